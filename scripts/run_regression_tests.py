@@ -1,9 +1,11 @@
 import argparse
 import glob
+import json
 import sys
 import os
 import subprocess
 import multiprocessing
+import time
 from functools import partial
 
 def is_game_path(path):
@@ -15,23 +17,75 @@ def is_game_path(path):
     return extension in ["cue", "chd"]
 
 
-def run_regression_test(runner, destdir, dump_interval, frames, gamepath):
+def get_game_paths(gamedir, gamelist):
+    if gamelist is not None:
+        with open(gamelist, "r") as f:
+            return [line.strip() for line in f if line.strip() and not line.startswith("#")]
+
+    paths = glob.glob(gamedir + "/**/*.*", recursive=True)
+    return sorted(filter(is_game_path, paths))
+
+
+def run_regression_test(runner, destdir, dump_interval, frames, renderer, benchmark, hash_interval, timeout, gamepath):
+    name = os.path.splitext(os.path.basename(gamepath))[0]
     args = [runner,
-            "-renderer", "software",
+            "-renderer", renderer,
             "-log", "verbose",
-            "-dumpdir", destdir,
-            "-dumpinterval", str(dump_interval),
             "-frames", str(frames),
-            "--", gamepath
     ]
 
+    if dump_interval > 0:
+        args += ["-dumpdir", destdir, "-dumpinterval", str(dump_interval)]
+
+    benchmark_path = os.path.join(destdir, name + ".benchmark.json")
+    if benchmark:
+        args += ["-benchmarkoutput", benchmark_path]
+
+    if hash_interval > 0:
+        args += ["-hashlog", os.path.join(destdir, name + ".hashes"), "-hashinterval", str(hash_interval)]
+
+    args += ["--", gamepath]
+
     print("Running '%s'" % (" ".join(args)))
-    subprocess.run(args)
 
+    # each game gets its own process, the core keeps its state in globals
+    result = {"game": gamepath}
+    start_time = time.monotonic()
+    with open(os.path.join(destdir, name + ".log"), "w") as logfile:
+        try:
+            proc = subprocess.run(args, stdout=logfile, stderr=subprocess.STDOUT, timeout=timeout)
+            result["returncode"] = proc.returncode
+            if proc.returncode == 0:
+                result["status"] = "ok"
+            elif proc.returncode < 0 or proc.returncode > 255:
+                # negative on POSIX when killed by a signal, NTSTATUS codes on Windows
+                result["status"] = "crashed"
+            else:
+                result["status"] = "failed"
+        except subprocess.TimeoutExpired:
+            result["returncode"] = None
+            result["status"] = "timeout"
+
+    result["wall_time"] = time.monotonic() - start_time
 
-def run_regression_tests(runner, gamedir, destdir, dump_interval, frames, parallel=1):
-    paths = glob.glob(gamedir + "/*.*", recursive=True)
-    gamepaths = list(filter(is_game_path, paths))
+    if benchmark and result["status"] == "ok" and os.path.isfile(benchmark_path):
+        with open(benchmark_path, "r") as f:
+            result["benchmark"] = json.load(f)
+
+    print("%s: %s in %.2f seconds" % (name, result["status"], result["wall_time"]))
+    return result
+
+
+def write_report(report, results):
+    with open(report, "w") as f:
+        json.dump(results, f, indent=2)
+
+    print("Wrote report to '%s'" % report)
+
+
+def run_regression_tests(runner, gamedir, gamelist, destdir, dump_interval, frames, renderer, benchmark, hash_interval,
+                         timeout, report, parallel=1):
+    gamepaths = get_game_paths(gamedir, gamelist)
 
     if not os.path.isdir(destdir) and not os.mkdir(destdir):
         print("Failed to create directory")
@@ -39,33 +93,50 @@ def run_regression_tests(runner, gamedir, destdir, dump_interval, frames, parall
 
     print("Found %u games" % len(gamepaths))
 
+    func = partial(run_regression_test, runner, destdir, dump_interval, frames, renderer, benchmark, hash_interval,
+                   timeout)
     if parallel <= 1:
-        for game in gamepaths:
-            run_regression_test(runner, destdir, dump_interval, frames, game)
+        results = list(map(func, gamepaths))
     else:
         print("Processing %u games on %u processors" % (len(gamepaths), parallel))
-        func = partial(run_regression_test, runner, destdir, dump_interval, frames)
         pool = multiprocessing.Pool(parallel)
-        pool.map(func, gamepaths)
+        results = pool.map(func, gamepaths)
         pool.close()
 
+    counts = {}
+    for result in results:
+        counts[result["status"]] = counts.get(result["status"], 0) + 1
+    print("Results: %s" % ", ".join("%u %s" % (count, status) for status, count in sorted(counts.items())))
 
-    return True
+    if report is not None:
+        write_report(report, results)
+
+    return counts.get("ok", 0) == len(results)
 
 
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description="Generate frame dump images for regression tests")
     parser.add_argument("-runner", action="store", required=True, help="Path to DuckStation regression test runner")
-    parser.add_argument("-gamedir", action="store", required=True, help="Directory containing game images")
+    parser.add_argument("-gamedir", action="store", help="Directory containing game images")
+    parser.add_argument("-gamelist", action="store", help="File listing game images to run, one per line")
     parser.add_argument("-destdir", action="store", required=True, help="Base directory to dump frames to")
-    parser.add_argument("-dumpinterval", action="store", type=int, required=True, help="Interval to dump frames at")
+    parser.add_argument("-dumpinterval", action="store", type=int, default=0, help="Interval to dump frames at")
     parser.add_argument("-frames", action="store", type=int, default=3600, help="Number of frames to run")
+    parser.add_argument("-renderer", action="store", default="software", help="Renderer to run games with")
+    parser.add_argument("-benchmark", action="store_true", help="Collect timing statistics for each game")
+    parser.add_argument("-hashinterval", action="store", type=int, default=0, help="Interval to hash memory at")
+    parser.add_argument("-timeout", action="store", type=int, help="Seconds before a game is considered hung")
+    parser.add_argument("-report", action="store", help="Path to write JSON report of all games to")
     parser.add_argument("-parallel", action="store", type=int, default=1, help="Number of proceeses to run")
 
     args = parser.parse_args()
+    if (args.gamedir is None) == (args.gamelist is None):
+        parser.error("Exactly one of -gamedir or -gamelist must be specified")
 
-    if not run_regression_tests(args.runner, os.path.realpath(args.gamedir), os.path.realpath(args.destdir), args.dumpinterval, args.frames, args.parallel):
+    gamedir = os.path.realpath(args.gamedir) if args.gamedir is not None else None
+    if not run_regression_tests(args.runner, gamedir, args.gamelist, os.path.realpath(args.destdir), args.dumpinterval,
+                                args.frames, args.renderer, args.benchmark, args.hashinterval, args.timeout,
+                                args.report, args.parallel):
         sys.exit(1)
     else:
         sys.exit(0)
-
@@ -1,3 +1,60 @@
 #include "common/file_system.h"
+#include <cstring>
 #include <gtest/gtest.h>
 
+TEST(FileSystem, LockCFile)
+{
+  std::FILE* fp = std::tmpfile();
+  ASSERT_NE(fp, nullptr);
+
+  // locks are not recursive, so unlocking must allow the file to be locked again
+  ASSERT_TRUE(FileSystem::LockCFile(fp));
+  FileSystem::UnlockCFile(fp);
+  ASSERT_TRUE(FileSystem::LockCFile(fp));
+  FileSystem::UnlockCFile(fp);
+
+  std::fclose(fp);
+}
+
+TEST(FileSystem, MapCFile)
+{
+  std::FILE* fp = std::tmpfile();
+  ASSERT_NE(fp, nullptr);
+
+  static constexpr char data[] = "mapped file contents";
+  ASSERT_EQ(std::fwrite(data, sizeof(data), 1, fp), 1u);
+  ASSERT_EQ(std::fflush(fp), 0);
+
+  ASSERT_EQ(FileSystem::MapCFile(fp, 0), nullptr);
+
+  const void* ptr = FileSystem::MapCFile(fp, sizeof(data));
+  ASSERT_NE(ptr, nullptr);
+  ASSERT_EQ(std::memcmp(ptr, data, sizeof(data)), 0);
+  FileSystem::UnmapCFile(ptr, sizeof(data));
+
+  std::fclose(fp);
+}
+
+TEST(FileSystem, MapCFileCopyOnWrite)
+{
+  std::FILE* fp = std::tmpfile();
+  ASSERT_NE(fp, nullptr);
+
+  static constexpr char data[] = "mapped file contents";
+  ASSERT_EQ(std::fwrite(data, sizeof(data), 1, fp), 1u);
+  ASSERT_EQ(std::fflush(fp), 0);
+
+  char* ptr = static_cast<char*>(FileSystem::MapCFileCopyOnWrite(fp, sizeof(data)));
+  ASSERT_NE(ptr, nullptr);
+  ASSERT_EQ(std::memcmp(ptr, data, sizeof(data)), 0);
+
+  // writes stay in the mapping
+  ptr[0] = 'M';
+  const void* ro_ptr = FileSystem::MapCFile(fp, sizeof(data));
+  ASSERT_NE(ro_ptr, nullptr);
+  ASSERT_EQ(std::memcmp(ro_ptr, data, sizeof(data)), 0);
+  FileSystem::UnmapCFile(ro_ptr, sizeof(data));
+  FileSystem::UnmapCFile(ptr, sizeof(data));
+
+  std::fclose(fp);
+}
@@ -0,0 +1,53 @@
+#include "common/frame_time_histogram.h"
+#include <gtest/gtest.h>
+
+TEST(FrameTimeHistogram, EmptyHistogramHasNoPercentile)
+{
+  FrameTimeHistogram histogram;
+  ASSERT_EQ(histogram.GetSampleCount(), 0u);
+  ASSERT_EQ(histogram.GetMedian(), 0.0f);
+}
+
+TEST(FrameTimeHistogram, MedianOfFrames)
+{
+  FrameTimeHistogram histogram;
+  for (u32 i = 0; i < 9; i++)
+    histogram.AddFrame(16.65f);
+  histogram.AddFrame(50.0f);
+
+  ASSERT_EQ(histogram.GetSampleCount(), 10u);
+  ASSERT_NEAR(histogram.GetMedian(), 16.65f, FrameTimeHistogram::BUCKET_WIDTH);
+  ASSERT_NEAR(histogram.GetPercentile(1.0f), 50.0f, FrameTimeHistogram::BUCKET_WIDTH);
+}
+
+TEST(FrameTimeHistogram, OldFramesLeaveTheWindow)
+{
+  FrameTimeHistogram histogram(4);
+  for (u32 i = 0; i < 4; i++)
+    histogram.AddFrame(33.3f);
+  for (u32 i = 0; i < 4; i++)
+    histogram.AddFrame(16.7f);
+
+  ASSERT_EQ(histogram.GetSampleCount(), 4u);
+  ASSERT_NEAR(histogram.GetPercentile(1.0f), 16.7f, FrameTimeHistogram::BUCKET_WIDTH);
+}
+
+TEST(FrameTimeHistogram, OutOfRangeFramesAreClamped)
+{
+  FrameTimeHistogram histogram;
+  histogram.AddFrame(-1.0f);
+  histogram.AddFrame(10000.0f);
+
+  ASSERT_EQ(histogram.GetBuckets().front(), 1u);
+  ASSERT_EQ(histogram.GetBuckets().back(), 1u);
+}
+
+TEST(FrameTimeHistogram, ResetClearsFrames)
+{
+  FrameTimeHistogram histogram;
+  histogram.AddFrame(16.7f);
+  histogram.Reset();
+
+  ASSERT_EQ(histogram.GetSampleCount(), 0u);
+  ASSERT_EQ(histogram.GetBuckets()[167], 0u);
+}
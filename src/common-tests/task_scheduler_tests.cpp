@@ -0,0 +1,88 @@
+#include "common/task_scheduler.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace Threading;
+
+TEST(TaskScheduler, RunsEveryTask)
+{
+  TaskScheduler scheduler(4);
+  std::atomic<u32> count{0};
+  {
+    TaskGroup group(scheduler);
+    for (u32 i = 0; i < 1000; i++)
+      group.Run([&count]() { count.fetch_add(1); });
+  }
+
+  ASSERT_EQ(count.load(), 1000u);
+}
+
+TEST(TaskScheduler, CancelledTasksAreSkipped)
+{
+  TaskScheduler scheduler(1);
+  std::atomic<u32> count{0};
+  std::atomic_bool release{false};
+
+  TaskGroup group(scheduler);
+  group.Run([&release]() {
+    while (!release.load())
+      std::this_thread::yield();
+  });
+  for (u32 i = 0; i < 10; i++)
+    group.Run([&count]() { count.fetch_add(1); });
+
+  // the cancelled tasks still count as done
+  group.Cancel();
+  release.store(true);
+  group.Wait();
+  ASSERT_EQ(count.load(), 0u);
+}
+
+TEST(TaskScheduler, WaitingInsideATaskDoesNotDeadlock)
+{
+  TaskScheduler scheduler(1);
+  std::atomic<u32> count{0};
+
+  TaskGroup outer(scheduler);
+  outer.Run([&scheduler, &count]() {
+    TaskGroup inner(scheduler);
+    for (u32 i = 0; i < 8; i++)
+      inner.Run([&count]() { count.fetch_add(1); }, TaskScheduler::Priority::High);
+    inner.Wait();
+    count.fetch_add(1);
+  });
+  outer.Wait();
+
+  ASSERT_EQ(count.load(), 9u);
+}
+
+TEST(TaskScheduler, ConcurrentEnqueueAndSteal)
+{
+  // tasks are queued from several threads at once, and each one queues another on its own worker for the others to
+  // steal, so pops race with the pushes which are still counting them
+  std::atomic<u32> count{0};
+  {
+    TaskScheduler scheduler(4);
+    TaskGroup group(scheduler);
+    std::vector<std::thread> producers;
+    for (u32 i = 0; i < 4; i++)
+    {
+      producers.emplace_back([&group, &count]() {
+        for (u32 j = 0; j < 2000; j++)
+        {
+          group.Run([&group, &count]() {
+            count.fetch_add(1);
+            group.Run([&count]() { count.fetch_add(1); });
+          });
+        }
+      });
+    }
+
+    for (std::thread& thread : producers)
+      thread.join();
+    group.Wait();
+  }
+
+  ASSERT_EQ(count.load(), 16000u);
+}
@@ -10,6 +10,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <limits>
 #include <sys/stat.h>
 
 #if defined(_WIN32)
@@ -37,6 +38,15 @@ public:
 
   virtual ~FileByteStream() override { fclose(m_pFile); }
 
+  // replaces the stdio buffer, so sequential reads and writes go to the OS in large blocks. must be called before any
+  // I/O is done on the file.
+  void SetBufferSize(u32 size)
+  {
+    m_buffer = std::make_unique<char[]>(size);
+    if (setvbuf(m_pFile, m_buffer.get(), _IOFBF, size) != 0)
+      m_buffer.reset();
+  }
+
   bool ReadByte(u8* pDestByte) override
   {
     if (m_errorState)
@@ -271,6 +281,28 @@ public:
 
 protected:
   FILE* m_pFile;
+  std::unique_ptr<char[]> m_buffer;
+};
+
+// streams which read a file through a mapping, so small reads are just copies
+class MappedFileByteStream final : public ReadOnlyMemoryByteStream
+{
+public:
+  MappedFileByteStream(std::FILE* fp, const void* data, u32 size)
+    : ReadOnlyMemoryByteStream(data, size), m_fp(fp), m_data(data), m_size(size)
+  {
+  }
+
+  ~MappedFileByteStream() override
+  {
+    FileSystem::UnmapCFile(m_data, m_size);
+    std::fclose(m_fp);
+  }
+
+private:
+  std::FILE* m_fp;
+  const void* m_data;
+  u32 m_size;
 };
 
 class AtomicUpdatedFileByteStream final : public FileByteStream
@@ -979,8 +1011,11 @@ bool ByteStream::WriteSizePrefixedString(const std::string_view& str)
   return (Write2(&size, sizeof(size)) && (size == 0 || Write2(str.data(), size)));
 }
 
-std::unique_ptr<ByteStream> ByteStream::OpenFile(const char* fileName, u32 openMode)
+std::unique_ptr<ByteStream> ByteStream::OpenFile(const char* fileName, u32 openMode, u32 bufferSize /* = 0 */)
 {
+  if (bufferSize == 0 && (openMode & BYTESTREAM_OPEN_STREAMED))
+    bufferSize = STREAMED_FILE_BUFFER_SIZE;
+
   if ((openMode & (BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE)) == BYTESTREAM_OPEN_WRITE)
   {
     // if opening with write but not create, the path must exist.
@@ -1071,6 +1106,8 @@ std::unique_ptr<ByteStream> ByteStream::OpenFile(const char* fileName, u32 openM
     // create the stream pointer
     std::unique_ptr<AtomicUpdatedFileByteStream> pStream =
       std::make_unique<AtomicUpdatedFileByteStream>(pTemporaryFile, fileName, temporaryFileName);
+    if (bufferSize > 0)
+      pStream->SetBufferSize(bufferSize);
 
     // do we need to copy the existing file into this one?
     if (!(openMode & BYTESTREAM_OPEN_TRUNCATE))
@@ -1083,15 +1120,15 @@ std::unique_ptr<ByteStream> ByteStream::OpenFile(const char* fileName, u32 openM
         return nullptr;
       }
 
-      static const size_t BUFFERSIZE = 4096;
-      u8 buffer[BUFFERSIZE];
+      static const size_t BUFFERSIZE = 64 * 1024;
+      std::unique_ptr<u8[]> buffer = std::make_unique<u8[]>(BUFFERSIZE);
       while (!feof(pOriginalFile))
       {
-        size_t nBytes = fread(buffer, BUFFERSIZE, sizeof(u8), pOriginalFile);
+        size_t nBytes = fread(buffer.get(), sizeof(u8), BUFFERSIZE, pOriginalFile);
         if (nBytes == 0)
           break;
 
-        if (pStream->Write(buffer, (u32)nBytes) != (u32)nBytes)
+        if (pStream->Write(buffer.get(), (u32)nBytes) != (u32)nBytes)
         {
           pStream->Discard();
           fclose(pOriginalFile);
@@ -1128,6 +1165,8 @@ std::unique_ptr<ByteStream> ByteStream::OpenFile(const char* fileName, u32 openM
     // create the stream pointer
     std::unique_ptr<AtomicUpdatedFileByteStream> pStream =
       std::make_unique<AtomicUpdatedFileByteStream>(pTemporaryFile, fileName, temporaryFileName);
+    if (bufferSize > 0)
+      pStream->SetBufferSize(bufferSize);
 
     // do we need to copy the existing file into this one?
     if (!(openMode & BYTESTREAM_OPEN_TRUNCATE))
@@ -1140,15 +1179,15 @@ std::unique_ptr<ByteStream> ByteStream::OpenFile(const char* fileName, u32 openM
         return nullptr;
       }
 
-      static const size_t BUFFERSIZE = 4096;
-      u8 buffer[BUFFERSIZE];
+      static const size_t BUFFERSIZE = 64 * 1024;
+      std::unique_ptr<u8[]> buffer = std::make_unique<u8[]>(BUFFERSIZE);
       while (!std::feof(pOriginalFile))
       {
-        size_t nBytes = std::fread(buffer, BUFFERSIZE, sizeof(u8), pOriginalFile);
+        size_t nBytes = std::fread(buffer.get(), sizeof(u8), BUFFERSIZE, pOriginalFile);
         if (nBytes == 0)
           break;
 
-        if (pStream->Write(buffer, (u32)nBytes) != (u32)nBytes)
+        if (pStream->Write(buffer.get(), (u32)nBytes) != (u32)nBytes)
         {
           pStream->SetErrorState();
           std::fclose(pOriginalFile);
@@ -1171,10 +1210,34 @@ std::unique_ptr<ByteStream> ByteStream::OpenFile(const char* fileName, u32 openM
     if (!pFile)
       return nullptr;
 
-    return std::make_unique<FileByteStream>(pFile);
+    std::unique_ptr<FileByteStream> pStream = std::make_unique<FileByteStream>(pFile);
+    if (bufferSize > 0)
+      pStream->SetBufferSize(bufferSize);
+
+    return pStream;
   }
 }
 
+std::unique_ptr<ByteStream> ByteStream::OpenMappedFile(const char* fileName)
+{
+  std::FILE* fp = FileSystem::OpenCFile(fileName, "rb");
+  if (!fp)
+    return nullptr;
+
+  const s64 size = FileSystem::FSize64(fp);
+  const void* data = (size > 0 && size <= std::numeric_limits<u32>::max()) ?
+                       FileSystem::MapCFile(fp, static_cast<size_t>(size)) :
+                       nullptr;
+  if (!data)
+  {
+    // empty files can't be mapped, and some filesystems don't support it
+    std::fclose(fp);
+    return OpenFile(fileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+  }
+
+  return std::make_unique<MappedFileByteStream>(fp, data, static_cast<u32>(size));
+}
+
 std::unique_ptr<MemoryByteStream> ByteStream::CreateMemoryStream(void* pMemory, u32 Size)
 {
   DebugAssert(pMemory != nullptr && Size > 0);
@@ -1346,10 +1409,18 @@ bool ByteStream::WriteBinaryToStream(ByteStream* stream, const void* data, size_
 class ZstdCompressStream final : public ByteStream
 {
 public:
-  ZstdCompressStream(ByteStream* dst_stream, int compression_level) : m_dst_stream(dst_stream)
+  ZstdCompressStream(ByteStream* dst_stream, int compression_level, u32 num_workers) : m_dst_stream(dst_stream)
   {
     m_cstream = ZSTD_createCStream();
     ZSTD_CCtx_setParameter(m_cstream, ZSTD_c_compressionLevel, compression_level);
+
+    // fails without multithreading support in the library, in which case we just compress on this thread. the
+    // default job size is several times the window, which would leave a save state in a single job.
+    if (num_workers > 0 &&
+        !ZSTD_isError(ZSTD_CCtx_setParameter(m_cstream, ZSTD_c_nbWorkers, static_cast<int>(num_workers))))
+    {
+      ZSTD_CCtx_setParameter(m_cstream, ZSTD_c_jobSize, MULTITHREADED_JOB_SIZE);
+    }
   }
 
   ~ZstdCompressStream() override
@@ -1422,6 +1493,7 @@ private:
   {
     INPUT_BUFFER_SIZE = 131072,
     OUTPUT_BUFFER_SIZE = 65536,
+    MULTITHREADED_JOB_SIZE = 1048576,
   };
 
   bool Compress(ZSTD_EndDirective action)
@@ -1487,9 +1559,10 @@ private:
   u8 m_output_buffer[OUTPUT_BUFFER_SIZE];
 };
 
-std::unique_ptr<ByteStream> ByteStream::CreateZstdCompressStream(ByteStream* src_stream, int compression_level)
+std::unique_ptr<ByteStream> ByteStream::CreateZstdCompressStream(ByteStream* src_stream, int compression_level,
+                                                                 u32 num_workers)
 {
-  return std::make_unique<ZstdCompressStream>(src_stream, compression_level);
+  return std::make_unique<ZstdCompressStream>(src_stream, compression_level, num_workers);
 }
 
 class ZstdDecompressStream final : public ByteStream
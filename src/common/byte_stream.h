@@ -97,9 +97,16 @@ public:
   bool WriteS64(s64 dest);
   bool WriteSizePrefixedString(const std::string_view& str);
 
+  // buffer size for streamed file streams, which are read or written sequentially.
+  static constexpr u32 STREAMED_FILE_BUFFER_SIZE = 1024 * 1024;
+
   // base byte stream creation functions
   // opens a local file-based stream. fills in error if passed, and returns false if the file cannot be opened.
-  static std::unique_ptr<ByteStream> OpenFile(const char* FileName, u32 OpenMode);
+  // a zero buffer size uses STREAMED_FILE_BUFFER_SIZE for streamed files, and the stdio default otherwise.
+  static std::unique_ptr<ByteStream> OpenFile(const char* FileName, u32 OpenMode, u32 BufferSize = 0);
+
+  // opens a file for reading through a memory mapping, falling back to a streamed file if it can't be mapped.
+  static std::unique_ptr<ByteStream> OpenMappedFile(const char* FileName);
 
   // memory byte stream, caller is responsible for management, therefore it can be located on either the stack or on the
   // heap.
@@ -117,8 +124,9 @@ public:
   // null memory stream
   static std::unique_ptr<NullByteStream> CreateNullStream();
 
-  // zstd stream
-  static std::unique_ptr<ByteStream> CreateZstdCompressStream(ByteStream* src_stream, int compression_level);
+  // zstd stream. a non-zero worker count compresses on that many extra threads, in jobs of around a megabyte.
+  static std::unique_ptr<ByteStream> CreateZstdCompressStream(ByteStream* src_stream, int compression_level,
+                                                              u32 num_workers = 0);
   static std::unique_ptr<ByteStream> CreateZstdDecompressStream(ByteStream* src_stream, u32 compressed_size);
 
   // copies one stream's contents to another. rewinds source streams automatically, and returns it back to its old
@@ -200,7 +208,7 @@ private:
   u32 m_iSize;
 };
 
-class ReadOnlyMemoryByteStream final : public ByteStream
+class ReadOnlyMemoryByteStream : public ByteStream
 {
 public:
   ReadOnlyMemoryByteStream(const void* pMemory, u32 MemSize);
@@ -217,10 +217,32 @@ ShaderCache::ComPtr<ID3DBlob> ShaderCache::GetShaderBlob(ShaderCompiler::Type ty
   if (iter == m_index.end())
     return CompileAndAddShaderBlob(key, shader_code);
 
+  return ReadShaderBlob(iter->second);
+}
+
+ShaderCache::ComPtr<ID3DBlob> ShaderCache::LookupShaderBlob(ShaderCompiler::Type type, std::string_view shader_code)
+{
+  const auto key = GetCacheKey(type, shader_code);
+  auto iter = m_index.find(key);
+  if (iter == m_index.end())
+    return {};
+
+  return ReadShaderBlob(iter->second);
+}
+
+void ShaderCache::InsertShaderBlob(ShaderCompiler::Type type, std::string_view shader_code, ID3DBlob* blob)
+{
+  const auto key = GetCacheKey(type, shader_code);
+  if (m_index.find(key) == m_index.end())
+    AddShaderBlob(key, blob);
+}
+
+ShaderCache::ComPtr<ID3DBlob> ShaderCache::ReadShaderBlob(const CacheIndexData& data)
+{
   ComPtr<ID3DBlob> blob;
-  HRESULT hr = D3DCreateBlob(iter->second.blob_size, blob.GetAddressOf());
-  if (FAILED(hr) || std::fseek(m_blob_file, iter->second.file_offset, SEEK_SET) != 0 ||
-      std::fread(blob->GetBufferPointer(), 1, iter->second.blob_size, m_blob_file) != iter->second.blob_size)
+  HRESULT hr = D3DCreateBlob(data.blob_size, blob.GetAddressOf());
+  if (FAILED(hr) || std::fseek(m_blob_file, data.file_offset, SEEK_SET) != 0 ||
+      std::fread(blob->GetBufferPointer(), 1, data.blob_size, m_blob_file) != data.blob_size)
   {
     Log_ErrorPrintf("Read blob from file failed");
     return {};
@@ -274,8 +296,14 @@ ShaderCache::ComPtr<ID3DBlob> ShaderCache::CompileAndAddShaderBlob(const CacheIn
   if (!blob)
     return {};
 
+  AddShaderBlob(key, blob.Get());
+  return blob;
+}
+
+void ShaderCache::AddShaderBlob(const CacheIndexKey& key, ID3DBlob* blob)
+{
   if (!m_blob_file || std::fseek(m_blob_file, 0, SEEK_END) != 0)
-    return blob;
+    return;
 
   CacheIndexData data;
   data.file_offset = static_cast<u32>(std::ftell(m_blob_file));
@@ -294,11 +322,10 @@ ShaderCache::ComPtr<ID3DBlob> ShaderCache::CompileAndAddShaderBlob(const CacheIn
       std::fflush(m_index_file) != 0)
   {
     Log_ErrorPrintf("Failed to write shader blob to file");
-    return blob;
+    return;
   }
 
   m_index.emplace(key, data);
-  return blob;
 }
 
 } // namespace D3D11
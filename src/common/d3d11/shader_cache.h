@@ -25,6 +25,12 @@ public:
 
   ComPtr<ID3DBlob> GetShaderBlob(ShaderCompiler::Type type, std::string_view shader_code);
 
+  /// Returns the cached blob for the shader, without compiling it if it's missing.
+  ComPtr<ID3DBlob> LookupShaderBlob(ShaderCompiler::Type type, std::string_view shader_code);
+
+  /// Adds a blob which was compiled elsewhere, e.g. on a worker thread.
+  void InsertShaderBlob(ShaderCompiler::Type type, std::string_view shader_code, ID3DBlob* blob);
+
   ComPtr<ID3D11VertexShader> GetVertexShader(ID3D11Device* device, std::string_view shader_code);
   ComPtr<ID3D11GeometryShader> GetGeometryShader(ID3D11Device* device, std::string_view shader_code);
   ComPtr<ID3D11PixelShader> GetPixelShader(ID3D11Device* device, std::string_view shader_code);
@@ -71,6 +77,8 @@ private:
   void Close();
 
   ComPtr<ID3DBlob> CompileAndAddShaderBlob(const CacheIndexKey& key, std::string_view shader_code);
+  ComPtr<ID3DBlob> ReadShaderBlob(const CacheIndexData& data);
+  void AddShaderBlob(const CacheIndexKey& key, ID3DBlob* blob);
 
   std::FILE* m_index_file = nullptr;
   std::FILE* m_blob_file = nullptr;
@@ -233,7 +233,28 @@ bool Context::CreateCommandQueue()
                                                D3D12_COMMAND_QUEUE_FLAG_NONE};
   HRESULT hr = m_device->CreateCommandQueue(&queue_desc, IID_PPV_ARGS(&m_command_queue));
   AssertMsg(SUCCEEDED(hr), "Create command queue");
-  return SUCCEEDED(hr);
+  if (FAILED(hr))
+    return false;
+
+  CreateCopyQueue();
+  return true;
+}
+
+void Context::CreateCopyQueue()
+{
+  // The copy queue is optional, everything falls back to the direct queue without it.
+  const D3D12_COMMAND_QUEUE_DESC queue_desc = {D3D12_COMMAND_LIST_TYPE_COPY, D3D12_COMMAND_QUEUE_PRIORITY_NORMAL,
+                                               D3D12_COMMAND_QUEUE_FLAG_NONE};
+  HRESULT hr = m_device->CreateCommandQueue(&queue_desc, IID_PPV_ARGS(m_copy_queue.ReleaseAndGetAddressOf()));
+  if (SUCCEEDED(hr))
+    hr = m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(m_copy_fence.ReleaseAndGetAddressOf()));
+
+  if (FAILED(hr))
+  {
+    Log_WarningPrintf("Failed to create copy queue: %08X", hr);
+    m_copy_fence.Reset();
+    m_copy_queue.Reset();
+  }
 }
 
 bool Context::CreateFence()
@@ -307,6 +328,24 @@ bool Context::CreateCommandLists()
     AssertMsg(SUCCEEDED(hr), "Closing new command list failed");
     if (FAILED(hr))
       return false;
+
+    if (m_copy_queue)
+    {
+      hr = m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY,
+                                            IID_PPV_ARGS(res.copy_command_allocator.GetAddressOf()));
+      if (SUCCEEDED(hr))
+      {
+        hr = m_device->CreateCommandList(1, D3D12_COMMAND_LIST_TYPE_COPY, res.copy_command_allocator.Get(), nullptr,
+                                         IID_PPV_ARGS(res.copy_command_list.GetAddressOf()));
+      }
+      if (SUCCEEDED(hr))
+        hr = res.copy_command_list->Close();
+      if (FAILED(hr))
+      {
+        Log_ErrorPrintf("Failed to create copy command list: %08X", hr);
+        return false;
+      }
+    }
   }
 
   MoveToNextCommandList();
@@ -366,11 +405,46 @@ void Context::MoveToNextCommandList()
   res.command_list->SetDescriptorHeaps(static_cast<UINT>(m_gpu_descriptor_heaps.size()), m_gpu_descriptor_heaps.data());
 }
 
+ID3D12GraphicsCommandList* Context::GetCopyCommandList()
+{
+  if (!m_copy_queue)
+    return nullptr;
+
+  // The allocator is safe to reset, the last use of this list has completed because the direct list waited on it.
+  CommandListResources& res = m_command_lists[m_current_command_list];
+  if (!res.has_copy_commands)
+  {
+    res.copy_command_allocator->Reset();
+    res.copy_command_list->Reset(res.copy_command_allocator.Get(), nullptr);
+    res.has_copy_commands = true;
+  }
+
+  return res.copy_command_list.Get();
+}
+
+void Context::SubmitCopyCommandList(CommandListResources& res)
+{
+  HRESULT hr = res.copy_command_list->Close();
+  AssertMsg(SUCCEEDED(hr), "Close copy command list");
+  const std::array<ID3D12CommandList*, 1> execute_lists{res.copy_command_list.Get()};
+  m_copy_queue->ExecuteCommandLists(static_cast<UINT>(execute_lists.size()), execute_lists.data());
+  res.has_copy_commands = false;
+
+  // The direct list consumes the results, so it has to wait for the copies on the GPU.
+  hr = m_copy_queue->Signal(m_copy_fence.Get(), m_current_fence_value);
+  AssertMsg(SUCCEEDED(hr), "Signal copy fence");
+  hr = m_command_queue->Wait(m_copy_fence.Get(), m_current_fence_value);
+  AssertMsg(SUCCEEDED(hr), "Wait for copy fence");
+}
+
 void Context::ExecuteCommandList(bool wait_for_completion)
 {
   CommandListResources& res = m_command_lists[m_current_command_list];
   HRESULT hr;
 
+  if (res.has_copy_commands)
+    SubmitCopyCommandList(res);
+
   if (res.has_timestamp_query)
   {
     // write the timestamp back at the end of the cmdlist
@@ -453,6 +527,8 @@ void Context::DestroyResources()
     m_fence_event = {};
   }
 
+  m_copy_fence.Reset();
+  m_copy_queue.Reset();
   m_command_queue.Reset();
   m_debug_interface.Reset();
   m_device.Reset();
@@ -46,6 +46,8 @@ public:
 
   ID3D12Device* GetDevice() const { return m_device.Get(); }
   ID3D12CommandQueue* GetCommandQueue() const { return m_command_queue.Get(); }
+  ID3D12CommandQueue* GetCopyQueue() const { return m_copy_queue.Get(); }
+  bool HasCopyQueue() const { return static_cast<bool>(m_copy_queue); }
 
   // Returns the current command list, commands can be recorded directly.
   ID3D12GraphicsCommandList* GetCommandList() const
@@ -53,6 +55,12 @@ public:
     return m_command_lists[m_current_command_list].command_list.Get();
   }
 
+  // Returns the copy queue command list associated with the current command list, beginning it if needed. It is
+  // submitted before the current command list, which waits for it on the GPU, so copies can overlap with previously
+  // submitted work. Destination resources must be in the COMMON state, and must not be in use by any command list
+  // which has not yet completed. Returns nullptr if there is no copy queue.
+  ID3D12GraphicsCommandList* GetCopyCommandList();
+
   // Descriptor manager access.
   DescriptorHeapManager& GetDescriptorHeapManager() { return m_descriptor_heap_manager; }
   DescriptorHeapManager& GetRTVHeapManager() { return m_rtv_heap_manager; }
@@ -103,28 +111,35 @@ private:
   {
     ComPtr<ID3D12CommandAllocator> command_allocator;
     ComPtr<ID3D12GraphicsCommandList> command_list;
+    ComPtr<ID3D12CommandAllocator> copy_command_allocator;
+    ComPtr<ID3D12GraphicsCommandList> copy_command_list;
     std::vector<ID3D12Resource*> pending_resources;
     std::vector<std::pair<DescriptorHeapManager&, u32>> pending_descriptors;
     u64 ready_fence_value = 0;
     bool has_timestamp_query = false;
+    bool has_copy_commands = false;
   };
 
   Context();
 
   bool CreateDevice(IDXGIFactory* dxgi_factory, u32 adapter_index, bool enable_debug_layer);
   bool CreateCommandQueue();
+  void CreateCopyQueue();
   bool CreateFence();
   bool CreateDescriptorHeaps();
   bool CreateCommandLists();
   bool CreateTextureStreamBuffer();
   bool CreateTimestampQuery();
   void MoveToNextCommandList();
+  void SubmitCopyCommandList(CommandListResources& res);
   void DestroyPendingResources(CommandListResources& cmdlist);
   void DestroyResources();
 
   ComPtr<ID3D12Debug> m_debug_interface;
   ComPtr<ID3D12Device> m_device;
   ComPtr<ID3D12CommandQueue> m_command_queue;
+  ComPtr<ID3D12CommandQueue> m_copy_queue;
+  ComPtr<ID3D12Fence> m_copy_fence;
 
   ComPtr<ID3D12Fence> m_fence = nullptr;
   HANDLE m_fence_event = {};
@@ -10,7 +10,8 @@ Log_SetChannel(D3D12);
 
 static constexpr std::array<DXGI_FORMAT, static_cast<u32>(GPUTexture::Format::Count)> s_dxgi_mapping = {
   {DXGI_FORMAT_UNKNOWN, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_FORMAT_B5G6R5_UNORM,
-   DXGI_FORMAT_B5G5R5A1_UNORM, DXGI_FORMAT_R8_UNORM, DXGI_FORMAT_D16_UNORM}};
+   DXGI_FORMAT_B5G5R5A1_UNORM, DXGI_FORMAT_R8_UNORM, DXGI_FORMAT_D16_UNORM,
+   DXGI_FORMAT_D32_FLOAT}};
 
 D3D12::Texture::Texture() = default;
 
@@ -333,6 +334,36 @@ void D3D12::Texture::CopyFromBuffer(u32 x, u32 y, u32 width, u32 height, u32 pit
   TransitionToState(old_state);
 }
 
+bool D3D12::Texture::CopyFromBufferOnCopyQueue(u32 x, u32 y, u32 width, u32 height, u32 pitch,
+                                               ID3D12Resource* buffer, u32 buffer_offset)
+{
+  DebugAssert(m_state == D3D12_RESOURCE_STATE_COMMON);
+  ID3D12GraphicsCommandList* cmdlist = g_d3d12_context->GetCopyCommandList();
+  if (!cmdlist)
+    return false;
+
+  D3D12_TEXTURE_COPY_LOCATION src;
+  src.pResource = buffer;
+  src.SubresourceIndex = 0;
+  src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+  src.PlacedFootprint.Offset = buffer_offset;
+  src.PlacedFootprint.Footprint.Width = width;
+  src.PlacedFootprint.Footprint.Height = height;
+  src.PlacedFootprint.Footprint.Depth = 1;
+  src.PlacedFootprint.Footprint.RowPitch = pitch;
+  src.PlacedFootprint.Footprint.Format = GetDXGIFormat();
+
+  D3D12_TEXTURE_COPY_LOCATION dst;
+  dst.pResource = m_resource.Get();
+  dst.SubresourceIndex = 0;
+  dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+
+  // implicitly promoted to COPY_DEST, and decays to COMMON when the copy list completes
+  const D3D12_BOX src_box{0u, 0u, 0u, width, height, 1u};
+  cmdlist->CopyTextureRegion(&dst, x, y, 0, &src, &src_box);
+  return true;
+}
+
 bool D3D12::Texture::LoadData(u32 x, u32 y, u32 width, u32 height, const void* data, u32 pitch)
 {
   const u32 texel_size = GetPixelSize();
@@ -57,6 +57,11 @@ public:
   static void CopyToUploadBuffer(const void* src_data, u32 src_pitch, u32 height, void* dst_data, u32 dst_pitch);
   void CopyFromBuffer(u32 x, u32 y, u32 width, u32 height, u32 pitch, ID3D12Resource* buffer, u32 buffer_offset);
 
+  /// Records the copy on the context's copy queue instead. The texture must be in the COMMON state, and decays back to
+  /// it once the copy completes. Returns false if there is no copy queue.
+  bool CopyFromBufferOnCopyQueue(u32 x, u32 y, u32 width, u32 height, u32 pitch, ID3D12Resource* buffer,
+                                 u32 buffer_offset);
+
 private:
   static bool CreateSRVDescriptor(ID3D12Resource* resource, DXGI_FORMAT format, bool multisampled,
                                   DescriptorHandle* dh);
@@ -5,6 +5,7 @@
 #include "common/string.h"
 #include "file_system.h"
 #include <cmath>
+#include <cstring>
 #include <fcntl.h>
 #include <string.h>
 #include <unistd.h>
@@ -23,6 +24,8 @@ DRMDisplay::~DRMDisplay()
   if (m_prev_crtc)
     RestoreBuffer();
 
+  DestroyAtomic();
+
   if (m_connector)
     drmModeFreeConnector(m_connector);
 
@@ -78,6 +81,33 @@ static uint32_t find_crtc_for_connector(int card_fd, const drmModeRes* resources
   return -1;
 }
 
+static u32 find_object_property(int card_fd, u32 object_id, u32 object_type, const char* name, u64* value = nullptr)
+{
+  drmModeObjectProperties* props = drmModeObjectGetProperties(card_fd, object_id, object_type);
+  if (!props)
+    return 0;
+
+  u32 prop_id = 0;
+  for (u32 i = 0; i < props->count_props && prop_id == 0; i++)
+  {
+    drmModePropertyRes* prop = drmModeGetProperty(card_fd, props->props[i]);
+    if (!prop)
+      continue;
+
+    if (std::strcmp(prop->name, name) == 0)
+    {
+      prop_id = prop->prop_id;
+      if (value)
+        *value = props->prop_values[i];
+    }
+
+    drmModeFreeProperty(prop);
+  }
+
+  drmModeFreeObjectProperties(props);
+  return prop_id;
+}
+
 bool DRMDisplay::Initialize(u32 width, u32 height, float refresh_rate)
 {
   if (m_card_id < 0)
@@ -96,6 +126,8 @@ bool DRMDisplay::Initialize(u32 width, u32 height, float refresh_rate)
 
 void DRMDisplay::RestoreBuffer()
 {
+  WaitForPendingFlip();
+
   if (m_prev_crtc)
   {
     u32 connector_id = m_connector->connector_id;
@@ -214,6 +246,8 @@ bool DRMDisplay::TryOpeningCard(int card, u32 width, u32 height, float refresh_r
     }
   }
 
+  DestroyAtomic();
+  m_atomic = InitializeAtomic(resources);
   drmModeFreeResources(resources);
 
   m_card_id = card;
@@ -221,6 +255,102 @@ bool DRMDisplay::TryOpeningCard(int card, u32 width, u32 height, float refresh_r
   return true;
 }
 
+bool DRMDisplay::InitializeAtomic(const drmModeRes* resources)
+{
+  if (drmSetClientCap(m_card_fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) != 0 ||
+      drmSetClientCap(m_card_fd, DRM_CLIENT_CAP_ATOMIC, 1) != 0)
+  {
+    Log_WarningPrintf("Atomic modesetting is not supported, using legacy page flips.");
+    return false;
+  }
+
+  u32 crtc_mask = 0;
+  for (int i = 0; i < resources->count_crtcs; i++)
+  {
+    if (resources->crtcs[i] == m_crtc_id)
+      crtc_mask = 1u << i;
+  }
+
+  drmModePlaneRes* plane_resources = drmModeGetPlaneResources(m_card_fd);
+  if (!plane_resources)
+  {
+    Log_ErrorPrintf("drmModeGetPlaneResources() failed: %d (%s)", errno, strerror(errno));
+    return false;
+  }
+
+  m_plane_id = 0;
+  for (u32 i = 0; i < plane_resources->count_planes && m_plane_id == 0; i++)
+  {
+    drmModePlane* plane = drmModeGetPlane(m_card_fd, plane_resources->planes[i]);
+    if (!plane)
+      continue;
+
+    u64 type;
+    if ((plane->possible_crtcs & crtc_mask) &&
+        find_object_property(m_card_fd, plane->plane_id, DRM_MODE_OBJECT_PLANE, "type", &type) != 0 &&
+        type == DRM_PLANE_TYPE_PRIMARY)
+    {
+      m_plane_id = plane->plane_id;
+    }
+
+    drmModeFreePlane(plane);
+  }
+
+  drmModeFreePlaneResources(plane_resources);
+  if (m_plane_id == 0)
+  {
+    Log_ErrorPrintf("No primary plane found for CRTC %u", m_crtc_id);
+    return false;
+  }
+
+  AtomicProperties& props = m_atomic_properties;
+  const u32 connector_id = m_connector->connector_id;
+  props.connector_crtc_id = find_object_property(m_card_fd, connector_id, DRM_MODE_OBJECT_CONNECTOR, "CRTC_ID");
+  props.crtc_mode_id = find_object_property(m_card_fd, m_crtc_id, DRM_MODE_OBJECT_CRTC, "MODE_ID");
+  props.crtc_active = find_object_property(m_card_fd, m_crtc_id, DRM_MODE_OBJECT_CRTC, "ACTIVE");
+  props.plane_fb_id = find_object_property(m_card_fd, m_plane_id, DRM_MODE_OBJECT_PLANE, "FB_ID");
+  props.plane_crtc_id = find_object_property(m_card_fd, m_plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_ID");
+  props.plane_src_x = find_object_property(m_card_fd, m_plane_id, DRM_MODE_OBJECT_PLANE, "SRC_X");
+  props.plane_src_y = find_object_property(m_card_fd, m_plane_id, DRM_MODE_OBJECT_PLANE, "SRC_Y");
+  props.plane_src_w = find_object_property(m_card_fd, m_plane_id, DRM_MODE_OBJECT_PLANE, "SRC_W");
+  props.plane_src_h = find_object_property(m_card_fd, m_plane_id, DRM_MODE_OBJECT_PLANE, "SRC_H");
+  props.plane_crtc_x = find_object_property(m_card_fd, m_plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_X");
+  props.plane_crtc_y = find_object_property(m_card_fd, m_plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_Y");
+  props.plane_crtc_w = find_object_property(m_card_fd, m_plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_W");
+  props.plane_crtc_h = find_object_property(m_card_fd, m_plane_id, DRM_MODE_OBJECT_PLANE, "CRTC_H");
+  if (props.connector_crtc_id == 0 || props.crtc_mode_id == 0 || props.crtc_active == 0 || props.plane_fb_id == 0 ||
+      props.plane_crtc_id == 0 || props.plane_src_x == 0 || props.plane_src_y == 0 || props.plane_src_w == 0 ||
+      props.plane_src_h == 0 || props.plane_crtc_x == 0 || props.plane_crtc_y == 0 || props.plane_crtc_w == 0 ||
+      props.plane_crtc_h == 0)
+  {
+    Log_ErrorPrintf("Missing atomic modesetting properties, using legacy page flips.");
+    return false;
+  }
+
+  if (drmModeCreatePropertyBlob(m_card_fd, m_mode, sizeof(drmModeModeInfo), &m_mode_blob_id) != 0)
+  {
+    Log_ErrorPrintf("drmModeCreatePropertyBlob() failed: %d (%s)", errno, strerror(errno));
+    m_mode_blob_id = 0;
+    return false;
+  }
+
+  Log_InfoPrintf("Using atomic modesetting with plane %u on CRTC %u", m_plane_id, m_crtc_id);
+  m_atomic_modeset_done = false;
+  return true;
+}
+
+void DRMDisplay::DestroyAtomic()
+{
+  if (m_mode_blob_id != 0)
+  {
+    drmModeDestroyPropertyBlob(m_card_fd, m_mode_blob_id);
+    m_mode_blob_id = 0;
+  }
+
+  m_atomic = false;
+  m_atomic_modeset_done = false;
+}
+
 std::optional<u32> DRMDisplay::AddBuffer(u32 width, u32 height, u32 format, u32 handle, u32 pitch, u32 offset)
 {
   uint32_t bo_handles[4] = {handle, 0, 0, 0};
@@ -245,6 +375,12 @@ void DRMDisplay::RemoveBuffer(u32 fb_id)
 
 void DRMDisplay::PresentBuffer(u32 fb_id, bool wait_for_vsync)
 {
+  if (m_atomic)
+  {
+    PresentBufferAtomic(fb_id);
+    return;
+  }
+
   if (!wait_for_vsync)
   {
     u32 connector_id = m_connector->connector_id;
@@ -289,6 +425,82 @@ void DRMDisplay::PresentBuffer(u32 fb_id, bool wait_for_vsync)
   }
 }
 
+void DRMDisplay::PresentBufferAtomic(u32 fb_id)
+{
+  // only one commit can be in flight, so this is also what paces presentation to vblank
+  WaitForPendingFlip();
+
+  drmModeAtomicReq* req = drmModeAtomicAlloc();
+  if (!req)
+  {
+    Log_ErrorPrintf("drmModeAtomicAlloc() failed");
+    return;
+  }
+
+  u32 flags = DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_ATOMIC_NONBLOCK;
+  const AtomicProperties& props = m_atomic_properties;
+  if (!m_atomic_modeset_done)
+  {
+    // the first commit takes over the CRTC, after that only the framebuffer changes
+    const u32 width = m_mode->hdisplay;
+    const u32 height = m_mode->vdisplay;
+    drmModeAtomicAddProperty(req, m_connector->connector_id, props.connector_crtc_id, m_crtc_id);
+    drmModeAtomicAddProperty(req, m_crtc_id, props.crtc_mode_id, m_mode_blob_id);
+    drmModeAtomicAddProperty(req, m_crtc_id, props.crtc_active, 1);
+    drmModeAtomicAddProperty(req, m_plane_id, props.plane_crtc_id, m_crtc_id);
+    drmModeAtomicAddProperty(req, m_plane_id, props.plane_src_x, 0);
+    drmModeAtomicAddProperty(req, m_plane_id, props.plane_src_y, 0);
+    drmModeAtomicAddProperty(req, m_plane_id, props.plane_src_w, static_cast<u64>(width) << 16);
+    drmModeAtomicAddProperty(req, m_plane_id, props.plane_src_h, static_cast<u64>(height) << 16);
+    drmModeAtomicAddProperty(req, m_plane_id, props.plane_crtc_x, 0);
+    drmModeAtomicAddProperty(req, m_plane_id, props.plane_crtc_y, 0);
+    drmModeAtomicAddProperty(req, m_plane_id, props.plane_crtc_w, width);
+    drmModeAtomicAddProperty(req, m_plane_id, props.plane_crtc_h, height);
+    flags |= DRM_MODE_ATOMIC_ALLOW_MODESET;
+  }
+  drmModeAtomicAddProperty(req, m_plane_id, props.plane_fb_id, fb_id);
+
+  const int res = drmModeAtomicCommit(m_card_fd, req, flags, this);
+  drmModeAtomicFree(req);
+  if (res != 0)
+  {
+    Log_ErrorPrintf("drmModeAtomicCommit() failed: %d", res);
+    return;
+  }
+
+  m_atomic_modeset_done = true;
+  m_flip_pending = true;
+}
+
+void DRMDisplay::WaitForPendingFlip()
+{
+  drmEventContext event_ctx = {};
+  event_ctx.version = DRM_EVENT_CONTEXT_VERSION;
+  event_ctx.page_flip_handler = [](int fd, unsigned int frame, unsigned int sec, unsigned int usec, void* data) {
+    static_cast<DRMDisplay*>(data)->m_flip_pending = false;
+  };
+
+  while (m_flip_pending)
+  {
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(m_card_fd, &fds);
+    int res = select(m_card_fd + 1, &fds, nullptr, nullptr, nullptr);
+    if (res < 0)
+    {
+      Log_ErrorPrintf("select() failed: %d", errno);
+      m_flip_pending = false;
+      break;
+    }
+    else if (res == 0)
+    {
+      continue;
+    }
+
+    drmHandleEvent(m_card_fd, &event_ctx);
+  }
+}
+
 bool DRMDisplay::GetCurrentMode(u32* width, u32* height, float* refresh_rate, int card, int connector)
 {
   int card_fd = -1;
@@ -37,17 +37,44 @@ public:
            (static_cast<float>(m_connector->modes[i].htotal) * static_cast<float>(m_connector->modes[i].vtotal));
   }
 
+  /// With atomic modesetting, flips are queued without blocking, and the buffer which was on screen before the
+  /// previously presented one can only be reused once that flip completes.
+  bool IsAtomic() const { return m_atomic; }
+
   std::optional<u32> AddBuffer(u32 width, u32 height, u32 format, u32 handle, u32 pitch, u32 offset);
   void RemoveBuffer(u32 fb_id);
   void PresentBuffer(u32 fb_id, bool wait_for_vsync);
 
+  /// Blocks until the last queued flip has been scanned out.
+  void WaitForPendingFlip();
+
 private:
   enum : u32
   {
     MAX_BUFFERS = 5
   };
 
+  struct AtomicProperties
+  {
+    u32 connector_crtc_id;
+    u32 crtc_mode_id;
+    u32 crtc_active;
+    u32 plane_fb_id;
+    u32 plane_crtc_id;
+    u32 plane_src_x;
+    u32 plane_src_y;
+    u32 plane_src_w;
+    u32 plane_src_h;
+    u32 plane_crtc_x;
+    u32 plane_crtc_y;
+    u32 plane_crtc_w;
+    u32 plane_crtc_h;
+  };
+
   bool TryOpeningCard(int card, u32 width, u32 height, float refresh_rate);
+  bool InitializeAtomic(const drmModeRes* resources);
+  void DestroyAtomic();
+  void PresentBufferAtomic(u32 fb_id);
 
   int m_card_id = 0;
   int m_card_fd = -1;
@@ -58,4 +85,11 @@ private:
   drmModeModeInfo* m_mode = nullptr;
 
   drmModeCrtc* m_prev_crtc = nullptr;
+
+  AtomicProperties m_atomic_properties = {};
+  u32 m_plane_id = 0;
+  u32 m_mode_blob_id = 0;
+  bool m_atomic = false;
+  bool m_atomic_modeset_done = false;
+  bool m_flip_pending = false;
 };
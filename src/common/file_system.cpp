@@ -20,6 +20,7 @@
 
 #if defined(_WIN32)
 #include "windows_headers.h"
+#include <io.h>
 #include <share.h>
 #include <shlobj.h>
 #include <winioctl.h>
@@ -28,6 +29,8 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <sys/file.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -711,6 +714,97 @@ s64 FileSystem::FSize64(std::FILE* fp)
   return -1;
 }
 
+bool FileSystem::LockCFile(std::FILE* fp)
+{
+#ifdef _WIN32
+  const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(fp)));
+  OVERLAPPED ov = {};
+  return (handle != INVALID_HANDLE_VALUE && LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &ov));
+#else
+  int res;
+  do
+  {
+    res = flock(fileno(fp), LOCK_EX);
+  } while (res != 0 && errno == EINTR);
+  return (res == 0);
+#endif
+}
+
+void FileSystem::UnlockCFile(std::FILE* fp)
+{
+#ifdef _WIN32
+  const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(fp)));
+  OVERLAPPED ov = {};
+  if (handle != INVALID_HANDLE_VALUE)
+    UnlockFileEx(handle, 0, MAXDWORD, MAXDWORD, &ov);
+#else
+  flock(fileno(fp), LOCK_UN);
+#endif
+}
+
+const void* FileSystem::MapCFile(std::FILE* fp, size_t size)
+{
+  if (size == 0)
+    return nullptr;
+
+#ifdef _WIN32
+  const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(fp)));
+  if (handle == INVALID_HANDLE_VALUE)
+    return nullptr;
+
+  const u64 size64 = static_cast<u64>(size);
+  const HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, static_cast<DWORD>(size64 >> 32),
+                                            static_cast<DWORD>(size64), nullptr);
+  if (!mapping)
+    return nullptr;
+
+  // the view holds a reference to the mapping object, so we don't need to keep the handle around
+  const void* ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+  CloseHandle(mapping);
+  return ptr;
+#else
+  void* ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fileno(fp), 0);
+  return (ptr != MAP_FAILED) ? ptr : nullptr;
+#endif
+}
+
+void* FileSystem::MapCFileCopyOnWrite(std::FILE* fp, size_t size)
+{
+  if (size == 0)
+    return nullptr;
+
+#ifdef _WIN32
+  const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(fp)));
+  if (handle == INVALID_HANDLE_VALUE)
+    return nullptr;
+
+  const u64 size64 = static_cast<u64>(size);
+  const HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_WRITECOPY, static_cast<DWORD>(size64 >> 32),
+                                            static_cast<DWORD>(size64), nullptr);
+  if (!mapping)
+    return nullptr;
+
+  void* ptr = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, size);
+  CloseHandle(mapping);
+  return ptr;
+#else
+  void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(fp), 0);
+  return (ptr != MAP_FAILED) ? ptr : nullptr;
+#endif
+}
+
+void FileSystem::UnmapCFile(const void* ptr, size_t size)
+{
+  if (!ptr)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(ptr);
+#else
+  munmap(const_cast<void*>(ptr), size);
+#endif
+}
+
 s64 FileSystem::GetPathFileSize(const char* Path)
 {
   FILESYSTEM_STAT_DATA sd;
@@ -92,6 +92,20 @@ int FSeek64(std::FILE* fp, s64 offset, int whence);
 s64 FTell64(std::FILE* fp);
 s64 FSize64(std::FILE* fp);
 
+/// Acquires an exclusive advisory lock on the whole of an open file, blocking until it is available.
+/// Other processes which lock the same file wait for UnlockCFile(), plain reads and writes are not affected.
+bool LockCFile(std::FILE* fp);
+void UnlockCFile(std::FILE* fp);
+
+/// Maps the first size bytes of an open file into memory for reading. The file must remain open while mapped.
+/// Returns nullptr on failure, or if size is zero.
+const void* MapCFile(std::FILE* fp, size_t size);
+void UnmapCFile(const void* ptr, size_t size);
+
+/// Maps the first size bytes of an open file copy-on-write. Pages which aren't written to stay shared with every other
+/// process mapping the same file, written pages become private and never reach the file. Release with UnmapCFile().
+void* MapCFileCopyOnWrite(std::FILE* fp, size_t size);
+
 int OpenFDFile(const char* filename, int flags, int mode);
 
 /// Sharing modes for OpenSharedCFile().
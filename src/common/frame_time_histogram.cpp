@@ -0,0 +1,57 @@
+#include "frame_time_histogram.h"
+#include "assert.h"
+#include <algorithm>
+#include <cmath>
+
+FrameTimeHistogram::FrameTimeHistogram(u32 window_size /*= DEFAULT_WINDOW_SIZE*/) : m_window(window_size)
+{
+  Assert(window_size > 0);
+}
+
+FrameTimeHistogram::~FrameTimeHistogram() = default;
+
+float FrameTimeHistogram::GetBucketTime(u32 bucket)
+{
+  return (static_cast<float>(bucket) + 0.5f) * BUCKET_WIDTH;
+}
+
+void FrameTimeHistogram::AddFrame(float time_ms)
+{
+  const float index = std::floor(time_ms / BUCKET_WIDTH);
+  const u16 bucket = (index > 0.0f) ? static_cast<u16>(std::min(index, static_cast<float>(NUM_BUCKETS - 1))) : 0;
+
+  if (m_sample_count == m_window.size())
+    m_buckets[m_window[m_window_position]]--;
+  else
+    m_sample_count++;
+
+  m_buckets[bucket]++;
+  m_window[m_window_position] = bucket;
+  m_window_position = (m_window_position + 1) % static_cast<u32>(m_window.size());
+}
+
+void FrameTimeHistogram::Reset()
+{
+  m_buckets.fill(0);
+  m_window_position = 0;
+  m_sample_count = 0;
+}
+
+float FrameTimeHistogram::GetPercentile(float fraction) const
+{
+  if (m_sample_count == 0)
+    return 0.0f;
+
+  // the smallest bucket in which at least the requested number of frames are at or below
+  const u32 target = std::clamp(static_cast<u32>(std::ceil(static_cast<float>(m_sample_count) * fraction)), 1u,
+                                m_sample_count);
+  u32 count = 0;
+  for (u32 i = 0; i < NUM_BUCKETS; i++)
+  {
+    count += m_buckets[i];
+    if (count >= target)
+      return GetBucketTime(i);
+  }
+
+  return GetBucketTime(NUM_BUCKETS - 1);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "types.h"
+#include <array>
+#include <vector>
+
+// Distribution of frame times over a sliding window of the most recent frames. Times are grouped into fixed width
+// buckets, so adding a frame is constant time, and percentiles are a scan over the buckets regardless of window size.
+class FrameTimeHistogram
+{
+public:
+  static constexpr float BUCKET_WIDTH = 0.1f; // milliseconds
+  static constexpr u32 NUM_BUCKETS = 1000;    // anything above 100ms is counted in the last bucket
+  static constexpr u32 DEFAULT_WINDOW_SIZE = 600;
+
+  FrameTimeHistogram(u32 window_size = DEFAULT_WINDOW_SIZE);
+  ~FrameTimeHistogram();
+
+  u32 GetWindowSize() const { return static_cast<u32>(m_window.size()); }
+  u32 GetSampleCount() const { return m_sample_count; }
+  const std::array<u32, NUM_BUCKETS>& GetBuckets() const { return m_buckets; }
+
+  /// Returns the frame time at the middle of the specified bucket, in milliseconds.
+  static float GetBucketTime(u32 bucket);
+
+  /// Adds a frame, removing the oldest frame first if the window is full.
+  void AddFrame(float time_ms);
+
+  /// Removes all frames from the window.
+  void Reset();
+
+  /// Returns the time which the specified fraction (0-1) of the frames in the window took no longer than, or zero if
+  /// no frames have been added. The result is accurate to the bucket width.
+  float GetPercentile(float fraction) const;
+  float GetMedian() const { return GetPercentile(0.5f); }
+
+private:
+  std::array<u32, NUM_BUCKETS> m_buckets = {};
+  std::vector<u16> m_window;
+  u32 m_window_position = 0;
+  u32 m_sample_count = 0;
+};
@@ -16,7 +16,6 @@ Log_SetChannel(GL::Context);
 #endif
 
 #ifdef USE_EGL
-#if defined(USE_WAYLAND) || defined(USE_GBM) || defined(USE_FBDEV) || defined(USE_X11)
 #if defined(USE_WAYLAND)
 #include "context_egl_wayland.h"
 #endif
@@ -29,10 +28,10 @@ Log_SetChannel(GL::Context);
 #if defined(USE_X11)
 #include "context_egl_x11.h"
 #endif
-#elif defined(ANDROID)
+#if defined(ANDROID)
 #include "context_egl_android.h"
 #else
-#error Unknown EGL platform
+#include "context_egl_surfaceless.h"
 #endif
 #endif
 
@@ -158,6 +157,11 @@ std::unique_ptr<GL::Context> Context::Create(const WindowInfo& wi, const Version
     context = ContextEGLFBDev::Create(wi, versions_to_try, num_versions_to_try);
 #endif
 
+#if defined(USE_EGL) && !defined(ANDROID)
+  if (!context && wi.type == WindowInfo::Type::Surfaceless)
+    context = ContextEGLSurfaceless::Create(wi, versions_to_try, num_versions_to_try);
+#endif
+
   if (!context)
     return nullptr;
 
@@ -18,7 +18,7 @@ ContextEGLGBM::~ContextEGLGBM()
 {
 #ifdef CONTEXT_EGL_GBM_USE_PRESENT_THREAD
   StopPresentThread();
-  Assert(!m_current_present_buffer);
+  Assert(!m_current_present_buffer && !m_queued_present_buffer);
 #endif
 
   m_drm_display.RestoreBuffer();
@@ -260,20 +260,39 @@ void ContextEGLGBM::PresentThread()
       continue;
 
     Buffer* next_buffer = LockFrontBuffer();
-    const bool wait_for_vsync = m_vsync && m_current_present_buffer;
+    const bool wait_for_vsync = m_vsync && (m_current_present_buffer || m_queued_present_buffer);
 
     lock.unlock();
     PresentBuffer(next_buffer, wait_for_vsync);
     lock.lock();
 
-    if (m_current_present_buffer)
-      ReleaseBuffer(m_current_present_buffer);
+    if (m_drm_display.IsAtomic())
+    {
+      // the flip is only queued, but presenting waited for the previous one, so the buffer before that is free
+      if (m_current_present_buffer)
+        ReleaseBuffer(m_current_present_buffer);
+
+      m_current_present_buffer = m_queued_present_buffer;
+      m_queued_present_buffer = next_buffer;
+    }
+    else
+    {
+      if (m_current_present_buffer)
+        ReleaseBuffer(m_current_present_buffer);
+
+      m_current_present_buffer = next_buffer;
+    }
 
-    m_current_present_buffer = next_buffer;
     m_present_pending.store(false);
     m_present_done_cv.notify_one();
   }
 
+  m_drm_display.WaitForPendingFlip();
+  if (m_queued_present_buffer)
+  {
+    ReleaseBuffer(m_queued_present_buffer);
+    m_queued_present_buffer = nullptr;
+  }
   if (m_current_present_buffer)
   {
     ReleaseBuffer(m_current_present_buffer);
@@ -69,6 +69,7 @@ private:
   std::condition_variable m_present_done_cv;
 
   Buffer* m_current_present_buffer = nullptr;
+  Buffer* m_queued_present_buffer = nullptr; // flip submitted but not yet on screen, atomic only
 #endif
 
   u32 m_num_buffers = 0;
@@ -0,0 +1,134 @@
+#include "context_egl_surfaceless.h"
+#include "../log.h"
+#include "../string.h"
+#include <cstring>
+#ifdef USE_GBM
+#include <cerrno>
+#include <fcntl.h>
+#include <gbm.h>
+#include <unistd.h>
+#endif
+Log_SetChannel(GL::ContextEGLSurfaceless);
+
+namespace GL {
+ContextEGLSurfaceless::ContextEGLSurfaceless(const WindowInfo& wi) : ContextEGL(wi) {}
+
+ContextEGLSurfaceless::~ContextEGLSurfaceless()
+{
+#ifdef USE_GBM
+  // Context has to go before the device it was created on.
+  DestroySurface();
+  DestroyContext();
+
+  if (m_gbm_device)
+    gbm_device_destroy(m_gbm_device);
+  if (m_render_node_fd >= 0)
+    close(m_render_node_fd);
+#endif
+}
+
+std::unique_ptr<Context> ContextEGLSurfaceless::Create(const WindowInfo& wi, const Version* versions_to_try,
+                                                       size_t num_versions_to_try)
+{
+  std::unique_ptr<ContextEGLSurfaceless> context = std::make_unique<ContextEGLSurfaceless>(wi);
+  if (!context->Initialize(versions_to_try, num_versions_to_try))
+    return nullptr;
+
+  return context;
+}
+
+std::unique_ptr<Context> ContextEGLSurfaceless::CreateSharedContext(const WindowInfo& wi)
+{
+  std::unique_ptr<ContextEGLSurfaceless> context = std::make_unique<ContextEGLSurfaceless>(wi);
+  context->m_display = m_display;
+
+  if (!context->CreateContextAndSurface(m_version, m_context, false))
+    return nullptr;
+
+  return context;
+}
+
+bool ContextEGLSurfaceless::SwapBuffers()
+{
+  // nothing to present to
+  return true;
+}
+
+bool ContextEGLSurfaceless::SetSwapInterval(s32 interval)
+{
+  return true;
+}
+
+bool ContextEGLSurfaceless::SetDisplay()
+{
+  // client extensions are queried without a display
+  const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  if (eglGetPlatformDisplayEXT && client_extensions &&
+      std::strstr(client_extensions, "EGL_MESA_platform_surfaceless"))
+  {
+    m_display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (m_display != EGL_NO_DISPLAY)
+    {
+      Log_InfoPrint("Using Mesa surfaceless platform");
+      return true;
+    }
+
+    Log_WarningPrintf("eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA) failed: %d", eglGetError());
+  }
+
+#ifdef USE_GBM
+  if (eglGetPlatformDisplayEXT && CreateRenderNodeDevice())
+  {
+    m_display = eglGetPlatformDisplayEXT(EGL_PLATFORM_GBM_KHR, m_gbm_device, nullptr);
+    if (m_display != EGL_NO_DISPLAY)
+      return true;
+
+    Log_WarningPrintf("eglGetPlatformDisplayEXT(EGL_PLATFORM_GBM_KHR) failed: %d", eglGetError());
+  }
+#endif
+
+  // last resort, some drivers (e.g. NVIDIA) give a usable default display without any window system
+  m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (m_display == EGL_NO_DISPLAY)
+  {
+    Log_ErrorPrintf("eglGetDisplay(EGL_DEFAULT_DISPLAY) failed: %d", eglGetError());
+    return false;
+  }
+
+  return true;
+}
+
+#ifdef USE_GBM
+
+bool ContextEGLSurfaceless::CreateRenderNodeDevice()
+{
+  // render nodes don't need the DRM master, so this works alongside a running desktop, or on a server with no outputs
+  static constexpr int FIRST_RENDER_NODE = 128;
+  static constexpr int NUM_RENDER_NODES = 16;
+  for (int i = FIRST_RENDER_NODE; i < (FIRST_RENDER_NODE + NUM_RENDER_NODES); i++)
+  {
+    const TinyString path(TinyString::FromFormat("/dev/dri/renderD%d", i));
+    const int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0)
+      continue;
+
+    m_gbm_device = gbm_create_device(fd);
+    if (!m_gbm_device)
+    {
+      Log_WarningPrintf("gbm_create_device(%s) failed: %d", path.GetCharArray(), errno);
+      close(fd);
+      continue;
+    }
+
+    Log_InfoPrintf("Using render node %s", path.GetCharArray());
+    m_render_node_fd = fd;
+    return true;
+  }
+
+  Log_ErrorPrint("No usable DRM render nodes found");
+  return false;
+}
+
+#endif
+
+} // namespace GL
@@ -0,0 +1,35 @@
+#pragma once
+#include "context_egl.h"
+
+struct gbm_device;
+
+namespace GL {
+
+/// Headless context for running without a window system, e.g. on servers. Rendering only goes to framebuffer objects.
+/// Uses the Mesa surfaceless platform when available, otherwise a GBM device on a DRM render node.
+class ContextEGLSurfaceless final : public ContextEGL
+{
+public:
+  ContextEGLSurfaceless(const WindowInfo& wi);
+  ~ContextEGLSurfaceless() override;
+
+  static std::unique_ptr<Context> Create(const WindowInfo& wi, const Version* versions_to_try,
+                                         size_t num_versions_to_try);
+
+  std::unique_ptr<Context> CreateSharedContext(const WindowInfo& wi) override;
+  bool SwapBuffers() override;
+  bool SetSwapInterval(s32 interval) override;
+
+protected:
+  bool SetDisplay() override;
+
+private:
+#ifdef USE_GBM
+  bool CreateRenderNodeDevice();
+
+  int m_render_node_fd = -1;
+  struct gbm_device* m_gbm_device = nullptr;
+#endif
+};
+
+} // namespace GL
@@ -4,6 +4,14 @@
 #include "../md5_digest.h"
 #include "../path.h"
 #include "../string_util.h"
+#include "../threading.h"
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <thread>
 Log_SetChannel(GL::ShaderCache);
 
 namespace GL {
@@ -23,9 +31,107 @@ struct CacheIndexEntry
   u32 file_offset;
   u32 blob_size;
   u32 blob_format;
+  u32 last_used;
 };
 #pragma pack(pop)
 
+namespace {
+// Compactions outlive the cache object, which is usually only open while programs are being compiled.
+struct CompactionState
+{
+  std::thread thread;
+  std::atomic_bool running{false};
+  std::atomic_bool cancel{false};
+
+  ~CompactionState()
+  {
+    cancel.store(true);
+    if (thread.joinable())
+      thread.join();
+  }
+};
+} // namespace
+
+static CompactionState s_compaction;
+
+static u32 GetCurrentTimestamp()
+{
+  return static_cast<u32>(std::time(nullptr));
+}
+
+static bool WriteIndexHeader(std::FILE* fp, u32 file_version, u32 data_version, const std::array<u8, 16>& driver_hash)
+{
+  return (std::fwrite(&file_version, sizeof(file_version), 1, fp) == 1 &&
+          std::fwrite(&data_version, sizeof(data_version), 1, fp) == 1 &&
+          std::fwrite(driver_hash.data(), driver_hash.size(), 1, fp) == 1 && std::fflush(fp) == 0);
+}
+
+static bool WriteCompactedFiles(const std::string& index_filename, const std::string& blob_filename,
+                                const std::string& new_index_filename, const std::string& new_blob_filename,
+                                u32 file_version, u32 data_version, const std::array<u8, 16>& driver_hash,
+                                std::vector<CacheIndexEntry>& entries)
+{
+  auto src_blob = FileSystem::OpenManagedCFile(blob_filename.c_str(), "rb");
+  auto dst_index = FileSystem::OpenManagedCFile(new_index_filename.c_str(), "wb");
+  auto dst_blob = FileSystem::OpenManagedCFile(new_blob_filename.c_str(), "wb");
+  if (!src_blob || !dst_index || !dst_blob ||
+      !WriteIndexHeader(dst_index.get(), file_version, data_version, driver_hash))
+  {
+    return false;
+  }
+
+  // copy in file order, so the source is read sequentially
+  std::sort(entries.begin(), entries.end(),
+            [](const CacheIndexEntry& lhs, const CacheIndexEntry& rhs) { return lhs.file_offset < rhs.file_offset; });
+
+  std::vector<u8> blob;
+  u32 dst_offset = 0;
+  for (CacheIndexEntry& entry : entries)
+  {
+    if (s_compaction.cancel.load())
+      return false;
+
+    blob.resize(entry.blob_size);
+    if (std::fseek(src_blob.get(), entry.file_offset, SEEK_SET) != 0 ||
+        std::fread(blob.data(), 1, entry.blob_size, src_blob.get()) != entry.blob_size ||
+        std::fwrite(blob.data(), 1, entry.blob_size, dst_blob.get()) != entry.blob_size)
+    {
+      return false;
+    }
+
+    entry.file_offset = dst_offset;
+    dst_offset += entry.blob_size;
+    if (std::fwrite(&entry, sizeof(entry), 1, dst_index.get()) != 1)
+      return false;
+  }
+
+  return (std::fflush(dst_blob.get()) == 0 && std::fflush(dst_index.get()) == 0);
+}
+
+static void CompactCacheFiles(std::string index_filename, std::string blob_filename, u32 file_version,
+                              u32 data_version, std::array<u8, 16> driver_hash, std::vector<CacheIndexEntry> entries)
+{
+  Threading::SetNameOfCurrentThread("Shader Cache Compaction");
+
+  const std::string new_index_filename = index_filename + ".new";
+  const std::string new_blob_filename = blob_filename + ".new";
+  if (WriteCompactedFiles(index_filename, blob_filename, new_index_filename, new_blob_filename, file_version,
+                          data_version, driver_hash, entries))
+  {
+    // the index goes last, so a partial rename is never picked up
+    FileSystem::RenamePath(new_blob_filename.c_str(), (blob_filename + ".compact").c_str());
+    FileSystem::RenamePath(new_index_filename.c_str(), (index_filename + ".compact").c_str());
+    Log_InfoPrintf("Shader cache compacted to %zu programs", entries.size());
+  }
+  else
+  {
+    FileSystem::DeleteFile(new_index_filename.c_str());
+    FileSystem::DeleteFile(new_blob_filename.c_str());
+  }
+
+  s_compaction.running.store(false);
+}
+
 ShaderCache::ShaderCache() = default;
 
 ShaderCache::~ShaderCache()
@@ -53,7 +159,7 @@ bool ShaderCache::CacheIndexKey::operator!=(const CacheIndexKey& key) const
     fragment_source_hash_high != key.fragment_source_hash_high || fragment_source_length != key.fragment_source_length);
 }
 
-void ShaderCache::Open(bool is_gles, std::string_view base_path, u32 version)
+void ShaderCache::Open(bool is_gles, std::string_view base_path, u32 version, u64 max_size /* = 0 */)
 {
   m_base_path = base_path;
   m_version = version;
@@ -78,10 +184,111 @@ void ShaderCache::Open(bool is_gles, std::string_view base_path, u32 version)
   {
     const std::string index_filename = GetIndexFileName();
     const std::string blob_filename = GetBlobFileName();
+    m_driver_hash = GetDriverHash();
+    ApplyCompactedFiles(index_filename, blob_filename);
 
     if (!ReadExisting(index_filename, blob_filename))
+    {
       CreateNew(index_filename, blob_filename);
+    }
+    else if (max_size > 0)
+    {
+      const s64 blob_size = FileSystem::FSize64(m_blob_file);
+      if (blob_size > 0 && static_cast<u64>(blob_size) > max_size)
+        StartCompaction(max_size);
+    }
+  }
+}
+
+std::array<u8, 16> ShaderCache::GetDriverHash()
+{
+  std::array<u8, 16> hash;
+  MD5Digest digest;
+  for (const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+  {
+    const char* str = reinterpret_cast<const char*>(glGetString(name));
+    if (str)
+      digest.Update(str, static_cast<u32>(std::strlen(str)));
+  }
+  digest.Final(hash.data());
+  return hash;
+}
+
+void ShaderCache::ApplyCompactedFiles(const std::string& index_filename, const std::string& blob_filename)
+{
+  // still being written, it'll be picked up next time
+  if (s_compaction.running.load())
+    return;
+
+  const std::string compact_index_filename = index_filename + ".compact";
+  const std::string compact_blob_filename = blob_filename + ".compact";
+  if (!FileSystem::FileExists(compact_index_filename.c_str()) ||
+      !FileSystem::FileExists(compact_blob_filename.c_str()))
+  {
+    FileSystem::DeleteFile(compact_index_filename.c_str());
+    FileSystem::DeleteFile(compact_blob_filename.c_str());
+    return;
+  }
+
+  // The old index is removed first, so if anything fails part way, it can't point into the new blob file.
+  if (!FileSystem::DeleteFile(index_filename.c_str()) ||
+      !FileSystem::RenamePath(compact_blob_filename.c_str(), blob_filename.c_str()) ||
+      !FileSystem::RenamePath(compact_index_filename.c_str(), index_filename.c_str()))
+  {
+    Log_WarningPrintf("Failed to replace shader cache with compacted copy, another instance may be using it");
+    FileSystem::DeleteFile(compact_index_filename.c_str());
+    FileSystem::DeleteFile(compact_blob_filename.c_str());
+    return;
+  }
+
+  Log_InfoPrintf("Replaced shader cache with compacted copy");
+}
+
+void ShaderCache::StartCompaction(u64 max_size)
+{
+  if (s_compaction.running.load())
+    return;
+  if (s_compaction.thread.joinable())
+    s_compaction.thread.join();
+
+  std::vector<CacheIndexEntry> entries;
+  entries.reserve(m_index.size());
+  for (const auto& [key, data] : m_index)
+  {
+    CacheIndexEntry entry = {};
+    entry.vertex_source_hash_low = key.vertex_source_hash_low;
+    entry.vertex_source_hash_high = key.vertex_source_hash_high;
+    entry.vertex_source_length = key.vertex_source_length;
+    entry.geometry_source_hash_low = key.geometry_source_hash_low;
+    entry.geometry_source_hash_high = key.geometry_source_hash_high;
+    entry.geometry_source_length = key.geometry_source_length;
+    entry.fragment_source_hash_low = key.fragment_source_hash_low;
+    entry.fragment_source_hash_high = key.fragment_source_hash_high;
+    entry.fragment_source_length = key.fragment_source_length;
+    entry.file_offset = data.file_offset;
+    entry.blob_size = data.blob_size;
+    entry.blob_format = data.blob_format;
+    entry.last_used = data.last_used;
+    entries.push_back(entry);
   }
+
+  // leave some room, so it isn't compacted again straight away
+  const u64 target_size = max_size / 4 * 3;
+  std::sort(entries.begin(), entries.end(),
+            [](const CacheIndexEntry& lhs, const CacheIndexEntry& rhs) { return lhs.last_used > rhs.last_used; });
+  u64 kept_size = 0;
+  size_t num_kept = 0;
+  for (; num_kept < entries.size() && (kept_size + entries[num_kept].blob_size) <= target_size; num_kept++)
+    kept_size += entries[num_kept].blob_size;
+
+  Log_InfoPrintf("Shader cache is over %" PRIu64 " bytes, keeping %zu of %zu programs (%" PRIu64 " bytes)", max_size,
+                 num_kept, entries.size(), kept_size);
+  entries.resize(num_kept);
+
+  s_compaction.cancel.store(false);
+  s_compaction.running.store(true);
+  s_compaction.thread = std::thread(CompactCacheFiles, GetIndexFileName(), GetBlobFileName(), FILE_VERSION, m_version,
+                                    m_driver_hash, std::move(entries));
 }
 
 bool ShaderCache::CreateNew(const std::string& index_filename, const std::string& blob_filename)
@@ -104,9 +311,7 @@ bool ShaderCache::CreateNew(const std::string& index_filename, const std::string
     return false;
   }
 
-  const u32 index_version = FILE_VERSION;
-  if (std::fwrite(&index_version, sizeof(index_version), 1, m_index_file) != 1 ||
-      std::fwrite(&m_version, sizeof(m_version), 1, m_index_file) != 1)
+  if (!WriteIndexHeader(m_index_file, FILE_VERSION, m_version, m_driver_hash))
   {
     Log_ErrorPrintf("Failed to write version to index file '%s'", index_filename.c_str());
     std::fclose(m_index_file);
@@ -125,6 +330,7 @@ bool ShaderCache::CreateNew(const std::string& index_filename, const std::string
     return false;
   }
 
+  m_index_read_position = static_cast<u32>(std::ftell(m_index_file));
   return true;
 }
 
@@ -145,6 +351,15 @@ bool ShaderCache::ReadExisting(const std::string& index_filename, const std::str
     return false;
   }
 
+  std::array<u8, 16> driver_hash;
+  if (std::fread(driver_hash.data(), driver_hash.size(), 1, m_index_file) != 1 || driver_hash != m_driver_hash)
+  {
+    Log_WarningPrintf("Driver changed since '%s' was written, discarding it", index_filename.c_str());
+    std::fclose(m_index_file);
+    m_index_file = nullptr;
+    return false;
+  }
+
   m_blob_file = FileSystem::OpenCFile(blob_filename.c_str(), "a+b");
   if (!m_blob_file)
   {
@@ -154,46 +369,128 @@ bool ShaderCache::ReadExisting(const std::string& index_filename, const std::str
     return false;
   }
 
-  std::fseek(m_blob_file, 0, SEEK_END);
-  const u32 blob_file_size = static_cast<u32>(std::ftell(m_blob_file));
+  m_index_read_position = static_cast<u32>(std::ftell(m_index_file));
+  if (!RefreshIndex())
+  {
+    Log_ErrorPrintf("Failed to read entry from '%s', corrupt file?", index_filename.c_str());
+    m_index.clear();
+    std::fclose(m_blob_file);
+    m_blob_file = nullptr;
+    std::fclose(m_index_file);
+    m_index_file = nullptr;
+    return false;
+  }
 
+  Log_InfoPrintf("Read %zu entries from '%s'", m_index.size(), index_filename.c_str());
+  return true;
+}
+
+bool ShaderCache::ReadIndexEntries()
+{
+  if (std::fseek(m_index_file, m_index_read_position, SEEK_SET) != 0 || std::fseek(m_blob_file, 0, SEEK_END) != 0)
+    return false;
+
+  const u32 blob_file_size = static_cast<u32>(std::ftell(m_blob_file));
+  bool result = true;
   for (;;)
   {
     CacheIndexEntry entry;
     if (std::fread(&entry, sizeof(entry), 1, m_index_file) != 1 ||
         (entry.file_offset + entry.blob_size) > blob_file_size)
     {
-      if (std::feof(m_index_file))
-        break;
-
-      Log_ErrorPrintf("Failed to read entry from '%s', corrupt file?", index_filename.c_str());
-      m_index.clear();
-      std::fclose(m_blob_file);
-      m_blob_file = nullptr;
-      std::fclose(m_index_file);
-      m_index_file = nullptr;
-      return false;
+      result = std::feof(m_index_file);
+      break;
     }
 
     const CacheIndexKey key{
       entry.vertex_source_hash_low,   entry.vertex_source_hash_high,   entry.vertex_source_length,
       entry.geometry_source_hash_low, entry.geometry_source_hash_high, entry.geometry_source_length,
       entry.fragment_source_hash_low, entry.fragment_source_hash_high, entry.fragment_source_length};
-    const CacheIndexData data{entry.file_offset, entry.blob_size, entry.blob_format};
+    const CacheIndexData data{entry.file_offset, entry.blob_size, entry.blob_format, entry.last_used,
+                              m_index_read_position};
     m_index.emplace(key, data);
+    m_index_read_position += sizeof(entry);
   }
 
-  Log_InfoPrintf("Read %zu entries from '%s'", m_index.size(), index_filename.c_str());
-  return true;
+  // ensure we don't write before seeking
+  std::fseek(m_index_file, 0, SEEK_END);
+  return result;
+}
+
+bool ShaderCache::RefreshIndex()
+{
+  if (!m_index_file || !m_blob_file || !FileSystem::LockCFile(m_index_file))
+    return false;
+
+  const bool result = ReadIndexEntries();
+  FileSystem::UnlockCFile(m_index_file);
+  return result;
+}
+
+void ShaderCache::UpdateLastUsed(CacheIndexData& data)
+{
+  const u32 now = GetCurrentTimestamp();
+  if ((now - data.last_used) < LAST_USED_UPDATE_INTERVAL || !FileSystem::LockCFile(m_index_file))
+    return;
+
+  // this is the only field of an entry which is ever rewritten
+  if (std::fseek(m_index_file, data.index_offset + offsetof(CacheIndexEntry, last_used), SEEK_SET) == 0 &&
+      std::fwrite(&now, sizeof(now), 1, m_index_file) == 1)
+  {
+    std::fflush(m_index_file);
+  }
+
+  std::fseek(m_index_file, 0, SEEK_END);
+  FileSystem::UnlockCFile(m_index_file);
+  data.last_used = now;
 }
 
 void ShaderCache::Close()
 {
   m_index.clear();
+  m_index_read_position = 0;
   if (m_index_file)
+  {
     std::fclose(m_index_file);
+    m_index_file = nullptr;
+  }
+  UnmapBlobFile();
   if (m_blob_file)
+  {
     std::fclose(m_blob_file);
+    m_blob_file = nullptr;
+  }
+}
+
+const u8* ShaderCache::GetMappedBlob(u32 file_offset, u32 size)
+{
+  if ((static_cast<u64>(file_offset) + size) > m_blob_file_map_size)
+  {
+    // entries are only ever appended, so map whatever is in the file now to cover any written since
+    UnmapBlobFile();
+
+    const s64 file_size = FileSystem::FSize64(m_blob_file);
+    if (file_size <= 0 || (static_cast<u64>(file_offset) + size) > static_cast<u64>(file_size))
+      return nullptr;
+
+    m_blob_file_map = static_cast<const u8*>(FileSystem::MapCFile(m_blob_file, static_cast<size_t>(file_size)));
+    if (!m_blob_file_map)
+    {
+      Log_WarningPrintf("Failed to map blob file, falling back to reads");
+      return nullptr;
+    }
+
+    m_blob_file_map_size = static_cast<u32>(file_size);
+  }
+
+  return m_blob_file_map + file_offset;
+}
+
+void ShaderCache::UnmapBlobFile()
+{
+  FileSystem::UnmapCFile(m_blob_file_map, m_blob_file_map_size);
+  m_blob_file_map = nullptr;
+  m_blob_file_map_size = 0;
 }
 
 bool ShaderCache::Recreate()
@@ -270,19 +567,34 @@ std::optional<Program> ShaderCache::GetProgram(const std::string_view vertex_sha
   const auto key = GetCacheKey(vertex_shader, geometry_shader, fragment_shader);
   auto iter = m_index.find(key);
   if (iter == m_index.end())
-    return CompileAndAddProgram(key, vertex_shader, geometry_shader, fragment_shader, callback);
+  {
+    // another instance sharing the cache may have compiled it since we last looked
+    if (!RefreshIndex() || (iter = m_index.find(key)) == m_index.end())
+      return CompileAndAddProgram(key, vertex_shader, geometry_shader, fragment_shader, callback);
+  }
 
-  std::vector<u8> data(iter->second.blob_size);
-  if (std::fseek(m_blob_file, iter->second.file_offset, SEEK_SET) != 0 ||
-      std::fread(data.data(), 1, iter->second.blob_size, m_blob_file) != iter->second.blob_size)
+  // read the binary out of the file only if it can't be mapped
+  std::vector<u8> data;
+  const u8* blob = GetMappedBlob(iter->second.file_offset, iter->second.blob_size);
+  if (!blob)
   {
-    Log_ErrorPrintf("Read blob from file failed");
-    return {};
+    data.resize(iter->second.blob_size);
+    if (std::fseek(m_blob_file, iter->second.file_offset, SEEK_SET) != 0 ||
+        std::fread(data.data(), 1, iter->second.blob_size, m_blob_file) != iter->second.blob_size)
+    {
+      Log_ErrorPrintf("Read blob from file failed");
+      return {};
+    }
+
+    blob = data.data();
   }
 
   Program prog;
-  if (prog.CreateFromBinary(data.data(), static_cast<u32>(data.size()), iter->second.blob_format))
+  if (prog.CreateFromBinary(blob, iter->second.blob_size, iter->second.blob_format))
+  {
+    UpdateLastUsed(iter->second);
     return std::optional<Program>(std::move(prog));
+  }
 
   Log_WarningPrintf(
     "Failed to create program from binary, this may be due to a driver or GPU Change. Recreating cache.");
@@ -328,13 +640,23 @@ std::optional<Program> ShaderCache::CompileAndAddProgram(const CacheIndexKey& ke
   if (!prog->GetBinary(&prog_data, &prog_format))
     return std::nullopt;
 
-  if (!m_blob_file || std::fseek(m_blob_file, 0, SEEK_END) != 0)
+  if (!m_blob_file || !FileSystem::LockCFile(m_index_file))
     return prog;
 
+  // Other instances append to the same files while holding the lock. Pick up their entries first, so that the
+  // offsets we write are correct and we don't add a duplicate if one of them compiled this program in the meantime.
+  if (!ReadIndexEntries() || m_index.find(key) != m_index.end() || std::fseek(m_blob_file, 0, SEEK_END) != 0)
+  {
+    FileSystem::UnlockCFile(m_index_file);
+    return prog;
+  }
+
   CacheIndexData data;
   data.file_offset = static_cast<u32>(std::ftell(m_blob_file));
   data.blob_size = static_cast<u32>(prog_data.size());
   data.blob_format = prog_format;
+  data.last_used = GetCurrentTimestamp();
+  data.index_offset = static_cast<u32>(std::ftell(m_index_file));
 
   CacheIndexEntry entry = {};
   entry.vertex_source_hash_low = key.vertex_source_hash_low;
@@ -349,16 +671,20 @@ std::optional<Program> ShaderCache::CompileAndAddProgram(const CacheIndexKey& ke
   entry.file_offset = data.file_offset;
   entry.blob_size = data.blob_size;
   entry.blob_format = data.blob_format;
+  entry.last_used = data.last_used;
 
   if (std::fwrite(prog_data.data(), 1, entry.blob_size, m_blob_file) != entry.blob_size ||
       std::fflush(m_blob_file) != 0 || std::fwrite(&entry, sizeof(entry), 1, m_index_file) != 1 ||
       std::fflush(m_index_file) != 0)
   {
     Log_ErrorPrintf("Failed to write shader blob to file");
+    FileSystem::UnlockCFile(m_index_file);
     return prog;
   }
 
   m_index.emplace(key, data);
+  m_index_read_position += sizeof(entry);
+  FileSystem::UnlockCFile(m_index_file);
   return prog;
 }
 
@@ -2,6 +2,7 @@
 #include "../hash_combine.h"
 #include "../types.h"
 #include "program.h"
+#include <array>
 #include <cstdio>
 #include <functional>
 #include <optional>
@@ -20,13 +21,18 @@ public:
   ShaderCache();
   ~ShaderCache();
 
-  void Open(bool is_gles, std::string_view base_path, u32 version);
+  /// Programs which haven't been used recently are dropped in the background once the blob file grows past
+  /// max_size, which can be zero for no limit.
+  void Open(bool is_gles, std::string_view base_path, u32 version, u64 max_size = 0);
 
   std::optional<Program> GetProgram(const std::string_view vertex_shader, const std::string_view geometry_shader,
                                     const std::string_view fragment_shader, const PreLinkCallback& callback = {});
 
 private:
-  static constexpr u32 FILE_VERSION = 3;
+  static constexpr u32 FILE_VERSION = 4;
+
+  // the last-used time of an entry is only rewritten when it's at least this old, in seconds
+  static constexpr u32 LAST_USED_UPDATE_INTERVAL = 24 * 60 * 60;
 
   struct CacheIndexKey
   {
@@ -61,6 +67,8 @@ private:
     u32 file_offset;
     u32 blob_size;
     u32 blob_format;
+    u32 last_used;
+    u32 index_offset;
   };
 
   using CacheIndex = std::unordered_map<CacheIndexKey, CacheIndexData, CacheIndexEntryHasher>;
@@ -68,6 +76,9 @@ private:
   static CacheIndexKey GetCacheKey(const std::string_view& vertex_shader, const std::string_view& geometry_shader,
                                    const std::string_view& fragment_shader);
 
+  /// Hash of the driver's vendor, renderer and version strings, binaries from any other driver are thrown away.
+  static std::array<u8, 16> GetDriverHash();
+
   std::string GetIndexFileName() const;
   std::string GetBlobFileName() const;
 
@@ -76,6 +87,28 @@ private:
   void Close();
   bool Recreate();
 
+  /// Reads entries which were appended to the index since it was last read, e.g. by another process sharing the
+  /// cache. The index file should be locked.
+  bool ReadIndexEntries();
+
+  /// Locks the index and picks up any new entries.
+  bool RefreshIndex();
+
+  /// Records that a program was just used, if the last time was long enough ago to be worth a write.
+  void UpdateLastUsed(CacheIndexData& data);
+
+  /// Replaces the cache files with the output of a finished compaction, if there is one.
+  void ApplyCompactedFiles(const std::string& index_filename, const std::string& blob_filename);
+
+  /// Starts writing a copy of the cache which only has the most recently used programs, up to three quarters of
+  /// max_size. It's swapped in the next time the cache is opened.
+  void StartCompaction(u64 max_size);
+
+  /// Returns a pointer to a blob in the memory-mapped blob file, remapping it if the blob was appended since the
+  /// file was last mapped. Returns nullptr if the file could not be mapped.
+  const u8* GetMappedBlob(u32 file_offset, u32 size);
+  void UnmapBlobFile();
+
   std::optional<Program> CompileProgram(const std::string_view& vertex_shader, const std::string_view& geometry_shader,
                                         const std::string_view& fragment_shader, const PreLinkCallback& callback,
                                         bool set_retrievable);
@@ -86,9 +119,13 @@ private:
   std::string m_base_path;
   std::FILE* m_index_file = nullptr;
   std::FILE* m_blob_file = nullptr;
+  u32 m_index_read_position = 0;
+  const u8* m_blob_file_map = nullptr;
+  u32 m_blob_file_map_size = 0;
 
   CacheIndex m_index;
   u32 m_version = 0;
+  std::array<u8, 16> m_driver_hash = {};
   bool m_program_binary_supported = false;
 };
 
@@ -1,8 +1,10 @@
 #include "stream_buffer.h"
 #include "../align.h"
 #include "../assert.h"
+#include "../log.h"
 #include <array>
 #include <cstdio>
+Log_SetChannel(GL::StreamBuffer);
 
 namespace GL {
 
@@ -283,6 +285,68 @@ private:
   bool m_coherent;
 };
 
+// Uses glMapBufferRange() without synchronization, and fences to avoid overwriting data which the GPU hasn't used yet.
+// Used when buffer storage isn't available, so the driver doesn't have to copy or orphan the buffer.
+class MapAndSyncStreamBuffer final : public SyncingStreamBuffer
+{
+public:
+  ~MapAndSyncStreamBuffer() override = default;
+
+  MappingResult Map(u32 alignment, u32 min_size) override
+  {
+    if (m_position > 0)
+      m_position = Common::AlignUp(m_position, alignment);
+
+    AllocateSpace(min_size);
+    DebugAssert((m_position + min_size) <= (m_available_block_index * m_bytes_per_block));
+
+    const u32 free_space_in_block =
+      std::min<u32>((m_available_block_index * m_bytes_per_block), m_size) - m_position;
+
+    glBindBuffer(m_target, m_buffer_id);
+    void* mapped_ptr = glMapBufferRange(m_target, m_position, free_space_in_block,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                                          GL_MAP_FLUSH_EXPLICIT_BIT);
+    Assert(mapped_ptr);
+
+    return MappingResult{mapped_ptr, m_position, m_position / alignment, free_space_in_block / alignment};
+  }
+
+  void Unmap(u32 used_size) override
+  {
+    DebugAssert((m_position + used_size) <= m_size);
+
+    glBindBuffer(m_target, m_buffer_id);
+    if (used_size > 0)
+      glFlushMappedBufferRange(m_target, 0, used_size);
+    glUnmapBuffer(m_target);
+
+    m_position += used_size;
+  }
+
+  static std::unique_ptr<StreamBuffer> Create(GLenum target, u32 size)
+  {
+    glGetError();
+
+    GLuint buffer_id;
+    glGenBuffers(1, &buffer_id);
+    glBindBuffer(target, buffer_id);
+    glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+
+    GLenum err = glGetError();
+    if (err != GL_NO_ERROR)
+    {
+      glDeleteBuffers(1, &buffer_id);
+      return {};
+    }
+
+    return std::unique_ptr<StreamBuffer>(new MapAndSyncStreamBuffer(target, buffer_id, size));
+  }
+
+private:
+  MapAndSyncStreamBuffer(GLenum target, GLuint buffer_id, u32 size) : SyncingStreamBuffer(target, buffer_id, size) {}
+};
+
 } // namespace detail
 
 std::unique_ptr<StreamBuffer> StreamBuffer::Create(GLenum target, u32 size)
@@ -292,9 +356,27 @@ std::unique_ptr<StreamBuffer> StreamBuffer::Create(GLenum target, u32 size)
   {
     buf = detail::BufferStorageStreamBuffer::Create(target, size);
     if (buf)
+    {
+      Log_InfoPrintf("Using persistent mapped buffer storage for %u KB stream buffer (target 0x%04X)", size / 1024,
+                     target);
+      return buf;
+    }
+  }
+
+  // Fences and unsynchronized mapping are core in GL 3.2/GLES 3.0.
+  if (GLAD_GL_VERSION_3_2 || GLAD_GL_ES_VERSION_3_0 || (GLAD_GL_VERSION_3_0 && GLAD_GL_ARB_sync))
+  {
+    buf = detail::MapAndSyncStreamBuffer::Create(target, size);
+    if (buf)
+    {
+      Log_InfoPrintf("Using unsynchronized mapping with fences for %u KB stream buffer (target 0x%04X)", size / 1024,
+                     target);
       return buf;
+    }
   }
 
+  Log_InfoPrintf("Using glBufferData() orphaning for %u KB stream buffer (target 0x%04X)", size / 1024, target);
+
   // BufferSubData is slower on all drivers except NVIDIA...
 #if 0
   const char* vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
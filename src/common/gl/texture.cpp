@@ -17,6 +17,7 @@ const std::tuple<GLenum, GLenum, GLenum>& GL::Texture::GetPixelFormatMapping(GPU
       {GL_RGB5_A1, GL_BGRA, GL_UNSIGNED_SHORT_1_5_5_5_REV}, // RGBA5551
       {GL_R8, GL_RED, GL_UNSIGNED_BYTE},                    // R8
       {GL_DEPTH_COMPONENT16, GL_DEPTH_COMPONENT, GL_SHORT}, // D16
+      {GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT}, // D32F
     }};
 
   static constexpr std::array<std::tuple<GLenum, GLenum, GLenum>, static_cast<u32>(GPUTexture::Format::Count)>
@@ -28,6 +29,7 @@ const std::tuple<GLenum, GLenum, GLenum>& GL::Texture::GetPixelFormatMapping(GPU
       {},                                        // RGBA5551
       {},                                        // R8
       {},                                        // D16
+      {},                                        // D32F
     }};
 
   if (!GLAD_GL_ES_VERSION_2_0 || GLAD_GL_ES_VERSION_3_0)
@@ -28,6 +28,7 @@ u32 GPUTexture::GPUTexture::GetPixelSize(GPUTexture::Format format)
   {
     case Format::RGBA8:
     case Format::BGRA8:
+    case Format::D32F:
       return 4;
 
     case Format::RGBA5551:
@@ -45,7 +46,7 @@ u32 GPUTexture::GPUTexture::GetPixelSize(GPUTexture::Format format)
 
 bool GPUTexture::IsDepthFormat(Format format)
 {
-  return (format == Format::D16);
+  return (format == Format::D16 || format == Format::D32F);
 }
 
 bool GPUTexture::ConvertTextureDataToRGBA8(u32 width, u32 height, std::vector<u32>& texture_data,
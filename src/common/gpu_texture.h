@@ -24,6 +24,7 @@ public:
     RGBA5551,
     R8,
     D16,
+    D32F,
     Count
   };
 
@@ -1,12 +1,16 @@
 #include "http_downloader.h"
 #include "assert.h"
+#include "file_system.h"
 #include "log.h"
 #include "string_util.h"
 #include "timer.h"
+#include <algorithm>
+#include <cinttypes>
 Log_SetChannel(HTTPDownloader);
 
 static constexpr float DEFAULT_TIMEOUT_IN_SECONDS = 30;
 static constexpr u32 DEFAULT_MAX_ACTIVE_REQUESTS = 4;
+static constexpr u32 WAIT_FOR_ACTIVITY_TIMEOUT_MS = 100;
 
 namespace Common {
 
@@ -20,6 +24,12 @@ HTTPDownloader::HTTPDownloader()
 
 HTTPDownloader::~HTTPDownloader() = default;
 
+HTTPDownloader::Request::~Request()
+{
+  if (output_file)
+    std::fclose(output_file);
+}
+
 void HTTPDownloader::SetTimeout(float timeout)
 {
   m_timeout = timeout;
@@ -70,6 +80,110 @@ void HTTPDownloader::CreatePostRequest(std::string url, std::string post_data, R
   LockedAddRequest(req);
 }
 
+void HTTPDownloader::CreateFileRequest(std::string url, std::string output_path, Request::Callback callback)
+{
+  Request* req = InternalCreateRequest();
+  req->parent = this;
+  req->type = Request::Type::Get;
+  req->url = std::move(url);
+  req->output_path = std::move(output_path);
+  req->callback = std::move(callback);
+  req->start_time = Common::Timer::GetCurrentValue();
+
+  // anything left over from an interrupted download is kept, and the server is asked for the remainder
+  const std::string partial_path(req->output_path + ".partial");
+  req->output_file = FileSystem::OpenCFile(partial_path.c_str(), "ab");
+  if (req->output_file)
+  {
+    const s64 size = FileSystem::FSize64(req->output_file);
+    req->resume_offset = static_cast<u64>(std::max<s64>(size, 0));
+    if (req->resume_offset > 0)
+      Log_DevPrintf("Resuming download of '%s' at %" PRIu64 " bytes", req->url.c_str(), req->resume_offset);
+  }
+
+  std::unique_lock<std::mutex> lock(m_pending_http_request_lock);
+  if (!req->output_file)
+  {
+    Log_ErrorPrintf("Failed to open '%s' for writing", partial_path.c_str());
+    req->status_code = -1;
+    req->state.store(Request::State::Complete);
+  }
+  else if (LockedGetActiveRequestCount() < m_max_active_requests)
+  {
+    if (!StartRequest(req))
+      return;
+  }
+
+  LockedAddRequest(req);
+}
+
+bool HTTPDownloader::WriteResponseData(Request* request, const void* data, size_t size)
+{
+  if (request->output_path.empty())
+  {
+    const u8* data_ptr = static_cast<const u8*>(data);
+    request->data.insert(request->data.end(), data_ptr, data_ptr + size);
+    return true;
+  }
+
+  if (!request->output_file)
+    return false;
+
+  // servers which ignore the range send the whole thing again
+  if (!request->output_started)
+  {
+    request->output_started = true;
+    if (request->resume_offset > 0 && request->status_code != HTTP_PARTIAL_CONTENT)
+    {
+      std::fclose(request->output_file);
+      request->output_file = FileSystem::OpenCFile((request->output_path + ".partial").c_str(), "wb");
+      request->resume_offset = 0;
+      if (!request->output_file)
+        return false;
+    }
+  }
+
+  return (std::fwrite(data, size, 1, request->output_file) == 1);
+}
+
+void HTTPDownloader::FinishFileRequest(Request* request)
+{
+  if (request->output_path.empty())
+    return;
+
+  const std::string partial_path(request->output_path + ".partial");
+  const bool write_failed = (!request->output_file || std::fflush(request->output_file) != 0);
+  if (request->output_file)
+  {
+    std::fclose(request->output_file);
+    request->output_file = nullptr;
+  }
+
+  if (request->status_code == HTTP_PARTIAL_CONTENT)
+    request->status_code = HTTP_OK;
+
+  if (request->status_code == HTTP_OK && request->resume_offset > 0 && !request->output_started)
+  {
+    // an empty body to a range request which wasn't honoured
+    FileSystem::DeleteFile(partial_path.c_str());
+    request->status_code = -1;
+  }
+  else if (request->status_code == HTTP_OK)
+  {
+    if (write_failed || !FileSystem::RenamePath(partial_path.c_str(), request->output_path.c_str()))
+    {
+      Log_ErrorPrintf("Failed to write download to '%s'", request->output_path.c_str());
+      FileSystem::DeleteFile(partial_path.c_str());
+      request->status_code = -1;
+    }
+  }
+  else if (request->status_code > 0)
+  {
+    // the server answered, but not with the file, so there's nothing worth resuming
+    FileSystem::DeleteFile(partial_path.c_str());
+  }
+}
+
 bool HTTPDownloader::HasAnyRequests()
 {
   std::unique_lock<std::mutex> lock(m_pending_http_request_lock);
@@ -107,6 +221,8 @@ void HTTPDownloader::LockedPollRequests(std::unique_lock<std::mutex>& lock)
       m_pending_http_requests.erase(m_pending_http_requests.begin() + index);
       lock.unlock();
 
+      req->status_code = -1;
+      FinishFileRequest(req);
       req->callback(-1, std::string(), Request::Data());
 
       CloseRequest(req);
@@ -129,6 +245,7 @@ void HTTPDownloader::LockedPollRequests(std::unique_lock<std::mutex>& lock)
 
     // run callback with lock unheld
     lock.unlock();
+    FinishFileRequest(req);
     req->callback(req->status_code, std::move(req->content_type), std::move(req->data));
     CloseRequest(req);
     lock.lock();
@@ -171,7 +288,18 @@ void HTTPDownloader::WaitForAllRequests()
 {
   std::unique_lock<std::mutex> lock(m_pending_http_request_lock);
   while (!m_pending_http_requests.empty())
+  {
     LockedPollRequests(lock);
+
+    // timeouts are only checked when polling, so don't block for too long
+    if (!m_pending_http_requests.empty())
+      InternalWaitForActivity(WAIT_FOR_ACTIVITY_TIMEOUT_MS);
+  }
+}
+
+void HTTPDownloader::InternalWaitForActivity(u32 timeout_ms)
+{
+  // backends which complete requests on their own threads have nothing to wait on
 }
 
 void HTTPDownloader::LockedAddRequest(Request* request)
@@ -1,6 +1,7 @@
 #pragma once
 #include "common/types.h"
 #include <atomic>
+#include <cstdio>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -15,7 +16,8 @@ class HTTPDownloader
 public:
   enum : s32
   {
-    HTTP_OK = 200
+    HTTP_OK = 200,
+    HTTP_PARTIAL_CONTENT = 206,
   };
 
   struct Request
@@ -38,6 +40,8 @@ public:
       Complete,
     };
 
+    ~Request();
+
     HTTPDownloader* parent;
     Callback callback;
     std::string url;
@@ -49,6 +53,12 @@ public:
     u32 content_length = 0;
     Type type = Type::Get;
     std::atomic<State> state{State::Pending};
+
+    // file requests write the body to output_path + ".partial" as it arrives, starting at resume_offset
+    std::string output_path;
+    std::FILE* output_file = nullptr;
+    u64 resume_offset = 0;
+    bool output_started = false;
   };
 
   HTTPDownloader();
@@ -65,6 +75,11 @@ public:
   void CreateRequest(std::string url, Request::Callback callback);
   void CreatePostRequest(std::string url, std::string post_data, Request::Callback callback);
 
+  /// Writes the response body to output_path as it arrives, rather than collecting it in memory. The callback gets
+  /// an empty data buffer, and the file only exists once the status code is HTTP_OK. If an earlier download of the
+  /// same path was interrupted, only the rest of it is requested.
+  void CreateFileRequest(std::string url, std::string output_path, Request::Callback callback);
+
   bool HasAnyRequests();
   void PollRequests();
   void WaitForAllRequests();
@@ -75,9 +90,17 @@ protected:
   virtual Request* InternalCreateRequest() = 0;
   virtual void InternalPollRequests() = 0;
 
+  virtual void InternalWaitForActivity(u32 timeout_ms);
+
+  // Failures should complete the request with an error status rather than returning false, so that the callback runs
+  // from PollRequests() without the lock held, and can queue another request.
   virtual bool StartRequest(Request* request) = 0;
   virtual void CloseRequest(Request* request) = 0;
 
+  /// Appends received body data to the request, either in memory or to its output file. status_code must be set.
+  static bool WriteResponseData(Request* request, const void* data, size_t size);
+  static void FinishFileRequest(Request* request);
+
   void LockedAddRequest(Request* request);
   u32 LockedGetActiveRequestCount();
   void LockedPollRequests(std::unique_lock<std::mutex>& lock);
@@ -4,7 +4,8 @@
 #include "common/string_util.h"
 #include "common/timer.h"
 #include <algorithm>
-#include <functional>
+#include <cinttypes>
+#include <cstring>
 #include <pthread.h>
 #include <signal.h>
 Log_SetChannel(HTTPDownloaderCurl);
@@ -13,7 +14,20 @@ namespace Common {
 
 HTTPDownloaderCurl::HTTPDownloaderCurl() : HTTPDownloader() {}
 
-HTTPDownloaderCurl::~HTTPDownloaderCurl() = default;
+HTTPDownloaderCurl::~HTTPDownloaderCurl()
+{
+  for (HTTPDownloader::Request* request : m_pending_http_requests)
+  {
+    Request* req = static_cast<Request*>(request);
+    RemoveFromMulti(req);
+    curl_easy_cleanup(req->handle);
+    delete req;
+  }
+  m_pending_http_requests.clear();
+
+  if (m_multi_handle)
+    curl_multi_cleanup(m_multi_handle);
+}
 
 std::unique_ptr<HTTPDownloader> HTTPDownloader::Create(const char* user_agent)
 {
@@ -48,30 +62,60 @@ bool HTTPDownloaderCurl::Initialize(const char* user_agent)
     }
   }
 
+  m_multi_handle = curl_multi_init();
+  if (!m_multi_handle)
+  {
+    Log_ErrorPrint("curl_multi_init() failed");
+    return false;
+  }
+
+  // requests to the same server share a connection with HTTP/2, rather than each opening their own
+  curl_multi_setopt(m_multi_handle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
   m_user_agent = user_agent;
-  m_thread_pool = std::make_unique<cb::ThreadPool>(m_max_active_requests);
   return true;
 }
 
 size_t HTTPDownloaderCurl::WriteCallback(char* ptr, size_t size, size_t nmemb, void* userdata)
 {
   Request* req = static_cast<Request*>(userdata);
-  const size_t current_size = req->data.size();
   const size_t transfer_size = size * nmemb;
-  const size_t new_size = current_size + transfer_size;
-  req->data.resize(new_size);
-  std::memcpy(&req->data[current_size], ptr, transfer_size);
-  return nmemb;
+  if (req->state != Request::State::Receiving)
+  {
+    long response_code = 0;
+    curl_easy_getinfo(req->handle, CURLINFO_RESPONSE_CODE, &response_code);
+    req->status_code = static_cast<s32>(response_code);
+    req->state = Request::State::Receiving;
+  }
+
+  // returning less than we were given aborts the transfer
+  return WriteResponseData(req, ptr, transfer_size) ? transfer_size : 0;
 }
 
-void HTTPDownloaderCurl::ProcessRequest(Request* req)
+void HTTPDownloaderCurl::RemoveFromMulti(Request* req)
 {
-  std::unique_lock<std::mutex> cancel_lock(m_cancel_mutex);
-  if (req->closed.load())
+  if (!req->added_to_multi)
     return;
 
-  cancel_lock.unlock();
+  curl_multi_remove_handle(m_multi_handle, req->handle);
+  req->added_to_multi = false;
+}
+
+HTTPDownloader::Request* HTTPDownloaderCurl::InternalCreateRequest()
+{
+  Request* req = new Request();
+  req->handle = curl_easy_init();
+  if (!req->handle)
+  {
+    delete req;
+    return nullptr;
+  }
 
+  return req;
+}
+
+void HTTPDownloaderCurl::InternalPollRequests()
+{
   // Apparently OpenSSL can fire SIGPIPE...
   sigset_t old_block_mask = {};
   sigset_t new_block_mask = {};
@@ -81,55 +125,52 @@ void HTTPDownloaderCurl::ProcessRequest(Request* req)
   if (pthread_sigmask(SIG_BLOCK, &new_block_mask, &old_block_mask) != 0)
     Log_WarningPrint("Failed to block SIGPIPE");
 
-  req->start_time = Common::Timer::GetCurrentValue();
-  int ret = curl_easy_perform(req->handle);
-  if (ret == CURLE_OK)
-  {
-    long response_code = 0;
-    curl_easy_getinfo(req->handle, CURLINFO_RESPONSE_CODE, &response_code);
-    req->status_code = static_cast<s32>(response_code);
+  int running_handles = 0;
+  const CURLMcode err = curl_multi_perform(m_multi_handle, &running_handles);
+  if (err != CURLM_OK)
+    Log_ErrorPrintf("curl_multi_perform() failed: %d", static_cast<int>(err));
 
-    char* content_type = nullptr;
-    if (!curl_easy_getinfo(req->handle, CURLINFO_CONTENT_TYPE, &content_type) && content_type)
-      req->content_type = content_type;
+  if (pthread_sigmask(SIG_SETMASK, &old_block_mask, nullptr) != 0)
+    Log_WarningPrint("Failed to unblock SIGPIPE");
 
-    Log_DevPrintf("Request for '%s' returned status code %d and %zu bytes", req->url.c_str(), req->status_code,
-                  req->data.size());
-  }
-  else
+  int messages_left = 0;
+  while (CURLMsg* msg = curl_multi_info_read(m_multi_handle, &messages_left))
   {
-    Log_ErrorPrintf("Request for '%s' returned %d", req->url.c_str(), ret);
-  }
+    if (msg->msg != CURLMSG_DONE)
+      continue;
 
-  curl_easy_cleanup(req->handle);
+    Request* req = nullptr;
+    curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &req);
+    if (!req)
+      continue;
 
-  if (pthread_sigmask(SIG_UNBLOCK, &new_block_mask, &old_block_mask) != 0)
-    Log_WarningPrint("Failed to unblock SIGPIPE");
+    if (msg->data.result == CURLE_OK)
+    {
+      long response_code = 0;
+      curl_easy_getinfo(req->handle, CURLINFO_RESPONSE_CODE, &response_code);
+      req->status_code = static_cast<s32>(response_code);
 
-  cancel_lock.lock();
-  req->state = Request::State::Complete;
-  if (req->closed.load())
-    delete req;
-  else
-    req->closed.store(true);
-}
+      char* content_type = nullptr;
+      if (!curl_easy_getinfo(req->handle, CURLINFO_CONTENT_TYPE, &content_type) && content_type)
+        req->content_type = content_type;
 
-HTTPDownloader::Request* HTTPDownloaderCurl::InternalCreateRequest()
-{
-  Request* req = new Request();
-  req->handle = curl_easy_init();
-  if (!req->handle)
-  {
-    delete req;
-    return nullptr;
-  }
+      Log_DevPrintf("Request for '%s' returned status code %d", req->url.c_str(), req->status_code);
+    }
+    else
+    {
+      Log_ErrorPrintf("Request for '%s' returned %d", req->url.c_str(), static_cast<int>(msg->data.result));
+      req->status_code = -1;
+    }
 
-  return req;
+    // msg is freed by removing the handle
+    RemoveFromMulti(req);
+    req->state.store(Request::State::Complete);
+  }
 }
 
-void HTTPDownloaderCurl::InternalPollRequests()
+void HTTPDownloaderCurl::InternalWaitForActivity(u32 timeout_ms)
 {
-  // noop - uses thread pool
+  curl_multi_poll(m_multi_handle, nullptr, 0, static_cast<int>(timeout_ms), nullptr);
 }
 
 bool HTTPDownloaderCurl::StartRequest(HTTPDownloader::Request* request)
@@ -139,7 +180,12 @@ bool HTTPDownloaderCurl::StartRequest(HTTPDownloader::Request* request)
   curl_easy_setopt(req->handle, CURLOPT_USERAGENT, m_user_agent.c_str());
   curl_easy_setopt(req->handle, CURLOPT_WRITEFUNCTION, &HTTPDownloaderCurl::WriteCallback);
   curl_easy_setopt(req->handle, CURLOPT_WRITEDATA, req);
-  curl_easy_setopt(req->handle, CURLOPT_NOSIGNAL, 1);
+  curl_easy_setopt(req->handle, CURLOPT_PRIVATE, req);
+  curl_easy_setopt(req->handle, CURLOPT_NOSIGNAL, 1L);
+
+  // wait for an existing connection to the server to be multiplexed, instead of opening another
+  curl_easy_setopt(req->handle, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+  curl_easy_setopt(req->handle, CURLOPT_PIPEWAIT, 1L);
 
   if (request->type == Request::Type::Post)
   {
@@ -147,21 +193,38 @@ bool HTTPDownloaderCurl::StartRequest(HTTPDownloader::Request* request)
     curl_easy_setopt(req->handle, CURLOPT_POSTFIELDS, request->post_data.c_str());
   }
 
+  // not CURLOPT_RESUME_FROM, which fails the transfer if the server sends the whole file instead
+  if (request->resume_offset > 0)
+  {
+    const std::string range(StringUtil::StdStringFromFormat("%" PRIu64 "-", request->resume_offset));
+    curl_easy_setopt(req->handle, CURLOPT_RANGE, range.c_str());
+  }
+
+  req->start_time = Common::Timer::GetCurrentValue();
+
+  const CURLMcode err = curl_multi_add_handle(m_multi_handle, req->handle);
+  if (err != CURLM_OK)
+  {
+    Log_ErrorPrintf("curl_multi_add_handle() for '%s' failed: %d", req->url.c_str(), static_cast<int>(err));
+    req->status_code = -1;
+    req->state = Request::State::Complete;
+    return true;
+  }
+
   Log_DevPrintf("Started HTTP request for '%s'", req->url.c_str());
+  req->added_to_multi = true;
   req->state = Request::State::Started;
-  req->start_time = Common::Timer::GetCurrentValue();
-  m_thread_pool->Schedule(std::bind(&HTTPDownloaderCurl::ProcessRequest, this, req));
   return true;
 }
 
 void HTTPDownloaderCurl::CloseRequest(HTTPDownloader::Request* request)
 {
-  std::unique_lock<std::mutex> cancel_lock(m_cancel_mutex);
+  // requests which timed out are still transferring, and the multi handle is only used with the lock held
   Request* req = static_cast<Request*>(request);
-  if (req->closed.load())
-    delete req;
-  else
-    req->closed.store(true);
+  std::unique_lock<std::mutex> lock(m_pending_http_request_lock);
+  RemoveFromMulti(req);
+  curl_easy_cleanup(req->handle);
+  delete req;
 }
 
-} // namespace Common
+} // namespace Common
\ No newline at end of file
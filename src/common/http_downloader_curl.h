@@ -1,9 +1,6 @@
 #pragma once
 #include "http_downloader.h"
-#include "common/thirdparty/thread_pool.h"
-#include <atomic>
 #include <memory>
-#include <mutex>
 #include <curl/curl.h>
 
 namespace Common {
@@ -19,6 +16,7 @@ public:
 protected:
   Request* InternalCreateRequest() override;
   void InternalPollRequests() override;
+  void InternalWaitForActivity(u32 timeout_ms) override;
   bool StartRequest(HTTPDownloader::Request* request) override;
   void CloseRequest(HTTPDownloader::Request* request) override;
 
@@ -26,15 +24,15 @@ private:
   struct Request : HTTPDownloader::Request
   {
     CURL* handle = nullptr;
-    std::atomic_bool closed{false};
+    bool added_to_multi = false;
   };
 
   static size_t WriteCallback(char* ptr, size_t size, size_t nmemb, void* userdata);
-  void ProcessRequest(Request* req);
+  void RemoveFromMulti(Request* req);
 
+  // all transfers are driven through the one multi handle, so connections are kept alive and shared between them
+  CURLM* m_multi_handle = nullptr;
   std::string m_user_agent;
-  std::unique_ptr<cb::ThreadPool> m_thread_pool;
-  std::mutex m_cancel_mutex;
 };
 
 } // namespace FrontendCommon
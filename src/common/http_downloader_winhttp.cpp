@@ -5,6 +5,7 @@
 #include "timer.h"
 #include <VersionHelpers.h>
 #include <algorithm>
+#include <cinttypes>
 Log_SetChannel(HTTPDownloaderWinHttp);
 
 #pragma comment(lib, "winhttp.lib")
@@ -54,6 +55,16 @@ bool HTTPDownloaderWinHttp::Initialize(const char* user_agent)
     return false;
   }
 
+#ifdef WINHTTP_OPTION_ENABLE_HTTP_PROTOCOL
+  // requests to the same server share a connection with HTTP/2, it's only available from Windows 10 1607
+  DWORD http_protocol_flags = WINHTTP_PROTOCOL_FLAG_HTTP2;
+  if (!WinHttpSetOption(m_hSession, WINHTTP_OPTION_ENABLE_HTTP_PROTOCOL, &http_protocol_flags,
+                        sizeof(http_protocol_flags)))
+  {
+    Log_DevPrintf("HTTP/2 is not available: %u", GetLastError());
+  }
+#endif
+
   return true;
 }
 
@@ -145,7 +156,8 @@ void CALLBACK HTTPDownloaderWinHttp::HTTPStatusCallback(HINTERNET hRequest, DWOR
       }
 
       Log_DevPrintf("Status code %d, content-length is %u", req->status_code, req->content_length);
-      req->data.reserve(req->content_length);
+      if (req->output_path.empty())
+        req->data.reserve(req->content_length);
       req->state = Request::State::Receiving;
 
       // start reading
@@ -193,6 +205,20 @@ void CALLBACK HTTPDownloaderWinHttp::HTTPStatusCallback(HINTERNET hRequest, DWOR
       req->data.resize(new_size);
       req->start_time = Common::Timer::GetCurrentValue();
 
+      // file requests only use the buffer for the chunk being read
+      if (!req->output_path.empty())
+      {
+        const bool written = WriteResponseData(req, req->data.data(), req->data.size());
+        req->data.clear();
+        if (!written)
+        {
+          Log_ErrorPrintf("Failed to write response for '%s'", req->url.c_str());
+          req->status_code = -1;
+          req->state.store(Request::State::Complete);
+          return;
+        }
+      }
+
       if (!WinHttpQueryDataAvailable(hRequest, nullptr) && GetLastError() != ERROR_IO_PENDING)
       {
         Log_ErrorPrintf("WinHttpQueryDataAvailable() failed: %u", GetLastError());
@@ -238,9 +264,9 @@ bool HTTPDownloaderWinHttp::StartRequest(HTTPDownloader::Request* request)
   if (!WinHttpCrackUrl(url_wide.c_str(), static_cast<DWORD>(url_wide.size()), 0, &uc))
   {
     Log_ErrorPrintf("WinHttpCrackUrl() failed: %u", GetLastError());
-    req->callback(-1, std::string(), req->data);
-    delete req;
-    return false;
+    req->status_code = -1;
+    req->state.store(Request::State::Complete);
+    return true;
   }
 
   host_name.resize(uc.dwHostNameLength);
@@ -250,9 +276,9 @@ bool HTTPDownloaderWinHttp::StartRequest(HTTPDownloader::Request* request)
   if (!req->hConnection)
   {
     Log_ErrorPrintf("Failed to start HTTP request for '%s': %u", req->url.c_str(), GetLastError());
-    req->callback(-1, std::string(), req->data);
-    delete req;
-    return false;
+    req->status_code = -1;
+    req->state.store(Request::State::Complete);
+    return true;
   }
 
   const DWORD request_flags = uc.nScheme == INTERNET_SCHEME_HTTPS ? WINHTTP_FLAG_SECURE : 0;
@@ -263,7 +289,10 @@ bool HTTPDownloaderWinHttp::StartRequest(HTTPDownloader::Request* request)
   {
     Log_ErrorPrintf("WinHttpOpenRequest() failed: %u", GetLastError());
     WinHttpCloseHandle(req->hConnection);
-    return false;
+    req->hConnection = NULL;
+    req->status_code = -1;
+    req->state.store(Request::State::Complete);
+    return true;
   }
 
   BOOL result;
@@ -274,6 +303,14 @@ bool HTTPDownloaderWinHttp::StartRequest(HTTPDownloader::Request* request)
                                 req->post_data.data(), static_cast<DWORD>(req->post_data.size()),
                                 static_cast<DWORD>(req->post_data.size()), reinterpret_cast<DWORD_PTR>(req));
   }
+  else if (req->resume_offset > 0)
+  {
+    const std::wstring range_header(
+      StringUtil::UTF8StringToWideString(StringUtil::StdStringFromFormat("Range: bytes=%" PRIu64 "-\r\n",
+                                                                         req->resume_offset)));
+    result = WinHttpSendRequest(req->hRequest, range_header.c_str(), static_cast<DWORD>(range_header.size()),
+                                WINHTTP_NO_REQUEST_DATA, 0, 0, reinterpret_cast<DWORD_PTR>(req));
+  }
   else
   {
     result = WinHttpSendRequest(req->hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0, WINHTTP_NO_REQUEST_DATA, 0, 0,
@@ -285,6 +322,7 @@ bool HTTPDownloaderWinHttp::StartRequest(HTTPDownloader::Request* request)
     Log_ErrorPrintf("WinHttpSendRequest() failed: %u", GetLastError());
     req->status_code = -1;
     req->state.store(Request::State::Complete);
+    return true;
   }
 
   Log_DevPrintf("Started HTTP request for '%s'", req->url.c_str());
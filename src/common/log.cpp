@@ -3,8 +3,14 @@
 #include "file_system.h"
 #include "string.h"
 #include "timer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 #if defined(_WIN32)
@@ -25,13 +31,45 @@ struct RegisteredCallback
   void* Parameter;
 };
 
+static void ConsoleOutputLogCallback(void* pUserParam, const char* channelName, const char* functionName,
+                                     LOGLEVEL level, const char* message);
+static void DebugOutputLogCallback(void* pUserParam, const char* channelName, const char* functionName, LOGLEVEL level,
+                                   const char* message);
+static void FileOutputLogCallback(void* pUserParam, const char* channelName, const char* functionName, LOGLEVEL level,
+                                  const char* message);
+
+static LOGLEVEL GetCallbackFilterLevel(const RegisteredCallback& callback, const char* channelName);
+static void UpdateEffectiveFilterLevel();
+static void ExecuteCallbacks(const char* channelName, const char* functionName, LOGLEVEL level, const char* message,
+                             Common::Timer::Value time);
+static void DispatchMessage(const char* channelName, const char* functionName, LOGLEVEL level, const char* message,
+                            size_t length);
+
+static bool EnqueueMessage(const char* channelName, const char* functionName, LOGLEVEL level, const char* message,
+                           size_t length);
+static bool DequeueMessage();
+static bool HasQueuedMessages();
+static void WakeAsyncWriter();
+static void FlushAsyncOutput();
+static void AsyncWriterThreadEntryPoint();
+static void StopAsyncWriter();
+
 std::vector<RegisteredCallback> s_callbacks;
 static std::mutex s_callback_mutex;
 
 static LOGLEVEL s_filter_level = LOGLEVEL_TRACE;
 
+// lowest of the global filter and the most verbose sink, checked before anything is formatted
+static std::atomic<LOGLEVEL> s_effective_filter_level{LOGLEVEL_NONE};
+
+// every channel in the program, registered during static initialization
+static Channel* s_channels = nullptr;
+
 static Common::Timer::Value s_startTimeStamp = Common::Timer::GetCurrentValue();
 
+// time the message being passed to the callbacks was written, which is earlier than now when it was queued
+static Common::Timer::Value s_message_time = 0;
+
 static bool s_console_output_enabled = false;
 static String s_console_output_channel_filter;
 static LOGLEVEL s_console_output_level_filter = LOGLEVEL_TRACE;
@@ -57,28 +95,135 @@ std::unique_ptr<std::FILE, void (*)(std::FILE*)> s_fileOutputHandle(nullptr, [](
   }
 });
 
+namespace {
+enum : u32
+{
+  ASYNC_QUEUE_SIZE = 1024,
+  ASYNC_QUEUE_MASK = ASYNC_QUEUE_SIZE - 1,
+  ASYNC_INLINE_MESSAGE_SIZE = 256,
+  ASYNC_WRITER_WAKE_INTERVAL_MS = 100,
+};
+
+// Bounded multi-producer queue slot. The sequence says whether the slot is free for the producer claiming position
+// N (sequence == N), or holds the message for position N (sequence == N + 1).
+struct QueuedMessage
+{
+  std::atomic<u32> sequence;
+  LOGLEVEL level;
+  const char* channel_name;
+  const char* function_name;
+  Common::Timer::Value time;
+  char* long_message;
+  char message[ASYNC_INLINE_MESSAGE_SIZE];
+};
+
+struct AsyncWriterShutdown
+{
+  ~AsyncWriterShutdown() { StopAsyncWriter(); }
+};
+} // namespace
+
+static QueuedMessage s_queue[ASYNC_QUEUE_SIZE];
+static bool s_queue_initialized = false;
+static std::atomic<u32> s_queue_enqueue_pos{0};
+static std::atomic<u32> s_queue_dequeue_pos{0};
+
+static std::atomic_bool s_async_output_enabled{false};
+static std::atomic<u32> s_async_active_producers{0};
+static std::atomic_bool s_async_writer_sleeping{false};
+static bool s_async_writer_exit = false;
+static std::mutex s_async_writer_mutex;
+static std::condition_variable s_async_writer_cv;
+static std::thread s_async_writer_thread;
+static thread_local bool s_is_async_writer_thread = false;
+
+// destroyed before everything above, so the remaining messages are written out at exit
+static AsyncWriterShutdown s_async_writer_shutdown;
+
 void RegisterCallback(CallbackFunctionType callbackFunction, void* pUserParam)
 {
   RegisteredCallback Callback;
   Callback.Function = callbackFunction;
   Callback.Parameter = pUserParam;
 
-  std::lock_guard<std::mutex> guard(s_callback_mutex);
-  s_callbacks.push_back(std::move(Callback));
+  FlushAsyncOutput();
+
+  {
+    std::lock_guard<std::mutex> guard(s_callback_mutex);
+    s_callbacks.push_back(std::move(Callback));
+  }
+
+  UpdateEffectiveFilterLevel();
 }
 
 void UnregisterCallback(CallbackFunctionType callbackFunction, void* pUserParam)
 {
-  std::lock_guard<std::mutex> guard(s_callback_mutex);
+  // messages written before the callback was removed should still reach it
+  FlushAsyncOutput();
 
-  for (auto iter = s_callbacks.begin(); iter != s_callbacks.end(); ++iter)
   {
-    if (iter->Function == callbackFunction && iter->Parameter == pUserParam)
+    std::lock_guard<std::mutex> guard(s_callback_mutex);
+
+    for (auto iter = s_callbacks.begin(); iter != s_callbacks.end(); ++iter)
     {
-      s_callbacks.erase(iter);
-      break;
+      if (iter->Function == callbackFunction && iter->Parameter == pUserParam)
+      {
+        s_callbacks.erase(iter);
+        break;
+      }
     }
   }
+
+  UpdateEffectiveFilterLevel();
+}
+
+Channel::Channel(const char* name) : m_name(name), m_level(LOGLEVEL_TRACE)
+{
+  // the sink filters may not have been constructed yet, so let everything through until they're next changed
+  std::lock_guard<std::mutex> guard(s_callback_mutex);
+  m_next = s_channels;
+  s_channels = this;
+}
+
+LOGLEVEL GetCallbackFilterLevel(const RegisteredCallback& callback, const char* channelName)
+{
+  // the debug output filter doesn't match on channel names, so it can't exclude any
+  if (callback.Function == ConsoleOutputLogCallback)
+  {
+    return (channelName && s_console_output_channel_filter.Find(channelName) >= 0) ? LOGLEVEL_NONE :
+                                                                                      s_console_output_level_filter;
+  }
+  else if (callback.Function == DebugOutputLogCallback)
+  {
+    return s_debug_output_level_filter;
+  }
+  else if (callback.Function == FileOutputLogCallback)
+  {
+    return (channelName && s_file_output_channel_filter.Find(channelName) >= 0) ? LOGLEVEL_NONE :
+                                                                                   s_file_output_level_filter;
+  }
+  else
+  {
+    return LOGLEVEL_TRACE;
+  }
+}
+
+void UpdateEffectiveFilterLevel()
+{
+  std::lock_guard<std::mutex> guard(s_callback_mutex);
+
+  LOGLEVEL sink_level = LOGLEVEL_NONE;
+  for (const RegisteredCallback& callback : s_callbacks)
+    sink_level = std::max(sink_level, GetCallbackFilterLevel(callback, nullptr));
+  s_effective_filter_level.store(std::min(s_filter_level, sink_level), std::memory_order_relaxed);
+
+  for (Channel* channel = s_channels; channel; channel = channel->GetNext())
+  {
+    LOGLEVEL channel_level = LOGLEVEL_NONE;
+    for (const RegisteredCallback& callback : s_callbacks)
+      channel_level = std::max(channel_level, GetCallbackFilterLevel(callback, channel->GetName()));
+    channel->SetLevel(std::min(s_filter_level, channel_level));
+  }
 }
 
 bool IsConsoleOutputEnabled()
@@ -91,13 +236,207 @@ bool IsDebugOutputEnabled()
   return s_debug_output_enabled;
 }
 
-static void ExecuteCallbacks(const char* channelName, const char* functionName, LOGLEVEL level, const char* message)
+bool IsAsyncOutputEnabled()
+{
+  return s_async_output_enabled.load(std::memory_order_relaxed);
+}
+
+void SetAsyncOutput(bool enabled)
+{
+  if (s_async_output_enabled.load(std::memory_order_relaxed) == enabled)
+    return;
+
+  if (!enabled)
+  {
+    StopAsyncWriter();
+    return;
+  }
+
+  if (!s_queue_initialized)
+  {
+    for (u32 i = 0; i < ASYNC_QUEUE_SIZE; i++)
+      s_queue[i].sequence.store(i, std::memory_order_relaxed);
+    s_queue_initialized = true;
+  }
+
+  s_async_writer_exit = false;
+  s_async_writer_thread = std::thread(AsyncWriterThreadEntryPoint);
+  s_async_output_enabled.store(true);
+}
+
+void StopAsyncWriter()
+{
+  if (!s_async_writer_thread.joinable())
+    return;
+
+  // anything which got in before the switch still has to make it into the queue
+  s_async_output_enabled.store(false);
+  while (s_async_active_producers.load() != 0)
+    std::this_thread::yield();
+
+  {
+    std::lock_guard<std::mutex> guard(s_async_writer_mutex);
+    s_async_writer_exit = true;
+    s_async_writer_cv.notify_one();
+  }
+
+  s_async_writer_thread.join();
+}
+
+bool EnqueueMessage(const char* channelName, const char* functionName, LOGLEVEL level, const char* message,
+                    size_t length)
+{
+  s_async_active_producers.fetch_add(1);
+  if (!s_async_output_enabled.load())
+  {
+    s_async_active_producers.fetch_sub(1);
+    return false;
+  }
+
+  QueuedMessage* slot;
+  u32 pos = s_queue_enqueue_pos.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    slot = &s_queue[pos & ASYNC_QUEUE_MASK];
+    const s32 diff = static_cast<s32>(slot->sequence.load(std::memory_order_acquire) - pos);
+    if (diff == 0)
+    {
+      if (s_queue_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else
+    {
+      // queue is full, wait for the writer rather than dropping the message
+      if (diff < 0)
+      {
+        WakeAsyncWriter();
+        std::this_thread::yield();
+      }
+
+      pos = s_queue_enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->level = level;
+  slot->channel_name = channelName;
+  slot->function_name = functionName;
+  slot->time = Common::Timer::GetCurrentValue();
+  if (length < ASYNC_INLINE_MESSAGE_SIZE)
+  {
+    std::memcpy(slot->message, message, length + 1);
+    slot->long_message = nullptr;
+  }
+  else
+  {
+    slot->long_message = new char[length + 1];
+    std::memcpy(slot->long_message, message, length + 1);
+  }
+
+  slot->sequence.store(pos + 1, std::memory_order_release);
+  s_async_active_producers.fetch_sub(1);
+
+  // pairs with the writer setting the flag before checking the queue, so one of us sees the other
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (s_async_writer_sleeping.load(std::memory_order_relaxed))
+    WakeAsyncWriter();
+
+  return true;
+}
+
+bool HasQueuedMessages()
+{
+  const u32 pos = s_queue_dequeue_pos.load(std::memory_order_relaxed);
+  return (s_queue[pos & ASYNC_QUEUE_MASK].sequence.load(std::memory_order_acquire) == (pos + 1));
+}
+
+bool DequeueMessage()
+{
+  // only ever called from the writer thread
+  const u32 pos = s_queue_dequeue_pos.load(std::memory_order_relaxed);
+  QueuedMessage& slot = s_queue[pos & ASYNC_QUEUE_MASK];
+  if (slot.sequence.load(std::memory_order_acquire) != (pos + 1))
+    return false;
+
+  ExecuteCallbacks(slot.channel_name, slot.function_name, slot.level,
+                   slot.long_message ? slot.long_message : slot.message, slot.time);
+  delete[] slot.long_message;
+
+  slot.sequence.store(pos + ASYNC_QUEUE_SIZE, std::memory_order_release);
+  s_queue_dequeue_pos.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+void WakeAsyncWriter()
+{
+  std::lock_guard<std::mutex> guard(s_async_writer_mutex);
+  s_async_writer_cv.notify_one();
+}
+
+void FlushAsyncOutput()
+{
+  if (!s_async_writer_thread.joinable() || s_is_async_writer_thread)
+    return;
+
+  const u32 target = s_queue_enqueue_pos.load();
+  while (static_cast<s32>(s_queue_dequeue_pos.load(std::memory_order_acquire) - target) < 0)
+  {
+    WakeAsyncWriter();
+    std::this_thread::yield();
+  }
+}
+
+void AsyncWriterThreadEntryPoint()
+{
+  s_is_async_writer_thread = true;
+
+  std::unique_lock<std::mutex> lock(s_async_writer_mutex);
+  for (;;)
+  {
+    lock.unlock();
+    while (DequeueMessage())
+      ;
+    lock.lock();
+
+    if (s_async_writer_exit)
+    {
+      // producers have all finished by the time exit is requested
+      lock.unlock();
+      while (DequeueMessage())
+        ;
+      break;
+    }
+
+    s_async_writer_sleeping.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!HasQueuedMessages())
+      s_async_writer_cv.wait_for(lock, std::chrono::milliseconds(ASYNC_WRITER_WAKE_INTERVAL_MS));
+    s_async_writer_sleeping.store(false);
+  }
+
+  s_is_async_writer_thread = false;
+}
+
+void ExecuteCallbacks(const char* channelName, const char* functionName, LOGLEVEL level, const char* message,
+                      Common::Timer::Value time)
 {
   std::lock_guard<std::mutex> guard(s_callback_mutex);
+  s_message_time = time;
   for (RegisteredCallback& callback : s_callbacks)
     callback.Function(callback.Parameter, channelName, functionName, level, message);
 }
 
+void DispatchMessage(const char* channelName, const char* functionName, LOGLEVEL level, const char* message,
+                     size_t length)
+{
+  if (s_async_output_enabled.load(std::memory_order_relaxed) &&
+      EnqueueMessage(channelName, functionName, level, message, length))
+  {
+    return;
+  }
+
+  ExecuteCallbacks(channelName, functionName, level, message, Common::Timer::GetCurrentValue());
+}
+
 static int FormatLogMessageForDisplay(char* buffer, size_t buffer_size, const char* channelName,
                                       const char* functionName, LOGLEVEL level, const char* message, bool timestamp,
                                       bool ansi_color_code, bool newline)
@@ -123,7 +462,7 @@ static int FormatLogMessageForDisplay(char* buffer, size_t buffer_size, const ch
   {
     // find time since start of process
     const float message_time =
-      static_cast<float>(Common::Timer::ConvertValueToSeconds(Common::Timer::GetCurrentValue() - s_startTimeStamp));
+      static_cast<float>(Common::Timer::ConvertValueToSeconds(s_message_time - s_startTimeStamp));
 
     if (level <= LOGLEVEL_PERF)
     {
@@ -296,7 +635,10 @@ void SetConsoleOutputParams(bool Enabled, const char* ChannelFilter, LOGLEVEL Le
   s_console_output_level_filter = LevelFilter;
 
   if (s_console_output_enabled == Enabled)
+  {
+    UpdateEffectiveFilterLevel();
     return;
+  }
 
   s_console_output_enabled = Enabled;
 
@@ -384,6 +726,7 @@ void SetDebugOutputParams(bool enabled, const char* channelFilter /* = nullptr *
 
   s_debug_output_channel_filter = (channelFilter != nullptr) ? channelFilter : "";
   s_debug_output_level_filter = levelFilter;
+  UpdateEffectiveFilterLevel();
 }
 
 static void FileOutputLogCallback(void* pUserParam, const char* channelName, const char* functionName, LOGLEVEL level,
@@ -422,29 +765,34 @@ void SetFileOutputParams(bool enabled, const char* filename, bool timestamps /*
     s_file_output_enabled = enabled;
   }
 
-  std::lock_guard<std::mutex> guard(s_callback_mutex);
-  s_file_output_channel_filter = (channelFilter != nullptr) ? channelFilter : "";
-  s_file_output_level_filter = levelFilter;
-  s_file_output_timestamp = timestamps;
+  {
+    std::lock_guard<std::mutex> guard(s_callback_mutex);
+    s_file_output_channel_filter = (channelFilter != nullptr) ? channelFilter : "";
+    s_file_output_level_filter = levelFilter;
+    s_file_output_timestamp = timestamps;
+  }
+
+  UpdateEffectiveFilterLevel();
 }
 
 void SetFilterLevel(LOGLEVEL level)
 {
   DebugAssert(level < LOGLEVEL_COUNT);
   s_filter_level = level;
+  UpdateEffectiveFilterLevel();
 }
 
 void Write(const char* channelName, const char* functionName, LOGLEVEL level, const char* message)
 {
-  if (level > s_filter_level)
+  if (level > s_effective_filter_level.load(std::memory_order_relaxed))
     return;
 
-  ExecuteCallbacks(channelName, functionName, level, message);
+  DispatchMessage(channelName, functionName, level, message, std::strlen(message));
 }
 
 void Writef(const char* channelName, const char* functionName, LOGLEVEL level, const char* format, ...)
 {
-  if (level > s_filter_level)
+  if (level > s_effective_filter_level.load(std::memory_order_relaxed))
     return;
 
   va_list ap;
@@ -455,32 +803,34 @@ void Writef(const char* channelName, const char* functionName, LOGLEVEL level, c
 
 void Writev(const char* channelName, const char* functionName, LOGLEVEL level, const char* format, va_list ap)
 {
-  if (level > s_filter_level)
+  if (level > s_effective_filter_level.load(std::memory_order_relaxed))
     return;
 
+  // most messages fit on the stack, so only format a second time when it was truncated
   va_list apCopy;
   va_copy(apCopy, ap);
 
-#ifdef _WIN32
-  u32 requiredSize = static_cast<u32>(_vscprintf(format, apCopy));
-#else
-  u32 requiredSize = std::vsnprintf(nullptr, 0, format, apCopy);
-#endif
-  va_end(apCopy);
+  char buffer[256];
+  const int length = std::vsnprintf(buffer, countof(buffer), format, ap);
+  if (length < 0)
+  {
+    va_end(apCopy);
+    return;
+  }
 
-  if (requiredSize < 256)
+  if (static_cast<u32>(length) < countof(buffer))
   {
-    char buffer[256];
-    std::vsnprintf(buffer, countof(buffer), format, ap);
-    ExecuteCallbacks(channelName, functionName, level, buffer);
+    DispatchMessage(channelName, functionName, level, buffer, static_cast<u32>(length));
   }
   else
   {
-    char* buffer = new char[requiredSize + 1];
-    std::vsnprintf(buffer, requiredSize + 1, format, ap);
-    ExecuteCallbacks(channelName, functionName, level, buffer);
-    delete[] buffer;
+    char* long_buffer = new char[length + 1];
+    std::vsnprintf(long_buffer, length + 1, format, apCopy);
+    DispatchMessage(channelName, functionName, level, long_buffer, static_cast<u32>(length));
+    delete[] long_buffer;
   }
+
+  va_end(apCopy);
 }
 
 } // namespace Log
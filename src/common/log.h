@@ -1,5 +1,6 @@
 #pragma once
 #include "types.h"
+#include <atomic>
 #include <cinttypes>
 #include <mutex>
 
@@ -41,6 +42,11 @@ void SetDebugOutputParams(bool enabled, const char* channelFilter = nullptr, LOG
 void SetFileOutputParams(bool enabled, const char* filename, bool timestamps = true,
                          const char* channelFilter = nullptr, LOGLEVEL levelFilter = LOGLEVEL_TRACE);
 
+// Moves formatted messages to a queue which is written out to the sinks by a background thread, so logging doesn't
+// block the caller on console or file output. Messages are never dropped, a full queue waits for the writer.
+bool IsAsyncOutputEnabled();
+void SetAsyncOutput(bool enabled);
+
 // Sets global filtering level, messages below this level won't be sent to any of the logging sinks.
 void SetFilterLevel(LOGLEVEL level);
 
@@ -48,45 +54,129 @@ void SetFilterLevel(LOGLEVEL level);
 void Write(const char* channelName, const char* functionName, LOGLEVEL level, const char* message);
 void Writef(const char* channelName, const char* functionName, LOGLEVEL level, const char* format, ...) printflike(4, 5);
 void Writev(const char* channelName, const char* functionName, LOGLEVEL level, const char* format, va_list ap);
-} // namespace Log
 
-// log wrappers
-#define Log_SetChannel(ChannelName) static const char* ___LogChannel___ = #ChannelName;
-#define Log_ErrorPrint(msg) Log::Write(___LogChannel___, __func__, LOGLEVEL_ERROR, msg)
-#define Log_ErrorPrintf(...) Log::Writef(___LogChannel___, __func__, LOGLEVEL_ERROR, __VA_ARGS__)
-#define Log_WarningPrint(msg) Log::Write(___LogChannel___, __func__, LOGLEVEL_WARNING, msg)
-#define Log_WarningPrintf(...) Log::Writef(___LogChannel___, __func__, LOGLEVEL_WARNING, __VA_ARGS__)
-#define Log_PerfPrint(msg) Log::Write(___LogChannel___, __func__, LOGLEVEL_PERF, msg)
-#define Log_PerfPrintf(...) Log::Writef(___LogChannel___, __func__, LOGLEVEL_PERF, __VA_ARGS__)
-#define Log_InfoPrint(msg) Log::Write(___LogChannel___, __func__, LOGLEVEL_INFO, msg)
-#define Log_InfoPrintf(...) Log::Writef(___LogChannel___, __func__, LOGLEVEL_INFO, __VA_ARGS__)
-#define Log_VerbosePrint(msg) Log::Write(___LogChannel___, __func__, LOGLEVEL_VERBOSE, msg)
-#define Log_VerbosePrintf(...) Log::Writef(___LogChannel___, __func__, LOGLEVEL_VERBOSE, __VA_ARGS__)
-#define Log_DevPrint(msg) Log::Write(___LogChannel___, __func__, LOGLEVEL_DEV, msg)
-#define Log_DevPrintf(...) Log::Writef(___LogChannel___, __func__, LOGLEVEL_DEV, __VA_ARGS__)
-#define Log_ProfilePrint(msg) Log::Write(___LogChannel___, __func__, LOGLEVEL_PROFILE, msg)
-#define Log_ProfilePrintf(...) Log::Writef(___LogChannel___, __func__, LOGLEVEL_PROFILE, __VA_ARGS__)
+// A source file's log channel. Holds the most verbose level which any sink would accept from the channel, so the log
+// wrappers can skip disabled messages with a single branch before evaluating any of their arguments.
+class Channel
+{
+public:
+  explicit Channel(const char* name);
+
+  ALWAYS_INLINE const char* GetName() const { return m_name; }
+  ALWAYS_INLINE Channel* GetNext() const { return m_next; }
+
+  ALWAYS_INLINE bool IsLevelEnabled(LOGLEVEL level) const
+  {
+    return (static_cast<u32>(level) <= m_level.load(std::memory_order_relaxed));
+  }
+  ALWAYS_INLINE void SetLevel(LOGLEVEL level) { m_level.store(static_cast<u32>(level), std::memory_order_relaxed); }
 
+private:
+  const char* m_name;
+  Channel* m_next;
+  std::atomic<u32> m_level;
+};
+} // namespace Log
+
+// Messages more verbose than this are compiled out, including their arguments. Defaults to leaving out debug and trace
+// messages from release builds, define it to one of the LOGLEVEL values to override.
+#ifndef LOG_MAX_COMPILED_LEVEL
 #ifdef _DEBUG
-#define Log_DebugPrint(msg) Log::Write(___LogChannel___, __func__, LOGLEVEL_DEBUG, msg)
-#define Log_DebugPrintf(...) Log::Writef(___LogChannel___, __func__, LOGLEVEL_DEBUG, __VA_ARGS__)
-#define Log_TracePrint(msg) Log::Write(___LogChannel___, __func__, LOGLEVEL_TRACE, msg)
-#define Log_TracePrintf(...) Log::Writef(___LogChannel___, __func__, LOGLEVEL_TRACE, __VA_ARGS__)
+#define LOG_MAX_COMPILED_LEVEL 9 // LOGLEVEL_TRACE
 #else
-#define Log_DebugPrint(msg)                                                                                            \
-  do                                                                                                                   \
-  {                                                                                                                    \
-  } while (0)
-#define Log_DebugPrintf(...)                                                                                           \
+#define LOG_MAX_COMPILED_LEVEL 7 // LOGLEVEL_PROFILE
+#endif
+#endif
+
+// log wrappers
+#define Log_SetChannel(ChannelName) static Log::Channel ___LogChannel___(#ChannelName);
+
+#define Log_ChannelWrite(level, msg)                                                                                   \
   do                                                                                                                   \
   {                                                                                                                    \
+    if (___LogChannel___.IsLevelEnabled(level))                                                                        \
+      Log::Write(___LogChannel___.GetName(), __func__, level, msg);                                                    \
   } while (0)
-#define Log_TracePrint(msg)                                                                                            \
+#define Log_ChannelWritef(level, ...)                                                                                  \
   do                                                                                                                   \
   {                                                                                                                    \
+    if (___LogChannel___.IsLevelEnabled(level))                                                                        \
+      Log::Writef(___LogChannel___.GetName(), __func__, level, __VA_ARGS__);                                           \
   } while (0)
-#define Log_TracePrintf(...)                                                                                           \
+#define Log_CompiledOut()                                                                                              \
   do                                                                                                                   \
   {                                                                                                                    \
   } while (0)
+
+
+#if LOG_MAX_COMPILED_LEVEL >= 1
+#define Log_ErrorPrint(msg) Log_ChannelWrite(LOGLEVEL_ERROR, msg)
+#define Log_ErrorPrintf(...) Log_ChannelWritef(LOGLEVEL_ERROR, __VA_ARGS__)
+#else
+#define Log_ErrorPrint(msg) Log_CompiledOut()
+#define Log_ErrorPrintf(...) Log_CompiledOut()
+#endif
+
+#if LOG_MAX_COMPILED_LEVEL >= 2
+#define Log_WarningPrint(msg) Log_ChannelWrite(LOGLEVEL_WARNING, msg)
+#define Log_WarningPrintf(...) Log_ChannelWritef(LOGLEVEL_WARNING, __VA_ARGS__)
+#else
+#define Log_WarningPrint(msg) Log_CompiledOut()
+#define Log_WarningPrintf(...) Log_CompiledOut()
+#endif
+
+#if LOG_MAX_COMPILED_LEVEL >= 3
+#define Log_PerfPrint(msg) Log_ChannelWrite(LOGLEVEL_PERF, msg)
+#define Log_PerfPrintf(...) Log_ChannelWritef(LOGLEVEL_PERF, __VA_ARGS__)
+#else
+#define Log_PerfPrint(msg) Log_CompiledOut()
+#define Log_PerfPrintf(...) Log_CompiledOut()
+#endif
+
+#if LOG_MAX_COMPILED_LEVEL >= 4
+#define Log_InfoPrint(msg) Log_ChannelWrite(LOGLEVEL_INFO, msg)
+#define Log_InfoPrintf(...) Log_ChannelWritef(LOGLEVEL_INFO, __VA_ARGS__)
+#else
+#define Log_InfoPrint(msg) Log_CompiledOut()
+#define Log_InfoPrintf(...) Log_CompiledOut()
+#endif
+
+#if LOG_MAX_COMPILED_LEVEL >= 5
+#define Log_VerbosePrint(msg) Log_ChannelWrite(LOGLEVEL_VERBOSE, msg)
+#define Log_VerbosePrintf(...) Log_ChannelWritef(LOGLEVEL_VERBOSE, __VA_ARGS__)
+#else
+#define Log_VerbosePrint(msg) Log_CompiledOut()
+#define Log_VerbosePrintf(...) Log_CompiledOut()
+#endif
+
+#if LOG_MAX_COMPILED_LEVEL >= 6
+#define Log_DevPrint(msg) Log_ChannelWrite(LOGLEVEL_DEV, msg)
+#define Log_DevPrintf(...) Log_ChannelWritef(LOGLEVEL_DEV, __VA_ARGS__)
+#else
+#define Log_DevPrint(msg) Log_CompiledOut()
+#define Log_DevPrintf(...) Log_CompiledOut()
+#endif
+
+#if LOG_MAX_COMPILED_LEVEL >= 7
+#define Log_ProfilePrint(msg) Log_ChannelWrite(LOGLEVEL_PROFILE, msg)
+#define Log_ProfilePrintf(...) Log_ChannelWritef(LOGLEVEL_PROFILE, __VA_ARGS__)
+#else
+#define Log_ProfilePrint(msg) Log_CompiledOut()
+#define Log_ProfilePrintf(...) Log_CompiledOut()
+#endif
+
+#if LOG_MAX_COMPILED_LEVEL >= 8
+#define Log_DebugPrint(msg) Log_ChannelWrite(LOGLEVEL_DEBUG, msg)
+#define Log_DebugPrintf(...) Log_ChannelWritef(LOGLEVEL_DEBUG, __VA_ARGS__)
+#else
+#define Log_DebugPrint(msg) Log_CompiledOut()
+#define Log_DebugPrintf(...) Log_CompiledOut()
+#endif
+
+#if LOG_MAX_COMPILED_LEVEL >= 9
+#define Log_TracePrint(msg) Log_ChannelWrite(LOGLEVEL_TRACE, msg)
+#define Log_TracePrintf(...) Log_ChannelWritef(LOGLEVEL_TRACE, __VA_ARGS__)
+#else
+#define Log_TracePrint(msg) Log_CompiledOut()
+#define Log_TracePrintf(...) Log_CompiledOut()
 #endif
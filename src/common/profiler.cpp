@@ -0,0 +1,196 @@
+#include "profiler.h"
+
+#ifdef WITH_PROFILER
+
+#include "file_system.h"
+#include "log.h"
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+Log_SetChannel(Profiler);
+
+namespace Profiler {
+
+namespace {
+struct Zone
+{
+  const char* name;
+  Common::Timer::Value start_time;
+  Common::Timer::Value end_time;
+};
+
+struct ThreadBuffer
+{
+  // only contended when a capture is being started or written out
+  std::mutex lock;
+  std::vector<Zone> zones;
+  std::string name;
+  u32 id;
+  u32 dropped_zones;
+};
+} // namespace
+
+// ~24MB per thread, the CPU thread records a few thousand zones per frame
+static constexpr u32 MAX_ZONES_PER_THREAD = 1024 * 1024;
+
+static ThreadBuffer* GetThreadBuffer();
+static void WriteEscapedString(std::FILE* fp, const char* str);
+
+std::atomic_bool g_capturing{false};
+
+static std::mutex s_buffers_lock;
+static std::vector<std::unique_ptr<ThreadBuffer>> s_buffers;
+static Common::Timer::Value s_capture_start_time = 0;
+
+// buffers outlive their threads, so zones from worker threads which exit mid-capture are kept
+static thread_local ThreadBuffer* s_thread_buffer = nullptr;
+
+} // namespace Profiler
+
+Profiler::ThreadBuffer* Profiler::GetThreadBuffer()
+{
+  if (s_thread_buffer)
+    return s_thread_buffer;
+
+  std::unique_lock lock(s_buffers_lock);
+  std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+  buffer->id = static_cast<u32>(s_buffers.size()) + 1;
+  buffer->dropped_zones = 0;
+  s_thread_buffer = buffer.get();
+  s_buffers.push_back(std::move(buffer));
+  return s_thread_buffer;
+}
+
+void Profiler::SetCurrentThreadName(const char* name)
+{
+  ThreadBuffer* buffer = GetThreadBuffer();
+  std::unique_lock lock(buffer->lock);
+  buffer->name = name;
+}
+
+void Profiler::AddZone(const char* name, Common::Timer::Value start_time, Common::Timer::Value end_time)
+{
+  ThreadBuffer* buffer = GetThreadBuffer();
+  std::unique_lock lock(buffer->lock);
+  if (buffer->zones.size() >= MAX_ZONES_PER_THREAD)
+  {
+    buffer->dropped_zones++;
+    return;
+  }
+
+  buffer->zones.push_back(Zone{name, start_time, end_time});
+}
+
+void Profiler::StartCapture()
+{
+  std::unique_lock lock(s_buffers_lock);
+  for (const std::unique_ptr<ThreadBuffer>& buffer : s_buffers)
+  {
+    std::unique_lock buffer_lock(buffer->lock);
+    buffer->zones.clear();
+    buffer->dropped_zones = 0;
+  }
+
+  s_capture_start_time = Common::Timer::GetCurrentValue();
+  g_capturing.store(true, std::memory_order_release);
+}
+
+void Profiler::WriteEscapedString(std::FILE* fp, const char* str)
+{
+  std::fputc('"', fp);
+  for (; *str != '\0'; str++)
+  {
+    const char ch = *str;
+    if (ch == '"' || ch == '\\')
+    {
+      std::fputc('\\', fp);
+      std::fputc(ch, fp);
+    }
+    else if (static_cast<unsigned char>(ch) < 0x20)
+    {
+      std::fprintf(fp, "\\u%04x", static_cast<unsigned>(ch));
+    }
+    else
+    {
+      std::fputc(ch, fp);
+    }
+  }
+  std::fputc('"', fp);
+}
+
+bool Profiler::StopCapture(const char* filename)
+{
+  g_capturing.store(false, std::memory_order_release);
+
+  std::FILE* fp = FileSystem::OpenCFile(filename, "wb");
+  if (!fp)
+  {
+    Log_ErrorPrintf("Failed to open '%s' for writing", filename);
+    return false;
+  }
+
+  std::unique_lock lock(s_buffers_lock);
+  u32 num_zones = 0;
+  bool first = true;
+
+  std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", fp);
+  for (const std::unique_ptr<ThreadBuffer>& buffer : s_buffers)
+  {
+    std::unique_lock buffer_lock(buffer->lock);
+    if (buffer->zones.empty())
+      continue;
+
+    if (!buffer->name.empty())
+    {
+      std::fprintf(fp, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+                   first ? "" : ",", buffer->id);
+      WriteEscapedString(fp, buffer->name.c_str());
+      std::fputs("}}", fp);
+      first = false;
+    }
+
+    for (const Zone& zone : buffer->zones)
+    {
+      // zones which were started during a previous capture
+      if (zone.start_time < s_capture_start_time)
+        continue;
+
+      const double start_us =
+        Common::Timer::ConvertValueToNanoseconds(zone.start_time - s_capture_start_time) / 1000.0;
+      const double duration_us = Common::Timer::ConvertValueToNanoseconds(zone.end_time - zone.start_time) / 1000.0;
+      std::fprintf(fp, "%s\n{\"name\":", first ? "" : ",");
+      WriteEscapedString(fp, zone.name);
+      std::fprintf(fp, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", buffer->id, start_us,
+                   duration_us);
+      first = false;
+      num_zones++;
+    }
+
+    if (buffer->dropped_zones > 0)
+    {
+      Log_WarningPrintf("Dropped %u zones from thread %u ('%s'), buffer was full", buffer->dropped_zones, buffer->id,
+                        buffer->name.c_str());
+    }
+
+    // don't hang on to the memory until the next capture
+    std::vector<Zone>().swap(buffer->zones);
+    buffer->dropped_zones = 0;
+  }
+  std::fputs("\n]}\n", fp);
+
+  const bool result = (std::ferror(fp) == 0);
+  std::fclose(fp);
+
+  if (!result)
+  {
+    Log_ErrorPrintf("Failed to write trace to '%s'", filename);
+    return false;
+  }
+
+  Log_InfoPrintf("Wrote %u zones to '%s'", num_zones, filename);
+  return true;
+}
+
+#endif // WITH_PROFILER
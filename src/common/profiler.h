@@ -0,0 +1,70 @@
+#pragma once
+#include "types.h"
+
+// Scoped zone profiler. Only built when WITH_PROFILER is defined, otherwise PROFILE_SCOPE() compiles to nothing.
+// Zones are recorded into per-thread buffers while a capture is running, and written out as a Chrome trace
+// (chrome://tracing, Perfetto, Speedscope) when the capture is stopped.
+
+#ifdef WITH_PROFILER
+
+#include "timer.h"
+#include <atomic>
+
+namespace Profiler {
+
+extern std::atomic_bool g_capturing;
+
+ALWAYS_INLINE static bool IsCapturing()
+{
+  return g_capturing.load(std::memory_order_relaxed);
+}
+
+/// Discards any previously recorded zones, and starts recording.
+void StartCapture();
+
+/// Stops recording, and writes the zones recorded since StartCapture() to the specified file.
+bool StopCapture(const char* filename);
+
+/// Sets the name the current thread is shown as in the trace. Called by Threading::SetNameOfCurrentThread().
+void SetCurrentThreadName(const char* name);
+
+/// Records a completed zone for the current thread. Name must be a string literal, only the pointer is stored.
+void AddZone(const char* name, Common::Timer::Value start_time, Common::Timer::Value end_time);
+
+class ScopedZone
+{
+public:
+  ALWAYS_INLINE ScopedZone(const char* name)
+    : m_name(name), m_start_time(IsCapturing() ? Common::Timer::GetCurrentValue() : 0)
+  {
+  }
+
+  ALWAYS_INLINE ~ScopedZone()
+  {
+    // zones which were open when the capture started are dropped, rather than given a bogus start time
+    if (m_start_time != 0 && IsCapturing())
+      AddZone(m_name, m_start_time, Common::Timer::GetCurrentValue());
+  }
+
+  ScopedZone(const ScopedZone&) = delete;
+  ScopedZone& operator=(const ScopedZone&) = delete;
+
+private:
+  const char* m_name;
+  Common::Timer::Value m_start_time;
+};
+
+} // namespace Profiler
+
+#define PROFILE_SCOPE_CONCAT_(a, b) a##b
+#define PROFILE_SCOPE_CONCAT(a, b) PROFILE_SCOPE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) Profiler::ScopedZone PROFILE_SCOPE_CONCAT(profile_zone_, __LINE__)(name)
+
+#else
+
+#define PROFILE_SCOPE(name)                                                                                            \
+  do                                                                                                                   \
+  {                                                                                                                    \
+  } while (0)
+
+#endif
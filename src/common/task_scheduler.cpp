@@ -0,0 +1,214 @@
+#include "task_scheduler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace Threading {
+
+// set on worker threads, so tasks scheduled from a task go to that worker's own queue
+static thread_local TaskScheduler* s_worker_scheduler = nullptr;
+static thread_local u32 s_worker_index = 0;
+
+TaskScheduler::TaskScheduler(u32 num_workers, ThreadPriority worker_priority, const char* name)
+{
+  if (num_workers == 0)
+    num_workers = std::max(std::thread::hardware_concurrency(), 1u);
+
+  m_queues.reserve(num_workers);
+  for (u32 i = 0; i < num_workers; i++)
+    m_queues.push_back(std::make_unique<WorkerQueue>());
+
+  m_workers.reserve(num_workers);
+  for (u32 i = 0; i < num_workers; i++)
+    m_workers.emplace_back(&TaskScheduler::WorkerThread, this, i, worker_priority, name);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  {
+    std::unique_lock lock(m_wake_mutex);
+    m_shutdown = true;
+  }
+  m_wake_cv.notify_all();
+
+  for (std::thread& worker : m_workers)
+    worker.join();
+}
+
+TaskScheduler& TaskScheduler::GetShared()
+{
+  static TaskScheduler scheduler(std::max(std::thread::hardware_concurrency(), 2u) - 1, ThreadPriority::Background,
+                                 "Shared Task Worker");
+  return scheduler;
+}
+
+bool TaskScheduler::IsWorkerThread() const
+{
+  return (s_worker_scheduler == this);
+}
+
+void TaskScheduler::Schedule(TaskFunction func, Priority priority)
+{
+  Enqueue(Task{std::move(func), nullptr}, priority);
+}
+
+void TaskScheduler::Enqueue(Task task, Priority priority)
+{
+  const u32 index = IsWorkerThread() ? s_worker_index :
+                                       (m_next_queue.fetch_add(1, std::memory_order_relaxed) % GetWorkerCount());
+
+  // counted under the wake lock, so a worker can't see no tasks and then miss the notification. this happens before
+  // the task is visible, otherwise a worker could pop it and take the count below zero; a worker which sees the count
+  // first just goes round again until the task is there.
+  {
+    std::unique_lock lock(m_wake_mutex);
+    m_queued_tasks.fetch_add(1, std::memory_order_release);
+  }
+
+  {
+    WorkerQueue& queue = *m_queues[index];
+    std::unique_lock lock(queue.mutex);
+    queue.tasks[static_cast<u8>(priority)].push_back(std::move(task));
+  }
+
+  m_wake_cv.notify_one();
+}
+
+bool TaskScheduler::PopTask(u32 worker_index, Task* task)
+{
+  const bool is_worker = IsWorkerThread();
+  const u32 num_queues = GetWorkerCount();
+  for (u32 priority = 0; priority < static_cast<u8>(Priority::Count); priority++)
+  {
+    // own queue newest first, since whatever scheduled it is probably still in cache. steal the oldest from others.
+    if (is_worker)
+    {
+      WorkerQueue& queue = *m_queues[worker_index];
+      std::unique_lock lock(queue.mutex);
+      std::deque<Task>& tasks = queue.tasks[priority];
+      if (!tasks.empty())
+      {
+        *task = std::move(tasks.back());
+        tasks.pop_back();
+        m_queued_tasks.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+
+    for (u32 i = is_worker ? 1 : 0; i < num_queues; i++)
+    {
+      WorkerQueue& queue = *m_queues[(worker_index + i) % num_queues];
+      std::unique_lock lock(queue.mutex);
+      std::deque<Task>& tasks = queue.tasks[priority];
+      if (!tasks.empty())
+      {
+        *task = std::move(tasks.front());
+        tasks.pop_front();
+        m_queued_tasks.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+void TaskScheduler::RunTask(Task& task)
+{
+  TaskGroup* group = task.group;
+  if (!group || !group->IsCancelled())
+    task.func();
+
+  // release anything captured before the group can be destroyed by whoever is waiting on it
+  task.func = {};
+  if (group)
+    group->TaskDone();
+}
+
+bool TaskScheduler::TryRunTask()
+{
+  Task task;
+  if (!PopTask(IsWorkerThread() ? s_worker_index : 0, &task))
+    return false;
+
+  RunTask(task);
+  return true;
+}
+
+void TaskScheduler::WorkerThread(u32 index, ThreadPriority priority, const char* name)
+{
+  SetNameOfCurrentThread(name);
+  if (priority != ThreadPriority::Normal)
+    SetCurrentThreadPriority(priority);
+
+  s_worker_scheduler = this;
+  s_worker_index = index;
+
+  Task task;
+  for (;;)
+  {
+    if (PopTask(index, &task))
+    {
+      RunTask(task);
+      continue;
+    }
+
+    // anything still queued at shutdown is run first
+    std::unique_lock lock(m_wake_mutex);
+    if (m_queued_tasks.load(std::memory_order_acquire) > 0)
+      continue;
+    if (m_shutdown)
+      break;
+
+    m_wake_cv.wait(lock, [this]() { return (m_shutdown || m_queued_tasks.load(std::memory_order_acquire) > 0); });
+  }
+
+  s_worker_scheduler = nullptr;
+}
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler) : m_scheduler(scheduler) {}
+
+TaskGroup::~TaskGroup()
+{
+  Wait();
+}
+
+void TaskGroup::Run(TaskScheduler::TaskFunction func, TaskScheduler::Priority priority)
+{
+  m_pending.fetch_add(1, std::memory_order_relaxed);
+  m_scheduler.Enqueue(TaskScheduler::Task{std::move(func), this}, priority);
+}
+
+void TaskGroup::Cancel()
+{
+  m_cancelled.store(true, std::memory_order_relaxed);
+}
+
+void TaskGroup::TaskDone()
+{
+  // under the lock, so a waiter which sees the count reach zero can't destroy the group before we're done with it
+  std::unique_lock lock(m_mutex);
+  if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    m_done_cv.notify_all();
+}
+
+void TaskGroup::Wait()
+{
+  for (;;)
+  {
+    {
+      std::unique_lock lock(m_mutex);
+      if (m_pending.load(std::memory_order_acquire) == 0)
+        return;
+    }
+
+    if (m_scheduler.TryRunTask())
+      continue;
+
+    // the remaining tasks are running elsewhere, but they can queue more, so check back for work now and again
+    std::unique_lock lock(m_mutex);
+    m_done_cv.wait_for(lock, std::chrono::milliseconds(1),
+                       [this]() { return (m_pending.load(std::memory_order_acquire) == 0); });
+  }
+}
+
+} // namespace Threading
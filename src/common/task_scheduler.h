@@ -0,0 +1,118 @@
+#pragma once
+#include "threading.h"
+#include "types.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Threading {
+
+class TaskGroup;
+
+/// Runs tasks on a fixed set of workers. Each worker has its own queue, which tasks scheduled from that worker go to;
+/// idle workers steal from the others, oldest first. Higher priority tasks are always taken before lower ones.
+class TaskScheduler
+{
+public:
+  enum class Priority : u8
+  {
+    High,
+    Normal,
+    Low,
+    Count
+  };
+
+  using TaskFunction = std::function<void()>;
+
+  /// Zero workers uses one per logical core.
+  explicit TaskScheduler(u32 num_workers = 0, ThreadPriority worker_priority = ThreadPriority::Normal,
+                         const char* name = "Task Worker");
+  ~TaskScheduler();
+
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+  /// Returns the scheduler shared by the whole program, which runs at background priority, leaving a core for the
+  /// CPU thread. Created on first use.
+  static TaskScheduler& GetShared();
+
+  ALWAYS_INLINE u32 GetWorkerCount() const { return static_cast<u32>(m_workers.size()); }
+
+  /// Returns true if the calling thread is one of this scheduler's workers.
+  bool IsWorkerThread() const;
+
+  /// Queues a task which isn't part of any group. Tasks still queued when the scheduler is destroyed are run first.
+  void Schedule(TaskFunction func, Priority priority = Priority::Normal);
+
+  /// Runs one queued task on the calling thread, if there are any. Used when waiting, so that waiting from a task
+  /// can't leave the workers with nothing to run the tasks being waited on.
+  bool TryRunTask();
+
+private:
+  friend TaskGroup;
+
+  struct Task
+  {
+    TaskFunction func;
+    TaskGroup* group;
+  };
+
+  struct WorkerQueue
+  {
+    std::mutex mutex;
+    std::deque<Task> tasks[static_cast<u8>(Priority::Count)];
+  };
+
+  void Enqueue(Task task, Priority priority);
+  bool PopTask(u32 worker_index, Task* task);
+  void RunTask(Task& task);
+  void WorkerThread(u32 index, ThreadPriority priority, const char* name);
+
+  std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+  std::vector<std::thread> m_workers;
+
+  // sleeping workers wait for the queued count to become non-zero
+  std::mutex m_wake_mutex;
+  std::condition_variable m_wake_cv;
+  std::atomic<u32> m_queued_tasks{0};
+  std::atomic<u32> m_next_queue{0};
+  bool m_shutdown = false;
+};
+
+/// Tracks a set of tasks so they can be waited on or cancelled together. Tasks which haven't started when the group
+/// is cancelled are skipped, running tasks can poll IsCancelled() to stop early. Destroying the group waits.
+class TaskGroup
+{
+public:
+  explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::GetShared());
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  ALWAYS_INLINE bool IsCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+  void Run(TaskScheduler::TaskFunction func, TaskScheduler::Priority priority = TaskScheduler::Priority::Normal);
+  void Cancel();
+
+  /// Waits for every task in the group to finish or be skipped, running queued tasks in the meantime.
+  void Wait();
+
+private:
+  friend TaskScheduler;
+
+  void TaskDone();
+
+  TaskScheduler& m_scheduler;
+  std::mutex m_mutex;
+  std::condition_variable m_done_cv;
+  std::atomic<u32> m_pending{0};
+  std::atomic_bool m_cancelled{false};
+};
+
+} // namespace Threading
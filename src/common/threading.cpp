@@ -1,5 +1,6 @@
 #include "threading.h"
 #include "assert.h"
+#include "profiler.h"
 #include <memory>
 
 #if !defined(_WIN32) && !defined(__APPLE__)
@@ -17,6 +18,7 @@
 #if defined(__linux__)
 #include <sched.h>
 #include <sys/prctl.h>
+#include <sys/resource.h>
 #include <sys/types.h>
 
 // glibc < v2.30 doesn't define gettid...
@@ -30,6 +32,7 @@
 #include <mach/mach_time.h>
 #include <mach/semaphore.h>
 #include <mach/task.h>
+#include <pthread/qos.h>
 #else
 #include <pthread_np.h>
 #endif
@@ -98,6 +101,35 @@ void Threading::Timeslice()
 #endif
 }
 
+bool Threading::SetCurrentThreadPriority(ThreadPriority priority)
+{
+#if defined(_WIN32)
+  static constexpr int priorities[] = {THREAD_PRIORITY_BELOW_NORMAL, THREAD_PRIORITY_NORMAL,
+                                       THREAD_PRIORITY_ABOVE_NORMAL};
+  const bool result = (SetThreadPriority(GetCurrentThread(), priorities[static_cast<u8>(priority)]) != FALSE);
+
+#ifdef THREAD_POWER_THROTTLING_CURRENT_VERSION
+  // EcoQoS, which is what puts threads on the efficiency cores of hybrid CPUs. Only Windows 11 honours it.
+  THREAD_POWER_THROTTLING_STATE state = {};
+  state.Version = THREAD_POWER_THROTTLING_CURRENT_VERSION;
+  state.ControlMask = THREAD_POWER_THROTTLING_EXECUTION_SPEED;
+  state.StateMask = (priority == ThreadPriority::Background) ? THREAD_POWER_THROTTLING_EXECUTION_SPEED : 0;
+  SetThreadInformation(GetCurrentThread(), ThreadPowerThrottling, &state, sizeof(state));
+#endif
+
+  return result;
+#elif defined(__APPLE__)
+  static constexpr qos_class_t classes[] = {QOS_CLASS_UTILITY, QOS_CLASS_USER_INITIATED, QOS_CLASS_USER_INTERACTIVE};
+  return (pthread_set_qos_class_self_np(classes[static_cast<u8>(priority)], 0) == 0);
+#elif defined(__linux__)
+  // nice values are per-thread on linux, despite what POSIX says
+  static constexpr int nice_values[] = {10, 0, -5};
+  return (setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), nice_values[static_cast<u8>(priority)]) == 0);
+#else
+  return false;
+#endif
+}
+
 Threading::ThreadHandle::ThreadHandle() = default;
 
 #ifdef _WIN32
@@ -556,6 +588,10 @@ void Threading::SetNameOfCurrentThread(const char* name)
 #else
   pthread_set_name_np(pthread_self(), name);
 #endif
+
+#ifdef WITH_PROFILER
+  Profiler::SetCurrentThreadName(name);
+#endif
 }
 
 Threading::KernelSemaphore::KernelSemaphore()
@@ -20,6 +20,17 @@ extern void SetNameOfCurrentThread(const char* name);
 // Releases a timeslice to other threads.
 extern void Timeslice();
 
+enum class ThreadPriority : u8
+{
+  Background, ///< Throughput work, which can go to efficiency cores.
+  Normal,
+  High, ///< Latency sensitive work, like the CPU thread.
+};
+
+/// Sets the scheduling priority of the calling thread, as well as its QoS class on platforms which have them, which
+/// steers it between performance and efficiency cores. Raising the priority may need privileges on Linux.
+extern bool SetCurrentThreadPriority(ThreadPriority priority);
+
 // --------------------------------------------------------------------------------------
 //  ThreadHandle
 // --------------------------------------------------------------------------------------
@@ -32,6 +32,11 @@ VkDescriptorSetLayout DescriptorSetLayoutBuilder::Create(VkDevice device)
   return layout;
 }
 
+void DescriptorSetLayoutBuilder::SetPushFlag()
+{
+  m_ci.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+}
+
 void DescriptorSetLayoutBuilder::AddBinding(u32 binding, VkDescriptorType dtype, u32 dcount, VkShaderStageFlags stages)
 {
   Assert(m_ci.bindingCount < MAX_BINDINGS);
@@ -402,6 +407,47 @@ void GraphicsPipelineBuilder::SetRenderPass(VkRenderPass render_pass, u32 subpas
   m_ci.subpass = subpass;
 }
 
+ComputePipelineBuilder::ComputePipelineBuilder()
+{
+  Clear();
+}
+
+void ComputePipelineBuilder::Clear()
+{
+  m_ci = {};
+  m_ci.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  m_ci.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  m_ci.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+}
+
+VkPipeline ComputePipelineBuilder::Create(VkDevice device, VkPipelineCache pipeline_cache /* = VK_NULL_HANDLE */,
+                                          bool clear /* = true */)
+{
+  VkPipeline pipeline;
+  VkResult res = vkCreateComputePipelines(device, pipeline_cache, 1, &m_ci, nullptr, &pipeline);
+  if (res != VK_SUCCESS)
+  {
+    LOG_VULKAN_ERROR(res, "vkCreateComputePipelines() failed: ");
+    return VK_NULL_HANDLE;
+  }
+
+  if (clear)
+    Clear();
+
+  return pipeline;
+}
+
+void ComputePipelineBuilder::SetShader(VkShaderModule module, const char* entry_point /* = "main" */)
+{
+  m_ci.stage.module = module;
+  m_ci.stage.pName = entry_point;
+}
+
+void ComputePipelineBuilder::SetPipelineLayout(VkPipelineLayout layout)
+{
+  m_ci.layout = layout;
+}
+
 SamplerBuilder::SamplerBuilder()
 {
   Clear();
@@ -471,6 +517,7 @@ void DescriptorSetUpdateBuilder::Clear()
 {
   m_writes = {};
   m_num_writes = 0;
+  m_num_infos = 0;
 }
 
 void DescriptorSetUpdateBuilder::Update(VkDevice device, bool clear /*= true*/)
@@ -483,6 +530,17 @@ void DescriptorSetUpdateBuilder::Update(VkDevice device, bool clear /*= true*/)
     Clear();
 }
 
+void DescriptorSetUpdateBuilder::PushUpdate(VkCommandBuffer cmdbuf, VkPipelineBindPoint bind_point,
+                                            VkPipelineLayout layout, u32 set /*= 0*/, bool clear /*= true*/)
+{
+  Assert(m_num_writes > 0);
+
+  vkCmdPushDescriptorSetKHR(cmdbuf, bind_point, layout, set, m_num_writes, m_writes.data());
+
+  if (clear)
+    Clear();
+}
+
 void DescriptorSetUpdateBuilder::AddImageDescriptorWrite(
   VkDescriptorSet set, u32 binding, VkImageView view,
   VkImageLayout layout /*= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL*/)
@@ -503,6 +561,25 @@ void DescriptorSetUpdateBuilder::AddImageDescriptorWrite(
   dw.pImageInfo = &ii;
 }
 
+void DescriptorSetUpdateBuilder::AddStorageImageDescriptorWrite(VkDescriptorSet set, u32 binding, VkImageView view,
+                                                                VkImageLayout layout /*= VK_IMAGE_LAYOUT_GENERAL*/)
+{
+  Assert(m_num_writes < MAX_WRITES && m_num_infos < MAX_INFOS);
+
+  VkDescriptorImageInfo& ii = m_infos[m_num_infos++].image;
+  ii.imageView = view;
+  ii.imageLayout = layout;
+  ii.sampler = VK_NULL_HANDLE;
+
+  VkWriteDescriptorSet& dw = m_writes[m_num_writes++];
+  dw.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  dw.dstSet = set;
+  dw.dstBinding = binding;
+  dw.descriptorCount = 1;
+  dw.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+  dw.pImageInfo = &ii;
+}
+
 void DescriptorSetUpdateBuilder::AddSamplerDescriptorWrite(VkDescriptorSet set, u32 binding, VkSampler sampler)
 {
   Assert(m_num_writes < MAX_WRITES && m_num_infos < MAX_INFOS);
@@ -19,6 +19,9 @@ public:
 
   VkDescriptorSetLayout Create(VkDevice device);
 
+  /// The layout can only be used with vkCmdPushDescriptorSetKHR(), not allocated from pools.
+  void SetPushFlag();
+
   void AddBinding(u32 binding, VkDescriptorType dtype, u32 dcount, VkShaderStageFlags stages);
 
 private:
@@ -138,6 +141,22 @@ private:
   VkPipelineMultisampleStateCreateInfo m_multisample_state;
 };
 
+class ComputePipelineBuilder
+{
+public:
+  ComputePipelineBuilder();
+
+  void Clear();
+
+  VkPipeline Create(VkDevice device, VkPipelineCache pipeline_cache = VK_NULL_HANDLE, bool clear = true);
+
+  void SetShader(VkShaderModule module, const char* entry_point = "main");
+  void SetPipelineLayout(VkPipelineLayout layout);
+
+private:
+  VkComputePipelineCreateInfo m_ci;
+};
+
 class SamplerBuilder
 {
 public:
@@ -172,9 +191,15 @@ public:
 
   void Update(VkDevice device, bool clear = true);
 
+  /// Pushes the writes into the command buffer instead of writing a set. The set handles in the writes are ignored.
+  void PushUpdate(VkCommandBuffer cmdbuf, VkPipelineBindPoint bind_point, VkPipelineLayout layout, u32 set = 0,
+                  bool clear = true);
+
   void AddImageDescriptorWrite(VkDescriptorSet set, u32 binding, VkImageView view,
                                VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
   void AddSamplerDescriptorWrite(VkDescriptorSet set, u32 binding, VkSampler sampler);
+  void AddStorageImageDescriptorWrite(VkDescriptorSet set, u32 binding, VkImageView view,
+                                      VkImageLayout layout = VK_IMAGE_LAYOUT_GENERAL);
   void AddCombinedImageSamplerDescriptorWrite(VkDescriptorSet set, u32 binding, VkImageView view, VkSampler sampler,
                                               VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
   void AddBufferDescriptorWrite(VkDescriptorSet set, u32 binding, VkDescriptorType dtype, VkBuffer buffer, u32 offset,
@@ -2,7 +2,9 @@
 #include "../assert.h"
 #include "../log.h"
 #include "../string_util.h"
+#include "../timer.h"
 #include "../window_info.h"
+#include "builders.h"
 #include "swap_chain.h"
 #include "util.h"
 #include <algorithm>
@@ -269,7 +271,8 @@ Vulkan::Context::GPUNameList Vulkan::Context::EnumerateGPUNames(VkInstance insta
 
 bool Vulkan::Context::Create(std::string_view gpu_name, const WindowInfo* wi,
                              std::unique_ptr<SwapChain>* out_swap_chain, bool threaded_presentation,
-                             bool enable_debug_utils, bool enable_validation_layer)
+                             bool enable_debug_utils, bool enable_validation_layer,
+                             u32 frames_in_flight /* = DEFAULT_COMMAND_BUFFERS */)
 {
   AssertMsg(!g_vulkan_context, "Has no current context");
 
@@ -340,6 +343,8 @@ bool Vulkan::Context::Create(std::string_view gpu_name, const WindowInfo* wi,
   }
 
   g_vulkan_context.reset(new Context(instance, gpus[gpu_index], true));
+  g_vulkan_context->m_num_command_buffers = std::clamp<u32>(frames_in_flight, 1, MAX_COMMAND_BUFFERS);
+  Log_InfoPrintf("Using %u frames in flight", g_vulkan_context->m_num_command_buffers);
 
   // Enable debug reports if the "Host GPU" log category is enabled.
   if (enable_debug_utils)
@@ -471,6 +476,7 @@ bool Vulkan::Context::SelectDeviceExtensions(ExtensionList* extension_list, bool
 
   m_optional_extensions.vk_ext_memory_budget = SupportsExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, false);
   m_optional_extensions.vk_khr_driver_properties = SupportsExtension(VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, false);
+  m_optional_extensions.vk_khr_push_descriptor = SupportsExtension(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME, false);
 
   return true;
 }
@@ -654,6 +660,13 @@ void Vulkan::Context::ProcessDeviceExtensions()
 
   // query
   vkGetPhysicalDeviceProperties2(m_physical_device, &properties2);
+
+  // some loaders advertise the extension without the entry point
+  if (m_optional_extensions.vk_khr_push_descriptor && !vkCmdPushDescriptorSetKHR)
+    m_optional_extensions.vk_khr_push_descriptor = false;
+
+  Log_InfoPrintf("VK_KHR_push_descriptor is %s",
+                 m_optional_extensions.vk_khr_push_descriptor ? "supported" : "NOT supported");
 }
 
 bool Vulkan::Context::CreateAllocator()
@@ -691,9 +704,9 @@ bool Vulkan::Context::CreateCommandBuffers()
 {
   VkResult res;
 
-  uint32_t frame_index = 0;
-  for (FrameResources& resources : m_frame_resources)
+  for (u32 frame_index = 0; frame_index < m_num_command_buffers; frame_index++)
   {
+    FrameResources& resources = m_frame_resources[frame_index];
     resources.needs_fence_wait = false;
 
     VkCommandPoolCreateInfo pool_info = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, nullptr, 0,
@@ -749,8 +762,6 @@ bool Vulkan::Context::CreateCommandBuffers()
     }
     Vulkan::Util::SetObjectName(g_vulkan_context->GetDevice(), resources.descriptor_pool, "Frame Descriptor Pool %u",
                                 frame_index);
-
-    ++frame_index;
   }
 
   ActivateCommandBuffer(0);
@@ -794,7 +805,8 @@ bool Vulkan::Context::CreateGlobalDescriptorPool()
   VkDescriptorPoolSize pool_sizes[] = {{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1024},
                                        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1024},
                                        {VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 16},
-                                       {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 16}};
+                                       {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 16},
+                                       {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 16}};
 
   VkDescriptorPoolCreateInfo pool_create_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
                                                  nullptr,
@@ -814,7 +826,8 @@ bool Vulkan::Context::CreateGlobalDescriptorPool()
   if (m_gpu_timing_supported)
   {
     const VkQueryPoolCreateInfo query_create_info = {
-      VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, nullptr, 0, VK_QUERY_TYPE_TIMESTAMP, NUM_COMMAND_BUFFERS * 2, 0};
+      VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, nullptr, 0, VK_QUERY_TYPE_TIMESTAMP,
+      MAX_COMMAND_BUFFERS * NUM_TIMESTAMP_QUERIES_PER_COMMAND_BUFFER, 0};
     res = vkCreateQueryPool(m_device, &query_create_info, nullptr, &m_timestamp_query_pool);
     if (res != VK_SUCCESS)
     {
@@ -872,6 +885,53 @@ VkDescriptorSet Vulkan::Context::AllocateDescriptorSet(VkDescriptorSetLayout set
   return descriptor_set;
 }
 
+VkDescriptorSet Vulkan::Context::GetCachedImageSamplerDescriptorSet(VkDescriptorSetLayout set_layout, u32 binding,
+                                                                   VkImageView view, VkSampler sampler,
+                                                                   VkImageLayout layout)
+{
+  // only a handful of textures are drawn per frame, so a linear search is cheaper than hashing
+  std::vector<CachedDescriptorSet>& cache = m_frame_resources[m_current_frame].cached_descriptor_sets;
+  for (const CachedDescriptorSet& cds : cache)
+  {
+    if (cds.set_layout == set_layout && cds.view == view && cds.sampler == sampler && cds.layout == layout &&
+        cds.binding == binding)
+    {
+      return cds.set;
+    }
+  }
+
+  VkDescriptorSet ds = AllocateDescriptorSet(set_layout);
+  if (ds == VK_NULL_HANDLE)
+    return VK_NULL_HANDLE;
+
+  DescriptorSetUpdateBuilder dsub;
+  dsub.AddCombinedImageSamplerDescriptorWrite(ds, binding, view, sampler, layout);
+  dsub.Update(m_device);
+
+  cache.push_back(CachedDescriptorSet{set_layout, view, sampler, layout, binding, ds});
+  return ds;
+}
+
+bool Vulkan::Context::BindImageSamplerDescriptor(VkCommandBuffer cmdbuf, VkPipelineLayout pipeline_layout,
+                                                 VkDescriptorSetLayout set_layout, u32 binding, VkImageView view,
+                                                 VkSampler sampler, VkImageLayout layout)
+{
+  if (m_optional_extensions.vk_khr_push_descriptor)
+  {
+    DescriptorSetUpdateBuilder dsub;
+    dsub.AddCombinedImageSamplerDescriptorWrite(VK_NULL_HANDLE, binding, view, sampler, layout);
+    dsub.PushUpdate(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout);
+    return true;
+  }
+
+  VkDescriptorSet ds = GetCachedImageSamplerDescriptorSet(set_layout, binding, view, sampler, layout);
+  if (ds == VK_NULL_HANDLE)
+    return false;
+
+  vkCmdBindDescriptorSets(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &ds, 0, nullptr);
+  return true;
+}
+
 VkDescriptorSet Vulkan::Context::AllocateGlobalDescriptorSet(VkDescriptorSetLayout set_layout)
 {
   VkDescriptorSetAllocateInfo allocate_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, nullptr,
@@ -896,13 +956,15 @@ void Vulkan::Context::WaitForFenceCounter(u64 fence_counter)
     return;
 
   // Find the first command buffer which covers this counter value.
-  u32 index = (m_current_frame + 1) % NUM_COMMAND_BUFFERS;
-  while (index != m_current_frame)
+  u32 index = m_current_frame;
+  for (u32 i = 1; i < m_num_command_buffers; i++)
   {
-    if (m_frame_resources[index].fence_counter >= fence_counter)
+    const u32 check_index = (m_current_frame + i) % m_num_command_buffers;
+    if (m_frame_resources[check_index].fence_counter >= fence_counter)
+    {
+      index = check_index;
       break;
-
-    index = (index + 1) % NUM_COMMAND_BUFFERS;
+    }
   }
 
   Assert(index != m_current_frame);
@@ -928,19 +990,78 @@ bool Vulkan::Context::SetEnableGPUTiming(bool enabled)
   return (enabled == m_gpu_timing_enabled);
 }
 
+void Vulkan::Context::SetGPUTimingSection(u32 section)
+{
+  if (m_current_gpu_timing_section == section)
+    return;
+
+  EndGPUTimingSectionQuery();
+  m_current_gpu_timing_section = section;
+  BeginGPUTimingSectionQuery();
+}
+
+Vulkan::Context::GPUSectionTimes Vulkan::Context::GetAndResetAccumulatedGPUSectionTimes()
+{
+  const GPUSectionTimes times = m_accumulated_gpu_section_times;
+  m_accumulated_gpu_section_times.fill(0.0f);
+  return times;
+}
+
+float Vulkan::Context::GetAndResetAccumulatedFenceWaitTime()
+{
+  const float time = m_accumulated_fence_wait_time;
+  m_accumulated_fence_wait_time = 0.0f;
+  return time;
+}
+
+void Vulkan::Context::BeginGPUTimingSectionQuery()
+{
+  // the query range is only reset when timing was enabled at the start of the command buffer
+  FrameResources& resources = m_frame_resources[m_current_frame];
+  if (m_current_gpu_timing_section == NO_GPU_TIMING_SECTION || !m_gpu_timing_enabled ||
+      !resources.timestamp_written ||
+      resources.timing_sections.size() == MAX_GPU_TIMING_SECTION_QUERIES_PER_COMMAND_BUFFER)
+  {
+    return;
+  }
+
+  const u32 query = m_current_frame * NUM_TIMESTAMP_QUERIES_PER_COMMAND_BUFFER + 2 +
+                    static_cast<u32>(resources.timing_sections.size()) * 2;
+  vkCmdWriteTimestamp(resources.command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, m_timestamp_query_pool, query);
+  resources.timing_sections.push_back(m_current_gpu_timing_section);
+  resources.timing_section_open = true;
+}
+
+void Vulkan::Context::EndGPUTimingSectionQuery()
+{
+  FrameResources& resources = m_frame_resources[m_current_frame];
+  if (!resources.timing_section_open)
+    return;
+
+  const u32 query = m_current_frame * NUM_TIMESTAMP_QUERIES_PER_COMMAND_BUFFER + 2 +
+                    static_cast<u32>(resources.timing_sections.size() - 1) * 2 + 1;
+  vkCmdWriteTimestamp(resources.command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, m_timestamp_query_pool, query);
+  resources.timing_section_open = false;
+}
+
 void Vulkan::Context::WaitForCommandBufferCompletion(u32 index)
 {
-  // Wait for this command buffer to be completed.
+  // Wait for this command buffer to be completed. Track how long the CPU was blocked, as this is the time which
+  // could be saved by allowing more frames in flight.
+  const Common::Timer::Value wait_start = Common::Timer::GetCurrentValue();
   VkResult res = vkWaitForFences(m_device, 1, &m_frame_resources[index].fence, VK_TRUE, UINT64_MAX);
   if (res != VK_SUCCESS)
     LOG_VULKAN_ERROR(res, "vkWaitForFences failed: ");
+  m_accumulated_fence_wait_time += static_cast<float>(
+    Common::Timer::ConvertValueToMilliseconds(Common::Timer::GetCurrentValue() - wait_start));
 
   // Clean up any resources for command buffers between the last known completed buffer and this
-  // now-completed command buffer. If we use >2 buffers, this may be more than one buffer.
+  // now-completed command buffer. If we use >2 buffers, this may be more than one buffer. When there is only a
+  // single buffer, the buffer being waited on is also the current buffer.
   const u64 now_completed_counter = m_frame_resources[index].fence_counter;
-  u32 cleanup_index = (m_current_frame + 1) % NUM_COMMAND_BUFFERS;
-  while (cleanup_index != m_current_frame)
+  for (u32 i = 1; i <= m_num_command_buffers; i++)
   {
+    const u32 cleanup_index = (m_current_frame + i) % m_num_command_buffers;
     FrameResources& resources = m_frame_resources[cleanup_index];
     if (resources.fence_counter > now_completed_counter)
       break;
@@ -951,8 +1072,6 @@ void Vulkan::Context::WaitForCommandBufferCompletion(u32 index)
         it();
       resources.cleanup_resources.clear();
     }
-
-    cleanup_index = (cleanup_index + 1) % NUM_COMMAND_BUFFERS;
   }
 
   m_completed_fence_counter = now_completed_counter;
@@ -966,10 +1085,11 @@ void Vulkan::Context::SubmitCommandBuffer(VkSemaphore wait_semaphore /* = VK_NUL
 {
   FrameResources& resources = m_frame_resources[m_current_frame];
 
+  EndGPUTimingSectionQuery();
   if (m_gpu_timing_enabled && resources.timestamp_written)
   {
     vkCmdWriteTimestamp(m_current_command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, m_timestamp_query_pool,
-                        m_current_frame * 2 + 1);
+                        m_current_frame * NUM_TIMESTAMP_QUERIES_PER_COMMAND_BUFFER + 1);
   }
 
   // End the current command buffer.
@@ -1117,7 +1237,7 @@ void Vulkan::Context::StopPresentThread()
 
 void Vulkan::Context::MoveToNextCommandBuffer()
 {
-  ActivateCommandBuffer((m_current_frame + 1) % NUM_COMMAND_BUFFERS);
+  ActivateCommandBuffer((m_current_frame + 1) % m_num_command_buffers);
 }
 
 void Vulkan::Context::ActivateCommandBuffer(u32 index)
@@ -1152,26 +1272,40 @@ void Vulkan::Context::ActivateCommandBuffer(u32 index)
   res = vkResetDescriptorPool(m_device, resources.descriptor_pool, 0);
   if (res != VK_SUCCESS)
     LOG_VULKAN_ERROR(res, "vkResetDescriptorPool failed: ");
+  resources.cached_descriptor_sets.clear();
 
   if (m_gpu_timing_enabled)
   {
     if (resources.timestamp_written)
     {
-      std::array<u64, 2> timestamps;
-      res =
-        vkGetQueryPoolResults(m_device, m_timestamp_query_pool, index * 2, static_cast<u32>(timestamps.size()),
-                              sizeof(u64) * timestamps.size(), timestamps.data(), sizeof(u64), VK_QUERY_RESULT_64_BIT);
+      // [0] and [1] are the whole command buffer, followed by a begin/end pair for each section
+      std::array<u64, NUM_TIMESTAMP_QUERIES_PER_COMMAND_BUFFER> timestamps;
+      const u32 num_queries = 2 + static_cast<u32>(resources.timing_sections.size()) * 2;
+      res = vkGetQueryPoolResults(m_device, m_timestamp_query_pool, index * NUM_TIMESTAMP_QUERIES_PER_COMMAND_BUFFER,
+                                  num_queries, sizeof(u64) * num_queries, timestamps.data(), sizeof(u64),
+                                  VK_QUERY_RESULT_64_BIT);
       if (res == VK_SUCCESS)
       {
+        const double period = static_cast<double>(m_device_properties.limits.timestampPeriod);
+
         // if we didn't write the timestamp at the start of the cmdbuffer (just enabled timing), the first TS will be
         // zero
         if (timestamps[0] > 0)
         {
-          const double ns_diff =
-            (timestamps[1] - timestamps[0]) * static_cast<double>(m_device_properties.limits.timestampPeriod);
+          const double ns_diff = (timestamps[1] - timestamps[0]) * period;
           m_accumulated_gpu_time =
             static_cast<float>(static_cast<double>(m_accumulated_gpu_time) + (ns_diff / 1000000.0));
         }
+
+        for (size_t i = 0; i < resources.timing_sections.size(); i++)
+        {
+          const u32 section = resources.timing_sections[i];
+          if (section >= MAX_GPU_TIMING_SECTIONS)
+            continue;
+
+          const double ns_diff = (timestamps[2 + i * 2 + 1] - timestamps[2 + i * 2]) * period;
+          m_accumulated_gpu_section_times[section] += static_cast<float>(ns_diff / 1000000.0);
+        }
       }
       else
       {
@@ -1179,17 +1313,22 @@ void Vulkan::Context::ActivateCommandBuffer(u32 index)
       }
     }
 
-    vkCmdResetQueryPool(resources.command_buffer, m_timestamp_query_pool, index * 2, 2);
+    vkCmdResetQueryPool(resources.command_buffer, m_timestamp_query_pool,
+                        index * NUM_TIMESTAMP_QUERIES_PER_COMMAND_BUFFER, NUM_TIMESTAMP_QUERIES_PER_COMMAND_BUFFER);
     vkCmdWriteTimestamp(resources.command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, m_timestamp_query_pool,
-                        index * 2);
+                        index * NUM_TIMESTAMP_QUERIES_PER_COMMAND_BUFFER);
   }
 
   resources.fence_counter = m_next_fence_counter++;
   resources.timestamp_written = m_gpu_timing_enabled;
+  resources.timing_sections.clear();
 
   m_current_frame = index;
   m_current_command_buffer = resources.command_buffer;
 
+  // continue the current section in the new command buffer
+  BeginGPUTimingSectionQuery();
+
   // using the lower 32 bits of the fence index should be sufficient here, I hope...
   vmaSetCurrentFrameIndex(m_allocator, static_cast<u32>(m_next_fence_counter));
 }
@@ -1197,12 +1336,13 @@ void Vulkan::Context::ActivateCommandBuffer(u32 index)
 void Vulkan::Context::ExecuteCommandBuffer(bool wait_for_completion)
 {
   // If we're waiting for completion, don't bother waking the worker thread.
-  const u32 current_frame = m_current_frame;
+  // With a single command buffer, moving to the next buffer has already waited for this one.
+  const u64 fence_counter = GetCurrentFenceCounter();
   SubmitCommandBuffer();
   MoveToNextCommandBuffer();
 
   if (wait_for_completion)
-    WaitForCommandBufferCompletion(current_frame);
+    WaitForFenceCounter(fence_counter);
 }
 
 bool Vulkan::Context::CheckLastPresentFail()
@@ -25,13 +25,21 @@ class Context
 public:
   enum : u32
   {
-    NUM_COMMAND_BUFFERS = 2
+    MAX_COMMAND_BUFFERS = 3,
+    DEFAULT_COMMAND_BUFFERS = 2,
+    MAX_GPU_TIMING_SECTIONS = 16,
+    MAX_GPU_TIMING_SECTION_QUERIES_PER_COMMAND_BUFFER = 127,
+    NUM_TIMESTAMP_QUERIES_PER_COMMAND_BUFFER = 2 + MAX_GPU_TIMING_SECTION_QUERIES_PER_COMMAND_BUFFER * 2,
+    NO_GPU_TIMING_SECTION = 0xFFFFFFFFu
   };
 
+  using GPUSectionTimes = std::array<float, MAX_GPU_TIMING_SECTIONS>;
+
   struct OptionalExtensions
   {
     bool vk_ext_memory_budget : 1;
     bool vk_khr_driver_properties : 1;
+    bool vk_khr_push_descriptor : 1;
   };
 
   ~Context();
@@ -48,9 +56,11 @@ public:
   static GPUList EnumerateGPUs(VkInstance instance);
   static GPUNameList EnumerateGPUNames(VkInstance instance);
 
-  // Creates a new context and sets it up as global.
+  // Creates a new context and sets it up as global. frames_in_flight is the number of command buffers which the CPU
+  // can record ahead of the GPU, between 1 and MAX_COMMAND_BUFFERS.
   static bool Create(std::string_view gpu_name, const WindowInfo* wi, std::unique_ptr<SwapChain>* out_swap_chain,
-                     bool threaded_presentation, bool enable_debug_utils, bool enable_validation_layer);
+                     bool threaded_presentation, bool enable_debug_utils, bool enable_validation_layer,
+                     u32 frames_in_flight = DEFAULT_COMMAND_BUFFERS);
 
   // Creates a new context from a pre-existing instance.
   static bool CreateFromExistingInstance(VkInstance instance, VkPhysicalDevice gpu, VkSurfaceKHR surface,
@@ -96,6 +106,7 @@ public:
   // Support bits
   ALWAYS_INLINE bool SupportsGeometryShaders() const { return m_device_features.geometryShader == VK_TRUE; }
   ALWAYS_INLINE bool SupportsDualSourceBlend() const { return m_device_features.dualSrcBlend == VK_TRUE; }
+  ALWAYS_INLINE bool SupportsPushDescriptors() const { return m_optional_extensions.vk_khr_push_descriptor; }
 
   // Helpers for getting constants
   ALWAYS_INLINE u32 GetUniformBufferAlignment() const
@@ -132,6 +143,7 @@ public:
   // is submitted, after that you should call these functions again.
   ALWAYS_INLINE VkDescriptorPool GetGlobalDescriptorPool() const { return m_global_descriptor_pool; }
   ALWAYS_INLINE VkCommandBuffer GetCurrentCommandBuffer() const { return m_current_command_buffer; }
+  ALWAYS_INLINE u32 GetNumCommandBuffers() const { return m_num_command_buffers; }
   ALWAYS_INLINE StreamBuffer& GetTextureUploadBuffer() { return m_texture_upload_buffer; }
   ALWAYS_INLINE VkDescriptorPool GetCurrentDescriptorPool() const
   {
@@ -141,7 +153,18 @@ public:
   /// Allocates a descriptor set from the pool reserved for the current frame.
   VkDescriptorSet AllocateDescriptorSet(VkDescriptorSetLayout set_layout);
 
-  /// Allocates a descriptor set from the pool reserved for the current frame.
+  /// Returns a descriptor set from the current frame's pool with a single combined image sampler at binding, reusing
+  /// one written earlier in the frame for the same resources. Used when push descriptors aren't available.
+  VkDescriptorSet GetCachedImageSamplerDescriptorSet(VkDescriptorSetLayout set_layout, u32 binding, VkImageView view,
+                                                     VkSampler sampler, VkImageLayout layout);
+
+  /// Binds a single combined image sampler as set 0 of a graphics pipeline layout. The descriptor is pushed when push
+  /// descriptors are supported, in which case the set layout must have been created with the push flag.
+  bool BindImageSamplerDescriptor(VkCommandBuffer cmdbuf, VkPipelineLayout pipeline_layout,
+                                  VkDescriptorSetLayout set_layout, u32 binding, VkImageView view, VkSampler sampler,
+                                  VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+  /// Allocates a descriptor set from the global pool.
   VkDescriptorSet AllocateGlobalDescriptorSet(VkDescriptorSetLayout set_layout);
 
   /// Frees a descriptor set allocated from the global pool.
@@ -193,6 +216,16 @@ public:
   float GetAndResetAccumulatedGPUTime();
   bool SetEnableGPUTiming(bool enabled);
 
+  // Attributes subsequent GPU work to the specified section, until the next call. Sections carry over into new
+  // command buffers. Pass NO_GPU_TIMING_SECTION to stop attributing work.
+  void SetGPUTimingSection(u32 section);
+
+  // Returns the GPU time spent in each section since the last call, in milliseconds.
+  GPUSectionTimes GetAndResetAccumulatedGPUSectionTimes();
+
+  // Returns the CPU time spent blocked waiting for command buffer fences since the last call, in milliseconds.
+  float GetAndResetAccumulatedFenceWaitTime();
+
 private:
   Context(VkInstance instance, VkPhysicalDevice physical_device, bool owns_device);
 
@@ -217,6 +250,9 @@ private:
   void ActivateCommandBuffer(u32 index);
   void WaitForCommandBufferCompletion(u32 index);
 
+  void BeginGPUTimingSectionQuery();
+  void EndGPUTimingSectionQuery();
+
   void DoSubmitCommandBuffer(u32 index, VkSemaphore wait_semaphore, VkSemaphore signal_semaphore);
   void DoPresent(VkSemaphore wait_semaphore, VkSwapchainKHR present_swap_chain, uint32_t present_image_index);
   void WaitForPresentComplete(std::unique_lock<std::mutex>& lock);
@@ -224,6 +260,16 @@ private:
   void StartPresentThread();
   void StopPresentThread();
 
+  struct CachedDescriptorSet
+  {
+    VkDescriptorSetLayout set_layout;
+    VkImageView view;
+    VkSampler sampler;
+    VkImageLayout layout;
+    u32 binding;
+    VkDescriptorSet set;
+  };
+
   struct FrameResources
   {
     // [0] - Init (upload) command buffer, [1] - draw command buffer
@@ -234,8 +280,11 @@ private:
     u64 fence_counter = 0;
     bool needs_fence_wait = false;
     bool timestamp_written = false;
+    bool timing_section_open = false;
 
+    std::vector<u32> timing_sections;
     std::vector<std::function<void()>> cleanup_resources;
+    std::vector<CachedDescriptorSet> cached_descriptor_sets;
   };
 
   VkInstance m_instance = VK_NULL_HANDLE;
@@ -254,10 +303,14 @@ private:
 
   VkQueryPool m_timestamp_query_pool = VK_NULL_HANDLE;
   float m_accumulated_gpu_time = 0.0f;
+  GPUSectionTimes m_accumulated_gpu_section_times{};
+  u32 m_current_gpu_timing_section = NO_GPU_TIMING_SECTION;
   bool m_gpu_timing_enabled = false;
   bool m_gpu_timing_supported = false;
 
-  std::array<FrameResources, NUM_COMMAND_BUFFERS> m_frame_resources;
+  std::array<FrameResources, MAX_COMMAND_BUFFERS> m_frame_resources;
+  u32 m_num_command_buffers = DEFAULT_COMMAND_BUFFERS;
+  float m_accumulated_fence_wait_time = 0.0f;
   u64 m_next_fence_counter = 1;
   u64 m_completed_fence_counter = 0;
   u32 m_current_frame;
@@ -206,6 +206,9 @@ extern "C" {
 #define vkAcquireNextImageKHR ds_vkAcquireNextImageKHR
 #define vkQueuePresentKHR ds_vkQueuePresentKHR
 
+// VK_KHR_push_descriptor
+#define vkCmdPushDescriptorSetKHR ds_vkCmdPushDescriptorSetKHR
+
 // Vulkan 1.1 functions.
 #define vkGetBufferMemoryRequirements2 ds_vkGetBufferMemoryRequirements2
 #define vkGetImageMemoryRequirements2 ds_vkGetImageMemoryRequirements2
@@ -6,6 +6,7 @@
 #include "context.h"
 #include "shader_compiler.h"
 #include "util.h"
+#include <cstring>
 Log_SetChannel(Vulkan::ShaderCache);
 
 // TODO: store the driver version and stuff in the shader header
@@ -88,8 +89,9 @@ ShaderCache::ShaderCache() = default;
 
 ShaderCache::~ShaderCache()
 {
-  CloseShaderCache();
+  // flush first, the pipeline cache write locks the index
   FlushPipelineCache();
+  CloseShaderCache();
   ClosePipelineCache();
 }
 
@@ -177,7 +179,7 @@ bool ShaderCache::CreateNewShaderCache(const std::string& index_filename, const
 
   if (std::fwrite(&index_version, sizeof(index_version), 1, m_index_file) != 1 ||
       std::fwrite(&m_version, sizeof(m_version), 1, m_index_file) != 1 ||
-      std::fwrite(&header, sizeof(header), 1, m_index_file) != 1)
+      std::fwrite(&header, sizeof(header), 1, m_index_file) != 1 || std::fflush(m_index_file) != 0)
   {
     Log_ErrorPrintf("Failed to write header to index file '%s'", index_filename.c_str());
     std::fclose(m_index_file);
@@ -196,6 +198,7 @@ bool ShaderCache::CreateNewShaderCache(const std::string& index_filename, const
     return false;
   }
 
+  m_index_read_position = static_cast<u32>(std::ftell(m_index_file));
   return true;
 }
 
@@ -234,38 +237,59 @@ bool ShaderCache::ReadExistingShaderCache(const std::string& index_filename, con
     return false;
   }
 
-  std::fseek(m_blob_file, 0, SEEK_END);
-  const u32 blob_file_size = static_cast<u32>(std::ftell(m_blob_file));
+  m_index_read_position = static_cast<u32>(std::ftell(m_index_file));
+  if (!RefreshIndex())
+  {
+    Log_ErrorPrintf("Failed to read entry from '%s', corrupt file?", index_filename.c_str());
+    m_index.clear();
+    std::fclose(m_blob_file);
+    m_blob_file = nullptr;
+    std::fclose(m_index_file);
+    m_index_file = nullptr;
+    return false;
+  }
 
+  Log_InfoPrintf("Read %zu entries from '%s'", m_index.size(), index_filename.c_str());
+  return true;
+}
+
+bool ShaderCache::ReadIndexEntries()
+{
+  if (std::fseek(m_index_file, m_index_read_position, SEEK_SET) != 0 || std::fseek(m_blob_file, 0, SEEK_END) != 0)
+    return false;
+
+  const u32 blob_file_size = static_cast<u32>(std::ftell(m_blob_file));
+  bool result = true;
   for (;;)
   {
     CacheIndexEntry entry;
     if (std::fread(&entry, sizeof(entry), 1, m_index_file) != 1 ||
         (entry.file_offset + entry.blob_size) > blob_file_size)
     {
-      if (std::feof(m_index_file))
-        break;
-
-      Log_ErrorPrintf("Failed to read entry from '%s', corrupt file?", index_filename.c_str());
-      m_index.clear();
-      std::fclose(m_blob_file);
-      m_blob_file = nullptr;
-      std::fclose(m_index_file);
-      m_index_file = nullptr;
-      return false;
+      result = std::feof(m_index_file);
+      break;
     }
 
     const CacheIndexKey key{entry.source_hash_low, entry.source_hash_high, entry.source_length,
                             static_cast<ShaderCompiler::Type>(entry.shader_type)};
     const CacheIndexData data{entry.file_offset, entry.blob_size};
     m_index.emplace(key, data);
+    m_index_read_position += sizeof(entry);
   }
 
   // ensure we don't write before seeking
   std::fseek(m_index_file, 0, SEEK_END);
+  return result;
+}
 
-  Log_InfoPrintf("Read %zu entries from '%s'", m_index.size(), index_filename.c_str());
-  return true;
+bool ShaderCache::RefreshIndex()
+{
+  if (!m_index_file || !m_blob_file || !FileSystem::LockCFile(m_index_file))
+    return false;
+
+  const bool result = ReadIndexEntries();
+  FileSystem::UnlockCFile(m_index_file);
+  return result;
 }
 
 void ShaderCache::CloseShaderCache()
@@ -275,6 +299,7 @@ void ShaderCache::CloseShaderCache()
     std::fclose(m_index_file);
     m_index_file = nullptr;
   }
+  UnmapBlobFile();
   if (m_blob_file)
   {
     std::fclose(m_blob_file);
@@ -282,6 +307,37 @@ void ShaderCache::CloseShaderCache()
   }
 }
 
+const u8* ShaderCache::GetMappedBlob(u32 file_offset, u32 size)
+{
+  if ((static_cast<u64>(file_offset) + size) > m_blob_file_map_size)
+  {
+    // entries are only ever appended, so map whatever is in the file now to cover any written since
+    UnmapBlobFile();
+
+    const s64 file_size = FileSystem::FSize64(m_blob_file);
+    if (file_size <= 0 || (static_cast<u64>(file_offset) + size) > static_cast<u64>(file_size))
+      return nullptr;
+
+    m_blob_file_map = static_cast<const u8*>(FileSystem::MapCFile(m_blob_file, static_cast<size_t>(file_size)));
+    if (!m_blob_file_map)
+    {
+      Log_WarningPrintf("Failed to map blob file, falling back to reads");
+      return nullptr;
+    }
+
+    m_blob_file_map_size = static_cast<u32>(file_size);
+  }
+
+  return m_blob_file_map + file_offset;
+}
+
+void ShaderCache::UnmapBlobFile()
+{
+  FileSystem::UnmapCFile(m_blob_file_map, m_blob_file_map_size);
+  m_blob_file_map = nullptr;
+  m_blob_file_map_size = 0;
+}
+
 bool ShaderCache::CreateNewPipelineCache()
 {
   if (!m_pipeline_cache_filename.empty() && FileSystem::FileExists(m_pipeline_cache_filename.c_str()))
@@ -336,6 +392,48 @@ bool ShaderCache::FlushPipelineCache()
   if (m_pipeline_cache == VK_NULL_HANDLE || !m_pipeline_cache_dirty || m_pipeline_cache_filename.empty())
     return false;
 
+  // The index lock also serializes pipeline cache writes between instances sharing the cache directory.
+  const bool locked = (m_index_file && FileSystem::LockCFile(m_index_file));
+  const bool result = WritePipelineCache();
+  if (locked)
+    FileSystem::UnlockCFile(m_index_file);
+
+  return result;
+}
+
+void ShaderCache::MergeExistingPipelineCache()
+{
+  // Another instance may have written pipelines we don't have since we loaded the cache, keep them.
+  std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(m_pipeline_cache_filename.c_str());
+  if (!data.has_value() || data->size() < sizeof(VK_PIPELINE_CACHE_HEADER))
+    return;
+
+  VK_PIPELINE_CACHE_HEADER header;
+  std::memcpy(&header, data->data(), sizeof(header));
+  if (!ValidatePipelineCacheHeader(header))
+    return;
+
+  const VkPipelineCacheCreateInfo ci{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO, nullptr, 0, data->size(),
+                                     data->data()};
+  VkPipelineCache existing_cache;
+  VkResult res = vkCreatePipelineCache(g_vulkan_context->GetDevice(), &ci, nullptr, &existing_cache);
+  if (res != VK_SUCCESS)
+  {
+    LOG_VULKAN_ERROR(res, "vkCreatePipelineCache() for merge failed: ");
+    return;
+  }
+
+  res = vkMergePipelineCaches(g_vulkan_context->GetDevice(), m_pipeline_cache, 1, &existing_cache);
+  if (res != VK_SUCCESS)
+    LOG_VULKAN_ERROR(res, "vkMergePipelineCaches() failed: ");
+
+  vkDestroyPipelineCache(g_vulkan_context->GetDevice(), existing_cache, nullptr);
+}
+
+bool ShaderCache::WritePipelineCache()
+{
+  MergeExistingPipelineCache();
+
   size_t data_size;
   VkResult res = vkGetPipelineCacheData(g_vulkan_context->GetDevice(), m_pipeline_cache, &data_size, nullptr);
   if (res != VK_SUCCESS)
@@ -358,8 +456,11 @@ bool ShaderCache::FlushPipelineCache()
   FILESYSTEM_STAT_DATA sd;
   if (!FileSystem::StatFile(m_pipeline_cache_filename.c_str(), &sd) || sd.Size != static_cast<s64>(data_size))
   {
+    // write to a temporary file first, so other instances never read a partially-written cache
     Log_InfoPrintf("Writing %zu bytes to '%s'", data_size, m_pipeline_cache_filename.c_str());
-    if (!FileSystem::WriteBinaryFile(m_pipeline_cache_filename.c_str(), data.data(), data.size()))
+    const std::string temp_filename = m_pipeline_cache_filename + ".tmp";
+    if (!FileSystem::WriteBinaryFile(temp_filename.c_str(), data.data(), data.size()) ||
+        !FileSystem::RenamePath(temp_filename.c_str(), m_pipeline_cache_filename.c_str()))
     {
       Log_ErrorPrintf("Failed to write pipeline cache to '%s'", m_pipeline_cache_filename.c_str());
       return false;
@@ -406,7 +507,7 @@ std::string ShaderCache::GetPipelineCacheBaseFileName(const std::string_view& ba
   return base_filename;
 }
 
-ShaderCache::CacheIndexKey ShaderCache::GetCacheKey(ShaderCompiler::Type type, const std::string_view& shader_code)
+ShaderCache::CacheIndexKey ShaderCache::GetCacheKey(ShaderCompiler::Type type, const void* data, u32 size)
 {
   union HashParts
   {
@@ -420,26 +521,42 @@ ShaderCache::CacheIndexKey ShaderCache::GetCacheKey(ShaderCompiler::Type type, c
   HashParts h;
 
   MD5Digest digest;
-  digest.Update(shader_code.data(), static_cast<u32>(shader_code.length()));
+  digest.Update(data, size);
   digest.Final(h.hash);
 
-  return CacheIndexKey{h.hash_low, h.hash_high, static_cast<u32>(shader_code.length()), type};
+  return CacheIndexKey{h.hash_low, h.hash_high, size, type};
 }
 
 std::optional<ShaderCompiler::SPIRVCodeVector> ShaderCache::GetShaderSPV(ShaderCompiler::Type type,
                                                                          std::string_view shader_code)
 {
-  const auto key = GetCacheKey(type, shader_code);
+  return GetShaderSPV(GetCacheKey(type, shader_code.data(), static_cast<u32>(shader_code.length())),
+                      [shader_code]() { return std::string(shader_code); });
+}
+
+std::optional<ShaderCompiler::SPIRVCodeVector>
+ShaderCache::GetShaderSPV(const CacheIndexKey& key, const std::function<std::string()>& generate_source)
+{
   auto iter = m_index.find(key);
   if (iter == m_index.end())
-    return CompileAndAddShaderSPV(key, shader_code);
+  {
+    // another instance sharing the cache may have compiled it since we last looked
+    if (!RefreshIndex() || (iter = m_index.find(key)) == m_index.end())
+      return CompileAndAddShaderSPV(key, generate_source());
+  }
 
   SPIRVCodeVector spv(iter->second.blob_size);
-  if (std::fseek(m_blob_file, iter->second.file_offset, SEEK_SET) != 0 ||
-      std::fread(spv.data(), sizeof(SPIRVCodeType), iter->second.blob_size, m_blob_file) != iter->second.blob_size)
+  const u8* blob = GetMappedBlob(iter->second.file_offset, iter->second.blob_size * sizeof(SPIRVCodeType));
+  if (blob)
+  {
+    std::memcpy(spv.data(), blob, iter->second.blob_size * sizeof(SPIRVCodeType));
+  }
+  else if (std::fseek(m_blob_file, iter->second.file_offset, SEEK_SET) != 0 ||
+           std::fread(spv.data(), sizeof(SPIRVCodeType), iter->second.blob_size, m_blob_file) !=
+             iter->second.blob_size)
   {
     Log_ErrorPrintf("Read blob from file failed, recompiling");
-    return ShaderCompiler::CompileShader(type, shader_code, m_debug);
+    return ShaderCompiler::CompileShader(key.shader_type, generate_source(), m_debug);
   }
 
   return spv;
@@ -447,12 +564,43 @@ std::optional<ShaderCompiler::SPIRVCodeVector> ShaderCache::GetShaderSPV(ShaderC
 
 VkShaderModule ShaderCache::GetShaderModule(ShaderCompiler::Type type, std::string_view shader_code)
 {
-  std::optional<SPIRVCodeVector> spv = GetShaderSPV(type, shader_code);
-  if (!spv.has_value())
-    return VK_NULL_HANDLE;
+  return GetShaderModule(GetCacheKey(type, shader_code.data(), static_cast<u32>(shader_code.length())),
+                         [shader_code]() { return std::string(shader_code); });
+}
+
+VkShaderModule ShaderCache::GetShaderModule(ShaderCompiler::Type type, const void* key_data, u32 key_size,
+                                            const std::function<std::string()>& generate_source)
+{
+  CacheIndexKey key = GetCacheKey(type, key_data, key_size);
+  key.source_length |= PARAMETER_KEY_FLAG;
+  return GetShaderModule(key, generate_source);
+}
+
+VkShaderModule ShaderCache::GetShaderModule(const CacheIndexKey& key,
+                                            const std::function<std::string()>& generate_source)
+{
+  // cached modules can be created straight from the mapped blob, without copying the SPIR-V out first
+  auto iter = m_index.find(key);
+  const u8* blob = (iter != m_index.end()) ?
+                     GetMappedBlob(iter->second.file_offset, iter->second.blob_size * sizeof(SPIRVCodeType)) :
+                     nullptr;
 
-  const VkShaderModuleCreateInfo ci{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, nullptr, 0,
-                                    spv->size() * sizeof(SPIRVCodeType), spv->data()};
+  std::optional<SPIRVCodeVector> spv;
+  VkShaderModuleCreateInfo ci{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, nullptr, 0};
+  if (blob)
+  {
+    ci.codeSize = iter->second.blob_size * sizeof(SPIRVCodeType);
+    ci.pCode = reinterpret_cast<const SPIRVCodeType*>(blob);
+  }
+  else
+  {
+    spv = GetShaderSPV(key, generate_source);
+    if (!spv.has_value())
+      return VK_NULL_HANDLE;
+
+    ci.codeSize = spv->size() * sizeof(SPIRVCodeType);
+    ci.pCode = spv->data();
+  }
 
   VkShaderModule mod;
   VkResult res = vkCreateShaderModule(g_vulkan_context->GetDevice(), &ci, nullptr, &mod);
@@ -492,9 +640,17 @@ std::optional<ShaderCompiler::SPIRVCodeVector> ShaderCache::CompileAndAddShaderS
   if (!spv.has_value())
     return {};
 
-  if (!m_blob_file || std::fseek(m_blob_file, 0, SEEK_END) != 0)
+  if (!m_blob_file || !FileSystem::LockCFile(m_index_file))
     return spv;
 
+  // Other instances append to the same files while holding the lock. Pick up their entries first, so that the
+  // offsets we write are correct and we don't add a duplicate if one of them compiled this shader in the meantime.
+  if (!ReadIndexEntries() || m_index.find(key) != m_index.end() || std::fseek(m_blob_file, 0, SEEK_END) != 0)
+  {
+    FileSystem::UnlockCFile(m_index_file);
+    return spv;
+  }
+
   CacheIndexData data;
   data.file_offset = static_cast<u32>(std::ftell(m_blob_file));
   data.blob_size = static_cast<u32>(spv->size());
@@ -512,10 +668,13 @@ std::optional<ShaderCompiler::SPIRVCodeVector> ShaderCache::CompileAndAddShaderS
       std::fflush(m_index_file) != 0)
   {
     Log_ErrorPrintf("Failed to write shader blob to file");
+    FileSystem::UnlockCFile(m_index_file);
     return spv;
   }
 
   m_index.emplace(key, data);
+  m_index_read_position += sizeof(entry);
+  FileSystem::UnlockCFile(m_index_file);
   return spv;
 }
 
@@ -4,6 +4,7 @@
 #include "loader.h"
 #include "shader_compiler.h"
 #include <cstdio>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -35,9 +36,18 @@ public:
   VkShaderModule GetFragmentShader(std::string_view shader_code);
   VkShaderModule GetComputeShader(std::string_view shader_code);
 
+  /// Looks a shader up by a key built from everything its source is generated from, instead of by the source, so the
+  /// source only has to be generated on a miss. Unlike source keys, these don't change when the generator does, so
+  /// the cache version has to be bumped whenever it's changed.
+  VkShaderModule GetShaderModule(ShaderCompiler::Type type, const void* key_data, u32 key_size,
+                                 const std::function<std::string()>& generate_source);
+
 private:
   static constexpr u32 FILE_VERSION = 2;
 
+  // set in the length of keys built from generator parameters, so they can't collide with source keys
+  static constexpr u32 PARAMETER_KEY_FLAG = 0x80000000u;
+
   struct CacheIndexKey
   {
     u64 source_hash_low;
@@ -71,7 +81,7 @@ private:
 
   static std::string GetShaderCacheBaseFileName(const std::string_view& base_path, bool debug);
   static std::string GetPipelineCacheBaseFileName(const std::string_view& base_path, bool debug);
-  static CacheIndexKey GetCacheKey(ShaderCompiler::Type type, const std::string_view& shader_code);
+  static CacheIndexKey GetCacheKey(ShaderCompiler::Type type, const void* data, u32 size);
 
   void Open(std::string_view base_path, u32 version, bool debug);
 
@@ -79,15 +89,35 @@ private:
   bool ReadExistingShaderCache(const std::string& index_filename, const std::string& blob_filename);
   void CloseShaderCache();
 
+  /// Reads entries which were appended to the index since it was last read, e.g. by another process sharing the
+  /// cache. The index file should be locked.
+  bool ReadIndexEntries();
+
+  /// Locks the index and picks up any new entries.
+  bool RefreshIndex();
+
+  /// Returns a pointer to a blob in the memory-mapped blob file, remapping it if the blob was appended since the
+  /// file was last mapped. Returns nullptr if the file could not be mapped.
+  const u8* GetMappedBlob(u32 file_offset, u32 size);
+  void UnmapBlobFile();
+
   bool CreateNewPipelineCache();
   bool ReadExistingPipelineCache();
+  void MergeExistingPipelineCache();
+  bool WritePipelineCache();
   void ClosePipelineCache();
 
+  std::optional<ShaderCompiler::SPIRVCodeVector> GetShaderSPV(const CacheIndexKey& key,
+                                                              const std::function<std::string()>& generate_source);
+  VkShaderModule GetShaderModule(const CacheIndexKey& key, const std::function<std::string()>& generate_source);
   std::optional<ShaderCompiler::SPIRVCodeVector> CompileAndAddShaderSPV(const CacheIndexKey& key,
                                                                         std::string_view shader_code);
 
   std::FILE* m_index_file = nullptr;
   std::FILE* m_blob_file = nullptr;
+  u32 m_index_read_position = 0;
+  const u8* m_blob_file_map = nullptr;
+  u32 m_blob_file_map_size = 0;
   std::string m_pipeline_cache_filename;
 
   CacheIndex m_index;
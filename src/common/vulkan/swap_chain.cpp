@@ -545,6 +545,14 @@ bool SwapChain::SelectPresentMode()
     return it != present_modes.end();
   };
 
+  // Relaxed vsync tears instead of waiting another vblank when a frame misses the interval, which avoids the latency
+  // spike from a late frame being held back.
+  if (m_vsync_enabled && m_relaxed_vsync && CheckForMode(VK_PRESENT_MODE_FIFO_RELAXED_KHR))
+  {
+    m_present_mode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+    return true;
+  }
+
   // If vsync is enabled, use VK_PRESENT_MODE_FIFO_KHR.
   // This check should not fail with conforming drivers, as the FIFO present mode is mandated by
   // the specification (VK_KHR_swapchain). In case it isn't though, fall through to any other mode.
@@ -789,13 +797,14 @@ bool SwapChain::RecreateSwapChain()
   return true;
 }
 
-bool SwapChain::SetVSync(bool enabled)
+bool SwapChain::SetVSync(bool enabled, bool relaxed /* = false */)
 {
-  if (m_vsync_enabled == enabled)
+  if (m_vsync_enabled == enabled && m_relaxed_vsync == relaxed)
     return true;
 
   // Recreate the swap chain with the new present mode.
   m_vsync_enabled = enabled;
+  m_relaxed_vsync = relaxed;
   return RecreateSwapChain();
 }
 
@@ -38,6 +38,7 @@ public:
   ALWAYS_INLINE VkSurfaceFormatKHR GetSurfaceFormat() const { return m_surface_format; }
   ALWAYS_INLINE VkFormat GetTextureFormat() const { return m_surface_format.format; }
   ALWAYS_INLINE bool IsVSyncEnabled() const { return m_vsync_enabled; }
+  ALWAYS_INLINE bool IsRelaxedVSyncEnabled() const { return m_relaxed_vsync; }
   ALWAYS_INLINE VkSwapchainKHR GetSwapChain() const { return m_swap_chain; }
   ALWAYS_INLINE const WindowInfo& GetWindowInfo() const { return m_window_info; }
   ALWAYS_INLINE u32 GetWidth() const { return m_window_info.surface_width; }
@@ -59,7 +60,8 @@ public:
   bool RecreateSwapChain();
 
   // Change vsync enabled state. This may fail as it causes a swapchain recreation.
-  bool SetVSync(bool enabled);
+  // Relaxed vsync uses FIFO_RELAXED where supported, presenting late frames immediately.
+  bool SetVSync(bool enabled, bool relaxed = false);
 
 private:
   bool SelectSurfaceFormat();
@@ -99,6 +101,7 @@ private:
   std::vector<SwapChainImage> m_images;
   u32 m_current_image = 0;
   bool m_vsync_enabled = false;
+  bool m_relaxed_vsync = false;
 };
 
 } // namespace Vulkan
@@ -10,7 +10,8 @@ Log_SetChannel(Texture);
 
 static constexpr std::array<VkFormat, static_cast<u32>(GPUTexture::Format::Count)> s_vk_mapping = {
   {VK_FORMAT_UNDEFINED, VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_R5G6B5_UNORM_PACK16,
-   VK_FORMAT_A1R5G5B5_UNORM_PACK16, VK_FORMAT_R8_UNORM, VK_FORMAT_D16_UNORM}};
+   VK_FORMAT_A1R5G5B5_UNORM_PACK16, VK_FORMAT_R8_UNORM, VK_FORMAT_D16_UNORM,
+   VK_FORMAT_D32_SFLOAT}};
 
 static constexpr VkComponentMapping s_identity_swizzle{VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
                                                        VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY};
@@ -309,7 +310,13 @@ void Vulkan::Texture::TransitionSubresourcesToLayout(VkCommandBuffer command_buf
     case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
       // Image was being used as a shader resource, make sure all reads have finished.
       barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-      srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+      srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+      break;
+
+    case VK_IMAGE_LAYOUT_GENERAL:
+      // Image was being used as a storage image or for a copy within itself, ensure all writes have finished.
+      barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+      srcStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
       break;
 
     case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
@@ -349,7 +356,13 @@ void Vulkan::Texture::TransitionSubresourcesToLayout(VkCommandBuffer command_buf
 
     case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
       barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-      dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+      dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+      break;
+
+    case VK_IMAGE_LAYOUT_GENERAL:
+      barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT |
+                              VK_ACCESS_TRANSFER_WRITE_BIT;
+      dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
       break;
 
     case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
@@ -0,0 +1,187 @@
+#include "benchmark.h"
+#include "common/log.h"
+#include "common/string_util.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace Benchmark {
+
+namespace {
+struct Entry
+{
+  const char* name;
+  Function function;
+};
+} // namespace
+
+static std::vector<Entry>& GetEntries();
+static bool RunBenchmark(const Entry& entry, double min_time);
+static void PrintUsage(const char* program_name);
+
+// iterations are grown by at most this factor between runs, so a bad estimate doesn't run for minutes
+static constexpr u64 MAX_ITERATION_GROWTH = 10;
+static constexpr u64 MAX_ITERATIONS = 1000000000;
+
+static const volatile void* s_sink;
+
+} // namespace Benchmark
+
+Benchmark::State::State(u64 max_iterations) : m_max_iterations(max_iterations) {}
+
+void Benchmark::State::PauseTiming()
+{
+  m_pause_time = Common::Timer::GetCurrentValue();
+}
+
+void Benchmark::State::ResumeTiming()
+{
+  m_paused_time += Common::Timer::GetCurrentValue() - m_pause_time;
+}
+
+void Benchmark::State::SkipWithError(const char* message)
+{
+  m_error = message;
+  m_max_iterations = 0;
+}
+
+Common::Timer::Value Benchmark::State::GetElapsedTime() const
+{
+  return (m_end_time > m_start_time) ? (m_end_time - m_start_time - m_paused_time) : 0;
+}
+
+std::vector<Benchmark::Entry>& Benchmark::GetEntries()
+{
+  // constructed on first use, since registration happens during static initialization
+  static std::vector<Entry> entries;
+  return entries;
+}
+
+bool Benchmark::Register(const char* name, Function function)
+{
+  GetEntries().push_back(Entry{name, function});
+  return true;
+}
+
+void Benchmark::DoNotOptimize(const void* ptr)
+{
+  s_sink = ptr;
+}
+
+bool Benchmark::RunBenchmark(const Entry& entry, double min_time)
+{
+  u64 iterations = 1;
+  for (;;)
+  {
+    State state(iterations);
+    entry.function(state);
+    if (state.GetError())
+    {
+      std::printf("%-44s skipped: %s\n", entry.name, state.GetError());
+      return false;
+    }
+
+    const double elapsed = Common::Timer::ConvertValueToSeconds(state.GetElapsedTime());
+    if (elapsed < min_time && iterations < MAX_ITERATIONS)
+    {
+      // aim a little past the minimum time, based on how long this run took
+      const double estimate = (elapsed > 0.0) ? (min_time * 1.4 / elapsed) * static_cast<double>(iterations) :
+                                                static_cast<double>(iterations * MAX_ITERATION_GROWTH);
+      iterations = std::clamp<u64>(static_cast<u64>(estimate), iterations + 1, iterations * MAX_ITERATION_GROWTH);
+      iterations = std::min(iterations, MAX_ITERATIONS);
+      continue;
+    }
+
+    const double ns_per_iteration = (elapsed * 1000000000.0) / static_cast<double>(iterations);
+    std::printf("%-44s %12.1f ns %12llu iterations", entry.name, ns_per_iteration,
+                static_cast<unsigned long long>(iterations));
+    if (state.GetBytesPerIteration() > 0)
+    {
+      const double total_bytes = static_cast<double>(state.GetBytesPerIteration()) * static_cast<double>(iterations);
+      std::printf(" %10.1f MB/s", total_bytes / (elapsed * 1048576.0));
+    }
+    if (state.GetItemsPerIteration() > 0)
+    {
+      const double total_items = static_cast<double>(state.GetItemsPerIteration()) * static_cast<double>(iterations);
+      std::printf(" %10.2f M items/s", total_items / (elapsed * 1000000.0));
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+    return true;
+  }
+}
+
+void Benchmark::PrintUsage(const char* program_name)
+{
+  std::fprintf(stderr, "Usage: %s [-filter <substring>] [-mintime <seconds>] [-list]\n", program_name);
+}
+
+int main(int argc, char* argv[])
+{
+  Log::SetConsoleOutputParams(true, nullptr, LOGLEVEL_WARNING);
+  Log::SetFilterLevel(LOGLEVEL_WARNING);
+
+  const char* filter = nullptr;
+  double min_time = 0.5;
+  bool list = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "-filter") == 0 && (i + 1) < argc)
+    {
+      filter = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "-mintime") == 0 && (i + 1) < argc)
+    {
+      const std::optional<double> value = StringUtil::FromChars<double>(argv[++i]);
+      if (!value.has_value() || value.value() < 0.0)
+      {
+        std::fprintf(stderr, "Invalid minimum time '%s'\n", argv[i]);
+        return EXIT_FAILURE;
+      }
+
+      min_time = value.value();
+    }
+    else if (std::strcmp(argv[i], "-list") == 0)
+    {
+      list = true;
+    }
+    else
+    {
+      Benchmark::PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<Benchmark::Entry> entries = Benchmark::GetEntries();
+  std::sort(entries.begin(), entries.end(), [](const Benchmark::Entry& lhs, const Benchmark::Entry& rhs) {
+    return std::strcmp(lhs.name, rhs.name) < 0;
+  });
+
+  u32 num_run = 0;
+  u32 num_skipped = 0;
+  for (const Benchmark::Entry& entry : entries)
+  {
+    if (filter && !std::strstr(entry.name, filter))
+      continue;
+
+    if (list)
+    {
+      std::printf("%s\n", entry.name);
+      continue;
+    }
+
+    if (Benchmark::RunBenchmark(entry, min_time))
+      num_run++;
+    else
+      num_skipped++;
+  }
+
+  if (!list)
+    std::printf("%u benchmarks run, %u skipped\n", num_run, num_skipped);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "common/timer.h"
+#include "common/types.h"
+
+// Minimal micro-benchmark harness. Each benchmark does its setup, runs the code being measured in a
+// while (state.KeepRunning()) loop, then tears down. The harness calls it with increasing iteration counts until a
+// run takes long enough to be measured accurately, and reports the time per iteration of the last run.
+namespace Benchmark {
+
+class State
+{
+public:
+  State(u64 max_iterations);
+
+  ALWAYS_INLINE bool KeepRunning()
+  {
+    if (m_iterations < m_max_iterations)
+    {
+      if (m_iterations++ == 0)
+        m_start_time = Common::Timer::GetCurrentValue();
+
+      return true;
+    }
+
+    m_end_time = Common::Timer::GetCurrentValue();
+    return false;
+  }
+
+  /// Excludes setup done inside the loop from the measured time.
+  void PauseTiming();
+  void ResumeTiming();
+
+  /// Amount of work done by each iteration, used to report throughput.
+  void SetBytesPerIteration(u64 bytes) { m_bytes_per_iteration = bytes; }
+  void SetItemsPerIteration(u64 items) { m_items_per_iteration = items; }
+
+  /// Skips the benchmark, e.g. if it isn't supported on this host.
+  void SkipWithError(const char* message);
+
+  u64 GetIterations() const { return m_iterations; }
+  u64 GetBytesPerIteration() const { return m_bytes_per_iteration; }
+  u64 GetItemsPerIteration() const { return m_items_per_iteration; }
+  const char* GetError() const { return m_error; }
+  Common::Timer::Value GetElapsedTime() const;
+
+private:
+  u64 m_iterations = 0;
+  u64 m_max_iterations;
+  u64 m_bytes_per_iteration = 0;
+  u64 m_items_per_iteration = 0;
+  Common::Timer::Value m_start_time = 0;
+  Common::Timer::Value m_end_time = 0;
+  Common::Timer::Value m_pause_time = 0;
+  Common::Timer::Value m_paused_time = 0;
+  const char* m_error = nullptr;
+};
+
+using Function = void (*)(State& state);
+
+/// Adds a benchmark to the list which is run. Use the BENCHMARK() macro instead.
+bool Register(const char* name, Function function);
+
+/// Prevents the compiler from optimizing away the computation of a result which isn't otherwise used.
+void DoNotOptimize(const void* ptr);
+
+} // namespace Benchmark
+
+#define BENCHMARK(function) static const bool benchmark_registered_##function = Benchmark::Register(#function, function)
@@ -0,0 +1,181 @@
+// The benchmarks drive individual components directly and never start a System, so the host is a no-op which only
+// has to satisfy the linker.
+
+#include "common/memory_settings_interface.h"
+#include "core/achievements.h"
+#include "core/host.h"
+#include "core/host_display.h"
+#include "core/host_settings.h"
+#include "core/settings.h"
+#include "core/system.h"
+#include "util/audio_stream.h"
+#include <mutex>
+
+static MemorySettingsInterface s_settings_interface;
+static std::mutex s_settings_mutex;
+
+std::string Host::GetStringSettingValue(const char* section, const char* key, const char* default_value)
+{
+  return s_settings_interface.GetStringValue(section, key, default_value);
+}
+
+bool Host::GetBoolSettingValue(const char* section, const char* key, bool default_value)
+{
+  return s_settings_interface.GetBoolValue(section, key, default_value);
+}
+
+std::unique_lock<std::mutex> Host::GetSettingsLock()
+{
+  return std::unique_lock<std::mutex>(s_settings_mutex);
+}
+
+SettingsInterface* Host::GetSettingsInterface()
+{
+  return &s_settings_interface;
+}
+
+SettingsInterface* Host::GetSettingsInterfaceForBindings()
+{
+  return &s_settings_interface;
+}
+
+SettingsInterface* Host::Internal::GetBaseSettingsLayer()
+{
+  return &s_settings_interface;
+}
+
+void Host::Internal::SetGameSettingsLayer(SettingsInterface* sif) {}
+
+void Host::Internal::SetInputSettingsLayer(SettingsInterface* sif) {}
+
+void Host::LoadSettings(SettingsInterface& si, std::unique_lock<std::mutex>& lock) {}
+
+void Host::CheckForSettingsChanges(const Settings& old_settings) {}
+
+std::optional<std::string> Host::ReadResourceFileToString(const char* filename)
+{
+  return std::nullopt;
+}
+
+std::optional<std::time_t> Host::GetResourceFileTimestamp(const char* filename)
+{
+  return std::nullopt;
+}
+
+TinyString Host::TranslateString(const char* context, const char* str, const char* disambiguation /*= nullptr*/,
+                                 int n /*= -1*/)
+{
+  return str;
+}
+
+std::string Host::TranslateStdString(const char* context, const char* str, const char* disambiguation /*= nullptr*/,
+                                     int n /*= -1*/)
+{
+  return str;
+}
+
+std::unique_ptr<AudioStream> Host::CreateAudioStream(AudioBackend backend, u32 sample_rate, u32 channels,
+                                                     u32 buffer_ms, u32 latency_ms, AudioStretchMode stretch)
+{
+  return AudioStream::CreateNullStream(sample_rate, channels, buffer_ms);
+}
+
+float Host::GetOSDScale()
+{
+  return 1.0f;
+}
+
+void Host::AddOSDMessage(std::string message, float duration /*= 2.0f*/) {}
+
+void Host::AddKeyedOSDMessage(std::string key, std::string message, float duration /*= 2.0f*/) {}
+
+void Host::AddIconOSDMessage(std::string key, const char* icon, std::string message, float duration /*= 2.0f*/) {}
+
+void Host::AddFormattedOSDMessage(float duration, const char* format, ...) {}
+
+void Host::AddKeyedFormattedOSDMessage(std::string key, float duration, const char* format, ...) {}
+
+void Host::ReportErrorAsync(const std::string_view& title, const std::string_view& message) {}
+
+bool Host::ConfirmMessage(const std::string_view& title, const std::string_view& message)
+{
+  return true;
+}
+
+void Host::ReportDebuggerMessage(const std::string_view& message) {}
+
+void Host::DisplayLoadingScreen(const char* message, int progress_min /*= -1*/, int progress_max /*= -1*/,
+                                int progress_value /*= -1*/)
+{
+}
+
+void Host::SetPadVibrationIntensity(u32 pad_index, float large_or_single_motor_intensity, float small_motor_intensity)
+{
+}
+
+void Host::LatchPadInput() {}
+
+void Host::SetMouseMode(bool relative, bool hide_cursor) {}
+
+bool Host::AcquireHostDisplay(RenderAPI api)
+{
+  return false;
+}
+
+void Host::ReleaseHostDisplay() {}
+
+void Host::RenderDisplay(bool skip_present) {}
+
+void Host::InvalidateDisplay() {}
+
+void Host::RequestResizeHostDisplay(s32 width, s32 height) {}
+
+void Host::OnSystemStarting() {}
+
+void Host::OnSystemStarted() {}
+
+void Host::OnSystemDestroyed() {}
+
+void Host::OnSystemPaused() {}
+
+void Host::OnSystemResumed() {}
+
+void Host::OnPerformanceCountersUpdated() {}
+
+void Host::OnGameChanged(const std::string& disc_path, const std::string& game_serial, const std::string& game_name)
+{
+}
+
+void Host::PumpMessagesOnCPUThread() {}
+
+#ifdef WITH_CHEEVOS
+
+bool Achievements::ConfirmSystemReset()
+{
+  return true;
+}
+
+void Achievements::ResetRuntime() {}
+
+bool Achievements::DoState(StateWrapper& sw)
+{
+  return true;
+}
+
+void Achievements::GameChanged(const std::string& path, CDImage* image) {}
+
+void Achievements::ResetChallengeMode() {}
+
+void Achievements::DisableChallengeMode() {}
+
+bool Achievements::ConfirmChallengeModeDisable(const char* trigger)
+{
+  return true;
+}
+
+bool Achievements::ChallengeModeActive()
+{
+  return false;
+}
+
+#endif
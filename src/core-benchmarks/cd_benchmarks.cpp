@@ -0,0 +1,181 @@
+#include "benchmark.h"
+#include "common/file_system.h"
+#include "common/path.h"
+#include "util/cd_image.h"
+#include "util/cd_xa.h"
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace CDBenchmarks {
+
+enum : u32
+{
+  // one second of 2x speed reading
+  SECTORS_PER_ITERATION = 150,
+
+  XA_SUBHEADER_OFFSET = CDImage::SECTOR_SYNC_SIZE + sizeof(CDImage::SectorHeader),
+  XA_CODINGINFO_OFFSET = XA_SUBHEADER_OFFSET + 3,
+  XA_CODINGINFO_STEREO = 0x01,
+  XA_CODINGINFO_8BIT = 0x10,
+
+  ECM_TYPE_RAW = 0,
+  ECM_TYPE_MODE2_FORM1 = 2,
+  ECM_TYPE_MODE2_FORM2 = 3,
+  ECM_MODE2_FORM1_SIZE = 0x804,
+  ECM_MODE2_FORM2_SIZE = 0x918,
+};
+
+static void FillRandom(u8* data, size_t size, u32 seed);
+static void RunXABenchmark(Benchmark::State& state, u8 codinginfo);
+static std::string WriteECMFile(u32 type, u32 sector_size);
+static void RunECMBenchmark(Benchmark::State& state, u32 type, u32 sector_size);
+
+} // namespace CDBenchmarks
+
+void CDBenchmarks::FillRandom(u8* data, size_t size, u32 seed)
+{
+  for (size_t i = 0; i < size; i++)
+  {
+    seed = seed * 1103515245u + 12345u;
+    data[i] = static_cast<u8>(seed >> 24);
+  }
+}
+
+void CDBenchmarks::RunXABenchmark(Benchmark::State& state, u8 codinginfo)
+{
+  // random sound groups are fine, out of range shifts are clamped and the filter is two bits
+  std::vector<std::array<u8, CDImage::RAW_SECTOR_SIZE>> sectors(SECTORS_PER_ITERATION);
+  for (u32 i = 0; i < SECTORS_PER_ITERATION; i++)
+  {
+    FillRandom(sectors[i].data(), sectors[i].size(), i + 1);
+    sectors[i][XA_CODINGINFO_OFFSET] = codinginfo;
+  }
+
+  std::array<s16, CDXA::XA_ADPCM_SAMPLES_PER_SECTOR_4BIT> samples;
+  std::array<s32, 4> last_samples = {};
+  while (state.KeepRunning())
+  {
+    for (const std::array<u8, CDImage::RAW_SECTOR_SIZE>& sector : sectors)
+      CDXA::DecodeADPCMSector(sector.data(), samples.data(), last_samples.data());
+  }
+
+  Benchmark::DoNotOptimize(samples.data());
+  state.SetItemsPerIteration(SECTORS_PER_ITERATION);
+  state.SetBytesPerIteration(SECTORS_PER_ITERATION * CDImage::RAW_SECTOR_SIZE);
+}
+
+static void CDXA_Decode4BitMono(Benchmark::State& state)
+{
+  CDBenchmarks::RunXABenchmark(state, 0);
+}
+BENCHMARK(CDXA_Decode4BitMono);
+
+static void CDXA_Decode4BitStereo(Benchmark::State& state)
+{
+  CDBenchmarks::RunXABenchmark(state, CDBenchmarks::XA_CODINGINFO_STEREO);
+}
+BENCHMARK(CDXA_Decode4BitStereo);
+
+static void CDXA_Decode8BitStereo(Benchmark::State& state)
+{
+  CDBenchmarks::RunXABenchmark(state, CDBenchmarks::XA_CODINGINFO_STEREO | CDBenchmarks::XA_CODINGINFO_8BIT);
+}
+BENCHMARK(CDXA_Decode8BitStereo);
+
+std::string CDBenchmarks::WriteECMFile(u32 type, u32 sector_size)
+{
+  // the EDC/ECC generation is internal to the ECM reader, so exercise it through a single-chunk image
+  std::string path = Path::Combine(FileSystem::GetWorkingDirectory(), "core-benchmarks.ecm");
+  std::FILE* fp = FileSystem::OpenCFile(path.c_str(), "wb");
+  if (!fp)
+    return {};
+
+  std::vector<u8> data;
+  data.insert(data.end(), {'E', 'C', 'M', 0});
+
+  // type in the low two bits, then the count minus one, five bits followed by groups of seven
+  const auto write_chunk_header = [&data](u32 chunk_type, u32 count) {
+    count--;
+    data.push_back(static_cast<u8>(chunk_type | ((count & 0x1F) << 2) | ((count > 0x1F) ? 0x80 : 0x00)));
+    for (count >>= 5; count != 0; count >>= 7)
+      data.push_back(static_cast<u8>((count & 0x7F) | ((count > 0x7F) ? 0x80 : 0x00)));
+  };
+
+  // mode 2 chunks don't include the sync and header, so like images of real discs, store those raw before each
+  for (u32 i = 0; i < SECTORS_PER_ITERATION; i++)
+  {
+    const CDImage::Position position = CDImage::Position::FromLBA(i + CDImage::FRAMES_PER_SECOND * 2);
+    write_chunk_header(ECM_TYPE_RAW, CDImage::SECTOR_SYNC_SIZE + sizeof(CDImage::SectorHeader));
+    data.insert(data.end(), {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00});
+    const auto [minute, second, frame] = position.ToBCD();
+    data.insert(data.end(), {minute, second, frame, 2});
+
+    write_chunk_header(type, 1);
+    const size_t sector_start = data.size();
+    data.resize(sector_start + sector_size);
+    FillRandom(&data[sector_start], sector_size, type + i);
+  }
+
+  // end of image, a count of 0xFFFFFFFF
+  data.insert(data.end(), {0xFC, 0xFF, 0xFF, 0xFF, 0x3F});
+
+  const bool result = (std::fwrite(data.data(), data.size(), 1, fp) == 1);
+  std::fclose(fp);
+  if (!result)
+  {
+    FileSystem::DeleteFile(path.c_str());
+    return {};
+  }
+
+  return path;
+}
+
+void CDBenchmarks::RunECMBenchmark(Benchmark::State& state, u32 type, u32 sector_size)
+{
+  const std::string path = WriteECMFile(type, sector_size);
+  if (path.empty())
+  {
+    state.SkipWithError("Failed to write ECM image");
+    return;
+  }
+
+  std::unique_ptr<CDImage> image = CDImage::OpenEcmImage(path.c_str(), nullptr);
+  if (!image)
+  {
+    FileSystem::DeleteFile(path.c_str());
+    state.SkipWithError("Failed to open ECM image");
+    return;
+  }
+
+  // the image isn't precached, so every read regenerates the sector's EDC/ECC
+  std::array<u8, CDImage::RAW_SECTOR_SIZE> sector;
+  while (state.KeepRunning())
+  {
+    image->Seek(1, static_cast<CDImage::LBA>(0));
+    for (u32 i = 0; i < SECTORS_PER_ITERATION; i++)
+      image->ReadRawSector(sector.data(), nullptr);
+  }
+
+  Benchmark::DoNotOptimize(sector.data());
+  image.reset();
+  FileSystem::DeleteFile(path.c_str());
+
+  state.SetItemsPerIteration(SECTORS_PER_ITERATION);
+  state.SetBytesPerIteration(SECTORS_PER_ITERATION * CDImage::RAW_SECTOR_SIZE);
+}
+
+// EDC and both ECC parity sets
+static void CD_ECMDecodeMode2Form1(Benchmark::State& state)
+{
+  CDBenchmarks::RunECMBenchmark(state, CDBenchmarks::ECM_TYPE_MODE2_FORM1, CDBenchmarks::ECM_MODE2_FORM1_SIZE);
+}
+BENCHMARK(CD_ECMDecodeMode2Form1);
+
+// EDC only
+static void CD_ECMDecodeMode2Form2(Benchmark::State& state)
+{
+  CDBenchmarks::RunECMBenchmark(state, CDBenchmarks::ECM_TYPE_MODE2_FORM2, CDBenchmarks::ECM_MODE2_FORM2_SIZE);
+}
+BENCHMARK(CD_ECMDecodeMode2Form2);
@@ -0,0 +1,284 @@
+#include "benchmark.h"
+#include "core/gpu_sw_backend.h"
+#include "core/settings.h"
+#include <memory>
+
+namespace GPUSWBackendBenchmarks {
+
+enum : u32
+{
+  // drawing to a 640x480 framebuffer, textures and palettes off to the right
+  DRAWING_AREA_WIDTH = 640,
+  DRAWING_AREA_HEIGHT = 480,
+  TEXTURE_PAGE_X = 640,
+  PALETTE_X = 0,
+  PALETTE_Y = 496,
+
+  PRIMITIVES_PER_ITERATION = 256,
+  PRIMITIVE_SIZE = 64,
+};
+
+enum : u32
+{
+  RC_POLYGON = 0x20000000,
+  RC_RECTANGLE = 0x60000000,
+  RC_SHADED = 0x10000000,
+  RC_QUAD = 0x08000000,
+  RC_TEXTURED = 0x04000000,
+  RC_TRANSPARENT = 0x02000000,
+};
+
+struct DrawConfig
+{
+  u32 render_command;
+  GPUTextureMode texture_mode;
+  bool dither;
+};
+
+static std::unique_ptr<GPU_SW_Backend> SetUp(u32 num_threads);
+static void TearDown(std::unique_ptr<GPU_SW_Backend> backend);
+static void FillDrawCommand(GPUBackendDrawCommand* cmd, const DrawConfig& config);
+static void RunPolygonBenchmark(Benchmark::State& state, const DrawConfig& config, u32 num_threads = 1);
+
+} // namespace GPUSWBackendBenchmarks
+
+std::unique_ptr<GPU_SW_Backend> GPUSWBackendBenchmarks::SetUp(u32 num_threads)
+{
+  // commands are executed as soon as they're pushed, so we don't measure the queue
+  g_settings.gpu_use_thread = false;
+  g_settings.gpu_software_renderer_threads = num_threads;
+  g_settings.gpu_software_renderer_scale = 1;
+
+  std::unique_ptr<GPU_SW_Backend> backend = std::make_unique<GPU_SW_Backend>();
+  if (!backend->Initialize(false))
+    return {};
+
+  // noise for the textures, so neither the palette lookups nor the transparent texel checks are predictable
+  u16* vram = backend->GetVRAM();
+  u32 seed = 0x13579BDFu;
+  for (u32 i = 0; i < VRAM_WIDTH * VRAM_HEIGHT; i++)
+  {
+    seed = seed * 1103515245u + 12345u;
+    vram[i] = static_cast<u16>(seed >> 16);
+  }
+
+  GPUBackendSetDrawingAreaCommand* cmd = backend->NewSetDrawingAreaCommand();
+  cmd->params.bits = 0;
+  cmd->new_area.Set(0, 0, DRAWING_AREA_WIDTH - 1, DRAWING_AREA_HEIGHT - 1);
+  backend->PushCommand(cmd);
+  return backend;
+}
+
+void GPUSWBackendBenchmarks::TearDown(std::unique_ptr<GPU_SW_Backend> backend)
+{
+  backend->Shutdown();
+  g_settings = Settings();
+}
+
+void GPUSWBackendBenchmarks::FillDrawCommand(GPUBackendDrawCommand* cmd, const DrawConfig& config)
+{
+  GPUDrawModeReg draw_mode = {};
+  draw_mode.texture_page_x_base = static_cast<u8>(TEXTURE_PAGE_X / 64);
+  draw_mode.texture_mode = config.texture_mode;
+  draw_mode.transparency_mode = GPUTransparencyMode::HalfBackgroundPlusHalfForeground;
+  draw_mode.dither_enable = config.dither;
+
+  GPUTexturePaletteReg palette = {};
+  palette.x = static_cast<u16>(PALETTE_X / 16);
+  palette.y = static_cast<u16>(PALETTE_Y);
+
+  cmd->params.bits = 0;
+  cmd->rc.bits = config.render_command | 0x808080u;
+  cmd->draw_mode.bits = draw_mode.bits;
+  cmd->palette.bits = palette.bits;
+  cmd->window = GPUTextureWindow{0xFF, 0xFF, 0x00, 0x00};
+}
+
+void GPUSWBackendBenchmarks::RunPolygonBenchmark(Benchmark::State& state, const DrawConfig& config,
+                                                 u32 num_threads /* = 1 */)
+{
+  std::unique_ptr<GPU_SW_Backend> backend = SetUp(num_threads);
+  if (!backend)
+  {
+    state.SkipWithError("Failed to initialize backend");
+    return;
+  }
+
+  const bool quad = (config.render_command & RC_QUAD) != 0;
+  const u32 num_vertices = quad ? 4 : 3;
+
+  while (state.KeepRunning())
+  {
+    for (u32 i = 0; i < PRIMITIVES_PER_ITERATION; i++)
+    {
+      // walk across the screen, so the primitives don't all hit the same cache lines
+      const s32 x = static_cast<s32>((i * 37) % (DRAWING_AREA_WIDTH - PRIMITIVE_SIZE));
+      const s32 y = static_cast<s32>((i * 53) % (DRAWING_AREA_HEIGHT - PRIMITIVE_SIZE));
+      const s32 size = static_cast<s32>(PRIMITIVE_SIZE);
+
+      GPUBackendDrawPolygonCommand* cmd = backend->NewDrawPolygonCommand(num_vertices);
+      FillDrawCommand(cmd, config);
+      cmd->vertices[0].Set(x, y, 0x2040C0, 0x0000);
+      cmd->vertices[1].Set(x + size, y, 0xC04020, 0x00FF);
+      cmd->vertices[2].Set(x, y + size, 0x40C020, 0xFF00);
+      if (quad)
+        cmd->vertices[3].Set(x + size, y + size, 0x808080, 0xFFFF);
+
+      backend->PushCommand(cmd);
+    }
+
+    // waits for the worker threads, if any
+    backend->Sync(false);
+  }
+
+  Benchmark::DoNotOptimize(backend->GetVRAM());
+  TearDown(std::move(backend));
+
+  state.SetItemsPerIteration(PRIMITIVES_PER_ITERATION);
+
+  // a triangle covers half of its bounding box
+  state.SetBytesPerIteration(PRIMITIVES_PER_ITERATION * PRIMITIVE_SIZE * PRIMITIVE_SIZE * sizeof(u16) /
+                             (quad ? 1 : 2));
+}
+
+static void GPU_SW_FlatTriangle(Benchmark::State& state)
+{
+  GPUSWBackendBenchmarks::RunPolygonBenchmark(
+    state, {GPUSWBackendBenchmarks::RC_POLYGON, GPUTextureMode::Palette4Bit, false});
+}
+BENCHMARK(GPU_SW_FlatTriangle);
+
+static void GPU_SW_ShadedQuad(Benchmark::State& state)
+{
+  GPUSWBackendBenchmarks::RunPolygonBenchmark(
+    state,
+    {GPUSWBackendBenchmarks::RC_POLYGON | GPUSWBackendBenchmarks::RC_SHADED | GPUSWBackendBenchmarks::RC_QUAD,
+     GPUTextureMode::Palette4Bit, false});
+}
+BENCHMARK(GPU_SW_ShadedQuad);
+
+static void GPU_SW_ShadedDitheredQuad(Benchmark::State& state)
+{
+  GPUSWBackendBenchmarks::RunPolygonBenchmark(
+    state,
+    {GPUSWBackendBenchmarks::RC_POLYGON | GPUSWBackendBenchmarks::RC_SHADED | GPUSWBackendBenchmarks::RC_QUAD,
+     GPUTextureMode::Palette4Bit, true});
+}
+BENCHMARK(GPU_SW_ShadedDitheredQuad);
+
+static void GPU_SW_Textured4BitQuad(Benchmark::State& state)
+{
+  GPUSWBackendBenchmarks::RunPolygonBenchmark(
+    state,
+    {GPUSWBackendBenchmarks::RC_POLYGON | GPUSWBackendBenchmarks::RC_QUAD | GPUSWBackendBenchmarks::RC_TEXTURED,
+     GPUTextureMode::Palette4Bit, false});
+}
+BENCHMARK(GPU_SW_Textured4BitQuad);
+
+static void GPU_SW_Textured8BitQuad(Benchmark::State& state)
+{
+  GPUSWBackendBenchmarks::RunPolygonBenchmark(
+    state,
+    {GPUSWBackendBenchmarks::RC_POLYGON | GPUSWBackendBenchmarks::RC_QUAD | GPUSWBackendBenchmarks::RC_TEXTURED,
+     GPUTextureMode::Palette8Bit, false});
+}
+BENCHMARK(GPU_SW_Textured8BitQuad);
+
+static void GPU_SW_Textured16BitQuad(Benchmark::State& state)
+{
+  GPUSWBackendBenchmarks::RunPolygonBenchmark(
+    state,
+    {GPUSWBackendBenchmarks::RC_POLYGON | GPUSWBackendBenchmarks::RC_QUAD | GPUSWBackendBenchmarks::RC_TEXTURED,
+     GPUTextureMode::Direct16Bit, false});
+}
+BENCHMARK(GPU_SW_Textured16BitQuad);
+
+// the worst case, every feature of the span loop at once
+static void GPU_SW_TexturedShadedTransparentQuad(Benchmark::State& state)
+{
+  GPUSWBackendBenchmarks::RunPolygonBenchmark(
+    state,
+    {GPUSWBackendBenchmarks::RC_POLYGON | GPUSWBackendBenchmarks::RC_SHADED | GPUSWBackendBenchmarks::RC_QUAD |
+       GPUSWBackendBenchmarks::RC_TEXTURED | GPUSWBackendBenchmarks::RC_TRANSPARENT,
+     GPUTextureMode::Palette4Bit, true});
+}
+BENCHMARK(GPU_SW_TexturedShadedTransparentQuad);
+
+static void GPU_SW_TexturedShadedTransparentQuad4Threads(Benchmark::State& state)
+{
+  GPUSWBackendBenchmarks::RunPolygonBenchmark(
+    state,
+    {GPUSWBackendBenchmarks::RC_POLYGON | GPUSWBackendBenchmarks::RC_SHADED | GPUSWBackendBenchmarks::RC_QUAD |
+       GPUSWBackendBenchmarks::RC_TEXTURED | GPUSWBackendBenchmarks::RC_TRANSPARENT,
+     GPUTextureMode::Palette4Bit, true},
+    4);
+}
+BENCHMARK(GPU_SW_TexturedShadedTransparentQuad4Threads);
+
+static void GPU_SW_TexturedSprite(Benchmark::State& state)
+{
+  using namespace GPUSWBackendBenchmarks;
+
+  std::unique_ptr<GPU_SW_Backend> backend = SetUp(1);
+  if (!backend)
+  {
+    state.SkipWithError("Failed to initialize backend");
+    return;
+  }
+
+  while (state.KeepRunning())
+  {
+    for (u32 i = 0; i < PRIMITIVES_PER_ITERATION; i++)
+    {
+      GPUBackendDrawRectangleCommand* cmd = backend->NewDrawRectangleCommand();
+      FillDrawCommand(cmd, {RC_RECTANGLE | RC_TEXTURED, GPUTextureMode::Palette4Bit, false});
+      cmd->x = static_cast<s32>((i * 37) % (DRAWING_AREA_WIDTH - PRIMITIVE_SIZE));
+      cmd->y = static_cast<s32>((i * 53) % (DRAWING_AREA_HEIGHT - PRIMITIVE_SIZE));
+      cmd->width = static_cast<u16>(PRIMITIVE_SIZE);
+      cmd->height = static_cast<u16>(PRIMITIVE_SIZE);
+      cmd->texcoord = static_cast<u16>((i * 16) & 0xFF);
+      cmd->color = 0x808080;
+      backend->PushCommand(cmd);
+    }
+
+    backend->Sync(false);
+  }
+
+  Benchmark::DoNotOptimize(backend->GetVRAM());
+  TearDown(std::move(backend));
+
+  state.SetItemsPerIteration(PRIMITIVES_PER_ITERATION);
+  state.SetBytesPerIteration(PRIMITIVES_PER_ITERATION * PRIMITIVE_SIZE * PRIMITIVE_SIZE * sizeof(u16));
+}
+BENCHMARK(GPU_SW_TexturedSprite);
+
+static void GPU_SW_FillVRAM(Benchmark::State& state)
+{
+  using namespace GPUSWBackendBenchmarks;
+
+  std::unique_ptr<GPU_SW_Backend> backend = SetUp(1);
+  if (!backend)
+  {
+    state.SkipWithError("Failed to initialize backend");
+    return;
+  }
+
+  while (state.KeepRunning())
+  {
+    GPUBackendFillVRAMCommand* cmd = backend->NewFillVRAMCommand();
+    cmd->params.bits = 0;
+    cmd->x = 0;
+    cmd->y = 0;
+    cmd->width = static_cast<u16>(DRAWING_AREA_WIDTH);
+    cmd->height = static_cast<u16>(DRAWING_AREA_HEIGHT);
+    cmd->color = 0x204080;
+    backend->PushCommand(cmd);
+    backend->Sync(false);
+  }
+
+  Benchmark::DoNotOptimize(backend->GetVRAM());
+  TearDown(std::move(backend));
+
+  state.SetBytesPerIteration(DRAWING_AREA_WIDTH * DRAWING_AREA_HEIGHT * sizeof(u16));
+}
+BENCHMARK(GPU_SW_FillVRAM);
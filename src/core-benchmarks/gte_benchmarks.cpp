@@ -0,0 +1,243 @@
+#include "benchmark.h"
+#include "core/gte.h"
+#include <array>
+
+namespace GTEBenchmarks {
+
+enum : u32
+{
+  // control registers are offset by +32
+  REG_VXY0 = 0,
+  REG_VZ0 = 1,
+  REG_VXY1 = 2,
+  REG_VZ1 = 3,
+  REG_VXY2 = 4,
+  REG_VZ2 = 5,
+  REG_RGBC = 6,
+  REG_IR0 = 8,
+  REG_IR1 = 9,
+  REG_IR2 = 10,
+  REG_IR3 = 11,
+  REG_RT = 32,
+  REG_TR = 37,
+  REG_LLM = 40,
+  REG_BK = 45,
+  REG_LCM = 48,
+  REG_FC = 53,
+  REG_OFX = 56,
+  REG_OFY = 57,
+  REG_H = 58,
+  REG_DQA = 59,
+  REG_DQB = 60,
+  REG_ZSF3 = 61,
+  REG_ZSF4 = 62,
+};
+
+enum : u32
+{
+  CMD_RTPS = 0x0180001,
+  CMD_NCLIP = 0x1400006,
+  CMD_DPCT = 0x0F8002A,
+  CMD_AVSZ3 = 0x158002D,
+  CMD_RTPT = 0x0280030,
+  CMD_NCDT = 0x0F80416,
+  CMD_NCCT = 0x108043F,
+  CMD_GPF = 0x190003D,
+  CMD_MVMVA = 0x0486012,
+};
+
+// commands per iteration, vertices are cycled through so the results aren't constant
+static constexpr u32 BATCH_SIZE = 256;
+static constexpr u32 NUM_VERTICES = 64;
+
+static u32 PackXY(s32 x, s32 y);
+static void SetUpRegisters();
+static void ExecuteCommand(u32 command);
+static void LoadTriangle(u32 index);
+static void RunCommandBenchmark(Benchmark::State& state, u32 command, bool load_vertices, u32 setup_command = 0);
+
+static std::array<std::array<s16, 3>, NUM_VERTICES> s_vertices;
+
+} // namespace GTEBenchmarks
+
+u32 GTEBenchmarks::PackXY(s32 x, s32 y)
+{
+  return (static_cast<u32>(x) & 0xFFFFu) | (static_cast<u32>(y) << 16);
+}
+
+void GTEBenchmarks::SetUpRegisters()
+{
+  GTE::Initialize();
+
+  // rotation around Y by ~30 degrees, 4.12 fixed point
+  GTE::WriteRegister(REG_RT + 0, PackXY(3547, 0));
+  GTE::WriteRegister(REG_RT + 1, PackXY(2048, 0));
+  GTE::WriteRegister(REG_RT + 2, PackXY(4096, 0));
+  GTE::WriteRegister(REG_RT + 3, PackXY(-2048, 0));
+  GTE::WriteRegister(REG_RT + 4, 3547);
+  GTE::WriteRegister(REG_TR + 0, 0);
+  GTE::WriteRegister(REG_TR + 1, 0);
+  GTE::WriteRegister(REG_TR + 2, 2048);
+
+  // one light from the front, and a couple of coloured ones
+  GTE::WriteRegister(REG_LLM + 0, PackXY(0, 0));
+  GTE::WriteRegister(REG_LLM + 1, PackXY(-4096, 2896));
+  GTE::WriteRegister(REG_LLM + 2, PackXY(2896, 0));
+  GTE::WriteRegister(REG_LLM + 3, PackXY(-2896, 0));
+  GTE::WriteRegister(REG_LLM + 4, 2896);
+  GTE::WriteRegister(REG_LCM + 0, PackXY(4096, 0));
+  GTE::WriteRegister(REG_LCM + 1, PackXY(2048, 4096));
+  GTE::WriteRegister(REG_LCM + 2, PackXY(1024, 0));
+  GTE::WriteRegister(REG_LCM + 3, PackXY(1024, 4096));
+  GTE::WriteRegister(REG_LCM + 4, 2048);
+  GTE::WriteRegister(REG_BK + 0, 512);
+  GTE::WriteRegister(REG_BK + 1, 512);
+  GTE::WriteRegister(REG_BK + 2, 768);
+  GTE::WriteRegister(REG_FC + 0, 128 << 4);
+  GTE::WriteRegister(REG_FC + 1, 128 << 4);
+  GTE::WriteRegister(REG_FC + 2, 160 << 4);
+
+  // 320x240 screen, centred
+  GTE::WriteRegister(REG_OFX, 160 << 16);
+  GTE::WriteRegister(REG_OFY, 120 << 16);
+  GTE::WriteRegister(REG_H, 256);
+  GTE::WriteRegister(REG_DQA, static_cast<u32>(-100));
+  GTE::WriteRegister(REG_DQB, 0x1400000);
+  GTE::WriteRegister(REG_ZSF3, 4096 / 3);
+  GTE::WriteRegister(REG_ZSF4, 4096 / 4);
+
+  GTE::WriteRegister(REG_RGBC, 0x30808080);
+  GTE::WriteRegister(REG_IR0, 2048);
+  GTE::WriteRegister(REG_IR1, 1024);
+  GTE::WriteRegister(REG_IR2, 2048);
+  GTE::WriteRegister(REG_IR3, 3072);
+
+  // random points in a cube in front of the camera, some of which push the results into saturation
+  u32 seed = 0x12345678u;
+  for (std::array<s16, 3>& vertex : s_vertices)
+  {
+    for (s16& component : vertex)
+    {
+      seed = seed * 1103515245u + 12345u;
+      component = static_cast<s16>(static_cast<s32>((seed >> 16) & 0x7FF) - 0x400);
+    }
+  }
+}
+
+void GTEBenchmarks::ExecuteCommand(u32 command)
+{
+  // COP2 imm25
+  GTE::ExecuteInstruction(0x4A000000u | command);
+}
+
+void GTEBenchmarks::LoadTriangle(u32 index)
+{
+  for (u32 i = 0; i < 3; i++)
+  {
+    const std::array<s16, 3>& vertex = s_vertices[(index + i) % NUM_VERTICES];
+    GTE::WriteRegister(REG_VXY0 + i * 2, PackXY(vertex[0], vertex[1]));
+    GTE::WriteRegister(REG_VZ0 + i * 2, static_cast<u32>(static_cast<s32>(vertex[2])));
+  }
+}
+
+void GTEBenchmarks::RunCommandBenchmark(Benchmark::State& state, u32 command, bool load_vertices,
+                                        u32 setup_command /* = 0 */)
+{
+  SetUpRegisters();
+  if (setup_command != 0)
+  {
+    LoadTriangle(0);
+    ExecuteCommand(setup_command);
+  }
+
+  while (state.KeepRunning())
+  {
+    for (u32 i = 0; i < BATCH_SIZE; i++)
+    {
+      if (load_vertices)
+        LoadTriangle(i);
+
+      ExecuteCommand(command);
+    }
+  }
+
+  Benchmark::DoNotOptimize(GTE::GetRegisterPtr(0));
+  state.SetItemsPerIteration(BATCH_SIZE);
+}
+
+static void GTE_RTPS(Benchmark::State& state)
+{
+  GTEBenchmarks::RunCommandBenchmark(state, GTEBenchmarks::CMD_RTPS, true);
+}
+BENCHMARK(GTE_RTPS);
+
+static void GTE_RTPT(Benchmark::State& state)
+{
+  GTEBenchmarks::RunCommandBenchmark(state, GTEBenchmarks::CMD_RTPT, true);
+}
+BENCHMARK(GTE_RTPT);
+
+static void GTE_NCLIP(Benchmark::State& state)
+{
+  // needs screen coordinates in the FIFO
+  GTEBenchmarks::RunCommandBenchmark(state, GTEBenchmarks::CMD_NCLIP, false, GTEBenchmarks::CMD_RTPT);
+}
+BENCHMARK(GTE_NCLIP);
+
+static void GTE_AVSZ3(Benchmark::State& state)
+{
+  GTEBenchmarks::RunCommandBenchmark(state, GTEBenchmarks::CMD_AVSZ3, false, GTEBenchmarks::CMD_RTPT);
+}
+BENCHMARK(GTE_AVSZ3);
+
+static void GTE_MVMVA(Benchmark::State& state)
+{
+  GTEBenchmarks::RunCommandBenchmark(state, GTEBenchmarks::CMD_MVMVA, true);
+}
+BENCHMARK(GTE_MVMVA);
+
+static void GTE_NCDT(Benchmark::State& state)
+{
+  GTEBenchmarks::RunCommandBenchmark(state, GTEBenchmarks::CMD_NCDT, true);
+}
+BENCHMARK(GTE_NCDT);
+
+static void GTE_NCCT(Benchmark::State& state)
+{
+  GTEBenchmarks::RunCommandBenchmark(state, GTEBenchmarks::CMD_NCCT, true);
+}
+BENCHMARK(GTE_NCCT);
+
+static void GTE_DPCT(Benchmark::State& state)
+{
+  GTEBenchmarks::RunCommandBenchmark(state, GTEBenchmarks::CMD_DPCT, false);
+}
+BENCHMARK(GTE_DPCT);
+
+static void GTE_GPF(Benchmark::State& state)
+{
+  GTEBenchmarks::RunCommandBenchmark(state, GTEBenchmarks::CMD_GPF, false);
+}
+BENCHMARK(GTE_GPF);
+
+// a mesh transform loop, as games do it: project a triangle, cull, light and sort
+static void GTE_MeshPipeline(Benchmark::State& state)
+{
+  GTEBenchmarks::SetUpRegisters();
+
+  while (state.KeepRunning())
+  {
+    for (u32 i = 0; i < GTEBenchmarks::BATCH_SIZE; i++)
+    {
+      GTEBenchmarks::LoadTriangle(i);
+      GTEBenchmarks::ExecuteCommand(GTEBenchmarks::CMD_RTPT);
+      GTEBenchmarks::ExecuteCommand(GTEBenchmarks::CMD_NCLIP);
+      GTEBenchmarks::ExecuteCommand(GTEBenchmarks::CMD_NCCT);
+      GTEBenchmarks::ExecuteCommand(GTEBenchmarks::CMD_AVSZ3);
+    }
+  }
+
+  Benchmark::DoNotOptimize(GTE::GetRegisterPtr(0));
+  state.SetItemsPerIteration(GTEBenchmarks::BATCH_SIZE);
+}
+BENCHMARK(GTE_MeshPipeline);
@@ -0,0 +1,181 @@
+#include "benchmark.h"
+#include "core/cpu_core.h"
+#include "core/mdec.h"
+#include "core/timing_event.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// The IDCT is internal to the MDEC, so these go through the same register/DMA interface as games do. Decoding is
+// dominated by the IDCT, six per macroblock, with the run-length decode and colour conversion also included.
+namespace MDECBenchmarks {
+
+enum : u32
+{
+  REG_DATA = 0,
+  REG_CONTROL = 4,
+
+  COMMAND_DECODE_MACROBLOCK = 1u << 29,
+  COMMAND_SET_IQ_TABLE = 2u << 29,
+  COMMAND_SET_SCALE_TABLE = 3u << 29,
+  COMMAND_OUTPUT_DEPTH_24BIT = 2u << 27,
+  COMMAND_OUTPUT_DEPTH_15BIT = 3u << 27,
+
+  CONTROL_RESET = 1u << 31,
+  CONTROL_ENABLE_DMA_IN = 1u << 30,
+  CONTROL_ENABLE_DMA_OUT = 1u << 29,
+
+  STATUS_DATA_OUT_FIFO_EMPTY = 1u << 31,
+  STATUS_DATA_IN_REQUEST = 1u << 28,
+
+  // a 320x240 frame
+  MACROBLOCKS_PER_ITERATION = 20 * 15,
+  BLOCKS_PER_MACROBLOCK = 6,
+  AC_COEFFICIENTS_PER_BLOCK = 12,
+  DMA_BLOCK_SIZE = 32,
+
+  // more than the time the MDEC takes to decode a macroblock
+  TICKS_PER_MACROBLOCK = 4096,
+};
+
+static void SetUp();
+static void TearDown();
+static void RunDecodeBenchmark(Benchmark::State& state, u32 output_depth, u32 words_per_macroblock);
+
+static std::vector<u32> s_stream;
+static std::unique_ptr<TimingEvent> s_idle_event;
+
+} // namespace MDECBenchmarks
+
+void MDECBenchmarks::SetUp()
+{
+  // the event loop expects there to always be an active event, which the other devices would normally provide
+  TimingEvents::Initialize();
+  s_idle_event = TimingEvents::CreateTimingEvent(
+    "Benchmark Idle", TICKS_PER_MACROBLOCK, TICKS_PER_MACROBLOCK, [](void*, TickCount, TickCount) {}, nullptr, true);
+  g_mdec.Initialize();
+  g_mdec.WriteRegister(REG_CONTROL, CONTROL_RESET);
+  g_mdec.WriteRegister(REG_CONTROL, CONTROL_ENABLE_DMA_IN | CONTROL_ENABLE_DMA_OUT);
+
+  // luma and chroma quantization tables, coarser for the higher frequencies
+  std::array<u32, 32> iq_table;
+  for (u32 i = 0; i < iq_table.size(); i++)
+  {
+    const u32 base = 2 + (i % 16) * 4;
+    iq_table[i] = base | ((base + 1) << 8) | ((base + 2) << 16) | ((base + 3) << 24);
+  }
+  g_mdec.WriteRegister(REG_DATA, COMMAND_SET_IQ_TABLE | 1);
+  g_mdec.DMAWrite(iq_table.data(), static_cast<u32>(iq_table.size()));
+
+  // the standard DCT basis, which is what the BIOS uploads
+  std::array<u32, 32> scale_table;
+  for (u32 i = 0; i < 64; i += 2)
+  {
+    u32 pair = 0;
+    for (u32 j = 0; j < 2; j++)
+    {
+      const u32 u = (i + j) / 8;
+      const u32 x = (i + j) % 8;
+      const double scale = ((u == 0) ? std::sqrt(0.5) : 1.0) * std::cos((2.0 * x + 1.0) * u * 3.14159265358979 / 16.0);
+      pair |= (static_cast<u32>(static_cast<s32>(std::lround(scale * 32767.0))) & 0xFFFFu) << (j * 16);
+    }
+    scale_table[i / 2] = pair;
+  }
+  g_mdec.WriteRegister(REG_DATA, COMMAND_SET_SCALE_TABLE);
+  g_mdec.DMAWrite(scale_table.data(), static_cast<u32>(scale_table.size()));
+
+  // run-length coded blocks with a DC and a spread of low frequency AC coefficients, like a typical movie frame
+  std::vector<u16> halfwords;
+  u32 seed = 0x2468ACE0u;
+  const auto random = [&seed](u32 range) {
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) % range;
+  };
+  for (u32 macroblock = 0; macroblock < MACROBLOCKS_PER_ITERATION; macroblock++)
+  {
+    for (u32 block = 0; block < BLOCKS_PER_MACROBLOCK; block++)
+    {
+      const u32 q_scale = 4 + random(8);
+      const u32 dc = random(512);
+      halfwords.push_back(static_cast<u16>((q_scale << 10) | dc));
+      for (u32 i = 0; i < AC_COEFFICIENTS_PER_BLOCK; i++)
+      {
+        const u32 run = random(4);
+        const s32 level = static_cast<s32>(random(64)) - 32;
+        halfwords.push_back(static_cast<u16>((run << 10) | (static_cast<u32>(level) & 0x3FF)));
+      }
+
+      // end of block
+      halfwords.push_back(0xFE00);
+    }
+  }
+  if (halfwords.size() & 1)
+    halfwords.push_back(0xFE00);
+
+  s_stream.resize(halfwords.size() / 2);
+  for (size_t i = 0; i < s_stream.size(); i++)
+    s_stream[i] = static_cast<u32>(halfwords[i * 2]) | (static_cast<u32>(halfwords[i * 2 + 1]) << 16);
+}
+
+void MDECBenchmarks::TearDown()
+{
+  g_mdec.Shutdown();
+  s_idle_event.reset();
+  TimingEvents::Shutdown();
+  std::vector<u32>().swap(s_stream);
+}
+
+void MDECBenchmarks::RunDecodeBenchmark(Benchmark::State& state, u32 output_depth, u32 words_per_macroblock)
+{
+  SetUp();
+
+  std::vector<u32> output(words_per_macroblock);
+  while (state.KeepRunning())
+  {
+    g_mdec.WriteRegister(REG_DATA, COMMAND_DECODE_MACROBLOCK | output_depth | static_cast<u32>(s_stream.size()));
+
+    size_t position = 0;
+    u32 macroblocks_read = 0;
+    while (macroblocks_read < MACROBLOCKS_PER_ITERATION)
+    {
+      while (position < s_stream.size() && (g_mdec.ReadRegister(REG_CONTROL) & STATUS_DATA_IN_REQUEST))
+      {
+        const u32 count = static_cast<u32>(std::min<size_t>(s_stream.size() - position, DMA_BLOCK_SIZE));
+        g_mdec.DMAWrite(&s_stream[position], count);
+        position += count;
+      }
+
+      // the decoded macroblock is copied to the output FIFO by an event
+      CPU::AddPendingTicks(TICKS_PER_MACROBLOCK);
+      TimingEvents::RunEvents();
+
+      if (!(g_mdec.ReadRegister(REG_CONTROL) & STATUS_DATA_OUT_FIFO_EMPTY))
+      {
+        g_mdec.DMARead(output.data(), words_per_macroblock);
+        macroblocks_read++;
+      }
+    }
+  }
+
+  Benchmark::DoNotOptimize(output.data());
+  TearDown();
+
+  state.SetItemsPerIteration(MACROBLOCKS_PER_ITERATION);
+  state.SetBytesPerIteration(MACROBLOCKS_PER_ITERATION * words_per_macroblock * sizeof(u32));
+}
+
+static void MDEC_DecodeMacroblocks15Bit(Benchmark::State& state)
+{
+  // 16x16 pixels at 2 bytes each
+  MDECBenchmarks::RunDecodeBenchmark(state, MDECBenchmarks::COMMAND_OUTPUT_DEPTH_15BIT, 128);
+}
+BENCHMARK(MDEC_DecodeMacroblocks15Bit);
+
+static void MDEC_DecodeMacroblocks24Bit(Benchmark::State& state)
+{
+  // 16x16 pixels at 3 bytes each
+  MDECBenchmarks::RunDecodeBenchmark(state, MDECBenchmarks::COMMAND_OUTPUT_DEPTH_24BIT, 192);
+}
+BENCHMARK(MDEC_DecodeMacroblocks24Bit);
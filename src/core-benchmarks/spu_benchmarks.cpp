@@ -0,0 +1,173 @@
+#include "benchmark.h"
+#include "core/cpu_core.h"
+#include "core/spu.h"
+#include "core/timing_event.h"
+#include <array>
+
+namespace SPUBenchmarks {
+
+enum : u32
+{
+  // register offsets from the start of the SPU's I/O area
+  VOICE_REGISTER_SIZE = 0x10,
+  VOICE_VOLUME_LEFT = 0x00,
+  VOICE_VOLUME_RIGHT = 0x02,
+  VOICE_PITCH = 0x04,
+  VOICE_START_ADDRESS = 0x06,
+  VOICE_ADSR_LOW = 0x08,
+  VOICE_ADSR_HIGH = 0x0A,
+  VOICE_REPEAT_ADDRESS = 0x0E,
+  MAIN_VOLUME_LEFT = 0x180,
+  MAIN_VOLUME_RIGHT = 0x182,
+  REVERB_VOLUME_LEFT = 0x184,
+  REVERB_VOLUME_RIGHT = 0x186,
+  KEY_ON_LOW = 0x188,
+  KEY_ON_HIGH = 0x18A,
+  REVERB_ON_LOW = 0x198,
+  REVERB_ON_HIGH = 0x19A,
+  REVERB_BASE_ADDRESS = 0x1A2,
+  SPUCNT = 0x1AA,
+  REVERB_REGISTERS = 0x1C0,
+  NUM_REVERB_REGISTERS = 32,
+
+  SPUCNT_ENABLE = 0x8000,
+  SPUCNT_UNMUTE = 0x4000,
+  SPUCNT_REVERB_ENABLE = 0x0080,
+};
+
+enum : u32
+{
+  NUM_VOICES = 24,
+  ADPCM_BLOCK_SIZE = 16,
+  SAMPLE_DATA_START = 0x1000,
+  SAMPLE_DATA_SIZE = 0x40000,
+  REVERB_AREA_SIZE = 0x26C0,
+
+  // one NTSC frame's worth of samples, per iteration
+  SAMPLES_PER_ITERATION = 735,
+  TICKS_PER_SAMPLE = 768,
+};
+
+// in the range of the BIOS presets, the cost of the reverb doesn't depend on the actual values
+static constexpr std::array<u16, NUM_REVERB_REGISTERS> s_reverb_registers = {
+  {0x007D, 0x005B, 0x6D80, 0x54B8, 0xBF40, 0xBEC0, 0x7000, 0x7000, 0x5C00, 0x5200, 0x4000,
+   0xB200, 0x5600, 0x4C00, 0x4400, 0x3D00, 0x034C, 0x0250, 0x01A0, 0x0168, 0x00F6, 0x0079,
+   0x00B6, 0x0079, 0x002E, 0x002C, 0x0154, 0x0142, 0x0154, 0x0142, 0x8000, 0x8000}};
+
+static void SetUp(u32 num_voices, bool reverb);
+static void TearDown();
+static void RunSPUBenchmark(Benchmark::State& state, u32 num_voices, bool reverb);
+
+} // namespace SPUBenchmarks
+
+void SPUBenchmarks::SetUp(u32 num_voices, bool reverb)
+{
+  TimingEvents::Initialize();
+  SPU::Initialize();
+
+  // noise-like ADPCM with a mix of filters and shifts, looping over the whole sample area
+  std::array<u8, SPU::RAM_SIZE>& ram = SPU::GetWritableRAM();
+  u32 seed = 0x87654321u;
+  for (u32 address = SAMPLE_DATA_START; address < (SAMPLE_DATA_START + SAMPLE_DATA_SIZE); address += ADPCM_BLOCK_SIZE)
+  {
+    seed = seed * 1103515245u + 12345u;
+    ram[address + 0] = static_cast<u8>((((seed >> 16) % 5) << 4) | ((seed >> 20) % 12));
+    ram[address + 1] = 0;
+    for (u32 i = 2; i < ADPCM_BLOCK_SIZE; i++)
+    {
+      seed = seed * 1103515245u + 12345u;
+      ram[address + i] = static_cast<u8>(seed >> 24);
+    }
+  }
+  ram[SAMPLE_DATA_START + 1] = 0x04;                                        // loop start
+  ram[SAMPLE_DATA_START + SAMPLE_DATA_SIZE - ADPCM_BLOCK_SIZE + 1] = 0x03; // loop end + repeat
+
+  u16 spucnt = SPUCNT_ENABLE | SPUCNT_UNMUTE;
+  if (reverb)
+  {
+    spucnt |= SPUCNT_REVERB_ENABLE;
+    for (u32 i = 0; i < NUM_REVERB_REGISTERS; i++)
+      SPU::WriteRegister(REVERB_REGISTERS + i * 2, s_reverb_registers[i]);
+    SPU::WriteRegister(REVERB_BASE_ADDRESS, static_cast<u16>((SPU::RAM_SIZE - REVERB_AREA_SIZE) / 8));
+    SPU::WriteRegister(REVERB_VOLUME_LEFT, 0x3000);
+    SPU::WriteRegister(REVERB_VOLUME_RIGHT, 0x3000);
+  }
+  SPU::WriteRegister(SPUCNT, spucnt);
+  SPU::WriteRegister(MAIN_VOLUME_LEFT, 0x3FFF);
+  SPU::WriteRegister(MAIN_VOLUME_RIGHT, 0x3FFF);
+
+  for (u32 voice = 0; voice < num_voices; voice++)
+  {
+    // spread the voices out through the sample data, at a range of pitches
+    const u32 base = voice * VOICE_REGISTER_SIZE;
+    const u32 start_address = SAMPLE_DATA_START + ((voice * SAMPLE_DATA_SIZE / NUM_VOICES) & ~(ADPCM_BLOCK_SIZE - 1));
+    SPU::WriteRegister(base + VOICE_VOLUME_LEFT, 0x1000);
+    SPU::WriteRegister(base + VOICE_VOLUME_RIGHT, 0x1000);
+    SPU::WriteRegister(base + VOICE_PITCH, static_cast<u16>(0x0800 + voice * 0x80));
+    SPU::WriteRegister(base + VOICE_START_ADDRESS, static_cast<u16>(start_address / 8));
+    SPU::WriteRegister(base + VOICE_REPEAT_ADDRESS, static_cast<u16>(SAMPLE_DATA_START / 8));
+
+    // fastest attack, then hold at the maximum sustain level
+    SPU::WriteRegister(base + VOICE_ADSR_LOW, 0x000F);
+    SPU::WriteRegister(base + VOICE_ADSR_HIGH, 0x1FC0);
+  }
+
+  const u32 voice_mask = (num_voices < 32) ? ((1u << num_voices) - 1u) : 0xFFFFFFFFu;
+  if (reverb)
+  {
+    SPU::WriteRegister(REVERB_ON_LOW, static_cast<u16>(voice_mask));
+    SPU::WriteRegister(REVERB_ON_HIGH, static_cast<u16>(voice_mask >> 16));
+  }
+  SPU::WriteRegister(KEY_ON_LOW, static_cast<u16>(voice_mask));
+  SPU::WriteRegister(KEY_ON_HIGH, static_cast<u16>(voice_mask >> 16));
+}
+
+void SPUBenchmarks::TearDown()
+{
+  SPU::Shutdown();
+  TimingEvents::Shutdown();
+}
+
+void SPUBenchmarks::RunSPUBenchmark(Benchmark::State& state, u32 num_voices, bool reverb)
+{
+  SetUp(num_voices, reverb);
+
+  while (state.KeepRunning())
+  {
+    CPU::AddPendingTicks(SAMPLES_PER_ITERATION * TICKS_PER_SAMPLE);
+    TimingEvents::RunEvents();
+  }
+
+  TearDown();
+  state.SetItemsPerIteration(SAMPLES_PER_ITERATION);
+}
+
+static void SPU_Silent(Benchmark::State& state)
+{
+  SPUBenchmarks::RunSPUBenchmark(state, 0, false);
+}
+BENCHMARK(SPU_Silent);
+
+static void SPU_1Voice(Benchmark::State& state)
+{
+  SPUBenchmarks::RunSPUBenchmark(state, 1, false);
+}
+BENCHMARK(SPU_1Voice);
+
+static void SPU_8Voices(Benchmark::State& state)
+{
+  SPUBenchmarks::RunSPUBenchmark(state, 8, false);
+}
+BENCHMARK(SPU_8Voices);
+
+static void SPU_24Voices(Benchmark::State& state)
+{
+  SPUBenchmarks::RunSPUBenchmark(state, 24, false);
+}
+BENCHMARK(SPU_24Voices);
+
+static void SPU_24VoicesReverb(Benchmark::State& state)
+{
+  SPUBenchmarks::RunSPUBenchmark(state, 24, true);
+}
+BENCHMARK(SPU_24VoicesReverb);
@@ -0,0 +1,244 @@
+#include "benchmark.h"
+#include "common/byte_stream.h"
+#include "util/state_wrapper.h"
+#include <array>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace StateBenchmarks {
+
+enum : u32
+{
+  RAM_SIZE = 2 * 1024 * 1024,
+  VRAM_SIZE = 1024 * 512 * sizeof(u16),
+  SPU_RAM_SIZE = 512 * 1024,
+  PAGE_SIZE = 4096,
+
+  // register-sized fields, in the order of thousands across all the devices
+  NUM_SCALARS = 4096,
+  NUM_MARKERS = 32,
+
+  STATE_VERSION = 1,
+};
+
+namespace {
+struct SyntheticState
+{
+  std::vector<u8> ram;
+  std::vector<u8> vram;
+  std::vector<u8> spu_ram;
+  std::array<u32, NUM_SCALARS> words;
+  std::array<u16, NUM_SCALARS> halfwords;
+  std::array<bool, NUM_SCALARS> flags;
+};
+} // namespace
+
+static void Generate(SyntheticState* state);
+static bool DoState(StateWrapper& sw, SyntheticState* state, bool bulk);
+static void Serialize(SyntheticState* state, GrowableMemoryByteStream* stream);
+static void RunRoundTripBenchmark(Benchmark::State& state, bool bulk);
+static void RunZstdCompressBenchmark(Benchmark::State& state, u32 num_workers);
+
+} // namespace StateBenchmarks
+
+void StateBenchmarks::Generate(SyntheticState* state)
+{
+  // roughly the mix of a real console: RAM is mostly zeroed pages, code with a small vocabulary, and noise
+  u32 seed = 0xDEADBEEFu;
+  const auto random = [&seed]() {
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+  };
+
+  std::array<u32, 256> code_words;
+  for (u32& word : code_words)
+    word = (random() << 8) ^ random();
+
+  state->ram.resize(RAM_SIZE);
+  for (u32 page = 0; page < RAM_SIZE; page += PAGE_SIZE)
+  {
+    const u32 type = random() % 10;
+    for (u32 offset = 0; offset < PAGE_SIZE; offset += sizeof(u32))
+    {
+      const u32 word = (type < 4) ? 0 : ((type < 7) ? code_words[random() % code_words.size()] : random());
+      std::memcpy(&state->ram[page + offset], &word, sizeof(word));
+    }
+  }
+
+  // VRAM is gradients with a bit of noise, SPU RAM is ADPCM which is close to incompressible
+  state->vram.resize(VRAM_SIZE);
+  for (u32 i = 0; i < VRAM_SIZE / sizeof(u16); i++)
+  {
+    const u32 x = i % 1024;
+    const u32 y = i / 1024;
+    const u16 pixel = static_cast<u16>(((x >> 5) & 0x1F) | (((y >> 4) & 0x1F) << 5) | ((random() & 0x3) << 10));
+    std::memcpy(&state->vram[i * sizeof(u16)], &pixel, sizeof(pixel));
+  }
+
+  state->spu_ram.resize(SPU_RAM_SIZE);
+  for (u8& value : state->spu_ram)
+    value = static_cast<u8>(random());
+
+  for (u32 i = 0; i < NUM_SCALARS; i++)
+  {
+    state->words[i] = random();
+    state->halfwords[i] = static_cast<u16>(random());
+    state->flags[i] = (random() & 1) != 0;
+  }
+}
+
+bool StateBenchmarks::DoState(StateWrapper& sw, SyntheticState* state, bool bulk)
+{
+  // a marker per device, with its registers in between
+  for (u32 device = 0; device < NUM_MARKERS; device++)
+  {
+    if (!sw.DoMarker("Device"))
+      return false;
+
+    for (u32 i = device; i < NUM_SCALARS; i += NUM_MARKERS)
+    {
+      sw.Do(&state->words[i]);
+      sw.Do(&state->halfwords[i]);
+      sw.Do(&state->flags[i]);
+    }
+  }
+
+  if (bulk)
+  {
+    sw.DoBytes(state->ram.data(), state->ram.size());
+    sw.DoBytes(state->vram.data(), state->vram.size());
+    sw.DoBytes(state->spu_ram.data(), state->spu_ram.size());
+  }
+
+  return !sw.HasError();
+}
+
+void StateBenchmarks::Serialize(SyntheticState* state, GrowableMemoryByteStream* stream)
+{
+  StateWrapper sw(stream, StateWrapper::Mode::Write, STATE_VERSION);
+  DoState(sw, state, true);
+}
+
+void StateBenchmarks::RunRoundTripBenchmark(Benchmark::State& state, bool bulk)
+{
+  std::unique_ptr<SyntheticState> source = std::make_unique<SyntheticState>();
+  std::unique_ptr<SyntheticState> dest = std::make_unique<SyntheticState>();
+  Generate(source.get());
+  dest->ram.resize(RAM_SIZE);
+  dest->vram.resize(VRAM_SIZE);
+  dest->spu_ram.resize(SPU_RAM_SIZE);
+
+  std::unique_ptr<GrowableMemoryByteStream> stream = ByteStream::CreateGrowableMemoryStream();
+  u64 size = 0;
+  while (state.KeepRunning())
+  {
+    stream->SeekAbsolute(0);
+    {
+      StateWrapper sw(stream.get(), StateWrapper::Mode::Write, STATE_VERSION);
+      DoState(sw, source.get(), bulk);
+      size = sw.GetPosition();
+    }
+
+    stream->SeekAbsolute(0);
+    {
+      StateWrapper sw(stream.get(), StateWrapper::Mode::Read, STATE_VERSION);
+      if (!DoState(sw, dest.get(), bulk))
+      {
+        state.SkipWithError("Failed to read state back");
+        return;
+      }
+    }
+  }
+
+  Benchmark::DoNotOptimize(dest.get());
+  state.SetBytesPerIteration(size * 2);
+}
+
+static void State_WrapperRoundTrip(Benchmark::State& state)
+{
+  StateBenchmarks::RunRoundTripBenchmark(state, true);
+}
+BENCHMARK(State_WrapperRoundTrip);
+
+// only the per-field overhead, without the memory copies
+static void State_WrapperScalarRoundTrip(Benchmark::State& state)
+{
+  StateBenchmarks::RunRoundTripBenchmark(state, false);
+  state.SetItemsPerIteration(StateBenchmarks::NUM_SCALARS * 3 * 2);
+}
+BENCHMARK(State_WrapperScalarRoundTrip);
+
+void StateBenchmarks::RunZstdCompressBenchmark(Benchmark::State& state, u32 num_workers)
+{
+  std::unique_ptr<SyntheticState> source = std::make_unique<SyntheticState>();
+  Generate(source.get());
+
+  std::unique_ptr<GrowableMemoryByteStream> uncompressed = ByteStream::CreateGrowableMemoryStream();
+  Serialize(source.get(), uncompressed.get());
+  const u32 uncompressed_size = static_cast<u32>(uncompressed->GetSize());
+
+  // same compression level as save states
+  std::unique_ptr<GrowableMemoryByteStream> compressed = ByteStream::CreateGrowableMemoryStream();
+  while (state.KeepRunning())
+  {
+    compressed->SeekAbsolute(0);
+    std::unique_ptr<ByteStream> cstream = ByteStream::CreateZstdCompressStream(compressed.get(), 0, num_workers);
+    if (!cstream->Write2(uncompressed->GetMemoryPointer(), uncompressed_size) || !cstream->Commit())
+    {
+      state.SkipWithError("Compression failed");
+      return;
+    }
+  }
+
+  state.SetBytesPerIteration(uncompressed_size);
+}
+
+static void State_ZstdCompress(Benchmark::State& state)
+{
+  StateBenchmarks::RunZstdCompressBenchmark(state, 0);
+}
+BENCHMARK(State_ZstdCompress);
+
+static void State_ZstdCompress4Workers(Benchmark::State& state)
+{
+  StateBenchmarks::RunZstdCompressBenchmark(state, 4);
+}
+BENCHMARK(State_ZstdCompress4Workers);
+
+static void State_ZstdDecompress(Benchmark::State& state)
+{
+  std::unique_ptr<StateBenchmarks::SyntheticState> source = std::make_unique<StateBenchmarks::SyntheticState>();
+  StateBenchmarks::Generate(source.get());
+
+  std::unique_ptr<GrowableMemoryByteStream> uncompressed = ByteStream::CreateGrowableMemoryStream();
+  StateBenchmarks::Serialize(source.get(), uncompressed.get());
+  const u32 uncompressed_size = static_cast<u32>(uncompressed->GetSize());
+
+  std::unique_ptr<GrowableMemoryByteStream> compressed = ByteStream::CreateGrowableMemoryStream();
+  {
+    std::unique_ptr<ByteStream> cstream = ByteStream::CreateZstdCompressStream(compressed.get(), 0);
+    if (!cstream->Write2(uncompressed->GetMemoryPointer(), uncompressed_size) || !cstream->Commit())
+    {
+      state.SkipWithError("Compression failed");
+      return;
+    }
+  }
+  const u32 compressed_size = static_cast<u32>(compressed->GetSize());
+
+  std::vector<u8> output(uncompressed_size);
+  while (state.KeepRunning())
+  {
+    compressed->SeekAbsolute(0);
+    std::unique_ptr<ByteStream> dstream = ByteStream::CreateZstdDecompressStream(compressed.get(), compressed_size);
+    if (!dstream->Read2(output.data(), uncompressed_size))
+    {
+      state.SkipWithError("Decompression failed");
+      return;
+    }
+  }
+
+  Benchmark::DoNotOptimize(output.data());
+  state.SetBytesPerIteration(uncompressed_size);
+}
+BENCHMARK(State_ZstdDecompress);
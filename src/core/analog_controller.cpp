@@ -233,6 +233,19 @@ std::optional<u32> AnalogController::GetAnalogInputBytes() const
          m_axis_state[static_cast<size_t>(Axis::RightY)] << 8 | m_axis_state[static_cast<size_t>(Axis::RightX)];
 }
 
+void AnalogController::SetInputState(u32 button_bits, u32 analog_bytes)
+{
+  m_button_state = static_cast<u16>(button_bits ^ 0xFFFF);
+  m_axis_state[static_cast<size_t>(Axis::LeftY)] = static_cast<u8>(analog_bytes >> 24);
+  m_axis_state[static_cast<size_t>(Axis::LeftX)] = static_cast<u8>(analog_bytes >> 16);
+  m_axis_state[static_cast<size_t>(Axis::RightY)] = static_cast<u8>(analog_bytes >> 8);
+  m_axis_state[static_cast<size_t>(Axis::RightX)] = static_cast<u8>(analog_bytes);
+
+  // the analog button has no held state, a set bit is a press
+  if (button_bits & (1u << static_cast<u32>(Button::Analog)))
+    SetBindState(static_cast<u32>(Button::Analog), 1.0f);
+}
+
 void AnalogController::ResetTransferState()
 {
   if (m_analog_toggle_queued)
@@ -71,6 +71,7 @@ public:
   void SetBindState(u32 index, float value) override;
   u32 GetButtonStateBits() const override;
   std::optional<u32> GetAnalogInputBytes() const override;
+  void SetInputState(u32 button_bits, u32 analog_bytes) override;
 
   void ResetTransferState() override;
   bool Transfer(const u8 data_in, u8* data_out) override;
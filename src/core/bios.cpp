@@ -278,7 +278,7 @@ DiscRegion GetPSExeDiscRegion(const PSEXEHeader& header)
 
 } // namespace BIOS
 
-std::optional<std::vector<u8>> BIOS::GetBIOSImage(ConsoleRegion region)
+std::optional<std::vector<u8>> BIOS::GetBIOSImage(ConsoleRegion region, std::string* out_path /* = nullptr */)
 {
   std::string bios_name;
   switch (region)
@@ -300,11 +300,12 @@ std::optional<std::vector<u8>> BIOS::GetBIOSImage(ConsoleRegion region)
   if (bios_name.empty())
   {
     // auto-detect
-    return FindBIOSImageInDirectory(region, EmuFolders::Bios.c_str());
+    return FindBIOSImageInDirectory(region, EmuFolders::Bios.c_str(), out_path);
   }
 
   // try the configured path
-  std::optional<Image> image = LoadImageFromFile(Path::Combine(EmuFolders::Bios, bios_name).c_str());
+  std::string path(Path::Combine(EmuFolders::Bios, bios_name));
+  std::optional<Image> image = LoadImageFromFile(path.c_str());
   if (!image.has_value())
   {
     Host::ReportFormattedErrorAsync(
@@ -318,10 +319,14 @@ std::optional<std::vector<u8>> BIOS::GetBIOSImage(ConsoleRegion region)
   if (!IsValidHashForRegion(region, found_hash))
     Log_WarningPrintf("Hash for BIOS '%s' does not match region. This may cause issues.", bios_name.c_str());
 
+  if (out_path)
+    *out_path = std::move(path);
+
   return image;
 }
 
-std::optional<std::vector<u8>> BIOS::FindBIOSImageInDirectory(ConsoleRegion region, const char* directory)
+std::optional<std::vector<u8>> BIOS::FindBIOSImageInDirectory(ConsoleRegion region, const char* directory,
+                                                              std::string* out_path /* = nullptr */)
 {
   Log_InfoPrintf("Searching for a %s BIOS in '%s'...", Settings::GetConsoleRegionDisplayName(region), directory);
 
@@ -354,6 +359,8 @@ std::optional<std::vector<u8>> BIOS::FindBIOSImageInDirectory(ConsoleRegion regi
     if (IsValidHashForRegion(region, found_hash))
     {
       Log_InfoPrintf("Using BIOS '%s': %s", fd.FileName.c_str(), ii ? ii->description : "");
+      if (out_path)
+        *out_path = std::move(full_path);
       return found_image;
     }
 
@@ -384,6 +391,9 @@ std::optional<std::vector<u8>> BIOS::FindBIOSImageInDirectory(ConsoleRegion regi
                       fallback_info->description);
   }
 
+  if (out_path)
+    *out_path = std::move(fallback_path);
+
   return fallback_image;
 }
 
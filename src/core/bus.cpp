@@ -2,6 +2,8 @@
 #include "cdrom.h"
 #include "common/align.h"
 #include "common/assert.h"
+#include "common/bitutils.h"
+#include "common/file_system.h"
 #include "common/log.h"
 #include "common/make_array.h"
 #include "cpu_code_cache.h"
@@ -19,8 +21,19 @@
 #include "timers.h"
 #include "util/state_wrapper.h"
 #include <cstdio>
+#include <cstring>
 #include <tuple>
 #include <utility>
+
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
 Log_SetChannel(Bus);
 
 namespace Bus {
@@ -73,10 +86,16 @@ union MEMCTRL
 
 std::bitset<RAM_8MB_CODE_PAGE_COUNT> m_ram_code_bits{};
 u32 m_ram_code_page_count = 0;
+
+// pages with a watchpoint, writes to these always go through DoRAMAccess
+static std::bitset<RAM_8MB_CODE_PAGE_COUNT> m_ram_watch_bits{};
 u8* g_ram = nullptr; // 2MB RAM
 u32 g_ram_size = 0;
 u32 g_ram_mask = 0;
-u8 g_bios[BIOS_SIZE]{}; // 512K BIOS ROM
+
+// g_bios points at either the static storage, or a copy-on-write mapping of the BIOS file
+static u8 s_bios_storage[BIOS_SIZE]{};
+u8* g_bios = s_bios_storage; // 512K BIOS ROM
 
 // Exports for external debugger access
 namespace Exports {
@@ -117,10 +136,16 @@ static std::vector<Common::MemoryArena::View> m_fastmem_reserved_views;
 #endif
 
 static u8** m_fastmem_lut = nullptr;
+static bool m_fastmem_lut_huge_pages = false;
 static constexpr auto m_fastmem_ram_mirrors =
   make_array(0x00000000u, 0x00200000u, 0x00400000u, 0x00600000u, 0x80000000u, 0x80200000u, 0x80400000u, 0x80600000u,
              0xA0000000u, 0xA0200000u, 0xA0400000u, 0xA0600000u);
 
+// Page table for the non-fastmem path, indexed by physical page. Reads map RAM mirrors and the BIOS, writes only map RAM
+// pages which don't contain code. Null pages go through the region handlers.
+static constexpr u32 MEMORY_LUT_NUM_PAGES = (CPU::PHYSICAL_MEMORY_ADDRESS_MASK + 1) / HOST_PAGE_SIZE;
+static std::array<u8*, MEMORY_LUT_NUM_PAGES * 2> m_memory_lut = {};
+
 static std::tuple<TickCount, TickCount, TickCount> CalculateMemoryTiming(MEMDELAY mem_delay, COMDELAY common_delay);
 static void RecalculateMemoryTimings();
 
@@ -129,6 +154,18 @@ static void ReleaseMemory();
 
 static void SetCodePageFastmemProtection(u32 page_index, bool writable);
 
+static void FreeFastmemLUT();
+
+static void UpdateMemoryLUT();
+static bool MapBIOS(const std::vector<u8>& image, const char* path);
+static void UnmapBIOS();
+static void SetMemoryLUTRAMPageWritable(u32 page_index, bool writable);
+
+static ALWAYS_INLINE bool IsRAMPageWriteProtected(u32 index)
+{
+  return (m_ram_code_bits[index] || m_ram_watch_bits[index]);
+}
+
 #define FIXUP_HALFWORD_OFFSET(size, offset) ((size >= MemoryAccessSize::HalfWord) ? (offset) : ((offset) & ~1u))
 #define FIXUP_HALFWORD_READ_VALUE(size, offset, value)                                                                 \
   ((size >= MemoryAccessSize::HalfWord) ? (value) : ((value) >> (((offset)&u32(1)) * 8u)))
@@ -155,8 +192,7 @@ bool Initialize()
 
 void Shutdown()
 {
-  std::free(m_fastmem_lut);
-  m_fastmem_lut = nullptr;
+  FreeFastmemLUT();
 
 #ifdef WITH_MMAP_FASTMEM
   m_fastmem_base = nullptr;
@@ -167,6 +203,8 @@ void Shutdown()
   m_fastmem_mode = CPUFastmemMode::Disabled;
 
   ReleaseMemory();
+  UnmapBIOS();
+  m_ram_watch_bits.reset();
 }
 
 void Reset()
@@ -183,10 +221,11 @@ void Reset()
   m_MEMCTRL.common_delay.bits = 0x00031125;
   m_ram_size_reg = UINT32_C(0x00000B88);
   m_ram_code_bits = {};
+  UpdateMemoryLUT();
   RecalculateMemoryTimings();
 }
 
-bool DoState(StateWrapper& sw)
+bool DoState(StateWrapper& sw, bool is_memory_state)
 {
   u32 ram_size = g_ram_size;
   sw.DoEx(&ram_size, 52, static_cast<u32>(RAM_2MB_SIZE));
@@ -207,7 +246,8 @@ bool DoState(StateWrapper& sw)
   sw.Do(&m_cdrom_access_time);
   sw.Do(&m_spu_access_time);
   sw.DoBytes(g_ram, g_ram_size);
-  sw.DoBytes(g_bios, BIOS_SIZE);
+  if (!is_memory_state)
+    sw.DoBytes(g_bios, BIOS_SIZE);
   sw.DoArray(m_MEMCTRL.regs, countof(m_MEMCTRL.regs));
   sw.Do(&m_ram_size_reg);
   sw.Do(&m_tty_line_buffer);
@@ -219,7 +259,7 @@ void SetExpansionROM(std::vector<u8> data)
   m_exp1_rom = std::move(data);
 }
 
-void SetBIOS(const std::vector<u8>& image)
+void SetBIOS(const std::vector<u8>& image, const char* path /* = nullptr */)
 {
   if (image.size() != static_cast<u32>(BIOS_SIZE))
   {
@@ -227,7 +267,46 @@ void SetBIOS(const std::vector<u8>& image)
     return;
   }
 
-  std::memcpy(g_bios, image.data(), BIOS_SIZE);
+  UnmapBIOS();
+  if (!path || !g_settings.map_resource_files || !MapBIOS(image, path))
+    std::memcpy(g_bios, image.data(), BIOS_SIZE);
+
+  UpdateMemoryLUT();
+}
+
+bool MapBIOS(const std::vector<u8>& image, const char* path)
+{
+  auto fp = FileSystem::OpenManagedCFile(path, "rb");
+  if (!fp)
+    return false;
+
+  u8* ptr = static_cast<u8*>(FileSystem::MapCFileCopyOnWrite(fp.get(), BIOS_SIZE));
+  if (!ptr)
+  {
+    Log_WarningPrintf("Failed to map BIOS image '%s', using a private copy", path);
+    return false;
+  }
+
+  // the file could have changed since it was loaded
+  if (std::memcmp(ptr, image.data(), BIOS_SIZE) != 0)
+  {
+    Log_WarningPrintf("BIOS image '%s' changed after loading, using a private copy", path);
+    FileSystem::UnmapCFile(ptr, BIOS_SIZE);
+    return false;
+  }
+
+  Log_DevPrintf("Mapped BIOS image '%s' at %p", path, ptr);
+  g_bios = ptr;
+  return true;
+}
+
+void UnmapBIOS()
+{
+  if (g_bios == s_bios_storage)
+    return;
+
+  FileSystem::UnmapCFile(g_bios, BIOS_SIZE);
+  g_bios = s_bios_storage;
 }
 
 std::tuple<TickCount, TickCount, TickCount> CalculateMemoryTiming(MEMDELAY mem_delay, COMDELAY common_delay)
@@ -297,7 +376,21 @@ bool AllocateMemory(bool enable_8mb_ram)
   // Create the base views.
   const u32 ram_size = enable_8mb_ram ? RAM_8MB_SIZE : RAM_2MB_SIZE;
   const u32 ram_mask = enable_8mb_ram ? RAM_8MB_MASK : RAM_2MB_MASK;
-  g_ram = static_cast<u8*>(m_memory_arena.CreateViewPtr(MEMORY_ARENA_RAM_OFFSET, ram_size, true, false));
+  u8* ram_address = nullptr;
+  if (g_settings.use_huge_pages)
+  {
+    // huge pages can only back an aligned view
+    static constexpr size_t huge_page_size = Common::MemoryArena::HUGE_PAGE_SIZE;
+    u8* base = static_cast<u8*>(Common::MemoryArena::FindBaseAddressForMapping(ram_size + huge_page_size));
+    if (base)
+      ram_address = reinterpret_cast<u8*>(Common::AlignUpPow2(reinterpret_cast<uintptr_t>(base), huge_page_size));
+  }
+
+  g_ram = static_cast<u8*>(m_memory_arena.CreateViewPtr(MEMORY_ARENA_RAM_OFFSET, ram_size, true, false, ram_address));
+  if (!g_ram && ram_address)
+    g_ram = static_cast<u8*>(m_memory_arena.CreateViewPtr(MEMORY_ARENA_RAM_OFFSET, ram_size, true, false));
+  if (g_ram && g_ram == ram_address)
+    Common::MemoryArena::AdviseHugePages(g_ram, ram_size);
   if (!g_ram)
   {
     Log_ErrorPrintf("Failed to create base views of memory (%u bytes RAM)", ram_size);
@@ -312,10 +405,18 @@ bool AllocateMemory(bool enable_8mb_ram)
   Exports::RAM_SIZE = g_ram_size;
   Exports::RAM_MASK = g_ram_mask;
 
+  UpdateMemoryLUT();
+
   Log_InfoPrintf("RAM is %u bytes at %p", g_ram_size, g_ram);
   return true;
 }
 
+void FreeFastmemLUT()
+{
+  Common::MemoryArena::FreeMemory(m_fastmem_lut, FASTMEM_LUT_NUM_SLOTS * sizeof(u8*), m_fastmem_lut_huge_pages);
+  m_fastmem_lut = nullptr;
+}
+
 void ReleaseMemory()
 {
   if (g_ram)
@@ -330,9 +431,39 @@ void ReleaseMemory()
     Exports::RAM_MASK = 0;
   }
 
+  UpdateMemoryLUT();
   m_memory_arena.Destroy();
 }
 
+void UpdateMemoryLUT()
+{
+  m_memory_lut.fill(nullptr);
+  if (!g_ram)
+    return;
+
+  for (u32 address = 0; address < RAM_MIRROR_END; address += HOST_PAGE_SIZE)
+  {
+    const u32 ram_address = address & g_ram_mask;
+    u8* ptr = &g_ram[ram_address];
+    m_memory_lut[address / HOST_PAGE_SIZE] = ptr;
+    m_memory_lut[MEMORY_LUT_NUM_PAGES + (address / HOST_PAGE_SIZE)] =
+      IsRAMPageWriteProtected(ram_address / HOST_PAGE_SIZE) ? nullptr : ptr;
+  }
+
+  for (u32 offset = 0; offset < BIOS_SIZE; offset += HOST_PAGE_SIZE)
+    m_memory_lut[(BIOS_BASE + offset) / HOST_PAGE_SIZE] = &g_bios[offset];
+}
+
+void SetMemoryLUTRAMPageWritable(u32 page_index, bool writable)
+{
+  const u32 ram_address = page_index * HOST_PAGE_SIZE;
+  for (u32 mirror_start = 0; mirror_start < RAM_MIRROR_END; mirror_start += g_ram_size)
+  {
+    m_memory_lut[MEMORY_LUT_NUM_PAGES + ((mirror_start + ram_address) / HOST_PAGE_SIZE)] =
+      writable ? &g_ram[ram_address] : nullptr;
+  }
+}
+
 static ALWAYS_INLINE u32 FastmemAddressToLUTPageIndex(u32 address)
 {
   return address >> 12;
@@ -376,16 +507,14 @@ void UpdateFastmemViews(CPUFastmemMode mode)
 #ifdef WITH_MMAP_FASTMEM
     m_fastmem_base = nullptr;
 #endif
-    std::free(m_fastmem_lut);
-    m_fastmem_lut = nullptr;
+    FreeFastmemLUT();
     return;
   }
 
 #ifdef WITH_MMAP_FASTMEM
   if (mode == CPUFastmemMode::MMap)
   {
-    std::free(m_fastmem_lut);
-    m_fastmem_lut = nullptr;
+    FreeFastmemLUT();
 
     if (!m_fastmem_base)
     {
@@ -408,10 +537,10 @@ void UpdateFastmemViews(CPUFastmemMode mode)
         return;
       }
 
-      // mark all pages with code as non-writable
+      // mark all pages with code or watchpoints as non-writable
       for (u32 i = 0; i < m_ram_code_page_count; i++)
       {
-        if (m_ram_code_bits[i])
+        if (IsRAMPageWriteProtected(i))
         {
           u8* page_address = map_address + (i * HOST_PAGE_SIZE);
           if (!m_memory_arena.SetPageProtection(page_address, HOST_PAGE_SIZE, true, false, false))
@@ -464,7 +593,10 @@ void UpdateFastmemViews(CPUFastmemMode mode)
 
   if (!m_fastmem_lut)
   {
-    m_fastmem_lut = static_cast<u8**>(std::calloc(FASTMEM_LUT_NUM_SLOTS, sizeof(u8*)));
+    // the table is 16MB and accessed randomly, so it benefits from huge pages more than most
+    m_fastmem_lut_huge_pages = g_settings.use_huge_pages;
+    m_fastmem_lut = static_cast<u8**>(Common::MemoryArena::AllocateMemory(FASTMEM_LUT_NUM_SLOTS * sizeof(u8*),
+                                                                         m_fastmem_lut_huge_pages));
     Assert(m_fastmem_lut);
 
     Log_InfoPrintf("Fastmem base (software): %p", m_fastmem_lut);
@@ -474,7 +606,7 @@ void UpdateFastmemViews(CPUFastmemMode mode)
     for (u32 address = 0; address < g_ram_size; address += HOST_PAGE_SIZE)
     {
       SetLUTFastmemPage(base_address + address, &g_ram[address],
-                        !m_ram_code_bits[FastmemAddressToLUTPageIndex(address)]);
+                        !IsRAMPageWriteProtected(FastmemAddressToLUTPageIndex(address)));
     }
   };
 
@@ -526,6 +658,11 @@ bool IsRAMCodePage(u32 index)
   return m_ram_code_bits[index];
 }
 
+bool IsRAMWatchPage(u32 index)
+{
+  return m_ram_watch_bits[index];
+}
+
 void SetRAMCodePage(u32 index)
 {
   if (m_ram_code_bits[index])
@@ -534,6 +671,7 @@ void SetRAMCodePage(u32 index)
   // protect fastmem pages
   m_ram_code_bits[index] = true;
   SetCodePageFastmemProtection(index, false);
+  SetMemoryLUTRAMPageWritable(index, false);
 }
 
 void ClearRAMCodePage(u32 index)
@@ -541,9 +679,42 @@ void ClearRAMCodePage(u32 index)
   if (!m_ram_code_bits[index])
     return;
 
-  // unprotect fastmem pages
+  // unprotect fastmem pages, unless a watchpoint still needs them
   m_ram_code_bits[index] = false;
+  if (m_ram_watch_bits[index])
+    return;
+
   SetCodePageFastmemProtection(index, true);
+  SetMemoryLUTRAMPageWritable(index, true);
+}
+
+void SetRAMWatchPage(u32 index)
+{
+  if (m_ram_watch_bits[index])
+    return;
+
+  m_ram_watch_bits[index] = true;
+  if (!g_ram || m_ram_code_bits[index])
+    return;
+
+  SetCodePageFastmemProtection(index, false);
+  SetMemoryLUTRAMPageWritable(index, false);
+}
+
+void ClearRAMWatchPages()
+{
+  for (u32 i = 0; i < m_ram_code_page_count; i++)
+  {
+    if (!m_ram_watch_bits[i])
+      continue;
+
+    m_ram_watch_bits[i] = false;
+    if (!g_ram || m_ram_code_bits[i])
+      continue;
+
+    SetCodePageFastmemProtection(i, true);
+    SetMemoryLUTRAMPageWritable(i, true);
+  }
 }
 
 void SetCodePageFastmemProtection(u32 page_index, bool writable)
@@ -578,6 +749,7 @@ void SetCodePageFastmemProtection(u32 page_index, bool writable)
 void ClearRAMCodePageFlags()
 {
   m_ram_code_bits.reset();
+  UpdateMemoryLUT();
 
 #ifdef WITH_MMAP_FASTMEM
   if (m_fastmem_mode == CPUFastmemMode::MMap)
@@ -602,6 +774,12 @@ void ClearRAMCodePageFlags()
         SetLUTFastmemPage(mirror_start + addr, &g_ram[addr], true);
     }
   }
+
+  for (u32 i = 0; i < m_ram_code_page_count; i++)
+  {
+    if (m_ram_watch_bits[i])
+      SetCodePageFastmemProtection(i, false);
+  }
 }
 
 bool IsCodePageAddress(PhysicalMemoryAddress address)
@@ -703,7 +881,26 @@ static ALWAYS_INLINE_RELEASE bool MaskedMemoryCompare(const u8* pattern, const u
   if (!mask)
     return std::memcmp(mem, pattern, pattern_length) == 0;
 
-  for (u32 i = 0; i < pattern_length; i++)
+  u32 i = 0;
+#if defined(CPU_X64)
+  for (; (i + 16) <= pattern_length; i += 16)
+  {
+    const __m128i diff = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mem + i)),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern + i)));
+    const __m128i masked = _mm_and_si128(diff, _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i)));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(masked, _mm_setzero_si128())) != 0xFFFF)
+      return false;
+  }
+#elif defined(CPU_AARCH64)
+  for (; (i + 16) <= pattern_length; i += 16)
+  {
+    const uint8x16_t diff = veorq_u8(vld1q_u8(mem + i), vld1q_u8(pattern + i));
+    if (vmaxvq_u8(vandq_u8(diff, vld1q_u8(mask + i))) != 0)
+      return false;
+  }
+#endif
+
+  for (; i < pattern_length; i++)
   {
     if ((mem[i] & mask[i]) != (pattern[i] & mask[i]))
       return false;
@@ -712,6 +909,45 @@ static ALWAYS_INLINE_RELEASE bool MaskedMemoryCompare(const u8* pattern, const u
   return true;
 }
 
+/// Returns the index of the first byte which matches value under mask, or count if there isn't one.
+static u32 FindMaskedByte(const u8* mem, u32 count, u8 value, u8 mask)
+{
+  if (mask == 0xFF)
+  {
+    const void* found = std::memchr(mem, value, count);
+    return found ? static_cast<u32>(static_cast<const u8*>(found) - mem) : count;
+  }
+
+  u32 i = 0;
+#if defined(CPU_X64)
+  const __m128i vvalue = _mm_set1_epi8(static_cast<char>(value));
+  const __m128i vmask = _mm_set1_epi8(static_cast<char>(mask));
+  for (; (i + 16) <= count; i += 16)
+  {
+    const __m128i masked = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mem + i)), vmask);
+    const u32 matches = static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(masked, vvalue)));
+    if (matches != 0)
+      return i + CountTrailingZeros(matches);
+  }
+#elif defined(CPU_AARCH64)
+  const uint8x16_t vvalue = vdupq_n_u8(value);
+  const uint8x16_t vmask = vdupq_n_u8(mask);
+  for (; (i + 16) <= count; i += 16)
+  {
+    if (vmaxvq_u8(vceqq_u8(vandq_u8(vld1q_u8(mem + i), vmask), vvalue)) != 0)
+      break;
+  }
+#endif
+
+  for (; i < count; i++)
+  {
+    if ((mem[i] & mask) == value)
+      return i;
+  }
+
+  return count;
+}
+
 std::optional<PhysicalMemoryAddress> SearchMemory(PhysicalMemoryAddress start_address, const u8* pattern,
                                                   const u8* mask, u32 pattern_length)
 {
@@ -719,6 +955,17 @@ std::optional<PhysicalMemoryAddress> SearchMemory(PhysicalMemoryAddress start_ad
   if (!region.has_value())
     return std::nullopt;
 
+  // candidates are found by looking for the first byte of the pattern which isn't masked out
+  u32 anchor = 0;
+  if (mask)
+  {
+    while (anchor < pattern_length && mask[anchor] == 0)
+      anchor++;
+  }
+  const bool has_anchor = (anchor < pattern_length);
+  const u8 anchor_mask = (has_anchor && mask) ? mask[anchor] : 0xFF;
+  const u8 anchor_value = has_anchor ? (pattern[anchor] & anchor_mask) : 0;
+
   PhysicalMemoryAddress current_address = start_address;
   MemoryRegion current_region = region.value();
   while (current_region != MemoryRegion::Count)
@@ -733,6 +980,17 @@ std::optional<PhysicalMemoryAddress> SearchMemory(PhysicalMemoryAddress start_ad
       PhysicalMemoryAddress bytes_remaining = region_end - current_address;
       while (bytes_remaining >= pattern_length)
       {
+        if (has_anchor)
+        {
+          const u32 candidates = bytes_remaining - pattern_length + 1;
+          const u32 skip = FindMaskedByte(mem + region_offset + anchor, candidates, anchor_value, anchor_mask);
+          if (skip == candidates)
+            break;
+
+          region_offset += skip;
+          bytes_remaining -= skip;
+        }
+
         if (MaskedMemoryCompare(pattern, mask, pattern_length, mem + region_offset))
           return region_start + region_offset;
 
@@ -806,6 +1064,9 @@ ALWAYS_INLINE static TickCount DoRAMAccess(u32 offset, u32& value)
   else
   {
     const u32 page_index = offset / HOST_PAGE_SIZE;
+    if (m_ram_watch_bits[page_index])
+      CPU::CheckWatchpoints(offset, 1u << static_cast<u32>(size), value);
+
     if constexpr (skip_redundant_writes)
     {
       if constexpr (size == MemoryAccessSize::Byte)
@@ -814,7 +1075,7 @@ ALWAYS_INLINE static TickCount DoRAMAccess(u32 offset, u32& value)
         {
           g_ram[offset] = Truncate8(value);
           if (m_ram_code_bits[page_index])
-            CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+            CPU::CodeCache::InvalidateBlocksWithRAMAddress(offset);
         }
       }
       else if constexpr (size == MemoryAccessSize::HalfWord)
@@ -826,7 +1087,7 @@ ALWAYS_INLINE static TickCount DoRAMAccess(u32 offset, u32& value)
         {
           std::memcpy(&g_ram[offset], &new_value, sizeof(u16));
           if (m_ram_code_bits[page_index])
-            CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+            CPU::CodeCache::InvalidateBlocksWithRAMAddress(offset);
         }
       }
       else if constexpr (size == MemoryAccessSize::Word)
@@ -837,14 +1098,14 @@ ALWAYS_INLINE static TickCount DoRAMAccess(u32 offset, u32& value)
         {
           std::memcpy(&g_ram[offset], &value, sizeof(u32));
           if (m_ram_code_bits[page_index])
-            CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+            CPU::CodeCache::InvalidateBlocksWithRAMAddress(offset);
         }
       }
     }
     else
     {
       if (m_ram_code_bits[page_index])
-        CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+        CPU::CodeCache::InvalidateBlocksWithRAMAddress(offset);
 
       if constexpr (size == MemoryAccessSize::Byte)
       {
@@ -1419,8 +1680,9 @@ TickCount GetICacheFillTicks(VirtualMemoryAddress address)
 
 void CheckAndUpdateICacheTags(u32 line_count, TickCount uncached_ticks)
 {
+  // Blocks in uncached regions don't have any lines to check, see CompileBlock().
   VirtualMemoryAddress current_pc = g_state.regs.pc & ICACHE_TAG_ADDRESS_MASK;
-  if (IsCachedAddress(current_pc))
+  if (line_count > 0)
   {
     TickCount ticks = 0;
     TickCount cached_ticks_per_line = GetICacheFillTicks(current_pc);
@@ -1541,6 +1803,39 @@ ALWAYS_INLINE static TickCount DoScratchpadAccess(PhysicalMemoryAddress address,
   return 0;
 }
 
+template<MemoryAccessType type, MemoryAccessSize size>
+ALWAYS_INLINE static void DoDirectMemoryAccess(u8* ptr, u32& value)
+{
+  if constexpr (size == MemoryAccessSize::Byte)
+  {
+    if constexpr (type == MemoryAccessType::Read)
+      value = ZeroExtend32(*ptr);
+    else
+      *ptr = Truncate8(value);
+  }
+  else if constexpr (size == MemoryAccessSize::HalfWord)
+  {
+    if constexpr (type == MemoryAccessType::Read)
+    {
+      u16 temp;
+      std::memcpy(&temp, ptr, sizeof(temp));
+      value = ZeroExtend32(temp);
+    }
+    else
+    {
+      const u16 temp = Truncate16(value);
+      std::memcpy(ptr, &temp, sizeof(temp));
+    }
+  }
+  else if constexpr (size == MemoryAccessSize::Word)
+  {
+    if constexpr (type == MemoryAccessType::Read)
+      std::memcpy(&value, ptr, sizeof(value));
+    else
+      std::memcpy(ptr, &value, sizeof(value));
+  }
+}
+
 template<MemoryAccessType type, MemoryAccessSize size>
 static ALWAYS_INLINE TickCount DoMemoryAccess(VirtualMemoryAddress address, u32& value)
 {
@@ -1605,6 +1900,17 @@ static ALWAYS_INLINE TickCount DoMemoryAccess(VirtualMemoryAddress address, u32&
     }
   }
 
+  // RAM and BIOS pages don't need a handler, skip the region checks.
+  constexpr u32 lut_offset = (type == MemoryAccessType::Write) ? MEMORY_LUT_NUM_PAGES : 0;
+  if (u8* const page = m_memory_lut[lut_offset + (address / HOST_PAGE_SIZE)]; page)
+  {
+    DoDirectMemoryAccess<type, size>(page + (address % HOST_PAGE_SIZE), value);
+    if constexpr (type == MemoryAccessType::Read)
+      return (address < RAM_MIRROR_END) ? RAM_READ_TICKS : m_bios_access_time[static_cast<u32>(size)];
+    else
+      return 0;
+  }
+
   if (address < RAM_MIRROR_END)
   {
     return DoRAMAccess<type, size, false>(address, value);
@@ -2020,6 +2326,39 @@ bool SafeReadMemoryWord(VirtualMemoryAddress addr, u32* value)
   return true;
 }
 
+bool SafeReadMemoryBytes(VirtualMemoryAddress addr, void* data, u32 length)
+{
+  using namespace Bus;
+
+  // copy straight out of RAM or the scratchpad when the whole range is in one of them
+  const u32 seg = (addr >> 29);
+  if (seg == 0 || seg == 4 || seg == 5)
+  {
+    const PhysicalMemoryAddress paddr = addr & PHYSICAL_MEMORY_ADDRESS_MASK;
+    if (paddr < RAM_MIRROR_END && ((paddr & g_ram_mask) + length) <= g_ram_size)
+    {
+      std::memcpy(data, &g_ram[paddr & g_ram_mask], length);
+      return true;
+    }
+
+    if (seg != 5 && (paddr & DCACHE_LOCATION_MASK) == DCACHE_LOCATION &&
+        ((paddr & DCACHE_OFFSET_MASK) + length) <= DCACHE_SIZE)
+    {
+      std::memcpy(data, &g_state.dcache[paddr & DCACHE_OFFSET_MASK], length);
+      return true;
+    }
+  }
+
+  u8* data_ptr = static_cast<u8*>(data);
+  for (u32 i = 0; i < length; i++)
+  {
+    if (!SafeReadMemoryByte(addr + i, &data_ptr[i]))
+      return false;
+  }
+
+  return true;
+}
+
 bool SafeWriteMemoryByte(VirtualMemoryAddress addr, u8 value)
 {
   u32 temp = ZeroExtend32(value);
@@ -2195,21 +2534,21 @@ u32 WriteMemoryWord(u32 address, u32 value)
 
 u32 UncheckedReadMemoryByte(u32 address)
 {
-  u32 temp;
+  u32 temp = 0;
   g_state.pending_ticks += DoMemoryAccess<MemoryAccessType::Read, MemoryAccessSize::Byte>(address, temp);
   return temp;
 }
 
 u32 UncheckedReadMemoryHalfWord(u32 address)
 {
-  u32 temp;
+  u32 temp = 0;
   g_state.pending_ticks += DoMemoryAccess<MemoryAccessType::Read, MemoryAccessSize::HalfWord>(address, temp);
   return temp;
 }
 
 u32 UncheckedReadMemoryWord(u32 address)
 {
-  u32 temp;
+  u32 temp = 0;
   g_state.pending_ticks += DoMemoryAccess<MemoryAccessType::Read, MemoryAccessSize::Word>(address, temp);
   return temp;
 }
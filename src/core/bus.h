@@ -103,7 +103,8 @@ enum : u32
 bool Initialize();
 void Shutdown();
 void Reset();
-bool DoState(StateWrapper& sw);
+/// Memory states (rewind/runahead) skip the BIOS, since it can't change without the memory states being discarded.
+bool DoState(StateWrapper& sw, bool is_memory_state);
 
 CPUFastmemMode GetFastmemMode();
 u8* GetFastmemBase();
@@ -111,13 +112,16 @@ void UpdateFastmemViews(CPUFastmemMode mode);
 bool CanUseFastmemForAddress(VirtualMemoryAddress address);
 
 void SetExpansionROM(std::vector<u8> data);
-void SetBIOS(const std::vector<u8>& image);
+
+/// Sets the BIOS image. If path is set and resource mapping is enabled, the BIOS is mapped copy-on-write from that
+/// file instead, so every instance using the same file shares its pages. Patched pages become private.
+void SetBIOS(const std::vector<u8>& image, const char* path = nullptr);
 
 extern std::bitset<RAM_8MB_CODE_PAGE_COUNT> m_ram_code_bits;
-extern u8* g_ram;            // 2MB-8MB RAM
-extern u32 g_ram_size;       // Active size of RAM.
-extern u32 g_ram_mask;       // Active address bits for RAM.
-extern u8 g_bios[BIOS_SIZE]; // 512K BIOS ROM
+extern u8* g_ram;      // 2MB-8MB RAM
+extern u32 g_ram_size; // Active size of RAM.
+extern u32 g_ram_mask; // Active address bits for RAM.
+extern u8* g_bios;     // 512K BIOS ROM
 
 /// Returns true if the address specified is writable (RAM).
 ALWAYS_INLINE static bool IsRAMAddress(PhysicalMemoryAddress address)
@@ -143,6 +147,15 @@ void ClearRAMCodePage(u32 index);
 /// Clears all code bits for RAM regions.
 void ClearRAMCodePageFlags();
 
+/// Flags a RAM page as watched, so every write to it goes through the slow path and is checked against watchpoints.
+void SetRAMWatchPage(u32 index);
+
+/// Clears the watch flag for all RAM pages.
+void ClearRAMWatchPages();
+
+/// Returns true if the specified page has a watchpoint.
+bool IsRAMWatchPage(u32 index);
+
 /// Returns true if the specified address is in a code page.
 bool IsCodePageAddress(PhysicalMemoryAddress address);
 
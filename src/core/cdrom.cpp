@@ -18,6 +18,12 @@ Log_SetChannel(CDROM);
 
 #if defined(CPU_X64)
 #include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
 #endif
 
 static constexpr std::array<const char*, 15> s_drive_state_names = {
@@ -1138,6 +1144,11 @@ void CDROM::ExecuteCommand(TickCount ticks_late)
         m_setloc_position.second = PackedBCDToBinary(ss);
         m_setloc_position.frame = PackedBCDToBinary(ff);
         m_setloc_pending = true;
+
+        // Start the host read now, so it overlaps with the time until the game issues the read/seek command. Only
+        // while idle, a read in progress still needs the current readahead.
+        if (m_drive_state == DriveState::Idle && CanReadMedia())
+          m_reader.PrefetchSector(m_setloc_position.ToLBA());
       }
 
       EndCommand();
@@ -2428,7 +2439,7 @@ void CDROM::ProcessDataSector(const u8* raw_sector, const CDImage::SubChannelQ&
   SetAsyncInterrupt(Interrupt::DataReady);
 }
 
-static std::array<std::array<s16, 29>, 7> s_zigzag_table = {
+static constexpr std::array<std::array<s16, 29>, 7> s_zigzag_table = {
   {{0,      0x0,     0x0,     0x0,    0x0,     -0x0002, 0x000A,  -0x0022, 0x0041, -0x0054,
     0x0034, 0x0009,  -0x010A, 0x0400, -0x0A78, 0x234C,  0x6794,  -0x1780, 0x0BCD, -0x0623,
     0x0350, -0x016D, 0x006B,  0x000A, -0x0010, 0x0011,  -0x0008, 0x0003,  -0x0001},
@@ -2451,13 +2462,68 @@ static std::array<std::array<s16, 29>, 7> s_zigzag_table = {
     0x3C07,  0x53E0,  -0x16FA, 0x0AFA, -0x0548, 0x027B,  -0x00EB, 0x001A,  0x002B, -0x0023,
     0x0010,  -0x0008, 0x0002,  0x0,    0x0,     0x0,     0x0,     0x0,     0x0}}};
 
-static s16 ZigZagInterpolate(const s16* ringbuf, const s16* table, u8 p)
+// Taps in oldest-to-newest order, padded to a multiple of the vector width, so they line up with a window of samples
+// which can be loaded straight from the mirrored ring buffer.
+static constexpr u32 ZIGZAG_WINDOW_SIZE = 32;
+static constexpr std::array<std::array<s16, ZIGZAG_WINDOW_SIZE>, 7> MakeZigZagWindowTable()
 {
-  s32 sum = 0;
-  for (u8 i = 0; i < 29; i++)
-    sum += (s32(ringbuf[(p - i) & 0x1F]) * s32(table[i])) / 0x8000;
+  std::array<std::array<s16, ZIGZAG_WINDOW_SIZE>, 7> ret = {};
+  for (u32 i = 0; i < 7; i++)
+  {
+    for (u32 j = 0; j < 29; j++)
+      ret[i][28 - j] = s_zigzag_table[i][j];
+  }
+  return ret;
+}
+alignas(16) static constexpr std::array<std::array<s16, ZIGZAG_WINDOW_SIZE>, 7> s_zigzag_window_table =
+  MakeZigZagWindowTable();
 
-  return static_cast<s16>(std::clamp<s32>(sum, -0x8000, 0x7FFF));
+/// Each product is truncated individually before summing, so this matches a scalar loop exactly.
+static s16 ZigZagInterpolate(const s16* window, const s16* table)
+{
+#if defined(CPU_X64)
+  __m128i sum = _mm_setzero_si128();
+  for (u32 i = 0; i < ZIGZAG_WINDOW_SIZE; i += 8)
+  {
+    const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&window[i]));
+    const __m128i taps = _mm_load_si128(reinterpret_cast<const __m128i*>(&table[i]));
+    const __m128i lo = _mm_mullo_epi16(samples, taps);
+    const __m128i hi = _mm_mulhi_epi16(samples, taps);
+    __m128i prod0 = _mm_unpacklo_epi16(lo, hi);
+    __m128i prod1 = _mm_unpackhi_epi16(lo, hi);
+
+    // divide by 0x8000 rounding towards zero, i.e. bias negative products by 0x7FFF before shifting
+    prod0 = _mm_srai_epi32(_mm_add_epi32(prod0, _mm_srli_epi32(_mm_srai_epi32(prod0, 31), 17)), 15);
+    prod1 = _mm_srai_epi32(_mm_add_epi32(prod1, _mm_srli_epi32(_mm_srai_epi32(prod1, 31), 17)), 15);
+    sum = _mm_add_epi32(sum, _mm_add_epi32(prod0, prod1));
+  }
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  const s32 result = _mm_cvtsi128_si32(sum);
+#elif defined(CPU_AARCH64)
+  int32x4_t sum = vdupq_n_s32(0);
+  for (u32 i = 0; i < ZIGZAG_WINDOW_SIZE; i += 8)
+  {
+    const int16x8_t samples = vld1q_s16(&window[i]);
+    const int16x8_t taps = vld1q_s16(&table[i]);
+    int32x4_t prod0 = vmull_s16(vget_low_s16(samples), vget_low_s16(taps));
+    int32x4_t prod1 = vmull_s16(vget_high_s16(samples), vget_high_s16(taps));
+
+    // divide by 0x8000 rounding towards zero, i.e. bias negative products by 0x7FFF before shifting
+    prod0 = vshrq_n_s32(
+      vaddq_s32(prod0, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(prod0, 31)), 17))), 15);
+    prod1 = vshrq_n_s32(
+      vaddq_s32(prod1, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(prod1, 31)), 17))), 15);
+    sum = vaddq_s32(sum, vaddq_s32(prod0, prod1));
+  }
+  const s32 result = vaddvq_s32(sum);
+#else
+  s32 result = 0;
+  for (u32 i = 0; i < 29; i++)
+    result += (s32(window[i]) * s32(table[i])) / 0x8000;
+#endif
+
+  return static_cast<s16>(std::clamp<s32>(result, -0x8000, 0x7FFF));
 }
 
 template<bool STEREO, bool SAMPLE_RATE>
@@ -2472,8 +2538,21 @@ void CDROM::ResampleXAADPCM(const s16* frames_in, u32 num_frames_in)
     return;
   }
 
-  s16* left_ringbuf = m_xa_resample_ring_buffer[0].data();
-  s16* right_ringbuf = m_xa_resample_ring_buffer[1].data();
+  // Work on a mirrored copy of the ring buffer, so the 29 samples before the read position are always contiguous.
+  static constexpr u32 RING_MASK = XA_RESAMPLE_RING_BUFFER_SIZE - 1;
+  static constexpr u32 WINDOW_OFFSET = XA_RESAMPLE_RING_BUFFER_SIZE - 28;
+  alignas(16) std::array<s16, XA_RESAMPLE_RING_BUFFER_SIZE * 2> left_ringbuf;
+  alignas(16) std::array<s16, XA_RESAMPLE_RING_BUFFER_SIZE * 2> right_ringbuf;
+  std::copy(m_xa_resample_ring_buffer[0].begin(), m_xa_resample_ring_buffer[0].end(), left_ringbuf.begin());
+  std::copy(m_xa_resample_ring_buffer[0].begin(), m_xa_resample_ring_buffer[0].end(),
+            left_ringbuf.begin() + XA_RESAMPLE_RING_BUFFER_SIZE);
+  if constexpr (STEREO)
+  {
+    std::copy(m_xa_resample_ring_buffer[1].begin(), m_xa_resample_ring_buffer[1].end(), right_ringbuf.begin());
+    std::copy(m_xa_resample_ring_buffer[1].begin(), m_xa_resample_ring_buffer[1].end(),
+              right_ringbuf.begin() + XA_RESAMPLE_RING_BUFFER_SIZE);
+  }
+
   u8 p = m_xa_resample_p;
   u8 sixstep = m_xa_resample_sixstep;
   for (u32 in_sample_index = 0; in_sample_index < num_frames_in; in_sample_index++)
@@ -2489,24 +2568,38 @@ void CDROM::ResampleXAADPCM(const s16* frames_in, u32 num_frames_in)
     for (u32 sample_dup = 0; sample_dup < (SAMPLE_RATE ? 2 : 1); sample_dup++)
     {
       left_ringbuf[p] = left;
+      left_ringbuf[p + XA_RESAMPLE_RING_BUFFER_SIZE] = left;
       if constexpr (STEREO)
+      {
         right_ringbuf[p] = right;
+        right_ringbuf[p + XA_RESAMPLE_RING_BUFFER_SIZE] = right;
+      }
       p = (p + 1) % 32;
       sixstep--;
 
       if (sixstep == 0)
       {
         sixstep = 6;
+        const u32 window_start = (p + WINDOW_OFFSET) & RING_MASK;
         for (u32 j = 0; j < 7; j++)
         {
-          const s16 left_interp = ZigZagInterpolate(left_ringbuf, s_zigzag_table[j].data(), p);
-          const s16 right_interp = STEREO ? ZigZagInterpolate(right_ringbuf, s_zigzag_table[j].data(), p) : left_interp;
+          const s16 left_interp = ZigZagInterpolate(&left_ringbuf[window_start], s_zigzag_window_table[j].data());
+          const s16 right_interp =
+            STEREO ? ZigZagInterpolate(&right_ringbuf[window_start], s_zigzag_window_table[j].data()) : left_interp;
           AddCDAudioFrame(left_interp, right_interp);
         }
       }
     }
   }
 
+  std::copy(left_ringbuf.begin(), left_ringbuf.begin() + XA_RESAMPLE_RING_BUFFER_SIZE,
+            m_xa_resample_ring_buffer[0].begin());
+  if constexpr (STEREO)
+  {
+    std::copy(right_ringbuf.begin(), right_ringbuf.begin() + XA_RESAMPLE_RING_BUFFER_SIZE,
+              m_xa_resample_ring_buffer[1].begin());
+  }
+
   m_xa_resample_p = p;
   m_xa_resample_sixstep = sixstep;
 }
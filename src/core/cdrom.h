@@ -50,6 +50,7 @@ public:
   void DrawDebugWindow();
 
   void SetReadaheadSectors(u32 readahead_sectors);
+  CDROMAsyncReader::ReadaheadStats GetReadaheadStats() const { return m_reader.GetReadaheadStats(); }
 
   /// Reads a frame from the audio FIFO, used by the SPU.
   ALWAYS_INLINE std::tuple<s16, s16> GetAudioFrame()
@@ -1,9 +1,15 @@
 #include "cdrom_async_reader.h"
 #include "common/assert.h"
 #include "common/log.h"
+#include "common/profiler.h"
 #include "common/timer.h"
+#include "host_time_accounting.h"
+#include <algorithm>
 Log_SetChannel(CDROMAsyncReader);
 
+static constexpr u32 MAX_READAHEAD_SCALE = 8;
+static constexpr u32 MAX_READAHEAD_COUNT = 256;
+
 CDROMAsyncReader::CDROMAsyncReader() = default;
 
 CDROMAsyncReader::~CDROMAsyncReader()
@@ -16,13 +22,21 @@ void CDROMAsyncReader::StartThread(u32 readahead_count)
   if (IsUsingThread())
     StopThread();
 
+  m_min_readahead_count = readahead_count;
+  m_max_readahead_count = std::max(readahead_count, std::min(readahead_count * MAX_READAHEAD_SCALE, MAX_READAHEAD_COUNT));
+  m_readahead_depth.store(readahead_count);
+  m_sequential_hits = 0;
+  m_readahead_hits.store(0);
+  m_readahead_misses.store(0);
+
   m_buffers.clear();
-  m_buffers.resize(readahead_count);
+  m_buffers.resize(m_max_readahead_count);
   EmptyBuffers();
 
   m_shutdown_flag.store(false);
   m_read_thread = std::thread(&CDROMAsyncReader::WorkerThreadEntryPoint, this);
-  Log_InfoPrintf("Read thread started with readahead of %u sectors", readahead_count);
+  Log_InfoPrintf("Read thread started with readahead of %u-%u sectors", m_min_readahead_count,
+                 m_max_readahead_count);
 }
 
 void CDROMAsyncReader::StopThread()
@@ -39,6 +53,43 @@ void CDROMAsyncReader::StopThread()
   m_read_thread.join();
   EmptyBuffers();
   m_buffers.clear();
+  m_min_readahead_count = 0;
+  m_max_readahead_count = 0;
+  m_readahead_depth.store(0);
+}
+
+CDROMAsyncReader::ReadaheadStats CDROMAsyncReader::GetReadaheadStats() const
+{
+  return ReadaheadStats{m_readahead_hits.load(std::memory_order_relaxed),
+                        m_readahead_misses.load(std::memory_order_relaxed),
+                        m_readahead_depth.load(std::memory_order_relaxed)};
+}
+
+void CDROMAsyncReader::GrowReadahead()
+{
+  m_readahead_hits.fetch_add(1, std::memory_order_relaxed);
+
+  // only called from the CPU thread, so the plain counter is fine
+  const u32 depth = m_readahead_depth.load();
+  if (++m_sequential_hits < depth || depth == m_max_readahead_count)
+    return;
+
+  m_sequential_hits = 0;
+  m_readahead_depth.store(std::min(depth * 2, m_max_readahead_count));
+  Log_DevPrintf("Readahead depth increased to %u sectors", m_readahead_depth.load());
+}
+
+void CDROMAsyncReader::ShrinkReadahead()
+{
+  m_readahead_misses.fetch_add(1, std::memory_order_relaxed);
+  m_sequential_hits = 0;
+
+  const u32 depth = m_readahead_depth.load();
+  if (depth > m_min_readahead_count)
+  {
+    m_readahead_depth.store(std::max(depth / 2, m_min_readahead_count));
+    Log_DevPrintf("Readahead depth decreased to %u sectors", m_readahead_depth.load());
+  }
 }
 
 void CDROMAsyncReader::SetMedia(std::unique_ptr<CDImage> media)
@@ -116,28 +167,48 @@ void CDROMAsyncReader::QueueReadSector(CDImage::LBA lba)
       return;
     }
 
-    // did we readahead to the correct sector?
-    const u32 next_buffer = (buffer_front + 1) % static_cast<u32>(m_buffers.size());
-    if (m_buffer_count > 1 && m_buffers[next_buffer].lba == lba)
+    // did we readahead to the correct sector? short forward seeks can skip over what's already buffered
+    const CDImage::LBA front_lba = m_buffers[buffer_front].lba;
+    const u32 skip = lba - front_lba;
+    if (lba > front_lba && skip < buffer_count)
     {
-      // great, don't need a seek, but still kick the thread to start reading ahead again
-      Log_DebugPrintf("Readahead buffer hit for sector %u", lba);
-      m_buffer_front.store(next_buffer);
-      m_buffer_count.fetch_sub(1);
-      m_can_readahead.store(true);
-      m_do_read_cv.notify_one();
-      return;
+      const u32 next_buffer = (buffer_front + skip) % static_cast<u32>(m_buffers.size());
+      if (m_buffers[next_buffer].lba == lba)
+      {
+        // great, don't need a seek, but still kick the thread to start reading ahead again
+        Log_DebugPrintf("Readahead buffer hit for sector %u (skipped %u)", lba, skip - 1);
+        m_buffer_front.store(next_buffer);
+        m_buffer_count.fetch_sub(skip);
+        if (skip == 1)
+          GrowReadahead();
+        else
+          m_readahead_hits.fetch_add(1, std::memory_order_relaxed);
+
+        m_can_readahead.store(true);
+        m_do_read_cv.notify_one();
+        return;
+      }
     }
   }
 
   // we need to toss away our readahead and start fresh
   Log_DebugPrintf("Readahead buffer miss, queueing seek to %u", lba);
+  ShrinkReadahead();
   std::unique_lock<std::mutex> lock(m_mutex);
   m_next_position_set.store(true);
   m_next_position = lba;
   m_do_read_cv.notify_one();
 }
 
+void CDROMAsyncReader::PrefetchSector(CDImage::LBA lba)
+{
+  if (!IsUsingThread())
+    return;
+
+  Log_DebugPrintf("Prefetching sector %u", lba);
+  QueueReadSector(lba);
+}
+
 bool CDROMAsyncReader::ReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data)
 {
   if (!IsUsingThread())
@@ -186,6 +257,7 @@ bool CDROMAsyncReader::WaitForReadToComplete()
     return m_buffers[m_buffer_front.load()].result;
   }
 
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::CDWait);
   Common::Timer wait_timer;
   Log_DebugPrintf("Sector read pending, waiting");
 
@@ -237,7 +309,10 @@ bool CDROMAsyncReader::ReadSectorIntoBuffer(std::unique_lock<std::mutex>& lock)
 
   Log_TracePrintf("Reading LBA %u...", buffer.lba);
 
-  buffer.result = m_media->ReadRawSector(buffer.data.data(), &buffer.subq);
+  {
+    PROFILE_SCOPE("CDROMAsyncReader::ReadSector");
+    buffer.result = m_media->ReadRawSector(buffer.data.data(), &buffer.subq);
+  }
   if (buffer.result)
   {
     const double read_time = timer.GetTimeMilliseconds();
@@ -276,7 +351,10 @@ void CDROMAsyncReader::ReadSectorNonThreaded(CDImage::LBA lba)
 
   Log_TracePrintf("Reading LBA %u...", buffer.lba);
 
-  buffer.result = m_media->ReadRawSector(buffer.data.data(), &buffer.subq);
+  {
+    PROFILE_SCOPE("CDROMAsyncReader::ReadSector");
+    buffer.result = m_media->ReadRawSector(buffer.data.data(), &buffer.subq);
+  }
   if (buffer.result)
   {
     const double read_time = timer.GetTimeMilliseconds();
@@ -356,9 +434,9 @@ void CDROMAsyncReader::WorkerThreadEntryPoint()
       if (!m_can_readahead.load())
         break;
 
-      // readahead time! read as many sectors as we have space for
-      Log_DebugPrintf("Reading ahead %u sectors...", static_cast<u32>(m_buffers.size()) - m_buffer_count.load());
-      while (m_buffer_count.load() < static_cast<u32>(m_buffers.size()))
+      // readahead time! read as many sectors as the current depth allows
+      Log_DebugPrintf("Reading ahead %u sectors...", m_readahead_depth.load() - m_buffer_count.load());
+      while (m_buffer_count.load() < m_readahead_depth.load())
       {
         if (m_next_position_set.load())
         {
@@ -21,6 +21,13 @@ public:
     bool result;
   };
 
+  struct ReadaheadStats
+  {
+    u32 hits;
+    u32 misses;
+    u32 depth;
+  };
+
   CDROMAsyncReader();
   ~CDROMAsyncReader();
 
@@ -29,7 +36,8 @@ public:
   const CDImage::SubChannelQ& GetSectorSubQ() const { return m_buffers[m_buffer_front.load()].subq; }
   u32 GetBufferedSectorCount() const { return m_buffer_count.load(); }
   bool HasBufferedSectors() const { return (m_buffer_count.load() > 0); }
-  u32 GetReadaheadCount() const { return static_cast<u32>(m_buffers.size()); }
+  u32 GetReadaheadCount() const { return m_min_readahead_count; }
+  ReadaheadStats GetReadaheadStats() const;
 
   bool HasMedia() const { return static_cast<bool>(m_media); }
   const CDImage* GetMedia() const { return m_media.get(); }
@@ -47,6 +55,10 @@ public:
 
   void QueueReadSector(CDImage::LBA lba);
 
+  /// Starts reading from a location that is likely to be requested soon, e.g. the target of a Setloc. Does nothing
+  /// without the read thread, since the sector would be read synchronously twice.
+  void PrefetchSector(CDImage::LBA lba);
+
   bool WaitForReadToComplete();
   void WaitForIdle();
 
@@ -59,6 +71,8 @@ private:
   void ReadSectorNonThreaded(CDImage::LBA lba);
   bool InternalReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data);
   void CancelReadahead();
+  void GrowReadahead();
+  void ShrinkReadahead();
 
   void WorkerThreadEntryPoint();
 
@@ -81,4 +95,13 @@ private:
   std::atomic<u32> m_buffer_front{0};
   std::atomic<u32> m_buffer_back{0};
   std::atomic<u32> m_buffer_count{0};
+
+  // The depth doubles each time a full window is consumed sequentially, so streaming builds up a cushion against slow
+  // storage, and halves on each seek so random access doesn't waste reads. m_buffers is sized for the maximum.
+  u32 m_min_readahead_count = 0;
+  u32 m_max_readahead_count = 0;
+  std::atomic<u32> m_readahead_depth{0};
+  u32 m_sequential_hits = 0;
+  std::atomic<u32> m_readahead_hits{0};
+  std::atomic<u32> m_readahead_misses{0};
 };
@@ -1,21 +1,40 @@
 #include "cheats.h"
 #include "bus.h"
+#include "common/align.h"
 #include "common/assert.h"
+#include "common/bitutils.h"
 #include "common/byte_stream.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/path.h"
 #include "common/string.h"
 #include "common/string_util.h"
+#include "common/timer.h"
 #include "controller.h"
 #include "cpu_code_cache.h"
 #include "cpu_core.h"
 #include "host.h"
+#include "settings.h"
 #include "system.h"
+#include <algorithm>
 #include <cctype>
 #include <iomanip>
+#include <limits>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <type_traits>
 Log_SetChannel(Cheats);
+
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
 static std::array<u32, 256> cht_register; // Used for D7 ,51 & 52 cheat types
 
 using KeyValuePairVector = std::vector<std::pair<std::string, std::string>>;
@@ -548,21 +567,359 @@ bool CheatList::ParseLibretroCheat(CheatCode* cc, const char* line)
   return !cc->instructions.empty();
 }
 
+template<typename T>
+ALWAYS_INLINE static T ReadProgramRAM(u32 offset)
+{
+  T value;
+  std::memcpy(&value, &Bus::g_ram[offset], sizeof(value));
+  return value;
+}
+
+template<typename T>
+ALWAYS_INLINE static void WriteProgramRAM(u32 offset, T value)
+{
+  // same as a bus write, unchanged values don't touch the code cache
+  if (ReadProgramRAM<T>(offset) == value)
+    return;
+
+  std::memcpy(&Bus::g_ram[offset], &value, sizeof(value));
+  if (Bus::m_ram_code_bits[offset / HOST_PAGE_SIZE])
+    CPU::CodeCache::InvalidateBlocksWithRAMAddress(offset);
+}
+
+template<typename T>
+ALWAYS_INLINE static void WriteProgramScratchpad(u32 offset, T value)
+{
+  std::memcpy(&CPU::g_state.dcache[offset], &value, sizeof(value));
+}
+
 void CheatList::Apply()
 {
   if (!m_master_enable)
     return;
 
-  for (const CheatCode& code : m_codes)
+  if (m_program_dirty || m_program_ram_mask != Bus::g_ram_mask)
+    CompileProgram();
+
+  const u32 count = static_cast<u32>(m_program.size());
+  for (u32 index = 0; index < count;)
   {
-    if (code.enabled)
-      code.Apply();
+    const ProgramOp& op = m_program[index];
+    switch (op.type)
+    {
+      case ProgramOpType::Interpret:
+        m_codes[op.offset].Apply();
+        break;
+
+      case ProgramOpType::Conditions:
+      {
+        bool result = true;
+        for (u32 i = 1; i <= op.count && result; i++)
+          result = EvaluateProgramCondition(m_program[index + i]);
+
+        // the guarded op always follows the comparisons
+        index += op.count + (result ? 0 : 1);
+      }
+      break;
+
+      case ProgramOpType::Nop:
+        break;
+
+      case ProgramOpType::Write8:
+        WriteProgramRAM<u8>(op.offset, Truncate8(op.value));
+        break;
+      case ProgramOpType::Write16:
+        WriteProgramRAM<u16>(op.offset, Truncate16(op.value));
+        break;
+      case ProgramOpType::Write32:
+        WriteProgramRAM<u32>(op.offset, op.value);
+        break;
+      case ProgramOpType::ScratchpadWrite16:
+        WriteProgramScratchpad<u16>(op.offset, Truncate16(op.value));
+        break;
+      case ProgramOpType::ScratchpadWrite32:
+        WriteProgramScratchpad<u32>(op.offset, op.value);
+        break;
+      case ProgramOpType::Add8:
+        WriteProgramRAM<u8>(op.offset, static_cast<u8>(ReadProgramRAM<u8>(op.offset) + op.value));
+        break;
+      case ProgramOpType::Add16:
+        WriteProgramRAM<u16>(op.offset, static_cast<u16>(ReadProgramRAM<u16>(op.offset) + op.value));
+        break;
+      case ProgramOpType::Add32:
+        WriteProgramRAM<u32>(op.offset, ReadProgramRAM<u32>(op.offset) + op.value);
+        break;
+      case ProgramOpType::Or8:
+        WriteProgramRAM<u8>(op.offset, static_cast<u8>(ReadProgramRAM<u8>(op.offset) | op.value));
+        break;
+      case ProgramOpType::Or16:
+        WriteProgramRAM<u16>(op.offset, static_cast<u16>(ReadProgramRAM<u16>(op.offset) | op.value));
+        break;
+      case ProgramOpType::Or32:
+        WriteProgramRAM<u32>(op.offset, ReadProgramRAM<u32>(op.offset) | op.value);
+        break;
+      case ProgramOpType::And8:
+        WriteProgramRAM<u8>(op.offset, static_cast<u8>(ReadProgramRAM<u8>(op.offset) & op.value));
+        break;
+      case ProgramOpType::And16:
+        WriteProgramRAM<u16>(op.offset, static_cast<u16>(ReadProgramRAM<u16>(op.offset) & op.value));
+        break;
+      case ProgramOpType::And32:
+        WriteProgramRAM<u32>(op.offset, ReadProgramRAM<u32>(op.offset) & op.value);
+        break;
+
+        DefaultCaseIsUnreachable();
+    }
+
+    index++;
+  }
+}
+
+bool CheatList::EvaluateProgramCondition(const ProgramOp& op) const
+{
+  switch (op.type)
+  {
+    case ProgramOpType::CompareEqual8:
+      return (ReadProgramRAM<u8>(op.offset) == op.value);
+    case ProgramOpType::CompareEqual16:
+      return (ReadProgramRAM<u16>(op.offset) == op.value);
+    case ProgramOpType::CompareEqual32:
+      return (ReadProgramRAM<u32>(op.offset) == op.value);
+    case ProgramOpType::CompareNotEqual8:
+      return (ReadProgramRAM<u8>(op.offset) != op.value);
+    case ProgramOpType::CompareNotEqual16:
+      return (ReadProgramRAM<u16>(op.offset) != op.value);
+    case ProgramOpType::CompareNotEqual32:
+      return (ReadProgramRAM<u32>(op.offset) != op.value);
+    case ProgramOpType::CompareLess8:
+      return (ReadProgramRAM<u8>(op.offset) < op.value);
+    case ProgramOpType::CompareLess16:
+      return (ReadProgramRAM<u16>(op.offset) < op.value);
+    case ProgramOpType::CompareLess32:
+      return (ReadProgramRAM<u32>(op.offset) < op.value);
+    case ProgramOpType::CompareGreater8:
+      return (ReadProgramRAM<u8>(op.offset) > op.value);
+    case ProgramOpType::CompareGreater16:
+      return (ReadProgramRAM<u16>(op.offset) > op.value);
+    case ProgramOpType::CompareGreater32:
+      return (ReadProgramRAM<u32>(op.offset) > op.value);
+
+    default:
+      UnreachableCode();
+      return false;
+  }
+}
+
+void CheatList::CompileProgram()
+{
+  m_program.clear();
+  m_program_ram_mask = Bus::g_ram_mask;
+  m_program_dirty = false;
+
+  u32 compiled_codes = 0;
+  u32 interpreted_codes = 0;
+  for (u32 i = 0; i < static_cast<u32>(m_codes.size()); i++)
+  {
+    const CheatCode& cc = m_codes[i];
+    if (!cc.enabled)
+      continue;
+
+    const size_t start = m_program.size();
+    if (CompileCode(cc, &m_program))
+    {
+      compiled_codes++;
+      continue;
+    }
+
+    m_program.resize(start);
+    m_program.push_back(ProgramOp{ProgramOpType::Interpret, 0, i, 0});
+    interpreted_codes++;
+  }
+
+  Log_DevPrintf("Compiled %u cheat codes to %zu ops, %u codes interpreted", compiled_codes, m_program.size(),
+                interpreted_codes);
+}
+
+bool CheatList::CompileCode(const CheatCode& cc, std::vector<ProgramOp>* ops)
+{
+  using InstructionCode = CheatCode::InstructionCode;
+
+  size_t conditions_start = 0;
+  u16 condition_count = 0;
+  for (const CheatCode::Instruction& inst : cc.instructions)
+  {
+    const u32 address = inst.address;
+    const u32 value8 = inst.value8;
+    const u32 value16 = inst.value16;
+    const u32 value32 = inst.value32;
+
+    ProgramOp op = {ProgramOpType::Nop, 0, 0, 0};
+    u32 access_size = 0;
+    const auto set_op = [&op, &access_size](ProgramOpType type, u32 size, u32 value) {
+      op = {type, 0, 0, value};
+      access_size = size;
+    };
+
+    switch (inst.code)
+    {
+      case InstructionCode::Nop:
+        break;
+
+      case InstructionCode::ConstantWrite8:
+        set_op(ProgramOpType::Write8, 1, value8);
+        break;
+      case InstructionCode::ConstantWrite16:
+        set_op(ProgramOpType::Write16, 2, value16);
+        break;
+      case InstructionCode::ExtConstantWrite32:
+        set_op(ProgramOpType::Write32, 4, value32);
+        break;
+
+      case InstructionCode::ExtConstantBitSet8:
+        set_op(ProgramOpType::Or8, 1, value8);
+        break;
+      case InstructionCode::ExtConstantBitSet16:
+        set_op(ProgramOpType::Or16, 2, value16);
+        break;
+      case InstructionCode::ExtConstantBitSet32:
+        set_op(ProgramOpType::Or32, 4, value32);
+        break;
+      case InstructionCode::ExtConstantBitClear8:
+        set_op(ProgramOpType::And8, 1, ~value8);
+        break;
+      case InstructionCode::ExtConstantBitClear16:
+        set_op(ProgramOpType::And16, 2, ~value16);
+        break;
+      case InstructionCode::ExtConstantBitClear32:
+        set_op(ProgramOpType::And32, 4, ~value32);
+        break;
+
+      // decrements are additions of the negated value, since the results are truncated
+      case InstructionCode::Increment8:
+        set_op(ProgramOpType::Add8, 1, value8);
+        break;
+      case InstructionCode::Increment16:
+        set_op(ProgramOpType::Add16, 2, value16);
+        break;
+      case InstructionCode::ExtIncrement32:
+        set_op(ProgramOpType::Add32, 4, value32);
+        break;
+      case InstructionCode::Decrement8:
+        set_op(ProgramOpType::Add8, 1, 0u - value8);
+        break;
+      case InstructionCode::Decrement16:
+        set_op(ProgramOpType::Add16, 2, 0u - value16);
+        break;
+      case InstructionCode::ExtDecrement32:
+        set_op(ProgramOpType::Add32, 4, 0u - value32);
+        break;
+
+      case InstructionCode::CompareEqual8:
+        set_op(ProgramOpType::CompareEqual8, 1, value8);
+        break;
+      case InstructionCode::CompareEqual16:
+        set_op(ProgramOpType::CompareEqual16, 2, value16);
+        break;
+      case InstructionCode::ExtCompareEqual32:
+        set_op(ProgramOpType::CompareEqual32, 4, value32);
+        break;
+      case InstructionCode::CompareNotEqual8:
+        set_op(ProgramOpType::CompareNotEqual8, 1, value8);
+        break;
+      case InstructionCode::CompareNotEqual16:
+        set_op(ProgramOpType::CompareNotEqual16, 2, value16);
+        break;
+      case InstructionCode::ExtCompareNotEqual32:
+        set_op(ProgramOpType::CompareNotEqual32, 4, value32);
+        break;
+      case InstructionCode::CompareLess8:
+        set_op(ProgramOpType::CompareLess8, 1, value8);
+        break;
+      case InstructionCode::CompareLess16:
+        set_op(ProgramOpType::CompareLess16, 2, value16);
+        break;
+      case InstructionCode::ExtCompareLess32:
+        set_op(ProgramOpType::CompareLess32, 4, value32);
+        break;
+      case InstructionCode::CompareGreater8:
+        set_op(ProgramOpType::CompareGreater8, 1, value8);
+        break;
+      case InstructionCode::CompareGreater16:
+        set_op(ProgramOpType::CompareGreater16, 2, value16);
+        break;
+      case InstructionCode::ExtCompareGreater32:
+        set_op(ProgramOpType::CompareGreater32, 4, value32);
+        break;
+
+      case InstructionCode::ScratchpadWrite16:
+      case InstructionCode::ExtScratchpadWrite32:
+      {
+        if (inst.code == InstructionCode::ExtScratchpadWrite32)
+          set_op(ProgramOpType::ScratchpadWrite32, 4, value32);
+        else
+          set_op(ProgramOpType::ScratchpadWrite16, 2, value16);
+
+        // unaligned accesses can run off the end of the scratchpad
+        op.offset = address & CPU::DCACHE_OFFSET_MASK;
+        if ((op.offset & (access_size - 1)) != 0)
+          return false;
+      }
+      break;
+
+      default:
+        return false;
+    }
+
+    const bool conditional = (op.type >= ProgramOpType::CompareEqual8);
+    const bool ram_access = (op.type >= ProgramOpType::Write8 && op.type != ProgramOpType::ScratchpadWrite16 &&
+                             op.type != ProgramOpType::ScratchpadWrite32);
+    if (ram_access)
+    {
+      // anything outside RAM or unaligned goes through the bus, so let the interpreter handle it
+      if (address >= Bus::RAM_MIRROR_END || (address & (access_size - 1)) != 0)
+        return false;
+
+      op.offset = address & Bus::g_ram_mask;
+    }
+
+    if (conditional)
+    {
+      if (condition_count == 0)
+      {
+        conditions_start = ops->size();
+        ops->push_back(ProgramOp{ProgramOpType::Conditions, 0, 0, 0});
+      }
+
+      ops->push_back(op);
+      condition_count++;
+      continue;
+    }
+
+    if (condition_count > 0)
+    {
+      (*ops)[conditions_start].count = condition_count;
+      condition_count = 0;
+    }
+    else if (op.type == ProgramOpType::Nop)
+    {
+      // nops only need to be kept when they're the target of a condition
+      continue;
+    }
+
+    ops->push_back(op);
   }
+
+  // comparisons at the end of a code don't guard anything
+  if (condition_count > 0)
+    ops->resize(conditions_start);
+
+  return true;
 }
 
 void CheatList::AddCode(CheatCode cc)
 {
   m_codes.push_back(std::move(cc));
+  m_program_dirty = true;
 }
 
 void CheatList::SetCode(u32 index, CheatCode cc)
@@ -570,6 +927,7 @@ void CheatList::SetCode(u32 index, CheatCode cc)
   if (index > m_codes.size())
     return;
 
+  m_program_dirty = true;
   if (index == m_codes.size())
   {
     m_codes.push_back(std::move(cc));
@@ -582,6 +940,7 @@ void CheatList::SetCode(u32 index, CheatCode cc)
 void CheatList::RemoveCode(u32 i)
 {
   m_codes.erase(m_codes.begin() + i);
+  m_program_dirty = true;
 }
 
 std::optional<CheatList::Format> CheatList::DetectFileFormat(const char* filename)
@@ -650,6 +1009,7 @@ bool CheatList::LoadFromFile(const char* filename, Format format)
 
 bool CheatList::LoadFromString(const std::string& str, Format format)
 {
+  m_program_dirty = true;
   if (format == Format::Autodetect)
     format = DetectFileFormat(str);
 
@@ -684,14 +1044,307 @@ bool CheatList::SaveToPCSXRFile(const char* filename)
   return (std::ferror(fp.get()) == 0);
 }
 
-bool CheatList::LoadFromPackage(const std::string& serial)
+namespace {
+enum : u32
+{
+  CHEAT_DATABASE_CACHE_SIGNATURE = 0x42445443,
+  CHEAT_DATABASE_CACHE_VERSION = 1,
+};
+
+// The index is used in place once it's mapped. It's a header, then a record for each serial in chtdb.txt sorted by
+// serial, then the serial strings. Each record gives the range of chtdb.txt holding that serial's codes.
+struct CheatDatabaseCacheHeader
+{
+  u32 signature;
+  u32 version;
+  u64 chtdb_ts;
+  u32 num_serials;
+  u32 string_table_size;
+};
+
+struct CheatDatabaseCacheSerial
+{
+  u32 serial_offset;
+  u32 serial_length;
+  u32 codes_offset;
+  u32 codes_length;
+};
+
+static_assert(sizeof(CheatDatabaseCacheHeader) == 24 && sizeof(CheatDatabaseCacheSerial) == 16,
+              "Cache structures are packed");
+} // namespace
+
+static std::mutex s_cheat_database_mutex;
+static bool s_cheat_database_loaded = false;
+static std::FILE* s_cheat_database_file = nullptr;
+static const u8* s_cheat_database_mapping = nullptr;
+static size_t s_cheat_database_mapping_size = 0;
+static std::vector<u8> s_cheat_database_buffer;
+static const CheatDatabaseCacheSerial* s_cheat_database_serials = nullptr;
+static const char* s_cheat_database_strings = nullptr;
+static u32 s_cheat_database_num_serials = 0;
+
+static std::string GetCheatDatabaseCacheFile()
+{
+  return Path::Combine(EmuFolders::Cache, "chtdb.cache");
+}
+
+static std::string_view TrimPackageLine(std::string_view line)
+{
+  while (!line.empty() && std::isspace(SignedCharToInt(line.front())))
+    line.remove_prefix(1);
+  while (!line.empty() && std::isspace(SignedCharToInt(line.back())))
+    line.remove_suffix(1);
+  return line;
+}
+
+static bool SetCheatDatabaseCacheData(const u8* data, size_t size, u64 chtdb_ts)
+{
+  if (size < sizeof(CheatDatabaseCacheHeader))
+    return false;
+
+  CheatDatabaseCacheHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (header.signature != CHEAT_DATABASE_CACHE_SIGNATURE || header.version != CHEAT_DATABASE_CACHE_VERSION ||
+      header.chtdb_ts != chtdb_ts)
+  {
+    Log_DevPrintf("Cheat database index is out of date, recreating.");
+    return false;
+  }
+
+  if ((sizeof(CheatDatabaseCacheHeader) + static_cast<u64>(header.num_serials) * sizeof(CheatDatabaseCacheSerial) +
+       header.string_table_size) != size)
+  {
+    Log_DevPrintf("Cheat database index is corrupted.");
+    return false;
+  }
+
+  const CheatDatabaseCacheSerial* serials =
+    reinterpret_cast<const CheatDatabaseCacheSerial*>(data + sizeof(CheatDatabaseCacheHeader));
+  for (u32 i = 0; i < header.num_serials; i++)
+  {
+    if (serials[i].serial_offset > header.string_table_size ||
+        serials[i].serial_length > (header.string_table_size - serials[i].serial_offset))
+    {
+      Log_DevPrintf("Cheat database index is corrupted.");
+      return false;
+    }
+  }
+
+  s_cheat_database_serials = serials;
+  s_cheat_database_strings = reinterpret_cast<const char*>(serials + header.num_serials);
+  s_cheat_database_num_serials = header.num_serials;
+  return true;
+}
+
+static bool BuildCheatDatabaseCache(const std::string_view& db, u64 chtdb_ts, std::vector<u8>* data)
 {
+  if (db.size() > std::numeric_limits<u32>::max())
+    return false;
+
+  // consecutive serials share the codes which follow them, so they're only closed off once codes are seen
+  std::vector<std::pair<std::string_view, CheatDatabaseCacheSerial>> serials;
+  size_t num_open_serials = 0;
+  bool open_serials_have_codes = false;
+  const auto close_serials = [&serials, &num_open_serials](size_t end) {
+    for (size_t i = serials.size() - num_open_serials; i < serials.size(); i++)
+      serials[i].second.codes_length = static_cast<u32>(end) - serials[i].second.codes_offset;
+    num_open_serials = 0;
+  };
+
+  size_t pos = 0;
+  while (pos < db.size())
+  {
+    const size_t line_start = pos;
+    size_t line_end = db.find('\n', pos);
+    if (line_end == std::string_view::npos)
+      line_end = db.size();
+    pos = std::min(line_end + 1, db.size());
+
+    // same rules as the parser, comments, blanks and single characters are skipped
+    const std::string_view line(TrimPackageLine(db.substr(line_start, line_end - line_start)));
+    if (line.size() <= 1 || line[0] == ';')
+      continue;
+
+    if (line[0] != ':')
+    {
+      open_serials_have_codes |= (num_open_serials > 0);
+      continue;
+    }
+
+    if (open_serials_have_codes)
+    {
+      close_serials(line_start);
+      open_serials_have_codes = false;
+    }
+
+    CheatDatabaseCacheSerial record = {};
+    record.codes_offset = static_cast<u32>(pos);
+    serials.emplace_back(line.substr(1), record);
+    num_open_serials++;
+  }
+  close_serials(db.size());
+
+  // the first occurrence of a serial is the one which is used
+  std::stable_sort(serials.begin(), serials.end(),
+                   [](const auto& lhs, const auto& rhs) { return (lhs.first < rhs.first); });
+  serials.erase(std::unique(serials.begin(), serials.end(),
+                            [](const auto& lhs, const auto& rhs) { return (lhs.first == rhs.first); }),
+                serials.end());
+
+  std::string strings;
+  for (auto& [serial, record] : serials)
+  {
+    record.serial_offset = static_cast<u32>(strings.size());
+    record.serial_length = static_cast<u32>(serial.size());
+    strings.append(serial);
+  }
+
+  CheatDatabaseCacheHeader header = {};
+  header.signature = CHEAT_DATABASE_CACHE_SIGNATURE;
+  header.version = CHEAT_DATABASE_CACHE_VERSION;
+  header.chtdb_ts = chtdb_ts;
+  header.num_serials = static_cast<u32>(serials.size());
+  header.string_table_size = static_cast<u32>(strings.size());
+
+  data->resize(sizeof(header) + serials.size() * sizeof(CheatDatabaseCacheSerial) + strings.size());
+  u8* ptr = data->data();
+  std::memcpy(ptr, &header, sizeof(header));
+  ptr += sizeof(header);
+  for (const auto& [serial, record] : serials)
+  {
+    std::memcpy(ptr, &record, sizeof(record));
+    ptr += sizeof(record);
+  }
+  std::memcpy(ptr, strings.data(), strings.size());
+  return true;
+}
+
+static bool SaveCheatDatabaseCache(const std::vector<u8>& data)
+{
+  std::unique_ptr<ByteStream> stream(ByteStream::OpenFile(
+    GetCheatDatabaseCacheFile().c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
+                                           BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED));
+  if (!stream)
+    return false;
+
+  if (!stream->Write2(data.data(), static_cast<u32>(data.size())))
+  {
+    stream->Discard();
+    return false;
+  }
+
+  return stream->Commit();
+}
+
+static void ReleaseCheatDatabaseCache()
+{
+  if (s_cheat_database_mapping)
+  {
+    FileSystem::UnmapCFile(s_cheat_database_mapping, s_cheat_database_mapping_size);
+    s_cheat_database_mapping = nullptr;
+    s_cheat_database_mapping_size = 0;
+  }
+  if (s_cheat_database_file)
+  {
+    std::fclose(s_cheat_database_file);
+    s_cheat_database_file = nullptr;
+  }
+  s_cheat_database_buffer = {};
+  s_cheat_database_serials = nullptr;
+  s_cheat_database_strings = nullptr;
+  s_cheat_database_num_serials = 0;
+}
+
+static bool LoadCheatDatabaseCache(u64 chtdb_ts)
+{
+  s_cheat_database_file = FileSystem::OpenCFile(GetCheatDatabaseCacheFile().c_str(), "rb");
+  if (!s_cheat_database_file)
+    return false;
+
+  const s64 size = FileSystem::FSize64(s_cheat_database_file);
+  const void* mapping =
+    (size > 0) ? FileSystem::MapCFile(s_cheat_database_file, static_cast<size_t>(size)) : nullptr;
+  if (mapping)
+  {
+    s_cheat_database_mapping = static_cast<const u8*>(mapping);
+    s_cheat_database_mapping_size = static_cast<size_t>(size);
+    if (SetCheatDatabaseCacheData(s_cheat_database_mapping, s_cheat_database_mapping_size, chtdb_ts))
+      return true;
+  }
+
+  ReleaseCheatDatabaseCache();
+  return false;
+}
+
+static void EnsureCheatDatabaseLoaded()
+{
+  if (s_cheat_database_loaded)
+    return;
+
+  s_cheat_database_loaded = true;
+
+  const u64 chtdb_ts = Host::GetResourceFileTimestamp("chtdb.txt").value_or(0);
+  if (LoadCheatDatabaseCache(chtdb_ts))
+    return;
+
+  // only the first boot after the database changes pays for reading all of it
+  Common::Timer timer;
   const std::optional<std::string> db_string(Host::ReadResourceFileToString("chtdb.txt"));
-  if (!db_string.has_value())
+  if (!db_string.has_value() || !BuildCheatDatabaseCache(db_string.value(), chtdb_ts, &s_cheat_database_buffer))
+    return;
+
+  if (!SaveCheatDatabaseCache(s_cheat_database_buffer))
+    Log_WarningPrintf("Failed to write cheat database index");
+
+  if (!SetCheatDatabaseCacheData(s_cheat_database_buffer.data(), s_cheat_database_buffer.size(), chtdb_ts))
+    ReleaseCheatDatabaseCache();
+
+  Log_InfoPrintf("Cheat database index build took %.2f ms", timer.GetTimeMilliseconds());
+}
+
+/// Reads the part of chtdb.txt holding the codes for a serial, without reading the rest.
+static std::optional<std::string> ReadPackageCodes(const std::string& serial)
+{
+  std::unique_lock lock(s_cheat_database_mutex);
+  EnsureCheatDatabaseLoaded();
+
+  const CheatDatabaseCacheSerial* begin = s_cheat_database_serials;
+  const CheatDatabaseCacheSerial* end = begin + s_cheat_database_num_serials;
+  const CheatDatabaseCacheSerial* iter =
+    std::lower_bound(begin, end, std::string_view(serial),
+                     [](const CheatDatabaseCacheSerial& record, const std::string_view& key) {
+                       return (std::string_view(s_cheat_database_strings + record.serial_offset,
+                                                record.serial_length) < key);
+                     });
+  if (iter == end || std::string_view(s_cheat_database_strings + iter->serial_offset, iter->serial_length) != serial)
+    return std::nullopt;
+
+  auto fp = FileSystem::OpenManagedCFile(Path::Combine(EmuFolders::Resources, "chtdb.txt").c_str(), "rb");
+  std::string codes(iter->codes_length, '\0');
+  if (!fp || FileSystem::FSeek64(fp.get(), iter->codes_offset, SEEK_SET) != 0 ||
+      std::fread(codes.data(), 1, codes.size(), fp.get()) != codes.size())
+  {
+    Log_ErrorPrintf("Failed to read codes for %s from cheat database", serial.c_str());
+    return std::nullopt;
+  }
+
+  return codes;
+}
+
+bool CheatList::LoadFromPackage(const std::string& serial)
+{
+  m_program_dirty = true;
+  const std::optional<std::string> codes(ReadPackageCodes(serial));
+  if (!codes.has_value())
+  {
+    Log_WarningPrintf("No codes found in package for %s", serial.c_str());
     return false;
+  }
 
-  std::istringstream iss(db_string.value());
+  std::istringstream iss(codes.value());
   std::string line;
+  CheatCode current_code;
   while (std::getline(iss, line))
   {
     char* start = line.data();
@@ -712,88 +1365,59 @@ bool CheatList::LoadFromPackage(const std::string& serial)
     if (start == end)
       continue;
 
-    if (start[0] != ':' || std::strcmp(&start[1], serial.c_str()) != 0)
-      continue;
+    // stop adding codes when we hit a different game
+    if (start[0] == ':' && (!m_codes.empty() || current_code.Valid()))
+      break;
 
-    // game code match
-    CheatCode current_code;
-    while (std::getline(iss, line))
+    if (start[0] == '#')
     {
-      start = line.data();
-      while (*start != '\0' && std::isspace(SignedCharToInt(*start)))
-        start++;
-
-      // skip empty lines
-      if (*start == '\0' || *start == ';')
-        continue;
+      start++;
 
-      end = start + std::strlen(start) - 1;
-      while (end > start && std::isspace(SignedCharToInt(*end)))
+      if (current_code.Valid())
       {
-        *end = '\0';
-        end--;
+        m_codes.push_back(std::move(current_code));
+        current_code = CheatCode();
       }
 
-      if (start == end)
-        continue;
-
-      // stop adding codes when we hit a different game
-      if (start[0] == ':' && (!m_codes.empty() || current_code.Valid()))
-        break;
-
-      if (start[0] == '#')
+      // new code
+      char* slash = std::strrchr(start, '\\');
+      if (slash)
       {
-        start++;
-
-        if (current_code.Valid())
-        {
-          m_codes.push_back(std::move(current_code));
-          current_code = CheatCode();
-        }
-
-        // new code
-        char* slash = std::strrchr(start, '\\');
-        if (slash)
-        {
-          *slash = '\0';
-          current_code.group = start;
-          start = slash + 1;
-        }
-        if (current_code.group.empty())
-          current_code.group = "Ungrouped";
-
-        current_code.description = start;
-        continue;
+        *slash = '\0';
+        current_code.group = start;
+        start = slash + 1;
       }
+      if (current_code.group.empty())
+        current_code.group = "Ungrouped";
 
-      while (!IsHexCharacter(*start) && start != end)
-        start++;
-      if (start == end)
-        continue;
-
-      char* end_ptr;
-      CheatCode::Instruction inst;
-      inst.first = static_cast<u32>(std::strtoul(start, &end_ptr, 16));
-      inst.second = 0;
-      if (end_ptr)
-      {
-        while (!IsHexCharacter(*end_ptr) && end_ptr != end)
-          end_ptr++;
-        if (end_ptr != end)
-          inst.second = static_cast<u32>(std::strtoul(end_ptr, nullptr, 16));
-      }
-      current_code.instructions.push_back(inst);
+      current_code.description = start;
+      continue;
     }
 
-    if (current_code.Valid())
-      m_codes.push_back(std::move(current_code));
+    while (!IsHexCharacter(*start) && start != end)
+      start++;
+    if (start == end)
+      continue;
 
-    Log_InfoPrintf("Loaded %zu codes from package for %s", m_codes.size(), serial.c_str());
-    return !m_codes.empty();
+    char* end_ptr;
+    CheatCode::Instruction inst;
+    inst.first = static_cast<u32>(std::strtoul(start, &end_ptr, 16));
+    inst.second = 0;
+    if (end_ptr)
+    {
+      while (!IsHexCharacter(*end_ptr) && end_ptr != end)
+        end_ptr++;
+      if (end_ptr != end)
+        inst.second = static_cast<u32>(std::strtoul(end_ptr, nullptr, 16));
+    }
+    current_code.instructions.push_back(inst);
   }
 
-  Log_WarningPrintf("No codes found in package for %s", serial.c_str());
-  return false;
+  if (current_code.Valid())
+    m_codes.push_back(std::move(current_code));
+
+  Log_InfoPrintf("Loaded %zu codes from package for %s", m_codes.size(), serial.c_str());
+  return !m_codes.empty();
 }
 
 u32 CheatList::GetEnabledCodeCount() const
@@ -828,6 +1452,7 @@ void CheatList::SetCodeEnabled(u32 index, bool state)
     return;
 
   m_codes[index].enabled = state;
+  m_program_dirty = true;
   if (!state)
     m_codes[index].ApplyOnDisable();
 }
@@ -2828,15 +3453,15 @@ void MemoryScan::Search()
   switch (m_size)
   {
     case MemoryAccessSize::Byte:
-      SearchBytes();
+      SearchValues<u8>();
       break;
 
     case MemoryAccessSize::HalfWord:
-      SearchHalfwords();
+      SearchValues<u16>();
       break;
 
     case MemoryAccessSize::Word:
-      SearchWords();
+      SearchValues<u32>();
       break;
 
     default:
@@ -2844,61 +3469,353 @@ void MemoryScan::Search()
   }
 }
 
-void MemoryScan::SearchBytes()
+namespace {
+// On the first pass the last value is the current value, so every operator is either a comparison against the search
+// value, or matches everything or nothing.
+enum class ScanMatch : u8
+{
+  None,
+  All,
+  Equal,
+  NotEqual,
+  Greater,
+  GreaterEqual,
+  Less,
+  LessEqual,
+};
+
+struct ScanComparison
 {
-  for (PhysicalMemoryAddress address = m_start_address; address < m_end_address; address++)
+  ScanMatch match;
+  u32 value; ///< truncated to the element size
+};
+} // namespace
+
+template<typename T>
+static ScanComparison GetScanComparison(MemoryScan::Operator op, u32 comp_value, bool is_signed)
+{
+  ScanMatch match;
+  switch (op)
   {
-    if (!IsValidScanAddress(address))
-      continue;
+    case MemoryScan::Operator::Equal:
+      match = ScanMatch::Equal;
+      break;
+    case MemoryScan::Operator::NotEqual:
+      match = ScanMatch::NotEqual;
+      break;
+    case MemoryScan::Operator::GreaterThan:
+      match = ScanMatch::Greater;
+      break;
+    case MemoryScan::Operator::GreaterEqual:
+      match = ScanMatch::GreaterEqual;
+      break;
+    case MemoryScan::Operator::LessThan:
+      match = ScanMatch::Less;
+      break;
+    case MemoryScan::Operator::LessEqual:
+      match = ScanMatch::LessEqual;
+      break;
 
-    const u8 bvalue = DoMemoryRead<u8>(address);
+    default:
+    {
+      const MemoryScan::Result res = {0, 0, 0, false};
+      return {res.Filter(op, comp_value, is_signed) ? ScanMatch::All : ScanMatch::None, 0};
+    }
+  }
 
-    Result res;
-    res.address = address;
-    res.value = m_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
-    res.last_value = res.value;
-    res.value_changed = false;
+  // values are extended to 32 bits before comparing, so a search value outside the element's range is all or nothing
+  constexpr u32 bits = sizeof(T) * 8;
+  const s64 min_value = is_signed ? -(s64(1) << (bits - 1)) : 0;
+  const s64 max_value = is_signed ? ((s64(1) << (bits - 1)) - 1) : ((s64(1) << bits) - 1);
+  const s64 value = is_signed ? static_cast<s64>(static_cast<s32>(comp_value)) : static_cast<s64>(comp_value);
+  if (value < min_value || value > max_value)
+  {
+    const bool below = (value < min_value);
+    switch (match)
+    {
+      case ScanMatch::Equal:
+        return {ScanMatch::None, 0};
+      case ScanMatch::NotEqual:
+        return {ScanMatch::All, 0};
+      case ScanMatch::Greater:
+      case ScanMatch::GreaterEqual:
+        return {below ? ScanMatch::All : ScanMatch::None, 0};
+      default:
+        return {below ? ScanMatch::None : ScanMatch::All, 0};
+    }
+  }
 
-    if (res.Filter(m_operator, m_value, m_signed))
-      m_results.push_back(res);
+  return {match, static_cast<u32>(static_cast<T>(value))};
+}
+
+template<typename T>
+ALWAYS_INLINE static u32 ExtendScanValue(T value, bool is_signed)
+{
+  if constexpr (std::is_same_v<T, u32>)
+    return value;
+  else
+    return is_signed ? SignExtend32(value) : ZeroExtend32(value);
+}
+
+template<typename T>
+ALWAYS_INLINE static bool MatchScanValue(T value, const ScanComparison& cmp, bool is_signed)
+{
+  using SignedType = std::make_signed_t<T>;
+  const T comp = static_cast<T>(cmp.value);
+  const bool greater =
+    is_signed ? (static_cast<SignedType>(value) > static_cast<SignedType>(comp)) : (value > comp);
+  const bool less = is_signed ? (static_cast<SignedType>(value) < static_cast<SignedType>(comp)) : (value < comp);
+  switch (cmp.match)
+  {
+    case ScanMatch::All:
+      return true;
+    case ScanMatch::Equal:
+      return (value == comp);
+    case ScanMatch::NotEqual:
+      return (value != comp);
+    case ScanMatch::Greater:
+      return greater;
+    case ScanMatch::GreaterEqual:
+      return !less;
+    case ScanMatch::Less:
+      return less;
+    case ScanMatch::LessEqual:
+      return !greater;
+    default:
+      return false;
   }
 }
 
-void MemoryScan::SearchHalfwords()
+#if defined(CPU_X64) || defined(CPU_AARCH64)
+
+#if defined(CPU_X64)
+using ScanVector = __m128i;
+#else
+using ScanVector = uint8x16_t;
+#endif
+
+template<typename T>
+ALWAYS_INLINE static ScanVector BroadcastScanValue(u32 value)
+{
+#if defined(CPU_X64)
+  if constexpr (sizeof(T) == 1)
+    return _mm_set1_epi8(static_cast<char>(value));
+  else if constexpr (sizeof(T) == 2)
+    return _mm_set1_epi16(static_cast<short>(value));
+  else
+    return _mm_set1_epi32(static_cast<int>(value));
+#else
+  if constexpr (sizeof(T) == 1)
+    return vdupq_n_u8(static_cast<u8>(value));
+  else if constexpr (sizeof(T) == 2)
+    return vreinterpretq_u8_u16(vdupq_n_u16(static_cast<u16>(value)));
+  else
+    return vreinterpretq_u8_u32(vdupq_n_u32(value));
+#endif
+}
+
+/// Returns one bit per byte of the comparison, for the first byte of each element which matches.
+template<typename T>
+ALWAYS_INLINE static u32 GetScanMatchMask(const u8* ptr, ScanMatch match, ScanVector comp, ScanVector bias)
 {
-  for (PhysicalMemoryAddress address = m_start_address; address < m_end_address; address += 2)
+  // unsigned values are biased, so all comparisons can be signed
+#if defined(CPU_X64)
+  const __m128i value = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)), bias);
+  __m128i eq, gt, lt;
+  if constexpr (sizeof(T) == 1)
   {
-    if (!IsValidScanAddress(address))
-      continue;
+    eq = _mm_cmpeq_epi8(value, comp);
+    gt = _mm_cmpgt_epi8(value, comp);
+    lt = _mm_cmpgt_epi8(comp, value);
+  }
+  else if constexpr (sizeof(T) == 2)
+  {
+    eq = _mm_cmpeq_epi16(value, comp);
+    gt = _mm_cmpgt_epi16(value, comp);
+    lt = _mm_cmpgt_epi16(comp, value);
+  }
+  else
+  {
+    eq = _mm_cmpeq_epi32(value, comp);
+    gt = _mm_cmpgt_epi32(value, comp);
+    lt = _mm_cmpgt_epi32(comp, value);
+  }
+
+  const auto movemask = [](__m128i v) { return static_cast<u32>(_mm_movemask_epi8(v)); };
+#else
+  const uint8x16_t value = veorq_u8(vld1q_u8(ptr), bias);
+  uint8x16_t eq, gt, lt;
+  if constexpr (sizeof(T) == 1)
+  {
+    eq = vceqq_u8(value, comp);
+    gt = vcgtq_s8(vreinterpretq_s8_u8(value), vreinterpretq_s8_u8(comp));
+    lt = vcgtq_s8(vreinterpretq_s8_u8(comp), vreinterpretq_s8_u8(value));
+  }
+  else if constexpr (sizeof(T) == 2)
+  {
+    eq = vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(value), vreinterpretq_u16_u8(comp)));
+    gt = vreinterpretq_u8_u16(vcgtq_s16(vreinterpretq_s16_u8(value), vreinterpretq_s16_u8(comp)));
+    lt = vreinterpretq_u8_u16(vcgtq_s16(vreinterpretq_s16_u8(comp), vreinterpretq_s16_u8(value)));
+  }
+  else
+  {
+    eq = vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(value), vreinterpretq_u32_u8(comp)));
+    gt = vreinterpretq_u8_u32(vcgtq_s32(vreinterpretq_s32_u8(value), vreinterpretq_s32_u8(comp)));
+    lt = vreinterpretq_u8_u32(vcgtq_s32(vreinterpretq_s32_u8(comp), vreinterpretq_s32_u8(value)));
+  }
+
+  const auto movemask = [](uint8x16_t v) {
+    static constexpr u8 bit_values[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t bits = vandq_u8(v, vld1q_u8(bit_values));
+    return static_cast<u32>(vaddv_u8(vget_low_u8(bits))) | (static_cast<u32>(vaddv_u8(vget_high_u8(bits))) << 8);
+  };
+#endif
 
-    const u16 bvalue = DoMemoryRead<u16>(address);
+  u32 mask;
+  switch (match)
+  {
+    case ScanMatch::Equal:
+      mask = movemask(eq);
+      break;
+    case ScanMatch::NotEqual:
+      mask = ~movemask(eq);
+      break;
+    case ScanMatch::Greater:
+      mask = movemask(gt);
+      break;
+    case ScanMatch::GreaterEqual:
+      mask = ~movemask(lt);
+      break;
+    case ScanMatch::Less:
+      mask = movemask(lt);
+      break;
+    case ScanMatch::LessEqual:
+    default:
+      mask = ~movemask(gt);
+      break;
+  }
+
+  constexpr u32 element_mask = (sizeof(T) == 1) ? 0xFFFFu : ((sizeof(T) == 2) ? 0x5555u : 0x1111u);
+  return mask & element_mask;
+}
 
-    Result res;
+#endif
+
+/// Scans addresses in [start, end) which are all in RAM, stepping by the element size.
+template<typename T>
+static void ScanRAMValues(PhysicalMemoryAddress start, PhysicalMemoryAddress end, const ScanComparison& cmp,
+                          bool is_signed, MemoryScan::ResultVector* results)
+{
+  const auto add_result = [results, is_signed](PhysicalMemoryAddress address, T value) {
+    MemoryScan::Result res;
     res.address = address;
-    res.value = m_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
+    res.value = ExtendScanValue(value, is_signed);
     res.last_value = res.value;
     res.value_changed = false;
+    results->push_back(res);
+  };
+
+#if defined(CPU_X64) || defined(CPU_AARCH64)
+  constexpr u32 sign_bit = 1u << (sizeof(T) * 8 - 1);
+  const ScanVector bias = BroadcastScanValue<T>(is_signed ? 0u : sign_bit);
+  const ScanVector comp = BroadcastScanValue<T>(is_signed ? cmp.value : (cmp.value ^ sign_bit));
+  const bool use_vectors = (cmp.match != ScanMatch::All);
+#endif
+
+  PhysicalMemoryAddress address = start;
+  while (address < end)
+  {
+#if defined(CPU_X64) || defined(CPU_AARCH64)
+    // vectors can't cross the end of a mirror, since the next byte is back at the start of RAM
+    const u32 offset = address & Bus::g_ram_mask;
+    if (use_vectors && (end - address) >= 16 && (offset + 16) <= Bus::g_ram_size)
+    {
+      u32 mask = GetScanMatchMask<T>(&Bus::g_ram[offset], cmp.match, comp, bias);
+      while (mask != 0)
+      {
+        const u32 bit = CountTrailingZeros(mask);
+        T value;
+        std::memcpy(&value, &Bus::g_ram[offset + bit], sizeof(value));
+        add_result(address + bit, value);
+        mask &= (mask - 1);
+      }
 
-    if (res.Filter(m_operator, m_value, m_signed))
-      m_results.push_back(res);
+      address += 16;
+      continue;
+    }
+#endif
+
+    const T value = DoMemoryRead<T>(address);
+    if (MatchScanValue(value, cmp, is_signed))
+      add_result(address, value);
+
+    address += sizeof(T);
   }
 }
 
-void MemoryScan::SearchWords()
+template<typename T>
+void MemoryScan::SearchValues()
 {
-  for (PhysicalMemoryAddress address = m_start_address; address < m_end_address; address += 4)
+  const ScanComparison cmp = GetScanComparison<T>(m_operator, m_value, m_signed);
+  if (cmp.match == ScanMatch::None)
+    return;
+
+  // RAM is scanned directly, split across threads when it's large enough to be worth it
+  static constexpr u32 MAX_SCAN_THREADS = 8;
+  static constexpr u32 MIN_SCAN_BYTES_PER_THREAD = 256 * 1024;
+  PhysicalMemoryAddress address = m_start_address;
+  if (address < Bus::RAM_MIRROR_END && address < m_end_address)
+  {
+    const PhysicalMemoryAddress ram_end = std::min<PhysicalMemoryAddress>(m_end_address, Bus::RAM_MIRROR_END);
+    constexpr u32 element_size = sizeof(T);
+    const u32 num_bytes = ((ram_end - address + element_size - 1) / element_size) * element_size;
+    const u32 num_threads = std::clamp<u32>(std::min(std::thread::hardware_concurrency(), MAX_SCAN_THREADS), 1u,
+                                            std::max(num_bytes / MIN_SCAN_BYTES_PER_THREAD, 1u));
+
+    // chunks are a whole number of vectors, so every thread steps through the same addresses a single one would
+    const PhysicalMemoryAddress scan_end = address + num_bytes;
+    const u32 chunk_size = Common::AlignUpPow2(num_bytes / num_threads, 16);
+    std::vector<ResultVector> chunk_results(num_threads);
+    std::vector<std::thread> threads;
+    for (u32 i = 1; i < num_threads; i++)
+    {
+      const PhysicalMemoryAddress chunk_start = address + (i * chunk_size);
+      const PhysicalMemoryAddress chunk_end =
+        (i == (num_threads - 1)) ? scan_end : std::min(scan_end, chunk_start + chunk_size);
+      if (chunk_start >= chunk_end)
+        break;
+
+      threads.emplace_back([chunk_start, chunk_end, cmp, is_signed = m_signed, results = &chunk_results[i]]() {
+        ScanRAMValues<T>(chunk_start, chunk_end, cmp, is_signed, results);
+      });
+    }
+
+    ScanRAMValues<T>(address, std::min(scan_end, address + chunk_size), cmp, m_signed, &m_results);
+    for (u32 i = 0; i < static_cast<u32>(threads.size()); i++)
+    {
+      threads[i].join();
+      m_results.insert(m_results.end(), chunk_results[i + 1].begin(), chunk_results[i + 1].end());
+    }
+
+    address = scan_end;
+  }
+
+  // the scratchpad and BIOS go through the bus
+  for (; address < m_end_address; address += sizeof(T))
   {
     if (!IsValidScanAddress(address))
       continue;
 
-    Result res;
-    res.address = address;
-    res.value = DoMemoryRead<u32>(address);
-    res.last_value = res.value;
-    res.value_changed = false;
-
-    if (res.Filter(m_operator, m_value, m_signed))
+    const T value = DoMemoryRead<T>(address);
+    if (MatchScanValue(value, cmp, m_signed))
+    {
+      Result res;
+      res.address = address;
+      res.value = ExtendScanValue(value, m_signed);
+      res.last_value = res.value;
+      res.value_changed = false;
       m_results.push_back(res);
+    }
   }
 }
 
@@ -3046,6 +3963,21 @@ bool MemoryScan::Result::Filter(Operator op, u32 comp_value, bool is_signed) con
   }
 }
 
+template<typename T>
+ALWAYS_INLINE static T ReadScanValue(PhysicalMemoryAddress address)
+{
+  // skip the bus for RAM, since there can be a lot of results to update
+  const u32 offset = address & Bus::g_ram_mask;
+  if (address < Bus::RAM_MIRROR_END && (offset + sizeof(T)) <= Bus::g_ram_size)
+  {
+    T value;
+    std::memcpy(&value, &Bus::g_ram[offset], sizeof(value));
+    return value;
+  }
+
+  return DoMemoryRead<T>(address);
+}
+
 void MemoryScan::Result::UpdateValue(MemoryAccessSize size, bool is_signed)
 {
   const u32 old_value = value;
@@ -3054,21 +3986,24 @@ void MemoryScan::Result::UpdateValue(MemoryAccessSize size, bool is_signed)
   {
     case MemoryAccessSize::Byte:
     {
-      u8 bvalue = DoMemoryRead<u8>(address);
+      u8 bvalue = ReadScanValue<u8>(address);
       value = is_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
     }
     break;
 
     case MemoryAccessSize::HalfWord:
     {
-      u16 bvalue = DoMemoryRead<u16>(address);
+      u16 bvalue = ReadScanValue<u16>(address);
       value = is_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
     }
     break;
 
     case MemoryAccessSize::Word:
     {
-      CPU::SafeReadMemoryWord(address, &value);
+      if (address < Bus::RAM_MIRROR_END)
+        value = ReadScanValue<u32>(address);
+      else
+        CPU::SafeReadMemoryWord(address, &value);
     }
     break;
   }
@@ -192,7 +192,58 @@ public:
   void MergeList(const CheatList& cl);
 
 private:
+  /// Enabled codes are compiled to a flat program, so the common writes and comparisons don't go through the
+  /// interpreter or the bus every frame. Codes which use anything else run through CheatCode::Apply().
+  enum class ProgramOpType : u8
+  {
+    Interpret,
+    Conditions, ///< the next count ops are comparisons, and the op after them is skipped unless all are true
+    Nop,
+    Write8,
+    Write16,
+    Write32,
+    ScratchpadWrite16,
+    ScratchpadWrite32,
+    Add8,
+    Add16,
+    Add32,
+    Or8,
+    Or16,
+    Or32,
+    And8,
+    And16,
+    And32,
+    // comparisons must stay at the end
+    CompareEqual8,
+    CompareEqual16,
+    CompareEqual32,
+    CompareNotEqual8,
+    CompareNotEqual16,
+    CompareNotEqual32,
+    CompareLess8,
+    CompareLess16,
+    CompareLess32,
+    CompareGreater8,
+    CompareGreater16,
+    CompareGreater32,
+  };
+
+  struct ProgramOp
+  {
+    ProgramOpType type;
+    u16 count;
+    u32 offset; ///< RAM or scratchpad offset, or the code index for Interpret
+    u32 value;
+  };
+
+  static bool CompileCode(const CheatCode& cc, std::vector<ProgramOp>* ops);
+  void CompileProgram();
+  bool EvaluateProgramCondition(const ProgramOp& op) const;
+
   std::vector<CheatCode> m_codes;
+  std::vector<ProgramOp> m_program;
+  u32 m_program_ram_mask = 0;
+  bool m_program_dirty = true;
   bool m_master_enable = true;
 };
 
@@ -260,9 +311,8 @@ public:
   void SetResultValue(u32 index, u32 value);
 
 private:
-  void SearchBytes();
-  void SearchHalfwords();
-  void SearchWords();
+  template<typename T>
+  void SearchValues();
 
   u32 m_value = 0;
   MemoryAccessSize m_size = MemoryAccessSize::HalfWord;
@@ -58,6 +58,8 @@ std::optional<u32> Controller::GetAnalogInputBytes() const
   return std::nullopt;
 }
 
+void Controller::SetInputState(u32 button_bits, u32 analog_bytes) {}
+
 void Controller::LoadSettings(SettingsInterface& si, const char* section) {}
 
 bool Controller::GetSoftwareCursor(const Common::RGBA8Image** image, float* image_scale, bool* relative_mode)
@@ -89,6 +89,9 @@ public:
   /// Returns analog input bytes packed as a u32. Values are specific to controller type.
   virtual std::optional<u32> GetAnalogInputBytes() const;
 
+  /// Replaces the input state with values from GetButtonStateBits()/GetAnalogInputBytes(), e.g. from a netplay peer.
+  virtual void SetInputState(u32 button_bits, u32 analog_bytes);
+
   /// Loads/refreshes any per-controller settings.
   virtual void LoadSettings(SettingsInterface& si, const char* section);
 
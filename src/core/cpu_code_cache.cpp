@@ -1,13 +1,25 @@
 #include "cpu_code_cache.h"
 #include "bus.h"
+#include "common/align.h"
 #include "common/assert.h"
+#include "common/byte_stream.h"
+#include "common/file_system.h"
 #include "common/log.h"
+#include "common/path.h"
+#include "common/timer.h"
 #include "cpu_core.h"
 #include "cpu_core_private.h"
 #include "cpu_disasm.h"
+#include "fmt/format.h"
+#include "host_time_accounting.h"
 #include "settings.h"
 #include "system.h"
 #include "timing_event.h"
+#include <cinttypes>
+#include <optional>
+#ifdef __linux__
+#include <unistd.h>
+#endif
 Log_SetChannel(CPU::CodeCache);
 
 #ifdef WITH_RECOMPILER
@@ -23,6 +35,18 @@ static constexpr u32 RECOMPILE_FRAMES_TO_FALL_BACK_TO_INTERPRETER = 100;
 static constexpr u32 RECOMPILE_COUNT_TO_FALL_BACK_TO_INTERPRETER = 20;
 static constexpr u32 INVALIDATE_THRESHOLD_TO_DISABLE_LINKING = 10;
 
+// Maximum number of unconditional branches which are followed when forming a block.
+static constexpr u32 MAX_TRACED_BRANCHES_PER_BLOCK = 8;
+
+// Longest block which is considered for idle loop skipping.
+static constexpr u32 MAX_IDLE_LOOP_INSTRUCTIONS = 16;
+
+// Persistent block cache, stores the guest instructions of each block so they can be precompiled at boot.
+// Bump the version whenever the block decoding rules in CompileBlock() change.
+static constexpr u32 BLOCK_CACHE_SIGNATURE = 0x4B4C4243; // CBLK
+static constexpr u32 BLOCK_CACHE_VERSION = 2;
+static constexpr u32 BLOCK_CACHE_MAX_INSTRUCTIONS_PER_BLOCK = 4096;
+
 #ifdef WITH_RECOMPILER
 
 // Currently remapping the code buffer doesn't work in macOS or Haiku.
@@ -40,6 +64,13 @@ static constexpr u32 RECOMPILER_FAR_CODE_CACHE_SIZE = 16 * 1024 * 1024;
 #endif
 static constexpr u32 CODE_WRITE_FAULT_THRESHOLD_FOR_SLOWMEM = 10;
 
+// Limit on how many faulting PCs are remembered, games which fault everywhere are going to be slow anyway.
+static constexpr u32 MAX_FASTMEM_FAULT_PCS = 4096;
+
+// When a segment fills up, the oldest segment is evicted and reused, instead of flushing the whole buffer.
+static constexpr u32 RECOMPILER_CODE_CACHE_SEGMENTS = 8;
+static constexpr u32 RECOMPILER_MIN_CODE_BUFFER_SIZE = 4 * 1024 * 1024;
+
 #ifdef USE_STATIC_CODE_BUFFER
 static constexpr u32 RECOMPILER_GUARD_SIZE = 4096;
 alignas(Recompiler::CODE_STORAGE_ALIGNMENT) static u8
@@ -201,7 +232,9 @@ static CodeBlock* LookupBlock(CodeBlockKey key);
 /// The block can also be flushed if recompilation failed, so ignore the pointer if false is returned.
 static bool RevalidateBlock(CodeBlock* block);
 
-static bool CompileBlock(CodeBlock* block);
+/// Decodes and compiles the block. If cached_instructions is set, the guest code is taken from the array instead of
+/// memory, in which case the block must be revalidated before it is executed.
+static bool CompileBlock(CodeBlock* block, const u32* cached_instructions = nullptr, u32 cached_instruction_count = 0);
 static void RemoveReferencesToBlock(CodeBlock* block);
 static void AddBlockToPageMap(CodeBlock* block);
 static void RemoveBlockFromPageMap(CodeBlock* block);
@@ -215,16 +248,48 @@ static void UnlinkBlock(CodeBlock* block);
 static void ClearState();
 
 static BlockMap s_blocks;
+static std::unordered_map<u32, CodeBlockProfile> s_block_profiles;
+static CodeBlockProfile* s_last_block_profile = nullptr;
+static u32 s_last_block_profile_ticks = 0;
+static bool s_block_profiling = false;
+static bool s_breakpoints_changed = false;
+static u32 s_compile_budget_frame_number = 0;
+static u32 s_compile_budget_used = 0;
+static u32 s_compiled_block_count = 0;
 static std::array<std::vector<CodeBlock*>, Bus::RAM_8MB_CODE_PAGE_COUNT> m_ram_block_map;
 
+// Which 256 byte sub-pages of each code page contain instructions, so writes to data sharing a page with code can
+// be ignored.
+static_assert((HOST_PAGE_SIZE / CODE_SUBPAGE_SIZE) <= 16);
+static std::array<u16, Bus::RAM_8MB_CODE_PAGE_COUNT> m_ram_code_subpage_bits;
+
 #ifdef WITH_RECOMPILER
 static HostCodeMap s_host_code_map;
 
+// Guest PCs of loads/stores which were backpatched to slowmem, and how many times.
+static std::unordered_map<u32, u32> s_fastmem_fault_pcs;
+static void RecordFastmemFault(CodeBlock* block, u32 guest_pc, bool backpatching);
+
 static void AddBlockToHostCodeMap(CodeBlock* block);
 static void RemoveBlockFromHostCodeMap(CodeBlock* block);
+static CodeBlock::HostCodePointer GetFastMapFunction(const CodeBlock* block);
+
+static bool IsBlockHot(const CodeBlock* block);
+static bool HasSpaceForBlockHostCode(const CodeBlock* block);
+static void EvictBlockHostCode(CodeBlock* block);
+static void EvictNextCodeSegment();
+static bool MakeSpaceForBlockHostCode(const CodeBlock* block);
+static bool CompileBlockHostCode(CodeBlock* block);
+static bool PromoteBlock(CodeBlock* block, bool* flushed);
 
 static bool InitializeFastmem();
 static void ShutdownFastmem();
+
+// perf map, /tmp/perf-<pid>.map, which lets perf attribute samples in the code buffer to guest blocks
+static std::FILE* s_perf_map_file = nullptr;
+static void UpdatePerfMap();
+static void ClosePerfMap();
+static void WritePerfMapEntry(const void* code, u32 code_size, const char* name);
 static Common::PageFaultHandler::HandlerResult LUTPageFaultHandler(void* exception_pc, void* fault_address,
                                                                    bool is_write);
 #ifdef WITH_MMAP_FASTMEM
@@ -233,6 +298,66 @@ static Common::PageFaultHandler::HandlerResult MMapPageFaultHandler(void* except
 #endif
 #endif // WITH_RECOMPILER
 
+#ifdef WITH_RECOMPILER
+
+static void GetCodeBufferSize(u32* code_size, u32* far_code_size)
+{
+  *code_size = RECOMPILER_CODE_CACHE_SIZE;
+  *far_code_size = RECOMPILER_FAR_CODE_CACHE_SIZE;
+
+  // the budget is split between near and far code in the same ratio as the default sizes
+  const u32 budget_mb = g_settings.cpu_recompiler_code_buffer_size;
+  const u32 default_mb = (RECOMPILER_CODE_CACHE_SIZE + RECOMPILER_FAR_CODE_CACHE_SIZE) / (1024 * 1024);
+  if (budget_mb == 0 || budget_mb >= default_mb)
+    return;
+
+  const u32 budget = std::max(budget_mb * 1024 * 1024, RECOMPILER_MIN_CODE_BUFFER_SIZE);
+  *far_code_size = Common::AlignDownPow2(
+    static_cast<u32>((static_cast<u64>(budget) * RECOMPILER_FAR_CODE_CACHE_SIZE) /
+                     (RECOMPILER_CODE_CACHE_SIZE + RECOMPILER_FAR_CODE_CACHE_SIZE)),
+    static_cast<u32>(HOST_PAGE_SIZE));
+  *code_size = budget - *far_code_size;
+}
+
+static bool AllocateCodeBuffer()
+{
+  u32 code_size, far_code_size;
+  GetCodeBufferSize(&code_size, &far_code_size);
+  if (code_size != RECOMPILER_CODE_CACHE_SIZE)
+    Log_InfoPrintf("Using %u KB of near and %u KB of far code space", code_size / 1024, far_code_size / 1024);
+
+#ifdef USE_STATIC_CODE_BUFFER
+  // pages of the static buffer past the budget are never touched, so they don't take up any memory
+  if (s_code_buffer.Initialize(s_code_storage, code_size + far_code_size, far_code_size, RECOMPILER_GUARD_SIZE))
+    return true;
+#endif
+
+  return s_code_buffer.Allocate(code_size, far_code_size, g_settings.use_huge_pages);
+}
+
+#endif
+
+/// Leaves the code buffer unprotected for the scope when blocks are linked, so that unlinking several blocks only
+/// toggles the protection once.
+class ScopedUnlinkWriteUnprotect
+{
+public:
+  ScopedUnlinkWriteUnprotect() : m_active(g_settings.IsUsingRecompiler() && g_settings.cpu_recompiler_block_linking)
+  {
+    if (m_active)
+      JitCodeBuffer::WriteProtect(false);
+  }
+
+  ~ScopedUnlinkWriteUnprotect()
+  {
+    if (m_active)
+      JitCodeBuffer::WriteProtect(true);
+  }
+
+private:
+  bool m_active;
+};
+
 void Initialize()
 {
   Assert(s_blocks.empty());
@@ -240,16 +365,8 @@ void Initialize()
 #ifdef WITH_RECOMPILER
   if (g_settings.IsUsingRecompiler())
   {
-#ifdef USE_STATIC_CODE_BUFFER
-    const bool has_buffer = s_code_buffer.Initialize(s_code_storage, sizeof(s_code_storage),
-                                                     RECOMPILER_FAR_CODE_CACHE_SIZE, RECOMPILER_GUARD_SIZE);
-#else
-    const bool has_buffer = false;
-#endif
-    if (!has_buffer && !s_code_buffer.Allocate(RECOMPILER_CODE_CACHE_SIZE, RECOMPILER_FAR_CODE_CACHE_SIZE))
-    {
+    if (!AllocateCodeBuffer())
       Panic("Failed to initialize code space");
-    }
 
     AllocateFastMap();
 
@@ -267,6 +384,7 @@ void ClearState()
   Bus::ClearRAMCodePageFlags();
   for (auto& it : m_ram_block_map)
     it.clear();
+  m_ram_code_subpage_bits.fill(0);
 
   for (const auto& it : s_blocks)
     delete it.second;
@@ -283,12 +401,32 @@ void Shutdown()
 {
   ClearState();
 #ifdef WITH_RECOMPILER
+  ClosePerfMap();
   ShutdownFastmem();
   FreeFastMap();
   s_code_buffer.Destroy();
+  s_fastmem_fault_pcs.clear();
 #endif
 }
 
+/// Fast-forwards through the iterations of an idle loop which would run before the next event. Iterations cost the
+/// same once the icache is warm, so skipping starts when two in a row took the same number of ticks. The last one
+/// still runs, so the event is reached at the same tick as it would be without skipping.
+static void SkipIdleLoop(CodeBlock* block, TickCount block_start_ticks)
+{
+  const TickCount ticks = g_state.pending_ticks - block_start_ticks;
+  if (g_state.regs.pc != block->GetPC() || ticks != block->idle_loop_ticks)
+  {
+    // exited the loop or took an exception, or the first iteration
+    block->idle_loop_ticks = (g_state.regs.pc == block->GetPC()) ? ticks : 0;
+    return;
+  }
+
+  const TickCount remaining_ticks = g_state.downcount - g_state.pending_ticks;
+  if (ticks > 0 && remaining_ticks > ticks)
+    g_state.pending_ticks += ((remaining_ticks - 1) / ticks) * ticks;
+}
+
 template<PGXPMode pgxp_mode>
 static void ExecuteImpl()
 {
@@ -320,6 +458,13 @@ static void ExecuteImpl()
 
     reexecute_block:
       Assert(!(HasPendingInterrupt()));
+      if (block->has_breakpoint && CheckBlockBreakpoint())
+        break;
+
+      const TickCount block_start_ticks = g_state.pending_ticks;
+
+      if (block->profile)
+        ProfileBlockEntry(block->profile);
 
 #if 0
       const u32 tick = TimingEvents::GetGlobalTickCounter() + CPU::GetPendingTicks();
@@ -331,11 +476,14 @@ static void ExecuteImpl()
       LogCurrentState();
 #endif
 
-      if (g_settings.cpu_recompiler_icache)
+      if (g_settings.cpu_recompiler_icache && (block->icache_line_count > 0 || block->uncached_fetch_ticks > 0))
         CheckAndUpdateICacheTags(block->icache_line_count, block->uncached_fetch_ticks);
 
       InterpretCachedBlock<pgxp_mode>(*block);
 
+      if (block->is_idle_loop && g_settings.cpu_idle_loop_skipping)
+        SkipIdleLoop(block, block_start_ticks);
+
       if (g_state.pending_ticks >= g_state.downcount)
         break;
       else if (!USE_BLOCK_LINKING)
@@ -391,6 +539,12 @@ static void ExecuteImpl()
 
 void Execute()
 {
+  if (s_breakpoints_changed)
+  {
+    s_breakpoints_changed = false;
+    Flush();
+  }
+
   if (g_settings.gpu_pgxp_enable)
   {
     if (g_settings.gpu_pgxp_cpu)
@@ -408,18 +562,26 @@ void Execute()
 
 void CompileDispatcher()
 {
+  UpdatePerfMap();
   s_code_buffer.WriteProtect(false);
 
   {
+    const u8* start = s_code_buffer.GetFreeCodePointer();
     Recompiler::CodeGenerator cg(&s_code_buffer);
     s_asm_dispatcher = cg.CompileDispatcher();
+    WritePerfMapEntry(start, static_cast<u32>(s_code_buffer.GetFreeCodePointer() - start), "ASMDispatcher");
   }
   {
+    const u8* start = s_code_buffer.GetFreeCodePointer();
     Recompiler::CodeGenerator cg(&s_code_buffer);
     s_single_block_asm_dispatcher = cg.CompileSingleBlockDispatcher();
+    WritePerfMapEntry(start, static_cast<u32>(s_code_buffer.GetFreeCodePointer() - start), "SingleBlockASMDispatcher");
   }
 
   s_code_buffer.WriteProtect(true);
+
+  // blocks go after the dispatchers, so evicting segments never touches them
+  s_code_buffer.InitializeSegments(RECOMPILER_CODE_CACHE_SEGMENTS);
 }
 
 FastMapTable* GetFastMapPointer()
@@ -429,6 +591,12 @@ FastMapTable* GetFastMapPointer()
 
 void ExecuteRecompiler()
 {
+  if (s_breakpoints_changed)
+  {
+    s_breakpoints_changed = false;
+    Flush();
+  }
+
   g_using_interpreter = false;
   g_state.frame_done = false;
 
@@ -476,16 +644,8 @@ void Reinitialize()
 
   if (g_settings.IsUsingRecompiler())
   {
-
-#ifdef USE_STATIC_CODE_BUFFER
-    if (!s_code_buffer.Initialize(s_code_storage, sizeof(s_code_storage), RECOMPILER_FAR_CODE_CACHE_SIZE,
-                                  RECOMPILER_GUARD_SIZE))
-#else
-    if (!s_code_buffer.Allocate(RECOMPILER_CODE_CACHE_SIZE, RECOMPILER_FAR_CODE_CACHE_SIZE))
-#endif
-    {
+    if (!AllocateCodeBuffer())
       Panic("Failed to initialize code space");
-    }
 
     if (g_settings.IsUsingFastmem() && !InitializeFastmem())
       Panic("Failed to initialize fastmem");
@@ -495,6 +655,15 @@ void Reinitialize()
     ResetFastMap();
   }
 #endif
+
+  // breakpoints the interpreter had to handle may be fine in the code cache, or the other way around
+  UpdateDebugDispatcherFlag();
+}
+
+void OnBreakpointsChanged()
+{
+  s_breakpoints_changed = true;
+  ForceDispatcherExit();
 }
 
 void Flush()
@@ -506,6 +675,151 @@ void Flush()
 #endif
 }
 
+static std::string GetBlockCachePath(const std::string_view& serial)
+{
+  const std::string sanitized_serial(Path::SanitizeFileName(serial));
+  return Path::Combine(EmuFolders::Cache, fmt::format("{}.blockcache", sanitized_serial));
+}
+
+/// Returns true if there is enough space in the code buffer to precompile another block without forcing a flush.
+static bool HasSpaceForPrecompiledBlock(u32 instruction_count)
+{
+#ifdef WITH_RECOMPILER
+  if (g_settings.IsUsingRecompiler())
+  {
+    // leave half of the segments for blocks which actually get compiled at runtime
+    const u32 current_segment = s_code_buffer.GetCurrentSegment();
+    const u32 last_segment = (s_code_buffer.GetSegmentCount() / 2) - 1;
+    return (current_segment < last_segment ||
+            (current_segment == last_segment &&
+             s_code_buffer.GetFreeCodeSpace() >= (instruction_count * Recompiler::MAX_NEAR_HOST_BYTES_PER_INSTRUCTION) &&
+             s_code_buffer.GetFreeFarCodeSpace() >=
+               (instruction_count * Recompiler::MAX_FAR_HOST_BYTES_PER_INSTRUCTION)));
+  }
+#endif
+
+  return true;
+}
+
+void LoadBlockCache(const std::string_view& serial)
+{
+  if (!g_settings.IsUsingCodeCache() || !g_settings.cpu_recompiler_block_cache || serial.empty())
+    return;
+
+  const std::string filename(GetBlockCachePath(serial));
+  std::unique_ptr<ByteStream> stream = ByteStream::OpenMappedFile(filename.c_str());
+  if (!stream)
+    return;
+
+  u32 signature, version, block_count;
+  if (!stream->ReadU32(&signature) || !stream->ReadU32(&version) || !stream->ReadU32(&block_count) ||
+      signature != BLOCK_CACHE_SIGNATURE || version != BLOCK_CACHE_VERSION)
+  {
+    Log_WarningPrintf("Block cache '%s' is corrupted or out of date, ignoring.", filename.c_str());
+    return;
+  }
+
+  Common::Timer timer;
+  std::vector<u32> instructions;
+  u32 precompiled_count = 0;
+  for (u32 i = 0; i < block_count; i++)
+  {
+    CodeBlockKey key;
+    u32 instruction_count;
+    if (!stream->ReadU32(&key.bits) || !stream->ReadU32(&instruction_count) || instruction_count == 0 ||
+        instruction_count > BLOCK_CACHE_MAX_INSTRUCTIONS_PER_BLOCK)
+    {
+      Log_WarningPrintf("Block cache '%s' is corrupted.", filename.c_str());
+      break;
+    }
+
+    instructions.resize(instruction_count);
+    if (!stream->Read2(instructions.data(), instruction_count * sizeof(u32)))
+    {
+      Log_WarningPrintf("Block cache '%s' is truncated.", filename.c_str());
+      break;
+    }
+
+    if (s_blocks.find(key.bits) != s_blocks.end())
+      continue;
+
+    if (!HasSpaceForPrecompiledBlock(instruction_count))
+    {
+      Log_WarningPrintf("Not enough code space to precompile remaining %u cached blocks.", block_count - i);
+      break;
+    }
+
+    CodeBlock* block = new CodeBlock(key);
+    block->recompile_frame_number = System::GetFrameNumber();
+    block->execution_count = g_settings.cpu_recompiler_hot_block_threshold;
+    if (!CompileBlock(block, instructions.data(), instruction_count))
+    {
+      delete block;
+      continue;
+    }
+
+    // The contents of memory haven't been checked yet, so leave the block invalidated. The first execution goes
+    // through RevalidateBlock(), which either re-enables the block or recompiles it from the current contents.
+    block->invalidated = true;
+    s_blocks.emplace(key.bits, block);
+#ifdef WITH_RECOMPILER
+    AddBlockToHostCodeMap(block);
+#endif
+    precompiled_count++;
+  }
+
+  Log_InfoPrintf("Precompiled %u of %u cached blocks for '%.*s' in %.2f ms", precompiled_count, block_count,
+                 static_cast<int>(serial.size()), serial.data(), timer.GetTimeMilliseconds());
+}
+
+void SaveBlockCache(const std::string_view& serial)
+{
+  if (!g_settings.IsUsingCodeCache() || !g_settings.cpu_recompiler_block_cache || serial.empty())
+    return;
+
+  const u32 block_count = static_cast<u32>(
+    std::count_if(s_blocks.begin(), s_blocks.end(), [](const BlockMap::value_type& it) { return it.second != nullptr; }));
+  if (block_count == 0)
+    return;
+
+  const std::string filename(GetBlockCachePath(serial));
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(filename.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
+                                             BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
+  {
+    Log_ErrorPrintf("Failed to open block cache '%s' for writing", filename.c_str());
+    return;
+  }
+
+  bool result = stream->WriteU32(BLOCK_CACHE_SIGNATURE);
+  result &= stream->WriteU32(BLOCK_CACHE_VERSION);
+  result &= stream->WriteU32(block_count);
+
+  // Invalidated blocks are written too, the instructions they were last compiled from are still a good guess.
+  for (const auto& it : s_blocks)
+  {
+    const CodeBlock* block = it.second;
+    if (!block)
+      continue;
+
+    result &= stream->WriteU32(block->key.bits);
+    result &= stream->WriteU32(static_cast<u32>(block->instructions.size()));
+    for (const CodeBlockInstruction& cbi : block->instructions)
+      result &= stream->WriteU32(cbi.instruction.bits);
+  }
+
+  if (!result)
+  {
+    Log_ErrorPrintf("Failed to write block cache '%s'", filename.c_str());
+    stream->Discard();
+    return;
+  }
+
+  stream->Commit();
+  Log_InfoPrintf("Wrote %u blocks to block cache '%s'", block_count, filename.c_str());
+}
+
 void LogCurrentState()
 {
   const auto& regs = g_state.regs;
@@ -537,6 +851,28 @@ static void FallbackExistingBlockToInterpreter(CodeBlock* block)
   delete block;
 }
 
+/// Returns false if the per-frame compile budget has been used up, in which case the block should be interpreted
+/// this time around, and compiled on a later frame. This spreads out bursts of new code over several frames.
+static bool ConsumeCompileBudget()
+{
+  const u32 budget = g_settings.cpu_recompiler_compile_budget;
+  if (budget == 0 || !g_settings.IsUsingRecompiler())
+    return true;
+
+  const u32 frame_number = System::GetFrameNumber();
+  if (frame_number != s_compile_budget_frame_number)
+  {
+    s_compile_budget_frame_number = frame_number;
+    s_compile_budget_used = 0;
+  }
+
+  if (s_compile_budget_used >= budget)
+    return false;
+
+  s_compile_budget_used++;
+  return true;
+}
+
 CodeBlock* LookupBlock(CodeBlockKey key)
 {
   BlockMap::iterator iter = s_blocks.find(key.bits);
@@ -554,6 +890,10 @@ CodeBlock* LookupBlock(CodeBlockKey key)
       return nullptr;
   }
 
+  // with tiering, the budget applies when blocks are promoted to host code instead
+  if (g_settings.cpu_recompiler_hot_block_threshold == 0 && !ConsumeCompileBudget())
+    return nullptr;
+
   CodeBlock* block = new CodeBlock(key);
   block->recompile_frame_number = System::GetFrameNumber();
 
@@ -563,7 +903,7 @@ CodeBlock* LookupBlock(CodeBlockKey key)
     AddBlockToPageMap(block);
 
 #ifdef WITH_RECOMPILER
-    SetFastMap(block->GetPC(), block->host_code);
+    SetFastMap(block->GetPC(), GetFastMapFunction(block));
     AddBlockToHostCodeMap(block);
 #endif
   }
@@ -596,7 +936,7 @@ bool RevalidateBlock(CodeBlock* block)
   block->invalidated = false;
   AddBlockToPageMap(block);
 #ifdef WITH_RECOMPILER
-  SetFastMap(block->GetPC(), block->host_code);
+  SetFastMap(block->GetPC(), GetFastMapFunction(block));
 #endif
   return true;
 
@@ -645,7 +985,7 @@ recompile:
 
 #ifdef WITH_RECOMPILER
   // re-add to page map again
-  SetFastMap(block->GetPC(), block->host_code);
+  SetFastMap(block->GetPC(), GetFastMapFunction(block));
   AddBlockToHostCodeMap(block);
 #endif
 
@@ -657,11 +997,276 @@ recompile:
   return true;
 }
 
-bool CompileBlock(CodeBlock* block)
+/// Returns true if the branch is always taken to a constant target, i.e. decoding can continue at the target.
+static bool IsTraceableBranchInstruction(const Instruction& instruction)
+{
+  switch (instruction.op)
+  {
+    case InstructionOp::j:
+    case InstructionOp::jal:
+      return true;
+
+    case InstructionOp::beq:
+      return (instruction.i.rs == Reg::zero && instruction.i.rt == Reg::zero);
+
+    case InstructionOp::b:
+      // bgez/bgezal zero
+      return ((static_cast<u8>(instruction.i.rt.GetValue()) & u8(1)) != 0 && instruction.i.rs == Reg::zero);
+
+    default:
+      return false;
+  }
+}
+
+/// Returns true if decoding can continue at the target of the branch before the delay slot at the end of the block.
+static bool CanTraceBranch(const CodeBlock* block, u32 traced_branch_count, u32 max_page_index)
+{
+  if (traced_branch_count == MAX_TRACED_BRANCHES_PER_BLOCK || block->instructions.size() < 2)
+    return false;
+
+  const CodeBlockInstruction& branch_cbi = block->instructions[block->instructions.size() - 2];
+  if (branch_cbi.is_branch_delay_slot || !IsTraceableBranchInstruction(branch_cbi.instruction))
+    return false;
+
+  // the page map tracks a contiguous range starting at the block's pc, so don't go backwards or skip pages
+  const u32 target = GetDirectBranchTarget(branch_cbi.instruction, branch_cbi.pc);
+  const u32 target_physical = target & PHYSICAL_MEMORY_ADDRESS_MASK;
+  if (target_physical < block->key.GetPCPhysicalAddress() || (target_physical / HOST_PAGE_SIZE) > (max_page_index + 1))
+    return false;
+
+  // loops have to go back through the dispatcher so that events get run
+  for (const CodeBlockInstruction& cbi : block->instructions)
+  {
+    if (cbi.pc == target)
+      return false;
+  }
+
+  return true;
+}
+
+/// Returns true if the instruction only writes a GPR from other GPRs/immediates, without side effects or exceptions.
+static bool IsSimpleALUInstruction(const Instruction& instruction)
+{
+  return (instruction.bits != 0 && GetCachedInterpreterHandler(instruction) != nullptr);
+}
+
+static Reg GetSimpleALUDestinationRegister(const Instruction& instruction)
+{
+  return (instruction.op == InstructionOp::funct) ? instruction.r.rd.GetValue() : instruction.i.rt.GetValue();
+}
+
+static bool DoesSimpleALUInstructionReadRegister(const Instruction& instruction, Reg reg)
+{
+  // conservative, not every funct reads rs, and lui doesn't read it either
+  if (instruction.op == InstructionOp::funct)
+    return (instruction.r.rs == reg || instruction.r.rt == reg);
+  else
+    return (instruction.i.rs == reg);
+}
+
+/// Flags ALU instructions whose result is discarded, or overwritten before anything can observe it.
+static void MarkDeadWrites(CodeBlock* block)
+{
+  const size_t count = block->instructions.size();
+  for (size_t i = 0; i < count; i++)
+  {
+    CodeBlockInstruction& cbi = block->instructions[i];
+    if (!IsSimpleALUInstruction(cbi.instruction))
+      continue;
+
+    const Reg rd = GetSimpleALUDestinationRegister(cbi.instruction);
+    if (rd == Reg::zero)
+    {
+      cbi.is_dead_write = true;
+      continue;
+    }
+
+    // anything which can trap or leave the block can observe the register, so only look through other ALU ops
+    for (size_t j = i + 1; j < count; j++)
+    {
+      const Instruction& next = block->instructions[j].instruction;
+      if (!IsSimpleALUInstruction(next) || DoesSimpleALUInstructionReadRegister(next, rd))
+        break;
+
+      if (GetSimpleALUDestinationRegister(next) == rd)
+      {
+        cbi.is_dead_write = true;
+        break;
+      }
+    }
+  }
+}
+
+/// Returns true if a load from this address can't return anything different until an event runs or the CPU stores.
+static bool IsIdleLoopLoadAddress(VirtualMemoryAddress address)
+{
+  // KSEG2 is the cache control registers
+  if (address >= 0xC0000000u)
+    return false;
+
+  // timers, the GPU etc. are synchronized when read, so only RAM, the BIOS and the interrupt controller are safe
+  const PhysicalMemoryAddress phys_addr = address & PHYSICAL_MEMORY_ADDRESS_MASK;
+  return (phys_addr < Bus::RAM_MIRROR_END ||
+          (phys_addr >= Bus::BIOS_BASE && phys_addr < (Bus::BIOS_BASE + Bus::BIOS_SIZE)) ||
+          (phys_addr >= Bus::INTERRUPT_CONTROLLER_BASE && phys_addr < (Bus::INTERRUPT_CONTROLLER_BASE + 8)));
+}
+
+/// Flags blocks which branch back to themselves, and would compute exactly the same thing on every iteration until an
+/// event changes what they read, e.g. polling a variable set by an interrupt handler or I_STAT. Only GPRs are
+/// touched, and no register which is written is read before it's written, so each iteration starts from the same
+/// state. Load addresses have to be constant within the block, so they can be checked here.
+static void MarkIdleLoop(CodeBlock* block)
+{
+  block->is_idle_loop = false;
+  block->idle_loop_ticks = 0;
+
+  const size_t count = block->instructions.size();
+  if (count < 2 || count > MAX_IDLE_LOOP_INSTRUCTIONS || block->contains_double_branches)
+    return;
+
+  const CodeBlockInstruction& branch_cbi = block->instructions[count - 2];
+  if (!branch_cbi.is_branch_instruction || !branch_cbi.is_direct_branch_instruction || branch_cbi.is_traced_branch ||
+      GetDirectBranchTarget(branch_cbi.instruction, branch_cbi.pc) != block->GetPC())
+  {
+    return;
+  }
+
+  u32 written_regs = 0;
+  u32 exposed_regs = 0;
+  u32 known_regs = 1u << static_cast<u8>(Reg::zero);
+  std::array<u32, static_cast<u8>(Reg::count)> known_values = {};
+  Reg last_load_reg = Reg::zero;
+
+  const auto read = [&written_regs, &exposed_regs, &last_load_reg](Reg reg) {
+    // the previous load hasn't landed yet, so this would see the value from before it
+    if (reg != Reg::zero && reg == last_load_reg)
+      return false;
+
+    const u32 bit = 1u << static_cast<u8>(reg);
+    if (!(written_regs & bit))
+      exposed_regs |= bit;
+    return true;
+  };
+  const auto write = [&written_regs, &known_regs](Reg reg) {
+    written_regs |= 1u << static_cast<u8>(reg);
+    known_regs &= ~(1u << static_cast<u8>(reg));
+  };
+  const auto is_known = [&known_regs](Reg reg) { return (known_regs & (1u << static_cast<u8>(reg))) != 0; };
+
+  for (const CodeBlockInstruction& cbi : block->instructions)
+  {
+    const Instruction& inst = cbi.instruction;
+    Reg load_reg = Reg::zero;
+    if (inst.bits == 0)
+    {
+      // nop
+    }
+    else if (&cbi == &branch_cbi)
+    {
+      switch (inst.op)
+      {
+        case InstructionOp::j:
+          break;
+
+        case InstructionOp::beq:
+        case InstructionOp::bne:
+          if (!read(inst.i.rs) || !read(inst.i.rt))
+            return;
+          break;
+
+        case InstructionOp::blez:
+        case InstructionOp::bgtz:
+          if (!read(inst.i.rs))
+            return;
+          break;
+
+        case InstructionOp::b:
+        {
+          // bltzal/bgezal write ra
+          if ((static_cast<u8>(inst.i.rt.GetValue()) & 0x1E) == 0x10 || !read(inst.i.rs))
+            return;
+        }
+        break;
+
+        default:
+          return;
+      }
+    }
+    else if (IsSimpleALUInstruction(inst))
+    {
+      const Reg rd = GetSimpleALUDestinationRegister(inst);
+      const bool is_funct = (inst.op == InstructionOp::funct);
+      if (is_funct ? (!read(inst.r.rs) || !read(inst.r.rt)) : (inst.op != InstructionOp::lui && !read(inst.i.rs)))
+        return;
+
+      // constants for addresses are usually built with lui, and then ori/addiu or an offset
+      std::optional<u32> value;
+      if (inst.op == InstructionOp::lui)
+        value = inst.i.imm_zext32() << 16;
+      else if (inst.op == InstructionOp::ori && is_known(inst.i.rs))
+        value = known_values[static_cast<u8>(inst.i.rs.GetValue())] | inst.i.imm_zext32();
+      else if (inst.op == InstructionOp::addiu && is_known(inst.i.rs))
+        value = known_values[static_cast<u8>(inst.i.rs.GetValue())] + inst.i.imm_sext32();
+
+      write(rd);
+      if (value.has_value() && rd != Reg::zero)
+      {
+        known_regs |= 1u << static_cast<u8>(rd);
+        known_values[static_cast<u8>(rd)] = value.value();
+      }
+    }
+    else
+    {
+      u32 size;
+      switch (inst.op)
+      {
+        case InstructionOp::lb:
+        case InstructionOp::lbu:
+          size = 1;
+          break;
+        case InstructionOp::lh:
+        case InstructionOp::lhu:
+          size = 2;
+          break;
+        case InstructionOp::lw:
+          size = 4;
+          break;
+        default:
+          return;
+      }
+
+      if (!is_known(inst.i.rs) || !read(inst.i.rs))
+        return;
+
+      const VirtualMemoryAddress address = known_values[static_cast<u8>(inst.i.rs.GetValue())] + inst.i.imm_sext32();
+      if ((address % size) != 0 || !IsIdleLoopLoadAddress(address))
+        return;
+
+      write(inst.i.rt);
+      load_reg = inst.i.rt;
+    }
+
+    last_load_reg = load_reg;
+  }
+
+  // anything read before it's written has to come from outside the loop, otherwise iterations could differ
+  if ((written_regs & exposed_regs & ~1u) != 0)
+    return;
+
+  Log_DevPrintf("Idle loop at %08X, %zu instructions", block->GetPC(), count);
+  block->is_idle_loop = true;
+}
+
+bool CompileBlock(CodeBlock* block, const u32* cached_instructions, u32 cached_instruction_count)
 {
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::BlockCompile);
+  s_compiled_block_count++;
   u32 pc = block->GetPC();
   bool is_branch_delay_slot = false;
   bool is_load_delay_slot = false;
+  u32 cached_instruction_index = 0;
+  u32 traced_branch_count = 0;
+  u32 max_page_index = block->GetStartPageIndex();
 
 #if 0
   if (pc == 0x0005aa90)
@@ -672,14 +1277,31 @@ bool CompileBlock(CodeBlock* block)
   block->uncached_fetch_ticks = 0;
   block->contains_double_branches = false;
   block->contains_loadstore_instructions = false;
+  block->end_page_index = max_page_index;
+  block->profile = s_block_profiling ? &s_block_profiles[block->key.bits] : nullptr;
 
   u32 last_cache_line = ICACHE_LINES;
 
   for (;;)
   {
+    // breakpoints have to start a block, so they're checked before the instruction runs
+    if (HasAnyBreakpoints() && !block->instructions.empty() && !is_branch_delay_slot && HasBreakpointAtAddress(pc))
+      break;
+
     CodeBlockInstruction cbi = {};
-    if (!SafeReadInstruction(pc, &cbi.instruction.bits) || !IsInvalidInstruction(cbi.instruction))
+    if (cached_instructions)
+    {
+      if (cached_instruction_index == cached_instruction_count)
+        break;
+
+      cbi.instruction.bits = cached_instructions[cached_instruction_index++];
+      if (!IsInvalidInstruction(cbi.instruction))
+        break;
+    }
+    else if (!SafeReadInstruction(pc, &cbi.instruction.bits) || !IsInvalidInstruction(cbi.instruction))
+    {
       break;
+    }
 
     cbi.pc = pc;
     cbi.is_branch_delay_slot = is_branch_delay_slot;
@@ -690,22 +1312,31 @@ bool CompileBlock(CodeBlock* block)
     cbi.is_load_instruction = IsMemoryLoadInstruction(cbi.instruction);
     cbi.is_store_instruction = IsMemoryStoreInstruction(cbi.instruction);
     cbi.has_load_delay = InstructionHasLoadDelay(cbi.instruction);
-    cbi.can_trap = CanInstructionTrap(cbi.instruction, InUserMode());
+    cbi.can_trap = CanInstructionTrap(cbi.instruction, block->key.user_mode);
     cbi.is_direct_branch_instruction = IsDirectBranchInstruction(cbi.instruction);
 
     if (g_settings.cpu_recompiler_icache)
     {
-      const u32 icache_line = GetICacheLine(pc);
-      if (icache_line != last_cache_line)
+      // Only cached fetches need the tags checked, uncached ones (KSEG1) are a constant number of ticks. Lines which
+      // don't cost anything to fill aren't worth tracking either.
+      if (!IsCachedAddress(pc))
+      {
+        block->uncached_fetch_ticks += GetInstructionReadTicks(pc);
+      }
+      else if (GetICacheFillTicks(pc) > 0)
       {
-        block->icache_line_count++;
-        last_cache_line = icache_line;
+        const u32 icache_line = GetICacheLine(pc);
+        if (icache_line != last_cache_line)
+        {
+          block->icache_line_count++;
+          last_cache_line = icache_line;
+        }
       }
-      block->uncached_fetch_ticks += GetInstructionReadTicks(pc);
     }
 
     block->contains_loadstore_instructions |= cbi.is_load_instruction;
     block->contains_loadstore_instructions |= cbi.is_store_instruction;
+    max_page_index = std::max(max_page_index, static_cast<u32>((cbi.pc & PHYSICAL_MEMORY_ADDRESS_MASK) / HOST_PAGE_SIZE));
 
     pc += sizeof(cbi.instruction.bits);
 
@@ -733,8 +1364,18 @@ bool CompileBlock(CodeBlock* block)
 
     // if we're in a branch delay slot, the block is now done
     // except if this is a branch in a branch delay slot, then we grab the one after that, and so on...
+    // unconditional branches with a constant target are followed, so the block continues at the target.
     if (is_branch_delay_slot && !cbi.is_branch_instruction)
-      break;
+    {
+      if (IsExitBlockInstruction(cbi.instruction) || !CanTraceBranch(block, traced_branch_count, max_page_index))
+        break;
+
+      CodeBlockInstruction& branch_cbi = block->instructions[block->instructions.size() - 2];
+      branch_cbi.is_traced_branch = true;
+      pc = GetDirectBranchTarget(branch_cbi.instruction, branch_cbi.pc);
+      traced_branch_count++;
+      Log_DevPrintf("Tracing branch at %08X -> %08X in block %08X", branch_cbi.pc, pc, block->GetPC());
+    }
 
     // if this is a branch, we grab the next instruction (delay slot), and then exit
     is_branch_delay_slot = cbi.is_branch_instruction;
@@ -749,7 +1390,23 @@ bool CompileBlock(CodeBlock* block)
 
   if (!block->instructions.empty())
   {
+    // if we couldn't decode anything at the target of a traced branch, it has to exit the block again
+    if (block->instructions.size() >= 2 && block->instructions.back().is_branch_delay_slot)
+      block->instructions[block->instructions.size() - 2].is_traced_branch = false;
+
     block->instructions.back().is_last_instruction = true;
+    block->end_page_index = max_page_index;
+    block->has_breakpoint = HasAnyBreakpoints() && HasBreakpointAtAddress(block->GetPC());
+    MarkDeadWrites(block);
+    MarkIdleLoop(block);
+
+    block->interpreter_handlers.clear();
+    block->interpreter_handlers.reserve(block->instructions.size());
+    for (const CodeBlockInstruction& cbi : block->instructions)
+    {
+      block->interpreter_handlers.push_back(cbi.is_dead_write ? GetCachedInterpreterHandler(Instruction{0}) :
+                                                                GetCachedInterpreterHandler(cbi.instruction));
+    }
 
 #ifdef _DEBUG
     SmallString disasm;
@@ -768,29 +1425,30 @@ bool CompileBlock(CodeBlock* block)
     return false;
   }
 
+  // cached instructions which don't decode to the same block are useless
+  if (cached_instructions && cached_instruction_index != cached_instruction_count)
+    return false;
+
 #ifdef WITH_RECOMPILER
   if (g_settings.IsUsingRecompiler())
   {
+    // Cold blocks stay in the cached interpreter until they've executed enough times.
+    if (!IsBlockHot(block))
+    {
+      block->host_code = nullptr;
+      block->host_code_size = 0;
+      return true;
+    }
+
     // Ensure we're not going to run out of space while compiling this block.
-    if (s_code_buffer.GetFreeCodeSpace() <
-          (block->instructions.size() * Recompiler::MAX_NEAR_HOST_BYTES_PER_INSTRUCTION) ||
-        s_code_buffer.GetFreeFarCodeSpace() <
-          (block->instructions.size() * Recompiler::MAX_FAR_HOST_BYTES_PER_INSTRUCTION))
+    if (!MakeSpaceForBlockHostCode(block))
     {
       Log_WarningPrintf("Out of code space, flushing all blocks.");
       Flush();
     }
 
-    s_code_buffer.WriteProtect(false);
-    Recompiler::CodeGenerator codegen(&s_code_buffer);
-    const bool compile_result = codegen.CompileBlock(block, &block->host_code, &block->host_code_size);
-    s_code_buffer.WriteProtect(true);
-
-    if (!compile_result)
-    {
-      Log_ErrorPrintf("Failed to compile host code for block at 0x%08X", block->key.GetPC());
+    if (!CompileBlockHostCode(block))
       return false;
-    }
   }
 #endif
 
@@ -799,15 +1457,204 @@ bool CompileBlock(CodeBlock* block)
 
 #ifdef WITH_RECOMPILER
 
+bool IsBlockHot(const CodeBlock* block)
+{
+  if (block->has_breakpoint)
+    return false;
+
+  // idle loops stay in the interpreter, linked host code would never come back to the dispatcher to skip them
+  if (block->is_idle_loop && g_settings.cpu_idle_loop_skipping)
+    return false;
+
+  return (block->execution_count >= g_settings.cpu_recompiler_hot_block_threshold);
+}
+
+bool HasSpaceForBlockHostCode(const CodeBlock* block)
+{
+  return (s_code_buffer.GetFreeCodeSpace() >=
+            (block->instructions.size() * Recompiler::MAX_NEAR_HOST_BYTES_PER_INSTRUCTION) &&
+          s_code_buffer.GetFreeFarCodeSpace() >=
+            (block->instructions.size() * Recompiler::MAX_FAR_HOST_BYTES_PER_INSTRUCTION));
+}
+
+void EvictBlockHostCode(CodeBlock* block)
+{
+  UnlinkBlock(block);
+  RemoveBlockFromHostCodeMap(block);
+  if (!block->invalidated)
+    SetFastMap(block->GetPC(), FastCompileBlockFunction);
+
+  block->host_code = nullptr;
+  block->host_code_size = 0;
+  block->loadstore_backpatch_info.clear();
+
+  // it's been compiled before, so compile it again as soon as it's executed
+  block->execution_count = std::max(block->execution_count, g_settings.cpu_recompiler_hot_block_threshold);
+}
+
+void EvictNextCodeSegment()
+{
+  Common::Timer timer;
+  const u32 segment = s_code_buffer.AdvanceSegment();
+  u32 evicted_count = 0;
+  ScopedUnlinkWriteUnprotect unprotect;
+  for (const auto& it : s_blocks)
+  {
+    CodeBlock* block = it.second;
+    if (block && block->host_code && block->host_code_segment == segment)
+    {
+      EvictBlockHostCode(block);
+      evicted_count++;
+    }
+  }
+
+  Log_PerfPrintf("Evicted %u blocks from code segment %u in %.2f ms", evicted_count, segment,
+                 timer.GetTimeMilliseconds());
+}
+
+bool MakeSpaceForBlockHostCode(const CodeBlock* block)
+{
+  if (HasSpaceForBlockHostCode(block))
+    return true;
+
+  if (s_code_buffer.GetSegmentCount() <= 1)
+    return false;
+
+  EvictNextCodeSegment();
+  return HasSpaceForBlockHostCode(block);
+}
+
+bool CompileBlockHostCode(CodeBlock* block)
+{
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::BlockCompile);
+  block->host_code_segment = s_code_buffer.GetCurrentSegment();
+  block->loadstore_backpatch_info.clear();
+
+  s_code_buffer.WriteProtect(false);
+  Recompiler::CodeGenerator codegen(&s_code_buffer);
+  const bool compile_result = codegen.CompileBlock(block, &block->host_code, &block->host_code_size);
+  s_code_buffer.WriteProtect(true);
+
+  if (!compile_result)
+  {
+    Log_ErrorPrintf("Failed to compile host code for block at 0x%08X", block->key.GetPC());
+    block->host_code = nullptr;
+    block->host_code_size = 0;
+    return false;
+  }
+
+  if (s_perf_map_file)
+  {
+    TinyString name;
+    name.Format("Block_%08X%s", block->key.GetPC(), block->key.user_mode ? "_User" : "");
+    WritePerfMapEntry(reinterpret_cast<const void*>(block->host_code), block->host_code_size, name);
+  }
+
+  return true;
+}
+
+bool PromoteBlock(CodeBlock* block, bool* flushed)
+{
+  if (!IsBlockHot(block))
+  {
+    block->execution_count++;
+    if (!IsBlockHot(block))
+      return false;
+  }
+
+  if (!ConsumeCompileBudget())
+    return false;
+
+  if (!MakeSpaceForBlockHostCode(block))
+  {
+    // this frees the block, so it'll be looked up again next time around
+    Log_WarningPrintf("Out of code space, flushing all blocks.");
+    Flush();
+    *flushed = true;
+    return false;
+  }
+
+  if (!CompileBlockHostCode(block))
+  {
+    // try again later, rather than on every execution
+    block->execution_count = 0;
+    return false;
+  }
+
+  Log_DebugPrintf("Promoted block 0x%08X to host code after %u executions", block->GetPC(), block->execution_count);
+  if (!block->invalidated)
+    SetFastMap(block->GetPC(), block->host_code);
+  AddBlockToHostCodeMap(block);
+  return true;
+}
+
+template<PGXPMode pgxp_mode>
+static void InterpretColdBlock(CodeBlock* block)
+{
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::Interpreter);
+  if (block->has_breakpoint && CheckBlockBreakpoint())
+    return;
+
+  if (block->profile)
+    ProfileBlockEntry(block->profile);
+
+  const TickCount block_start_ticks = g_state.pending_ticks;
+  if (g_settings.cpu_recompiler_icache && (block->icache_line_count > 0 || block->uncached_fetch_ticks > 0))
+    CheckAndUpdateICacheTags(block->icache_line_count, block->uncached_fetch_ticks);
+
+  InterpretCachedBlock<pgxp_mode>(*block);
+
+  if (block->is_idle_loop && g_settings.cpu_idle_loop_skipping)
+    SkipIdleLoop(block, block_start_ticks);
+}
+
 void FastCompileBlockFunction()
 {
-  CodeBlock* block = LookupBlock(GetNextBlockKey());
+  CodeBlock* block;
+  bool is_cold = false;
+  {
+    // compiling can evict or flush other blocks, which unlinks them, so it all shares one toggle. it has to be
+    // protected again before running anything in the code buffer.
+    JitCodeBuffer::ScopedWriteUnprotect unprotect;
+    block = LookupBlock(GetNextBlockKey());
+    if (block && !block->host_code)
+    {
+      // if promotion flushed the cache, the block is gone, so run this one uncached
+      bool flushed = false;
+      if (!PromoteBlock(block, &flushed))
+      {
+        if (flushed)
+          block = nullptr;
+        else
+          is_cold = true;
+      }
+    }
+  }
+
+  if (is_cold)
+  {
+    if (g_settings.gpu_pgxp_enable)
+    {
+      if (g_settings.gpu_pgxp_cpu)
+        InterpretColdBlock<PGXPMode::CPU>(block);
+      else
+        InterpretColdBlock<PGXPMode::Memory>(block);
+    }
+    else
+    {
+      InterpretColdBlock<PGXPMode::Disabled>(block);
+    }
+
+    return;
+  }
+
   if (block)
   {
     s_single_block_asm_dispatcher(block->host_code);
     return;
   }
 
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::Interpreter);
   if (g_settings.gpu_pgxp_enable)
   {
     if (g_settings.gpu_pgxp_cpu)
@@ -824,6 +1671,7 @@ void FastCompileBlockFunction()
 void InvalidCodeFunction()
 {
   Log_ErrorPrintf("Trying to execute invalid code at 0x%08X", g_state.regs.pc);
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::Interpreter);
   if (g_settings.gpu_pgxp_enable)
   {
     if (g_settings.gpu_pgxp_cpu)
@@ -880,16 +1728,87 @@ void InvalidateBlocksWithPageIndex(u32 page_index)
 {
   DebugAssert(page_index < Bus::RAM_8MB_CODE_PAGE_COUNT);
   auto& blocks = m_ram_block_map[page_index];
+  ScopedUnlinkWriteUnprotect unprotect;
   for (CodeBlock* block : blocks)
     InvalidateBlock(block, true);
 
   // Block will be re-added next execution.
   blocks.clear();
+  m_ram_code_subpage_bits[page_index] = 0;
   Bus::ClearRAMCodePage(page_index);
 }
 
+static u16 GetRAMAddressSubpageBit(u32 ram_address)
+{
+  return static_cast<u16>(1u << ((ram_address % HOST_PAGE_SIZE) / CODE_SUBPAGE_SIZE));
+}
+
+static u16 GetBlockSubpageBits(const CodeBlock* block, u32 page_index)
+{
+  u16 bits = 0;
+  for (const CodeBlockInstruction& cbi : block->instructions)
+  {
+    const u32 address = cbi.pc & PHYSICAL_MEMORY_ADDRESS_MASK;
+    if ((address / HOST_PAGE_SIZE) == page_index)
+      bits |= GetRAMAddressSubpageBit(address);
+  }
+
+  return bits;
+}
+
+static void UpdatePageSubpageBits(u32 page_index)
+{
+  u16 bits = 0;
+  for (const CodeBlock* block : m_ram_block_map[page_index])
+    bits |= GetBlockSubpageBits(block, page_index);
+
+  m_ram_code_subpage_bits[page_index] = bits;
+}
+
+bool IsCodeSubpageAddress(u32 ram_address)
+{
+  return (m_ram_code_subpage_bits[ram_address / HOST_PAGE_SIZE] & GetRAMAddressSubpageBit(ram_address)) != 0;
+}
+
+void InvalidateBlocksWithRAMAddress(u32 ram_address)
+{
+  const u32 page_index = ram_address / HOST_PAGE_SIZE;
+  const u16 subpage_bit = GetRAMAddressSubpageBit(ram_address);
+  DebugAssert(page_index < Bus::RAM_8MB_CODE_PAGE_COUNT);
+  if (!(m_ram_code_subpage_bits[page_index] & subpage_bit))
+  {
+    // data next to code, nothing to invalidate
+    return;
+  }
+
+  // only the blocks overlapping the written sub-page have to be checked again
+  auto& blocks = m_ram_block_map[page_index];
+  ScopedUnlinkWriteUnprotect unprotect;
+  u16 remaining_bits = 0;
+  for (auto iter = blocks.begin(); iter != blocks.end();)
+  {
+    CodeBlock* block = *iter;
+    const u16 block_bits = GetBlockSubpageBits(block, page_index);
+    if (block_bits & subpage_bit)
+    {
+      InvalidateBlock(block, true);
+      iter = blocks.erase(iter);
+    }
+    else
+    {
+      remaining_bits |= block_bits;
+      ++iter;
+    }
+  }
+
+  m_ram_code_subpage_bits[page_index] = remaining_bits;
+  if (blocks.empty())
+    Bus::ClearRAMCodePage(page_index);
+}
+
 void InvalidateAll()
 {
+  ScopedUnlinkWriteUnprotect unprotect;
   for (auto& it : s_blocks)
   {
     CodeBlock* block = it.second;
@@ -900,6 +1819,116 @@ void InvalidateAll()
   Bus::ClearRAMCodePageFlags();
   for (auto& it : m_ram_block_map)
     it.clear();
+  m_ram_code_subpage_bits.fill(0);
+}
+
+u32 GetCompiledBlockCount()
+{
+  return s_compiled_block_count;
+}
+
+void StartBlockProfile()
+{
+  if (s_block_profiling)
+    return;
+
+  Log_InfoPrintf("Starting block profile");
+  s_block_profiling = true;
+  s_last_block_profile = nullptr;
+  if (System::IsValid())
+    Flush();
+}
+
+bool StopBlockProfile(const char* path)
+{
+  if (!s_block_profiling)
+    return false;
+
+  struct Entry
+  {
+    u32 key;
+    const CodeBlockProfile* profile;
+  };
+  std::vector<Entry> entries;
+  entries.reserve(s_block_profiles.size());
+  for (const auto& it : s_block_profiles)
+  {
+    if (it.second.entry_count > 0)
+      entries.push_back(Entry{it.first, &it.second});
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& lhs, const Entry& rhs) { return lhs.profile->ticks > rhs.profile->ticks; });
+
+  bool result = false;
+  auto fp = FileSystem::OpenManagedCFile(path, "wb");
+  if (fp)
+  {
+    SmallString disasm;
+    std::fprintf(fp.get(), "pc,user_mode,entries,ticks,ticks_per_entry,instructions,fastmem_faults,disassembly\n");
+    for (const Entry& entry : entries)
+    {
+      CodeBlockKey key;
+      key.bits = entry.key;
+
+      // blocks which have since been flushed can't be disassembled
+      const BlockMap::const_iterator iter = s_blocks.find(entry.key);
+      const CodeBlock* block = (iter != s_blocks.end()) ? iter->second : nullptr;
+      u32 fastmem_faults = 0;
+      for (const auto& it : entry.profile->fastmem_faults)
+        fastmem_faults += it.second;
+
+      std::fprintf(fp.get(), "%08X,%u,%" PRIu64 ",%" PRIu64 ",%.2f,%u,%u,\"", key.GetPC(), key.user_mode ? 1u : 0u,
+                   entry.profile->entry_count, entry.profile->ticks,
+                   static_cast<double>(entry.profile->ticks) / static_cast<double>(entry.profile->entry_count),
+                   block ? static_cast<u32>(block->instructions.size()) : 0u, fastmem_faults);
+      if (block)
+      {
+        for (const CodeBlockInstruction& cbi : block->instructions)
+        {
+          CPU::DisassembleInstruction(&disasm, cbi.pc, cbi.instruction.bits);
+          std::fprintf(fp.get(), "%s%08X: %s", (&cbi == block->instructions.data()) ? "" : "; ", cbi.pc,
+                       disasm.GetCharArray());
+
+          const auto fault_iter = entry.profile->fastmem_faults.find(cbi.pc);
+          if (fault_iter != entry.profile->fastmem_faults.end())
+            std::fprintf(fp.get(), " [%u fastmem faults]", fault_iter->second);
+        }
+      }
+      std::fprintf(fp.get(), "\"\n");
+    }
+
+    result = (std::ferror(fp.get()) == 0);
+  }
+
+  if (result)
+    Log_InfoPrintf("Wrote profile for %zu blocks to '%s'", entries.size(), path);
+  else
+    Log_ErrorPrintf("Failed to write block profile to '%s'", path);
+
+  // the blocks reference the profiles, so get rid of them before discarding the results
+  s_block_profiling = false;
+  s_last_block_profile = nullptr;
+  if (System::IsValid())
+    Flush();
+  s_block_profiles.clear();
+  return result;
+}
+
+bool IsBlockProfileEnabled()
+{
+  return s_block_profiling;
+}
+
+void ProfileBlockEntry(CodeBlockProfile* profile)
+{
+  // interrupts and events between blocks get counted towards the previous block
+  const u32 ticks = TimingEvents::GetGlobalTickCounter() + static_cast<u32>(g_state.pending_ticks);
+  if (s_last_block_profile)
+    s_last_block_profile->ticks += ticks - s_last_block_profile_ticks;
+
+  s_last_block_profile = profile;
+  s_last_block_profile_ticks = ticks;
+  profile->entry_count++;
 }
 
 void RemoveReferencesToBlock(CodeBlock* block)
@@ -934,6 +1963,7 @@ void AddBlockToPageMap(CodeBlock* block)
   for (u32 page = start_page; page <= end_page; page++)
   {
     m_ram_block_map[page].push_back(block);
+    m_ram_code_subpage_bits[page] |= GetBlockSubpageBits(block, page);
     Bus::SetRAMCodePage(page);
   }
 }
@@ -951,6 +1981,7 @@ void RemoveBlockFromPageMap(CodeBlock* block)
     auto page_block_iter = std::find(page_blocks.begin(), page_blocks.end(), block);
     Assert(page_block_iter != page_blocks.end());
     page_blocks.erase(page_block_iter);
+    UpdatePageSubpageBits(page);
   }
 }
 
@@ -985,11 +2016,7 @@ void UnlinkBlock(CodeBlock* block)
   if (block->link_predecessors.empty() && block->link_successors.empty())
     return;
 
-#ifdef WITH_RECOMPILER
-  if (g_settings.IsUsingRecompiler() && g_settings.cpu_recompiler_block_linking)
-    s_code_buffer.WriteProtect(false);
-#endif
-
+  ScopedUnlinkWriteUnprotect unprotect;
   for (CodeBlock::LinkInfo& li : block->link_predecessors)
   {
     auto iter = std::find_if(li.block->link_successors.begin(), li.block->link_successors.end(),
@@ -1029,18 +2056,13 @@ void UnlinkBlock(CodeBlock* block)
     li.block->link_predecessors.erase(iter);
   }
   block->link_successors.clear();
-
-#ifdef WITH_RECOMPILER
-  if (g_settings.IsUsingRecompiler() && g_settings.cpu_recompiler_block_linking)
-    s_code_buffer.WriteProtect(true);
-#endif
 }
 
 #ifdef WITH_RECOMPILER
 
 void AddBlockToHostCodeMap(CodeBlock* block)
 {
-  if (!g_settings.IsUsingRecompiler())
+  if (!g_settings.IsUsingRecompiler() || !block->host_code)
     return;
 
   auto ir = s_host_code_map.emplace(block->host_code, block);
@@ -1049,7 +2071,7 @@ void AddBlockToHostCodeMap(CodeBlock* block)
 
 void RemoveBlockFromHostCodeMap(CodeBlock* block)
 {
-  if (!g_settings.IsUsingRecompiler())
+  if (!g_settings.IsUsingRecompiler() || !block->host_code)
     return;
 
   HostCodeMap::iterator hc_iter = s_host_code_map.find(block->host_code);
@@ -1057,6 +2079,53 @@ void RemoveBlockFromHostCodeMap(CodeBlock* block)
   s_host_code_map.erase(hc_iter);
 }
 
+CodeBlock::HostCodePointer GetFastMapFunction(const CodeBlock* block)
+{
+  // cold blocks go through the compile function, which counts executions and promotes them
+  return block->host_code ? block->host_code : FastCompileBlockFunction;
+}
+
+void UpdatePerfMap()
+{
+#ifdef __linux__
+  if (!g_settings.cpu_recompiler_perf_map)
+  {
+    ClosePerfMap();
+    return;
+  }
+
+  if (s_perf_map_file)
+    return;
+
+  // append, so code which was compiled before a reinitialize keeps its names
+  const std::string path = fmt::format("/tmp/perf-{}.map", getpid());
+  s_perf_map_file = std::fopen(path.c_str(), "a");
+  if (!s_perf_map_file)
+    Log_ErrorPrintf("Failed to open perf map '%s'", path.c_str());
+  else
+    Log_InfoPrintf("Writing perf map to '%s'", path.c_str());
+#endif
+}
+
+void ClosePerfMap()
+{
+  if (!s_perf_map_file)
+    return;
+
+  std::fclose(s_perf_map_file);
+  s_perf_map_file = nullptr;
+}
+
+void WritePerfMapEntry(const void* code, u32 code_size, const char* name)
+{
+  if (!s_perf_map_file || code_size == 0)
+    return;
+
+  // perf reads the map when the samples are reported, so entries have to be visible before we crash or exit
+  std::fprintf(s_perf_map_file, "%" PRIxPTR " %x %s\n", reinterpret_cast<uintptr_t>(code), code_size, name);
+  std::fflush(s_perf_map_file);
+}
+
 bool InitializeFastmem()
 {
   const CPUFastmemMode mode = g_settings.cpu_fastmem_mode;
@@ -1127,8 +2196,15 @@ Common::PageFaultHandler::HandlerResult MMapPageFaultHandler(void* exception_pc,
         const u32 code_page_index = Bus::GetRAMCodePageIndex(fastmem_address);
         if (Bus::IsRAMCodePage(code_page_index))
         {
-          if (++lbi.fault_count < CODE_WRITE_FAULT_THRESHOLD_FOR_SLOWMEM)
+          if (!IsCodeSubpageAddress(fastmem_address & Bus::g_ram_mask))
           {
+            // writing data next to code, the slowmem path will ignore it without invalidating the page
+            Log_DevPrintf("Backpatching data write at %p (%08X) address %p (%08X) next to code to slowmem",
+                          exception_pc, lbi.guest_pc, fault_address, fastmem_address);
+          }
+          else if (++lbi.fault_count < CODE_WRITE_FAULT_THRESHOLD_FOR_SLOWMEM)
+          {
+            RecordFastmemFault(block, lbi.guest_pc, false);
             InvalidateBlocksWithPageIndex(code_page_index);
             return Common::PageFaultHandler::HandlerResult::ContinueExecution;
           }
@@ -1140,7 +2216,12 @@ Common::PageFaultHandler::HandlerResult MMapPageFaultHandler(void* exception_pc,
         }
       }
 
-      // found it, do fixup
+      // found it, do fixup. writes which only faulted because of a watchpoint are fine in fastmem once it's removed,
+      // so they aren't remembered for the next compile.
+      const u32 page_index = Bus::GetRAMCodePageIndex(fastmem_address);
+      const bool watch_fault = (is_write && Bus::IsRAMAddress(fastmem_address) && Bus::IsRAMWatchPage(page_index) &&
+                                !Bus::IsRAMCodePage(page_index));
+      RecordFastmemFault(block, lbi.guest_pc, !watch_fault);
       s_code_buffer.WriteProtect(false);
       const bool backpatch_result = Recompiler::CodeGenerator::BackpatchLoadStore(lbi);
       s_code_buffer.WriteProtect(true);
@@ -1165,6 +2246,26 @@ Common::PageFaultHandler::HandlerResult MMapPageFaultHandler(void* exception_pc,
 
 #endif
 
+void RecordFastmemFault(CodeBlock* block, u32 guest_pc, bool backpatching)
+{
+  if (block->profile)
+    block->profile->fastmem_faults[guest_pc]++;
+
+  if (!backpatching)
+    return;
+
+  auto iter = s_fastmem_fault_pcs.find(guest_pc);
+  if (iter != s_fastmem_fault_pcs.end())
+    iter->second++;
+  else if (s_fastmem_fault_pcs.size() < MAX_FASTMEM_FAULT_PCS)
+    s_fastmem_fault_pcs.emplace(guest_pc, 1u);
+}
+
+bool HasFastmemFaulted(u32 guest_pc)
+{
+  return (s_fastmem_fault_pcs.find(guest_pc) != s_fastmem_fault_pcs.end());
+}
+
 Common::PageFaultHandler::HandlerResult LUTPageFaultHandler(void* exception_pc, void* fault_address, bool is_write)
 {
   // use upper_bound to find the next block after the pc
@@ -1184,7 +2285,9 @@ Common::PageFaultHandler::HandlerResult LUTPageFaultHandler(void* exception_pc,
     Recompiler::LoadStoreBackpatchInfo& lbi = *bpi_iter;
     if (lbi.host_pc == exception_pc)
     {
-      // found it, do fixup
+      // found it, do fixup. the guest address isn't known here, so while there are watchpoints, writes could be
+      // faulting because of them, and aren't remembered for the next compile.
+      RecordFastmemFault(block, lbi.guest_pc, !(is_write && HasAnyWatchpoints()));
       s_code_buffer.WriteProtect(false);
       const bool backpatch_result = Recompiler::CodeGenerator::BackpatchLoadStore(lbi);
       s_code_buffer.WriteProtect(true);
@@ -1217,10 +2320,17 @@ void CPU::Recompiler::Thunks::ResolveBranch(CodeBlock* block, void* host_pc, voi
 {
   using namespace CPU::CodeCache;
 
-  CodeBlockKey key = GetNextBlockKey();
-  CodeBlock* successor_block = LookupBlock(key);
-  if (!successor_block || (successor_block->invalidated && !RevalidateBlock(successor_block)) || !block->can_link ||
-      !successor_block->can_link)
+  const CodeBlockKey key = GetNextBlockKey();
+  const BlockMap::iterator iter = s_blocks.find(key.bits);
+  if (iter == s_blocks.end() || (iter->second && (iter->second->invalidated || !iter->second->host_code)))
+  {
+    // Compiling or revalidating here could evict or flush the code we're returning to. Leave the branch pointing at
+    // the resolver and let the dispatcher take care of the block, we'll try to link again next time around.
+    return;
+  }
+
+  CodeBlock* successor_block = iter->second;
+  if (!successor_block || !block->can_link || !successor_block->can_link)
   {
     // just turn it into a return to the dispatcher instead.
     s_code_buffer.WriteProtect(false);
@@ -1234,6 +2344,11 @@ void CPU::Recompiler::Thunks::ResolveBranch(CodeBlock* block, void* host_pc, voi
   }
 }
 
+void CPU::Recompiler::Thunks::ProfileBlockEntry(CodeBlockProfile* profile)
+{
+  CPU::CodeCache::ProfileBlockEntry(profile);
+}
+
 void CPU::Recompiler::Thunks::LogPC(u32 pc)
 {
 #if 0
@@ -4,9 +4,11 @@
 #include "cpu_types.h"
 #include "util/jit_code_buffer.h"
 #include "util/page_fault_handler.h"
+#include <algorithm>
 #include <array>
 #include <map>
 #include <memory>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -54,6 +56,20 @@ struct CodeBlockInstruction
   bool is_last_instruction : 1;
   bool has_load_delay : 1;
   bool can_trap : 1;
+  bool is_traced_branch : 1;
+  bool is_dead_write : 1;
+};
+
+/// Pre-decoded handler for simple instructions, which the cached interpreter can run without going through the decoder.
+using CachedInterpreterHandler = void (*)(Instruction inst);
+
+struct CodeBlockProfile
+{
+  u64 entry_count = 0;
+  u64 ticks = 0;
+
+  // guest pc -> fastmem faults
+  std::unordered_map<u32, u32> fastmem_faults;
 };
 
 struct CodeBlock
@@ -75,6 +91,7 @@ struct CodeBlock
   HostCodePointer host_code = nullptr;
 
   std::vector<CodeBlockInstruction> instructions;
+  std::vector<CachedInterpreterHandler> interpreter_handlers;
   std::vector<LinkInfo> link_predecessors;
   std::vector<LinkInfo> link_successors;
 
@@ -89,15 +106,28 @@ struct CodeBlock
   bool contains_double_branches = false;
   bool invalidated = false;
   bool can_link = true;
+  bool is_idle_loop = false;
+
+  // starts at a breakpoint, so it is checked before each run and kept out of the recompiler
+  bool has_breakpoint = false;
+
+  // ticks taken by the last iteration of an idle loop
+  TickCount idle_loop_ticks = 0;
 
   u32 recompile_frame_number = 0;
   u32 recompile_count = 0;
   u32 invalidate_frame_number = 0;
+  u32 execution_count = 0;
+  u32 end_page_index = 0;
+  u32 host_code_segment = 0;
+
+  // only set while block profiling is active
+  CodeBlockProfile* profile = nullptr;
 
   u32 GetPC() const { return key.GetPC(); }
   u32 GetSizeInBytes() const { return static_cast<u32>(instructions.size()) * sizeof(Instruction); }
   u32 GetStartPageIndex() const { return (key.GetPCPhysicalAddress() / HOST_PAGE_SIZE); }
-  u32 GetEndPageIndex() const { return ((key.GetPCPhysicalAddress() + GetSizeInBytes()) / HOST_PAGE_SIZE); }
+  u32 GetEndPageIndex() const { return end_page_index; }
   bool IsInRAM() const
   {
     // TODO: Constant
@@ -126,6 +156,10 @@ using SingleBlockDispatcherFunction = void (*)(const CodeBlock::HostCodePointer)
 
 FastMapTable* GetFastMapPointer();
 void ExecuteRecompiler();
+
+/// Returns true if a load/store at this guest PC has had to be backpatched to slowmem. New code for it goes straight
+/// to slowmem instead of faulting again. Remembered across flushes, until shutdown.
+bool HasFastmemFaulted(u32 guest_pc);
 #endif
 
 /// Flushes the code cache, forcing all blocks to be recompiled.
@@ -134,12 +168,49 @@ void Flush();
 /// Changes whether the recompiler is enabled.
 void Reinitialize();
 
+/// Flushes the code cache before the next block runs, so blocks are split at the new set of breakpoints.
+void OnBreakpointsChanged();
+
+/// Precompiles blocks recorded by a previous session of the specified game.
+void LoadBlockCache(const std::string_view& serial);
+
+/// Records the guest code of all compiled blocks, so they can be precompiled next time the game is booted.
+void SaveBlockCache(const std::string_view& serial);
+
 /// Invalidates all blocks which are in the range of the specified code page.
 void InvalidateBlocksWithPageIndex(u32 page_index);
 
+/// Granularity of self-modifying code detection within code pages.
+static constexpr u32 CODE_SUBPAGE_SIZE = 256;
+
+/// Returns true if the 256 byte sub-page containing the specified RAM address has any instructions in blocks.
+bool IsCodeSubpageAddress(u32 ram_address);
+
+/// Invalidates only the blocks which have instructions in the same sub-page as the specified RAM address.
+/// Writes to data which shares a page with code, but not a sub-page, don't invalidate anything.
+void InvalidateBlocksWithRAMAddress(u32 ram_address);
+
 /// Invalidates all blocks in the cache.
 void InvalidateAll();
 
+/// Returns the number of blocks compiled since startup, including recompiles after invalidation and flushes.
+u32 GetCompiledBlockCount();
+
+/// Starts counting entries and guest ticks for each block. All blocks are flushed so they get instrumented.
+void StartBlockProfile();
+
+/// Stops profiling, writing per-block results to a CSV file, most expensive first.
+bool StopBlockProfile(const char* path);
+
+/// Returns true if block profiling has been started.
+bool IsBlockProfileEnabled();
+
+/// Called on block entry while profiling, attributes the ticks elapsed since the previous entry to that block.
+void ProfileBlockEntry(CodeBlockProfile* profile);
+
+/// Returns a handler for instructions which can't raise exceptions or affect control flow, otherwise nullptr.
+CachedInterpreterHandler GetCachedInterpreterHandler(Instruction inst);
+
 template<PGXPMode pgxp_mode>
 void InterpretCachedBlock(const CodeBlock& block);
 
@@ -153,8 +224,22 @@ ALWAYS_INLINE void InvalidateCodePages(PhysicalMemoryAddress address, u32 word_c
   const u32 end_page = (address + word_count * sizeof(u32) - sizeof(u32)) / HOST_PAGE_SIZE;
   for (u32 page = start_page; page <= end_page; page++)
   {
-    if (Bus::m_ram_code_bits[page])
-      CPU::CodeCache::InvalidateBlocksWithPageIndex(page);
+    if (!Bus::m_ram_code_bits[page])
+      continue;
+
+    // only invalidate if the range touches any sub-pages with code
+    const u32 page_start = std::max(address, static_cast<u32>(page * HOST_PAGE_SIZE));
+    const u32 page_end = std::min(address + word_count * static_cast<u32>(sizeof(u32)),
+                                  static_cast<u32>((page + 1) * HOST_PAGE_SIZE));
+    for (u32 subpage_address = page_start; subpage_address < page_end;
+         subpage_address = (subpage_address & ~(CODE_SUBPAGE_SIZE - 1)) + CODE_SUBPAGE_SIZE)
+    {
+      if (IsCodeSubpageAddress(subpage_address))
+      {
+        CPU::CodeCache::InvalidateBlocksWithPageIndex(page);
+        break;
+      }
+    }
   }
 }
 
@@ -3,6 +3,7 @@
 #include "common/align.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "cpu_code_cache.h"
 #include "cpu_core_private.h"
 #include "cpu_disasm.h"
 #include "cpu_recompiler_thunks.h"
@@ -13,6 +14,7 @@
 #include "system.h"
 #include "timing_event.h"
 #include "util/state_wrapper.h"
+#include <algorithm>
 #include <cstdio>
 
 Log_SetChannel(CPU::Core);
@@ -38,6 +40,9 @@ static u32 s_breakpoint_counter = 1;
 static u32 s_last_breakpoint_check_pc = INVALID_BREAKPOINT_PC;
 static bool s_single_step = false;
 
+static std::vector<Watchpoint> s_watchpoints;
+static u32 s_watchpoint_counter = 1;
+
 bool IsTraceEnabled()
 {
   return s_trace_to_log;
@@ -96,6 +101,8 @@ void Initialize()
   s_breakpoint_counter = 1;
   s_last_breakpoint_check_pc = INVALID_BREAKPOINT_PC;
   s_single_step = false;
+  s_watchpoints.clear();
+  s_watchpoint_counter = 1;
 
   UpdateFastmemBase();
 
@@ -106,6 +113,9 @@ void Shutdown()
 {
   ClearBreakpoints();
   StopTrace();
+
+  // the bus has already dropped the watched pages
+  s_watchpoints.clear();
 }
 
 void Reset()
@@ -1619,9 +1629,20 @@ void DispatchInterrupt()
     g_state.regs.pc);
 }
 
+/// The code cache splits blocks at breakpoints, so it can check them without interpreting everything. A block can't
+/// start in a branch delay slot though, so breakpoints there still need the interpreter.
+static bool CanCodeCacheCheckBreakpoint(const Breakpoint& bp)
+{
+  Instruction prev_inst;
+  return (g_settings.IsUsingCodeCache() &&
+          (!SafeReadInstruction(bp.address - sizeof(Instruction), &prev_inst.bits) || !IsBranchInstruction(prev_inst)));
+}
+
 void UpdateDebugDispatcherFlag()
 {
-  const bool has_any_breakpoints = !s_breakpoints.empty();
+  const bool has_any_breakpoints =
+    std::any_of(s_breakpoints.begin(), s_breakpoints.end(),
+                [](const Breakpoint& bp) { return !CanCodeCacheCheckBreakpoint(bp); });
 
   // TODO: cop0 breakpoints
   const auto& dcic = g_state.cop0_regs.dcic;
@@ -1688,6 +1709,7 @@ bool AddBreakpoint(VirtualMemoryAddress address, bool auto_clear, bool enabled)
   Breakpoint bp{address, nullptr, auto_clear ? 0 : s_breakpoint_counter++, 0, auto_clear, enabled};
   s_breakpoints.push_back(std::move(bp));
   UpdateDebugDispatcherFlag();
+  CodeCache::OnBreakpointsChanged();
 
   if (!auto_clear)
   {
@@ -1708,6 +1730,7 @@ bool AddBreakpointWithCallback(VirtualMemoryAddress address, BreakpointCallback
   Breakpoint bp{address, callback, 0, 0, false, true};
   s_breakpoints.push_back(std::move(bp));
   UpdateDebugDispatcherFlag();
+  CodeCache::OnBreakpointsChanged();
   return true;
 }
 
@@ -1723,6 +1746,7 @@ bool RemoveBreakpoint(VirtualMemoryAddress address)
 
   s_breakpoints.erase(it);
   UpdateDebugDispatcherFlag();
+  CodeCache::OnBreakpointsChanged();
 
   if (address == s_last_breakpoint_check_pc)
     s_last_breakpoint_check_pc = INVALID_BREAKPOINT_PC;
@@ -1736,6 +1760,7 @@ void ClearBreakpoints()
   s_breakpoint_counter = 0;
   s_last_breakpoint_check_pc = INVALID_BREAKPOINT_PC;
   UpdateDebugDispatcherFlag();
+  CodeCache::OnBreakpointsChanged();
 }
 
 bool AddStepOverBreakpoint()
@@ -1845,6 +1870,7 @@ ALWAYS_INLINE_RELEASE static bool BreakpointCheck()
         s_breakpoints.erase(s_breakpoints.begin() + i);
         count--;
         UpdateDebugDispatcherFlag();
+        CodeCache::OnBreakpointsChanged();
       }
       else
       {
@@ -1861,6 +1887,7 @@ ALWAYS_INLINE_RELEASE static bool BreakpointCheck()
         s_breakpoints.erase(s_breakpoints.begin() + i);
         count--;
         UpdateDebugDispatcherFlag();
+        CodeCache::OnBreakpointsChanged();
       }
       else
       {
@@ -1874,6 +1901,101 @@ ALWAYS_INLINE_RELEASE static bool BreakpointCheck()
   return System::IsPaused();
 }
 
+bool CheckBlockBreakpoint()
+{
+  if (BreakpointCheck())
+    return true;
+
+  // the interpreter moves past the breakpoint by checking the next instruction, so a loop back to it hits again
+  s_last_breakpoint_check_pc = INVALID_BREAKPOINT_PC;
+  return false;
+}
+
+bool HasAnyWatchpoints()
+{
+  return !s_watchpoints.empty();
+}
+
+const WatchpointList& GetWatchpointList()
+{
+  return s_watchpoints;
+}
+
+static void UpdateRAMWatchPages()
+{
+  // whether breakpoints can be left to the code cache depends on the instruction before them, which may have been
+  // written since breakpoints last changed
+  UpdateDebugDispatcherFlag();
+
+  Bus::ClearRAMWatchPages();
+  if (Bus::g_ram_size == 0)
+    return;
+
+  for (const Watchpoint& wp : s_watchpoints)
+  {
+    const u32 start = (wp.address & PHYSICAL_MEMORY_ADDRESS_MASK) & Bus::g_ram_mask;
+    const u32 end = std::min(start + wp.size, Bus::g_ram_size);
+    for (u32 page = start / HOST_PAGE_SIZE; page <= (end - 1) / HOST_PAGE_SIZE; page++)
+      Bus::SetRAMWatchPage(page);
+  }
+}
+
+bool AddWatchpoint(VirtualMemoryAddress address, u32 size)
+{
+  if (size == 0 || !Bus::IsRAMAddress(address & PHYSICAL_MEMORY_ADDRESS_MASK) ||
+      std::any_of(s_watchpoints.begin(), s_watchpoints.end(),
+                  [address](const Watchpoint& wp) { return (wp.address == address); }))
+  {
+    return false;
+  }
+
+  Log_InfoPrintf("Adding watchpoint at %08X, size = %u", address, size);
+  s_watchpoints.push_back(Watchpoint{address, size, s_watchpoint_counter++, 0});
+  UpdateRAMWatchPages();
+
+  Host::ReportFormattedDebuggerMessage(Host::TranslateString("DebuggerMessage", "Added watchpoint at 0x%08X."),
+                                       address);
+  return true;
+}
+
+bool RemoveWatchpoint(VirtualMemoryAddress address)
+{
+  auto it = std::find_if(s_watchpoints.begin(), s_watchpoints.end(),
+                         [address](const Watchpoint& wp) { return (wp.address == address); });
+  if (it == s_watchpoints.end())
+    return false;
+
+  Host::ReportFormattedDebuggerMessage(Host::TranslateString("DebuggerMessage", "Removed watchpoint at 0x%08X."),
+                                       address);
+
+  s_watchpoints.erase(it);
+  UpdateRAMWatchPages();
+  return true;
+}
+
+void ClearWatchpoints()
+{
+  s_watchpoints.clear();
+  s_watchpoint_counter = 1;
+  UpdateRAMWatchPages();
+}
+
+void CheckWatchpoints(PhysicalMemoryAddress address, u32 size, u32 value)
+{
+  for (Watchpoint& wp : s_watchpoints)
+  {
+    const u32 start = (wp.address & PHYSICAL_MEMORY_ADDRESS_MASK) & Bus::g_ram_mask;
+    if (address >= (start + wp.size) || (address + size) <= start)
+      continue;
+
+    // recompiled code doesn't keep the pc up to date, so this is the start of the block at best
+    wp.hit_count++;
+    Host::ReportFormattedDebuggerMessage("Hit watchpoint %u: write of 0x%08X to 0x%08X near 0x%08X.", wp.number,
+                                         value, address, g_state.regs.pc);
+    System::PauseSystem(true);
+  }
+}
+
 template<PGXPMode pgxp_mode, bool debug>
 static void ExecuteImpl()
 {
@@ -1980,6 +2102,137 @@ void SingleStep()
 
 namespace CodeCache {
 
+// These must match ExecuteInstruction(), minus the PGXP hooks.
+static void CachedInterpreter_nop(Instruction inst) {}
+static void CachedInterpreter_sll(Instruction inst)
+{
+  WriteReg(inst.r.rd, ReadReg(inst.r.rt) << inst.r.shamt);
+}
+static void CachedInterpreter_srl(Instruction inst)
+{
+  WriteReg(inst.r.rd, ReadReg(inst.r.rt) >> inst.r.shamt);
+}
+static void CachedInterpreter_sra(Instruction inst)
+{
+  WriteReg(inst.r.rd, static_cast<u32>(static_cast<s32>(ReadReg(inst.r.rt)) >> inst.r.shamt));
+}
+static void CachedInterpreter_sllv(Instruction inst)
+{
+  WriteReg(inst.r.rd, ReadReg(inst.r.rt) << (ReadReg(inst.r.rs) & UINT32_C(0x1F)));
+}
+static void CachedInterpreter_srlv(Instruction inst)
+{
+  WriteReg(inst.r.rd, ReadReg(inst.r.rt) >> (ReadReg(inst.r.rs) & UINT32_C(0x1F)));
+}
+static void CachedInterpreter_srav(Instruction inst)
+{
+  WriteReg(inst.r.rd, static_cast<u32>(static_cast<s32>(ReadReg(inst.r.rt)) >> (ReadReg(inst.r.rs) & UINT32_C(0x1F))));
+}
+static void CachedInterpreter_and(Instruction inst)
+{
+  WriteReg(inst.r.rd, ReadReg(inst.r.rs) & ReadReg(inst.r.rt));
+}
+static void CachedInterpreter_or(Instruction inst)
+{
+  WriteReg(inst.r.rd, ReadReg(inst.r.rs) | ReadReg(inst.r.rt));
+}
+static void CachedInterpreter_xor(Instruction inst)
+{
+  WriteReg(inst.r.rd, ReadReg(inst.r.rs) ^ ReadReg(inst.r.rt));
+}
+static void CachedInterpreter_nor(Instruction inst)
+{
+  WriteReg(inst.r.rd, ~(ReadReg(inst.r.rs) | ReadReg(inst.r.rt)));
+}
+static void CachedInterpreter_addu(Instruction inst)
+{
+  WriteReg(inst.r.rd, ReadReg(inst.r.rs) + ReadReg(inst.r.rt));
+}
+static void CachedInterpreter_subu(Instruction inst)
+{
+  WriteReg(inst.r.rd, ReadReg(inst.r.rs) - ReadReg(inst.r.rt));
+}
+static void CachedInterpreter_slt(Instruction inst)
+{
+  WriteReg(inst.r.rd, BoolToUInt32(static_cast<s32>(ReadReg(inst.r.rs)) < static_cast<s32>(ReadReg(inst.r.rt))));
+}
+static void CachedInterpreter_sltu(Instruction inst)
+{
+  WriteReg(inst.r.rd, BoolToUInt32(ReadReg(inst.r.rs) < ReadReg(inst.r.rt)));
+}
+static void CachedInterpreter_lui(Instruction inst)
+{
+  WriteReg(inst.i.rt, inst.i.imm_zext32() << 16);
+}
+static void CachedInterpreter_andi(Instruction inst)
+{
+  WriteReg(inst.i.rt, ReadReg(inst.i.rs) & inst.i.imm_zext32());
+}
+static void CachedInterpreter_ori(Instruction inst)
+{
+  WriteReg(inst.i.rt, ReadReg(inst.i.rs) | inst.i.imm_zext32());
+}
+static void CachedInterpreter_xori(Instruction inst)
+{
+  WriteReg(inst.i.rt, ReadReg(inst.i.rs) ^ inst.i.imm_zext32());
+}
+static void CachedInterpreter_addiu(Instruction inst)
+{
+  WriteReg(inst.i.rt, ReadReg(inst.i.rs) + inst.i.imm_sext32());
+}
+static void CachedInterpreter_slti(Instruction inst)
+{
+  WriteReg(inst.i.rt, BoolToUInt32(static_cast<s32>(ReadReg(inst.i.rs)) < static_cast<s32>(inst.i.imm_sext32())));
+}
+static void CachedInterpreter_sltiu(Instruction inst)
+{
+  WriteReg(inst.i.rt, BoolToUInt32(ReadReg(inst.i.rs) < inst.i.imm_sext32()));
+}
+
+CachedInterpreterHandler GetCachedInterpreterHandler(Instruction inst)
+{
+  if (inst.bits == 0)
+    return &CachedInterpreter_nop;
+
+  switch (inst.op)
+  {
+    case InstructionOp::funct:
+    {
+      switch (inst.r.funct)
+      {
+        // clang-format off
+        case InstructionFunct::sll: return &CachedInterpreter_sll;
+        case InstructionFunct::srl: return &CachedInterpreter_srl;
+        case InstructionFunct::sra: return &CachedInterpreter_sra;
+        case InstructionFunct::sllv: return &CachedInterpreter_sllv;
+        case InstructionFunct::srlv: return &CachedInterpreter_srlv;
+        case InstructionFunct::srav: return &CachedInterpreter_srav;
+        case InstructionFunct::and_: return &CachedInterpreter_and;
+        case InstructionFunct::or_: return &CachedInterpreter_or;
+        case InstructionFunct::xor_: return &CachedInterpreter_xor;
+        case InstructionFunct::nor: return &CachedInterpreter_nor;
+        case InstructionFunct::addu: return &CachedInterpreter_addu;
+        case InstructionFunct::subu: return &CachedInterpreter_subu;
+        case InstructionFunct::slt: return &CachedInterpreter_slt;
+        case InstructionFunct::sltu: return &CachedInterpreter_sltu;
+        default: return nullptr;
+          // clang-format on
+      }
+    }
+
+      // clang-format off
+    case InstructionOp::lui: return &CachedInterpreter_lui;
+    case InstructionOp::andi: return &CachedInterpreter_andi;
+    case InstructionOp::ori: return &CachedInterpreter_ori;
+    case InstructionOp::xori: return &CachedInterpreter_xori;
+    case InstructionOp::addiu: return &CachedInterpreter_addiu;
+    case InstructionOp::slti: return &CachedInterpreter_slti;
+    case InstructionOp::sltiu: return &CachedInterpreter_sltiu;
+    default: return nullptr;
+      // clang-format on
+  }
+}
+
 template<PGXPMode pgxp_mode>
 void InterpretCachedBlock(const CodeBlock& block)
 {
@@ -1987,10 +2240,31 @@ void InterpretCachedBlock(const CodeBlock& block)
   DebugAssert(g_state.regs.pc == block.GetPC());
   g_state.regs.npc = block.GetPC() + 4;
 
+  // PGXP has to track moves through add with a zero operand, and PGXP-CPU every ALU op, so these always go through
+  // the decoder
+  const CachedInterpreterHandler* handler = (pgxp_mode == PGXPMode::Disabled && !block.interpreter_handlers.empty()) ?
+                                              block.interpreter_handlers.data() :
+                                              nullptr;
+
   for (const CodeBlockInstruction& cbi : block.instructions)
   {
     g_state.pending_ticks++;
 
+    if (handler)
+    {
+      // simple instructions can't raise exceptions, so the exception state doesn't need to be set up
+      const CachedInterpreterHandler instruction_handler = *(handler++);
+      if (instruction_handler)
+      {
+        g_state.branch_was_taken = false;
+        g_state.regs.pc = g_state.regs.npc;
+        g_state.regs.npc += 4;
+        instruction_handler(cbi.instruction);
+        UpdateLoadDelay();
+        continue;
+      }
+    }
+
     // now executing the instruction we previously fetched
     g_state.current_instruction.bits = cbi.instruction.bits;
     g_state.current_instruction_pc = cbi.pc;
@@ -45,42 +45,42 @@ union CacheControl
 
 struct State
 {
+  // Fields touched by the dispatcher and on every block entry/exit are kept together at the start, so that they sit in
+  // the first cache line. Code generators use these offsets, see the static_asserts below.
+
   // ticks the CPU has executed
   TickCount downcount = 0;
   TickCount pending_ticks = 0;
   TickCount gte_completion_tick = 0;
 
-  Registers regs = {};
-  Cop0Registers cop0_regs = {};
-  Instruction next_instruction = {};
+  // load delays
+  Reg load_delay_reg = Reg::count;
+  Reg next_load_delay_reg = Reg::count;
+  bool use_debug_dispatcher = false;
+  bool frame_done = false;
+  u32 load_delay_value = 0;
+  u32 next_load_delay_value = 0;
 
   // address of the instruction currently being executed
   Instruction current_instruction = {};
   u32 current_instruction_pc = 0;
+  Instruction next_instruction = {};
   bool current_instruction_in_branch_delay_slot = false;
   bool current_instruction_was_branch_taken = false;
   bool next_instruction_is_branch_delay_slot = false;
   bool branch_was_taken = false;
   bool exception_raised = false;
   bool interrupt_delay = false;
-  bool frame_done = false;
 
-  // load delays
-  Reg load_delay_reg = Reg::count;
-  u32 load_delay_value = 0;
-  Reg next_load_delay_reg = Reg::count;
-  u32 next_load_delay_value = 0;
+  u8* fastmem_base = nullptr;
 
+  Registers regs = {};
+  Cop0Registers cop0_regs = {};
   CacheControl cache_control{0};
 
   // GTE registers are stored here so we can access them on ARM with a single instruction
   GTE::Regs gte_regs = {};
 
-  // 4 bytes of padding here on x64
-  bool use_debug_dispatcher = false;
-
-  u8* fastmem_base = nullptr;
-
   // data cache (used as scratchpad)
   std::array<u8, DCACHE_SIZE> dcache = {};
   std::array<u32, ICACHE_LINES> icache_tags = {};
@@ -90,6 +90,12 @@ struct State
   static constexpr u32 GTERegisterOffset(u32 index) { return offsetof(State, gte_regs.r32) + (sizeof(u32) * index); }
 };
 
+static_assert(offsetof(State, fastmem_base) + sizeof(u8*) <= 64, "Per-block state should fit in one cache line");
+
+// AArch32 loads/stores have a 12-bit immediate offset, and the icache tags are accessed from generated code.
+static_assert(offsetof(State, icache_tags) + sizeof(State::icache_tags) <= 4096,
+              "Fields used by code generators must be within reach of a single load");
+
 extern State g_state;
 extern bool g_using_interpreter;
 
@@ -144,6 +150,7 @@ ALWAYS_INLINE bool InKernelMode()
 bool SafeReadMemoryByte(VirtualMemoryAddress addr, u8* value);
 bool SafeReadMemoryHalfWord(VirtualMemoryAddress addr, u16* value);
 bool SafeReadMemoryWord(VirtualMemoryAddress addr, u32* value);
+bool SafeReadMemoryBytes(VirtualMemoryAddress addr, void* data, u32 length);
 bool SafeWriteMemoryByte(VirtualMemoryAddress addr, u8 value);
 bool SafeWriteMemoryHalfWord(VirtualMemoryAddress addr, u16 value);
 bool SafeWriteMemoryWord(VirtualMemoryAddress addr, u32 value);
@@ -190,6 +197,23 @@ void ClearBreakpoints();
 bool AddStepOverBreakpoint();
 bool AddStepOutBreakpoint(u32 max_instructions_to_search = 1000);
 
+// Write watchpoints, RAM only. Writes by the CPU which overlap the range pause the system once the current block ends.
+struct Watchpoint
+{
+  VirtualMemoryAddress address;
+  u32 size;
+  u32 number;
+  u32 hit_count;
+};
+
+using WatchpointList = std::vector<Watchpoint>;
+
+bool HasAnyWatchpoints();
+const WatchpointList& GetWatchpointList();
+bool AddWatchpoint(VirtualMemoryAddress address, u32 size);
+bool RemoveWatchpoint(VirtualMemoryAddress address);
+void ClearWatchpoints();
+
 extern bool TRACE_EXECUTION;
 
 } // namespace CPU
@@ -23,6 +23,13 @@ ALWAYS_INLINE void CheckForPendingInterrupt()
 void DispatchInterrupt();
 void UpdateDebugDispatcherFlag();
 
+/// Breakpoint check for the code cache, which only checks at the start of blocks which have a breakpoint there.
+/// Returns true if the block shouldn't be executed, because the system was paused.
+bool CheckBlockBreakpoint();
+
+/// Called by the bus for writes to RAM pages with a watchpoint, address is the offset into RAM.
+void CheckWatchpoints(PhysicalMemoryAddress address, u32 size, u32 value);
+
 // icache stuff
 ALWAYS_INLINE bool IsCachedAddress(VirtualMemoryAddress address)
 {
@@ -6,6 +6,7 @@
 #include "gte.h"
 #include "pgxp.h"
 #include "settings.h"
+#include <cstring>
 Log_SetChannel(CPU::Recompiler);
 
 // TODO: Turn load+sext/zext into a single signed/unsigned load
@@ -67,7 +68,7 @@ bool CodeGenerator::CompileBlock(CodeBlock* block, CodeBlock::HostCodePointer* o
 
 bool CodeGenerator::CompileInstruction(const CodeBlockInstruction& cbi)
 {
-  if (IsNopInstruction(cbi.instruction))
+  if (IsNopInstruction(cbi.instruction) || cbi.is_dead_write)
   {
     InstructionPrologue(cbi, 1);
     InstructionEpilogue(cbi);
@@ -916,6 +917,52 @@ Value CodeGenerator::NotValue(const Value& val)
   return res;
 }
 
+void CodeGenerator::EmitPGXPMove(Reg dest, Reg src, const Value& src_value)
+{
+  // Same as PGXP::CPU_MOVE(): validate the source against its current value, then copy the whole shadow value.
+  u32* const src_shadow = PGXP::GetCPURegisterShadow(static_cast<u32>(src));
+  u32* const dest_shadow = PGXP::GetCPURegisterShadow(static_cast<u32>(dest));
+
+  Value flags = m_register_cache.AllocateScratch(RegSize_32);
+  Value temp = m_register_cache.AllocateScratch(RegSize_32);
+  EmitLoadGlobal(flags.GetHostRegister(), RegSize_32, &src_shadow[PGXP::SHADOW_VALUE_FLAGS_WORD]);
+  EmitLoadGlobal(temp.GetHostRegister(), RegSize_32, &src_shadow[PGXP::SHADOW_VALUE_VALUE_WORD]);
+
+  LabelType value_matches;
+  EmitConditionalBranch(Condition::Equal, false, temp.GetHostRegister(), src_value, &value_matches);
+  EmitAnd(flags.GetHostRegister(), flags.GetHostRegister(),
+          Value::FromConstantU32(PGXP::SHADOW_VALUE_INVALIDATE_MASK));
+  EmitStoreGlobal(&src_shadow[PGXP::SHADOW_VALUE_FLAGS_WORD], flags);
+  EmitBindLabel(&value_matches);
+
+  if (dest_shadow == src_shadow)
+    return;
+
+  // temp still holds the source value word on both paths
+  EmitStoreGlobal(&dest_shadow[PGXP::SHADOW_VALUE_VALUE_WORD], temp);
+  EmitStoreGlobal(&dest_shadow[PGXP::SHADOW_VALUE_FLAGS_WORD], flags);
+  for (u32 i = 0; i < PGXP::SHADOW_VALUE_FLAGS_WORD; i++)
+  {
+    EmitLoadGlobal(temp.GetHostRegister(), RegSize_32, &src_shadow[i]);
+    EmitStoreGlobal(&dest_shadow[i], temp);
+  }
+}
+
+void CodeGenerator::EmitPGXPLoadUpper(Reg dest, u16 imm)
+{
+  // Same as PGXP::CPU_LUI(): x = 0, y = imm, z = 0, with only x and y valid.
+  const float y = static_cast<float>(static_cast<s16>(imm));
+  u32 y_bits;
+  std::memcpy(&y_bits, &y, sizeof(y_bits));
+
+  u32* const dest_shadow = PGXP::GetCPURegisterShadow(static_cast<u32>(dest));
+  EmitStoreGlobal(&dest_shadow[0], Value::FromConstantU32(0));
+  EmitStoreGlobal(&dest_shadow[1], Value::FromConstantU32(y_bits));
+  EmitStoreGlobal(&dest_shadow[2], Value::FromConstantU32(0));
+  EmitStoreGlobal(&dest_shadow[PGXP::SHADOW_VALUE_FLAGS_WORD], Value::FromConstantU32(PGXP::SHADOW_VALUE_VALID_01));
+  EmitStoreGlobal(&dest_shadow[PGXP::SHADOW_VALUE_VALUE_WORD], Value::FromConstantU32(ZeroExtend32(imm) << 16));
+}
+
 void CodeGenerator::GenerateExceptionExit(const CodeBlockInstruction& cbi, Exception excode,
                                           Condition condition /* = Condition::Always */)
 {
@@ -961,6 +1008,9 @@ void CodeGenerator::BlockPrologue()
   EmitFunctionCall(nullptr, &Thunks::LogPC, Value::FromConstantU32(m_pc));
 #endif
 
+  if (m_block->profile)
+    EmitFunctionCall(nullptr, &Thunks::ProfileBlockEntry, Value::FromConstantPtr(m_block->profile));
+
   if (m_block->uncached_fetch_ticks > 0 || m_block->icache_line_count > 0)
     EmitICacheCheckAndUpdate();
 
@@ -1593,15 +1643,17 @@ bool CodeGenerator::Compile_Store(const CodeBlockInstruction& cbi)
     const CPU::Segment seg = GetSegmentForAddress(*address_spec);
     if (seg == Segment::KUSEG || seg == Segment::KSEG0 || seg == Segment::KSEG1)
     {
-      const PhysicalMemoryAddress phys_addr = VirtualAddressToPhysical(*address_spec);
-      const PhysicalMemoryAddress block_start = VirtualAddressToPhysical(m_block->GetPC());
-      const PhysicalMemoryAddress block_end = VirtualAddressToPhysical(
-        m_block->GetPC() + static_cast<u32>(m_block->instructions.size()) * sizeof(Instruction));
-      if (phys_addr >= block_start && phys_addr < block_end)
+      // blocks containing traced branches aren't contiguous, so check each instruction
+      const PhysicalMemoryAddress phys_addr = VirtualAddressToPhysical(*address_spec) & ~UINT32_C(3);
+      for (const CodeBlockInstruction& block_cbi : m_block->instructions)
       {
-        Log_WarningPrintf("Instruction %08X speculatively writes to %08X inside block %08X-%08X. Truncating block.",
-                          cbi.pc, phys_addr, block_start, block_end);
-        TruncateBlockAtCurrentInstruction();
+        if (VirtualAddressToPhysical(block_cbi.pc) == phys_addr)
+        {
+          Log_WarningPrintf("Instruction %08X speculatively writes to %08X inside block %08X. Truncating block.",
+                            cbi.pc, phys_addr, m_block->GetPC());
+          TruncateBlockAtCurrentInstruction();
+          break;
+        }
       }
     }
   }
@@ -1755,7 +1807,7 @@ bool CodeGenerator::Compile_MoveHiLo(const CodeBlockInstruction& cbi)
     {
       Value hi = m_register_cache.ReadGuestRegister(Reg::hi);
       if (g_settings.UsingPGXPCPUMode())
-        EmitFunctionCall(nullptr, &PGXP::CPU_MFHI, Value::FromConstantU32(cbi.instruction.bits), hi);
+        EmitPGXPMove(cbi.instruction.r.rd, Reg::hi, hi);
 
       m_register_cache.WriteGuestRegister(cbi.instruction.r.rd, std::move(hi));
       SpeculativeWriteReg(cbi.instruction.r.rd, std::nullopt);
@@ -1766,7 +1818,7 @@ bool CodeGenerator::Compile_MoveHiLo(const CodeBlockInstruction& cbi)
     {
       Value rs = m_register_cache.ReadGuestRegister(cbi.instruction.r.rs);
       if (g_settings.UsingPGXPCPUMode())
-        EmitFunctionCall(nullptr, &PGXP::CPU_MTHI, Value::FromConstantU32(cbi.instruction.bits), rs);
+        EmitPGXPMove(Reg::hi, cbi.instruction.r.rs, rs);
 
       m_register_cache.WriteGuestRegister(Reg::hi, std::move(rs));
     }
@@ -1776,7 +1828,7 @@ bool CodeGenerator::Compile_MoveHiLo(const CodeBlockInstruction& cbi)
     {
       Value lo = m_register_cache.ReadGuestRegister(Reg::lo);
       if (g_settings.UsingPGXPCPUMode())
-        EmitFunctionCall(nullptr, &PGXP::CPU_MFLO, Value::FromConstantU32(cbi.instruction.bits), lo);
+        EmitPGXPMove(cbi.instruction.r.rd, Reg::lo, lo);
 
       m_register_cache.WriteGuestRegister(cbi.instruction.r.rd, std::move(lo));
       SpeculativeWriteReg(cbi.instruction.r.rd, std::nullopt);
@@ -1787,7 +1839,7 @@ bool CodeGenerator::Compile_MoveHiLo(const CodeBlockInstruction& cbi)
     {
       Value rs = m_register_cache.ReadGuestRegister(cbi.instruction.r.rs);
       if (g_settings.UsingPGXPCPUMode())
-        EmitFunctionCall(nullptr, &PGXP::CPU_MTLO, Value::FromConstantU32(cbi.instruction.bits), rs);
+        EmitPGXPMove(Reg::lo, cbi.instruction.r.rs, rs);
 
       m_register_cache.WriteGuestRegister(Reg::lo, std::move(rs));
     }
@@ -1851,8 +1903,7 @@ bool CodeGenerator::Compile_Add(const CodeBlockInstruction& cbi)
   // detect register moves and handle them for pgxp
   if (g_settings.gpu_pgxp_enable && rhs.HasConstantValue(0))
   {
-    EmitFunctionCall(nullptr, &PGXP::CPU_MOVE,
-                     Value::FromConstantU32((static_cast<u32>(dest) << 8) | (static_cast<u32>(lhs_src))), lhs);
+    EmitPGXPMove(dest, lhs_src, lhs);
   }
   else if (g_settings.UsingPGXPCPUMode())
   {
@@ -2313,6 +2364,26 @@ bool CodeGenerator::Compile_Branch(const CodeBlockInstruction& cbi)
       m_register_cache.PopState();
     }
 
+    if (cbi.is_traced_branch)
+    {
+      // the target is compiled inline after the delay slot, so there's no exit here
+      DebugAssert(condition == Condition::Always && branch_target.IsConstant());
+      const u32 target = static_cast<u32>(branch_target.constant_value);
+      Assert((m_current_instruction + 1) != m_block_end);
+      InstructionEpilogue(cbi);
+      m_current_instruction++;
+      if (!CompileInstruction(*m_current_instruction))
+        return false;
+
+      // if the delay slot truncated the block, we still need to exit to the target
+      if (m_block_end == (m_current_instruction + 1))
+        WriteNewPC(Value::FromConstantU32(target), true);
+
+      m_pc = target;
+      m_pc_valid = true;
+      return true;
+    }
+
     if (can_link_block)
     {
       // if it's an in-block branch, compile the delay slot now
@@ -2541,7 +2612,7 @@ bool CodeGenerator::Compile_lui(const CodeBlockInstruction& cbi)
   InstructionPrologue(cbi, 1);
 
   if (g_settings.UsingPGXPCPUMode())
-    EmitFunctionCall(nullptr, &PGXP::CPU_LUI, Value::FromConstantU32(cbi.instruction.bits));
+    EmitPGXPLoadUpper(cbi.instruction.i.rt, cbi.instruction.i.imm);
 
   // rt <- (imm << 16)
   const u32 value = cbi.instruction.i.imm_zext32() << 16;
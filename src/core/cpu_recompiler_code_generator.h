@@ -183,6 +183,15 @@ private:
   // Host register setup
   void InitHostRegs();
 
+  // Guest registers which are kept in host registers across blocks (AArch64 only).
+  static HostReg GetPinnedHostReg(Reg guest_reg);
+  void EmitLoadPinnedGuestRegisters();
+  void EmitStorePinnedGuestRegisters();
+
+  // PGXP shadow register updates which are simple enough to emit inline.
+  void EmitPGXPMove(Reg dest, Reg src, const Value& src_value);
+  void EmitPGXPLoadUpper(Reg dest, u16 imm);
+
   Value ConvertValueSize(const Value& value, RegSize size, bool sign_extend);
   void ConvertValueSizeInPlace(Value* value, RegSize size, bool sign_extend);
 
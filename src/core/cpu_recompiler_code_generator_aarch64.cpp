@@ -30,6 +30,21 @@ constexpr u64 FUNCTION_STACK_SIZE =
 // PC we return to after the end of the block
 static void* s_dispatcher_return_address;
 
+// With register pinning, these guest registers live in callee-saved host registers for the whole dispatcher loop.
+// The CPU state copy is only brought up to date around calls out of generated code.
+static constexpr std::array<std::pair<Reg, HostReg>, 7> s_pinned_guest_regs = {{{Reg::sp, 21},
+                                                                                {Reg::ra, 22},
+                                                                                {Reg::v0, 23},
+                                                                                {Reg::a0, 24},
+                                                                                {Reg::a1, 25},
+                                                                                {Reg::a2, 26},
+                                                                                {Reg::a3, 27}}};
+
+static bool IsUsingRegisterPinning()
+{
+  return g_settings.cpu_recompiler_register_pinning;
+}
+
 static s64 GetPCDisplacement(const void* current, const void* target)
 {
   Assert(Common::IsAlignedPow2(reinterpret_cast<size_t>(current), 4));
@@ -141,13 +156,77 @@ void CodeGenerator::InitHostRegs()
 {
   // TODO: function calls mess up the parameter registers if we use them.. fix it
   // allocate nonvolatile before volatile
-  m_register_cache.SetHostRegAllocationOrder(
-    {19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 4, 5, 6, 7, 9, 10, 11, 12, 13, 14, 15, 16, 17});
+  if (IsUsingRegisterPinning())
+  {
+    // x21-x27 are owned by the pinned guest registers
+    m_register_cache.SetHostRegAllocationOrder({19, 20, 28, 4, 5, 6, 7, 9, 10, 11, 12, 13, 14, 15, 16, 17});
+  }
+  else
+  {
+    m_register_cache.SetHostRegAllocationOrder(
+      {19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 4, 5, 6, 7, 9, 10, 11, 12, 13, 14, 15, 16, 17});
+  }
   m_register_cache.SetCallerSavedHostRegs({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17});
   m_register_cache.SetCalleeSavedHostRegs({19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 30});
   m_register_cache.SetCPUPtrHostReg(RCPUPTR);
 }
 
+HostReg CodeGenerator::GetPinnedHostReg(Reg guest_reg)
+{
+  if (!IsUsingRegisterPinning())
+    return HostReg_Invalid;
+
+  for (const auto& [pinned_guest_reg, pinned_host_reg] : s_pinned_guest_regs)
+  {
+    if (pinned_guest_reg == guest_reg)
+      return pinned_host_reg;
+  }
+
+  return HostReg_Invalid;
+}
+
+void CodeGenerator::EmitLoadPinnedGuestRegisters()
+{
+  for (u32 i = 0; i < s_pinned_guest_regs.size(); i++)
+  {
+    const auto& [guest_reg, host_reg] = s_pinned_guest_regs[i];
+    const a64::MemOperand mem(GetCPUPtrReg(), State::GPRRegisterOffset(static_cast<u32>(guest_reg)));
+
+    // a0-a3 are adjacent in both the state and the host registers
+    if ((i + 1) < s_pinned_guest_regs.size() &&
+        static_cast<u32>(s_pinned_guest_regs[i + 1].first) == (static_cast<u32>(guest_reg) + 1) &&
+        s_pinned_guest_regs[i + 1].second == (host_reg + 1))
+    {
+      m_emit->ldp(GetHostReg32(host_reg), GetHostReg32(host_reg + 1), mem);
+      i++;
+    }
+    else
+    {
+      m_emit->ldr(GetHostReg32(host_reg), mem);
+    }
+  }
+}
+
+void CodeGenerator::EmitStorePinnedGuestRegisters()
+{
+  for (u32 i = 0; i < s_pinned_guest_regs.size(); i++)
+  {
+    const auto& [guest_reg, host_reg] = s_pinned_guest_regs[i];
+    const a64::MemOperand mem(GetCPUPtrReg(), State::GPRRegisterOffset(static_cast<u32>(guest_reg)));
+    if ((i + 1) < s_pinned_guest_regs.size() &&
+        static_cast<u32>(s_pinned_guest_regs[i + 1].first) == (static_cast<u32>(guest_reg) + 1) &&
+        s_pinned_guest_regs[i + 1].second == (host_reg + 1))
+    {
+      m_emit->stp(GetHostReg32(host_reg), GetHostReg32(host_reg + 1), mem);
+      i++;
+    }
+    else
+    {
+      m_emit->str(GetHostReg32(host_reg), mem);
+    }
+  }
+}
+
 void CodeGenerator::SwitchToFarCode()
 {
   m_emit = &m_far_emitter;
@@ -1029,6 +1108,10 @@ void CodeGenerator::RestoreStackAfterCall(u32 adjust_size)
 
 void CodeGenerator::EmitCall(const void* ptr)
 {
+  // anything we call can look at or modify the guest registers
+  if (IsUsingRegisterPinning())
+    EmitStorePinnedGuestRegisters();
+
   const s64 displacement = GetPCDisplacement(GetCurrentCodePointer(), ptr);
   const bool use_blr = !vixl::IsInt26(displacement);
   if (use_blr)
@@ -1040,6 +1123,9 @@ void CodeGenerator::EmitCall(const void* ptr)
   {
     m_emit->bl(displacement);
   }
+
+  if (IsUsingRegisterPinning())
+    EmitLoadPinnedGuestRegisters();
 }
 
 void CodeGenerator::EmitFunctionCallPtr(Value* return_value, const void* ptr)
@@ -1870,6 +1956,10 @@ void CodeGenerator::EmitFlushInterpreterLoadDelay()
   const a64::MemOperand load_delay_value(GetCPUPtrReg(), offsetof(State, load_delay_value));
   const a64::MemOperand regs_base(GetCPUPtrReg(), offsetof(State, regs.r[0]));
 
+  // the delayed register could be a pinned one, so go through the state
+  if (IsUsingRegisterPinning())
+    EmitStorePinnedGuestRegisters();
+
   a64::Label skip_flush;
 
   // reg = load_delay_reg
@@ -1894,6 +1984,9 @@ void CodeGenerator::EmitFlushInterpreterLoadDelay()
   m_emit->Strb(GetHostReg32(reg), load_delay_reg);
 
   m_emit->Bind(&skip_flush);
+
+  if (IsUsingRegisterPinning())
+    EmitLoadPinnedGuestRegisters();
 }
 
 void CodeGenerator::EmitMoveNextInterpreterLoadDelay()
@@ -2272,6 +2365,8 @@ CodeCache::DispatcherFunction CodeGenerator::CompileDispatcher()
   const u32 stack_adjust = PrepareStackForCall();
 
   EmitLoadGlobalAddress(RCPUPTR, &g_state);
+  if (IsUsingRegisterPinning())
+    EmitLoadPinnedGuestRegisters();
 
   a64::Label frame_done_loop;
   a64::Label exit_dispatcher;
@@ -2304,11 +2399,10 @@ CodeCache::DispatcherFunction CodeGenerator::CompileDispatcher()
   m_emit->Bind(&no_interrupt);
 
   // TimingEvents::UpdateCPUDowncount:
-  // x8 <- head event->downcount
+  // x8 <- next event downcount
   // downcount <- x8
-  EmitLoadGlobalAddress(8, TimingEvents::GetHeadEventPtr());
-  m_emit->ldr(a64::x8, a64::MemOperand(a64::x8));
-  m_emit->ldr(a64::w8, a64::MemOperand(a64::x8, offsetof(TimingEvent, m_downcount)));
+  EmitLoadGlobalAddress(8, TimingEvents::GetNextEventDowncountPtr());
+  m_emit->ldr(a64::w8, a64::MemOperand(a64::x8));
   m_emit->str(a64::w8, a64::MemOperand(GetHostReg64(RCPUPTR), offsetof(State, downcount)));
 
   // main dispatch loop
@@ -2338,16 +2432,38 @@ CodeCache::DispatcherFunction CodeGenerator::CompileDispatcher()
 
   // blr(x9[pc * 2]) (fast_map[pc >> 2])
   m_emit->ldr(a64::x8, a64::MemOperand(a64::x9, a64::x8, a64::LSL, 3));
-  m_emit->blr(a64::x8);
+  if (IsUsingRegisterPinning())
+  {
+    // blocks without host code go through C++, which needs the pinned registers in the state
+    // if (x8 - code_buffer) >= code_buffer_size goto call_host_function
+    a64::Label call_host_function;
+    a64::Label block_done;
+    EmitLoadGlobalAddress(9, m_code_buffer->GetCodePointer());
+    m_emit->sub(a64::x9, a64::x8, a64::x9);
+    m_emit->Mov(a64::x10, m_code_buffer->GetTotalSize());
+    m_emit->cmp(a64::x9, a64::x10);
+    m_emit->b(&call_host_function, a64::hs);
+    m_emit->blr(a64::x8);
+    m_emit->b(&block_done);
+
+    m_emit->Bind(&call_host_function);
+    EmitStorePinnedGuestRegisters();
+    m_emit->blr(a64::x8);
+    EmitLoadPinnedGuestRegisters();
+    m_emit->Bind(&block_done);
+  }
+  else
+  {
+    m_emit->blr(a64::x8);
+  }
 
   // end while
   m_emit->Bind(&downcount_hit);
 
   // check events then for frame done
   m_emit->ldr(a64::w8, a64::MemOperand(GetHostReg64(RCPUPTR), offsetof(State, pending_ticks)));
-  EmitLoadGlobalAddress(9, TimingEvents::GetHeadEventPtr());
-  m_emit->ldr(a64::x9, a64::MemOperand(a64::x9));
-  m_emit->ldr(a64::w9, a64::MemOperand(a64::x9, offsetof(TimingEvent, m_downcount)));
+  EmitLoadGlobalAddress(9, TimingEvents::GetNextEventDowncountPtr());
+  m_emit->ldr(a64::w9, a64::MemOperand(a64::x9));
   m_emit->cmp(a64::w8, a64::w9);
   m_emit->b(&frame_done_loop, a64::lt);
   EmitCall(reinterpret_cast<const void*>(&TimingEvents::RunEvents));
@@ -2355,6 +2471,8 @@ CodeCache::DispatcherFunction CodeGenerator::CompileDispatcher()
 
   // all done
   m_emit->Bind(&exit_dispatcher);
+  if (IsUsingRegisterPinning())
+    EmitStorePinnedGuestRegisters();
   RestoreStackAfterCall(stack_adjust);
   m_register_cache.PopCalleeSavedRegisters(true);
   m_emit->add(a64::sp, a64::sp, FUNCTION_STACK_SIZE);
@@ -2374,9 +2492,14 @@ CodeCache::SingleBlockDispatcherFunction CodeGenerator::CompileSingleBlockDispat
   const u32 stack_adjust = PrepareStackForCall();
 
   EmitLoadGlobalAddress(RCPUPTR, &g_state);
+  if (IsUsingRegisterPinning())
+    EmitLoadPinnedGuestRegisters();
 
   m_emit->blr(GetHostReg64(RARG1));
 
+  if (IsUsingRegisterPinning())
+    EmitStorePinnedGuestRegisters();
+
   RestoreStackAfterCall(stack_adjust);
   m_register_cache.PopCalleeSavedRegisters(true);
   m_emit->add(a64::sp, a64::sp, FUNCTION_STACK_SIZE);
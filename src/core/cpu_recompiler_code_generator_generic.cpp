@@ -1,4 +1,5 @@
 #include "common/log.h"
+#include "cpu_code_cache.h"
 #include "cpu_core.h"
 #include "cpu_core_private.h"
 #include "cpu_recompiler_code_generator.h"
@@ -9,12 +10,29 @@ namespace CPU::Recompiler {
 
 void CodeGenerator::EmitLoadGuestRegister(HostReg host_reg, Reg guest_reg)
 {
+#ifdef CPU_AARCH64
+  if (const HostReg pinned_reg = GetPinnedHostReg(guest_reg); pinned_reg != HostReg_Invalid)
+  {
+    EmitCopyValue(host_reg, Value::FromHostReg(&m_register_cache, pinned_reg, RegSize_32));
+    return;
+  }
+#endif
+
   EmitLoadCPUStructField(host_reg, RegSize_32, State::GPRRegisterOffset(static_cast<u32>(guest_reg)));
 }
 
 void CodeGenerator::EmitStoreGuestRegister(Reg guest_reg, const Value& value)
 {
   DebugAssert(value.size == RegSize_32);
+
+#ifdef CPU_AARCH64
+  if (const HostReg pinned_reg = GetPinnedHostReg(guest_reg); pinned_reg != HostReg_Invalid)
+  {
+    EmitCopyValue(pinned_reg, value);
+    return;
+  }
+#endif
+
   EmitStoreCPUStructField(State::GPRRegisterOffset(static_cast<u32>(guest_reg)), value);
 }
 
@@ -59,8 +77,8 @@ Value CodeGenerator::EmitLoadGuestMemory(const CodeBlockInstruction& cbi, const
 
   Value result = m_register_cache.AllocateScratch(HostPointerSize);
 
-  const bool use_fastmem =
-    (address_spec ? Bus::CanUseFastmemForAddress(*address_spec) : true) && !SpeculativeIsCacheIsolated();
+  const bool use_fastmem = (address_spec ? Bus::CanUseFastmemForAddress(*address_spec) : true) &&
+                           !SpeculativeIsCacheIsolated() && !CodeCache::HasFastmemFaulted(cbi.pc);
   if (address_spec)
   {
     if (!use_fastmem)
@@ -132,8 +150,8 @@ void CodeGenerator::EmitStoreGuestMemory(const CodeBlockInstruction& cbi, const
     }
   }
 
-  const bool use_fastmem =
-    (address_spec ? Bus::CanUseFastmemForAddress(*address_spec) : true) && !SpeculativeIsCacheIsolated();
+  const bool use_fastmem = (address_spec ? Bus::CanUseFastmemForAddress(*address_spec) : true) &&
+                           !SpeculativeIsCacheIsolated() && !CodeCache::HasFastmemFaulted(cbi.pc);
   if (address_spec)
   {
     if (!use_fastmem)
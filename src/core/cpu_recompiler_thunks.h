@@ -4,6 +4,7 @@
 
 namespace CPU {
 struct CodeBlock;
+struct CodeBlockProfile;
 struct CodeBlockInstruction;
 
 namespace Recompiler::Thunks {
@@ -34,6 +35,7 @@ void UncheckedWriteMemoryHalfWord(u32 address, u32 value);
 void UncheckedWriteMemoryWord(u32 address, u32 value);
 
 void ResolveBranch(CodeBlock* block, void* host_pc, void* host_resolve_pc, u32 host_pc_size);
+void ProfileBlockEntry(CodeBlockProfile* profile);
 void LogPC(u32 pc);
 
 } // namespace Recompiler::Thunks
@@ -72,6 +72,11 @@ u32 DigitalController::GetButtonStateBits() const
   return m_button_state ^ 0xFFFF;
 }
 
+void DigitalController::SetInputState(u32 button_bits, u32 analog_bytes)
+{
+  m_button_state = static_cast<u16>(button_bits ^ 0xFFFF);
+}
+
 void DigitalController::ResetTransferState()
 {
   m_transfer_state = TransferState::Idle;
@@ -43,6 +43,7 @@ public:
   float GetBindState(u32 index) const override;
   void SetBindState(u32 index, float value) override;
   u32 GetButtonStateBits() const override;
+  void SetInputState(u32 button_bits, u32 analog_bytes) override;
 
   void ResetTransferState() override;
   bool Transfer(const u8 data_in, u8* data_out) override;
@@ -16,11 +16,61 @@
 #include "util/state_wrapper.h"
 Log_SetChannel(DMA);
 
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 static u32 GetAddressMask()
 {
   return Bus::g_ram_mask & 0xFFFFFFFCu;
 }
 
+/// Returns true if the block can be accessed directly in RAM, i.e. it's ascending and ends before it would wrap.
+static bool IsContiguousRAMBlock(u32 address, u32 increment, u32 word_count, u32 mask)
+{
+  return (static_cast<s32>(increment) > 0 && (address + (increment * word_count)) <= (mask + 4));
+}
+
+/// Writes an ordering table which doesn't wrap, from the terminator at base upwards. Each entry points to the previous
+/// one, so four consecutive entries are a vector of ascending addresses.
+static void FillOrderingTable(u8* ram_pointer, u32 base, u32 word_count)
+{
+  u32 i = 1;
+#if defined(CPU_X64)
+  __m128i values = _mm_setr_epi32(static_cast<int>(base), static_cast<int>(base + 4), static_cast<int>(base + 8),
+                                  static_cast<int>(base + 12));
+  const __m128i step = _mm_set1_epi32(16);
+  for (; (i + 4) <= word_count; i += 4)
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&ram_pointer[base + (i * 4)]), values);
+    values = _mm_add_epi32(values, step);
+  }
+#elif defined(CPU_AARCH64)
+  const u32 initial_values[4] = {base, base + 4, base + 8, base + 12};
+  uint32x4_t values = vld1q_u32(initial_values);
+  const uint32x4_t step = vdupq_n_u32(16);
+  for (; (i + 4) <= word_count; i += 4)
+  {
+    vst1q_u32(reinterpret_cast<u32*>(&ram_pointer[base + (i * 4)]), values);
+    values = vaddq_u32(values, step);
+  }
+#endif
+  for (; i < word_count; i++)
+  {
+    const u32 value = base + ((i - 1) * 4);
+    std::memcpy(&ram_pointer[base + (i * 4)], &value, sizeof(value));
+  }
+
+  const u32 terminator = UINT32_C(0xFFFFFF);
+  std::memcpy(&ram_pointer[base], &terminator, sizeof(terminator));
+}
+
 DMA g_dma;
 
 DMA::DMA() = default;
@@ -494,8 +544,7 @@ TickCount DMA::TransferMemoryToDevice(Channel channel, u32 address, u32 incremen
 {
   const u32* src_pointer = reinterpret_cast<u32*>(Bus::g_ram + address);
   const u32 mask = GetAddressMask();
-  if (channel != Channel::GPU &&
-      (static_cast<s32>(increment) < 0 || ((address + (increment * word_count)) & mask) <= address))
+  if (channel != Channel::GPU && !IsContiguousRAMBlock(address, increment, word_count, mask))
   {
     // Use temp buffer if it's wrapping around
     if (m_transfer_buffer.size() < word_count)
@@ -503,10 +552,21 @@ TickCount DMA::TransferMemoryToDevice(Channel channel, u32 address, u32 incremen
     src_pointer = m_transfer_buffer.data();
 
     u8* ram_pointer = Bus::g_ram;
-    for (u32 i = 0; i < word_count; i++)
+    if (static_cast<s32>(increment) > 0)
+    {
+      // ascending blocks only wrap once, so they're two copies
+      const u32 words_before_wrap = ((mask + 4) - address) / 4;
+      std::memcpy(m_transfer_buffer.data(), &ram_pointer[address], words_before_wrap * sizeof(u32));
+      std::memcpy(&m_transfer_buffer[words_before_wrap], ram_pointer,
+                  (word_count - words_before_wrap) * sizeof(u32));
+    }
+    else
     {
-      std::memcpy(&m_transfer_buffer[i], &ram_pointer[address], sizeof(u32));
-      address = (address + increment) & mask;
+      for (u32 i = 0; i < word_count; i++)
+      {
+        std::memcpy(&m_transfer_buffer[i], &ram_pointer[address], sizeof(u32));
+        address = (address + increment) & mask;
+      }
     }
   }
 
@@ -516,13 +576,21 @@ TickCount DMA::TransferMemoryToDevice(Channel channel, u32 address, u32 incremen
     {
       if (g_gpu->BeginDMAWrite())
       {
-        u8* ram_pointer = Bus::g_ram;
-        for (u32 i = 0; i < word_count; i++)
+        if (IsContiguousRAMBlock(address, increment, word_count, mask))
         {
-          u32 value;
-          std::memcpy(&value, &ram_pointer[address], sizeof(u32));
-          g_gpu->DMAWrite(address, value);
-          address = (address + increment) & mask;
+          // linked list packets and forward blocks which don't wrap can be written in one go
+          g_gpu->DMAWriteBlock(address, src_pointer, word_count);
+        }
+        else
+        {
+          u8* ram_pointer = Bus::g_ram;
+          for (u32 i = 0; i < word_count; i++)
+          {
+            u32 value;
+            std::memcpy(&value, &ram_pointer[address], sizeof(u32));
+            g_gpu->DMAWrite(address, value);
+            address = (address + increment) & mask;
+          }
         }
         g_gpu->EndDMAWrite();
       }
@@ -557,21 +625,29 @@ TickCount DMA::TransferDeviceToMemory(Channel channel, u32 address, u32 incremen
     // clear ordering table
     u8* ram_pointer = Bus::g_ram;
     const u32 word_count_less_1 = word_count - 1;
-    for (u32 i = 0; i < word_count_less_1; i++)
+    if (address >= (word_count_less_1 * 4))
     {
-      u32 value = ((address - 4) & mask);
-      std::memcpy(&ram_pointer[address], &value, sizeof(value));
-      address = (address - 4) & mask;
+      address -= word_count_less_1 * 4;
+      FillOrderingTable(ram_pointer, address, word_count);
     }
+    else
+    {
+      for (u32 i = 0; i < word_count_less_1; i++)
+      {
+        u32 value = ((address - 4) & mask);
+        std::memcpy(&ram_pointer[address], &value, sizeof(value));
+        address = (address - 4) & mask;
+      }
 
-    const u32 terminator = UINT32_C(0xFFFFFF);
-    std::memcpy(&ram_pointer[address], &terminator, sizeof(terminator));
+      const u32 terminator = UINT32_C(0xFFFFFF);
+      std::memcpy(&ram_pointer[address], &terminator, sizeof(terminator));
+    }
     CPU::CodeCache::InvalidateCodePages(address, word_count);
     return Bus::GetDMARAMTickCount(word_count);
   }
 
   u32* dest_pointer = reinterpret_cast<u32*>(&Bus::g_ram[address]);
-  if (static_cast<s32>(increment) < 0 || ((address + (increment * word_count)) & mask) <= address)
+  if (!IsContiguousRAMBlock(address, increment, word_count, mask))
   {
     // Use temp buffer if it's wrapping around
     if (m_transfer_buffer.size() < word_count)
@@ -607,10 +683,19 @@ TickCount DMA::TransferDeviceToMemory(Channel channel, u32 address, u32 incremen
   if (dest_pointer == m_transfer_buffer.data())
   {
     u8* ram_pointer = Bus::g_ram;
-    for (u32 i = 0; i < word_count; i++)
+    if (static_cast<s32>(increment) > 0)
     {
-      std::memcpy(&ram_pointer[address], &m_transfer_buffer[i], sizeof(u32));
-      address = (address + increment) & mask;
+      const u32 words_before_wrap = ((mask + 4) - address) / 4;
+      std::memcpy(&ram_pointer[address], m_transfer_buffer.data(), words_before_wrap * sizeof(u32));
+      std::memcpy(ram_pointer, &m_transfer_buffer[words_before_wrap], (word_count - words_before_wrap) * sizeof(u32));
+    }
+    else
+    {
+      for (u32 i = 0; i < word_count; i++)
+      {
+        std::memcpy(&ram_pointer[address], &m_transfer_buffer[i], sizeof(u32));
+        address = (address + increment) & mask;
+      }
     }
   }
 
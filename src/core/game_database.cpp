@@ -1,6 +1,7 @@
 #include "game_database.h"
 #include "common/assert.h"
 #include "common/byte_stream.h"
+#include "common/file_system.h"
 #include "common/heterogeneous_containers.h"
 #include "common/log.h"
 #include "common/path.h"
@@ -12,10 +13,16 @@
 #include "system.h"
 #include "tinyxml2.h"
 #include "util/cd_image.h"
+#include "xxhash.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <iomanip>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
+#include <unordered_map>
 Log_SetChannel(GameDatabase);
 
 #ifdef _WIN32
@@ -28,16 +35,110 @@ namespace GameDatabase {
 enum : u32
 {
   GAME_DATABASE_CACHE_SIGNATURE = 0x45434C48,
-  GAME_DATABASE_CACHE_VERSION = 2,
+  GAME_DATABASE_CACHE_VERSION = 3,
+
+  // average number of keys in each perfect hash bucket, and the most seeds tried for each
+  PERFECT_HASH_KEYS_PER_BUCKET = 4,
+  MAX_PERFECT_HASH_SEED = 1u << 20,
+  EMPTY_HASH_SLOT = 0xFFFFFFFFu,
+
+  CACHE_HAS_DISPLAY_ACTIVE_START_OFFSET = (1u << 0),
+  CACHE_HAS_DISPLAY_ACTIVE_END_OFFSET = (1u << 1),
+  CACHE_HAS_DISPLAY_LINE_START_OFFSET = (1u << 2),
+  CACHE_HAS_DISPLAY_LINE_END_OFFSET = (1u << 3),
+  CACHE_HAS_DMA_MAX_SLICE_TICKS = (1u << 4),
+  CACHE_HAS_DMA_HALT_TICKS = (1u << 5),
+  CACHE_HAS_GPU_FIFO_SIZE = (1u << 6),
+  CACHE_HAS_GPU_MAX_RUN_AHEAD = (1u << 7),
+  CACHE_HAS_GPU_PGXP_TOLERANCE = (1u << 8),
+  CACHE_HAS_GPU_PGXP_DEPTH_THRESHOLD = (1u << 9),
 };
 
+// The cache is used in place once it's mapped. It's a header, the fixed-size entry and code records, perfect hash
+// tables from codes and serials to the records, and then the strings referenced by the records. The hash tables are
+// an array of bucket seeds followed by the slots, which hold a record index or EMPTY_HASH_SLOT.
+struct CacheHeader
+{
+  u32 signature;
+  u32 version;
+  u64 gamedb_ts;
+  u64 gamesettings_ts;
+  u64 compat_ts;
+  u32 num_entries;
+  u32 num_codes;
+  u32 num_code_buckets;
+  u32 num_code_slots;
+  u32 num_serial_buckets;
+  u32 num_serial_slots;
+  u32 string_table_size;
+  u32 reserved;
+};
+
+struct CacheString
+{
+  u32 offset;
+  u32 length;
+};
+
+struct CacheEntry
+{
+  CacheString serial;
+  CacheString title;
+  CacheString genre;
+  CacheString developer;
+  CacheString publisher;
+  u64 release_date;
+  u32 supported_controllers;
+  u32 traits;
+  u32 dma_max_slice_ticks;
+  u32 dma_halt_ticks;
+  u32 gpu_fifo_size;
+  u32 gpu_max_run_ahead;
+  float gpu_pgxp_tolerance;
+  float gpu_pgxp_depth_threshold;
+  s16 display_active_start_offset;
+  s16 display_active_end_offset;
+  s8 display_line_start_offset;
+  s8 display_line_end_offset;
+  u8 min_players;
+  u8 max_players;
+  u8 min_blocks;
+  u8 max_blocks;
+  u8 compatibility;
+  u8 reserved;
+  u16 optional_fields;
+  u16 reserved2;
+};
+
+struct CacheCode
+{
+  CacheString code;
+  u32 entry_index;
+};
+
+static_assert(sizeof(CacheHeader) == 64 && sizeof(CacheEntry) == 96 && sizeof(CacheCode) == 12,
+              "Cache structures are packed");
+static_assert(static_cast<u32>(Trait::Count) <= 32, "Traits fit in the cache");
+
 static Entry* GetMutableEntry(const std::string_view& serial);
 static const Entry* GetEntryForId(const std::string_view& code);
 
+static u64 HashKey(const std::string_view& key, u32 seed);
+static u32 LookupPerfectHash(const std::string_view& key, const u32* buckets, u32 num_buckets, const u32* slots,
+                             u32 num_slots);
+static bool BuildPerfectHash(const std::vector<std::string_view>& keys, std::vector<u32>* buckets,
+                             std::vector<u32>* slots);
+
+static void GetTimestamps(u64* gamedb_ts, u64* gamesettings_ts, u64* compat_ts);
+static std::string_view GetCacheString(const CacheString& str);
+static void SetCacheData(const u8* data, size_t size);
+static bool LoadEntriesFromCacheData(u64 gamedb_ts, u64 gamesettings_ts, u64 compat_ts);
+static void ReleaseCacheData();
 static bool LoadFromCache();
-static bool SaveToCache();
+static bool BuildCache(u64 gamedb_ts, u64 gamesettings_ts, u64 compat_ts, std::vector<u8>* data);
+static bool SaveToCache(const std::vector<u8>& data);
 
-static bool LoadGameDBJson();
+static bool LoadGameDBJson(rapidjson::Document* json);
 static bool ParseJsonEntry(Entry* entry, const rapidjson::Value& value);
 static bool ParseJsonCodes(u32 index, const rapidjson::Value& value);
 static bool LoadGameSettingsIni();
@@ -65,12 +166,34 @@ std::array<std::pair<const char*, const char*>, static_cast<u32>(GameDatabase::T
   {"ForceRecompilerMemoryExceptions", TRANSLATABLE("GameSettingsTrait", "Force Recompiler Memory Exceptions")},
   {"ForceRecompilerICache", TRANSLATABLE("GameSettingsTrait", "Force Recompiler ICache")},
   {"ForceRecompilerLUTFastmem", TRANSLATABLE("GameSettingsTrait", "Force Recompiler LUT Fastmem")},
+  {"DisableIdleLoopSkipping", TRANSLATABLE("GameSettingsTrait", "Disable Idle Loop Skipping")},
 }};
 
+// the database is loaded on a worker thread while booting, as well as from the game list
+static std::mutex s_load_mutex;
 static bool s_loaded = false;
 static bool s_track_hashes_loaded = false;
 
+// the entries' strings point into the cache data, which is either the mapped cache file or built in memory
 static std::vector<GameDatabase::Entry> s_entries;
+static std::FILE* s_cache_file = nullptr;
+static bool s_cache_mapped = false;
+static std::vector<u8> s_cache_buffer;
+static const u8* s_cache_data = nullptr;
+static size_t s_cache_data_size = 0;
+static const CacheCode* s_cache_codes = nullptr;
+static const u32* s_code_buckets = nullptr;
+static const u32* s_code_slots = nullptr;
+static const u32* s_serial_buckets = nullptr;
+static const u32* s_serial_slots = nullptr;
+static const char* s_cache_strings = nullptr;
+static u32 s_num_codes = 0;
+static u32 s_num_code_buckets = 0;
+static u32 s_num_code_slots = 0;
+static u32 s_num_serial_buckets = 0;
+static u32 s_num_serial_slots = 0;
+
+// only used while building the cache
 static UnorderedStringMap<u32> s_code_lookup;
 
 static TrackHashesMap s_track_hashes_map;
@@ -78,6 +201,7 @@ static TrackHashesMap s_track_hashes_map;
 
 void GameDatabase::EnsureLoaded()
 {
+  std::unique_lock lock(s_load_mutex);
   if (s_loaded)
     return;
 
@@ -87,13 +211,32 @@ void GameDatabase::EnsureLoaded()
 
   if (!LoadFromCache())
   {
+    // the parsed entries refer to strings in the document until they're copied into the cache
+    std::unique_ptr<rapidjson::Document> json = std::make_unique<rapidjson::Document>();
+    LoadGameDBJson(json.get());
+    LoadGameSettingsIni();
+    LoadGameCompatibilityXml();
+
+    u64 gamedb_ts, gamesettings_ts, compat_ts;
+    GetTimestamps(&gamedb_ts, &gamesettings_ts, &compat_ts);
+
+    std::vector<u8> data;
+    const bool built = BuildCache(gamedb_ts, gamesettings_ts, compat_ts, &data);
     s_entries = {};
     s_code_lookup = {};
+    if (built)
+    {
+      if (!SaveToCache(data))
+        Log_WarningPrintf("Failed to write game database cache");
 
-    LoadGameDBJson();
-    LoadGameSettingsIni();
-    LoadGameCompatibilityXml();
-    SaveToCache();
+      s_cache_buffer = std::move(data);
+      SetCacheData(s_cache_buffer.data(), s_cache_buffer.size());
+      if (!LoadEntriesFromCacheData(gamedb_ts, gamesettings_ts, compat_ts))
+      {
+        Log_ErrorPrintf("Failed to load built game database");
+        ReleaseCacheData();
+      }
+    }
   }
 
   Log_InfoPrintf("Database load took %.2f ms", timer.GetTimeMilliseconds());
@@ -101,8 +244,8 @@ void GameDatabase::EnsureLoaded()
 
 void GameDatabase::Unload()
 {
-  s_entries = {};
-  s_code_lookup = {};
+  std::unique_lock lock(s_load_mutex);
+  ReleaseCacheData();
   s_loaded = false;
 }
 
@@ -110,8 +253,11 @@ const GameDatabase::Entry* GameDatabase::GetEntryForId(const std::string_view& c
 {
   EnsureLoaded();
 
-  auto iter = UnorderedStringMapFind(s_code_lookup, code);
-  return (iter != s_code_lookup.end()) ? &s_entries[iter->second] : nullptr;
+  const u32 index = LookupPerfectHash(code, s_code_buckets, s_num_code_buckets, s_code_slots, s_num_code_slots);
+  if (index == EMPTY_HASH_SLOT || GetCacheString(s_cache_codes[index].code) != code)
+    return nullptr;
+
+  return &s_entries[s_cache_codes[index].entry_index];
 }
 
 std::string GameDatabase::GetSerialForDisc(CDImage* image)
@@ -165,7 +311,9 @@ const GameDatabase::Entry* GameDatabase::GetEntryForSerial(const std::string_vie
 {
   EnsureLoaded();
 
-  return GetMutableEntry(serial);
+  const u32 index =
+    LookupPerfectHash(serial, s_serial_buckets, s_num_serial_buckets, s_serial_slots, s_num_serial_slots);
+  return (index != EMPTY_HASH_SLOT && s_entries[index].serial == serial) ? &s_entries[index] : nullptr;
 }
 
 GameDatabase::Entry* GameDatabase::GetMutableEntry(const std::string_view& serial)
@@ -440,6 +588,12 @@ void GameDatabase::Entry::ApplySettings(Settings& settings, bool display_osd_mes
     settings.cpu_fastmem_mode = CPUFastmemMode::LUT;
   }
 
+  if (settings.cpu_idle_loop_skipping && HasTrait(Trait::DisableIdleLoopSkipping))
+  {
+    Log_WarningPrint("Idle loop skipping disabled by game settings.");
+    settings.cpu_idle_loop_skipping = false;
+  }
+
 #define BIT_FOR(ctype) (static_cast<u32>(1) << static_cast<u32>(ctype))
 
   if (supported_controllers != 0 && supported_controllers != static_cast<u32>(-1))
@@ -491,218 +645,437 @@ void GameDatabase::Entry::ApplySettings(Settings& settings, bool display_osd_mes
 #undef BIT_FOR
 }
 
-static void GetTimestamps(u64* gamedb_ts, u64* gamesettings_ts, u64* compat_ts)
+void GameDatabase::GetTimestamps(u64* gamedb_ts, u64* gamesettings_ts, u64* compat_ts)
 {
   *gamedb_ts = Host::GetResourceFileTimestamp("database/gamedb.json").value_or(0);
   *gamesettings_ts = Host::GetResourceFileTimestamp("database/gamesettings.ini").value_or(0);
   *compat_ts = Host::GetResourceFileTimestamp("database/compatibility.xml").value_or(0);
 }
 
-template<typename T>
-bool ReadOptionalFromStream(ByteStream* stream, std::optional<T>* dest)
+static std::string GetCacheFile()
 {
-  bool has_value;
-  if (!stream->Read2(&has_value, sizeof(has_value)))
-    return false;
+  return Path::Combine(EmuFolders::Cache, "gamedb.cache");
+}
 
-  if (!has_value)
-    return true;
+u64 GameDatabase::HashKey(const std::string_view& key, u32 seed)
+{
+  return XXH64(key.data(), key.size(), seed);
+}
 
-  T value;
-  if (!stream->Read2(&value, sizeof(T)))
-    return false;
+u32 GameDatabase::LookupPerfectHash(const std::string_view& key, const u32* buckets, u32 num_buckets,
+                                    const u32* slots, u32 num_slots)
+{
+  if (num_slots == 0)
+    return EMPTY_HASH_SLOT;
 
-  *dest = value;
-  return true;
+  const u32 seed = buckets[HashKey(key, 0) % num_buckets];
+  return slots[HashKey(key, seed) % num_slots];
 }
 
-template<typename T>
-bool WriteOptionalToStream(ByteStream* stream, const std::optional<T>& src)
+bool GameDatabase::BuildPerfectHash(const std::vector<std::string_view>& keys, std::vector<u32>* buckets,
+                                    std::vector<u32>* slots)
 {
-  const bool has_value = src.has_value();
-  if (!stream->Write2(&has_value, sizeof(has_value)))
-    return false;
+  // hash and displace: the keys are split into small buckets, and each bucket gets a seed which moves all of its
+  // keys into free slots. the keys must be unique, the slots hold the index of the key which maps to them.
+  const u32 num_keys = static_cast<u32>(keys.size());
+  const u32 num_slots = num_keys + (num_keys / 4);
+  const u32 num_buckets = std::max<u32>(num_keys / PERFECT_HASH_KEYS_PER_BUCKET, 1);
+
+  std::vector<std::vector<u32>> bucket_keys(num_buckets);
+  for (u32 i = 0; i < num_keys; i++)
+    bucket_keys[HashKey(keys[i], 0) % num_buckets].push_back(i);
+
+  // largest buckets first, while there's the most room
+  std::vector<u32> order(num_buckets);
+  for (u32 i = 0; i < num_buckets; i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&bucket_keys](u32 lhs, u32 rhs) {
+    return bucket_keys[lhs].size() > bucket_keys[rhs].size();
+  });
+
+  buckets->assign(num_buckets, 0);
+  slots->assign(num_slots, EMPTY_HASH_SLOT);
+
+  std::vector<u32> bucket_slots;
+  for (const u32 bucket : order)
+  {
+    const std::vector<u32>& bkeys = bucket_keys[bucket];
+    if (bkeys.empty())
+      break;
+
+    u32 seed = 1;
+    for (; seed < MAX_PERFECT_HASH_SEED; seed++)
+    {
+      bucket_slots.clear();
+      for (const u32 key : bkeys)
+      {
+        const u32 slot = static_cast<u32>(HashKey(keys[key], seed) % num_slots);
+        if ((*slots)[slot] != EMPTY_HASH_SLOT ||
+            std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end())
+        {
+          break;
+        }
 
-  if (!has_value)
-    return true;
+        bucket_slots.push_back(slot);
+      }
 
-  return stream->Write2(&src.value(), sizeof(T));
+      if (bucket_slots.size() == bkeys.size())
+        break;
+    }
+
+    if (seed == MAX_PERFECT_HASH_SEED)
+      return false;
+
+    (*buckets)[bucket] = seed;
+    for (size_t i = 0; i < bkeys.size(); i++)
+      (*slots)[bucket_slots[i]] = bkeys[i];
+  }
+
+  return true;
 }
 
-static std::string GetCacheFile()
+std::string_view GameDatabase::GetCacheString(const CacheString& str)
 {
-  return Path::Combine(EmuFolders::Cache, "gamedb.cache");
+  return std::string_view(s_cache_strings + str.offset, str.length);
 }
 
-bool GameDatabase::LoadFromCache()
+void GameDatabase::SetCacheData(const u8* data, size_t size)
 {
-  std::unique_ptr<ByteStream> stream(
-    ByteStream::OpenFile(GetCacheFile().c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED));
-  if (!stream)
-  {
-    Log_DevPrintf("Cache does not exist, loading full database.");
-    return false;
-  }
+  s_cache_data = data;
+  s_cache_data_size = size;
+}
 
-  u64 gamedb_ts, gamesettings_ts, compat_ts;
-  GetTimestamps(&gamedb_ts, &gamesettings_ts, &compat_ts);
+bool GameDatabase::LoadEntriesFromCacheData(u64 gamedb_ts, u64 gamesettings_ts, u64 compat_ts)
+{
+  if (s_cache_data_size < sizeof(CacheHeader))
+    return false;
 
-  u32 signature, version, num_entries, num_codes;
-  u64 file_gamedb_ts, file_gamesettings_ts, file_compat_ts;
-  if (!stream->ReadU32(&signature) || !stream->ReadU32(&version) || !stream->ReadU64(&file_gamedb_ts) ||
-      !stream->ReadU64(&file_gamesettings_ts) || !stream->ReadU64(&file_compat_ts) || !stream->ReadU32(&num_entries) ||
-      !stream->ReadU32(&num_codes) || signature != GAME_DATABASE_CACHE_SIGNATURE ||
-      version != GAME_DATABASE_CACHE_VERSION)
+  CacheHeader header;
+  std::memcpy(&header, s_cache_data, sizeof(header));
+  if (header.signature != GAME_DATABASE_CACHE_SIGNATURE || header.version != GAME_DATABASE_CACHE_VERSION)
   {
     Log_DevPrintf("Cache header is corrupted or version mismatch.");
     return false;
   }
 
-  if (gamedb_ts != file_gamedb_ts || gamesettings_ts != file_gamesettings_ts || compat_ts != file_compat_ts)
+  if (header.gamedb_ts != gamedb_ts || header.gamesettings_ts != gamesettings_ts || header.compat_ts != compat_ts)
   {
     Log_DevPrintf("Cache is out of date, recreating.");
     return false;
   }
 
-  s_entries.reserve(num_entries);
-
-  for (u32 i = 0; i < num_entries; i++)
+  const u64 expected_size =
+    sizeof(CacheHeader) + static_cast<u64>(header.num_entries) * sizeof(CacheEntry) +
+    static_cast<u64>(header.num_codes) * sizeof(CacheCode) +
+    (static_cast<u64>(header.num_code_buckets) + header.num_code_slots + header.num_serial_buckets +
+     header.num_serial_slots) *
+      sizeof(u32) +
+    header.string_table_size;
+  if (expected_size != s_cache_data_size || (header.num_code_slots > 0 && header.num_code_buckets == 0) ||
+      (header.num_serial_slots > 0 && header.num_serial_buckets == 0))
   {
-    Entry& entry = s_entries.emplace_back();
+    Log_DevPrintf("Cache is corrupted.");
+    return false;
+  }
 
-    constexpr u32 num_bytes = (static_cast<u32>(Trait::Count) + 7) / 8;
-    std::array<u8, num_bytes> bits;
-    u8 compatibility;
-
-    if (!stream->ReadSizePrefixedString(&entry.serial) || !stream->ReadSizePrefixedString(&entry.title) ||
-        !stream->ReadSizePrefixedString(&entry.genre) || !stream->ReadSizePrefixedString(&entry.developer) ||
-        !stream->ReadSizePrefixedString(&entry.publisher) || !stream->ReadU64(&entry.release_date) ||
-        !stream->ReadU8(&entry.min_players) || !stream->ReadU8(&entry.max_players) ||
-        !stream->ReadU8(&entry.min_blocks) || !stream->ReadU8(&entry.max_blocks) ||
-        !stream->ReadU32(&entry.supported_controllers) || !stream->ReadU8(&compatibility) ||
-        compatibility >= static_cast<u8>(GameDatabase::CompatibilityRating::Count) ||
-        !stream->Read2(bits.data(), num_bytes) ||
-        !ReadOptionalFromStream(stream.get(), &entry.display_active_start_offset) ||
-        !ReadOptionalFromStream(stream.get(), &entry.display_active_end_offset) ||
-        !ReadOptionalFromStream(stream.get(), &entry.display_line_start_offset) ||
-        !ReadOptionalFromStream(stream.get(), &entry.display_line_end_offset) ||
-        !ReadOptionalFromStream(stream.get(), &entry.dma_max_slice_ticks) ||
-        !ReadOptionalFromStream(stream.get(), &entry.dma_halt_ticks) ||
-        !ReadOptionalFromStream(stream.get(), &entry.gpu_fifo_size) ||
-        !ReadOptionalFromStream(stream.get(), &entry.gpu_max_run_ahead) ||
-        !ReadOptionalFromStream(stream.get(), &entry.gpu_pgxp_tolerance) ||
-        !ReadOptionalFromStream(stream.get(), &entry.gpu_pgxp_depth_threshold))
-    {
-      Log_DevPrintf("Cache entry is corrupted.");
+  // everything is aligned to four bytes, and the entries to eight, so the tables can be used in place
+  const u8* ptr = s_cache_data + sizeof(CacheHeader);
+  const CacheEntry* cache_entries = reinterpret_cast<const CacheEntry*>(ptr);
+  ptr += header.num_entries * sizeof(CacheEntry);
+  s_cache_codes = reinterpret_cast<const CacheCode*>(ptr);
+  ptr += header.num_codes * sizeof(CacheCode);
+  s_code_buckets = reinterpret_cast<const u32*>(ptr);
+  ptr += header.num_code_buckets * sizeof(u32);
+  s_code_slots = reinterpret_cast<const u32*>(ptr);
+  ptr += header.num_code_slots * sizeof(u32);
+  s_serial_buckets = reinterpret_cast<const u32*>(ptr);
+  ptr += header.num_serial_buckets * sizeof(u32);
+  s_serial_slots = reinterpret_cast<const u32*>(ptr);
+  ptr += header.num_serial_slots * sizeof(u32);
+  s_cache_strings = reinterpret_cast<const char*>(ptr);
+  s_num_codes = header.num_codes;
+  s_num_code_buckets = header.num_code_buckets;
+  s_num_code_slots = header.num_code_slots;
+  s_num_serial_buckets = header.num_serial_buckets;
+  s_num_serial_slots = header.num_serial_slots;
+
+  const auto check_string = [&header](const CacheString& str) {
+    return (str.offset <= header.string_table_size && str.length <= (header.string_table_size - str.offset));
+  };
+  for (u32 i = 0; i < header.num_codes; i++)
+  {
+    if (!check_string(s_cache_codes[i].code) || s_cache_codes[i].entry_index >= header.num_entries)
+      return false;
+  }
+  for (u32 i = 0; i < header.num_code_slots; i++)
+  {
+    if (s_code_slots[i] != EMPTY_HASH_SLOT && s_code_slots[i] >= header.num_codes)
+      return false;
+  }
+  for (u32 i = 0; i < header.num_serial_slots; i++)
+  {
+    if (s_serial_slots[i] != EMPTY_HASH_SLOT && s_serial_slots[i] >= header.num_entries)
       return false;
-    }
-
-    entry.compatibility = static_cast<GameDatabase::CompatibilityRating>(compatibility);
-    entry.traits.reset();
-    for (u32 j = 0; j < static_cast<int>(Trait::Count); j++)
-    {
-      if ((bits[j / 8] & (1u << (j % 8))) != 0)
-        entry.traits[j] = true;
-    }
   }
 
-  for (u32 i = 0; i < num_codes; i++)
+  // the strings stay in the cache data, so this doesn't allocate anything beyond the array
+  s_entries.resize(header.num_entries);
+  for (u32 i = 0; i < header.num_entries; i++)
   {
-    std::string code;
-    u32 index;
-    if (!stream->ReadSizePrefixedString(&code) || !stream->ReadU32(&index) ||
-        index >= static_cast<u32>(s_entries.size()))
+    const CacheEntry& ce = cache_entries[i];
+    Entry& entry = s_entries[i];
+    if (!check_string(ce.serial) || !check_string(ce.title) || !check_string(ce.genre) ||
+        !check_string(ce.developer) || !check_string(ce.publisher) ||
+        ce.compatibility >= static_cast<u8>(CompatibilityRating::Count))
     {
-      Log_DevPrintf("Cache code entry is corrupted.");
+      Log_DevPrintf("Cache entry is corrupted.");
       return false;
     }
 
-    s_code_lookup.emplace(std::move(code), index);
+    entry.serial = GetCacheString(ce.serial);
+    entry.title = GetCacheString(ce.title);
+    entry.genre = GetCacheString(ce.genre);
+    entry.developer = GetCacheString(ce.developer);
+    entry.publisher = GetCacheString(ce.publisher);
+    entry.release_date = ce.release_date;
+    entry.min_players = ce.min_players;
+    entry.max_players = ce.max_players;
+    entry.min_blocks = ce.min_blocks;
+    entry.max_blocks = ce.max_blocks;
+    entry.supported_controllers = ce.supported_controllers;
+    entry.compatibility = static_cast<CompatibilityRating>(ce.compatibility);
+    entry.traits = std::bitset<static_cast<int>(Trait::Count)>(ce.traits);
+
+#define GET_OPTIONAL(field, bit)                                                                                       \
+  if (ce.optional_fields & (bit))                                                                                      \
+    entry.field = ce.field;
+
+    GET_OPTIONAL(display_active_start_offset, CACHE_HAS_DISPLAY_ACTIVE_START_OFFSET);
+    GET_OPTIONAL(display_active_end_offset, CACHE_HAS_DISPLAY_ACTIVE_END_OFFSET);
+    GET_OPTIONAL(display_line_start_offset, CACHE_HAS_DISPLAY_LINE_START_OFFSET);
+    GET_OPTIONAL(display_line_end_offset, CACHE_HAS_DISPLAY_LINE_END_OFFSET);
+    GET_OPTIONAL(dma_max_slice_ticks, CACHE_HAS_DMA_MAX_SLICE_TICKS);
+    GET_OPTIONAL(dma_halt_ticks, CACHE_HAS_DMA_HALT_TICKS);
+    GET_OPTIONAL(gpu_fifo_size, CACHE_HAS_GPU_FIFO_SIZE);
+    GET_OPTIONAL(gpu_max_run_ahead, CACHE_HAS_GPU_MAX_RUN_AHEAD);
+    GET_OPTIONAL(gpu_pgxp_tolerance, CACHE_HAS_GPU_PGXP_TOLERANCE);
+    GET_OPTIONAL(gpu_pgxp_depth_threshold, CACHE_HAS_GPU_PGXP_DEPTH_THRESHOLD);
+
+#undef GET_OPTIONAL
   }
 
   return true;
 }
 
-bool GameDatabase::SaveToCache()
+bool GameDatabase::LoadFromCache()
 {
-  u64 gamedb_ts, gamesettings_ts, compat_ts;
-  GetTimestamps(&gamedb_ts, &gamesettings_ts, &compat_ts);
-
-  std::unique_ptr<ByteStream> stream(
-    ByteStream::OpenFile(GetCacheFile().c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE |
-                                                   BYTESTREAM_OPEN_TRUNCATE | BYTESTREAM_OPEN_STREAMED));
-  if (!stream)
+  const std::string filename(GetCacheFile());
+  s_cache_file = FileSystem::OpenCFile(filename.c_str(), "rb");
+  if (!s_cache_file)
+  {
+    Log_DevPrintf("Cache does not exist, loading full database.");
     return false;
+  }
+
+  const s64 size = FileSystem::FSize64(s_cache_file);
+  const void* mapping = (size > 0) ? FileSystem::MapCFile(s_cache_file, static_cast<size_t>(size)) : nullptr;
+  if (mapping)
+  {
+    SetCacheData(static_cast<const u8*>(mapping), static_cast<size_t>(size));
+    s_cache_mapped = true;
+
+    u64 gamedb_ts, gamesettings_ts, compat_ts;
+    GetTimestamps(&gamedb_ts, &gamesettings_ts, &compat_ts);
+    if (LoadEntriesFromCacheData(gamedb_ts, gamesettings_ts, compat_ts))
+      return true;
+  }
+
+  ReleaseCacheData();
+  return false;
+}
 
-  bool result = stream->WriteU32(GAME_DATABASE_CACHE_SIGNATURE);
-  result = result && stream->WriteU32(GAME_DATABASE_CACHE_VERSION);
-  result = result && stream->WriteU64(static_cast<u64>(gamedb_ts));
-  result = result && stream->WriteU64(static_cast<u64>(gamesettings_ts));
-  result = result && stream->WriteU64(static_cast<u64>(compat_ts));
+void GameDatabase::ReleaseCacheData()
+{
+  s_entries = {};
 
-  result = result && stream->WriteU32(static_cast<u32>(s_entries.size()));
-  result = result && stream->WriteU32(static_cast<u32>(s_code_lookup.size()));
+  if (s_cache_mapped)
+  {
+    FileSystem::UnmapCFile(s_cache_data, s_cache_data_size);
+    s_cache_mapped = false;
+  }
+  if (s_cache_file)
+  {
+    std::fclose(s_cache_file);
+    s_cache_file = nullptr;
+  }
+  s_cache_buffer = {};
+
+  SetCacheData(nullptr, 0);
+  s_cache_codes = nullptr;
+  s_code_buckets = nullptr;
+  s_code_slots = nullptr;
+  s_serial_buckets = nullptr;
+  s_serial_slots = nullptr;
+  s_cache_strings = nullptr;
+  s_num_codes = 0;
+  s_num_code_buckets = 0;
+  s_num_code_slots = 0;
+  s_num_serial_buckets = 0;
+  s_num_serial_slots = 0;
+}
 
+bool GameDatabase::BuildCache(u64 gamedb_ts, u64 gamesettings_ts, u64 compat_ts, std::vector<u8>* data)
+{
+  // genres, developers and publishers repeat a lot, so each distinct string is only stored once
+  std::string strings;
+  std::unordered_map<std::string_view, CacheString> string_offsets;
+  const auto add_string = [&strings, &string_offsets](const std::string_view& str) {
+    auto iter = string_offsets.find(str);
+    if (iter != string_offsets.end())
+      return iter->second;
+
+    const CacheString ref = {static_cast<u32>(strings.size()), static_cast<u32>(str.length())};
+    strings.append(str);
+    string_offsets.emplace(str, ref);
+    return ref;
+  };
+
+  std::vector<CacheEntry> cache_entries;
+  std::vector<std::string_view> serial_keys;
+  std::vector<u32> serial_key_entries;
+  std::unordered_map<std::string_view, u32> seen_serials;
+  cache_entries.reserve(s_entries.size());
   for (const Entry& entry : s_entries)
   {
-    result = result && stream->WriteSizePrefixedString(entry.serial);
-    result = result && stream->WriteSizePrefixedString(entry.title);
-    result = result && stream->WriteSizePrefixedString(entry.genre);
-    result = result && stream->WriteSizePrefixedString(entry.developer);
-    result = result && stream->WriteSizePrefixedString(entry.publisher);
-    result = result && stream->WriteU64(entry.release_date);
-    result = result && stream->WriteU8(entry.min_players);
-    result = result && stream->WriteU8(entry.max_players);
-    result = result && stream->WriteU8(entry.min_blocks);
-    result = result && stream->WriteU8(entry.max_blocks);
-    result = result && stream->WriteU32(entry.supported_controllers);
-    result = result && stream->WriteU8(static_cast<u8>(entry.compatibility));
-
-    constexpr u32 num_bytes = (static_cast<u32>(Trait::Count) + 7) / 8;
-    std::array<u8, num_bytes> bits;
-    bits.fill(0);
-    for (u32 j = 0; j < static_cast<int>(Trait::Count); j++)
+    CacheEntry& ce = cache_entries.emplace_back();
+    std::memset(&ce, 0, sizeof(ce));
+    ce.serial = add_string(entry.serial);
+    ce.title = add_string(entry.title);
+    ce.genre = add_string(entry.genre);
+    ce.developer = add_string(entry.developer);
+    ce.publisher = add_string(entry.publisher);
+    ce.release_date = entry.release_date;
+    ce.supported_controllers = entry.supported_controllers;
+    ce.traits = static_cast<u32>(entry.traits.to_ulong());
+    ce.min_players = entry.min_players;
+    ce.max_players = entry.max_players;
+    ce.min_blocks = entry.min_blocks;
+    ce.max_blocks = entry.max_blocks;
+    ce.compatibility = static_cast<u8>(entry.compatibility);
+
+#define SET_OPTIONAL(field, bit)                                                                                       \
+  if (entry.field.has_value())                                                                                         \
+  {                                                                                                                    \
+    ce.field = entry.field.value();                                                                                    \
+    ce.optional_fields |= (bit);                                                                                       \
+  }
+
+    SET_OPTIONAL(display_active_start_offset, CACHE_HAS_DISPLAY_ACTIVE_START_OFFSET);
+    SET_OPTIONAL(display_active_end_offset, CACHE_HAS_DISPLAY_ACTIVE_END_OFFSET);
+    SET_OPTIONAL(display_line_start_offset, CACHE_HAS_DISPLAY_LINE_START_OFFSET);
+    SET_OPTIONAL(display_line_end_offset, CACHE_HAS_DISPLAY_LINE_END_OFFSET);
+    SET_OPTIONAL(dma_max_slice_ticks, CACHE_HAS_DMA_MAX_SLICE_TICKS);
+    SET_OPTIONAL(dma_halt_ticks, CACHE_HAS_DMA_HALT_TICKS);
+    SET_OPTIONAL(gpu_fifo_size, CACHE_HAS_GPU_FIFO_SIZE);
+    SET_OPTIONAL(gpu_max_run_ahead, CACHE_HAS_GPU_MAX_RUN_AHEAD);
+    SET_OPTIONAL(gpu_pgxp_tolerance, CACHE_HAS_GPU_PGXP_TOLERANCE);
+    SET_OPTIONAL(gpu_pgxp_depth_threshold, CACHE_HAS_GPU_PGXP_DEPTH_THRESHOLD);
+
+#undef SET_OPTIONAL
+
+    // the first entry with a serial is the one which is returned
+    const u32 index = static_cast<u32>(cache_entries.size() - 1);
+    if (seen_serials.emplace(entry.serial, index).second)
     {
-      if (entry.traits[j])
-        bits[j / 8] |= (1u << (j % 8));
+      serial_keys.push_back(entry.serial);
+      serial_key_entries.push_back(index);
     }
+  }
 
-    result = result && stream->Write2(bits.data(), num_bytes);
+  std::vector<CacheCode> cache_codes;
+  std::vector<std::string_view> code_keys;
+  cache_codes.reserve(s_code_lookup.size());
+  code_keys.reserve(s_code_lookup.size());
+  for (const auto& [code, index] : s_code_lookup)
+  {
+    cache_codes.push_back(CacheCode{add_string(code), index});
+    code_keys.push_back(code);
+  }
 
-    result = result && WriteOptionalToStream(stream.get(), entry.display_active_start_offset);
-    result = result && WriteOptionalToStream(stream.get(), entry.display_active_end_offset);
-    result = result && WriteOptionalToStream(stream.get(), entry.display_line_start_offset);
-    result = result && WriteOptionalToStream(stream.get(), entry.display_line_end_offset);
-    result = result && WriteOptionalToStream(stream.get(), entry.dma_max_slice_ticks);
-    result = result && WriteOptionalToStream(stream.get(), entry.dma_halt_ticks);
-    result = result && WriteOptionalToStream(stream.get(), entry.gpu_fifo_size);
-    result = result && WriteOptionalToStream(stream.get(), entry.gpu_max_run_ahead);
-    result = result && WriteOptionalToStream(stream.get(), entry.gpu_pgxp_tolerance);
-    result = result && WriteOptionalToStream(stream.get(), entry.gpu_pgxp_depth_threshold);
+  std::vector<u32> code_buckets, code_slots, serial_buckets, serial_slots;
+  if (!BuildPerfectHash(code_keys, &code_buckets, &code_slots) ||
+      !BuildPerfectHash(serial_keys, &serial_buckets, &serial_slots))
+  {
+    Log_ErrorPrintf("Failed to build game database lookup tables");
+    return false;
   }
 
-  for (const auto& it : s_code_lookup)
+  // the serial table maps to entries, not keys
+  for (u32& slot : serial_slots)
   {
-    result = result && stream->WriteSizePrefixedString(it.first);
-    result = result && stream->WriteU32(it.second);
+    if (slot != EMPTY_HASH_SLOT)
+      slot = serial_key_entries[slot];
   }
 
-  result = result && stream->Flush();
+  CacheHeader header = {};
+  header.signature = GAME_DATABASE_CACHE_SIGNATURE;
+  header.version = GAME_DATABASE_CACHE_VERSION;
+  header.gamedb_ts = gamedb_ts;
+  header.gamesettings_ts = gamesettings_ts;
+  header.compat_ts = compat_ts;
+  header.num_entries = static_cast<u32>(cache_entries.size());
+  header.num_codes = static_cast<u32>(cache_codes.size());
+  header.num_code_buckets = static_cast<u32>(code_buckets.size());
+  header.num_code_slots = static_cast<u32>(code_slots.size());
+  header.num_serial_buckets = static_cast<u32>(serial_buckets.size());
+  header.num_serial_slots = static_cast<u32>(serial_slots.size());
+  header.string_table_size = static_cast<u32>(strings.size());
+
+  data->clear();
+  const auto append = [data](const void* ptr, size_t size) {
+    const u8* bytes = static_cast<const u8*>(ptr);
+    data->insert(data->end(), bytes, bytes + size);
+  };
+  append(&header, sizeof(header));
+  append(cache_entries.data(), cache_entries.size() * sizeof(CacheEntry));
+  append(cache_codes.data(), cache_codes.size() * sizeof(CacheCode));
+  append(code_buckets.data(), code_buckets.size() * sizeof(u32));
+  append(code_slots.data(), code_slots.size() * sizeof(u32));
+  append(serial_buckets.data(), serial_buckets.size() * sizeof(u32));
+  append(serial_slots.data(), serial_slots.size() * sizeof(u32));
+  append(strings.data(), strings.size());
   return true;
 }
 
+bool GameDatabase::SaveToCache(const std::vector<u8>& data)
+{
+  std::unique_ptr<ByteStream> stream(ByteStream::OpenFile(
+    GetCacheFile().c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
+                              BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED));
+  if (!stream)
+    return false;
+
+  if (!stream->Write2(data.data(), static_cast<u32>(data.size())))
+  {
+    stream->Discard();
+    return false;
+  }
+
+  return stream->Commit();
+}
+
 //////////////////////////////////////////////////////////////////////////
 // JSON Parsing
 //////////////////////////////////////////////////////////////////////////
 
-static bool GetStringFromObject(const rapidjson::Value& object, const char* key, std::string* dest)
+static bool GetStringFromObject(const rapidjson::Value& object, const char* key, std::string_view* dest)
 {
-  dest->clear();
+  *dest = std::string_view();
   auto member = object.FindMember(key);
   if (member == object.MemberEnd() || !member->value.IsString())
     return false;
 
-  dest->assign(member->value.GetString(), member->value.GetStringLength());
+  *dest = std::string_view(member->value.GetString(), member->value.GetStringLength());
   return true;
 }
 
@@ -736,7 +1109,7 @@ static bool GetArrayOfStringsFromObject(const rapidjson::Value& object, const ch
   return true;
 }
 
-bool GameDatabase::LoadGameDBJson()
+bool GameDatabase::LoadGameDBJson(rapidjson::Document* json)
 {
   std::optional<std::string> gamedb_data(Host::ReadResourceFileToString("database/gamedb.json"));
   if (!gamedb_data.has_value())
@@ -745,8 +1118,6 @@ bool GameDatabase::LoadGameDBJson()
     return false;
   }
 
-  // TODO: Parse in-place, avoid string allocations.
-  std::unique_ptr<rapidjson::Document> json = std::make_unique<rapidjson::Document>();
   json->Parse(gamedb_data->c_str(), gamedb_data->size());
   if (json->HasParseError())
   {
@@ -808,10 +1179,10 @@ bool GameDatabase::ParseJsonEntry(Entry* entry, const rapidjson::Value& value)
 
   entry->release_date = 0;
   {
-    std::string release_date;
+    std::string_view release_date;
     if (GetStringFromObject(value, "releaseDate", &release_date))
     {
-      std::istringstream iss(release_date);
+      std::istringstream iss{std::string(release_date)};
       struct tm parsed_time = {};
       iss >> std::get_time(&parsed_time, "%Y-%m-%d");
       if (!iss.fail())
@@ -1136,8 +1507,9 @@ bool GameDatabase::LoadTrackHashes()
         continue;
       }
 
-      std::string revisionString;
-      GetStringFromObject(track_revisions, "version", &revisionString);
+      std::string_view revision_view;
+      GetStringFromObject(track_revisions, "version", &revision_view);
+      const std::string revisionString(revision_view);
 
       for (const rapidjson::Value& track : tracks->value.GetArray())
       {
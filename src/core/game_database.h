@@ -44,18 +44,19 @@ enum class Trait : u32
   ForceRecompilerMemoryExceptions,
   ForceRecompilerICache,
   ForceRecompilerLUTFastmem,
+  DisableIdleLoopSkipping,
 
   Count
 };
 
 struct Entry
 {
-  // TODO: Make string_view.
-  std::string serial;
-  std::string title;
-  std::string genre;
-  std::string developer;
-  std::string publisher;
+  // the strings point into the database, and are valid until it's unloaded
+  std::string_view serial;
+  std::string_view title;
+  std::string_view genre;
+  std::string_view developer;
+  std::string_view publisher;
   u64 release_date;
   u8 min_players;
   u8 max_players;
@@ -234,6 +234,43 @@ static std::optional<std::string> Cmd$Z1(const std::string_view& data)
   }
 }
 
+/// Remove write watchpoint.
+static std::optional<std::string> Cmd$z2(const std::string_view& data)
+{
+  std::stringstream ss{std::string{data}};
+  std::string dataAddress;
+
+  std::getline(ss, dataAddress, ',');
+
+  auto address = StringUtil::FromChars<VirtualMemoryAddress>(dataAddress, 16);
+  if (address) {
+    CPU::RemoveWatchpoint(*address);
+    return { "OK" };
+  }
+  else {
+    return std::nullopt;
+  }
+}
+
+/// Insert write watchpoint.
+static std::optional<std::string> Cmd$Z2(const std::string_view& data)
+{
+  std::stringstream ss{std::string{data}};
+  std::string dataAddress, dataLength;
+
+  std::getline(ss, dataAddress, ',');
+  std::getline(ss, dataLength, '\0');
+
+  auto address = StringUtil::FromChars<VirtualMemoryAddress>(dataAddress, 16);
+  auto length = StringUtil::FromChars<u32>(dataLength, 16);
+  if (address && length) {
+    return { CPU::AddWatchpoint(*address, *length) ? "OK" : "E00" };
+  }
+  else {
+    return std::nullopt;
+  }
+}
+
 static std::optional<std::string> Cmd$vMustReplyEmpty(const std::string_view& data)
 {
   return { "" };
@@ -256,6 +293,8 @@ static const std::map<const char*, std::function<std::optional<std::string>(cons
   { "Z0,", Cmd$Z1 },
   { "z1,", Cmd$z1 },
   { "Z1,", Cmd$Z1 },
+  { "z2,", Cmd$z2 },
+  { "Z2,", Cmd$Z2 },
   { "vMustReplyEmpty", Cmd$vMustReplyEmpty },
   { "qSupported", Cmd$qSupported },
 };
@@ -1,13 +1,16 @@
 #include "gpu.h"
+#include "common/byte_stream.h"
 #include "common/file_system.h"
 #include "common/heap_array.h"
 #include "common/log.h"
 #include "common/string_util.h"
 #include "dma.h"
+#include "gpu_dump.h"
 #include "host.h"
 #include "host_display.h"
 #include "imgui.h"
 #include "interrupt_controller.h"
+#include "save_state_version.h"
 #include "settings.h"
 #include "stb_image_write.h"
 #include "system.h"
@@ -24,6 +27,8 @@ GPU::GPU() = default;
 
 GPU::~GPU()
 {
+  StopRecordingDump();
+
   if (g_host_display)
     g_host_display->SetGPUTimingEnabled(false);
 }
@@ -32,6 +37,44 @@ bool GPU::Initialize()
 {
   m_force_progressive_scan = g_settings.gpu_disable_interlacing;
   m_force_ntsc_timings = g_settings.gpu_force_ntsc_timings;
+  CreateTimingEvents();
+  m_fifo_size = g_settings.gpu_fifo_size;
+  m_max_run_ahead = g_settings.gpu_max_run_ahead;
+  m_console_is_pal = System::IsPALRegion();
+  UpdateCRTCConfig();
+  LoadPostProcessingChain();
+
+  g_host_display->SetGPUTimingEnabled(g_settings.display_show_gpu || g_settings.gpu_dynamic_resolution);
+
+  return true;
+}
+
+void GPU::DetachFromSystem()
+{
+  FlushRender();
+  StopRecordingDump();
+  m_crtc_tick_event.reset();
+  m_command_tick_event.reset();
+
+  g_host_display->ClearDisplayTexture();
+  g_host_display->SetGPUTimingEnabled(false);
+  ResetGraphicsAPIState();
+}
+
+bool GPU::AttachToSystem()
+{
+  CreateTimingEvents();
+  RestoreGraphicsAPIState();
+
+  // the post processing chain can change while no system is running, so reload it like Initialize() does
+  UpdateSettings();
+  UpdateCRTCConfig();
+  LoadPostProcessingChain();
+  return true;
+}
+
+void GPU::CreateTimingEvents()
+{
   m_crtc_tick_event = TimingEvents::CreateTimingEvent(
     "GPU CRTC Tick", 1, 1,
     [](void* param, TickCount ticks, TickCount ticks_late) { static_cast<GPU*>(param)->CRTCTickEvent(ticks); }, this,
@@ -40,20 +83,15 @@ bool GPU::Initialize()
     "GPU Command Tick", 1, 1,
     [](void* param, TickCount ticks, TickCount ticks_late) { static_cast<GPU*>(param)->CommandTickEvent(ticks); }, this,
     true);
-  m_fifo_size = g_settings.gpu_fifo_size;
-  m_max_run_ahead = g_settings.gpu_max_run_ahead;
-  m_console_is_pal = System::IsPALRegion();
-  UpdateCRTCConfig();
+}
 
+void GPU::LoadPostProcessingChain()
+{
   if (g_settings.display_post_processing && !g_settings.display_post_process_chain.empty() &&
       !g_host_display->SetPostProcessingChain(g_settings.display_post_process_chain))
   {
     Host::AddOSDMessage(Host::TranslateStdString("OSDMessage", "Failed to load post processing shader chain."), 20.0f);
   }
-
-  g_host_display->SetGPUTimingEnabled(g_settings.display_show_gpu);
-
-  return true;
 }
 
 void GPU::UpdateSettings()
@@ -72,7 +110,7 @@ void GPU::UpdateSettings()
   // Crop mode calls this, so recalculate the display area
   UpdateCRTCDisplayParameters();
 
-  g_host_display->SetGPUTimingEnabled(g_settings.display_show_gpu);
+  g_host_display->SetGPUTimingEnabled(g_settings.display_show_gpu || g_settings.gpu_dynamic_resolution);
 }
 
 bool GPU::IsHardwareRenderer()
@@ -88,6 +126,11 @@ void GPU::CPUClockChanged()
 
 void GPU::UpdateResolutionScale() {}
 
+bool GPU::UpdateDynamicResolution(float gpu_time, float frame_budget)
+{
+  return false;
+}
+
 std::tuple<u32, u32> GPU::GetEffectiveDisplayResolution(bool scaled /* = true */)
 {
   return std::tie(m_crtc_state.display_vram_width, m_crtc_state.display_vram_height);
@@ -165,6 +208,9 @@ void GPU::SoftReset()
 
 bool GPU::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display)
 {
+  if (m_vram_readback_pending)
+    FinishVRAMReadback();
+
   if (sw.IsReading())
   {
     // perform a reset to discard all pending draws/fb state
@@ -253,7 +299,6 @@ bool GPU::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_displ
   if (sw.IsReading())
   {
     m_draw_mode.texture_page_changed = true;
-    m_draw_mode.texture_window_changed = true;
     m_drawing_area_changed = true;
     UpdateDMARequest();
   }
@@ -389,12 +434,18 @@ void GPU::WriteRegister(u32 offset, u32 value)
   switch (offset)
   {
     case 0x00:
+      if (m_gpu_dump)
+        m_gpu_dump->WriteGP0(value);
+
       m_fifo.Push(value);
       ExecuteCommands();
       UpdateCommandTickEvent();
       return;
 
     case 0x04:
+      if (m_gpu_dump)
+        m_gpu_dump->WriteGP1(value);
+
       WriteGP1(value);
       return;
 
@@ -417,6 +468,34 @@ void GPU::DMARead(u32* words, u32 word_count)
     words[i] = ReadGPUREAD();
 }
 
+void GPU::DMAWriteBlock(u32 address, const u32* words, u32 word_count)
+{
+  if (m_gpu_dump)
+  {
+    for (u32 i = 0; i < word_count; i++)
+      m_gpu_dump->WriteGP0(words[i]);
+  }
+
+  // CPU->VRAM data can go straight to the blit buffer when nothing is queued ahead of it, since the FIFO would be
+  // drained into it as soon as the commands are executed anyway.
+  if (m_blitter_state == BlitterState::WritingVRAM && m_fifo.IsEmpty() && !m_syncing &&
+      m_pending_command_ticks <= m_max_run_ahead)
+  {
+    const u32 words_to_copy = std::min(m_blit_remaining_words, word_count);
+    m_blit_buffer.insert(m_blit_buffer.end(), words, words + words_to_copy);
+    m_blit_remaining_words -= words_to_copy;
+    if (m_blit_remaining_words == 0)
+      FinishVRAMWrite();
+
+    words += words_to_copy;
+    address += words_to_copy * sizeof(u32);
+    word_count -= words_to_copy;
+  }
+
+  for (u32 i = 0; i < word_count; i++)
+    m_fifo.Push((ZeroExtend64(address + (i * sizeof(u32))) << 32) | ZeroExtend64(words[i]));
+}
+
 void GPU::EndDMAWrite()
 {
   m_fifo_pushed = true;
@@ -898,8 +977,13 @@ void GPU::CRTCTickEvent(TickCount ticks)
         g_interrupt_controller.InterruptRequest(InterruptController::IRQ::VBLANK);
 
         // flush any pending draws and "scan out" the image
+        if (m_gpu_dump)
+          m_gpu_dump->WriteVSync();
+
+        // frames replayed by runahead are never presented, so don't bother scanning them out
         FlushRender();
-        UpdateDisplay();
+        if (!System::IsReplayingRunahead())
+          UpdateDisplay();
         System::FrameDone();
 
         // switch fields early. this is needed so we draw to the correct one.
@@ -945,6 +1029,9 @@ void GPU::CRTCTickEvent(TickCount ticks)
     m_GPUSTAT.display_line_lsb = ConvertToBoolUnchecked((m_crtc_state.regs.Y + m_crtc_state.current_scanline) & u32(1));
   }
 
+  if (m_gpu_dump)
+    m_gpu_dump->WriteCRTCState(m_crtc_state.interlaced_field, m_crtc_state.active_line_lsb);
+
   UpdateCRTCTickEvent();
 }
 
@@ -1011,6 +1098,12 @@ u32 GPU::ReadGPUREAD()
   if (m_blitter_state != BlitterState::ReadingVRAM)
     return m_GPUREAD_latch;
 
+  if (m_vram_readback_pending)
+    FinishVRAMReadback();
+
+  if (m_gpu_dump)
+    m_gpu_dump->WriteGPUREAD();
+
   // Read two pixels out of VRAM and combine them. Zero fill odd pixel counts.
   u32 value = 0;
   for (u32 i = 0; i < 2; i++)
@@ -1287,6 +1380,16 @@ void GPU::UpdateDisplay() {}
 
 void GPU::ReadVRAM(u32 x, u32 y, u32 width, u32 height) {}
 
+void GPU::BeginVRAMReadback(u32 x, u32 y, u32 width, u32 height)
+{
+  ReadVRAM(x, y, width, height);
+}
+
+void GPU::FinishVRAMReadback()
+{
+  m_vram_readback_pending = false;
+}
+
 void GPU::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
 {
   const u16 color16 = VRAMRGBA8888ToRGBA5551(color);
@@ -1493,8 +1596,6 @@ void GPU::SetTextureWindow(u32 value)
   if (m_draw_mode.texture_window_value == value)
     return;
 
-  FlushRender();
-
   const u8 mask_x = Truncate8(value & UINT32_C(0x1F));
   const u8 mask_y = Truncate8((value >> 5) & UINT32_C(0x1F));
   const u8 offset_x = Truncate8((value >> 10) & UINT32_C(0x1F));
@@ -1506,7 +1607,12 @@ void GPU::SetTextureWindow(u32 value)
   m_draw_mode.texture_window.or_x = (offset_x & mask_x) * 8u;
   m_draw_mode.texture_window.or_y = (offset_y & mask_y) * 8u;
   m_draw_mode.texture_window_value = value;
-  m_draw_mode.texture_window_changed = true;
+}
+
+const u16* GPU::ReadbackVRAM()
+{
+  ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+  return m_vram_ptr;
 }
 
 bool GPU::DumpVRAMToFile(const char* filename)
@@ -1563,6 +1669,124 @@ bool GPU::DumpVRAMToFile(const char* filename, u32 width, u32 height, u32 stride
   return (stbi_write_png_to_func(write_func, fp.get(), width, height, 4, rgba8_buf.get(), sizeof(u32) * width) != 0);
 }
 
+bool GPU::StartRecordingDump(const char* path)
+{
+  StopRecordingDump();
+
+  std::unique_ptr<GrowableMemoryByteStream> stream = ByteStream::CreateGrowableMemoryStream();
+  {
+    StateWrapper sw(stream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+    if (!DoState(sw, nullptr, false))
+    {
+      Log_ErrorPrintf("Failed to save GPU state for dump");
+      return false;
+    }
+  }
+
+  m_gpu_dump = GPUDump::Recorder::Create(path, stream->GetMemoryPointer(), static_cast<u32>(stream->GetSize()),
+                                         SAVE_STATE_VERSION, m_console_is_pal);
+  if (!m_gpu_dump)
+    return false;
+
+  Log_InfoPrintf("Started recording GPU dump to '%s'", path);
+  return true;
+}
+
+void GPU::StopRecordingDump()
+{
+  if (!m_gpu_dump)
+    return;
+
+  if (!m_gpu_dump->Close())
+    Log_ErrorPrintf("Errors occurred while writing GPU dump");
+
+  m_gpu_dump.reset();
+  Log_InfoPrintf("Stopped recording GPU dump");
+}
+
+void GPU::WriteDumpGP0(u32 value)
+{
+  m_gpu_dump->WriteGP0(value);
+}
+
+void GPU::DrainDumpFIFO()
+{
+  // commands are executed as soon as all their words arrive, since there's no CPU to wait for
+  while (!m_fifo.IsEmpty())
+  {
+    const u32 fifo_size = m_fifo.GetSize();
+    m_pending_command_ticks = 0;
+    ExecuteCommands();
+    if (m_fifo.GetSize() == fifo_size)
+      break;
+  }
+
+  m_pending_command_ticks = 0;
+  UpdateCommandTickEvent();
+}
+
+void GPU::ProcessDumpPacket(GPUDump::PacketType type, const u32* data, u32 count)
+{
+  switch (type)
+  {
+    case GPUDump::PacketType::GPUPort0Data:
+    {
+      for (u32 i = 0; i < count; i++)
+      {
+        if (m_fifo.IsFull())
+          DrainDumpFIFO();
+
+        m_fifo.Push(data[i]);
+      }
+
+      DrainDumpFIFO();
+    }
+    break;
+
+    case GPUDump::PacketType::GPUPort1Data:
+    {
+      for (u32 i = 0; i < count; i++)
+        WriteGP1(data[i]);
+    }
+    break;
+
+    case GPUDump::PacketType::ReadGPUREAD:
+    {
+      const u32 num_reads = (count > 0) ? data[0] : 0;
+      for (u32 i = 0; i < num_reads; i++)
+        ReadGPUREAD();
+    }
+    break;
+
+    case GPUDump::PacketType::CRTCState:
+    {
+      if (count > 0)
+      {
+        m_crtc_state.interlaced_field = Truncate8(data[0] & 1u);
+        m_crtc_state.active_line_lsb = Truncate8((data[0] >> 8) & 1u);
+      }
+    }
+    break;
+
+    case GPUDump::PacketType::VSync:
+    {
+      FlushRender();
+      UpdateDisplay();
+      System::FrameDone();
+
+      if (m_GPUSTAT.InInterleaved480iMode())
+        m_crtc_state.interlaced_display_field = m_crtc_state.interlaced_field ^ 1u;
+      else
+        m_crtc_state.interlaced_display_field = 0;
+    }
+    break;
+
+    default:
+      Log_WarningPrintf("Unknown GPU dump packet type %u", static_cast<u32>(type));
+      break;
+  }
+}
+
 void GPU::DrawDebugStateWindow()
 {
   const float framebuffer_scale = Host::GetOSDScale();
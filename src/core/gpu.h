@@ -20,6 +20,11 @@ class GPUTexture;
 class TimingEvent;
 class Timers;
 
+namespace GPUDump {
+enum class PacketType : u8;
+class Recorder;
+} // namespace GPUDump
+
 namespace Threading
 {
 class Thread;
@@ -83,6 +88,11 @@ public:
 
   virtual bool Initialize();
   virtual void Reset(bool clear_vram);
+
+  /// Drops everything tied to the running system, keeping the device resources and pipelines, so the renderer can be
+  /// reused by the next boot. AttachToSystem() picks up the new system and any settings changed in the meantime.
+  virtual void DetachFromSystem();
+  virtual bool AttachToSystem();
   virtual bool DoState(StateWrapper& sw, GPUTexture** save_to_texture, bool update_display);
 
   // Graphics API state reset/restore - call when drawing the UI etc.
@@ -106,7 +116,12 @@ public:
   ALWAYS_INLINE void DMAWrite(u32 address, u32 value)
   {
     m_fifo.Push((ZeroExtend64(address) << 32) | ZeroExtend64(value));
+    if (m_gpu_dump)
+      WriteDumpGP0(value);
   }
+
+  /// Writes a contiguous block of words from RAM, starting at address.
+  void DMAWriteBlock(u32 address, const u32* words, u32 word_count);
   void EndDMAWrite();
 
   /// Returns true if no data is being sent from VRAM to the DAC or that no portion of VRAM would be visible on screen.
@@ -146,6 +161,10 @@ public:
   /// Updates the resolution scale when it's set to automatic.
   virtual void UpdateResolutionScale();
 
+  /// Steps the resolution scale up or down to fit the GPU time per frame into the frame budget, both in milliseconds.
+  /// Returns true if the resolution changed.
+  virtual bool UpdateDynamicResolution(float gpu_time, float frame_budget);
+
   /// Returns the effective display resolution of the GPU.
   virtual std::tuple<u32, u32> GetEffectiveDisplayResolution(bool scaled = true);
 
@@ -177,6 +196,9 @@ public:
   // gpu_sw.cpp
   static std::unique_ptr<GPU> CreateSoftwareRenderer();
 
+  // gpu_null.cpp
+  static std::unique_ptr<GPU> CreateNullRenderer();
+
   // Converts window coordinates into horizontal ticks and scanlines. Returns false if out of range. Used for lightguns.
   bool ConvertScreenCoordinatesToBeamTicksAndLines(s32 window_x, s32 window_y, float x_scale, u32* out_tick,
                                                    u32* out_line) const;
@@ -187,6 +209,17 @@ public:
   // Dumps raw VRAM to a file.
   bool DumpVRAMToFile(const char* filename);
 
+  // Reads back VRAM from the host GPU if needed, returning the CPU copy. Only valid until the GPU next executes.
+  const u16* ReadbackVRAM();
+
+  // Records the GPU state and command stream to a file, for replaying without the rest of the system.
+  ALWAYS_INLINE bool IsRecordingDump() const { return static_cast<bool>(m_gpu_dump); }
+  bool StartRecordingDump(const char* path);
+  void StopRecordingDump();
+
+  // Executes a packet from a GPU dump.
+  void ProcessDumpPacket(GPUDump::PacketType type, const u32* data, u32 count);
+
 protected:
   TickCount CRTCTicksToSystemTicks(TickCount crtc_ticks, TickCount fractional_ticks) const;
   TickCount SystemTicksToCRTCTicks(TickCount sysclk_ticks, TickCount* fractional_ticks) const;
@@ -213,6 +246,9 @@ protected:
 
   void SoftReset();
 
+  void CreateTimingEvents();
+  void LoadPostProcessingChain();
+
   // Sets dots per scanline
   void UpdateCRTCConfig();
   void UpdateCRTCDisplayParameters();
@@ -282,6 +318,11 @@ protected:
 
   // Rendering in the backend
   virtual void ReadVRAM(u32 x, u32 y, u32 width, u32 height);
+
+  /// Reads back VRAM for a VRAM->CPU transfer. Backends which can do this without stalling set
+  /// m_vram_readback_pending, and the shadow copy is completed by FinishVRAMReadback() before it is next accessed.
+  virtual void BeginVRAMReadback(u32 x, u32 y, u32 width, u32 height);
+  virtual void FinishVRAMReadback();
   virtual void FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color);
   virtual void UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, bool set_mask, bool check_mask);
   virtual void CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height);
@@ -415,7 +456,6 @@ protected:
     bool texture_x_flip;
     bool texture_y_flip;
     bool texture_page_changed;
-    bool texture_window_changed;
 
     /// Returns a rectangle comprising the texture palette area.
     ALWAYS_INLINE_RELEASE Common::Rectangle<u32> GetTexturePaletteRectangle() const
@@ -428,10 +468,6 @@ protected:
     ALWAYS_INLINE bool IsTexturePageChanged() const { return texture_page_changed; }
     ALWAYS_INLINE void SetTexturePageChanged() { texture_page_changed = true; }
     ALWAYS_INLINE void ClearTexturePageChangedFlag() { texture_page_changed = false; }
-
-    ALWAYS_INLINE bool IsTextureWindowChanged() const { return texture_window_changed; }
-    ALWAYS_INLINE void SetTextureWindowChanged() { texture_window_changed = true; }
-    ALWAYS_INLINE void ClearTextureWindowChangedFlag() { texture_window_changed = false; }
   } m_draw_mode = {};
 
   Common::Rectangle<u32> m_drawing_area{0, 0, VRAM_WIDTH, VRAM_HEIGHT};
@@ -529,6 +565,9 @@ protected:
   /// GPUREAD value for non-VRAM-reads.
   u32 m_GPUREAD_latch = 0;
 
+  /// True if a VRAM->CPU readback has been started but not yet copied into the shadow copy.
+  bool m_vram_readback_pending = false;
+
   /// True if currently executing/syncing.
   bool m_syncing = false;
   bool m_fifo_pushed = false;
@@ -567,7 +606,14 @@ protected:
   Stats m_stats = {};
   Stats m_last_stats = {};
 
+  std::unique_ptr<GPUDump::Recorder> m_gpu_dump;
+
 private:
+  void WriteDumpGP0(u32 value);
+
+  /// Executes everything in the FIFO during dump playback, ignoring command timing.
+  void DrainDumpFIFO();
+
   using GP0CommandHandler = bool (GPU::*)();
   using GP0CommandHandlerTable = std::array<GP0CommandHandler, 256>;
   static GP0CommandHandlerTable GenerateGP0CommandHandlerTable();
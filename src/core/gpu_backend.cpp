@@ -1,11 +1,38 @@
 #include "gpu_backend.h"
 #include "common/align.h"
 #include "common/log.h"
+#include "common/profiler.h"
+#include "common/platform.h"
+#include "common/threading.h"
 #include "common/timer.h"
+#include "host_time_accounting.h"
 #include "settings.h"
 #include "util/state_wrapper.h"
 Log_SetChannel(GPUBackend);
 
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// How long the GPU thread keeps polling for new commands before sleeping.
+static constexpr double GPU_THREAD_SPIN_TIME_NS = 1 * 1000000;
+
+// How long the CPU thread polls for a sync to complete before sleeping.
+static constexpr double SYNC_SPIN_TIME_NS = 50 * 1000;
+
+ALWAYS_INLINE static void SpinPause()
+{
+#if defined(CPU_X64)
+  _mm_pause();
+#elif defined(CPU_AARCH64) && defined(_MSC_VER)
+  __yield();
+#elif defined(CPU_AARCH64)
+  __asm__ __volatile__("yield");
+#endif
+}
+
 std::unique_ptr<GPUBackend> g_gpu_backend;
 
 GPUBackend::GPUBackend() = default;
@@ -109,6 +136,7 @@ void* GPUBackend::AllocateCommand(GPUBackendCommandType command, u32 size)
       while (available_size < (size + sizeof(GPUBackendCommandType)))
       {
         WakeGPUThread();
+        SpinPause();
         read_ptr = m_command_fifo_read_ptr.load();
         available_size = (read_ptr > write_ptr) ? (read_ptr - write_ptr) : (COMMAND_QUEUE_SIZE - write_ptr);
       }
@@ -155,25 +183,26 @@ void GPUBackend::PushCommand(GPUBackendCommand* cmd)
     const u32 new_write_ptr = m_command_fifo_write_ptr.fetch_add(cmd->size) + cmd->size;
     DebugAssert(new_write_ptr <= COMMAND_QUEUE_SIZE);
     UNREFERENCED_VARIABLE(new_write_ptr);
-    if (GetPendingCommandSize() >= THRESHOLD_TO_WAKE_GPU)
+    if (GetPendingCommandSize() >= (m_lazy_replay ? THRESHOLD_TO_WAKE_GPU_LAZY : THRESHOLD_TO_WAKE_GPU))
       WakeGPUThread();
   }
 }
 
 void GPUBackend::WakeGPUThread()
 {
-  std::unique_lock<std::mutex> lock(m_sync_mutex);
-  if (!m_gpu_thread_sleeping.load())
-    return;
-
-  m_wake_gpu_thread_cv.notify_one();
+  // Whoever clears the flag is responsible for waking the thread, so only one post happens per sleep.
+  if (m_gpu_thread_sleeping.load() && m_gpu_thread_sleeping.exchange(false))
+    m_wake_gpu_thread_semaphore.Post();
 }
 
 void GPUBackend::StartGPUThread()
 {
   m_gpu_loop_done.store(false);
   m_use_gpu_thread = true;
-  m_gpu_thread.Start([this]() { RunGPULoop(); });
+  m_gpu_thread.Start([this]() {
+    Threading::SetNameOfCurrentThread("GPU Thread");
+    RunGPULoop();
+  });
   Log_InfoPrint("GPU thread started.");
 }
 
@@ -192,20 +221,41 @@ void GPUBackend::StopGPUThread()
 void GPUBackend::Sync(bool allow_sleep)
 {
   if (!m_use_gpu_thread)
+  {
+    FlushRender();
     return;
+  }
 
   GPUBackendSyncCommand* cmd =
     static_cast<GPUBackendSyncCommand*>(AllocateCommand(GPUBackendCommandType::Sync, sizeof(GPUBackendSyncCommand)));
   cmd->allow_sleep = allow_sleep;
+  m_sync_done.store(false);
   PushCommand(cmd);
   WakeGPUThread();
 
-  m_sync_semaphore.Wait();
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::GPUSync);
+
+  // The GPU thread is usually not far behind, so avoid the cost of sleeping if it catches up quickly.
+  const Common::Timer::Value start_time = Common::Timer::GetCurrentValue();
+  while (!m_sync_done.load())
+  {
+    if (Common::Timer::ConvertValueToNanoseconds(Common::Timer::GetCurrentValue() - start_time) < SYNC_SPIN_TIME_NS)
+    {
+      SpinPause();
+      continue;
+    }
+
+    // If the GPU thread finished in the meantime and already cleared the flag, its post still has to be consumed.
+    m_cpu_thread_sleeping.store(true);
+    if (!m_sync_done.load() || !m_cpu_thread_sleeping.exchange(false))
+      m_sync_semaphore.Wait();
+
+    break;
+  }
 }
 
 void GPUBackend::RunGPULoop()
 {
-  static constexpr double SPIN_TIME_NS = 1 * 1000000;
   Common::Timer::Value last_command_time = 0;
 
   for (;;)
@@ -214,24 +264,29 @@ void GPUBackend::RunGPULoop()
     u32 read_ptr = m_command_fifo_read_ptr.load();
     if (read_ptr == write_ptr)
     {
+      if (m_gpu_loop_done.load())
+        break;
+
       const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
-      if (Common::Timer::ConvertValueToNanoseconds(current_time - last_command_time) < SPIN_TIME_NS)
+      if (Common::Timer::ConvertValueToNanoseconds(current_time - last_command_time) < GPU_THREAD_SPIN_TIME_NS)
+      {
+        SpinPause();
         continue;
+      }
 
-      std::unique_lock<std::mutex> lock(m_sync_mutex);
+      // Commands pushed after the flag is set will wake us. If some arrived before then, back out of sleeping, but
+      // if the CPU thread has already cleared the flag, its post has to be consumed.
       m_gpu_thread_sleeping.store(true);
-      m_wake_gpu_thread_cv.wait(lock, [this]() { return m_gpu_loop_done.load() || GetPendingCommandSize() > 0; });
-      m_gpu_thread_sleeping.store(false);
+      if ((GetPendingCommandSize() == 0 && !m_gpu_loop_done.load()) || !m_gpu_thread_sleeping.exchange(false))
+        m_wake_gpu_thread_semaphore.Wait();
 
-      if (m_gpu_loop_done.load())
-        break;
-      else
-        continue;
+      continue;
     }
 
     if (write_ptr < read_ptr)
       write_ptr = COMMAND_QUEUE_SIZE;
 
+    PROFILE_SCOPE("GPUBackend::ProcessCommands");
     bool allow_sleep = false;
     while (read_ptr < write_ptr)
     {
@@ -251,7 +306,10 @@ void GPUBackend::RunGPULoop()
         case GPUBackendCommandType::Sync:
         {
           DebugAssert(read_ptr == write_ptr);
-          m_sync_semaphore.Post();
+          FlushRender();
+          m_sync_done.store(true);
+          if (m_cpu_thread_sleeping.load() && m_cpu_thread_sleeping.exchange(false))
+            m_sync_semaphore.Post();
           allow_sleep = static_cast<const GPUBackendSyncCommand*>(cmd)->allow_sleep;
         }
         break;
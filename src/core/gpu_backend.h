@@ -3,9 +3,7 @@
 #include "common/threading.h"
 #include "gpu_types.h"
 #include <atomic>
-#include <condition_variable>
 #include <memory>
-#include <mutex>
 #include <thread>
 
 #ifdef _MSC_VER
@@ -65,26 +63,35 @@ protected:
 
   Common::Rectangle<u32> m_drawing_area{};
 
-  Threading::KernelSemaphore m_sync_semaphore;
-  std::atomic_bool m_gpu_thread_sleeping{false};
-  std::atomic_bool m_gpu_loop_done{false};
   Threading::Thread m_gpu_thread;
   bool m_use_gpu_thread = false;
 
-  std::mutex m_sync_mutex;
-  std::condition_variable m_sync_cpu_thread_cv;
-  std::condition_variable m_wake_gpu_thread_cv;
-  bool m_sync_done = false;
+  // Only wake the GPU thread when the queue is getting full, or something is waiting on the results.
+  bool m_lazy_replay = false;
+
+  // The semaphores are only used once the waiting side has given up spinning and set its sleeping flag, which the
+  // other side clears before posting.
+  Threading::KernelSemaphore m_wake_gpu_thread_semaphore;
+  Threading::KernelSemaphore m_sync_semaphore;
 
   enum : u32
   {
     COMMAND_QUEUE_SIZE = 4 * 1024 * 1024,
-    THRESHOLD_TO_WAKE_GPU = 256
+    THRESHOLD_TO_WAKE_GPU = 256,
+    THRESHOLD_TO_WAKE_GPU_LAZY = COMMAND_QUEUE_SIZE / 2
   };
 
   HeapArray<u8, COMMAND_QUEUE_SIZE> m_command_fifo_data;
+
+  // Single producer (CPU thread), single consumer (GPU thread). Each side's index is on its own cache line.
   alignas(64) std::atomic<u32> m_command_fifo_read_ptr{0};
   alignas(64) std::atomic<u32> m_command_fifo_write_ptr{0};
+
+  alignas(64) std::atomic_bool m_gpu_thread_sleeping{false};
+  std::atomic_bool m_gpu_loop_done{false};
+
+  alignas(64) std::atomic_bool m_sync_done{false};
+  std::atomic_bool m_cpu_thread_sleeping{false};
 };
 
 #ifdef _MSC_VER
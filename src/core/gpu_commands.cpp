@@ -1,7 +1,9 @@
 #include "common/assert.h"
 #include "common/log.h"
+#include "common/profiler.h"
 #include "common/string_util.h"
 #include "gpu.h"
+#include "host_time_accounting.h"
 #include "interrupt_controller.h"
 #include "system.h"
 #include "texture_replacements.h"
@@ -24,6 +26,8 @@ static constexpr u32 ReplaceZero(u32 value, u32 value_for_zero)
 
 void GPU::ExecuteCommands()
 {
+  PROFILE_SCOPE("GPU::ExecuteCommands");
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::GPUCommands);
   m_syncing = true;
 
   for (;;)
@@ -572,11 +576,14 @@ bool GPU::HandleCopyRectangleVRAMToCPUCommand()
   // all rendering should be done first...
   FlushRender();
 
-  // ensure VRAM shadow is up to date
-  ReadVRAM(m_vram_transfer.x, m_vram_transfer.y, m_vram_transfer.width, m_vram_transfer.height);
+  // ensure VRAM shadow is up to date, the backend may defer the wait until the first word is read
+  BeginVRAMReadback(m_vram_transfer.x, m_vram_transfer.y, m_vram_transfer.width, m_vram_transfer.height);
 
   if (g_settings.debugging.dump_vram_to_cpu_copies)
   {
+    if (m_vram_readback_pending)
+      FinishVRAMReadback();
+
     DumpVRAMToFile(StringUtil::StdStringFromFormat("vram_to_cpu_copy_%u.png", s_vram_to_cpu_dump_id++).c_str(),
                    m_vram_transfer.width, m_vram_transfer.height, sizeof(u16) * VRAM_WIDTH,
                    &m_vram_ptr[m_vram_transfer.y * VRAM_WIDTH + m_vram_transfer.x], true);
@@ -0,0 +1,280 @@
+#include "gpu_dump.h"
+#include "common/byte_stream.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "gpu.h"
+#include "util/state_wrapper.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+Log_SetChannel(GPUDump);
+
+namespace GPUDump {
+
+// flush to the file once this many words are buffered
+static constexpr size_t FLUSH_SIZE = 256 * 1024;
+
+static constexpr u32 MakePacketHeader(PacketType type, u32 count)
+{
+  return (static_cast<u32>(type) << PACKET_TYPE_SHIFT) | count;
+}
+
+Recorder::Recorder(std::FILE* fp) : m_fp(fp)
+{
+  m_buffer.reserve(FLUSH_SIZE + 16);
+}
+
+Recorder::~Recorder()
+{
+  Close();
+}
+
+std::unique_ptr<Recorder> Recorder::Create(const char* path, const void* state, u32 state_size, u32 state_version,
+                                           bool is_pal)
+{
+  std::FILE* fp = FileSystem::OpenCFile(path, "wb");
+  if (!fp)
+  {
+    Log_ErrorPrintf("Failed to open '%s' for writing", path);
+    return {};
+  }
+
+  FileHeader header = {};
+  header.magic = FileHeader::MAGIC;
+  header.version = FileHeader::VERSION;
+  header.state_version = state_version;
+  header.state_size = state_size;
+  header.is_pal = static_cast<u32>(is_pal);
+
+  // keep the packets word aligned
+  static constexpr u8 padding[4] = {};
+  const u32 padding_size = (4 - (state_size % 4)) % 4;
+  if (std::fwrite(&header, sizeof(header), 1, fp) != 1 || std::fwrite(state, state_size, 1, fp) != 1 ||
+      (padding_size > 0 && std::fwrite(padding, padding_size, 1, fp) != 1))
+  {
+    Log_ErrorPrintf("Failed to write initial state to '%s'", path);
+    std::fclose(fp);
+    FileSystem::DeleteFile(path);
+    return {};
+  }
+
+  return std::unique_ptr<Recorder>(new Recorder(fp));
+}
+
+void Recorder::WriteToPacket(PacketType type, u32 value)
+{
+  if (!m_packet_open || m_packet_type != type || (m_buffer[m_packet_start] & PACKET_LENGTH_MASK) == PACKET_LENGTH_MASK)
+  {
+    if (m_buffer.size() >= FLUSH_SIZE)
+      Flush();
+
+    m_packet_start = m_buffer.size();
+    m_packet_type = type;
+    m_packet_open = true;
+    m_buffer.push_back(MakePacketHeader(type, 0));
+  }
+
+  m_buffer.push_back(value);
+  m_buffer[m_packet_start]++;
+}
+
+void Recorder::WritePacket(PacketType type, const u32* data, u32 count)
+{
+  if (m_buffer.size() >= FLUSH_SIZE)
+    Flush();
+
+  m_packet_open = false;
+  m_buffer.push_back(MakePacketHeader(type, count));
+  m_buffer.insert(m_buffer.end(), data, data + count);
+}
+
+void Recorder::WriteGP0(u32 value)
+{
+  WriteToPacket(PacketType::GPUPort0Data, value);
+}
+
+void Recorder::WriteGP1(u32 value)
+{
+  WriteToPacket(PacketType::GPUPort1Data, value);
+}
+
+void Recorder::WriteGPUREAD()
+{
+  // consecutive reads only need a count
+  if (m_packet_open && m_packet_type == PacketType::ReadGPUREAD)
+  {
+    m_buffer[m_packet_start + 1]++;
+    return;
+  }
+
+  const u32 count = 1;
+  WritePacket(PacketType::ReadGPUREAD, &count, 1);
+  m_packet_start = m_buffer.size() - 2;
+  m_packet_type = PacketType::ReadGPUREAD;
+  m_packet_open = true;
+}
+
+void Recorder::WriteCRTCState(u8 interlaced_field, u8 active_line_lsb)
+{
+  if (m_last_interlaced_field == interlaced_field && m_last_active_line_lsb == active_line_lsb)
+    return;
+
+  m_last_interlaced_field = interlaced_field;
+  m_last_active_line_lsb = active_line_lsb;
+
+  const u32 data = ZeroExtend32(interlaced_field) | (ZeroExtend32(active_line_lsb) << 8);
+  WritePacket(PacketType::CRTCState, &data, 1);
+}
+
+void Recorder::WriteVSync()
+{
+  WritePacket(PacketType::VSync, nullptr, 0);
+}
+
+void Recorder::Flush()
+{
+  if (!m_buffer.empty() && !m_write_error &&
+      std::fwrite(m_buffer.data(), sizeof(u32), m_buffer.size(), m_fp) != m_buffer.size())
+  {
+    Log_ErrorPrintf("Failed to write %zu words to GPU dump", m_buffer.size());
+    m_write_error = true;
+  }
+
+  m_buffer.clear();
+  m_packet_open = false;
+}
+
+bool Recorder::Close()
+{
+  if (!m_fp)
+    return !m_write_error;
+
+  Flush();
+  if (std::fclose(m_fp) != 0)
+    m_write_error = true;
+
+  m_fp = nullptr;
+  return !m_write_error;
+}
+
+Player::~Player() = default;
+
+std::unique_ptr<Player> Player::Open(const char* path)
+{
+  std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(path);
+  if (!data.has_value())
+  {
+    Log_ErrorPrintf("Failed to read GPU dump '%s'", path);
+    return {};
+  }
+
+  FileHeader header;
+  if (data->size() < sizeof(header))
+  {
+    Log_ErrorPrintf("GPU dump '%s' is truncated", path);
+    return {};
+  }
+
+  std::memcpy(&header, data->data(), sizeof(header));
+  if (header.magic != FileHeader::MAGIC || header.version != FileHeader::VERSION)
+  {
+    Log_ErrorPrintf("'%s' is not a supported GPU dump (magic %08X version %u)", path, header.magic, header.version);
+    return {};
+  }
+
+  const u32 packets_offset = static_cast<u32>(sizeof(header)) + ((header.state_size + 3u) & ~3u);
+  if (packets_offset > data->size())
+  {
+    Log_ErrorPrintf("GPU dump '%s' is truncated", path);
+    return {};
+  }
+
+  std::unique_ptr<Player> player(new Player());
+  player->m_data = std::move(data.value());
+  player->m_state_offset = static_cast<u32>(sizeof(header));
+  player->m_state_size = header.state_size;
+  player->m_state_version = header.state_version;
+  player->m_packets_offset = packets_offset;
+  player->m_position = packets_offset;
+  player->m_is_pal = (header.is_pal != 0);
+  Log_InfoPrintf("Opened GPU dump '%s', %zu bytes of packets", path, player->m_data.size() - packets_offset);
+  return player;
+}
+
+bool Player::LoadInitialState()
+{
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::CreateReadOnlyMemoryStream(&m_data[m_state_offset], m_state_size);
+  StateWrapper sw(stream.get(), StateWrapper::Mode::Read, m_state_version);
+  if (!g_gpu->DoState(sw, nullptr, true))
+  {
+    Log_ErrorPrintf("Failed to load GPU dump initial state");
+    return false;
+  }
+
+  m_position = m_packets_offset;
+  m_pass_frames = 0;
+  m_pass_start_time = Common::Timer::GetCurrentValue();
+  m_last_frame_time = m_pass_start_time;
+  m_min_frame_time = std::numeric_limits<Common::Timer::Value>::max();
+  m_max_frame_time = 0;
+  return true;
+}
+
+void Player::ProcessFrame()
+{
+  const u32 end = static_cast<u32>(m_data.size()) & ~3u;
+  bool looped = false;
+  for (;;)
+  {
+    if ((m_position + sizeof(u32)) > end)
+    {
+      // avoid spinning forever on a dump without any vsyncs
+      if (looped)
+        break;
+
+      LogPassTimings();
+      if (!LoadInitialState())
+        break;
+
+      m_pass++;
+      looped = true;
+      continue;
+    }
+
+    u32 header;
+    std::memcpy(&header, &m_data[m_position], sizeof(header));
+    m_position += sizeof(header);
+
+    const PacketType type = static_cast<PacketType>(header >> PACKET_TYPE_SHIFT);
+    const u32 count = std::min<u32>(header & PACKET_LENGTH_MASK, (end - m_position) / sizeof(u32));
+    g_gpu->ProcessDumpPacket(type, reinterpret_cast<const u32*>(&m_data[m_position]), count);
+    m_position += count * sizeof(u32);
+
+    if (type == PacketType::VSync)
+      break;
+  }
+
+  // frame time includes presenting the previous frame
+  const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
+  const Common::Timer::Value frame_time = current_time - m_last_frame_time;
+  m_min_frame_time = std::min(m_min_frame_time, frame_time);
+  m_max_frame_time = std::max(m_max_frame_time, frame_time);
+  m_last_frame_time = current_time;
+  m_pass_frames++;
+}
+
+void Player::LogPassTimings()
+{
+  if (m_pass_frames == 0)
+    return;
+
+  const double total_ms = Common::Timer::ConvertValueToMilliseconds(m_last_frame_time - m_pass_start_time);
+  Log_InfoPrintf("GPU dump pass %u: %u frames in %.2f ms (%.2f FPS), frame time avg %.3f ms min %.3f ms max %.3f ms",
+                 m_pass, m_pass_frames, total_ms, (static_cast<double>(m_pass_frames) * 1000.0) / total_ms,
+                 total_ms / static_cast<double>(m_pass_frames),
+                 Common::Timer::ConvertValueToMilliseconds(m_min_frame_time),
+                 Common::Timer::ConvertValueToMilliseconds(m_max_frame_time));
+}
+
+} // namespace GPUDump
@@ -0,0 +1,113 @@
+#pragma once
+#include "common/timer.h"
+#include "types.h"
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+/// Capture and replay of the GPU command stream, for benchmarking renderers without the CPU.
+/// A dump is the GPU state (including VRAM) at the time recording started, followed by packets for everything which
+/// was written to or read from the GPU ports, and the vertical blanks.
+namespace GPUDump {
+
+#pragma pack(push, 4)
+struct FileHeader
+{
+  static constexpr u32 MAGIC = 0x504D4447; // GDMP
+  static constexpr u32 VERSION = 1;
+
+  u32 magic;
+  u32 version;
+  u32 state_version;
+  u32 state_size;
+  u32 is_pal;
+};
+#pragma pack(pop)
+
+enum class PacketType : u8
+{
+  GPUPort0Data, // words written to GP0, by MMIO or DMA
+  GPUPort1Data, // words written to GP1
+  ReadGPUREAD,  // one word with the number of words read from GPUREAD during a VRAM->CPU transfer
+  CRTCState,    // interlaced field and active line LSB, written when either changes
+  VSync,        // no data
+};
+
+/// Packets are a header word, with the type in the upper 8 bits and the data length in words in the lower 24 bits,
+/// followed by the data.
+static constexpr u32 PACKET_LENGTH_MASK = 0x00FFFFFFu;
+static constexpr u32 PACKET_TYPE_SHIFT = 24;
+
+class Recorder
+{
+public:
+  ~Recorder();
+
+  static std::unique_ptr<Recorder> Create(const char* path, const void* state, u32 state_size, u32 state_version,
+                                          bool is_pal);
+
+  void WriteGP0(u32 value);
+  void WriteGP1(u32 value);
+  void WriteGPUREAD();
+  void WriteCRTCState(u8 interlaced_field, u8 active_line_lsb);
+  void WriteVSync();
+
+  bool Close();
+
+private:
+  Recorder(std::FILE* fp);
+
+  /// Appends a word to the current packet, starting a new one if the type differs.
+  void WriteToPacket(PacketType type, u32 value);
+  void WritePacket(PacketType type, const u32* data, u32 count);
+  void Flush();
+
+  std::FILE* m_fp;
+  std::vector<u32> m_buffer;
+  size_t m_packet_start = 0;
+  PacketType m_packet_type = PacketType::VSync;
+  bool m_packet_open = false;
+  bool m_write_error = false;
+
+  u8 m_last_interlaced_field = 0xFF;
+  u8 m_last_active_line_lsb = 0xFF;
+};
+
+class Player
+{
+public:
+  ~Player();
+
+  static std::unique_ptr<Player> Open(const char* path);
+
+  ALWAYS_INLINE bool IsPAL() const { return m_is_pal; }
+
+  /// Loads the initial state into the GPU, rewinding to the start of the dump.
+  bool LoadInitialState();
+
+  /// Executes packets up to and including the next vertical blank. Loops back to the start at the end of the dump,
+  /// logging the frame times for the pass.
+  void ProcessFrame();
+
+private:
+  Player() = default;
+
+  void LogPassTimings();
+
+  std::vector<u8> m_data;
+  u32 m_state_offset = 0;
+  u32 m_state_size = 0;
+  u32 m_state_version = 0;
+  u32 m_packets_offset = 0;
+  u32 m_position = 0;
+  bool m_is_pal = false;
+
+  u32 m_pass = 0;
+  u32 m_pass_frames = 0;
+  Common::Timer::Value m_pass_start_time = 0;
+  Common::Timer::Value m_last_frame_time = 0;
+  Common::Timer::Value m_min_frame_time = 0;
+  Common::Timer::Value m_max_frame_time = 0;
+};
+
+} // namespace GPUDump
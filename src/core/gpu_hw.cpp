@@ -1,6 +1,7 @@
 #include "gpu_hw.h"
 #include "common/align.h"
 #include "common/assert.h"
+#include "common/bitutils.h"
 #include "common/log.h"
 #include "cpu_core.h"
 #include "gpu_sw_backend.h"
@@ -24,6 +25,16 @@ ALWAYS_INLINE static constexpr std::tuple<T, T> MinMax(T v1, T v2)
     return std::tie(v1, v2);
 }
 
+// fraction of the frame budget the GPU can use before the resolution steps down, and how many performance counter
+// updates (about a second each) it has to stay above it. stepping up needs the estimate at the next scale to fit
+// under the lower limit for longer, so it doesn't bounce between two scales.
+static constexpr float DYNAMIC_RESOLUTION_HIGH_LOAD = 0.9f;
+static constexpr float DYNAMIC_RESOLUTION_LOW_LOAD = 0.8f;
+static constexpr u32 DYNAMIC_RESOLUTION_DOWN_UPDATES = 2;
+static constexpr u32 DYNAMIC_RESOLUTION_UP_UPDATES = 5;
+
+static u32 s_shader_compile_count = 0;
+
 ALWAYS_INLINE static bool ShouldUseUVLimits()
 {
   // We only need UV limits if PGXP is enabled, or texture filtering is enabled.
@@ -81,7 +92,8 @@ bool GPU_HW::Initialize()
   {
     Host::AddOSDMessage(Host::TranslateStdString("OSDMessage", "SSAA is not supported, using MSAA instead."), 20.0f);
   }
-  if (!m_supports_dual_source_blend && TextureFilterRequiresDualSourceBlend(m_texture_filtering))
+  if (!m_supports_dual_source_blend && !m_supports_framebuffer_fetch &&
+      TextureFilterRequiresDualSourceBlend(m_texture_filtering))
   {
     Host::AddFormattedOSDMessage(
       20.0f, Host::TranslateString("OSDMessage", "Texture filter '%s' is not supported with the current renderer."),
@@ -113,9 +125,10 @@ void GPU_HW::Reset(bool clear_vram)
 
   m_batch_current_vertex_ptr = m_batch_start_vertex_ptr;
 
-  m_vram_shadow.fill(0);
+  // the software renderer draws into the shadow copy, so it has to be idle before clearing it
   if (m_sw_renderer)
     m_sw_renderer->Reset(clear_vram);
+  m_vram_shadow.fill(0);
 
   m_batch = {};
   m_batch_ubo_data = {};
@@ -143,6 +156,9 @@ bool GPU_HW::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_di
 
 void GPU_HW::UpdateHWSettings(bool* framebuffer_changed, bool* shaders_changed)
 {
+  if (!g_settings.gpu_dynamic_resolution)
+    m_dynamic_resolution_scale = 0;
+
   const u32 resolution_scale = CalculateResolutionScale();
   const u32 multisamples = std::min(m_max_multisamples, g_settings.gpu_multisamples);
   const bool per_sample_shading = g_settings.gpu_per_sample_shading && m_supports_per_sample_shading;
@@ -196,8 +212,11 @@ void GPU_HW::UpdateHWSettings(bool* framebuffer_changed, bool* shaders_changed)
   m_downsample_mode = downsample_mode;
   m_disable_color_perspective = disable_color_perspective;
 
-  if (!m_supports_dual_source_blend && TextureFilterRequiresDualSourceBlend(m_texture_filtering))
+  if (!m_supports_dual_source_blend && !m_supports_framebuffer_fetch &&
+      TextureFilterRequiresDualSourceBlend(m_texture_filtering))
+  {
     m_texture_filtering = GPUTextureFilter::Nearest;
+  }
 
   if (m_pgxp_depth_buffer != g_settings.UsingPGXPDepthBuffer())
   {
@@ -234,6 +253,9 @@ u32 GPU_HW::CalculateResolutionScale() const
     scale = static_cast<u32>(std::clamp<s32>(preferred_scale, 1, m_max_resolution_scale));
   }
 
+  if (g_settings.gpu_dynamic_resolution && m_dynamic_resolution_scale != 0)
+    scale = std::min(scale, m_dynamic_resolution_scale);
+
   if (g_settings.gpu_downsample_mode == GPUDownsampleMode::Adaptive && m_supports_adaptive_downsampling && scale > 1 &&
       !Common::IsPow2(scale))
   {
@@ -262,6 +284,59 @@ void GPU_HW::UpdateResolutionScale()
     UpdateSettings();
 }
 
+bool GPU_HW::UpdateDynamicResolution(float gpu_time, float frame_budget)
+{
+  if (!g_settings.gpu_dynamic_resolution || gpu_time <= 0.0f || frame_budget <= 0.0f)
+    return false;
+
+  // adaptive downsampling only works with power of two scales
+  const bool pow2_steps =
+    (g_settings.gpu_downsample_mode == GPUDownsampleMode::Adaptive && m_supports_adaptive_downsampling);
+  const float load = gpu_time / frame_budget;
+  u32 new_scale;
+  if (load > DYNAMIC_RESOLUTION_HIGH_LOAD)
+  {
+    m_dynamic_resolution_low_count = 0;
+    if (++m_dynamic_resolution_high_count < DYNAMIC_RESOLUTION_DOWN_UPDATES)
+      return false;
+
+    new_scale = std::max(pow2_steps ? (m_resolution_scale / 2) : (m_resolution_scale - 1),
+                         std::max(g_settings.gpu_dynamic_resolution_min_scale, 1u));
+    if (new_scale >= m_resolution_scale)
+      return false;
+  }
+  else
+  {
+    // assume the cost grows with the pixel count
+    m_dynamic_resolution_high_count = 0;
+    new_scale = pow2_steps ? (m_resolution_scale * 2) : (m_resolution_scale + 1);
+    const float ratio = static_cast<float>(new_scale) / static_cast<float>(m_resolution_scale);
+    if ((load * ratio * ratio) > DYNAMIC_RESOLUTION_LOW_LOAD)
+    {
+      m_dynamic_resolution_low_count = 0;
+      return false;
+    }
+
+    if (++m_dynamic_resolution_low_count < DYNAMIC_RESOLUTION_UP_UPDATES)
+      return false;
+  }
+
+  m_dynamic_resolution_high_count = 0;
+  m_dynamic_resolution_low_count = 0;
+  m_dynamic_resolution_scale = new_scale;
+  if (CalculateResolutionScale() == m_resolution_scale)
+  {
+    // already at the configured scale
+    m_dynamic_resolution_scale = m_resolution_scale;
+    return false;
+  }
+
+  Log_InfoPrintf("Dynamic resolution: GPU time %.2fms of %.2fms, scale %u -> %u", gpu_time, frame_budget,
+                 m_resolution_scale, new_scale);
+  UpdateSettings();
+  return true;
+}
+
 GPUDownsampleMode GPU_HW::GetDownsampleMode(u32 resolution_scale) const
 {
   if (resolution_scale == 1)
@@ -294,6 +369,7 @@ void GPU_HW::PrintSettingsToLog()
                  (!m_true_color && m_scaled_dithering) ? " (Scaled)" : "");
   Log_InfoPrintf("Texture Filtering: %s", Settings::GetTextureFilterDisplayName(m_texture_filtering));
   Log_InfoPrintf("Dual-source blending: %s", m_supports_dual_source_blend ? "Supported" : "Not supported");
+  Log_InfoPrintf("Framebuffer fetch blending: %s", m_supports_framebuffer_fetch ? "Supported" : "Not supported");
   Log_InfoPrintf("Using UV limits: %s", m_using_uv_limits ? "YES" : "NO");
   Log_InfoPrintf("Depth buffer: %s", m_pgxp_depth_buffer ? "YES" : "NO");
   Log_InfoPrintf("Downsampling: %s", Settings::GetDownsampleModeDisplayName(m_downsample_mode));
@@ -491,10 +567,10 @@ void GPU_HW::DrawLine(float x0, float y0, u32 col0, float x1, float y1, u32 col1
   if (dx == 0.0f && dy == 0.0f)
   {
     // Degenerate, render a point.
-    output[0].Set(x0, y0, depth, 1.0f, col0, 0, 0, 0);
-    output[1].Set(x0 + 1.0f, y0, depth, 1.0f, col0, 0, 0, 0);
-    output[2].Set(x1, y1 + 1.0f, depth, 1.0f, col0, 0, 0, 0);
-    output[3].Set(x1 + 1.0f, y1 + 1.0f, depth, 1.0f, col0, 0, 0, 0);
+    output[0].Set(x0, y0, depth, 1.0f, col0, 0, 0, 0, 0);
+    output[1].Set(x0 + 1.0f, y0, depth, 1.0f, col0, 0, 0, 0, 0);
+    output[2].Set(x1, y1 + 1.0f, depth, 1.0f, col0, 0, 0, 0, 0);
+    output[3].Set(x1 + 1.0f, y1 + 1.0f, depth, 1.0f, col0, 0, 0, 0, 0);
   }
   else
   {
@@ -558,10 +634,10 @@ void GPU_HW::DrawLine(float x0, float y0, u32 col0, float x1, float y1, u32 col1
     const float ox1 = x1 + pad_x1;
     const float oy1 = y1 + pad_y1;
 
-    output[0].Set(ox0, oy0, depth, 1.0f, col0, 0, 0, 0);
-    output[1].Set(ox0 + fill_dx, oy0 + fill_dy, depth, 1.0f, col0, 0, 0, 0);
-    output[2].Set(ox1, oy1, depth, 1.0f, col1, 0, 0, 0);
-    output[3].Set(ox1 + fill_dx, oy1 + fill_dy, depth, 1.0f, col1, 0, 0, 0);
+    output[0].Set(ox0, oy0, depth, 1.0f, col0, 0, 0, 0, 0);
+    output[1].Set(ox0 + fill_dx, oy0 + fill_dy, depth, 1.0f, col0, 0, 0, 0, 0);
+    output[2].Set(ox1, oy1, depth, 1.0f, col1, 0, 0, 0, 0);
+    output[3].Set(ox1 + fill_dx, oy1 + fill_dy, depth, 1.0f, col1, 0, 0, 0, 0);
   }
 
   AddVertex(output[0]);
@@ -579,6 +655,9 @@ void GPU_HW::LoadVertices()
 
   const GPURenderCommand rc{m_render_command.bits};
   const u32 texpage = ZeroExtend32(m_draw_mode.mode_reg.bits) | (ZeroExtend32(m_draw_mode.palette_reg) << 16);
+  const u32 texwindow =
+    ZeroExtend32(m_draw_mode.texture_window.and_x) | (ZeroExtend32(m_draw_mode.texture_window.and_y) << 8) |
+    (ZeroExtend32(m_draw_mode.texture_window.or_x) << 16) | (ZeroExtend32(m_draw_mode.texture_window.or_y) << 24);
   const float depth = GetCurrentNormalizedVertexDepth();
 
   switch (rc.primitive)
@@ -609,7 +688,7 @@ void GPU_HW::LoadVertices()
         native_vertex_positions[i][1] = native_y;
         native_texcoords[i] = texcoord;
         vertices[i].Set(static_cast<float>(native_x), static_cast<float>(native_y), depth, 1.0f, color, texpage,
-                        texcoord, 0xFFFF0000u);
+                        texwindow, texcoord, 0xFFFF0000u);
 
         if (pgxp)
         {
@@ -666,7 +745,7 @@ void GPU_HW::LoadVertices()
         const u32 clip_bottom =
           static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-        m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+        IncludeDrawnVRAMDirtyRectangle(clip_left, clip_right, clip_top, clip_bottom);
         AddDrawTriangleTicks(native_vertex_positions[0][0], native_vertex_positions[0][1],
                              native_vertex_positions[1][0], native_vertex_positions[1][1],
                              native_vertex_positions[2][0], native_vertex_positions[2][1], rc.shading_enable,
@@ -700,7 +779,7 @@ void GPU_HW::LoadVertices()
           const u32 clip_bottom =
             static_cast<u32>(std::clamp<s32>(max_y_123, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-          m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+          IncludeDrawnVRAMDirtyRectangle(clip_left, clip_right, clip_top, clip_bottom);
           AddDrawTriangleTicks(native_vertex_positions[2][0], native_vertex_positions[2][1],
                                native_vertex_positions[1][0], native_vertex_positions[1][1],
                                native_vertex_positions[3][0], native_vertex_positions[3][1], rc.shading_enable,
@@ -798,13 +877,17 @@ void GPU_HW::LoadVertices()
           const u16 tex_right = tex_left + static_cast<u16>(quad_width);
           const u32 uv_limits = BatchVertex::PackUVLimits(tex_left, tex_right - 1, tex_top, tex_bottom - 1);
 
-          AddNewVertex(quad_start_x, quad_start_y, depth, 1.0f, color, texpage, tex_left, tex_top, uv_limits);
-          AddNewVertex(quad_end_x, quad_start_y, depth, 1.0f, color, texpage, tex_right, tex_top, uv_limits);
-          AddNewVertex(quad_start_x, quad_end_y, depth, 1.0f, color, texpage, tex_left, tex_bottom, uv_limits);
+          AddNewVertex(quad_start_x, quad_start_y, depth, 1.0f, color, texpage, texwindow, tex_left, tex_top,
+                       uv_limits);
+          AddNewVertex(quad_end_x, quad_start_y, depth, 1.0f, color, texpage, texwindow, tex_right, tex_top, uv_limits);
+          AddNewVertex(quad_start_x, quad_end_y, depth, 1.0f, color, texpage, texwindow, tex_left, tex_bottom,
+                       uv_limits);
 
-          AddNewVertex(quad_start_x, quad_end_y, depth, 1.0f, color, texpage, tex_left, tex_bottom, uv_limits);
-          AddNewVertex(quad_end_x, quad_start_y, depth, 1.0f, color, texpage, tex_right, tex_top, uv_limits);
-          AddNewVertex(quad_end_x, quad_end_y, depth, 1.0f, color, texpage, tex_right, tex_bottom, uv_limits);
+          AddNewVertex(quad_start_x, quad_end_y, depth, 1.0f, color, texpage, texwindow, tex_left, tex_bottom,
+                       uv_limits);
+          AddNewVertex(quad_end_x, quad_start_y, depth, 1.0f, color, texpage, texwindow, tex_right, tex_top, uv_limits);
+          AddNewVertex(quad_end_x, quad_end_y, depth, 1.0f, color, texpage, texwindow, tex_right, tex_bottom,
+                       uv_limits);
 
           x_offset += quad_width;
           tex_left = 0;
@@ -821,7 +904,7 @@ void GPU_HW::LoadVertices()
       const u32 clip_bottom =
         static_cast<u32>(std::clamp<s32>(pos_y + rectangle_height, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-      m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+      IncludeDrawnVRAMDirtyRectangle(clip_left, clip_right, clip_top, clip_bottom);
       AddDrawRectangleTicks(clip_right - clip_left, clip_bottom - clip_top, rc.texture_enable, rc.transparency_enable);
 
       if (m_sw_renderer)
@@ -884,7 +967,7 @@ void GPU_HW::LoadVertices()
         const u32 clip_bottom =
           static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-        m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+        IncludeDrawnVRAMDirtyRectangle(clip_left, clip_right, clip_top, clip_bottom);
         AddDrawLineTicks(clip_right - clip_left, clip_bottom - clip_top, rc.shading_enable);
 
         // TODO: Should we do a PGXP lookup here? Most lines are 2D.
@@ -951,7 +1034,7 @@ void GPU_HW::LoadVertices()
             const u32 clip_bottom =
               static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-            m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+            IncludeDrawnVRAMDirtyRectangle(clip_left, clip_right, clip_top, clip_bottom);
             AddDrawLineTicks(clip_right - clip_left, clip_bottom - clip_top, rc.shading_enable);
 
             // TODO: Should we do a PGXP lookup here? Most lines are 2D.
@@ -1059,7 +1142,7 @@ GPU_HW::VRAMCopyUBOData GPU_HW::GetVRAMCopyUBOData(u32 src_x, u32 src_y, u32 dst
 
 void GPU_HW::IncludeVRAMDirtyRectangle(const Common::Rectangle<u32>& rect)
 {
-  m_vram_dirty_rect.Include(rect);
+  IncludeDrawnVRAMDirtyRectangle(rect.left, rect.right, rect.top, rect.bottom);
 
   // the vram area can include the texture page, but the game can leave it as-is. in this case, set it as dirty so the
   // shadow texture is updated
@@ -1071,6 +1154,53 @@ void GPU_HW::IncludeVRAMDirtyRectangle(const Common::Rectangle<u32>& rect)
   }
 }
 
+bool GPU_HW::IsVRAMDirty(const Common::Rectangle<u32>& rect) const
+{
+  const u32 right = std::min<u32>(rect.right, VRAM_WIDTH);
+  const u32 bottom = std::min<u32>(rect.bottom, VRAM_HEIGHT);
+  if (rect.left >= right || rect.top >= bottom)
+    return false;
+
+  const u32 mask = GetVRAMDirtyTileMask(rect.left, right);
+  for (u32 row = (rect.top >> VRAM_DIRTY_TILE_SHIFT); row <= ((bottom - 1) >> VRAM_DIRTY_TILE_SHIFT); row++)
+  {
+    if (m_vram_dirty_tiles[row] & mask)
+      return true;
+  }
+
+  return false;
+}
+
+void GPU_HW::GetVRAMDirtyRectangles(std::vector<Common::Rectangle<u32>>* rects) const
+{
+  rects->clear();
+
+  for (u32 row = 0; row < static_cast<u32>(m_vram_dirty_tiles.size()); row++)
+  {
+    const u32 top = row * VRAM_DIRTY_TILE_SIZE;
+    const u32 bottom = top + VRAM_DIRTY_TILE_SIZE;
+    u32 bits = m_vram_dirty_tiles[row];
+    while (bits != 0)
+    {
+      const u32 first_col = CountTrailingZeros(bits);
+      const u32 shifted = bits >> first_col;
+      const u32 num_cols = (shifted == ~0u) ? 32u : CountTrailingZeros(~shifted);
+      const u32 left = first_col * VRAM_DIRTY_TILE_SIZE;
+      const u32 right = (first_col + num_cols) * VRAM_DIRTY_TILE_SIZE;
+      bits &= ~GetVRAMDirtyTileMask(left, right);
+
+      // extend the same run from the previous row if there is one
+      auto it = std::find_if(rects->begin(), rects->end(), [left, right, top](const Common::Rectangle<u32>& rc) {
+        return (rc.left == left && rc.right == right && rc.bottom == top);
+      });
+      if (it != rects->end())
+        it->bottom = bottom;
+      else
+        rects->emplace_back(left, top, right, bottom);
+    }
+  }
+}
+
 void GPU_HW::EnsureVertexBufferSpace(u32 required_vertices)
 {
   if (m_batch_current_vertex_ptr)
@@ -1137,8 +1267,6 @@ void GPU_HW::UpdateSoftwareRenderer(bool copy_vram_from_hw)
   if (current_enabled == new_enabled)
     return;
 
-  m_vram_ptr = m_vram_shadow.data();
-
   if (!new_enabled)
   {
     if (m_sw_renderer)
@@ -1147,17 +1275,19 @@ void GPU_HW::UpdateSoftwareRenderer(bool copy_vram_from_hw)
     return;
   }
 
-  std::unique_ptr<GPU_SW_Backend> sw_renderer = std::make_unique<GPU_SW_Backend>();
-  if (!sw_renderer->Initialize(true))
-    return;
-
-  // We need to fill in the SW renderer's VRAM with the current state for hot toggles.
+  // The SW renderer shares the shadow copy, which only has to be brought up to date for hot toggles.
   if (copy_vram_from_hw)
   {
     FlushRender();
     ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
-    std::memcpy(sw_renderer->GetVRAM(), m_vram_ptr, sizeof(u16) * VRAM_WIDTH * VRAM_HEIGHT);
+  }
+
+  std::unique_ptr<GPU_SW_Backend> sw_renderer = std::make_unique<GPU_SW_Backend>(m_vram_shadow.data());
+  if (!sw_renderer->Initialize(true))
+    return;
 
+  if (copy_vram_from_hw)
+  {
     // Sync the drawing area.
     GPUBackendSetDrawingAreaCommand* cmd = sw_renderer->NewSetDrawingAreaCommand();
     cmd->new_area = m_drawing_area;
@@ -1165,7 +1295,6 @@ void GPU_HW::UpdateSoftwareRenderer(bool copy_vram_from_hw)
   }
 
   m_sw_renderer = std::move(sw_renderer);
-  m_vram_ptr = m_sw_renderer->GetVRAM();
 }
 
 void GPU_HW::FillBackendCommandParameters(GPUBackendCommand* cmd) const
@@ -1274,9 +1403,8 @@ void GPU_HW::DispatchRenderCommand()
     if (m_draw_mode.IsTexturePageChanged())
     {
       m_draw_mode.ClearTexturePageChangedFlag();
-      if (m_vram_dirty_rect.Valid() && (m_draw_mode.mode_reg.GetTexturePageRectangle().Intersects(m_vram_dirty_rect) ||
-                                        (m_draw_mode.mode_reg.IsUsingPalette() &&
-                                         m_draw_mode.GetTexturePaletteRectangle().Intersects(m_vram_dirty_rect))))
+      if (IsVRAMDirty(m_draw_mode.mode_reg.GetTexturePageRectangle()) ||
+          (m_draw_mode.mode_reg.IsUsingPalette() && IsVRAMDirty(m_draw_mode.GetTexturePaletteRectangle())))
       {
         // Log_DevPrintf("Invalidating VRAM read cache due to drawing area overlap");
         if (!IsFlushed())
@@ -1303,7 +1431,8 @@ void GPU_HW::DispatchRenderCommand()
     rc.transparency_enable ? m_draw_mode.mode_reg.transparency_mode : GPUTransparencyMode::Disabled;
   const bool dithering_enable = (!m_true_color && rc.IsDitheringEnabled()) ? m_GPUSTAT.dither_enable : false;
   if (texture_mode != m_batch.texture_mode || transparency_mode != m_batch.transparency_mode ||
-      transparency_mode == GPUTransparencyMode::BackgroundMinusForeground || dithering_enable != m_batch.dithering)
+      (transparency_mode == GPUTransparencyMode::BackgroundMinusForeground && !m_supports_framebuffer_fetch) ||
+      dithering_enable != m_batch.dithering)
   {
     FlushRender();
   }
@@ -1315,7 +1444,11 @@ void GPU_HW::DispatchRenderCommand()
   {
     static constexpr float transparent_alpha[4][2] = {{0.5f, 0.5f}, {1.0f, 1.0f}, {1.0f, 1.0f}, {0.25f, 1.0f}};
 
-    const float src_alpha_factor = transparent_alpha[static_cast<u32>(transparency_mode)][0];
+    // the shader adds the weighted colours when it blends with framebuffer fetch, so subtraction is a negative weight
+    const float src_alpha_factor =
+      (m_supports_framebuffer_fetch && transparency_mode == GPUTransparencyMode::BackgroundMinusForeground) ?
+        -1.0f :
+        transparent_alpha[static_cast<u32>(transparency_mode)][0];
     const float dst_alpha_factor = transparent_alpha[static_cast<u32>(transparency_mode)][1];
     m_batch_ubo_dirty |= (m_batch_ubo_data.u_src_alpha_factor != src_alpha_factor ||
                           m_batch_ubo_data.u_dst_alpha_factor != dst_alpha_factor);
@@ -1347,15 +1480,17 @@ void GPU_HW::DispatchRenderCommand()
   m_batch.transparency_mode = transparency_mode;
   m_batch.dithering = dithering_enable;
 
-  if (m_draw_mode.IsTextureWindowChanged())
+  if (m_batch_ubo_uber_state)
   {
-    m_draw_mode.ClearTextureWindowChangedFlag();
-
-    m_batch_ubo_data.u_texture_window_and[0] = ZeroExtend32(m_draw_mode.texture_window.and_x);
-    m_batch_ubo_data.u_texture_window_and[1] = ZeroExtend32(m_draw_mode.texture_window.and_y);
-    m_batch_ubo_data.u_texture_window_or[0] = ZeroExtend32(m_draw_mode.texture_window.or_x);
-    m_batch_ubo_data.u_texture_window_or[1] = ZeroExtend32(m_draw_mode.texture_window.or_y);
-    m_batch_ubo_dirty = true;
+    const u32 uber_texture_mode = static_cast<u32>(texture_mode);
+    const u32 uber_dithering = BoolToUInt32(dithering_enable);
+    const u32 uber_interlacing = BoolToUInt32(m_batch.interlacing);
+    m_batch_ubo_dirty |= (m_batch_ubo_data.u_texture_mode != uber_texture_mode ||
+                          m_batch_ubo_data.u_dithering != uber_dithering ||
+                          m_batch_ubo_data.u_interlacing != uber_interlacing);
+    m_batch_ubo_data.u_texture_mode = uber_texture_mode;
+    m_batch_ubo_data.u_dithering = uber_dithering;
+    m_batch_ubo_data.u_interlacing = uber_interlacing;
   }
 
   if (m_drawing_area_changed)
@@ -1388,6 +1523,10 @@ void GPU_HW::FlushRender()
   if (vertex_count == 0)
     return;
 
+  // adaptive frameskip only drops the draws, the software renderer for readbacks still sees them
+  if (System::IsSkippingFrameDrawing())
+    return;
+
   if (m_batch_ubo_dirty)
   {
     UploadUniformBuffer(&m_batch_ubo_data, sizeof(m_batch_ubo_data));
@@ -1481,10 +1620,20 @@ void GPU_HW::DrawRendererStats(bool is_idle_frame)
     ImGui::Text("%u", stats.num_uniform_buffer_updates);
     ImGui::NextColumn();
 
+    ImGui::TextUnformatted("VRAM Write Flushes: ");
+    ImGui::NextColumn();
+    ImGui::Text("%u", stats.num_vram_write_flushes);
+    ImGui::NextColumn();
+
     ImGui::Columns(1);
   }
 }
 
+u32 GPU_HW::GetShaderCompileCount()
+{
+  return s_shader_compile_count;
+}
+
 GPU_HW::ShaderCompileProgressTracker::ShaderCompileProgressTracker(std::string title, u32 total)
   : m_title(std::move(title)), m_min_time(Common::Timer::ConvertSecondsToValue(1.0)),
     m_update_interval(Common::Timer::ConvertSecondsToValue(0.1)), m_start_time(Common::Timer::GetCurrentValue()),
@@ -1495,6 +1644,7 @@ GPU_HW::ShaderCompileProgressTracker::ShaderCompileProgressTracker(std::string t
 void GPU_HW::ShaderCompileProgressTracker::Increment()
 {
   m_progress++;
+  s_shader_compile_count++;
 
   const u64 tv = Common::Timer::GetCurrentValue();
   if ((tv - m_start_time) >= m_min_time && (tv - m_last_update_time) >= m_update_interval)
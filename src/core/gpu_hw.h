@@ -30,6 +30,13 @@ public:
     SeparateFields
   };
 
+  enum : u32
+  {
+    // Level 0 texels covered by each workgroup of the adaptive downsample compute shader.
+    ADAPTIVE_DOWNSAMPLE_COMPUTE_TILE_SHIFT = 5,
+    ADAPTIVE_DOWNSAMPLE_COMPUTE_TILE_SIZE = 1u << ADAPTIVE_DOWNSAMPLE_COMPUTE_TILE_SHIFT,
+  };
+
   GPU_HW();
   virtual ~GPU_HW();
 
@@ -40,16 +47,22 @@ public:
   virtual bool DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display) override;
 
   void UpdateResolutionScale() override final;
+  bool UpdateDynamicResolution(float gpu_time, float frame_budget) override final;
   std::tuple<u32, u32> GetEffectiveDisplayResolution(bool scaled = true) override final;
   std::tuple<u32, u32> GetFullDisplayResolution(bool scaled = true) override final;
 
+  /// Returns the number of shaders and pipelines built by the hardware renderers since startup, whether they were
+  /// compiled or came from the shader cache.
+  static u32 GetShaderCompileCount();
+
 protected:
   enum : u32
   {
     VRAM_UPDATE_TEXTURE_BUFFER_SIZE = 4 * 1024 * 1024,
     VERTEX_BUFFER_SIZE = 4 * 1024 * 1024,
     UNIFORM_BUFFER_SIZE = 2 * 1024 * 1024,
-    MAX_BATCH_VERTEX_COUNTER_IDS = 65536 - 2,
+    VERTEX_DEPTH_COUNTER_RANGE = 1024 * 1024,
+    MAX_BATCH_VERTEX_COUNTER_IDS = VERTEX_DEPTH_COUNTER_RANGE - 2,
     MAX_VERTICES_FOR_RECTANGLE = 6 * (((MAX_PRIMITIVE_WIDTH + (TEXTURE_PAGE_WIDTH - 1)) / TEXTURE_PAGE_WIDTH) + 1u) *
                                  (((MAX_PRIMITIVE_HEIGHT + (TEXTURE_PAGE_HEIGHT - 1)) / TEXTURE_PAGE_HEIGHT) + 1u)
   };
@@ -63,18 +76,19 @@ protected:
     float w;
     u32 color;
     u32 texpage;
-    u16 u; // 16-bit texcoords are needed for 256 extent rectangles
+    u32 texwindow; // GPUTextureWindow, per-vertex so that window changes don't split the batch
+    u16 u;         // 16-bit texcoords are needed for 256 extent rectangles
     u16 v;
     u32 uv_limits;
 
-    ALWAYS_INLINE void Set(float x_, float y_, float z_, float w_, u32 color_, u32 texpage_, u16 packed_texcoord,
-                           u32 uv_limits_)
+    ALWAYS_INLINE void Set(float x_, float y_, float z_, float w_, u32 color_, u32 texpage_, u32 texwindow_,
+                           u16 packed_texcoord, u32 uv_limits_)
     {
-      Set(x_, y_, z_, w_, color_, texpage_, packed_texcoord & 0xFF, (packed_texcoord >> 8), uv_limits_);
+      Set(x_, y_, z_, w_, color_, texpage_, texwindow_, packed_texcoord & 0xFF, (packed_texcoord >> 8), uv_limits_);
     }
 
-    ALWAYS_INLINE void Set(float x_, float y_, float z_, float w_, u32 color_, u32 texpage_, u16 u_, u16 v_,
-                           u32 uv_limits_)
+    ALWAYS_INLINE void Set(float x_, float y_, float z_, float w_, u32 color_, u32 texpage_, u32 texwindow_, u16 u_,
+                           u16 v_, u32 uv_limits_)
     {
       x = x_;
       y = y_;
@@ -82,6 +96,7 @@ protected:
       w = w_;
       color = color_;
       texpage = texpage_;
+      texwindow = texwindow_;
       u = u_;
       v = v_;
       uv_limits = uv_limits_;
@@ -118,12 +133,15 @@ protected:
 
   struct BatchUBOData
   {
-    u32 u_texture_window_and[2];
-    u32 u_texture_window_or[2];
     float u_src_alpha_factor;
     float u_dst_alpha_factor;
     u32 u_interlaced_displayed_field;
     u32 u_set_mask_while_drawing;
+
+    // only used by the uber shaders
+    u32 u_texture_mode;
+    u32 u_dithering;
+    u32 u_interlacing;
   };
 
   struct VRAMFillUBOData
@@ -168,6 +186,7 @@ protected:
     u32 num_batches;
     u32 num_vram_read_texture_updates;
     u32 num_uniform_buffer_updates;
+    u32 num_vram_write_flushes;
   };
 
   class ShaderCompileProgressTracker
@@ -209,6 +228,21 @@ protected:
   u32 CalculateResolutionScale() const;
   GPUDownsampleMode GetDownsampleMode(u32 resolution_scale) const;
 
+  enum : u32
+  {
+    VRAM_DIRTY_TILE_SHIFT = 5,
+    VRAM_DIRTY_TILE_SIZE = 1u << VRAM_DIRTY_TILE_SHIFT,
+  };
+  static_assert((VRAM_WIDTH / VRAM_DIRTY_TILE_SIZE) == 32, "one word per row of dirty tiles");
+
+  /// Returns the bits for the tile columns covering [left, right).
+  ALWAYS_INLINE static u32 GetVRAMDirtyTileMask(u32 left, u32 right)
+  {
+    const u32 first_col = left >> VRAM_DIRTY_TILE_SHIFT;
+    const u32 last_col = (right - 1) >> VRAM_DIRTY_TILE_SHIFT;
+    return ((2u << last_col) - 1u) & ~((1u << first_col) - 1u);
+  }
+
   ALWAYS_INLINE bool IsUsingMultisampling() const { return m_multisamples > 1; }
   ALWAYS_INLINE bool IsUsingDownsampling() const
   {
@@ -218,11 +252,34 @@ protected:
   void SetFullVRAMDirtyRectangle()
   {
     m_vram_dirty_rect.Set(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+    m_vram_dirty_tiles.fill(~0u);
     m_draw_mode.SetTexturePageChanged();
   }
-  void ClearVRAMDirtyRectangle() { m_vram_dirty_rect.SetInvalid(); }
+  void ClearVRAMDirtyRectangle()
+  {
+    m_vram_dirty_rect.SetInvalid();
+    m_vram_dirty_tiles.fill(0u);
+  }
   void IncludeVRAMDirtyRectangle(const Common::Rectangle<u32>& rect);
 
+  /// Marks an area which has been drawn to as dirty. Right and bottom are exclusive.
+  ALWAYS_INLINE void IncludeDrawnVRAMDirtyRectangle(u32 left, u32 right, u32 top, u32 bottom)
+  {
+    m_vram_dirty_rect.Include(left, right, top, bottom);
+    if (left >= right || top >= bottom)
+      return;
+
+    const u32 mask = GetVRAMDirtyTileMask(left, right);
+    for (u32 row = (top >> VRAM_DIRTY_TILE_SHIFT); row <= ((bottom - 1) >> VRAM_DIRTY_TILE_SHIFT); row++)
+      m_vram_dirty_tiles[row] |= mask;
+  }
+
+  /// Returns true if any of the dirty tiles overlap the rectangle, which is clamped to VRAM.
+  bool IsVRAMDirty(const Common::Rectangle<u32>& rect) const;
+
+  /// Returns the dirty tiles as rectangles, merging runs which are identical in consecutive rows.
+  void GetVRAMDirtyRectangles(std::vector<Common::Rectangle<u32>>* rects) const;
+
   bool IsFlushed() const { return m_batch_current_vertex_ptr == m_batch_start_vertex_ptr; }
 
   u32 GetBatchVertexSpace() const { return static_cast<u32>(m_batch_end_vertex_ptr - m_batch_current_vertex_ptr); }
@@ -232,9 +289,11 @@ protected:
   void ResetBatchVertexDepth();
 
   /// Returns the value to be written to the depth buffer for the current operation for mask bit emulation.
+  /// The range is a power of two, so every ID is exact in the float depth buffer, with a few ulps left over for
+  /// interpolation error. Running out of IDs means rebuilding the depth buffer from VRAM, so the wider the better.
   ALWAYS_INLINE float GetCurrentNormalizedVertexDepth() const
   {
-    return 1.0f - (static_cast<float>(m_current_depth) / 65535.0f);
+    return 1.0f - (static_cast<float>(m_current_depth) / static_cast<float>(VERTEX_DEPTH_COUNTER_RANGE));
   }
 
   /// Returns the interlaced mode to use when scanning out/displaying.
@@ -261,6 +320,10 @@ protected:
   /// Returns true if alpha blending should be enabled for drawing the current batch.
   ALWAYS_INLINE bool UseAlphaBlending(GPUTransparencyMode transparency_mode, BatchRenderMode render_mode) const
   {
+    // blended in the shader, against the fetched framebuffer value
+    if (m_supports_framebuffer_fetch)
+      return false;
+
     if (m_texture_filtering == GPUTextureFilter::Bilinear || m_texture_filtering == GPUTextureFilter::JINC2 ||
         m_texture_filtering == GPUTextureFilter::xBR)
     {
@@ -274,10 +337,11 @@ protected:
   }
 
   /// We need two-pass rendering when using BG-FG blending and texturing, as the transparency can be enabled
-  /// on a per-pixel basis, and the opaque pixels shouldn't be blended at all.
+  /// on a per-pixel basis, and the opaque pixels shouldn't be blended at all. Not when the shader does the blending
+  /// itself with framebuffer fetch, then it can pick per pixel.
   ALWAYS_INLINE bool NeedsTwoPassRendering() const
   {
-    return (m_batch.texture_mode != GPUTextureMode::Disabled &&
+    return (!m_supports_framebuffer_fetch && m_batch.texture_mode != GPUTextureMode::Disabled &&
             (m_batch.transparency_mode == GPUTransparencyMode::BackgroundMinusForeground ||
              (!m_supports_dual_source_blend && m_batch.transparency_mode != GPUTransparencyMode::Disabled)));
   }
@@ -365,22 +429,28 @@ protected:
   u32 m_resolution_scale = 1;
   u32 m_multisamples = 1;
   u32 m_max_resolution_scale = 1;
+
+  // upper limit from dynamic resolution, zero until it first steps down
+  u32 m_dynamic_resolution_scale = 0;
+  u32 m_dynamic_resolution_high_count = 0;
+  u32 m_dynamic_resolution_low_count = 0;
   u32 m_max_multisamples = 1;
   RenderAPI m_render_api = RenderAPI::None;
   bool m_true_color = true;
 
   union
   {
-    BitField<u8, bool, 0, 1> m_supports_per_sample_shading;
-    BitField<u8, bool, 1, 1> m_supports_dual_source_blend;
-    BitField<u8, bool, 2, 1> m_supports_adaptive_downsampling;
-    BitField<u8, bool, 3, 1> m_supports_disable_color_perspective;
-    BitField<u8, bool, 4, 1> m_per_sample_shading;
-    BitField<u8, bool, 5, 1> m_scaled_dithering;
-    BitField<u8, bool, 6, 1> m_chroma_smoothing;
-    BitField<u8, bool, 7, 1> m_disable_color_perspective;
-
-    u8 bits = 0;
+    BitField<u16, bool, 0, 1> m_supports_per_sample_shading;
+    BitField<u16, bool, 1, 1> m_supports_dual_source_blend;
+    BitField<u16, bool, 2, 1> m_supports_adaptive_downsampling;
+    BitField<u16, bool, 3, 1> m_supports_disable_color_perspective;
+    BitField<u16, bool, 4, 1> m_per_sample_shading;
+    BitField<u16, bool, 5, 1> m_scaled_dithering;
+    BitField<u16, bool, 6, 1> m_chroma_smoothing;
+    BitField<u16, bool, 7, 1> m_disable_color_perspective;
+    BitField<u16, bool, 8, 1> m_supports_framebuffer_fetch;
+
+    u16 bits = 0;
   };
 
   GPUTextureFilter m_texture_filtering = GPUTextureFilter::Nearest;
@@ -388,12 +458,19 @@ protected:
   bool m_using_uv_limits = false;
   bool m_pgxp_depth_buffer = false;
 
+  // Set by backends which can draw with the uber shaders, so the batch state is kept in the uniform buffer.
+  bool m_batch_ubo_uber_state = false;
+
   BatchConfig m_batch;
   BatchUBOData m_batch_ubo_data = {};
 
   // Bounding box of VRAM area that the GPU has drawn into.
   Common::Rectangle<u32> m_vram_dirty_rect;
 
+  // Same area as coarse tiles, so distant writes don't dirty everything between them. Bit N of each row is the tile
+  // starting at X = N * VRAM_DIRTY_TILE_SIZE.
+  std::array<u32, VRAM_HEIGHT / VRAM_DIRTY_TILE_SIZE> m_vram_dirty_tiles = {};
+
   // Statistics
   RendererStats m_renderer_stats = {};
   RendererStats m_last_renderer_stats = {};
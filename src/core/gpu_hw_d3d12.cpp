@@ -11,6 +11,7 @@
 #include "common/timer.h"
 #include "gpu_hw_shadergen.h"
 #include "host_display.h"
+#include "host_time_accounting.h"
 #include "system.h"
 Log_SetChannel(GPU_HW_D3D12);
 
@@ -318,7 +319,7 @@ bool GPU_HW_D3D12::CreateFramebuffer()
   const u32 texture_width = VRAM_WIDTH * m_resolution_scale;
   const u32 texture_height = VRAM_HEIGHT * m_resolution_scale;
   const DXGI_FORMAT texture_format = DXGI_FORMAT_R8G8B8A8_UNORM;
-  const DXGI_FORMAT depth_format = DXGI_FORMAT_D16_UNORM;
+  const DXGI_FORMAT depth_format = DXGI_FORMAT_D32_FLOAT;
 
   if (!m_vram_texture.Create(texture_width, texture_height, 1, 1, m_multisamples, texture_format, texture_format,
                              texture_format, DXGI_FORMAT_UNKNOWN, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET) ||
@@ -412,12 +413,14 @@ bool GPU_HW_D3D12::CreateTextureBuffer()
 
 bool GPU_HW_D3D12::CompilePipelines()
 {
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::ShaderCompile);
   D3D12::ShaderCache shader_cache;
   shader_cache.Open(EmuFolders::Cache, g_d3d12_context->GetFeatureLevel(), g_settings.gpu_use_debug_device);
 
   GPU_HW_ShaderGen shadergen(g_host_display->GetRenderAPI(), m_resolution_scale, m_multisamples, m_per_sample_shading,
                              m_true_color, m_scaled_dithering, m_texture_filtering, m_using_uv_limits,
-                             m_pgxp_depth_buffer, m_disable_color_perspective, m_supports_dual_source_blend);
+                             m_pgxp_depth_buffer, m_disable_color_perspective, m_supports_dual_source_blend,
+                             m_supports_framebuffer_fetch);
 
   ShaderCompileProgressTracker progress("Compiling Pipelines", 2 + (4 * 9 * 2 * 2) + (2 * 4 * 5 * 9 * 2 * 2) + 1 +
                                                                  (2 * 2) + 2 + 2 + 1 + 1 + (2 * 3) + 1);
@@ -486,8 +489,9 @@ bool GPU_HW_D3D12::CompilePipelines()
               {
                 gpbuilder.AddVertexAttribute("ATTR", 2, DXGI_FORMAT_R32_UINT, 0, offsetof(BatchVertex, u));
                 gpbuilder.AddVertexAttribute("ATTR", 3, DXGI_FORMAT_R32_UINT, 0, offsetof(BatchVertex, texpage));
+                gpbuilder.AddVertexAttribute("ATTR", 4, DXGI_FORMAT_R32_UINT, 0, offsetof(BatchVertex, texwindow));
                 if (m_using_uv_limits)
-                  gpbuilder.AddVertexAttribute("ATTR", 4, DXGI_FORMAT_R8G8B8A8_UNORM, 0,
+                  gpbuilder.AddVertexAttribute("ATTR", 5, DXGI_FORMAT_R8G8B8A8_UNORM, 0,
                                                offsetof(BatchVertex, uv_limits));
               }
 
@@ -773,16 +777,22 @@ bool GPU_HW_D3D12::BlitVRAMReplacementTexture(const TextureReplacementTexture* t
   if (!CreateTextureReplacementStreamBuffer())
     return false;
 
-  if (m_vram_write_replacement_texture.GetWidth() < tex->GetWidth() ||
-      m_vram_write_replacement_texture.GetHeight() < tex->GetHeight())
+  // The copy queue can only be used once the GPU is done with the texture, which is left in the common state.
+  const u32 texture_index = m_next_vram_write_replacement_texture;
+  D3D12::Texture& rtex = m_vram_write_replacement_textures[texture_index];
+  bool use_copy_queue = (g_d3d12_context->HasCopyQueue() && m_vram_write_replacement_texture_fences[texture_index] <=
+                                                               g_d3d12_context->GetCompletedFenceValue());
+  if (rtex.GetWidth() < tex->GetWidth() || rtex.GetHeight() < tex->GetHeight())
   {
-    if (!m_vram_write_replacement_texture.Create(tex->GetWidth(), tex->GetHeight(), 1, 1, 1, DXGI_FORMAT_R8G8B8A8_UNORM,
-                                                 DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_UNKNOWN, DXGI_FORMAT_UNKNOWN,
-                                                 D3D12_RESOURCE_FLAG_NONE))
+    if (!rtex.Create(tex->GetWidth(), tex->GetHeight(), 1, 1, 1, DXGI_FORMAT_R8G8B8A8_UNORM,
+                     DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_UNKNOWN, DXGI_FORMAT_UNKNOWN, D3D12_RESOURCE_FLAG_NONE))
     {
       Log_ErrorPrint("Failed to create VRAM write replacement texture");
       return false;
     }
+
+    // new textures start in the shader resource state
+    use_copy_queue = false;
   }
 
   const u32 copy_pitch = Common::AlignUpPow2<u32>(tex->GetWidth() * sizeof(u32), D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
@@ -804,22 +814,32 @@ bool GPU_HW_D3D12::BlitVRAMReplacementTexture(const TextureReplacementTexture* t
   D3D12::Texture::CopyToUploadBuffer(tex->GetPixels(), tex->GetPitch(), tex->GetHeight(),
                                      m_texture_replacment_stream_buffer.GetCurrentHostPointer(), copy_pitch);
   m_texture_replacment_stream_buffer.CommitMemory(required_size);
-  m_vram_write_replacement_texture.CopyFromBuffer(0, 0, tex->GetWidth(), tex->GetHeight(), copy_pitch,
-                                                  m_texture_replacment_stream_buffer.GetBuffer(), sb_offset);
-  m_vram_write_replacement_texture.TransitionToState(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+  if (!use_copy_queue ||
+      !rtex.CopyFromBufferOnCopyQueue(0, 0, tex->GetWidth(), tex->GetHeight(), copy_pitch,
+                                      m_texture_replacment_stream_buffer.GetBuffer(), sb_offset))
+  {
+    rtex.CopyFromBuffer(0, 0, tex->GetWidth(), tex->GetHeight(), copy_pitch,
+                        m_texture_replacment_stream_buffer.GetBuffer(), sb_offset);
+  }
+  rtex.TransitionToState(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 
   // texture -> vram
-  const float uniforms[] = {
-    0.0f, 0.0f, static_cast<float>(tex->GetWidth()) / static_cast<float>(m_vram_write_replacement_texture.GetWidth()),
-    static_cast<float>(tex->GetHeight()) / static_cast<float>(m_vram_write_replacement_texture.GetHeight())};
+  const float uniforms[] = {0.0f, 0.0f, static_cast<float>(tex->GetWidth()) / static_cast<float>(rtex.GetWidth()),
+                            static_cast<float>(tex->GetHeight()) / static_cast<float>(rtex.GetHeight())};
   ID3D12GraphicsCommandList* cmdlist = g_d3d12_context->GetCommandList();
   cmdlist->SetGraphicsRootSignature(m_single_sampler_root_signature.Get());
   cmdlist->SetGraphicsRoot32BitConstants(0, sizeof(uniforms) / sizeof(u32), uniforms, 0);
-  cmdlist->SetGraphicsRootDescriptorTable(1, m_vram_write_replacement_texture.GetSRVDescriptor());
+  cmdlist->SetGraphicsRootDescriptorTable(1, rtex.GetSRVDescriptor());
   cmdlist->SetGraphicsRootDescriptorTable(2, m_linear_sampler.gpu_handle);
   cmdlist->SetPipelineState(m_copy_pipeline.Get());
   D3D12::SetViewportAndScissor(cmdlist, dst_x, dst_y, width, height);
   cmdlist->DrawInstanced(3, 1, 0, 0);
+
+  // leave it ready for the copy queue once this command list completes
+  rtex.TransitionToState(D3D12_RESOURCE_STATE_COMMON);
+  m_vram_write_replacement_texture_fences[texture_index] = g_d3d12_context->GetCurrentFenceValue();
+  m_next_vram_write_replacement_texture = (texture_index + 1) % NUM_VRAM_WRITE_REPLACEMENT_TEXTURES;
+
   RestoreGraphicsAPIState();
   return true;
 }
@@ -1085,7 +1105,7 @@ void GPU_HW_D3D12::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 widt
   {
     const Common::Rectangle<u32> src_bounds = GetVRAMTransferBounds(src_x, src_y, width, height);
     const Common::Rectangle<u32> dst_bounds = GetVRAMTransferBounds(dst_x, dst_y, width, height);
-    if (m_vram_dirty_rect.Intersects(src_bounds))
+    if (IsVRAMDirty(src_bounds))
       UpdateVRAMReadTexture();
     IncludeVRAMDirtyRectangle(dst_bounds);
 
@@ -1109,7 +1129,7 @@ void GPU_HW_D3D12::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 widt
     return;
   }
 
-  if (m_vram_dirty_rect.Intersects(Common::Rectangle<u32>::FromExtents(src_x, src_y, width, height)))
+  if (IsVRAMDirty(Common::Rectangle<u32>::FromExtents(src_x, src_y, width, height)))
     UpdateVRAMReadTexture();
 
   GPU_HW::CopyVRAM(src_x, src_y, dst_x, dst_y, width, height);
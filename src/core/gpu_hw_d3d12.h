@@ -48,6 +48,7 @@ private:
   {
     MAX_PUSH_CONSTANTS_SIZE = 64,
     TEXTURE_REPLACEMENT_BUFFER_SIZE = 64 * 1024 * 1024,
+    NUM_VRAM_WRITE_REPLACEMENT_TEXTURES = 4,
   };
   void SetCapabilities();
   void DestroyResources();
@@ -106,6 +107,11 @@ private:
   DimensionalArray<ComPtr<ID3D12PipelineState>, 3, 2> m_display_pipelines;
 
   ComPtr<ID3D12PipelineState> m_copy_pipeline;
-  D3D12::Texture m_vram_write_replacement_texture;
+
+  // Replacement uploads rotate through several textures, so a copy queue upload never overwrites a texture which is
+  // still being sampled by a command list in flight.
+  std::array<D3D12::Texture, NUM_VRAM_WRITE_REPLACEMENT_TEXTURES> m_vram_write_replacement_textures;
+  std::array<u64, NUM_VRAM_WRITE_REPLACEMENT_TEXTURES> m_vram_write_replacement_texture_fences = {};
+  u32 m_next_vram_write_replacement_texture = 0;
   D3D12::StreamBuffer m_texture_replacment_stream_buffer;
 };
@@ -5,6 +5,7 @@
 #include "gpu_hw_shadergen.h"
 #include "host.h"
 #include "host_display.h"
+#include "host_time_accounting.h"
 #include "shader_cache_version.h"
 #include "system.h"
 #include "texture_replacements.h"
@@ -382,6 +383,10 @@ void GPU_HW_OpenGL::SetCapabilities()
     (max_dual_source_draw_buffers > 0) &&
     (GLAD_GL_VERSION_3_3 || GLAD_GL_ARB_blend_func_extended || GLAD_GL_EXT_blend_func_extended);
 
+  // mostly tiled mobile GPUs, where reading the framebuffer in the shader is nearly free
+  m_supports_framebuffer_fetch = GLAD_GL_EXT_shader_framebuffer_fetch;
+  Log_InfoPrintf("Framebuffer fetch: %s", m_supports_framebuffer_fetch ? "supported" : "not supported");
+
   // adaptive smoothing would require texture views, which aren't in GLES.
   m_supports_adaptive_downsampling = false;
 
@@ -398,8 +403,8 @@ bool GPU_HW_OpenGL::CreateFramebuffer()
 
   if (!m_vram_texture.Create(texture_width, texture_height, 1, 1, multisamples, GPUTexture::Format::RGBA8, nullptr, 0,
                              true, true) ||
-      !m_vram_depth_texture.Create(texture_width, texture_height, 1, 1, multisamples, GPUTexture::Format::D16, nullptr,
-                                   0, false, true) ||
+      !m_vram_depth_texture.Create(texture_width, texture_height, 1, 1, multisamples, GPUTexture::Format::D32F,
+                                   nullptr, 0, false, true) ||
       !m_vram_read_texture.Create(texture_width, texture_height, 1, 1, 1, GPUTexture::Format::RGBA8, nullptr, 0, false,
                                   true) ||
       !m_vram_read_texture.CreateFramebuffer() ||
@@ -467,13 +472,16 @@ bool GPU_HW_OpenGL::CreateVertexBuffer()
   glEnableVertexAttribArray(2);
   glEnableVertexAttribArray(3);
   glEnableVertexAttribArray(4);
+  glEnableVertexAttribArray(5);
   glVertexAttribPointer(0, 4, GL_FLOAT, false, sizeof(BatchVertex), reinterpret_cast<void*>(offsetof(BatchVertex, x)));
   glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, true, sizeof(BatchVertex),
                         reinterpret_cast<void*>(offsetof(BatchVertex, color)));
   glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(BatchVertex), reinterpret_cast<void*>(offsetof(BatchVertex, u)));
   glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(BatchVertex),
                          reinterpret_cast<void*>(offsetof(BatchVertex, texpage)));
-  glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, true, sizeof(BatchVertex),
+  glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(BatchVertex),
+                         reinterpret_cast<void*>(offsetof(BatchVertex, texwindow)));
+  glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, true, sizeof(BatchVertex),
                         reinterpret_cast<void*>(offsetof(BatchVertex, uv_limits)));
   glBindVertexArray(0);
 
@@ -512,13 +520,16 @@ bool GPU_HW_OpenGL::CreateTextureBuffer()
 
 bool GPU_HW_OpenGL::CompilePrograms()
 {
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::ShaderCompile);
   GL::ShaderCache shader_cache;
-  shader_cache.Open(IsGLES(), EmuFolders::Cache, SHADER_CACHE_VERSION);
+  shader_cache.Open(IsGLES(), EmuFolders::Cache, SHADER_CACHE_VERSION,
+                    static_cast<u64>(g_settings.gpu_shader_cache_size_limit) * 1024 * 1024);
 
   const bool use_binding_layout = GPU_HW_ShaderGen::UseGLSLBindingLayout();
   GPU_HW_ShaderGen shadergen(g_host_display->GetRenderAPI(), m_resolution_scale, m_multisamples, m_per_sample_shading,
                              m_true_color, m_scaled_dithering, m_texture_filtering, m_using_uv_limits,
-                             m_pgxp_depth_buffer, m_disable_color_perspective, m_supports_dual_source_blend);
+                             m_pgxp_depth_buffer, m_disable_color_perspective, m_supports_dual_source_blend,
+                             m_supports_framebuffer_fetch);
 
   ShaderCompileProgressTracker progress("Compiling Programs", (4 * 9 * 2 * 2) + (2 * 3) + (2 * 2) + 1 + 1 + 1 + 1 + 1);
 
@@ -545,7 +556,8 @@ bool GPU_HW_OpenGL::CompilePrograms()
               {
                 prog.BindAttribute(2, "a_texcoord");
                 prog.BindAttribute(3, "a_texpage");
-                prog.BindAttribute(4, "a_uv_limits");
+                prog.BindAttribute(4, "a_texwindow");
+                prog.BindAttribute(5, "a_uv_limits");
               }
 
               if (!IsGLES() || m_supports_dual_source_blend)
@@ -1160,7 +1172,7 @@ void GPU_HW_OpenGL::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 wid
 
   const Common::Rectangle<u32> dst_bounds = GetVRAMTransferBounds(dst_x, dst_y, width, height);
   const Common::Rectangle<u32> src_bounds = GetVRAMTransferBounds(src_x, src_y, width, height);
-  const bool src_dirty = m_vram_dirty_rect.Intersects(src_bounds);
+  const bool src_dirty = IsVRAMDirty(src_bounds);
 
   if (UseVRAMCopyShader(src_x, src_y, dst_x, dst_y, width, height))
   {
@@ -5,16 +5,30 @@
 GPU_HW_ShaderGen::GPU_HW_ShaderGen(RenderAPI render_api, u32 resolution_scale, u32 multisamples,
                                    bool per_sample_shading, bool true_color, bool scaled_dithering,
                                    GPUTextureFilter texture_filtering, bool uv_limits, bool pgxp_depth,
-                                   bool disable_color_perspective, bool supports_dual_source_blend)
+                                   bool disable_color_perspective, bool supports_dual_source_blend,
+                                   bool supports_framebuffer_fetch)
   : ShaderGen(render_api, supports_dual_source_blend), m_resolution_scale(resolution_scale),
     m_multisamples(multisamples), m_per_sample_shading(per_sample_shading), m_true_color(true_color),
     m_scaled_dithering(scaled_dithering), m_texture_filter(texture_filtering), m_uv_limits(uv_limits),
     m_pgxp_depth(pgxp_depth), m_disable_color_perspective(disable_color_perspective)
 {
+  m_supports_framebuffer_fetch = supports_framebuffer_fetch;
 }
 
 GPU_HW_ShaderGen::~GPU_HW_ShaderGen() = default;
 
+u64 GPU_HW_ShaderGen::GetCacheKeyParameters() const
+{
+  return (static_cast<u64>(m_render_api) | (static_cast<u64>(m_resolution_scale) << 8) |
+          (static_cast<u64>(m_multisamples) << 16) | (static_cast<u64>(m_texture_filter) << 24) |
+          (static_cast<u64>(m_per_sample_shading) << 32) | (static_cast<u64>(m_true_color) << 33) |
+          (static_cast<u64>(m_scaled_dithering) << 34) | (static_cast<u64>(m_uv_limits) << 35) |
+          (static_cast<u64>(m_pgxp_depth) << 36) | (static_cast<u64>(m_disable_color_perspective) << 37) |
+          (static_cast<u64>(m_supports_dual_source_blend) << 38) |
+          (static_cast<u64>(m_use_glsl_interface_blocks) << 39) | (static_cast<u64>(m_use_glsl_binding_layout) << 40) |
+          (static_cast<u64>(m_supports_framebuffer_fetch) << 41));
+}
+
 void GPU_HW_ShaderGen::WriteCommonFunctions(std::stringstream& ss)
 {
   DefineMacro(ss, "MULTISAMPLING", UsingMSAA());
@@ -49,9 +63,9 @@ float4 RGBA5551ToRGBA8(uint v)
 void GPU_HW_ShaderGen::WriteBatchUniformBuffer(std::stringstream& ss)
 {
   DeclareUniformBuffer(ss,
-                       {"uint2 u_texture_window_and", "uint2 u_texture_window_or", "float u_src_alpha_factor",
-                        "float u_dst_alpha_factor", "uint u_interlaced_displayed_field",
-                        "bool u_set_mask_while_drawing"},
+                       {"float u_src_alpha_factor", "float u_dst_alpha_factor", "uint u_interlaced_displayed_field",
+                        "bool u_set_mask_while_drawing", "uint u_texture_mode", "bool u_dithering",
+                        "bool u_interlacing"},
                        false);
 }
 
@@ -70,16 +84,18 @@ std::string GPU_HW_ShaderGen::GenerateBatchVertexShader(bool textured)
   {
     if (m_uv_limits)
     {
-      DeclareVertexEntryPoint(
-        ss, {"float4 a_pos", "float4 a_col0", "uint a_texcoord", "uint a_texpage", "float4 a_uv_limits"}, 1, 1,
-        {{"nointerpolation", "uint4 v_texpage"}, {"nointerpolation", "float4 v_uv_limits"}}, false, "", UsingMSAA(),
-        UsingPerSampleShading(), m_disable_color_perspective);
+      DeclareVertexEntryPoint(ss,
+                              {"float4 a_pos", "float4 a_col0", "uint a_texcoord", "uint a_texpage", "uint a_texwindow",
+                               "float4 a_uv_limits"},
+                              1, 1, {{"nointerpolation", "uint4 v_texpage"}, {"nointerpolation", "float4 v_uv_limits"}},
+                              false, "", UsingMSAA(), UsingPerSampleShading(), m_disable_color_perspective);
     }
     else
     {
-      DeclareVertexEntryPoint(ss, {"float4 a_pos", "float4 a_col0", "uint a_texcoord", "uint a_texpage"}, 1, 1,
-                              {{"nointerpolation", "uint4 v_texpage"}}, false, "", UsingMSAA(), UsingPerSampleShading(),
-                              m_disable_color_perspective);
+      DeclareVertexEntryPoint(
+        ss, {"float4 a_pos", "float4 a_col0", "uint a_texcoord", "uint a_texpage", "uint a_texwindow"}, 1, 1,
+        {{"nointerpolation", "uint4 v_texpage"}}, false, "", UsingMSAA(), UsingPerSampleShading(),
+        m_disable_color_perspective);
     }
   }
   else
@@ -125,12 +141,18 @@ std::string GPU_HW_ShaderGen::GenerateBatchVertexShader(bool textured)
     v_tex0 = float2(float((a_texcoord & 0xFFFFu) * RESOLUTION_SCALE),
                     float((a_texcoord >> 16) * RESOLUTION_SCALE));
 
-    // base_x,base_y,palette_x,palette_y
+    // base_x,base_y,palette_x,palette_y in the lower 16 bits
     v_texpage.x = (a_texpage & 15u) * 64u * RESOLUTION_SCALE;
     v_texpage.y = ((a_texpage >> 4) & 1u) * 256u * RESOLUTION_SCALE;
     v_texpage.z = ((a_texpage >> 16) & 63u) * 16u * RESOLUTION_SCALE;
     v_texpage.w = ((a_texpage >> 22) & 511u) * RESOLUTION_SCALE;
 
+    // texture window and_x,and_y,or_x,or_y in the upper 16 bits
+    v_texpage.x |= (a_texwindow & 0xFFu) << 16;
+    v_texpage.y |= ((a_texwindow >> 8) & 0xFFu) << 16;
+    v_texpage.z |= ((a_texwindow >> 16) & 0xFFu) << 16;
+    v_texpage.w |= (a_texwindow >> 24) << 16;
+
     #if UV_LIMITS
       v_uv_limits = a_uv_limits * float4(255.0, 255.0, 255.0, 255.0);
     #endif
@@ -628,14 +650,28 @@ void FilteredSampleFromVRAM(uint4 texpage, float2 coords, float4 uv_limits,
 
 std::string GPU_HW_ShaderGen::GenerateBatchFragmentShader(GPU_HW::BatchRenderMode transparency,
                                                           GPUTextureMode texture_mode, bool dithering, bool interlacing)
+{
+  return GenerateBatchFragmentShader(transparency, texture_mode, dithering, interlacing, false);
+}
+
+std::string GPU_HW_ShaderGen::GenerateBatchUberFragmentShader(GPU_HW::BatchRenderMode transparency)
+{
+  return GenerateBatchFragmentShader(transparency, GPUTextureMode::Disabled, false, false, true);
+}
+
+std::string GPU_HW_ShaderGen::GenerateBatchFragmentShader(GPU_HW::BatchRenderMode transparency,
+                                                          GPUTextureMode texture_mode, bool dithering, bool interlacing,
+                                                          bool uber)
 {
   const GPUTextureMode actual_texture_mode = texture_mode & ~GPUTextureMode::RawTextureBit;
   const bool raw_texture = (texture_mode & GPUTextureMode::RawTextureBit) == GPUTextureMode::RawTextureBit;
-  const bool textured = (texture_mode != GPUTextureMode::Disabled);
+  const bool textured = uber || (texture_mode != GPUTextureMode::Disabled);
+  const bool use_framebuffer_fetch = m_supports_framebuffer_fetch;
   const bool use_dual_source =
-    m_supports_dual_source_blend && ((transparency != GPU_HW::BatchRenderMode::TransparencyDisabled &&
-                                      transparency != GPU_HW::BatchRenderMode::OnlyOpaque) ||
-                                     m_texture_filter != GPUTextureFilter::Nearest);
+    !use_framebuffer_fetch && m_supports_dual_source_blend &&
+    ((transparency != GPU_HW::BatchRenderMode::TransparencyDisabled &&
+      transparency != GPU_HW::BatchRenderMode::OnlyOpaque) ||
+     m_texture_filter != GPUTextureFilter::Nearest);
 
   std::stringstream ss;
   WriteHeader(ss);
@@ -643,18 +679,28 @@ std::string GPU_HW_ShaderGen::GenerateBatchFragmentShader(GPU_HW::BatchRenderMod
   DefineMacro(ss, "TRANSPARENCY_ONLY_OPAQUE", transparency == GPU_HW::BatchRenderMode::OnlyOpaque);
   DefineMacro(ss, "TRANSPARENCY_ONLY_TRANSPARENT", transparency == GPU_HW::BatchRenderMode::OnlyTransparent);
   DefineMacro(ss, "TEXTURED", textured);
-  DefineMacro(ss, "PALETTE",
-              actual_texture_mode == GPUTextureMode::Palette4Bit || actual_texture_mode == GPUTextureMode::Palette8Bit);
-  DefineMacro(ss, "PALETTE_4_BIT", actual_texture_mode == GPUTextureMode::Palette4Bit);
-  DefineMacro(ss, "PALETTE_8_BIT", actual_texture_mode == GPUTextureMode::Palette8Bit);
-  DefineMacro(ss, "RAW_TEXTURE", raw_texture);
-  DefineMacro(ss, "DITHERING", dithering);
   DefineMacro(ss, "DITHERING_SCALED", m_scaled_dithering);
-  DefineMacro(ss, "INTERLACING", interlacing);
+
+  // The batch state is tested with branches instead of the preprocessor, so the uber shader can read it from the
+  // uniform buffer. Otherwise they're constants, and the compiler removes the branches.
+  const auto define_batch_state = [&ss, uber](const char* name, bool value, const char* uniform_value) {
+    ss << "#define " << name << " " << (uber ? uniform_value : (value ? "true" : "false")) << "\n";
+  };
+  define_batch_state("TEXTURED_BATCH", textured, "(u_texture_mode != 8u)");
+  define_batch_state("PALETTE",
+                     actual_texture_mode == GPUTextureMode::Palette4Bit ||
+                       actual_texture_mode == GPUTextureMode::Palette8Bit,
+                     "((u_texture_mode & 3u) < 2u)");
+  define_batch_state("PALETTE_4_BIT", actual_texture_mode == GPUTextureMode::Palette4Bit,
+                     "((u_texture_mode & 3u) == 0u)");
+  define_batch_state("RAW_TEXTURE", raw_texture, "((u_texture_mode & 4u) != 0u)");
+  define_batch_state("DITHERING", dithering, "u_dithering");
+  define_batch_state("INTERLACING", interlacing, "u_interlacing");
   DefineMacro(ss, "TRUE_COLOR", m_true_color);
   DefineMacro(ss, "TEXTURE_FILTERING", m_texture_filter != GPUTextureFilter::Nearest);
   DefineMacro(ss, "UV_LIMITS", m_uv_limits);
   DefineMacro(ss, "USE_DUAL_SOURCE", use_dual_source);
+  DefineMacro(ss, "USE_FRAMEBUFFER_FETCH", use_framebuffer_fetch);
   DefineMacro(ss, "PGXP_DEPTH", m_pgxp_depth);
 
   WriteCommonFunctions(ss);
@@ -696,18 +742,18 @@ uint3 ApplyDithering(uint2 coord, uint3 icol)
 #if TEXTURED
 CONSTANT float4 TRANSPARENT_PIXEL_COLOR = float4(0.0, 0.0, 0.0, 0.0);
 
-uint2 ApplyTextureWindow(uint2 coords)
+uint2 ApplyTextureWindow(uint4 texwindow, uint2 coords)
 {
-  uint x = (uint(coords.x) & u_texture_window_and.x) | u_texture_window_or.x;
-  uint y = (uint(coords.y) & u_texture_window_and.y) | u_texture_window_or.y;
+  uint x = (uint(coords.x) & texwindow.x) | texwindow.z;
+  uint y = (uint(coords.y) & texwindow.y) | texwindow.w;
   return uint2(x, y);
 }
 
-uint2 ApplyUpscaledTextureWindow(uint2 coords)
+uint2 ApplyUpscaledTextureWindow(uint4 texwindow, uint2 coords)
 {
   uint2 native_coords = coords / uint2(RESOLUTION_SCALE, RESOLUTION_SCALE);
   uint2 coords_offset = coords % uint2(RESOLUTION_SCALE, RESOLUTION_SCALE);
-  return (ApplyTextureWindow(native_coords) * uint2(RESOLUTION_SCALE, RESOLUTION_SCALE)) + coords_offset;
+  return (ApplyTextureWindow(texwindow, native_coords) * uint2(RESOLUTION_SCALE, RESOLUTION_SCALE)) + coords_offset;
 }
 
 uint2 FloatToIntegerCoords(float2 coords)
@@ -719,40 +765,51 @@ uint2 FloatToIntegerCoords(float2 coords)
 
 float4 SampleFromVRAM(uint4 texpage, float2 coords)
 {
-  #if PALETTE
-    uint2 icoord = ApplyTextureWindow(FloatToIntegerCoords(coords));
+  // The texture window is packed into the upper 16 bits of the texture page.
+  uint4 texwindow = texpage >> 16;
+  texpage &= uint4(0xFFFFu, 0xFFFFu, 0xFFFFu, 0xFFFFu);
+
+  if (PALETTE)
+  {
+    uint2 icoord = ApplyTextureWindow(texwindow, FloatToIntegerCoords(coords));
     uint2 index_coord = icoord;
-    #if PALETTE_4_BIT
+    if (PALETTE_4_BIT)
       index_coord.x /= 4u;
-    #elif PALETTE_8_BIT
+    else
       index_coord.x /= 2u;
-    #endif
 
     // fixup coords
     uint2 vicoord = texpage.xy + (index_coord * uint2(RESOLUTION_SCALE, RESOLUTION_SCALE));
 
-    // load colour/palette
-    float4 texel = SAMPLE_TEXTURE(samp0, float2(vicoord) * RCP_VRAM_SIZE);
+    // Both fetches are for exact texels, so load them rather than going through the sampler. Wrap them ourselves,
+    // since loads don't repeat.
+    float4 texel = LOAD_TEXTURE(samp0, int2(vicoord % VRAM_SIZE), 0);
     uint vram_value = RGBA8ToRGBA5551(texel);
 
     // apply palette
-    #if PALETTE_4_BIT
+    uint palette_index;
+    if (PALETTE_4_BIT)
+    {
       uint subpixel = icoord.x & 3u;
-      uint palette_index = (vram_value >> (subpixel * 4u)) & 0x0Fu;
-    #elif PALETTE_8_BIT
+      palette_index = (vram_value >> (subpixel * 4u)) & 0x0Fu;
+    }
+    else
+    {
       uint subpixel = icoord.x & 1u;
-      uint palette_index = (vram_value >> (subpixel * 8u)) & 0xFFu;
-    #endif
+      palette_index = (vram_value >> (subpixel * 8u)) & 0xFFu;
+    }
 
     // sample palette
     uint2 palette_icoord = uint2(texpage.z + (palette_index * RESOLUTION_SCALE), texpage.w);
-    return SAMPLE_TEXTURE(samp0, float2(palette_icoord) * RCP_VRAM_SIZE);
-  #else
+    return LOAD_TEXTURE(samp0, int2(palette_icoord % VRAM_SIZE), 0);
+  }
+  else
+  {
     // Direct texturing. Render-to-texture effects. Use upscaled coordinates.
-    uint2 icoord = ApplyUpscaledTextureWindow(FloatToIntegerCoords(coords));    
+    uint2 icoord = ApplyUpscaledTextureWindow(texwindow, FloatToIntegerCoords(coords));
     uint2 direct_icoord = texpage.xy + icoord;
     return SAMPLE_TEXTURE(samp0, float2(direct_icoord) * RCP_VRAM_SIZE);
-  #endif
+  }
 }
 
 #endif
@@ -768,52 +825,59 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
       DeclareFragmentEntryPoint(ss, 1, 1,
                                 {{"nointerpolation", "uint4 v_texpage"}, {"nointerpolation", "float4 v_uv_limits"}},
                                 true, use_dual_source ? 2 : 1, !m_pgxp_depth, UsingMSAA(), UsingPerSampleShading(),
-                                false, m_disable_color_perspective);
+                                false, m_disable_color_perspective, use_framebuffer_fetch);
     }
     else
     {
       DeclareFragmentEntryPoint(ss, 1, 1, {{"nointerpolation", "uint4 v_texpage"}}, true, use_dual_source ? 2 : 1,
                                 !m_pgxp_depth, UsingMSAA(), UsingPerSampleShading(), false,
-                                m_disable_color_perspective);
+                                m_disable_color_perspective, use_framebuffer_fetch);
     }
   }
   else
   {
     DeclareFragmentEntryPoint(ss, 1, 0, {}, true, use_dual_source ? 2 : 1, !m_pgxp_depth, UsingMSAA(),
-                              UsingPerSampleShading(), false, m_disable_color_perspective);
+                              UsingPerSampleShading(), false, m_disable_color_perspective, use_framebuffer_fetch);
   }
 
   ss << R"(
 {
   uint3 vertcol = uint3(v_col0.rgb * float3(255.0, 255.0, 255.0));
 
+  #if USE_FRAMEBUFFER_FETCH
+    // read before anything is written to the output
+    float4 fbcol = o_col0;
+  #endif
+
   bool semitransparent;
   uint3 icolor;
   float ialpha;
   float oalpha;
 
-  #if INTERLACING
+  if (INTERLACING)
+  {
     if ((uint(v_pos.y) & 1u) == u_interlaced_displayed_field)
       discard;
-  #endif
+  }
 
   #if TEXTURED
-
+  if (TEXTURED_BATCH)
+  {
     // We can't currently use upscaled coordinate for palettes because of how they're packed.
     // Not that it would be any benefit anyway, render-to-texture effects don't use palettes.
     float2 coords = v_tex0;
-    #if PALETTE
+    if (PALETTE)
       coords /= float2(RESOLUTION_SCALE, RESOLUTION_SCALE);
-    #endif
 
     #if UV_LIMITS
       float4 uv_limits = v_uv_limits;
-      #if !PALETTE
+      if (!PALETTE)
+      {
         // Extend the UV range to all "upscaled" pixels. This means 1-pixel-high polygon-based 
         // framebuffer effects won't be downsampled. (e.g. Mega Man Legends 2 haze effect)
         uv_limits *= float(RESOLUTION_SCALE);
         uv_limits.zw += float(RESOLUTION_SCALE - 1u);
-      #endif
+      }
     #endif
 
     float4 texcol;
@@ -838,45 +902,51 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
     // If not using true color, truncate the framebuffer colors to 5-bit.
     #if !TRUE_COLOR
       icolor = uint3(texcol.rgb * float3(255.0, 255.0, 255.0)) >> 3;
-      #if !RAW_TEXTURE
+      if (!RAW_TEXTURE)
+      {
         icolor = (icolor * vertcol) >> 4;
-        #if DITHERING
+        if (DITHERING)
           icolor = ApplyDithering(uint2(v_pos.xy), icolor);
-        #else
+        else
           icolor = min(icolor >> 3, uint3(31u, 31u, 31u));
-        #endif
-      #endif
+      }
     #else
       icolor = uint3(texcol.rgb * float3(255.0, 255.0, 255.0));
-      #if !RAW_TEXTURE
+      if (!RAW_TEXTURE)
+      {
         icolor = (icolor * vertcol) >> 7;
-        #if DITHERING
+        if (DITHERING)
           icolor = ApplyDithering(uint2(v_pos.xy), icolor);
-        #else
+        else
           icolor = min(icolor, uint3(255u, 255u, 255u));
-        #endif
-      #endif
+      }
     #endif
 
     // Compute output alpha (mask bit)
     oalpha = float(u_set_mask_while_drawing ? 1 : int(semitransparent));
-  #else
+  }
+  else
+  #endif
+  {
     // All pixels are semitransparent for untextured polygons.
     semitransparent = true;
     icolor = vertcol;
     ialpha = 1.0;
 
-    #if DITHERING
+    if (DITHERING)
+    {
       icolor = ApplyDithering(uint2(v_pos.xy), icolor);
-    #else
+    }
+    else
+    {
       #if !TRUE_COLOR
         icolor >>= 3;
       #endif
-    #endif
+    }
 
     // However, the mask bit is cleared if set mask bit is false.
     oalpha = float(u_set_mask_while_drawing);
-  #endif
+  }
 
   // Premultiply alpha so we don't need to use a colour output for it.
   float premultiply_alpha = ialpha;
@@ -894,7 +964,27 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
     color = (float3(icolor) * premultiply_alpha) / float3(255.0, 255.0, 255.0);
   #endif
 
-  #if TRANSPARENCY && TEXTURED
+  #if USE_FRAMEBUFFER_FETCH && (TRANSPARENCY || TEXTURE_FILTERING)
+    // Blend against the framebuffer here instead of in the blend unit. Each pixel picks its own weights, so opaque
+    // and semitransparent texels are done in one pass, and the colour is truncated after blending instead of before.
+    #if TRANSPARENCY
+      float dst_factor = semitransparent ? (u_dst_alpha_factor / ialpha) : (1.0 - ialpha);
+    #else
+      float dst_factor = 1.0 - ialpha;
+    #endif
+
+    #if !TRUE_COLOR
+      float3 dstcol = roundEven(fbcol.rgb * float3(31.0, 31.0, 31.0));
+      o_col0 = float4(clamp(floor(float3(icolor) * premultiply_alpha + dstcol * dst_factor), float3(0.0, 0.0, 0.0),
+                            float3(31.0, 31.0, 31.0)) / float3(31.0, 31.0, 31.0), oalpha);
+    #else
+      o_col0 = float4(saturate(color + fbcol.rgb * dst_factor), oalpha);
+    #endif
+
+    #if !PGXP_DEPTH
+      o_depth = oalpha * v_pos.z;
+    #endif
+  #elif TRANSPARENCY && TEXTURED
     // Apply semitransparency. If not a semitransparent texel, destination alpha is ignored.
     if (semitransparent)
     {
@@ -1324,15 +1414,8 @@ std::string GPU_HW_ShaderGen::GenerateVRAMUpdateDepthFragmentShader()
   return ss.str();
 }
 
-std::string GPU_HW_ShaderGen::GenerateAdaptiveDownsampleMipFragmentShader(bool first_pass)
+void GPU_HW_ShaderGen::WriteAdaptiveDownsampleBiasFunctions(std::stringstream& ss)
 {
-  std::stringstream ss;
-  WriteHeader(ss);
-  WriteCommonFunctions(ss);
-  DeclareTexture(ss, "samp0", 0, false);
-  DeclareUniformBuffer(ss, {"float2 u_uv_min", "float2 u_uv_max", "float2 u_rcp_resolution"}, true);
-  DefineMacro(ss, "FIRST_PASS", first_pass);
-
   // mipmap_energy.glsl ported from parallel-rsx.
   ss << R"(
 
@@ -1359,6 +1442,18 @@ float4 get_bias(float4 c00, float4 c01, float4 c10, float4 c11)
 }
 
 )";
+}
+
+std::string GPU_HW_ShaderGen::GenerateAdaptiveDownsampleMipFragmentShader(bool first_pass)
+{
+  std::stringstream ss;
+  WriteHeader(ss);
+  WriteCommonFunctions(ss);
+  DeclareTexture(ss, "samp0", 0, false);
+  DeclareUniformBuffer(ss, {"float2 u_uv_min", "float2 u_uv_max", "float2 u_rcp_resolution"}, true);
+  DefineMacro(ss, "FIRST_PASS", first_pass);
+
+  WriteAdaptiveDownsampleBiasFunctions(ss);
 
   DeclareFragmentEntryPoint(ss, 0, 1, {}, false, 1, false, false, false, false);
   ss << R"(
@@ -1383,6 +1478,81 @@ float4 get_bias(float4 c00, float4 c01, float4 c10, float4 c11)
   return ss.str();
 }
 
+std::string GPU_HW_ShaderGen::GenerateAdaptiveDownsampleMipComputeShader(u32 levels)
+{
+  // Vulkan only. Each workgroup reads a 32x32 block of the source, writes it to level 0, and reduces it down through
+  // the remaining levels in shared memory, so the whole chain is built in one dispatch.
+  DebugAssert(IsVulkan() && levels >= 2 && levels <= (GPU_HW::ADAPTIVE_DOWNSAMPLE_COMPUTE_TILE_SHIFT + 1));
+
+  std::stringstream ss;
+  WriteHeader(ss);
+  DeclareTexture(ss, "samp0", 0, false);
+  for (u32 level = 0; level < levels; level++)
+    ss << "layout(set = 0, binding = " << (level + 2) << ", rgba8) uniform writeonly image2D o_mip" << level << ";\n";
+  DeclareUniformBuffer(ss, {"uint2 u_base", "uint2 u_rect_min", "uint2 u_rect_size"}, true);
+  WriteAdaptiveDownsampleBiasFunctions(ss);
+
+  ss << R"(
+layout(local_size_x = 16, local_size_y = 16) in;
+
+shared float4 s_mip[16 * 16];
+
+void StoreLevel(uint level, uint2 coords, float4 value)
+{
+  uint2 rect_min = u_rect_min >> level;
+  if (any(lessThan(coords, rect_min)) || any(greaterThanEqual(coords, rect_min + (u_rect_size >> level))))
+    return;
+
+)";
+  for (u32 level = 0; level < levels; level++)
+  {
+    ss << "  " << ((level > 0) ? "else " : "") << "if (level == " << level << "u)\n";
+    ss << "    imageStore(o_mip" << level << ", int2(coords), value);\n";
+  }
+  ss << R"(}
+
+float4 LoadSource(uint2 coords)
+{
+  uint2 clamped = clamp(coords, u_rect_min, u_rect_min + u_rect_size - uint2(1u, 1u));
+  float4 value = texelFetch(samp0, int2(clamped), 0);
+  StoreLevel(0u, coords, value);
+  return value;
+}
+
+void main()
+{
+  uint2 lid = gl_LocalInvocationID.xy;
+  uint2 coords = (u_base >> 1) + gl_WorkGroupID.xy * 16u + lid;
+  float3 c00 = LoadSource(coords * 2u + uint2(0u, 0u)).rgb;
+  float3 c01 = LoadSource(coords * 2u + uint2(0u, 1u)).rgb;
+  float3 c10 = LoadSource(coords * 2u + uint2(1u, 0u)).rgb;
+  float3 c11 = LoadSource(coords * 2u + uint2(1u, 1u)).rgb;
+  float4 value = get_bias(c00, c01, c10, c11);
+  StoreLevel(1u, coords, value);
+  s_mip[lid.y * 16u + lid.x] = value;
+)";
+
+  for (u32 level = 2; level < levels; level++)
+  {
+    const u32 size = GPU_HW::ADAPTIVE_DOWNSAMPLE_COMPUTE_TILE_SIZE >> level;
+    ss << "\n  // level " << level << "\n";
+    ss << "  memoryBarrierShared();\n  barrier();\n";
+    ss << "  if (all(lessThan(lid, uint2(" << size << "u))))\n  {\n";
+    ss << "    uint base = (lid.y * 2u) * 16u + (lid.x * 2u);\n";
+    ss << "    value = get_bias(s_mip[base], s_mip[base + 16u], s_mip[base + 1u], s_mip[base + 17u]);\n";
+    ss << "  }\n";
+    ss << "  memoryBarrierShared();\n  barrier();\n";
+    ss << "  if (all(lessThan(lid, uint2(" << size << "u))))\n  {\n";
+    ss << "    s_mip[lid.y * 16u + lid.x] = value;\n";
+    ss << "    StoreLevel(" << level << "u, (u_base >> " << level << ") + gl_WorkGroupID.xy * " << size
+       << "u + lid, value);\n";
+    ss << "  }\n";
+  }
+
+  ss << "}\n";
+  return ss.str();
+}
+
 std::string GPU_HW_ShaderGen::GenerateAdaptiveDownsampleBlurFragmentShader()
 {
   std::stringstream ss;
@@ -7,12 +7,22 @@ class GPU_HW_ShaderGen : public ShaderGen
 public:
   GPU_HW_ShaderGen(RenderAPI render_api, u32 resolution_scale, u32 multisamples, bool per_sample_shading,
                    bool true_color, bool scaled_dithering, GPUTextureFilter texture_filtering, bool uv_limits,
-                   bool pgxp_depth, bool disable_color_perspective, bool supports_dual_source_blend);
+                   bool pgxp_depth, bool disable_color_perspective, bool supports_dual_source_blend,
+                   bool supports_framebuffer_fetch);
   ~GPU_HW_ShaderGen();
 
+  /// Packs every parameter the generated source depends on, for shader caches which key by these and the permutation
+  /// instead of the source. Doesn't include the GLSL version, which is only fixed for Vulkan.
+  u64 GetCacheKeyParameters() const;
+
   std::string GenerateBatchVertexShader(bool textured);
   std::string GenerateBatchFragmentShader(GPU_HW::BatchRenderMode transparency, GPUTextureMode texture_mode,
                                           bool dithering, bool interlacing);
+
+  /// Generates a fragment shader which reads the texture mode, dithering and interlacing from the uniform buffer,
+  /// for use with any batch drawn with the blend state for the render mode.
+  std::string GenerateBatchUberFragmentShader(GPU_HW::BatchRenderMode transparency);
+
   std::string GenerateDisplayFragmentShader(bool depth_24bit, GPU_HW::InterlacedRenderMode interlace_mode,
                                             bool smooth_chroma);
   std::string GenerateVRAMReadFragmentShader();
@@ -22,6 +32,7 @@ public:
   std::string GenerateVRAMUpdateDepthFragmentShader();
 
   std::string GenerateAdaptiveDownsampleMipFragmentShader(bool first_pass);
+  std::string GenerateAdaptiveDownsampleMipComputeShader(u32 levels);
   std::string GenerateAdaptiveDownsampleBlurFragmentShader();
   std::string GenerateAdaptiveDownsampleCompositeFragmentShader();
   std::string GenerateBoxSampleDownsampleFragmentShader();
@@ -33,6 +44,9 @@ private:
   void WriteCommonFunctions(std::stringstream& ss);
   void WriteBatchUniformBuffer(std::stringstream& ss);
   void WriteBatchTextureFilter(std::stringstream& ss, GPUTextureFilter texture_filter);
+  void WriteAdaptiveDownsampleBiasFunctions(std::stringstream& ss);
+  std::string GenerateBatchFragmentShader(GPU_HW::BatchRenderMode transparency, GPUTextureMode texture_mode,
+                                          bool dithering, bool interlacing, bool uber);
 
   u32 m_resolution_scale;
   u32 m_multisamples;
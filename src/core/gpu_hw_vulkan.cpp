@@ -2,6 +2,8 @@
 #include "common/assert.h"
 #include "common/log.h"
 #include "common/scoped_guard.h"
+#include "common/string_util.h"
+#include "common/threading.h"
 #include "common/timer.h"
 #include "common/vulkan/builders.h"
 #include "common/vulkan/context.h"
@@ -9,10 +11,18 @@
 #include "common/vulkan/util.h"
 #include "gpu_hw_shadergen.h"
 #include "host_display.h"
+#include "host_time_accounting.h"
 #include "system.h"
 #include "util/state_wrapper.h"
+#include <algorithm>
+#include <thread>
 Log_SetChannel(GPU_HW_Vulkan);
 
+static void SetGPUTimingSection(GPUTimingSection section)
+{
+  g_vulkan_context->SetGPUTimingSection(static_cast<u32>(section));
+}
+
 GPU_HW_Vulkan::GPU_HW_Vulkan() = default;
 
 GPU_HW_Vulkan::~GPU_HW_Vulkan()
@@ -75,6 +85,12 @@ bool GPU_HW_Vulkan::Initialize()
     return false;
   }
 
+  if (!CreateVRAMReadbackBuffer())
+  {
+    Log_ErrorPrintf("Failed to create VRAM readback buffer");
+    return false;
+  }
+
   if (!CreateFramebuffer())
   {
     Log_ErrorPrintf("Failed to create framebuffer");
@@ -104,6 +120,8 @@ void GPU_HW_Vulkan::Reset(bool clear_vram)
 
 bool GPU_HW_Vulkan::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display)
 {
+  FlushPendingVRAMWrites();
+
   if (host_texture)
   {
     EndRenderPass();
@@ -174,6 +192,8 @@ bool GPU_HW_Vulkan::DoState(StateWrapper& sw, GPUTexture** host_texture, bool up
 
 void GPU_HW_Vulkan::ResetGraphicsAPIState()
 {
+  FlushPendingVRAMWrites();
+
   GPU_HW::ResetGraphicsAPIState();
 
   EndRenderPass();
@@ -204,6 +224,8 @@ void GPU_HW_Vulkan::RestoreGraphicsAPIState()
 
 void GPU_HW_Vulkan::UpdateSettings()
 {
+  FlushPendingVRAMWrites();
+
   GPU_HW::UpdateSettings();
 
   bool framebuffer_changed, shaders_changed;
@@ -221,7 +243,11 @@ void GPU_HW_Vulkan::UpdateSettings()
   g_vulkan_context->ExecuteCommandBuffer(true);
 
   if (framebuffer_changed)
+  {
+    // the compile threads use the render pass
+    StopBatchPipelineCompileThreads();
     CreateFramebuffer();
+  }
 
   if (shaders_changed)
   {
@@ -350,15 +376,20 @@ void GPU_HW_Vulkan::SetCapabilities()
 void GPU_HW_Vulkan::DestroyResources()
 {
   // Everything should be finished executing before recreating resources.
+  m_pending_vram_writes.clear();
   if (g_vulkan_context)
     g_vulkan_context->ExecuteCommandBuffer(true);
 
+  StopBatchPipelineCompileThreads();
   DestroyFramebuffer();
   DestroyPipelines();
 
   Vulkan::Util::SafeDestroyPipelineLayout(m_downsample_pipeline_layout);
   Vulkan::Util::SafeDestroyDescriptorSetLayout(m_downsample_composite_descriptor_set_layout);
   Vulkan::Util::SafeDestroyPipelineLayout(m_downsample_composite_pipeline_layout);
+  Vulkan::Util::SafeDestroyDescriptorSetLayout(m_downsample_compute_descriptor_set_layout);
+  Vulkan::Util::SafeDestroyPipelineLayout(m_downsample_compute_pipeline_layout);
+  m_downsample_compute_max_levels = 0;
 
   Vulkan::Util::SafeFreeGlobalDescriptorSet(m_vram_write_descriptor_set);
   Vulkan::Util::SafeDestroyBufferView(m_texture_stream_buffer_view);
@@ -366,6 +397,7 @@ void GPU_HW_Vulkan::DestroyResources()
   m_vertex_stream_buffer.Destroy(false);
   m_uniform_stream_buffer.Destroy(false);
   m_texture_stream_buffer.Destroy(false);
+  DestroyVRAMReadbackBuffer();
 
   Vulkan::Util::SafeDestroyPipelineLayout(m_vram_write_pipeline_layout);
   Vulkan::Util::SafeDestroyPipelineLayout(m_single_sampler_pipeline_layout);
@@ -417,6 +449,8 @@ void GPU_HW_Vulkan::EndRenderPass()
 
 void GPU_HW_Vulkan::ExecuteCommandBuffer(bool wait_for_completion, bool restore_state)
 {
+  FlushPendingVRAMWrites();
+
   EndRenderPass();
   g_vulkan_context->ExecuteCommandBuffer(wait_for_completion);
   m_batch_ubo_dirty = true;
@@ -513,6 +547,32 @@ bool GPU_HW_Vulkan::CreatePipelineLayouts()
   Vulkan::Util::SetObjectName(g_vulkan_context->GetDevice(), m_downsample_composite_pipeline_layout,
                               "Downsample Composite Pipeline Layout");
 
+  // One storage image per mip level, so the number of levels the compute path can build is capped by the device.
+  const u32 max_compute_levels =
+    std::min<u32>(g_vulkan_context->GetDeviceLimits().maxPerStageDescriptorStorageImages,
+                  ADAPTIVE_DOWNSAMPLE_COMPUTE_TILE_SHIFT + 1);
+  if (max_compute_levels >= 2)
+  {
+    dslbuilder.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+    for (u32 i = 0; i < max_compute_levels; i++)
+      dslbuilder.AddBinding(2 + i, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT);
+    m_downsample_compute_descriptor_set_layout = dslbuilder.Create(device);
+    if (m_downsample_compute_descriptor_set_layout == VK_NULL_HANDLE)
+      return false;
+    Vulkan::Util::SetObjectName(g_vulkan_context->GetDevice(), m_downsample_compute_descriptor_set_layout,
+                                "Downsample Compute Descriptor Set Layout");
+
+    plbuilder.AddDescriptorSet(m_downsample_compute_descriptor_set_layout);
+    plbuilder.AddPushConstants(VK_SHADER_STAGE_COMPUTE_BIT, 0, MAX_PUSH_CONSTANTS_SIZE);
+    m_downsample_compute_pipeline_layout = plbuilder.Create(device);
+    if (m_downsample_compute_pipeline_layout == VK_NULL_HANDLE)
+      return false;
+    Vulkan::Util::SetObjectName(g_vulkan_context->GetDevice(), m_downsample_compute_pipeline_layout,
+                                "Downsample Compute Pipeline Layout");
+
+    m_downsample_compute_max_levels = max_compute_levels;
+  }
+
   return true;
 }
 
@@ -554,7 +614,7 @@ bool GPU_HW_Vulkan::CreateFramebuffer()
   const u32 texture_width = VRAM_WIDTH * m_resolution_scale;
   const u32 texture_height = VRAM_HEIGHT * m_resolution_scale;
   const VkFormat texture_format = VK_FORMAT_R8G8B8A8_UNORM;
-  const VkFormat depth_format = VK_FORMAT_D16_UNORM;
+  const VkFormat depth_format = VK_FORMAT_D32_SFLOAT;
   const VkSampleCountFlagBits samples = static_cast<VkSampleCountFlagBits>(m_multisamples);
 
   if (!m_vram_texture.Create(texture_width, texture_height, 1, 1, texture_format, samples, VK_IMAGE_VIEW_TYPE_2D,
@@ -692,10 +752,17 @@ bool GPU_HW_Vulkan::CreateFramebuffer()
   {
     const u32 levels = GetAdaptiveDownsamplingMipLevels();
 
+    VkFormatProperties format_properties;
+    vkGetPhysicalDeviceFormatProperties(g_vulkan_context->GetPhysicalDevice(), texture_format, &format_properties);
+    m_use_compute_downsample = (levels >= 2 && levels <= m_downsample_compute_max_levels &&
+                                (format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) != 0);
+    Log_DevPrintf("Adaptive downsample mip chain: %s", m_use_compute_downsample ? "compute" : "render passes");
+
     if (!m_downsample_texture.Create(texture_width, texture_height, levels, 1, texture_format, VK_SAMPLE_COUNT_1_BIT,
                                      VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
                                      VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT |
-                                       VK_IMAGE_USAGE_TRANSFER_DST_BIT) ||
+                                       VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                                       (m_use_compute_downsample ? VK_IMAGE_USAGE_STORAGE_BIT : 0)) ||
         !m_downsample_weight_texture.Create(VRAM_WIDTH, VRAM_HEIGHT, 1, 1, VK_FORMAT_R8_UNORM, VK_SAMPLE_COUNT_1_BIT,
                                             VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
                                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT))
@@ -765,8 +832,35 @@ bool GPU_HW_Vulkan::CreateFramebuffer()
     dsubuilder.AddCombinedImageSamplerDescriptorWrite(m_downsample_composite_descriptor_set, 2,
                                                       m_downsample_weight_texture.GetView(), m_linear_sampler,
                                                       VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
     dsubuilder.Update(g_vulkan_context->GetDevice());
+
+    if (m_use_compute_downsample)
+    {
+      m_downsample_compute_vram_descriptor_set =
+        g_vulkan_context->AllocateGlobalDescriptorSet(m_downsample_compute_descriptor_set_layout);
+      m_downsample_compute_display_descriptor_set =
+        g_vulkan_context->AllocateGlobalDescriptorSet(m_downsample_compute_descriptor_set_layout);
+      if (m_downsample_compute_vram_descriptor_set == VK_NULL_HANDLE ||
+          m_downsample_compute_display_descriptor_set == VK_NULL_HANDLE)
+      {
+        return false;
+      }
+
+      dsubuilder.AddCombinedImageSamplerDescriptorWrite(m_downsample_compute_vram_descriptor_set, 1,
+                                                        m_vram_texture.GetView(), m_point_sampler,
+                                                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+      dsubuilder.AddCombinedImageSamplerDescriptorWrite(m_downsample_compute_display_descriptor_set, 1,
+                                                        m_display_texture.GetView(), m_point_sampler,
+                                                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+      for (u32 i = 0; i < levels; i++)
+      {
+        dsubuilder.AddStorageImageDescriptorWrite(m_downsample_compute_vram_descriptor_set, 2 + i,
+                                                  m_downsample_mip_views[i].image_view);
+        dsubuilder.AddStorageImageDescriptorWrite(m_downsample_compute_display_descriptor_set, 2 + i,
+                                                  m_downsample_mip_views[i].image_view);
+      }
+      dsubuilder.Update(g_vulkan_context->GetDevice());
+    }
   }
   else if (m_downsample_mode == GPUDownsampleMode::Box)
   {
@@ -794,6 +888,9 @@ bool GPU_HW_Vulkan::CreateFramebuffer()
 
 void GPU_HW_Vulkan::ClearFramebuffer()
 {
+  FlushPendingVRAMWrites();
+  SetGPUTimingSection(GPUTimingSection::VRAMFill);
+
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
 
   m_vram_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
@@ -817,6 +914,9 @@ void GPU_HW_Vulkan::ClearFramebuffer()
 void GPU_HW_Vulkan::DestroyFramebuffer()
 {
   Vulkan::Util::SafeFreeGlobalDescriptorSet(m_downsample_composite_descriptor_set);
+  Vulkan::Util::SafeFreeGlobalDescriptorSet(m_downsample_compute_vram_descriptor_set);
+  Vulkan::Util::SafeFreeGlobalDescriptorSet(m_downsample_compute_display_descriptor_set);
+  m_use_compute_downsample = false;
 
   for (SmoothMipView& mv : m_downsample_mip_views)
   {
@@ -918,39 +1018,118 @@ bool GPU_HW_Vulkan::CreateTextureBuffer()
   return true;
 }
 
+bool GPU_HW_Vulkan::CreateVRAMReadbackBuffer()
+{
+  const VkBufferCreateInfo bci = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                                  nullptr,
+                                  0u,
+                                  VRAM_WIDTH * VRAM_HEIGHT * sizeof(u32),
+                                  VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                  VK_SHARING_MODE_EXCLUSIVE,
+                                  0u,
+                                  nullptr};
+
+  VmaAllocationCreateInfo aci = {};
+  aci.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+  aci.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+  aci.preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+  VmaAllocationInfo ai = {};
+  VkResult res = vmaCreateBuffer(g_vulkan_context->GetAllocator(), &bci, &aci, &m_vram_readback_buffer,
+                                 &m_vram_readback_allocation, &ai);
+  if (res != VK_SUCCESS)
+  {
+    LOG_VULKAN_ERROR(res, "vmaCreateBuffer() failed: ");
+    return false;
+  }
+
+  m_vram_readback_buffer_map = static_cast<const u8*>(ai.pMappedData);
+  Vulkan::Util::SetObjectName(g_vulkan_context->GetDevice(), m_vram_readback_buffer, "VRAM Readback Buffer");
+  return true;
+}
+
+void GPU_HW_Vulkan::DestroyVRAMReadbackBuffer()
+{
+  m_vram_readback_pending = false;
+  if (m_vram_readback_buffer == VK_NULL_HANDLE)
+    return;
+
+  vmaDestroyBuffer(g_vulkan_context->GetAllocator(), m_vram_readback_buffer, m_vram_readback_allocation);
+  m_vram_readback_buffer = VK_NULL_HANDLE;
+  m_vram_readback_allocation = VK_NULL_HANDLE;
+  m_vram_readback_buffer_map = nullptr;
+}
+
+namespace {
+// The batch shaders make up most of the permutations, so they're cached by their parameters, and their source is
+// only generated when they're missing from the cache.
+struct BatchShaderCacheKey
+{
+  enum : u32
+  {
+    VERTEX,
+    FRAGMENT,
+    UBER_FRAGMENT
+  };
+
+  u64 parameters;
+  u32 shader;
+  u32 permutation;
+};
+static_assert(sizeof(BatchShaderCacheKey) == 16);
+} // namespace
+
 bool GPU_HW_Vulkan::CompilePipelines()
 {
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::ShaderCompile);
   VkDevice device = g_vulkan_context->GetDevice();
   VkPipelineCache pipeline_cache = g_vulkan_shader_cache->GetPipelineCache();
 
   GPU_HW_ShaderGen shadergen(g_host_display->GetRenderAPI(), m_resolution_scale, m_multisamples, m_per_sample_shading,
                              m_true_color, m_scaled_dithering, m_texture_filtering, m_using_uv_limits,
-                             m_pgxp_depth_buffer, m_disable_color_perspective, m_supports_dual_source_blend);
-
-  ShaderCompileProgressTracker progress("Compiling Pipelines", 2 + (4 * 9 * 2 * 2) + (3 * 4 * 5 * 9 * 2 * 2) + 1 + 2 +
-                                                                 (2 * 2) + 2 + 1 + 1 + (2 * 3) + 1);
-
-  // vertex shaders - [textured]
-  // fragment shaders - [render_mode][texture_mode][dithering][interlacing]
-  DimensionalArray<VkShaderModule, 2> batch_vertex_shaders{};
-  DimensionalArray<VkShaderModule, 2, 2, 9, 4> batch_fragment_shaders{};
-  ScopedGuard batch_shader_guard([&batch_vertex_shaders, &batch_fragment_shaders]() {
-    batch_vertex_shaders.enumerate(Vulkan::Util::SafeDestroyShaderModule);
-    batch_fragment_shaders.enumerate(Vulkan::Util::SafeDestroyShaderModule);
-  });
+                             m_pgxp_depth_buffer, m_disable_color_perspective, m_supports_dual_source_blend,
+                             m_supports_framebuffer_fetch);
+
+  u32 num_batch_transparency_modes = 0;
+  for (u8 render_mode = 0; render_mode < 4; render_mode++)
+  {
+    for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
+    {
+      if (GetBatchPipelineTransparencyMode(render_mode, transparency_mode) == transparency_mode)
+        num_batch_transparency_modes++;
+    }
+  }
+
+  // Batch pipelines are built in the background in async mode, so they don't count towards the loading screen.
+  // The uber pipelines are drawn with until they're ready, and are used for everything if uber shaders are enabled.
+  m_use_uber_shaders = g_settings.gpu_use_uber_shaders;
+  const bool async_batch_pipelines = !m_use_uber_shaders && g_settings.gpu_async_pipeline_compilation;
+  const bool uber_batch_pipelines = m_use_uber_shaders || async_batch_pipelines;
+  const u32 num_batch_shaders = m_use_uber_shaders ? 0 : (4 * 9 * 2 * 2);
+  const u32 num_batch_pipelines = uber_batch_pipelines ? 0 : (num_batch_transparency_modes * 3 * 9 * 2 * 2);
+  const u32 num_uber_pipelines = uber_batch_pipelines ? (4 + num_batch_transparency_modes * 3) : 0;
+  ShaderCompileProgressTracker progress("Compiling Pipelines", 2 + num_batch_shaders + num_batch_pipelines +
+                                                                 num_uber_pipelines + 1 + 2 + (2 * 2) + 2 + 1 + 1 +
+                                                                 (2 * 3) + 1);
+
+  m_batch_ubo_uber_state = uber_batch_pipelines;
+  m_batch_ubo_dirty = true;
 
   for (u8 textured = 0; textured < 2; textured++)
   {
-    const std::string vs = shadergen.GenerateBatchVertexShader(ConvertToBoolUnchecked(textured));
-    VkShaderModule shader = g_vulkan_shader_cache->GetVertexShader(vs);
+    const BatchShaderCacheKey key{shadergen.GetCacheKeyParameters(), BatchShaderCacheKey::VERTEX, textured};
+    VkShaderModule shader =
+      g_vulkan_shader_cache->GetShaderModule(Vulkan::ShaderCompiler::Type::Vertex, &key, sizeof(key), [&]() {
+        return shadergen.GenerateBatchVertexShader(ConvertToBoolUnchecked(textured));
+      });
     if (shader == VK_NULL_HANDLE)
       return false;
 
-    batch_vertex_shaders[textured] = shader;
+    m_batch_vertex_shaders[textured] = shader;
     progress.Increment();
   }
 
-  for (u8 render_mode = 0; render_mode < 4; render_mode++)
+  for (u8 render_mode = 0; render_mode < 4 && !m_use_uber_shaders; render_mode++)
   {
     for (u8 texture_mode = 0; texture_mode < 9; texture_mode++)
     {
@@ -958,116 +1137,100 @@ bool GPU_HW_Vulkan::CompilePipelines()
       {
         for (u8 interlacing = 0; interlacing < 2; interlacing++)
         {
-          const std::string fs = shadergen.GenerateBatchFragmentShader(
-            static_cast<BatchRenderMode>(render_mode), static_cast<GPUTextureMode>(texture_mode),
-            ConvertToBoolUnchecked(dithering), ConvertToBoolUnchecked(interlacing));
-
-          VkShaderModule shader = g_vulkan_shader_cache->GetFragmentShader(fs);
+          const BatchShaderCacheKey key{
+            shadergen.GetCacheKeyParameters(), BatchShaderCacheKey::FRAGMENT,
+            static_cast<u32>(render_mode) | (texture_mode << 8) | (dithering << 16) | (interlacing << 17)};
+          VkShaderModule shader =
+            g_vulkan_shader_cache->GetShaderModule(Vulkan::ShaderCompiler::Type::Fragment, &key, sizeof(key), [&]() {
+              return shadergen.GenerateBatchFragmentShader(
+                static_cast<BatchRenderMode>(render_mode), static_cast<GPUTextureMode>(texture_mode),
+                ConvertToBoolUnchecked(dithering), ConvertToBoolUnchecked(interlacing));
+            });
           if (shader == VK_NULL_HANDLE)
             return false;
 
-          batch_fragment_shaders[render_mode][texture_mode][dithering][interlacing] = shader;
+          m_batch_fragment_shaders[render_mode][texture_mode][dithering][interlacing] = shader;
           progress.Increment();
         }
       }
     }
   }
 
-  Vulkan::GraphicsPipelineBuilder gpbuilder;
-
-  // [depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
-  for (u8 depth_test = 0; depth_test < 3; depth_test++)
+  if (num_batch_pipelines > 0)
   {
-    for (u8 render_mode = 0; render_mode < 4; render_mode++)
+    // [depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
+    for (u8 depth_test = 0; depth_test < 3; depth_test++)
     {
-      for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
+      for (u8 render_mode = 0; render_mode < 4; render_mode++)
       {
-        for (u8 texture_mode = 0; texture_mode < 9; texture_mode++)
+        for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
         {
-          for (u8 dithering = 0; dithering < 2; dithering++)
+          if (GetBatchPipelineTransparencyMode(render_mode, transparency_mode) != transparency_mode)
+            continue;
+
+          for (u8 texture_mode = 0; texture_mode < 9; texture_mode++)
           {
-            for (u8 interlacing = 0; interlacing < 2; interlacing++)
+            for (u8 dithering = 0; dithering < 2; dithering++)
             {
-              static constexpr std::array<VkCompareOp, 3> depth_test_values = {
-                VK_COMPARE_OP_ALWAYS, VK_COMPARE_OP_GREATER_OR_EQUAL, VK_COMPARE_OP_LESS_OR_EQUAL};
-              const bool textured = (static_cast<GPUTextureMode>(texture_mode) != GPUTextureMode::Disabled);
-
-              gpbuilder.SetPipelineLayout(m_batch_pipeline_layout);
-              gpbuilder.SetRenderPass(m_vram_render_pass, 0);
-
-              gpbuilder.AddVertexBuffer(0, sizeof(BatchVertex), VK_VERTEX_INPUT_RATE_VERTEX);
-              gpbuilder.AddVertexAttribute(0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(BatchVertex, x));
-              gpbuilder.AddVertexAttribute(1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(BatchVertex, color));
-              if (textured)
+              for (u8 interlacing = 0; interlacing < 2; interlacing++)
               {
-                gpbuilder.AddVertexAttribute(2, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, u));
-                gpbuilder.AddVertexAttribute(3, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, texpage));
-                if (m_using_uv_limits)
-                  gpbuilder.AddVertexAttribute(4, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(BatchVertex, uv_limits));
-              }
+                VkPipeline pipeline = GetBatchPipeline(depth_test, render_mode, texture_mode, transparency_mode,
+                                                       dithering, interlacing);
+                if (pipeline == VK_NULL_HANDLE)
+                  return false;
 
-              gpbuilder.SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
-              gpbuilder.SetVertexShader(batch_vertex_shaders[BoolToUInt8(textured)]);
-              gpbuilder.SetFragmentShader(batch_fragment_shaders[render_mode][texture_mode][dithering][interlacing]);
+                progress.Increment();
+              }
+            }
+          }
+        }
+      }
+    }
 
-              gpbuilder.SetRasterizationState(VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, VK_FRONT_FACE_CLOCKWISE);
-              gpbuilder.SetDepthState(true, true, depth_test_values[depth_test]);
-              gpbuilder.SetNoBlendingState();
-              gpbuilder.SetMultisamples(m_multisamples, m_per_sample_shading);
+    DestroyBatchShaders();
+  }
 
-              if ((static_cast<GPUTransparencyMode>(transparency_mode) != GPUTransparencyMode::Disabled &&
-                   (static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
-                    static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque)) ||
-                  m_texture_filtering != GPUTextureFilter::Nearest)
-              {
-                if (m_supports_dual_source_blend)
-                {
-                  gpbuilder.SetBlendAttachment(
-                    0, true, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_SRC1_ALPHA,
-                    (static_cast<GPUTransparencyMode>(transparency_mode) ==
-                       GPUTransparencyMode::BackgroundMinusForeground &&
-                     static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
-                     static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque) ?
-                      VK_BLEND_OP_REVERSE_SUBTRACT :
-                      VK_BLEND_OP_ADD,
-                    VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
-                }
-                else
-                {
-                  const float factor = (static_cast<GPUTransparencyMode>(transparency_mode) ==
-                                        GPUTransparencyMode::HalfBackgroundPlusHalfForeground) ?
-                                         0.5f :
-                                         1.0f;
-                  gpbuilder.SetBlendAttachment(
-                    0, true, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_CONSTANT_ALPHA,
-                    (static_cast<GPUTransparencyMode>(transparency_mode) ==
-                       GPUTransparencyMode::BackgroundMinusForeground &&
-                     static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
-                     static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque) ?
-                      VK_BLEND_OP_REVERSE_SUBTRACT :
-                      VK_BLEND_OP_ADD,
-                    VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
-                  gpbuilder.SetBlendConstants(0.0f, 0.0f, 0.0f, factor);
-                }
-              }
+  if (uber_batch_pipelines)
+  {
+    for (u8 render_mode = 0; render_mode < 4; render_mode++)
+    {
+      const BatchShaderCacheKey key{shadergen.GetCacheKeyParameters(), BatchShaderCacheKey::UBER_FRAGMENT,
+                                    render_mode};
+      VkShaderModule shader =
+        g_vulkan_shader_cache->GetShaderModule(Vulkan::ShaderCompiler::Type::Fragment, &key, sizeof(key), [&]() {
+          return shadergen.GenerateBatchUberFragmentShader(static_cast<BatchRenderMode>(render_mode));
+        });
+      if (shader == VK_NULL_HANDLE)
+        return false;
 
-              gpbuilder.SetDynamicViewportAndScissorState();
+      progress.Increment();
 
-              VkPipeline pipeline = gpbuilder.Create(device, pipeline_cache);
-              if (pipeline == VK_NULL_HANDLE)
-                return false;
+      for (u8 depth_test = 0; depth_test < 3; depth_test++)
+      {
+        for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
+        {
+          if (GetBatchPipelineTransparencyMode(render_mode, transparency_mode) != transparency_mode)
+            continue;
 
-              m_batch_pipelines[depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing] =
-                pipeline;
-              progress.Increment();
-            }
+          VkPipeline pipeline = CreateBatchPipeline(depth_test, render_mode, transparency_mode, true, shader);
+          if (pipeline == VK_NULL_HANDLE)
+          {
+            Log_ErrorPrintf("Failed to create batch uber pipeline %u/%u/%u", depth_test, render_mode,
+                            transparency_mode);
+            vkDestroyShaderModule(device, shader, nullptr);
+            return false;
           }
+
+          m_batch_uber_pipelines[depth_test][render_mode][transparency_mode] = pipeline;
+          progress.Increment();
         }
       }
+
+      vkDestroyShaderModule(device, shader, nullptr);
     }
   }
 
-  batch_shader_guard.Invoke();
+  Vulkan::GraphicsPipelineBuilder gpbuilder;
 
   VkShaderModule fullscreen_quad_vertex_shader =
     g_vulkan_shader_cache->GetVertexShader(shadergen.GenerateScreenQuadVertexShader());
@@ -1316,6 +1479,25 @@ bool GPU_HW_Vulkan::CompilePipelines()
 
     Vulkan::Util::SetObjectName(g_vulkan_context->GetDevice(), m_downsample_composite_pass_pipeline,
                                 "Downsample Composite Pass Pipeline");
+
+    if (m_use_compute_downsample)
+    {
+      VkShaderModule cs = g_vulkan_shader_cache->GetComputeShader(
+        shadergen.GenerateAdaptiveDownsampleMipComputeShader(m_downsample_texture.GetLevels()));
+      if (cs == VK_NULL_HANDLE)
+        return false;
+
+      Vulkan::ComputePipelineBuilder cpbuilder;
+      cpbuilder.SetShader(cs);
+      cpbuilder.SetPipelineLayout(m_downsample_compute_pipeline_layout);
+      m_downsample_compute_pipeline = cpbuilder.Create(device, pipeline_cache);
+      vkDestroyShaderModule(g_vulkan_context->GetDevice(), cs, nullptr);
+      if (m_downsample_compute_pipeline == VK_NULL_HANDLE)
+        return false;
+
+      Vulkan::Util::SetObjectName(g_vulkan_context->GetDevice(), m_downsample_compute_pipeline,
+                                  "Downsample Compute Mip Pipeline");
+    }
   }
   else if (m_downsample_mode == GPUDownsampleMode::Box)
   {
@@ -1346,12 +1528,229 @@ bool GPU_HW_Vulkan::CompilePipelines()
 
 #undef UPDATE_PROGRESS
 
+  if (async_batch_pipelines)
+    StartBatchPipelineCompileThreads();
+
   return true;
 }
 
+VkPipeline GPU_HW_Vulkan::CreateBatchPipeline(u8 depth_test, u8 render_mode, u8 transparency_mode, bool textured,
+                                              VkShaderModule fragment_shader) const
+{
+  Vulkan::GraphicsPipelineBuilder gpbuilder;
+  static constexpr std::array<VkCompareOp, 3> depth_test_values = {VK_COMPARE_OP_ALWAYS, VK_COMPARE_OP_GREATER_OR_EQUAL,
+                                                                   VK_COMPARE_OP_LESS_OR_EQUAL};
+
+  gpbuilder.SetPipelineLayout(m_batch_pipeline_layout);
+  gpbuilder.SetRenderPass(m_vram_render_pass, 0);
+
+  gpbuilder.AddVertexBuffer(0, sizeof(BatchVertex), VK_VERTEX_INPUT_RATE_VERTEX);
+  gpbuilder.AddVertexAttribute(0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(BatchVertex, x));
+  gpbuilder.AddVertexAttribute(1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(BatchVertex, color));
+  if (textured)
+  {
+    gpbuilder.AddVertexAttribute(2, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, u));
+    gpbuilder.AddVertexAttribute(3, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, texpage));
+    gpbuilder.AddVertexAttribute(4, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, texwindow));
+    if (m_using_uv_limits)
+      gpbuilder.AddVertexAttribute(5, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(BatchVertex, uv_limits));
+  }
+
+  gpbuilder.SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+  gpbuilder.SetVertexShader(m_batch_vertex_shaders[BoolToUInt8(textured)]);
+  gpbuilder.SetFragmentShader(fragment_shader);
+
+  gpbuilder.SetRasterizationState(VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, VK_FRONT_FACE_CLOCKWISE);
+  gpbuilder.SetDepthState(true, true, depth_test_values[depth_test]);
+  gpbuilder.SetNoBlendingState();
+  gpbuilder.SetMultisamples(m_multisamples, m_per_sample_shading);
+
+  const bool transparent = (static_cast<GPUTransparencyMode>(transparency_mode) != GPUTransparencyMode::Disabled &&
+                            static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
+                            static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque);
+  if (transparent || m_texture_filtering != GPUTextureFilter::Nearest)
+  {
+    const VkBlendOp blend_op =
+      (transparent &&
+       static_cast<GPUTransparencyMode>(transparency_mode) == GPUTransparencyMode::BackgroundMinusForeground) ?
+        VK_BLEND_OP_REVERSE_SUBTRACT :
+        VK_BLEND_OP_ADD;
+    if (m_supports_dual_source_blend)
+    {
+      gpbuilder.SetBlendAttachment(0, true, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_SRC1_ALPHA, blend_op,
+                                   VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+    }
+    else
+    {
+      const float factor =
+        (static_cast<GPUTransparencyMode>(transparency_mode) == GPUTransparencyMode::HalfBackgroundPlusHalfForeground) ?
+          0.5f :
+          1.0f;
+      gpbuilder.SetBlendAttachment(0, true, VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_CONSTANT_ALPHA, blend_op,
+                                   VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
+      gpbuilder.SetBlendConstants(0.0f, 0.0f, 0.0f, factor);
+    }
+  }
+
+  gpbuilder.SetDynamicViewportAndScissorState();
+
+  return gpbuilder.Create(g_vulkan_context->GetDevice(), g_vulkan_shader_cache->GetPipelineCache());
+}
+
+u8 GPU_HW_Vulkan::GetBatchPipelineTransparencyMode(u8 render_mode, u8 transparency_mode) const
+{
+  if (static_cast<GPUTransparencyMode>(transparency_mode) != GPUTransparencyMode::Disabled &&
+      static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
+      static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque)
+  {
+    return transparency_mode;
+  }
+
+  // Without blending, the transparency mode only affects the blend constant used for filtering without dual-source
+  // blending, so all the other modes can share the disabled pipeline.
+  if (m_texture_filtering != GPUTextureFilter::Nearest && !m_supports_dual_source_blend &&
+      static_cast<GPUTransparencyMode>(transparency_mode) == GPUTransparencyMode::HalfBackgroundPlusHalfForeground)
+  {
+    return transparency_mode;
+  }
+
+  return static_cast<u8>(GPUTransparencyMode::Disabled);
+}
+
+VkPipeline GPU_HW_Vulkan::GetBatchPipeline(u8 depth_test, u8 render_mode, u8 texture_mode, u8 transparency_mode,
+                                           u8 dithering, u8 interlacing)
+{
+  transparency_mode = GetBatchPipelineTransparencyMode(render_mode, transparency_mode);
+  std::atomic<VkPipeline>& slot =
+    m_batch_pipelines[depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing];
+  VkPipeline pipeline = slot.load(std::memory_order_acquire);
+  if (pipeline != VK_NULL_HANDLE)
+    return pipeline;
+
+  // not compiled yet, so stall for this one rather than drawing with the wrong state
+  pipeline = CreateBatchPipeline(depth_test, render_mode, transparency_mode,
+                                 static_cast<GPUTextureMode>(texture_mode) != GPUTextureMode::Disabled,
+                                 m_batch_fragment_shaders[render_mode][texture_mode][dithering][interlacing]);
+  if (pipeline == VK_NULL_HANDLE)
+  {
+    Log_ErrorPrintf("Failed to create batch pipeline %u/%u/%u/%u/%u/%u", depth_test, render_mode, texture_mode,
+                    transparency_mode, dithering, interlacing);
+    return VK_NULL_HANDLE;
+  }
+
+  // a compile thread might have beaten us to it
+  VkPipeline existing = VK_NULL_HANDLE;
+  if (!slot.compare_exchange_strong(existing, pipeline, std::memory_order_acq_rel))
+  {
+    vkDestroyPipeline(g_vulkan_context->GetDevice(), pipeline, nullptr);
+    return existing;
+  }
+
+  return pipeline;
+}
+
+void GPU_HW_Vulkan::StartBatchPipelineCompileThreads()
+{
+  // Queue the combinations which are most likely to be used first. Those which can't be used with the current
+  // settings are left out, they'll be created on demand if that ever changes.
+  m_batch_pipeline_compile_queue.clear();
+  for (u8 interlacing = 0; interlacing < 2; interlacing++)
+  {
+    for (u8 depth_test = 0; depth_test < 3; depth_test++)
+    {
+      if (depth_test == 2 && !m_pgxp_depth_buffer)
+        continue;
+
+      for (u8 dithering = 0; dithering < 2; dithering++)
+      {
+        if (dithering && m_true_color)
+          continue;
+
+        for (u8 render_mode = 0; render_mode < 4; render_mode++)
+        {
+          for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
+          {
+            if (GetBatchPipelineTransparencyMode(render_mode, transparency_mode) != transparency_mode)
+              continue;
+
+            for (u8 texture_mode = 0; texture_mode < 9; texture_mode++)
+            {
+              m_batch_pipeline_compile_queue.push_back(
+                ZeroExtend32(depth_test) | (ZeroExtend32(render_mode) << 2) | (ZeroExtend32(texture_mode) << 4) |
+                (ZeroExtend32(transparency_mode) << 8) | (ZeroExtend32(dithering) << 11) |
+                (ZeroExtend32(interlacing) << 12));
+            }
+          }
+        }
+      }
+    }
+  }
+
+  const u32 num_threads = std::clamp<u32>(std::thread::hardware_concurrency() / 2u, 1u, MAX_PIPELINE_COMPILE_THREADS);
+  Log_InfoPrintf("Compiling %zu batch pipelines on %u threads", m_batch_pipeline_compile_queue.size(), num_threads);
+
+  m_batch_pipeline_compile_next.store(0, std::memory_order_relaxed);
+  m_batch_pipeline_compile_remaining.store(static_cast<u32>(m_batch_pipeline_compile_queue.size()),
+                                           std::memory_order_relaxed);
+  m_batch_pipeline_compile_cancel.store(false, std::memory_order_relaxed);
+  m_batch_pipeline_compile_start_time = Common::Timer::GetCurrentValue();
+
+  m_batch_pipeline_compile_threads.reserve(num_threads);
+  for (u32 i = 0; i < num_threads; i++)
+    m_batch_pipeline_compile_threads.emplace_back([this]() { BatchPipelineCompileThread(); });
+}
+
+void GPU_HW_Vulkan::StopBatchPipelineCompileThreads()
+{
+  m_batch_pipeline_compile_cancel.store(true, std::memory_order_relaxed);
+  for (Threading::Thread& thread : m_batch_pipeline_compile_threads)
+    thread.Join();
+
+  m_batch_pipeline_compile_threads.clear();
+  m_batch_pipeline_compile_queue.clear();
+}
+
+void GPU_HW_Vulkan::BatchPipelineCompileThread()
+{
+  Threading::SetNameOfCurrentThread("Vulkan Pipeline Compiler");
+
+  for (;;)
+  {
+    const u32 index = m_batch_pipeline_compile_next.fetch_add(1, std::memory_order_relaxed);
+    if (index >= m_batch_pipeline_compile_queue.size() ||
+        m_batch_pipeline_compile_cancel.load(std::memory_order_relaxed))
+    {
+      break;
+    }
+
+    const u32 key = m_batch_pipeline_compile_queue[index];
+    GetBatchPipeline(Truncate8(key & 3u), Truncate8((key >> 2) & 3u), Truncate8((key >> 4) & 15u),
+                     Truncate8((key >> 8) & 7u), Truncate8((key >> 11) & 1u), Truncate8((key >> 12) & 1u));
+
+    if (m_batch_pipeline_compile_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      Log_InfoPrintf("Finished compiling batch pipelines in background in %.2f ms",
+                     Common::Timer::ConvertValueToMilliseconds(Common::Timer::GetCurrentValue() -
+                                                               m_batch_pipeline_compile_start_time));
+    }
+  }
+}
+
+void GPU_HW_Vulkan::DestroyBatchShaders()
+{
+  m_batch_vertex_shaders.enumerate(Vulkan::Util::SafeDestroyShaderModule);
+  m_batch_fragment_shaders.enumerate(Vulkan::Util::SafeDestroyShaderModule);
+}
+
 void GPU_HW_Vulkan::DestroyPipelines()
 {
-  m_batch_pipelines.enumerate(Vulkan::Util::SafeDestroyPipeline);
+  StopBatchPipelineCompileThreads();
+  m_batch_pipelines.enumerate([](std::atomic<VkPipeline>& p) {
+    VkPipeline pipeline = p.exchange(VK_NULL_HANDLE, std::memory_order_relaxed);
+    Vulkan::Util::SafeDestroyPipeline(pipeline);
+  });
+  m_batch_uber_pipelines.enumerate(Vulkan::Util::SafeDestroyPipeline);
+  DestroyBatchShaders();
 
   m_vram_fill_pipelines.enumerate(Vulkan::Util::SafeDestroyPipeline);
 
@@ -1368,12 +1767,16 @@ void GPU_HW_Vulkan::DestroyPipelines()
   Vulkan::Util::SafeDestroyPipeline(m_downsample_mid_pass_pipeline);
   Vulkan::Util::SafeDestroyPipeline(m_downsample_blur_pass_pipeline);
   Vulkan::Util::SafeDestroyPipeline(m_downsample_composite_pass_pipeline);
+  Vulkan::Util::SafeDestroyPipeline(m_downsample_compute_pipeline);
 
   m_display_pipelines.enumerate(Vulkan::Util::SafeDestroyPipeline);
 }
 
 void GPU_HW_Vulkan::DrawBatchVertices(BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices)
 {
+  FlushPendingVRAMWrites();
+  SetGPUTimingSection(GPUTimingSection::Batches);
+
   BeginVRAMRenderPass();
 
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
@@ -1382,9 +1785,29 @@ void GPU_HW_Vulkan::DrawBatchVertices(BatchRenderMode render_mode, u32 base_vert
 
   // [depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
   const u8 depth_test = m_batch.use_depth_buffer ? static_cast<u8>(2) : BoolToUInt8(m_batch.check_mask_before_draw);
-  VkPipeline pipeline =
-    m_batch_pipelines[depth_test][static_cast<u8>(render_mode)][static_cast<u8>(m_batch.texture_mode)][static_cast<u8>(
-      m_batch.transparency_mode)][BoolToUInt8(m_batch.dithering)][BoolToUInt8(m_batch.interlacing)];
+  const u8 transparency_mode =
+    GetBatchPipelineTransparencyMode(static_cast<u8>(render_mode), static_cast<u8>(m_batch.transparency_mode));
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  if (!m_use_uber_shaders)
+  {
+    // still compiling in the background, so draw with the uber pipeline instead of stalling if it's not ready
+    pipeline = m_batch_pipelines[depth_test][static_cast<u8>(render_mode)][static_cast<u8>(m_batch.texture_mode)]
+                                [transparency_mode][BoolToUInt8(m_batch.dithering)][BoolToUInt8(m_batch.interlacing)]
+                                  .load(std::memory_order_acquire);
+    if (pipeline == VK_NULL_HANDLE && m_batch_pipeline_compile_threads.empty())
+    {
+      HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::ShaderCompile);
+      pipeline = GetBatchPipeline(depth_test, static_cast<u8>(render_mode), static_cast<u8>(m_batch.texture_mode),
+                                  transparency_mode, BoolToUInt8(m_batch.dithering), BoolToUInt8(m_batch.interlacing));
+    }
+  }
+
+  if (pipeline == VK_NULL_HANDLE)
+  {
+    pipeline = m_batch_uber_pipelines[depth_test][static_cast<u8>(render_mode)][transparency_mode];
+    if (pipeline == VK_NULL_HANDLE)
+      return;
+  }
 
   vkCmdBindPipeline(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
   vkCmdDraw(cmdbuf, num_vertices, 1, base_vertex, 0);
@@ -1418,6 +1841,9 @@ void GPU_HW_Vulkan::ClearDisplay()
 
 void GPU_HW_Vulkan::UpdateDisplay()
 {
+  FlushPendingVRAMWrites();
+  SetGPUTimingSection(GPUTimingSection::Display);
+
   GPU_HW::UpdateDisplay();
   EndRenderPass();
 
@@ -1539,6 +1965,56 @@ void GPU_HW_Vulkan::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
     return;
   }
 
+  // A readback which is still in flight would overwrite this one when it completes.
+  if (m_vram_readback_pending)
+    FinishVRAMReadback();
+
+  QueueVRAMReadback(x, y, width, height);
+  ExecuteCommandBuffer(true, true);
+  FinishVRAMReadback();
+}
+
+void GPU_HW_Vulkan::BeginVRAMReadback(u32 x, u32 y, u32 width, u32 height)
+{
+  if (IsUsingSoftwareRendererForReadbacks())
+  {
+    ReadSoftwareRendererVRAM(x, y, width, height);
+    return;
+  }
+
+  if (m_vram_readback_pending)
+    FinishVRAMReadback();
+
+  // Submit without waiting, the CPU can keep running until it reads the first word from GPUREAD.
+  QueueVRAMReadback(x, y, width, height);
+  ExecuteCommandBuffer(false, true);
+}
+
+void GPU_HW_Vulkan::FinishVRAMReadback()
+{
+  m_vram_readback_pending = false;
+  g_vulkan_context->WaitForFenceCounter(m_vram_readback_fence_counter);
+
+  const u32 encoded_width = (m_vram_readback_rect.GetWidth() + 1) / 2;
+  const u32 encoded_height = m_vram_readback_rect.GetHeight();
+  const u32 pitch = m_vram_readback_texture.CalcUpdatePitch(encoded_width);
+
+  // invalidate cpu cache before reading
+  VkResult res = vmaInvalidateAllocation(g_vulkan_context->GetAllocator(), m_vram_readback_allocation, 0,
+                                         pitch * encoded_height);
+  if (res != VK_SUCCESS)
+    LOG_VULKAN_ERROR(res, "vmaInvalidateAllocation() failed, readback may be incorrect: ");
+
+  StringUtil::StrideMemCpy(&m_vram_shadow[m_vram_readback_rect.top * VRAM_WIDTH + m_vram_readback_rect.left],
+                           VRAM_WIDTH * sizeof(u16), m_vram_readback_buffer_map, pitch, encoded_width * sizeof(u32),
+                           encoded_height);
+}
+
+void GPU_HW_Vulkan::QueueVRAMReadback(u32 x, u32 y, u32 width, u32 height)
+{
+  FlushPendingVRAMWrites();
+  SetGPUTimingSection(GPUTimingSection::VRAMReadback);
+
   // Get bounds with wrap-around handled.
   const Common::Rectangle<u32> copy_rect = GetVRAMTransferBounds(x, y, width, height);
   const u32 encoded_width = (copy_rect.GetWidth() + 1) / 2;
@@ -1572,16 +2048,36 @@ void GPU_HW_Vulkan::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
   m_vram_readback_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
   m_vram_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 
-  // Stage the readback and copy it into our shadow buffer (will execute command buffer and stall).
-  g_host_display->DownloadTexture(&m_vram_readback_texture, 0, 0, encoded_width, encoded_height,
-                                  &m_vram_shadow[copy_rect.top * VRAM_WIDTH + copy_rect.left],
-                                  VRAM_WIDTH * sizeof(u16));
-
-  RestoreGraphicsAPIState();
+  // Stage the readback, the copy into the shadow buffer happens once the command buffer completes.
+  const u32 pitch = m_vram_readback_texture.CalcUpdatePitch(encoded_width);
+  const u32 size = pitch * encoded_height;
+  VkBufferImageCopy image_copy = {};
+  image_copy.bufferOffset = 0;
+  image_copy.bufferRowLength = m_vram_readback_texture.CalcUpdateRowLength(pitch);
+  image_copy.bufferImageHeight = 0;
+  image_copy.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u};
+  image_copy.imageOffset = {0, 0, 0};
+  image_copy.imageExtent = {encoded_width, encoded_height, 1u};
+
+  Vulkan::Util::BufferMemoryBarrier(cmdbuf, m_vram_readback_buffer, VK_ACCESS_HOST_READ_BIT,
+                                    VK_ACCESS_TRANSFER_WRITE_BIT, 0, size, VK_PIPELINE_STAGE_HOST_BIT,
+                                    VK_PIPELINE_STAGE_TRANSFER_BIT);
+  vkCmdCopyImageToBuffer(cmdbuf, m_vram_readback_texture.GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                         m_vram_readback_buffer, 1, &image_copy);
+  Vulkan::Util::BufferMemoryBarrier(cmdbuf, m_vram_readback_buffer, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                    VK_ACCESS_HOST_READ_BIT, 0, size, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                    VK_PIPELINE_STAGE_HOST_BIT);
+
+  m_vram_readback_rect = copy_rect;
+  m_vram_readback_fence_counter = g_vulkan_context->GetCurrentFenceCounter();
+  m_vram_readback_pending = true;
 }
 
 void GPU_HW_Vulkan::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
 {
+  FlushPendingVRAMWrites();
+  SetGPUTimingSection(GPUTimingSection::VRAMFill);
+
   if (IsUsingSoftwareRendererForReadbacks())
     FillSoftwareRendererVRAM(x, y, width, height, color);
 
@@ -1645,30 +2141,57 @@ void GPU_HW_Vulkan::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void*
   std::memcpy(m_texture_stream_buffer.GetCurrentHostPointer(), data, data_size);
   m_texture_stream_buffer.CommitMemory(data_size);
 
+  // The draw is deferred until something else touches VRAM, so back-to-back writes share one pass.
+  PendingVRAMWrite& pw = m_pending_vram_writes.emplace_back();
+  pw.uniforms = GetVRAMWriteUBOData(x, y, width, height, start_index, set_mask, check_mask);
+  pw.scaled_bounds = bounds * m_resolution_scale;
+  pw.pipeline_index = BoolToUInt8(check_mask && !m_pgxp_depth_buffer);
+}
+
+void GPU_HW_Vulkan::FlushPendingVRAMWrites()
+{
+  if (m_pending_vram_writes.empty())
+    return;
+
+  SetGPUTimingSection(GPUTimingSection::VRAMWrite);
+
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
-  const Vulkan::Util::DebugScope debugScope(cmdbuf, "GPU_HW_Vulkan::UpdateVRAM: {%u,%u} %ux%u", x, y, width, height);
+  const Vulkan::Util::DebugScope debugScope(cmdbuf, "GPU_HW_Vulkan::FlushPendingVRAMWrites: %zu writes",
+                                            m_pending_vram_writes.size());
 
   BeginVRAMRenderPass();
 
-  const VRAMWriteUBOData uniforms = GetVRAMWriteUBOData(x, y, width, height, start_index, set_mask, check_mask);
-  vkCmdPushConstants(cmdbuf, m_vram_write_pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uniforms),
-                     &uniforms);
-  vkCmdBindPipeline(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    m_vram_write_pipelines[BoolToUInt8(check_mask && !m_pgxp_depth_buffer)]);
   vkCmdBindDescriptorSets(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_vram_write_pipeline_layout, 0, 1,
                           &m_vram_write_descriptor_set, 0, nullptr);
 
-  // the viewport should already be set to the full vram, so just adjust the scissor
-  const Common::Rectangle<u32> scaled_bounds = bounds * m_resolution_scale;
-  Vulkan::Util::SetScissor(cmdbuf, scaled_bounds.left, scaled_bounds.top, scaled_bounds.GetWidth(),
-                           scaled_bounds.GetHeight());
-  vkCmdDraw(cmdbuf, 3, 1, 0, 0);
+  u8 current_pipeline_index = 0xFF;
+  for (const PendingVRAMWrite& pw : m_pending_vram_writes)
+  {
+    if (pw.pipeline_index != current_pipeline_index)
+    {
+      vkCmdBindPipeline(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_vram_write_pipelines[pw.pipeline_index]);
+      current_pipeline_index = pw.pipeline_index;
+    }
+
+    vkCmdPushConstants(cmdbuf, m_vram_write_pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(pw.uniforms),
+                       &pw.uniforms);
 
+    // the viewport should already be set to the full vram, so just adjust the scissor
+    Vulkan::Util::SetScissor(cmdbuf, pw.scaled_bounds.left, pw.scaled_bounds.top, pw.scaled_bounds.GetWidth(),
+                             pw.scaled_bounds.GetHeight());
+    vkCmdDraw(cmdbuf, 3, 1, 0, 0);
+  }
+
+  m_renderer_stats.num_vram_write_flushes++;
+  m_pending_vram_writes.clear();
   RestoreGraphicsAPIState();
 }
 
 void GPU_HW_Vulkan::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height)
 {
+  FlushPendingVRAMWrites();
+  SetGPUTimingSection(GPUTimingSection::VRAMCopy);
+
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
   const Vulkan::Util::DebugScope debugScope(cmdbuf, "GPU_HW_Vulkan::CopyVRAM: {%u, %u} {%u, %u} %ux%u", src_x, src_y,
                                             dst_x, dst_y, width, height);
@@ -1679,7 +2202,7 @@ void GPU_HW_Vulkan::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 wid
   {
     const Common::Rectangle<u32> src_bounds = GetVRAMTransferBounds(src_x, src_y, width, height);
     const Common::Rectangle<u32> dst_bounds = GetVRAMTransferBounds(dst_x, dst_y, width, height);
-    if (m_vram_dirty_rect.Intersects(src_bounds))
+    if (IsVRAMDirty(src_bounds))
       UpdateVRAMReadTexture();
     IncludeVRAMDirtyRectangle(dst_bounds);
 
@@ -1731,6 +2254,18 @@ void GPU_HW_Vulkan::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 wid
 
 void GPU_HW_Vulkan::UpdateVRAMReadTexture()
 {
+  FlushPendingVRAMWrites();
+  SetGPUTimingSection(GPUTimingSection::Batches);
+
+  // Only copy the dirty tiles, the bounding box of distant writes can cover most of VRAM.
+  std::vector<Common::Rectangle<u32>> dirty_rects;
+  GetVRAMDirtyRectangles(&dirty_rects);
+  if (dirty_rects.empty())
+  {
+    GPU_HW::UpdateVRAMReadTexture();
+    return;
+  }
+
   EndRenderPass();
 
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
@@ -1738,28 +2273,39 @@ void GPU_HW_Vulkan::UpdateVRAMReadTexture()
   m_vram_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
   m_vram_read_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-  const auto scaled_rect = m_vram_dirty_rect * m_resolution_scale;
-
   if (m_vram_texture.GetSamples() > VK_SAMPLE_COUNT_1_BIT)
   {
-    const VkImageResolve resolve{{VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
-                                 {static_cast<s32>(scaled_rect.left), static_cast<s32>(scaled_rect.top), 0},
-                                 {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
-                                 {static_cast<s32>(scaled_rect.left), static_cast<s32>(scaled_rect.top), 0},
-                                 {scaled_rect.GetWidth(), scaled_rect.GetHeight(), 1u}};
+    std::vector<VkImageResolve> resolves;
+    resolves.reserve(dirty_rects.size());
+    for (const Common::Rectangle<u32>& rect : dirty_rects)
+    {
+      const Common::Rectangle<u32> scaled_rect = rect * m_resolution_scale;
+      resolves.push_back({{VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
+                          {static_cast<s32>(scaled_rect.left), static_cast<s32>(scaled_rect.top), 0},
+                          {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
+                          {static_cast<s32>(scaled_rect.left), static_cast<s32>(scaled_rect.top), 0},
+                          {scaled_rect.GetWidth(), scaled_rect.GetHeight(), 1u}});
+    }
+
     vkCmdResolveImage(cmdbuf, m_vram_texture.GetImage(), m_vram_texture.GetLayout(), m_vram_read_texture.GetImage(),
-                      m_vram_read_texture.GetLayout(), 1, &resolve);
+                      m_vram_read_texture.GetLayout(), static_cast<u32>(resolves.size()), resolves.data());
   }
   else
   {
-    const VkImageCopy copy{{VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
-                           {static_cast<s32>(scaled_rect.left), static_cast<s32>(scaled_rect.top), 0},
-                           {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
-                           {static_cast<s32>(scaled_rect.left), static_cast<s32>(scaled_rect.top), 0},
-                           {scaled_rect.GetWidth(), scaled_rect.GetHeight(), 1u}};
+    std::vector<VkImageCopy> copies;
+    copies.reserve(dirty_rects.size());
+    for (const Common::Rectangle<u32>& rect : dirty_rects)
+    {
+      const Common::Rectangle<u32> scaled_rect = rect * m_resolution_scale;
+      copies.push_back({{VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
+                        {static_cast<s32>(scaled_rect.left), static_cast<s32>(scaled_rect.top), 0},
+                        {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
+                        {static_cast<s32>(scaled_rect.left), static_cast<s32>(scaled_rect.top), 0},
+                        {scaled_rect.GetWidth(), scaled_rect.GetHeight(), 1u}});
+    }
 
     vkCmdCopyImage(cmdbuf, m_vram_texture.GetImage(), m_vram_texture.GetLayout(), m_vram_read_texture.GetImage(),
-                   m_vram_read_texture.GetLayout(), 1u, &copy);
+                   m_vram_read_texture.GetLayout(), static_cast<u32>(copies.size()), copies.data());
   }
 
   m_vram_read_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
@@ -1769,6 +2315,9 @@ void GPU_HW_Vulkan::UpdateVRAMReadTexture()
 
 void GPU_HW_Vulkan::UpdateDepthBufferFromMaskBit()
 {
+  FlushPendingVRAMWrites();
+  SetGPUTimingSection(GPUTimingSection::Batches);
+
   if (m_pgxp_depth_buffer)
     return;
 
@@ -1795,6 +2344,9 @@ void GPU_HW_Vulkan::UpdateDepthBufferFromMaskBit()
 
 void GPU_HW_Vulkan::ClearDepthBuffer()
 {
+  FlushPendingVRAMWrites();
+  SetGPUTimingSection(GPUTimingSection::Batches);
+
   EndRenderPass();
 
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
@@ -1813,6 +2365,9 @@ void GPU_HW_Vulkan::ClearDepthBuffer()
 bool GPU_HW_Vulkan::BlitVRAMReplacementTexture(const TextureReplacementTexture* tex, u32 dst_x, u32 dst_y, u32 width,
                                                u32 height)
 {
+  FlushPendingVRAMWrites();
+  SetGPUTimingSection(GPUTimingSection::VRAMWrite);
+
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
   const Vulkan::Util::DebugScope debugScope(cmdbuf, "GPU_HW_Vulkan::BlitVRAMReplacementTexture: {%u,%u} %ux%u", dst_x,
                                             dst_y, width, height);
@@ -1852,6 +2407,7 @@ bool GPU_HW_Vulkan::BlitVRAMReplacementTexture(const TextureReplacementTexture*
 
 void GPU_HW_Vulkan::DownsampleFramebuffer(Vulkan::Texture& source, u32 left, u32 top, u32 width, u32 height)
 {
+  SetGPUTimingSection(GPUTimingSection::Downsample);
   if (m_downsample_mode == GPUDownsampleMode::Adaptive)
     DownsampleFramebufferAdaptive(source, left, top, width, height);
   else
@@ -1893,52 +2449,60 @@ void GPU_HW_Vulkan::DownsampleFramebufferBoxFilter(Vulkan::Texture& source, u32
 
 void GPU_HW_Vulkan::DownsampleFramebufferAdaptive(Vulkan::Texture& source, u32 left, u32 top, u32 width, u32 height)
 {
-  const VkImageCopy copy{{VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
-                         {static_cast<s32>(left), static_cast<s32>(top), 0},
-                         {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
-                         {static_cast<s32>(left), static_cast<s32>(top), 0},
-                         {width, height, 1u}};
-
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
   const Vulkan::Util::DebugScope outer_scope(cmdbuf, "Downsample Framebuffer Adaptive:");
 
-  source.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-  m_downsample_texture.TransitionSubresourcesToLayout(cmdbuf, 0, 1, 0, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                                      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-  vkCmdCopyImage(cmdbuf, source.GetImage(), source.GetLayout(), m_downsample_texture.GetImage(),
-                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
-
-  m_downsample_texture.TransitionSubresourcesToLayout(cmdbuf, 0, 1, 0, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                                      VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-  // creating mip chain
   const u32 levels = m_downsample_texture.GetLevels();
-  for (u32 level = 1; level < levels; level++)
+  if (m_use_compute_downsample)
   {
-    const Vulkan::Util::DebugScope mip_scope(cmdbuf, "Generate Mip: %u", level);
-    m_downsample_texture.TransitionSubresourcesToLayout(
-      cmdbuf, level, 1, 0, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    GenerateAdaptiveDownsampleMipsCompute(source, left, top, width, height);
+  }
+  else
+  {
+    const VkImageCopy copy{{VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
+                           {static_cast<s32>(left), static_cast<s32>(top), 0},
+                           {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
+                           {static_cast<s32>(left), static_cast<s32>(top), 0},
+                           {width, height, 1u}};
 
-    static constexpr VkClearValue clear_color = {};
-    BeginRenderPass(m_downsample_render_pass, m_downsample_mip_views[level].framebuffer, 0, 0,
-                    m_downsample_texture.GetMipWidth(level), m_downsample_texture.GetMipHeight(level), &clear_color);
-    Vulkan::Util::SetViewportAndScissor(cmdbuf, left >> level, top >> level, width >> level, height >> level);
-    vkCmdBindPipeline(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      (level == 1) ? m_downsample_first_pass_pipeline : m_downsample_mid_pass_pipeline);
-    vkCmdBindDescriptorSets(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_downsample_pipeline_layout, 0, 1,
-                            &m_downsample_mip_views[level - 1].descriptor_set, 0, nullptr);
+    source.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    m_downsample_texture.TransitionSubresourcesToLayout(cmdbuf, 0, 1, 0, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    vkCmdCopyImage(cmdbuf, source.GetImage(), source.GetLayout(), m_downsample_texture.GetImage(),
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
 
-    const SmoothingUBOData ubo = GetSmoothingUBO(level, left, top, width, height, m_downsample_texture.GetWidth(),
-                                                 m_downsample_texture.GetHeight());
-    vkCmdPushConstants(cmdbuf, m_downsample_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                       0, sizeof(ubo), &ubo);
+    m_downsample_texture.TransitionSubresourcesToLayout(cmdbuf, 0, 1, 0, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
-    vkCmdDraw(cmdbuf, 3, 1, 0, 0);
+    // creating mip chain
+    for (u32 level = 1; level < levels; level++)
+    {
+      const Vulkan::Util::DebugScope mip_scope(cmdbuf, "Generate Mip: %u", level);
+      m_downsample_texture.TransitionSubresourcesToLayout(
+        cmdbuf, level, 1, 0, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+
+      static constexpr VkClearValue clear_color = {};
+      BeginRenderPass(m_downsample_render_pass, m_downsample_mip_views[level].framebuffer, 0, 0,
+                      m_downsample_texture.GetMipWidth(level), m_downsample_texture.GetMipHeight(level),
+                      &clear_color);
+      Vulkan::Util::SetViewportAndScissor(cmdbuf, left >> level, top >> level, width >> level, height >> level);
+      vkCmdBindPipeline(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                        (level == 1) ? m_downsample_first_pass_pipeline : m_downsample_mid_pass_pipeline);
+      vkCmdBindDescriptorSets(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_downsample_pipeline_layout, 0, 1,
+                              &m_downsample_mip_views[level - 1].descriptor_set, 0, nullptr);
+
+      const SmoothingUBOData ubo = GetSmoothingUBO(level, left, top, width, height, m_downsample_texture.GetWidth(),
+                                                   m_downsample_texture.GetHeight());
+      vkCmdPushConstants(cmdbuf, m_downsample_pipeline_layout,
+                         VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(ubo), &ubo);
 
-    EndRenderPass();
+      vkCmdDraw(cmdbuf, 3, 1, 0, 0);
+
+      EndRenderPass();
 
-    m_downsample_texture.TransitionSubresourcesToLayout(
-      cmdbuf, level, 1, 0, 1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+      m_downsample_texture.TransitionSubresourcesToLayout(
+        cmdbuf, level, 1, 0, 1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
   }
 
   // blur pass at lowest resolution
@@ -1988,6 +2552,42 @@ void GPU_HW_Vulkan::DownsampleFramebufferAdaptive(Vulkan::Texture& source, u32 l
   g_host_display->SetDisplayTexture(&m_display_texture, left, top, width, height);
 }
 
+void GPU_HW_Vulkan::GenerateAdaptiveDownsampleMipsCompute(Vulkan::Texture& source, u32 left, u32 top, u32 width,
+                                                          u32 height)
+{
+  VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
+  const Vulkan::Util::DebugScope scope(cmdbuf, "Generate Mips (Compute)");
+
+  source.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  m_downsample_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_GENERAL);
+
+  // Workgroups are aligned to the tile size so that every level of a tile stays within the same workgroup.
+  struct Uniforms
+  {
+    u32 base[2];
+    u32 rect_min[2];
+    u32 rect_size[2];
+  };
+  const u32 base_x = left & ~(ADAPTIVE_DOWNSAMPLE_COMPUTE_TILE_SIZE - 1u);
+  const u32 base_y = top & ~(ADAPTIVE_DOWNSAMPLE_COMPUTE_TILE_SIZE - 1u);
+  const Uniforms uniforms = {{base_x, base_y}, {left, top}, {width, height}};
+  const u32 groups_x = (left + width - base_x + ADAPTIVE_DOWNSAMPLE_COMPUTE_TILE_SIZE - 1u) >>
+                       ADAPTIVE_DOWNSAMPLE_COMPUTE_TILE_SHIFT;
+  const u32 groups_y = (top + height - base_y + ADAPTIVE_DOWNSAMPLE_COMPUTE_TILE_SIZE - 1u) >>
+                       ADAPTIVE_DOWNSAMPLE_COMPUTE_TILE_SHIFT;
+
+  const VkDescriptorSet ds = (&source == &m_display_texture) ? m_downsample_compute_display_descriptor_set :
+                                                              m_downsample_compute_vram_descriptor_set;
+  vkCmdBindPipeline(cmdbuf, VK_PIPELINE_BIND_POINT_COMPUTE, m_downsample_compute_pipeline);
+  vkCmdBindDescriptorSets(cmdbuf, VK_PIPELINE_BIND_POINT_COMPUTE, m_downsample_compute_pipeline_layout, 0, 1, &ds, 0,
+                          nullptr);
+  vkCmdPushConstants(cmdbuf, m_downsample_compute_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uniforms),
+                     &uniforms);
+  vkCmdDispatch(cmdbuf, groups_x, groups_y, 1);
+
+  m_downsample_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
 std::unique_ptr<GPU> GPU::CreateHardwareVulkanRenderer()
 {
   return std::make_unique<GPU_HW_Vulkan>();
@@ -1,12 +1,16 @@
 #pragma once
 #include "common/dimensional_array.h"
+#include "common/threading.h"
+#include "common/timer.h"
 #include "common/vulkan/stream_buffer.h"
 #include "common/vulkan/texture.h"
 #include "gpu_hw.h"
 #include "texture_replacements.h"
 #include <array>
+#include <atomic>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 class GPU_HW_Vulkan : public GPU_HW
 {
@@ -28,6 +32,8 @@ protected:
   void ClearDisplay() override;
   void UpdateDisplay() override;
   void ReadVRAM(u32 x, u32 y, u32 width, u32 height) override;
+  void BeginVRAMReadback(u32 x, u32 y, u32 width, u32 height) override;
+  void FinishVRAMReadback() override;
   void FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color) override;
   void UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, bool set_mask, bool check_mask) override;
   void CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height) override;
@@ -44,6 +50,7 @@ private:
   enum : u32
   {
     MAX_PUSH_CONSTANTS_SIZE = 64,
+    MAX_PIPELINE_COMPILE_THREADS = 4,
   };
   void SetCapabilities();
   void DestroyResources();
@@ -65,15 +72,38 @@ private:
   bool CreateVertexBuffer();
   bool CreateUniformBuffer();
   bool CreateTextureBuffer();
+  bool CreateVRAMReadbackBuffer();
+  void DestroyVRAMReadbackBuffer();
+
+  /// Draws all queued VRAM writes. Must be called before anything else reads or writes the VRAM texture.
+  void FlushPendingVRAMWrites();
+
+  /// Records the encode and copy of the rectangle to the readback buffer, without submitting the command buffer.
+  void QueueVRAMReadback(u32 x, u32 y, u32 width, u32 height);
 
   bool CompilePipelines();
   void DestroyPipelines();
 
+  /// Returns the pipeline for a batch, creating it if it hasn't been compiled yet.
+  VkPipeline GetBatchPipeline(u8 depth_test, u8 render_mode, u8 texture_mode, u8 transparency_mode, u8 dithering,
+                              u8 interlacing);
+  /// Returns the transparency mode of the batch pipeline which is equivalent to the combination.
+  u8 GetBatchPipelineTransparencyMode(u8 render_mode, u8 transparency_mode) const;
+  VkPipeline CreateBatchPipeline(u8 depth_test, u8 render_mode, u8 transparency_mode, bool textured,
+                                 VkShaderModule fragment_shader) const;
+  void DestroyBatchShaders();
+
+  /// Async pipeline compilation, where batch pipelines are created on worker threads after the first frame.
+  void StartBatchPipelineCompileThreads();
+  void StopBatchPipelineCompileThreads();
+  void BatchPipelineCompileThread();
+
   bool BlitVRAMReplacementTexture(const TextureReplacementTexture* tex, u32 dst_x, u32 dst_y, u32 width, u32 height);
 
   void DownsampleFramebuffer(Vulkan::Texture& source, u32 left, u32 top, u32 width, u32 height);
   void DownsampleFramebufferBoxFilter(Vulkan::Texture& source, u32 left, u32 top, u32 width, u32 height);
   void DownsampleFramebufferAdaptive(Vulkan::Texture& source, u32 left, u32 top, u32 width, u32 height);
+  void GenerateAdaptiveDownsampleMipsCompute(Vulkan::Texture& source, u32 left, u32 top, u32 width, u32 height);
 
   VkRenderPass m_current_render_pass = VK_NULL_HANDLE;
 
@@ -118,11 +148,46 @@ private:
   Vulkan::StreamBuffer m_uniform_stream_buffer;
   Vulkan::StreamBuffer m_texture_stream_buffer;
 
+  // CPU->VRAM writes which have been staged in m_texture_stream_buffer, but not yet drawn.
+  struct PendingVRAMWrite
+  {
+    VRAMWriteUBOData uniforms;
+    Common::Rectangle<u32> scaled_bounds;
+    u8 pipeline_index;
+  };
+  std::vector<PendingVRAMWrite> m_pending_vram_writes;
+
+  // Host-visible copy of the readback texture, and the rectangle/command buffer of the last queued readback.
+  VkBuffer m_vram_readback_buffer = VK_NULL_HANDLE;
+  VmaAllocation m_vram_readback_allocation = VK_NULL_HANDLE;
+  const u8* m_vram_readback_buffer_map = nullptr;
+  Common::Rectangle<u32> m_vram_readback_rect;
+  u64 m_vram_readback_fence_counter = 0;
+
   u32 m_current_uniform_buffer_offset = 0;
   VkBufferView m_texture_stream_buffer_view = VK_NULL_HANDLE;
 
+  // vertex shaders - [textured]
+  // fragment shaders - [render_mode][texture_mode][dithering][interlacing]
+  // kept around while the batch pipelines are being compiled
+  DimensionalArray<VkShaderModule, 2> m_batch_vertex_shaders{};
+  DimensionalArray<VkShaderModule, 2, 2, 9, 4> m_batch_fragment_shaders{};
+
   // [depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
-  DimensionalArray<VkPipeline, 2, 2, 5, 9, 4, 3> m_batch_pipelines{};
+  // atomic because they can be created by the compile threads while rendering
+  DimensionalArray<std::atomic<VkPipeline>, 2, 2, 5, 9, 4, 3> m_batch_pipelines{};
+
+  // [depth_test][render_mode][transparency_mode]
+  // drawn with while the batch pipelines are compiling, or always when uber shaders are enabled
+  DimensionalArray<VkPipeline, 5, 4, 3> m_batch_uber_pipelines{};
+  bool m_use_uber_shaders = false;
+
+  std::vector<Threading::Thread> m_batch_pipeline_compile_threads;
+  std::vector<u32> m_batch_pipeline_compile_queue;
+  std::atomic<u32> m_batch_pipeline_compile_next{0};
+  std::atomic<u32> m_batch_pipeline_compile_remaining{0};
+  std::atomic_bool m_batch_pipeline_compile_cancel{false};
+  Common::Timer::Value m_batch_pipeline_compile_start_time = 0;
 
   // [wrapped][interlaced]
   DimensionalArray<VkPipeline, 2, 2> m_vram_fill_pipelines{};
@@ -163,4 +228,13 @@ private:
   VkPipeline m_downsample_mid_pass_pipeline = VK_NULL_HANDLE;
   VkPipeline m_downsample_blur_pass_pipeline = VK_NULL_HANDLE;
   VkPipeline m_downsample_composite_pass_pipeline = VK_NULL_HANDLE;
+
+  // single-dispatch compute mip chain for adaptive downsampling, when storage images are usable
+  VkDescriptorSetLayout m_downsample_compute_descriptor_set_layout = VK_NULL_HANDLE;
+  VkPipelineLayout m_downsample_compute_pipeline_layout = VK_NULL_HANDLE;
+  VkDescriptorSet m_downsample_compute_vram_descriptor_set = VK_NULL_HANDLE;
+  VkDescriptorSet m_downsample_compute_display_descriptor_set = VK_NULL_HANDLE;
+  VkPipeline m_downsample_compute_pipeline = VK_NULL_HANDLE;
+  u32 m_downsample_compute_max_levels = 0;
+  bool m_use_compute_downsample = false;
 };
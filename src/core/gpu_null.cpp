@@ -0,0 +1,97 @@
+#include "common/log.h"
+#include "gpu.h"
+#include "host_display.h"
+#include "util/state_wrapper.h"
+#include <array>
+Log_SetChannel(GPU_Null);
+
+namespace {
+
+/// Parses commands and keeps VRAM up to date for transfers and readbacks, but never draws anything. Used for
+/// audio-only playback, where the output is never looked at.
+class GPU_Null final : public GPU
+{
+public:
+  GPU_Null();
+  ~GPU_Null() override;
+
+  GPURenderer GetRendererType() const override;
+  const Threading::Thread* GetSWThread() const override;
+
+  bool Initialize() override;
+  bool DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display) override;
+  void Reset(bool clear_vram) override;
+
+protected:
+  void ClearDisplay() override;
+  void UpdateDisplay() override;
+
+private:
+  std::array<u16, VRAM_WIDTH * VRAM_HEIGHT> m_vram = {};
+};
+
+} // namespace
+
+GPU_Null::GPU_Null()
+{
+  m_vram_ptr = m_vram.data();
+}
+
+GPU_Null::~GPU_Null()
+{
+  if (g_host_display)
+    g_host_display->ClearDisplayTexture();
+}
+
+GPURenderer GPU_Null::GetRendererType() const
+{
+  // it's more or less the software renderer without the rasterizer, and shouldn't be treated as a hardware renderer
+  return GPURenderer::Software;
+}
+
+const Threading::Thread* GPU_Null::GetSWThread() const
+{
+  return nullptr;
+}
+
+bool GPU_Null::Initialize()
+{
+  // the frontend still wants a display for the UI, keep the current one if we have it
+  if (!g_host_display && !Host::AcquireHostDisplay(HostDisplay::GetPreferredAPI()))
+    return false;
+
+  if (!GPU::Initialize())
+    return false;
+
+  Log_InfoPrint("Using null renderer, nothing will be drawn.");
+  return true;
+}
+
+bool GPU_Null::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display)
+{
+  // VRAM lives on the CPU side, same as the software renderer
+  return GPU::DoState(sw, nullptr, update_display);
+}
+
+void GPU_Null::Reset(bool clear_vram)
+{
+  GPU::Reset(clear_vram);
+
+  if (clear_vram)
+    m_vram.fill(0);
+}
+
+void GPU_Null::ClearDisplay()
+{
+  g_host_display->ClearDisplayTexture();
+}
+
+void GPU_Null::UpdateDisplay()
+{
+  g_host_display->ClearDisplayTexture();
+}
+
+std::unique_ptr<GPU> GPU::CreateNullRenderer()
+{
+  return std::make_unique<GPU_Null>();
+}
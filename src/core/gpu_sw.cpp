@@ -6,6 +6,7 @@
 #include "common/platform.h"
 #include "host_display.h"
 #include "system.h"
+#include "util/shared_frame_output.h"
 #include <algorithm>
 Log_SetChannel(GPU_SW);
 
@@ -35,6 +36,7 @@ GPU_SW::GPU_SW()
 
 GPU_SW::~GPU_SW()
 {
+  m_frame_output.reset();
   m_backend.Shutdown();
   if (g_host_display)
     g_host_display->ClearDisplayTexture();
@@ -81,6 +83,7 @@ bool GPU_SW::Initialize()
     }
   }
 
+  UpdateFrameOutput();
   return true;
 }
 
@@ -101,6 +104,43 @@ void GPU_SW::UpdateSettings()
 {
   GPU::UpdateSettings();
   m_backend.UpdateSettings();
+  UpdateFrameOutput();
+}
+
+void GPU_SW::UpdateFrameOutput()
+{
+  if (!g_settings.display_shared_frame_output)
+  {
+    m_frame_output.reset();
+    return;
+  }
+
+  if (m_frame_output)
+    return;
+
+#ifdef _WIN32
+  static constexpr const char* name = "Local\\DuckStationFrames";
+#else
+  static constexpr const char* name = "/duckstation-frames";
+#endif
+
+  // big enough for 24-bit output with the widest horizontal resolution and interlacing
+  m_frame_output = std::make_unique<Common::SharedFrameOutput>();
+  if (!m_frame_output->Create(name, VRAM_WIDTH, VRAM_HEIGHT, FRAME_OUTPUT_SLOTS))
+    m_frame_output.reset();
+}
+
+std::tuple<u32, u32> GPU_SW::GetEffectiveDisplayResolution(bool scaled /* = true */)
+{
+  // 24-bit output is always displayed from native vram
+  const u32 shift = (scaled && !m_GPUSTAT.display_area_color_depth_24) ? m_backend.GetUpscaleShift() : 0u;
+  return std::make_tuple(m_crtc_state.display_vram_width << shift, m_crtc_state.display_vram_height << shift);
+}
+
+std::tuple<u32, u32> GPU_SW::GetFullDisplayResolution(bool scaled /* = true */)
+{
+  const u32 shift = (scaled && !m_GPUSTAT.display_area_color_depth_24) ? m_backend.GetUpscaleShift() : 0u;
+  return std::make_tuple(m_crtc_state.display_width << shift, m_crtc_state.display_height << shift);
 }
 
 GPUTexture* GPU_SW::GetDisplayTexture(u32 width, u32 height, GPUTexture::Format format)
@@ -110,6 +150,8 @@ GPUTexture* GPU_SW::GetDisplayTexture(u32 width, u32 height, GPUTexture::Format
   {
     g_host_display->ClearDisplayTexture();
     m_display_texture.reset();
+    for (DisplayFieldState& state : m_display_fields)
+      state.valid = false;
     m_display_texture = g_host_display->CreateTexture(width, height, 1, 1, 1, format, nullptr, 0, true);
     if (!m_display_texture)
       Log_ErrorPrintf("Failed to create %ux%u %u texture", width, height, static_cast<u32>(format));
@@ -232,20 +274,230 @@ ALWAYS_INLINE void CopyOutRow16<GPUTexture::Format::RGB565, u16>(const u16* src_
     *(dst_ptr++) = VRAM16ToOutput<GPUTexture::Format::RGB565, u16>(*(src_ptr++));
 }
 
+#if defined(CPU_X64)
+/// Converts 8 VRAM pixels to RGBA8, or BGRA8 with opaque alpha when swap_rb is set. Returns 4 pixels in each output.
+template<bool swap_rb>
+ALWAYS_INLINE static void ConvertVRAM16ToRGBA8x8(__m128i value, __m128i* out_lo, __m128i* out_hi)
+{
+  const __m128i single_mask = _mm_set1_epi16(0x1F);
+  const __m128i mul = _mm_set1_epi16(527);
+  const __m128i add = _mm_set1_epi16(23);
+  const __m128i r = _mm_srli_epi16(
+    _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(value, single_mask), mul), add), 6);
+  const __m128i g = _mm_srli_epi16(
+    _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(value, 5), single_mask), mul), add), 6);
+  const __m128i b = _mm_srli_epi16(
+    _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(value, 10), single_mask), mul), add), 6);
+  const __m128i a = swap_rb ? _mm_set1_epi16(static_cast<s16>(static_cast<u16>(0xFF00))) :
+                              _mm_slli_epi16(_mm_srai_epi16(value, 15), 8);
+
+  const __m128i c01 = _mm_or_si128(swap_rb ? b : r, _mm_slli_epi16(g, 8));
+  const __m128i c23 = _mm_or_si128(swap_rb ? r : b, a);
+  *out_lo = _mm_unpacklo_epi16(c01, c23);
+  *out_hi = _mm_unpackhi_epi16(c01, c23);
+}
+#elif defined(CPU_AARCH64)
+template<bool swap_rb>
+ALWAYS_INLINE static uint16x8x2_t ConvertVRAM16ToRGBA8x8(uint16x8_t value)
+{
+  const uint16x8_t single_mask = vdupq_n_u16(0x1F);
+  const uint16x8_t add = vdupq_n_u16(23);
+  const uint16x8_t r = vshrq_n_u16(vmlaq_n_u16(add, vandq_u16(value, single_mask), 527), 6);
+  const uint16x8_t g = vshrq_n_u16(vmlaq_n_u16(add, vandq_u16(vshrq_n_u16(value, 5), single_mask), 527), 6);
+  const uint16x8_t b = vshrq_n_u16(vmlaq_n_u16(add, vandq_u16(vshrq_n_u16(value, 10), single_mask), 527), 6);
+  const uint16x8_t a =
+    swap_rb ? vdupq_n_u16(0xFF00) : vshlq_n_u16(vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(value), 15)), 8);
+
+  const uint16x8_t c01 = vorrq_u16(swap_rb ? b : r, vshlq_n_u16(g, 8));
+  const uint16x8_t c23 = vorrq_u16(swap_rb ? r : b, a);
+  return vzipq_u16(c01, c23);
+}
+#endif
+
 template<>
 ALWAYS_INLINE void CopyOutRow16<GPUTexture::Format::RGBA8, u32>(const u16* src_ptr, u32* dst_ptr, u32 width)
 {
-  for (u32 col = 0; col < width; col++)
+  u32 col = 0;
+
+#if defined(CPU_X64)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    __m128i lo, hi;
+    ConvertVRAM16ToRGBA8x8<false>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr)), &lo, &hi);
+    src_ptr += 8;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr + 4), hi);
+    dst_ptr += 8;
+  }
+#elif defined(CPU_AARCH64)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const uint16x8x2_t value = ConvertVRAM16ToRGBA8x8<false>(vld1q_u16(src_ptr));
+    src_ptr += 8;
+    vst1q_u32(dst_ptr, vreinterpretq_u32_u16(value.val[0]));
+    vst1q_u32(dst_ptr + 4, vreinterpretq_u32_u16(value.val[1]));
+    dst_ptr += 8;
+  }
+#endif
+
+  for (; col < width; col++)
     *(dst_ptr++) = VRAM16ToOutput<GPUTexture::Format::RGBA8, u32>(*(src_ptr++));
 }
 
 template<>
 ALWAYS_INLINE void CopyOutRow16<GPUTexture::Format::BGRA8, u32>(const u16* src_ptr, u32* dst_ptr, u32 width)
 {
-  for (u32 col = 0; col < width; col++)
+  u32 col = 0;
+
+#if defined(CPU_X64)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    __m128i lo, hi;
+    ConvertVRAM16ToRGBA8x8<true>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr)), &lo, &hi);
+    src_ptr += 8;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr + 4), hi);
+    dst_ptr += 8;
+  }
+#elif defined(CPU_AARCH64)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const uint16x8x2_t value = ConvertVRAM16ToRGBA8x8<true>(vld1q_u16(src_ptr));
+    src_ptr += 8;
+    vst1q_u32(dst_ptr, vreinterpretq_u32_u16(value.val[0]));
+    vst1q_u32(dst_ptr + 4, vreinterpretq_u32_u16(value.val[1]));
+    dst_ptr += 8;
+  }
+#endif
+
+  for (; col < width; col++)
     *(dst_ptr++) = VRAM16ToOutput<GPUTexture::Format::BGRA8, u32>(*(src_ptr++));
 }
 
+template<GPUTexture::Format out_format, typename out_type>
+static void CopyOutRow24(const u8* src_ptr, out_type* dst_ptr, u32 width);
+
+#if defined(CPU_X64)
+/// Spreads 4 packed RGB888 pixels from the bottom 12 bytes of value into 32-bit lanes. The top byte is garbage.
+ALWAYS_INLINE static __m128i Expand24To32x4(__m128i value)
+{
+  const __m128i p01 = _mm_unpacklo_epi32(value, _mm_srli_si128(value, 3));
+  const __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(value, 6), _mm_srli_si128(value, 9));
+  return _mm_unpacklo_epi64(p01, p23);
+}
+#endif
+
+template<>
+ALWAYS_INLINE void CopyOutRow24<GPUTexture::Format::RGBA8, u32>(const u8* src_ptr, u32* dst_ptr, u32 width)
+{
+  u32 col = 0;
+
+#if defined(CPU_X64)
+  // each load reads 16 bytes but only consumes 12, so stop while there are at least two pixels spare
+  const __m128i alpha = _mm_set1_epi32(static_cast<s32>(0xFF000000u));
+  for (; (col + 6) <= width; col += 4)
+  {
+    const __m128i value = Expand24To32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), _mm_or_si128(value, alpha));
+    src_ptr += 12;
+    dst_ptr += 4;
+  }
+#elif defined(CPU_AARCH64)
+  for (; (col + 16) <= width; col += 16)
+  {
+    const uint8x16x3_t rgb = vld3q_u8(src_ptr);
+    uint8x16x4_t rgba;
+    rgba.val[0] = rgb.val[0];
+    rgba.val[1] = rgb.val[1];
+    rgba.val[2] = rgb.val[2];
+    rgba.val[3] = vdupq_n_u8(0xFF);
+    vst4q_u8(reinterpret_cast<u8*>(dst_ptr), rgba);
+    src_ptr += 48;
+    dst_ptr += 16;
+  }
+#endif
+
+  u8* dst_row_ptr = reinterpret_cast<u8*>(dst_ptr);
+  for (; col < width; col++)
+  {
+    *(dst_row_ptr++) = *(src_ptr++);
+    *(dst_row_ptr++) = *(src_ptr++);
+    *(dst_row_ptr++) = *(src_ptr++);
+    *(dst_row_ptr++) = 0xFF;
+  }
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow24<GPUTexture::Format::BGRA8, u32>(const u8* src_ptr, u32* dst_ptr, u32 width)
+{
+  u32 col = 0;
+
+#if defined(CPU_X64)
+  const __m128i alpha = _mm_set1_epi32(static_cast<s32>(0xFF000000u));
+  const __m128i g_mask = _mm_set1_epi32(0x0000FF00);
+  const __m128i rb_mask = _mm_set1_epi32(0x000000FF);
+  for (; (col + 6) <= width; col += 4)
+  {
+    const __m128i value = Expand24To32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr)));
+    const __m128i r = _mm_slli_epi32(_mm_and_si128(value, rb_mask), 16);
+    const __m128i b = _mm_and_si128(_mm_srli_epi32(value, 16), rb_mask);
+    const __m128i bgra = _mm_or_si128(_mm_or_si128(_mm_and_si128(value, g_mask), alpha), _mm_or_si128(r, b));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), bgra);
+    src_ptr += 12;
+    dst_ptr += 4;
+  }
+#elif defined(CPU_AARCH64)
+  for (; (col + 16) <= width; col += 16)
+  {
+    const uint8x16x3_t rgb = vld3q_u8(src_ptr);
+    uint8x16x4_t bgra;
+    bgra.val[0] = rgb.val[2];
+    bgra.val[1] = rgb.val[1];
+    bgra.val[2] = rgb.val[0];
+    bgra.val[3] = vdupq_n_u8(0xFF);
+    vst4q_u8(reinterpret_cast<u8*>(dst_ptr), bgra);
+    src_ptr += 48;
+    dst_ptr += 16;
+  }
+#endif
+
+  u8* dst_row_ptr = reinterpret_cast<u8*>(dst_ptr);
+  for (; col < width; col++)
+  {
+    *(dst_row_ptr++) = src_ptr[2];
+    *(dst_row_ptr++) = src_ptr[1];
+    *(dst_row_ptr++) = src_ptr[0];
+    *(dst_row_ptr++) = 0xFF;
+    src_ptr += 3;
+  }
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow24<GPUTexture::Format::RGB565, u16>(const u8* src_ptr, u16* dst_ptr, u32 width)
+{
+  for (u32 col = 0; col < width; col++)
+  {
+    *(dst_ptr++) = ((static_cast<u16>(src_ptr[0]) >> 3) << 11) | ((static_cast<u16>(src_ptr[1]) >> 2) << 5) |
+                   (static_cast<u16>(src_ptr[2]) >> 3);
+    src_ptr += 3;
+  }
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow24<GPUTexture::Format::RGBA5551, u16>(const u8* src_ptr, u16* dst_ptr, u32 width)
+{
+  for (u32 col = 0; col < width; col++)
+  {
+    *(dst_ptr++) = ((static_cast<u16>(src_ptr[0]) >> 3) << 10) | ((static_cast<u16>(src_ptr[1]) >> 3) << 5) |
+                   (static_cast<u16>(src_ptr[2]) >> 3);
+    src_ptr += 3;
+  }
+}
+
 template<GPUTexture::Format display_format>
 void GPU_SW::CopyOut15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 field, bool interlaced, bool interleaved)
 {
@@ -266,11 +518,14 @@ void GPU_SW::CopyOut15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 field
   }
   else
   {
-    dst_stride = GPU_MAX_DISPLAY_WIDTH * sizeof(OutputPixelType);
-    dst_ptr = m_display_texture_buffer.data() + (field != 0 ? dst_stride : 0);
+    // only the rows of this field are written, the other field is kept from the previous frame
+    if (!g_host_display->BeginTextureFieldUpdate(texture, width, height, field, reinterpret_cast<void**>(&dst_ptr),
+                                                 &dst_stride))
+    {
+      return;
+    }
   }
 
-  const u32 output_stride = dst_stride;
   const u8 interlaced_shift = BoolToUInt8(interlaced);
   const u8 interleaved_shift = BoolToUInt8(interleaved);
 
@@ -278,7 +533,6 @@ void GPU_SW::CopyOut15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 field
   if ((src_x + width) <= VRAM_WIDTH && (src_y + height) <= VRAM_HEIGHT)
   {
     const u32 rows = height >> interlaced_shift;
-    dst_stride <<= interlaced_shift;
 
     const u16* src_ptr = &m_vram_ptr[src_y * VRAM_WIDTH + src_x];
     const u32 src_step = VRAM_WIDTH << interleaved_shift;
@@ -292,7 +546,6 @@ void GPU_SW::CopyOut15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 field
   else
   {
     const u32 rows = height >> interlaced_shift;
-    dst_stride <<= interlaced_shift;
 
     const u32 end_x = src_x + width;
     for (u32 row = 0; row < rows; row++)
@@ -311,14 +564,114 @@ void GPU_SW::CopyOut15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 field
   if (!interlaced)
     g_host_display->EndTextureUpdate(texture, 0, 0, width, height);
   else
-    g_host_display->UpdateTexture(texture, 0, 0, width, height, m_display_texture_buffer.data(), output_stride);
+    g_host_display->EndTextureFieldUpdate(texture, width, height, field);
 
   g_host_display->SetDisplayTexture(texture, 0, 0, width, height);
 }
 
+template<GPUTexture::Format display_format>
+void GPU_SW::CopyOutUpscaled15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 field, bool interlaced,
+                                  bool interleaved)
+{
+  using OutputPixelType = std::conditional_t<
+    display_format == GPUTexture::Format::RGBA8 || display_format == GPUTexture::Format::BGRA8, u32, u16>;
+
+  const u32 shift = m_backend.GetUpscaleShift();
+  const u32 scale = 1u << shift;
+  const u32 vram_pitch = VRAM_WIDTH << shift;
+  const u16* vram = m_backend.GetUpscaledVRAM();
+  const u32 output_width = width << shift;
+  const u32 output_height = height << shift;
+
+  GPUTexture* texture = GetDisplayTexture(output_width, output_height, display_format);
+  if (!texture)
+    return;
+
+  u8* dst_ptr;
+  u32 dst_stride;
+  if (!interlaced)
+  {
+    if (!g_host_display->BeginTextureUpdate(texture, output_width, output_height, reinterpret_cast<void**>(&dst_ptr),
+                                            &dst_stride))
+    {
+      return;
+    }
+  }
+  else
+  {
+    // the other field is kept from the previous frame, so the buffer must persist
+    dst_stride = output_width * sizeof(OutputPixelType);
+    if (m_upscaled_display_texture_buffer.size() < (dst_stride * output_height))
+      m_upscaled_display_texture_buffer.resize(dst_stride * output_height);
+    dst_ptr = m_upscaled_display_texture_buffer.data();
+  }
+
+  const u8 interlaced_shift = BoolToUInt8(interlaced);
+  const u8 interleaved_shift = BoolToUInt8(interleaved);
+  const u32 rows = height >> interlaced_shift;
+  for (u32 row = 0; row < rows; row++)
+  {
+    const u32 src_row = (src_y + (row << interleaved_shift)) % VRAM_HEIGHT;
+    const u32 dst_row = interlaced ? ((row << 1) + field) : row;
+    for (u32 i = 0; i < scale; i++)
+    {
+      const u16* src_row_ptr = &vram[((src_row << shift) + i) * vram_pitch];
+      OutputPixelType* dst_row_ptr =
+        reinterpret_cast<OutputPixelType*>(dst_ptr + (((dst_row << shift) + i) * dst_stride));
+      if ((src_x + width) <= VRAM_WIDTH)
+      {
+        CopyOutRow16<display_format>(src_row_ptr + (src_x << shift), dst_row_ptr, output_width);
+      }
+      else
+      {
+        for (u32 col = 0; col < output_width; col++)
+        {
+          dst_row_ptr[col] =
+            VRAM16ToOutput<display_format, OutputPixelType>(src_row_ptr[((src_x << shift) + col) % vram_pitch]);
+        }
+      }
+    }
+  }
+
+  if (!interlaced)
+  {
+    g_host_display->EndTextureUpdate(texture, 0, 0, output_width, output_height);
+  }
+  else
+  {
+    g_host_display->UpdateTexture(texture, 0, 0, output_width, output_height,
+                                  m_upscaled_display_texture_buffer.data(), dst_stride);
+  }
+
+  g_host_display->SetDisplayTexture(texture, 0, 0, output_width, output_height);
+}
+
 void GPU_SW::CopyOut15Bit(GPUTexture::Format display_format, u32 src_x, u32 src_y, u32 width, u32 height, u32 field,
                           bool interlaced, bool interleaved)
 {
+  if (m_backend.GetUpscaleShift() > 0)
+  {
+    switch (display_format)
+    {
+      case GPUTexture::Format::RGBA5551:
+        CopyOutUpscaled15Bit<GPUTexture::Format::RGBA5551>(src_x, src_y, width, height, field, interlaced,
+                                                           interleaved);
+        break;
+      case GPUTexture::Format::RGB565:
+        CopyOutUpscaled15Bit<GPUTexture::Format::RGB565>(src_x, src_y, width, height, field, interlaced, interleaved);
+        break;
+      case GPUTexture::Format::RGBA8:
+        CopyOutUpscaled15Bit<GPUTexture::Format::RGBA8>(src_x, src_y, width, height, field, interlaced, interleaved);
+        break;
+      case GPUTexture::Format::BGRA8:
+        CopyOutUpscaled15Bit<GPUTexture::Format::BGRA8>(src_x, src_y, width, height, field, interlaced, interleaved);
+        break;
+      default:
+        break;
+    }
+    return;
+  }
+
   switch (display_format)
   {
     case GPUTexture::Format::RGBA5551:
@@ -359,15 +712,17 @@ void GPU_SW::CopyOut24Bit(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 heigh
   }
   else
   {
-    dst_stride = Common::AlignUpPow2<u32>(width * sizeof(OutputPixelType), 4);
-    dst_ptr = m_display_texture_buffer.data() + (field != 0 ? dst_stride : 0);
+    // only the rows of this field are written, the other field is kept from the previous frame
+    if (!g_host_display->BeginTextureFieldUpdate(texture, width, height, field, reinterpret_cast<void**>(&dst_ptr),
+                                                 &dst_stride))
+    {
+      return;
+    }
   }
 
-  const u32 output_stride = dst_stride;
   const u8 interlaced_shift = BoolToUInt8(interlaced);
   const u8 interleaved_shift = BoolToUInt8(interleaved);
   const u32 rows = height >> interlaced_shift;
-  dst_stride <<= interlaced_shift;
 
   if ((src_x + width) <= VRAM_WIDTH && (src_y + (rows << interleaved_shift)) <= VRAM_HEIGHT)
   {
@@ -375,54 +730,7 @@ void GPU_SW::CopyOut24Bit(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 heigh
     const u32 src_stride = (VRAM_WIDTH << interleaved_shift) * sizeof(u16);
     for (u32 row = 0; row < rows; row++)
     {
-      if constexpr (display_format == GPUTexture::Format::RGBA8)
-      {
-        const u8* src_row_ptr = src_ptr;
-        u8* dst_row_ptr = reinterpret_cast<u8*>(dst_ptr);
-        for (u32 col = 0; col < width; col++)
-        {
-          *(dst_row_ptr++) = *(src_row_ptr++);
-          *(dst_row_ptr++) = *(src_row_ptr++);
-          *(dst_row_ptr++) = *(src_row_ptr++);
-          *(dst_row_ptr++) = 0xFF;
-        }
-      }
-      else if constexpr (display_format == GPUTexture::Format::BGRA8)
-      {
-        const u8* src_row_ptr = src_ptr;
-        u8* dst_row_ptr = reinterpret_cast<u8*>(dst_ptr);
-        for (u32 col = 0; col < width; col++)
-        {
-          *(dst_row_ptr++) = src_row_ptr[2];
-          *(dst_row_ptr++) = src_row_ptr[1];
-          *(dst_row_ptr++) = src_row_ptr[0];
-          *(dst_row_ptr++) = 0xFF;
-          src_row_ptr += 3;
-        }
-      }
-      else if constexpr (display_format == GPUTexture::Format::RGB565)
-      {
-        const u8* src_row_ptr = src_ptr;
-        u16* dst_row_ptr = reinterpret_cast<u16*>(dst_ptr);
-        for (u32 col = 0; col < width; col++)
-        {
-          *(dst_row_ptr++) = ((static_cast<u16>(src_row_ptr[0]) >> 3) << 11) |
-                             ((static_cast<u16>(src_row_ptr[1]) >> 2) << 5) | (static_cast<u16>(src_row_ptr[2]) >> 3);
-          src_row_ptr += 3;
-        }
-      }
-      else if constexpr (display_format == GPUTexture::Format::RGBA5551)
-      {
-        const u8* src_row_ptr = src_ptr;
-        u16* dst_row_ptr = reinterpret_cast<u16*>(dst_ptr);
-        for (u32 col = 0; col < width; col++)
-        {
-          *(dst_row_ptr++) = ((static_cast<u16>(src_row_ptr[0]) >> 3) << 10) |
-                             ((static_cast<u16>(src_row_ptr[1]) >> 3) << 5) | (static_cast<u16>(src_row_ptr[2]) >> 3);
-          src_row_ptr += 3;
-        }
-      }
-
+      CopyOutRow24<display_format>(src_ptr, reinterpret_cast<OutputPixelType*>(dst_ptr), width);
       src_ptr += src_stride;
       dst_ptr += dst_stride;
     }
@@ -468,7 +776,7 @@ void GPU_SW::CopyOut24Bit(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 heigh
   if (!interlaced)
     g_host_display->EndTextureUpdate(texture, 0, 0, width, height);
   else
-    g_host_display->UpdateTexture(texture, 0, 0, width, height, m_display_texture_buffer.data(), output_stride);
+    g_host_display->EndTextureFieldUpdate(texture, width, height, field);
 
   g_host_display->SetDisplayTexture(texture, 0, 0, width, height);
 }
@@ -496,9 +804,123 @@ void GPU_SW::CopyOut24Bit(GPUTexture::Format display_format, u32 src_x, u32 src_
   }
 }
 
+void GPU_SW::CopyOutDisplay(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 height, u32 field, bool interlaced,
+                            bool interleaved, bool color_depth_24)
+{
+  DisplayFieldState& state = m_display_fields[interlaced ? field : 0];
+  const u32 upscale_shift = color_depth_24 ? 0 : m_backend.GetUpscaleShift();
+  if (m_display_texture && state.valid && state.src_x == src_x && state.src_y == src_y && state.skip_x == skip_x &&
+      state.width == width && state.height == height && state.upscale_shift == upscale_shift &&
+      state.interlaced == interlaced && state.interleaved == interleaved && state.color_depth_24 == color_depth_24)
+  {
+    // 24-bit pixels are 1.5 halfwords wide, and the slow path reads one past the end.
+    const u32 rows = height >> BoolToUInt8(interlaced);
+    const u32 vram_width = color_depth_24 ? ((((skip_x + width) * 3) + 1) / 2 + 1) : width;
+    const u32 vram_height = (rows > 0) ? (((rows - 1) << BoolToUInt8(interleaved)) + 1) : 0;
+    Common::Rectangle<u32> vram_rect = Common::Rectangle<u32>::FromExtents(src_x, src_y, vram_width, vram_height);
+    if (vram_rect.right > VRAM_WIDTH)
+      vram_rect.Set(0, vram_rect.top, VRAM_WIDTH, vram_rect.bottom);
+    if (vram_rect.bottom > VRAM_HEIGHT)
+      vram_rect.Set(vram_rect.left, 0, vram_rect.right, VRAM_HEIGHT);
+
+    if (!state.dirty_rect.Intersects(vram_rect))
+    {
+      g_host_display->SetDisplayTexture(m_display_texture.get(), 0, 0, m_display_texture->GetWidth(),
+                                        m_display_texture->GetHeight());
+      return;
+    }
+  }
+
+  if (color_depth_24)
+  {
+    CopyOut24Bit(m_24bit_display_format, src_x, src_y, skip_x, width, height, field, interlaced, interleaved);
+  }
+  else
+  {
+    CopyOut15Bit(m_16bit_display_format, src_x, src_y, width, height, field, interlaced, interleaved);
+  }
+
+  state.dirty_rect.SetInvalid();
+  state.src_x = src_x;
+  state.src_y = src_y;
+  state.skip_x = skip_x;
+  state.width = width;
+  state.height = height;
+  state.upscale_shift = upscale_shift;
+  state.interlaced = interlaced;
+  state.interleaved = interleaved;
+  state.color_depth_24 = color_depth_24;
+  state.valid = (m_display_texture != nullptr);
+
+  // progressive output overwrites both fields
+  DisplayFieldState& other_state = m_display_fields[interlaced ? (field ^ 1) : 1];
+  if (!interlaced || !other_state.interlaced)
+    other_state.valid = false;
+}
+
+void GPU_SW::ExportDisplayFrame(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 height, bool interlaced,
+                                bool interleaved, bool color_depth_24)
+{
+  u8* dst_ptr;
+  u32 dst_stride;
+  if (!m_frame_output->BeginFrame(width, height, reinterpret_cast<void**>(&dst_ptr), &dst_stride))
+    return;
+
+  // converted straight from vram rather than read back from the display texture, so both fields of interlaced
+  // output are woven together, and fields which are the same lines are doubled
+  const u32 src_width = color_depth_24 ? ((((skip_x + width) * 3) + 1) / 2) : width;
+  const bool wraps_x = ((src_x + src_width) > VRAM_WIDTH);
+  const u8 line_shift = BoolToUInt8(interlaced && !interleaved);
+  for (u32 row = 0; row < height; row++)
+  {
+    const u16* src_row_ptr = &m_vram_ptr[((src_y + (row >> line_shift)) % VRAM_HEIGHT) * VRAM_WIDTH];
+    u32* dst_row_ptr = reinterpret_cast<u32*>(dst_ptr);
+
+    if (!color_depth_24)
+    {
+      if (!wraps_x)
+      {
+        CopyOutRow16<GPUTexture::Format::RGBA8>(src_row_ptr + src_x, dst_row_ptr, width);
+      }
+      else
+      {
+        for (u32 col = 0; col < width; col++)
+          dst_row_ptr[col] = VRAM16ToOutput<GPUTexture::Format::RGBA8, u32>(src_row_ptr[(src_x + col) % VRAM_WIDTH]);
+      }
+    }
+    else
+    {
+      if (!wraps_x)
+      {
+        CopyOutRow24<GPUTexture::Format::RGBA8>(reinterpret_cast<const u8*>(src_row_ptr + src_x) + (skip_x * 3),
+                                                dst_row_ptr, width);
+      }
+      else
+      {
+        for (u32 col = 0; col < width; col++)
+        {
+          const u32 offset = (src_x + (((skip_x + col) * 3) / 2));
+          const u16 s0 = src_row_ptr[offset % VRAM_WIDTH];
+          const u16 s1 = src_row_ptr[(offset + 1) % VRAM_WIDTH];
+          const u8 shift = static_cast<u8>(col & 1u) * 8;
+          dst_row_ptr[col] = (((ZeroExtend32(s1) << 16) | ZeroExtend32(s0)) >> shift) | 0xFF000000u;
+        }
+      }
+    }
+
+    dst_ptr += dst_stride;
+  }
+
+  m_frame_output->EndFrame();
+}
+
 void GPU_SW::ClearDisplay()
 {
-  std::memset(m_display_texture_buffer.data(), 0, m_display_texture_buffer.size());
+  // drop the texture so the field which isn't updated next starts out cleared
+  if (g_host_display)
+    g_host_display->ClearDisplayTexture();
+  m_display_texture.reset();
+  m_upscaled_display_texture_buffer.clear();
 }
 
 void GPU_SW::UpdateDisplay()
@@ -506,6 +928,14 @@ void GPU_SW::UpdateDisplay()
   // fill display texture
   m_backend.Sync(true);
 
+  const Common::Rectangle<u32>& dirty_rect = m_backend.GetVRAMDirtyRect();
+  if (dirty_rect.Valid())
+  {
+    for (DisplayFieldState& state : m_display_fields)
+      state.dirty_rect.Include(dirty_rect);
+    m_backend.ClearVRAMDirtyRect();
+  }
+
   if (!g_settings.debugging.show_vram)
   {
     g_host_display->SetDisplayParameters(m_crtc_state.display_width, m_crtc_state.display_height,
@@ -523,33 +953,47 @@ void GPU_SW::UpdateDisplay()
     const u32 display_width = m_crtc_state.display_vram_width;
     const u32 display_height = m_crtc_state.display_vram_height;
 
+    if (m_frame_output)
+    {
+      const bool interlaced = IsInterlacedDisplayEnabled();
+      const bool interleaved = (interlaced && m_GPUSTAT.vertical_resolution);
+      if (m_GPUSTAT.display_area_color_depth_24)
+      {
+        ExportDisplayFrame(m_crtc_state.regs.X, vram_offset_y, m_crtc_state.display_vram_left - m_crtc_state.regs.X,
+                           display_width, display_height, interlaced, interleaved, true);
+      }
+      else
+      {
+        ExportDisplayFrame(m_crtc_state.display_vram_left, vram_offset_y, 0, display_width, display_height,
+                           interlaced, interleaved, false);
+      }
+    }
+
     if (IsInterlacedDisplayEnabled())
     {
       const u32 field = GetInterlacedDisplayField();
       if (m_GPUSTAT.display_area_color_depth_24)
       {
-        CopyOut24Bit(m_24bit_display_format, m_crtc_state.regs.X, vram_offset_y + field,
-                     m_crtc_state.display_vram_left - m_crtc_state.regs.X, display_width, display_height, field, true,
-                     m_GPUSTAT.vertical_resolution);
+        CopyOutDisplay(m_crtc_state.regs.X, vram_offset_y + field, m_crtc_state.display_vram_left - m_crtc_state.regs.X,
+                       display_width, display_height, field, true, m_GPUSTAT.vertical_resolution, true);
       }
       else
       {
-        CopyOut15Bit(m_16bit_display_format, m_crtc_state.display_vram_left, vram_offset_y + field, display_width,
-                     display_height, field, true, m_GPUSTAT.vertical_resolution);
+        CopyOutDisplay(m_crtc_state.display_vram_left, vram_offset_y + field, 0, display_width, display_height, field,
+                       true, m_GPUSTAT.vertical_resolution, false);
       }
     }
     else
     {
       if (m_GPUSTAT.display_area_color_depth_24)
       {
-        CopyOut24Bit(m_24bit_display_format, m_crtc_state.regs.X, vram_offset_y,
-                     m_crtc_state.display_vram_left - m_crtc_state.regs.X, display_width, display_height, 0, false,
-                     false);
+        CopyOutDisplay(m_crtc_state.regs.X, vram_offset_y, m_crtc_state.display_vram_left - m_crtc_state.regs.X,
+                       display_width, display_height, 0, false, false, true);
       }
       else
       {
-        CopyOut15Bit(m_16bit_display_format, m_crtc_state.display_vram_left, vram_offset_y, display_width,
-                     display_height, 0, false, false);
+        CopyOutDisplay(m_crtc_state.display_vram_left, vram_offset_y, 0, display_width, display_height, 0, false,
+                       false, false);
       }
     }
   }
@@ -1,5 +1,4 @@
 #pragma once
-#include "common/heap_array.h"
 #include "gpu.h"
 #include "gpu_sw_backend.h"
 #include "host_display.h"
@@ -14,6 +13,11 @@ class Thread;
 
 class GPUTexture;
 
+namespace Common
+{
+class SharedFrameOutput;
+}
+
 class GPU_SW final : public GPU
 {
 public:
@@ -30,6 +34,9 @@ public:
   void Reset(bool clear_vram) override;
   void UpdateSettings() override;
 
+  std::tuple<u32, u32> GetEffectiveDisplayResolution(bool scaled = true) override;
+  std::tuple<u32, u32> GetFullDisplayResolution(bool scaled = true) override;
+
 protected:
   void ReadVRAM(u32 x, u32 y, u32 width, u32 height) override;
   void FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color) override;
@@ -41,12 +48,23 @@ protected:
   void CopyOut15Bit(GPUTexture::Format display_format, u32 src_x, u32 src_y, u32 width, u32 height, u32 field,
                     bool interlaced, bool interleaved);
 
+  template<GPUTexture::Format display_format>
+  void CopyOutUpscaled15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 field, bool interlaced,
+                            bool interleaved);
+
   template<GPUTexture::Format display_format>
   void CopyOut24Bit(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 height, u32 field, bool interlaced,
                     bool interleaved);
   void CopyOut24Bit(GPUTexture::Format display_format, u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 height,
                     u32 field, bool interlaced, bool interleaved);
 
+  void CopyOutDisplay(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 height, u32 field, bool interlaced,
+                      bool interleaved, bool color_depth_24);
+
+  void UpdateFrameOutput();
+  void ExportDisplayFrame(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 height, bool interlaced, bool interleaved,
+                          bool color_depth_24);
+
   void ClearDisplay() override;
   void UpdateDisplay() override;
 
@@ -57,10 +75,32 @@ protected:
 
   GPUTexture* GetDisplayTexture(u32 width, u32 height, GPUTexture::Format format);
 
-  HeapArray<u8, GPU_MAX_DISPLAY_WIDTH * GPU_MAX_DISPLAY_HEIGHT * sizeof(u32)> m_display_texture_buffer;
   GPUTexture::Format m_16bit_display_format = GPUTexture::Format::RGB565;
   GPUTexture::Format m_24bit_display_format = GPUTexture::Format::RGBA8;
   std::unique_ptr<GPUTexture> m_display_texture;
+  std::vector<u8> m_upscaled_display_texture_buffer;
+
+  // What was last converted into each field of the display texture, so unchanged frames can skip the conversion and
+  // upload. Progressive output uses the first field.
+  struct DisplayFieldState
+  {
+    Common::Rectangle<u32> dirty_rect;
+    u32 src_x;
+    u32 src_y;
+    u32 skip_x;
+    u32 width;
+    u32 height;
+    u32 upscale_shift;
+    bool interlaced;
+    bool interleaved;
+    bool color_depth_24;
+    bool valid;
+  };
+  std::array<DisplayFieldState, 2> m_display_fields = {};
+
+  // Copies of each presented frame for external consumers, when enabled.
+  static constexpr u32 FRAME_OUTPUT_SLOTS = 3;
+  std::unique_ptr<Common::SharedFrameOutput> m_frame_output;
 
   GPU_SW_Backend m_backend;
 };
@@ -1,23 +1,82 @@
 #include "gpu_sw_backend.h"
 #include "common/assert.h"
 #include "common/log.h"
+#include "common/platform.h"
 #include "gpu_sw_backend.h"
 #include "host_display.h"
+#include "settings.h"
 #include "system.h"
+#include "util/memory_arena.h"
 #include <algorithm>
+#include <cstring>
 Log_SetChannel(GPU_SW_Backend);
 
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
+static constexpr u32 MAX_RENDER_THREADS = 32;
+static constexpr u32 MAX_BATCH_SIZE = 1024 * 1024;
+
+static u32 GetSettingsUpscaleShift()
+{
+  const u32 scale = g_settings.gpu_software_renderer_scale;
+  return (scale >= 4) ? 2 : ((scale >= 2) ? 1 : 0);
+}
+
 GPU_SW_Backend::GPU_SW_Backend() : GPUBackend()
 {
-  m_vram.fill(0);
-  m_vram_ptr = m_vram.data();
+  m_vram_huge_pages = g_settings.use_huge_pages;
+  m_vram = static_cast<u16*>(Common::MemoryArena::AllocateMemory(VRAM_SIZE, m_vram_huge_pages));
+  Assert(m_vram);
+  m_vram_ptr = m_vram;
+}
+
+GPU_SW_Backend::GPU_SW_Backend(u16* shared_vram) : GPUBackend()
+{
+  m_vram = shared_vram;
+  m_vram_shared = true;
+  m_vram_ptr = m_vram;
+
+  // Nothing reads the results until a readback, so there's no point waking the thread for every few commands.
+  m_lazy_replay = true;
 }
 
-GPU_SW_Backend::~GPU_SW_Backend() = default;
+GPU_SW_Backend::~GPU_SW_Backend()
+{
+  StopWorkers();
+  if (!m_vram_shared)
+    Common::MemoryArena::FreeMemory(m_vram, VRAM_SIZE, m_vram_huge_pages);
+}
 
 bool GPU_SW_Backend::Initialize(bool force_thread)
 {
-  return GPUBackend::Initialize(force_thread);
+  if (!GPUBackend::Initialize(force_thread))
+    return false;
+
+  StartWorkers(g_settings.gpu_software_renderer_threads);
+  SetUpscaleShift(m_vram_shared ? 0 : GetSettingsUpscaleShift());
+  return true;
+}
+
+void GPU_SW_Backend::UpdateSettings()
+{
+  GPUBackend::UpdateSettings();
+
+  const u32 num_threads = std::clamp<u32>(g_settings.gpu_software_renderer_threads, 1u, MAX_RENDER_THREADS);
+  if (num_threads != (static_cast<u32>(m_workers.size()) + 1u))
+  {
+    StopWorkers();
+    StartWorkers(num_threads);
+  }
+
+  SetUpscaleShift(m_vram_shared ? 0 : GetSettingsUpscaleShift());
 }
 
 void GPU_SW_Backend::Reset(bool clear_vram)
@@ -25,39 +84,168 @@ void GPU_SW_Backend::Reset(bool clear_vram)
   GPUBackend::Reset(clear_vram);
 
   if (clear_vram)
-    m_vram.fill(0);
+  {
+    AddVRAMDirtyRect(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+    std::fill_n(m_vram, VRAM_WIDTH * VRAM_HEIGHT, u16(0));
+    std::fill(m_upscaled_vram.begin(), m_upscaled_vram.end(), u16(0));
+  }
+}
+
+void GPU_SW_Backend::Shutdown()
+{
+  GPUBackend::Shutdown();
+  StopWorkers();
 }
 
 void GPU_SW_Backend::DrawPolygon(const GPUBackendDrawPolygonCommand* cmd)
 {
-  const GPURenderCommand rc{cmd->rc.bits};
-  const bool dithering_enable = rc.IsDitheringEnabled() && cmd->draw_mode.dither_enable;
+  // Vertices outside the representable range wrap around, so fall back to the whole drawing area.
+  const u32 num_vertices = cmd->rc.quad_polygon ? 4 : 3;
+  s32 min_x = cmd->vertices[0].x, max_x = min_x, min_y = cmd->vertices[0].y, max_y = min_y;
+  for (u32 i = 1; i < num_vertices; i++)
+  {
+    min_x = std::min(min_x, cmd->vertices[i].x);
+    max_x = std::max(max_x, cmd->vertices[i].x);
+    min_y = std::min(min_y, cmd->vertices[i].y);
+    max_y = std::max(max_y, cmd->vertices[i].y);
+  }
 
-  const DrawTriangleFunction DrawFunction = GetDrawTriangleFunction(
-    rc.shading_enable, rc.texture_enable, rc.raw_texture_enable, rc.transparency_enable, dithering_enable);
+  const Common::Rectangle<u32> bounds = (min_x < -1024 || max_x > 1023 || min_y < -1024 || max_y > 1023) ?
+                                          GetClippedBounds(0, 0, VRAM_WIDTH, VRAM_HEIGHT) :
+                                          GetClippedBounds(min_x, min_y, max_x + 1, max_y + 1);
+  AddVRAMDirtyRect(bounds.left, bounds.top, bounds.GetWidth(), bounds.GetHeight());
 
-  (this->*DrawFunction)(cmd, &cmd->vertices[0], &cmd->vertices[1], &cmd->vertices[2]);
-  if (rc.quad_polygon)
-    (this->*DrawFunction)(cmd, &cmd->vertices[2], &cmd->vertices[1], &cmd->vertices[3]);
+  if (m_workers.empty())
+    RasterizeCommand(cmd, m_drawing_area);
+  else
+    QueueDrawCommand(cmd, bounds);
 }
 
 void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
 {
-  const GPURenderCommand rc{cmd->rc.bits};
+  const Common::Rectangle<u32> bounds =
+    GetClippedBounds(cmd->x, cmd->y, cmd->x + static_cast<s32>(ZeroExtend32(cmd->width)),
+                     cmd->y + static_cast<s32>(ZeroExtend32(cmd->height)));
+  AddVRAMDirtyRect(bounds.left, bounds.top, bounds.GetWidth(), bounds.GetHeight());
 
-  const DrawRectangleFunction DrawFunction =
-    GetDrawRectangleFunction(rc.texture_enable, rc.raw_texture_enable, rc.transparency_enable);
-
-  (this->*DrawFunction)(cmd);
+  if (m_workers.empty())
+    RasterizeCommand(cmd, m_drawing_area);
+  else
+    QueueDrawCommand(cmd, bounds);
 }
 
 void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd)
 {
-  const DrawLineFunction DrawFunction =
-    GetDrawLineFunction(cmd->rc.shading_enable, cmd->rc.transparency_enable, cmd->IsDitheringEnabled());
+  // Positions are wrapped to 11 bits when plotting, and the stepping can land one pixel past either end.
+  s32 min_x = cmd->vertices[0].x, max_x = min_x, min_y = cmd->vertices[0].y, max_y = min_y;
+  for (u32 i = 1; i < cmd->num_vertices; i++)
+  {
+    min_x = std::min(min_x, cmd->vertices[i].x);
+    max_x = std::max(max_x, cmd->vertices[i].x);
+    min_y = std::min(min_y, cmd->vertices[i].y);
+    max_y = std::max(max_y, cmd->vertices[i].y);
+  }
+
+  const Common::Rectangle<u32> bounds = (min_x < 1 || max_x > 2046 || min_y < 1 || max_y > 2046) ?
+                                          GetClippedBounds(0, 0, VRAM_WIDTH, VRAM_HEIGHT) :
+                                          GetClippedBounds(min_x - 1, min_y - 1, max_x + 2, max_y + 2);
+  AddVRAMDirtyRect(bounds.left, bounds.top, bounds.GetWidth(), bounds.GetHeight());
+
+  if (m_workers.empty())
+    RasterizeCommand(cmd, m_drawing_area);
+  else
+    QueueDrawCommand(cmd, bounds);
+}
+
+static GPUTextureMode GetDrawTextureMode(const GPUBackendDrawCommand* cmd)
+{
+  if (!cmd->rc.texture_enable)
+    return GPUTextureMode::Disabled;
+
+  const GPUTextureMode texture_mode = cmd->draw_mode.texture_mode;
+  return cmd->rc.raw_texture_enable ? (texture_mode | GPUTextureMode::RawTextureBit) : texture_mode;
+}
+
+static GPUTransparencyMode GetDrawTransparencyMode(const GPUBackendDrawCommand* cmd)
+{
+  return cmd->rc.transparency_enable ? cmd->draw_mode.transparency_mode : GPUTransparencyMode::Disabled;
+}
 
-  for (u16 i = 1; i < cmd->num_vertices; i++)
-    (this->*DrawFunction)(cmd, &cmd->vertices[i - 1], &cmd->vertices[i]);
+void GPU_SW_Backend::RasterizeCommand(const GPUBackendCommand* cmd, const Common::Rectangle<u32>& area)
+{
+  // The upscaled copy goes first, so that it samples the same texels as the native draw.
+  if (m_upscale_shift > 0)
+  {
+    const u32 shift = m_upscale_shift;
+    const DrawTarget upscaled_target{
+      m_upscaled_vram.data(), VRAM_WIDTH << shift, shift,
+      Common::Rectangle<u32>(area.left << shift, area.top << shift, ((area.right + 1) << shift) - 1,
+                             ((area.bottom + 1) << shift) - 1)};
+    RasterizeCommandToTarget(cmd, upscaled_target);
+  }
+
+  RasterizeCommandToTarget(cmd, DrawTarget{m_vram, VRAM_WIDTH, 0, area});
+}
+
+void GPU_SW_Backend::RasterizeCommandToTarget(const GPUBackendCommand* cmd, const DrawTarget& target)
+{
+  switch (cmd->type)
+  {
+    case GPUBackendCommandType::DrawPolygon:
+    {
+      const GPUBackendDrawPolygonCommand* pcmd = static_cast<const GPUBackendDrawPolygonCommand*>(cmd);
+      const GPURenderCommand rc{pcmd->rc.bits};
+      const bool dithering_enable =
+        rc.IsDitheringEnabled() && pcmd->draw_mode.dither_enable && !rc.raw_texture_enable;
+
+      const DrawTriangleFunction DrawFunction = GetDrawTriangleFunction(
+        rc.shading_enable, GetDrawTextureMode(pcmd), GetDrawTransparencyMode(pcmd), dithering_enable);
+
+      // Scaling the vertices steps the edges and interpolants once per upscaled pixel.
+      const GPUBackendDrawPolygonCommand::Vertex* vertices = pcmd->vertices;
+      std::array<GPUBackendDrawPolygonCommand::Vertex, 4> scaled_vertices;
+      if (target.scale_shift > 0)
+      {
+        const s32 scale = static_cast<s32>(1u << target.scale_shift);
+        for (u32 i = 0; i < (rc.quad_polygon ? 4u : 3u); i++)
+        {
+          scaled_vertices[i] = pcmd->vertices[i];
+          scaled_vertices[i].x *= scale;
+          scaled_vertices[i].y *= scale;
+        }
+        vertices = scaled_vertices.data();
+      }
+
+      (this->*DrawFunction)(pcmd, target, &vertices[0], &vertices[1], &vertices[2]);
+      if (rc.quad_polygon)
+        (this->*DrawFunction)(pcmd, target, &vertices[2], &vertices[1], &vertices[3]);
+    }
+    break;
+
+    case GPUBackendCommandType::DrawRectangle:
+    {
+      const GPUBackendDrawRectangleCommand* rcmd = static_cast<const GPUBackendDrawRectangleCommand*>(cmd);
+      const DrawRectangleFunction DrawFunction =
+        GetDrawRectangleFunction(GetDrawTextureMode(rcmd), GetDrawTransparencyMode(rcmd));
+
+      (this->*DrawFunction)(rcmd, target);
+    }
+    break;
+
+    case GPUBackendCommandType::DrawLine:
+    {
+      const GPUBackendDrawLineCommand* lcmd = static_cast<const GPUBackendDrawLineCommand*>(cmd);
+      const DrawLineFunction DrawFunction =
+        GetDrawLineFunction(lcmd->rc.shading_enable, GetDrawTransparencyMode(lcmd), lcmd->IsDitheringEnabled());
+
+      for (u16 i = 1; i < lcmd->num_vertices; i++)
+        (this->*DrawFunction)(lcmd, target, &lcmd->vertices[i - 1], &lcmd->vertices[i]);
+    }
+    break;
+
+    default:
+      break;
+  }
 }
 
 constexpr GPU_SW_Backend::DitherLUT GPU_SW_Backend::ComputeDitherLUT()
@@ -79,51 +267,319 @@ constexpr GPU_SW_Backend::DitherLUT GPU_SW_Backend::ComputeDitherLUT()
 
 static constexpr GPU_SW_Backend::DitherLUT s_dither_lut = GPU_SW_Backend::ComputeDitherLUT();
 
-template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
-void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixel(const GPUBackendDrawCommand* cmd, u32 x, u32 y, u8 color_r,
-                                                      u8 color_g, u8 color_b, u8 texcoord_x, u8 texcoord_y)
+template<GPUTextureMode texture_mode>
+ALWAYS_INLINE_RELEASE u16 GPU_SW_Backend::SampleTexture(const GPUBackendDrawCommand* cmd, u8 texcoord_x,
+                                                        u8 texcoord_y) const
 {
-  VRAMPixel color;
+  static constexpr GPUTextureMode texture_format = texture_mode & ~GPUTextureMode::RawTextureBit;
+
+  // Apply texture window
+  texcoord_x = (texcoord_x & cmd->window.and_x) | cmd->window.or_x;
+  texcoord_y = (texcoord_y & cmd->window.and_y) | cmd->window.or_y;
+
+  if constexpr (texture_format == GPUTextureMode::Palette4Bit)
+  {
+    const u16 palette_value =
+      GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 4)) % VRAM_WIDTH,
+               (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
+    const u16 palette_index = (palette_value >> ((texcoord_x % 4) * 4)) & 0x0Fu;
+    return GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
+  }
+  else if constexpr (texture_format == GPUTextureMode::Palette8Bit)
+  {
+    const u16 palette_value =
+      GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 2)) % VRAM_WIDTH,
+               (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
+    const u16 palette_index = (palette_value >> ((texcoord_x % 2) * 8)) & 0xFFu;
+    return GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
+  }
+  else
+  {
+    return GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x)) % VRAM_WIDTH,
+                    (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
+  }
+}
+
+#if defined(CPU_X64) || defined(CPU_AARCH64)
+
+// Thin wrappers over 8x16-bit vectors, so the span shader below can be shared between SSE2 and NEON.
+#if defined(CPU_X64)
+using SpanVector = __m128i;
+ALWAYS_INLINE static SpanVector SpanLoad(const void* ptr)
+{
+  return _mm_loadu_si128(static_cast<const __m128i*>(ptr));
+}
+ALWAYS_INLINE static void SpanStore(void* ptr, SpanVector v)
+{
+  _mm_storeu_si128(static_cast<__m128i*>(ptr), v);
+}
+ALWAYS_INLINE static SpanVector SpanConstant(u16 v)
+{
+  return _mm_set1_epi16(static_cast<s16>(v));
+}
+ALWAYS_INLINE static SpanVector SpanAnd(SpanVector a, SpanVector b)
+{
+  return _mm_and_si128(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanOr(SpanVector a, SpanVector b)
+{
+  return _mm_or_si128(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanAdd(SpanVector a, SpanVector b)
+{
+  return _mm_add_epi16(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanSub(SpanVector a, SpanVector b)
+{
+  return _mm_sub_epi16(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanMul(SpanVector a, SpanVector b)
+{
+  return _mm_mullo_epi16(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanMin(SpanVector a, SpanVector b)
+{
+  return _mm_min_epi16(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanMax(SpanVector a, SpanVector b)
+{
+  return _mm_max_epi16(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanEqual(SpanVector a, SpanVector b)
+{
+  return _mm_cmpeq_epi16(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanSelect(SpanVector mask, SpanVector a, SpanVector b)
+{
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+template<int n>
+ALWAYS_INLINE static SpanVector SpanShiftLeft(SpanVector v)
+{
+  return _mm_slli_epi16(v, n);
+}
+template<int n>
+ALWAYS_INLINE static SpanVector SpanShiftRight(SpanVector v)
+{
+  return _mm_srli_epi16(v, n);
+}
+template<int n>
+ALWAYS_INLINE static SpanVector SpanShiftRightArithmetic(SpanVector v)
+{
+  return _mm_srai_epi16(v, n);
+}
+#elif defined(CPU_AARCH64)
+using SpanVector = uint16x8_t;
+ALWAYS_INLINE static SpanVector SpanLoad(const void* ptr)
+{
+  return vld1q_u16(static_cast<const u16*>(ptr));
+}
+ALWAYS_INLINE static void SpanStore(void* ptr, SpanVector v)
+{
+  vst1q_u16(static_cast<u16*>(ptr), v);
+}
+ALWAYS_INLINE static SpanVector SpanConstant(u16 v)
+{
+  return vdupq_n_u16(v);
+}
+ALWAYS_INLINE static SpanVector SpanAnd(SpanVector a, SpanVector b)
+{
+  return vandq_u16(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanOr(SpanVector a, SpanVector b)
+{
+  return vorrq_u16(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanAdd(SpanVector a, SpanVector b)
+{
+  return vaddq_u16(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanSub(SpanVector a, SpanVector b)
+{
+  return vsubq_u16(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanMul(SpanVector a, SpanVector b)
+{
+  return vmulq_u16(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanMin(SpanVector a, SpanVector b)
+{
+  return vreinterpretq_u16_s16(vminq_s16(vreinterpretq_s16_u16(a), vreinterpretq_s16_u16(b)));
+}
+ALWAYS_INLINE static SpanVector SpanMax(SpanVector a, SpanVector b)
+{
+  return vreinterpretq_u16_s16(vmaxq_s16(vreinterpretq_s16_u16(a), vreinterpretq_s16_u16(b)));
+}
+ALWAYS_INLINE static SpanVector SpanEqual(SpanVector a, SpanVector b)
+{
+  return vceqq_u16(a, b);
+}
+ALWAYS_INLINE static SpanVector SpanSelect(SpanVector mask, SpanVector a, SpanVector b)
+{
+  return vbslq_u16(mask, a, b);
+}
+template<int n>
+ALWAYS_INLINE static SpanVector SpanShiftLeft(SpanVector v)
+{
+  return vshlq_n_u16(v, n);
+}
+template<int n>
+ALWAYS_INLINE static SpanVector SpanShiftRight(SpanVector v)
+{
+  return vshrq_n_u16(v, n);
+}
+template<int n>
+ALWAYS_INLINE static SpanVector SpanShiftRightArithmetic(SpanVector v)
+{
+  return vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(v), n));
+}
+#endif
+
+/// Equivalent to the dither LUT: clamp((value + offset) >> 3, 0, 31).
+ALWAYS_INLINE static SpanVector SpanDither(SpanVector value, SpanVector offset)
+{
+  return SpanMin(SpanMax(SpanShiftRightArithmetic<3>(SpanAdd(value, offset)), SpanConstant(0)), SpanConstant(31));
+}
+
+/// Fills in the dither matrix offsets for pixels x..x+7 of row y. These repeat every 4 pixels, so stay valid while
+/// stepping x by 8.
+template<bool dithering_enable>
+ALWAYS_INLINE static void GetSpanDitherOffsets(s16* offsets, u32 x, u32 y)
+{
+  for (u32 i = 0; i < GPU_SW_Backend::SPAN_PIXELS; i++)
+    offsets[i] = dithering_enable ? static_cast<s16>(DITHER_MATRIX[y & 3u][(x + i) & 3u]) : 0;
+}
+
+/// Texels for a whole vector are fetched before any of its pixels are written, so rows which the texture page or
+/// palette also lives in have to be shaded one pixel at a time.
+template<bool texture_enable>
+ALWAYS_INLINE static bool CanShadeRowVectorized(const GPUBackendDrawCommand* cmd, u32 y)
+{
+  if constexpr (!texture_enable)
+    return true;
+
+  return ((y - cmd->draw_mode.GetTexturePageBaseY()) >= TEXTURE_PAGE_HEIGHT && y != cmd->palette.GetYBase());
+}
+
+template<GPUTextureMode texture_mode, GPUTransparencyMode transparency_mode, bool dithering_enable>
+void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixels8(const GPUBackendDrawCommand* cmd, const DrawTarget& target,
+                                                        u32 x, u32 y, const SpanPixels& pixels,
+                                                        const s16* dither_offsets)
+{
+  static constexpr bool texture_enable = (texture_mode != GPUTextureMode::Disabled);
+  static constexpr bool raw_texture_enable =
+    texture_enable && (texture_mode & GPUTextureMode::RawTextureBit) == GPUTextureMode::RawTextureBit;
+  static constexpr bool transparency_enable = (transparency_mode != GPUTransparencyMode::Disabled);
+
+  const SpanVector channel_mask = SpanConstant(0x1F);
+  const SpanVector transparent_bit = SpanConstant(0x8000);
+  u16* const dst_ptr = target.GetPixelPtr(x, y);
+
+  SpanVector color;
+  SpanVector write_mask = SpanConstant(0xFFFF);
   if constexpr (texture_enable)
   {
-    // Apply texture window
-    texcoord_x = (texcoord_x & cmd->window.and_x) | cmd->window.or_x;
-    texcoord_y = (texcoord_y & cmd->window.and_y) | cmd->window.or_y;
+    const SpanVector texture_color = SpanLoad(pixels.texel);
+    write_mask = SpanSelect(SpanEqual(texture_color, SpanConstant(0)), SpanConstant(0), write_mask);
 
-    VRAMPixel texture_color;
-    switch (cmd->draw_mode.texture_mode)
+    if constexpr (raw_texture_enable)
     {
-      case GPUTextureMode::Palette4Bit:
-      {
-        const u16 palette_value =
-          GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 4)) % VRAM_WIDTH,
-                   (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
-        const u16 palette_index = (palette_value >> ((texcoord_x % 4) * 4)) & 0x0Fu;
-
-        texture_color.bits =
-          GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
-      }
-      break;
+      color = texture_color;
+    }
+    else
+    {
+      const SpanVector offset = SpanLoad(dither_offsets);
+      const SpanVector tr = SpanAnd(texture_color, channel_mask);
+      const SpanVector tg = SpanAnd(SpanShiftRight<5>(texture_color), channel_mask);
+      const SpanVector tb = SpanAnd(SpanShiftRight<10>(texture_color), channel_mask);
+      color = SpanOr(
+        SpanOr(SpanDither(SpanShiftRight<4>(SpanMul(tr, SpanLoad(pixels.r))), offset),
+               SpanShiftLeft<5>(SpanDither(SpanShiftRight<4>(SpanMul(tg, SpanLoad(pixels.g))), offset))),
+        SpanOr(SpanShiftLeft<10>(SpanDither(SpanShiftRight<4>(SpanMul(tb, SpanLoad(pixels.b))), offset)),
+               SpanAnd(texture_color, transparent_bit)));
+    }
+  }
+  else
+  {
+    const SpanVector offset = SpanLoad(dither_offsets);
+    color = SpanOr(SpanOr(SpanDither(SpanLoad(pixels.r), offset),
+                          SpanShiftLeft<5>(SpanDither(SpanLoad(pixels.g), offset))),
+                   SpanShiftLeft<10>(SpanDither(SpanLoad(pixels.b), offset)));
+  }
 
-      case GPUTextureMode::Palette8Bit:
-      {
-        const u16 palette_value =
-          GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 2)) % VRAM_WIDTH,
-                   (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
-        const u16 palette_index = (palette_value >> ((texcoord_x % 2) * 8)) & 0xFFu;
-        texture_color.bits =
-          GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
-      }
-      break;
+  const SpanVector bg_color = SpanLoad(dst_ptr);
+  if constexpr (transparency_enable)
+  {
+    // Per-channel form of the packed math in ShadePixel(), which matches it whenever the foreground has bit 15 set.
+    const SpanVector fr = SpanAnd(color, channel_mask);
+    const SpanVector fg = SpanAnd(SpanShiftRight<5>(color), channel_mask);
+    const SpanVector fb = SpanAnd(SpanShiftRight<10>(color), channel_mask);
+    const SpanVector br = SpanAnd(bg_color, channel_mask);
+    const SpanVector bg = SpanAnd(SpanShiftRight<5>(bg_color), channel_mask);
+    const SpanVector bb = SpanAnd(SpanShiftRight<10>(bg_color), channel_mask);
+
+    SpanVector rr, rg, rb;
+    if constexpr (transparency_mode == GPUTransparencyMode::HalfBackgroundPlusHalfForeground)
+    {
+      rr = SpanShiftRight<1>(SpanAdd(br, fr));
+      rg = SpanShiftRight<1>(SpanAdd(bg, fg));
+      rb = SpanShiftRight<1>(SpanAdd(bb, fb));
+    }
+    else if constexpr (transparency_mode == GPUTransparencyMode::BackgroundPlusForeground)
+    {
+      rr = SpanMin(SpanAdd(br, fr), channel_mask);
+      rg = SpanMin(SpanAdd(bg, fg), channel_mask);
+      rb = SpanMin(SpanAdd(bb, fb), channel_mask);
+    }
+    else if constexpr (transparency_mode == GPUTransparencyMode::BackgroundMinusForeground)
+    {
+      rr = SpanMax(SpanSub(br, fr), SpanConstant(0));
+      rg = SpanMax(SpanSub(bg, fg), SpanConstant(0));
+      rb = SpanMax(SpanSub(bb, fb), SpanConstant(0));
+    }
+    else
+    {
+      rr = SpanMin(SpanAdd(br, SpanShiftRight<2>(fr)), channel_mask);
+      rg = SpanMin(SpanAdd(bg, SpanShiftRight<2>(fg)), channel_mask);
+      rb = SpanMin(SpanAdd(bb, SpanShiftRight<2>(fb)), channel_mask);
+    }
 
-      default:
-      {
-        texture_color.bits = GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x)) % VRAM_WIDTH,
-                                      (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
-      }
-      break;
+    const SpanVector blended = SpanOr(SpanOr(rr, SpanShiftLeft<5>(rg)), SpanShiftLeft<10>(rb));
+    if constexpr (texture_enable)
+    {
+      // Only texels with bit 15 set are blended, and they keep it.
+      color = SpanSelect(SpanShiftRightArithmetic<15>(color), SpanOr(blended, transparent_bit), color);
     }
+    else
+    {
+      // Non-textured transparent polygons don't set bit 15.
+      color = blended;
+    }
+  }
+
+  const SpanVector mask_and = SpanConstant(cmd->params.GetMaskAND());
+  write_mask = SpanAnd(write_mask, SpanEqual(SpanAnd(bg_color, mask_and), SpanConstant(0)));
+  color = SpanOr(color, SpanConstant(cmd->params.GetMaskOR()));
+  SpanStore(dst_ptr, SpanSelect(write_mask, color, bg_color));
+}
+
+#endif
 
+template<GPUTextureMode texture_mode, GPUTransparencyMode transparency_mode, bool dithering_enable>
+void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixel(const GPUBackendDrawCommand* cmd, const DrawTarget& target,
+                                                      u32 x, u32 y, u8 color_r, u8 color_g, u8 color_b,
+                                                      u8 texcoord_x, u8 texcoord_y)
+{
+  static constexpr bool texture_enable = (texture_mode != GPUTextureMode::Disabled);
+  static constexpr bool raw_texture_enable =
+    texture_enable && (texture_mode & GPUTextureMode::RawTextureBit) == GPUTextureMode::RawTextureBit;
+  static constexpr bool transparency_enable = (transparency_mode != GPUTransparencyMode::Disabled);
+
+  VRAMPixel color;
+  if constexpr (texture_enable)
+  {
+    VRAMPixel texture_color;
+    texture_color.bits = SampleTexture<texture_mode>(cmd, texcoord_x, texcoord_y);
     if (texture_color.bits == 0)
       return;
 
@@ -153,7 +609,8 @@ void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixel(const GPUBackendDrawComman
                  (ZeroExtend16(s_dither_lut[dither_y][dither_x][color_b]) << 10) | (transparency_enable ? 0x8000u : 0);
   }
 
-  const VRAMPixel bg_color{GetPixel(static_cast<u32>(x), static_cast<u32>(y))};
+  u16* const dst_ptr = target.GetPixelPtr(x, y);
+  const VRAMPixel bg_color{*dst_ptr};
   if constexpr (transparency_enable)
   {
     if (color.bits & 0x8000u || !texture_enable)
@@ -161,49 +618,39 @@ void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixel(const GPUBackendDrawComman
       // Based on blargg's efficient 15bpp pixel math.
       u32 bg_bits = ZeroExtend32(bg_color.bits);
       u32 fg_bits = ZeroExtend32(color.bits);
-      switch (cmd->draw_mode.transparency_mode)
+      if constexpr (transparency_mode == GPUTransparencyMode::HalfBackgroundPlusHalfForeground)
       {
-        case GPUTransparencyMode::HalfBackgroundPlusHalfForeground:
-        {
-          bg_bits |= 0x8000u;
-          color.bits = Truncate16(((fg_bits + bg_bits) - ((fg_bits ^ bg_bits) & 0x0421u)) >> 1);
-        }
-        break;
-
-        case GPUTransparencyMode::BackgroundPlusForeground:
-        {
-          bg_bits &= ~0x8000u;
-
-          const u32 sum = fg_bits + bg_bits;
-          const u32 carry = (sum - ((fg_bits ^ bg_bits) & 0x8421u)) & 0x8420u;
-
-          color.bits = Truncate16((sum - carry) | (carry - (carry >> 5)));
-        }
-        break;
+        bg_bits |= 0x8000u;
+        color.bits = Truncate16(((fg_bits + bg_bits) - ((fg_bits ^ bg_bits) & 0x0421u)) >> 1);
+      }
+      else if constexpr (transparency_mode == GPUTransparencyMode::BackgroundPlusForeground)
+      {
+        bg_bits &= ~0x8000u;
 
-        case GPUTransparencyMode::BackgroundMinusForeground:
-        {
-          bg_bits |= 0x8000u;
-          fg_bits &= ~0x8000u;
+        const u32 sum = fg_bits + bg_bits;
+        const u32 carry = (sum - ((fg_bits ^ bg_bits) & 0x8421u)) & 0x8420u;
 
-          const u32 diff = bg_bits - fg_bits + 0x108420u;
-          const u32 borrow = (diff - ((bg_bits ^ fg_bits) & 0x108420u)) & 0x108420u;
+        color.bits = Truncate16((sum - carry) | (carry - (carry >> 5)));
+      }
+      else if constexpr (transparency_mode == GPUTransparencyMode::BackgroundMinusForeground)
+      {
+        bg_bits |= 0x8000u;
+        fg_bits &= ~0x8000u;
 
-          color.bits = Truncate16((diff - borrow) & (borrow - (borrow >> 5)));
-        }
-        break;
+        const u32 diff = bg_bits - fg_bits + 0x108420u;
+        const u32 borrow = (diff - ((bg_bits ^ fg_bits) & 0x108420u)) & 0x108420u;
 
-        case GPUTransparencyMode::BackgroundPlusQuarterForeground:
-        {
-          bg_bits &= ~0x8000u;
-          fg_bits = ((fg_bits >> 2) & 0x1CE7u) | 0x8000u;
+        color.bits = Truncate16((diff - borrow) & (borrow - (borrow >> 5)));
+      }
+      else if constexpr (transparency_mode == GPUTransparencyMode::BackgroundPlusQuarterForeground)
+      {
+        bg_bits &= ~0x8000u;
+        fg_bits = ((fg_bits >> 2) & 0x1CE7u) | 0x8000u;
 
-          const u32 sum = fg_bits + bg_bits;
-          const u32 carry = (sum - ((fg_bits ^ bg_bits) & 0x8421u)) & 0x8420u;
+        const u32 sum = fg_bits + bg_bits;
+        const u32 carry = (sum - ((fg_bits ^ bg_bits) & 0x8421u)) & 0x8420u;
 
-          color.bits = Truncate16((sum - carry) | (carry - (carry >> 5)));
-        }
-        break;
+        color.bits = Truncate16((sum - carry) | (carry - (carry >> 5)));
       }
 
       // See above.
@@ -216,38 +663,83 @@ void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixel(const GPUBackendDrawComman
   if ((bg_color.bits & mask_and) != 0)
     return;
 
-  SetPixel(static_cast<u32>(x), static_cast<u32>(y), color.bits | cmd->params.GetMaskOR());
+  *dst_ptr = color.bits | cmd->params.GetMaskOR();
 }
 
-template<bool texture_enable, bool raw_texture_enable, bool transparency_enable>
-void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
+template<GPUTextureMode texture_mode, GPUTransparencyMode transparency_mode>
+void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd, const DrawTarget& target)
 {
-  const s32 origin_x = cmd->x;
-  const s32 origin_y = cmd->y;
+  static constexpr bool texture_enable = (texture_mode != GPUTextureMode::Disabled);
+
+  // Rectangles aren't interpolated, so upscaling only repeats each texel.
+  const u32 shift = target.scale_shift;
+  const Common::Rectangle<u32>& area = target.area;
+  const s32 origin_x = cmd->x * static_cast<s32>(1u << shift);
+  const s32 origin_y = cmd->y * static_cast<s32>(1u << shift);
+  const u32 width = ZeroExtend32(cmd->width) << shift;
+  const u32 height = ZeroExtend32(cmd->height) << shift;
   const auto [r, g, b] = UnpackColorRGB24(cmd->color);
   const auto [origin_texcoord_x, origin_texcoord_y] = UnpackTexcoord(cmd->texcoord);
 
-  for (u32 offset_y = 0; offset_y < cmd->height; offset_y++)
+  for (u32 offset_y = 0; offset_y < height; offset_y++)
   {
     const s32 y = origin_y + static_cast<s32>(offset_y);
-    if (y < static_cast<s32>(m_drawing_area.top) || y > static_cast<s32>(m_drawing_area.bottom) ||
-        (cmd->params.interlaced_rendering && cmd->params.active_line_lsb == (Truncate8(static_cast<u32>(y)) & 1u)))
+    if (y < static_cast<s32>(area.top) || y > static_cast<s32>(area.bottom) ||
+        (cmd->params.interlaced_rendering &&
+         cmd->params.active_line_lsb == (Truncate8(static_cast<u32>(y) >> shift) & 1u)))
     {
       continue;
     }
 
-    const u8 texcoord_y = Truncate8(ZeroExtend32(origin_texcoord_y) + offset_y);
+    const u8 texcoord_y = Truncate8(ZeroExtend32(origin_texcoord_y) + (offset_y >> shift));
+    u32 offset_x = 0;
+
+#if defined(CPU_X64) || defined(CPU_AARCH64)
+    if (shift > 0 || CanShadeRowVectorized<texture_enable>(cmd, static_cast<u32>(y)))
+    {
+      const u32 start_x = static_cast<u32>(std::max<s32>(static_cast<s32>(area.left) - origin_x, 0));
+      const u32 end_x = static_cast<u32>(
+        std::clamp<s32>(static_cast<s32>(area.right) + 1 - origin_x, 0, static_cast<s32>(width)));
+      if (start_x < end_x && (end_x - start_x) >= SPAN_PIXELS)
+      {
+        alignas(16) s16 dither_offsets[SPAN_PIXELS];
+        GetSpanDitherOffsets<false>(dither_offsets, 0, 0);
+
+        SpanPixels pixels;
+        std::fill_n(pixels.r, SPAN_PIXELS, r);
+        std::fill_n(pixels.g, SPAN_PIXELS, g);
+        std::fill_n(pixels.b, SPAN_PIXELS, b);
+
+        // Columns before start_x are outside the drawing area, so the loop below only has to pick up the remainder.
+        for (offset_x = start_x; (end_x - offset_x) >= SPAN_PIXELS; offset_x += SPAN_PIXELS)
+        {
+          if constexpr (texture_enable)
+          {
+            for (u32 i = 0; i < SPAN_PIXELS; i++)
+            {
+              pixels.texel[i] = SampleTexture<texture_mode>(
+                cmd, Truncate8(ZeroExtend32(origin_texcoord_x) + ((offset_x + i) >> shift)), texcoord_y);
+            }
+          }
+
+          ShadePixels8<texture_mode, transparency_mode, false>(
+            cmd, target, static_cast<u32>(origin_x + static_cast<s32>(offset_x)), static_cast<u32>(y), pixels,
+            dither_offsets);
+        }
+      }
+    }
+#endif
 
-    for (u32 offset_x = 0; offset_x < cmd->width; offset_x++)
+    for (; offset_x < width; offset_x++)
     {
       const s32 x = origin_x + static_cast<s32>(offset_x);
-      if (x < static_cast<s32>(m_drawing_area.left) || x > static_cast<s32>(m_drawing_area.right))
+      if (x < static_cast<s32>(area.left) || x > static_cast<s32>(area.right))
         continue;
 
-      const u8 texcoord_x = Truncate8(ZeroExtend32(origin_texcoord_x) + offset_x);
+      const u8 texcoord_x = Truncate8(ZeroExtend32(origin_texcoord_x) + (offset_x >> shift));
 
-      ShadePixel<texture_enable, raw_texture_enable, transparency_enable, false>(
-        cmd, static_cast<u32>(x), static_cast<u32>(y), r, g, b, texcoord_x, texcoord_y);
+      ShadePixel<texture_mode, transparency_mode, false>(cmd, target, static_cast<u32>(x), static_cast<u32>(y), r, g,
+                                                         b, texcoord_x, texcoord_y);
     }
   }
 }
@@ -286,6 +778,13 @@ static ALWAYS_INLINE_RELEASE s32 GetPolyXFP_Int(s64 xfp)
   return (xfp >> 32);
 }
 
+/// Equivalent of TruncateGPUVertexPosition() for coordinates which have been multiplied by (1 << scale_shift).
+static ALWAYS_INLINE_RELEASE s32 TruncateScaledVertexPosition(s32 x, u32 scale_shift)
+{
+  const u32 unused_bits = 32 - 11 - scale_shift;
+  return static_cast<s32>(static_cast<u32>(x) << unused_bits) >> unused_bits;
+}
+
 template<bool shading_enable, bool texture_enable>
 bool ALWAYS_INLINE_RELEASE GPU_SW_Backend::CalcIDeltas(i_deltas& idl, const GPUBackendDrawPolygonCommand::Vertex* A,
                                                        const GPUBackendDrawPolygonCommand::Vertex* B,
@@ -293,6 +792,8 @@ bool ALWAYS_INLINE_RELEASE GPU_SW_Backend::CalcIDeltas(i_deltas& idl, const GPUB
 {
 #define CALCIS(x, y) (((B->x - A->x) * (C->y - B->y)) - ((C->x - B->x) * (B->y - A->y)))
 
+  // The gradients are computed in 64 bits, since the numerators overflow with upscaled coordinates.
+
   s32 denom = CALCIS(x, y);
 
   if (!denom)
@@ -300,23 +801,23 @@ bool ALWAYS_INLINE_RELEASE GPU_SW_Backend::CalcIDeltas(i_deltas& idl, const GPUB
 
   if constexpr (shading_enable)
   {
-    idl.dr_dx = (u32)(CALCIS(r, y) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
-    idl.dr_dy = (u32)(CALCIS(x, r) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
+    idl.dr_dx = (u32)(static_cast<s64>(CALCIS(r, y)) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
+    idl.dr_dy = (u32)(static_cast<s64>(CALCIS(x, r)) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
 
-    idl.dg_dx = (u32)(CALCIS(g, y) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
-    idl.dg_dy = (u32)(CALCIS(x, g) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
+    idl.dg_dx = (u32)(static_cast<s64>(CALCIS(g, y)) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
+    idl.dg_dy = (u32)(static_cast<s64>(CALCIS(x, g)) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
 
-    idl.db_dx = (u32)(CALCIS(b, y) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
-    idl.db_dy = (u32)(CALCIS(x, b) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
+    idl.db_dx = (u32)(static_cast<s64>(CALCIS(b, y)) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
+    idl.db_dy = (u32)(static_cast<s64>(CALCIS(x, b)) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
   }
 
   if constexpr (texture_enable)
   {
-    idl.du_dx = (u32)(CALCIS(u, y) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
-    idl.du_dy = (u32)(CALCIS(x, u) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
+    idl.du_dx = (u32)(static_cast<s64>(CALCIS(u, y)) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
+    idl.du_dy = (u32)(static_cast<s64>(CALCIS(x, u)) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
 
-    idl.dv_dx = (u32)(CALCIS(v, y) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
-    idl.dv_dy = (u32)(CALCIS(x, v) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
+    idl.dv_dx = (u32)(static_cast<s64>(CALCIS(v, y)) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
+    idl.dv_dy = (u32)(static_cast<s64>(CALCIS(x, v)) * (1 << COORD_FBS) / denom) << COORD_POST_PADDING;
   }
 
   return true;
@@ -358,28 +859,34 @@ void ALWAYS_INLINE_RELEASE GPU_SW_Backend::AddIDeltas_DY(i_group& ig, const i_de
   }
 }
 
-template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
+template<bool shading_enable, GPUTextureMode texture_mode, GPUTransparencyMode transparency_mode,
          bool dithering_enable>
-void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s32 x_start, s32 x_bound, i_group ig,
-                              const i_deltas& idl)
+void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, const DrawTarget& target, s32 y,
+                              s32 x_start, s32 x_bound, i_group ig, const i_deltas& idl)
 {
-  if (cmd->params.interlaced_rendering && cmd->params.active_line_lsb == (Truncate8(static_cast<u32>(y)) & 1u))
+  static constexpr bool texture_enable = (texture_mode != GPUTextureMode::Disabled);
+
+  if (cmd->params.interlaced_rendering &&
+      cmd->params.active_line_lsb == (Truncate8(static_cast<u32>(y) >> target.scale_shift) & 1u))
+  {
     return;
+  }
 
+  const Common::Rectangle<u32>& area = target.area;
   s32 x_ig_adjust = x_start;
   s32 w = x_bound - x_start;
-  s32 x = TruncateGPUVertexPosition(x_start);
+  s32 x = TruncateScaledVertexPosition(x_start, target.scale_shift);
 
-  if (x < static_cast<s32>(m_drawing_area.left))
+  if (x < static_cast<s32>(area.left))
   {
-    s32 delta = static_cast<s32>(m_drawing_area.left) - x;
+    s32 delta = static_cast<s32>(area.left) - x;
     x_ig_adjust += delta;
     x += delta;
     w -= delta;
   }
 
-  if ((x + w) > (static_cast<s32>(m_drawing_area.right) + 1))
-    w = static_cast<s32>(m_drawing_area.right) + 1 - x;
+  if ((x + w) > (static_cast<s32>(area.right) + 1))
+    w = static_cast<s32>(area.right) + 1 - x;
 
   if (w <= 0)
     return;
@@ -387,6 +894,42 @@ void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s3
   AddIDeltas_DX<shading_enable, texture_enable>(ig, idl, x_ig_adjust);
   AddIDeltas_DY<shading_enable, texture_enable>(ig, idl, y);
 
+#if defined(CPU_X64) || defined(CPU_AARCH64)
+  if (w >= static_cast<s32>(SPAN_PIXELS) &&
+      (target.scale_shift > 0 || CanShadeRowVectorized<texture_enable>(cmd, static_cast<u32>(y))))
+  {
+    alignas(16) s16 dither_offsets[SPAN_PIXELS];
+    GetSpanDitherOffsets<dithering_enable>(dither_offsets, static_cast<u32>(x), static_cast<u32>(y));
+
+    SpanPixels pixels;
+    do
+    {
+      for (u32 i = 0; i < SPAN_PIXELS; i++)
+      {
+        pixels.r[i] = Truncate8(ig.r >> (COORD_FBS + COORD_POST_PADDING));
+        pixels.g[i] = Truncate8(ig.g >> (COORD_FBS + COORD_POST_PADDING));
+        pixels.b[i] = Truncate8(ig.b >> (COORD_FBS + COORD_POST_PADDING));
+        if constexpr (texture_enable)
+        {
+          pixels.texel[i] = SampleTexture<texture_mode>(cmd, Truncate8(ig.u >> (COORD_FBS + COORD_POST_PADDING)),
+                                          Truncate8(ig.v >> (COORD_FBS + COORD_POST_PADDING)));
+        }
+
+        AddIDeltas_DX<shading_enable, texture_enable>(ig, idl);
+      }
+
+      ShadePixels8<texture_mode, transparency_mode, dithering_enable>(
+        cmd, target, static_cast<u32>(x), static_cast<u32>(y), pixels, dither_offsets);
+
+      x += SPAN_PIXELS;
+      w -= SPAN_PIXELS;
+    } while (w >= static_cast<s32>(SPAN_PIXELS));
+
+    if (w == 0)
+      return;
+  }
+#endif
+
   do
   {
     const u32 r = ig.r >> (COORD_FBS + COORD_POST_PADDING);
@@ -395,8 +938,8 @@ void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s3
     const u32 u = ig.u >> (COORD_FBS + COORD_POST_PADDING);
     const u32 v = ig.v >> (COORD_FBS + COORD_POST_PADDING);
 
-    ShadePixel<texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
-      cmd, static_cast<u32>(x), static_cast<u32>(y), Truncate8(r), Truncate8(g), Truncate8(b), Truncate8(u),
+    ShadePixel<texture_mode, transparency_mode, dithering_enable>(
+      cmd, target, static_cast<u32>(x), static_cast<u32>(y), Truncate8(r), Truncate8(g), Truncate8(b), Truncate8(u),
       Truncate8(v));
 
     x++;
@@ -404,13 +947,15 @@ void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s3
   } while (--w > 0);
 }
 
-template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
+template<bool shading_enable, GPUTextureMode texture_mode, GPUTransparencyMode transparency_mode,
          bool dithering_enable>
-void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd,
+void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, const DrawTarget& target,
                                   const GPUBackendDrawPolygonCommand::Vertex* v0,
                                   const GPUBackendDrawPolygonCommand::Vertex* v1,
                                   const GPUBackendDrawPolygonCommand::Vertex* v2)
 {
+  static constexpr bool texture_enable = (texture_mode != GPUTextureMode::Disabled);
+
   u32 core_vertex;
   {
     u32 cvtemp = 0;
@@ -451,10 +996,11 @@ void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd,
   if (v0->y == v2->y)
     return;
 
-  if (static_cast<u32>(std::abs(v2->x - v0->x)) >= MAX_PRIMITIVE_WIDTH ||
-      static_cast<u32>(std::abs(v2->x - v1->x)) >= MAX_PRIMITIVE_WIDTH ||
-      static_cast<u32>(std::abs(v1->x - v0->x)) >= MAX_PRIMITIVE_WIDTH ||
-      static_cast<u32>(v2->y - v0->y) >= MAX_PRIMITIVE_HEIGHT)
+  const u32 max_width = MAX_PRIMITIVE_WIDTH << target.scale_shift;
+  const u32 max_height = MAX_PRIMITIVE_HEIGHT << target.scale_shift;
+  if (static_cast<u32>(std::abs(v2->x - v0->x)) >= max_width ||
+      static_cast<u32>(std::abs(v2->x - v1->x)) >= max_width ||
+      static_cast<u32>(std::abs(v1->x - v0->x)) >= max_width || static_cast<u32>(v2->y - v0->y) >= max_height)
   {
     return;
   }
@@ -562,32 +1108,32 @@ void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd,
         lc -= ls;
         rc -= rs;
 
-        s32 y = TruncateGPUVertexPosition(yi);
+        s32 y = TruncateScaledVertexPosition(yi, target.scale_shift);
 
-        if (y < static_cast<s32>(m_drawing_area.top))
+        if (y < static_cast<s32>(target.area.top))
           break;
 
-        if (y > static_cast<s32>(m_drawing_area.bottom))
+        if (y > static_cast<s32>(target.area.bottom))
           continue;
 
-        DrawSpan<shading_enable, texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
-          cmd, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
+        DrawSpan<shading_enable, texture_mode, transparency_mode, dithering_enable>(
+          cmd, target, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
       }
     }
     else
     {
       while (yi < yb)
       {
-        s32 y = TruncateGPUVertexPosition(yi);
+        s32 y = TruncateScaledVertexPosition(yi, target.scale_shift);
 
-        if (y > static_cast<s32>(m_drawing_area.bottom))
+        if (y > static_cast<s32>(target.area.bottom))
           break;
 
-        if (y >= static_cast<s32>(m_drawing_area.top))
+        if (y >= static_cast<s32>(target.area.top))
         {
 
-          DrawSpan<shading_enable, texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
-            cmd, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
+          DrawSpan<shading_enable, texture_mode, transparency_mode, dithering_enable>(
+            cmd, target, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
         }
 
         yi++;
@@ -631,10 +1177,14 @@ static ALWAYS_INLINE_RELEASE s64 LineDivide(s64 delta, s32 dk)
   return (delta / dk);
 }
 
-template<bool shading_enable, bool transparency_enable, bool dithering_enable>
-void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, const GPUBackendDrawLineCommand::Vertex* p0,
-                              const GPUBackendDrawLineCommand::Vertex* p1)
+template<bool shading_enable, GPUTransparencyMode transparency_mode, bool dithering_enable>
+void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, const DrawTarget& target,
+                              const GPUBackendDrawLineCommand::Vertex* p0, const GPUBackendDrawLineCommand::Vertex* p1)
 {
+  // Lines are stepped at native resolution, and each pixel is drawn as a block in the upscaled copy.
+  const u32 shift = target.scale_shift;
+  const u32 scale = 1u << shift;
+  const Common::Rectangle<u32>& area = target.area;
   const s32 i_dx = std::abs(p1->x - p0->x);
   const s32 i_dy = std::abs(p1->y - p0->y);
   const s32 k = (i_dx > i_dy) ? i_dx : i_dy;
@@ -692,16 +1242,23 @@ void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, const GPUBac
     const s32 x = (cur_point.x >> Line_XY_FractBits) & 2047;
     const s32 y = (cur_point.y >> Line_XY_FractBits) & 2047;
 
+    const u32 target_x = static_cast<u32>(x) << shift;
+    const u32 target_y = static_cast<u32>(y) << shift;
     if ((!cmd->params.interlaced_rendering || cmd->params.active_line_lsb != (Truncate8(static_cast<u32>(y)) & 1u)) &&
-        x >= static_cast<s32>(m_drawing_area.left) && x <= static_cast<s32>(m_drawing_area.right) &&
-        y >= static_cast<s32>(m_drawing_area.top) && y <= static_cast<s32>(m_drawing_area.bottom))
+        target_x >= area.left && target_x <= area.right && target_y >= area.top && target_y <= area.bottom)
     {
       const u8 r = shading_enable ? static_cast<u8>(cur_point.r >> Line_RGB_FractBits) : p0->r;
       const u8 g = shading_enable ? static_cast<u8>(cur_point.g >> Line_RGB_FractBits) : p0->g;
       const u8 b = shading_enable ? static_cast<u8>(cur_point.b >> Line_RGB_FractBits) : p0->b;
 
-      ShadePixel<false, false, transparency_enable, dithering_enable>(cmd, static_cast<u32>(x), static_cast<u32>(y), r,
-                                                                      g, b, 0, 0);
+      for (u32 block_y = 0; block_y < scale; block_y++)
+      {
+        for (u32 block_x = 0; block_x < scale; block_x++)
+        {
+          ShadePixel<GPUTextureMode::Disabled, transparency_mode, dithering_enable>(
+            cmd, target, target_x + block_x, target_y + block_y, r, g, b, 0, 0);
+        }
+      }
     }
 
     cur_point.x += step.dx_dk;
@@ -718,7 +1275,12 @@ void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, const GPUBac
 
 void GPU_SW_Backend::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color, GPUBackendCommandParameters params)
 {
+  AddVRAMDirtyRect(x, y, width, height);
+
   const u16 color16 = VRAMRGBA8888ToRGBA5551(color);
+  if (m_upscale_shift > 0)
+    FillUpscaledVRAM(x, y, width, height, color16, params);
+
   if ((x + width) <= VRAM_WIDTH && !params.interlaced_rendering)
   {
     for (u32 yoffs = 0; yoffs < height; yoffs++)
@@ -763,6 +1325,8 @@ void GPU_SW_Backend::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color, GP
 void GPU_SW_Backend::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data,
                                 GPUBackendCommandParameters params)
 {
+  AddVRAMDirtyRect(x, y, width, height);
+
   // Fast path when the copy is not oversized.
   if ((x + width) <= VRAM_WIDTH && (y + height) <= VRAM_HEIGHT && !params.IsMaskingEnabled())
   {
@@ -794,11 +1358,16 @@ void GPU_SW_Backend::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void*
       }
     }
   }
+
+  if (m_upscale_shift > 0)
+    UpscaleVRAMRegion(x, y, width, height);
 }
 
 void GPU_SW_Backend::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height,
                               GPUBackendCommandParameters params)
 {
+  AddVRAMDirtyRect(dst_x, dst_y, width, height);
+
   // Break up oversized copies. This behavior has not been verified on console.
   if ((src_x + width) > VRAM_WIDTH || (dst_x + width) > VRAM_WIDTH)
   {
@@ -831,6 +1400,10 @@ void GPU_SW_Backend::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 wi
     return;
   }
 
+  // The upscaled copy checks the mask against native VRAM, so it has to be done before that is modified.
+  if (m_upscale_shift > 0)
+    CopyUpscaledVRAM(src_x, src_y, dst_x, dst_y, width, height, params);
+
   // This doesn't have a fast path, but do we really need one? It's not common.
   const u16 mask_and = params.GetMaskAND();
   const u16 mask_or = params.GetMaskOR();
@@ -870,73 +1443,405 @@ void GPU_SW_Backend::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 wi
   }
 }
 
-void GPU_SW_Backend::FlushRender() {}
+void GPU_SW_Backend::SetUpscaleShift(u32 shift)
+{
+  shift = std::min(shift, MAX_UPSCALE_SHIFT);
+  if (m_upscale_shift == shift)
+    return;
+
+  m_upscale_shift = shift;
+  if (shift == 0)
+  {
+    m_upscaled_vram = {};
+    return;
+  }
+
+  // Save states only contain native VRAM, and are loaded through UpdateVRAM(), so this is only needed on changes.
+  m_upscaled_vram.resize((VRAM_WIDTH << shift) * (VRAM_HEIGHT << shift));
+  UpscaleVRAMRegion(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+  Log_InfoPrintf("Software renderer upscaling to %ux%u.", VRAM_WIDTH << shift, VRAM_HEIGHT << shift);
+}
+
+void GPU_SW_Backend::UpscaleVRAMRegion(u32 x, u32 y, u32 width, u32 height)
+{
+  const u32 shift = m_upscale_shift;
+  const u32 scale = 1u << shift;
+  const u32 pitch = VRAM_WIDTH << shift;
+  width = std::min<u32>(width, VRAM_WIDTH);
+  height = std::min<u32>(height, VRAM_HEIGHT);
+
+  for (u32 yoffs = 0; yoffs < height; yoffs++)
+  {
+    const u32 row = (y + yoffs) % VRAM_HEIGHT;
+    const u16* src_row_ptr = &m_vram[row * VRAM_WIDTH];
+    u16* dst_row_ptr = &m_upscaled_vram[(row << shift) * pitch];
+    for (u32 xoffs = 0; xoffs < width; xoffs++)
+    {
+      const u32 col = (x + xoffs) % VRAM_WIDTH;
+      std::fill_n(&dst_row_ptr[col << shift], scale, src_row_ptr[col]);
+    }
+
+    // Rows within a block are identical, so copy the whole run when it doesn't wrap.
+    for (u32 i = 1; i < scale; i++)
+    {
+      u16* dst_block_row_ptr = dst_row_ptr + (i * pitch);
+      if ((x + width) <= VRAM_WIDTH)
+      {
+        std::copy_n(&dst_row_ptr[x << shift], width << shift, &dst_block_row_ptr[x << shift]);
+      }
+      else
+      {
+        std::copy_n(&dst_row_ptr[x << shift], (VRAM_WIDTH - x) << shift, &dst_block_row_ptr[x << shift]);
+        std::copy_n(dst_row_ptr, (x + width - VRAM_WIDTH) << shift, dst_block_row_ptr);
+      }
+    }
+  }
+}
+
+void GPU_SW_Backend::FillUpscaledVRAM(u32 x, u32 y, u32 width, u32 height, u16 color,
+                                      GPUBackendCommandParameters params)
+{
+  const u32 shift = m_upscale_shift;
+  const u32 pitch = VRAM_WIDTH << shift;
+  for (u32 yoffs = 0; yoffs < height; yoffs++)
+  {
+    const u32 row = (y + yoffs) % VRAM_HEIGHT;
+    if (params.interlaced_rendering && (row & u32(1)) == params.active_line_lsb)
+      continue;
+
+    for (u32 i = 0; i < (1u << shift); i++)
+    {
+      u16* row_ptr = &m_upscaled_vram[((row << shift) + i) * pitch];
+      for (u32 xoffs = 0; xoffs < width; xoffs++)
+      {
+        const u32 col = (x + xoffs) % VRAM_WIDTH;
+        std::fill_n(&row_ptr[col << shift], 1u << shift, color);
+      }
+    }
+  }
+}
+
+void GPU_SW_Backend::CopyUpscaledVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height,
+                                      GPUBackendCommandParameters params)
+{
+  // Blocks are copied in the same order as the native pixels, so overlapping copies behave the same way.
+  const u32 shift = m_upscale_shift;
+  const u32 scale = 1u << shift;
+  const u32 pitch = VRAM_WIDTH << shift;
+  const u16 mask_and = params.GetMaskAND();
+  const u16 mask_or = params.GetMaskOR();
+  const bool reverse = (src_x < dst_x || ((src_x + width - 1) % VRAM_WIDTH) < ((dst_x + width - 1) % VRAM_WIDTH));
+
+  for (u32 row = 0; row < height; row++)
+  {
+    const u32 src_row = (src_y + row) % VRAM_HEIGHT;
+    const u32 dst_row = (dst_y + row) % VRAM_HEIGHT;
+    for (u32 i = 0; i < width; i++)
+    {
+      const u32 col = reverse ? (width - 1 - i) : i;
+      const u32 src_col = (src_x + col) % VRAM_WIDTH;
+      const u32 dst_col = (dst_x + col) % VRAM_WIDTH;
+      if ((m_vram[dst_row * VRAM_WIDTH + dst_col] & mask_and) != 0)
+        continue;
+
+      for (u32 block_y = 0; block_y < scale; block_y++)
+      {
+        const u16* src_ptr = &m_upscaled_vram[((src_row << shift) + block_y) * pitch + (src_col << shift)];
+        u16* dst_ptr = &m_upscaled_vram[((dst_row << shift) + block_y) * pitch + (dst_col << shift)];
+        for (u32 block_x = 0; block_x < scale; block_x++)
+          dst_ptr[block_x] = src_ptr[block_x] | mask_or;
+      }
+    }
+  }
+}
+
+Common::Rectangle<u32> GPU_SW_Backend::GetClippedBounds(s32 left, s32 top, s32 right, s32 bottom) const
+{
+  // nothing gets drawn with an inverted drawing area, and clamping to it would be undefined
+  if (!m_drawing_area.Valid())
+    return Common::Rectangle<u32>(0, 0, 0, 0);
+
+  const s32 clip_left = static_cast<s32>(m_drawing_area.left);
+  const s32 clip_top = static_cast<s32>(m_drawing_area.top);
+  const s32 clip_right = static_cast<s32>(m_drawing_area.right) + 1;
+  const s32 clip_bottom = static_cast<s32>(m_drawing_area.bottom) + 1;
+  return Common::Rectangle<u32>(static_cast<u32>(std::clamp(left, clip_left, clip_right)),
+                                static_cast<u32>(std::clamp(top, clip_top, clip_bottom)),
+                                static_cast<u32>(std::clamp(right, clip_left, clip_right)),
+                                static_cast<u32>(std::clamp(bottom, clip_top, clip_bottom)));
+}
+
+void GPU_SW_Backend::AddVRAMDirtyRect(u32 x, u32 y, u32 width, u32 height)
+{
+  if (width == 0 || height == 0)
+    return;
+
+  // Writes which wrap around mark the whole width/height, it's not worth tracking both pieces.
+  if ((x + width) > VRAM_WIDTH)
+  {
+    x = 0;
+    width = VRAM_WIDTH;
+  }
+  if ((y + height) > VRAM_HEIGHT)
+  {
+    y = 0;
+    height = VRAM_HEIGHT;
+  }
+
+  m_vram_dirty_rect.Include(x, x + width, y, y + height);
+}
+
+void GPU_SW_Backend::QueueDrawCommand(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& bounds)
+{
+  if (!m_drawing_area.Valid())
+    return;
+
+  if (!bounds.HasExtents())
+    return;
+
+  // Texture page and palette reads wrap horizontally, in which case just assume the whole row is read.
+  Common::Rectangle<u32> page_rect, palette_rect;
+  if (cmd->rc.texture_enable)
+  {
+    page_rect = cmd->draw_mode.GetTexturePageRectangle();
+    if (page_rect.right > VRAM_WIDTH)
+      page_rect.Set(0, page_rect.top, VRAM_WIDTH, page_rect.bottom);
+
+    if (cmd->draw_mode.IsUsingPalette())
+    {
+      const u32 palette_width = (cmd->draw_mode.texture_mode == GPUTextureMode::Palette4Bit) ? 16 : 256;
+      palette_rect = Common::Rectangle<u32>::FromExtents(cmd->palette.GetXBase(), cmd->palette.GetYBase(),
+                                                         palette_width, 1);
+      if (palette_rect.right > VRAM_WIDTH)
+        palette_rect.Set(0, palette_rect.top, VRAM_WIDTH, palette_rect.bottom);
+    }
+  }
+
+  const auto reads_from = [&page_rect, &palette_rect](const Common::Rectangle<u32>& rc) {
+    return rc.Valid() && ((page_rect.Valid() && page_rect.Intersects(rc)) ||
+                          (palette_rect.Valid() && palette_rect.Intersects(rc)));
+  };
+
+  // Sampling from what this primitive writes depends on the order pixels are drawn in, so keep that serial.
+  if (reads_from(bounds))
+  {
+    FlushRender();
+    RasterizeCommand(cmd, m_drawing_area);
+    return;
+  }
+
+  // Other bands may run ahead, so the batch can't contain writes to what we read, or reads of what we write.
+  if (m_batch_data.size() >= MAX_BATCH_SIZE || reads_from(m_batch_written_area) ||
+      (m_batch_read_area.Valid() && m_batch_read_area.Intersects(bounds)))
+  {
+    FlushRender();
+  }
+
+  if (page_rect.Valid())
+    m_batch_read_area.Include(page_rect);
+  if (palette_rect.Valid())
+    m_batch_read_area.Include(palette_rect);
+
+  const u32 offset = static_cast<u32>(m_batch_data.size());
+  m_batch_data.resize(offset + cmd->size);
+  std::memcpy(&m_batch_data[offset], cmd, cmd->size);
+  m_batch_commands.push_back(BatchedCommand{offset, bounds.top, bounds.bottom - 1});
+  m_batch_written_area.Include(bounds);
+}
+
+void GPU_SW_Backend::RasterizeBatch(u32 band)
+{
+  const Common::Rectangle<u32>& area = m_band_areas[band];
+  for (const BatchedCommand& bc : m_batch_commands)
+  {
+    if (bc.bottom < area.top || bc.top > area.bottom)
+      continue;
+
+    RasterizeCommand(reinterpret_cast<const GPUBackendCommand*>(&m_batch_data[bc.offset]), area);
+  }
+}
+
+void GPU_SW_Backend::FlushRender()
+{
+  if (m_batch_commands.empty())
+    return;
+
+  // Each thread gets an equal share of the rows in the drawing area, with the calling thread taking the first.
+  const u32 num_bands = static_cast<u32>(m_band_areas.size());
+  const u32 area_top = m_drawing_area.top;
+  const u32 area_height = m_drawing_area.bottom - m_drawing_area.top + 1;
+  for (u32 i = 0; i < num_bands; i++)
+  {
+    Common::Rectangle<u32>& band_area = m_band_areas[i];
+    band_area.left = m_drawing_area.left;
+    band_area.right = m_drawing_area.right;
+    band_area.top = area_top + (area_height * i) / num_bands;
+    band_area.bottom = area_top + (area_height * (i + 1)) / num_bands - 1;
+  }
+
+  for (const std::unique_ptr<Worker>& worker : m_workers)
+    worker->wake_semaphore.Post();
+
+  RasterizeBatch(0);
+
+  for (size_t i = 0; i < m_workers.size(); i++)
+    m_workers_done_semaphore.Wait();
+
+  m_batch_data.clear();
+  m_batch_commands.clear();
+  m_batch_written_area.SetInvalid();
+  m_batch_read_area.SetInvalid();
+}
+
+void GPU_SW_Backend::StartWorkers(u32 count)
+{
+  count = std::clamp<u32>(count, 1u, MAX_RENDER_THREADS);
+  if (count == 1)
+    return;
+
+  m_workers_exit.store(false);
+  m_band_areas.resize(count);
+  m_batch_data.reserve(MAX_BATCH_SIZE);
+
+  for (u32 i = 0; i < (count - 1); i++)
+  {
+    std::unique_ptr<Worker> worker = std::make_unique<Worker>();
+    worker->thread.Start([this, worker = worker.get(), i]() { WorkerThread(worker, i + 1); });
+    m_workers.push_back(std::move(worker));
+  }
+
+  Log_InfoPrintf("Started %u software renderer threads.", count);
+}
+
+void GPU_SW_Backend::StopWorkers()
+{
+  if (m_workers.empty())
+    return;
+
+  m_workers_exit.store(true);
+  for (const std::unique_ptr<Worker>& worker : m_workers)
+  {
+    worker->wake_semaphore.Post();
+    worker->thread.Join();
+  }
+
+  m_workers.clear();
+  m_band_areas.clear();
+  m_batch_data = {};
+  m_batch_commands = {};
+  m_batch_written_area.SetInvalid();
+  m_batch_read_area.SetInvalid();
+}
+
+void GPU_SW_Backend::WorkerThread(Worker* worker, u32 band)
+{
+  Threading::SetNameOfCurrentThread("Software Renderer Worker");
+
+  for (;;)
+  {
+    worker->wake_semaphore.Wait();
+    if (m_workers_exit.load())
+      break;
+
+    RasterizeBatch(band);
+    m_workers_done_semaphore.Post();
+  }
+}
 
 void GPU_SW_Backend::DrawingAreaChanged() {}
 
-GPU_SW_Backend::DrawLineFunction GPU_SW_Backend::GetDrawLineFunction(bool shading_enable, bool transparency_enable,
-                                                                     bool dithering_enable)
+// The function tables are indexed by texture mode (with the raw bit, or disabled), transparency mode (or disabled),
+// shading and dithering. Combinations which behave identically share an instantiation.
+static constexpr size_t NUM_TABLE_TEXTURE_MODES = static_cast<size_t>(GPUTextureMode::Disabled) + 1;
+static constexpr size_t NUM_TABLE_TRANSPARENCY_MODES = static_cast<size_t>(GPUTransparencyMode::Disabled) + 1;
+static constexpr size_t NUM_DRAW_FUNCTIONS = NUM_TABLE_TEXTURE_MODES * NUM_TABLE_TRANSPARENCY_MODES * 2 * 2;
+
+static constexpr size_t GetDrawFunctionIndex(GPUTextureMode texture_mode, GPUTransparencyMode transparency_mode,
+                                             bool shading_enable, bool dithering_enable)
+{
+  return (((static_cast<size_t>(texture_mode) * NUM_TABLE_TRANSPARENCY_MODES) + static_cast<size_t>(transparency_mode)) *
+            2 +
+          static_cast<size_t>(shading_enable)) *
+           2 +
+         static_cast<size_t>(dithering_enable);
+}
+
+static constexpr GPUTextureMode GetIndexTextureMode(size_t index)
+{
+  // The reserved mode behaves the same as 15-bit.
+  const GPUTextureMode mode = static_cast<GPUTextureMode>(index / (NUM_TABLE_TRANSPARENCY_MODES * 2 * 2));
+  if (mode == GPUTextureMode::Reserved_Direct16Bit)
+    return GPUTextureMode::Direct16Bit;
+  else if (mode == GPUTextureMode::Reserved_RawDirect16Bit)
+    return GPUTextureMode::RawDirect16Bit;
+  else
+    return mode;
+}
+
+static constexpr GPUTransparencyMode GetIndexTransparencyMode(size_t index)
+{
+  return static_cast<GPUTransparencyMode>((index / (2 * 2)) % NUM_TABLE_TRANSPARENCY_MODES);
+}
+
+static constexpr bool GetIndexShadingEnable(size_t index)
+{
+  return ((index / 2) % 2) != 0;
+}
+
+static constexpr bool GetIndexDitheringEnable(size_t index)
 {
-  static constexpr DrawLineFunction funcs[2][2][2] = {
-    {{&GPU_SW_Backend::DrawLine<false, false, false>, &GPU_SW_Backend::DrawLine<false, false, true>},
-     {&GPU_SW_Backend::DrawLine<false, true, false>, &GPU_SW_Backend::DrawLine<false, true, true>}},
-    {{&GPU_SW_Backend::DrawLine<true, false, false>, &GPU_SW_Backend::DrawLine<true, false, true>},
-     {&GPU_SW_Backend::DrawLine<true, true, false>, &GPU_SW_Backend::DrawLine<true, true, true>}}};
+  // Raw textures are never dithered.
+  const GPUTextureMode texture_mode = GetIndexTextureMode(index);
+  return (index % 2) != 0 && (texture_mode == GPUTextureMode::Disabled ||
+                              (texture_mode & GPUTextureMode::RawTextureBit) != GPUTextureMode::RawTextureBit);
+}
 
-  return funcs[u8(shading_enable)][u8(transparency_enable)][u8(dithering_enable)];
+template<size_t... I>
+constexpr std::array<GPU_SW_Backend::DrawLineFunction, sizeof...(I)>
+GPU_SW_Backend::MakeDrawLineFunctionTable(std::index_sequence<I...>)
+{
+  return {{&GPU_SW_Backend::DrawLine<GetIndexShadingEnable(I), GetIndexTransparencyMode(I),
+                                     GetIndexDitheringEnable(I)>...}};
 }
 
-GPU_SW_Backend::DrawRectangleFunction
-GPU_SW_Backend::GetDrawRectangleFunction(bool texture_enable, bool raw_texture_enable, bool transparency_enable)
+template<size_t... I>
+constexpr std::array<GPU_SW_Backend::DrawRectangleFunction, sizeof...(I)>
+GPU_SW_Backend::MakeDrawRectangleFunctionTable(std::index_sequence<I...>)
 {
-  static constexpr DrawRectangleFunction funcs[2][2][2] = {
-    {{&GPU_SW_Backend::DrawRectangle<false, false, false>, &GPU_SW_Backend::DrawRectangle<false, false, true>},
-     {&GPU_SW_Backend::DrawRectangle<false, false, false>, &GPU_SW_Backend::DrawRectangle<false, false, true>}},
-    {{&GPU_SW_Backend::DrawRectangle<true, false, false>, &GPU_SW_Backend::DrawRectangle<true, false, true>},
-     {&GPU_SW_Backend::DrawRectangle<true, true, false>, &GPU_SW_Backend::DrawRectangle<true, true, true>}}};
+  return {{&GPU_SW_Backend::DrawRectangle<GetIndexTextureMode(I), GetIndexTransparencyMode(I)>...}};
+}
 
-  return funcs[u8(texture_enable)][u8(raw_texture_enable)][u8(transparency_enable)];
+template<size_t... I>
+constexpr std::array<GPU_SW_Backend::DrawTriangleFunction, sizeof...(I)>
+GPU_SW_Backend::MakeDrawTriangleFunctionTable(std::index_sequence<I...>)
+{
+  return {{&GPU_SW_Backend::DrawTriangle<GetIndexShadingEnable(I), GetIndexTextureMode(I), GetIndexTransparencyMode(I),
+                                         GetIndexDitheringEnable(I)>...}};
 }
 
-GPU_SW_Backend::DrawTriangleFunction GPU_SW_Backend::GetDrawTriangleFunction(bool shading_enable, bool texture_enable,
-                                                                             bool raw_texture_enable,
-                                                                             bool transparency_enable,
+GPU_SW_Backend::DrawLineFunction GPU_SW_Backend::GetDrawLineFunction(bool shading_enable,
+                                                                     GPUTransparencyMode transparency_mode,
+                                                                     bool dithering_enable)
+{
+  static constexpr std::array<DrawLineFunction, NUM_DRAW_FUNCTIONS> funcs =
+    MakeDrawLineFunctionTable(std::make_index_sequence<NUM_DRAW_FUNCTIONS>());
+  return funcs[GetDrawFunctionIndex(GPUTextureMode::Disabled, transparency_mode, shading_enable, dithering_enable)];
+}
+
+GPU_SW_Backend::DrawRectangleFunction GPU_SW_Backend::GetDrawRectangleFunction(GPUTextureMode texture_mode,
+                                                                               GPUTransparencyMode transparency_mode)
+{
+  static constexpr std::array<DrawRectangleFunction, NUM_DRAW_FUNCTIONS> funcs =
+    MakeDrawRectangleFunctionTable(std::make_index_sequence<NUM_DRAW_FUNCTIONS>());
+  return funcs[GetDrawFunctionIndex(texture_mode, transparency_mode, false, false)];
+}
+
+GPU_SW_Backend::DrawTriangleFunction GPU_SW_Backend::GetDrawTriangleFunction(bool shading_enable,
+                                                                             GPUTextureMode texture_mode,
+                                                                             GPUTransparencyMode transparency_mode,
                                                                              bool dithering_enable)
 {
-  static constexpr DrawTriangleFunction funcs[2][2][2][2][2] = {
-    {{{{&GPU_SW_Backend::DrawTriangle<false, false, false, false, false>,
-        &GPU_SW_Backend::DrawTriangle<false, false, false, false, true>},
-       {&GPU_SW_Backend::DrawTriangle<false, false, false, true, false>,
-        &GPU_SW_Backend::DrawTriangle<false, false, false, true, true>}},
-      {{&GPU_SW_Backend::DrawTriangle<false, false, false, false, false>,
-        &GPU_SW_Backend::DrawTriangle<false, false, false, false, false>},
-       {&GPU_SW_Backend::DrawTriangle<false, false, false, true, false>,
-        &GPU_SW_Backend::DrawTriangle<false, false, false, true, false>}}},
-     {{{&GPU_SW_Backend::DrawTriangle<false, true, false, false, false>,
-        &GPU_SW_Backend::DrawTriangle<false, true, false, false, true>},
-       {&GPU_SW_Backend::DrawTriangle<false, true, false, true, false>,
-        &GPU_SW_Backend::DrawTriangle<false, true, false, true, true>}},
-      {{&GPU_SW_Backend::DrawTriangle<false, true, true, false, false>,
-        &GPU_SW_Backend::DrawTriangle<false, true, true, false, false>},
-       {&GPU_SW_Backend::DrawTriangle<false, true, true, true, false>,
-        &GPU_SW_Backend::DrawTriangle<false, true, true, true, false>}}}},
-    {{{{&GPU_SW_Backend::DrawTriangle<true, false, false, false, false>,
-        &GPU_SW_Backend::DrawTriangle<true, false, false, false, true>},
-       {&GPU_SW_Backend::DrawTriangle<true, false, false, true, false>,
-        &GPU_SW_Backend::DrawTriangle<true, false, false, true, true>}},
-      {{&GPU_SW_Backend::DrawTriangle<true, false, false, false, false>,
-        &GPU_SW_Backend::DrawTriangle<true, false, false, false, false>},
-       {&GPU_SW_Backend::DrawTriangle<true, false, false, true, false>,
-        &GPU_SW_Backend::DrawTriangle<true, false, false, true, false>}}},
-     {{{&GPU_SW_Backend::DrawTriangle<true, true, false, false, false>,
-        &GPU_SW_Backend::DrawTriangle<true, true, false, false, true>},
-       {&GPU_SW_Backend::DrawTriangle<true, true, false, true, false>,
-        &GPU_SW_Backend::DrawTriangle<true, true, false, true, true>}},
-      {{&GPU_SW_Backend::DrawTriangle<true, true, true, false, false>,
-        &GPU_SW_Backend::DrawTriangle<true, true, true, false, false>},
-       {&GPU_SW_Backend::DrawTriangle<true, true, true, true, false>,
-        &GPU_SW_Backend::DrawTriangle<true, true, true, true, false>}}}}};
-
-  return funcs[u8(shading_enable)][u8(texture_enable)][u8(raw_texture_enable)][u8(transparency_enable)]
-              [u8(dithering_enable)];
-}
\ No newline at end of file
+  static constexpr std::array<DrawTriangleFunction, NUM_DRAW_FUNCTIONS> funcs =
+    MakeDrawTriangleFunctionTable(std::make_index_sequence<NUM_DRAW_FUNCTIONS>());
+  return funcs[GetDrawFunctionIndex(texture_mode, transparency_mode, shading_enable, dithering_enable)];
+}
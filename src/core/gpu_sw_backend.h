@@ -1,28 +1,51 @@
 #pragma once
 #include "gpu_backend.h"
 #include <array>
+#include <atomic>
 #include <memory>
+#include <utility>
 #include <vector>
 
 class GPU_SW_Backend final : public GPUBackend
 {
 public:
   GPU_SW_Backend();
+
+  /// Renders into the caller's VRAM at native resolution, for when only readbacks are needed from this backend.
+  explicit GPU_SW_Backend(u16* shared_vram);
+
   ~GPU_SW_Backend() override;
 
   bool Initialize(bool force_thread) override;
+  void UpdateSettings() override;
   void Reset(bool clear_vram) override;
+  void Shutdown() override;
 
   ALWAYS_INLINE_RELEASE u16 GetPixel(const u32 x, const u32 y) const { return m_vram[VRAM_WIDTH * y + x]; }
   ALWAYS_INLINE_RELEASE const u16* GetPixelPtr(const u32 x, const u32 y) const { return &m_vram[VRAM_WIDTH * y + x]; }
   ALWAYS_INLINE_RELEASE u16* GetPixelPtr(const u32 x, const u32 y) { return &m_vram[VRAM_WIDTH * y + x]; }
   ALWAYS_INLINE_RELEASE void SetPixel(const u32 x, const u32 y, const u16 value) { m_vram[VRAM_WIDTH * y + x] = value; }
 
+  /// Upscaled copy of VRAM, which is (VRAM_WIDTH << shift) by (VRAM_HEIGHT << shift) pixels. Only valid when the
+  /// upscale shift is non-zero.
+  ALWAYS_INLINE u32 GetUpscaleShift() const { return m_upscale_shift; }
+  ALWAYS_INLINE const u16* GetUpscaledVRAM() const { return m_upscaled_vram.data(); }
+
+  /// Area of VRAM written since the last ClearVRAMDirtyRect(). Updated by the GPU thread, so sync before reading.
+  ALWAYS_INLINE const Common::Rectangle<u32>& GetVRAMDirtyRect() const { return m_vram_dirty_rect; }
+  ALWAYS_INLINE void ClearVRAMDirtyRect() { m_vram_dirty_rect.SetInvalid(); }
+
   // this is actually (31 * 255) >> 4) == 494, but to simplify addressing we use the next power of two (512)
   static constexpr u32 DITHER_LUT_SIZE = 512;
   using DitherLUT = std::array<std::array<std::array<u8, 512>, DITHER_MATRIX_SIZE>, DITHER_MATRIX_SIZE>;
   static constexpr DitherLUT ComputeDitherLUT();
 
+  // number of pixels shaded at once by the vectorized span path
+  static constexpr u32 SPAN_PIXELS = 8;
+
+  // largest supported upscale factor, as a shift (4x)
+  static constexpr u32 MAX_UPSCALE_SHIFT = 2;
+
 protected:
   union VRAMPixel
   {
@@ -95,19 +118,62 @@ protected:
   void FlushRender() override;
   void DrawingAreaChanged() override;
 
+  //////////////////////////////////////////////////////////////////////////
+  // Upscaling
+  //////////////////////////////////////////////////////////////////////////
+  // When upscaling is enabled, draws are rasterized twice: once to native VRAM, which stays bit-exact with what the
+  // console would produce, and once with scaled coordinates to a higher resolution copy that is only used for display.
+  // Textures are always sampled from native VRAM.
+  void SetUpscaleShift(u32 shift);
+  void UpscaleVRAMRegion(u32 x, u32 y, u32 width, u32 height);
+  void FillUpscaledVRAM(u32 x, u32 y, u32 width, u32 height, u16 color, GPUBackendCommandParameters params);
+  void CopyUpscaledVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height,
+                        GPUBackendCommandParameters params);
+
+  /// Pixels written by a draw. The area is in the coordinate space of the target and inclusive.
+  struct DrawTarget
+  {
+    u16* pixels;
+    u32 pitch;
+    u32 scale_shift;
+    Common::Rectangle<u32> area;
+
+    ALWAYS_INLINE_RELEASE u16* GetPixelPtr(u32 x, u32 y) const { return &pixels[pitch * y + x]; }
+  };
+
   //////////////////////////////////////////////////////////////////////////
   // Rasterization
   //////////////////////////////////////////////////////////////////////////
-  template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
-  void ShadePixel(const GPUBackendDrawCommand* cmd, u32 x, u32 y, u8 color_r, u8 color_g, u8 color_b, u8 texcoord_x,
-                  u8 texcoord_y);
+  template<GPUTextureMode texture_mode>
+  u16 SampleTexture(const GPUBackendDrawCommand* cmd, u8 texcoord_x, u8 texcoord_y) const;
+
+  template<GPUTextureMode texture_mode, GPUTransparencyMode transparency_mode, bool dithering_enable>
+  void ShadePixel(const GPUBackendDrawCommand* cmd, const DrawTarget& target, u32 x, u32 y, u8 color_r, u8 color_g,
+                  u8 color_b, u8 texcoord_x, u8 texcoord_y);
 
-  template<bool texture_enable, bool raw_texture_enable, bool transparency_enable>
-  void DrawRectangle(const GPUBackendDrawRectangleCommand* cmd);
+  /// Inputs for shading a run of horizontally adjacent pixels at once. Colours are 8-bit, texels are 15-bit.
+  struct alignas(16) SpanPixels
+  {
+    u16 r[SPAN_PIXELS];
+    u16 g[SPAN_PIXELS];
+    u16 b[SPAN_PIXELS];
+    u16 texel[SPAN_PIXELS];
+  };
+
+  /// Vectorized equivalent of calling ShadePixel() for pixels x..x+7. Only available on x64 and AArch64.
+  template<GPUTextureMode texture_mode, GPUTransparencyMode transparency_mode, bool dithering_enable>
+  void ShadePixels8(const GPUBackendDrawCommand* cmd, const DrawTarget& target, u32 x, u32 y,
+                    const SpanPixels& pixels, const s16* dither_offsets);
+
+  template<GPUTextureMode texture_mode, GPUTransparencyMode transparency_mode>
+  void DrawRectangle(const GPUBackendDrawRectangleCommand* cmd, const DrawTarget& target);
 
-  using DrawRectangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawRectangleCommand* cmd);
-  DrawRectangleFunction GetDrawRectangleFunction(bool texture_enable, bool raw_texture_enable,
-                                                 bool transparency_enable);
+  using DrawRectangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawRectangleCommand* cmd,
+                                                         const DrawTarget& target);
+  template<size_t... I>
+  static constexpr std::array<DrawRectangleFunction, sizeof...(I)>
+  MakeDrawRectangleFunctionTable(std::index_sequence<I...>);
+  DrawRectangleFunction GetDrawRectangleFunction(GPUTextureMode texture_mode, GPUTransparencyMode transparency_mode);
 
   //////////////////////////////////////////////////////////////////////////
   // Polygon and line rasterization ported from Mednafen
@@ -137,31 +203,88 @@ protected:
   template<bool shading_enable, bool texture_enable>
   void AddIDeltas_DY(i_group& ig, const i_deltas& idl, u32 count = 1);
 
-  template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
+  template<bool shading_enable, GPUTextureMode texture_mode, GPUTransparencyMode transparency_mode,
            bool dithering_enable>
-  void DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s32 x_start, s32 x_bound, i_group ig,
-                const i_deltas& idl);
+  void DrawSpan(const GPUBackendDrawPolygonCommand* cmd, const DrawTarget& target, s32 y, s32 x_start,
+                s32 x_bound, i_group ig, const i_deltas& idl);
 
-  template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
+  template<bool shading_enable, GPUTextureMode texture_mode, GPUTransparencyMode transparency_mode,
            bool dithering_enable>
-  void DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, const GPUBackendDrawPolygonCommand::Vertex* v0,
-                    const GPUBackendDrawPolygonCommand::Vertex* v1, const GPUBackendDrawPolygonCommand::Vertex* v2);
+  void DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, const DrawTarget& target,
+                    const GPUBackendDrawPolygonCommand::Vertex* v0, const GPUBackendDrawPolygonCommand::Vertex* v1,
+                    const GPUBackendDrawPolygonCommand::Vertex* v2);
 
   using DrawTriangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawPolygonCommand* cmd,
+                                                        const DrawTarget& target,
                                                         const GPUBackendDrawPolygonCommand::Vertex* v0,
                                                         const GPUBackendDrawPolygonCommand::Vertex* v1,
                                                         const GPUBackendDrawPolygonCommand::Vertex* v2);
-  DrawTriangleFunction GetDrawTriangleFunction(bool shading_enable, bool texture_enable, bool raw_texture_enable,
-                                               bool transparency_enable, bool dithering_enable);
+  template<size_t... I>
+  static constexpr std::array<DrawTriangleFunction, sizeof...(I)>
+  MakeDrawTriangleFunctionTable(std::index_sequence<I...>);
+  DrawTriangleFunction GetDrawTriangleFunction(bool shading_enable, GPUTextureMode texture_mode,
+                                               GPUTransparencyMode transparency_mode, bool dithering_enable);
 
-  template<bool shading_enable, bool transparency_enable, bool dithering_enable>
-  void DrawLine(const GPUBackendDrawLineCommand* cmd, const GPUBackendDrawLineCommand::Vertex* p0,
-                const GPUBackendDrawLineCommand::Vertex* p1);
+  template<bool shading_enable, GPUTransparencyMode transparency_mode, bool dithering_enable>
+  void DrawLine(const GPUBackendDrawLineCommand* cmd, const DrawTarget& target,
+                const GPUBackendDrawLineCommand::Vertex* p0, const GPUBackendDrawLineCommand::Vertex* p1);
 
   using DrawLineFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawLineCommand* cmd,
+                                                    const DrawTarget& target,
                                                     const GPUBackendDrawLineCommand::Vertex* p0,
                                                     const GPUBackendDrawLineCommand::Vertex* p1);
-  DrawLineFunction GetDrawLineFunction(bool shading_enable, bool transparency_enable, bool dithering_enable);
+  template<size_t... I>
+  static constexpr std::array<DrawLineFunction, sizeof...(I)> MakeDrawLineFunctionTable(std::index_sequence<I...>);
+  DrawLineFunction GetDrawLineFunction(bool shading_enable, GPUTransparencyMode transparency_mode,
+                                       bool dithering_enable);
+
+  /// Rasterizes a draw command to native VRAM and the upscaled copy, only touching pixels within the specified area.
+  void RasterizeCommand(const GPUBackendCommand* cmd, const Common::Rectangle<u32>& area);
+  void RasterizeCommandToTarget(const GPUBackendCommand* cmd, const DrawTarget& target);
+
+  //////////////////////////////////////////////////////////////////////////
+  // Binned multi-threaded rasterization
+  //////////////////////////////////////////////////////////////////////////
+  // Draws are queued until something depends on their result, and then each thread rasterizes the whole batch for its
+  // own band of rows of the drawing area. Submission order is preserved within each band, and since shading only
+  // reads back the destination pixel, the result is identical to drawing the batch on one thread. Primitives which
+  // sample from areas written earlier in the batch (or by themselves) force the batch to be drawn first.
+  struct BatchedCommand
+  {
+    u32 offset;
+    u32 top;
+    u32 bottom;
+  };
+
+  struct Worker
+  {
+    Threading::Thread thread;
+    Threading::KernelSemaphore wake_semaphore;
+  };
 
-  std::array<u16, VRAM_WIDTH * VRAM_HEIGHT> m_vram;
+  void StartWorkers(u32 count);
+  void StopWorkers();
+  void WorkerThread(Worker* worker, u32 band);
+  Common::Rectangle<u32> GetClippedBounds(s32 left, s32 top, s32 right, s32 bottom) const;
+  void QueueDrawCommand(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& bounds);
+  void AddVRAMDirtyRect(u32 x, u32 y, u32 width, u32 height);
+  void RasterizeBatch(u32 band);
+
+  // separately allocated, so it can be backed by huge pages, unless it belongs to the caller
+  u16* m_vram = nullptr;
+  bool m_vram_huge_pages = false;
+  bool m_vram_shared = false;
+  std::vector<u16> m_upscaled_vram;
+  u32 m_upscale_shift = 0;
+  Common::Rectangle<u32> m_vram_dirty_rect;
+
+  std::vector<u8> m_batch_data;
+  std::vector<BatchedCommand> m_batch_commands;
+  Common::Rectangle<u32> m_batch_written_area;
+  Common::Rectangle<u32> m_batch_read_area;
+
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  std::vector<Common::Rectangle<u32>> m_band_areas;
+  Threading::KernelSemaphore m_workers_done_semaphore;
+  std::atomic_bool m_workers_exit{false};
 };
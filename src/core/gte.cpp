@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <array>
 #include <numeric>
+#include <utility>
 
 namespace GTE {
 
@@ -424,40 +425,33 @@ static void PushRGBFromMAC()
   REGS.dr32[22] = r | (g << 8) | (b << 16) | (c << 24); // RGB2 <- Value
 }
 
-ALWAYS_INLINE static u32 UNRDivide(u32 lhs, u32 rhs)
+static constexpr std::array<u8, 257> MakeUNRTable()
 {
-  if (rhs * 2 <= lhs)
+  // unr_table[i] = max(0, (40000h / (i + 100h) + 1) / 2 - 101h), with one extra entry for "(d-7FC0h)/80h"=100h.
+  std::array<u8, 257> table = {};
+  for (u32 i = 0; i < table.size(); i++)
   {
-    REGS.FLAG.divide_overflow = true;
-    return 0x1FFFF;
+    const s32 value = static_cast<s32>(((0x40000u / (i + 0x100u)) + 1u) / 2u) - 0x101;
+    table[i] = static_cast<u8>((value < 0) ? 0 : value);
   }
+  return table;
+}
+
+static constexpr std::array<u8, 257> s_unr_table = MakeUNRTable();
+static_assert(s_unr_table[0] == 0xFF && s_unr_table[128] == 0x54 && s_unr_table[256] == 0x00);
+
+ALWAYS_INLINE static u32 UNRDivide(u32 lhs, u32 rhs)
+{
+  // Both operands are 16-bit, so the overflow case can be resolved with a select at the end rather than a branch.
+  // The intermediate values for the overflow case (including rhs=0) are discarded, and never trap.
+  const bool overflow = (rhs * 2 <= lhs);
 
   const u32 shift = (rhs == 0) ? 16 : CountLeadingZeros(static_cast<u16>(rhs));
   lhs <<= shift;
   rhs <<= shift;
 
-  static constexpr std::array<u8, 257> unr_table = {{
-    0xFF, 0xFD, 0xFB, 0xF9, 0xF7, 0xF5, 0xF3, 0xF1, 0xEF, 0xEE, 0xEC, 0xEA, 0xE8, 0xE6, 0xE4, 0xE3, //
-    0xE1, 0xDF, 0xDD, 0xDC, 0xDA, 0xD8, 0xD6, 0xD5, 0xD3, 0xD1, 0xD0, 0xCE, 0xCD, 0xCB, 0xC9, 0xC8, //  00h..3Fh
-    0xC6, 0xC5, 0xC3, 0xC1, 0xC0, 0xBE, 0xBD, 0xBB, 0xBA, 0xB8, 0xB7, 0xB5, 0xB4, 0xB2, 0xB1, 0xB0, //
-    0xAE, 0xAD, 0xAB, 0xAA, 0xA9, 0xA7, 0xA6, 0xA4, 0xA3, 0xA2, 0xA0, 0x9F, 0x9E, 0x9C, 0x9B, 0x9A, //
-    0x99, 0x97, 0x96, 0x95, 0x94, 0x92, 0x91, 0x90, 0x8F, 0x8D, 0x8C, 0x8B, 0x8A, 0x89, 0x87, 0x86, //
-    0x85, 0x84, 0x83, 0x82, 0x81, 0x7F, 0x7E, 0x7D, 0x7C, 0x7B, 0x7A, 0x79, 0x78, 0x77, 0x75, 0x74, //  40h..7Fh
-    0x73, 0x72, 0x71, 0x70, 0x6F, 0x6E, 0x6D, 0x6C, 0x6B, 0x6A, 0x69, 0x68, 0x67, 0x66, 0x65, 0x64, //
-    0x63, 0x62, 0x61, 0x60, 0x5F, 0x5E, 0x5D, 0x5D, 0x5C, 0x5B, 0x5A, 0x59, 0x58, 0x57, 0x56, 0x55, //
-    0x54, 0x53, 0x53, 0x52, 0x51, 0x50, 0x4F, 0x4E, 0x4D, 0x4D, 0x4C, 0x4B, 0x4A, 0x49, 0x48, 0x48, //
-    0x47, 0x46, 0x45, 0x44, 0x43, 0x43, 0x42, 0x41, 0x40, 0x3F, 0x3F, 0x3E, 0x3D, 0x3C, 0x3C, 0x3B, //  80h..BFh
-    0x3A, 0x39, 0x39, 0x38, 0x37, 0x36, 0x36, 0x35, 0x34, 0x33, 0x33, 0x32, 0x31, 0x31, 0x30, 0x2F, //
-    0x2E, 0x2E, 0x2D, 0x2C, 0x2C, 0x2B, 0x2A, 0x2A, 0x29, 0x28, 0x28, 0x27, 0x26, 0x26, 0x25, 0x24, //
-    0x24, 0x23, 0x22, 0x22, 0x21, 0x20, 0x20, 0x1F, 0x1E, 0x1E, 0x1D, 0x1D, 0x1C, 0x1B, 0x1B, 0x1A, //
-    0x19, 0x19, 0x18, 0x18, 0x17, 0x16, 0x16, 0x15, 0x15, 0x14, 0x14, 0x13, 0x12, 0x12, 0x11, 0x11, //  C0h..FFh
-    0x10, 0x0F, 0x0F, 0x0E, 0x0E, 0x0D, 0x0D, 0x0C, 0x0C, 0x0B, 0x0A, 0x0A, 0x09, 0x09, 0x08, 0x08, //
-    0x07, 0x07, 0x06, 0x06, 0x05, 0x05, 0x04, 0x04, 0x03, 0x03, 0x02, 0x02, 0x01, 0x01, 0x00, 0x00, //
-    0x00 // <-- one extra table entry (for "(d-7FC0h)/80h"=100h)
-  }};
-
   const u32 divisor = rhs | 0x8000;
-  const s32 x = static_cast<s32>(0x101 + ZeroExtend32(unr_table[((divisor & 0x7FFF) + 0x40) >> 7]));
+  const s32 x = static_cast<s32>(0x101 + ZeroExtend32(s_unr_table[((divisor & 0x7FFF) + 0x40) >> 7]));
   const s32 d = ((static_cast<s32>(ZeroExtend32(divisor)) * -x) + 0x80) >> 8;
   const u32 recip = static_cast<u32>(((x * (0x20000 + d)) + 0x80) >> 8);
 
@@ -465,7 +459,8 @@ ALWAYS_INLINE static u32 UNRDivide(u32 lhs, u32 rhs)
 
   // The min(1FFFFh) limit is needed for cases like FE3Fh/7F20h, F015h/780Bh, etc. (these do produce UNR result 20000h,
   // and are saturated to 1FFFFh, but without setting overflow FLAG bits).
-  return std::min<u32>(0x1FFFF, result);
+  REGS.FLAG.bits |= static_cast<u32>(overflow) << 17; // divide_overflow
+  return overflow ? 0x1FFFF : std::min<u32>(0x1FFFF, result);
 }
 
 static void MulMatVec(const s16 M[3][3], const s16 Vx, const s16 Vy, const s16 Vz, u8 shift, bool lm)
@@ -482,20 +477,21 @@ static void MulMatVec(const s16 M[3][3], const s16 Vx, const s16 Vy, const s16 V
 #undef dot3
 }
 
-static void MulMatVec(const s16 M[3][3], const s32 T[3], const s16 Vx, const s16 Vy, const s16 Vz, u8 shift, bool lm)
+/// Computes T*1000h + M*V for one row. The intermediate sums are checked for overflow and wrapped to 44 bits, the
+/// final sum is returned as-is for the caller to check and truncate.
+template<u32 i>
+ALWAYS_INLINE static s64 MulMatVecRow(const s16 M[3][3], const s32 T[3], const s16 Vx, const s16 Vy, const s16 Vz)
 {
-#define dot3(i)                                                                                                        \
-  TruncateAndSetMACAndIR<i + 1>(                                                                                       \
-    SignExtendMACResult<i + 1>(SignExtendMACResult<i + 1>((s64(T[i]) << 12) + (s64(M[i][0]) * s64(Vx))) +              \
-                               (s64(M[i][1]) * s64(Vy))) +                                                             \
-      (s64(M[i][2]) * s64(Vz)),                                                                                        \
-    shift, lm)
-
-  dot3(0);
-  dot3(1);
-  dot3(2);
+  return SignExtendMACResult<i + 1>(SignExtendMACResult<i + 1>((s64(T[i]) << 12) + (s64(M[i][0]) * s64(Vx))) +
+                                    (s64(M[i][1]) * s64(Vy))) +
+         (s64(M[i][2]) * s64(Vz));
+}
 
-#undef dot3
+static void MulMatVec(const s16 M[3][3], const s32 T[3], const s16 Vx, const s16 Vy, const s16 Vz, u8 shift, bool lm)
+{
+  TruncateAndSetMACAndIR<1>(MulMatVecRow<0>(M, T, Vx, Vy, Vz), shift, lm);
+  TruncateAndSetMACAndIR<2>(MulMatVecRow<1>(M, T, Vx, Vy, Vz), shift, lm);
+  TruncateAndSetMACAndIR<3>(MulMatVecRow<2>(M, T, Vx, Vy, Vz), shift, lm);
 }
 
 static void MulMatVecBuggy(const s16 M[3][3], const s32 T[3], const s16 Vx, const s16 Vy, const s16 Vz, u8 shift,
@@ -519,84 +515,109 @@ static void MulMatVecBuggy(const s16 M[3][3], const s32 T[3], const s16 Vx, cons
 #undef dot3
 }
 
-static void Execute_MVMVA(Instruction inst)
+template<u32 mx, u32 v, u32 cv>
+static void Execute_MVMVA_Impl(Instruction inst)
 {
   REGS.FLAG.Clear();
 
-  // TODO: Remove memcpy..
-  s16 M[3][3];
-  switch (inst.mvmva_multiply_matrix)
+  // the operands are fixed for each instruction, so the shared case only has to pick pointers
+  const s16(*M)[3];
+  s16 buggy_M[3][3];
+  if constexpr (mx == 0)
   {
-    case 0:
-      std::memcpy(M, REGS.RT, sizeof(s16) * 3 * 3);
-      break;
-    case 1:
-      std::memcpy(M, REGS.LLM, sizeof(s16) * 3 * 3);
-      break;
-    case 2:
-      std::memcpy(M, REGS.LCM, sizeof(s16) * 3 * 3);
-      break;
-    default:
-    {
-      // buggy
-      M[0][0] = -static_cast<s16>(ZeroExtend16(REGS.RGBC[0]) << 4);
-      M[0][1] = static_cast<s16>(ZeroExtend16(REGS.RGBC[0]) << 4);
-      M[0][2] = REGS.IR0;
-      M[1][0] = REGS.RT[0][2];
-      M[1][1] = REGS.RT[0][2];
-      M[1][2] = REGS.RT[0][2];
-      M[2][0] = REGS.RT[1][1];
-      M[2][1] = REGS.RT[1][1];
-      M[2][2] = REGS.RT[1][1];
-    }
-    break;
+    M = REGS.RT;
+  }
+  else if constexpr (mx == 1)
+  {
+    M = REGS.LLM;
+  }
+  else if constexpr (mx == 2)
+  {
+    M = REGS.LCM;
+  }
+  else
+  {
+    // buggy
+    buggy_M[0][0] = -static_cast<s16>(ZeroExtend16(REGS.RGBC[0]) << 4);
+    buggy_M[0][1] = static_cast<s16>(ZeroExtend16(REGS.RGBC[0]) << 4);
+    buggy_M[0][2] = REGS.IR0;
+    buggy_M[1][0] = REGS.RT[0][2];
+    buggy_M[1][1] = REGS.RT[0][2];
+    buggy_M[1][2] = REGS.RT[0][2];
+    buggy_M[2][0] = REGS.RT[1][1];
+    buggy_M[2][1] = REGS.RT[1][1];
+    buggy_M[2][2] = REGS.RT[1][1];
+    M = buggy_M;
   }
 
   s16 Vx, Vy, Vz;
-  switch (inst.mvmva_multiply_vector)
+  if constexpr (v == 0)
   {
-    case 0:
-      Vx = REGS.V0[0];
-      Vy = REGS.V0[1];
-      Vz = REGS.V0[2];
-      break;
-    case 1:
-      Vx = REGS.V1[0];
-      Vy = REGS.V1[1];
-      Vz = REGS.V1[2];
-      break;
-    case 2:
-      Vx = REGS.V2[0];
-      Vy = REGS.V2[1];
-      Vz = REGS.V2[2];
-      break;
-    default:
-      Vx = REGS.IR1;
-      Vy = REGS.IR2;
-      Vz = REGS.IR3;
-      break;
+    Vx = REGS.V0[0];
+    Vy = REGS.V0[1];
+    Vz = REGS.V0[2];
+  }
+  else if constexpr (v == 1)
+  {
+    Vx = REGS.V1[0];
+    Vy = REGS.V1[1];
+    Vz = REGS.V1[2];
+  }
+  else if constexpr (v == 2)
+  {
+    Vx = REGS.V2[0];
+    Vy = REGS.V2[1];
+    Vz = REGS.V2[2];
+  }
+  else
+  {
+    Vx = REGS.IR1;
+    Vy = REGS.IR2;
+    Vz = REGS.IR3;
   }
 
-  static const s32 zero_T[3] = {};
-  switch (inst.mvmva_translation_vector)
+  if constexpr (cv == 0)
   {
-    case 0:
-      MulMatVec(M, REGS.TR, Vx, Vy, Vz, inst.GetShift(), inst.lm);
-      break;
-    case 1:
-      MulMatVec(M, REGS.BK, Vx, Vy, Vz, inst.GetShift(), inst.lm);
-      break;
-    case 2:
-      MulMatVecBuggy(M, REGS.FC, Vx, Vy, Vz, inst.GetShift(), inst.lm);
-      break;
-    default:
-      MulMatVec(M, zero_T, Vx, Vy, Vz, inst.GetShift(), inst.lm);
-      break;
+    MulMatVec(M, REGS.TR, Vx, Vy, Vz, inst.GetShift(), inst.lm);
+  }
+  else if constexpr (cv == 1)
+  {
+    MulMatVec(M, REGS.BK, Vx, Vy, Vz, inst.GetShift(), inst.lm);
+  }
+  else if constexpr (cv == 2)
+  {
+    MulMatVecBuggy(M, REGS.FC, Vx, Vy, Vz, inst.GetShift(), inst.lm);
+  }
+  else
+  {
+    static constexpr s32 zero_T[3] = {};
+    MulMatVec(M, zero_T, Vx, Vy, Vz, inst.GetShift(), inst.lm);
   }
 
   REGS.FLAG.UpdateError();
 }
 
+template<size_t... I>
+static constexpr std::array<InstructionImpl, sizeof...(I)> MakeMVMVATable(std::index_sequence<I...>)
+{
+  return {{&Execute_MVMVA_Impl<(I >> 4) & 3, (I >> 2) & 3, I & 3>...}};
+}
+
+// indexed by matrix, vector and translation vector
+static constexpr std::array<InstructionImpl, 64> s_mvmva_table = MakeMVMVATable(std::make_index_sequence<64>());
+
+ALWAYS_INLINE static InstructionImpl GetMVMVAImpl(Instruction inst)
+{
+  return s_mvmva_table[(static_cast<u32>(inst.mvmva_multiply_matrix) << 4) |
+                       (static_cast<u32>(inst.mvmva_multiply_vector) << 2) |
+                       static_cast<u32>(inst.mvmva_translation_vector)];
+}
+
+static void Execute_MVMVA(Instruction inst)
+{
+  GetMVMVAImpl(inst)(inst);
+}
+
 static void Execute_SQR(Instruction inst)
 {
   REGS.FLAG.Clear();
@@ -638,19 +659,22 @@ static void Execute_OP(Instruction inst)
   REGS.FLAG.UpdateError();
 }
 
-static void RTPS(const s16 V[3], u8 shift, bool lm, bool last)
+/// Per-vertex state carried from the transform to the projection stage of RTPS.
+struct RTPSVertex
 {
-#define dot3(i)                                                                                                        \
-  SignExtendMACResult<i + 1>(SignExtendMACResult<i + 1>((s64(REGS.TR[i]) << 12) + (s64(REGS.RT[i][0]) * s64(V[0]))) +  \
-                             (s64(REGS.RT[i][1]) * s64(V[1]))) +                                                       \
-    (s64(REGS.RT[i][2]) * s64(V[2]))
+  s64 x, y, z;
+  s16 ir1, ir2;
+  u16 sz3;
+};
 
+static RTPSVertex RTPSTransform(const s16 V[3], u8 shift, bool lm)
+{
   // IR1 = MAC1 = (TRX*1000h + RT11*VX0 + RT12*VY0 + RT13*VZ0) SAR (sf*12)
   // IR2 = MAC2 = (TRY*1000h + RT21*VX0 + RT22*VY0 + RT23*VZ0) SAR (sf*12)
   // IR3 = MAC3 = (TRZ*1000h + RT31*VX0 + RT32*VY0 + RT33*VZ0) SAR (sf*12)
-  const s64 x = dot3(0);
-  const s64 y = dot3(1);
-  const s64 z = dot3(2);
+  const s64 x = MulMatVecRow<0>(REGS.RT, REGS.TR, V[0], V[1], V[2]);
+  const s64 y = MulMatVecRow<1>(REGS.RT, REGS.TR, V[0], V[1], V[2]);
+  const s64 z = MulMatVecRow<2>(REGS.RT, REGS.TR, V[0], V[1], V[2]);
   TruncateAndSetMAC<1>(x, shift);
   TruncateAndSetMAC<2>(y, shift);
   TruncateAndSetMAC<3>(z, shift);
@@ -662,33 +686,41 @@ static void RTPS(const s16 V[3], u8 shift, bool lm, bool last)
   // when "MAC3" exceeds -8000h..+7FFFh).
   TruncateAndSetIR<3>(s32(z >> 12), false);
   REGS.dr32[11] = std::clamp(REGS.MAC3, lm ? 0 : IR123_MIN_VALUE, IR123_MAX_VALUE);
-#undef dot3
 
   // SZ3 = MAC3 SAR ((1-sf)*12)                           ;ScreenZ FIFO 0..+FFFFh
   PushSZ(s32(z >> 12));
 
+  return RTPSVertex{x, y, z, REGS.IR1, REGS.IR2, REGS.SZ3};
+}
+
+static void RTPSProject(const RTPSVertex& vertex, u32 quotient, u8 shift, bool lm, bool last)
+{
+  const s64 x = vertex.x;
+  const s64 y = vertex.y;
+  const s64 z = vertex.z;
+
   // MAC0=(((H*20000h/SZ3)+1)/2)*IR1+OFX, SX2=MAC0/10000h ;ScrX FIFO -400h..+3FFh
   // MAC0=(((H*20000h/SZ3)+1)/2)*IR2+OFY, SY2=MAC0/10000h ;ScrY FIFO -400h..+3FFh
-  const s64 result = static_cast<s64>(ZeroExtend64(UNRDivide(REGS.H, REGS.SZ3)));
+  const s64 result = static_cast<s64>(ZeroExtend64(quotient));
 
   s64 Sx;
   switch (s_aspect_ratio)
   {
     case DisplayAspectRatio::R16_9:
-      Sx = ((((s64(result) * s64(REGS.IR1)) * s64(3)) / s64(4)) + s64(REGS.OFX));
+      Sx = ((((s64(result) * s64(vertex.ir1)) * s64(3)) / s64(4)) + s64(REGS.OFX));
       break;
 
     case DisplayAspectRatio::R19_9:
-      Sx = ((((s64(result) * s64(REGS.IR1)) * s64(12)) / s64(19)) + s64(REGS.OFX));
+      Sx = ((((s64(result) * s64(vertex.ir1)) * s64(12)) / s64(19)) + s64(REGS.OFX));
       break;
 
     case DisplayAspectRatio::R20_9:
-      Sx = ((((s64(result) * s64(REGS.IR1)) * s64(3)) / s64(5)) + s64(REGS.OFX));
+      Sx = ((((s64(result) * s64(vertex.ir1)) * s64(3)) / s64(5)) + s64(REGS.OFX));
       break;
 
     case DisplayAspectRatio::Custom:
     case DisplayAspectRatio::MatchWindow:
-      Sx = ((((s64(result) * s64(REGS.IR1)) * s64(s_custom_aspect_ratio_numerator)) /
+      Sx = ((((s64(result) * s64(vertex.ir1)) * s64(s_custom_aspect_ratio_numerator)) /
              s64(s_custom_aspect_ratio_denominator)) +
             s64(REGS.OFX));
       break;
@@ -697,11 +729,11 @@ static void RTPS(const s16 V[3], u8 shift, bool lm, bool last)
     case DisplayAspectRatio::R4_3:
     case DisplayAspectRatio::PAR1_1:
     default:
-      Sx = (s64(result) * s64(REGS.IR1) + s64(REGS.OFX));
+      Sx = (s64(result) * s64(vertex.ir1) + s64(REGS.OFX));
       break;
   }
 
-  const s64 Sy = s64(result) * s64(REGS.IR2) + s64(REGS.OFY);
+  const s64 Sy = s64(result) * s64(vertex.ir2) + s64(REGS.OFY);
   CheckMACOverflow<0>(Sx);
   CheckMACOverflow<0>(Sy);
   PushSXY(s32(Sx >> 16), s32(Sy >> 16));
@@ -728,9 +760,9 @@ static void RTPS(const s16 V[3], u8 shift, bool lm, bool last)
     }
     else
     {
-      precise_sz3 = float(REGS.SZ3);
-      precise_ir1 = float(REGS.IR1);
-      precise_ir2 = float(REGS.IR2);
+      precise_sz3 = float(vertex.sz3);
+      precise_ir1 = float(vertex.ir1);
+      precise_ir2 = float(vertex.ir2);
     }
 
     // this can potentially use increased precision on Z
@@ -784,6 +816,12 @@ static void RTPS(const s16 V[3], u8 shift, bool lm, bool last)
   }
 }
 
+static void RTPS(const s16 V[3], u8 shift, bool lm, bool last)
+{
+  const RTPSVertex vertex = RTPSTransform(V, shift, lm);
+  RTPSProject(vertex, UNRDivide(REGS.H, vertex.sz3), shift, lm, last);
+}
+
 static void Execute_RTPS(Instruction inst)
 {
   REGS.FLAG.Clear();
@@ -798,9 +836,19 @@ static void Execute_RTPT(Instruction inst)
   const u8 shift = inst.GetShift();
   const bool lm = inst.lm;
 
-  RTPS(REGS.V0, shift, lm, false);
-  RTPS(REGS.V1, shift, lm, false);
-  RTPS(REGS.V2, shift, lm, true);
+  // The three divides only depend on their own vertex's SZ, so run all transforms first and keep the divides
+  // independent of each other. This writes registers in a different order than three sequential RTPS, which is only
+  // safe because RTPSProject() reads nothing a transform writes: just the vertex copy, H, OFX/OFY and DQA/DQB. The
+  // FIFOs and MAC/IR end up the same, and FLAG bits are only ever ORed in.
+  const RTPSVertex v0 = RTPSTransform(REGS.V0, shift, lm);
+  const RTPSVertex v1 = RTPSTransform(REGS.V1, shift, lm);
+  const RTPSVertex v2 = RTPSTransform(REGS.V2, shift, lm);
+  const u32 q0 = UNRDivide(REGS.H, v0.sz3);
+  const u32 q1 = UNRDivide(REGS.H, v1.sz3);
+  const u32 q2 = UNRDivide(REGS.H, v2.sz3);
+  RTPSProject(v0, q0, shift, lm, false);
+  RTPSProject(v1, q1, shift, lm, false);
+  RTPSProject(v2, q2, shift, lm, true);
 
   REGS.FLAG.UpdateError();
 }
@@ -1309,7 +1357,7 @@ InstructionImpl GetInstructionImpl(u32 inst_bits, TickCount* ticks)
 
     case 0x12:
       *ticks = 8;
-      return &Execute_MVMVA;
+      return GetMVMVAImpl(inst);
 
     case 0x13:
       *ticks = 19;
@@ -113,6 +113,9 @@ void DisplayLoadingScreen(const char* message, int progress_min = -1, int progre
 /// Intensity is normalized from 0 to 1.
 void SetPadVibrationIntensity(u32 pad_index, float large_or_single_motor_intensity, float small_motor_intensity);
 
+/// Internal method used by pads to pick up the newest host input when the game starts reading a device.
+void LatchPadInput();
+
 /// Enables "relative" mouse mode, locking the cursor position and returning relative coordinates.
 void SetMouseMode(bool relative, bool hide_cursor);
 
@@ -41,6 +41,30 @@ bool HostDisplay::UpdateTexture(GPUTexture* texture, u32 x, u32 y, u32 width, u3
   return true;
 }
 
+bool HostDisplay::BeginTextureFieldUpdate(GPUTexture* texture, u32 width, u32 height, u32 field, void** out_buffer,
+                                          u32* out_pitch)
+{
+  const u32 pitch = Common::AlignUpPow2(width * texture->GetPixelSize(), 4);
+  if (m_field_update_texture != texture || m_field_update_pitch != pitch ||
+      m_field_update_buffer.size() != (pitch * height))
+  {
+    // new texture, so there's no previous field to keep
+    m_field_update_buffer.clear();
+    m_field_update_buffer.resize(pitch * height);
+    m_field_update_texture = texture;
+    m_field_update_pitch = pitch;
+  }
+
+  *out_buffer = m_field_update_buffer.data() + (field * pitch);
+  *out_pitch = pitch * 2;
+  return true;
+}
+
+void HostDisplay::EndTextureFieldUpdate(GPUTexture* texture, u32 width, u32 height, u32 field)
+{
+  UpdateTexture(texture, 0, 0, width, height, m_field_update_buffer.data(), m_field_update_pitch);
+}
+
 bool HostDisplay::ParseFullscreenMode(const std::string_view& mode, u32* width, u32* height, float* refresh_rate)
 {
   if (!mode.empty())
@@ -92,6 +116,37 @@ std::string HostDisplay::GetFullscreenModeString(u32 width, u32 height, float re
   return StringUtil::StdStringFromFormat("%u x %u @ %f hz", width, height, refresh_rate);
 }
 
+bool HostDisplay::BeginScreenshotReadback(u32 width, u32 height)
+{
+  m_screenshot_readback_pixels.clear();
+  if (!RenderScreenshot(width, height, &m_screenshot_readback_pixels, &m_screenshot_readback_stride,
+                        &m_screenshot_readback_format))
+  {
+    return false;
+  }
+
+  if (UsesLowerLeftOrigin() && m_screenshot_readback_format == GPUTexture::Format::RGBA8 &&
+      m_screenshot_readback_stride == (width * sizeof(u32)))
+  {
+    GPUTexture::FlipTextureDataRGBA8(width, height, m_screenshot_readback_pixels, m_screenshot_readback_stride);
+  }
+
+  return true;
+}
+
+bool HostDisplay::FinishScreenshotReadback(std::vector<u32>* out_pixels, u32* out_stride,
+                                           GPUTexture::Format* out_format)
+{
+  if (m_screenshot_readback_pixels.empty())
+    return false;
+
+  *out_pixels = std::move(m_screenshot_readback_pixels);
+  *out_stride = m_screenshot_readback_stride;
+  *out_format = m_screenshot_readback_format;
+  m_screenshot_readback_pixels = {};
+  return true;
+}
+
 bool HostDisplay::UsesLowerLeftOrigin() const
 {
   const RenderAPI api = GetRenderAPI();
@@ -138,6 +193,23 @@ float HostDisplay::GetAndResetAccumulatedGPUTime()
   return 0.0f;
 }
 
+float HostDisplay::GetAndResetAccumulatedFenceWaitTime()
+{
+  return 0.0f;
+}
+
+bool HostDisplay::GetAndResetAccumulatedGPUSectionTimes(GPUSectionTimes* times)
+{
+  return false;
+}
+
+const char* HostDisplay::GetGPUTimingSectionName(GPUTimingSection section)
+{
+  static constexpr std::array<const char*, static_cast<size_t>(GPUTimingSection::Count)> names = {
+    {"Batches", "VRAM Fill", "VRAM Copy", "VRAM Write", "VRAM Readback", "Downsample", "Display", "Post-Processing"}};
+  return names[static_cast<size_t>(section)];
+}
+
 void HostDisplay::SetSoftwareCursor(std::unique_ptr<GPUTexture> texture, float scale /*= 1.0f*/)
 {
   m_cursor_texture = std::move(texture);
@@ -454,8 +526,8 @@ bool HostDisplay::WriteTextureToFile(GPUTexture* texture, u32 x, u32 y, u32 widt
   return true;
 }
 
-bool HostDisplay::WriteDisplayTextureToFile(std::string filename, bool full_resolution /* = true */,
-                                            bool apply_aspect_ratio /* = true */, bool compress_on_thread /* = false */)
+bool HostDisplay::CalculateDisplayTextureOutputSize(bool full_resolution, bool apply_aspect_ratio, u32* width,
+                                                    u32* height) const
 {
   if (!m_display_texture)
     return false;
@@ -484,6 +556,18 @@ bool HostDisplay::WriteDisplayTextureToFile(std::string filename, bool full_reso
   if (resize_width <= 0 || resize_height <= 0)
     return false;
 
+  *width = static_cast<u32>(resize_width);
+  *height = static_cast<u32>(resize_height);
+  return true;
+}
+
+bool HostDisplay::WriteDisplayTextureToFile(std::string filename, bool full_resolution /* = true */,
+                                            bool apply_aspect_ratio /* = true */, bool compress_on_thread /* = false */)
+{
+  u32 resize_width, resize_height;
+  if (!CalculateDisplayTextureOutputSize(full_resolution, apply_aspect_ratio, &resize_width, &resize_height))
+    return false;
+
   const bool flip_y = (m_display_texture_view_height < 0);
   s32 read_height = m_display_texture_view_height;
   s32 read_y = m_display_texture_view_y;
@@ -495,8 +579,8 @@ bool HostDisplay::WriteDisplayTextureToFile(std::string filename, bool full_reso
   }
 
   return WriteTextureToFile(m_display_texture, m_display_texture_view_x, read_y, m_display_texture_view_width,
-                            read_height, std::move(filename), true, flip_y, static_cast<u32>(resize_width),
-                            static_cast<u32>(resize_height), compress_on_thread);
+                            read_height, std::move(filename), true, flip_y, resize_width, resize_height,
+                            compress_on_thread);
 }
 
 bool HostDisplay::WriteDisplayTextureToBuffer(std::vector<u32>* buffer, u32 resize_width /* = 0 */,
@@ -3,6 +3,7 @@
 #include "common/rectangle.h"
 #include "common/window_info.h"
 #include "types.h"
+#include <array>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -104,6 +105,12 @@ public:
 
   virtual bool UpdateTexture(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height, const void* data, u32 pitch);
 
+  /// Maps one field (every second row, starting at row field) of a whole-texture update for writing. The rows of the
+  /// other field keep the contents from their last update. out_pitch is the distance between consecutive field rows.
+  virtual bool BeginTextureFieldUpdate(GPUTexture* texture, u32 width, u32 height, u32 field, void** out_buffer,
+                                       u32* out_pitch);
+  virtual void EndTextureFieldUpdate(GPUTexture* texture, u32 width, u32 height, u32 field);
+
   virtual bool DownloadTexture(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height, void* out_data,
                                u32 out_data_stride) = 0;
 
@@ -114,6 +121,12 @@ public:
   virtual bool RenderScreenshot(u32 width, u32 height, std::vector<u32>* out_pixels, u32* out_stride,
                                 GPUTexture::Format* out_format) = 0;
 
+  /// Renders a screenshot like RenderScreenshot(), but only starts reading it back. The pixels, with the first row at
+  /// the top, are collected by FinishScreenshotReadback(), ideally a frame later so the GPU doesn't have to be waited
+  /// on. Only one readback can be in flight; the default implementation reads back immediately.
+  virtual bool BeginScreenshotReadback(u32 width, u32 height);
+  virtual bool FinishScreenshotReadback(std::vector<u32>* out_pixels, u32* out_stride, GPUTexture::Format* out_format);
+
   virtual void SetVSync(bool enabled) = 0;
 
   /// ImGui context management, usually called by derived classes.
@@ -128,6 +141,7 @@ public:
   void ClearDisplayTexture()
   {
     m_display_texture = nullptr;
+    m_field_update_texture = nullptr;
     m_display_texture_view_x = 0;
     m_display_texture_view_y = 0;
     m_display_texture_view_width = 0;
@@ -177,6 +191,16 @@ public:
   /// Returns the amount of GPU time utilized since the last time this method was called.
   virtual float GetAndResetAccumulatedGPUTime();
 
+  /// Returns the CPU time spent waiting on GPU fences since the last time this method was called.
+  virtual float GetAndResetAccumulatedFenceWaitTime();
+
+  /// Returns the GPU time spent in each section since the last time this method was called.
+  /// Returns false if the backend does not record per-section timings.
+  using GPUSectionTimes = std::array<float, static_cast<size_t>(GPUTimingSection::Count)>;
+  virtual bool GetAndResetAccumulatedGPUSectionTimes(GPUSectionTimes* times);
+
+  static const char* GetGPUTimingSectionName(GPUTimingSection section);
+
   void SetDisplayTopMargin(s32 height) { m_display_top_margin = height; }
   void SetDisplayAlignment(Alignment alignment) { m_display_alignment = alignment; }
 
@@ -205,6 +229,9 @@ public:
                           bool clear_alpha = true, bool flip_y = false, u32 resize_width = 0, u32 resize_height = 0,
                           bool compress_on_thread = false);
 
+  /// Helper function for computing the size of the display texture when saved, optionally corrected for aspect ratio.
+  bool CalculateDisplayTextureOutputSize(bool full_resolution, bool apply_aspect_ratio, u32* width, u32* height) const;
+
   /// Helper function to save current display texture to PNG.
   bool WriteDisplayTextureToFile(std::string filename, bool full_resolution = true, bool apply_aspect_ratio = true,
                                  bool compress_on_thread = false);
@@ -251,12 +278,22 @@ protected:
   s32 m_display_texture_view_width = 0;
   s32 m_display_texture_view_height = 0;
 
+  // Shadow copy for field updates on backends which can't write to part of a texture in place.
+  std::vector<u8> m_field_update_buffer;
+  const GPUTexture* m_field_update_texture = nullptr;
+  u32 m_field_update_pitch = 0;
+
   s32 m_display_top_margin = 0;
   Alignment m_display_alignment = Alignment::Center;
 
   std::unique_ptr<GPUTexture> m_cursor_texture;
   float m_cursor_texture_scale = 1.0f;
 
+  // result of the default BeginScreenshotReadback(), handed out by FinishScreenshotReadback()
+  std::vector<u32> m_screenshot_readback_pixels;
+  u32 m_screenshot_readback_stride = 0;
+  GPUTexture::Format m_screenshot_readback_format = GPUTexture::Format::Unknown;
+
   bool m_display_changed = false;
   bool m_gpu_timing_enabled = false;
 };
@@ -0,0 +1,189 @@
+#include "host_time_accounting.h"
+#include "common/assert.h"
+#include "common/log.h"
+#include "common/string.h"
+#include "timing_event.h"
+#include <algorithm>
+#include <array>
+Log_SetChannel(HostTimeAccounting);
+
+namespace HostTimeAccounting {
+
+static void AddAverage(std::string name, Common::Timer::Value time, Common::Timer::Value elapsed, u32 frames);
+
+// events can be serviced early from inside other events' callbacks, so this can nest a few levels deep
+static constexpr u32 MAX_SECTION_DEPTH = 16;
+
+// sections which took less than this percentage of the interval are left out of the overlay
+static constexpr float MIN_DISPLAYED_USAGE = 0.1f;
+
+// number of frames kept for DumpRecentFrames(), and sections shorter than this (in milliseconds) are left out
+static constexpr u32 FRAME_HISTORY_SIZE = 8;
+static constexpr float MIN_DUMPED_TIME = 0.05f;
+
+static constexpr std::array<const char*, static_cast<size_t>(Section::Count)> s_section_names = {
+  {"Recompiled Code", "Interpreter", "Block Compile", "GPU Commands", "MDEC", "SPU", "Shader Compile", "CD Wait",
+   "GPU Sync"}};
+
+namespace {
+struct FrameRecord
+{
+  float frame_time;
+  float event_time;
+  std::array<float, static_cast<size_t>(Section::Count)> section_times;
+};
+} // namespace
+
+bool g_enabled = false;
+
+// sections are charged to the current frame, then moved to the interval totals at the end of the frame
+static std::array<Common::Timer::Value, static_cast<size_t>(Section::Count)> s_section_times = {};
+static std::array<Common::Timer::Value, static_cast<size_t>(Section::Count)> s_interval_section_times = {};
+static Common::Timer::Value s_interval_event_time = 0;
+static std::array<Common::Timer::Value*, MAX_SECTION_DEPTH> s_section_stack;
+static u32 s_section_depth = 0;
+static Common::Timer::Value s_last_transition_time = 0;
+
+static std::vector<SectionTime> s_averages;
+
+static std::array<FrameRecord, FRAME_HISTORY_SIZE> s_frame_history;
+static u32 s_frame_history_position = 0;
+static u32 s_frame_history_count = 0;
+
+} // namespace HostTimeAccounting
+
+void HostTimeAccounting::SetEnabled(bool enabled)
+{
+  DebugAssert(s_section_depth == 0);
+  if (g_enabled == enabled)
+    return;
+
+  g_enabled = enabled;
+  Reset();
+  s_averages.clear();
+}
+
+void HostTimeAccounting::Reset()
+{
+  s_section_times.fill(0);
+  s_interval_section_times.fill(0);
+  s_interval_event_time = 0;
+  s_frame_history_position = 0;
+  s_frame_history_count = 0;
+  TimingEvents::EnumerateEvents([](TimingEvent* event) { event->m_host_time = 0; });
+}
+
+void HostTimeAccounting::EnterSection(Common::Timer::Value* accumulator)
+{
+  DebugAssert(s_section_depth < MAX_SECTION_DEPTH);
+
+  const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
+  if (s_section_depth > 0)
+    *s_section_stack[s_section_depth - 1] += current_time - s_last_transition_time;
+
+  s_section_stack[s_section_depth++] = accumulator;
+  s_last_transition_time = current_time;
+}
+
+void HostTimeAccounting::EnterSection(Section section)
+{
+  EnterSection(&s_section_times[static_cast<size_t>(section)]);
+}
+
+void HostTimeAccounting::LeaveSection()
+{
+  DebugAssert(s_section_depth > 0);
+
+  const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
+  *s_section_stack[--s_section_depth] += current_time - s_last_transition_time;
+  s_last_transition_time = current_time;
+}
+
+void HostTimeAccounting::AddAverage(std::string name, Common::Timer::Value time, Common::Timer::Value elapsed,
+                                    u32 frames)
+{
+  const float usage = static_cast<float>(static_cast<double>(time) * 100.0 / static_cast<double>(elapsed));
+  if (usage < MIN_DISPLAYED_USAGE)
+    return;
+
+  s_averages.push_back(SectionTime{
+    std::move(name), usage,
+    static_cast<float>(Common::Timer::ConvertValueToMilliseconds(time) / static_cast<double>(std::max(frames, 1u)))});
+}
+
+void HostTimeAccounting::EndFrame(float frame_time)
+{
+  if (!g_enabled)
+    return;
+
+  FrameRecord& record = s_frame_history[s_frame_history_position];
+  record.frame_time = frame_time;
+  for (size_t i = 0; i < s_section_times.size(); i++)
+  {
+    record.section_times[i] = static_cast<float>(Common::Timer::ConvertValueToMilliseconds(s_section_times[i]));
+    s_interval_section_times[i] += s_section_times[i];
+    s_section_times[i] = 0;
+  }
+
+  // events keep accumulating over the whole interval, so the frame's share is the difference since the last frame
+  Common::Timer::Value event_time = 0;
+  TimingEvents::EnumerateEvents([&event_time](TimingEvent* event) { event_time += event->m_host_time; });
+  record.event_time = static_cast<float>(Common::Timer::ConvertValueToMilliseconds(event_time - s_interval_event_time));
+  s_interval_event_time = event_time;
+
+  s_frame_history_position = (s_frame_history_position + 1) % FRAME_HISTORY_SIZE;
+  s_frame_history_count = std::min(s_frame_history_count + 1, FRAME_HISTORY_SIZE);
+}
+
+void HostTimeAccounting::DumpRecentFrames()
+{
+  if (!g_enabled)
+    return;
+
+  LargeString line;
+  for (u32 i = 0; i < s_frame_history_count; i++)
+  {
+    const u32 index = (s_frame_history_position + FRAME_HISTORY_SIZE - s_frame_history_count + i) % FRAME_HISTORY_SIZE;
+    const FrameRecord& record = s_frame_history[index];
+
+    line.Fmt("  Frame -{}: {:.2f} ms", s_frame_history_count - 1 - i, record.frame_time);
+    for (size_t j = 0; j < record.section_times.size(); j++)
+    {
+      if (record.section_times[j] >= MIN_DUMPED_TIME)
+        line.AppendFmtString(", {} {:.2f} ms", s_section_names[j], record.section_times[j]);
+    }
+    if (record.event_time >= MIN_DUMPED_TIME)
+      line.AppendFmtString(", Events {:.2f} ms", record.event_time);
+
+    Log_WarningPrint(line);
+  }
+}
+
+void HostTimeAccounting::UpdateAverages(Common::Timer::Value elapsed, u32 frames)
+{
+  s_averages.clear();
+  if (!g_enabled || elapsed == 0)
+    return;
+
+  for (size_t i = 0; i < s_section_times.size(); i++)
+  {
+    // anything charged since the last EndFrame() belongs to the next frame, but is still part of this interval
+    AddAverage(s_section_names[i], s_interval_section_times[i] + s_section_times[i], elapsed, frames);
+    s_interval_section_times[i] = 0;
+    s_section_times[i] = 0;
+  }
+
+  TimingEvents::EnumerateEvents([elapsed, frames](TimingEvent* event) {
+    AddAverage(event->GetName(), event->m_host_time, elapsed, frames);
+    event->m_host_time = 0;
+  });
+  s_interval_event_time = 0;
+
+  std::sort(s_averages.begin(), s_averages.end(),
+            [](const SectionTime& lhs, const SectionTime& rhs) { return lhs.time > rhs.time; });
+}
+
+const std::vector<HostTimeAccounting::SectionTime>& HostTimeAccounting::GetAverages()
+{
+  return s_averages;
+}
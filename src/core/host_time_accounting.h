@@ -0,0 +1,83 @@
+#pragma once
+#include "common/timer.h"
+#include "types.h"
+#include <string>
+#include <vector>
+
+// Attributes host time on the CPU thread to the emulated subsystems, for the performance overlay. Sections nest, and
+// the time is exclusive, i.e. GPU commands processed during a DMA from recompiled code are not counted twice.
+namespace HostTimeAccounting {
+
+enum class Section : u8
+{
+  RecompiledCode,
+  Interpreter,
+  BlockCompile,
+  GPUCommands,
+  MDEC,
+  SPU,
+  ShaderCompile,
+  CDWait,
+  GPUSync,
+  Count
+};
+
+struct SectionTime
+{
+  std::string name;
+  float usage; // percentage of wall time
+  float time;  // milliseconds per frame
+};
+
+extern bool g_enabled;
+
+/// Enables or disables accounting. Must not be called while any sections are active.
+void SetEnabled(bool enabled);
+
+/// Clears the time accumulated since the last update.
+void Reset();
+
+/// Records the time accumulated during the frame which just finished, for DumpRecentFrames().
+void EndFrame(float frame_time);
+
+/// Writes the breakdown of the last few frames to the log, oldest first.
+void DumpRecentFrames();
+
+/// Computes the averages for the time since the last update, and resets the accumulators.
+void UpdateAverages(Common::Timer::Value elapsed, u32 frames);
+
+/// Returns the averages from the last update, ordered by time, with insignificant sections omitted.
+const std::vector<SectionTime>& GetAverages();
+
+/// Time is charged to the accumulator until the matching LeaveSection(), or another section is entered.
+void EnterSection(Common::Timer::Value* accumulator);
+void EnterSection(Section section);
+void LeaveSection();
+
+class ScopedSection
+{
+public:
+  ALWAYS_INLINE ScopedSection(Section section) : m_active(g_enabled)
+  {
+    if (m_active)
+      EnterSection(section);
+  }
+  ALWAYS_INLINE ScopedSection(Common::Timer::Value* accumulator) : m_active(g_enabled)
+  {
+    if (m_active)
+      EnterSection(accumulator);
+  }
+  ALWAYS_INLINE ~ScopedSection()
+  {
+    if (m_active)
+      LeaveSection();
+  }
+
+  ScopedSection(const ScopedSection&) = delete;
+  ScopedSection& operator=(const ScopedSection&) = delete;
+
+private:
+  bool m_active;
+};
+
+} // namespace HostTimeAccounting
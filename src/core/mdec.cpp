@@ -3,12 +3,23 @@
 #include "cpu_core.h"
 #include "dma.h"
 #include "host.h"
+#include "host_time_accounting.h"
 #include "imgui.h"
 #include "interrupt_controller.h"
 #include "system.h"
 #include "util/state_wrapper.h"
 Log_SetChannel(MDEC);
 
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 MDEC g_mdec;
 
 MDEC::MDEC() = default;
@@ -233,6 +244,7 @@ void MDEC::WriteCommandRegister(u32 value)
 
 void MDEC::Execute()
 {
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::MDEC);
   for (;;)
   {
     switch (m_state)
@@ -436,6 +448,7 @@ void MDEC::ScheduleBlockCopyOut(TickCount ticks)
 
 void MDEC::CopyOutBlock()
 {
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::MDEC);
   Assert(m_state == State::WritingMacroblock);
   m_block_copy_out_event->Deactivate();
 
@@ -475,62 +488,72 @@ void MDEC::CopyOutBlock()
 
     case DataOutputDepth_24Bit:
     {
-      // pack tightly
-      u32 index = 0;
-      u32 state = 0;
-      u32 rgb = 0;
-      while (index < m_block_rgb.size())
-      {
-        switch (state)
-        {
-          case 0:
-            rgb = m_block_rgb[index++]; // RGB-
-            state = 1;
-            break;
-          case 1:
-            rgb |= (m_block_rgb[index] & 0xFF) << 24; // RGBR
-            m_data_out_fifo.Push(rgb);
-            rgb = m_block_rgb[index] >> 8; // GB--
-            index++;
-            state = 2;
-            break;
-          case 2:
-            rgb |= m_block_rgb[index] << 16; // GBRG
-            m_data_out_fifo.Push(rgb);
-            rgb = m_block_rgb[index] >> 16; // B---
-            index++;
-            state = 3;
-            break;
-          case 3:
-            rgb |= m_block_rgb[index] << 8; // BRGB
-            m_data_out_fifo.Push(rgb);
-            index++;
-            state = 0;
-            break;
-        }
-      }
+      // pack tightly, the pixels are stored as RGB- so the first three bytes of each are the output
+      std::array<u32, std::tuple_size_v<decltype(m_block_rgb)> * 3 / 4> packed;
+      u8* out_ptr = reinterpret_cast<u8*>(packed.data());
+      for (u32 i = 0; i < static_cast<u32>(m_block_rgb.size()); i++)
+        std::memcpy(out_ptr + i * 3, &m_block_rgb[i], 3);
+
+      m_data_out_fifo.PushRange(packed.data(), static_cast<u32>(packed.size()));
       break;
     }
 
     case DataOutputDepth_15Bit:
     {
+      std::array<u32, std::tuple_size_v<decltype(m_block_rgb)> / 2> packed;
       const u16 a = ZeroExtend16(m_status.data_output_bit15.GetValue());
-      for (u32 i = 0; i < static_cast<u32>(m_block_rgb.size());)
+
+#if defined(CPU_X64)
+      // the 15-bit colours are below 0x8000, so the signed pack doesn't saturate them
+      const __m128i mask = _mm_set1_epi32(0x1F);
+      const __m128i alpha = _mm_set1_epi16(static_cast<s16>(a << 15));
+      const auto convert = [&mask](__m128i color) {
+        const __m128i r = _mm_and_si128(_mm_srli_epi32(color, 3), mask);
+        const __m128i g = _mm_and_si128(_mm_srli_epi32(color, 11), mask);
+        const __m128i b = _mm_and_si128(_mm_srli_epi32(color, 19), mask);
+        return _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 5)), _mm_slli_epi32(b, 10));
+      };
+      for (u32 i = 0; i < static_cast<u32>(m_block_rgb.size()); i += 8)
+      {
+        const __m128i lo = convert(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_block_rgb[i])));
+        const __m128i hi = convert(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_block_rgb[i + 4])));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&packed[i / 2]), _mm_or_si128(_mm_packs_epi32(lo, hi), alpha));
+      }
+#elif defined(CPU_AARCH64)
+      const uint32x4_t mask = vdupq_n_u32(0x1F);
+      const uint16x8_t alpha = vdupq_n_u16(static_cast<u16>(a << 15));
+      const auto convert = [&mask](uint32x4_t color) {
+        const uint32x4_t r = vandq_u32(vshrq_n_u32(color, 3), mask);
+        const uint32x4_t g = vandq_u32(vshrq_n_u32(color, 11), mask);
+        const uint32x4_t b = vandq_u32(vshrq_n_u32(color, 19), mask);
+        return vmovn_u32(vorrq_u32(vorrq_u32(r, vshlq_n_u32(g, 5)), vshlq_n_u32(b, 10)));
+      };
+      for (u32 i = 0; i < static_cast<u32>(m_block_rgb.size()); i += 8)
+      {
+        const uint16x8_t res =
+          vcombine_u16(convert(vld1q_u32(&m_block_rgb[i])), convert(vld1q_u32(&m_block_rgb[i + 4])));
+        vst1q_u32(&packed[i / 2], vreinterpretq_u32_u16(vorrq_u16(res, alpha)));
+      }
+#else
+      for (u32 i = 0; i < static_cast<u32>(m_block_rgb.size()); i += 2)
       {
-        u32 color = m_block_rgb[i++];
+        u32 color = m_block_rgb[i];
         u16 r = Truncate16((color >> 3) & 0x1Fu);
         u16 g = Truncate16((color >> 11) & 0x1Fu);
         u16 b = Truncate16((color >> 19) & 0x1Fu);
         const u16 color15a = r | (g << 5) | (b << 10) | (a << 15);
 
-        color = m_block_rgb[i++];
+        color = m_block_rgb[i + 1];
         r = Truncate16((color >> 3) & 0x1Fu);
         g = Truncate16((color >> 11) & 0x1Fu);
         b = Truncate16((color >> 19) & 0x1Fu);
         const u16 color15b = r | (g << 5) | (b << 10) | (a << 15);
 
-        m_data_out_fifo.Push(ZeroExtend32(color15a) | (ZeroExtend32(color15b) << 16));
+        packed[i / 2] = ZeroExtend32(color15a) | (ZeroExtend32(color15b) << 16);
       }
+#endif
+
+      m_data_out_fifo.PushRange(packed.data(), static_cast<u32>(packed.size()));
     }
     break;
 
@@ -623,6 +646,146 @@ bool MDEC::rl_decode_block(s16* blk, const u8* qt)
 
 void MDEC::IDCT(s16* blk)
 {
+#if defined(CPU_X64)
+  // Coefficients are clamped to 11 bits, so the first pass is exact in 32 bits. The second pass isn't (up to 2^46),
+  // and SSE2 has no signed 64-bit multiply, so each intermediate is split into 9/10/10-bit pieces, each of which can
+  // go through madd without overflowing, and the pieces are recombined with shifts. This is bit-exact with the scalar
+  // version below, including the round-to-nearest of the high 32 bits.
+  __m128i scale_rows[8];
+  for (u32 i = 0; i < 8; i++)
+    scale_rows[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_scale_table[i * 8]));
+
+  // the first pass broadcasts columns of the scale table, so transpose it
+  __m128i scale_cols[8];
+  {
+    const __m128i t0 = _mm_unpacklo_epi16(scale_rows[0], scale_rows[1]);
+    const __m128i t1 = _mm_unpackhi_epi16(scale_rows[0], scale_rows[1]);
+    const __m128i t2 = _mm_unpacklo_epi16(scale_rows[2], scale_rows[3]);
+    const __m128i t3 = _mm_unpackhi_epi16(scale_rows[2], scale_rows[3]);
+    const __m128i t4 = _mm_unpacklo_epi16(scale_rows[4], scale_rows[5]);
+    const __m128i t5 = _mm_unpackhi_epi16(scale_rows[4], scale_rows[5]);
+    const __m128i t6 = _mm_unpacklo_epi16(scale_rows[6], scale_rows[7]);
+    const __m128i t7 = _mm_unpackhi_epi16(scale_rows[6], scale_rows[7]);
+    const __m128i u0 = _mm_unpacklo_epi32(t0, t2);
+    const __m128i u1 = _mm_unpackhi_epi32(t0, t2);
+    const __m128i u2 = _mm_unpacklo_epi32(t1, t3);
+    const __m128i u3 = _mm_unpackhi_epi32(t1, t3);
+    const __m128i u4 = _mm_unpacklo_epi32(t4, t6);
+    const __m128i u5 = _mm_unpackhi_epi32(t4, t6);
+    const __m128i u6 = _mm_unpacklo_epi32(t5, t7);
+    const __m128i u7 = _mm_unpackhi_epi32(t5, t7);
+    scale_cols[0] = _mm_unpacklo_epi64(u0, u4);
+    scale_cols[1] = _mm_unpackhi_epi64(u0, u4);
+    scale_cols[2] = _mm_unpacklo_epi64(u1, u5);
+    scale_cols[3] = _mm_unpackhi_epi64(u1, u5);
+    scale_cols[4] = _mm_unpacklo_epi64(u2, u6);
+    scale_cols[5] = _mm_unpackhi_epi64(u2, u6);
+    scale_cols[6] = _mm_unpacklo_epi64(u3, u7);
+    scale_cols[7] = _mm_unpackhi_epi64(u3, u7);
+  }
+
+  // rows u and u+1 interleaved, so madd sums both products at once
+  __m128i block_pairs[8];
+  __m128i scale_pairs[8];
+  for (u32 i = 0; i < 4; i++)
+  {
+    const __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[i * 16]));
+    const __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[i * 16 + 8]));
+    block_pairs[i * 2] = _mm_unpacklo_epi16(r0, r1);
+    block_pairs[i * 2 + 1] = _mm_unpackhi_epi16(r0, r1);
+    scale_pairs[i * 2] = _mm_unpacklo_epi16(scale_rows[i * 2], scale_rows[i * 2 + 1]);
+    scale_pairs[i * 2 + 1] = _mm_unpackhi_epi16(scale_rows[i * 2], scale_rows[i * 2 + 1]);
+  }
+
+#define MADD_ROW(lo, hi, pairs, coeffs)                                                                               \
+  do                                                                                                                   \
+  {                                                                                                                    \
+    const __m128i c0 = _mm_shuffle_epi32(coeffs, _MM_SHUFFLE(0, 0, 0, 0));                                             \
+    const __m128i c1 = _mm_shuffle_epi32(coeffs, _MM_SHUFFLE(1, 1, 1, 1));                                             \
+    const __m128i c2 = _mm_shuffle_epi32(coeffs, _MM_SHUFFLE(2, 2, 2, 2));                                             \
+    const __m128i c3 = _mm_shuffle_epi32(coeffs, _MM_SHUFFLE(3, 3, 3, 3));                                             \
+    lo = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(pairs[0], c0), _mm_madd_epi16(pairs[2], c1)),                      \
+                       _mm_add_epi32(_mm_madd_epi16(pairs[4], c2), _mm_madd_epi16(pairs[6], c3)));                     \
+    hi = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(pairs[1], c0), _mm_madd_epi16(pairs[3], c1)),                      \
+                       _mm_add_epi32(_mm_madd_epi16(pairs[5], c2), _mm_madd_epi16(pairs[7], c3)));                     \
+  } while (0)
+
+  const __m128i mask = _mm_set1_epi32(0x3FF);
+  const __m128i round = _mm_set1_epi32(1 << 11);
+  for (u32 y = 0; y < 8; y++)
+  {
+    __m128i temp_lo, temp_hi;
+    MADD_ROW(temp_lo, temp_hi, block_pairs, scale_cols[y]);
+
+    // temp = a * 2^20 + b * 2^10 + c
+    const __m128i a = _mm_packs_epi32(_mm_srai_epi32(temp_lo, 20), _mm_srai_epi32(temp_hi, 20));
+    const __m128i b = _mm_packs_epi32(_mm_and_si128(_mm_srai_epi32(temp_lo, 10), mask),
+                                      _mm_and_si128(_mm_srai_epi32(temp_hi, 10), mask));
+    const __m128i c = _mm_packs_epi32(_mm_and_si128(temp_lo, mask), _mm_and_si128(temp_hi, mask));
+
+    __m128i a_lo, a_hi, b_lo, b_hi, c_lo, c_hi;
+    MADD_ROW(a_lo, a_hi, scale_pairs, a);
+    MADD_ROW(b_lo, b_hi, scale_pairs, b);
+    MADD_ROW(c_lo, c_hi, scale_pairs, c);
+
+    // sum >> 22 == a + ((b + (c >> 10)) >> 10), rounding is then just adding half before dropping the last 10 bits
+    __m128i lo = _mm_add_epi32(a_lo, _mm_srai_epi32(_mm_add_epi32(b_lo, _mm_srai_epi32(c_lo, 10)), 10));
+    __m128i hi = _mm_add_epi32(a_hi, _mm_srai_epi32(_mm_add_epi32(b_hi, _mm_srai_epi32(c_hi, 10)), 10));
+    lo = _mm_srai_epi32(_mm_add_epi32(lo, round), 12);
+    hi = _mm_srai_epi32(_mm_add_epi32(hi, round), 12);
+
+    // sign extend from 9 bits, then clamp
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 23), 23);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 23), 23);
+    const __m128i res =
+      _mm_max_epi16(_mm_min_epi16(_mm_packs_epi32(lo, hi), _mm_set1_epi16(127)), _mm_set1_epi16(-128));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&blk[y * 8]), res);
+  }
+
+#undef MADD_ROW
+#elif defined(CPU_AARCH64)
+  // NEON has widening 64-bit multiply-accumulate, so this is a direct translation of the scalar version.
+  int16x8_t block_rows[8];
+  int32x4_t scale_rows[8][2];
+  for (u32 i = 0; i < 8; i++)
+  {
+    block_rows[i] = vld1q_s16(&blk[i * 8]);
+    const int16x8_t scale_row = vld1q_s16(&m_scale_table[i * 8]);
+    scale_rows[i][0] = vmovl_s16(vget_low_s16(scale_row));
+    scale_rows[i][1] = vmovl_high_s16(scale_row);
+  }
+
+  for (u32 y = 0; y < 8; y++)
+  {
+    int32x4_t temp_lo = vdupq_n_s32(0);
+    int32x4_t temp_hi = vdupq_n_s32(0);
+    for (u32 u = 0; u < 8; u++)
+    {
+      temp_lo = vmlal_n_s16(temp_lo, vget_low_s16(block_rows[u]), m_scale_table[u * 8 + y]);
+      temp_hi = vmlal_high_n_s16(temp_hi, block_rows[u], m_scale_table[u * 8 + y]);
+    }
+
+    alignas(16) s32 temp[8];
+    vst1q_s32(&temp[0], temp_lo);
+    vst1q_s32(&temp[4], temp_hi);
+
+    int64x2_t sum[4] = {vdupq_n_s64(0), vdupq_n_s64(0), vdupq_n_s64(0), vdupq_n_s64(0)};
+    for (u32 u = 0; u < 8; u++)
+    {
+      sum[0] = vmlal_n_s32(sum[0], vget_low_s32(scale_rows[u][0]), temp[u]);
+      sum[1] = vmlal_high_n_s32(sum[1], scale_rows[u][0], temp[u]);
+      sum[2] = vmlal_n_s32(sum[2], vget_low_s32(scale_rows[u][1]), temp[u]);
+      sum[3] = vmlal_high_n_s32(sum[3], scale_rows[u][1], temp[u]);
+    }
+
+    int32x4_t lo = vcombine_s32(vrshrn_n_s64(sum[0], 32), vrshrn_n_s64(sum[1], 32));
+    int32x4_t hi = vcombine_s32(vrshrn_n_s64(sum[2], 32), vrshrn_n_s64(sum[3], 32));
+    lo = vshrq_n_s32(vshlq_n_s32(lo, 23), 23);
+    hi = vshrq_n_s32(vshlq_n_s32(hi, 23), 23);
+    const int16x8_t res = vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+    vst1q_s16(&blk[y * 8], vmaxq_s16(vminq_s16(res, vdupq_n_s16(127)), vdupq_n_s16(-128)));
+  }
+#else
   std::array<s64, 64> temp_buffer;
   for (u32 x = 0; x < 8; x++)
   {
@@ -646,11 +809,101 @@ void MDEC::IDCT(s16* blk)
         static_cast<s16>(std::clamp<s32>(SignExtendN<9, s32>((sum >> 32) + ((sum >> 31) & 1)), -128, 127));
     }
   }
+#endif
 }
 
 void MDEC::yuv_to_rgb(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const std::array<s16, 64>& Cbblk,
                       const std::array<s16, 64>& Yblk)
 {
+#if defined(CPU_X64)
+  // Same float operations as the scalar version, so the truncated results match exactly.
+  const __m128 r_scale = _mm_set1_ps(1.402f);
+  const __m128 b_scale = _mm_set1_ps(1.772f);
+  const __m128 gb_scale = _mm_set1_ps(-0.3437f);
+  const __m128 gr_scale = _mm_set1_ps(-0.7143f);
+  const __m128i min_value = _mm_set1_epi16(-128);
+  const __m128i max_value = _mm_set1_epi16(127);
+  const __m128i bias = _mm_set1_epi16(128);
+  const __m128i zero = _mm_setzero_si128();
+
+  for (u32 y = 0; y < 8; y++)
+  {
+    // each chroma sample covers two pixels
+    const u32 chroma_offset = (xx / 2) + ((y + yy) / 2) * 8;
+    const __m128i cr4 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&Crblk[chroma_offset]));
+    const __m128i cb4 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&Cbblk[chroma_offset]));
+    const __m128i cr = _mm_unpacklo_epi16(cr4, cr4);
+    const __m128i cb = _mm_unpacklo_epi16(cb4, cb4);
+
+    const __m128 cr_lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(cr, cr), 16));
+    const __m128 cr_hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(cr, cr), 16));
+    const __m128 cb_lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(cb, cb), 16));
+    const __m128 cb_hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(cb, cb), 16));
+
+    const __m128i r = _mm_packs_epi32(_mm_cvttps_epi32(_mm_mul_ps(r_scale, cr_lo)),
+                                      _mm_cvttps_epi32(_mm_mul_ps(r_scale, cr_hi)));
+    const __m128i g = _mm_packs_epi32(
+      _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(gb_scale, cb_lo), _mm_mul_ps(gr_scale, cr_lo))),
+      _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(gb_scale, cb_hi), _mm_mul_ps(gr_scale, cr_hi))));
+    const __m128i b = _mm_packs_epi32(_mm_cvttps_epi32(_mm_mul_ps(b_scale, cb_lo)),
+                                      _mm_cvttps_epi32(_mm_mul_ps(b_scale, cb_hi)));
+
+    // inputs are clamped to 8 bits, so none of the 16-bit adds can overflow
+    const __m128i luma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&Yblk[y * 8]));
+    const __m128i r8 = _mm_add_epi16(_mm_max_epi16(_mm_min_epi16(_mm_add_epi16(luma, r), max_value), min_value), bias);
+    const __m128i g8 = _mm_add_epi16(_mm_max_epi16(_mm_min_epi16(_mm_add_epi16(luma, g), max_value), min_value), bias);
+    const __m128i b8 = _mm_add_epi16(_mm_max_epi16(_mm_min_epi16(_mm_add_epi16(luma, b), max_value), min_value), bias);
+
+    const __m128i rg = _mm_or_si128(r8, _mm_slli_epi16(g8, 8));
+    u32* out = &m_block_rgb[xx + (y + yy) * 16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(rg, b8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(rg, b8));
+  }
+#elif defined(CPU_AARCH64)
+  // Separate multiplies and adds rather than fused, to match the rounding of the scalar version on x64.
+  const float32x4_t r_scale = vdupq_n_f32(1.402f);
+  const float32x4_t b_scale = vdupq_n_f32(1.772f);
+  const float32x4_t gb_scale = vdupq_n_f32(-0.3437f);
+  const float32x4_t gr_scale = vdupq_n_f32(-0.7143f);
+  const int16x8_t min_value = vdupq_n_s16(-128);
+  const int16x8_t max_value = vdupq_n_s16(127);
+  const int16x8_t bias = vdupq_n_s16(128);
+
+  for (u32 y = 0; y < 8; y++)
+  {
+    const u32 chroma_offset = (xx / 2) + ((y + yy) / 2) * 8;
+    const int16x4_t cr4 = vld1_s16(&Crblk[chroma_offset]);
+    const int16x4_t cb4 = vld1_s16(&Cbblk[chroma_offset]);
+    const int16x8_t cr = vcombine_s16(vzip1_s16(cr4, cr4), vzip2_s16(cr4, cr4));
+    const int16x8_t cb = vcombine_s16(vzip1_s16(cb4, cb4), vzip2_s16(cb4, cb4));
+
+    const float32x4_t cr_lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(cr)));
+    const float32x4_t cr_hi = vcvtq_f32_s32(vmovl_high_s16(cr));
+    const float32x4_t cb_lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(cb)));
+    const float32x4_t cb_hi = vcvtq_f32_s32(vmovl_high_s16(cb));
+
+    const int16x8_t r = vcombine_s16(vqmovn_s32(vcvtq_s32_f32(vmulq_f32(r_scale, cr_lo))),
+                                     vqmovn_s32(vcvtq_s32_f32(vmulq_f32(r_scale, cr_hi))));
+    const int16x8_t g =
+      vcombine_s16(vqmovn_s32(vcvtq_s32_f32(vaddq_f32(vmulq_f32(gb_scale, cb_lo), vmulq_f32(gr_scale, cr_lo)))),
+                   vqmovn_s32(vcvtq_s32_f32(vaddq_f32(vmulq_f32(gb_scale, cb_hi), vmulq_f32(gr_scale, cr_hi)))));
+    const int16x8_t b = vcombine_s16(vqmovn_s32(vcvtq_s32_f32(vmulq_f32(b_scale, cb_lo))),
+                                     vqmovn_s32(vcvtq_s32_f32(vmulq_f32(b_scale, cb_hi))));
+
+    const int16x8_t luma = vld1q_s16(&Yblk[y * 8]);
+    const uint16x8_t r8 =
+      vreinterpretq_u16_s16(vaddq_s16(vmaxq_s16(vminq_s16(vaddq_s16(luma, r), max_value), min_value), bias));
+    const uint16x8_t g8 =
+      vreinterpretq_u16_s16(vaddq_s16(vmaxq_s16(vminq_s16(vaddq_s16(luma, g), max_value), min_value), bias));
+    const uint16x8_t b8 =
+      vreinterpretq_u16_s16(vaddq_s16(vmaxq_s16(vminq_s16(vaddq_s16(luma, b), max_value), min_value), bias));
+
+    const uint16x8_t rg = vorrq_u16(r8, vshlq_n_u16(g8, 8));
+    u32* out = &m_block_rgb[xx + (y + yy) * 16];
+    vst1q_u32(out, vreinterpretq_u32_u16(vzip1q_u16(rg, b8)));
+    vst1q_u32(out + 4, vreinterpretq_u32_u16(vzip2q_u16(rg, b8)));
+  }
+#else
   for (u32 y = 0; y < 8; y++)
   {
     for (u32 x = 0; x < 8; x++)
@@ -677,6 +930,7 @@ void MDEC::yuv_to_rgb(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const st
                                                 (ZeroExtend32(static_cast<u16>(B)) << 16);
     }
   }
+#endif
 }
 
 void MDEC::y_to_mono(const std::array<s16, 64>& Yblk)
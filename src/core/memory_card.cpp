@@ -5,12 +5,37 @@
 #include "common/log.h"
 #include "common/path.h"
 #include "common/string_util.h"
+#include "common/threading.h"
 #include "host.h"
 #include "system.h"
 #include "util/state_wrapper.h"
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
 Log_SetChannel(MemoryCard);
 
+namespace {
+struct QueuedSave
+{
+  std::string filename;
+  std::unique_ptr<MemoryCardImage::DataArray> data;
+  bool display_osd_message;
+};
+} // namespace
+
+// cards are written on a worker thread from a copy of the image, so slow storage doesn't stall the game. saves of the
+// same file which are still waiting are merged, so only the newest image gets written.
+static std::deque<QueuedSave> s_queued_saves;
+static std::mutex s_save_mutex;
+static std::condition_variable s_save_work_cv;
+static std::condition_variable s_save_done_cv;
+static std::thread s_save_thread;
+static bool s_save_in_progress = false;
+static bool s_save_thread_shutdown = false;
+
 MemoryCard::MemoryCard()
 {
   m_FLAG.no_write_yet = true;
@@ -292,30 +317,95 @@ void MemoryCard::Format()
 
 bool MemoryCard::LoadFromFile()
 {
+  // the card may have been swapped out and back in before its last save was written
+  FlushSaves();
   return MemoryCardImage::LoadFromFile(&m_data, m_filename.c_str());
 }
 
-bool MemoryCard::SaveIfChanged(bool display_osd_message)
+void MemoryCard::SaveIfChanged(bool display_osd_message)
 {
   m_save_event->Deactivate();
 
   if (!m_changed)
-    return true;
+    return;
 
   m_changed = false;
 
   if (m_filename.empty())
-    return false;
+    return;
+
+  // write errors are reported by the save thread
+  QueueSave(m_filename, m_data, display_osd_message);
+}
+
+void MemoryCard::QueueSave(const std::string& filename, const MemoryCardImage::DataArray& data,
+                           bool display_osd_message)
+{
+  std::unique_lock lock(s_save_mutex);
+
+  // the front entry can't be replaced while it's being written
+  const auto begin = s_save_in_progress ? (s_queued_saves.begin() + 1) : s_queued_saves.begin();
+  for (auto it = begin; it != s_queued_saves.end(); ++it)
+  {
+    if (it->filename == filename)
+    {
+      std::memcpy(it->data->data(), data.data(), data.size());
+      it->display_osd_message |= display_osd_message;
+      return;
+    }
+  }
+
+  QueuedSave qs;
+  qs.filename = filename;
+  qs.data = std::make_unique<MemoryCardImage::DataArray>(data);
+  qs.display_osd_message = display_osd_message;
+  s_queued_saves.push_back(std::move(qs));
+
+  if (!s_save_thread.joinable())
+  {
+    s_save_thread_shutdown = false;
+    s_save_thread = std::thread(SaveThreadEntryPoint);
+  }
+
+  s_save_work_cv.notify_one();
+}
 
+void MemoryCard::SaveThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Memory Card Writer");
+
+  std::unique_lock lock(s_save_mutex);
+  for (;;)
+  {
+    s_save_work_cv.wait(lock, []() { return !s_queued_saves.empty() || s_save_thread_shutdown; });
+    if (s_queued_saves.empty())
+      break;
+
+    s_save_in_progress = true;
+    const QueuedSave& qs = s_queued_saves.front();
+    lock.unlock();
+    WriteSave(qs.filename, *qs.data, qs.display_osd_message);
+    lock.lock();
+
+    s_save_in_progress = false;
+    s_queued_saves.pop_front();
+    if (s_queued_saves.empty())
+      s_save_done_cv.notify_all();
+  }
+}
+
+bool MemoryCard::WriteSave(const std::string& filename, const MemoryCardImage::DataArray& data,
+                           bool display_osd_message)
+{
   std::string osd_key;
   std::string display_name;
   if (display_osd_message)
   {
-    osd_key = fmt::format("memory_card_save_{}", m_filename);
-    display_name = FileSystem::GetDisplayNameFromPath(m_filename);
+    osd_key = fmt::format("memory_card_save_{}", filename);
+    display_name = FileSystem::GetDisplayNameFromPath(filename);
   }
 
-  if (!MemoryCardImage::SaveToFile(m_data, m_filename.c_str()))
+  if (!MemoryCardImage::SaveToFile(data, filename.c_str()))
   {
     if (display_osd_message)
     {
@@ -341,6 +431,26 @@ bool MemoryCard::SaveIfChanged(bool display_osd_message)
   return true;
 }
 
+void MemoryCard::FlushSaves()
+{
+  std::unique_lock lock(s_save_mutex);
+  s_save_done_cv.wait(lock, []() { return s_queued_saves.empty(); });
+}
+
+void MemoryCard::StopSaveThread()
+{
+  std::unique_lock lock(s_save_mutex);
+  if (!s_save_thread.joinable())
+    return;
+
+  s_save_thread_shutdown = true;
+  s_save_work_cv.notify_one();
+  lock.unlock();
+
+  // anything still queued gets written before the thread exits
+  s_save_thread.join();
+}
+
 void MemoryCard::QueueFileSave()
 {
   // skip if the event is already pending, or we don't have a backing file
@@ -20,6 +20,12 @@ public:
   static std::unique_ptr<MemoryCard> Create();
   static std::unique_ptr<MemoryCard> Open(std::string_view filename);
 
+  /// Blocks until all queued card images have been written to disk.
+  static void FlushSaves();
+
+  /// Writes any queued card images, and stops the writer thread.
+  static void StopSaveThread();
+
   const MemoryCardImage::DataArray& GetData() const { return m_data; }
   MemoryCardImage::DataArray& GetData() { return m_data; }
   const std::string& GetFilename() const { return m_filename; }
@@ -78,8 +84,12 @@ private:
 
   static TickCount GetSaveDelayInTicks();
 
+  static void QueueSave(const std::string& filename, const MemoryCardImage::DataArray& data, bool display_osd_message);
+  static void SaveThreadEntryPoint();
+  static bool WriteSave(const std::string& filename, const MemoryCardImage::DataArray& data, bool display_osd_message);
+
   bool LoadFromFile();
-  bool SaveIfChanged(bool display_osd_message);
+  void SaveIfChanged(bool display_osd_message);
   void QueueFileSave();
 
   std::unique_ptr<TimingEvent> m_save_event;
@@ -0,0 +1,838 @@
+#include "netplay.h"
+#include "analog_controller.h"
+#include "common/assert.h"
+#include "common/error.h"
+#include "common/log.h"
+#include "common/string_util.h"
+#include "common/timer.h"
+#include "controller.h"
+#include "host.h"
+#include "host_settings.h"
+#include "pad.h"
+#include "settings.h"
+#include "system.h"
+#include "xxhash.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+Log_SetChannel(Netplay);
+
+#ifdef _WIN32
+#include "common/windows_headers.h"
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace Netplay {
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+static constexpr SocketHandle INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+#else
+using SocketHandle = int;
+static constexpr SocketHandle INVALID_SOCKET_HANDLE = -1;
+#endif
+
+namespace {
+
+enum : u32
+{
+  PROTOCOL_MAGIC = 0x504E5344, // DSNP
+  PROTOCOL_VERSION = 1,
+
+  // the emulator gets a state slot for every frame which can still be rolled back to
+  NUM_STATE_SLOTS = MAX_PREDICTION_FRAMES + 2,
+
+  // inputs are kept by frame, for as long as they can be resent or rolled back to
+  INPUT_HISTORY_SIZE = 128,
+  MAX_INPUTS_PER_PACKET = 32,
+
+  // states at multiples of this many frames are hashed, and the hashes compared once both sides have confirmed them
+  DESYNC_CHECK_INTERVAL = 30,
+  NUM_CHECKSUMS = 8,
+
+  // the side which is ahead waits a frame at most this often, until both are running in step
+  FRAME_ADVANTAGE_WINDOW = 16,
+  FRAME_ADVANTAGE_INTERVAL = 30,
+
+  HELLO_INTERVAL_MS = 250,
+  TIMEOUT_MS = 5000,
+
+  NO_FRAME = 0xFFFFFFFFu,
+};
+
+static_assert(MAX_PREDICTION_FRAMES + MAX_INPUT_DELAY + MAX_INPUTS_PER_PACKET < INPUT_HISTORY_SIZE);
+
+enum class PacketType : u8
+{
+  Hello,
+  Input,
+  Disconnect,
+};
+
+enum class SessionState : u8
+{
+  Inactive,
+  Connecting,
+  Running,
+};
+
+#pragma pack(push, 1)
+struct PadInput
+{
+  u32 buttons;
+  u32 analog;
+
+  bool operator==(const PadInput& rhs) const { return (buttons == rhs.buttons && analog == rhs.analog); }
+  bool operator!=(const PadInput& rhs) const { return (buttons != rhs.buttons || analog != rhs.analog); }
+};
+
+struct PacketHeader
+{
+  u32 magic;
+  u8 version;
+  PacketType type;
+};
+
+struct HelloPacket
+{
+  PacketHeader header;
+  u8 player;
+  u8 controller_type;
+  u8 connected;
+  u64 game_hash;
+};
+
+struct InputPacket
+{
+  PacketHeader header;
+
+  // all of the receiver's inputs before this frame have arrived
+  u32 ack_frame;
+
+  // frame the sender is about to run, and how far it thinks the receiver is ahead of it, for balancing
+  u32 current_frame;
+  s8 frame_advantage;
+
+  // newest hash of a state which the sender has confirmed, NO_FRAME if there isn't one yet
+  u32 checksum_frame;
+  u64 checksum;
+
+  u32 start_frame;
+  u8 num_inputs;
+  PadInput inputs[MAX_INPUTS_PER_PACKET];
+};
+#pragma pack(pop)
+
+static constexpr PadInput NEUTRAL_INPUT = {0, 0x80808080u};
+
+struct StateSlot
+{
+  u32 frame;
+  u64 checksum;
+  bool has_checksum;
+  bool checksum_sent;
+};
+
+struct Checksum
+{
+  u32 frame;
+  u64 checksum;
+};
+
+} // namespace
+
+static bool ParseSession(const std::string_view& session, u32* player, u16* local_port, std::string* host,
+                         u16* remote_port, u32* input_delay);
+static bool OpenSocket(u16 local_port, const std::string& host, u16 remote_port, Common::Error* error);
+static void CloseSocket();
+static void SendPacket(const void* data, size_t size);
+static void SendHello();
+static void SendInputs();
+static void ReceivePackets();
+static void HandleHello(const HelloPacket& packet);
+static void HandleInputs(const InputPacket& packet, size_t size);
+static void HandleRemoteChecksum(u32 frame, u64 checksum);
+static void EndSession(const char* message);
+
+static u64 GetGameHash();
+static PadInput ReadLocalInput();
+static void SimulateFrame(bool replaying);
+static void Rollback();
+static void UpdateConfirmedChecksums();
+static bool ShouldWaitForRemote();
+static float GetFrameAdvantage();
+
+static ALWAYS_INLINE u32 GetInputIndex(u32 frame)
+{
+  return frame % INPUT_HISTORY_SIZE;
+}
+
+static SessionState s_state = SessionState::Inactive;
+static SocketHandle s_socket = INVALID_SOCKET_HANDLE;
+static sockaddr_in s_remote_address = {};
+static std::string s_remote_name;
+static Common::Timer::Value s_last_receive_time = 0;
+static Common::Timer::Value s_last_hello_time = 0;
+
+static u32 s_local_player = 0;
+static u32 s_remote_player = 1;
+static u32 s_input_delay = DEFAULT_INPUT_DELAY;
+static std::unique_ptr<Controller> s_local_controller;
+static bool s_local_analog_mode = false;
+
+// next frame to run
+static u32 s_frame = 0;
+
+// local inputs exist for frames before s_local_input_frames, and the remote side has those before s_local_acked_frames
+static std::array<PadInput, INPUT_HISTORY_SIZE> s_local_inputs;
+static u32 s_local_input_frames = 0;
+static u32 s_local_acked_frames = 0;
+
+// remote inputs have arrived for frames before s_remote_input_frames, later frames ran with the predictions kept in
+// s_used_remote_inputs, and the earliest that was wrong is rolled back to
+static std::array<PadInput, INPUT_HISTORY_SIZE> s_remote_inputs;
+static std::array<PadInput, INPUT_HISTORY_SIZE> s_used_remote_inputs;
+static u32 s_remote_input_frames = 0;
+static u32 s_rollback_frame = NO_FRAME;
+
+static std::array<StateSlot, NUM_STATE_SLOTS> s_state_slots;
+
+static std::array<Checksum, NUM_CHECKSUMS> s_local_checksums;
+static std::array<Checksum, NUM_CHECKSUMS> s_remote_checksums;
+static u32 s_local_checksum_pos = 0;
+static u32 s_remote_checksum_pos = 0;
+static u32 s_last_remote_checksum_frame = NO_FRAME;
+static bool s_desync_reported = false;
+
+static std::array<s8, FRAME_ADVANTAGE_WINDOW> s_local_advantages;
+static std::array<s8, FRAME_ADVANTAGE_WINDOW> s_remote_advantages;
+static u32 s_advantage_pos = 0;
+static u32 s_last_wait_frame = 0;
+
+} // namespace Netplay
+
+bool Netplay::ParseSession(const std::string_view& session, u32* player, u16* local_port, std::string* host,
+                           u16* remote_port, u32* input_delay)
+{
+  const std::vector<std::string_view> parts(StringUtil::SplitString(session, ':', false));
+  const size_t num_parts = parts.size();
+  if (num_parts < 4 || num_parts > 5)
+    return false;
+
+  const std::optional<u32> player_number = StringUtil::FromChars<u32>(parts[0]);
+  const std::optional<u16> local = StringUtil::FromChars<u16>(parts[1]);
+  const std::optional<u16> remote = StringUtil::FromChars<u16>(parts[3]);
+  const std::optional<u32> delay =
+    (num_parts > 4) ? StringUtil::FromChars<u32>(parts[4]) : std::optional<u32>(DEFAULT_INPUT_DELAY);
+  if (!player_number.has_value() || player_number.value() < 1 || player_number.value() > NUM_PLAYERS ||
+      !local.has_value() || parts[2].empty() || !remote.has_value() || !delay.has_value() ||
+      delay.value() > MAX_INPUT_DELAY)
+  {
+    return false;
+  }
+
+  *player = player_number.value() - 1;
+  *local_port = local.value();
+  *host = parts[2];
+  *remote_port = remote.value();
+  *input_delay = delay.value();
+  return true;
+}
+
+bool Netplay::OpenSocket(u16 local_port, const std::string& host, u16 remote_port, Common::Error* error)
+{
+#ifdef _WIN32
+  WSADATA wsa_data;
+  const int wsa_error = WSAStartup(MAKEWORD(2, 2), &wsa_data);
+  if (wsa_error != 0)
+  {
+    error->SetSocket(wsa_error);
+    return false;
+  }
+#endif
+
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_protocol = IPPROTO_UDP;
+  addrinfo* result = nullptr;
+  if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result)
+  {
+    error->SetFormattedMessage("Failed to resolve '%s'.", host.c_str());
+    CloseSocket();
+    return false;
+  }
+
+  std::memcpy(&s_remote_address, result->ai_addr, sizeof(s_remote_address));
+  s_remote_address.sin_port = htons(remote_port);
+  freeaddrinfo(result);
+
+  s_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (s_socket == INVALID_SOCKET_HANDLE)
+  {
+#ifdef _WIN32
+    error->SetSocket(WSAGetLastError());
+#else
+    error->SetSocket(errno);
+#endif
+    CloseSocket();
+    return false;
+  }
+
+  sockaddr_in local_address = {};
+  local_address.sin_family = AF_INET;
+  local_address.sin_addr.s_addr = htonl(INADDR_ANY);
+  local_address.sin_port = htons(local_port);
+
+#ifdef _WIN32
+  u_long non_blocking = 1;
+  const bool bound = (bind(s_socket, reinterpret_cast<const sockaddr*>(&local_address), sizeof(local_address)) == 0 &&
+                      ioctlsocket(s_socket, FIONBIO, &non_blocking) == 0);
+  if (!bound)
+    error->SetSocket(WSAGetLastError());
+#else
+  const bool bound = (bind(s_socket, reinterpret_cast<const sockaddr*>(&local_address), sizeof(local_address)) == 0 &&
+                      fcntl(s_socket, F_SETFL, fcntl(s_socket, F_GETFL) | O_NONBLOCK) == 0);
+  if (!bound)
+    error->SetSocket(errno);
+#endif
+  if (!bound)
+  {
+    CloseSocket();
+    return false;
+  }
+
+  char address_str[INET_ADDRSTRLEN] = {};
+  inet_ntop(AF_INET, &s_remote_address.sin_addr, address_str, sizeof(address_str));
+  s_remote_name = StringUtil::StdStringFromFormat("%s:%u", address_str, static_cast<u32>(remote_port));
+  return true;
+}
+
+void Netplay::CloseSocket()
+{
+  if (s_socket != INVALID_SOCKET_HANDLE)
+  {
+#ifdef _WIN32
+    closesocket(s_socket);
+#else
+    close(s_socket);
+#endif
+    s_socket = INVALID_SOCKET_HANDLE;
+  }
+
+#ifdef _WIN32
+  WSACleanup();
+#endif
+}
+
+void Netplay::SendPacket(const void* data, size_t size)
+{
+  // lost packets are covered by the next ones, so failures aren't interesting
+  sendto(s_socket, static_cast<const char*>(data), static_cast<int>(size), 0,
+         reinterpret_cast<const sockaddr*>(&s_remote_address), sizeof(s_remote_address));
+}
+
+void Netplay::SendHello()
+{
+  HelloPacket packet = {};
+  packet.header.magic = PROTOCOL_MAGIC;
+  packet.header.version = PROTOCOL_VERSION;
+  packet.header.type = PacketType::Hello;
+  packet.player = static_cast<u8>(s_local_player);
+  packet.controller_type = static_cast<u8>(s_local_controller->GetType());
+  packet.connected = (s_state == SessionState::Running);
+  packet.game_hash = GetGameHash();
+  SendPacket(&packet, sizeof(packet));
+  s_last_hello_time = Common::Timer::GetCurrentValue();
+}
+
+void Netplay::SendInputs()
+{
+  InputPacket packet;
+  packet.header.magic = PROTOCOL_MAGIC;
+  packet.header.version = PROTOCOL_VERSION;
+  packet.header.type = PacketType::Input;
+  packet.ack_frame = s_remote_input_frames;
+  packet.current_frame = s_frame;
+  packet.frame_advantage = s_local_advantages[(s_advantage_pos + FRAME_ADVANTAGE_WINDOW - 1) % FRAME_ADVANTAGE_WINDOW];
+
+  const Checksum& checksum = s_local_checksums[(s_local_checksum_pos + NUM_CHECKSUMS - 1) % NUM_CHECKSUMS];
+  packet.checksum_frame = checksum.frame;
+  packet.checksum = checksum.checksum;
+
+  // everything which hasn't been acknowledged is sent every time, so nothing has to be resent after a loss
+  packet.start_frame = s_local_acked_frames;
+  packet.num_inputs =
+    static_cast<u8>(std::min<u32>(s_local_input_frames - s_local_acked_frames, MAX_INPUTS_PER_PACKET));
+  for (u32 i = 0; i < packet.num_inputs; i++)
+    packet.inputs[i] = s_local_inputs[GetInputIndex(packet.start_frame + i)];
+
+  SendPacket(&packet, offsetof(InputPacket, inputs) + sizeof(PadInput) * packet.num_inputs);
+}
+
+void Netplay::ReceivePackets()
+{
+  for (;;)
+  {
+    union
+    {
+      PacketHeader header;
+      HelloPacket hello;
+      InputPacket input;
+      u8 data[sizeof(InputPacket)];
+    } packet;
+
+    sockaddr_in from = {};
+#ifdef _WIN32
+    int from_size = sizeof(from);
+#else
+    socklen_t from_size = sizeof(from);
+#endif
+    const auto size =
+      recvfrom(s_socket, reinterpret_cast<char*>(packet.data), sizeof(packet), 0, reinterpret_cast<sockaddr*>(&from),
+               &from_size);
+    if (size <= 0)
+      break;
+
+    if (from.sin_addr.s_addr != s_remote_address.sin_addr.s_addr || from.sin_port != s_remote_address.sin_port ||
+        static_cast<size_t>(size) < sizeof(PacketHeader) || packet.header.magic != PROTOCOL_MAGIC)
+    {
+      continue;
+    }
+
+    if (packet.header.version != PROTOCOL_VERSION)
+    {
+      EndSession(Host::TranslateString("OSDMessage", "The other side is running a different version of netplay.")
+                   .GetCharArray());
+      return;
+    }
+
+    s_last_receive_time = Common::Timer::GetCurrentValue();
+    switch (packet.header.type)
+    {
+      case PacketType::Hello:
+      {
+        if (static_cast<size_t>(size) >= sizeof(HelloPacket))
+          HandleHello(packet.hello);
+      }
+      break;
+
+      case PacketType::Input:
+      {
+        if (s_state == SessionState::Running && static_cast<size_t>(size) >= offsetof(InputPacket, inputs))
+          HandleInputs(packet.input, static_cast<size_t>(size));
+      }
+      break;
+
+      case PacketType::Disconnect:
+      {
+        EndSession(Host::TranslateString("OSDMessage", "The other side left the netplay session.").GetCharArray());
+        return;
+      }
+
+      default:
+        break;
+    }
+
+    if (s_state == SessionState::Inactive)
+      return;
+  }
+}
+
+void Netplay::HandleHello(const HelloPacket& packet)
+{
+  if (packet.player != s_remote_player || packet.controller_type != static_cast<u8>(s_local_controller->GetType()) ||
+      packet.game_hash != GetGameHash())
+  {
+    EndSession(Host::TranslateString("OSDMessage",
+                                     "The other side is using a different game, controller type or player number.")
+                 .GetCharArray());
+    return;
+  }
+
+  // the other side is still waiting if it isn't connected, so ours went missing
+  if (s_state != SessionState::Connecting)
+  {
+    if (!packet.connected)
+      SendHello();
+    return;
+  }
+
+  // both sides start from a reset, so they're in step from the first frame
+  System::ResetSystem();
+
+  s_state = SessionState::Running;
+  s_frame = 0;
+  s_local_inputs.fill(NEUTRAL_INPUT);
+  s_local_input_frames = s_input_delay;
+  s_local_acked_frames = 0;
+  s_remote_inputs.fill(NEUTRAL_INPUT);
+  s_used_remote_inputs.fill(NEUTRAL_INPUT);
+  s_remote_input_frames = 0;
+  s_rollback_frame = NO_FRAME;
+  s_state_slots.fill(StateSlot{NO_FRAME, 0, false, false});
+  s_local_checksums.fill(Checksum{NO_FRAME, 0});
+  s_remote_checksums.fill(Checksum{NO_FRAME, 0});
+  s_local_checksum_pos = 0;
+  s_remote_checksum_pos = 0;
+  s_last_remote_checksum_frame = NO_FRAME;
+  s_desync_reported = false;
+  s_local_advantages.fill(0);
+  s_remote_advantages.fill(0);
+  s_advantage_pos = 0;
+  s_last_wait_frame = 0;
+
+  if (!packet.connected)
+    SendHello();
+
+  Host::AddKeyedFormattedOSDMessage(
+    "Netplay", 5.0f,
+    Host::TranslateString("OSDMessage", "Netplay session with %s started as player %u.").GetCharArray(),
+    s_remote_name.c_str(), s_local_player + 1);
+}
+
+void Netplay::HandleInputs(const InputPacket& packet, size_t size)
+{
+  const u32 num_inputs = std::min<u32>(
+    std::min<u32>(packet.num_inputs, MAX_INPUTS_PER_PACKET),
+    static_cast<u32>((size - offsetof(InputPacket, inputs)) / sizeof(PadInput)));
+
+  // inputs arrive in order, anything apart from the next missing one is a duplicate or from a reordered packet
+  for (u32 i = 0; i < num_inputs; i++)
+  {
+    const u32 frame = packet.start_frame + i;
+    if (frame != s_remote_input_frames)
+      continue;
+
+    const PadInput& input = packet.inputs[i];
+    const u32 index = GetInputIndex(frame);
+    s_remote_inputs[index] = input;
+    s_remote_input_frames++;
+
+    if (frame < s_frame && s_used_remote_inputs[index] != input)
+      s_rollback_frame = std::min(s_rollback_frame, frame);
+  }
+
+  if (packet.ack_frame > s_local_acked_frames && packet.ack_frame <= s_local_input_frames)
+    s_local_acked_frames = packet.ack_frame;
+
+  // GGPO-style balancing: both sides see each other through the same latency, so half the difference between the
+  // advantages they measure is how far this side is ahead
+  s_local_advantages[s_advantage_pos] =
+    static_cast<s8>(std::clamp<s32>(static_cast<s32>(packet.current_frame - s_frame), -127, 127));
+  s_remote_advantages[s_advantage_pos] = packet.frame_advantage;
+  s_advantage_pos = (s_advantage_pos + 1) % FRAME_ADVANTAGE_WINDOW;
+
+  if (packet.checksum_frame != NO_FRAME && packet.checksum_frame != s_last_remote_checksum_frame)
+  {
+    s_last_remote_checksum_frame = packet.checksum_frame;
+    HandleRemoteChecksum(packet.checksum_frame, packet.checksum);
+  }
+}
+
+void Netplay::HandleRemoteChecksum(u32 frame, u64 checksum)
+{
+  s_remote_checksums[s_remote_checksum_pos] = Checksum{frame, checksum};
+  s_remote_checksum_pos = (s_remote_checksum_pos + 1) % NUM_CHECKSUMS;
+
+  for (const Checksum& local : s_local_checksums)
+  {
+    if (local.frame == frame && local.checksum != checksum && !s_desync_reported)
+    {
+      Log_ErrorPrintf("State differs from the other side's at frame %u", frame);
+      Host::AddKeyedOSDMessage("NetplayDesync",
+                               Host::TranslateStdString("OSDMessage", "Netplay desync detected, the session will drift "
+                                                                      "apart. Restart it to get back in sync."),
+                               10.0f);
+      s_desync_reported = true;
+    }
+  }
+}
+
+void Netplay::EndSession(const char* message)
+{
+  if (s_state == SessionState::Inactive)
+    return;
+
+  Log_InfoPrintf("Netplay session ended: %s", message);
+  Host::AddKeyedOSDMessage("Netplay", message, 10.0f);
+
+  s_state = SessionState::Inactive;
+  CloseSocket();
+  System::SetNetplayStateSlotCount(0);
+  s_local_controller.reset();
+
+  for (u32 i = 0; i < NUM_PLAYERS; i++)
+  {
+    Controller* controller = g_pad.GetController(i);
+    if (controller)
+      controller->SetInputState(NEUTRAL_INPUT.buttons, NEUTRAL_INPUT.analog);
+  }
+}
+
+u64 Netplay::GetGameHash()
+{
+  const std::string& serial = System::GetRunningSerial();
+  return XXH3_64bits(serial.data(), serial.size());
+}
+
+Netplay::PadInput Netplay::ReadLocalInput()
+{
+  PadInput input;
+  input.buttons = s_local_controller->GetButtonStateBits();
+  input.analog = s_local_controller->GetAnalogInputBytes().value_or(NEUTRAL_INPUT.analog);
+
+  // the analog button changes the mode as soon as it's pressed, so changes to the local controller's are sent as a
+  // press, which the emulated controllers act on at the same frame
+  if (s_local_controller->GetType() == ControllerType::AnalogController)
+  {
+    const bool analog_mode = static_cast<const AnalogController*>(s_local_controller.get())->InAnalogMode();
+    if (analog_mode != s_local_analog_mode)
+    {
+      input.buttons |= 1u << static_cast<u32>(AnalogController::Button::Analog);
+      s_local_analog_mode = analog_mode;
+    }
+  }
+
+  return input;
+}
+
+void Netplay::SimulateFrame(bool replaying)
+{
+  StateSlot& slot = s_state_slots[s_frame % NUM_STATE_SLOTS];
+  if (!System::SaveNetplayState(s_frame % NUM_STATE_SLOTS))
+  {
+    EndSession(Host::TranslateString("OSDMessage", "Failed to save netplay state.").GetCharArray());
+    return;
+  }
+
+  // hashing is too slow to do every frame, and only needs a regular sample
+  slot.frame = s_frame;
+  slot.has_checksum = (s_frame > 0 && (s_frame % DESYNC_CHECK_INTERVAL) == 0);
+  slot.checksum_sent = false;
+  if (slot.has_checksum)
+  {
+    u64 ram_hash, spu_ram_hash;
+    System::GetMemoryHashes(&ram_hash, nullptr, &spu_ram_hash);
+    slot.checksum = ram_hash ^ (spu_ram_hash + 0x9E3779B97F4A7C15ULL + (ram_hash << 6) + (ram_hash >> 2));
+  }
+
+  // frames with no remote input yet are predicted to repeat the last one that arrived
+  const u32 index = GetInputIndex(s_frame);
+  const PadInput& local_input = s_local_inputs[index];
+  const PadInput& remote_input =
+    (s_frame < s_remote_input_frames) ?
+      s_remote_inputs[index] :
+      ((s_remote_input_frames > 0) ? s_remote_inputs[GetInputIndex(s_remote_input_frames - 1)] : NEUTRAL_INPUT);
+  s_used_remote_inputs[index] = remote_input;
+
+  Controller* local_controller = g_pad.GetController(s_local_player);
+  Controller* remote_controller = g_pad.GetController(s_remote_player);
+  if (local_controller)
+    local_controller->SetInputState(local_input.buttons, local_input.analog);
+  if (remote_controller)
+    remote_controller->SetInputState(remote_input.buttons, remote_input.analog);
+
+  System::RunNetplayFrame(replaying);
+  s_frame++;
+}
+
+void Netplay::Rollback()
+{
+  const u32 rollback_frame = s_rollback_frame;
+  s_rollback_frame = NO_FRAME;
+
+  const u32 slot_index = rollback_frame % NUM_STATE_SLOTS;
+  if (s_state_slots[slot_index].frame != rollback_frame || !System::LoadNetplayState(slot_index))
+  {
+    EndSession(
+      Host::TranslateString("OSDMessage", "The netplay session fell too far behind to roll back.").GetCharArray());
+    return;
+  }
+
+  const u32 target_frame = s_frame;
+  Log_DevPrintf("Rolling back %u frames to frame %u", target_frame - rollback_frame, rollback_frame);
+
+  s_frame = rollback_frame;
+  while (s_frame < target_frame && s_state == SessionState::Running)
+    SimulateFrame(true);
+}
+
+void Netplay::UpdateConfirmedChecksums()
+{
+  // a state is final once every input before it has arrived, and any rollback into it has been done
+  for (StateSlot& slot : s_state_slots)
+  {
+    if (slot.frame == NO_FRAME || !slot.has_checksum || slot.checksum_sent || slot.frame > s_remote_input_frames)
+      continue;
+
+    slot.checksum_sent = true;
+    s_local_checksums[s_local_checksum_pos] = Checksum{slot.frame, slot.checksum};
+    s_local_checksum_pos = (s_local_checksum_pos + 1) % NUM_CHECKSUMS;
+
+    for (const Checksum& remote : s_remote_checksums)
+    {
+      if (remote.frame == slot.frame)
+        HandleRemoteChecksum(remote.frame, remote.checksum);
+    }
+  }
+}
+
+float Netplay::GetFrameAdvantage()
+{
+  s32 local_sum = 0, remote_sum = 0;
+  for (u32 i = 0; i < FRAME_ADVANTAGE_WINDOW; i++)
+  {
+    local_sum += s_local_advantages[i];
+    remote_sum += s_remote_advantages[i];
+  }
+
+  return static_cast<float>(remote_sum - local_sum) / static_cast<float>(FRAME_ADVANTAGE_WINDOW * 2);
+}
+
+bool Netplay::ShouldWaitForRemote()
+{
+  // can't predict any further, or keep any more inputs for resending
+  if (s_frame >= (s_remote_input_frames + MAX_PREDICTION_FRAMES) ||
+      (s_local_input_frames - s_local_acked_frames) >= (INPUT_HISTORY_SIZE - 1))
+  {
+    return true;
+  }
+
+  // running ahead of the other side means more rollbacks here and fewer there, so give it a frame to catch up
+  if ((s_frame - s_last_wait_frame) >= FRAME_ADVANTAGE_INTERVAL && GetFrameAdvantage() >= 1.0f)
+  {
+    s_last_wait_frame = s_frame;
+    return true;
+  }
+
+  return false;
+}
+
+bool Netplay::Start(const std::string_view& session, Common::Error* error)
+{
+  Stop();
+
+  u32 player = 0, input_delay = 0;
+  u16 local_port = 0, remote_port = 0;
+  std::string host;
+  if (!ParseSession(session, &player, &local_port, &host, &remote_port, &input_delay))
+  {
+    error->SetFormattedMessage("Invalid netplay session '%.*s', expected player:local_port:host:port[:delay].",
+                               static_cast<int>(session.size()), session.data());
+    return false;
+  }
+
+  // the local player's bindings are always the first pad's, and drive whichever port they're playing on
+  const ControllerType type = g_settings.controller_types[0];
+  if ((type != ControllerType::DigitalController && type != ControllerType::AnalogController) ||
+      g_settings.controller_types[1] != type)
+  {
+    error->SetMessage("Netplay needs both ports set to the same type, digital or analog controllers.");
+    return false;
+  }
+
+  if (!OpenSocket(local_port, host, remote_port, error))
+    return false;
+
+  {
+    auto lock = Host::GetSettingsLock();
+    s_local_controller = Controller::Create(type, 0);
+    s_local_controller->LoadSettings(*Host::GetSettingsInterfaceForBindings(),
+                                     Controller::GetSettingsSection(0).c_str());
+  }
+  s_local_analog_mode = (type == ControllerType::AnalogController) &&
+                        static_cast<const AnalogController*>(s_local_controller.get())->InAnalogMode();
+
+  s_local_player = player;
+  s_remote_player = (player + 1) % NUM_PLAYERS;
+  s_input_delay = input_delay;
+  s_state = SessionState::Connecting;
+  s_last_receive_time = Common::Timer::GetCurrentValue();
+  System::SetNetplayStateSlotCount(NUM_STATE_SLOTS);
+
+  Log_InfoPrintf("Netplay session as player %u on port %u, connecting to %s with %u frames of input delay",
+                 player + 1, static_cast<u32>(local_port), s_remote_name.c_str(), input_delay);
+  SendHello();
+  return true;
+}
+
+void Netplay::Stop()
+{
+  if (s_state == SessionState::Inactive)
+    return;
+
+  PacketHeader packet = {PROTOCOL_MAGIC, PROTOCOL_VERSION, PacketType::Disconnect};
+  SendPacket(&packet, sizeof(packet));
+  EndSession(Host::TranslateString("OSDMessage", "Netplay session ended.").GetCharArray());
+}
+
+bool Netplay::IsActive()
+{
+  return (s_state != SessionState::Inactive);
+}
+
+Controller* Netplay::GetLocalController()
+{
+  return s_local_controller.get();
+}
+
+void Netplay::RunFrame()
+{
+  ReceivePackets();
+  if (s_state == SessionState::Inactive)
+    return;
+
+  const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
+  if (s_state == SessionState::Connecting)
+  {
+    if (Common::Timer::ConvertValueToMilliseconds(current_time - s_last_hello_time) >= HELLO_INTERVAL_MS)
+    {
+      SendHello();
+      Host::AddKeyedFormattedOSDMessage("Netplay", 1.0f,
+                                        Host::TranslateString("OSDMessage", "Waiting for %s to join netplay...")
+                                          .GetCharArray(),
+                                        s_remote_name.c_str());
+    }
+
+    return;
+  }
+
+  if (Common::Timer::ConvertValueToMilliseconds(current_time - s_last_receive_time) >= TIMEOUT_MS)
+  {
+    EndSession(Host::TranslateString("OSDMessage", "Lost the connection to the other netplay player.").GetCharArray());
+    return;
+  }
+
+  if (s_rollback_frame != NO_FRAME)
+  {
+    Rollback();
+    if (s_state == SessionState::Inactive)
+      return;
+  }
+
+  UpdateConfirmedChecksums();
+
+  if (!ShouldWaitForRemote())
+  {
+    s_local_inputs[GetInputIndex(s_local_input_frames++)] = ReadLocalInput();
+    SimulateFrame(false);
+  }
+
+  if (s_state == SessionState::Running)
+    SendInputs();
+}
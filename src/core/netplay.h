@@ -0,0 +1,44 @@
+#pragma once
+#include "types.h"
+#include <string_view>
+
+namespace Common {
+class Error;
+}
+
+class Controller;
+
+/// Two player rollback netplay over UDP. Each side runs ahead of the inputs it has received from the other, predicting
+/// them, and rolls back and runs the frames again when a prediction turns out wrong. Both sides reset the system when
+/// they connect, so they need the same game, BIOS, memory cards and emulation settings.
+namespace Netplay {
+
+enum : u32
+{
+  NUM_PLAYERS = 2,
+
+  /// How far the session can run ahead of the remote player's inputs before waiting for them.
+  MAX_PREDICTION_FRAMES = 8,
+
+  MAX_INPUT_DELAY = 8,
+  DEFAULT_INPUT_DELAY = 1,
+};
+
+/// Opens a session described by "player:local_port:remote_host:remote_port[:input_delay]", with player 1 or 2.
+/// Frames aren't run until the other side has connected.
+bool Start(const std::string_view& session, Common::Error* error);
+
+/// Ends the session, telling the other side.
+void Stop();
+
+/// Returns true when there is a session, connected or not.
+bool IsActive();
+
+/// Returns the controller which the local player's bindings drive while a session is active.
+Controller* GetLocalController();
+
+/// Runs the next frame of the session, called by System instead of running frames itself. May run no frames, when
+/// waiting for the other side, or several, when rolling back.
+void RunFrame();
+
+} // namespace Netplay
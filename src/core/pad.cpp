@@ -492,6 +492,9 @@ void Pad::DoTransfer(TickCount ticks_late)
   {
     case ActiveDevice::None:
     {
+      // the game is starting to read a device, so give it the newest input
+      Host::LatchPadInput();
+
       if (m_multitaps[m_JOY_CTRL.SLOT].IsEnabled())
       {
         if ((ack = m_multitaps[m_JOY_CTRL.SLOT].Transfer(data_out, &data_in)) == true)
@@ -20,22 +20,28 @@
 
 #include "pgxp.h"
 #include "bus.h"
+#include "common/assert.h"
+#include "common/bitutils.h"
 #include "common/log.h"
 #include "cpu_core.h"
 #include "settings.h"
 #include <climits>
 #include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <vector>
 Log_SetChannel(PGXP);
 
 namespace PGXP {
 
 enum : u32
 {
-  VERTEX_CACHE_WIDTH = 0x800 * 2,
-  VERTEX_CACHE_HEIGHT = 0x800 * 2,
-  VERTEX_CACHE_SIZE = VERTEX_CACHE_WIDTH * VERTEX_CACHE_HEIGHT,
-  PGXP_MEM_SIZE = (Bus::RAM_8MB_SIZE + CPU::DCACHE_SIZE) / 4,
-  PGXP_MEM_SCRATCH_OFFSET = Bus::RAM_8MB_SIZE / 4
+  VERTEX_CACHE_INITIAL_SIZE_SHIFT = 12,
+  PGXP_MEM_PAGE_SHIFT = 12,
+  PGXP_MEM_PAGE_SIZE = 1u << PGXP_MEM_PAGE_SHIFT,
+  PGXP_MEM_PAGE_VALUE_COUNT = PGXP_MEM_PAGE_SIZE / 4,
+  PGXP_MEM_SCRATCH_PAGE = Bus::RAM_8MB_SIZE / PGXP_MEM_PAGE_SIZE,
+  PGXP_MEM_PAGE_COUNT = PGXP_MEM_SCRATCH_PAGE + 1
 };
 
 #define NONE 0
@@ -86,6 +92,30 @@ typedef union
   s32 sd;
 } psx_value;
 
+// The vertex cache maps screen positions to the last precise vertex projected there, for when the vertex can't be
+// found through memory. It's an open addressing hash table keyed by the packed screen XY, no bigger than what a frame
+// needs. A new table is started each frame, with the previous frame's kept around for lookups, and tables are emptied
+// by bumping their generation rather than clearing them.
+struct VertexCacheEntry
+{
+  u32 key;
+  u32 generation;
+  PGXP_value vertex;
+};
+
+struct VertexCacheTable
+{
+  std::vector<VertexCacheEntry> entries;
+  u32 generation = 0;
+  u32 count = 0;
+  u32 shift = 0;
+};
+
+static u32 NextVertexCacheGeneration();
+static u32 GetVertexCacheIndex(const VertexCacheTable& table, u32 key);
+static void GrowVertexCache(VertexCacheTable& table);
+static void ResetVertexCache();
+static void FreeVertexCache();
 static void PGXP_CacheVertex(s16 sx, s16 sy, const PGXP_value& vertex);
 
 static void MakeValid(PGXP_value* pV, u32 psxV);
@@ -97,11 +127,19 @@ static double f16Unsign(double in);
 static double f16Overflow(double in);
 
 static PGXP_value* GetPtr(u32 addr);
+static PGXP_value* GetWritablePtr(u32 addr);
+static PGXP_value* AllocateMemPage(u32 page);
+static void FreeMemPages();
 static PGXP_value* ReadMem(u32 addr);
 
 static const PGXP_value PGXP_value_invalid = {0.f, 0.f, 0.f, {0}, 0};
 static const PGXP_value PGXP_value_zero = {0.f, 0.f, 0.f, {VALID_ALL}, 0};
 
+static_assert(sizeof(PGXP_value) == sizeof(u32) * SHADOW_VALUE_WORD_COUNT);
+static_assert(offsetof(PGXP_value, flags) == sizeof(u32) * SHADOW_VALUE_FLAGS_WORD);
+static_assert(offsetof(PGXP_value, value) == sizeof(u32) * SHADOW_VALUE_VALUE_WORD);
+static_assert(VALID_01 == SHADOW_VALUE_VALID_01 && INV_VALID_ALL == SHADOW_VALUE_INVALIDATE_MASK);
+
 static PGXP_value CPU_reg[34];
 static PGXP_value CP0_reg[32];
 #define CPU_Hi CPU_reg[32]
@@ -111,8 +149,17 @@ static PGXP_value CP0_reg[32];
 static PGXP_value GTE_data_reg[32];
 static PGXP_value GTE_ctrl_reg[32];
 
-static PGXP_value* Mem = nullptr;
-static PGXP_value* vertexCache = nullptr;
+// Shadow values for RAM and the scratchpad, allocated a page at a time on first write. Most of RAM never holds
+// values that went through the GTE, so this is far smaller than a dense copy of memory.
+static PGXP_value* MemPages[PGXP_MEM_PAGE_COUNT] = {};
+static u32 MemPagesAllocated = 0;
+
+// Returned for reads from pages which haven't been allocated. Reads only ever clear flags, so this stays zeroed.
+static PGXP_value UnallocatedValue = {};
+
+static VertexCacheTable s_vertex_cache[2];
+static u32 s_vertex_cache_current = 0;
+static u32 s_vertex_cache_generation = 0;
 
 ALWAYS_INLINE_RELEASE void MakeValid(PGXP_value* pV, u32 psxV)
 {
@@ -155,16 +202,82 @@ ALWAYS_INLINE_RELEASE double f16Overflow(double in)
   return out;
 }
 
-ALWAYS_INLINE_RELEASE PGXP_value* GetPtr(u32 addr)
+ALWAYS_INLINE_RELEASE static bool GetMemLocation(u32 addr, u32* page, u32* index)
 {
   if ((addr & CPU::DCACHE_LOCATION_MASK) == CPU::DCACHE_LOCATION)
-    return &Mem[PGXP_MEM_SCRATCH_OFFSET + ((addr & CPU::DCACHE_OFFSET_MASK) >> 2)];
+  {
+    *page = PGXP_MEM_SCRATCH_PAGE;
+    *index = (addr & CPU::DCACHE_OFFSET_MASK) >> 2;
+    return true;
+  }
 
   const u32 paddr = (addr & CPU::PHYSICAL_MEMORY_ADDRESS_MASK);
-  if (paddr < Bus::RAM_MIRROR_END)
-    return &Mem[(paddr & Bus::g_ram_mask) >> 2];
-  else
+  if (paddr >= Bus::RAM_MIRROR_END)
+    return false;
+
+  const u32 ram_addr = paddr & Bus::g_ram_mask;
+  *page = ram_addr >> PGXP_MEM_PAGE_SHIFT;
+  *index = (ram_addr & (PGXP_MEM_PAGE_SIZE - 1)) >> 2;
+  return true;
+}
+
+ALWAYS_INLINE_RELEASE PGXP_value* GetPtr(u32 addr)
+{
+  u32 page, index;
+  if (!GetMemLocation(addr, &page, &index))
+    return nullptr;
+
+  PGXP_value* page_ptr = MemPages[page];
+  return page_ptr ? &page_ptr[index] : &UnallocatedValue;
+}
+
+ALWAYS_INLINE_RELEASE PGXP_value* GetWritablePtr(u32 addr)
+{
+  u32 page, index;
+  if (!GetMemLocation(addr, &page, &index))
+    return nullptr;
+
+  PGXP_value* page_ptr = MemPages[page];
+  if (!page_ptr)
+  {
+    page_ptr = AllocateMemPage(page);
+    if (!page_ptr)
+      return nullptr;
+  }
+
+  return &page_ptr[index];
+}
+
+PGXP_value* AllocateMemPage(u32 page)
+{
+  PGXP_value* page_ptr = static_cast<PGXP_value*>(std::calloc(PGXP_MEM_PAGE_VALUE_COUNT, sizeof(PGXP_value)));
+  if (!page_ptr)
+  {
+    Log_ErrorPrintf("Failed to allocate PGXP memory page %u", page);
     return nullptr;
+  }
+
+  MemPages[page] = page_ptr;
+  MemPagesAllocated++;
+  return page_ptr;
+}
+
+void FreeMemPages()
+{
+  if (MemPagesAllocated > 0)
+  {
+    Log_DevPrintf("Freeing %u PGXP memory pages (%u KB)", MemPagesAllocated,
+                  (MemPagesAllocated * PGXP_MEM_PAGE_VALUE_COUNT * static_cast<u32>(sizeof(PGXP_value))) / 1024u);
+  }
+
+  for (PGXP_value*& page_ptr : MemPages)
+  {
+    std::free(page_ptr);
+    page_ptr = nullptr;
+  }
+
+  MemPagesAllocated = 0;
+  UnallocatedValue = {};
 }
 
 ALWAYS_INLINE_RELEASE PGXP_value* ReadMem(u32 addr)
@@ -230,7 +343,8 @@ ALWAYS_INLINE_RELEASE static void ValidateAndCopyMem16(PGXP_value* dest, u32 add
 
 ALWAYS_INLINE_RELEASE void WriteMem(const PGXP_value* value, u32 addr)
 {
-  PGXP_value* pMem = GetPtr(addr);
+  // unallocated pages already read back as invalid
+  PGXP_value* pMem = (value == &PGXP_value_invalid) ? GetPtr(addr) : GetWritablePtr(addr);
 
   if (pMem)
     *pMem = *value;
@@ -238,7 +352,7 @@ ALWAYS_INLINE_RELEASE void WriteMem(const PGXP_value* value, u32 addr)
 
 ALWAYS_INLINE_RELEASE static void WriteMem16(const PGXP_value* src, u32 addr)
 {
-  PGXP_value* dest = GetPtr(addr);
+  PGXP_value* dest = GetWritablePtr(addr);
   psx_value* pVal = NULL;
 
   if (dest)
@@ -277,28 +391,10 @@ void Initialize()
   std::memset(GTE_data_reg, 0, sizeof(GTE_data_reg));
   std::memset(GTE_ctrl_reg, 0, sizeof(GTE_ctrl_reg));
 
-  if (!Mem)
-  {
-    Mem = static_cast<PGXP_value*>(std::calloc(PGXP_MEM_SIZE, sizeof(PGXP_value)));
-    if (!Mem)
-    {
-      std::fprintf(stderr, "Failed to allocate PGXP memory\n");
-      std::abort();
-    }
-  }
-
-  if (g_settings.gpu_pgxp_vertex_cache && !vertexCache)
-  {
-    vertexCache = static_cast<PGXP_value*>(std::calloc(VERTEX_CACHE_SIZE, sizeof(PGXP_value)));
-    if (!vertexCache)
-    {
-      Log_ErrorPrint("Failed to allocate memory for vertex cache, disabling.");
-      g_settings.gpu_pgxp_vertex_cache = false;
-    }
-  }
+  FreeMemPages();
 
-  if (vertexCache)
-    std::memset(vertexCache, 0, sizeof(PGXP_value) * VERTEX_CACHE_SIZE);
+  // tables are allocated on first use
+  ResetVertexCache();
 }
 
 void Reset()
@@ -309,25 +405,14 @@ void Reset()
   std::memset(GTE_data_reg, 0, sizeof(GTE_data_reg));
   std::memset(GTE_ctrl_reg, 0, sizeof(GTE_ctrl_reg));
 
-  if (Mem)
-    std::memset(Mem, 0, sizeof(PGXP_value) * PGXP_MEM_SIZE);
-
-  if (vertexCache)
-    std::memset(vertexCache, 0, sizeof(PGXP_value) * VERTEX_CACHE_SIZE);
+  FreeMemPages();
+  ResetVertexCache();
 }
 
 void Shutdown()
 {
-  if (vertexCache)
-  {
-    std::free(vertexCache);
-    vertexCache = nullptr;
-  }
-  if (Mem)
-  {
-    std::free(Mem);
-    Mem = nullptr;
-  }
+  FreeVertexCache();
+  FreeMemPages();
 
   std::memset(GTE_data_reg, 0, sizeof(GTE_data_reg));
   std::memset(GTE_ctrl_reg, 0, sizeof(GTE_ctrl_reg));
@@ -485,24 +570,133 @@ void CPU_SWC2(u32 instr, u32 rtVal, u32 addr)
   WriteMem(&GTE_data_reg[rt(instr)], addr);
 }
 
+u32 NextVertexCacheGeneration()
+{
+  // zero is never used, so freshly allocated entries are empty
+  s_vertex_cache_generation++;
+  if (s_vertex_cache_generation == 0)
+    s_vertex_cache_generation++;
+  return s_vertex_cache_generation;
+}
+
+ALWAYS_INLINE u32 GetVertexCacheIndex(const VertexCacheTable& table, u32 key)
+{
+  // fibonacci hashing, the high bits are the well mixed ones
+  return (key * 0x9E3779B9u) >> table.shift;
+}
+
+void GrowVertexCache(VertexCacheTable& table)
+{
+  std::vector<VertexCacheEntry> old_entries(
+    table.entries.empty() ? static_cast<size_t>(1u << VERTEX_CACHE_INITIAL_SIZE_SHIFT) : (table.entries.size() * 2));
+  old_entries.swap(table.entries);
+  table.shift = 32 - CountTrailingZeros(static_cast<u32>(table.entries.size()));
+
+  const u32 mask = static_cast<u32>(table.entries.size()) - 1;
+  for (const VertexCacheEntry& entry : old_entries)
+  {
+    if (entry.generation != table.generation)
+      continue;
+
+    u32 index = GetVertexCacheIndex(table, entry.key);
+    while (table.entries[index].generation == table.generation)
+      index = (index + 1) & mask;
+    table.entries[index] = entry;
+  }
+
+  Log_DevPrintf("Vertex cache grown to %zu entries", table.entries.size());
+}
+
+void ResetVertexCache()
+{
+  for (VertexCacheTable& table : s_vertex_cache)
+  {
+    table.generation = NextVertexCacheGeneration();
+    table.count = 0;
+  }
+}
+
+void FreeVertexCache()
+{
+  for (VertexCacheTable& table : s_vertex_cache)
+  {
+    table.entries = {};
+    table.count = 0;
+    table.shift = 0;
+  }
+}
+
+void EndFrame()
+{
+  s_vertex_cache_current ^= 1;
+
+  VertexCacheTable& table = s_vertex_cache[s_vertex_cache_current];
+  table.generation = NextVertexCacheGeneration();
+  table.count = 0;
+}
+
 ALWAYS_INLINE_RELEASE void PGXP_CacheVertex(s16 sx, s16 sy, const PGXP_value& vertex)
 {
-  if (sx >= -0x800 && sx <= 0x7ff && sy >= -0x800 && sy <= 0x7ff)
+  if (sx < -0x800 || sx > 0x7ff || sy < -0x800 || sy > 0x7ff)
+    return;
+
+  // kept at most half full, so probes stay short
+  VertexCacheTable& table = s_vertex_cache[s_vertex_cache_current];
+  if ((table.count + 1) * 2 > table.entries.size())
+    GrowVertexCache(table);
+
+  const u32 key = (static_cast<u32>(static_cast<u16>(sy)) << 16) | static_cast<u16>(sx);
+  const u32 mask = static_cast<u32>(table.entries.size()) - 1;
+  u32 index = GetVertexCacheIndex(table, key);
+  for (;;)
   {
-    // Write vertex into cache
-    vertexCache[(sy + 0x800) * VERTEX_CACHE_WIDTH + (sx + 0x800)] = vertex;
+    VertexCacheEntry& entry = table.entries[index];
+    if (entry.generation != table.generation)
+    {
+      entry.key = key;
+      entry.generation = table.generation;
+      entry.vertex = vertex;
+      table.count++;
+      return;
+    }
+    else if (entry.key == key)
+    {
+      entry.vertex = vertex;
+      return;
+    }
+
+    index = (index + 1) & mask;
   }
 }
 
-static ALWAYS_INLINE_RELEASE PGXP_value* PGXP_GetCachedVertex(short sx, short sy)
+static ALWAYS_INLINE_RELEASE const PGXP_value* LookupCachedVertex(const VertexCacheTable& table, u32 key)
 {
-  if (sx >= -0x800 && sx <= 0x7ff && sy >= -0x800 && sy <= 0x7ff)
+  if (table.entries.empty())
+    return nullptr;
+
+  const u32 mask = static_cast<u32>(table.entries.size()) - 1;
+  u32 index = GetVertexCacheIndex(table, key);
+  for (;;)
   {
-    // Return pointer to cache entry
-    return &vertexCache[(sy + 0x800) * VERTEX_CACHE_WIDTH + (sx + 0x800)];
+    const VertexCacheEntry& entry = table.entries[index];
+    if (entry.generation != table.generation)
+      return nullptr;
+    else if (entry.key == key)
+      return &entry.vertex;
+
+    index = (index + 1) & mask;
   }
+}
 
-  return nullptr;
+static ALWAYS_INLINE_RELEASE const PGXP_value* PGXP_GetCachedVertex(short sx, short sy)
+{
+  if (sx < -0x800 || sx > 0x7ff || sy < -0x800 || sy > 0x7ff)
+    return nullptr;
+
+  // vertices are often drawn the frame after they're transformed, so fall back to the previous frame's table
+  const u32 key = (static_cast<u32>(static_cast<u16>(sy)) << 16) | static_cast<u16>(sx);
+  const PGXP_value* vertex = LookupCachedVertex(s_vertex_cache[s_vertex_cache_current], key);
+  return vertex ? vertex : LookupCachedVertex(s_vertex_cache[s_vertex_cache_current ^ 1], key);
 }
 
 static ALWAYS_INLINE_RELEASE float TruncateVertexPosition(float p)
@@ -614,6 +808,12 @@ void CPU_SW(u32 instr, u32 rtVal, u32 addr)
   WriteMem(val, addr);
 }
 
+u32* GetCPURegisterShadow(u32 index)
+{
+  DebugAssert(index < std::size(CPU_reg));
+  return reinterpret_cast<u32*>(&CPU_reg[index]);
+}
+
 void CPU_MOVE(u32 rd_and_rs, u32 rsVal)
 {
   const u32 Rs = (rd_and_rs & 0xFFu);
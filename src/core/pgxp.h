@@ -27,6 +27,9 @@ void Initialize();
 void Reset();
 void Shutdown();
 
+/// Starts a new frame in the vertex cache, dropping vertices from two frames ago.
+void EndFrame();
+
 // -- GTE functions
 // Transforms
 void GTE_PushSXYZ2f(float x, float y, float z, u32 v);
@@ -54,6 +57,20 @@ void CPU_SH(u32 instr, u16 rtVal, u32 addr);
 void CPU_SW(u32 instr, u32 rtVal, u32 addr);
 void CPU_MOVE(u32 rd_and_rs, u32 rsVal);
 
+// Shadow values are five 32-bit words (x, y, z, flags, value). The layout is exposed so the recompiler can emit
+// register moves inline instead of calling CPU_MOVE() and friends.
+enum : u32
+{
+  SHADOW_VALUE_FLAGS_WORD = 3,
+  SHADOW_VALUE_VALUE_WORD = 4,
+  SHADOW_VALUE_WORD_COUNT = 5,
+  SHADOW_VALUE_VALID_01 = 0x00000101u,
+  SHADOW_VALUE_INVALIDATE_MASK = 0xFEFEFEFEu, // applied to flags when the value no longer matches
+};
+
+/// Returns the shadow value for a CPU register. 32 is HI, and 33 is LO.
+u32* GetCPURegisterShadow(u32 index);
+
 // Arithmetic with immediate value
 void CPU_ADDI(u32 instr, u32 rsVal);
 void CPU_ANDI(u32 instr, u32 rsVal);
@@ -2,7 +2,7 @@
 #include "types.h"
 
 static constexpr u32 SAVE_STATE_MAGIC = 0x43435544;
-static constexpr u32 SAVE_STATE_VERSION = 56;
+static constexpr u32 SAVE_STATE_VERSION = 57;
 static constexpr u32 SAVE_STATE_MINIMUM_VERSION = 42;
 
 static_assert(SAVE_STATE_VERSION >= SAVE_STATE_MINIMUM_VERSION);
@@ -18,6 +18,9 @@ struct SAVE_STATE_HEADER
     COMPRESSION_TYPE_NONE = 0,
     COMPRESSION_TYPE_ZLIB = 1,
     COMPRESSION_TYPE_ZSTD = 2,
+
+    // data starts with a u32 section count and a SAVE_STATE_SECTION table, each section is compressed separately
+    COMPRESSION_TYPE_SECTIONS = 3,
   };
 
   u32 magic;
@@ -40,4 +43,20 @@ struct SAVE_STATE_HEADER
   u32 data_uncompressed_size;
   u32 offset_to_data;
 };
+
+// One component of the state data, starting at its marker. Concatenating the uncompressed sections in order gives
+// the same data as an unsectioned state.
+struct SAVE_STATE_SECTION
+{
+  enum : u32
+  {
+    MAX_NAME_LENGTH = 32,
+  };
+
+  char name[MAX_NAME_LENGTH];
+  u32 compression_type;
+  u32 offset; // from the start of the file
+  u32 compressed_size;
+  u32 uncompressed_size;
+};
 #pragma pack(pop)
@@ -155,6 +155,8 @@ void Settings::Load(SettingsInterface& si)
       si.GetStringValue("Console", "Region", Settings::GetConsoleRegionName(Settings::DEFAULT_CONSOLE_REGION)).c_str())
       .value_or(DEFAULT_CONSOLE_REGION);
   enable_8mb_ram = si.GetBoolValue("Console", "Enable8MBRAM", false);
+  use_huge_pages = si.GetBoolValue("Console", "UseHugePages", false);
+  map_resource_files = si.GetBoolValue("Main", "MapResourceFiles", false);
 
   emulation_speed = si.GetFloatValue("Main", "EmulationSpeed", 1.0f);
   fast_forward_speed = si.GetFloatValue("Main", "FastForwardSpeed", 0.0f);
@@ -178,6 +180,7 @@ void Settings::Load(SettingsInterface& si)
   rewind_enable = si.GetBoolValue("Main", "RewindEnable", false);
   rewind_save_frequency = si.GetFloatValue("Main", "RewindFrequency", 10.0f);
   rewind_save_slots = static_cast<u32>(si.GetIntValue("Main", "RewindSaveSlots", 10));
+  rewind_native_resolution_vram = si.GetBoolValue("Main", "RewindNativeResolutionVRAM", false);
   runahead_frames = static_cast<u32>(si.GetIntValue("Main", "RunaheadFrameCount", 0));
 
   cpu_execution_mode =
@@ -188,9 +191,16 @@ void Settings::Load(SettingsInterface& si)
   cpu_overclock_denominator = std::max(si.GetIntValue("CPU", "OverclockDenominator", 1), 1);
   cpu_overclock_enable = si.GetBoolValue("CPU", "OverclockEnable", false);
   UpdateOverclockActive();
+  cpu_idle_loop_skipping = si.GetBoolValue("CPU", "IdleLoopSkipping", true);
   cpu_recompiler_memory_exceptions = si.GetBoolValue("CPU", "RecompilerMemoryExceptions", false);
   cpu_recompiler_block_linking = si.GetBoolValue("CPU", "RecompilerBlockLinking", true);
   cpu_recompiler_icache = si.GetBoolValue("CPU", "RecompilerICache", false);
+  cpu_recompiler_block_cache = si.GetBoolValue("CPU", "RecompilerBlockCache", false);
+  cpu_recompiler_compile_budget = si.GetUIntValue("CPU", "RecompilerCompileBudget", 0u);
+  cpu_recompiler_hot_block_threshold = si.GetUIntValue("CPU", "RecompilerHotBlockThreshold", 0u);
+  cpu_recompiler_code_buffer_size = si.GetUIntValue("CPU", "RecompilerCodeBufferSize", 0u);
+  cpu_recompiler_perf_map = si.GetBoolValue("CPU", "RecompilerPerfMap", false);
+  cpu_recompiler_register_pinning = si.GetBoolValue("CPU", "RecompilerRegisterPinning", false);
   cpu_fastmem_mode = ParseCPUFastmemMode(
                        si.GetStringValue("CPU", "FastmemMode", GetCPUFastmemModeName(DEFAULT_CPU_FASTMEM_MODE)).c_str())
                        .value_or(DEFAULT_CPU_FASTMEM_MODE);
@@ -199,12 +209,22 @@ void Settings::Load(SettingsInterface& si)
                    .value_or(DEFAULT_GPU_RENDERER);
   gpu_adapter = si.GetStringValue("GPU", "Adapter", "");
   gpu_resolution_scale = static_cast<u32>(si.GetIntValue("GPU", "ResolutionScale", 1));
+  gpu_dynamic_resolution = si.GetBoolValue("GPU", "DynamicResolution", false);
+  gpu_dynamic_resolution_min_scale =
+    static_cast<u32>(std::max(si.GetIntValue("GPU", "DynamicResolutionMinScale", 1), 1));
   gpu_multisamples = static_cast<u32>(si.GetIntValue("GPU", "Multisamples", 1));
   gpu_use_debug_device = si.GetBoolValue("GPU", "UseDebugDevice", false);
+  gpu_shader_cache_size_limit = si.GetUIntValue("GPU", "ShaderCacheSizeLimit", DEFAULT_GPU_SHADER_CACHE_SIZE_LIMIT);
+  gpu_async_pipeline_compilation = si.GetBoolValue("GPU", "AsyncPipelineCompilation", false);
+  gpu_use_uber_shaders = si.GetBoolValue("GPU", "UseUberShaders", false);
   gpu_per_sample_shading = si.GetBoolValue("GPU", "PerSampleShading", false);
   gpu_use_thread = si.GetBoolValue("GPU", "UseThread", true);
   gpu_use_software_renderer_for_readbacks = si.GetBoolValue("GPU", "UseSoftwareRendererForReadbacks", false);
+  gpu_software_renderer_threads = si.GetUIntValue("GPU", "SoftwareRendererThreads", 1u);
+  gpu_software_renderer_scale = si.GetUIntValue("GPU", "SoftwareRendererScale", 1u);
   gpu_threaded_presentation = si.GetBoolValue("GPU", "ThreadedPresentation", true);
+  gpu_max_frames_in_flight = std::clamp<u32>(
+    si.GetUIntValue("GPU", "MaxFramesInFlight", DEFAULT_GPU_MAX_FRAMES_IN_FLIGHT), 1u, MAX_GPU_MAX_FRAMES_IN_FLIGHT);
   gpu_true_color = si.GetBoolValue("GPU", "TrueColor", true);
   gpu_scaled_dithering = si.GetBoolValue("GPU", "ScaledDithering", true);
   gpu_texture_filter =
@@ -257,12 +277,23 @@ void Settings::Load(SettingsInterface& si)
   display_show_resolution = si.GetBoolValue("Display", "ShowResolution", false);
   display_show_cpu = si.GetBoolValue("Display", "ShowCPU", false);
   display_show_gpu = si.GetBoolValue("Display", "ShowGPU", false);
+  display_show_subsystem_times = si.GetBoolValue("Display", "ShowSubsystemTimes", false);
+  display_detect_stutters = si.GetBoolValue("Display", "DetectStutters", false);
+  display_stutter_threshold = si.GetFloatValue("Display", "StutterThreshold", DEFAULT_DISPLAY_STUTTER_THRESHOLD);
+  display_stutter_median_multiplier =
+    si.GetFloatValue("Display", "StutterMedianMultiplier", DEFAULT_DISPLAY_STUTTER_MEDIAN_MULTIPLIER);
   display_show_status_indicators = si.GetBoolValue("Display", "ShowStatusIndicators", true);
   display_show_inputs = si.GetBoolValue("Display", "ShowInputs", false);
   display_show_enhancements = si.GetBoolValue("Display", "ShowEnhancements", false);
   display_all_frames = si.GetBoolValue("Display", "DisplayAllFrames", false);
+  display_adaptive_frameskip = si.GetBoolValue("Display", "AdaptiveFrameskip", false);
+  display_pre_frame_sleep = si.GetBoolValue("Display", "PreFrameSleep", false);
+  display_pre_frame_sleep_buffer =
+    si.GetFloatValue("Display", "PreFrameSleepBuffer", DEFAULT_DISPLAY_PRE_FRAME_SLEEP_BUFFER);
   display_internal_resolution_screenshots = si.GetBoolValue("Display", "InternalResolutionScreenshots", false);
+  display_shared_frame_output = si.GetBoolValue("Display", "SharedFrameOutput", false);
   video_sync_enabled = si.GetBoolValue("Display", "VSync", DEFAULT_VSYNC_VALUE);
+  video_sync_relaxed = si.GetBoolValue("Display", "RelaxedVSync", false);
   display_post_process_chain = si.GetStringValue("Display", "PostProcessChain", "");
   display_max_fps = si.GetFloatValue("Display", "MaxFPS", DEFAULT_DISPLAY_MAX_FPS);
   display_osd_scale = si.GetFloatValue("Display", "OSDScale", DEFAULT_OSD_SCALE);
@@ -272,6 +303,8 @@ void Settings::Load(SettingsInterface& si)
   cdrom_region_check = si.GetBoolValue("CDROM", "RegionCheck", false);
   cdrom_load_image_to_ram = si.GetBoolValue("CDROM", "LoadImageToRAM", false);
   cdrom_load_image_patches = si.GetBoolValue("CDROM", "LoadImagePatches", false);
+  cdrom_sector_cache = si.GetBoolValue("CDROM", "SectorCache", false);
+  cdrom_sector_cache_size = si.GetUIntValue("CDROM", "SectorCacheSize", DEFAULT_CDROM_SECTOR_CACHE_SIZE);
   cdrom_mute_cd_audio = si.GetBoolValue("CDROM", "MuteCDAudio", false);
   cdrom_read_speedup = si.GetIntValue("CDROM", "ReadSpeedup", 1);
   cdrom_seek_speedup = si.GetIntValue("CDROM", "SeekSpeedup", 1);
@@ -291,6 +324,7 @@ void Settings::Load(SettingsInterface& si)
 
   audio_output_muted = si.GetBoolValue("Audio", "OutputMuted", false);
   audio_dump_on_boot = si.GetBoolValue("Audio", "DumpOnBoot", false);
+  audio_only_psf = si.GetBoolValue("Audio", "AudioOnlyPSF", true);
 
   dma_max_slice_ticks = si.GetIntValue("Hacks", "DMAMaxSliceTicks", DEFAULT_DMA_MAX_SLICE_TICKS);
   dma_halt_ticks = si.GetIntValue("Hacks", "DMAHaltTicks", DEFAULT_DMA_HALT_TICKS);
@@ -299,6 +333,7 @@ void Settings::Load(SettingsInterface& si)
 
   bios_patch_tty_enable = si.GetBoolValue("BIOS", "PatchTTYEnable", false);
   bios_patch_fast_boot = si.GetBoolValue("BIOS", "PatchFastBoot", DEFAULT_FAST_BOOT_VALUE);
+  bios_instant_boot = si.GetBoolValue("BIOS", "InstantBoot", false);
 
   multitap_mode =
     ParseMultitapModeName(
@@ -371,6 +406,9 @@ void Settings::Load(SettingsInterface& si)
   texture_replacements.enable_vram_write_replacements =
     si.GetBoolValue("TextureReplacements", "EnableVRAMWriteReplacements", false);
   texture_replacements.preload_textures = si.GetBoolValue("TextureReplacements", "PreloadTextures", false);
+  texture_replacements.async_loading = si.GetBoolValue("TextureReplacements", "AsyncLoading", true);
+  texture_replacements.max_cache_size_mb =
+    si.GetUIntValue("TextureReplacements", "MaxCacheSizeMB", DEFAULT_TEXTURE_REPLACEMENT_CACHE_SIZE_MB);
   texture_replacements.dump_vram_writes = si.GetBoolValue("TextureReplacements", "DumpVRAMWrites", false);
   texture_replacements.dump_vram_write_force_alpha_channel =
     si.GetBoolValue("TextureReplacements", "DumpVRAMWriteForceAlphaChannel", true);
@@ -384,6 +422,8 @@ void Settings::Save(SettingsInterface& si) const
 {
   si.SetStringValue("Console", "Region", GetConsoleRegionName(region));
   si.SetBoolValue("Console", "Enable8MBRAM", enable_8mb_ram);
+  si.SetBoolValue("Console", "UseHugePages", use_huge_pages);
+  si.SetBoolValue("Main", "MapResourceFiles", map_resource_files);
 
   si.SetFloatValue("Main", "EmulationSpeed", emulation_speed);
   si.SetFloatValue("Main", "FastForwardSpeed", fast_forward_speed);
@@ -407,26 +447,42 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("Main", "RewindEnable", rewind_enable);
   si.SetFloatValue("Main", "RewindFrequency", rewind_save_frequency);
   si.SetIntValue("Main", "RewindSaveSlots", rewind_save_slots);
+  si.SetBoolValue("Main", "RewindNativeResolutionVRAM", rewind_native_resolution_vram);
   si.SetIntValue("Main", "RunaheadFrameCount", runahead_frames);
 
   si.SetStringValue("CPU", "ExecutionMode", GetCPUExecutionModeName(cpu_execution_mode));
   si.SetBoolValue("CPU", "OverclockEnable", cpu_overclock_enable);
   si.SetIntValue("CPU", "OverclockNumerator", cpu_overclock_numerator);
   si.SetIntValue("CPU", "OverclockDenominator", cpu_overclock_denominator);
+  si.SetBoolValue("CPU", "IdleLoopSkipping", cpu_idle_loop_skipping);
   si.SetBoolValue("CPU", "RecompilerMemoryExceptions", cpu_recompiler_memory_exceptions);
   si.SetBoolValue("CPU", "RecompilerBlockLinking", cpu_recompiler_block_linking);
   si.SetBoolValue("CPU", "RecompilerICache", cpu_recompiler_icache);
+  si.SetBoolValue("CPU", "RecompilerBlockCache", cpu_recompiler_block_cache);
+  si.SetUIntValue("CPU", "RecompilerCompileBudget", cpu_recompiler_compile_budget);
+  si.SetUIntValue("CPU", "RecompilerHotBlockThreshold", cpu_recompiler_hot_block_threshold);
+  si.SetUIntValue("CPU", "RecompilerCodeBufferSize", cpu_recompiler_code_buffer_size);
+  si.SetBoolValue("CPU", "RecompilerPerfMap", cpu_recompiler_perf_map);
+  si.SetBoolValue("CPU", "RecompilerRegisterPinning", cpu_recompiler_register_pinning);
   si.SetStringValue("CPU", "FastmemMode", GetCPUFastmemModeName(cpu_fastmem_mode));
 
   si.SetStringValue("GPU", "Renderer", GetRendererName(gpu_renderer));
   si.SetStringValue("GPU", "Adapter", gpu_adapter.c_str());
   si.SetIntValue("GPU", "ResolutionScale", static_cast<long>(gpu_resolution_scale));
+  si.SetBoolValue("GPU", "DynamicResolution", gpu_dynamic_resolution);
+  si.SetIntValue("GPU", "DynamicResolutionMinScale", static_cast<long>(gpu_dynamic_resolution_min_scale));
   si.SetIntValue("GPU", "Multisamples", static_cast<long>(gpu_multisamples));
   si.SetBoolValue("GPU", "UseDebugDevice", gpu_use_debug_device);
+  si.SetUIntValue("GPU", "ShaderCacheSizeLimit", gpu_shader_cache_size_limit);
+  si.SetBoolValue("GPU", "AsyncPipelineCompilation", gpu_async_pipeline_compilation);
+  si.SetBoolValue("GPU", "UseUberShaders", gpu_use_uber_shaders);
   si.SetBoolValue("GPU", "PerSampleShading", gpu_per_sample_shading);
   si.SetBoolValue("GPU", "UseThread", gpu_use_thread);
   si.SetBoolValue("GPU", "ThreadedPresentation", gpu_threaded_presentation);
+  si.SetUIntValue("GPU", "MaxFramesInFlight", gpu_max_frames_in_flight);
   si.SetBoolValue("GPU", "UseSoftwareRendererForReadbacks", gpu_use_software_renderer_for_readbacks);
+  si.SetUIntValue("GPU", "SoftwareRendererThreads", gpu_software_renderer_threads);
+  si.SetUIntValue("GPU", "SoftwareRendererScale", gpu_software_renderer_scale);
   si.SetBoolValue("GPU", "TrueColor", gpu_true_color);
   si.SetBoolValue("GPU", "ScaledDithering", gpu_scaled_dithering);
   si.SetStringValue("GPU", "TextureFilter", GetTextureFilterName(gpu_texture_filter));
@@ -465,12 +521,21 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("Display", "ShowResolution", display_show_resolution);
   si.SetBoolValue("Display", "ShowCPU", display_show_cpu);
   si.SetBoolValue("Display", "ShowGPU", display_show_gpu);
+  si.SetBoolValue("Display", "ShowSubsystemTimes", display_show_subsystem_times);
+  si.SetBoolValue("Display", "DetectStutters", display_detect_stutters);
+  si.SetFloatValue("Display", "StutterThreshold", display_stutter_threshold);
+  si.SetFloatValue("Display", "StutterMedianMultiplier", display_stutter_median_multiplier);
   si.SetBoolValue("Display", "ShowStatusIndicators", display_show_status_indicators);
   si.SetBoolValue("Display", "ShowInputs", display_show_inputs);
   si.SetBoolValue("Display", "ShowEnhancements", display_show_enhancements);
   si.SetBoolValue("Display", "DisplayAllFrames", display_all_frames);
+  si.SetBoolValue("Display", "AdaptiveFrameskip", display_adaptive_frameskip);
+  si.SetBoolValue("Display", "PreFrameSleep", display_pre_frame_sleep);
+  si.SetFloatValue("Display", "PreFrameSleepBuffer", display_pre_frame_sleep_buffer);
   si.SetBoolValue("Display", "InternalResolutionScreenshots", display_internal_resolution_screenshots);
+  si.SetBoolValue("Display", "SharedFrameOutput", display_shared_frame_output);
   si.SetBoolValue("Display", "VSync", video_sync_enabled);
+  si.SetBoolValue("Display", "RelaxedVSync", video_sync_relaxed);
   if (display_post_process_chain.empty())
     si.DeleteValue("Display", "PostProcessChain");
   else
@@ -482,6 +547,8 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("CDROM", "RegionCheck", cdrom_region_check);
   si.SetBoolValue("CDROM", "LoadImageToRAM", cdrom_load_image_to_ram);
   si.SetBoolValue("CDROM", "LoadImagePatches", cdrom_load_image_patches);
+  si.SetBoolValue("CDROM", "SectorCache", cdrom_sector_cache);
+  si.SetUIntValue("CDROM", "SectorCacheSize", cdrom_sector_cache_size);
   si.SetBoolValue("CDROM", "MuteCDAudio", cdrom_mute_cd_audio);
   si.SetIntValue("CDROM", "ReadSpeedup", cdrom_read_speedup);
   si.SetIntValue("CDROM", "SeekSpeedup", cdrom_seek_speedup);
@@ -495,6 +562,7 @@ void Settings::Save(SettingsInterface& si) const
   si.SetUIntValue("Audio", "FastForwardVolume", audio_fast_forward_volume);
   si.SetBoolValue("Audio", "OutputMuted", audio_output_muted);
   si.SetBoolValue("Audio", "DumpOnBoot", audio_dump_on_boot);
+  si.SetBoolValue("Audio", "AudioOnlyPSF", audio_only_psf);
 
   si.SetIntValue("Hacks", "DMAMaxSliceTicks", dma_max_slice_ticks);
   si.SetIntValue("Hacks", "DMAHaltTicks", dma_halt_ticks);
@@ -503,6 +571,7 @@ void Settings::Save(SettingsInterface& si) const
 
   si.SetBoolValue("BIOS", "PatchTTYEnable", bios_patch_tty_enable);
   si.SetBoolValue("BIOS", "PatchFastBoot", bios_patch_fast_boot);
+  si.SetBoolValue("BIOS", "InstantBoot", bios_instant_boot);
 
   for (u32 i = 0; i < NUM_CONTROLLER_AND_CARD_PORTS; i++)
   {
@@ -555,6 +624,8 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("TextureReplacements", "EnableVRAMWriteReplacements",
                   texture_replacements.enable_vram_write_replacements);
   si.SetBoolValue("TextureReplacements", "PreloadTextures", texture_replacements.preload_textures);
+  si.SetBoolValue("TextureReplacements", "AsyncLoading", texture_replacements.async_loading);
+  si.SetUIntValue("TextureReplacements", "MaxCacheSizeMB", texture_replacements.max_cache_size_mb);
   si.SetBoolValue("TextureReplacements", "DumpVRAMWrites", texture_replacements.dump_vram_writes);
   si.SetBoolValue("TextureReplacements", "DumpVRAMWriteForceAlphaChannel",
                   texture_replacements.dump_vram_write_force_alpha_channel);
@@ -573,6 +644,8 @@ void Settings::FixIncompatibleSettings(bool display_osd_messages)
     g_settings.cpu_overclock_active = false;
     g_settings.enable_8mb_ram = false;
     g_settings.gpu_resolution_scale = 1;
+    g_settings.gpu_dynamic_resolution = false;
+    g_settings.gpu_software_renderer_scale = 1;
     g_settings.gpu_multisamples = 1;
     g_settings.gpu_per_sample_shading = false;
     g_settings.gpu_true_color = false;
@@ -662,6 +735,138 @@ void Settings::FixIncompatibleSettings(bool display_osd_messages)
   }
 }
 
+namespace {
+struct SettingChange
+{
+  bool (*changed)(const Settings& lhs, const Settings& rhs);
+  u32 subsystems;
+};
+} // namespace
+
+#define SETTING_CHANGE(field, subsystems)                                                                            \
+  SettingChange { [](const Settings& lhs, const Settings& rhs) { return lhs.field != rhs.field; }, (subsystems) }
+
+// FIXME: memory_card_directory should update the memory cards too
+static const SettingChange s_setting_changes[] = {
+  SETTING_CHANGE(gpu_renderer, Settings::CHANGED_GPU_RENDERER),
+  SETTING_CHANGE(gpu_use_debug_device, Settings::CHANGED_HOST_DISPLAY),
+  SETTING_CHANGE(gpu_threaded_presentation, Settings::CHANGED_HOST_DISPLAY),
+  SETTING_CHANGE(gpu_max_frames_in_flight, Settings::CHANGED_GPU_FRAMES_IN_FLIGHT),
+
+  SETTING_CHANGE(gpu_resolution_scale, Settings::CHANGED_GPU | Settings::CHANGED_MEMORY_STATE_TEXTURES),
+  SETTING_CHANGE(gpu_dynamic_resolution, Settings::CHANGED_GPU | Settings::CHANGED_MEMORY_STATE_TEXTURES),
+  SETTING_CHANGE(gpu_multisamples, Settings::CHANGED_GPU | Settings::CHANGED_MEMORY_STATE_TEXTURES),
+  SETTING_CHANGE(gpu_dynamic_resolution_min_scale, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_per_sample_shading, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_use_thread, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_use_software_renderer_for_readbacks, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_software_renderer_threads, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_software_renderer_scale, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_fifo_size, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_max_run_ahead, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_true_color, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_scaled_dithering, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_texture_filter, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_disable_interlacing, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_force_ntsc_timings, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_24bit_chroma_smoothing, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_downsample_mode, Settings::CHANGED_GPU),
+  SETTING_CHANGE(display_crop_mode, Settings::CHANGED_GPU),
+  SETTING_CHANGE(display_aspect_ratio, Settings::CHANGED_GPU | Settings::CHANGED_ASPECT_RATIO),
+  SETTING_CHANGE(gpu_pgxp_enable, Settings::CHANGED_GPU | Settings::CHANGED_PGXP),
+  SETTING_CHANGE(gpu_pgxp_texture_correction, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_pgxp_color_correction, Settings::CHANGED_GPU),
+  SETTING_CHANGE(gpu_pgxp_depth_buffer, Settings::CHANGED_GPU),
+  SETTING_CHANGE(display_active_start_offset, Settings::CHANGED_GPU),
+  SETTING_CHANGE(display_active_end_offset, Settings::CHANGED_GPU),
+  SETTING_CHANGE(display_line_start_offset, Settings::CHANGED_GPU),
+  SETTING_CHANGE(display_line_end_offset, Settings::CHANGED_GPU),
+  SETTING_CHANGE(display_shared_frame_output, Settings::CHANGED_GPU),
+
+  SETTING_CHANGE(gpu_widescreen_hack, Settings::CHANGED_ASPECT_RATIO),
+  SETTING_CHANGE(display_aspect_ratio_custom_numerator, Settings::CHANGED_ASPECT_RATIO),
+  SETTING_CHANGE(display_aspect_ratio_custom_denominator, Settings::CHANGED_ASPECT_RATIO),
+
+  SETTING_CHANGE(gpu_pgxp_culling, Settings::CHANGED_PGXP),
+  SETTING_CHANGE(gpu_pgxp_vertex_cache, Settings::CHANGED_PGXP),
+  SETTING_CHANGE(gpu_pgxp_cpu, Settings::CHANGED_PGXP),
+
+  SETTING_CHANGE(cpu_overclock_active, Settings::CHANGED_CPU_OVERCLOCK),
+  SETTING_CHANGE(cpu_overclock_numerator, Settings::CHANGED_CPU_OVERCLOCK),
+  SETTING_CHANGE(cpu_overclock_denominator, Settings::CHANGED_CPU_OVERCLOCK),
+  SETTING_CHANGE(cpu_execution_mode, Settings::CHANGED_CPU_EXECUTION_MODE),
+  SETTING_CHANGE(cpu_fastmem_mode, Settings::CHANGED_CPU_EXECUTION_MODE),
+  SETTING_CHANGE(cpu_recompiler_memory_exceptions, Settings::CHANGED_RECOMPILER_CODE_BUFFER),
+  SETTING_CHANGE(cpu_recompiler_code_buffer_size, Settings::CHANGED_RECOMPILER_CODE_BUFFER),
+  SETTING_CHANGE(cpu_idle_loop_skipping, Settings::CHANGED_RECOMPILER_BLOCKS),
+  SETTING_CHANGE(cpu_recompiler_block_linking, Settings::CHANGED_RECOMPILER_BLOCKS),
+  SETTING_CHANGE(cpu_recompiler_perf_map, Settings::CHANGED_RECOMPILER_BLOCKS),
+  SETTING_CHANGE(cpu_recompiler_register_pinning, Settings::CHANGED_RECOMPILER_BLOCKS),
+  SETTING_CHANGE(cpu_recompiler_icache, Settings::CHANGED_RECOMPILER_ICACHE),
+
+  SETTING_CHANGE(audio_backend, Settings::CHANGED_AUDIO_STREAM | Settings::CHANGED_SPEED_LIMITER),
+  SETTING_CHANGE(audio_driver, Settings::CHANGED_AUDIO_STREAM),
+  SETTING_CHANGE(audio_stretch_mode, Settings::CHANGED_AUDIO_STREAM),
+  SETTING_CHANGE(audio_buffer_ms, Settings::CHANGED_AUDIO_STREAM),
+  SETTING_CHANGE(audio_output_latency_ms, Settings::CHANGED_AUDIO_STREAM),
+  SETTING_CHANGE(audio_output_volume, Settings::CHANGED_AUDIO_VOLUME),
+  SETTING_CHANGE(audio_fast_forward_volume, Settings::CHANGED_AUDIO_VOLUME),
+  SETTING_CHANGE(audio_output_muted, Settings::CHANGED_AUDIO_VOLUME),
+
+  SETTING_CHANGE(emulation_speed, Settings::CHANGED_THROTTLE | Settings::CHANGED_SPEED_LIMITER),
+  SETTING_CHANGE(fast_forward_speed, Settings::CHANGED_SPEED_LIMITER),
+  SETTING_CHANGE(video_sync_enabled, Settings::CHANGED_SPEED_LIMITER),
+  SETTING_CHANGE(video_sync_relaxed, Settings::CHANGED_SPEED_LIMITER),
+  SETTING_CHANGE(increase_timer_resolution, Settings::CHANGED_SPEED_LIMITER),
+  SETTING_CHANGE(display_max_fps, Settings::CHANGED_SPEED_LIMITER),
+  SETTING_CHANGE(display_all_frames, Settings::CHANGED_SPEED_LIMITER),
+  SETTING_CHANGE(display_adaptive_frameskip, Settings::CHANGED_SPEED_LIMITER),
+  SETTING_CHANGE(display_pre_frame_sleep, Settings::CHANGED_SPEED_LIMITER),
+  SETTING_CHANGE(sync_to_host_refresh_rate, Settings::CHANGED_SPEED_LIMITER),
+
+  SETTING_CHANGE(cdrom_readahead_sectors, Settings::CHANGED_CDROM_READAHEAD),
+  SETTING_CHANGE(memory_card_types, Settings::CHANGED_MEMORY_CARDS),
+  SETTING_CHANGE(memory_card_paths, Settings::CHANGED_MEMORY_CARDS),
+  SETTING_CHANGE(memory_card_use_playlist_title, Settings::CHANGED_MEMORY_CARD_TITLES),
+
+  SETTING_CHANGE(rewind_enable, Settings::CHANGED_GPU | Settings::CHANGED_MEMORY_SAVE_STATES),
+  SETTING_CHANGE(runahead_frames, Settings::CHANGED_GPU | Settings::CHANGED_MEMORY_SAVE_STATES),
+  SETTING_CHANGE(rewind_save_frequency, Settings::CHANGED_MEMORY_SAVE_STATES),
+  SETTING_CHANGE(rewind_save_slots, Settings::CHANGED_MEMORY_SAVE_STATES),
+  SETTING_CHANGE(rewind_native_resolution_vram, Settings::CHANGED_MEMORY_SAVE_STATES),
+
+  SETTING_CHANGE(texture_replacements.enable_vram_write_replacements, Settings::CHANGED_TEXTURE_REPLACEMENTS),
+  SETTING_CHANGE(texture_replacements.preload_textures, Settings::CHANGED_TEXTURE_REPLACEMENTS),
+  SETTING_CHANGE(texture_replacements.async_loading, Settings::CHANGED_TEXTURE_REPLACEMENTS),
+  SETTING_CHANGE(texture_replacements.max_cache_size_mb, Settings::CHANGED_TEXTURE_REPLACEMENTS),
+
+  SETTING_CHANGE(dma_max_slice_ticks, Settings::CHANGED_DMA),
+  SETTING_CHANGE(dma_halt_ticks, Settings::CHANGED_DMA),
+
+  SETTING_CHANGE(display_post_processing, Settings::CHANGED_POST_PROCESSING),
+  SETTING_CHANGE(display_post_process_chain, Settings::CHANGED_POST_PROCESSING),
+  SETTING_CHANGE(display_show_subsystem_times, Settings::CHANGED_HOST_TIME_ACCOUNTING),
+  SETTING_CHANGE(display_detect_stutters, Settings::CHANGED_HOST_TIME_ACCOUNTING),
+
+  SETTING_CHANGE(controller_types, Settings::CHANGED_CONTROLLER_TYPES),
+  SETTING_CHANGE(multitap_mode, Settings::CHANGED_MULTITAP),
+};
+
+#undef SETTING_CHANGE
+
+u32 Settings::GetChangedSubsystems(const Settings& old_settings) const
+{
+  u32 changed = 0;
+  for (const SettingChange& change : s_setting_changes)
+  {
+    // skip the comparison if everything it would set is already known to have changed
+    if ((changed & change.subsystems) != change.subsystems && change.changed(*this, old_settings))
+      changed |= change.subsystems;
+  }
+
+  return changed;
+}
+
 static std::array<const char*, LOGLEVEL_COUNT> s_log_level_names = {
   {"None", "Error", "Warning", "Perf", "Info", "Verbose", "Dev", "Profile", "Debug", "Trace"}};
 static std::array<const char*, LOGLEVEL_COUNT> s_log_level_display_names = {
@@ -1032,7 +1237,7 @@ static constexpr const char* s_audio_backend_names[] = {
   "Cubeb",
 #endif
 #ifdef _WIN32
-  "XAudio2",
+  "XAudio2", "WASAPI",
 #endif
 #ifdef __ANDROID__
   "AAudio",  "OpenSLES",
@@ -1045,6 +1250,7 @@ static constexpr const char* s_audio_backend_display_names[] = {
 #endif
 #ifdef _WIN32
   TRANSLATABLE("AudioBackend", "XAudio2"),
+  TRANSLATABLE("AudioBackend", "WASAPI (Exclusive)"),
 #endif
 #ifdef __ANDROID__
   "AAudio",
@@ -1313,6 +1519,11 @@ bool EmuFolders::EnsureFoldersExist()
   result = FileSystem::EnsureDirectoryExists(Covers.c_str(), false) && result;
   result = FileSystem::EnsureDirectoryExists(Dumps.c_str(), false) && result;
   result = FileSystem::EnsureDirectoryExists(Path::Combine(Dumps, "audio").c_str(), false) && result;
+  result = FileSystem::EnsureDirectoryExists(Path::Combine(Dumps, "gpu").c_str(), false) && result;
+  result = FileSystem::EnsureDirectoryExists(Path::Combine(Dumps, "video").c_str(), false) && result;
+#ifdef WITH_PROFILER
+  result = FileSystem::EnsureDirectoryExists(Path::Combine(Dumps, "traces").c_str(), false) && result;
+#endif
   result = FileSystem::EnsureDirectoryExists(Path::Combine(Dumps, "textures").c_str(), false) && result;
   result = FileSystem::EnsureDirectoryExists(GameSettings.c_str(), false) && result;
   result = FileSystem::EnsureDirectoryExists(InputProfiles.c_str(), false) && result;
@@ -58,9 +58,16 @@ struct Settings
   u32 cpu_overclock_denominator = 1;
   bool cpu_overclock_enable = false;
   bool cpu_overclock_active = false;
+  bool cpu_idle_loop_skipping = true;
   bool cpu_recompiler_memory_exceptions = false;
   bool cpu_recompiler_block_linking = true;
   bool cpu_recompiler_icache = false;
+  bool cpu_recompiler_block_cache = false;
+  u32 cpu_recompiler_compile_budget = 0;
+  u32 cpu_recompiler_hot_block_threshold = 0;
+  u32 cpu_recompiler_code_buffer_size = 0;
+  bool cpu_recompiler_perf_map = false;
+  bool cpu_recompiler_register_pinning = false;
   CPUFastmemMode cpu_fastmem_mode = DEFAULT_CPU_FASTMEM_MODE;
 
   float emulation_speed = 1.0f;
@@ -86,17 +93,26 @@ struct Settings
   bool rewind_enable = false;
   float rewind_save_frequency = 10.0f;
   u32 rewind_save_slots = 10;
+  bool rewind_native_resolution_vram = false;
   u32 runahead_frames = 0;
 
   GPURenderer gpu_renderer = DEFAULT_GPU_RENDERER;
   std::string gpu_adapter;
   std::string display_post_process_chain;
   u32 gpu_resolution_scale = 1;
+  bool gpu_dynamic_resolution = false;
+  u32 gpu_dynamic_resolution_min_scale = 1;
   u32 gpu_multisamples = 1;
   bool gpu_use_thread = true;
   bool gpu_use_software_renderer_for_readbacks = false;
+  u32 gpu_software_renderer_threads = 1;
+  u32 gpu_software_renderer_scale = 1;
   bool gpu_threaded_presentation = true;
+  u32 gpu_max_frames_in_flight = DEFAULT_GPU_MAX_FRAMES_IN_FLIGHT;
   bool gpu_use_debug_device = false;
+  u32 gpu_shader_cache_size_limit = DEFAULT_GPU_SHADER_CACHE_SIZE_LIMIT;
+  bool gpu_async_pipeline_compilation = false;
+  bool gpu_use_uber_shaders = false;
   bool gpu_per_sample_shading = false;
   bool gpu_true_color = true;
   bool gpu_scaled_dithering = true;
@@ -133,14 +149,23 @@ struct Settings
   bool display_show_resolution = false;
   bool display_show_cpu = false;
   bool display_show_gpu = false;
+  bool display_show_subsystem_times = false;
+  bool display_detect_stutters = false;
   bool display_show_status_indicators = true;
   bool display_show_inputs = false;
   bool display_show_enhancements = false;
   bool display_all_frames = false;
+  bool display_adaptive_frameskip = false;
+  bool display_pre_frame_sleep = false;
   bool display_internal_resolution_screenshots = false;
+  bool display_shared_frame_output = false;
   bool video_sync_enabled = DEFAULT_VSYNC_VALUE;
+  bool video_sync_relaxed = false;
   float display_osd_scale = 100.0f;
   float display_max_fps = DEFAULT_DISPLAY_MAX_FPS;
+  float display_pre_frame_sleep_buffer = DEFAULT_DISPLAY_PRE_FRAME_SLEEP_BUFFER;
+  float display_stutter_threshold = DEFAULT_DISPLAY_STUTTER_THRESHOLD;
+  float display_stutter_median_multiplier = DEFAULT_DISPLAY_STUTTER_MEDIAN_MULTIPLIER;
   float gpu_pgxp_tolerance = -1.0f;
   float gpu_pgxp_depth_clear_threshold = DEFAULT_GPU_PGXP_DEPTH_THRESHOLD;
 
@@ -148,6 +173,8 @@ struct Settings
   bool cdrom_region_check = false;
   bool cdrom_load_image_to_ram = false;
   bool cdrom_load_image_patches = false;
+  bool cdrom_sector_cache = false;
+  u32 cdrom_sector_cache_size = DEFAULT_CDROM_SECTOR_CACHE_SIZE;
   bool cdrom_mute_cd_audio = false;
   u32 cdrom_read_speedup = 1;
   u32 cdrom_seek_speedup = 1;
@@ -161,6 +188,7 @@ struct Settings
   u32 audio_fast_forward_volume = 100;
   bool audio_output_muted = false;
   bool audio_dump_on_boot = false;
+  bool audio_only_psf = true;
 
   // timing hacks section
   TickCount dma_max_slice_ticks = DEFAULT_DMA_MAX_SLICE_TICKS;
@@ -203,6 +231,8 @@ struct Settings
   {
     bool enable_vram_write_replacements = false;
     bool preload_textures = false;
+    bool async_loading = true;
+    u32 max_cache_size_mb = DEFAULT_TEXTURE_REPLACEMENT_CACHE_SIZE_MB;
 
     bool dump_vram_writes = false;
     bool dump_vram_write_force_alpha_channel = true;
@@ -221,7 +251,10 @@ struct Settings
 
   bool bios_patch_tty_enable = false;
   bool bios_patch_fast_boot = DEFAULT_FAST_BOOT_VALUE;
+  bool bios_instant_boot = false;
   bool enable_8mb_ram = false;
+  bool use_huge_pages = false;
+  bool map_resource_files = false;
 
   std::array<ControllerType, NUM_CONTROLLER_AND_CARD_PORTS> controller_types{};
   bool controller_disable_analog_mode_forcing = false;
@@ -309,8 +342,12 @@ struct Settings
     DEFAULT_DMA_HALT_TICKS = 100,
     DEFAULT_GPU_FIFO_SIZE = 16,
     DEFAULT_GPU_MAX_RUN_AHEAD = 128,
+    DEFAULT_GPU_MAX_FRAMES_IN_FLIGHT = 2,
+    MAX_GPU_MAX_FRAMES_IN_FLIGHT = 3,
+    DEFAULT_GPU_SHADER_CACHE_SIZE_LIMIT = 512, // MB, zero is unlimited
     DEFAULT_VRAM_WRITE_DUMP_WIDTH_THRESHOLD = 128,
     DEFAULT_VRAM_WRITE_DUMP_HEIGHT_THRESHOLD = 128,
+    DEFAULT_TEXTURE_REPLACEMENT_CACHE_SIZE_MB = 512,
   };
 
   void Load(SettingsInterface& si);
@@ -318,6 +355,41 @@ struct Settings
 
   void FixIncompatibleSettings(bool display_osd_messages);
 
+  /// Subsystems which have to pick up a settings change, so the rest can be left alone.
+  enum ChangedSubsystem : u32
+  {
+    CHANGED_GPU_RENDERER = (1u << 0),
+    CHANGED_HOST_DISPLAY = (1u << 1),
+    CHANGED_GPU_FRAMES_IN_FLIGHT = (1u << 2),
+    CHANGED_GPU = (1u << 3),
+    CHANGED_MEMORY_STATE_TEXTURES = (1u << 4),
+    CHANGED_CPU_OVERCLOCK = (1u << 5),
+    CHANGED_CPU_EXECUTION_MODE = (1u << 6),
+    CHANGED_RECOMPILER_CODE_BUFFER = (1u << 7),
+    CHANGED_RECOMPILER_BLOCKS = (1u << 8),
+    CHANGED_RECOMPILER_ICACHE = (1u << 9),
+    CHANGED_PGXP = (1u << 10),
+    CHANGED_ASPECT_RATIO = (1u << 11),
+    CHANGED_AUDIO_STREAM = (1u << 12),
+    CHANGED_AUDIO_VOLUME = (1u << 13),
+    CHANGED_THROTTLE = (1u << 14),
+    CHANGED_SPEED_LIMITER = (1u << 15),
+    CHANGED_CDROM_READAHEAD = (1u << 16),
+    CHANGED_MEMORY_CARDS = (1u << 17),
+    CHANGED_MEMORY_CARD_TITLES = (1u << 18),
+    CHANGED_MEMORY_SAVE_STATES = (1u << 19),
+    CHANGED_TEXTURE_REPLACEMENTS = (1u << 20),
+    CHANGED_DMA = (1u << 21),
+    CHANGED_POST_PROCESSING = (1u << 22),
+    CHANGED_HOST_TIME_ACCOUNTING = (1u << 23),
+    CHANGED_CONTROLLER_TYPES = (1u << 24),
+    CHANGED_MULTITAP = (1u << 25),
+  };
+
+  /// Returns the ChangedSubsystem bits for the settings which differ from the old ones. Settings which only affect
+  /// how things are drawn each frame, e.g. the OSD, don't need anything re-applied and aren't tracked.
+  u32 GetChangedSubsystems(const Settings& old_settings) const;
+
   static std::optional<LOGLEVEL> ParseLogLevelName(const char* str);
   static const char* GetLogLevelName(LOGLEVEL level);
   static const char* GetLogLevelDisplayName(LOGLEVEL level);
@@ -390,6 +462,8 @@ struct Settings
   static constexpr GPUDownsampleMode DEFAULT_GPU_DOWNSAMPLE_MODE = GPUDownsampleMode::Disabled;
   static constexpr ConsoleRegion DEFAULT_CONSOLE_REGION = ConsoleRegion::Auto;
   static constexpr float DEFAULT_GPU_PGXP_DEPTH_THRESHOLD = 300.0f;
+  static constexpr float DEFAULT_DISPLAY_STUTTER_THRESHOLD = 50.0f;
+  static constexpr float DEFAULT_DISPLAY_STUTTER_MEDIAN_MULTIPLIER = 2.0f;
 
 #ifdef WITH_RECOMPILER
   static constexpr CPUExecutionMode DEFAULT_CPU_EXECUTION_MODE = CPUExecutionMode::Recompiler;
@@ -418,6 +492,7 @@ struct Settings
   static constexpr float DEFAULT_OSD_SCALE = 100.0f;
 
   static constexpr u8 DEFAULT_CDROM_READAHEAD_SECTORS = 8;
+  static constexpr u32 DEFAULT_CDROM_SECTOR_CACHE_SIZE = 4096; // MB
 
   static constexpr ControllerType DEFAULT_CONTROLLER_1_TYPE = ControllerType::AnalogController;
   static constexpr ControllerType DEFAULT_CONTROLLER_2_TYPE = ControllerType::None;
@@ -450,12 +525,14 @@ struct Settings
   static constexpr bool DEFAULT_VSYNC_VALUE = false;
   static constexpr bool DEFAULT_FAST_BOOT_VALUE = false;
   static constexpr float DEFAULT_DISPLAY_MAX_FPS = 0.0f;
+  static constexpr float DEFAULT_DISPLAY_PRE_FRAME_SLEEP_BUFFER = 2.0f;
 #else
   static constexpr bool DEFAULT_SAVE_STATE_COMPRESSION = true;
   static constexpr bool DEFAULT_SAVE_STATE_BACKUPS = false;
   static constexpr bool DEFAULT_VSYNC_VALUE = false;
   static constexpr bool DEFAULT_FAST_BOOT_VALUE = true;
   static constexpr float DEFAULT_DISPLAY_MAX_FPS = 60.0f;
+  static constexpr float DEFAULT_DISPLAY_PRE_FRAME_SLEEP_BUFFER = 4.0f;
 #endif
 };
 
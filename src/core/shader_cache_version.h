@@ -1,4 +1,6 @@
 #pragma once
 #include "types.h"
 
-static constexpr u32 SHADER_CACHE_VERSION = 7;
\ No newline at end of file
+// Bump whenever the generated shaders change. The Vulkan batch shaders are cached by their parameters rather than their
+// source, so old entries would otherwise still be used.
+static constexpr u32 SHADER_CACHE_VERSION = 9;
\ No newline at end of file
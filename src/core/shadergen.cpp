@@ -147,6 +147,9 @@ void ShaderGen::WriteHeader(std::stringstream& ss)
     if (!GLAD_GL_VERSION_4_3 && !GLAD_GL_ES_VERSION_3_1 && GLAD_GL_ARB_shader_storage_buffer_object)
       ss << "#extension GL_ARB_shader_storage_buffer_object : require\n";
   }
+
+  if ((m_render_api == RenderAPI::OpenGL || m_render_api == RenderAPI::OpenGLES) && m_supports_framebuffer_fetch)
+    ss << "#extension GL_EXT_shader_framebuffer_fetch : require\n";
 #endif
 
   DefineMacro(ss, "API_OPENGL", m_render_api == RenderAPI::OpenGL);
@@ -464,7 +467,7 @@ void ShaderGen::DeclareFragmentEntryPoint(
   const std::initializer_list<std::pair<const char*, const char*>>& additional_inputs,
   bool declare_fragcoord /* = false */, u32 num_color_outputs /* = 1 */, bool depth_output /* = false */,
   bool msaa /* = false */, bool ssaa /* = false */, bool declare_sample_id /* = false */,
-  bool noperspective_color /* = false */)
+  bool noperspective_color /* = false */, bool framebuffer_fetch /* = false */)
 {
   if (m_glsl)
   {
@@ -515,7 +518,15 @@ void ShaderGen::DeclareFragmentEntryPoint(
     if (depth_output)
       ss << "#define o_depth gl_FragDepth\n";
 
-    if (m_use_glsl_binding_layout)
+    if (framebuffer_fetch)
+    {
+      // EXT_shader_framebuffer_fetch, the output starts with the framebuffer's value
+      Assert(num_color_outputs == 1);
+      if (m_use_glsl_binding_layout)
+        ss << "layout(location = 0) ";
+      ss << "inout float4 o_col0;\n";
+    }
+    else if (m_use_glsl_binding_layout)
     {
       if (m_supports_dual_source_blend)
       {
@@ -44,11 +44,12 @@ protected:
                                  const std::initializer_list<std::pair<const char*, const char*>>& additional_inputs,
                                  bool declare_fragcoord = false, u32 num_color_outputs = 1, bool depth_output = false,
                                  bool msaa = false, bool ssaa = false, bool declare_sample_id = false,
-                                 bool noperspective_color = false);
+                                 bool noperspective_color = false, bool framebuffer_fetch = false);
 
   RenderAPI m_render_api;
   bool m_glsl;
   bool m_supports_dual_source_blend;
+  bool m_supports_framebuffer_fetch = false;
   bool m_use_glsl_interface_blocks;
   bool m_use_glsl_binding_layout;
 
@@ -1,17 +1,31 @@
 #include "spu.h"
 #include "cdrom.h"
+#include "common/bitutils.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/profiler.h"
 #include "dma.h"
 #include "host.h"
+#include "host_time_accounting.h"
 #include "imgui.h"
 #include "interrupt_controller.h"
 #include "system.h"
 #include "util/audio_stream.h"
+#include "util/avi_writer.h"
 #include "util/state_wrapper.h"
 #include "util/wav_writer.h"
 Log_SetChannel(SPU);
 
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 // Enable to dump all voices of the SPU audio individually.
 // #define SPU_DUMP_ALL_VOICES 1
 
@@ -39,7 +53,8 @@ enum : u32
   CAPTURE_BUFFER_SIZE_PER_CHANNEL = 0x400,
   MINIMUM_TICKS_BETWEEN_KEY_ON_OFF = 2,
   NUM_REVERB_REGS = 32,
-  FIFO_SIZE_IN_HALFWORDS = 32
+  FIFO_SIZE_IN_HALFWORDS = 32,
+  ADPCM_DECODE_CACHE_SIZE = 512
 };
 enum : s16
 {
@@ -244,13 +259,14 @@ struct Voice
   bool ignore_loop_address;
 
   bool IsOn() const { return adsr_phase != ADSRPhase::Off; }
+  u32 GetVoiceBit() const;
 
   void KeyOn();
   void KeyOff();
   void ForceOff();
 
-  void DecodeBlock(const ADPCMBlock& block);
-  s32 Interpolate() const;
+  void DecodeBlock(u16 address, const ADPCMBlock& block);
+  void GetInterpolationInputs(s16* samples, s16* coefficients) const;
 
   // Switches to the specified phase, filling in target.
   void UpdateADSREnvelope();
@@ -259,6 +275,28 @@ struct Voice
   void TickADSR();
 };
 
+// Decoded ADPCM block, indexed by block address. Entries are tagged with the raw block and the filter history they
+// were decoded from rather than invalidated on RAM writes, so the output is always identical to a fresh decode. A
+// zeroed entry is itself valid, a zero block with zero history decodes to silence.
+struct ADPCMDecodeCacheEntry
+{
+  ADPCMBlock block;
+  std::array<s16, 2> last_samples;
+  std::array<s16, NUM_SAMPLES_PER_ADPCM_BLOCK> samples;
+};
+
+// Per-frame voice sampling state, stored per-field so the interpolation and envelope can be computed for
+// several voices at once. Each voice contributes four interpolation taps.
+struct VoiceSampleBatch
+{
+  alignas(16) std::array<s16, NUM_VOICES * 4> interpolation_samples;
+  alignas(16) std::array<s16, NUM_VOICES * 4> interpolation_coefficients;
+  alignas(16) std::array<s16, NUM_VOICES> samples;
+  alignas(16) std::array<s16, NUM_VOICES> adsr_volumes;
+  alignas(16) std::array<s32, NUM_VOICES> volumes;
+  u32 active_mask;
+};
+
 struct ReverbRegisters
 {
   s16 vLOUT;
@@ -315,7 +353,10 @@ static void WriteToCaptureBuffer(u32 index, s16 value);
 static void IncrementCaptureBufferPosition();
 
 static void ReadADPCMBlock(u16 address, ADPCMBlock* block);
-static std::tuple<s32, s32> SampleVoice(u32 voice_index);
+static void UpdateActiveVoiceMask();
+static void PrepareVoiceSample(u32 voice_index);
+static void ComputeVoiceVolumes();
+static std::tuple<s32, s32> AdvanceVoice(u32 voice_index);
 
 static void UpdateNoise();
 
@@ -326,6 +367,9 @@ static void ProcessReverb(s16 left_in, s16 right_in, s32* left_out, s32* right_o
 
 static void Execute(void* param, TickCount ticks, TickCount ticks_late);
 static void UpdateEventInterval();
+static bool IsRAMIRQPredictionActive();
+static u32 GetFramesUntilPossibleRAMIRQ();
+static void ScheduleTickEvent();
 
 static void ExecuteFIFOWriteToRAM(TickCount& ticks);
 static void ExecuteFIFOReadFromRAM(TickCount& ticks);
@@ -339,6 +383,7 @@ static void CreateOutputStream();
 static std::unique_ptr<TimingEvent> s_tick_event;
 static std::unique_ptr<TimingEvent> s_transfer_event;
 static std::unique_ptr<Common::WAVWriter> s_dump_writer;
+static Common::AVIWriter* s_media_capture_writer = nullptr;
 static std::unique_ptr<AudioStream> s_audio_stream;
 static std::unique_ptr<AudioStream> s_null_audio_stream;
 static bool s_audio_output_muted = false;
@@ -386,6 +431,11 @@ static std::array<std::array<s16, 64>, 2> s_reverb_upsample_buffer;
 static s32 s_reverb_resample_buffer_position = 0;
 
 static std::array<Voice, NUM_VOICES> s_voices{};
+static VoiceSampleBatch s_voice_batch{};
+static std::array<ADPCMDecodeCacheEntry, ADPCM_DECODE_CACHE_SIZE> s_adpcm_decode_cache{};
+
+/// Bit per voice which is not in the Off phase. Off voices are skipped entirely unless IRQ9 is enabled.
+static u32 s_active_voice_mask = 0;
 
 static InlineFIFOQueue<u16, FIFO_SIZE_IN_HALFWORDS> s_transfer_fifo;
 
@@ -508,6 +558,7 @@ void SPU::Reset()
     v.ignore_loop_address = false;
   }
 
+  UpdateActiveVoiceMask();
   s_transfer_fifo.Clear();
   s_transfer_event->Deactivate();
   s_ram.fill(0);
@@ -577,6 +628,7 @@ bool SPU::DoState(StateWrapper& sw)
 
   if (sw.IsReading())
   {
+    UpdateActiveVoiceMask();
     UpdateEventInterval();
     UpdateTransferEvent();
   }
@@ -751,6 +803,7 @@ void SPU::WriteRegister(u32 offset, u16 value)
       Log_DebugPrintf("SPU key on low <- 0x%04X", ZeroExtend32(value));
       GeneratePendingSamples();
       s_key_on_register = (s_key_on_register & 0xFFFF0000) | ZeroExtend32(value);
+      UpdateEventInterval();
     }
     break;
 
@@ -759,6 +812,7 @@ void SPU::WriteRegister(u32 offset, u16 value)
       Log_DebugPrintf("SPU key on high <- 0x%04X", ZeroExtend32(value));
       GeneratePendingSamples();
       s_key_on_register = (s_key_on_register & 0x0000FFFF) | (ZeroExtend32(value) << 16);
+      UpdateEventInterval();
     }
     break;
 
@@ -783,6 +837,7 @@ void SPU::WriteRegister(u32 offset, u16 value)
       GeneratePendingSamples();
       s_pitch_modulation_enable_register = (s_pitch_modulation_enable_register & 0xFFFF0000) | ZeroExtend32(value);
       Log_DebugPrintf("SPU pitch modulation enable register <- 0x%08X", s_pitch_modulation_enable_register);
+      UpdateEventInterval();
     }
     break;
 
@@ -792,6 +847,7 @@ void SPU::WriteRegister(u32 offset, u16 value)
       s_pitch_modulation_enable_register =
         (s_pitch_modulation_enable_register & 0x0000FFFF) | (ZeroExtend32(value) << 16);
       Log_DebugPrintf("SPU pitch modulation enable register <- 0x%08X", s_pitch_modulation_enable_register);
+      UpdateEventInterval();
     }
     break;
 
@@ -846,6 +902,7 @@ void SPU::WriteRegister(u32 offset, u16 value)
       if (IsRAMIRQTriggerable())
         CheckForLateRAMIRQs();
 
+      UpdateEventInterval();
       return;
     }
 
@@ -1015,8 +1072,9 @@ void SPU::WriteVoiceRegister(u32 offset, u16 value)
   const u32 voice_index = (offset / 0x10);
   DebugAssert(voice_index < 24);
 
+  // Voices which are off still fetch blocks while the IRQ is enabled, so their pitch and loop address matter too.
   Voice& voice = s_voices[voice_index];
-  if (voice.IsOn() || s_key_on_register & (1u << voice_index))
+  if (voice.IsOn() || s_key_on_register & (1u << voice_index) || s_SPUCNT.irq9_enable)
     GeneratePendingSamples();
 
   switch (reg_index)
@@ -1041,6 +1099,7 @@ void SPU::WriteVoiceRegister(u32 offset, u16 value)
     {
       Log_DebugPrintf("SPU voice %u ADPCM sample rate <- 0x%04X", voice_index, value);
       voice.regs.adpcm_sample_rate = value;
+      UpdateEventInterval();
     }
     break;
 
@@ -1094,6 +1153,8 @@ void SPU::WriteVoiceRegister(u32 offset, u16 value)
         Log_DevPrintf("Not ignoring loop address, the ADPCM repeat address of 0x%04X for voice %u will be overwritten",
                       value, voice_index);
       }
+
+      UpdateEventInterval();
     }
     break;
 
@@ -1507,6 +1568,11 @@ bool SPU::StopDumpingAudio()
   return true;
 }
 
+void SPU::SetMediaCaptureWriter(Common::AVIWriter* writer)
+{
+  s_media_capture_writer = writer;
+}
+
 const std::array<u8, SPU::RAM_SIZE>& SPU::GetRAM()
 {
   return s_ram;
@@ -1532,6 +1598,21 @@ AudioStream* SPU::GetOutputStream()
   return s_audio_stream.get();
 }
 
+u32 SPU::Voice::GetVoiceBit() const
+{
+  return u32(1) << static_cast<u32>(this - s_voices.data());
+}
+
+void SPU::UpdateActiveVoiceMask()
+{
+  s_active_voice_mask = 0;
+  for (u32 i = 0; i < NUM_VOICES; i++)
+    s_active_voice_mask |= s_voices[i].IsOn() ? (u32(1) << i) : 0u;
+
+  // Force the last volume of all off voices to be cleared on the next frame.
+  s_voice_batch.active_mask = (u32(1) << NUM_VOICES) - 1;
+}
+
 void SPU::Voice::KeyOn()
 {
   current_address = regs.adpcm_start_address & ~u16(1);
@@ -1547,6 +1628,7 @@ void SPU::Voice::KeyOn()
   is_first_block = true;
   ignore_loop_address = false;
   adsr_phase = ADSRPhase::Attack;
+  s_active_voice_mask |= GetVoiceBit();
   UpdateADSREnvelope();
 }
 
@@ -1566,6 +1648,7 @@ void SPU::Voice::ForceOff()
 
   regs.adsr_volume = 0;
   adsr_phase = ADSRPhase::Off;
+  s_active_voice_mask &= ~GetVoiceBit();
 }
 
 SPU::ADSRPhase SPU::GetNextADSRPhase(ADSRPhase phase)
@@ -1755,12 +1838,15 @@ void SPU::Voice::TickADSR()
     if (reached_target)
     {
       adsr_phase = GetNextADSRPhase(adsr_phase);
+      if (adsr_phase == ADSRPhase::Off)
+        s_active_voice_mask &= ~GetVoiceBit();
+
       UpdateADSREnvelope();
     }
   }
 }
 
-void SPU::Voice::DecodeBlock(const ADPCMBlock& block)
+void SPU::Voice::DecodeBlock(u16 address, const ADPCMBlock& block)
 {
   static constexpr std::array<s32, 5> filter_table_pos = {{0, 60, 115, 98, 122}};
   static constexpr std::array<s32, 5> filter_table_neg = {{0, 0, -52, -55, -60}};
@@ -1769,6 +1855,22 @@ void SPU::Voice::DecodeBlock(const ADPCMBlock& block)
   current_block_samples[2] = current_block_samples[NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + NUM_SAMPLES_PER_ADPCM_BLOCK - 1];
   current_block_samples[1] = current_block_samples[NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + NUM_SAMPLES_PER_ADPCM_BLOCK - 2];
   current_block_samples[0] = current_block_samples[NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + NUM_SAMPLES_PER_ADPCM_BLOCK - 3];
+  current_block_flags.bits = block.flags.bits;
+
+  // looping samples decode the same blocks over and over
+  ADPCMDecodeCacheEntry& cache_entry = s_adpcm_decode_cache[(address >> 1) % ADPCM_DECODE_CACHE_SIZE];
+  if (cache_entry.last_samples == adpcm_last_samples &&
+      std::memcmp(&cache_entry.block, &block, sizeof(ADPCMBlock)) == 0)
+  {
+    std::copy(cache_entry.samples.begin(), cache_entry.samples.end(),
+              &current_block_samples[NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK]);
+    adpcm_last_samples[0] = cache_entry.samples[NUM_SAMPLES_PER_ADPCM_BLOCK - 1];
+    adpcm_last_samples[1] = cache_entry.samples[NUM_SAMPLES_PER_ADPCM_BLOCK - 2];
+    return;
+  }
+
+  std::memcpy(&cache_entry.block, &block, sizeof(ADPCMBlock));
+  cache_entry.last_samples = adpcm_last_samples;
 
   // pre-lookup
   const u8 shift = block.GetShift();
@@ -1790,86 +1892,87 @@ void SPU::Voice::DecodeBlock(const ADPCMBlock& block)
   }
 
   std::copy(last_samples, last_samples + countof(last_samples), adpcm_last_samples.begin());
-  current_block_flags.bits = block.flags.bits;
-}
-
-s32 SPU::Voice::Interpolate() const
-{
-  static constexpr std::array<s16, 0x200> gauss = {{
-    -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
-    -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
-    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0001, //
-    0x0001, 0x0001, 0x0001, 0x0002, 0x0002, 0x0002, 0x0003, 0x0003, //
-    0x0003, 0x0004, 0x0004, 0x0005, 0x0005, 0x0006, 0x0007, 0x0007, //
-    0x0008, 0x0009, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, //
-    0x000F, 0x0010, 0x0011, 0x0012, 0x0013, 0x0015, 0x0016, 0x0018, // entry
-    0x0019, 0x001B, 0x001C, 0x001E, 0x0020, 0x0021, 0x0023, 0x0025, // 000..07F
-    0x0027, 0x0029, 0x002C, 0x002E, 0x0030, 0x0033, 0x0035, 0x0038, //
-    0x003A, 0x003D, 0x0040, 0x0043, 0x0046, 0x0049, 0x004D, 0x0050, //
-    0x0054, 0x0057, 0x005B, 0x005F, 0x0063, 0x0067, 0x006B, 0x006F, //
-    0x0074, 0x0078, 0x007D, 0x0082, 0x0087, 0x008C, 0x0091, 0x0096, //
-    0x009C, 0x00A1, 0x00A7, 0x00AD, 0x00B3, 0x00BA, 0x00C0, 0x00C7, //
-    0x00CD, 0x00D4, 0x00DB, 0x00E3, 0x00EA, 0x00F2, 0x00FA, 0x0101, //
-    0x010A, 0x0112, 0x011B, 0x0123, 0x012C, 0x0135, 0x013F, 0x0148, //
-    0x0152, 0x015C, 0x0166, 0x0171, 0x017B, 0x0186, 0x0191, 0x019C, //
-    0x01A8, 0x01B4, 0x01C0, 0x01CC, 0x01D9, 0x01E5, 0x01F2, 0x0200, //
-    0x020D, 0x021B, 0x0229, 0x0237, 0x0246, 0x0255, 0x0264, 0x0273, //
-    0x0283, 0x0293, 0x02A3, 0x02B4, 0x02C4, 0x02D6, 0x02E7, 0x02F9, //
-    0x030B, 0x031D, 0x0330, 0x0343, 0x0356, 0x036A, 0x037E, 0x0392, //
-    0x03A7, 0x03BC, 0x03D1, 0x03E7, 0x03FC, 0x0413, 0x042A, 0x0441, //
-    0x0458, 0x0470, 0x0488, 0x04A0, 0x04B9, 0x04D2, 0x04EC, 0x0506, //
-    0x0520, 0x053B, 0x0556, 0x0572, 0x058E, 0x05AA, 0x05C7, 0x05E4, // entry
-    0x0601, 0x061F, 0x063E, 0x065C, 0x067C, 0x069B, 0x06BB, 0x06DC, // 080..0FF
-    0x06FD, 0x071E, 0x0740, 0x0762, 0x0784, 0x07A7, 0x07CB, 0x07EF, //
-    0x0813, 0x0838, 0x085D, 0x0883, 0x08A9, 0x08D0, 0x08F7, 0x091E, //
-    0x0946, 0x096F, 0x0998, 0x09C1, 0x09EB, 0x0A16, 0x0A40, 0x0A6C, //
-    0x0A98, 0x0AC4, 0x0AF1, 0x0B1E, 0x0B4C, 0x0B7A, 0x0BA9, 0x0BD8, //
-    0x0C07, 0x0C38, 0x0C68, 0x0C99, 0x0CCB, 0x0CFD, 0x0D30, 0x0D63, //
-    0x0D97, 0x0DCB, 0x0E00, 0x0E35, 0x0E6B, 0x0EA1, 0x0ED7, 0x0F0F, //
-    0x0F46, 0x0F7F, 0x0FB7, 0x0FF1, 0x102A, 0x1065, 0x109F, 0x10DB, //
-    0x1116, 0x1153, 0x118F, 0x11CD, 0x120B, 0x1249, 0x1288, 0x12C7, //
-    0x1307, 0x1347, 0x1388, 0x13C9, 0x140B, 0x144D, 0x1490, 0x14D4, //
-    0x1517, 0x155C, 0x15A0, 0x15E6, 0x162C, 0x1672, 0x16B9, 0x1700, //
-    0x1747, 0x1790, 0x17D8, 0x1821, 0x186B, 0x18B5, 0x1900, 0x194B, //
-    0x1996, 0x19E2, 0x1A2E, 0x1A7B, 0x1AC8, 0x1B16, 0x1B64, 0x1BB3, //
-    0x1C02, 0x1C51, 0x1CA1, 0x1CF1, 0x1D42, 0x1D93, 0x1DE5, 0x1E37, //
-    0x1E89, 0x1EDC, 0x1F2F, 0x1F82, 0x1FD6, 0x202A, 0x207F, 0x20D4, //
-    0x2129, 0x217F, 0x21D5, 0x222C, 0x2282, 0x22DA, 0x2331, 0x2389, // entry
-    0x23E1, 0x2439, 0x2492, 0x24EB, 0x2545, 0x259E, 0x25F8, 0x2653, // 100..17F
-    0x26AD, 0x2708, 0x2763, 0x27BE, 0x281A, 0x2876, 0x28D2, 0x292E, //
-    0x298B, 0x29E7, 0x2A44, 0x2AA1, 0x2AFF, 0x2B5C, 0x2BBA, 0x2C18, //
-    0x2C76, 0x2CD4, 0x2D33, 0x2D91, 0x2DF0, 0x2E4F, 0x2EAE, 0x2F0D, //
-    0x2F6C, 0x2FCC, 0x302B, 0x308B, 0x30EA, 0x314A, 0x31AA, 0x3209, //
-    0x3269, 0x32C9, 0x3329, 0x3389, 0x33E9, 0x3449, 0x34A9, 0x3509, //
-    0x3569, 0x35C9, 0x3629, 0x3689, 0x36E8, 0x3748, 0x37A8, 0x3807, //
-    0x3867, 0x38C6, 0x3926, 0x3985, 0x39E4, 0x3A43, 0x3AA2, 0x3B00, //
-    0x3B5F, 0x3BBD, 0x3C1B, 0x3C79, 0x3CD7, 0x3D35, 0x3D92, 0x3DEF, //
-    0x3E4C, 0x3EA9, 0x3F05, 0x3F62, 0x3FBD, 0x4019, 0x4074, 0x40D0, //
-    0x412A, 0x4185, 0x41DF, 0x4239, 0x4292, 0x42EB, 0x4344, 0x439C, //
-    0x43F4, 0x444C, 0x44A3, 0x44FA, 0x4550, 0x45A6, 0x45FC, 0x4651, //
-    0x46A6, 0x46FA, 0x474E, 0x47A1, 0x47F4, 0x4846, 0x4898, 0x48E9, //
-    0x493A, 0x498A, 0x49D9, 0x4A29, 0x4A77, 0x4AC5, 0x4B13, 0x4B5F, //
-    0x4BAC, 0x4BF7, 0x4C42, 0x4C8D, 0x4CD7, 0x4D20, 0x4D68, 0x4DB0, //
-    0x4DF7, 0x4E3E, 0x4E84, 0x4EC9, 0x4F0E, 0x4F52, 0x4F95, 0x4FD7, // entry
-    0x5019, 0x505A, 0x509A, 0x50DA, 0x5118, 0x5156, 0x5194, 0x51D0, // 180..1FF
-    0x520C, 0x5247, 0x5281, 0x52BA, 0x52F3, 0x532A, 0x5361, 0x5397, //
-    0x53CC, 0x5401, 0x5434, 0x5467, 0x5499, 0x54CA, 0x54FA, 0x5529, //
-    0x5558, 0x5585, 0x55B2, 0x55DE, 0x5609, 0x5632, 0x565B, 0x5684, //
-    0x56AB, 0x56D1, 0x56F6, 0x571B, 0x573E, 0x5761, 0x5782, 0x57A3, //
-    0x57C3, 0x57E2, 0x57FF, 0x581C, 0x5838, 0x5853, 0x586D, 0x5886, //
-    0x589E, 0x58B5, 0x58CB, 0x58E0, 0x58F4, 0x5907, 0x5919, 0x592A, //
-    0x593A, 0x5949, 0x5958, 0x5965, 0x5971, 0x597C, 0x5986, 0x598F, //
-    0x5997, 0x599E, 0x59A4, 0x59A9, 0x59AD, 0x59B0, 0x59B2, 0x59B3  //
-  }};
-
+  std::copy_n(&current_block_samples[NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK], NUM_SAMPLES_PER_ADPCM_BLOCK,
+              cache_entry.samples.begin());
+}
+
+static constexpr std::array<s16, 0x200> s_gauss_table = {{
+  -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
+  -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0001, //
+  0x0001, 0x0001, 0x0001, 0x0002, 0x0002, 0x0002, 0x0003, 0x0003, //
+  0x0003, 0x0004, 0x0004, 0x0005, 0x0005, 0x0006, 0x0007, 0x0007, //
+  0x0008, 0x0009, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, //
+  0x000F, 0x0010, 0x0011, 0x0012, 0x0013, 0x0015, 0x0016, 0x0018, // entry
+  0x0019, 0x001B, 0x001C, 0x001E, 0x0020, 0x0021, 0x0023, 0x0025, // 000..07F
+  0x0027, 0x0029, 0x002C, 0x002E, 0x0030, 0x0033, 0x0035, 0x0038, //
+  0x003A, 0x003D, 0x0040, 0x0043, 0x0046, 0x0049, 0x004D, 0x0050, //
+  0x0054, 0x0057, 0x005B, 0x005F, 0x0063, 0x0067, 0x006B, 0x006F, //
+  0x0074, 0x0078, 0x007D, 0x0082, 0x0087, 0x008C, 0x0091, 0x0096, //
+  0x009C, 0x00A1, 0x00A7, 0x00AD, 0x00B3, 0x00BA, 0x00C0, 0x00C7, //
+  0x00CD, 0x00D4, 0x00DB, 0x00E3, 0x00EA, 0x00F2, 0x00FA, 0x0101, //
+  0x010A, 0x0112, 0x011B, 0x0123, 0x012C, 0x0135, 0x013F, 0x0148, //
+  0x0152, 0x015C, 0x0166, 0x0171, 0x017B, 0x0186, 0x0191, 0x019C, //
+  0x01A8, 0x01B4, 0x01C0, 0x01CC, 0x01D9, 0x01E5, 0x01F2, 0x0200, //
+  0x020D, 0x021B, 0x0229, 0x0237, 0x0246, 0x0255, 0x0264, 0x0273, //
+  0x0283, 0x0293, 0x02A3, 0x02B4, 0x02C4, 0x02D6, 0x02E7, 0x02F9, //
+  0x030B, 0x031D, 0x0330, 0x0343, 0x0356, 0x036A, 0x037E, 0x0392, //
+  0x03A7, 0x03BC, 0x03D1, 0x03E7, 0x03FC, 0x0413, 0x042A, 0x0441, //
+  0x0458, 0x0470, 0x0488, 0x04A0, 0x04B9, 0x04D2, 0x04EC, 0x0506, //
+  0x0520, 0x053B, 0x0556, 0x0572, 0x058E, 0x05AA, 0x05C7, 0x05E4, // entry
+  0x0601, 0x061F, 0x063E, 0x065C, 0x067C, 0x069B, 0x06BB, 0x06DC, // 080..0FF
+  0x06FD, 0x071E, 0x0740, 0x0762, 0x0784, 0x07A7, 0x07CB, 0x07EF, //
+  0x0813, 0x0838, 0x085D, 0x0883, 0x08A9, 0x08D0, 0x08F7, 0x091E, //
+  0x0946, 0x096F, 0x0998, 0x09C1, 0x09EB, 0x0A16, 0x0A40, 0x0A6C, //
+  0x0A98, 0x0AC4, 0x0AF1, 0x0B1E, 0x0B4C, 0x0B7A, 0x0BA9, 0x0BD8, //
+  0x0C07, 0x0C38, 0x0C68, 0x0C99, 0x0CCB, 0x0CFD, 0x0D30, 0x0D63, //
+  0x0D97, 0x0DCB, 0x0E00, 0x0E35, 0x0E6B, 0x0EA1, 0x0ED7, 0x0F0F, //
+  0x0F46, 0x0F7F, 0x0FB7, 0x0FF1, 0x102A, 0x1065, 0x109F, 0x10DB, //
+  0x1116, 0x1153, 0x118F, 0x11CD, 0x120B, 0x1249, 0x1288, 0x12C7, //
+  0x1307, 0x1347, 0x1388, 0x13C9, 0x140B, 0x144D, 0x1490, 0x14D4, //
+  0x1517, 0x155C, 0x15A0, 0x15E6, 0x162C, 0x1672, 0x16B9, 0x1700, //
+  0x1747, 0x1790, 0x17D8, 0x1821, 0x186B, 0x18B5, 0x1900, 0x194B, //
+  0x1996, 0x19E2, 0x1A2E, 0x1A7B, 0x1AC8, 0x1B16, 0x1B64, 0x1BB3, //
+  0x1C02, 0x1C51, 0x1CA1, 0x1CF1, 0x1D42, 0x1D93, 0x1DE5, 0x1E37, //
+  0x1E89, 0x1EDC, 0x1F2F, 0x1F82, 0x1FD6, 0x202A, 0x207F, 0x20D4, //
+  0x2129, 0x217F, 0x21D5, 0x222C, 0x2282, 0x22DA, 0x2331, 0x2389, // entry
+  0x23E1, 0x2439, 0x2492, 0x24EB, 0x2545, 0x259E, 0x25F8, 0x2653, // 100..17F
+  0x26AD, 0x2708, 0x2763, 0x27BE, 0x281A, 0x2876, 0x28D2, 0x292E, //
+  0x298B, 0x29E7, 0x2A44, 0x2AA1, 0x2AFF, 0x2B5C, 0x2BBA, 0x2C18, //
+  0x2C76, 0x2CD4, 0x2D33, 0x2D91, 0x2DF0, 0x2E4F, 0x2EAE, 0x2F0D, //
+  0x2F6C, 0x2FCC, 0x302B, 0x308B, 0x30EA, 0x314A, 0x31AA, 0x3209, //
+  0x3269, 0x32C9, 0x3329, 0x3389, 0x33E9, 0x3449, 0x34A9, 0x3509, //
+  0x3569, 0x35C9, 0x3629, 0x3689, 0x36E8, 0x3748, 0x37A8, 0x3807, //
+  0x3867, 0x38C6, 0x3926, 0x3985, 0x39E4, 0x3A43, 0x3AA2, 0x3B00, //
+  0x3B5F, 0x3BBD, 0x3C1B, 0x3C79, 0x3CD7, 0x3D35, 0x3D92, 0x3DEF, //
+  0x3E4C, 0x3EA9, 0x3F05, 0x3F62, 0x3FBD, 0x4019, 0x4074, 0x40D0, //
+  0x412A, 0x4185, 0x41DF, 0x4239, 0x4292, 0x42EB, 0x4344, 0x439C, //
+  0x43F4, 0x444C, 0x44A3, 0x44FA, 0x4550, 0x45A6, 0x45FC, 0x4651, //
+  0x46A6, 0x46FA, 0x474E, 0x47A1, 0x47F4, 0x4846, 0x4898, 0x48E9, //
+  0x493A, 0x498A, 0x49D9, 0x4A29, 0x4A77, 0x4AC5, 0x4B13, 0x4B5F, //
+  0x4BAC, 0x4BF7, 0x4C42, 0x4C8D, 0x4CD7, 0x4D20, 0x4D68, 0x4DB0, //
+  0x4DF7, 0x4E3E, 0x4E84, 0x4EC9, 0x4F0E, 0x4F52, 0x4F95, 0x4FD7, // entry
+  0x5019, 0x505A, 0x509A, 0x50DA, 0x5118, 0x5156, 0x5194, 0x51D0, // 180..1FF
+  0x520C, 0x5247, 0x5281, 0x52BA, 0x52F3, 0x532A, 0x5361, 0x5397, //
+  0x53CC, 0x5401, 0x5434, 0x5467, 0x5499, 0x54CA, 0x54FA, 0x5529, //
+  0x5558, 0x5585, 0x55B2, 0x55DE, 0x5609, 0x5632, 0x565B, 0x5684, //
+  0x56AB, 0x56D1, 0x56F6, 0x571B, 0x573E, 0x5761, 0x5782, 0x57A3, //
+  0x57C3, 0x57E2, 0x57FF, 0x581C, 0x5838, 0x5853, 0x586D, 0x5886, //
+  0x589E, 0x58B5, 0x58CB, 0x58E0, 0x58F4, 0x5907, 0x5919, 0x592A, //
+  0x593A, 0x5949, 0x5958, 0x5965, 0x5971, 0x597C, 0x5986, 0x598F, //
+  0x5997, 0x599E, 0x59A4, 0x59A9, 0x59AD, 0x59B0, 0x59B2, 0x59B3  //
+}};
+
+void SPU::Voice::GetInterpolationInputs(s16* samples, s16* coefficients) const
+{
   const u8 i = counter.interpolation_index;
   const u32 s = NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + ZeroExtend32(counter.sample_index.GetValue());
 
-  s32 out = s32(gauss[0x0FF - i]) * s32(current_block_samples[s - 3]);
-  out += s32(gauss[0x1FF - i]) * s32(current_block_samples[s - 2]);
-  out += s32(gauss[0x100 + i]) * s32(current_block_samples[s - 1]);
-  out += s32(gauss[0x000 + i]) * s32(current_block_samples[s - 0]);
-  return out >> 15;
+  std::memcpy(samples, &current_block_samples[s - 3], sizeof(s16) * 4);
+  coefficients[0] = s_gauss_table[0x0FF - i];
+  coefficients[1] = s_gauss_table[0x1FF - i];
+  coefficients[2] = s_gauss_table[0x100 + i];
+  coefficients[3] = s_gauss_table[0x000 + i];
 }
 
 void SPU::ReadADPCMBlock(u16 address, ADPCMBlock* block)
@@ -1899,29 +2002,17 @@ void SPU::ReadADPCMBlock(u16 address, ADPCMBlock* block)
   }
 }
 
-ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::SampleVoice(u32 voice_index)
+ALWAYS_INLINE_RELEASE void SPU::PrepareVoiceSample(u32 voice_index)
 {
   Voice& voice = s_voices[voice_index];
-  if (!voice.IsOn() && !s_SPUCNT.irq9_enable)
-  {
-    voice.last_volume = 0;
-
-#ifdef SPU_DUMP_ALL_VOICES
-    if (s_voice_dump_writers[voice_index])
-    {
-      const s16 dump_samples[2] = {0, 0};
-      s_voice_dump_writers[voice_index]->WriteFrames(dump_samples, 1);
-    }
-#endif
-
-    return {};
-  }
+  s16* const interpolation_samples = &s_voice_batch.interpolation_samples[voice_index * 4];
+  s16* const interpolation_coefficients = &s_voice_batch.interpolation_coefficients[voice_index * 4];
 
   if (!voice.has_samples)
   {
     ADPCMBlock block;
     ReadADPCMBlock(voice.current_address, &block);
-    voice.DecodeBlock(block);
+    voice.DecodeBlock(voice.current_address, block);
     voice.has_samples = true;
 
     if (voice.current_block_flags.loop_start && !voice.ignore_loop_address)
@@ -1931,24 +2022,109 @@ ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::SampleVoice(u32 voice_index)
     }
   }
 
-  // skip interpolation when the volume is muted anyway
-  s32 volume;
-  if (voice.regs.adsr_volume != 0)
+  // skip interpolation when the volume is muted anyway, noise replaces the sample in ComputeVoiceVolumes()
+  s_voice_batch.adsr_volumes[voice_index] = voice.regs.adsr_volume;
+  if (voice.regs.adsr_volume != 0 && !IsVoiceNoiseEnabled(voice_index))
+    voice.GetInterpolationInputs(interpolation_samples, interpolation_coefficients);
+  else
+    std::memset(interpolation_samples, 0, sizeof(s16) * 4);
+}
+
+void SPU::ComputeVoiceVolumes()
+{
+  VoiceSampleBatch& batch = s_voice_batch;
+
+  // The gaussian table rows sum to less than 0x8000 in magnitude, so interpolated samples always fit in 16 bits,
+  // and the products below are exact in 32 bits. This matches ApplyVolume()/the scalar interpolation bit-for-bit.
+#if defined(CPU_X64)
+  for (u32 i = 0; i < NUM_VOICES; i += 8)
   {
-    // interpolate/sample and apply ADSR volume
-    s32 sample;
-    if (IsVoiceNoiseEnabled(voice_index))
-      sample = GetVoiceNoiseLevel();
-    else
-      sample = voice.Interpolate();
+    __m128i sums[2];
+    for (u32 j = 0; j < 2; j++)
+    {
+      // madd sums adjacent tap pairs, leaving two partial sums per voice.
+      const u32 base = (i + j * 4) * 4;
+      const __m128i p01 =
+        _mm_madd_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(&batch.interpolation_samples[base])),
+                       _mm_load_si128(reinterpret_cast<const __m128i*>(&batch.interpolation_coefficients[base])));
+      const __m128i p23 =
+        _mm_madd_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(&batch.interpolation_samples[base + 8])),
+                       _mm_load_si128(reinterpret_cast<const __m128i*>(&batch.interpolation_coefficients[base + 8])));
+      const __m128i even =
+        _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(p01), _mm_castsi128_ps(p23), _MM_SHUFFLE(2, 0, 2, 0)));
+      const __m128i odd =
+        _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(p01), _mm_castsi128_ps(p23), _MM_SHUFFLE(3, 1, 3, 1)));
+      sums[j] = _mm_srai_epi32(_mm_add_epi32(even, odd), 15);
+    }
 
-    volume = ApplyVolume(sample, voice.regs.adsr_volume);
+    _mm_store_si128(reinterpret_cast<__m128i*>(&batch.samples[i]), _mm_packs_epi32(sums[0], sums[1]));
   }
-  else
+#elif defined(CPU_AARCH64)
+  for (u32 i = 0; i < NUM_VOICES; i += 4)
+  {
+    const u32 base = i * 4;
+    const int16x8_t s01 = vld1q_s16(&batch.interpolation_samples[base]);
+    const int16x8_t c01 = vld1q_s16(&batch.interpolation_coefficients[base]);
+    const int16x8_t s23 = vld1q_s16(&batch.interpolation_samples[base + 8]);
+    const int16x8_t c23 = vld1q_s16(&batch.interpolation_coefficients[base + 8]);
+    const int32x4_t p0 = vmull_s16(vget_low_s16(s01), vget_low_s16(c01));
+    const int32x4_t p1 = vmull_high_s16(s01, c01);
+    const int32x4_t p2 = vmull_s16(vget_low_s16(s23), vget_low_s16(c23));
+    const int32x4_t p3 = vmull_high_s16(s23, c23);
+    const int32x4_t sum = vpaddq_s32(vpaddq_s32(p0, p1), vpaddq_s32(p2, p3));
+    vst1_s16(&batch.samples[i], vmovn_s32(vshrq_n_s32(sum, 15)));
+  }
+#else
+  for (u32 i = 0; i < NUM_VOICES; i++)
+  {
+    const s16* samples = &batch.interpolation_samples[i * 4];
+    const s16* coefficients = &batch.interpolation_coefficients[i * 4];
+    s32 out = s32(coefficients[0]) * s32(samples[0]);
+    out += s32(coefficients[1]) * s32(samples[1]);
+    out += s32(coefficients[2]) * s32(samples[2]);
+    out += s32(coefficients[3]) * s32(samples[3]);
+    batch.samples[i] = static_cast<s16>(out >> 15);
+  }
+#endif
+
+  if (s_noise_mode_register != 0)
   {
-    volume = 0;
+    const s16 noise_level = GetVoiceNoiseLevel();
+    for (u32 i = 0; i < NUM_VOICES; i++)
+    {
+      if (IsVoiceNoiseEnabled(i))
+        batch.samples[i] = noise_level;
+    }
   }
 
+  // apply ADSR volume
+#if defined(CPU_X64)
+  for (u32 i = 0; i < NUM_VOICES; i += 8)
+  {
+    const __m128i samples = _mm_load_si128(reinterpret_cast<const __m128i*>(&batch.samples[i]));
+    const __m128i adsr_volumes = _mm_load_si128(reinterpret_cast<const __m128i*>(&batch.adsr_volumes[i]));
+    const __m128i lo = _mm_mullo_epi16(samples, adsr_volumes);
+    const __m128i hi = _mm_mulhi_epi16(samples, adsr_volumes);
+    _mm_store_si128(reinterpret_cast<__m128i*>(&batch.volumes[i]), _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 15));
+    _mm_store_si128(reinterpret_cast<__m128i*>(&batch.volumes[i + 4]),
+                    _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 15));
+  }
+#elif defined(CPU_AARCH64)
+  for (u32 i = 0; i < NUM_VOICES; i += 4)
+  {
+    const int32x4_t product = vmull_s16(vld1_s16(&batch.samples[i]), vld1_s16(&batch.adsr_volumes[i]));
+    vst1q_s32(&batch.volumes[i], vshrq_n_s32(product, 15));
+  }
+#else
+  for (u32 i = 0; i < NUM_VOICES; i++)
+    batch.volumes[i] = ApplyVolume(batch.samples[i], batch.adsr_volumes[i]);
+#endif
+}
+
+ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::AdvanceVoice(u32 voice_index)
+{
+  Voice& voice = s_voices[voice_index];
+  const s32 volume = s_voice_batch.volumes[voice_index];
   voice.last_volume = volume;
 
   if (voice.adsr_phase != ADSRPhase::Off)
@@ -2076,15 +2252,61 @@ static constexpr std::array<s16, 20> s_reverb_resample_coefficients = {
 static s16 s_last_reverb_input[2];
 static s32 s_last_reverb_output[2];
 
-ALWAYS_INLINE static s32 Reverb4422(const s16* src)
+// Resampling filters expanded for a straight dot product, padded to a multiple of 8 taps. The downsampler only
+// uses even input samples plus the middle one, the padding taps are zero.
+template<u32 N, bool downsample>
+static constexpr std::array<s16, N> ComputeReverbFIRCoefficients()
 {
-  s32 out = 0; // 32-bits is adequate(it won't overflow)
+  std::array<s16, N> coefficients = {};
   for (u32 i = 0; i < 20; i++)
-    out += s_reverb_resample_coefficients[i] * src[i * 2];
+    coefficients[downsample ? (i * 2) : i] = s_reverb_resample_coefficients[i];
+  if (downsample)
+    coefficients[19] = 0x4000;
+  return coefficients;
+}
+alignas(16) static constexpr std::array<s16, 40> s_reverb_downsample_coefficients =
+  ComputeReverbFIRCoefficients<40, true>();
+alignas(16) static constexpr std::array<s16, 24> s_reverb_upsample_coefficients =
+  ComputeReverbFIRCoefficients<24, false>();
+
+/// Reads N samples from src, the resample buffers are mirrored so this never needs to wrap.
+template<u32 N>
+ALWAYS_INLINE static s32 ReverbFIR(const s16* src, const std::array<s16, N>& coefficients)
+{
+  static_assert((N % 8) == 0);
 
-  // Middle non-zero
-  out += 0x4000 * src[19];
-  out >>= 15;
+#if defined(CPU_X64)
+  __m128i sum = _mm_setzero_si128();
+  for (u32 i = 0; i < N; i += 8)
+  {
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i])),
+                                            _mm_load_si128(reinterpret_cast<const __m128i*>(&coefficients[i]))));
+  }
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+#elif defined(CPU_AARCH64)
+  int32x4_t sum = vdupq_n_s32(0);
+  for (u32 i = 0; i < N; i += 8)
+  {
+    const int16x8_t samples = vld1q_s16(&src[i]);
+    const int16x8_t coeffs = vld1q_s16(&coefficients[i]);
+    sum = vmlal_s16(sum, vget_low_s16(samples), vget_low_s16(coeffs));
+    sum = vmlal_high_s16(sum, samples, coeffs);
+  }
+  return vaddvq_s32(sum);
+#else
+  s32 out = 0;
+  for (u32 i = 0; i < N; i++)
+    out += coefficients[i] * src[i];
+  return out;
+#endif
+}
+
+ALWAYS_INLINE static s32 Reverb4422(const s16* src)
+{
+  // 32-bits is adequate(it won't overflow)
+  const s32 out = ReverbFIR<40>(src, s_reverb_downsample_coefficients) >> 15;
   return std::clamp<s32>(out, -32768, 32767);
 }
 
@@ -2099,11 +2321,7 @@ ALWAYS_INLINE static s32 Reverb2244(const s16* src)
   }
   else
   {
-    out = 0;
-    for (u32 i = 0; i < 20; i++)
-      out += s_reverb_resample_coefficients[i] * src[i];
-
-    out >>= 14;
+    out = ReverbFIR<24>(src, s_reverb_upsample_coefficients) >> 14;
     out = std::clamp<s32>(out, -32768, 32767);
   }
 
@@ -2231,6 +2449,8 @@ void SPU::ProcessReverb(s16 left_in, s16 right_in, s32* left_out, s32* right_out
 
 void SPU::Execute(void* param, TickCount ticks, TickCount ticks_late)
 {
+  PROFILE_SCOPE("SPU::Execute");
+  HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::SPU);
   u32 remaining_frames;
   if (g_settings.cpu_overclock_active)
   {
@@ -2262,20 +2482,48 @@ void SPU::Execute(void* param, TickCount ticks, TickCount ticks_late)
       s32 reverb_in_left = 0;
       s32 reverb_in_right = 0;
 
-      u32 reverb_on_register = s_reverb_on_register;
+      // Off voices still read RAM (and can trigger IRQs) when IRQ9 is enabled, otherwise they are silent.
+      const u32 voice_mask = s_SPUCNT.irq9_enable ? ((u32(1) << NUM_VOICES) - 1) : s_active_voice_mask;
+
+      // Voices which were sampled last frame but not this one must output silence, and their last volume is
+      // visible through pitch modulation and the capture buffers.
+      const u32 stale_voice_mask = s_voice_batch.active_mask & ~voice_mask;
+      for (u32 bits = stale_voice_mask; bits != 0; bits &= bits - 1)
+        s_voices[CountTrailingZeros(bits)].last_volume = 0;
+      s_voice_batch.active_mask = voice_mask;
 
+#ifdef SPU_DUMP_ALL_VOICES
       for (u32 voice = 0; voice < NUM_VOICES; voice++)
       {
-        const auto [left, right] = SampleVoice(voice);
-        left_sum += left;
-        right_sum += right;
+        if (!(voice_mask & (u32(1) << voice)) && s_voice_dump_writers[voice])
+        {
+          const s16 dump_samples[2] = {0, 0};
+          s_voice_dump_writers[voice]->WriteFrames(dump_samples, 1);
+        }
+      }
+#endif
+
+      if (voice_mask != 0)
+      {
+        // Decode and gather all voices first, so the interpolation/envelope can be done for several at once.
+        // Pitch modulation depends on the previous voice's volume, so the counters are still advanced in order.
+        for (u32 bits = voice_mask; bits != 0; bits &= bits - 1)
+          PrepareVoiceSample(CountTrailingZeros(bits));
+        ComputeVoiceVolumes();
 
-        if (reverb_on_register & 1u)
+        for (u32 bits = voice_mask; bits != 0; bits &= bits - 1)
         {
-          reverb_in_left += left;
-          reverb_in_right += right;
+          const u32 voice = CountTrailingZeros(bits);
+          const auto [left, right] = AdvanceVoice(voice);
+          left_sum += left;
+          right_sum += right;
+
+          if (s_reverb_on_register & (u32(1) << voice))
+          {
+            reverb_in_left += left;
+            reverb_in_right += right;
+          }
         }
-        reverb_on_register >>= 1;
       }
 
       if (!s_SPUCNT.mute_n)
@@ -2353,27 +2601,114 @@ void SPU::Execute(void* param, TickCount ticks, TickCount ticks_late)
 
     if (s_dump_writer)
       s_dump_writer->WriteFrames(output_frame_start, frames_in_this_batch);
+    if (s_media_capture_writer && !s_audio_output_muted)
+      s_media_capture_writer->WriteAudioFrames(output_frame_start, frames_in_this_batch);
 
     output_stream->EndWrite(frames_in_this_batch);
     remaining_frames -= frames_in_this_batch;
   }
+
+  // Voices have moved on, so the distance to the IRQ address needs to be predicted again.
+  if (s_SPUCNT.enable && s_SPUCNT.irq9_enable)
+    ScheduleTickEvent();
 }
 
 void SPU::UpdateEventInterval()
+{
+  // Without a pending RAM IRQ, the interval only depends on the buffer size, so we don't need to reschedule.
+  if (!IsRAMIRQPredictionActive() && s_tick_event->IsActive() &&
+      s_tick_event->GetInterval() == static_cast<TickCount>(s_audio_stream->GetBufferSize()) * s_cpu_ticks_per_spu_tick)
+  {
+    return;
+  }
+
+  // Ensure all pending ticks have been executed, since we won't get them back after rescheduling.
+  s_tick_event->InvokeEarly(true);
+  ScheduleTickEvent();
+}
+
+bool SPU::IsRAMIRQPredictionActive()
+{
+  return s_SPUCNT.enable && IsRAMIRQTriggerable();
+}
+
+u32 SPU::GetFramesUntilPossibleRAMIRQ()
+{
+  // Returns the number of frames up to and including the first one which could trigger the RAM IRQ. Running the
+  // event for exactly that many frames means the interrupt is raised no later than it would be ticking every frame.
+  const u32 irq_address = ZeroExtend32(s_irq_address) * 8;
+  u32 frames = std::numeric_limits<u32>::max();
+
+  // Capture buffers are written every frame at the same offset in each of the four 1KB regions.
+  if (irq_address < (CAPTURE_BUFFER_SIZE_PER_CHANNEL * 4))
+  {
+    const u32 offset = (irq_address - s_capture_buffer_position) % CAPTURE_BUFFER_SIZE_PER_CHANNEL;
+    frames = offset / sizeof(s16) + 1;
+  }
+
+  // Pending key ons are applied after the first frame, and the voice reads the start block on the second.
+  if (s_key_on_register != 0)
+    frames = std::min<u32>(frames, 2);
+
+  // The address of the next block each voice reads is known from the current block's flags, but the one after that
+  // depends on RAM which could still be written by a transfer. So we can only look ahead by up to two block reads.
+  // All voices fetch blocks while the IRQ is enabled, even if they're off.
+  static constexpr u32 BLOCK_UNITS = NUM_SAMPLES_PER_ADPCM_BLOCK << 12;
+  for (u32 i = 0; i < NUM_VOICES && frames > 1; i++)
+  {
+    const Voice& voice = s_voices[i];
+
+    // Pitch modulation can at most double the step, which is then clamped.
+    const u32 max_step = IsPitchModulationEnabled(i) ? 0x3FFFu :
+                                                       std::min<u32>(voice.regs.adpcm_sample_rate, 0x3FFFu);
+    const u32 position = voice.counter.bits & ((1u << 17) - 1u);
+
+    // Samples are read at the start of the frame following the one where the counter crosses the block end.
+    u32 next_read_frame, following_read_frame;
+    u16 next_read_address;
+    if (!voice.has_samples)
+    {
+      next_read_frame = 1;
+      next_read_address = voice.current_address;
+      following_read_frame =
+        (max_step != 0) ? ((BLOCK_UNITS - position + max_step - 1) / max_step + 1) : std::numeric_limits<u32>::max();
+    }
+    else if (max_step != 0)
+    {
+      next_read_frame = (BLOCK_UNITS - position + max_step - 1) / max_step + 1;
+      next_read_address = voice.current_block_flags.loop_end ? (voice.regs.adpcm_repeat_address & ~u16(1)) :
+                                                               static_cast<u16>(voice.current_address + 2);
+
+      // The counter carries less than one step into the following block.
+      following_read_frame = next_read_frame + BLOCK_UNITS / max_step;
+    }
+    else
+    {
+      continue;
+    }
+
+    const u32 next_read_ram_address = (ZeroExtend32(next_read_address) * 8) & RAM_MASK;
+    if (CheckRAMIRQ(next_read_ram_address) || CheckRAMIRQ((next_read_ram_address + 8) & RAM_MASK))
+      frames = std::min(frames, next_read_frame);
+    else
+      frames = std::min(frames, following_read_frame);
+  }
+
+  return frames;
+}
+
+void SPU::ScheduleTickEvent()
 {
   // Don't generate more than the audio buffer since in a single slice, otherwise we'll both overflow the buffers when
   // we do write it, and the audio thread will underflow since it won't have enough data it the game isn't messing with
   // the SPU state.
   const u32 max_slice_frames = s_audio_stream->GetBufferSize();
 
-  // TODO: Make this predict how long until the interrupt will be hit instead...
-  const u32 interval = (s_SPUCNT.enable && s_SPUCNT.irq9_enable) ? 1 : max_slice_frames;
+  // When the RAM IRQ could fire, run up to the first frame which might trigger it instead of every frame, and catch up
+  // on register accesses which change the prediction.
+  const u32 interval =
+    IsRAMIRQPredictionActive() ? std::clamp<u32>(GetFramesUntilPossibleRAMIRQ(), 1, max_slice_frames) : max_slice_frames;
   const TickCount interval_ticks = static_cast<TickCount>(interval) * s_cpu_ticks_per_spu_tick;
-  if (s_tick_event->IsActive() && s_tick_event->GetInterval() == interval_ticks)
-    return;
-
-  // Ensure all pending ticks have been executed, since we won't get them back after rescheduling.
-  s_tick_event->InvokeEarly(true);
   s_tick_event->SetInterval(interval_ticks);
 
   TickCount downcount = interval_ticks;
@@ -10,6 +10,10 @@ class StateWrapper;
 
 class AudioStream;
 
+namespace Common {
+class AVIWriter;
+}
+
 namespace SPU {
 
 enum : u32
@@ -46,6 +50,9 @@ bool StartDumpingAudio(const char* filename);
 /// Stops dumping audio to file, if started.
 bool StopDumpingAudio();
 
+/// Sends output to a media capture alongside the video frames, pass nullptr to stop.
+void SetMediaCaptureWriter(Common::AVIWriter* writer);
+
 /// Access to SPU RAM.
 const std::array<u8, RAM_SIZE>& GetRAM();
 std::array<u8, RAM_SIZE>& GetWritableRAM();
@@ -5,12 +5,17 @@
 #include "bus.h"
 #include "cdrom.h"
 #include "cheats.h"
+#include "common/align.h"
 #include "common/error.h"
 #include "common/file_system.h"
+#include "common/frame_time_histogram.h"
 #include "common/log.h"
 #include "common/make_array.h"
 #include "common/path.h"
+#include "common/profiler.h"
+#include "common/scoped_guard.h"
 #include "common/string_util.h"
+#include "common/thirdparty/thread_pool.h"
 #include "common/threading.h"
 #include "controller.h"
 #include "cpu_code_cache.h"
@@ -20,16 +25,19 @@
 #include "fmt/format.h"
 #include "game_database.h"
 #include "gpu.h"
+#include "gpu_dump.h"
 #include "gte.h"
 #include "host.h"
 #include "host_display.h"
 #include "host_interface_progress_callback.h"
+#include "host_time_accounting.h"
 #include "host_settings.h"
 #include "interrupt_controller.h"
 #include "libcrypt_serials.h"
 #include "mdec.h"
 #include "memory_card.h"
 #include "multitap.h"
+#include "netplay.h"
 #include "pad.h"
 #include "pgxp.h"
 #include "psf_loader.h"
@@ -39,17 +47,24 @@
 #include "texture_replacements.h"
 #include "timers.h"
 #include "util/audio_stream.h"
+#include "util/avi_writer.h"
 #include "util/ini_settings_interface.h"
 #include "util/iso_reader.h"
 #include "util/state_wrapper.h"
 #include "xxhash.h"
+#include "zstd.h"
 #include <cctype>
 #include <cinttypes>
 #include <cmath>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
+#include <ctime>
 #include <deque>
 #include <fstream>
+#include <future>
 #include <limits>
+#include <mutex>
 #include <thread>
 Log_SetChannel(System);
 
@@ -76,12 +91,83 @@ struct MemorySaveState
   std::unique_ptr<GrowableMemoryByteStream> state_stream;
 };
 
+// Everything that goes into a save state file, captured on the CPU thread so that compressing and writing it can
+// happen elsewhere.
+struct SaveStateBuffer
+{
+  std::string path;
+  bool backup_existing_save;
+  bool show_saved_message = true;
+  u32 compression_method;
+
+  SAVE_STATE_HEADER header;
+  std::string media_filename;
+  std::vector<u32> screenshot;
+  std::unique_ptr<GrowableMemoryByteStream> state_stream;
+
+  // name and offset in state_stream of each top-level component, the rest is filled in when it's written
+  std::vector<SAVE_STATE_SECTION> sections;
+
+  // the screenshot readback is still in flight, and has to be collected before the state is queued for writing
+  bool screenshot_pending = false;
+};
+
+// A save state file read ahead of loading it, with the data section already decompressed.
+struct PrefetchedSaveState
+{
+  std::string path;
+  std::time_t modification_time;
+  s64 size;
+
+  // null if the file couldn't be read, so it isn't retried until something else is prefetched
+  std::unique_ptr<GrowableMemoryByteStream> stream;
+};
+
+struct RewindState
+{
+  std::unique_ptr<GPUTexture> vram_texture;
+
+  // pages which differ from the following state, XORed against it and compressed
+  std::vector<u8> compressed_delta;
+  u32 delta_size;
+  u32 state_size;
+};
+
 namespace System {
 static std::optional<ExtendedSaveStateInfo> InternalGetExtendedSaveStateInfo(ByteStream* stream);
 static bool InternalSaveState(ByteStream* state, u32 screenshot_size = 256,
                               u32 compression_method = SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE);
-static bool SaveMemoryState(MemorySaveState* mss);
-static bool LoadMemoryState(const MemorySaveState& mss);
+static bool SaveStateToBuffer(SaveStateBuffer* buffer, u32 screenshot_size, bool defer_screenshot = false);
+static void FinishSaveStateScreenshot(SaveStateBuffer* buffer);
+static void FinishPendingSaveStateScreenshot();
+static bool DoStateSection(StateWrapper& sw, const char* name);
+static bool WriteSaveStateSections(const SaveStateBuffer& buffer, ByteStream* state, u32 compression_method,
+                                   u32 num_compression_workers);
+static std::optional<std::vector<SAVE_STATE_SECTION>> ReadSaveStateSectionTable(ByteStream* state,
+                                                                               const SAVE_STATE_HEADER& header);
+static bool ReadSaveStateSectionData(ByteStream* state, const SAVE_STATE_SECTION& section, u8* data);
+static std::unique_ptr<GrowableMemoryByteStream> ReadSaveStateSections(ByteStream* state,
+                                                                       const SAVE_STATE_HEADER& header);
+static bool WriteSaveStateBuffer(const SaveStateBuffer& buffer, ByteStream* stream, u32 compression_method,
+                                 u32 num_compression_workers);
+static void WriteSaveStateFile(const SaveStateBuffer& buffer);
+static void QueueSaveStateWrite(SaveStateBuffer buffer);
+static bool ReadPrefetchedSaveState(const char* path, PrefetchedSaveState* pss);
+static std::unique_ptr<GrowableMemoryByteStream> TakePrefetchedSaveState(const char* path);
+static void StartSaveStateThread();
+static void SaveStateThreadEntryPoint();
+static void FlushSaveStateWrites();
+static void StopSaveStateThread();
+static bool SaveMemoryState(MemorySaveState* mss, bool host_vram);
+static bool LoadMemoryState(const MemorySaveState& mss, bool update_display);
+static u32 GetMaxMemoryStateTextures();
+static std::unique_ptr<GPUTexture> AcquireMemoryStateTexture();
+static void ReleaseMemoryStateTexture(std::unique_ptr<GPUTexture> texture);
+static void DestroyMemoryStateTexturePool();
+static bool EncodeRewindDelta(const GrowableMemoryByteStream* older, const GrowableMemoryByteStream* newer,
+                              RewindState* rs);
+static bool DecodeRewindDelta(const RewindState& rs, GrowableMemoryByteStream* stream);
+static void PopRewindHeadState();
 
 static bool LoadEXE(const char* filename);
 
@@ -89,9 +175,16 @@ static std::string GetExecutableNameForImage(ISOReader& iso, bool strip_subdirec
 
 static bool ReadExecutableFromImage(ISOReader& iso, std::string* out_executable_name,
                                     std::vector<u8>* out_executable_data);
+static std::string GetGameHashIdFromImage(ISOReader& iso);
 
 static void StallCPU(TickCount ticks);
 
+static std::string GetInstantBootStatePath(const BIOS::Hash& bios_hash, bool fast_boot);
+static bool ArmInstantBootCapture(CDImage* image, std::string path);
+static void CancelInstantBootCapture();
+static bool InstantBootBreakpointCallback(VirtualMemoryAddress address);
+static void SaveInstantBootState();
+
 static void InternalReset();
 static void ClearRunningGame();
 static void DestroySystem();
@@ -99,7 +192,10 @@ static std::string GetMediaPathFromSaveState(const char* path);
 static bool DoLoadState(ByteStream* stream, bool force_software_renderer, bool update_display);
 static bool DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display, bool is_memory_state);
 static void DoRunFrame();
+static void CheckForStutter(float frame_time);
+static void CaptureMediaFrame();
 static bool CreateGPU(GPURenderer renderer);
+static void ParkGPU();
 static bool SaveUndoLoadState();
 
 static void SetRewinding(bool enabled);
@@ -110,12 +206,14 @@ static void SaveRunaheadState();
 static void DoRunahead();
 
 static void DoMemorySaveStates();
+static void ThrottleToAudio();
 
 static bool Initialize(bool force_software_renderer);
 
 static bool UpdateGameSettingsLayer();
 static void UpdateRunningGame(const char* path, CDImage* image, bool booting);
 static bool CheckForSBIFile(CDImage* image);
+static std::unique_ptr<CDImage> OpenCDImage(const char* path, Common::Error* error);
 static std::unique_ptr<MemoryCard> GetMemoryCardForSlot(u32 slot, MemoryCardType type);
 
 static void SetTimerResolutionIncreased(bool enabled);
@@ -150,15 +248,37 @@ static bool s_turbo_enabled = false;
 static bool s_throttler_enabled = true;
 static bool s_display_all_frames = true;
 static bool s_syncing_to_host = false;
+static bool s_pre_frame_sleep = false;
+
+// while the throttler can't keep up, frames can be emulated without submitting their draws to the host GPU
+static bool s_adaptive_frameskip = false;
+static bool s_adaptive_frameskip_behind = false;
+static bool s_skipping_frame_drawing = false;
+static bool s_previous_frame_drawing_skipped = false;
+static u32 s_consecutive_frames_drawing_skipped = 0;
+
+// PSFs played without rendering, and paced by the audio output when running at normal speed
+static bool s_audio_only = false;
+static bool s_audio_paced = false;
+static u32 s_audio_only_frames_since_present = 0;
+static Common::Timer::Value s_pre_frame_sleep_time = 0;
+static Common::Timer::Value s_last_input_poll_time = 0;
 
 static float s_average_frame_time_accumulator = 0.0f;
 static float s_worst_frame_time_accumulator = 0.0f;
+static float s_worst_frame_work_time_accumulator = 0.0f;
+static float s_average_input_latency_accumulator = 0.0f;
+static float s_worst_input_latency_accumulator = 0.0f;
+static u32 s_input_latency_samples = 0;
 
+static u32 s_performance_counters_update_count = 0;
 static float s_vps = 0.0f;
 static float s_fps = 0.0f;
 static float s_speed = 0.0f;
 static float s_worst_frame_time = 0.0f;
 static float s_average_frame_time = 0.0f;
+static float s_average_input_latency = 0.0f;
+static float s_worst_input_latency = 0.0f;
 static float s_cpu_thread_usage = 0.0f;
 static float s_cpu_thread_time = 0.0f;
 static float s_sw_thread_usage = 0.0f;
@@ -166,6 +286,12 @@ static float s_sw_thread_time = 0.0f;
 static float s_average_gpu_time = 0.0f;
 static float s_accumulated_gpu_time = 0.0f;
 static float s_gpu_usage = 0.0f;
+static HostDisplay::GPUSectionTimes s_average_gpu_section_times = {};
+static HostDisplay::GPUSectionTimes s_accumulated_gpu_section_times = {};
+static bool s_has_gpu_section_times = false;
+static float s_average_fence_wait_time = 0.0f;
+static float s_accumulated_fence_wait_time = 0.0f;
+static u32 s_fence_wait_samples = 0;
 static u32 s_last_frame_number = 0;
 static u32 s_last_internal_frame_number = 0;
 static u32 s_last_global_tick_counter = 0;
@@ -176,14 +302,75 @@ static Common::Timer s_fps_timer;
 static Common::Timer s_frame_timer;
 static Threading::ThreadHandle s_cpu_thread_handle;
 
+// stutters aren't reported until the histogram has this many frames, then not again until the logged frames are gone
+static constexpr u32 MIN_STUTTER_DETECTION_FRAMES = 60;
+static constexpr u32 STUTTER_DETECTION_COOLDOWN_FRAMES = 8;
+static FrameTimeHistogram s_frame_time_histogram;
+static u32 s_stutter_detection_cooldown = 0;
+
 static std::unique_ptr<CheatList> s_cheat_list;
+static std::unique_ptr<GPUDump::Player> s_gpu_dump_player;
+
+// hardware renderer left over from the last session, reused by the next boot if the renderer hasn't changed
+static std::unique_ptr<GPU> s_parked_gpu;
+
+static constexpr u32 MEDIA_CAPTURE_JPEG_QUALITY = 90;
+static std::unique_ptr<Common::AVIWriter> s_media_capture;
+
+#ifdef WITH_PROFILER
+static std::string s_profile_capture_filename;
+#endif
+
+// save state files are compressed and written on a worker thread, in the order they were requested. when there's
+// nothing to write, the same thread reads ahead the state which is highlighted in the load menu.
+static constexpr u32 MAX_SAVE_STATE_COMPRESSION_WORKERS = 4;
+static std::deque<SaveStateBuffer> s_queued_save_states;
+static std::optional<SaveStateBuffer> s_screenshot_pending_save_state;
+static u32 s_save_state_write_counter = 0;
+static std::string s_save_state_prefetch_request;
+static PrefetchedSaveState s_prefetched_save_state;
+static std::mutex s_save_state_mutex;
+static std::condition_variable s_save_state_work_cv;
+static std::condition_variable s_save_state_done_cv;
+static std::thread s_save_state_thread;
+static bool s_save_state_thread_shutdown = false;
+
+// sections are only compressed on multiple threads when they're big enough to split into several jobs
+static constexpr u32 MAX_SAVE_STATE_SECTIONS = 64;
+static constexpr u32 MULTITHREADED_SECTION_COMPRESSION_SIZE = 2 * 1024 * 1024;
+static std::vector<SAVE_STATE_SECTION>* s_save_state_section_recorder = nullptr;
+
+// instant boot, the state is taken the first time the game's executable is entered
+static constexpr u32 INSTANT_BOOT_ENTRY_CODE_WORDS = 16;
+static std::string s_instant_boot_state_path;
+static VirtualMemoryAddress s_instant_boot_entry_pc = 0;
+static std::vector<u32> s_instant_boot_entry_code;
+static bool s_instant_boot_capture_pending = false;
+
+// one for each of the game database and BIOS loads while booting
+static constexpr int BOOT_THREAD_POOL_WORKERS = 2;
 
 // temporary save state, created when loading, used to undo load state
 static std::unique_ptr<ByteStream> m_undo_load_state;
 
 static bool s_memory_saves_enabled = false;
 
-static std::deque<MemorySaveState> s_rewind_states;
+// VRAM copies from memory states which were thrown away, so that clearing the states (which happens on every
+// settings change and state load) doesn't mean reallocating all of them
+static std::vector<std::unique_ptr<GPUTexture>> s_memory_state_texture_pool;
+
+// The newest rewind state is kept whole, older states only store what changed from the state after them, so they can
+// be rebuilt one at a time while rewinding.
+static constexpr u32 REWIND_DELTA_PAGE_SIZE = 4096;
+// negative levels are zstd's fast mode, comparable to LZ4. the deltas are mostly zeros, so they barely grow.
+static constexpr int REWIND_DELTA_COMPRESSION_LEVEL = -4;
+static std::deque<RewindState> s_rewind_states;
+static MemorySaveState s_rewind_head_state;
+static bool s_rewind_head_valid = false;
+static std::unique_ptr<GrowableMemoryByteStream> s_rewind_spare_stream;
+static std::vector<u8> s_rewind_delta_buffer;
+static std::vector<u8> s_rewind_compress_buffer;
+static ZSTD_CCtx* s_rewind_compress_context = nullptr;
 static s32 s_rewind_load_frequency = -1;
 static s32 s_rewind_load_counter = -1;
 static s32 s_rewind_save_frequency = -1;
@@ -191,9 +378,13 @@ static s32 s_rewind_save_counter = -1;
 static bool s_rewinding_first_save = false;
 
 static std::deque<MemorySaveState> s_runahead_states;
+static std::vector<MemorySaveState> s_runahead_spare_states;
 static bool s_runahead_replay_pending = false;
+static bool s_runahead_replaying = false;
 static u32 s_runahead_frames = 0;
 
+static std::vector<MemorySaveState> s_netplay_states;
+
 static TinyString GetTimestampStringForFileName()
 {
   return TinyString::FromFmt("{:%Y-%m-%d_%H-%M-%S}", fmt::localtime(std::time(nullptr)));
@@ -292,6 +483,9 @@ u32 System::GetInternalFrameNumber()
 void System::FrameDone()
 {
   s_frame_number++;
+  if (g_settings.gpu_pgxp_enable && g_settings.gpu_pgxp_vertex_cache)
+    PGXP::EndFrame();
+
   CPU::g_state.frame_done = true;
   CPU::g_state.downcount = 0;
 }
@@ -320,6 +514,19 @@ bool System::IsRunningBIOS()
   return s_running_bios;
 }
 
+void System::GetMemoryHashes(u64* ram_hash, u64* vram_hash, u64* spu_ram_hash)
+{
+  *ram_hash = XXH3_64bits(Bus::g_ram, Bus::g_ram_size);
+  if (vram_hash)
+    *vram_hash = XXH3_64bits(g_gpu->ReadbackVRAM(), VRAM_WIDTH * VRAM_HEIGHT * sizeof(u16));
+  *spu_ram_hash = XXH3_64bits(SPU::GetRAM().data(), SPU::RAM_SIZE);
+}
+
+u32 System::GetPerformanceCountersUpdateCount()
+{
+  return s_performance_counters_update_count;
+}
+
 float System::GetFPS()
 {
   return s_fps;
@@ -340,6 +547,19 @@ float System::GetWorstFrameTime()
 {
   return s_worst_frame_time;
 }
+
+const FrameTimeHistogram& System::GetFrameTimeHistogram()
+{
+  return s_frame_time_histogram;
+}
+float System::GetAverageInputLatency()
+{
+  return s_average_input_latency;
+}
+float System::GetWorstInputLatency()
+{
+  return s_worst_input_latency;
+}
 float System::GetThrottleFrequency()
 {
   return s_throttle_frequency;
@@ -368,6 +588,18 @@ float System::GetGPUAverageTime()
 {
   return s_average_gpu_time;
 }
+float System::GetAverageFenceWaitTime()
+{
+  return s_average_fence_wait_time;
+}
+bool System::HasGPUSectionTimes()
+{
+  return s_has_gpu_section_times;
+}
+float System::GetGPUSectionAverageTime(GPUTimingSection section)
+{
+  return s_average_gpu_section_times[static_cast<size_t>(section)];
+}
 
 bool System::IsExeFileName(const std::string_view& path)
 {
@@ -380,12 +612,18 @@ bool System::IsPsfFileName(const std::string_view& path)
   return (StringUtil::EndsWithNoCase(path, ".psf") || StringUtil::EndsWithNoCase(path, ".minipsf"));
 }
 
+bool System::IsGPUDumpFileName(const std::string_view& path)
+{
+  return StringUtil::EndsWithNoCase(path, ".gpudump");
+}
+
 bool System::IsLoadableFilename(const std::string_view& path)
 {
   static constexpr auto extensions = make_array(".bin", ".cue", ".img", ".iso", ".chd", ".ecm", ".mds", // discs
                                                 ".exe", ".psexe", ".ps-exe",                            // exes
                                                 ".psf", ".minipsf",                                     // psf
                                                 ".m3u",                                                 // playlists
+                                                ".gpudump",                                             // gpu dumps
                                                 ".pbp");
 
   for (const char* test_extension : extensions)
@@ -430,7 +668,11 @@ std::string System::GetGameSerialForPath(const char* image_path, bool fallback_t
 
 std::string System::GetGameIdFromImage(CDImage* cdi, bool fallback_to_hash)
 {
-  std::string code(GetExecutableNameForImage(cdi));
+  ISOReader iso;
+  if (!iso.Open(cdi, 1))
+    return {};
+
+  std::string code(GetExecutableNameForImage(iso, true));
   if (!code.empty())
   {
     // SCES_123.45 -> SCES-12345
@@ -456,7 +698,8 @@ std::string System::GetGameIdFromImage(CDImage* cdi, bool fallback_to_hash)
   if (!fallback_to_hash)
     return {};
 
-  return GetGameHashIdFromImage(cdi);
+  // reuse the reader, SYSTEM.CNF and the root directory are already cached
+  return GetGameHashIdFromImage(iso);
 }
 
 std::string System::GetGameHashIdFromImage(CDImage* cdi)
@@ -465,12 +708,17 @@ std::string System::GetGameHashIdFromImage(CDImage* cdi)
   if (!iso.Open(cdi, 1))
     return {};
 
+  return GetGameHashIdFromImage(iso);
+}
+
+std::string System::GetGameHashIdFromImage(ISOReader& iso)
+{
   std::string exe_name;
   std::vector<u8> exe_buffer;
-  if (!ReadExecutableFromImage(cdi, &exe_name, &exe_buffer))
+  if (!ReadExecutableFromImage(iso, &exe_name, &exe_buffer))
     return {};
 
-  const u32 track_1_length = cdi->GetTrackLength(1);
+  const u32 track_1_length = iso.GetImage()->GetTrackLength(1);
 
   XXH64_state_t* state = XXH64_createState();
   XXH64_reset(state, 0x4242D00C);
@@ -730,6 +978,7 @@ std::string System::GetInputProfilePath(const std::string_view& name)
 bool System::RecreateGPU(GPURenderer renderer, bool force_recreate_display, bool update_display /* = true*/)
 {
   ClearMemorySaveStates();
+  DestroyMemoryStateTexturePool();
   g_gpu->RestoreGraphicsAPIState();
 
   // save current state
@@ -933,6 +1182,7 @@ void System::PauseSystem(bool paused)
 
   if (paused)
   {
+    FinishPendingSaveStateScreenshot();
     Host::OnSystemPaused();
   }
   else
@@ -957,11 +1207,29 @@ bool System::LoadState(const char* filename)
   }
 #endif
 
+  // the other side would carry on from where it was
+  if (Netplay::IsActive())
+  {
+    Host::AddOSDMessage(Host::TranslateStdString("OSDMessage", "Save states can't be loaded during netplay."), 5.0f);
+    return false;
+  }
+
+  // the state being loaded might be the one which is waiting for its screenshot
+  FinishPendingSaveStateScreenshot();
+
   Common::Timer load_timer;
 
-  std::unique_ptr<ByteStream> stream = ByteStream::OpenFile(filename, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
-  if (!stream)
-    return false;
+  std::unique_ptr<ByteStream> stream = TakePrefetchedSaveState(filename);
+  if (stream)
+  {
+    Log_DevPrintf("Using prefetched save state '%s'", filename);
+  }
+  else
+  {
+    stream = ByteStream::OpenFile(filename, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+    if (!stream)
+      return false;
+  }
 
   Log_InfoPrintf("Loading state from '%s'...", filename);
 
@@ -996,9 +1264,50 @@ bool System::LoadState(const char* filename)
 
 bool System::SaveState(const char* filename, bool backup_existing_save)
 {
-  if (backup_existing_save && FileSystem::FileExists(filename))
+  Common::Timer save_timer;
+
+  SaveStateBuffer buffer;
+  buffer.path = filename;
+  buffer.backup_existing_save = backup_existing_save;
+  buffer.compression_method = g_settings.compress_save_states ? SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD :
+                                                                SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE;
+
+  // only one screenshot readback can be in flight
+  FinishPendingSaveStateScreenshot();
+
+  // while running, the screenshot is collected after the next frame, so the GPU doesn't have to be waited on
+  if (!SaveStateToBuffer(&buffer, 256, IsRunning()))
+  {
+    Host::ReportFormattedErrorAsync(Host::TranslateString("OSDMessage", "Save State"),
+                                    Host::TranslateString("OSDMessage", "Saving state to '%s' failed."), filename);
+    return false;
+  }
+
+  Log_VerbosePrintf("Capturing state took %.2f msec", save_timer.GetTimeMilliseconds());
+  if (buffer.screenshot_pending)
+    s_screenshot_pending_save_state = std::move(buffer);
+  else
+    QueueSaveStateWrite(std::move(buffer));
+
+  return true;
+}
+
+void System::FinishPendingSaveStateScreenshot()
+{
+  if (!s_screenshot_pending_save_state.has_value())
+    return;
+
+  FinishSaveStateScreenshot(&s_screenshot_pending_save_state.value());
+  QueueSaveStateWrite(std::move(s_screenshot_pending_save_state.value()));
+  s_screenshot_pending_save_state.reset();
+}
+
+void System::WriteSaveStateFile(const SaveStateBuffer& buffer)
+{
+  const char* filename = buffer.path.c_str();
+  if (buffer.backup_existing_save && FileSystem::FileExists(filename))
   {
-    const std::string backup_filename(Path::ReplaceExtension(filename, "bak"));
+    const std::string backup_filename(Path::ReplaceExtension(buffer.path, "bak"));
     if (!FileSystem::RenamePath(filename, backup_filename.c_str()))
       Log_ErrorPrintf("Failed to rename save state backup '%s'", backup_filename.c_str());
   }
@@ -1008,33 +1317,255 @@ bool System::SaveState(const char* filename, bool backup_existing_save)
   std::unique_ptr<ByteStream> stream =
     ByteStream::OpenFile(filename, BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
                                      BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
-  if (!stream)
-    return false;
 
   Log_InfoPrintf("Saving state to '%s'...", filename);
 
-  const u32 screenshot_size = 256;
-  const bool result = InternalSaveState(stream.get(), screenshot_size,
-                                        g_settings.compress_save_states ? SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD :
-                                                                          SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE);
+  // leave a core for the CPU thread, which is still running the game
+  const u32 num_threads = std::thread::hardware_concurrency();
+  const u32 num_workers = std::min((num_threads > 1) ? (num_threads - 1) : 0u, MAX_SAVE_STATE_COMPRESSION_WORKERS);
+  const bool result =
+    stream && WriteSaveStateBuffer(buffer, stream.get(), buffer.compression_method, num_workers);
   if (!result)
   {
     Host::ReportFormattedErrorAsync(Host::TranslateString("OSDMessage", "Save State"),
                                     Host::TranslateString("OSDMessage", "Saving state to '%s' failed."), filename);
-    stream->Discard();
+    if (stream)
+      stream->Discard();
   }
   else
   {
-    const std::string display_name(FileSystem::GetDisplayNameFromPath(filename));
-    Host::AddIconOSDMessage("save_state", ICON_FA_SAVE,
-                            fmt::format(Host::TranslateString("OSDMessage", "State saved to '{}'.").GetCharArray(),
-                                        Path::GetFileName(display_name)),
-                            5.0f);
+    if (buffer.show_saved_message)
+    {
+      const std::string display_name(FileSystem::GetDisplayNameFromPath(filename));
+      Host::AddIconOSDMessage("save_state", ICON_FA_SAVE,
+                              fmt::format(Host::TranslateString("OSDMessage", "State saved to '{}'.").GetCharArray(),
+                                          Path::GetFileName(display_name)),
+                              5.0f);
+    }
     stream->Commit();
   }
 
-  Log_VerbosePrintf("Saving state took %.2f msec", save_timer.GetTimeMilliseconds());
-  return result;
+  Log_VerbosePrintf("Writing state took %.2f msec", save_timer.GetTimeMilliseconds());
+}
+
+void System::QueueSaveStateWrite(SaveStateBuffer buffer)
+{
+  std::unique_lock lock(s_save_state_mutex);
+
+  // a prefetch which is in progress may have read the old file, so throw it away
+  s_save_state_write_counter++;
+  if (s_prefetched_save_state.path == buffer.path)
+    s_prefetched_save_state = {};
+
+  s_queued_save_states.push_back(std::move(buffer));
+  StartSaveStateThread();
+  s_save_state_work_cv.notify_one();
+}
+
+void System::PrefetchSaveState(const char* filename)
+{
+  if (!IsValid())
+    return;
+
+  std::unique_lock lock(s_save_state_mutex);
+  if (s_save_state_prefetch_request == filename || s_prefetched_save_state.path == filename)
+    return;
+
+  s_save_state_prefetch_request = filename;
+  StartSaveStateThread();
+  s_save_state_work_cv.notify_one();
+}
+
+bool System::ReadPrefetchedSaveState(const char* path, PrefetchedSaveState* pss)
+{
+  Common::Timer read_timer;
+
+  pss->path = path;
+
+  FILESYSTEM_STAT_DATA sd;
+  FileSystem::ManagedCFilePtr fp = FileSystem::OpenManagedCFile(path, "rb");
+  if (!fp || !FileSystem::StatFile(fp.get(), &sd))
+    return false;
+
+  std::optional<std::vector<u8>> data(FileSystem::ReadBinaryFile(fp.get()));
+  fp.reset();
+
+  // versions are checked when it's loaded, so the user gets the error then
+  SAVE_STATE_HEADER header;
+  if (!data.has_value() || data->size() < sizeof(header))
+    return false;
+  std::memcpy(&header, data->data(), sizeof(header));
+  if (header.magic != SAVE_STATE_MAGIC || header.offset_to_data < sizeof(header) ||
+      header.offset_to_data > data->size() || header.data_uncompressed_size > MAX_SAVE_STATE_SIZE)
+  {
+    return false;
+  }
+
+  // everything before the data is copied as-is, only the data is rewritten uncompressed
+  const u32 data_offset = header.offset_to_data;
+  const u32 file_data_size = static_cast<u32>(data->size()) - data_offset;
+  std::unique_ptr<GrowableMemoryByteStream> stream;
+  if (header.data_compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE)
+  {
+    stream = std::make_unique<GrowableMemoryByteStream>(nullptr, static_cast<u32>(data->size()));
+    stream->Resize(static_cast<u32>(data->size()));
+    std::memcpy(stream->GetMemoryPointer() + data_offset, data->data() + data_offset, file_data_size);
+  }
+  else if (header.data_compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD)
+  {
+    if (header.data_compressed_size > file_data_size)
+      return false;
+
+    stream = std::make_unique<GrowableMemoryByteStream>(nullptr, data_offset + header.data_uncompressed_size);
+    stream->Resize(data_offset + header.data_uncompressed_size);
+
+    const size_t ret = ZSTD_decompress(stream->GetMemoryPointer() + data_offset, header.data_uncompressed_size,
+                                       data->data() + data_offset, header.data_compressed_size);
+    if (ZSTD_isError(ret) || ret != header.data_uncompressed_size)
+    {
+      Log_ErrorPrintf("Failed to decompress prefetched save state '%s'", path);
+      return false;
+    }
+
+    header.data_compression_type = SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE;
+    header.data_compressed_size = 0;
+  }
+  else if (header.data_compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_SECTIONS)
+  {
+    std::unique_ptr<ReadOnlyMemoryByteStream> file_stream =
+      ByteStream::CreateReadOnlyMemoryStream(data->data(), static_cast<u32>(data->size()));
+    std::unique_ptr<GrowableMemoryByteStream> state_data(ReadSaveStateSections(file_stream.get(), header));
+    if (!state_data)
+      return false;
+
+    // the section table sits at the start of the data, so it's left out along with the compression
+    const u32 state_data_size = static_cast<u32>(state_data->GetSize());
+    stream = std::make_unique<GrowableMemoryByteStream>(nullptr, data_offset + state_data_size);
+    stream->Resize(data_offset + state_data_size);
+    std::memcpy(stream->GetMemoryPointer() + data_offset, state_data->GetMemoryPointer(), state_data_size);
+
+    header.data_compression_type = SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE;
+    header.data_compressed_size = 0;
+    header.data_uncompressed_size = state_data_size;
+  }
+  else
+  {
+    return false;
+  }
+
+  std::memcpy(stream->GetMemoryPointer(), data->data(), data_offset);
+  std::memcpy(stream->GetMemoryPointer(), &header, sizeof(header));
+  stream->SeekAbsolute(0);
+
+  pss->modification_time = sd.ModificationTime;
+  pss->size = sd.Size;
+  pss->stream = std::move(stream);
+  Log_VerbosePrintf("Prefetching save state '%s' took %.2f msec", path, read_timer.GetTimeMilliseconds());
+  return true;
+}
+
+std::unique_ptr<GrowableMemoryByteStream> System::TakePrefetchedSaveState(const char* path)
+{
+  std::unique_lock lock(s_save_state_mutex);
+
+  // waiting on a prefetch of this file which is already running is never slower than reading it again
+  s_save_state_done_cv.wait(
+    lock, [path]() { return s_queued_save_states.empty() && s_save_state_prefetch_request != path; });
+
+  PrefetchedSaveState pss(std::move(s_prefetched_save_state));
+  s_prefetched_save_state = {};
+  lock.unlock();
+
+  if (pss.path != path || !pss.stream)
+    return {};
+
+  FILESYSTEM_STAT_DATA sd;
+  if (!FileSystem::StatFile(path, &sd) || sd.ModificationTime != pss.modification_time || sd.Size != pss.size)
+  {
+    Log_WarningPrintf("Save state '%s' changed after it was prefetched", path);
+    return {};
+  }
+
+  return std::move(pss.stream);
+}
+
+void System::StartSaveStateThread()
+{
+  if (s_save_state_thread.joinable())
+    return;
+
+  s_save_state_thread_shutdown = false;
+  s_save_state_thread = std::thread(SaveStateThreadEntryPoint);
+}
+
+void System::SaveStateThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Save State Writer");
+
+  std::unique_lock lock(s_save_state_mutex);
+  for (;;)
+  {
+    s_save_state_work_cv.wait(lock, []() {
+      return !s_queued_save_states.empty() || !s_save_state_prefetch_request.empty() || s_save_state_thread_shutdown;
+    });
+
+    if (!s_queued_save_states.empty())
+    {
+      // leave the buffer in the queue until the file is committed, so flushing waits for it
+      lock.unlock();
+      WriteSaveStateFile(s_queued_save_states.front());
+      lock.lock();
+
+      s_queued_save_states.pop_front();
+      if (s_queued_save_states.empty())
+        s_save_state_done_cv.notify_all();
+    }
+    else if (!s_save_state_prefetch_request.empty())
+    {
+      const std::string path(s_save_state_prefetch_request);
+      const u32 write_counter = s_save_state_write_counter;
+      lock.unlock();
+
+      PrefetchedSaveState pss;
+      ReadPrefetchedSaveState(path.c_str(), &pss);
+
+      lock.lock();
+      if (write_counter == s_save_state_write_counter)
+        s_prefetched_save_state = std::move(pss);
+      if (s_save_state_prefetch_request == path)
+        s_save_state_prefetch_request.clear();
+      s_save_state_done_cv.notify_all();
+    }
+    else
+    {
+      break;
+    }
+  }
+}
+
+void System::FlushSaveStateWrites()
+{
+  std::unique_lock lock(s_save_state_mutex);
+  s_save_state_done_cv.wait(lock, []() { return s_queued_save_states.empty(); });
+}
+
+void System::StopSaveStateThread()
+{
+  std::unique_lock lock(s_save_state_mutex);
+  s_save_state_prefetch_request.clear();
+  s_prefetched_save_state = {};
+  if (!s_save_state_thread.joinable())
+    return;
+
+  s_save_state_thread_shutdown = true;
+  s_save_state_work_cv.notify_one();
+  lock.unlock();
+
+  // anything still queued gets written before the thread exits
+  s_save_state_thread.join();
+
+  // a prefetch might have finished while we were waiting
+  s_prefetched_save_state = {};
 }
 
 bool System::SaveResumeState()
@@ -1046,6 +1577,112 @@ bool System::SaveResumeState()
   return SaveState(path.c_str(), false);
 }
 
+std::string System::GetInstantBootStatePath(const BIOS::Hash& bios_hash, bool fast_boot)
+{
+  // anything which changes what happens before the game's code runs, or how the state would be loaded, needs its
+  // own state. the path is included so the state doesn't refer to an image which has moved.
+  std::string key(fmt::format("{}|{}|{}|{}|{}|{}|{}|{}/{}|{}", s_running_game_path, bios_hash.ToString(),
+                              SAVE_STATE_VERSION, static_cast<u32>(s_region), fast_boot,
+                              g_settings.bios_patch_tty_enable, g_settings.enable_8mb_ram,
+                              g_settings.cpu_overclock_active ? g_settings.cpu_overclock_numerator : 1u,
+                              g_settings.cpu_overclock_active ? g_settings.cpu_overclock_denominator : 1u,
+                              static_cast<u32>(g_settings.multitap_mode)));
+  for (u32 i = 0; i < NUM_CONTROLLER_AND_CARD_PORTS; i++)
+  {
+    key += fmt::format("|{}:{}", static_cast<u32>(g_settings.controller_types[i]),
+                       static_cast<u32>(g_settings.memory_card_types[i]));
+  }
+
+  const std::string sanitized_serial(Path::SanitizeFileName(s_running_game_serial));
+  return Path::Combine(EmuFolders::Cache, fmt::format("{}_{:016X}.instantboot", sanitized_serial,
+                                                      XXH64(key.data(), key.size(), 0x4242D00C)));
+}
+
+bool System::ArmInstantBootCapture(CDImage* image, std::string path)
+{
+  std::string exe_name;
+  std::vector<u8> exe_data;
+  BIOS::PSEXEHeader header;
+  if (!ReadExecutableFromImage(image, &exe_name, &exe_data) || exe_data.size() < sizeof(header))
+  {
+    Log_WarningPrintf("Failed to read executable from image, instant boot state can't be captured.");
+    return false;
+  }
+
+  std::memcpy(&header, exe_data.data(), sizeof(header));
+  const u32 entry_offset = sizeof(header) + (header.initial_pc - header.load_address);
+  if (!BIOS::IsValidPSExeHeader(header, static_cast<u32>(exe_data.size())) ||
+      header.initial_pc < header.load_address ||
+      (entry_offset + INSTANT_BOOT_ENTRY_CODE_WORDS * sizeof(u32)) > exe_data.size())
+  {
+    Log_WarningPrintf("Executable '%s' has an unusual entry point, instant boot state can't be captured.",
+                      exe_name.c_str());
+    return false;
+  }
+
+  s_instant_boot_entry_code.resize(INSTANT_BOOT_ENTRY_CODE_WORDS);
+  std::memcpy(s_instant_boot_entry_code.data(), &exe_data[entry_offset], INSTANT_BOOT_ENTRY_CODE_WORDS * sizeof(u32));
+
+  // everything up to the entry point runs in the debug dispatcher, which is only the BIOS and the loading of the
+  // executable
+  if (!CPU::AddBreakpointWithCallback(header.initial_pc, InstantBootBreakpointCallback))
+    return false;
+
+  Log_InfoPrintf("Capturing instant boot state when '%s' reaches %08X", exe_name.c_str(), header.initial_pc);
+  s_instant_boot_state_path = std::move(path);
+  s_instant_boot_entry_pc = header.initial_pc;
+  return true;
+}
+
+void System::CancelInstantBootCapture()
+{
+  if (s_instant_boot_state_path.empty())
+    return;
+
+  CPU::RemoveBreakpoint(s_instant_boot_entry_pc);
+  s_instant_boot_state_path = {};
+  s_instant_boot_entry_code = {};
+  s_instant_boot_capture_pending = false;
+}
+
+bool System::InstantBootBreakpointCallback(VirtualMemoryAddress address)
+{
+  // the shell can run code at the same address before the game is loaded, so check it's the executable's code
+  for (u32 i = 0; i < INSTANT_BOOT_ENTRY_CODE_WORDS; i++)
+  {
+    u32 word;
+    if (!CPU::SafeReadMemoryWord(address + i * sizeof(u32), &word) || word != s_instant_boot_entry_code[i])
+      return true;
+  }
+
+  // the frame ends after this instruction, and the state is saved once the CPU is out of the dispatcher
+  s_instant_boot_capture_pending = true;
+  CPU::ForceDispatcherExit();
+  return false;
+}
+
+void System::SaveInstantBootState()
+{
+  s_instant_boot_capture_pending = false;
+
+  SaveStateBuffer buffer;
+  buffer.path = std::move(s_instant_boot_state_path);
+  buffer.backup_existing_save = false;
+  buffer.show_saved_message = false;
+  buffer.compression_method = g_settings.compress_save_states ? SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD :
+                                                                SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE;
+  s_instant_boot_state_path = {};
+  s_instant_boot_entry_code = {};
+  if (!SaveStateToBuffer(&buffer, 0))
+  {
+    Log_ErrorPrintf("Failed to capture instant boot state.");
+    return;
+  }
+
+  Log_InfoPrintf("Captured instant boot state at %08X after %u frames", CPU::g_state.regs.pc, s_frame_number);
+  QueueSaveStateWrite(std::move(buffer));
+}
+
 bool System::BootSystem(SystemBootParameters parameters)
 {
   if (!parameters.save_state.empty())
@@ -1067,16 +1704,36 @@ bool System::BootSystem(SystemBootParameters parameters)
   s_region = g_settings.region;
   Host::OnSystemStarting();
 
+  // The game database isn't needed until the disc has been opened, and the BIOS isn't needed until the GPU has been
+  // created, so they're loaded alongside. Destroying the pool waits for anything left behind by a failed boot.
+  cb::ThreadPool boot_pool(BOOT_THREAD_POOL_WORKERS);
+  std::future<void> game_database_loaded = boot_pool.ScheduleAndGetFuture(&GameDatabase::EnsureLoaded);
+
   // Load CD image up and detect region.
   Common::Error error;
   std::unique_ptr<CDImage> media;
+  std::unique_ptr<GPUDump::Player> gpu_dump_player;
   bool exe_boot = false;
   bool psf_boot = false;
   if (!parameters.filename.empty())
   {
     exe_boot = IsExeFileName(parameters.filename.c_str());
     psf_boot = (!exe_boot && IsPsfFileName(parameters.filename.c_str()));
-    if (exe_boot || psf_boot)
+    if (IsGPUDumpFileName(parameters.filename.c_str()))
+    {
+      gpu_dump_player = GPUDump::Player::Open(parameters.filename.c_str());
+      if (!gpu_dump_player)
+      {
+        Host::ReportFormattedErrorAsync("Error", "Failed to load GPU dump '%s'", parameters.filename.c_str());
+        s_state = State::Shutdown;
+        Host::OnSystemDestroyed();
+        return false;
+      }
+
+      if (s_region == ConsoleRegion::Auto)
+        s_region = gpu_dump_player->IsPAL() ? ConsoleRegion::PAL : ConsoleRegion::NTSC_U;
+    }
+    else if (exe_boot || psf_boot)
     {
       if (s_region == ConsoleRegion::Auto)
       {
@@ -1089,7 +1746,7 @@ bool System::BootSystem(SystemBootParameters parameters)
     else
     {
       Log_InfoPrintf("Loading CD image '%s'...", parameters.filename.c_str());
-      media = CDImage::Open(parameters.filename.c_str(), g_settings.cdrom_load_image_patches, &error);
+      media = OpenCDImage(parameters.filename.c_str(), &error);
       if (!media)
       {
         Host::ReportErrorAsync("Error", fmt::format("Failed to load CD image '{}': {}",
@@ -1147,6 +1804,7 @@ bool System::BootSystem(SystemBootParameters parameters)
   }
 
   // Update running game, this will apply settings as well.
+  game_database_loaded.wait();
   UpdateRunningGame(media ? media->GetFileName().c_str() : parameters.filename.c_str(), media.get(), true);
 
 #ifdef WITH_CHEEVOS
@@ -1161,17 +1819,18 @@ bool System::BootSystem(SystemBootParameters parameters)
   }
 #endif
 
-  // Load BIOS image.
-  std::optional<BIOS::Image> bios_image(BIOS::GetBIOSImage(s_region));
-  if (!bios_image)
-  {
-    Host::ReportFormattedErrorAsync("Error", Host::TranslateString("System", "Failed to load %s BIOS."),
-                                    Settings::GetConsoleRegionName(s_region));
-    s_state = State::Shutdown;
-    ClearRunningGame();
-    Host::OnSystemDestroyed();
-    return false;
-  }
+  // Load BIOS image, which can mean hashing every file in the directory, while the GPU is created.
+  // The path is returned alongside, so the task doesn't reference anything which a failed boot would destroy first.
+  std::future<std::pair<std::optional<BIOS::Image>, std::string>> bios_image_loaded =
+    boot_pool.ScheduleAndGetFuture([region = s_region]() {
+      std::string path;
+      std::optional<BIOS::Image> image(BIOS::GetBIOSImage(region, &path));
+      return std::make_pair(std::move(image), std::move(path));
+    });
+
+  // Nothing visual matters when playing a PSF, so skip rendering and presenting entirely.
+  s_audio_only = (psf_boot && g_settings.audio_only_psf);
+  s_audio_only_frames_since_present = 0;
 
   // Component setup.
   if (!Initialize(parameters.force_software_renderer))
@@ -1182,10 +1841,19 @@ bool System::BootSystem(SystemBootParameters parameters)
     return false;
   }
 
+  auto [bios_image, bios_path] = bios_image_loaded.get();
+  if (!bios_image)
+  {
+    Host::ReportFormattedErrorAsync("Error", Host::TranslateString("System", "Failed to load %s BIOS."),
+                                    Settings::GetConsoleRegionName(s_region));
+    DestroySystem();
+    return false;
+  }
+
   // Allow controller analog mode for EXEs and PSFs.
-  s_running_bios = s_running_game_path.empty() && !exe_boot && !psf_boot;
+  s_running_bios = s_running_game_path.empty() && !exe_boot && !psf_boot && !gpu_dump_player;
 
-  Bus::SetBIOS(*bios_image);
+  Bus::SetBIOS(*bios_image, bios_path.empty() ? nullptr : bios_path.c_str());
   UpdateControllers();
   UpdateMemoryCardTypes();
   UpdateMultitaps();
@@ -1209,15 +1877,37 @@ bool System::BootSystem(SystemBootParameters parameters)
     DestroySystem();
     return false;
   }
+  else if (gpu_dump_player)
+  {
+    // the CPU doesn't run while playing a dump, the GPU is driven from the file instead
+    s_gpu_dump_player = std::move(gpu_dump_player);
+    if (!s_gpu_dump_player->LoadInitialState())
+    {
+      Host::ReportFormattedErrorAsync("Error", "Failed to load GPU dump '%s'", parameters.filename.c_str());
+      DestroySystem();
+      return false;
+    }
+  }
+
+  // Resume from the state cached at the game's entry point with instant boot, or capture it if there isn't one yet.
+  const bool fast_boot =
+    parameters.override_fast_boot.has_value() ? parameters.override_fast_boot.value() : g_settings.bios_patch_fast_boot;
+  std::string instant_boot_state;
+  if (media && g_settings.bios_instant_boot && parameters.save_state.empty() && !s_running_game_serial.empty() &&
+      !g_settings.IsRunaheadEnabled() && !Achievements::ChallengeModeActive())
+  {
+    std::string path(GetInstantBootStatePath(bios_hash, fast_boot));
+    if (FileSystem::FileExists(path.c_str()))
+      instant_boot_state = std::move(path);
+    else
+      ArmInstantBootCapture(media.get(), std::move(path));
+  }
 
   // Insert CD, and apply fastboot patch if enabled.
   if (media)
     g_cdrom.InsertMedia(std::move(media));
-  if (g_cdrom.HasMedia() && (parameters.override_fast_boot.has_value() ? parameters.override_fast_boot.value() :
-                                                                         g_settings.bios_patch_fast_boot))
-  {
+  if (g_cdrom.HasMedia() && fast_boot)
     BIOS::PatchBIOSFastBoot(Bus::g_bios, Bus::BIOS_SIZE, bios_hash);
-  }
 
   // Good to go.
   s_state =
@@ -1234,6 +1924,9 @@ bool System::BootSystem(SystemBootParameters parameters)
   // try to load the state, if it fails, bail out
   if (!parameters.save_state.empty())
   {
+    // e.g. the resume state, which may have been saved just before the system was shut down
+    FlushSaveStateWrites();
+
     std::unique_ptr<ByteStream> stream =
       ByteStream::OpenFile(parameters.save_state.c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
     if (!stream)
@@ -1252,10 +1945,56 @@ bool System::BootSystem(SystemBootParameters parameters)
       return false;
     }
   }
+  else if (!instant_boot_state.empty())
+  {
+    Log_InfoPrintf("Resuming from instant boot state '%s'", instant_boot_state.c_str());
+    FlushSaveStateWrites();
+    std::unique_ptr<ByteStream> stream =
+      ByteStream::OpenFile(instant_boot_state.c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+    if (!stream || !DoLoadState(stream.get(), false, true))
+    {
+      // the key doesn't cover every setting and the image can change, so a stale state is expected. boot normally
+      // instead, capturing a new state on the way.
+      Log_WarningPrintf("Failed to load instant boot state '%s', booting normally.", instant_boot_state.c_str());
+      stream.reset();
+      FileSystem::DeleteFile(instant_boot_state.c_str());
+
+      // a state which failed part-way through can have dropped the disc, or overwritten the BIOS
+      media = g_cdrom.RemoveMedia(false);
+      if (!media)
+      {
+        Host::ReportErrorAsync(Host::TranslateString("System", "Error"),
+                               Host::TranslateString("System", "Failed to load the instant boot state."));
+        DestroySystem();
+        return false;
+      }
+
+      Bus::SetBIOS(*bios_image, bios_path.empty() ? nullptr : bios_path.c_str());
+      InternalReset();
+      if (g_settings.bios_patch_tty_enable)
+        BIOS::PatchBIOSEnableTTY(Bus::g_bios, Bus::BIOS_SIZE, bios_hash);
+
+      ArmInstantBootCapture(media.get(), std::move(instant_boot_state));
+      g_cdrom.InsertMedia(std::move(media));
+      if (fast_boot)
+        BIOS::PatchBIOSFastBoot(Bus::g_bios, Bus::BIOS_SIZE, bios_hash);
+    }
+  }
 
   if (parameters.load_image_to_ram || g_settings.cdrom_load_image_to_ram)
     g_cdrom.PrecacheMedia();
 
+  CPU::CodeCache::LoadBlockCache(s_running_game_serial);
+
+  if (!parameters.netplay_session.empty() && !Netplay::Start(parameters.netplay_session, &error))
+  {
+    Host::ReportErrorAsync(Host::TranslateString("System", "Error"),
+                           fmt::format(Host::TranslateString("System", "Failed to start netplay: {}").GetCharArray(),
+                                       error.GetMessage().GetCharArray()));
+    DestroySystem();
+    return false;
+  }
+
   ResetPerformanceCounters();
   if (IsRunning())
     UpdateSpeedLimiterState();
@@ -1274,17 +2013,31 @@ bool System::Initialize(bool force_software_renderer)
   s_throttle_frequency = 60.0f;
   s_frame_period = 0;
   s_next_frame_time = 0;
+  s_adaptive_frameskip_behind = false;
+  s_skipping_frame_drawing = false;
+  s_previous_frame_drawing_skipped = false;
+  s_consecutive_frames_drawing_skipped = 0;
   s_turbo_enabled = false;
   s_fast_forward_enabled = false;
 
   s_average_frame_time_accumulator = 0.0f;
   s_worst_frame_time_accumulator = 0.0f;
+  s_worst_frame_work_time_accumulator = 0.0f;
+  s_average_input_latency_accumulator = 0.0f;
+  s_worst_input_latency_accumulator = 0.0f;
+  s_input_latency_samples = 0;
+  s_pre_frame_sleep_time = 0;
+  s_frame_time_histogram.Reset();
+  s_stutter_detection_cooldown = 0;
+  HostTimeAccounting::SetEnabled(g_settings.display_show_subsystem_times || g_settings.display_detect_stutters);
 
   s_vps = 0.0f;
   s_fps = 0.0f;
   s_speed = 0.0f;
   s_worst_frame_time = 0.0f;
   s_average_frame_time = 0.0f;
+  s_average_input_latency = 0.0f;
+  s_worst_input_latency = 0.0f;
   s_cpu_thread_usage = 0.0f;
   s_cpu_thread_time = 0.0f;
   s_sw_thread_usage = 0.0f;
@@ -1292,6 +2045,12 @@ bool System::Initialize(bool force_software_renderer)
   s_average_gpu_time = 0.0f;
   s_accumulated_gpu_time = 0.0f;
   s_gpu_usage = 0.0f;
+  s_average_gpu_section_times.fill(0.0f);
+  s_accumulated_gpu_section_times.fill(0.0f);
+  s_has_gpu_section_times = false;
+  s_average_fence_wait_time = 0.0f;
+  s_accumulated_fence_wait_time = 0.0f;
+  s_fence_wait_samples = 0;
   s_last_frame_number = 0;
   s_last_internal_frame_number = 0;
   s_last_global_tick_counter = 0;
@@ -1397,20 +2156,43 @@ void System::DestroySystem()
 
   s_cpu_thread_usage = {};
 
+  Netplay::Stop();
+  FinishPendingSaveStateScreenshot();
+  StopSaveStateThread();
   ClearMemorySaveStates();
+  DestroyMemoryStateTexturePool();
 
   g_texture_replacements.Shutdown();
+  s_gpu_dump_player.reset();
+
+  if (s_media_capture)
+  {
+    SPU::SetMediaCaptureWriter(nullptr);
+    s_media_capture.reset();
+  }
+
+#ifdef WITH_PROFILER
+  if (IsCapturingProfile())
+  {
+    Profiler::StopCapture(s_profile_capture_filename.c_str());
+    s_profile_capture_filename = {};
+  }
+#endif
+
+  CancelInstantBootCapture();
 
   g_sio.Shutdown();
   g_mdec.Shutdown();
   SPU::Shutdown();
   g_timers.Shutdown();
   g_pad.Shutdown();
+  MemoryCard::StopSaveThread();
   g_cdrom.Shutdown();
-  g_gpu.reset();
+  ParkGPU();
   g_interrupt_controller.Shutdown();
   g_dma.Shutdown();
   PGXP::Shutdown();
+  CPU::CodeCache::SaveBlockCache(s_running_game_serial);
   CPU::CodeCache::Shutdown();
   Bus::Shutdown();
   CPU::Shutdown();
@@ -1434,6 +2216,7 @@ void System::ClearRunningGame()
   s_running_game_path.clear();
   s_running_game_title.clear();
   s_running_bios = false;
+  s_audio_only = false;
   s_cheat_list.reset();
   s_state = State::Shutdown;
 
@@ -1446,39 +2229,105 @@ void System::ClearRunningGame()
 
 void System::Execute()
 {
+  s_last_input_poll_time = Common::Timer::GetCurrentValue();
+
   while (System::IsRunning())
   {
+    const Common::Timer::Value frame_input_time = s_last_input_poll_time;
+
     if (s_display_all_frames)
       System::RunFrame();
     else
       System::RunFrames();
 
+    // a save state's screenshot has had a whole frame to read back by now
+    FinishPendingSaveStateScreenshot();
+
     // this can shut us down
     Host::PumpMessagesOnCPUThread();
     if (!IsValid())
       return;
 
+    s_last_input_poll_time = Common::Timer::GetCurrentValue();
+
     if (s_frame_step_request)
     {
       s_frame_step_request = false;
       PauseSystem(true);
     }
 
-    const bool skip_present = g_host_display->ShouldSkipDisplayingFrame();
-    Host::RenderDisplay(skip_present);
+    // excludes the present, which may block for vsync
+    s_worst_frame_work_time_accumulator =
+      std::max(s_worst_frame_work_time_accumulator, static_cast<float>(s_frame_timer.GetTimeMilliseconds()));
+
+    // audio-only still presents now and again, so the OSD and menus update
+    static constexpr u32 AUDIO_ONLY_PRESENT_INTERVAL = 15;
+    // games draw the frame before the one they display, so a frame after a skipped one may show a stale buffer
+    bool skip_present = g_host_display->ShouldSkipDisplayingFrame() || s_previous_frame_drawing_skipped;
+    if (s_audio_only)
+    {
+      skip_present |= (++s_audio_only_frames_since_present < AUDIO_ONLY_PRESENT_INTERVAL);
+      if (!skip_present)
+        s_audio_only_frames_since_present = 0;
+    }
+
+    {
+      PROFILE_SCOPE("Host::RenderDisplay");
+      Host::RenderDisplay(skip_present);
+    }
+    if (!skip_present)
+    {
+      // time from the input the frame was emulated with being read, to the frame being handed to the display
+      const float latency = static_cast<float>(
+        Common::Timer::ConvertValueToMilliseconds(Common::Timer::GetCurrentValue() - frame_input_time));
+      s_average_input_latency_accumulator += latency;
+      s_worst_input_latency_accumulator = std::max(s_worst_input_latency_accumulator, latency);
+      s_input_latency_samples++;
+
+      s_accumulated_fence_wait_time += g_host_display->GetAndResetAccumulatedFenceWaitTime();
+      s_fence_wait_samples++;
+    }
     if (!skip_present && g_host_display->IsGPUTimingEnabled())
     {
       s_accumulated_gpu_time += g_host_display->GetAndResetAccumulatedGPUTime();
       s_presents_since_last_update++;
+
+      HostDisplay::GPUSectionTimes section_times;
+      s_has_gpu_section_times = g_host_display->GetAndResetAccumulatedGPUSectionTimes(&section_times);
+      if (s_has_gpu_section_times)
+      {
+        for (size_t i = 0; i < section_times.size(); i++)
+          s_accumulated_gpu_section_times[i] += section_times[i];
+      }
     }
 
     System::UpdatePerformanceCounters();
 
-    if (s_throttler_enabled)
+    if (s_audio_paced)
+      ThrottleToAudio();
+    else if (s_throttler_enabled)
       System::Throttle();
+
+    if (s_pre_frame_sleep)
+    {
+      PreFrameSleep();
+      if (!IsValid())
+        return;
+    }
   }
 }
 
+void System::PreFrameSleep()
+{
+  // Start emulating the next frame as late as possible, so that it finishes just before its deadline (or vsync),
+  // and the input it is emulated with is as fresh as possible.
+  if (s_pre_frame_sleep_time > 0)
+    Common::Timer::SleepUntil(Common::Timer::GetCurrentValue() + s_pre_frame_sleep_time, true);
+
+  Host::PumpMessagesOnCPUThread();
+  s_last_input_poll_time = Common::Timer::GetCurrentValue();
+}
+
 void System::RecreateSystem()
 {
   Assert(!IsShutdown());
@@ -1517,6 +2366,29 @@ void System::RecreateSystem()
 
 bool System::CreateGPU(GPURenderer renderer)
 {
+  // any parked renderer is left alone for the next boot, which probably isn't audio-only too
+  if (s_audio_only)
+  {
+    g_gpu = GPU::CreateNullRenderer();
+    return g_gpu->Initialize();
+  }
+
+  if (s_parked_gpu)
+  {
+    if (s_parked_gpu->GetRendererType() == renderer)
+    {
+      g_gpu = std::move(s_parked_gpu);
+      if (g_gpu->AttachToSystem())
+      {
+        Log_InfoPrintf("Reusing %s renderer from the previous session", Settings::GetRendererName(renderer));
+        return true;
+      }
+    }
+
+    g_gpu.reset();
+    ReleaseParkedGPU();
+  }
+
   switch (renderer)
   {
 #ifdef WITH_OPENGL
@@ -1563,16 +2435,53 @@ bool System::CreateGPU(GPURenderer renderer)
   return true;
 }
 
+void System::ParkGPU()
+{
+  // The frontends which keep the display alive after shutdown (i.e. the fullscreen UI) can boot the next game without
+  // recreating the device resources and pipelines. If the display goes away, it releases the parked GPU first.
+  if (!g_gpu || !g_gpu->IsHardwareRenderer() || !g_host_display)
+  {
+    g_gpu.reset();
+    return;
+  }
+
+  g_gpu->DetachFromSystem();
+  s_parked_gpu = std::move(g_gpu);
+}
+
+void System::ReleaseParkedGPU()
+{
+  if (!s_parked_gpu)
+    return;
+
+  // the destructors expect the API state to be restored, same as when the system is running
+  s_parked_gpu->RestoreGraphicsAPIState();
+  s_parked_gpu.reset();
+}
+
+bool System::DoStateSection(StateWrapper& sw, const char* name)
+{
+  if (s_save_state_section_recorder && sw.IsWriting())
+  {
+    SAVE_STATE_SECTION section = {};
+    StringUtil::Strlcpy(section.name, name, sizeof(section.name));
+    section.offset = static_cast<u32>(sw.GetPosition());
+    s_save_state_section_recorder->push_back(section);
+  }
+
+  return sw.DoMarker(name);
+}
+
 bool System::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display, bool is_memory_state)
 {
-  if (!sw.DoMarker("System"))
+  if (!DoStateSection(sw, "System"))
     return false;
 
   sw.Do(&s_region);
   sw.Do(&s_frame_number);
   sw.Do(&s_internal_frame_number);
 
-  if (!sw.DoMarker("CPU") || !CPU::DoState(sw))
+  if (!DoStateSection(sw, "CPU") || !CPU::DoState(sw))
     return false;
 
   if (sw.IsReading())
@@ -1588,43 +2497,43 @@ bool System::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_di
   if (sw.IsReading() && g_settings.gpu_pgxp_enable && !is_memory_state)
     PGXP::Reset();
 
-  if (!sw.DoMarker("Bus") || !Bus::DoState(sw))
+  if (!DoStateSection(sw, "Bus") || !Bus::DoState(sw, is_memory_state))
     return false;
 
-  if (!sw.DoMarker("DMA") || !g_dma.DoState(sw))
+  if (!DoStateSection(sw, "DMA") || !g_dma.DoState(sw))
     return false;
 
-  if (!sw.DoMarker("InterruptController") || !g_interrupt_controller.DoState(sw))
+  if (!DoStateSection(sw, "InterruptController") || !g_interrupt_controller.DoState(sw))
     return false;
 
   g_gpu->RestoreGraphicsAPIState();
-  const bool gpu_result = sw.DoMarker("GPU") && g_gpu->DoState(sw, host_texture, update_display);
+  const bool gpu_result = DoStateSection(sw, "GPU") && g_gpu->DoState(sw, host_texture, update_display);
   g_gpu->ResetGraphicsAPIState();
   if (!gpu_result)
     return false;
 
-  if (!sw.DoMarker("CDROM") || !g_cdrom.DoState(sw))
+  if (!DoStateSection(sw, "CDROM") || !g_cdrom.DoState(sw))
     return false;
 
-  if (!sw.DoMarker("Pad") || !g_pad.DoState(sw))
+  if (!DoStateSection(sw, "Pad") || !g_pad.DoState(sw))
     return false;
 
-  if (!sw.DoMarker("Timers") || !g_timers.DoState(sw))
+  if (!DoStateSection(sw, "Timers") || !g_timers.DoState(sw))
     return false;
 
-  if (!sw.DoMarker("SPU") || !SPU::DoState(sw))
+  if (!DoStateSection(sw, "SPU") || !SPU::DoState(sw))
     return false;
 
-  if (!sw.DoMarker("MDEC") || !g_mdec.DoState(sw))
+  if (!DoStateSection(sw, "MDEC") || !g_mdec.DoState(sw))
     return false;
 
-  if (!sw.DoMarker("SIO") || !g_sio.DoState(sw))
+  if (!DoStateSection(sw, "SIO") || !g_sio.DoState(sw))
     return false;
 
-  if (!sw.DoMarker("Events") || !TimingEvents::DoState(sw))
+  if (!DoStateSection(sw, "Events") || !TimingEvents::DoState(sw))
     return false;
 
-  if (!sw.DoMarker("Overclock"))
+  if (!DoStateSection(sw, "Overclock"))
     return false;
 
   bool cpu_overclock_active = g_settings.cpu_overclock_active;
@@ -1651,7 +2560,7 @@ bool System::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_di
   {
     if (sw.GetVersion() >= 56)
     {
-      if (!sw.DoMarker("Cheevos"))
+      if (!DoStateSection(sw, "Cheevos"))
         return false;
 
 #ifdef WITH_CHEEVOS
@@ -1715,6 +2624,8 @@ std::string System::GetMediaPathFromSaveState(const char* path)
 {
   std::string ret;
 
+  FlushSaveStateWrites();
+
   std::unique_ptr<ByteStream> stream(ByteStream::OpenFile(path, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_SEEKABLE));
   if (stream)
   {
@@ -1786,7 +2697,7 @@ bool System::DoLoadState(ByteStream* state, bool force_software_renderer, bool u
     }
     else
     {
-      media = CDImage::Open(media_filename.c_str(), g_settings.cdrom_load_image_patches, &error);
+      media = OpenCDImage(media_filename.c_str(), &error);
       if (!media)
       {
         if (old_media)
@@ -1833,6 +2744,9 @@ bool System::DoLoadState(ByteStream* state, bool force_software_renderer, bool u
 
   ClearMemorySaveStates();
 
+  // the entry point won't be reached from a state taken in-game, so don't keep using the debug dispatcher
+  CancelInstantBootCapture();
+
   g_cdrom.Reset();
   if (media)
   {
@@ -1876,6 +2790,16 @@ bool System::DoLoadState(ByteStream* state, bool force_software_renderer, bool u
     if (!DoState(sw, nullptr, update_display, false))
       return false;
   }
+  else if (header.data_compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_SECTIONS)
+  {
+    std::unique_ptr<GrowableMemoryByteStream> data(ReadSaveStateSections(state, header));
+    if (!data)
+      return false;
+
+    StateWrapper sw(data.get(), StateWrapper::Mode::Read, header.version);
+    if (!DoState(sw, nullptr, update_display, false))
+      return false;
+  }
   else
   {
     Host::ReportFormattedErrorAsync("Error", "Unknown save state compression type %u", header.data_compression_type);
@@ -1893,16 +2817,22 @@ bool System::DoLoadState(ByteStream* state, bool force_software_renderer, bool u
 bool System::InternalSaveState(ByteStream* state, u32 screenshot_size /* = 256 */,
                                u32 compression_method /* = SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE*/)
 {
-  if (IsShutdown())
+  SaveStateBuffer buffer;
+  if (!SaveStateToBuffer(&buffer, screenshot_size))
     return false;
 
-  SAVE_STATE_HEADER header = {};
+  // in-memory states are never inspected, so keep them in one piece
+  buffer.sections.clear();
+  return WriteSaveStateBuffer(buffer, state, compression_method, 0);
+}
 
-  const u64 header_position = state->GetPosition();
-  if (!state->Write2(&header, sizeof(header)))
+bool System::SaveStateToBuffer(SaveStateBuffer* buffer, u32 screenshot_size, bool defer_screenshot /* = false */)
+{
+  if (IsShutdown())
     return false;
 
-  // fill in header
+  SAVE_STATE_HEADER& header = buffer->header;
+  header = {};
   header.magic = SAVE_STATE_MAGIC;
   header.version = SAVE_STATE_VERSION;
   StringUtil::Strlcpy(header.title, s_running_game_title.c_str(), sizeof(header.title));
@@ -1910,12 +2840,8 @@ bool System::InternalSaveState(ByteStream* state, u32 screenshot_size /* = 256 *
 
   if (g_cdrom.HasMedia())
   {
-    const std::string& media_filename = g_cdrom.GetMediaFileName();
-    header.offset_to_media_filename = static_cast<u32>(state->GetPosition());
-    header.media_filename_length = static_cast<u32>(media_filename.length());
+    buffer->media_filename = g_cdrom.GetMediaFileName();
     header.media_subimage_index = g_cdrom.GetMedia()->HasSubImages() ? g_cdrom.GetMedia()->GetCurrentSubImage() : 0;
-    if (!media_filename.empty() && !state->Write2(media_filename.data(), header.media_filename_length))
-      return false;
   }
 
   // save screenshot
@@ -1929,69 +2855,135 @@ bool System::InternalSaveState(ByteStream* state, u32 screenshot_size /* = 256 *
                                     ((display_aspect_ratio > 0.0f) ? display_aspect_ratio : 1.0f)));
     Log_VerbosePrintf("Saving %ux%u screenshot for state", screenshot_width, screenshot_height);
 
-    std::vector<u32> screenshot_buffer;
-    u32 screenshot_stride;
-    GPUTexture::Format screenshot_format;
-    if (g_host_display->RenderScreenshot(screenshot_width, screenshot_height, &screenshot_buffer, &screenshot_stride,
-                                         &screenshot_format) &&
-        GPUTexture::ConvertTextureDataToRGBA8(screenshot_width, screenshot_height, screenshot_buffer, screenshot_stride,
-                                              screenshot_format))
+    if (g_host_display->BeginScreenshotReadback(screenshot_width, screenshot_height))
     {
-      if (screenshot_stride != (screenshot_width * sizeof(u32)))
-      {
-        Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to incorrect stride(%u)",
-                          screenshot_width, screenshot_height, screenshot_stride);
-      }
-      else
-      {
-        if (g_host_display->UsesLowerLeftOrigin())
-        {
-          GPUTexture::FlipTextureDataRGBA8(screenshot_width, screenshot_height, screenshot_buffer, screenshot_stride);
-        }
-
-        header.offset_to_screenshot = static_cast<u32>(state->GetPosition());
-        header.screenshot_width = screenshot_width;
-        header.screenshot_height = screenshot_height;
-        header.screenshot_size = static_cast<u32>(screenshot_buffer.size() * sizeof(u32));
-        if (!state->Write2(screenshot_buffer.data(), header.screenshot_size))
-          return false;
-      }
+      header.screenshot_width = screenshot_width;
+      header.screenshot_height = screenshot_height;
+      buffer->screenshot_pending = true;
+      if (!defer_screenshot)
+        FinishSaveStateScreenshot(buffer);
     }
     else
     {
-      Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to render/conversion failure",
-                        screenshot_width, screenshot_height);
+      Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to render failure", screenshot_width,
+                        screenshot_height);
     }
   }
 
-  // write data
+  // serialize uncompressed, compression is left to the writer
+  if (!buffer->state_stream)
+    buffer->state_stream = std::make_unique<GrowableMemoryByteStream>(nullptr, MAX_SAVE_STATE_SIZE);
+
+  g_gpu->RestoreGraphicsAPIState();
+
+  buffer->sections.clear();
+  s_save_state_section_recorder = &buffer->sections;
+
+  StateWrapper sw(buffer->state_stream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+  const bool result = DoState(sw, nullptr, false, false);
+  s_save_state_section_recorder = nullptr;
+
+  g_gpu->ResetGraphicsAPIState();
+
+  return result;
+}
+
+void System::FinishSaveStateScreenshot(SaveStateBuffer* buffer)
+{
+  if (!buffer->screenshot_pending)
+    return;
+
+  buffer->screenshot_pending = false;
+
+  SAVE_STATE_HEADER& header = buffer->header;
+  const u32 screenshot_width = header.screenshot_width;
+  const u32 screenshot_height = header.screenshot_height;
+  header.screenshot_width = 0;
+  header.screenshot_height = 0;
+
+  std::vector<u32> screenshot_buffer;
+  u32 screenshot_stride;
+  GPUTexture::Format screenshot_format;
+  if (!g_host_display->FinishScreenshotReadback(&screenshot_buffer, &screenshot_stride, &screenshot_format) ||
+      !GPUTexture::ConvertTextureDataToRGBA8(screenshot_width, screenshot_height, screenshot_buffer, screenshot_stride,
+                                             screenshot_format))
   {
-    header.offset_to_data = static_cast<u32>(state->GetPosition());
+    Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to readback/conversion failure",
+                      screenshot_width, screenshot_height);
+    return;
+  }
 
-    g_gpu->RestoreGraphicsAPIState();
+  if (screenshot_stride != (screenshot_width * sizeof(u32)))
+  {
+    Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to incorrect stride(%u)", screenshot_width,
+                      screenshot_height, screenshot_stride);
+    return;
+  }
+
+  header.screenshot_width = screenshot_width;
+  header.screenshot_height = screenshot_height;
+  buffer->screenshot = std::move(screenshot_buffer);
+}
+
+bool System::WriteSaveStateBuffer(const SaveStateBuffer& buffer, ByteStream* state, u32 compression_method,
+                                  u32 num_compression_workers)
+{
+  SAVE_STATE_HEADER header = buffer.header;
+
+  const u64 header_position = state->GetPosition();
+  if (!state->Write2(&header, sizeof(header)))
+    return false;
+
+  if (!buffer.media_filename.empty())
+  {
+    header.offset_to_media_filename = static_cast<u32>(state->GetPosition());
+    header.media_filename_length = static_cast<u32>(buffer.media_filename.length());
+    if (!state->Write2(buffer.media_filename.data(), header.media_filename_length))
+      return false;
+  }
+
+  if (!buffer.screenshot.empty())
+  {
+    header.offset_to_screenshot = static_cast<u32>(state->GetPosition());
+    header.screenshot_size = static_cast<u32>(buffer.screenshot.size() * sizeof(u32));
+    if (!state->Write2(buffer.screenshot.data(), header.screenshot_size))
+      return false;
+  }
+
+  // write data
+  {
+    const u8* data = buffer.state_stream->GetMemoryPointer();
+    const u32 data_size = static_cast<u32>(buffer.state_stream->GetSize());
 
+    header.offset_to_data = static_cast<u32>(state->GetPosition());
     header.data_compression_type = compression_method;
+    header.data_uncompressed_size = data_size;
+
+    if (!buffer.sections.empty())
+    {
+      header.data_compression_type = SAVE_STATE_HEADER::COMPRESSION_TYPE_SECTIONS;
+      if (!WriteSaveStateSections(buffer, state, compression_method, num_compression_workers))
+        return false;
 
-    bool result = false;
-    if (compression_method == SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE)
+      header.data_compressed_size = static_cast<u32>(state->GetPosition() - header.offset_to_data);
+    }
+    else if (compression_method == SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE)
     {
-      StateWrapper sw(state, StateWrapper::Mode::Write, SAVE_STATE_VERSION);
-      result = DoState(sw, nullptr, false, false);
-      header.data_uncompressed_size = static_cast<u32>(state->GetPosition() - header.offset_to_data);
+      if (!state->Write2(data, data_size))
+        return false;
     }
     else if (compression_method == SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD)
     {
-      std::unique_ptr<ByteStream> cstream(ByteStream::CreateZstdCompressStream(state, 0));
-      StateWrapper sw(cstream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
-      result = DoState(sw, nullptr, false, false) && cstream->Commit();
-      header.data_uncompressed_size = static_cast<u32>(cstream->GetPosition());
+      std::unique_ptr<ByteStream> cstream(ByteStream::CreateZstdCompressStream(state, 0, num_compression_workers));
+      if (!cstream->Write2(data, data_size) || !cstream->Commit())
+        return false;
+
       header.data_compressed_size = static_cast<u32>(state->GetPosition() - header.offset_to_data);
     }
-
-    g_gpu->ResetGraphicsAPIState();
-
-    if (!result)
+    else
+    {
       return false;
+    }
   }
 
   // re-write header
@@ -2005,79 +2997,261 @@ bool System::InternalSaveState(ByteStream* state, u32 screenshot_size /* = 256 *
   return true;
 }
 
-void System::SingleStepCPU()
+bool System::WriteSaveStateSections(const SaveStateBuffer& buffer, ByteStream* state, u32 compression_method,
+                                    u32 num_compression_workers)
 {
-  const u32 old_frame_number = s_frame_number;
+  const u8* data = buffer.state_stream->GetMemoryPointer();
+  const u32 data_size = static_cast<u32>(buffer.state_stream->GetSize());
+  std::vector<SAVE_STATE_SECTION> sections(buffer.sections);
+  const u32 num_sections = static_cast<u32>(sections.size());
+  if (sections.front().offset != 0 || num_sections > MAX_SAVE_STATE_SECTIONS)
+    return false;
 
-  s_frame_timer.Reset();
+  // table is written twice, once to reserve space, then again with the offsets filled in
+  const u64 table_position = state->GetPosition() + sizeof(num_sections);
+  if (!state->Write2(&num_sections, sizeof(num_sections)) ||
+      !state->Write2(sections.data(), sizeof(SAVE_STATE_SECTION) * num_sections))
+  {
+    return false;
+  }
 
-  g_gpu->RestoreGraphicsAPIState();
+  // sections too small to be worth splitting share one context, rather than each allocating a stream sized for the
+  // default window. knowing the size up front also lets zstd shrink its tables for the small ones.
+  ZSTD_CCtx* cctx = nullptr;
+  std::vector<u8> compress_buffer;
+  ScopedGuard cctx_guard([&cctx]() {
+    if (cctx)
+      ZSTD_freeCCtx(cctx);
+  });
 
-  CPU::SingleStep();
+  for (u32 i = 0; i < num_sections; i++)
+  {
+    SAVE_STATE_SECTION& section = sections[i];
+    const u32 start = section.offset;
+    const u32 end = (i < (num_sections - 1)) ? sections[i + 1].offset : data_size;
+    section.compression_type = compression_method;
+    section.offset = static_cast<u32>(state->GetPosition());
+    section.uncompressed_size = end - start;
 
-  SPU::GeneratePendingSamples();
+    if (compression_method == SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD)
+    {
+      if (num_compression_workers > 0 && section.uncompressed_size >= MULTITHREADED_SECTION_COMPRESSION_SIZE)
+      {
+        std::unique_ptr<ByteStream> cstream(
+          ByteStream::CreateZstdCompressStream(state, 0, num_compression_workers));
+        if (!cstream->Write2(data + start, section.uncompressed_size) || !cstream->Commit())
+          return false;
+      }
+      else
+      {
+        if (!cctx && !(cctx = ZSTD_createCCtx()))
+          return false;
 
-  if (s_frame_number != old_frame_number && s_cheat_list)
-    s_cheat_list->Apply();
+        const size_t compress_bound = ZSTD_compressBound(section.uncompressed_size);
+        if (compress_buffer.size() < compress_bound)
+          compress_buffer.resize(compress_bound);
 
-  g_gpu->ResetGraphicsAPIState();
-}
+        const size_t compressed_size = ZSTD_compress2(cctx, compress_buffer.data(), compress_buffer.size(),
+                                                      data + start, section.uncompressed_size);
+        if (ZSTD_isError(compressed_size))
+        {
+          Log_ErrorPrintf("Failed to compress save state section: %s", ZSTD_getErrorName(compressed_size));
+          return false;
+        }
 
-void System::DoRunFrame()
-{
-  g_gpu->RestoreGraphicsAPIState();
+        if (!state->Write2(compress_buffer.data(), static_cast<u32>(compressed_size)))
+          return false;
+      }
 
-  if (CPU::g_state.use_debug_dispatcher)
-  {
-    CPU::ExecuteDebug();
-  }
-  else
-  {
-    switch (g_settings.cpu_execution_mode)
+      section.compressed_size = static_cast<u32>(state->GetPosition() - section.offset);
+    }
+    else if (compression_method == SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE)
     {
-      case CPUExecutionMode::Recompiler:
-#ifdef WITH_RECOMPILER
-        CPU::CodeCache::ExecuteRecompiler();
-#else
-        CPU::CodeCache::Execute();
-#endif
-        break;
-
-      case CPUExecutionMode::CachedInterpreter:
-        CPU::CodeCache::Execute();
-        break;
+      if (!state->Write2(data + start, section.uncompressed_size))
+        return false;
 
-      case CPUExecutionMode::Interpreter:
-      default:
-        CPU::Execute();
-        break;
+      section.compressed_size = section.uncompressed_size;
+    }
+    else
+    {
+      return false;
     }
   }
 
-  // Generate any pending samples from the SPU before sleeping, this way we reduce the chances of underruns.
-  SPU::GeneratePendingSamples();
-
-  if (s_cheat_list)
-    s_cheat_list->Apply();
-
-  g_gpu->ResetGraphicsAPIState();
+  const u64 end_position = state->GetPosition();
+  return (state->SeekAbsolute(table_position) &&
+          state->Write2(sections.data(), sizeof(SAVE_STATE_SECTION) * num_sections) &&
+          state->SeekAbsolute(end_position));
 }
 
-void System::RunFrame()
+std::optional<std::vector<SAVE_STATE_SECTION>> System::ReadSaveStateSectionTable(ByteStream* state,
+                                                                                const SAVE_STATE_HEADER& header)
 {
+  u32 num_sections;
+  if (!state->SeekAbsolute(header.offset_to_data) || !state->Read2(&num_sections, sizeof(num_sections)) ||
+      num_sections == 0 || num_sections > MAX_SAVE_STATE_SECTIONS)
+  {
+    return std::nullopt;
+  }
+
+  std::vector<SAVE_STATE_SECTION> sections(num_sections);
+  if (!state->Read2(sections.data(), sizeof(SAVE_STATE_SECTION) * num_sections))
+    return std::nullopt;
+
+  for (SAVE_STATE_SECTION& section : sections)
+    section.name[SAVE_STATE_SECTION::MAX_NAME_LENGTH - 1] = '\0';
+
+  return sections;
+}
+
+bool System::ReadSaveStateSectionData(ByteStream* state, const SAVE_STATE_SECTION& section, u8* data)
+{
+  if (!state->SeekAbsolute(section.offset))
+    return false;
+
+  if (section.compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE)
+    return state->Read2(data, section.uncompressed_size);
+
+  if (section.compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD)
+  {
+    std::unique_ptr<ByteStream> dstream(ByteStream::CreateZstdDecompressStream(state, section.compressed_size));
+    return dstream->Read2(data, section.uncompressed_size);
+  }
+
+  Log_ErrorPrintf("Unknown compression type %u for save state section '%s'", section.compression_type, section.name);
+  return false;
+}
+
+std::unique_ptr<GrowableMemoryByteStream> System::ReadSaveStateSections(ByteStream* state,
+                                                                        const SAVE_STATE_HEADER& header)
+{
+  std::optional<std::vector<SAVE_STATE_SECTION>> sections(ReadSaveStateSectionTable(state, header));
+  if (!sections.has_value() || header.data_uncompressed_size > MAX_SAVE_STATE_SIZE)
+    return {};
+
+  std::unique_ptr<GrowableMemoryByteStream> data =
+    std::make_unique<GrowableMemoryByteStream>(nullptr, header.data_uncompressed_size);
+  for (const SAVE_STATE_SECTION& section : sections.value())
+  {
+    const u32 position = static_cast<u32>(data->GetSize());
+    if (section.uncompressed_size > (header.data_uncompressed_size - position))
+      return {};
+
+    data->Resize(position + section.uncompressed_size);
+    if (!ReadSaveStateSectionData(state, section, data->GetMemoryPointer() + position))
+    {
+      Log_ErrorPrintf("Failed to read save state section '%s'", section.name);
+      return {};
+    }
+  }
+
+  data->SeekAbsolute(0);
+  return data;
+}
+
+void System::SingleStepCPU()
+{
+  const u32 old_frame_number = s_frame_number;
+
+  s_frame_timer.Reset();
+
+  g_gpu->RestoreGraphicsAPIState();
+
+  CPU::SingleStep();
+
+  SPU::GeneratePendingSamples();
+
+  if (s_frame_number != old_frame_number && s_cheat_list)
+    s_cheat_list->Apply();
+
+  g_gpu->ResetGraphicsAPIState();
+}
+
+void System::DoRunFrame()
+{
+  g_gpu->RestoreGraphicsAPIState();
+
+  if (s_gpu_dump_player)
+  {
+    s_gpu_dump_player->ProcessFrame();
+  }
+  else if (CPU::g_state.use_debug_dispatcher)
+  {
+    HostTimeAccounting::ScopedSection section(HostTimeAccounting::Section::Interpreter);
+    CPU::ExecuteDebug();
+  }
+  else
+  {
+    PROFILE_SCOPE("CPU::Execute");
+    HostTimeAccounting::ScopedSection section(g_settings.IsUsingRecompiler() ?
+                                                HostTimeAccounting::Section::RecompiledCode :
+                                                HostTimeAccounting::Section::Interpreter);
+    switch (g_settings.cpu_execution_mode)
+    {
+      case CPUExecutionMode::Recompiler:
+#ifdef WITH_RECOMPILER
+        CPU::CodeCache::ExecuteRecompiler();
+#else
+        CPU::CodeCache::Execute();
+#endif
+        break;
+
+      case CPUExecutionMode::CachedInterpreter:
+        CPU::CodeCache::Execute();
+        break;
+
+      case CPUExecutionMode::Interpreter:
+      default:
+        CPU::Execute();
+        break;
+    }
+  }
+
+  // Generate any pending samples from the SPU before sleeping, this way we reduce the chances of underruns.
+  SPU::GeneratePendingSamples();
+
+  if (s_cheat_list)
+    s_cheat_list->Apply();
+
+  g_gpu->ResetGraphicsAPIState();
+}
+
+void System::RunFrame()
+{
+  PROFILE_SCOPE("System::RunFrame");
   s_frame_timer.Reset();
 
+  if (Netplay::IsActive())
+  {
+    Netplay::RunFrame();
+    s_next_frame_time += s_frame_period;
+    return;
+  }
+
   if (s_rewind_load_counter >= 0)
   {
     DoRewind();
     return;
   }
 
+  // never skip more than a couple of frames in a row, something has to get presented
+  static constexpr u32 MAX_CONSECUTIVE_FRAMES_DRAWING_SKIPPED = 2;
+  s_previous_frame_drawing_skipped = s_skipping_frame_drawing;
+  s_skipping_frame_drawing = s_adaptive_frameskip && s_adaptive_frameskip_behind && !s_media_capture &&
+                             s_consecutive_frames_drawing_skipped < MAX_CONSECUTIVE_FRAMES_DRAWING_SKIPPED;
+  s_consecutive_frames_drawing_skipped = s_skipping_frame_drawing ? (s_consecutive_frames_drawing_skipped + 1) : 0;
+
   if (s_runahead_frames > 0)
     DoRunahead();
 
   DoRunFrame();
 
+  if (s_instant_boot_capture_pending)
+    SaveInstantBootState();
+
+  if (s_media_capture)
+    CaptureMediaFrame();
+
   s_next_frame_time += s_frame_period;
 
   if (s_memory_saves_enabled)
@@ -2114,10 +3288,13 @@ void System::UpdateThrottlePeriod()
 void System::ResetThrottler()
 {
   s_next_frame_time = Common::Timer::GetCurrentValue();
+  s_adaptive_frameskip_behind = false;
 }
 
 void System::Throttle()
 {
+  PROFILE_SCOPE("System::Throttle");
+
   // If we're running too slow, advance the next frame time based on the time we lost. Effectively skips
   // running those frames at the intended time, because otherwise if we pause in the debugger, we'll run
   // hundreds of frames when we resume.
@@ -2126,12 +3303,37 @@ void System::Throttle()
   {
     const Common::Timer::Value diff = static_cast<s64>(current_time) - static_cast<s64>(s_next_frame_time);
     s_next_frame_time += (diff / s_frame_period) * s_frame_period;
+
+    // ignore the odd late wakeup, only skip drawing when we're really falling behind
+    s_adaptive_frameskip_behind = (diff > (s_frame_period / 4));
     return;
   }
 
+  s_adaptive_frameskip_behind = false;
   Common::Timer::SleepUntil(s_next_frame_time, true);
 }
 
+void System::ThrottleToAudio()
+{
+  PROFILE_SCOPE("System::ThrottleToAudio");
+
+  // Emulate whenever the output stream drops below its target, then sleep until half of that has played. The host
+  // wakes a few times per buffer instead of every frame, and no time stretching is needed to keep the buffer level.
+  const AudioStream* stream = SPU::GetOutputStream();
+  const u32 buffered = stream->GetBufferedFramesRelaxed();
+  const u32 target = stream->GetTargetBufferSize();
+  if (buffered < target)
+    return;
+
+  // bounded, in case the stream stops draining, e.g. the device went away
+  static constexpr u64 MAX_SLEEP_NS = 100000000;
+  const u64 sleep_ns = std::min<u64>((static_cast<u64>(buffered - target / 2) * 1000000000) / stream->GetSampleRate(),
+                                     MAX_SLEEP_NS);
+  Common::Timer::SleepUntil(Common::Timer::GetCurrentValue() + Common::Timer::ConvertNanosecondsToValue(
+                                                                 static_cast<double>(sleep_ns)),
+                            false);
+}
+
 void System::RunFrames()
 {
   // If we're running more than this in a single loop... we're in for a bad time.
@@ -2159,6 +3361,9 @@ void System::UpdatePerformanceCounters()
   const float frame_time = static_cast<float>(s_frame_timer.GetTimeMilliseconds());
   s_average_frame_time_accumulator += frame_time;
   s_worst_frame_time_accumulator = std::max(s_worst_frame_time_accumulator, frame_time);
+  HostTimeAccounting::EndFrame(frame_time);
+  if (g_settings.display_detect_stutters)
+    CheckForStutter(frame_time);
 
   // update fps counter
   const Common::Timer::Value now_ticks = Common::Timer::GetCurrentValue();
@@ -2181,6 +3386,21 @@ void System::UpdatePerformanceCounters()
   s_worst_frame_time_accumulator = 0.0f;
   s_average_frame_time = s_average_frame_time_accumulator / frames_run;
   s_average_frame_time_accumulator = 0.0f;
+  s_worst_input_latency = s_worst_input_latency_accumulator;
+  s_worst_input_latency_accumulator = 0.0f;
+  s_average_input_latency =
+    s_average_input_latency_accumulator / static_cast<float>(std::max(s_input_latency_samples, 1u));
+  s_average_input_latency_accumulator = 0.0f;
+  s_input_latency_samples = 0;
+
+  // budget the sleep on the worst frame in the last interval, plus a safety margin for the present
+  if (s_pre_frame_sleep)
+  {
+    const float sleep_time = static_cast<float>(Common::Timer::ConvertValueToMilliseconds(s_frame_period)) -
+                             s_worst_frame_work_time_accumulator - g_settings.display_pre_frame_sleep_buffer;
+    s_pre_frame_sleep_time = Common::Timer::ConvertMillisecondsToValue(std::max(sleep_time, 0.0f));
+  }
+  s_worst_frame_work_time_accumulator = 0.0f;
   s_vps = static_cast<float>(frames_run / time);
   s_last_frame_number = s_frame_number;
   s_fps = static_cast<float>(s_internal_frame_number - s_last_internal_frame_number) / time;
@@ -2205,20 +3425,71 @@ void System::UpdatePerformanceCounters()
 
   s_fps_timer.ResetTo(now_ticks);
 
+  HostTimeAccounting::UpdateAverages(ticks_diff, static_cast<u32>(frames_run));
+
   if (g_host_display->IsGPUTimingEnabled())
   {
     s_average_gpu_time = s_accumulated_gpu_time / static_cast<float>(std::max(s_presents_since_last_update, 1u));
     s_gpu_usage = s_accumulated_gpu_time / (time * 10.0f);
+    for (size_t i = 0; i < s_average_gpu_section_times.size(); i++)
+    {
+      s_average_gpu_section_times[i] =
+        s_accumulated_gpu_section_times[i] / static_cast<float>(std::max(s_presents_since_last_update, 1u));
+    }
+  }
+
+  // only at normal speed, the budget would be too small when fast forwarding
+  if (g_settings.gpu_dynamic_resolution && g_host_display->IsGPUTimingEnabled() && s_presents_since_last_update > 0 &&
+      s_target_speed == 1.0f &&
+      g_gpu->UpdateDynamicResolution(s_average_gpu_time, 1000.0f / static_cast<float>(s_throttle_frequency)))
+  {
+    // the VRAM texture changed size, so the memory states can't be restored anymore
+    ClearMemorySaveStates();
+    DestroyMemoryStateTexturePool();
   }
+
   s_accumulated_gpu_time = 0.0f;
+  s_accumulated_gpu_section_times.fill(0.0f);
   s_presents_since_last_update = 0;
 
+  s_average_fence_wait_time = s_accumulated_fence_wait_time / static_cast<float>(std::max(s_fence_wait_samples, 1u));
+  s_accumulated_fence_wait_time = 0.0f;
+  s_fence_wait_samples = 0;
+
   Log_VerbosePrintf("FPS: %.2f VPS: %.2f CPU: %.2f GPU: %.2f Average: %.2fms Worst: %.2fms", s_fps, s_vps,
                     s_cpu_thread_usage, s_gpu_usage, s_average_frame_time, s_worst_frame_time);
 
+  s_performance_counters_update_count++;
   Host::OnPerformanceCountersUpdated();
 }
 
+void System::CheckForStutter(float frame_time)
+{
+  // compared against the median before this frame, so a run of slow frames doesn't hide itself
+  const float median = s_frame_time_histogram.GetMedian();
+  s_frame_time_histogram.AddFrame(frame_time);
+  if (s_frame_time_histogram.GetSampleCount() < MIN_STUTTER_DETECTION_FRAMES)
+    return;
+
+  if (s_stutter_detection_cooldown > 0)
+  {
+    s_stutter_detection_cooldown--;
+    return;
+  }
+
+  const bool over_threshold =
+    (g_settings.display_stutter_threshold > 0.0f && frame_time >= g_settings.display_stutter_threshold);
+  const bool over_median = (g_settings.display_stutter_median_multiplier > 0.0f &&
+                            frame_time >= (median * g_settings.display_stutter_median_multiplier));
+  if (!over_threshold && !over_median)
+    return;
+
+  Log_WarningPrintf("Stutter in frame %u: %.2f ms (median %.2f ms, 99th percentile %.2f ms)", s_frame_number,
+                    frame_time, median, s_frame_time_histogram.GetPercentile(0.99f));
+  HostTimeAccounting::DumpRecentFrames();
+  s_stutter_detection_cooldown = STUTTER_DETECTION_COOLDOWN_FRAMES;
+}
+
 void System::ResetPerformanceCounters()
 {
   s_last_frame_number = s_frame_number;
@@ -2232,7 +3503,14 @@ void System::ResetPerformanceCounters()
 
   s_average_frame_time_accumulator = 0.0f;
   s_worst_frame_time_accumulator = 0.0f;
+  s_worst_frame_work_time_accumulator = 0.0f;
+  s_average_input_latency_accumulator = 0.0f;
+  s_worst_input_latency_accumulator = 0.0f;
+  s_input_latency_samples = 0;
   s_fps_timer.Reset();
+  s_frame_time_histogram.Reset();
+  s_stutter_detection_cooldown = 0;
+  HostTimeAccounting::Reset();
   ResetThrottler();
 }
 
@@ -2242,9 +3520,19 @@ void System::UpdateSpeedLimiterState()
   s_target_speed = s_turbo_enabled ?
                      g_settings.turbo_speed :
                      (s_fast_forward_enabled ? g_settings.fast_forward_speed : g_settings.emulation_speed);
+
+  // dumps are for benchmarking, so always run them unthrottled
+  if (s_gpu_dump_player)
+    s_target_speed = 0.0f;
+
   s_throttler_enabled = (s_target_speed != 0.0f);
   s_display_all_frames = !s_throttler_enabled || g_settings.display_all_frames;
 
+  // the sleep is recomputed from frame times once they're available
+  s_pre_frame_sleep = s_throttler_enabled && s_display_all_frames && g_settings.display_pre_frame_sleep;
+  s_pre_frame_sleep_time = 0;
+  s_adaptive_frameskip = s_throttler_enabled && g_settings.display_adaptive_frameskip;
+
   s_syncing_to_host = false;
   if (g_settings.sync_to_host_refresh_rate && (g_settings.audio_stretch_mode != AudioStretchMode::Off) &&
       s_target_speed == 1.0f && IsValid())
@@ -2268,6 +3556,18 @@ void System::UpdateSpeedLimiterState()
     s_throttler_enabled = false;
   }
 
+  // Audio-only playback at normal speed is paced by the output stream. There's nothing to hear with the null backend,
+  // so that keeps using the frame timer.
+  s_audio_paced = (s_audio_only && s_target_speed == 1.0f && g_settings.audio_backend != AudioBackend::Null);
+  if (s_audio_paced)
+  {
+    Log_InfoPrintf("Using audio output for throttling.");
+    s_throttler_enabled = false;
+    s_display_all_frames = true;
+    s_pre_frame_sleep = false;
+    s_syncing_to_host = false;
+  }
+
   Log_VerbosePrintf("Target speed: %f%%", s_target_speed * 100.0f);
 
   if (IsValid())
@@ -2275,10 +3575,12 @@ void System::UpdateSpeedLimiterState()
     // Update audio output.
     AudioStream* stream = SPU::GetOutputStream();
     stream->SetOutputVolume(GetAudioOutputVolume());
+    stream->SetStretchMode(s_audio_paced ? AudioStretchMode::Off : g_settings.audio_stretch_mode);
 
     // Adjust nominal rate when resampling, or syncing to host.
-    const bool rate_adjust =
-      (s_syncing_to_host || g_settings.audio_stretch_mode == AudioStretchMode::Resample) && s_target_speed > 0.0f;
+    const bool rate_adjust = (s_syncing_to_host || g_settings.audio_stretch_mode == AudioStretchMode::Resample ||
+                              g_settings.audio_stretch_mode == AudioStretchMode::DynamicRateControl) &&
+                             s_target_speed > 0.0f && !s_audio_paced;
     stream->SetNominalRate(rate_adjust ? s_target_speed : 1.0f);
 
     if (old_target_speed < s_target_speed)
@@ -2312,7 +3614,8 @@ void System::UpdateDisplaySync()
 
 bool System::ShouldUseVSync()
 {
-  return g_settings.video_sync_enabled && !IsRunningAtNonStandardSpeed();
+  // presents mustn't block when pacing from the audio output
+  return g_settings.video_sync_enabled && !IsRunningAtNonStandardSpeed() && !s_audio_paced;
 }
 
 bool System::IsFastForwardEnabled()
@@ -2577,6 +3880,10 @@ void System::StallCPU(TickCount ticks)
 
 Controller* System::GetController(u32 slot)
 {
+  // bindings drive netplay's copy of the first controller, the emulated ones get their input from the session
+  if (Netplay::IsActive())
+    return (slot == 0) ? Netplay::GetLocalController() : nullptr;
+
   return g_pad.GetController(slot);
 }
 
@@ -2844,10 +4151,22 @@ std::string System::GetMediaFileName()
   return g_cdrom.GetMediaFileName();
 }
 
+std::unique_ptr<CDImage> System::OpenCDImage(const char* path, Common::Error* error)
+{
+  std::unique_ptr<CDImage> image = CDImage::Open(path, g_settings.cdrom_load_image_patches, error);
+  if (image && g_settings.cdrom_sector_cache)
+  {
+    image = CDImage::OverlaySectorCache(std::move(image), Path::Combine(EmuFolders::Cache, "sectorcache").c_str(),
+                                        static_cast<u64>(g_settings.cdrom_sector_cache_size) * 1048576u);
+  }
+
+  return image;
+}
+
 bool System::InsertMedia(const char* path)
 {
   Common::Error error;
-  std::unique_ptr<CDImage> image = CDImage::Open(path, g_settings.cdrom_load_image_patches, &error);
+  std::unique_ptr<CDImage> image = OpenCDImage(path, &error);
   if (!image)
   {
     Host::AddFormattedOSDMessage(10.0f, Host::TranslateString("OSDMessage", "Failed to open disc image '%s': %s."),
@@ -2894,7 +4213,7 @@ void System::UpdateRunningGame(const char* path, CDImage* image, bool booting)
   {
     s_running_game_path = path;
 
-    if (IsExeFileName(path) || IsPsfFileName(path))
+    if (IsExeFileName(path) || IsPsfFileName(path) || IsGPUDumpFileName(path))
     {
       // TODO: We could pull the title from the PSF.
       s_running_game_title = Path::GetFileTitle(path);
@@ -3075,13 +4394,15 @@ void System::SetCheatList(std::unique_ptr<CheatList> cheats)
 
 void System::CheckForSettingsChanges(const Settings& old_settings)
 {
-  if (IsValid() && (g_settings.gpu_renderer != old_settings.gpu_renderer ||
-                    g_settings.gpu_use_debug_device != old_settings.gpu_use_debug_device ||
-                    g_settings.gpu_threaded_presentation != old_settings.gpu_threaded_presentation))
+  const u32 changed = g_settings.GetChangedSubsystems(old_settings);
+
+  if (IsValid() && ((changed & (Settings::CHANGED_GPU_RENDERER | Settings::CHANGED_HOST_DISPLAY)) ||
+                    (Settings::GetRenderAPIForRenderer(g_settings.gpu_renderer) == RenderAPI::Vulkan &&
+                     (changed & Settings::CHANGED_GPU_FRAMES_IN_FLIGHT))))
   {
-    // if debug device/threaded presentation change, we need to recreate the whole display
-    const bool recreate_display = (g_settings.gpu_use_debug_device != old_settings.gpu_use_debug_device ||
-                                   g_settings.gpu_threaded_presentation != old_settings.gpu_threaded_presentation);
+    // if debug device/threaded presentation/frames in flight change, we need to recreate the whole display
+    const bool recreate_display =
+      (changed & (Settings::CHANGED_HOST_DISPLAY | Settings::CHANGED_GPU_FRAMES_IN_FLIGHT)) != 0;
 
     Host::AddFormattedOSDMessage(5.0f, Host::TranslateString("OSDMessage", "Switching to %s%s GPU renderer."),
                                  Settings::GetRendererName(g_settings.gpu_renderer),
@@ -3089,19 +4410,22 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
     RecreateGPU(g_settings.gpu_renderer, recreate_display);
   }
 
-  if (IsValid())
+  // settings which aren't tracked can't affect the emulated system, so the rewind/runahead states are still good
+  if (IsValid() && changed != 0)
   {
     ClearMemorySaveStates();
 
-    if (g_settings.cpu_overclock_active != old_settings.cpu_overclock_active ||
-        (g_settings.cpu_overclock_active &&
-         (g_settings.cpu_overclock_numerator != old_settings.cpu_overclock_numerator ||
-          g_settings.cpu_overclock_denominator != old_settings.cpu_overclock_denominator)))
+    // the VRAM texture size is changing, so none of the pooled textures can be used
+    if (changed & Settings::CHANGED_MEMORY_STATE_TEXTURES)
+      DestroyMemoryStateTexturePool();
+
+    if ((changed & Settings::CHANGED_CPU_OVERCLOCK) &&
+        (g_settings.cpu_overclock_active || old_settings.cpu_overclock_active))
     {
       UpdateOverclock();
     }
 
-    if (g_settings.audio_backend != old_settings.audio_backend || g_settings.audio_driver != old_settings.audio_driver)
+    if (changed & Settings::CHANGED_AUDIO_STREAM)
     {
       if (g_settings.audio_backend != old_settings.audio_backend)
       {
@@ -3111,21 +4435,11 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
 
       SPU::RecreateOutputStream();
     }
-    if (g_settings.audio_stretch_mode != old_settings.audio_stretch_mode)
-      SPU::GetOutputStream()->SetStretchMode(g_settings.audio_stretch_mode);
-    if (g_settings.audio_buffer_ms != old_settings.audio_buffer_ms ||
-        g_settings.audio_output_latency_ms != old_settings.audio_output_latency_ms ||
-        g_settings.audio_stretch_mode != old_settings.audio_stretch_mode)
-    {
-      SPU::RecreateOutputStream();
-      UpdateSpeedLimiterState();
-    }
 
-    if (g_settings.emulation_speed != old_settings.emulation_speed)
+    if (changed & Settings::CHANGED_THROTTLE)
       UpdateThrottlePeriod();
 
-    if (g_settings.cpu_execution_mode != old_settings.cpu_execution_mode ||
-        g_settings.cpu_fastmem_mode != old_settings.cpu_fastmem_mode)
+    if (changed & Settings::CHANGED_CPU_EXECUTION_MODE)
     {
       Host::AddFormattedOSDMessage(5.0f, Host::TranslateString("OSDMessage", "Switching to %s CPU execution mode."),
                                    Host::TranslateString("CPUExecutionMode", Settings::GetCPUExecutionModeDisplayName(
@@ -3136,69 +4450,35 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
     }
 
     if (g_settings.cpu_execution_mode == CPUExecutionMode::Recompiler &&
-        (g_settings.cpu_recompiler_memory_exceptions != old_settings.cpu_recompiler_memory_exceptions ||
-         g_settings.cpu_recompiler_block_linking != old_settings.cpu_recompiler_block_linking ||
-         g_settings.cpu_recompiler_icache != old_settings.cpu_recompiler_icache))
+        (changed & (Settings::CHANGED_RECOMPILER_CODE_BUFFER | Settings::CHANGED_RECOMPILER_BLOCKS |
+                    Settings::CHANGED_RECOMPILER_ICACHE)))
     {
       Host::AddOSDMessage(Host::TranslateStdString("OSDMessage", "Recompiler options changed, flushing all blocks."),
                           5.0f);
 
-      // changing memory exceptions can re-enable fastmem
-      if (g_settings.cpu_recompiler_memory_exceptions != old_settings.cpu_recompiler_memory_exceptions)
+      // changing memory exceptions can re-enable fastmem, and the code buffer has to be reallocated for a new size
+      if (changed & Settings::CHANGED_RECOMPILER_CODE_BUFFER)
         CPU::CodeCache::Reinitialize();
       else
         CPU::CodeCache::Flush();
 
-      if (g_settings.cpu_recompiler_icache != old_settings.cpu_recompiler_icache)
+      if (changed & Settings::CHANGED_RECOMPILER_ICACHE)
         CPU::ClearICache();
     }
 
-    SPU::GetOutputStream()->SetOutputVolume(GetAudioOutputVolume());
-
-    if (g_settings.gpu_resolution_scale != old_settings.gpu_resolution_scale ||
-        g_settings.gpu_multisamples != old_settings.gpu_multisamples ||
-        g_settings.gpu_per_sample_shading != old_settings.gpu_per_sample_shading ||
-        g_settings.gpu_use_thread != old_settings.gpu_use_thread ||
-        g_settings.gpu_use_software_renderer_for_readbacks != old_settings.gpu_use_software_renderer_for_readbacks ||
-        g_settings.gpu_fifo_size != old_settings.gpu_fifo_size ||
-        g_settings.gpu_max_run_ahead != old_settings.gpu_max_run_ahead ||
-        g_settings.gpu_true_color != old_settings.gpu_true_color ||
-        g_settings.gpu_scaled_dithering != old_settings.gpu_scaled_dithering ||
-        g_settings.gpu_texture_filter != old_settings.gpu_texture_filter ||
-        g_settings.gpu_disable_interlacing != old_settings.gpu_disable_interlacing ||
-        g_settings.gpu_force_ntsc_timings != old_settings.gpu_force_ntsc_timings ||
-        g_settings.gpu_24bit_chroma_smoothing != old_settings.gpu_24bit_chroma_smoothing ||
-        g_settings.gpu_downsample_mode != old_settings.gpu_downsample_mode ||
-        g_settings.display_crop_mode != old_settings.display_crop_mode ||
-        g_settings.display_aspect_ratio != old_settings.display_aspect_ratio ||
-        g_settings.gpu_pgxp_enable != old_settings.gpu_pgxp_enable ||
-        g_settings.gpu_pgxp_texture_correction != old_settings.gpu_pgxp_texture_correction ||
-        g_settings.gpu_pgxp_color_correction != old_settings.gpu_pgxp_color_correction ||
-        g_settings.gpu_pgxp_depth_buffer != old_settings.gpu_pgxp_depth_buffer ||
-        g_settings.display_active_start_offset != old_settings.display_active_start_offset ||
-        g_settings.display_active_end_offset != old_settings.display_active_end_offset ||
-        g_settings.display_line_start_offset != old_settings.display_line_start_offset ||
-        g_settings.display_line_end_offset != old_settings.display_line_end_offset ||
-        g_settings.rewind_enable != old_settings.rewind_enable ||
-        g_settings.runahead_frames != old_settings.runahead_frames)
+    if (changed & Settings::CHANGED_AUDIO_VOLUME)
+      SPU::GetOutputStream()->SetOutputVolume(GetAudioOutputVolume());
+
+    if (changed & Settings::CHANGED_GPU)
     {
       g_gpu->UpdateSettings();
       Host::InvalidateDisplay();
     }
 
-    if (g_settings.gpu_widescreen_hack != old_settings.gpu_widescreen_hack ||
-        g_settings.display_aspect_ratio != old_settings.display_aspect_ratio ||
-        (g_settings.display_aspect_ratio == DisplayAspectRatio::Custom &&
-         (g_settings.display_aspect_ratio_custom_numerator != old_settings.display_aspect_ratio_custom_numerator ||
-          g_settings.display_aspect_ratio_custom_denominator != old_settings.display_aspect_ratio_custom_denominator)))
-    {
+    if (changed & Settings::CHANGED_ASPECT_RATIO)
       GTE::UpdateAspectRatio();
-    }
 
-    if (g_settings.gpu_pgxp_enable != old_settings.gpu_pgxp_enable ||
-        (g_settings.gpu_pgxp_enable && (g_settings.gpu_pgxp_culling != old_settings.gpu_pgxp_culling ||
-                                        g_settings.gpu_pgxp_vertex_cache != old_settings.gpu_pgxp_vertex_cache ||
-                                        g_settings.gpu_pgxp_cpu != old_settings.gpu_pgxp_cpu)))
+    if ((changed & Settings::CHANGED_PGXP) && (g_settings.gpu_pgxp_enable || old_settings.gpu_pgxp_enable))
     {
       if (g_settings.IsUsingCodeCache())
       {
@@ -3216,50 +4496,32 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
         PGXP::Initialize();
     }
 
-    if (g_settings.cdrom_readahead_sectors != old_settings.cdrom_readahead_sectors)
+    if (changed & Settings::CHANGED_CDROM_READAHEAD)
       g_cdrom.SetReadaheadSectors(g_settings.cdrom_readahead_sectors);
 
-    if (g_settings.memory_card_types != old_settings.memory_card_types ||
-      g_settings.memory_card_paths != old_settings.memory_card_paths ||
-      (g_settings.memory_card_use_playlist_title != old_settings.memory_card_use_playlist_title &&
-        HasMediaSubImages())/* FIXME ||
-       g_settings.memory_card_directory != old_settings.memory_card_directory*/)
+    if ((changed & Settings::CHANGED_MEMORY_CARDS) ||
+        ((changed & Settings::CHANGED_MEMORY_CARD_TITLES) && HasMediaSubImages()))
     {
       UpdateMemoryCardTypes();
     }
 
-    if (g_settings.rewind_enable != old_settings.rewind_enable ||
-        g_settings.rewind_save_frequency != old_settings.rewind_save_frequency ||
-        g_settings.rewind_save_slots != old_settings.rewind_save_slots ||
-        g_settings.runahead_frames != old_settings.runahead_frames)
-    {
+    if (changed & Settings::CHANGED_MEMORY_SAVE_STATES)
       UpdateMemorySaveStateSettings();
-    }
 
-    if (g_settings.texture_replacements.enable_vram_write_replacements !=
-          old_settings.texture_replacements.enable_vram_write_replacements ||
-        g_settings.texture_replacements.preload_textures != old_settings.texture_replacements.preload_textures)
-    {
+    if (changed & Settings::CHANGED_TEXTURE_REPLACEMENTS)
       g_texture_replacements.Reload();
-    }
 
-    g_dma.SetMaxSliceTicks(g_settings.dma_max_slice_ticks);
-    g_dma.SetHaltTicks(g_settings.dma_halt_ticks);
-
-    if (g_settings.audio_backend != old_settings.audio_backend ||
-        g_settings.video_sync_enabled != old_settings.video_sync_enabled ||
-        g_settings.increase_timer_resolution != old_settings.increase_timer_resolution ||
-        g_settings.emulation_speed != old_settings.emulation_speed ||
-        g_settings.fast_forward_speed != old_settings.fast_forward_speed ||
-        g_settings.display_max_fps != old_settings.display_max_fps ||
-        g_settings.display_all_frames != old_settings.display_all_frames ||
-        g_settings.sync_to_host_refresh_rate != old_settings.sync_to_host_refresh_rate)
+    if (changed & Settings::CHANGED_DMA)
     {
-      UpdateSpeedLimiterState();
+      g_dma.SetMaxSliceTicks(g_settings.dma_max_slice_ticks);
+      g_dma.SetHaltTicks(g_settings.dma_halt_ticks);
     }
 
-    if (g_settings.display_post_processing != old_settings.display_post_processing ||
-        g_settings.display_post_process_chain != old_settings.display_post_process_chain)
+    // audio-only playback is only paced by real backends
+    if (changed & (Settings::CHANGED_SPEED_LIMITER | Settings::CHANGED_AUDIO_STREAM))
+      UpdateSpeedLimiterState();
+
+    if (changed & Settings::CHANGED_POST_PROCESSING)
     {
       if (g_settings.display_post_processing && !g_settings.display_post_process_chain.empty())
       {
@@ -3274,47 +4536,105 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
     }
   }
 
-  bool controllers_updated = false;
-  for (u32 i = 0; i < NUM_CONTROLLER_AND_CARD_PORTS; i++)
+  if (changed & Settings::CHANGED_HOST_TIME_ACCOUNTING)
+  {
+    HostTimeAccounting::SetEnabled(g_settings.display_show_subsystem_times || g_settings.display_detect_stutters);
+    s_frame_time_histogram.Reset();
+  }
+
+  // the per-controller settings come from the bindings layer rather than g_settings, so they're always reloaded
+  if (IsValid())
   {
-    if (g_settings.controller_types[i] != old_settings.controller_types[i])
+    if (changed & Settings::CHANGED_CONTROLLER_TYPES)
     {
-      if (IsValid() && !controllers_updated)
-      {
-        UpdateControllers();
-        ResetControllers();
-        UpdateSoftwareCursor();
-        controllers_updated = true;
-      }
+      UpdateControllers();
+      ResetControllers();
     }
-
-    if (IsValid() && !controllers_updated)
+    else
     {
       UpdateControllerSettings();
-      UpdateSoftwareCursor();
     }
+
+    UpdateSoftwareCursor();
   }
 
-  if (g_settings.multitap_mode != old_settings.multitap_mode)
+  if (changed & Settings::CHANGED_MULTITAP)
     UpdateMultitaps();
 }
 
-void System::CalculateRewindMemoryUsage(u32 num_saves, u64* ram_usage, u64* vram_usage)
+void System::CalculateRewindMemoryUsage(u32 num_saves, bool native_resolution_vram, u64* ram_usage, u64* vram_usage)
 {
   *ram_usage = MAX_SAVE_STATE_SIZE * static_cast<u64>(num_saves);
-  *vram_usage = (VRAM_WIDTH * VRAM_HEIGHT * 4) * static_cast<u64>(std::max(g_settings.gpu_resolution_scale, 1u)) *
-                static_cast<u64>(g_settings.gpu_multisamples) * static_cast<u64>(num_saves);
+  *vram_usage = native_resolution_vram ?
+                  0 :
+                  (VRAM_WIDTH * VRAM_HEIGHT * 4) * static_cast<u64>(std::max(g_settings.gpu_resolution_scale, 1u)) *
+                    static_cast<u64>(g_settings.gpu_multisamples) * static_cast<u64>(num_saves);
+}
+
+std::unique_ptr<GPUTexture> System::AcquireMemoryStateTexture()
+{
+  // the renderer replaces it if it's the wrong size
+  std::unique_ptr<GPUTexture> texture;
+  if (!s_memory_state_texture_pool.empty())
+  {
+    texture = std::move(s_memory_state_texture_pool.back());
+    s_memory_state_texture_pool.pop_back();
+  }
+
+  return texture;
+}
+
+u32 System::GetMaxMemoryStateTextures()
+{
+  // the head rewind state has a texture too
+  const bool rewind_textures = (g_settings.rewind_enable && !g_settings.rewind_native_resolution_vram);
+  return (rewind_textures ? (g_settings.rewind_save_slots + 1) : 0) + g_settings.runahead_frames +
+         static_cast<u32>(s_netplay_states.size());
+}
+
+void System::ReleaseMemoryStateTexture(std::unique_ptr<GPUTexture> texture)
+{
+  // no point keeping more than can be in use at once
+  if (texture && s_memory_state_texture_pool.size() < GetMaxMemoryStateTextures())
+    s_memory_state_texture_pool.push_back(std::move(texture));
+}
+
+void System::DestroyMemoryStateTexturePool()
+{
+  s_memory_state_texture_pool.clear();
 }
 
 void System::ClearMemorySaveStates()
 {
+  for (RewindState& rs : s_rewind_states)
+    ReleaseMemoryStateTexture(std::move(rs.vram_texture));
+  ReleaseMemoryStateTexture(std::move(s_rewind_head_state.vram_texture));
+  for (MemorySaveState& mss : s_runahead_states)
+    ReleaseMemoryStateTexture(std::move(mss.vram_texture));
+  for (MemorySaveState& mss : s_runahead_spare_states)
+    ReleaseMemoryStateTexture(std::move(mss.vram_texture));
+
   s_rewind_states.clear();
+  s_rewind_head_state = {};
+  s_rewind_head_valid = false;
+  s_rewind_spare_stream.reset();
+  s_rewind_delta_buffer = {};
+  s_rewind_compress_buffer = {};
+  if (s_rewind_compress_context)
+  {
+    ZSTD_freeCCtx(s_rewind_compress_context);
+    s_rewind_compress_context = nullptr;
+  }
+
   s_runahead_states.clear();
+  s_runahead_spare_states.clear();
 }
 
 void System::UpdateMemorySaveStateSettings()
 {
   ClearMemorySaveStates();
+  if (s_memory_state_texture_pool.size() > GetMaxMemoryStateTextures())
+    s_memory_state_texture_pool.resize(GetMaxMemoryStateTextures());
 
   s_memory_saves_enabled = g_settings.rewind_enable;
 
@@ -3324,7 +4644,8 @@ void System::UpdateMemorySaveStateSettings()
     s_rewind_save_counter = 0;
 
     u64 ram_usage, vram_usage;
-    CalculateRewindMemoryUsage(g_settings.rewind_save_slots, &ram_usage, &vram_usage);
+    CalculateRewindMemoryUsage(g_settings.rewind_save_slots, g_settings.rewind_native_resolution_vram, &ram_usage,
+                               &vram_usage);
     Log_InfoPrintf(
       "Rewind is enabled, saving every %d frames, with %u slots and %" PRIu64 "MB RAM and %" PRIu64 "MB VRAM usage",
       std::max(s_rewind_save_frequency, 1), g_settings.rewind_save_slots, ram_usage / 1048576, vram_usage / 1048576);
@@ -3344,13 +4665,14 @@ void System::UpdateMemorySaveStateSettings()
     Log_InfoPrintf("Runahead is active with %u frames", s_runahead_frames);
 }
 
-bool System::LoadMemoryState(const MemorySaveState& mss)
+bool System::LoadMemoryState(const MemorySaveState& mss, bool update_display)
 {
   mss.state_stream->SeekAbsolute(0);
 
+  // states without a VRAM texture have native resolution VRAM in the stream instead
   StateWrapper sw(mss.state_stream.get(), StateWrapper::Mode::Read, SAVE_STATE_VERSION);
   GPUTexture* host_texture = mss.vram_texture.get();
-  if (!DoState(sw, &host_texture, true, true))
+  if (!DoState(sw, host_texture ? &host_texture : nullptr, update_display, true))
   {
     Host::ReportErrorAsync("Error", "Failed to load memory save state, resetting.");
     InternalReset();
@@ -3360,16 +4682,21 @@ bool System::LoadMemoryState(const MemorySaveState& mss)
   return true;
 }
 
-bool System::SaveMemoryState(MemorySaveState* mss)
+bool System::SaveMemoryState(MemorySaveState* mss, bool host_vram)
 {
   if (!mss->state_stream)
     mss->state_stream = std::make_unique<GrowableMemoryByteStream>(nullptr, MAX_SAVE_STATE_SIZE);
   else
     mss->state_stream->SeekAbsolute(0);
 
+  if (!host_vram)
+    ReleaseMemoryStateTexture(std::move(mss->vram_texture));
+  else if (!mss->vram_texture)
+    mss->vram_texture = AcquireMemoryStateTexture();
+
   GPUTexture* host_texture = mss->vram_texture.release();
   StateWrapper sw(mss->state_stream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
-  if (!DoState(sw, &host_texture, false, true))
+  if (!DoState(sw, host_vram ? &host_texture : nullptr, false, true))
   {
     Log_ErrorPrint("Failed to create rewind state.");
     delete host_texture;
@@ -3380,28 +4707,182 @@ bool System::SaveMemoryState(MemorySaveState* mss)
   return true;
 }
 
+bool System::EncodeRewindDelta(const GrowableMemoryByteStream* older, const GrowableMemoryByteStream* newer,
+                               RewindState* rs)
+{
+  // Each changed page is stored as its index followed by the XOR of the two versions, with the shorter state treated
+  // as zero-padded. Most of RAM is untouched between saves, so this leaves very little for the compressor.
+  static constexpr u32 ENTRY_SIZE = sizeof(u32) + REWIND_DELTA_PAGE_SIZE;
+
+  const u8* older_data = older->GetMemoryPointer();
+  const u8* newer_data = newer->GetMemoryPointer();
+  const u32 older_size = static_cast<u32>(older->GetSize());
+  const u32 newer_size = static_cast<u32>(newer->GetSize());
+  const u32 num_pages = (std::max(older_size, newer_size) + (REWIND_DELTA_PAGE_SIZE - 1)) / REWIND_DELTA_PAGE_SIZE;
+  if (s_rewind_delta_buffer.size() < (num_pages * ENTRY_SIZE))
+    s_rewind_delta_buffer.resize(num_pages * ENTRY_SIZE);
+
+  u8* entry_ptr = s_rewind_delta_buffer.data();
+  for (u32 page = 0; page < num_pages; page++)
+  {
+    const u32 offset = page * REWIND_DELTA_PAGE_SIZE;
+    const u32 older_len = (offset < older_size) ? std::min(older_size - offset, REWIND_DELTA_PAGE_SIZE) : 0;
+    const u32 newer_len = (offset < newer_size) ? std::min(newer_size - offset, REWIND_DELTA_PAGE_SIZE) : 0;
+    if (older_len == newer_len && std::memcmp(older_data + offset, newer_data + offset, older_len) == 0)
+      continue;
+
+    std::memcpy(entry_ptr, &page, sizeof(page));
+    u8* xor_ptr = entry_ptr + sizeof(u32);
+    std::memcpy(xor_ptr, older_data + offset, older_len);
+    std::memset(xor_ptr + older_len, 0, REWIND_DELTA_PAGE_SIZE - older_len);
+    for (u32 i = 0; i < newer_len; i++)
+      xor_ptr[i] ^= newer_data[offset + i];
+
+    entry_ptr += ENTRY_SIZE;
+  }
+
+  const u32 delta_size = static_cast<u32>(entry_ptr - s_rewind_delta_buffer.data());
+  const size_t compress_bound = ZSTD_compressBound(delta_size);
+  if (s_rewind_compress_buffer.size() < compress_bound)
+    s_rewind_compress_buffer.resize(compress_bound);
+  if (!s_rewind_compress_context && !(s_rewind_compress_context = ZSTD_createCCtx()))
+    return false;
+
+  const size_t compressed_size =
+    ZSTD_compressCCtx(s_rewind_compress_context, s_rewind_compress_buffer.data(), s_rewind_compress_buffer.size(),
+                      s_rewind_delta_buffer.data(), delta_size, REWIND_DELTA_COMPRESSION_LEVEL);
+  if (ZSTD_isError(compressed_size))
+  {
+    Log_ErrorPrintf("Failed to compress rewind state: %s", ZSTD_getErrorName(compressed_size));
+    return false;
+  }
+
+  rs->compressed_delta.assign(s_rewind_compress_buffer.begin(), s_rewind_compress_buffer.begin() + compressed_size);
+  rs->delta_size = delta_size;
+  rs->state_size = older_size;
+  return true;
+}
+
+bool System::DecodeRewindDelta(const RewindState& rs, GrowableMemoryByteStream* stream)
+{
+  static constexpr u32 ENTRY_SIZE = sizeof(u32) + REWIND_DELTA_PAGE_SIZE;
+
+  if (s_rewind_delta_buffer.size() < rs.delta_size)
+    s_rewind_delta_buffer.resize(rs.delta_size);
+
+  const size_t decompressed_size = ZSTD_decompress(s_rewind_delta_buffer.data(), rs.delta_size,
+                                                   rs.compressed_delta.data(), rs.compressed_delta.size());
+  if (ZSTD_isError(decompressed_size) || decompressed_size != rs.delta_size)
+  {
+    Log_ErrorPrintf("Failed to decompress rewind state");
+    return false;
+  }
+
+  // pad out to whole pages with zeros, matching the encoder
+  const u32 newer_size = static_cast<u32>(stream->GetSize());
+  const u32 padded_size = Common::AlignUpPow2(std::max(newer_size, rs.state_size), REWIND_DELTA_PAGE_SIZE);
+  stream->Resize(padded_size);
+  u8* data = stream->GetMemoryPointer();
+  std::memset(data + newer_size, 0, padded_size - newer_size);
+
+  for (u32 entry_offset = 0; entry_offset < rs.delta_size; entry_offset += ENTRY_SIZE)
+  {
+    const u8* entry_ptr = &s_rewind_delta_buffer[entry_offset];
+    u32 page;
+    std::memcpy(&page, entry_ptr, sizeof(page));
+    if (((page + 1) * REWIND_DELTA_PAGE_SIZE) > padded_size)
+    {
+      Log_ErrorPrintf("Rewind state page %u is out of range", page);
+      return false;
+    }
+
+    u8* page_ptr = data + page * REWIND_DELTA_PAGE_SIZE;
+    const u8* xor_ptr = entry_ptr + sizeof(u32);
+    for (u32 i = 0; i < REWIND_DELTA_PAGE_SIZE; i++)
+      page_ptr[i] ^= xor_ptr[i];
+  }
+
+  stream->Resize(rs.state_size);
+  return true;
+}
+
+void System::PopRewindHeadState()
+{
+  if (s_rewind_states.empty())
+  {
+    s_rewind_head_valid = false;
+    return;
+  }
+
+  RewindState& rs = s_rewind_states.back();
+  if (!DecodeRewindDelta(rs, s_rewind_head_state.state_stream.get()))
+  {
+    // nothing older can be rebuilt without this one
+    s_rewind_states.clear();
+    s_rewind_head_valid = false;
+    return;
+  }
+
+  ReleaseMemoryStateTexture(std::move(s_rewind_head_state.vram_texture));
+  s_rewind_head_state.vram_texture = std::move(rs.vram_texture);
+  s_rewind_states.pop_back();
+}
+
 bool System::SaveRewindState()
 {
 #ifdef PROFILE_MEMORY_SAVE_STATES
   Common::Timer save_timer;
 #endif
 
-  // try to reuse the frontmost slot
+  // try to reuse the frontmost slot's texture
   const u32 save_slots = g_settings.rewind_save_slots;
   MemorySaveState mss;
-  while (s_rewind_states.size() >= save_slots)
+  while (!s_rewind_states.empty() && (s_rewind_states.size() + 1) >= save_slots)
   {
-    mss = std::move(s_rewind_states.front());
+    ReleaseMemoryStateTexture(std::move(mss.vram_texture));
+    mss.vram_texture = std::move(s_rewind_states.front().vram_texture);
     s_rewind_states.pop_front();
   }
+  if (s_rewind_head_valid && save_slots <= 1)
+  {
+    mss = std::move(s_rewind_head_state);
+    s_rewind_head_valid = false;
+  }
+  else
+  {
+    mss.state_stream = std::move(s_rewind_spare_stream);
+  }
 
-  if (!SaveMemoryState(&mss))
+  if (!SaveMemoryState(&mss, !g_settings.rewind_native_resolution_vram))
+  {
+    s_rewind_spare_stream = std::move(mss.state_stream);
     return false;
+  }
+
+  if (s_rewind_head_valid)
+  {
+    RewindState rs;
+    if (EncodeRewindDelta(s_rewind_head_state.state_stream.get(), mss.state_stream.get(), &rs))
+    {
+      rs.vram_texture = std::move(s_rewind_head_state.vram_texture);
+      s_rewind_states.push_back(std::move(rs));
+    }
+    else
+    {
+      // can't step back past the gap anyway
+      s_rewind_states.clear();
+    }
 
-  s_rewind_states.push_back(std::move(mss));
+    s_rewind_spare_stream = std::move(s_rewind_head_state.state_stream);
+  }
+
+  s_rewind_head_state = std::move(mss);
+  s_rewind_head_valid = true;
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
-  Log_DevPrintf("Saved rewind state (%" PRIu64 " bytes, took %.4f ms)", s_rewind_states.back().state_stream->GetSize(),
+  Log_DevPrintf("Saved rewind state (%" PRIu64 " bytes, %zu bytes compressed delta, took %.4f ms)",
+                s_rewind_head_state.state_stream->GetSize(),
+                s_rewind_states.empty() ? static_cast<size_t>(0) : s_rewind_states.back().compressed_delta.size(),
                 save_timer.GetTimeMilliseconds());
 #endif
 
@@ -3410,24 +4891,24 @@ bool System::SaveRewindState()
 
 bool System::LoadRewindState(u32 skip_saves /*= 0*/, bool consume_state /*=true */)
 {
-  while (skip_saves > 0 && !s_rewind_states.empty())
+  while (skip_saves > 0 && s_rewind_head_valid)
   {
-    s_rewind_states.pop_back();
+    PopRewindHeadState();
     skip_saves--;
   }
 
-  if (s_rewind_states.empty())
+  if (!s_rewind_head_valid)
     return false;
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
   Common::Timer load_timer;
 #endif
 
-  if (!LoadMemoryState(s_rewind_states.back()))
+  if (!LoadMemoryState(s_rewind_head_state, true))
     return false;
 
   if (consume_state)
-    s_rewind_states.pop_back();
+    PopRewindHeadState();
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
   Log_DevPrintf("Rewind load took %.4f ms", load_timer.GetTimeMilliseconds());
@@ -3481,15 +4962,20 @@ void System::DoRewind()
 
 void System::SaveRunaheadState()
 {
-  // try to reuse the frontmost slot
+  // try to reuse the frontmost slot, or one thrown away by the last replay
   MemorySaveState mss;
   while (s_runahead_states.size() >= s_runahead_frames)
   {
     mss = std::move(s_runahead_states.front());
     s_runahead_states.pop_front();
   }
+  if (!mss.state_stream && !s_runahead_spare_states.empty())
+  {
+    mss = std::move(s_runahead_spare_states.back());
+    s_runahead_spare_states.pop_back();
+  }
 
-  if (!SaveMemoryState(&mss))
+  if (!SaveMemoryState(&mss, true))
   {
     Log_ErrorPrint("Failed to save runahead state.");
     return;
@@ -3509,15 +4995,20 @@ void System::DoRunahead()
   {
     // we need to replay and catch up - load the state,
     s_runahead_replay_pending = false;
-    if (s_runahead_states.empty() || !LoadMemoryState(s_runahead_states.front()))
+    // the display is updated by the frame we run afterwards
+    if (s_runahead_states.empty() || !LoadMemoryState(s_runahead_states.front(), false))
     {
       s_runahead_states.clear();
       return;
     }
 
-    // and throw away all the states, forcing us to catch up below
-    // TODO: can we leave one frame here and run, avoiding the extra save?
-    s_runahead_states.clear();
+    // and throw away all the states, forcing us to catch up below. the allocations are kept, otherwise every replay
+    // would have to recreate the state buffers and VRAM textures
+    while (!s_runahead_states.empty())
+    {
+      s_runahead_spare_states.push_back(std::move(s_runahead_states.front()));
+      s_runahead_states.pop_front();
+    }
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
     Log_VerbosePrintf("Rewound to frame %u, took %.2f ms", s_frame_number, timer.GetTimeMilliseconds());
@@ -3534,6 +5025,7 @@ void System::DoRunahead()
 #endif
 
     SPU::SetAudioOutputMuted(true);
+    s_runahead_replaying = true;
 
     while (frames_to_run > 0)
     {
@@ -3542,6 +5034,7 @@ void System::DoRunahead()
       frames_to_run--;
     }
 
+    s_runahead_replaying = false;
     SPU::SetAudioOutputMuted(false);
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
@@ -3578,6 +5071,52 @@ void System::DoMemorySaveStates()
     SaveRunaheadState();
 }
 
+void System::SetNetplayStateSlotCount(u32 count)
+{
+  for (size_t i = count; i < s_netplay_states.size(); i++)
+    ReleaseMemoryStateTexture(std::move(s_netplay_states[i].vram_texture));
+
+  s_netplay_states.resize(count);
+}
+
+bool System::SaveNetplayState(u32 slot)
+{
+  DebugAssert(slot < s_netplay_states.size());
+  return SaveMemoryState(&s_netplay_states[slot], true);
+}
+
+bool System::LoadNetplayState(u32 slot)
+{
+  DebugAssert(slot < s_netplay_states.size());
+  return (s_netplay_states[slot].state_stream && LoadMemoryState(s_netplay_states[slot], false));
+}
+
+void System::RunNetplayFrame(bool replaying)
+{
+  if (!replaying)
+  {
+    DoRunFrame();
+    return;
+  }
+
+  SPU::SetAudioOutputMuted(true);
+  s_runahead_replaying = true;
+  DoRunFrame();
+  s_runahead_replaying = false;
+  SPU::SetAudioOutputMuted(false);
+}
+
+bool System::IsReplayingRunahead()
+{
+  return s_runahead_replaying;
+}
+
+bool System::IsSkippingFrameDrawing()
+{
+  // runahead replays before the skipped frame have to be drawn, the displayed frame is built from them
+  return s_skipping_frame_drawing && !s_runahead_replaying;
+}
+
 void System::SetRunaheadReplayFlag()
 {
   if (s_runahead_frames == 0 || s_runahead_states.empty())
@@ -3731,6 +5270,192 @@ void System::StopDumpingAudio()
   Host::AddOSDMessage(Host::TranslateStdString("OSDMessage", "Stopped dumping audio."), 5.0f);
 }
 
+bool System::IsRecordingGPUDump()
+{
+  return IsValid() && g_gpu->IsRecordingDump();
+}
+
+bool System::StartRecordingGPUDump(const char* filename)
+{
+  if (!IsValid() || s_gpu_dump_player)
+    return false;
+
+  std::string auto_filename;
+  if (!filename)
+  {
+    const auto& serial = System::GetRunningSerial();
+    if (serial.empty())
+    {
+      auto_filename = Path::Combine(EmuFolders::Dumps, fmt::format("gpu" FS_OSPATH_SEPARATOR_STR "{}.gpudump",
+                                                                   GetTimestampStringForFileName()));
+    }
+    else
+    {
+      auto_filename = Path::Combine(EmuFolders::Dumps, fmt::format("gpu" FS_OSPATH_SEPARATOR_STR "{}_{}.gpudump",
+                                                                   serial, GetTimestampStringForFileName()));
+    }
+
+    filename = auto_filename.c_str();
+  }
+
+  if (g_gpu->StartRecordingDump(filename))
+  {
+    Host::AddFormattedOSDMessage(5.0f, Host::TranslateString("OSDMessage", "Started recording GPU dump to '%s'."),
+                                 filename);
+    return true;
+  }
+  else
+  {
+    Host::AddFormattedOSDMessage(10.0f,
+                                 Host::TranslateString("OSDMessage", "Failed to start recording GPU dump to '%s'."),
+                                 filename);
+    return false;
+  }
+}
+
+void System::StopRecordingGPUDump()
+{
+  if (!IsRecordingGPUDump())
+    return;
+
+  g_gpu->StopRecordingDump();
+  Host::AddOSDMessage(Host::TranslateStdString("OSDMessage", "Stopped recording GPU dump."), 5.0f);
+}
+
+bool System::IsCapturingMedia()
+{
+  return static_cast<bool>(s_media_capture);
+}
+
+bool System::StartMediaCapture(const char* filename)
+{
+  if (!IsValid() || s_media_capture)
+    return false;
+
+  u32 width, height;
+  if (!g_host_display->CalculateDisplayTextureOutputSize(true, true, &width, &height))
+  {
+    Host::AddOSDMessage(Host::TranslateStdString("OSDMessage", "Cannot start capture, nothing is being displayed."),
+                        10.0f);
+    return false;
+  }
+
+  // most players expect even dimensions
+  width = Common::AlignUpPow2(width, 2);
+  height = Common::AlignUpPow2(height, 2);
+
+  std::string auto_filename;
+  if (!filename)
+  {
+    const auto& serial = System::GetRunningSerial();
+    if (serial.empty())
+    {
+      auto_filename = Path::Combine(
+        EmuFolders::Dumps, fmt::format("video" FS_OSPATH_SEPARATOR_STR "{}.avi", GetTimestampStringForFileName()));
+    }
+    else
+    {
+      auto_filename = Path::Combine(EmuFolders::Dumps, fmt::format("video" FS_OSPATH_SEPARATOR_STR "{}_{}.avi", serial,
+                                                                   GetTimestampStringForFileName()));
+    }
+
+    filename = auto_filename.c_str();
+  }
+
+  std::unique_ptr<Common::AVIWriter> capture = std::make_unique<Common::AVIWriter>();
+  if (!capture->Open(filename, width, height, s_throttle_frequency, SPU::SAMPLE_RATE, 2, MEDIA_CAPTURE_JPEG_QUALITY))
+  {
+    Host::AddFormattedOSDMessage(10.0f, Host::TranslateString("OSDMessage", "Failed to start capturing to '%s'."),
+                                 filename);
+    return false;
+  }
+
+  s_media_capture = std::move(capture);
+  SPU::SetMediaCaptureWriter(s_media_capture.get());
+  Host::AddFormattedOSDMessage(5.0f, Host::TranslateString("OSDMessage", "Started capturing %ux%u video to '%s'."),
+                               width, height, filename);
+  return true;
+}
+
+void System::StopMediaCapture()
+{
+  if (!s_media_capture)
+    return;
+
+  SPU::SetMediaCaptureWriter(nullptr);
+  s_media_capture.reset();
+  Host::AddOSDMessage(Host::TranslateStdString("OSDMessage", "Stopped capturing video."), 5.0f);
+}
+
+#ifdef WITH_PROFILER
+
+bool System::IsCapturingProfile()
+{
+  return Profiler::IsCapturing();
+}
+
+bool System::StartProfileCapture(const char* filename)
+{
+  if (!IsValid() || Profiler::IsCapturing())
+    return false;
+
+  if (filename)
+  {
+    s_profile_capture_filename = filename;
+  }
+  else
+  {
+    const auto& serial = System::GetRunningSerial();
+    if (serial.empty())
+    {
+      s_profile_capture_filename = Path::Combine(
+        EmuFolders::Dumps, fmt::format("traces" FS_OSPATH_SEPARATOR_STR "{}.json", GetTimestampStringForFileName()));
+    }
+    else
+    {
+      s_profile_capture_filename =
+        Path::Combine(EmuFolders::Dumps, fmt::format("traces" FS_OSPATH_SEPARATOR_STR "{}_{}.json", serial,
+                                                     GetTimestampStringForFileName()));
+    }
+  }
+
+  Profiler::StartCapture();
+  Host::AddFormattedOSDMessage(5.0f, Host::TranslateString("OSDMessage", "Started capturing profile to '%s'."),
+                               s_profile_capture_filename.c_str());
+  return true;
+}
+
+void System::StopProfileCapture()
+{
+  if (!Profiler::IsCapturing())
+    return;
+
+  if (Profiler::StopCapture(s_profile_capture_filename.c_str()))
+  {
+    Host::AddFormattedOSDMessage(5.0f, Host::TranslateString("OSDMessage", "Wrote profile to '%s'."),
+                                 s_profile_capture_filename.c_str());
+  }
+  else
+  {
+    Host::AddFormattedOSDMessage(10.0f, Host::TranslateString("OSDMessage", "Failed to write profile to '%s'."),
+                                 s_profile_capture_filename.c_str());
+  }
+
+  s_profile_capture_filename = {};
+}
+
+#endif
+
+void System::CaptureMediaFrame()
+{
+  // if the readback fails, an empty frame is written, which repeats the last image and keeps audio in sync
+  std::vector<u32> pixels;
+  if (!g_host_display->WriteDisplayTextureToBuffer(&pixels, s_media_capture->GetWidth(), s_media_capture->GetHeight()))
+    pixels.clear();
+
+  s_media_capture->WriteVideoFrame(std::move(pixels));
+}
+
 bool System::SaveScreenshot(const char* filename /* = nullptr */, bool full_resolution /* = true */,
                             bool apply_aspect_ratio /* = true */, bool compress_on_thread /* = true */)
 {
@@ -3800,6 +5525,8 @@ std::vector<SaveStateInfo> System::GetAvailableSaveStates(const char* serial)
   std::vector<SaveStateInfo> si;
   std::string path;
 
+  FlushSaveStateWrites();
+
   auto add_path = [&si](std::string path, s32 slot, bool global) {
     FILESYSTEM_STAT_DATA sd;
     if (!FileSystem::StatFile(path.c_str(), &sd))
@@ -3826,6 +5553,9 @@ std::optional<SaveStateInfo> System::GetSaveStateInfo(const char* serial, s32 sl
   const bool global = (!serial || serial[0] == 0);
   std::string path = global ? GetGlobalSaveStateFileName(slot) : GetGameSaveStateFileName(serial, slot);
 
+  // a slot which was just saved might still be being written
+  FlushSaveStateWrites();
+
   FILESYSTEM_STAT_DATA sd;
   if (!FileSystem::StatFile(path.c_str(), &sd))
     return std::nullopt;
@@ -3835,6 +5565,8 @@ std::optional<SaveStateInfo> System::GetSaveStateInfo(const char* serial, s32 sl
 
 std::optional<ExtendedSaveStateInfo> System::GetExtendedSaveStateInfo(const char* path)
 {
+  FlushSaveStateWrites();
+
   FILESYSTEM_STAT_DATA sd;
   if (!FileSystem::StatFile(path, &sd))
     return std::nullopt;
@@ -4071,13 +5803,11 @@ void System::SetCheatCodeState(u32 index, bool enabled, bool save_to_file)
   if (index >= cl->GetCodeCount())
     return;
 
-  CheatCode& cc = cl->GetCode(index);
+  const CheatCode& cc = cl->GetCode(index);
   if (cc.enabled == enabled)
     return;
 
-  cc.enabled = enabled;
-  if (!enabled)
-    cc.ApplyOnDisable();
+  cl->SetCodeEnabled(index, enabled);
 
   if (enabled)
   {
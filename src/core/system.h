@@ -6,9 +6,11 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 class ByteStream;
 class CDImage;
+class FrameTimeHistogram;
 class StateWrapper;
 
 class Controller;
@@ -32,6 +34,9 @@ struct SystemBootParameters
   u32 media_playlist_index = 0;
   bool load_image_to_ram = false;
   bool force_software_renderer = false;
+
+  /// Netplay session to join once booted, see Netplay::Start().
+  std::string netplay_session;
 };
 
 struct SaveStateInfo
@@ -86,6 +91,9 @@ bool IsExeFileName(const std::string_view& path);
 /// Returns true if the filename is a Portable Sound Format file we can uncompress/load.
 bool IsPsfFileName(const std::string_view& path);
 
+/// Returns true if the filename is a GPU command dump we can replay.
+bool IsGPUDumpFileName(const std::string_view& path);
+
 /// Returns true if the filename is one we can load.
 bool IsLoadableFilename(const std::string_view& path);
 
@@ -172,12 +180,24 @@ const std::string& GetRunningSerial();
 const std::string& GetRunningTitle();
 bool IsRunningBIOS();
 
+/// Hashes RAM, VRAM and SPU RAM, for finding the first frame where two runs diverge. VRAM is skipped if vram_hash is
+/// null, since reading it back from the GPU is slow.
+void GetMemoryHashes(u64* ram_hash, u64* vram_hash, u64* spu_ram_hash);
+
 // TODO: Move to PerformanceMetrics
 float GetFPS();
 float GetVPS();
 float GetEmulationSpeed();
 float GetAverageFrameTime();
 float GetWorstFrameTime();
+
+/// Frame times over the last few seconds, only updated while stutter detection is enabled.
+const FrameTimeHistogram& GetFrameTimeHistogram();
+
+/// Time from input being read to the frame emulated with it being presented, in milliseconds.
+float GetAverageInputLatency();
+float GetWorstInputLatency();
+
 float GetThrottleFrequency();
 float GetCPUThreadUsage();
 float GetCPUThreadAverageTime();
@@ -186,6 +206,16 @@ float GetSWThreadAverageTime();
 float GetGPUUsage();
 float GetGPUAverageTime();
 
+/// CPU time spent blocked waiting for the GPU to release a frame's resources, averaged over presented frames.
+float GetAverageFenceWaitTime();
+
+/// Per-section breakdown of the GPU time, averaged over presented frames. Only valid if HasGPUSectionTimes().
+bool HasGPUSectionTimes();
+float GetGPUSectionAverageTime(GPUTimingSection section);
+
+/// Incremented each time the counters above are recalculated, so anything displaying them can skip reformatting.
+u32 GetPerformanceCountersUpdateCount();
+
 /// Loads global settings (i.e. EmuConfig).
 void LoadSettings(bool display_osd_messages);
 void SetDefaultSettings(SettingsInterface& si);
@@ -202,6 +232,12 @@ void ResetSystem();
 
 /// Loads state from the specified filename.
 bool LoadState(const char* filename);
+
+/// Reads and decompresses a save state in the background, so loading it afterwards doesn't have to touch the disk.
+void PrefetchSaveState(const char* filename);
+
+/// Saves state to the specified filename. The file is compressed and written in the background, so the result only
+/// covers serializing the state, and functions which read state files back wait for any pending writes.
 bool SaveState(const char* filename, bool backup_existing_save);
 bool SaveResumeState();
 
@@ -214,6 +250,10 @@ void RecreateSystem();
 /// Recreates the GPU component, saving/loading the state so it is preserved. Call when the GPU renderer changes.
 bool RecreateGPU(GPURenderer renderer, bool force_recreate_display = false, bool update_display = true);
 
+/// Destroys the hardware renderer kept after shutdown for the next boot to reuse. Must be called before the host
+/// display is released.
+void ReleaseParkedGPU();
+
 void SingleStepCPU();
 void RunFrame();
 void RunFrames();
@@ -231,6 +271,9 @@ void ResetThrottler();
 /// Throttles the system, i.e. sleeps until it's time to execute the next frame.
 void Throttle();
 
+/// Delays the start of the next frame by the time it isn't expected to need, then polls input.
+void PreFrameSleep();
+
 void UpdatePerformanceCounters();
 void ResetPerformanceCounters();
 
@@ -313,6 +356,13 @@ void SetTurboEnabled(bool enabled);
 bool IsRewinding();
 void SetRewindState(bool enabled);
 
+/// Returns true while runahead is catching up. These frames are never shown, so display updates can be skipped.
+bool IsReplayingRunahead();
+
+/// Returns true while emulating a frame whose draws are dropped by adaptive frameskip, because the host is behind.
+/// VRAM transfers, fills and the software readback renderer still run, only the host GPU draws are skipped.
+bool IsSkippingFrameDrawing();
+
 void DoFrameStep();
 void DoToggleCheats();
 
@@ -365,6 +415,36 @@ bool StartDumpingAudio(const char* filename = nullptr);
 /// Stops dumping audio to file if it has been started.
 void StopDumpingAudio();
 
+/// Returns true if currently recording a GPU dump.
+bool IsRecordingGPUDump();
+
+/// Starts recording the GPU command stream to a file. If no file name is provided, one will be generated automatically.
+bool StartRecordingGPUDump(const char* filename = nullptr);
+
+/// Stops recording the GPU dump if it has been started.
+void StopRecordingGPUDump();
+
+/// Returns true if currently capturing video and audio.
+bool IsCapturingMedia();
+
+/// Starts capturing the display and audio output to an AVI file. If no file name is provided, one will be generated
+/// automatically. The video size is fixed at the current display size, later mode changes are scaled to fit.
+bool StartMediaCapture(const char* filename = nullptr);
+
+/// Stops capturing video and audio if it has been started.
+void StopMediaCapture();
+
+#ifdef WITH_PROFILER
+/// Returns true if the frame profiler is capturing zones.
+bool IsCapturingProfile();
+
+/// Starts capturing profiler zones from all threads. If no file name is provided, one will be generated automatically.
+bool StartProfileCapture(const char* filename = nullptr);
+
+/// Stops capturing profiler zones, and writes them to the file as a Chrome trace.
+void StopProfileCapture();
+#endif
+
 /// Saves a screenshot to the specified file. IF no file name is provided, one will be generated automatically.
 bool SaveScreenshot(const char* filename = nullptr, bool full_resolution = true, bool apply_aspect_ratio = true,
                     bool compress_on_thread = true);
@@ -427,12 +507,20 @@ void HostDisplayResized();
 //////////////////////////////////////////////////////////////////////////
 // Memory Save States (Rewind and Runahead)
 //////////////////////////////////////////////////////////////////////////
-void CalculateRewindMemoryUsage(u32 num_saves, u64* ram_usage, u64* vram_usage);
+void CalculateRewindMemoryUsage(u32 num_saves, bool native_resolution_vram, u64* ram_usage, u64* vram_usage);
 void ClearMemorySaveStates();
 void UpdateMemorySaveStateSettings();
 bool LoadRewindState(u32 skip_saves = 0, bool consume_state = true);
 void SetRunaheadReplayFlag();
 
+/// Netplay's states to roll back to, which are kept apart from rewind and runahead. A count of zero frees them.
+void SetNetplayStateSlotCount(u32 count);
+bool SaveNetplayState(u32 slot);
+bool LoadNetplayState(u32 slot);
+
+/// Runs a frame for netplay. Replayed frames are muted and not displayed, the same as for runahead.
+void RunNetplayFrame(bool replaying);
+
 } // namespace System
 
 namespace Host {
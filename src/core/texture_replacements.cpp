@@ -4,19 +4,27 @@
 #include "common/path.h"
 #include "common/platform.h"
 #include "common/string_util.h"
+#include "common/thirdparty/thread_pool.h"
 #include "common/timer.h"
 #include "fmt/format.h"
+#include "gpu_types.h"
 #include "host.h"
 #include "settings.h"
 #include "xxhash.h"
 #if defined(CPU_X86) || defined(CPU_X64)
 #include "xxh_x86dispatch.h"
 #endif
+#include <algorithm>
 #include <cinttypes>
 Log_SetChannel(TextureReplacements);
 
 TextureReplacements g_texture_replacements;
 
+static constexpr int ASYNC_LOAD_THREADS = 2;
+
+// writes are dropped rather than blocking emulation when dumping falls this far behind, they'll be dumped next time
+static constexpr size_t MAX_QUEUED_DUMP_BYTES = 64 * 1024 * 1024;
+
 static constexpr u32 VRAMRGBA5551ToRGBA8888(u16 color)
 {
   u8 r = Truncate8(color & 31);
@@ -33,6 +41,11 @@ static constexpr u32 VRAMRGBA5551ToRGBA8888(u16 color)
   return ZeroExtend32(r) | (ZeroExtend32(g) << 8) | (ZeroExtend32(b) << 16) | (ZeroExtend32(a) << 24);
 }
 
+static size_t GetTextureMemoryUsage(const TextureReplacementTexture& texture)
+{
+  return static_cast<size_t>(texture.GetPitch()) * texture.GetHeight();
+}
+
 std::string TextureReplacementHash::ToString() const
 {
   return StringUtil::StdStringFromFormat("%" PRIx64 "%" PRIx64, high, low);
@@ -55,7 +68,10 @@ bool TextureReplacementHash::ParseString(const std::string_view& sv)
 
 TextureReplacements::TextureReplacements() = default;
 
-TextureReplacements::~TextureReplacements() = default;
+TextureReplacements::~TextureReplacements()
+{
+  ClosePack();
+}
 
 void TextureReplacements::SetGameID(std::string game_id)
 {
@@ -68,44 +84,79 @@ void TextureReplacements::SetGameID(std::string game_id)
 
 const TextureReplacementTexture* TextureReplacements::GetVRAMWriteReplacement(u32 width, u32 height, const void* pixels)
 {
+  if (m_all_vram_write_sizes_known &&
+      m_vram_write_sizes.find(GetVRAMWriteSizeKey(width, height)) == m_vram_write_sizes.end())
+  {
+    return nullptr;
+  }
+
   const TextureReplacementHash hash = GetVRAMWriteHash(width, height, pixels);
 
   const auto it = m_vram_write_replacements.find(hash);
   if (it == m_vram_write_replacements.end())
-    return nullptr;
+  {
+    const auto pit = m_pack_index.find(hash);
+    return (pit != m_pack_index.end()) ? LoadPackTexture(*pit->second) : nullptr;
+  }
+
+  if (!g_settings.texture_replacements.async_loading)
+    return LoadTexture(it->second.filename);
 
-  return LoadTexture(it->second);
+  return GetOrQueueTexture(it->second.filename);
 }
 
 void TextureReplacements::DumpVRAMWrite(u32 width, u32 height, const void* pixels)
 {
-  std::string filename = GetVRAMWriteDumpFilename(width, height, pixels);
-  if (filename.empty())
+  if (m_game_id.empty())
     return;
 
+  const TextureReplacementHash hash = GetVRAMWriteHash(width, height, pixels);
+  if (m_dumped_hashes.find(hash) != m_dumped_hashes.end())
+    return;
+
+  const size_t data_size = width * height * sizeof(u16);
+  if ((m_queued_dump_bytes.load(std::memory_order_acquire) + data_size) > MAX_QUEUED_DUMP_BYTES)
+  {
+    Log_WarningPrintf("Too many queued VRAM write dumps, skipping %ux%u write", width, height);
+    return;
+  }
+
+  m_dumped_hashes.insert(hash);
+  m_queued_dump_bytes.fetch_add(data_size, std::memory_order_acq_rel);
+
+  if (!m_dump_pool)
+    m_dump_pool = std::make_unique<cb::ThreadPool>(1);
+
+  std::vector<u16> data(width * height);
+  std::memcpy(data.data(), pixels, data_size);
+  m_dump_pool->Schedule([this, hash, width, height, data = std::move(data), dump_directory = GetDumpDirectory(),
+                         force_alpha_channel = g_settings.texture_replacements.dump_vram_write_force_alpha_channel]() {
+    const std::string filename = GetVRAMWriteDumpFilename(dump_directory, hash, width, height);
+    if (!filename.empty())
+      WriteVRAMWriteDump(filename, width, height, data.data(), force_alpha_channel);
+
+    m_queued_dump_bytes.fetch_sub(data.size() * sizeof(u16), std::memory_order_acq_rel);
+  });
+}
+
+void TextureReplacements::WriteVRAMWriteDump(const std::string& filename, u32 width, u32 height, const u16* pixels,
+                                             bool force_alpha_channel)
+{
   Common::RGBA8Image image;
   image.SetSize(width, height);
 
-  const u16* src_pixels = reinterpret_cast<const u16*>(pixels);
+  const u16* src_pixels = pixels;
+  const u32 alpha_mask = force_alpha_channel ? 0xFF000000u : 0u;
 
   for (u32 y = 0; y < height; y++)
   {
     for (u32 x = 0; x < width; x++)
     {
-      image.SetPixel(x, y, VRAMRGBA5551ToRGBA8888(*src_pixels));
+      image.SetPixel(x, y, VRAMRGBA5551ToRGBA8888(*src_pixels) | alpha_mask);
       src_pixels++;
     }
   }
 
-  if (g_settings.texture_replacements.dump_vram_write_force_alpha_channel)
-  {
-    for (u32 y = 0; y < height; y++)
-    {
-      for (u32 x = 0; x < width; x++)
-        image.SetPixel(x, y, image.GetPixel(x, y) | 0xFF000000u);
-    }
-  }
-
   Log_InfoPrintf("Dumping %ux%u VRAM write to '%s'", width, height, filename.c_str());
   if (!image.SaveToFile(filename.c_str()))
     Log_ErrorPrintf("Failed to dump %ux%u VRAM write to '%s'", width, height, filename.c_str());
@@ -113,8 +164,21 @@ void TextureReplacements::DumpVRAMWrite(u32 width, u32 height, const void* pixel
 
 void TextureReplacements::Shutdown()
 {
+  m_dump_pool.reset();
+  m_dumped_hashes.clear();
+
+  // destroying the pool waits for any in-progress loads
+  m_load_pool.reset();
+  m_completed_loads.clear();
+  m_queued_loads.clear();
+  m_failed_loads.clear();
+
   m_texture_cache.clear();
+  m_texture_cache_memory_usage = 0;
   m_vram_write_replacements.clear();
+  m_vram_write_sizes.clear();
+  m_all_vram_write_sizes_known = true;
+  ClosePack();
   m_game_id.clear();
 }
 
@@ -128,23 +192,30 @@ std::string TextureReplacements::GetDumpDirectory() const
   return Path::Combine(EmuFolders::Dumps, Path::Combine("textures", m_game_id));
 }
 
+std::string TextureReplacements::GetPackFilename() const
+{
+  return Path::Combine(GetSourceDirectory(), "textures.pack");
+}
+
 TextureReplacementHash TextureReplacements::GetVRAMWriteHash(u32 width, u32 height, const void* pixels) const
 {
   XXH128_hash_t hash = XXH3_128bits(pixels, width * height * sizeof(u16));
   return {hash.low64, hash.high64};
 }
 
-std::string TextureReplacements::GetVRAMWriteDumpFilename(u32 width, u32 height, const void* pixels) const
+std::string TextureReplacements::GetVRAMWriteDumpFilename(const std::string& dump_directory,
+                                                          const TextureReplacementHash& hash, u32 width, u32 height)
 {
-  if (m_game_id.empty())
-    return {};
+  std::string filename(
+    Path::Combine(dump_directory, fmt::format("vram-write-{}-{}x{}.png", hash.ToString(), width, height)));
 
-  const TextureReplacementHash hash = GetVRAMWriteHash(width, height, pixels);
-  const std::string dump_directory(GetDumpDirectory());
-  std::string filename(Path::Combine(dump_directory, fmt::format("vram-write-{}.png", hash.ToString())));
-
-  if (FileSystem::FileExists(filename.c_str()))
+  // don't re-dump writes which were dumped before the size was included in the name
+  if (FileSystem::FileExists(filename.c_str()) ||
+      FileSystem::FileExists(
+        Path::Combine(dump_directory, fmt::format("vram-write-{}.png", hash.ToString())).c_str()))
+  {
     return {};
+  }
 
   if (!FileSystem::EnsureDirectoryExists(dump_directory.c_str(), false))
     return {};
@@ -154,26 +225,43 @@ std::string TextureReplacements::GetVRAMWriteDumpFilename(u32 width, u32 height,
 
 void TextureReplacements::Reload()
 {
+  // the game may have changed, so finish writing any dumps for the previous one
+  m_dump_pool.reset();
+  m_dumped_hashes.clear();
+
+  WaitForAsyncLoads();
+  m_failed_loads.clear();
   m_vram_write_replacements.clear();
+  m_vram_write_sizes.clear();
+  m_all_vram_write_sizes_known = true;
+  ClosePack();
 
-  if (g_settings.texture_replacements.AnyReplacementsEnabled())
+  if (g_settings.texture_replacements.AnyReplacementsEnabled() && !m_game_id.empty())
+  {
+    OpenPack();
     FindTextures(GetSourceDirectory());
+  }
 
   if (g_settings.texture_replacements.preload_textures)
     PreloadTextures();
 
   PurgeUnreferencedTexturesFromCache();
+
+  // the budget may have changed
+  EvictTexturesFromCache({});
 }
 
 void TextureReplacements::PurgeUnreferencedTexturesFromCache()
 {
   TextureCache old_map = std::move(m_texture_cache);
+  m_texture_cache_memory_usage = 0;
   for (const auto& it : m_vram_write_replacements)
   {
-    auto it2 = old_map.find(it.second);
+    auto it2 = old_map.find(it.second.filename);
     if (it2 != old_map.end())
     {
-      m_texture_cache[it.second] = std::move(it2->second);
+      m_texture_cache_memory_usage += GetTextureMemoryUsage(it2->second.texture);
+      m_texture_cache[it.second.filename] = std::move(it2->second);
       old_map.erase(it2);
     }
   }
@@ -181,7 +269,7 @@ void TextureReplacements::PurgeUnreferencedTexturesFromCache()
 
 bool TextureReplacements::ParseReplacementFilename(const std::string& filename,
                                                    TextureReplacementHash* replacement_hash,
-                                                   ReplacmentType* replacement_type)
+                                                   ReplacmentType* replacement_type, u32* vram_write_size)
 {
   const char* extension = std::strrchr(filename.c_str(), '.');
   const char* title = std::strrchr(filename.c_str(), '/');
@@ -208,7 +296,28 @@ bool TextureReplacements::ParseReplacementFilename(const std::string& filename,
     return false;
   }
 
-  if (!replacement_hash->ParseString(std::string_view(hashpart, static_cast<size_t>(extension - hashpart))))
+  // optionally followed by the size of the write, i.e. vram-write-<hash>-<width>x<height>
+  std::string_view hash_sv(hashpart, static_cast<size_t>(extension - hashpart));
+  *vram_write_size = 0;
+  if (hash_sv.length() > 32 && hash_sv[32] == '-')
+  {
+    const std::string_view size_sv = hash_sv.substr(33);
+    const std::string_view::size_type xpos = size_sv.find('x');
+    const std::optional<u32> width =
+      (xpos != std::string_view::npos) ? StringUtil::FromChars<u32>(size_sv.substr(0, xpos)) : std::nullopt;
+    const std::optional<u32> height =
+      (xpos != std::string_view::npos) ? StringUtil::FromChars<u32>(size_sv.substr(xpos + 1)) : std::nullopt;
+    if (!width.has_value() || !height.has_value() || width.value() == 0 || width.value() > VRAM_WIDTH ||
+        height.value() == 0 || height.value() > VRAM_HEIGHT)
+    {
+      return false;
+    }
+
+    *vram_write_size = GetVRAMWriteSizeKey(width.value(), height.value());
+    hash_sv = hash_sv.substr(0, 32);
+  }
+
+  if (!replacement_hash->ParseString(hash_sv))
     return false;
 
   extension++;
@@ -238,7 +347,8 @@ void TextureReplacements::FindTextures(const std::string& dir)
 
     TextureReplacementHash hash;
     ReplacmentType type;
-    if (!ParseReplacementFilename(fd.FileName, &hash, &type))
+    u32 vram_write_size;
+    if (!ParseReplacementFilename(fd.FileName, &hash, &type, &vram_write_size))
       continue;
 
     switch (type)
@@ -248,11 +358,13 @@ void TextureReplacements::FindTextures(const std::string& dir)
         auto it = m_vram_write_replacements.find(hash);
         if (it != m_vram_write_replacements.end())
         {
-          Log_WarningPrintf("Duplicate VRAM write replacement: '%s' and '%s'", it->second.c_str(), fd.FileName.c_str());
+          Log_WarningPrintf("Duplicate VRAM write replacement: '%s' and '%s'", it->second.filename.c_str(),
+                            fd.FileName.c_str());
           continue;
         }
 
-        m_vram_write_replacements.emplace(hash, std::move(fd.FileName));
+        AddVRAMWriteSize(vram_write_size);
+        m_vram_write_replacements.emplace(hash, VRAMWriteReplacement{std::move(fd.FileName), vram_write_size});
       }
       break;
     }
@@ -265,7 +377,10 @@ const TextureReplacementTexture* TextureReplacements::LoadTexture(const std::str
 {
   auto it = m_texture_cache.find(filename);
   if (it != m_texture_cache.end())
-    return &it->second;
+  {
+    it->second.last_access = ++m_texture_cache_counter;
+    return &it->second.texture;
+  }
 
   Common::RGBA8Image image;
   if (!image.LoadFromFile(filename.c_str()))
@@ -275,8 +390,295 @@ const TextureReplacementTexture* TextureReplacements::LoadTexture(const std::str
   }
 
   Log_InfoPrintf("Loaded '%s': %ux%u", filename.c_str(), image.GetWidth(), image.GetHeight());
-  it = m_texture_cache.emplace(filename, std::move(image)).first;
-  return &it->second;
+  return InsertTextureIntoCache(filename, std::move(image));
+}
+
+const TextureReplacementTexture* TextureReplacements::GetOrQueueTexture(const std::string& filename)
+{
+  ProcessCompletedLoads();
+
+  auto it = m_texture_cache.find(filename);
+  if (it != m_texture_cache.end())
+  {
+    it->second.last_access = ++m_texture_cache_counter;
+    return &it->second.texture;
+  }
+
+  // the original VRAM write is used until the texture has been decoded
+  if (m_queued_loads.find(filename) != m_queued_loads.end() || m_failed_loads.find(filename) != m_failed_loads.end())
+    return nullptr;
+
+  if (!m_load_pool)
+    m_load_pool = std::make_unique<cb::ThreadPool>(ASYNC_LOAD_THREADS);
+
+  m_queued_loads.insert(filename);
+  m_load_pool->Schedule([this, filename]() mutable {
+    Common::RGBA8Image image;
+    if (!image.LoadFromFile(filename.c_str()))
+      image.Invalidate();
+
+    std::unique_lock lock(m_completed_loads_mutex);
+    m_completed_loads.emplace_back(std::move(filename), std::move(image));
+  });
+
+  return nullptr;
+}
+
+void TextureReplacements::ProcessCompletedLoads()
+{
+  if (m_queued_loads.empty())
+    return;
+
+  CompletedLoadList completed;
+  {
+    std::unique_lock lock(m_completed_loads_mutex);
+    completed.swap(m_completed_loads);
+  }
+
+  for (auto& [filename, image] : completed)
+  {
+    m_queued_loads.erase(filename);
+    if (!image.IsValid())
+    {
+      Log_ErrorPrintf("Failed to load '%s'", filename.c_str());
+      m_failed_loads.insert(std::move(filename));
+      continue;
+    }
+
+    Log_InfoPrintf("Loaded '%s': %ux%u", filename.c_str(), image.GetWidth(), image.GetHeight());
+    InsertTextureIntoCache(filename, std::move(image));
+  }
+}
+
+void TextureReplacements::WaitForAsyncLoads()
+{
+  // ThreadPool::Wait() only waits for the queue to drain, destroying the pool also waits for running loads
+  m_load_pool.reset();
+  ProcessCompletedLoads();
+}
+
+const TextureReplacementTexture* TextureReplacements::InsertTextureIntoCache(const std::string& filename,
+                                                                             TextureReplacementTexture texture)
+{
+  auto it = m_texture_cache.find(filename);
+  if (it != m_texture_cache.end())
+  {
+    m_texture_cache_memory_usage -= GetTextureMemoryUsage(it->second.texture);
+    it->second.texture = std::move(texture);
+  }
+  else
+  {
+    it = m_texture_cache.emplace(filename, CachedTexture{std::move(texture), 0}).first;
+  }
+
+  it->second.last_access = ++m_texture_cache_counter;
+  m_texture_cache_memory_usage += GetTextureMemoryUsage(it->second.texture);
+  EvictTexturesFromCache(filename);
+  return &it->second.texture;
+}
+
+void TextureReplacements::EvictTexturesFromCache(const std::string& keep_filename)
+{
+  // preloading wants everything resident, so the budget doesn't apply
+  const u32 max_size_mb = g_settings.texture_replacements.max_cache_size_mb;
+  if (max_size_mb == 0 || g_settings.texture_replacements.preload_textures)
+    return;
+
+  const size_t max_size = static_cast<size_t>(max_size_mb) * 1048576u;
+  while (m_texture_cache_memory_usage > max_size)
+  {
+    auto lowest = m_texture_cache.end();
+    for (auto it = m_texture_cache.begin(); it != m_texture_cache.end(); ++it)
+    {
+      if (it->first != keep_filename &&
+          (lowest == m_texture_cache.end() || it->second.last_access < lowest->second.last_access))
+      {
+        lowest = it;
+      }
+    }
+    if (lowest == m_texture_cache.end())
+      break;
+
+    Log_DevPrintf("Evicting '%s' from replacement texture cache", lowest->first.c_str());
+    m_texture_cache_memory_usage -= GetTextureMemoryUsage(lowest->second.texture);
+    m_texture_cache.erase(lowest);
+  }
+}
+
+void TextureReplacements::AddVRAMWriteSize(u32 vram_write_size)
+{
+  if (vram_write_size != 0)
+    m_vram_write_sizes.insert(vram_write_size);
+  else
+    m_all_vram_write_sizes_known = false;
+}
+
+bool TextureReplacements::OpenPack()
+{
+  const std::string filename = GetPackFilename();
+  m_pack_file = FileSystem::OpenCFile(filename.c_str(), "rb");
+  if (!m_pack_file)
+    return false;
+
+  const s64 size = FileSystem::FSize64(m_pack_file);
+  if (size < static_cast<s64>(sizeof(PackHeader)) ||
+      !(m_pack_data = static_cast<const u8*>(FileSystem::MapCFile(m_pack_file, static_cast<size_t>(size)))))
+  {
+    Log_ErrorPrintf("Failed to map texture pack '%s'", filename.c_str());
+    ClosePack();
+    return false;
+  }
+
+  m_pack_size = static_cast<size_t>(size);
+
+  PackHeader header;
+  std::memcpy(&header, m_pack_data, sizeof(header));
+  if (header.magic != PACK_MAGIC || header.version != PACK_VERSION ||
+      (sizeof(PackHeader) + static_cast<u64>(header.num_entries) * sizeof(PackIndexEntry)) > m_pack_size)
+  {
+    Log_ErrorPrintf("Texture pack '%s' is invalid or from a different version", filename.c_str());
+    ClosePack();
+    return false;
+  }
+
+  const PackIndexEntry* entries = reinterpret_cast<const PackIndexEntry*>(m_pack_data + sizeof(PackHeader));
+  for (u32 i = 0; i < header.num_entries; i++)
+  {
+    const PackIndexEntry& entry = entries[i];
+    const u64 data_size = static_cast<u64>(entry.width) * entry.height * sizeof(u32);
+    if (entry.format != PackTextureFormat::RGBA8 || entry.width == 0 || entry.height == 0 ||
+        entry.data_offset > m_pack_size || data_size > (m_pack_size - entry.data_offset))
+    {
+      Log_WarningPrintf("Skipping invalid entry %u in texture pack '%s'", i, filename.c_str());
+      continue;
+    }
+
+    AddVRAMWriteSize(entry.vram_write_size);
+    m_pack_index.emplace(TextureReplacementHash{entry.hash_low, entry.hash_high}, &entry);
+  }
+
+  Log_InfoPrintf("Found %zu replacement textures in pack '%s'", m_pack_index.size(), filename.c_str());
+  return true;
+}
+
+void TextureReplacements::ClosePack()
+{
+  m_pack_index.clear();
+  m_pack_texture.Invalidate();
+  FileSystem::UnmapCFile(m_pack_data, m_pack_size);
+  m_pack_data = nullptr;
+  m_pack_size = 0;
+  if (m_pack_file)
+  {
+    std::fclose(m_pack_file);
+    m_pack_file = nullptr;
+  }
+}
+
+const TextureReplacementTexture* TextureReplacements::LoadPackTexture(const PackIndexEntry& entry)
+{
+  // only valid until the next call, the caller uploads it immediately
+  m_pack_texture.SetPixels(entry.width, entry.height, reinterpret_cast<const u32*>(m_pack_data + entry.data_offset));
+  return &m_pack_texture;
+}
+
+bool TextureReplacements::BuildPack(std::string* out_filename)
+{
+  if (m_game_id.empty() || (m_vram_write_replacements.empty() && m_pack_index.empty()))
+  {
+    Log_ErrorPrintf("No replacement textures to pack");
+    return false;
+  }
+
+  // sorted by hash, so rebuilding the same textures produces the same pack
+  std::vector<std::pair<TextureReplacementHash, const VRAMWriteReplacement*>> loose_textures;
+  loose_textures.reserve(m_vram_write_replacements.size());
+  for (const auto& it : m_vram_write_replacements)
+    loose_textures.emplace_back(it.first, &it.second);
+  std::vector<std::pair<TextureReplacementHash, const PackIndexEntry*>> pack_textures;
+  for (const auto& it : m_pack_index)
+  {
+    if (m_vram_write_replacements.find(it.first) == m_vram_write_replacements.end())
+      pack_textures.emplace_back(it.first, it.second);
+  }
+  std::sort(loose_textures.begin(), loose_textures.end());
+  std::sort(pack_textures.begin(), pack_textures.end());
+
+  const std::string filename = GetPackFilename();
+  const std::string temp_filename = filename + ".tmp";
+  FileSystem::ManagedCFilePtr fp = FileSystem::OpenManagedCFile(temp_filename.c_str(), "wb");
+  if (!fp)
+  {
+    Log_ErrorPrintf("Failed to open '%s' for writing", temp_filename.c_str());
+    return false;
+  }
+
+  // texture data follows the index, which is written once we know which textures loaded
+  const u32 max_entries = static_cast<u32>(loose_textures.size() + pack_textures.size());
+  std::vector<PackIndexEntry> entries;
+  entries.reserve(max_entries);
+  u64 data_offset = sizeof(PackHeader) + static_cast<u64>(max_entries) * sizeof(PackIndexEntry);
+  bool result = (FileSystem::FSeek64(fp.get(), static_cast<s64>(data_offset), SEEK_SET) == 0);
+
+  const auto write_texture = [&fp, &entries, &data_offset, &result](const TextureReplacementHash& hash,
+                                                                     u32 vram_write_size, u32 width, u32 height,
+                                                                     const void* pixels) {
+    const size_t data_size = static_cast<size_t>(width) * height * sizeof(u32);
+    if (!result || std::fwrite(pixels, data_size, 1, fp.get()) != 1)
+    {
+      result = false;
+      return;
+    }
+
+    entries.push_back(
+      PackIndexEntry{hash.low, hash.high, data_offset, width, height, PackTextureFormat::RGBA8, vram_write_size});
+    data_offset += data_size;
+  };
+
+  for (const auto& [hash, replacement] : loose_textures)
+  {
+    Common::RGBA8Image image;
+    if (!image.LoadFromFile(replacement->filename.c_str()))
+    {
+      Log_WarningPrintf("Failed to load '%s', not adding to pack", replacement->filename.c_str());
+      continue;
+    }
+
+    write_texture(hash, replacement->vram_write_size, image.GetWidth(), image.GetHeight(), image.GetPixels());
+  }
+  for (const auto& [hash, entry] : pack_textures)
+    write_texture(hash, entry->vram_write_size, entry->width, entry->height, m_pack_data + entry->data_offset);
+
+  const PackHeader header{PACK_MAGIC, PACK_VERSION, static_cast<u32>(entries.size()), 0};
+  if (!result || FileSystem::FSeek64(fp.get(), 0, SEEK_SET) != 0 ||
+      std::fwrite(&header, sizeof(header), 1, fp.get()) != 1 ||
+      (!entries.empty() && std::fwrite(entries.data(), sizeof(PackIndexEntry), entries.size(), fp.get()) !=
+                             entries.size()) ||
+      std::fflush(fp.get()) != 0)
+  {
+    Log_ErrorPrintf("Failed to write texture pack '%s'", temp_filename.c_str());
+    fp.reset();
+    FileSystem::DeleteFile(temp_filename.c_str());
+    return false;
+  }
+  fp.reset();
+
+  // the old pack has to be unmapped before it can be replaced
+  ClosePack();
+  if (!FileSystem::RenamePath(temp_filename.c_str(), filename.c_str()))
+  {
+    Log_ErrorPrintf("Failed to rename '%s' to '%s'", temp_filename.c_str(), filename.c_str());
+    FileSystem::DeleteFile(temp_filename.c_str());
+    OpenPack();
+    return false;
+  }
+
+  Log_InfoPrintf("Wrote %zu textures to '%s'", entries.size(), filename.c_str());
+  OpenPack();
+  if (out_filename)
+    *out_filename = filename;
+
+  return true;
 }
 
 void TextureReplacements::PreloadTextures()
@@ -299,7 +701,7 @@ void TextureReplacements::PreloadTextures()
   {
     UPDATE_PROGRESS();
 
-    LoadTexture(it.second);
+    LoadTexture(it.second.filename);
     num_textures_loaded++;
   }
 
@@ -2,11 +2,20 @@
 #include "common/hash_combine.h"
 #include "common/image.h"
 #include "types.h"
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+namespace cb {
+class ThreadPool;
+}
+
 struct TextureReplacementHash
 {
   u64 low;
@@ -54,37 +63,127 @@ public:
   const TextureReplacementTexture* GetVRAMWriteReplacement(u32 width, u32 height, const void* pixels);
   void DumpVRAMWrite(u32 width, u32 height, const void* pixels);
 
+  /// Writes the current game's replacement textures to a single pack file, which can be loaded without decoding.
+  /// Loose files take precedence over textures already in the pack.
+  bool BuildPack(std::string* out_filename);
+
   void Shutdown();
 
 private:
+  static constexpr u32 PACK_MAGIC = 0x50545344; // DSTP
+  static constexpr u32 PACK_VERSION = 2;
+
+  enum class PackTextureFormat : u32
+  {
+    RGBA8
+  };
+
+  struct PackHeader
+  {
+    u32 magic;
+    u32 version;
+    u32 num_entries;
+    u32 reserved;
+  };
+
+  struct PackIndexEntry
+  {
+    u64 hash_low;
+    u64 hash_high;
+    u64 data_offset;
+    u32 width;
+    u32 height;
+    PackTextureFormat format;
+    u32 vram_write_size; // see GetVRAMWriteSizeKey(), zero if unknown
+  };
+
+  struct VRAMWriteReplacement
+  {
+    std::string filename;
+    u32 vram_write_size; // see GetVRAMWriteSizeKey(), zero if unknown
+  };
+
   struct ReplacementHashMapHash
   {
     size_t operator()(const TextureReplacementHash& hash);
   };
 
-  using VRAMWriteReplacementMap = std::unordered_map<TextureReplacementHash, std::string>;
-  using TextureCache = std::unordered_map<std::string, TextureReplacementTexture>;
+  struct CachedTexture
+  {
+    TextureReplacementTexture texture;
+    u64 last_access;
+  };
+
+  using VRAMWriteReplacementMap = std::unordered_map<TextureReplacementHash, VRAMWriteReplacement>;
+  using TextureCache = std::unordered_map<std::string, CachedTexture>;
+  using CompletedLoadList = std::vector<std::pair<std::string, TextureReplacementTexture>>;
+  using PackIndex = std::unordered_map<TextureReplacementHash, const PackIndexEntry*>;
+
+  static constexpr u32 GetVRAMWriteSizeKey(u32 width, u32 height) { return (width << 16) | height; }
 
   static bool ParseReplacementFilename(const std::string& filename, TextureReplacementHash* replacement_hash,
-                                       ReplacmentType* replacement_type);
+                                       ReplacmentType* replacement_type, u32* vram_write_size);
 
   std::string GetSourceDirectory() const;
   std::string GetDumpDirectory() const;
+  std::string GetPackFilename() const;
 
   TextureReplacementHash GetVRAMWriteHash(u32 width, u32 height, const void* pixels) const;
-  std::string GetVRAMWriteDumpFilename(u32 width, u32 height, const void* pixels) const;
+  static std::string GetVRAMWriteDumpFilename(const std::string& dump_directory, const TextureReplacementHash& hash,
+                                              u32 width, u32 height);
+  static void WriteVRAMWriteDump(const std::string& filename, u32 width, u32 height, const u16* pixels,
+                                 bool force_alpha_channel);
 
   void FindTextures(const std::string& dir);
+  void AddVRAMWriteSize(u32 vram_write_size);
+
+  bool OpenPack();
+  void ClosePack();
+  const TextureReplacementTexture* LoadPackTexture(const PackIndexEntry& entry);
 
   const TextureReplacementTexture* LoadTexture(const std::string& filename);
   void PreloadTextures();
   void PurgeUnreferencedTexturesFromCache();
 
+  /// Returns the texture if it is already loaded, otherwise queues it to be decoded on a worker thread.
+  const TextureReplacementTexture* GetOrQueueTexture(const std::string& filename);
+  void ProcessCompletedLoads();
+  void WaitForAsyncLoads();
+
+  const TextureReplacementTexture* InsertTextureIntoCache(const std::string& filename,
+                                                          TextureReplacementTexture texture);
+  void EvictTexturesFromCache(const std::string& keep_filename);
+
   std::string m_game_id;
 
   TextureCache m_texture_cache;
+  u64 m_texture_cache_counter = 0;
+  size_t m_texture_cache_memory_usage = 0;
+
+  std::unique_ptr<cb::ThreadPool> m_load_pool;
+  std::unordered_set<std::string> m_queued_loads;
+  std::unordered_set<std::string> m_failed_loads;
+  std::mutex m_completed_loads_mutex;
+  CompletedLoadList m_completed_loads;
+
+  // dumps are encoded and written on a single worker, writes already queued or dumped are skipped by hash
+  std::unique_ptr<cb::ThreadPool> m_dump_pool;
+  std::unordered_set<TextureReplacementHash> m_dumped_hashes;
+  std::atomic<size_t> m_queued_dump_bytes{0};
 
   VRAMWriteReplacementMap m_vram_write_replacements;
+
+  // Sizes of the VRAM writes which have replacements, so that uploads of other sizes can skip hashing. Only usable
+  // when every replacement's size is known, older dumps don't include it in the filename.
+  std::unordered_set<u32> m_vram_write_sizes;
+  bool m_all_vram_write_sizes_known = true;
+
+  // textures in the pack are copied out of the mapping on use, rather than being cached
+  std::FILE* m_pack_file = nullptr;
+  const u8* m_pack_data = nullptr;
+  size_t m_pack_size = 0;
+  PackIndex m_pack_index;
+  TextureReplacementTexture m_pack_texture;
 };
 
 extern TextureReplacements g_texture_replacements;
\ No newline at end of file
@@ -1,19 +1,33 @@
 #include "timing_event.h"
 #include "common/assert.h"
 #include "common/log.h"
+#include "common/profiler.h"
 #include "cpu_core.h"
 #include "cpu_core_private.h"
+#include "host_time_accounting.h"
 #include "system.h"
 #include "util/state_wrapper.h"
+#include <algorithm>
+#include <utility>
 Log_SetChannel(TimingEvents);
 
 namespace TimingEvents {
 
-static TimingEvent* s_active_events_head;
-static TimingEvent* s_active_events_tail;
+static void AddActiveEvent(TimingEvent* event);
+static void RemoveActiveEvent(TimingEvent* event);
+static void UpdateEventPosition(TimingEvent* event);
+static void UpdateNextEventDowncount();
+
+// Active events, as a binary min-heap ordered by next run time. Events which are due on the same tick run in the order
+// they were scheduled, so the execution order only depends on the sequence of schedule calls.
+static std::vector<TimingEvent*> s_active_events;
 static TimingEvent* s_current_event = nullptr;
-static u32 s_active_event_count = 0;
+static TickCount s_next_event_downcount = 0;
 static u32 s_global_tick_counter = 0;
+static u32 s_schedule_order_counter = 0;
+
+// every event which has been created, including inactive ones
+static std::vector<TimingEvent*> s_all_events;
 
 u32 GetGlobalTickCounter()
 {
@@ -32,7 +46,13 @@ void Reset()
 
 void Shutdown()
 {
-  Assert(s_active_event_count == 0);
+  Assert(s_active_events.empty());
+}
+
+void EnumerateEvents(const std::function<void(TimingEvent*)>& callback)
+{
+  for (TimingEvent* event : s_all_events)
+    callback(event);
 }
 
 std::unique_ptr<TimingEvent> CreateTimingEvent(std::string name, TickCount period, TickCount interval,
@@ -50,205 +70,140 @@ void UpdateCPUDowncount()
 {
   if (!CPU::g_state.frame_done && (!CPU::HasPendingInterrupt() || CPU::g_using_interpreter))
   {
-    CPU::g_state.downcount = s_active_events_head->GetDowncount();
+    CPU::g_state.downcount = s_next_event_downcount;
   }
 }
 
-TimingEvent** GetHeadEventPtr()
+const TickCount* GetNextEventDowncountPtr()
 {
-  return &s_active_events_head;
+  return &s_next_event_downcount;
 }
 
-static void SortEvent(TimingEvent* event)
+ALWAYS_INLINE static bool IsEventEarlier(const TimingEvent* lhs, const TimingEvent* rhs)
 {
-  const TickCount event_downcount = event->m_downcount;
+  // Compare relative to each other, since the tick counter wraps.
+  const s32 diff = static_cast<s32>(lhs->m_next_run_time - rhs->m_next_run_time);
+  return (diff < 0 || (diff == 0 && static_cast<s32>(lhs->m_schedule_order - rhs->m_schedule_order) < 0));
+}
 
-  if (event->prev && event->prev->m_downcount > event_downcount)
-  {
-    // move backwards
-    TimingEvent* current = event->prev;
-    while (current && current->m_downcount > event_downcount)
-      current = current->prev;
-
-    // unlink
-    if (event->prev)
-      event->prev->next = event->next;
-    else
-      s_active_events_head = event->next;
-    if (event->next)
-      event->next->prev = event->prev;
-    else
-      s_active_events_tail = event->prev;
+ALWAYS_INLINE static void SetHeapEntry(u32 index, TimingEvent* event)
+{
+  s_active_events[index] = event;
+  event->m_heap_index = index;
+}
 
-    // insert after current
-    if (current)
-    {
-      event->next = current->next;
-      if (current->next)
-        current->next->prev = event;
-      else
-        s_active_events_tail = event;
-
-      event->prev = current;
-      current->next = event;
-    }
-    else
-    {
-      // insert at front
-      DebugAssert(s_active_events_head);
-      s_active_events_head->prev = event;
-      event->prev = nullptr;
-      event->next = s_active_events_head;
-      s_active_events_head = event;
-      UpdateCPUDowncount();
-    }
-  }
-  else if (event->next && event_downcount > event->next->m_downcount)
+static void SiftUp(TimingEvent* event)
+{
+  u32 index = event->m_heap_index;
+  while (index > 0)
   {
-    // move forwards
-    TimingEvent* current = event->next;
-    while (current && event_downcount > current->m_downcount)
-      current = current->next;
-
-    // unlink
-    if (event->prev)
-      event->prev->next = event->next;
-    else
-      s_active_events_head = event->next;
-    if (event->next)
-      event->next->prev = event->prev;
-    else
-      s_active_events_tail = event->prev;
+    const u32 parent = (index - 1) / 2;
+    TimingEvent* parent_event = s_active_events[parent];
+    if (!IsEventEarlier(event, parent_event))
+      break;
 
-    // insert before current
-    if (current)
-    {
-      event->next = current;
-      event->prev = current->prev;
+    SetHeapEntry(index, parent_event);
+    index = parent;
+  }
 
-      if (current->prev)
-        current->prev->next = event;
-      else
-        s_active_events_head = event;
+  SetHeapEntry(index, event);
+}
 
-      current->prev = event;
-    }
-    else
-    {
-      // insert at back
-      DebugAssert(s_active_events_tail);
-      s_active_events_tail->next = event;
-      event->next = nullptr;
-      event->prev = s_active_events_tail;
-      s_active_events_tail = event;
-    }
+static void SiftDown(TimingEvent* event)
+{
+  const u32 count = static_cast<u32>(s_active_events.size());
+  u32 index = event->m_heap_index;
+  for (;;)
+  {
+    const u32 left = index * 2 + 1;
+    if (left >= count)
+      break;
+
+    const u32 right = left + 1;
+    const u32 child = (right < count && IsEventEarlier(s_active_events[right], s_active_events[left])) ? right : left;
+    TimingEvent* child_event = s_active_events[child];
+    if (!IsEventEarlier(child_event, event))
+      break;
+
+    SetHeapEntry(index, child_event);
+    index = child;
   }
+
+  SetHeapEntry(index, event);
 }
 
-static void AddActiveEvent(TimingEvent* event)
+void UpdateNextEventDowncount()
 {
-  DebugAssert(!event->prev && !event->next);
-  s_active_event_count++;
+  const TickCount downcount =
+    s_active_events.empty() ? 0 :
+                              static_cast<TickCount>(s_active_events.front()->m_next_run_time - s_global_tick_counter);
+  s_next_event_downcount = downcount;
+  UpdateCPUDowncount();
+}
 
-  TimingEvent* current = nullptr;
-  TimingEvent* next = s_active_events_head;
-  while (next && event->m_downcount > next->m_downcount)
-  {
-    current = next;
-    next = next->next;
-  }
+void UpdateEventPosition(TimingEvent* event)
+{
+  // The event's time changed, so it goes behind anything else already due on the same tick.
+  event->m_schedule_order = s_schedule_order_counter++;
 
-  if (!next)
-  {
-    // new tail
-    event->prev = s_active_events_tail;
-    if (s_active_events_tail)
-    {
-      s_active_events_tail->next = event;
-      s_active_events_tail = event;
-    }
-    else
-    {
-      // first event
-      s_active_events_tail = event;
-      s_active_events_head = event;
-      UpdateCPUDowncount();
-    }
-  }
-  else if (!current)
-  {
-    // new head
-    event->next = s_active_events_head;
-    s_active_events_head->prev = event;
-    s_active_events_head = event;
-    UpdateCPUDowncount();
-  }
+  const u32 index = event->m_heap_index;
+  if (index > 0 && IsEventEarlier(event, s_active_events[(index - 1) / 2]))
+    SiftUp(event);
   else
-  {
-    // inbetween current < event > next
-    event->prev = current;
-    event->next = next;
-    current->next = event;
-    next->prev = event;
-  }
+    SiftDown(event);
+
+  UpdateNextEventDowncount();
 }
 
-static void RemoveActiveEvent(TimingEvent* event)
+void AddActiveEvent(TimingEvent* event)
 {
-  DebugAssert(s_active_event_count > 0);
+  event->m_schedule_order = s_schedule_order_counter++;
+  event->m_heap_index = static_cast<u32>(s_active_events.size());
+  s_active_events.push_back(event);
+  SiftUp(event);
+  UpdateNextEventDowncount();
+}
 
-  if (event->next)
-  {
-    event->next->prev = event->prev;
-  }
-  else
-  {
-    s_active_events_tail = event->prev;
-  }
+void RemoveActiveEvent(TimingEvent* event)
+{
+  DebugAssert(!s_active_events.empty() && s_active_events[event->m_heap_index] == event);
 
-  if (event->prev)
+  TimingEvent* last_event = s_active_events.back();
+  s_active_events.pop_back();
+  if (last_event != event)
   {
-    event->prev->next = event->next;
-  }
-  else
-  {
-    s_active_events_head = event->next;
-    if (s_active_events_head)
-      UpdateCPUDowncount();
+    // move the last event into the hole, then restore the heap property around it
+    const u32 index = event->m_heap_index;
+    SetHeapEntry(index, last_event);
+    if (index > 0 && IsEventEarlier(last_event, s_active_events[(index - 1) / 2]))
+      SiftUp(last_event);
+    else
+      SiftDown(last_event);
   }
 
-  event->prev = nullptr;
-  event->next = nullptr;
+  if (!s_active_events.empty())
+    UpdateNextEventDowncount();
+}
 
-  s_active_event_count--;
+static void GetSortedActiveEvents(std::vector<TimingEvent*>* events)
+{
+  *events = s_active_events;
+  std::sort(events->begin(), events->end(), IsEventEarlier);
 }
 
 static void SortEvents()
 {
   std::vector<TimingEvent*> events;
-  events.reserve(s_active_event_count);
-
-  TimingEvent* next = s_active_events_head;
-  while (next)
-  {
-    TimingEvent* current = next;
-    events.push_back(current);
-    next = current->next;
-    current->prev = nullptr;
-    current->next = nullptr;
-  }
-
-  s_active_events_head = nullptr;
-  s_active_events_tail = nullptr;
-  s_active_event_count = 0;
+  GetSortedActiveEvents(&events);
 
+  s_active_events.clear();
   for (TimingEvent* event : events)
     AddActiveEvent(event);
 }
 
 static TimingEvent* FindActiveEvent(const char* name)
 {
-  for (TimingEvent* event = s_active_events_head; event; event = event->next)
+  for (TimingEvent* event : s_active_events)
   {
     if (event->GetName().compare(name) == 0)
       return event;
@@ -259,41 +214,39 @@ static TimingEvent* FindActiveEvent(const char* name)
 
 void RunEvents()
 {
+  PROFILE_SCOPE("TimingEvents::RunEvents");
   DebugAssert(!s_current_event);
 
   TickCount pending_ticks = CPU::GetPendingTicks();
   CPU::ResetPendingTicks();
   while (pending_ticks > 0)
   {
-    const TickCount time = std::min(pending_ticks, s_active_events_head->GetDowncount());
+    const TickCount time = std::min(pending_ticks, s_next_event_downcount);
     s_global_tick_counter += static_cast<u32>(time);
     pending_ticks -= time;
 
-    // Apply downcount to all events.
-    // This will result in a negative downcount for those events which are late.
-    for (TimingEvent* event = s_active_events_head; event; event = event->next)
-    {
-      event->m_downcount -= time;
-      event->m_time_since_last_run += time;
-    }
+    // Events are scheduled in absolute time, so unlike a per-event downcount, nothing needs to be updated for the
+    // events which aren't due yet. Anything which is due now will have a negative downcount if it's late.
+    UpdateNextEventDowncount();
 
     // Now we can actually run the callbacks.
-    while (s_active_events_head->m_downcount <= 0)
+    while (s_next_event_downcount <= 0)
     {
-      // move it to the end, since that'll likely be its new position
-      TimingEvent* event = s_active_events_head;
+      TimingEvent* event = s_active_events.front();
       s_current_event = event;
 
       // Factor late time into the time for the next invocation.
-      const TickCount ticks_late = -event->m_downcount;
-      const TickCount ticks_to_execute = event->m_time_since_last_run;
-      event->m_downcount += event->m_interval;
-      event->m_time_since_last_run = 0;
+      const TickCount ticks_late = -s_next_event_downcount;
+      const TickCount ticks_to_execute = static_cast<TickCount>(s_global_tick_counter - event->m_last_run_time);
+      event->m_next_run_time += static_cast<u32>(event->m_interval);
+      event->m_last_run_time = s_global_tick_counter;
+
+      // Re-sort before the callback, so the heap is valid if the callback schedules other events.
+      UpdateEventPosition(event);
 
       // The cycles_late is only an indicator, it doesn't modify the cycles to execute.
+      HostTimeAccounting::ScopedSection section(&event->m_host_time);
       event->m_callback(event->m_callback_param, ticks_to_execute, ticks_late);
-      if (event->m_active)
-        SortEvent(event);
     }
   }
 
@@ -303,10 +256,30 @@ void RunEvents()
 
 bool DoState(StateWrapper& sw)
 {
+  // Times are absolute, so anything which isn't in the state (e.g. events added since it was made) has to be moved
+  // to the loaded tick counter, keeping its downcount.
+  std::vector<std::pair<TickCount, TickCount>> relative_times;
+  if (sw.IsReading())
+  {
+    relative_times.reserve(s_active_events.size());
+    for (const TimingEvent* event : s_active_events)
+    {
+      relative_times.emplace_back(static_cast<TickCount>(event->m_next_run_time - s_global_tick_counter),
+                                  static_cast<TickCount>(s_global_tick_counter - event->m_last_run_time));
+    }
+  }
+
   sw.Do(&s_global_tick_counter);
 
   if (sw.IsReading())
   {
+    for (size_t i = 0; i < s_active_events.size(); i++)
+    {
+      TimingEvent* event = s_active_events[i];
+      event->m_next_run_time = s_global_tick_counter + static_cast<u32>(relative_times[i].first);
+      event->m_last_run_time = s_global_tick_counter - static_cast<u32>(relative_times[i].second);
+    }
+
     // Load timestamps for the clock events.
     // Any oneshot events should be recreated by the load state method, so we can fix up their times here.
     u32 event_count = 0;
@@ -332,8 +305,8 @@ bool DoState(StateWrapper& sw)
       }
 
       // Using reschedule is safe here since we call sort afterwards.
-      event->m_downcount = downcount;
-      event->m_time_since_last_run = time_since_last_run;
+      event->m_next_run_time = s_global_tick_counter + static_cast<u32>(downcount);
+      event->m_last_run_time = s_global_tick_counter - static_cast<u32>(time_since_last_run);
       event->m_period = period;
       event->m_interval = interval;
     }
@@ -349,19 +322,25 @@ bool DoState(StateWrapper& sw)
   }
   else
   {
+    // Written in execution order, same as the list-based scheduler did.
+    std::vector<TimingEvent*> events;
+    GetSortedActiveEvents(&events);
 
-    sw.Do(&s_active_event_count);
+    u32 event_count = static_cast<u32>(events.size());
+    sw.Do(&event_count);
 
-    for (TimingEvent* event = s_active_events_head; event; event = event->next)
+    for (TimingEvent* event : events)
     {
+      TickCount downcount = event->GetDowncount();
+      TickCount time_since_last_run = static_cast<TickCount>(s_global_tick_counter - event->m_last_run_time);
       sw.Do(&event->m_name);
-      sw.Do(&event->m_downcount);
-      sw.Do(&event->m_time_since_last_run);
+      sw.Do(&downcount);
+      sw.Do(&time_since_last_run);
       sw.Do(&event->m_period);
       sw.Do(&event->m_interval);
     }
 
-    Log_DevPrintf("Wrote %u events to save state.", s_active_event_count);
+    Log_DevPrintf("Wrote %u events to save state.", event_count);
   }
 
   return !sw.HasError();
@@ -374,22 +353,34 @@ TimingEvent::TimingEvent(std::string name, TickCount period, TickCount interval,
   : m_callback(callback), m_callback_param(callback_param), m_downcount(interval), m_time_since_last_run(0),
     m_period(period), m_interval(interval), m_name(std::move(name))
 {
+  TimingEvents::s_all_events.push_back(this);
 }
 
 TimingEvent::~TimingEvent()
 {
   if (m_active)
     TimingEvents::RemoveActiveEvent(this);
+
+  auto iter = std::find(TimingEvents::s_all_events.begin(), TimingEvents::s_all_events.end(), this);
+  DebugAssert(iter != TimingEvents::s_all_events.end());
+  TimingEvents::s_all_events.erase(iter);
+}
+
+TickCount TimingEvent::GetDowncount() const
+{
+  return m_active ? static_cast<TickCount>(m_next_run_time - TimingEvents::s_global_tick_counter) : m_downcount;
 }
 
 TickCount TimingEvent::GetTicksSinceLastExecution() const
 {
-  return CPU::GetPendingTicks() + m_time_since_last_run;
+  const TickCount time_since_last_run =
+    m_active ? static_cast<TickCount>(TimingEvents::s_global_tick_counter - m_last_run_time) : m_time_since_last_run;
+  return CPU::GetPendingTicks() + time_since_last_run;
 }
 
 TickCount TimingEvent::GetTicksUntilNextExecution() const
 {
-  return std::max(m_downcount - CPU::GetPendingTicks(), static_cast<TickCount>(0));
+  return std::max(GetDowncount() - CPU::GetPendingTicks(), static_cast<TickCount>(0));
 }
 
 void TimingEvent::Delay(TickCount ticks)
@@ -400,30 +391,28 @@ void TimingEvent::Delay(TickCount ticks)
     return;
   }
 
-  m_downcount += ticks;
+  m_next_run_time += static_cast<u32>(ticks);
 
   DebugAssert(TimingEvents::s_current_event != this);
-  TimingEvents::SortEvent(this);
+  TimingEvents::UpdateEventPosition(this);
 }
 
 void TimingEvent::Schedule(TickCount ticks)
 {
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  m_downcount = pending_ticks + ticks;
+  const u32 current_time = TimingEvents::s_global_tick_counter + static_cast<u32>(CPU::GetPendingTicks());
+  m_next_run_time = current_time + static_cast<u32>(ticks);
 
   if (!m_active)
   {
     // Event is going active, so we want it to only execute ticks from the current timestamp.
-    m_time_since_last_run = -pending_ticks;
+    m_last_run_time = current_time;
     m_active = true;
     TimingEvents::AddActiveEvent(this);
   }
   else
   {
     // Event is already active, so we leave the time since last run alone, and just modify the downcount.
-    // If this is a call from an IO handler for example, re-sort the event queue.
-    if (TimingEvents::s_current_event != this)
-      TimingEvents::SortEvent(this);
+    TimingEvents::UpdateEventPosition(this);
   }
 }
 
@@ -445,10 +434,9 @@ void TimingEvent::Reset()
   if (!m_active)
     return;
 
-  m_downcount = m_interval;
-  m_time_since_last_run = 0;
-  if (TimingEvents::s_current_event != this)
-    TimingEvents::SortEvent(this);
+  m_next_run_time = TimingEvents::s_global_tick_counter + static_cast<u32>(m_interval);
+  m_last_run_time = TimingEvents::s_global_tick_counter;
+  TimingEvents::UpdateEventPosition(this);
 }
 
 void TimingEvent::InvokeEarly(bool force /* = false */)
@@ -456,18 +444,21 @@ void TimingEvent::InvokeEarly(bool force /* = false */)
   if (!m_active)
     return;
 
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  const TickCount ticks_to_execute = m_time_since_last_run + pending_ticks;
+  const u32 current_time = TimingEvents::s_global_tick_counter + static_cast<u32>(CPU::GetPendingTicks());
+  const TickCount ticks_to_execute = static_cast<TickCount>(current_time - m_last_run_time);
   if ((!force && ticks_to_execute < m_period) || ticks_to_execute <= 0)
     return;
 
-  m_downcount = pending_ticks + m_interval;
-  m_time_since_last_run -= ticks_to_execute;
-  m_callback(m_callback_param, ticks_to_execute, 0);
+  m_next_run_time = current_time + static_cast<u32>(m_interval);
+  m_last_run_time = current_time;
 
-  // Since we've changed the downcount, we need to re-sort the events.
+  // Since we've changed the downcount, we need to re-sort the events. This has to happen before the callback, in case
+  // it schedules anything else.
   DebugAssert(TimingEvents::s_current_event != this);
-  TimingEvents::SortEvent(this);
+  TimingEvents::UpdateEventPosition(this);
+
+  HostTimeAccounting::ScopedSection section(&m_host_time);
+  m_callback(m_callback_param, ticks_to_execute, 0);
 }
 
 void TimingEvent::Activate()
@@ -476,9 +467,9 @@ void TimingEvent::Activate()
     return;
 
   // leave the downcount intact
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  m_downcount += pending_ticks;
-  m_time_since_last_run -= pending_ticks;
+  const u32 current_time = TimingEvents::s_global_tick_counter + static_cast<u32>(CPU::GetPendingTicks());
+  m_next_run_time = current_time + static_cast<u32>(m_downcount);
+  m_last_run_time = current_time - static_cast<u32>(m_time_since_last_run);
 
   m_active = true;
   TimingEvents::AddActiveEvent(this);
@@ -489,9 +480,9 @@ void TimingEvent::Deactivate()
   if (!m_active)
     return;
 
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  m_downcount -= pending_ticks;
-  m_time_since_last_run += pending_ticks;
+  const u32 current_time = TimingEvents::s_global_tick_counter + static_cast<u32>(CPU::GetPendingTicks());
+  m_downcount = static_cast<TickCount>(m_next_run_time - current_time);
+  m_time_since_last_run = static_cast<TickCount>(current_time - m_last_run_time);
 
   m_active = false;
   TimingEvents::RemoveActiveEvent(this);
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 
+#include "common/timer.h"
 #include "types.h"
 
 class StateWrapper;
@@ -24,7 +25,7 @@ public:
   // Returns the number of ticks between each event.
   ALWAYS_INLINE TickCount GetPeriod() const { return m_period; }
   ALWAYS_INLINE TickCount GetInterval() const { return m_interval; }
-  ALWAYS_INLINE TickCount GetDowncount() const { return m_downcount; }
+  TickCount GetDowncount() const;
 
   // Includes pending time.
   TickCount GetTicksSinceLastExecution() const;
@@ -60,18 +61,24 @@ public:
   void SetInterval(TickCount interval) { m_interval = interval; }
   void SetPeriod(TickCount period) { m_period = period; }
 
-  TimingEvent* prev = nullptr;
-  TimingEvent* next = nullptr;
-
   TimingEventCallback m_callback;
   void* m_callback_param;
 
+  // While active, the event is scheduled in absolute global ticks. Inactive events keep the relative values instead,
+  // which are rebased onto the current time when the event is activated again.
+  u32 m_next_run_time = 0;
+  u32 m_last_run_time = 0;
+  u32 m_heap_index = 0;
+  u32 m_schedule_order = 0;
   TickCount m_downcount;
   TickCount m_time_since_last_run;
   TickCount m_period;
   TickCount m_interval;
   bool m_active = false;
 
+  // host time spent in the callback, for the performance overlay
+  Common::Timer::Value m_host_time = 0;
+
   std::string m_name;
 };
 
@@ -87,6 +94,9 @@ void Shutdown();
 std::unique_ptr<TimingEvent> CreateTimingEvent(std::string name, TickCount period, TickCount interval,
                                                TimingEventCallback callback, void* callback_param, bool activate);
 
+/// Calls the function for every event which exists, active or not.
+void EnumerateEvents(const std::function<void(TimingEvent*)>& callback);
+
 /// Serialization.
 bool DoState(StateWrapper& sw);
 
@@ -94,6 +104,7 @@ void RunEvents();
 
 void UpdateCPUDowncount();
 
-TimingEvent** GetHeadEventPtr();
+/// Downcount of the next event to run, updated whenever the schedule changes. Read by the recompiler dispatcher.
+const TickCount* GetNextEventDowncountPtr();
 
 } // namespace TimingEvents
\ No newline at end of file
@@ -88,6 +88,19 @@ enum class GPUDownsampleMode : u8
   Count
 };
 
+enum class GPUTimingSection : u8
+{
+  Batches,
+  VRAMFill,
+  VRAMCopy,
+  VRAMWrite,
+  VRAMReadback,
+  Downsample,
+  Display,
+  PostProcessing,
+  Count
+};
+
 enum class DisplayCropMode : u8
 {
   None,
@@ -117,6 +130,7 @@ enum class AudioBackend : u8
 #endif
 #ifdef _WIN32
   XAudio2,
+  WASAPI,
 #endif
 #ifdef __ANDROID__
   AAudio,
@@ -0,0 +1,457 @@
+#include "chd_writer.h"
+#include "common/assert.h"
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "libchdr/chd.h"
+#include "zlib.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+Log_SetChannel(CHDWriter);
+
+namespace {
+enum : u32
+{
+  V5_HEADER_SIZE = 124,
+  MAP_HEADER_SIZE = 16,
+  MAP_ENTRY_SIZE = 12,
+  METADATA_HEADER_SIZE = 16,
+
+  // hunk map types, see libchdr. only the first codec and uncompressed hunks are used.
+  COMPRESSION_TYPE_0 = 0,
+  COMPRESSION_NONE = 4,
+  NUM_COMPRESSION_TYPES = 16,
+
+  // enough to keep every worker busy while the next batch is read
+  HUNKS_PER_WORKER = 16,
+
+  // the cdzl header is an ECC bitmap (no ECC is stripped, so it's empty), then the compressed size of the sectors
+  CDZL_ECC_BYTES = (CHDWriter::CD_FRAMES_PER_HUNK + 7) / 8,
+  CDZL_HEADER_SIZE = CDZL_ECC_BYTES + 2,
+};
+
+/// MSB-first, the same order libchdr's bitstream reads in.
+class BitWriter
+{
+public:
+  void Write(u32 value, u32 num_bits)
+  {
+    for (u32 i = num_bits; i > 0; i--)
+    {
+      m_accumulator = (m_accumulator << 1) | ((value >> (i - 1)) & 1u);
+      if (++m_num_bits == 8)
+      {
+        m_data.push_back(static_cast<u8>(m_accumulator));
+        m_accumulator = 0;
+        m_num_bits = 0;
+      }
+    }
+  }
+
+  std::vector<u8>& Flush()
+  {
+    if (m_num_bits > 0)
+      Write(0, 8 - m_num_bits);
+
+    return m_data;
+  }
+
+private:
+  std::vector<u8> m_data;
+  u32 m_accumulator = 0;
+  u32 m_num_bits = 0;
+};
+} // namespace
+
+static void PutBE16(u8* dst, u16 value)
+{
+  dst[0] = static_cast<u8>(value >> 8);
+  dst[1] = static_cast<u8>(value);
+}
+
+static void PutBE24(u8* dst, u32 value)
+{
+  dst[0] = static_cast<u8>(value >> 16);
+  dst[1] = static_cast<u8>(value >> 8);
+  dst[2] = static_cast<u8>(value);
+}
+
+static void PutBE32(u8* dst, u32 value)
+{
+  dst[0] = static_cast<u8>(value >> 24);
+  dst[1] = static_cast<u8>(value >> 16);
+  dst[2] = static_cast<u8>(value >> 8);
+  dst[3] = static_cast<u8>(value);
+}
+
+static void PutBE48(u8* dst, u64 value)
+{
+  PutBE16(dst, static_cast<u16>(value >> 32));
+  PutBE32(dst + 2, static_cast<u32>(value));
+}
+
+static void PutBE64(u8* dst, u64 value)
+{
+  PutBE32(dst, static_cast<u32>(value >> 32));
+  PutBE32(dst + 4, static_cast<u32>(value));
+}
+
+// CRC-16/CCITT, which is what CHD uses for hunks and the map
+static u16 ComputeCRC16(const void* data, size_t size)
+{
+  static constexpr auto table = []() {
+    std::array<u16, 256> ret = {};
+    for (u32 i = 0; i < 256; i++)
+    {
+      u16 crc = static_cast<u16>(i << 8);
+      for (u32 bit = 0; bit < 8; bit++)
+        crc = (crc & 0x8000) ? static_cast<u16>((crc << 1) ^ 0x1021) : static_cast<u16>(crc << 1);
+      ret[i] = crc;
+    }
+    return ret;
+  }();
+
+  u16 crc = 0xFFFF;
+  const u8* ptr = static_cast<const u8*>(data);
+  for (size_t i = 0; i < size; i++)
+    crc = static_cast<u16>((crc << 8) ^ table[(crc >> 8) ^ ptr[i]]);
+  return crc;
+}
+
+static bool DeflateRaw(const u8* src, u32 src_size, u8* dst, u32 dst_capacity, int level, u32* out_size)
+{
+  z_stream zs = {};
+  if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+
+  zs.next_in = const_cast<Bytef*>(src);
+  zs.avail_in = src_size;
+  zs.next_out = dst;
+  zs.avail_out = dst_capacity;
+  const int res = deflate(&zs, Z_FINISH);
+  *out_size = static_cast<u32>(zs.total_out);
+  deflateEnd(&zs);
+  return (res == Z_STREAM_END);
+}
+
+static u32 GetBitsForValue(u32 value)
+{
+  u32 bits = 0;
+  while (bits < 32 && (value >> bits) != 0)
+    bits++;
+  return bits;
+}
+
+CHDWriter::CHDWriter(Threading::TaskScheduler& scheduler) : m_scheduler(scheduler), m_group(scheduler) {}
+
+CHDWriter::~CHDWriter()
+{
+  m_group.Cancel();
+  m_group.Wait();
+  if (m_fp)
+    Abort();
+}
+
+bool CHDWriter::Create(const char* path, int compression_level, Common::Error* error)
+{
+  Assert(!m_fp);
+  m_fp = FileSystem::OpenCFile(path, "wb");
+  if (!m_fp)
+  {
+    Log_ErrorPrintf("Failed to create '%s': errno %d", path, errno);
+    if (error)
+      error->SetErrno(errno);
+
+    return false;
+  }
+
+  m_path = path;
+  m_compression_level = compression_level;
+  m_batch_size = m_scheduler.GetWorkerCount() * HUNKS_PER_WORKER;
+  m_filling_hunks.resize(m_batch_size);
+  m_compressing_hunks.resize(m_batch_size);
+  for (u32 i = 0; i < m_batch_size; i++)
+  {
+    m_filling_hunks[i].data.resize(HUNK_SIZE);
+    m_compressing_hunks[i].data.resize(HUNK_SIZE);
+  }
+
+  // the header is rewritten once we have the offsets and hashes
+  const u8 placeholder[V5_HEADER_SIZE] = {};
+  m_next_hunk_offset = V5_HEADER_SIZE;
+  return WriteBytes(placeholder, sizeof(placeholder), error);
+}
+
+void CHDWriter::AddMetadata(u32 tag, std::string value)
+{
+  m_metadata.push_back(Metadata{tag, std::move(value)});
+}
+
+bool CHDWriter::WriteFrame(const void* sector, const void* subcode, Common::Error* error)
+{
+  Hunk& hunk = m_filling_hunks[m_num_filling_hunks];
+  u8* frame = &hunk.data[hunk.num_frames * CD_FRAME_SIZE];
+  std::memcpy(frame, sector, CD_SECTOR_SIZE);
+  if (subcode)
+    std::memcpy(frame + CD_SECTOR_SIZE, subcode, CD_SUBCODE_SIZE);
+  else
+    std::memset(frame + CD_SECTOR_SIZE, 0, CD_SUBCODE_SIZE);
+
+  m_logical_bytes += CD_FRAME_SIZE;
+  if (++hunk.num_frames < CD_FRAMES_PER_HUNK)
+    return true;
+
+  if (++m_num_filling_hunks < m_batch_size)
+    return true;
+
+  return CompressFilledHunks(error);
+}
+
+bool CHDWriter::CompressFilledHunks(Common::Error* error)
+{
+  // swap the batches over, writing out the one which has finished
+  m_group.Wait();
+  if (!WriteCompressedHunks(error))
+    return false;
+
+  std::swap(m_filling_hunks, m_compressing_hunks);
+  m_num_compressing_hunks = m_num_filling_hunks;
+  m_num_filling_hunks = 0;
+  for (u32 i = 0; i < m_num_compressing_hunks; i++)
+    m_group.Run([this, &hunk = m_compressing_hunks[i]]() { CompressHunk(hunk); });
+
+  return true;
+}
+
+void CHDWriter::CompressHunk(Hunk& hunk) const
+{
+  // a partial last hunk is padded with zeros
+  if (hunk.num_frames < CD_FRAMES_PER_HUNK)
+    std::memset(&hunk.data[hunk.num_frames * CD_FRAME_SIZE], 0, (CD_FRAMES_PER_HUNK - hunk.num_frames) * CD_FRAME_SIZE);
+
+  hunk.crc = ComputeCRC16(hunk.data.data(), HUNK_SIZE);
+
+  // cdzl compresses the sectors and the subcode separately, which is a fair bit better than interleaved
+  u8 sectors[CD_SECTOR_SIZE * CD_FRAMES_PER_HUNK];
+  u8 subcode[CD_SUBCODE_SIZE * CD_FRAMES_PER_HUNK];
+  for (u32 i = 0; i < CD_FRAMES_PER_HUNK; i++)
+  {
+    std::memcpy(&sectors[i * CD_SECTOR_SIZE], &hunk.data[i * CD_FRAME_SIZE], CD_SECTOR_SIZE);
+    std::memcpy(&subcode[i * CD_SUBCODE_SIZE], &hunk.data[i * CD_FRAME_SIZE + CD_SECTOR_SIZE], CD_SUBCODE_SIZE);
+  }
+
+  // anything which doesn't come out smaller is stored as-is
+  hunk.compressed.resize(HUNK_SIZE);
+  u8* out = hunk.compressed.data();
+  u32 sectors_size, subcode_size;
+  if (!DeflateRaw(sectors, sizeof(sectors), out + CDZL_HEADER_SIZE, HUNK_SIZE - CDZL_HEADER_SIZE, m_compression_level,
+                  &sectors_size) ||
+      !DeflateRaw(subcode, sizeof(subcode), out + CDZL_HEADER_SIZE + sectors_size,
+                  HUNK_SIZE - CDZL_HEADER_SIZE - sectors_size, m_compression_level, &subcode_size) ||
+      (CDZL_HEADER_SIZE + sectors_size + subcode_size) >= HUNK_SIZE)
+  {
+    hunk.compressed.clear();
+    return;
+  }
+
+  std::memset(out, 0, CDZL_ECC_BYTES);
+  PutBE16(out + CDZL_ECC_BYTES, static_cast<u16>(sectors_size));
+  hunk.compressed.resize(CDZL_HEADER_SIZE + sectors_size + subcode_size);
+}
+
+bool CHDWriter::WriteCompressedHunks(Common::Error* error)
+{
+  for (u32 i = 0; i < m_num_compressing_hunks; i++)
+  {
+    Hunk& hunk = m_compressing_hunks[i];
+    m_raw_sha1.Update(hunk.data.data(), hunk.num_frames * CD_FRAME_SIZE);
+
+    MapEntry& entry = m_map.emplace_back();
+    entry.offset = m_next_hunk_offset;
+    entry.crc = hunk.crc;
+    if (!hunk.compressed.empty())
+    {
+      entry.type = COMPRESSION_TYPE_0;
+      entry.length = static_cast<u32>(hunk.compressed.size());
+      if (!WriteBytes(hunk.compressed.data(), hunk.compressed.size(), error))
+        return false;
+    }
+    else
+    {
+      entry.type = COMPRESSION_NONE;
+      entry.length = HUNK_SIZE;
+      if (!WriteBytes(hunk.data.data(), HUNK_SIZE, error))
+        return false;
+    }
+
+    m_next_hunk_offset += entry.length;
+    hunk.num_frames = 0;
+  }
+
+  m_num_compressing_hunks = 0;
+  return true;
+}
+
+bool CHDWriter::Finish(Common::Error* error)
+{
+  if (m_filling_hunks[m_num_filling_hunks].num_frames > 0)
+    m_num_filling_hunks++;
+
+  if (!CompressFilledHunks(error))
+  {
+    Abort();
+    return false;
+  }
+
+  m_group.Wait();
+  if (!WriteCompressedHunks(error) || !WriteMap(error) || !WriteMetadata(error) || !WriteHeader(error))
+  {
+    Abort();
+    return false;
+  }
+
+  if (std::fclose(m_fp) != 0)
+  {
+    m_fp = nullptr;
+    if (error)
+      error->SetErrno(errno);
+
+    FileSystem::DeleteFile(m_path.c_str());
+    return false;
+  }
+
+  m_fp = nullptr;
+  Log_InfoPrintf("Wrote %zu hunks (%" PRIu64 " bytes) to '%s'", m_map.size(), m_next_hunk_offset - V5_HEADER_SIZE,
+                 m_path.c_str());
+  return true;
+}
+
+bool CHDWriter::WriteMap(Common::Error* error)
+{
+  // the decoder reconstructs this from the compressed map, and checks the crc of it against the header
+  u32 max_length = 0;
+  std::vector<u8> raw_map(m_map.size() * MAP_ENTRY_SIZE);
+  for (size_t i = 0; i < m_map.size(); i++)
+  {
+    const MapEntry& entry = m_map[i];
+    u8* raw = &raw_map[i * MAP_ENTRY_SIZE];
+    raw[0] = entry.type;
+    PutBE24(&raw[1], entry.length);
+    PutBE48(&raw[4], entry.offset);
+    PutBE16(&raw[10], entry.crc);
+    if (entry.type == COMPRESSION_TYPE_0)
+      max_length = std::max(max_length, entry.length);
+  }
+
+  // The types are huffman coded, but a tree where every code is four bits is as valid as any other, and it's so
+  // small either way that it's not worth building a real one. That also means no RLE, it's only a size saving.
+  const u32 length_bits = GetBitsForValue(max_length);
+  BitWriter bits;
+  for (u32 i = 0; i < NUM_COMPRESSION_TYPES; i++)
+    bits.Write(4, 4);
+  for (const MapEntry& entry : m_map)
+    bits.Write(entry.type, 4);
+  for (const MapEntry& entry : m_map)
+  {
+    if (entry.type == COMPRESSION_TYPE_0)
+      bits.Write(entry.length, length_bits);
+    bits.Write(entry.crc, 16);
+  }
+
+  const std::vector<u8>& map_data = bits.Flush();
+  u8 header[MAP_HEADER_SIZE] = {};
+  PutBE32(&header[0], static_cast<u32>(map_data.size()));
+  PutBE48(&header[4], V5_HEADER_SIZE);
+  PutBE16(&header[10], ComputeCRC16(raw_map.data(), raw_map.size()));
+  header[12] = static_cast<u8>(length_bits);
+
+  m_map_offset = m_next_hunk_offset;
+  return (WriteBytes(header, sizeof(header), error) && WriteBytes(map_data.data(), map_data.size(), error));
+}
+
+bool CHDWriter::WriteMetadata(Common::Error* error)
+{
+  // the overall hash covers the raw data and every checksummed metadata entry, sorted
+  std::vector<std::array<u8, 4 + SHA1Digest::DIGEST_SIZE>> metadata_hashes;
+  metadata_hashes.reserve(m_metadata.size());
+
+  u64 offset = static_cast<u64>(FileSystem::FTell64(m_fp));
+  m_metadata_offset = m_metadata.empty() ? 0 : offset;
+  for (size_t i = 0; i < m_metadata.size(); i++)
+  {
+    const Metadata& md = m_metadata[i];
+    const u32 length = static_cast<u32>(md.value.size() + 1);
+    offset += METADATA_HEADER_SIZE + length;
+
+    u8 header[METADATA_HEADER_SIZE];
+    PutBE32(&header[0], md.tag);
+    PutBE32(&header[4], (CHD_MDFLAGS_CHECKSUM << 24) | length);
+    PutBE64(&header[8], (i == (m_metadata.size() - 1)) ? 0 : offset);
+    if (!WriteBytes(header, sizeof(header), error) || !WriteBytes(md.value.c_str(), length, error))
+      return false;
+
+    auto& hash = metadata_hashes.emplace_back();
+    PutBE32(hash.data(), md.tag);
+    SHA1Digest digest;
+    digest.Update(md.value.c_str(), length);
+    digest.Final(hash.data() + 4);
+  }
+
+  std::sort(metadata_hashes.begin(), metadata_hashes.end());
+
+  m_raw_sha1.Final(m_raw_sha1_digest);
+  SHA1Digest overall;
+  overall.Update(m_raw_sha1_digest, sizeof(m_raw_sha1_digest));
+  for (const auto& hash : metadata_hashes)
+    overall.Update(hash.data(), static_cast<u32>(hash.size()));
+  overall.Final(m_overall_sha1_digest);
+  return true;
+}
+
+bool CHDWriter::WriteHeader(Common::Error* error)
+{
+  u8 header[V5_HEADER_SIZE] = {};
+  std::memcpy(&header[0], "MComprHD", 8);
+  PutBE32(&header[8], V5_HEADER_SIZE);
+  PutBE32(&header[12], 5);
+  PutBE32(&header[16], CHD_CODEC_CD_ZLIB);
+  PutBE64(&header[32], m_logical_bytes);
+  PutBE64(&header[40], m_map_offset);
+  PutBE64(&header[48], m_metadata_offset);
+  PutBE32(&header[56], HUNK_SIZE);
+  PutBE32(&header[60], CD_FRAME_SIZE);
+  std::memcpy(&header[64], m_raw_sha1_digest, sizeof(m_raw_sha1_digest));
+  std::memcpy(&header[84], m_overall_sha1_digest, sizeof(m_overall_sha1_digest));
+
+  if (FileSystem::FSeek64(m_fp, 0, SEEK_SET) != 0)
+  {
+    if (error)
+      error->SetErrno(errno);
+
+    return false;
+  }
+
+  return WriteBytes(header, sizeof(header), error);
+}
+
+bool CHDWriter::WriteBytes(const void* data, size_t size, Common::Error* error)
+{
+  if (size == 0 || std::fwrite(data, size, 1, m_fp) == 1)
+    return true;
+
+  Log_ErrorPrintf("Failed to write %zu bytes to '%s': errno %d", size, m_path.c_str(), errno);
+  if (error)
+    error->SetErrno(errno);
+
+  return false;
+}
+
+void CHDWriter::Abort()
+{
+  std::fclose(m_fp);
+  m_fp = nullptr;
+  FileSystem::DeleteFile(m_path.c_str());
+}
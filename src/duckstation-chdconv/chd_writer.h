@@ -0,0 +1,98 @@
+#pragma once
+#include "common/sha1_digest.h"
+#include "common/task_scheduler.h"
+#include "common/types.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace Common {
+class Error;
+}
+
+/// Writes CD images as v5 CHDs, in the same layout as chdman: each frame is the raw sector followed by 96 bytes of
+/// subcode, eight frames to a hunk, with the tracks described by metadata. Hunks are compressed with the CD zlib codec
+/// on the scheduler's workers while the caller keeps reading and adding frames.
+class CHDWriter
+{
+public:
+  enum : u32
+  {
+    CD_SECTOR_SIZE = 2352,
+    CD_SUBCODE_SIZE = 96,
+    CD_FRAME_SIZE = CD_SECTOR_SIZE + CD_SUBCODE_SIZE,
+    CD_FRAMES_PER_HUNK = 8,
+    HUNK_SIZE = CD_FRAME_SIZE * CD_FRAMES_PER_HUNK,
+  };
+
+  explicit CHDWriter(Threading::TaskScheduler& scheduler);
+  ~CHDWriter();
+
+  bool Create(const char* path, int compression_level, Common::Error* error);
+
+  /// Adds a metadata entry, e.g. a track description. These are written at the end, and included in the SHA1.
+  void AddMetadata(u32 tag, std::string value);
+
+  /// Appends a frame. A null subcode pointer stores zeros, which compress to almost nothing.
+  bool WriteFrame(const void* sector, const void* subcode, Common::Error* error);
+
+  /// Writes the remaining hunks, the map, the metadata and the final header. Deletes the file if anything fails.
+  bool Finish(Common::Error* error);
+
+private:
+  struct Hunk
+  {
+    std::vector<u8> data;
+    std::vector<u8> compressed;
+    u32 num_frames = 0;
+    u16 crc = 0;
+  };
+
+  struct MapEntry
+  {
+    u8 type;
+    u32 length;
+    u64 offset;
+    u16 crc;
+  };
+
+  struct Metadata
+  {
+    u32 tag;
+    std::string value;
+  };
+
+  void CompressHunk(Hunk& hunk) const;
+  bool CompressFilledHunks(Common::Error* error);
+  bool WriteCompressedHunks(Common::Error* error);
+  bool WriteMap(Common::Error* error);
+  bool WriteMetadata(Common::Error* error);
+  bool WriteHeader(Common::Error* error);
+  bool WriteBytes(const void* data, size_t size, Common::Error* error);
+  void Abort();
+
+  Threading::TaskScheduler& m_scheduler;
+  Threading::TaskGroup m_group;
+
+  std::string m_path;
+  std::FILE* m_fp = nullptr;
+  int m_compression_level = 0;
+
+  // hunks are filled while the batch before is being compressed, then written out once it's done
+  std::vector<Hunk> m_filling_hunks;
+  std::vector<Hunk> m_compressing_hunks;
+  u32 m_num_filling_hunks = 0;
+  u32 m_num_compressing_hunks = 0;
+  u32 m_batch_size = 0;
+
+  std::vector<MapEntry> m_map;
+  std::vector<Metadata> m_metadata;
+  u64 m_next_hunk_offset = 0;
+  u64 m_logical_bytes = 0;
+  u64 m_map_offset = 0;
+  u64 m_metadata_offset = 0;
+
+  SHA1Digest m_raw_sha1;
+  u8 m_raw_sha1_digest[SHA1Digest::DIGEST_SIZE] = {};
+  u8 m_overall_sha1_digest[SHA1Digest::DIGEST_SIZE] = {};
+};
@@ -0,0 +1,377 @@
+#include "chd_writer.h"
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/path.h"
+#include "common/progress_callback.h"
+#include "common/string_util.h"
+#include "common/task_scheduler.h"
+#include "common/timer.h"
+#include "fmt/format.h"
+#include "libchdr/chd.h"
+#include "scmversion/scmversion.h"
+#include "util/cd_image.h"
+#include "util/cd_subchannel_replacement.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+Log_SetChannel(CHDConv);
+
+static int s_compression_level = 9;
+static u32 s_num_threads = 0;
+static bool s_overwrite = false;
+static std::string s_output_path;
+static std::vector<std::string> s_input_paths;
+
+static void PrintCommandLineVersion()
+{
+  std::fprintf(stderr, "DuckStation CHD Converter Version %s (%s)\n", g_scm_tag_str, g_scm_branch_str);
+  std::fprintf(stderr, "https://github.com/stenzek/duckstation\n");
+  std::fprintf(stderr, "\n");
+}
+
+static void PrintCommandLineHelp(const char* progname)
+{
+  PrintCommandLineVersion();
+  std::fprintf(stderr, "Usage: %s [parameters] [--] <image> [image...]\n", progname);
+  std::fprintf(stderr, "\n");
+  std::fprintf(stderr, "Converts any disc image DuckStation can open to CHD.\n");
+  std::fprintf(stderr, "The CHD is written next to the original image unless -o is used.\n");
+  std::fprintf(stderr, "Replacement subchannel data (e.g. LibCrypt) is written to a .sbi alongside the CHD.\n");
+  std::fprintf(stderr, "\n");
+  std::fprintf(stderr, "  -help: Displays this information and exits.\n");
+  std::fprintf(stderr, "  -version: Displays version information and exits.\n");
+  std::fprintf(stderr, "  -o <file>: Sets the output filename, when converting a single image.\n");
+  std::fprintf(stderr, "  -threads <count>: Sets the number of compression threads. Defaults to one per core.\n");
+  std::fprintf(stderr, "  -level <1-9>: Sets the zlib compression level. Defaults to 9.\n");
+  std::fprintf(stderr, "  -force: Overwrites existing output files.\n");
+  std::fprintf(stderr, "  --: Signals that no more arguments will follow and the remaining\n"
+                       "    parameters are image filenames. Use when a filename starts with a dash.\n");
+  std::fprintf(stderr, "\n");
+}
+
+static bool ParseCommandLineArgs(int argc, char* argv[])
+{
+  bool no_more_args = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (!no_more_args)
+    {
+#define CHECK_ARG(str) !std::strcmp(argv[i], str)
+#define CHECK_ARG_PARAM(str) (!std::strcmp(argv[i], str) && ((i + 1) < argc))
+
+      if (CHECK_ARG("-help"))
+      {
+        PrintCommandLineHelp(argv[0]);
+        return false;
+      }
+      else if (CHECK_ARG("-version"))
+      {
+        PrintCommandLineVersion();
+        return false;
+      }
+      else if (CHECK_ARG_PARAM("-o"))
+      {
+        s_output_path = argv[++i];
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-threads"))
+      {
+        const std::optional<u32> threads = StringUtil::FromChars<u32>(argv[++i]);
+        if (!threads.has_value())
+        {
+          Log_ErrorPrintf("Invalid thread count specified: %s", argv[i]);
+          return false;
+        }
+
+        s_num_threads = threads.value();
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-level"))
+      {
+        s_compression_level = StringUtil::FromChars<int>(argv[++i]).value_or(0);
+        if (s_compression_level < 1 || s_compression_level > 9)
+        {
+          Log_ErrorPrintf("Invalid compression level specified: %s", argv[i]);
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG("-force"))
+      {
+        s_overwrite = true;
+        continue;
+      }
+      else if (CHECK_ARG("--"))
+      {
+        no_more_args = true;
+        continue;
+      }
+      else if (argv[i][0] == '-')
+      {
+        Log_ErrorPrintf("Unknown parameter: '%s'", argv[i]);
+        return false;
+      }
+
+#undef CHECK_ARG
+#undef CHECK_ARG_PARAM
+    }
+
+    s_input_paths.emplace_back(argv[i]);
+  }
+
+  if (s_input_paths.empty())
+  {
+    PrintCommandLineHelp(argv[0]);
+    return false;
+  }
+
+  if (!s_output_path.empty() && s_input_paths.size() > 1)
+  {
+    Log_ErrorPrintf("-o can only be used with a single image.");
+    return false;
+  }
+
+  return true;
+}
+
+static const char* GetCHDTrackTypeString(CDImage::TrackMode mode)
+{
+  // the inverse of what the CHD reader parses
+  switch (mode)
+  {
+    case CDImage::TrackMode::Audio:
+      return "AUDIO";
+    case CDImage::TrackMode::Mode1:
+      return "MODE1";
+    case CDImage::TrackMode::Mode1Raw:
+      return "MODE1_RAW";
+    case CDImage::TrackMode::Mode2:
+      return "MODE2";
+    case CDImage::TrackMode::Mode2Form1:
+      return "MODE2_FORM1";
+    case CDImage::TrackMode::Mode2Form2:
+      return "MODE2_FORM2";
+    case CDImage::TrackMode::Mode2FormMix:
+      return "MODE2_FORM_MIX";
+    case CDImage::TrackMode::Mode2Raw:
+    default:
+      return "MODE2_RAW";
+  }
+}
+
+static u32 GetTotalFrameCount(const CDImage* image)
+{
+  u32 frames = 0;
+  for (const CDImage::Index& index : image->GetIndices())
+  {
+    if (index.track_number != CDImage::LEAD_OUT_TRACK_NUMBER && index.file_sector_size > 0)
+      frames += index.length;
+  }
+  return frames;
+}
+
+static bool WriteTracks(CDImage* image, CHDWriter* writer, CDSubChannelReplacement* sbi, ProgressCallback* progress,
+                        Common::Error* error)
+{
+  const bool check_subchannel = image->HasNonStandardSubchannel();
+  const std::vector<CDImage::Index>& indices = image->GetIndices();
+
+  u8 sector[CHDWriter::CD_SECTOR_SIZE];
+  u32 frames_written = 0;
+  progress->SetProgressRange(std::max(GetTotalFrameCount(image), 1u));
+
+  for (const CDImage::Track& track : image->GetTracks())
+  {
+    // pregaps which aren't in the source file stay out of the CHD, the reader regenerates them as silence
+    const CDImage::Index* pregap =
+      (track.first_index > 0 && indices[track.first_index - 1].track_number == track.track_number &&
+       indices[track.first_index - 1].is_pregap) ?
+        &indices[track.first_index - 1] :
+        nullptr;
+    const bool pregap_in_file = (pregap && pregap->file_sector_size > 0);
+    const u32 pregap_frames = pregap ? pregap->length : 0;
+
+    u32 track_frames = pregap_in_file ? pregap_frames : 0;
+    for (u32 i = track.first_index; i < indices.size() && indices[i].track_number == track.track_number; i++)
+      track_frames += indices[i].length;
+
+    const char* type = GetCHDTrackTypeString(track.mode);
+    writer->AddMetadata(
+      CDROM_TRACK_METADATA2_TAG,
+      fmt::format("TRACK:{} TYPE:{} SUBTYPE:NONE FRAMES:{} PREGAP:{} PGTYPE:{}{} PGSUB:NONE POSTGAP:0",
+                  track.track_number, type, track_frames, pregap_frames, pregap_in_file ? "V" : "", type));
+
+    u32 first_index = track.first_index;
+    if (pregap)
+      first_index--;
+
+    for (u32 i = first_index; i < indices.size() && indices[i].track_number == track.track_number; i++)
+    {
+      // pregaps which aren't stored can still have replacement subchannel
+      const CDImage::Index& index = indices[i];
+      const bool store_sectors = (!index.is_pregap || pregap_in_file);
+      if (!store_sectors && !check_subchannel)
+        continue;
+
+      for (u32 lba = 0; lba < index.length; lba++)
+      {
+        if (check_subchannel)
+        {
+          CDImage::SubChannelQ subq, generated_subq;
+          if (image->ReadSubChannelQ(&subq, index, lba) &&
+              image->CDImage::ReadSubChannelQ(&generated_subq, index, lba) && subq.data != generated_subq.data)
+          {
+            sbi->AddReplacementSubChannelQ(index.start_lba_on_disc + lba, subq);
+          }
+        }
+
+        if (!store_sectors)
+          continue;
+
+        std::memset(sector, 0, sizeof(sector));
+        if (index.file_sector_size > 0 && !image->ReadSectorFromIndex(sector, index, lba))
+        {
+          if (error)
+            error->SetFormattedMessage("Failed to read LBA %u", index.start_lba_on_disc + lba);
+
+          return false;
+        }
+
+        // CHD stores audio big-endian
+        if (track.mode == CDImage::TrackMode::Audio)
+        {
+          for (u32 j = 0; j < sizeof(sector); j += 2)
+            std::swap(sector[j], sector[j + 1]);
+        }
+
+        if (!writer->WriteFrame(sector, nullptr, error))
+          return false;
+
+        if (((++frames_written) % 1000) == 0)
+          progress->SetProgressValue(frames_written);
+      }
+    }
+
+    // each track is padded to a multiple of four frames, which the reader expects
+    std::memset(sector, 0, sizeof(sector));
+    for (u32 i = track_frames; (i % 4) != 0; i++)
+    {
+      if (!writer->WriteFrame(sector, nullptr, error))
+        return false;
+    }
+  }
+
+  progress->SetProgressValue(frames_written);
+  return true;
+}
+
+static bool ConvertImage(CDImage* image, const std::string& output_path, Threading::TaskScheduler& scheduler)
+{
+  if (!s_overwrite && FileSystem::FileExists(output_path.c_str()))
+  {
+    Log_ErrorPrintf("'%s' already exists, use -force to overwrite it.", output_path.c_str());
+    return false;
+  }
+
+  Log_InfoPrintf("Converting '%s' (%u tracks) to '%s'...", image->GetFileName().c_str(), image->GetTrackCount(),
+                 output_path.c_str());
+
+  Common::Timer timer;
+  Common::Error error;
+  CHDWriter writer(scheduler);
+  CDSubChannelReplacement sbi;
+  ConsoleProgressCallback progress;
+  if (!writer.Create(output_path.c_str(), s_compression_level, &error) ||
+      !WriteTracks(image, &writer, &sbi, &progress, &error) || !writer.Finish(&error))
+  {
+    Log_ErrorPrintf("Failed to convert '%s': %s", image->GetFileName().c_str(), error.GetMessage().GetCharArray());
+    return false;
+  }
+
+  const std::string sbi_path = Path::ReplaceExtension(output_path, "sbi");
+  if (sbi.GetReplacementSectorCount() > 0)
+  {
+    if (!sbi.SaveSBI(sbi_path.c_str()))
+    {
+      Log_ErrorPrintf("Failed to write subchannel data to '%s'", sbi_path.c_str());
+      return false;
+    }
+
+    Log_InfoPrintf("Wrote %u replacement subchannel sectors to '%s'", sbi.GetReplacementSectorCount(),
+                   sbi_path.c_str());
+  }
+
+  Log_InfoPrintf("Converted '%s' in %.2f seconds.", image->GetFileName().c_str(), timer.GetTimeSeconds());
+  return true;
+}
+
+static bool ConvertFile(const std::string& input_path, Threading::TaskScheduler& scheduler)
+{
+  Common::Error error;
+  std::unique_ptr<CDImage> image = CDImage::Open(input_path.c_str(), false, &error);
+  if (!image)
+  {
+    Log_ErrorPrintf("Failed to open '%s': %s", input_path.c_str(), error.GetMessage().GetCharArray());
+    return false;
+  }
+
+  const std::string output_path = s_output_path.empty() ? Path::ReplaceExtension(input_path, "chd") : s_output_path;
+  if (!image->HasSubImages() || image->GetSubImageCount() <= 1)
+  {
+    if (output_path == input_path)
+    {
+      Log_ErrorPrintf("Output path for '%s' is the same as the input.", input_path.c_str());
+      return false;
+    }
+
+    return ConvertImage(image.get(), output_path, scheduler);
+  }
+
+  // multi-disc images become a CHD per disc
+  const std::string_view output_base = Path::StripExtension(output_path);
+  for (u32 i = 0; i < image->GetSubImageCount(); i++)
+  {
+    if (!image->SwitchSubImage(i, &error))
+    {
+      Log_ErrorPrintf("Failed to switch to disc %u of '%s': %s", i + 1, input_path.c_str(),
+                      error.GetMessage().GetCharArray());
+      return false;
+    }
+
+    if (!ConvertImage(image.get(), fmt::format("{} (Disc {}).chd", output_base, i + 1), scheduler))
+      return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  Log::SetConsoleOutputParams(true, nullptr, LOGLEVEL_INFO);
+
+  if (!ParseCommandLineArgs(argc, argv))
+    return -1;
+
+  Threading::TaskScheduler scheduler(s_num_threads, Threading::ThreadPriority::Normal, "CHD Compressor");
+  Log_InfoPrintf("Compressing with %u threads at level %d.", scheduler.GetWorkerCount(), s_compression_level);
+
+  u32 failed = 0;
+  for (const std::string& path : s_input_paths)
+  {
+    if (!ConvertFile(path, scheduler))
+      failed++;
+  }
+
+  if (failed > 0)
+  {
+    Log_ErrorPrintf("%u of %zu images failed to convert.", failed, s_input_paths.size());
+    return -1;
+  }
+
+  return 0;
+}
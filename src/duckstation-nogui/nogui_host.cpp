@@ -71,8 +71,11 @@ static void StartCPUThread();
 static void StopCPUThread();
 static void ProcessCPUThreadEvents(bool block);
 static void ProcessCPUThreadPlatformMessages();
+static void WaitForCPUThreadEvents(u32 timeout_ms);
+static void WakeCPUThread();
 static void CPUThreadEntryPoint();
 static void CPUThreadMainLoop();
+static void RenderDisplay(bool skip_present, bool skip_if_unchanged);
 static std::unique_ptr<NoGUIPlatform> CreatePlatform();
 static std::string GetWindowTitle(const std::string& game_title);
 static void UpdateWindowTitle(const std::string& game_title);
@@ -100,6 +103,7 @@ static std::condition_variable s_cpu_thread_event_done;
 static std::condition_variable s_cpu_thread_event_posted;
 static std::deque<std::pair<std::function<void()>, bool>> s_cpu_thread_events;
 static u32 s_blocking_cpu_events_pending = 0; // TODO: Token system would work better here.
+static bool s_cpu_thread_wake_requested = false;
 
 static std::mutex s_async_op_mutex;
 static std::thread s_async_op_thread;
@@ -422,6 +426,7 @@ void NoGUIHost::ProcessPlatformMouseMoveEvent(float x, float y)
 
   InputManager::UpdatePointerAbsolutePosition(0, x, y);
   ImGuiManager::UpdateMousePosition(x, y);
+  WakeCPUThread();
 }
 
 void NoGUIHost::ProcessPlatformMouseButtonEvent(s32 button, bool pressed)
@@ -438,6 +443,7 @@ void NoGUIHost::ProcessPlatformMouseWheelEvent(float x, float y)
     InputManager::UpdatePointerRelativeDelta(0, InputPointerAxis::WheelX, x);
   if (y != 0.0f)
     InputManager::UpdatePointerRelativeDelta(0, InputPointerAxis::WheelY, y);
+  WakeCPUThread();
 }
 
 void NoGUIHost::ProcessPlatformKeyEvent(s32 key, bool pressed)
@@ -589,6 +595,41 @@ void NoGUIHost::ProcessCPUThreadEvents(bool block)
   }
 }
 
+void NoGUIHost::WaitForCPUThreadEvents(u32 timeout_ms)
+{
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  const auto woken = []() { return (!s_cpu_thread_events.empty() || s_cpu_thread_wake_requested); };
+
+  // controllers still have to be polled, but we only go back to rendering if they did something
+  std::unique_lock lock(s_cpu_thread_events_mutex);
+  while (s_running.load(std::memory_order_acquire))
+  {
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= deadline ||
+        s_cpu_thread_event_posted.wait_for(
+          lock, std::min<std::chrono::steady_clock::duration>(CPU_THREAD_POLL_INTERVAL, deadline - now), woken))
+    {
+      break;
+    }
+
+    lock.unlock();
+    ProcessCPUThreadPlatformMessages();
+    const bool had_input = InputManager::PollSources();
+    lock.lock();
+    if (had_input)
+      break;
+  }
+
+  s_cpu_thread_wake_requested = false;
+}
+
+void NoGUIHost::WakeCPUThread()
+{
+  std::unique_lock lock(s_cpu_thread_events_mutex);
+  s_cpu_thread_wake_requested = true;
+  s_cpu_thread_event_posted.notify_one();
+}
+
 void NoGUIHost::CPUThreadEntryPoint()
 {
   Threading::SetNameOfCurrentThread("CPU Thread");
@@ -634,7 +675,7 @@ void NoGUIHost::CPUThreadMainLoop()
     }
 
     Host::PumpMessagesOnCPUThread();
-    Host::RenderDisplay(false);
+    RenderDisplay(false, true);
   }
 }
 
@@ -769,21 +810,35 @@ void Host::InvalidateDisplay()
 }
 
 void Host::RenderDisplay(bool skip_present)
+{
+  NoGUIHost::RenderDisplay(skip_present, false);
+}
+
+void NoGUIHost::RenderDisplay(bool skip_present, bool skip_if_unchanged)
 {
   // acquire for IO.MousePos.
   std::atomic_thread_fence(std::memory_order_acquire);
 
+  bool skipped_unchanged = false;
   if (!skip_present)
   {
     FullscreenUI::Render();
     ImGuiManager::RenderOverlays();
     ImGuiManager::RenderOSD();
     ImGuiManager::RenderDebugWindows();
+
+    // the display texture can't change while we're not running, so if the UI is the same, so is the whole frame
+    skipped_unchanged = (!ImGuiManager::HasFrameChanged() && skip_if_unchanged);
   }
 
-  g_host_display->Render(skip_present);
+  g_host_display->Render(skip_present || skipped_unchanged);
 
   ImGuiManager::NewFrame();
+
+  // nothing to draw until there's input or queued work, or a texture finishes loading
+  const u32 idle_timeout = CommonHost::GetIdleWaitTimeout(skipped_unchanged);
+  if (idle_timeout > 0)
+    WaitForCPUThreadEvents(idle_timeout);
 }
 
 // void Host::ResizeHostDisplay(u32 new_window_width, u32 new_window_height, float new_window_scale)
@@ -1070,6 +1125,9 @@ void NoGUIHost::PrintCommandLineHelp(const char* progname)
                        "                 the emulator.\n");
   std::fprintf(stderr, "  -settings <filename>: Loads a custom settings configuration from the\n"
                        "    specified filename. Default settings applied if file not found.\n");
+  std::fprintf(stderr, "  -netplay <player>:<local port>:<host>:<port>[:<delay>]: Joins a two player\n"
+                       "    netplay session as player 1 or 2 once booted, with both sides using the\n"
+                       "    same game and settings. Delay is in frames, and defaults to 1.\n");
   std::fprintf(stderr, "  -earlyconsole: Creates console as early as possible, for logging.\n");
   std::fprintf(stderr, "  --: Signals that no more arguments will follow and the remaining\n"
                        "    parameters make up the filename. Use when the filename contains\n"
@@ -1193,6 +1251,12 @@ bool NoGUIHost::ParseCommandLineParametersAndInitializeConfig(int argc, char* ar
         Log_InfoPrintf("Command Line: Overriding settings filename: %s", settings_filename.c_str());
         continue;
       }
+      else if (CHECK_ARG_PARAM("-netplay"))
+      {
+        AutoBoot(autoboot)->netplay_session = argv[++i];
+        Log_InfoPrintf("Command Line: Joining netplay session: %s", autoboot->netplay_session.c_str());
+        continue;
+      }
       else if (CHECK_ARG("-earlyconsole"))
       {
         InitializeEarlyConsole();
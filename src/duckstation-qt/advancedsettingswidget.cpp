@@ -1,4 +1,5 @@
 #include "advancedsettingswidget.h"
+#include "common/platform.h"
 #include "core/gpu_types.h"
 #include "mainwindow.h"
 #include "qtutils.h"
@@ -228,6 +229,12 @@ void AdvancedSettingsWidget::addTweakOptions()
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Apply Compatibility Settings"), "Main",
                         "ApplyCompatibilitySettings", true);
   addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Display FPS Limit"), "Display", "MaxFPS", 0, 1000, 0);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Reduce Input Latency (Pre-Frame Sleep)"), "Display",
+                        "PreFrameSleep", false);
+  addFloatRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Pre-Frame Sleep Safety Margin (ms)"), "Display",
+                           "PreFrameSleepBuffer", 0.0f, 20.0f, 0.5f, Settings::DEFAULT_DISPLAY_PRE_FRAME_SLEEP_BUFFER);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Relaxed VSync (Tear Late Frames)"), "Display",
+                        "RelaxedVSync", false);
 
   addMSAATweakOption(m_dialog, m_ui.tweakOptionTable, tr("Multisample Antialiasing"));
 
@@ -248,11 +255,37 @@ void AdvancedSettingsWidget::addTweakOptions()
                            -1.0f, 100.0f, 0.25f, -1.0f);
   addFloatRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("PGXP Depth Clear Threshold"), "GPU",
                            "PGXPDepthClearThreshold", 0.0f, 4096.0f, 1.0f, Settings::DEFAULT_GPU_PGXP_DEPTH_THRESHOLD);
-
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Software Renderer Threads"), "GPU",
+                         "SoftwareRendererThreads", 1, 32, 1);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Software Renderer Scale"), "GPU",
+                         "SoftwareRendererScale", 1, 4, 1);
+
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Use Huge Pages For Emulated Memory"), "Console",
+                        "UseHugePages", false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Share BIOS And Resources Between Instances"), "Main",
+                        "MapResourceFiles", false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Idle Loop Skipping"), "CPU", "IdleLoopSkipping",
+                        true);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Memory Exceptions"), "CPU",
                         "RecompilerMemoryExceptions", false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Block Linking"), "CPU",
                         "RecompilerBlockLinking", true);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Block Cache"), "CPU",
+                        "RecompilerBlockCache", false);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Recompiler Compile Budget (Blocks Per Frame)"), "CPU",
+                         "RecompilerCompileBudget", 0, 100000, 0);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Recompiler Hot Block Threshold (Executions)"), "CPU",
+                         "RecompilerHotBlockThreshold", 0, 100000, 0);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Recompiler Code Buffer Size (MB, 0 = Default)"), "CPU",
+                         "RecompilerCodeBufferSize", 0, 48, 0);
+#ifdef __linux__
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Export Recompiler Perf Map"), "CPU",
+                        "RecompilerPerfMap", false);
+#endif
+#ifdef CPU_AARCH64
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Register Pinning"), "CPU",
+                        "RecompilerRegisterPinning", false);
+#endif
   addChoiceTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Fast Memory Access"), "CPU",
                        "FastmemMode", Settings::ParseCPUFastmemMode, Settings::GetCPUFastmemModeName,
                        Settings::GetCPUFastmemModeDisplayName, "CPUFastmemMode",
@@ -262,6 +295,11 @@ void AdvancedSettingsWidget::addTweakOptions()
                         "TextureReplacements", "EnableVRAMWriteReplacements", false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Preload Texture Replacements"), "TextureReplacements",
                         "PreloadTextures", false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Load Texture Replacements Asynchronously"),
+                        "TextureReplacements", "AsyncLoading", true);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Texture Replacement Cache Size (MB)"),
+                         "TextureReplacements", "MaxCacheSizeMB", 0, 16384,
+                         Settings::DEFAULT_TEXTURE_REPLACEMENT_CACHE_SIZE_MB);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Dump Replaceable VRAM Writes"), "TextureReplacements",
                         "DumpVRAMWrites", false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Set Dumped VRAM Write Alpha Channel"),
@@ -283,6 +321,11 @@ void AdvancedSettingsWidget::addTweakOptions()
                          Settings::DEFAULT_GPU_MAX_RUN_AHEAD);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Use Debug Host GPU Device"), "GPU", "UseDebugDevice",
                         false);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Vulkan Frames In Flight"), "GPU", "MaxFramesInFlight", 1,
+                         Settings::MAX_GPU_MAX_FRAMES_IN_FLIGHT, Settings::DEFAULT_GPU_MAX_FRAMES_IN_FLIGHT);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Compile Pipelines In Background"), "GPU",
+                        "AsyncPipelineCompilation", false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Use Uber Shaders"), "GPU", "UseUberShaders", false);
 
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Increase Timer Resolution"), "Main",
                         "IncreaseTimerResolution", true);
@@ -292,6 +335,27 @@ void AdvancedSettingsWidget::addTweakOptions()
 
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Create Save State Backups"), "General",
                         "CreateSaveStateBackups", false);
+
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Log Stutters"), "Display", "DetectStutters", false);
+  addFloatRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Stutter Threshold (ms, 0 = Disabled)"), "Display",
+                           "StutterThreshold", 0.0f, 1000.0f, 1.0f, Settings::DEFAULT_DISPLAY_STUTTER_THRESHOLD);
+  addFloatRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Stutter Threshold (x Median, 0 = Disabled)"),
+                           "Display", "StutterMedianMultiplier", 0.0f, 10.0f, 0.1f,
+                           Settings::DEFAULT_DISPLAY_STUTTER_MEDIAN_MULTIPLIER);
+
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Dynamic Resolution Scaling"), "GPU", "DynamicResolution",
+                        false);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Dynamic Resolution Minimum Scale"), "GPU",
+                         "DynamicResolutionMinScale", 1, 16, 1);
+
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Audio-Only PSF Playback"), "Audio", "AudioOnlyPSF",
+                        true);
+
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Adaptive Frameskip"), "Display", "AdaptiveFrameskip",
+                        false);
+
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Shader Cache Size Limit (MB)"), "GPU",
+                         "ShaderCacheSizeLimit", 0, 16384, Settings::DEFAULT_GPU_SHADER_CACHE_SIZE_LIMIT);
 }
 
 void AdvancedSettingsWidget::onResetToDefaultClicked()
@@ -305,16 +369,35 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);     // Show status indicators
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);     // Apply compatibility settings
     setIntRangeTweakOption(m_ui.tweakOptionTable, i++, 0);       // Display FPS limit
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);    // Pre-frame sleep
+    setFloatRangeTweakOption(m_ui.tweakOptionTable, i++,
+                             Settings::DEFAULT_DISPLAY_PRE_FRAME_SLEEP_BUFFER); // Pre-frame sleep buffer
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);    // Relaxed vsync
     setChoiceTweakOption(m_ui.tweakOptionTable, i++, 0);         // Multisample antialiasing
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);    // PGXP vertex cache
     setFloatRangeTweakOption(m_ui.tweakOptionTable, i++, -1.0f); // PGXP geometry tolerance
     setFloatRangeTweakOption(m_ui.tweakOptionTable, i++,
                              Settings::DEFAULT_GPU_PGXP_DEPTH_THRESHOLD); // PGXP depth clear threshold
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++, 1);                // Software renderer threads
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++, 1);                // Software renderer scale
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler memory exceptions
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);              // Recompiler block linking
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler block cache
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++, 0);                // Recompiler compile budget
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++, 0);                // Recompiler hot block threshold
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++, 0);                // Recompiler code buffer size
+#ifdef __linux__
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler perf map
+#endif
+#ifdef CPU_AARCH64
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler register pinning
+#endif
     setChoiceTweakOption(m_ui.tweakOptionTable, i++, Settings::DEFAULT_CPU_FASTMEM_MODE); // Recompiler fastmem mode
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false); // VRAM write texture replacement
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false); // Preload texture replacements
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);  // Load texture replacements asynchronously
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
+                           Settings::DEFAULT_TEXTURE_REPLACEMENT_CACHE_SIZE_MB); // Texture replacement cache size
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false); // Dump replacable VRAM writes
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false); // Set dumped VRAM write alpha channel
     setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
@@ -330,9 +413,24 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
     setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
                            static_cast<int>(Settings::DEFAULT_GPU_MAX_RUN_AHEAD)); // GPU max run-ahead
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Use debug host GPU device
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
+                           static_cast<int>(Settings::DEFAULT_GPU_MAX_FRAMES_IN_FLIGHT)); // Vulkan frames in flight
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Compile pipelines in background
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Use uber shaders
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);                       // Increase timer resolution
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Allow booting without SBI file
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Create save state backups
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Log stutters
+    setFloatRangeTweakOption(m_ui.tweakOptionTable, i++,
+                             Settings::DEFAULT_DISPLAY_STUTTER_THRESHOLD); // Stutter threshold
+    setFloatRangeTweakOption(m_ui.tweakOptionTable, i++,
+                             Settings::DEFAULT_DISPLAY_STUTTER_MEDIAN_MULTIPLIER); // Stutter median multiplier
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Dynamic resolution scaling
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++, 1);                         // Dynamic resolution min scale
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);                       // Audio-only PSF playback
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Adaptive frameskip
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
+                           Settings::DEFAULT_GPU_SHADER_CACHE_SIZE_LIMIT); // Shader cache size limit
 
     return;
   }
@@ -344,6 +442,9 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
   sif->DeleteValue("Display", "ShowStatusIndicators");
   sif->DeleteValue("Main", "ApplyCompatibilitySettings");
   sif->DeleteValue("Display", "MaxFPS");
+  sif->DeleteValue("Display", "PreFrameSleep");
+  sif->DeleteValue("Display", "PreFrameSleepBuffer");
+  sif->DeleteValue("Display", "RelaxedVSync");
   sif->DeleteValue("Display", "ActiveStartOffset");
   sif->DeleteValue("Display", "ActiveEndOffset");
   sif->DeleteValue("Display", "LineStartOffset");
@@ -353,11 +454,24 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
   sif->DeleteValue("GPU", "PGXPVertexCache");
   sif->DeleteValue("GPU", "PGXPTolerance");
   sif->DeleteValue("GPU", "PGXPDepthClearThreshold");
+  sif->DeleteValue("GPU", "SoftwareRendererThreads");
+  sif->DeleteValue("GPU", "SoftwareRendererScale");
+  sif->DeleteValue("Console", "UseHugePages");
+  sif->DeleteValue("Main", "MapResourceFiles");
+  sif->DeleteValue("CPU", "IdleLoopSkipping");
   sif->DeleteValue("CPU", "RecompilerMemoryExceptions");
   sif->DeleteValue("CPU", "RecompilerBlockLinking");
+  sif->DeleteValue("CPU", "RecompilerBlockCache");
+  sif->DeleteValue("CPU", "RecompilerCompileBudget");
+  sif->DeleteValue("CPU", "RecompilerHotBlockThreshold");
+  sif->DeleteValue("CPU", "RecompilerCodeBufferSize");
+  sif->DeleteValue("CPU", "RecompilerPerfMap");
+  sif->DeleteValue("CPU", "RecompilerRegisterPinning");
   sif->DeleteValue("CPU", "FastmemMode");
   sif->DeleteValue("TextureReplacements", "EnableVRAMWriteReplacements");
   sif->DeleteValue("TextureReplacements", "PreloadTextures");
+  sif->DeleteValue("TextureReplacements", "AsyncLoading");
+  sif->DeleteValue("TextureReplacements", "MaxCacheSizeMB");
   sif->DeleteValue("TextureReplacements", "DumpVRAMWrites");
   sif->DeleteValue("TextureReplacements", "DumpVRAMWriteForceAlphaChannel");
   sif->DeleteValue("TextureReplacements", "DumpVRAMWriteWidthThreshold");
@@ -367,9 +481,19 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
   sif->DeleteValue("Hacks", "GPUFIFOSize");
   sif->DeleteValue("Hacks", "GPUMaxRunAhead");
   sif->DeleteValue("GPU", "UseDebugDevice");
+  sif->DeleteValue("GPU", "AsyncPipelineCompilation");
+  sif->DeleteValue("GPU", "UseUberShaders");
   sif->DeleteValue("Main", "IncreaseTimerResolution");
   sif->DeleteValue("CDROM", "AllowBootingWithoutSBIFile");
   sif->DeleteValue("General", "CreateSaveStateBackups");
+  sif->DeleteValue("Display", "DetectStutters");
+  sif->DeleteValue("Display", "StutterThreshold");
+  sif->DeleteValue("Display", "StutterMedianMultiplier");
+  sif->DeleteValue("GPU", "DynamicResolution");
+  sif->DeleteValue("GPU", "DynamicResolutionMinScale");
+  sif->DeleteValue("Audio", "AudioOnlyPSF");
+  sif->DeleteValue("Display", "AdaptiveFrameskip");
+  sif->DeleteValue("GPU", "ShaderCacheSizeLimit");
   sif->Save();
   while (m_ui.tweakOptionTable->rowCount() > 0)
     m_ui.tweakOptionTable->removeRow(m_ui.tweakOptionTable->rowCount() - 1);
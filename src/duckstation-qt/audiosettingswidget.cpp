@@ -84,7 +84,9 @@ AudioSettingsWidget::AudioSettingsWidget(SettingsDialog* dialog, QWidget* parent
   dialog->registerWidgetHelp(
     m_ui.stretchMode, tr("Stretch Mode"), tr("Time Stretching"),
     tr("When running outside of 100% speed, adjusts the tempo on audio instead of dropping frames. Produces "
-       "much nicer fast forward/slowdown audio at a small cost to performance."));
+       "much nicer fast forward/slowdown audio at a small cost to performance. Dynamic rate control instead "
+       "resamples with a tiny continuous rate adjustment to keep the buffer level steady, which suits sync to host "
+       "refresh rate."));
 }
 
 AudioSettingsWidget::~AudioSettingsWidget() = default;
@@ -359,6 +359,15 @@ void AutoUpdaterDialog::getChangesComplete(QNetworkReply* reply)
 
 void AutoUpdaterDialog::downloadUpdateClicked()
 {
+  // the update is written out as it arrives, rather than holding the whole zip in memory until it's complete
+  const QString update_zip_path = getUpdateZipPath();
+  QFile update_zip_file(update_zip_path);
+  if (!update_zip_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    reportError("Writing update zip to '%s' failed", update_zip_path.toUtf8().constData());
+    return;
+  }
+
   QUrl url(m_download_url);
   QNetworkRequest request(url);
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
@@ -366,6 +375,13 @@ void AutoUpdaterDialog::downloadUpdateClicked()
 #endif
   QNetworkReply* reply = m_network_access_mgr->get(request);
 
+  bool write_failed = false;
+  connect(reply, &QNetworkReply::readyRead, [reply, &update_zip_file, &write_failed]() {
+    const QByteArray chunk = reply->readAll();
+    if (!write_failed && update_zip_file.write(chunk) != chunk.size())
+      write_failed = true;
+  });
+
   QProgressDialog progress(tr("Downloading %1...").arg(m_download_url), tr("Cancel"), 0, 1);
   progress.setWindowTitle(tr("Automatic Updater"));
   progress.setWindowIcon(windowIcon());
@@ -376,29 +392,41 @@ void AutoUpdaterDialog::downloadUpdateClicked()
     progress.setValue(static_cast<int>(received));
   });
 
-  connect(m_network_access_mgr, &QNetworkAccessManager::finished, this, [this, &progress](QNetworkReply* reply) {
-    m_network_access_mgr->disconnect();
-
-    if (reply->error() != QNetworkReply::NoError)
-    {
-      reportError("Download failed: %s", reply->errorString().toUtf8().constData());
-      progress.done(-1);
-      return;
-    }
-
-    const QByteArray data = reply->readAll();
-    if (data.isEmpty())
-    {
-      reportError("Download failed: Update is empty");
-      progress.done(-1);
-      return;
-    }
-
-    if (processUpdate(data))
-      progress.done(1);
-    else
-      progress.done(-1);
-  });
+  connect(m_network_access_mgr, &QNetworkAccessManager::finished, this,
+          [this, &progress, &update_zip_file, &write_failed, &update_zip_path](QNetworkReply* reply) {
+            m_network_access_mgr->disconnect();
+
+            if (reply->error() != QNetworkReply::NoError)
+            {
+              reportError("Download failed: %s", reply->errorString().toUtf8().constData());
+              progress.done(-1);
+              return;
+            }
+
+            const QByteArray chunk = reply->readAll();
+            if (!write_failed && update_zip_file.write(chunk) != chunk.size())
+              write_failed = true;
+
+            const qint64 size = update_zip_file.size();
+            update_zip_file.close();
+            if (write_failed)
+            {
+              reportError("Writing update zip to '%s' failed", update_zip_path.toUtf8().constData());
+              progress.done(-1);
+              return;
+            }
+            else if (size == 0)
+            {
+              reportError("Download failed: Update is empty");
+              progress.done(-1);
+              return;
+            }
+
+            if (processUpdate(update_zip_path))
+              progress.done(1);
+            else
+              progress.done(-1);
+          });
 
   const int result = progress.exec();
   if (result == 0)
@@ -413,6 +441,13 @@ void AutoUpdaterDialog::downloadUpdateClicked()
     done(0);
   }
 
+  // don't leave a partial or unusable zip around
+  if (result != 1)
+  {
+    update_zip_file.close();
+    QFile::remove(update_zip_path);
+  }
+
   reply->deleteLater();
 }
 
@@ -447,30 +482,23 @@ void AutoUpdaterDialog::remindMeLaterClicked()
 
 #ifdef _WIN32
 
-bool AutoUpdaterDialog::processUpdate(const QByteArray& update_data)
+QString AutoUpdaterDialog::getUpdateZipPath() const
+{
+  return QCoreApplication::applicationDirPath() + QStringLiteral("\\update.zip");
+}
+
+bool AutoUpdaterDialog::processUpdate(const QString& update_zip_path)
 {
   const QString update_directory = QCoreApplication::applicationDirPath();
-  const QString update_zip_path = update_directory + QStringLiteral("\\update.zip");
   const QString updater_path = update_directory + QStringLiteral("\\updater.exe");
 
   Q_ASSERT(!update_zip_path.isEmpty() && !updater_path.isEmpty() && !update_directory.isEmpty());
-  if ((QFile::exists(update_zip_path) && !QFile::remove(update_zip_path)) ||
-      (QFile::exists(updater_path) && !QFile::remove(updater_path)))
+  if (QFile::exists(updater_path) && !QFile::remove(updater_path))
   {
-    reportError("Removing existing update zip/updater failed");
+    reportError("Removing existing updater failed");
     return false;
   }
 
-  {
-    QFile update_zip_file(update_zip_path);
-    if (!update_zip_file.open(QIODevice::WriteOnly) || update_zip_file.write(update_data) != update_data.size())
-    {
-      reportError("Writing update zip to '%s' failed", update_zip_path.toUtf8().constData());
-      return false;
-    }
-    update_zip_file.close();
-  }
-
   if (!extractUpdater(update_zip_path, updater_path))
   {
     reportError("Extracting updater failed");
@@ -574,7 +602,12 @@ bool AutoUpdaterDialog::doUpdate(const QString& zip_path, const QString& updater
 
 #else
 
-bool AutoUpdaterDialog::processUpdate(const QByteArray& update_data)
+QString AutoUpdaterDialog::getUpdateZipPath() const
+{
+  return QCoreApplication::applicationDirPath() + QStringLiteral("/update.zip");
+}
+
+bool AutoUpdaterDialog::processUpdate(const QString& update_zip_path)
 {
   return false;
 }
@@ -44,12 +44,14 @@ private:
   bool updateNeeded() const;
   std::string getCurrentUpdateTag() const;
 
+  QString getUpdateZipPath() const;
+
 #ifdef _WIN32
-  bool processUpdate(const QByteArray& update_data);
+  bool processUpdate(const QString& update_zip_path);
   bool extractUpdater(const QString& zip_path, const QString& destination_path);
   bool doUpdate(const QString& zip_path, const QString& updater_path, const QString& destination_path);
 #else
-  bool processUpdate(const QByteArray& update_data);
+  bool processUpdate(const QString& update_zip_path);
 #endif
 
   Ui::AutoUpdaterDialog m_ui;
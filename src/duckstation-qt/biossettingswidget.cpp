@@ -15,10 +15,15 @@ BIOSSettingsWidget::BIOSSettingsWidget(SettingsDialog* dialog, QWidget* parent)
 
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.enableTTYOutput, "BIOS", "PatchTTYEnable", false);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.fastBoot, "BIOS", "PatchFastBoot", false);
+  SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.instantBoot, "BIOS", "InstantBoot", false);
 
   dialog->registerWidgetHelp(m_ui.fastBoot, tr("Fast Boot"), tr("Unchecked"),
                              tr("Patches the BIOS to skip the console's boot animation. Does not work with all games, "
                                 "but usually safe to enable."));
+  dialog->registerWidgetHelp(
+    m_ui.instantBoot, tr("Instant Boot"), tr("Unchecked"),
+    tr("Saves a state the first time a game's executable starts, and resumes from it on later boots, skipping the "
+       "BIOS and loading. The state is taken again when the BIOS, console region or controller settings change."));
   dialog->registerWidgetHelp(
     m_ui.enableTTYOutput, tr("Enable TTY Output"), tr("Unchecked"),
     tr("Patches the BIOS to log calls to printf(). Only use when debugging, can break games."));
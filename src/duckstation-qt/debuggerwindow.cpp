@@ -1,6 +1,10 @@
 #include "debuggerwindow.h"
 #include "common/assert.h"
+#include "common/path.h"
+#include "core/cpu_code_cache.h"
 #include "core/cpu_core_private.h"
+#include "core/host.h"
+#include "core/settings.h"
 #include "debuggermodels.h"
 #include "qthost.h"
 #include "qtutils.h"
@@ -141,6 +145,28 @@ void DebuggerWindow::onTraceTriggered()
   }
 }
 
+void DebuggerWindow::onBlockProfileTriggered()
+{
+  if (!CPU::CodeCache::IsBlockProfileEnabled())
+  {
+    Host::RunOnCPUThread(&CPU::CodeCache::StartBlockProfile, true);
+    QMessageBox::information(this, windowTitle(),
+                             tr("Block profiling started.\nTrigger this action again to write the results."));
+  }
+  else
+  {
+    const std::string path = Path::Combine(EmuFolders::DataRoot, "block_profile.csv");
+    bool result = false;
+    Host::RunOnCPUThread([&path, &result]() { result = CPU::CodeCache::StopBlockProfile(path.c_str()); }, true);
+    if (result)
+      QMessageBox::information(this, windowTitle(),
+                               tr("Block profile written to %1.").arg(QString::fromStdString(path)));
+    else
+      QMessageBox::critical(this, windowTitle(),
+                            tr("Failed to write block profile to %1.").arg(QString::fromStdString(path)));
+  }
+}
+
 void DebuggerWindow::onFollowAddressTriggered()
 {
   //
@@ -394,6 +420,7 @@ void DebuggerWindow::connectSignals()
   connect(m_ui.actionGoToAddress, &QAction::triggered, this, &DebuggerWindow::onGoToAddressTriggered);
   connect(m_ui.actionDumpAddress, &QAction::triggered, this, &DebuggerWindow::onDumpAddressTriggered);
   connect(m_ui.actionTrace, &QAction::triggered, this, &DebuggerWindow::onTraceTriggered);
+  connect(m_ui.actionBlockProfile, &QAction::triggered, this, &DebuggerWindow::onBlockProfileTriggered);
   connect(m_ui.actionStepInto, &QAction::triggered, this, &DebuggerWindow::onStepIntoActionTriggered);
   connect(m_ui.actionStepOver, &QAction::triggered, this, &DebuggerWindow::onStepOverActionTriggered);
   connect(m_ui.actionStepOut, &QAction::triggered, this, &DebuggerWindow::onStepOutActionTriggered);
@@ -462,6 +489,7 @@ void DebuggerWindow::setUIEnabled(bool enabled)
   m_ui.actionGoToAddress->setEnabled(enabled);
   m_ui.actionGoToPC->setEnabled(enabled);
   m_ui.actionTrace->setEnabled(enabled);
+  m_ui.actionBlockProfile->setEnabled(enabled);
   m_ui.memoryRegionRAM->setEnabled(enabled);
   m_ui.memoryRegionEXP1->setEnabled(enabled);
   m_ui.memoryRegionScratchpad->setEnabled(enabled);
@@ -45,6 +45,7 @@ private Q_SLOTS:
   void onDumpAddressTriggered();
   void onFollowAddressTriggered();
   void onTraceTriggered();  
+  void onBlockProfileTriggered();
   void onAddBreakpointTriggered();
   void onToggleBreakpointTriggered();
   void onClearBreakpointsTriggered();
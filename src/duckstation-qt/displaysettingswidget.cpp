@@ -55,6 +55,7 @@ DisplaySettingsWidget::DisplaySettingsWidget(SettingsDialog* dialog, QWidget* pa
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.showResolution, "Display", "ShowResolution", false);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.showCPU, "Display", "ShowCPU", false);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.showInput, "Display", "ShowInputs", false);
+  SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.showSubsystemTimes, "Display", "ShowSubsystemTimes", false);
 
   connect(m_ui.renderer, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
           &DisplaySettingsWidget::populateGPUAdaptersAndResolutions);
@@ -152,6 +153,11 @@ DisplaySettingsWidget::DisplaySettingsWidget(SettingsDialog* dialog, QWidget* pa
   dialog->registerWidgetHelp(
     m_ui.showInput, tr("Show Controller Input"), tr("Unchecked"),
     tr("Shows the current controller state of the system in the bottom-left corner of the display."));
+  dialog->registerWidgetHelp(
+    m_ui.showSubsystemTimes, tr("Show Subsystem Times"), tr("Unchecked"),
+    tr("Shows the percentage of the emulation thread's time spent in recompiled code, the interpreter, block "
+       "compilation, GPU command processing, MDEC, SPU and each timing event in the top-right corner of the display. "
+       "Useful for finding out which part of the emulator is the bottleneck for a game."));
 
 #ifdef _WIN32
   {
@@ -13,6 +13,7 @@
 #include <QtGui/QGuiApplication>
 #include <QtGui/QIcon>
 #include <QtGui/QPainter>
+#include <cctype>
 
 static constexpr std::array<const char*, GameListModel::Column_Count> s_column_names = {
   {"Type", "Serial", "Title", "File Title", "Developer", "Publisher", "Genre", "Year", "Players", "Size", "Region",
@@ -23,6 +24,9 @@ static constexpr int COVER_ART_HEIGHT = 512;
 static constexpr int COVER_ART_SPACING = 32;
 static constexpr int MIN_COVER_CACHE_SIZE = 256;
 
+// Zooming back and forth in the grid only has to repaint when it's between a few recent sizes.
+static constexpr size_t MAX_COVER_CACHE_SIZES = 3;
+
 static int DPRScale(int size, float dpr)
 {
   return static_cast<int>(static_cast<float>(size) * dpr);
@@ -33,53 +37,53 @@ static int DPRUnscale(int size, float dpr)
   return static_cast<int>(static_cast<float>(size) / dpr);
 }
 
-static void resizeAndPadPixmap(QPixmap* pm, int expected_width, int expected_height, float dpr)
+static void resizeAndPadImage(QImage* image, int expected_width, int expected_height, float dpr)
 {
   const int dpr_expected_width = DPRScale(expected_width, dpr);
   const int dpr_expected_height = DPRScale(expected_height, dpr);
-  if (pm->width() == dpr_expected_width && pm->height() == dpr_expected_height)
+  if (image->width() == dpr_expected_width && image->height() == dpr_expected_height)
     return;
 
-  *pm = pm->scaled(dpr_expected_width, dpr_expected_height, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-  if (pm->width() == dpr_expected_width && pm->height() == dpr_expected_height)
+  *image = image->scaled(dpr_expected_width, dpr_expected_height, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+  image->setDevicePixelRatio(dpr);
+  if (image->width() == dpr_expected_width && image->height() == dpr_expected_height)
     return;
 
   // QPainter works in unscaled coordinates.
   int xoffs = 0;
   int yoffs = 0;
-  if (pm->width() < dpr_expected_width)
-    xoffs = DPRUnscale((dpr_expected_width - pm->width()) / 2, dpr);
-  if (pm->height() < dpr_expected_height)
-    yoffs = DPRUnscale((dpr_expected_height - pm->height()) / 2, dpr);
+  if (image->width() < dpr_expected_width)
+    xoffs = DPRUnscale((dpr_expected_width - image->width()) / 2, dpr);
+  if (image->height() < dpr_expected_height)
+    yoffs = DPRUnscale((dpr_expected_height - image->height()) / 2, dpr);
 
-  QPixmap padded_image(dpr_expected_width, dpr_expected_height);
+  QImage padded_image(dpr_expected_width, dpr_expected_height, QImage::Format_ARGB32_Premultiplied);
   padded_image.setDevicePixelRatio(dpr);
   padded_image.fill(Qt::transparent);
   QPainter painter;
   if (painter.begin(&padded_image))
   {
     painter.setCompositionMode(QPainter::CompositionMode_Source);
-    painter.drawPixmap(xoffs, yoffs, *pm);
+    painter.drawImage(xoffs, yoffs, *image);
     painter.setCompositionMode(QPainter::CompositionMode_Destination);
     painter.fillRect(padded_image.rect(), QColor(0, 0, 0, 0));
     painter.end();
   }
 
-  *pm = padded_image;
+  *image = std::move(padded_image);
 }
 
-static QPixmap createPlaceholderImage(const QPixmap& placeholder_pixmap, int width, int height, float scale,
-                                      const std::string& title)
+static QImage createPlaceholderImage(const QImage& placeholder_image, int width, int height, float scale, float dpr,
+                                     const std::string& title)
 {
-  const float dpr = qApp->devicePixelRatio();
-  QPixmap pm(placeholder_pixmap.copy());
-  pm.setDevicePixelRatio(dpr);
-  if (pm.isNull())
-    return QPixmap();
+  if (placeholder_image.isNull())
+    return QImage();
 
-  resizeAndPadPixmap(&pm, width, height, dpr);
+  QImage image(placeholder_image.copy());
+  image.setDevicePixelRatio(dpr);
+  resizeAndPadImage(&image, width, height, dpr);
   QPainter painter;
-  if (painter.begin(&pm))
+  if (painter.begin(&image))
   {
     QFont font;
     font.setPointSize(std::max(static_cast<int>(32.0f * scale), 1));
@@ -92,7 +96,15 @@ static QPixmap createPlaceholderImage(const QPixmap& placeholder_pixmap, int wid
     painter.end();
   }
 
-  return pm;
+  return image;
+}
+
+static std::string toLowerSortKey(std::string_view str)
+{
+  std::string ret(str);
+  for (char& ch : ret)
+    ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+  return ret;
 }
 
 std::optional<GameListModel::Column> GameListModel::getColumnIdForName(std::string_view name)
@@ -111,8 +123,7 @@ const char* GameListModel::getColumnName(Column col)
   return s_column_names[static_cast<int>(col)];
 }
 
-GameListModel::GameListModel(QObject* parent /* = nullptr */)
-  : QAbstractTableModel(parent), m_cover_pixmap_cache(MIN_COVER_CACHE_SIZE)
+GameListModel::GameListModel(QObject* parent /* = nullptr */) : QAbstractTableModel(parent)
 {
   loadCommonImages();
   setCoverScale(1.0f);
@@ -125,16 +136,41 @@ void GameListModel::setCoverScale(float scale)
   if (m_cover_scale == scale)
     return;
 
-  m_cover_pixmap_cache.Clear();
   m_cover_scale = scale;
   m_loading_pixmap = QPixmap(getCoverArtWidth(), getCoverArtHeight());
   m_loading_pixmap.fill(QColor(0, 0, 0, 0));
+
+  // keep the covers scaled for the previous size, in case we zoom back to it
+  const int width = getCoverArtWidth();
+  auto iter = std::find_if(m_cover_pixmap_caches.begin(), m_cover_pixmap_caches.end(),
+                           [width](const auto& it) { return it.first == width; });
+  if (iter != m_cover_pixmap_caches.end())
+  {
+    std::rotate(m_cover_pixmap_caches.begin(), iter, iter + 1);
+  }
+  else
+  {
+    m_cover_pixmap_caches.emplace(m_cover_pixmap_caches.begin(), width,
+                                  std::make_unique<CoverPixmapCache>(MIN_COVER_CACHE_SIZE));
+    if (m_cover_pixmap_caches.size() > MAX_COVER_CACHE_SIZES)
+      m_cover_pixmap_caches.pop_back();
+  }
+
+  m_cover_pixmap_cache = m_cover_pixmap_caches.front().second.get();
 }
 
 void GameListModel::refreshCovers()
 {
-  m_cover_pixmap_cache.Clear();
-  refresh();
+  for (auto& it : m_cover_pixmap_caches)
+    it.second->Clear();
+
+  // loads which are still in flight are for the old covers, so drop them when they complete
+  m_cover_generation++;
+
+  // only the covers need repainting, the rows haven't changed
+  const int count = rowCount();
+  if (count > 0)
+    emit dataChanged(index(0, Column_Cover), index(count - 1, Column_Cover), {Qt::DecorationRole});
 }
 
 void GameListModel::updateCacheSize(int width, int height)
@@ -144,7 +180,7 @@ void GameListModel::updateCacheSize(int width, int height)
   const int cover_height = getCoverArtHeight();
   const int num_columns = ((width + (cover_width - 1)) / cover_width);
   const int num_rows = ((height + (cover_height - 1)) / cover_height);
-  m_cover_pixmap_cache.SetMaxCapacity(static_cast<int>(std::max(num_columns * num_rows, MIN_COVER_CACHE_SIZE)));
+  m_cover_pixmap_cache->SetMaxCapacity(static_cast<int>(std::max(num_columns * num_rows, MIN_COVER_CACHE_SIZE)));
 }
 
 void GameListModel::reloadCommonImages()
@@ -155,48 +191,62 @@ void GameListModel::reloadCommonImages()
 
 void GameListModel::loadOrGenerateCover(const GameList::Entry* ge)
 {
-  QFuture<QPixmap> future =
-    QtConcurrent::run([this, path = ge->path, title = ge->title, serial = ge->serial]() -> QPixmap {
-      QPixmap image;
+  // QPixmap can only be used on the UI thread, so the workers produce images, and they're converted afterwards.
+  const int width = getCoverArtWidth();
+  const int height = getCoverArtHeight();
+  QFuture<QImage> future = QtConcurrent::run(
+    &m_cover_thread_pool, [path = ge->path, title = ge->title, serial = ge->serial, placeholder = m_placeholder_image,
+                           width, height, scale = m_cover_scale,
+                           dpr = static_cast<float>(qApp->devicePixelRatio())]() -> QImage {
+      QImage image;
       const std::string cover_path(GameList::GetCoverImagePath(path, serial, title));
       if (!cover_path.empty())
       {
-        const float dpr = qApp->devicePixelRatio();
-        image = QPixmap(QString::fromStdString(cover_path));
+        image = QImage(QString::fromStdString(cover_path));
         if (!image.isNull())
         {
           image.setDevicePixelRatio(dpr);
-          resizeAndPadPixmap(&image, getCoverArtWidth(), getCoverArtHeight(), dpr);
+          resizeAndPadImage(&image, width, height, dpr);
         }
       }
 
       if (image.isNull())
-        image =
-          createPlaceholderImage(m_placeholder_pixmap, getCoverArtWidth(), getCoverArtHeight(), m_cover_scale, title);
+        image = createPlaceholderImage(placeholder, width, height, scale, dpr, title);
 
       return image;
     });
 
   // Context must be 'this' so we run on the UI thread.
-  future.then(this, [this, path = ge->path](QPixmap pm) {
-    m_cover_pixmap_cache.Insert(std::move(path), std::move(pm));
-    invalidateCoverForPath(path);
+  future.then(this, [this, path = ge->path, width, generation = m_cover_generation](QImage image) {
+    // covers were refreshed while we were loading, or this size was evicted
+    CoverPixmapCache* cache = findCoverPixmapCache(width);
+    if (generation != m_cover_generation || !cache)
+      return;
+
+    cache->Insert(path, QPixmap::fromImage(std::move(image)));
+    if (cache == m_cover_pixmap_cache)
+      invalidateCoverForPath(path);
   });
 }
 
+GameListModel::CoverPixmapCache* GameListModel::findCoverPixmapCache(int width)
+{
+  for (auto& it : m_cover_pixmap_caches)
+  {
+    if (it.first == width)
+      return it.second.get();
+  }
+
+  return nullptr;
+}
+
 void GameListModel::invalidateCoverForPath(const std::string& path)
 {
-  // This isn't ideal, but not sure how else we can get the row, when it might change while scanning...
-  auto lock = GameList::GetLock();
-  const u32 count = GameList::GetEntryCount();
+  // The row might have changed while we were loading, so look it up again.
   std::optional<u32> row;
-  for (u32 i = 0; i < count; i++)
   {
-    if (GameList::GetEntryByIndex(i)->path == path)
-    {
-      row = i;
-      break;
-    }
+    auto lock = GameList::GetLock();
+    row = GameList::GetEntryIndexForPath(path.c_str());
   }
   if (!row.has_value())
   {
@@ -382,14 +432,14 @@ QVariant GameListModel::data(const QModelIndex& index, int role) const
 
         case Column_Cover:
         {
-          QPixmap* pm = m_cover_pixmap_cache.Lookup(ge->path);
+          QPixmap* pm = m_cover_pixmap_cache->Lookup(ge->path);
           if (pm)
             return *pm;
 
           // We insert the placeholder into the cache, so that we don't repeatedly
           // queue loading jobs for this game.
           const_cast<GameListModel*>(this)->loadOrGenerateCover(ge);
-          return *m_cover_pixmap_cache.Insert(ge->path, m_loading_pixmap);
+          return *m_cover_pixmap_cache->Insert(ge->path, m_loading_pixmap);
         }
         break;
 
@@ -414,6 +464,9 @@ QVariant GameListModel::headerData(int section, Qt::Orientation orientation, int
 void GameListModel::refresh()
 {
   beginResetModel();
+  m_sort_keys_column = -1;
+  m_sort_keys.clear();
+  m_title_sort_keys.clear();
   endResetModel();
 }
 
@@ -430,123 +483,100 @@ bool GameListModel::titlesLessThan(int left_row, int right_row) const
   return (StringUtil::Strcasecmp(left->title.c_str(), right->title.c_str()) < 0);
 }
 
-bool GameListModel::lessThan(const QModelIndex& left_index, const QModelIndex& right_index, int column) const
+void GameListModel::updateSortKeys(int column) const
 {
-  if (!left_index.isValid() || !right_index.isValid())
-    return false;
-
-  const int left_row = left_index.row();
-  const int right_row = right_index.row();
-  if (left_row < 0 || left_row >= static_cast<int>(GameList::GetEntryCount()) || right_row < 0 ||
-      right_row >= static_cast<int>(GameList::GetEntryCount()))
-  {
-    return false;
-  }
-
   const auto lock = GameList::GetLock();
-  const GameList::Entry* left = GameList::GetEntryByIndex(left_row);
-  const GameList::Entry* right = GameList::GetEntryByIndex(right_row);
-  if (!left || !right)
-    return false;
-
-  switch (column)
+  const u32 count = GameList::GetEntryCount();
+  m_title_sort_keys.resize(count);
+  m_sort_keys.resize(count);
+  for (u32 i = 0; i < count; i++)
   {
-    case Column_Type:
-    {
-      if (left->type == right->type)
-        return titlesLessThan(left_row, right_row);
-
-      return (static_cast<int>(left->type) < static_cast<int>(right->type));
-    }
-
-    case Column_Serial:
-    {
-      if (left->serial == right->serial)
-        return titlesLessThan(left_row, right_row);
-      return (StringUtil::Strcasecmp(left->serial.c_str(), right->serial.c_str()) < 0);
-    }
-
-    case Column_Title:
-    {
-      return titlesLessThan(left_row, right_row);
-    }
+    const GameList::Entry* ge = GameList::GetEntryByIndex(i);
+    m_title_sort_keys[i] = toLowerSortKey(ge->title);
 
-    case Column_FileTitle:
+    SortKey& key = m_sort_keys[i];
+    key.text.clear();
+    key.value = 0;
+    switch (column)
     {
-      const std::string_view file_title_left(Path::GetFileTitle(left->path));
-      const std::string_view file_title_right(Path::GetFileTitle(right->path));
-      if (file_title_left == file_title_right)
-        return titlesLessThan(left_row, right_row);
+      case Column_Type:
+        key.value = static_cast<u64>(ge->type);
+        break;
 
-      const std::size_t smallest = std::min(file_title_left.size(), file_title_right.size());
-      return (StringUtil::Strncasecmp(file_title_left.data(), file_title_right.data(), smallest) < 0);
-    }
+      case Column_Serial:
+        key.text = toLowerSortKey(ge->serial);
+        break;
 
-    case Column_Region:
-    {
-      if (left->region == right->region)
-        return titlesLessThan(left_row, right_row);
-      return (static_cast<int>(left->region) < static_cast<int>(right->region));
-    }
+      case Column_FileTitle:
+        key.text = toLowerSortKey(Path::GetFileTitle(ge->path));
+        break;
 
-    case Column_Compatibility:
-    {
-      if (left->compatibility == right->compatibility)
-        return titlesLessThan(left_row, right_row);
+      case Column_Developer:
+        key.text = toLowerSortKey(ge->developer);
+        break;
 
-      return (static_cast<int>(left->compatibility) < static_cast<int>(right->compatibility));
-    }
+      case Column_Publisher:
+        key.text = toLowerSortKey(ge->publisher);
+        break;
 
-    case Column_Size:
-    {
-      if (left->total_size == right->total_size)
-        return titlesLessThan(left_row, right_row);
+      case Column_Genre:
+        key.text = toLowerSortKey(ge->genre);
+        break;
 
-      return (left->total_size < right->total_size);
-    }
+      case Column_Year:
+        key.value = static_cast<u64>(ge->release_date);
+        break;
 
-    case Column_Genre:
-    {
-      if (left->genre == right->genre)
-        return titlesLessThan(left_row, right_row);
-      return (StringUtil::Strcasecmp(left->genre.c_str(), right->genre.c_str()) < 0);
-    }
+      case Column_Players:
+        key.value = (static_cast<u64>(ge->min_players) << 8) | static_cast<u64>(ge->max_players);
+        break;
 
-    case Column_Developer:
-    {
-      if (left->developer == right->developer)
-        return titlesLessThan(left_row, right_row);
-      return (StringUtil::Strcasecmp(left->developer.c_str(), right->developer.c_str()) < 0);
-    }
+      case Column_Size:
+        key.value = ge->total_size;
+        break;
 
-    case Column_Publisher:
-    {
-      if (left->publisher == right->publisher)
-        return titlesLessThan(left_row, right_row);
-      return (StringUtil::Strcasecmp(left->publisher.c_str(), right->publisher.c_str()) < 0);
-    }
+      case Column_Region:
+        key.value = static_cast<u64>(ge->region);
+        break;
 
-    case Column_Year:
-    {
-      if (left->release_date == right->release_date)
-        return titlesLessThan(left_row, right_row);
+      case Column_Compatibility:
+        key.value = static_cast<u64>(ge->compatibility);
+        break;
 
-      return (left->release_date < right->release_date);
+      default:
+        break;
     }
+  }
 
-    case Column_Players:
-    {
-      u8 left_players = (left->min_players << 4) + left->max_players;
-      u8 right_players = (right->min_players << 4) + right->max_players;
-      if (left_players == right_players)
-        return titlesLessThan(left_row, right_row);
+  m_sort_keys_column = column;
+}
 
-      return (left_players < right_players);
-    }
+bool GameListModel::lessThan(const QModelIndex& left_index, const QModelIndex& right_index, int column) const
+{
+  if (!left_index.isValid() || !right_index.isValid() || column < 0 || column >= Column_Cover)
+    return false;
 
-    default:
+  // keys are built once per sort, rather than locking and comparing entries for every pair
+  const size_t left_row = static_cast<size_t>(left_index.row());
+  const size_t right_row = static_cast<size_t>(right_index.row());
+  if (column != m_sort_keys_column || left_row >= m_sort_keys.size() || right_row >= m_sort_keys.size())
+  {
+    updateSortKeys(column);
+    if (left_row >= m_sort_keys.size() || right_row >= m_sort_keys.size())
       return false;
   }
+
+  if (column != Column_Title)
+  {
+    const SortKey& left = m_sort_keys[left_row];
+    const SortKey& right = m_sort_keys[right_row];
+    if (left.text != right.text)
+      return (left.text < right.text);
+    if (left.value != right.value)
+      return (left.value < right.value);
+  }
+
+  return (m_title_sort_keys[left_row] < m_title_sort_keys[right_row]);
 }
 
 void GameListModel::loadCommonImages()
@@ -560,7 +590,7 @@ void GameListModel::loadCommonImages()
   for (int i = 0; i < static_cast<int>(GameDatabase::CompatibilityRating::Count); i++)
     m_compatibility_pixmaps[i] = QtUtils::GetIconForCompatibility(static_cast<GameDatabase::CompatibilityRating>(i)).pixmap(96, 24);
 
-  m_placeholder_pixmap.load(QStringLiteral("%1/images/cover-placeholder.png").arg(QtHost::GetResourcesBasePath()));
+  m_placeholder_image.load(QStringLiteral("%1/images/cover-placeholder.png").arg(QtHost::GetResourcesBasePath()));
 }
 
 void GameListModel::setColumnDisplayNames()
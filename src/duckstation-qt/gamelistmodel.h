@@ -5,10 +5,16 @@
 #include "core/types.h"
 #include "frontend-common/game_list.h"
 #include <QtCore/QAbstractTableModel>
+#include <QtCore/QThreadPool>
+#include <QtGui/QImage>
 #include <QtGui/QPixmap>
 #include <algorithm>
 #include <array>
+#include <memory>
 #include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 class GameListModel final : public QAbstractTableModel
 {
@@ -66,10 +72,22 @@ public:
   void reloadCommonImages();
 
 private:
+  using CoverPixmapCache = LRUCache<std::string, QPixmap>;
+
+  // Sorting compares these rather than the entries, so it doesn't need the game list lock for every comparison.
+  // Text is lowercase, and numeric columns only use the value.
+  struct SortKey
+  {
+    std::string text;
+    u64 value;
+  };
+
   void loadCommonImages();
   void setColumnDisplayNames();
   void loadOrGenerateCover(const GameList::Entry* ge);
   void invalidateCoverForPath(const std::string& path);
+  CoverPixmapCache* findCoverPixmapCache(int width);
+  void updateSortKeys(int column) const;
 
   float m_cover_scale = 0.0f;
   bool m_show_titles_for_covers = false;
@@ -79,8 +97,18 @@ private:
   std::array<QPixmap, static_cast<int>(DiscRegion::Count)> m_region_pixmaps;
   std::array<QPixmap, static_cast<int>(GameDatabase::CompatibilityRating::Count)> m_compatibility_pixmaps;
 
-  QPixmap m_placeholder_pixmap;
+  QImage m_placeholder_image;
   QPixmap m_loading_pixmap;
 
-  mutable LRUCache<std::string, QPixmap> m_cover_pixmap_cache;
+  // scaled covers for the current size first, then the sizes they were last shown at
+  std::vector<std::pair<int, std::unique_ptr<CoverPixmapCache>>> m_cover_pixmap_caches;
+  CoverPixmapCache* m_cover_pixmap_cache = nullptr;
+  u32 m_cover_generation = 0;
+
+  mutable std::vector<SortKey> m_sort_keys;
+  mutable std::vector<std::string> m_title_sort_keys;
+  mutable int m_sort_keys_column = -1;
+
+  // declared last, so any loads still running finish before the rest of the model is destroyed
+  QThreadPool m_cover_thread_pool;
 };
\ No newline at end of file
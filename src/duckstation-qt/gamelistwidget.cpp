@@ -8,7 +8,10 @@
 #include "gamelistrefreshthread.h"
 #include "qthost.h"
 #include "qtutils.h"
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QSet>
 #include <QtCore/QSortFilterProxyModel>
+#include <QtCore/QTimer>
 #include <QtGui/QGuiApplication>
 #include <QtGui/QPixmap>
 #include <QtGui/QWheelEvent>
@@ -18,6 +21,9 @@
 static constexpr float MIN_SCALE = 0.1f;
 static constexpr float MAX_SCALE = 2.0f;
 
+// copying an image to a game directory can take a while, so wait for the changes to stop before scanning
+static constexpr int DIRECTORY_CHANGE_REFRESH_DELAY_MS = 2000;
+
 static const char* SUPPORTED_FORMATS_STRING =
   QT_TRANSLATE_NOOP(GameListWidget, ".cue (Cue Sheets)\n"
                                     ".iso/.img (Single Track Image)\n"
@@ -187,6 +193,18 @@ void GameListWidget::initialize()
   else
     m_ui.stack->setCurrentIndex(0);
 
+  if (Host::GetBaseBoolSettingValue("GameList", "WatchDirectories", true))
+  {
+    m_directory_watcher = new QFileSystemWatcher(this);
+    connect(m_directory_watcher, &QFileSystemWatcher::directoryChanged, this,
+            &GameListWidget::onWatchedDirectoryChanged);
+
+    m_directory_change_timer = new QTimer(this);
+    m_directory_change_timer->setSingleShot(true);
+    m_directory_change_timer->setInterval(DIRECTORY_CHANGE_REFRESH_DELAY_MS);
+    connect(m_directory_change_timer, &QTimer::timeout, this, &GameListWidget::onDirectoryChangeTimerExpired);
+  }
+
   updateToolbar();
   resizeTableViewColumnsToFit();
 }
@@ -252,6 +270,50 @@ void GameListWidget::onRefreshComplete()
   // if we still had no games, switch to the helper widget
   if (m_model->rowCount() == 0)
     m_ui.stack->setCurrentIndex(2);
+
+  updateDirectoryWatcher();
+}
+
+void GameListWidget::onWatchedDirectoryChanged()
+{
+  // restarting the timer means a long copy only triggers one refresh
+  m_directory_change_timer->start();
+}
+
+void GameListWidget::onDirectoryChangeTimerExpired()
+{
+  // don't interrupt a refresh the user started, try again once it's done
+  if (m_refresh_thread)
+  {
+    m_directory_change_timer->start();
+    return;
+  }
+
+  // only the directories which changed are listed again, and only new files are opened
+  refresh(false);
+}
+
+void GameListWidget::updateDirectoryWatcher()
+{
+  if (!m_directory_watcher)
+    return;
+
+  QSet<QString> directories;
+  for (const std::string& directory : GameList::GetScannedDirectories())
+    directories.insert(QString::fromStdString(directory));
+
+  const QStringList watched_directories(m_directory_watcher->directories());
+  QStringList removed_directories;
+  for (const QString& directory : watched_directories)
+  {
+    if (!directories.remove(directory))
+      removed_directories.push_back(directory);
+  }
+
+  if (!removed_directories.isEmpty())
+    m_directory_watcher->removePaths(removed_directories);
+  if (!directories.isEmpty())
+    m_directory_watcher->addPaths(directories.values());
 }
 
 void GameListWidget::onSelectionModelCurrentChanged(const QModelIndex& current, const QModelIndex& previous)
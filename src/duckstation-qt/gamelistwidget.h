@@ -10,6 +10,8 @@ Q_DECLARE_METATYPE(const GameList::Entry*);
 class GameListModel;
 class GameListSortModel;
 class GameListRefreshThread;
+class QFileSystemWatcher;
+class QTimer;
 
 class GameListGridListView : public QListView
 {
@@ -63,6 +65,8 @@ Q_SIGNALS:
 private Q_SLOTS:
   void onRefreshProgress(const QString& status, int current, int total);
   void onRefreshComplete();
+  void onWatchedDirectoryChanged();
+  void onDirectoryChangeTimerExpired();
 
   void onSelectionModelCurrentChanged(const QModelIndex& current, const QModelIndex& previous);
   void onTableViewItemActivated(const QModelIndex& index);
@@ -93,6 +97,7 @@ private:
   void listZoom(float delta);
   void updateListFont();
   void updateToolbar();
+  void updateDirectoryWatcher();
 
   Ui::GameListWidget m_ui;
 
@@ -105,4 +110,8 @@ private:
   Ui::EmptyGameListWidget m_empty_ui;
 
   GameListRefreshThread* m_refresh_thread = nullptr;
+
+  // refreshes when files are added to or removed from the game directories, after they've settled
+  QFileSystemWatcher* m_directory_watcher = nullptr;
+  QTimer* m_directory_change_timer = nullptr;
 };
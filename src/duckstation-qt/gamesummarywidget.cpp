@@ -1,10 +1,13 @@
 #include "gamesummarywidget.h"
+#include "common/path.h"
 #include "common/string_util.h"
 #include "core/game_database.h"
+#include "core/settings.h"
 #include "fmt/format.h"
 #include "frontend-common/game_list.h"
 #include "qthost.h"
 #include "qtprogresscallback.h"
+#include "qtutils.h"
 #include "settingsdialog.h"
 #include <QtConcurrent/QtConcurrent>
 #include <QtCore/QFuture>
@@ -56,17 +59,17 @@ void GameSummaryWidget::populateUi(const std::string& path, const std::string& s
 
   if (entry)
   {
-    m_ui.title->setText(QString::fromStdString(entry->title));
+    m_ui.title->setText(QtUtils::StringViewToQString(entry->title));
     m_ui.compatibility->setCurrentIndex(static_cast<int>(entry->compatibility));
-    m_ui.genre->setText(entry->genre.empty() ? tr("Unknown") : QString::fromStdString(entry->genre));
+    m_ui.genre->setText(entry->genre.empty() ? tr("Unknown") : QtUtils::StringViewToQString(entry->genre));
     if (!entry->developer.empty() && !entry->publisher.empty() && entry->developer != entry->publisher)
       m_ui.developer->setText(tr("%1 (Published by %2)")
-                                .arg(QString::fromStdString(entry->developer))
-                                .arg(QString::fromStdString(entry->publisher)));
+                                .arg(QtUtils::StringViewToQString(entry->developer))
+                                .arg(QtUtils::StringViewToQString(entry->publisher)));
     else if (!entry->developer.empty())
-      m_ui.developer->setText(QString::fromStdString(entry->developer));
+      m_ui.developer->setText(QtUtils::StringViewToQString(entry->developer));
     else if (!entry->publisher.empty())
-      m_ui.developer->setText(tr("Published by %1").arg(QString::fromStdString(entry->publisher)));
+      m_ui.developer->setText(tr("Published by %1").arg(QtUtils::StringViewToQString(entry->publisher)));
     else
       m_ui.developer->setText(tr("Unknown"));
 
@@ -221,31 +224,20 @@ void GameSummaryWidget::onComputeHashClicked()
 #endif
 
   QtModalProgressCallback progress_callback(this);
-  progress_callback.SetProgressRange(image->GetTrackCount());
 
+  // Calculate hashes, tracks are hashed in parallel, and remembered until the file changes
   std::vector<CDImageHasher::Hash> track_hashes;
-  track_hashes.reserve(image->GetTrackCount());
-
-  // Calculate hashes
-  bool calculate_hash_success = true;
-  for (u8 track = 1; track <= image->GetTrackCount(); track++)
+  const std::string cache_filename(Path::Combine(EmuFolders::Cache, "trackhashes.cache"));
+  const bool calculate_hash_success =
+    CDImageHasher::GetTrackHashes(m_path.c_str(), &track_hashes, cache_filename.c_str(), &progress_callback) &&
+    track_hashes.size() == image->GetTrackCount();
+  if (calculate_hash_success)
   {
-    progress_callback.SetProgressValue(track - 1);
-    progress_callback.PushState();
-
-    CDImageHasher::Hash hash;
-    if (!CDImageHasher::GetTrackHash(image.get(), track, &hash, &progress_callback))
+    for (u32 track = 1; track <= image->GetTrackCount(); track++)
     {
-      progress_callback.PopState();
-      calculate_hash_success = false;
-      break;
+      QTableWidgetItem* item = m_ui.tracks->item(track - 1, 4);
+      item->setText(QString::fromStdString(CDImageHasher::HashToString(track_hashes[track - 1])));
     }
-    track_hashes.emplace_back(hash);
-
-    QTableWidgetItem* item = m_ui.tracks->item(track - 1, 4);
-    item->setText(QString::fromStdString(CDImageHasher::HashToString(hash)));
-
-    progress_callback.PopState();
   }
 
   // Verify hashes against gamedb
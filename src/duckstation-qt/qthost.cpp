@@ -5,6 +5,7 @@
 #include "common/file_system.h"
 #include "common/log.h"
 #include "common/path.h"
+#include "common/threading.h"
 #include "common/string_util.h"
 #include "core/cheats.h"
 #include "core/controller.h"
@@ -15,6 +16,7 @@
 #include "core/memory_card.h"
 #include "core/spu.h"
 #include "core/system.h"
+#include "core/texture_replacements.h"
 #include "displaywidget.h"
 #include "frontend-common/fullscreen_ui.h"
 #include "frontend-common/game_list.h"
@@ -586,15 +588,15 @@ void EmuThread::onDisplayWindowMouseButtonEvent(int button, bool pressed)
                              GenericInputBinding::Unknown);
 }
 
-void EmuThread::onDisplayWindowMouseWheelEvent(const QPoint& delta_angle)
+void EmuThread::onDisplayWindowMouseWheelEvent(float delta_x, float delta_y)
 {
   DebugAssert(isOnThread());
 
-  const float dx = std::clamp(static_cast<float>(delta_angle.x()) / QtUtils::MOUSE_WHEEL_DELTA, -1.0f, 1.0f);
+  const float dx = std::clamp(delta_x / QtUtils::MOUSE_WHEEL_DELTA, -1.0f, 1.0f);
   if (dx != 0.0f)
     InputManager::UpdatePointerRelativeDelta(0, InputPointerAxis::WheelX, dx);
 
-  const float dy = std::clamp(static_cast<float>(delta_angle.y()) / QtUtils::MOUSE_WHEEL_DELTA, -1.0f, 1.0f);
+  const float dy = std::clamp(delta_y / QtUtils::MOUSE_WHEEL_DELTA, -1.0f, 1.0f);
   if (dy != 0.0f)
     InputManager::UpdatePointerRelativeDelta(0, InputPointerAxis::WheelY, dy);
 }
@@ -767,13 +769,108 @@ void EmuThread::connectDisplaySignals(DisplayWidget* widget)
 {
   widget->disconnect(this);
 
-  connect(widget, &DisplayWidget::windowResizedEvent, this, &EmuThread::onDisplayWindowResized);
   connect(widget, &DisplayWidget::windowRestoredEvent, this, &EmuThread::redrawDisplayWindow);
-  connect(widget, &DisplayWidget::windowKeyEvent, this, &EmuThread::onDisplayWindowKeyEvent);
   connect(widget, &DisplayWidget::windowTextEntered, this, &EmuThread::onDisplayWindowTextEntered);
-  connect(widget, &DisplayWidget::windowMouseMoveEvent, this, &EmuThread::onDisplayWindowMouseMoveEvent);
-  connect(widget, &DisplayWidget::windowMouseButtonEvent, this, &EmuThread::onDisplayWindowMouseButtonEvent);
-  connect(widget, &DisplayWidget::windowMouseWheelEvent, this, &EmuThread::onDisplayWindowMouseWheelEvent);
+
+  // these run on the UI thread, and only queue the event for us
+  connect(
+    widget, &DisplayWidget::windowResizedEvent, this,
+    [this](int width, int height, float scale) { queueDisplayWindowResize(width, height); }, Qt::DirectConnection);
+  connect(
+    widget, &DisplayWidget::windowKeyEvent, this,
+    [this](int key_code, bool pressed) {
+      queueDisplayWindowEvent(DisplayWindowEvent{DisplayWindowEvent::Type::Key, pressed, key_code, 0.0f, 0.0f});
+    },
+    Qt::DirectConnection);
+  connect(
+    widget, &DisplayWidget::windowMouseMoveEvent, this,
+    [this](bool relative, float x, float y) {
+      queueDisplayWindowEvent(DisplayWindowEvent{
+        relative ? DisplayWindowEvent::Type::RelativeMouseMove : DisplayWindowEvent::Type::MouseMove, false, 0, x, y});
+    },
+    Qt::DirectConnection);
+  connect(
+    widget, &DisplayWidget::windowMouseButtonEvent, this,
+    [this](int button, bool pressed) {
+      queueDisplayWindowEvent(DisplayWindowEvent{DisplayWindowEvent::Type::MouseButton, pressed, button, 0.0f, 0.0f});
+    },
+    Qt::DirectConnection);
+  connect(
+    widget, &DisplayWidget::windowMouseWheelEvent, this,
+    [this](const QPoint& angle_delta) {
+      queueDisplayWindowEvent(DisplayWindowEvent{DisplayWindowEvent::Type::MouseWheel, false, 0,
+                                                 static_cast<float>(angle_delta.x()),
+                                                 static_cast<float>(angle_delta.y())});
+    },
+    Qt::DirectConnection);
+}
+
+void EmuThread::queueDisplayWindowEvent(const DisplayWindowEvent& event)
+{
+  const u32 write_pos = m_display_window_events_write_pos.load(std::memory_order_relaxed);
+  if ((write_pos - m_display_window_events_read_pos.load(std::memory_order_acquire)) ==
+      DISPLAY_WINDOW_EVENT_QUEUE_SIZE)
+  {
+    Log_WarningPrintf("Display window event queue is full, dropping event.");
+    return;
+  }
+
+  m_display_window_events[write_pos & DISPLAY_WINDOW_EVENT_QUEUE_MASK] = event;
+  m_display_window_events_write_pos.store(write_pos + 1, std::memory_order_release);
+
+  // while running, the events are picked up when messages are pumped, this is for when we're sitting in the event loop
+  if (!m_display_window_events_wake_pending.exchange(true, std::memory_order_acq_rel))
+    QMetaObject::invokeMethod(this, &EmuThread::processDisplayWindowEvents, Qt::QueuedConnection);
+}
+
+void EmuThread::queueDisplayWindowResize(int width, int height)
+{
+  m_display_window_pending_size.store((static_cast<u64>(static_cast<u32>(width)) << 32) | static_cast<u32>(height),
+                                      std::memory_order_release);
+  m_display_window_resize_pending.store(true, std::memory_order_release);
+
+  if (!m_display_window_events_wake_pending.exchange(true, std::memory_order_acq_rel))
+    QMetaObject::invokeMethod(this, &EmuThread::processDisplayWindowEvents, Qt::QueuedConnection);
+}
+
+void EmuThread::processDisplayWindowEvents()
+{
+  DebugAssert(isOnThread());
+  m_display_window_events_wake_pending.store(false, std::memory_order_release);
+
+  if (m_display_window_resize_pending.exchange(false, std::memory_order_acq_rel))
+  {
+    const u64 size = m_display_window_pending_size.load(std::memory_order_acquire);
+    onDisplayWindowResized(static_cast<int>(size >> 32), static_cast<int>(static_cast<u32>(size)));
+  }
+
+  const u32 write_pos = m_display_window_events_write_pos.load(std::memory_order_acquire);
+  u32 read_pos = m_display_window_events_read_pos.load(std::memory_order_relaxed);
+  for (; read_pos != write_pos; read_pos++)
+  {
+    const DisplayWindowEvent& event = m_display_window_events[read_pos & DISPLAY_WINDOW_EVENT_QUEUE_MASK];
+    switch (event.type)
+    {
+      case DisplayWindowEvent::Type::Key:
+        onDisplayWindowKeyEvent(event.code, event.pressed);
+        break;
+
+      case DisplayWindowEvent::Type::MouseMove:
+      case DisplayWindowEvent::Type::RelativeMouseMove:
+        onDisplayWindowMouseMoveEvent(event.type == DisplayWindowEvent::Type::RelativeMouseMove, event.x, event.y);
+        break;
+
+      case DisplayWindowEvent::Type::MouseButton:
+        onDisplayWindowMouseButtonEvent(event.code, event.pressed);
+        break;
+
+      case DisplayWindowEvent::Type::MouseWheel:
+        onDisplayWindowMouseWheelEvent(event.x, event.y);
+        break;
+    }
+  }
+
+  m_display_window_events_read_pos.store(read_pos, std::memory_order_release);
 }
 
 void EmuThread::updateDisplayState()
@@ -1255,6 +1352,21 @@ void EmuThread::dumpSPURAM(const QString& filename)
     Host::ReportErrorAsync("Error", fmt::format("Failed to dump SPU RAM to '{}'", filename_str));
 }
 
+void EmuThread::buildTextureReplacementPack()
+{
+  if (!isOnThread())
+  {
+    QMetaObject::invokeMethod(this, "buildTextureReplacementPack", Qt::QueuedConnection);
+    return;
+  }
+
+  std::string filename;
+  if (g_texture_replacements.BuildPack(&filename))
+    Host::AddOSDMessage(fmt::format("Texture replacement pack written to '{}'", filename), 10.0f);
+  else
+    Host::ReportErrorAsync("Error", "Failed to build texture replacement pack, check the log for details.");
+}
+
 void EmuThread::saveScreenshot()
 {
   if (!isOnThread())
@@ -1314,7 +1426,8 @@ void Host::OnAchievementsChallengeModeChanged()
 
 void EmuThread::doBackgroundControllerPoll()
 {
-  InputManager::PollSources();
+  if (InputManager::PollSources() && m_idle_waiting)
+    m_event_loop->quit();
 }
 
 void EmuThread::createBackgroundControllerPollTimer()
@@ -1379,6 +1492,7 @@ void EmuThread::stopInThread()
 
 void EmuThread::run()
 {
+  Threading::SetNameOfCurrentThread("CPU Thread");
   m_event_loop = new QEventLoop();
   m_started_semaphore.release();
 
@@ -1389,6 +1503,10 @@ void EmuThread::run()
   createBackgroundControllerPollTimer();
   startBackgroundControllerPollTimer();
 
+  m_idle_timer = new QTimer(this);
+  m_idle_timer->setSingleShot(true);
+  connect(m_idle_timer, &QTimer::timeout, m_event_loop, &QEventLoop::quit);
+
   // main loop
   while (!m_shutdown_flag)
   {
@@ -1409,13 +1527,15 @@ void EmuThread::run()
       m_event_loop->processEvents(QEventLoop::AllEvents);
       CommonHost::PumpMessagesOnCPUThread();
       if (g_host_display)
-        renderDisplay(false);
+        renderDisplay(false, true);
     }
   }
 
   if (System::IsValid())
     System::ShutdownSystem(false);
 
+  delete m_idle_timer;
+  m_idle_timer = nullptr;
   destroyBackgroundControllerPollTimer();
   CommonHost::Shutdown();
 
@@ -1423,22 +1543,50 @@ void EmuThread::run()
   moveToThread(m_ui_thread);
 }
 
-void EmuThread::renderDisplay(bool skip_present)
+void EmuThread::renderDisplay(bool skip_present, bool skip_if_unchanged)
 {
   // acquire for IO.MousePos.
   std::atomic_thread_fence(std::memory_order_acquire);
 
+  bool skipped_unchanged = false;
   if (!skip_present)
   {
     FullscreenUI::Render();
     ImGuiManager::RenderOverlays();
     ImGuiManager::RenderOSD();
     ImGuiManager::RenderDebugWindows();
+
+    // the display texture can't change while we're not running, so if the UI is the same, so is the whole frame
+    skipped_unchanged = (!ImGuiManager::HasFrameChanged() && skip_if_unchanged);
   }
 
-  g_host_display->Render(skip_present);
+  g_host_display->Render(skip_present || skipped_unchanged);
 
   ImGuiManager::NewFrame();
+
+  // nothing to draw until there's input or queued work, or a texture finishes loading
+  const u32 idle_timeout = CommonHost::GetIdleWaitTimeout(skipped_unchanged);
+  if (idle_timeout > 0)
+    waitForIdleEvents(idle_timeout);
+}
+
+void EmuThread::waitForIdleEvents(u32 timeout_ms)
+{
+  m_idle_waiting = true;
+  m_idle_timer->start(static_cast<int>(timeout_ms));
+  m_event_loop->exec();
+  m_idle_timer->stop();
+  m_idle_waiting = false;
+}
+
+bool EmuThread::event(QEvent* event)
+{
+  // input from the display widget and requests from the UI thread all arrive as queued calls
+  const bool result = QThread::event(event);
+  if (m_idle_waiting && event->type() == QEvent::MetaCall)
+    m_event_loop->quit();
+
+  return result;
 }
 
 void Host::InvalidateDisplay()
@@ -1679,6 +1827,7 @@ void Host::SetMouseMode(bool relative, bool hide_cursor)
 
 void Host::PumpMessagesOnCPUThread()
 {
+  g_emu_thread->processDisplayWindowEvents();
   g_emu_thread->getEventLoop()->processEvents(QEventLoop::AllEvents);
   CommonHost::PumpMessagesOnCPUThread(); // calls InputManager::PollSources()
 }
@@ -1864,6 +2013,9 @@ void QtHost::PrintCommandLineHelp(const char* progname)
                        "                 the emulator.\n");
   std::fprintf(stderr, "  -settings <filename>: Loads a custom settings configuration from the\n"
                        "    specified filename. Default settings applied if file not found.\n");
+  std::fprintf(stderr, "  -netplay <player>:<local port>:<host>:<port>[:<delay>]: Joins a two player\n"
+                       "    netplay session as player 1 or 2 once booted, with both sides using the\n"
+                       "    same game and settings. Delay is in frames, and defaults to 1.\n");
   std::fprintf(stderr, "  -earlyconsole: Creates console as early as possible, for logging.\n");
   std::fprintf(stderr, "  --: Signals that no more arguments will follow and the remaining\n"
                        "    parameters make up the filename. Use when the filename contains\n"
@@ -1995,6 +2147,12 @@ bool QtHost::ParseCommandLineParametersAndInitializeConfig(QApplication& app,
         s_start_fullscreen_ui = true;
         continue;
       }
+      else if (CHECK_ARG_PARAM("-netplay"))
+      {
+        AutoBoot(autoboot)->netplay_session = args[++i].toStdString();
+        Log_InfoPrintf("Command Line: Joining netplay session: %s", autoboot->netplay_session.c_str());
+        continue;
+      }
       else if (CHECK_ARG("-earlyconsole"))
       {
         InitializeEarlyConsole();
@@ -15,6 +15,7 @@
 #include <QtCore/QSettings>
 #include <QtCore/QString>
 #include <QtCore/QThread>
+#include <array>
 #include <atomic>
 #include <functional>
 #include <map>
@@ -93,8 +94,9 @@ public:
 
   bool acquireHostDisplay(RenderAPI api);
   void connectDisplaySignals(DisplayWidget* widget);
+  void processDisplayWindowEvents();
   void releaseHostDisplay();
-  void renderDisplay(bool skip_present);
+  void renderDisplay(bool skip_present, bool skip_if_unchanged = false);
 
   void startBackgroundControllerPollTimer();
   void stopBackgroundControllerPollTimer();
@@ -172,6 +174,7 @@ public Q_SLOTS:
   void dumpRAM(const QString& filename);
   void dumpVRAM(const QString& filename);
   void dumpSPURAM(const QString& filename);
+  void buildTextureReplacementPack();
   void saveScreenshot();
   void redrawDisplayWindow();
   void toggleFullscreen();
@@ -185,24 +188,53 @@ public Q_SLOTS:
 
 private Q_SLOTS:
   void stopInThread();
-  void onDisplayWindowMouseMoveEvent(bool relative, float x, float y);
-  void onDisplayWindowMouseButtonEvent(int button, bool pressed);
-  void onDisplayWindowMouseWheelEvent(const QPoint& delta_angle);
-  void onDisplayWindowResized(int width, int height);
-  void onDisplayWindowKeyEvent(int key, bool pressed);
   void onDisplayWindowTextEntered(const QString& text);
   void doBackgroundControllerPoll();
   void runOnEmuThread(std::function<void()> callback);
 
 protected:
   void run() override;
+  bool event(QEvent* event) override;
 
 private:
   using InputButtonHandler = std::function<void(bool)>;
   using InputAxisHandler = std::function<void(float)>;
 
+  enum : u32
+  {
+    DISPLAY_WINDOW_EVENT_QUEUE_SIZE = 256,
+    DISPLAY_WINDOW_EVENT_QUEUE_MASK = DISPLAY_WINDOW_EVENT_QUEUE_SIZE - 1,
+  };
+
+  struct DisplayWindowEvent
+  {
+    enum class Type : u8
+    {
+      Key,
+      MouseMove,
+      RelativeMouseMove,
+      MouseButton,
+      MouseWheel,
+    };
+
+    Type type;
+    bool pressed;
+    s32 code;
+    float x;
+    float y;
+  };
+
+  void queueDisplayWindowEvent(const DisplayWindowEvent& event);
+  void queueDisplayWindowResize(int width, int height);
+  void onDisplayWindowMouseMoveEvent(bool relative, float x, float y);
+  void onDisplayWindowMouseButtonEvent(int button, bool pressed);
+  void onDisplayWindowMouseWheelEvent(float delta_x, float delta_y);
+  void onDisplayWindowResized(int width, int height);
+  void onDisplayWindowKeyEvent(int key, bool pressed);
+
   void createBackgroundControllerPollTimer();
   void destroyBackgroundControllerPollTimer();
+  void waitForIdleEvents(u32 timeout_ms);
   void updateDisplayState();
 
   QThread* m_ui_thread;
@@ -210,6 +242,19 @@ private:
   QEventLoop* m_event_loop = nullptr;
   QTimer* m_background_controller_polling_timer = nullptr;
 
+  // While idle, queued calls and controller input end the wait early, otherwise the timer does.
+  QTimer* m_idle_timer = nullptr;
+  bool m_idle_waiting = false;
+
+  // Input and resizes from the display widget skip the Qt event loop, so a busy UI thread can't delay them. The UI
+  // thread is the only producer, and only the last resize matters.
+  std::array<DisplayWindowEvent, DISPLAY_WINDOW_EVENT_QUEUE_SIZE> m_display_window_events;
+  std::atomic<u32> m_display_window_events_read_pos{0};
+  std::atomic<u32> m_display_window_events_write_pos{0};
+  std::atomic<u64> m_display_window_pending_size{0};
+  std::atomic_bool m_display_window_resize_pending{false};
+  std::atomic_bool m_display_window_events_wake_pending{false};
+
   bool m_shutdown_flag = false;
   bool m_run_fullscreen_ui = false;
   bool m_is_rendering_to_main = false;
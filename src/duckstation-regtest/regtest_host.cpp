@@ -0,0 +1,1223 @@
+#include "common/assert.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/memory_settings_interface.h"
+#include "common/path.h"
+#include "common/string_util.h"
+#include "common/timer.h"
+#include "core/controller.h"
+#include "core/cpu_code_cache.h"
+#include "core/gpu_hw.h"
+#include "core/host.h"
+#include "core/host_display.h"
+#include "core/host_settings.h"
+#include "core/settings.h"
+#include "core/system.h"
+#include "frontend-common/common_host.h"
+#include "frontend-common/game_list.h"
+#include "frontend-common/input_manager.h"
+#include "regtest_host_display.h"
+#include "scmversion/scmversion.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <tuple>
+#include <utility>
+#include <vector>
+Log_SetChannel(RegTestHost);
+
+#ifdef WITH_CHEEVOS
+#include "frontend-common/achievements.h"
+#endif
+
+namespace RegTestHost {
+static bool SetFolders();
+static void InitializeSettings();
+static bool AcquireHostDisplay(RenderAPI api);
+static void ReleaseHostDisplay();
+static int RunFrames();
+} // namespace RegTestHost
+
+static MemorySettingsInterface s_base_settings_interface;
+
+static int s_frames_to_run = 60 * 60;
+static int s_frame_dump_interval = 0;
+static std::optional<SystemBootParameters> s_boot_parameters;
+static std::string s_dump_base_directory;
+static std::string s_dump_game_directory;
+static std::string s_block_profile_path;
+static GPURenderer s_renderer_to_use = GPURenderer::Software;
+static bool s_report_gpu_times = false;
+static bool s_benchmark = false;
+static int s_benchmark_warmup_frames = 0;
+static std::string s_benchmark_output_path;
+static std::string s_baseline_save_path;
+static std::string s_baseline_compare_path;
+static double s_regression_threshold = 5.0;
+static int s_hash_interval = 0;
+static std::string s_hash_log_path;
+static std::string s_hash_compare_path;
+
+namespace {
+struct BenchmarkResults
+{
+  // one sample per performance counter update (once a second), from after the warm-up
+  u32 num_samples = 0;
+  double vps = 0.0;
+  double cpu_thread_usage = 0.0;
+  double cpu_thread_time = 0.0;
+  double sw_thread_usage = 0.0;
+  double sw_thread_time = 0.0;
+
+  // summed every frame instead, System only collects it for frames it presents itself
+  double gpu_time = 0.0;
+
+  // counters at the end of the warm-up, so compiles during it aren't included
+  u32 start_compiled_blocks = 0;
+  u32 start_shader_compiles = 0;
+};
+
+// one line per game in a baseline file, keyed by serial
+struct BenchmarkBaseline
+{
+  std::string serial;
+  double vps = 0.0;
+  double frame_time_p99 = 0.0;
+  u32 compiled_blocks = 0;
+  u32 shader_compiles = 0;
+};
+} // namespace
+
+static bool s_benchmark_sampling = false;
+static BenchmarkResults s_benchmark_results;
+static std::vector<double> s_benchmark_frame_times;
+static Common::Timer s_benchmark_timer;
+
+namespace {
+struct FrameHashes
+{
+  int frame;
+  u64 ram;
+  u64 vram;
+  u64 spu_ram;
+};
+} // namespace
+
+static std::FILE* s_hash_log_file = nullptr;
+static std::vector<FrameHashes> s_reference_hashes;
+static size_t s_next_reference_hash = 0;
+
+bool RegTestHost::SetFolders()
+{
+  std::string program_path(FileSystem::GetProgramPath());
+  Log_InfoPrintf("Program Path: %s", program_path.c_str());
+
+  // everything lives next to the executable, the runner never touches the user's data directory
+  EmuFolders::AppRoot = Path::Canonicalize(Path::GetDirectory(program_path));
+  EmuFolders::DataRoot = EmuFolders::AppRoot;
+  EmuFolders::Resources = Path::Combine(EmuFolders::AppRoot, "resources");
+
+  Log_DevPrintf("AppRoot Directory: %s", EmuFolders::AppRoot.c_str());
+  Log_DevPrintf("DataRoot Directory: %s", EmuFolders::DataRoot.c_str());
+  Log_DevPrintf("Resources Directory: %s", EmuFolders::Resources.c_str());
+
+  if (!FileSystem::DirectoryExists(EmuFolders::Resources.c_str()))
+  {
+    Log_ErrorPrintf("Resources directory is missing, your installation is incomplete.");
+    return false;
+  }
+
+  return true;
+}
+
+void RegTestHost::InitializeSettings()
+{
+  SettingsInterface& si = s_base_settings_interface;
+  Host::Internal::SetBaseSettingsLayer(&si);
+
+  System::SetDefaultSettings(si);
+  CommonHost::SetDefaultSettings(si);
+  EmuFolders::SetDefaults();
+  EmuFolders::Save(si);
+
+  // Set the settings we need for testing.
+  si.SetStringValue("GPU", "Renderer", Settings::GetRendererName(s_renderer_to_use));
+  si.SetStringValue(Controller::GetSettingsSection(0).c_str(), "Type",
+                    Settings::GetControllerTypeName(ControllerType::DigitalController));
+  si.SetStringValue(Controller::GetSettingsSection(1).c_str(), "Type",
+                    Settings::GetControllerTypeName(ControllerType::None));
+  si.SetStringValue("MemoryCards", "Card1Type", Settings::GetMemoryCardTypeName(MemoryCardType::NonPersistent));
+  si.SetStringValue("MemoryCards", "Card2Type", Settings::GetMemoryCardTypeName(MemoryCardType::None));
+  si.SetStringValue("ControllerPorts", "MultitapMode", Settings::GetMultitapModeName(MultitapMode::Disabled));
+  si.SetStringValue("Audio", "Backend", Settings::GetAudioBackendName(AudioBackend::Null));
+  si.SetStringValue("Logging", "LogLevel", Settings::GetLogLevelName(LOGLEVEL_DEV));
+  si.SetBoolValue("Logging", "LogToConsole", true);
+  si.SetBoolValue("Display", "ShowGPU", s_report_gpu_times || s_benchmark);
+
+  if (s_benchmark)
+  {
+    // run as fast as possible, frames are never presented
+    si.SetFloatValue("Main", "EmulationSpeed", 0.0f);
+    si.SetBoolValue("Main", "SyncToHostRefreshRate", false);
+    si.SetBoolValue("Display", "VSync", false);
+  }
+
+  EmuFolders::LoadConfig(si);
+  EmuFolders::EnsureFoldersExist();
+}
+
+bool RegTestHost::AcquireHostDisplay(RenderAPI api)
+{
+  // the software renderer only needs somewhere to put the display texture for frame dumps
+  if (s_renderer_to_use == GPURenderer::Software)
+    g_host_display = std::make_unique<RegTestHostDisplay>();
+  else
+    g_host_display = Host::CreateDisplayForAPI(api);
+
+  if (!g_host_display)
+  {
+    Log_ErrorPrintf("Failed to create host display for the %s renderer", Settings::GetRendererName(s_renderer_to_use));
+    return false;
+  }
+
+  WindowInfo wi;
+  wi.type = WindowInfo::Type::Surfaceless;
+  wi.surface_width = 640;
+  wi.surface_height = 480;
+  if (!g_host_display->CreateRenderDevice(wi, std::string_view(), false, false))
+  {
+    Log_ErrorPrintf("Failed to create render device");
+    g_host_display.reset();
+    return false;
+  }
+
+  if (!g_host_display->InitializeRenderDevice(std::string_view(), false, false))
+  {
+    Log_ErrorPrintf("Failed to initialize render device");
+    g_host_display.reset();
+    return false;
+  }
+
+  return true;
+}
+
+void RegTestHost::ReleaseHostDisplay()
+{
+  g_host_display.reset();
+}
+
+void Host::ReportErrorAsync(const std::string_view& title, const std::string_view& message)
+{
+  if (!title.empty() && !message.empty())
+  {
+    Log_ErrorPrintf("ReportErrorAsync: %.*s: %.*s", static_cast<int>(title.size()), title.data(),
+                    static_cast<int>(message.size()), message.data());
+  }
+  else if (!message.empty())
+  {
+    Log_ErrorPrintf("ReportErrorAsync: %.*s", static_cast<int>(message.size()), message.data());
+  }
+}
+
+bool Host::ConfirmMessage(const std::string_view& title, const std::string_view& message)
+{
+  if (!title.empty() && !message.empty())
+  {
+    Log_ErrorPrintf("ConfirmMessage: %.*s: %.*s", static_cast<int>(title.size()), title.data(),
+                    static_cast<int>(message.size()), message.data());
+  }
+  else if (!message.empty())
+  {
+    Log_ErrorPrintf("ConfirmMessage: %.*s", static_cast<int>(message.size()), message.data());
+  }
+
+  return true;
+}
+
+void Host::ReportDebuggerMessage(const std::string_view& message)
+{
+  Log_ErrorPrintf("ReportDebuggerMessage: %.*s", static_cast<int>(message.size()), message.data());
+}
+
+void Host::OnInputDeviceConnected(const std::string_view& identifier, const std::string_view& device_name)
+{
+  // noop
+}
+
+void Host::OnInputDeviceDisconnected(const std::string_view& identifier)
+{
+  // noop
+}
+
+TinyString Host::TranslateString(const char* context, const char* str, const char* disambiguation, int n)
+{
+  return str;
+}
+
+std::string Host::TranslateStdString(const char* context, const char* str, const char* disambiguation, int n)
+{
+  return str;
+}
+
+std::optional<std::vector<u8>> Host::ReadResourceFile(const char* filename)
+{
+  const std::string path(Path::Combine(EmuFolders::Resources, filename));
+  std::optional<std::vector<u8>> ret(FileSystem::ReadBinaryFile(path.c_str()));
+  if (!ret.has_value())
+    Log_ErrorPrintf("Failed to read resource file '%s'", filename);
+  return ret;
+}
+
+std::optional<std::string> Host::ReadResourceFileToString(const char* filename)
+{
+  const std::string path(Path::Combine(EmuFolders::Resources, filename));
+  std::optional<std::string> ret(FileSystem::ReadFileToString(path.c_str()));
+  if (!ret.has_value())
+    Log_ErrorPrintf("Failed to read resource file to string '%s'", filename);
+  return ret;
+}
+
+std::optional<std::time_t> Host::GetResourceFileTimestamp(const char* filename)
+{
+  const std::string path(Path::Combine(EmuFolders::Resources, filename));
+  FILESYSTEM_STAT_DATA sd;
+  if (!FileSystem::StatFile(path.c_str(), &sd))
+  {
+    Log_ErrorPrintf("Failed to stat resource file '%s'", filename);
+    return std::nullopt;
+  }
+
+  return sd.ModificationTime;
+}
+
+void Host::LoadSettings(SettingsInterface& si, std::unique_lock<std::mutex>& lock)
+{
+  CommonHost::LoadSettings(si, lock);
+}
+
+void Host::CheckForSettingsChanges(const Settings& old_settings)
+{
+  CommonHost::CheckForSettingsChanges(old_settings);
+}
+
+void Host::CommitBaseSettingChanges()
+{
+  // settings are only held in memory
+}
+
+bool Host::AcquireHostDisplay(RenderAPI api)
+{
+  if (g_host_display && (s_renderer_to_use == GPURenderer::Software || g_host_display->GetRenderAPI() == api))
+    return true;
+
+  RegTestHost::ReleaseHostDisplay();
+  return RegTestHost::AcquireHostDisplay(api);
+}
+
+void Host::ReleaseHostDisplay()
+{
+  // kept until the runner exits, same as the renderer
+}
+
+void Host::OnSystemStarting()
+{
+  Log_VerbosePrintf("Host::OnSystemStarting()");
+}
+
+void Host::OnSystemStarted()
+{
+  Log_VerbosePrintf("Host::OnSystemStarted()");
+}
+
+void Host::OnSystemPaused()
+{
+  Log_VerbosePrintf("Host::OnSystemPaused()");
+}
+
+void Host::OnSystemResumed()
+{
+  Log_VerbosePrintf("Host::OnSystemResumed()");
+}
+
+void Host::OnSystemDestroyed()
+{
+  Log_VerbosePrintf("Host::OnSystemDestroyed()");
+}
+
+void Host::InvalidateDisplay()
+{
+  // noop
+}
+
+void Host::RenderDisplay(bool skip_present)
+{
+  g_host_display->Render(skip_present);
+}
+
+void Host::RequestResizeHostDisplay(s32 width, s32 height)
+{
+  // noop
+}
+
+void Host::OpenURL(const std::string_view& url)
+{
+  // noop
+}
+
+bool Host::CopyTextToClipboard(const std::string_view& text)
+{
+  return false;
+}
+
+void Host::OnPerformanceCountersUpdated()
+{
+  if (!s_benchmark_sampling)
+    return;
+
+  BenchmarkResults& res = s_benchmark_results;
+  res.num_samples++;
+  res.vps += System::GetVPS();
+  res.cpu_thread_usage += System::GetCPUThreadUsage();
+  res.cpu_thread_time += System::GetCPUThreadAverageTime();
+  res.sw_thread_usage += System::GetSWThreadUsage();
+  res.sw_thread_time += System::GetSWThreadAverageTime();
+}
+
+void Host::OnGameChanged(const std::string& disc_path, const std::string& game_serial, const std::string& game_name)
+{
+  // also called with nothing when the system shuts down
+  if (disc_path.empty())
+    return;
+
+  Log_InfoPrintf("Disc Path: %s", disc_path.c_str());
+  Log_InfoPrintf("Game Serial: %s", game_serial.c_str());
+  Log_InfoPrintf("Game Name: %s", game_name.c_str());
+
+  if (!s_dump_base_directory.empty())
+  {
+    s_dump_game_directory = Path::Combine(s_dump_base_directory, game_name);
+    if (!FileSystem::DirectoryExists(s_dump_game_directory.c_str()))
+    {
+      Log_InfoPrintf("Creating directory '%s'...", s_dump_game_directory.c_str());
+      if (!FileSystem::CreateDirectory(s_dump_game_directory.c_str(), false))
+        Panic("Failed to create dump directory.");
+    }
+
+    Log_InfoPrintf("Dumping frames to '%s'...", s_dump_game_directory.c_str());
+  }
+}
+
+#ifdef WITH_CHEEVOS
+void Host::OnAchievementsRefreshed()
+{
+  // noop
+}
+#endif
+
+void Host::SetMouseMode(bool relative, bool hide_cursor)
+{
+  // noop
+}
+
+void Host::PumpMessagesOnCPUThread()
+{
+  // noop
+}
+
+void Host::RunOnCPUThread(std::function<void()> function, bool block /* = false */)
+{
+  // there's only ever the one thread
+  function();
+}
+
+void Host::RefreshGameListAsync(bool invalidate_cache)
+{
+  // noop
+}
+
+void Host::CancelGameListRefresh()
+{
+  // noop
+}
+
+bool Host::IsFullscreen()
+{
+  return false;
+}
+
+void Host::SetFullscreen(bool enabled)
+{
+  // noop
+}
+
+void* Host::GetTopLevelWindowHandle()
+{
+  return nullptr;
+}
+
+void Host::RequestExit(bool save_state_if_running)
+{
+  // noop
+}
+
+void Host::RequestSystemShutdown(bool allow_confirm, bool save_state)
+{
+  // noop
+}
+
+std::optional<u32> InputManager::ConvertHostKeyboardStringToCode(const std::string_view& str)
+{
+  return std::nullopt;
+}
+
+std::optional<std::string> InputManager::ConvertHostKeyboardCodeToString(u32 code)
+{
+  return std::nullopt;
+}
+
+BEGIN_HOTKEY_LIST(g_host_hotkeys)
+END_HOTKEY_LIST()
+
+static void PrintCommandLineVersion()
+{
+  const bool was_console_enabled = Log::IsConsoleOutputEnabled();
+  if (!was_console_enabled)
+    Log::SetConsoleOutputParams(true);
+
+  std::fprintf(stderr, "DuckStation Regression Test Runner Version %s (%s)\n", g_scm_tag_str, g_scm_branch_str);
+  std::fprintf(stderr, "https://github.com/stenzek/duckstation\n");
+  std::fprintf(stderr, "\n");
+
+  if (!was_console_enabled)
+    Log::SetConsoleOutputParams(false);
+}
+
+static void PrintCommandLineHelp(const char* progname)
+{
+  const bool was_console_enabled = Log::IsConsoleOutputEnabled();
+  if (!was_console_enabled)
+    Log::SetConsoleOutputParams(true);
+
+  PrintCommandLineVersion();
+  std::fprintf(stderr, "Usage: %s [parameters] [--] [boot filename]\n", progname);
+  std::fprintf(stderr, "\n");
+  std::fprintf(stderr, "  -help: Displays this information and exits.\n");
+  std::fprintf(stderr, "  -version: Displays version information and exits.\n");
+  std::fprintf(stderr, "  -dumpdir: Set frame dump base directory (will be dumped to basedir/gametitle).\n");
+  std::fprintf(stderr, "  -dumpinterval: Dumps every N frames.\n");
+  std::fprintf(stderr, "  -frames: Sets the number of frames to execute.\n");
+  std::fprintf(stderr, "  -profile <file>: Profiles recompiler blocks, writing the results to the file.\n");
+  std::fprintf(stderr, "  -log <level>: Sets the log level. Defaults to verbose.\n");
+  std::fprintf(stderr, "  -renderer <renderer>: Sets the graphics renderer. Default to software.\n");
+  std::fprintf(stderr, "  -gputimes: Reports the GPU time spent in each rendering stage when exiting.\n");
+  std::fprintf(stderr, "  -benchmark: Runs unthrottled without presenting, and reports timing statistics.\n");
+  std::fprintf(stderr, "  -benchmarkoutput <file>: Writes benchmark results to the file, as CSV if the\n"
+                       "    extension is .csv, otherwise JSON. Defaults to JSON on stdout.\n");
+  std::fprintf(stderr, "  -warmup <frames>: Frames to run before benchmark measurements start.\n");
+  std::fprintf(stderr, "  -savebaseline <file>: Stores the benchmark results for this game in a baseline file,\n"
+                       "    replacing any earlier results for it.\n");
+  std::fprintf(stderr, "  -comparebaseline <file>: Compares the benchmark results against the game's baseline,\n"
+                       "    exiting with code 2 if anything regressed beyond the threshold.\n");
+  std::fprintf(stderr, "  -regressionthreshold <percent>: Allowed change before it counts as a regression.\n"
+                       "    Defaults to 5.\n");
+  std::fprintf(stderr, "  -hashlog <file>: Writes hashes of RAM, VRAM and SPU RAM to the file.\n");
+  std::fprintf(stderr, "  -hashinterval <frames>: Hashes every N frames. Defaults to every frame.\n");
+  std::fprintf(stderr, "  -comparehashes <file>: Checks hashes against a log from an earlier run, and stops\n"
+                       "    at the first frame which differs.\n");
+  std::fprintf(stderr, "  --: Signals that no more arguments will follow and the remaining\n"
+                       "    parameters make up the filename. Use when the filename contains\n"
+                       "    spaces or starts with a dash.\n");
+  std::fprintf(stderr, "\n");
+
+  if (!was_console_enabled)
+    Log::SetConsoleOutputParams(false);
+}
+
+static bool ParseCommandLineArgs(int argc, char* argv[])
+{
+  s_boot_parameters.emplace();
+
+  bool no_more_args = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (!no_more_args)
+    {
+#define CHECK_ARG(str) !std::strcmp(argv[i], str)
+#define CHECK_ARG_PARAM(str) (!std::strcmp(argv[i], str) && ((i + 1) < argc))
+
+      if (CHECK_ARG("-help"))
+      {
+        PrintCommandLineHelp(argv[0]);
+        return false;
+      }
+      else if (CHECK_ARG("-version"))
+      {
+        PrintCommandLineVersion();
+        return false;
+      }
+      else if (CHECK_ARG("-gputimes"))
+      {
+        s_report_gpu_times = true;
+        continue;
+      }
+      else if (CHECK_ARG("-benchmark"))
+      {
+        s_benchmark = true;
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-benchmarkoutput"))
+      {
+        s_benchmark_output_path = argv[++i];
+        s_benchmark = true;
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-warmup"))
+      {
+        s_benchmark_warmup_frames = StringUtil::FromChars<int>(argv[++i]).value_or(-1);
+        if (s_benchmark_warmup_frames < 0)
+        {
+          Log_ErrorPrintf("Invalid warm-up frame count specified: %d", s_benchmark_warmup_frames);
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-savebaseline"))
+      {
+        s_baseline_save_path = argv[++i];
+        s_benchmark = true;
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-comparebaseline"))
+      {
+        s_baseline_compare_path = argv[++i];
+        s_benchmark = true;
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-regressionthreshold"))
+      {
+        s_regression_threshold = StringUtil::FromChars<double>(argv[++i]).value_or(-1.0);
+        if (s_regression_threshold < 0.0)
+        {
+          Log_ErrorPrintf("Invalid regression threshold specified: %s", argv[i]);
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-hashlog"))
+      {
+        s_hash_log_path = argv[++i];
+        if (s_hash_log_path.empty())
+        {
+          Log_ErrorPrintf("Invalid hash log path specified.");
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-hashinterval"))
+      {
+        s_hash_interval = StringUtil::FromChars<int>(argv[++i]).value_or(0);
+        if (s_hash_interval <= 0)
+        {
+          Log_ErrorPrintf("Invalid hash interval specified: %d", s_hash_interval);
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-comparehashes"))
+      {
+        s_hash_compare_path = argv[++i];
+        if (s_hash_compare_path.empty())
+        {
+          Log_ErrorPrintf("Invalid hash comparison path specified.");
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-dumpdir"))
+      {
+        s_dump_base_directory = argv[++i];
+        if (s_dump_base_directory.empty())
+        {
+          Log_ErrorPrintf("Invalid dump directory specified.");
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-dumpinterval"))
+      {
+        s_frame_dump_interval = StringUtil::FromChars<int>(argv[++i]).value_or(0);
+        if (s_frame_dump_interval <= 0)
+        {
+          Log_ErrorPrintf("Invalid dump interval specified: %d", s_frame_dump_interval);
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-frames"))
+      {
+        s_frames_to_run = StringUtil::FromChars<int>(argv[++i]).value_or(-1);
+        if (s_frames_to_run <= 0)
+        {
+          Log_ErrorPrintf("Invalid frame count specified: %d", s_frames_to_run);
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-profile"))
+      {
+        s_block_profile_path = argv[++i];
+        if (s_block_profile_path.empty())
+        {
+          Log_ErrorPrintf("Invalid profile path specified.");
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-log"))
+      {
+        std::optional<LOGLEVEL> level = Settings::ParseLogLevelName(argv[++i]);
+        if (!level.has_value())
+        {
+          Log_ErrorPrintf("Invalid log level specified.");
+          return false;
+        }
+
+        Log::SetConsoleOutputParams(true, nullptr, level.value());
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-renderer"))
+      {
+        std::optional<GPURenderer> renderer = Settings::ParseRendererName(argv[++i]);
+        if (!renderer.has_value())
+        {
+          Log_ErrorPrintf("Invalid renderer specified.");
+          return false;
+        }
+
+        s_renderer_to_use = renderer.value();
+        continue;
+      }
+      else if (CHECK_ARG("--"))
+      {
+        no_more_args = true;
+        continue;
+      }
+      else if (argv[i][0] == '-')
+      {
+        Log_ErrorPrintf("Unknown parameter: '%s'", argv[i]);
+        return false;
+      }
+
+#undef CHECK_ARG
+#undef CHECK_ARG_PARAM
+    }
+
+    if (!s_boot_parameters->filename.empty())
+      s_boot_parameters->filename += ' ';
+    s_boot_parameters->filename += argv[i];
+  }
+
+  return true;
+}
+
+static std::string GetFrameDumpFilename(int frame)
+{
+  return StringUtil::StdStringFromFormat("%s" FS_OSPATH_SEPARATOR_STR "frame_%05d.png", s_dump_game_directory.c_str(),
+                                         frame);
+}
+
+static double GetFrameTimePercentile(const std::vector<double>& sorted_frame_times, double percentile)
+{
+  const size_t index = static_cast<size_t>(percentile / 100.0 * static_cast<double>(sorted_frame_times.size() - 1));
+  return sorted_frame_times[std::min(index, sorted_frame_times.size() - 1)];
+}
+
+static std::string EscapeBenchmarkString(const std::string& str, bool csv)
+{
+  std::string ret;
+  ret.reserve(str.size());
+  for (const char ch : str)
+  {
+    if (ch == '"' || (!csv && ch == '\\'))
+      ret.push_back(csv ? '"' : '\\');
+    if (static_cast<unsigned char>(ch) >= 0x20)
+      ret.push_back(ch);
+  }
+  return ret;
+}
+
+static bool WriteBenchmarkResults(double wall_time, BenchmarkBaseline* baseline)
+{
+  std::vector<double>& frame_times = s_benchmark_frame_times;
+  if (frame_times.empty())
+  {
+    Log_ErrorPrintf("No frames were measured, the warm-up covers the whole run.");
+    return false;
+  }
+
+  std::sort(frame_times.begin(), frame_times.end());
+  const BenchmarkResults& res = s_benchmark_results;
+  if (res.num_samples == 0)
+    Log_WarningPrintf("The run was shorter than a second, so thread usage was never sampled.");
+
+  const double num_frames = static_cast<double>(frame_times.size());
+  const double samples = static_cast<double>(std::max(res.num_samples, 1u));
+  double frame_time_sum = 0.0;
+  for (const double time : frame_times)
+    frame_time_sum += time;
+
+  baseline->serial = System::GetRunningSerial();
+  baseline->vps = num_frames / (wall_time / 1000.0);
+  baseline->frame_time_p99 = GetFrameTimePercentile(frame_times, 99.0);
+  baseline->compiled_blocks = CPU::CodeCache::GetCompiledBlockCount() - res.start_compiled_blocks;
+  baseline->shader_compiles = GPU_HW::GetShaderCompileCount() - res.start_shader_compiles;
+
+  std::FILE* fp = stdout;
+  if (!s_benchmark_output_path.empty())
+  {
+    fp = FileSystem::OpenCFile(s_benchmark_output_path.c_str(), "wb");
+    if (!fp)
+    {
+      Log_ErrorPrintf("Failed to open benchmark output file '%s'", s_benchmark_output_path.c_str());
+      return false;
+    }
+  }
+
+  const auto values = {
+    std::make_pair("frames", num_frames),
+    std::make_pair("warmup_frames", static_cast<double>(s_benchmark_warmup_frames)),
+    std::make_pair("wall_time_ms", wall_time),
+    std::make_pair("vps", baseline->vps),
+    std::make_pair("frame_time_avg_ms", frame_time_sum / num_frames),
+    std::make_pair("frame_time_min_ms", frame_times.front()),
+    std::make_pair("frame_time_p50_ms", GetFrameTimePercentile(frame_times, 50.0)),
+    std::make_pair("frame_time_p90_ms", GetFrameTimePercentile(frame_times, 90.0)),
+    std::make_pair("frame_time_p95_ms", GetFrameTimePercentile(frame_times, 95.0)),
+    std::make_pair("frame_time_p99_ms", baseline->frame_time_p99),
+    std::make_pair("frame_time_max_ms", frame_times.back()),
+    std::make_pair("cpu_thread_usage", res.cpu_thread_usage / samples),
+    std::make_pair("cpu_thread_time_ms", res.cpu_thread_time / samples),
+    std::make_pair("sw_thread_usage", res.sw_thread_usage / samples),
+    std::make_pair("sw_thread_time_ms", res.sw_thread_time / samples),
+    std::make_pair("gpu_usage", res.gpu_time / wall_time * 100.0),
+    std::make_pair("gpu_time_ms", res.gpu_time / num_frames),
+    std::make_pair("compiled_blocks", static_cast<double>(baseline->compiled_blocks)),
+    std::make_pair("shader_compiles", static_cast<double>(baseline->shader_compiles)),
+  };
+
+  const bool csv = StringUtil::EndsWithNoCase(s_benchmark_output_path, ".csv");
+  const std::string serial(EscapeBenchmarkString(System::GetRunningSerial(), csv));
+  const std::string title(EscapeBenchmarkString(System::GetRunningTitle(), csv));
+  if (csv)
+  {
+    std::fprintf(fp, "serial,title");
+    for (const auto& [name, value] : values)
+      std::fprintf(fp, ",%s", name);
+    std::fprintf(fp, "\n\"%s\",\"%s\"", serial.c_str(), title.c_str());
+    for (const auto& [name, value] : values)
+      std::fprintf(fp, ",%.4f", value);
+    std::fprintf(fp, "\n");
+  }
+  else
+  {
+    std::fprintf(fp, "{\n  \"serial\": \"%s\",\n  \"title\": \"%s\"", serial.c_str(), title.c_str());
+    for (const auto& [name, value] : values)
+      std::fprintf(fp, ",\n  \"%s\": %.4f", name, value);
+    std::fprintf(fp, "\n}\n");
+  }
+
+  if (fp != stdout)
+  {
+    std::fclose(fp);
+    Log_InfoPrintf("Wrote benchmark results to '%s'.", s_benchmark_output_path.c_str());
+  }
+
+  return true;
+}
+
+static bool LoadBenchmarkBaselines(const std::string& path, const BenchmarkBaseline& current, bool allow_missing,
+                                   std::vector<BenchmarkBaseline>* entries)
+{
+  if (current.serial.empty())
+  {
+    Log_ErrorPrintf("The game has no serial to look up its baseline with.");
+    return false;
+  }
+
+  std::optional<std::string> data(FileSystem::ReadFileToString(path.c_str()));
+  if (!data.has_value())
+  {
+    if (allow_missing && !FileSystem::FileExists(path.c_str()))
+      return true;
+
+    Log_ErrorPrintf("Failed to read benchmark baseline from '%s'", path.c_str());
+    return false;
+  }
+
+  for (const std::string_view& line : StringUtil::SplitString(data.value(), '\n'))
+  {
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    const std::string line_str(line);
+    char serial[128];
+    BenchmarkBaseline entry;
+    if (std::sscanf(line_str.c_str(), "%127s %lf %lf %u %u", serial, &entry.vps, &entry.frame_time_p99,
+                    &entry.compiled_blocks, &entry.shader_compiles) == 5)
+    {
+      entry.serial = serial;
+      entries->push_back(std::move(entry));
+    }
+  }
+
+  return true;
+}
+
+static bool SaveBenchmarkBaseline(const BenchmarkBaseline& current)
+{
+  std::vector<BenchmarkBaseline> entries;
+  if (!LoadBenchmarkBaselines(s_baseline_save_path, current, true, &entries))
+    return false;
+
+  auto iter = std::find_if(entries.begin(), entries.end(),
+                           [&current](const BenchmarkBaseline& entry) { return entry.serial == current.serial; });
+  if (iter != entries.end())
+    *iter = current;
+  else
+    entries.push_back(current);
+  std::sort(entries.begin(), entries.end(),
+            [](const BenchmarkBaseline& lhs, const BenchmarkBaseline& rhs) { return lhs.serial < rhs.serial; });
+
+  std::string data("# serial vps frame_time_p99_ms compiled_blocks shader_compiles\n");
+  for (const BenchmarkBaseline& entry : entries)
+  {
+    data += StringUtil::StdStringFromFormat("%s %.4f %.4f %u %u\n", entry.serial.c_str(), entry.vps,
+                                            entry.frame_time_p99, entry.compiled_blocks, entry.shader_compiles);
+  }
+
+  if (!FileSystem::WriteStringToFile(s_baseline_save_path.c_str(), data))
+  {
+    Log_ErrorPrintf("Failed to write benchmark baseline to '%s'", s_baseline_save_path.c_str());
+    return false;
+  }
+
+  Log_InfoPrintf("Stored benchmark baseline for '%s' in '%s'.", current.serial.c_str(), s_baseline_save_path.c_str());
+  return true;
+}
+
+/// Logs the change in each value from the game's baseline, setting regressed if any got worse beyond the threshold.
+static bool CompareBenchmarkBaseline(const BenchmarkBaseline& current, bool* regressed)
+{
+  std::vector<BenchmarkBaseline> entries;
+  if (!LoadBenchmarkBaselines(s_baseline_compare_path, current, false, &entries))
+    return false;
+
+  auto iter = std::find_if(entries.begin(), entries.end(),
+                           [&current](const BenchmarkBaseline& entry) { return entry.serial == current.serial; });
+  if (iter == entries.end())
+  {
+    Log_ErrorPrintf("No baseline for '%s' in '%s'", current.serial.c_str(), s_baseline_compare_path.c_str());
+    return false;
+  }
+
+  const BenchmarkBaseline& base = *iter;
+  const auto values = {
+    std::make_tuple("vps", base.vps, current.vps, true),
+    std::make_tuple("frame_time_p99_ms", base.frame_time_p99, current.frame_time_p99, false),
+    std::make_tuple("compiled_blocks", static_cast<double>(base.compiled_blocks),
+                    static_cast<double>(current.compiled_blocks), false),
+    std::make_tuple("shader_compiles", static_cast<double>(base.shader_compiles),
+                    static_cast<double>(current.shader_compiles), false),
+  };
+
+  Log_InfoPrintf("Benchmark results for '%s' compared to baseline:", current.serial.c_str());
+  for (const auto& [name, base_value, value, higher_is_better] : values)
+  {
+    // going from nothing to something counts as doubling, otherwise any compile in a new run would be infinite
+    const double delta =
+      (base_value != 0.0) ? ((value - base_value) / base_value * 100.0) : ((value != 0.0) ? 100.0 : 0.0);
+    const bool worse = higher_is_better ? (delta < -s_regression_threshold) : (delta > s_regression_threshold);
+    if (worse)
+    {
+      Log_ErrorPrintf("  %s: %.4f -> %.4f (%+.2f%%), regressed", name, base_value, value, delta);
+      *regressed = true;
+    }
+    else
+    {
+      Log_InfoPrintf("  %s: %.4f -> %.4f (%+.2f%%)", name, base_value, value, delta);
+    }
+  }
+
+  return true;
+}
+
+static bool OpenHashLogs()
+{
+  if (!s_hash_compare_path.empty())
+  {
+    std::optional<std::string> data(FileSystem::ReadFileToString(s_hash_compare_path.c_str()));
+    if (!data.has_value())
+    {
+      Log_ErrorPrintf("Failed to read reference hashes from '%s'", s_hash_compare_path.c_str());
+      return false;
+    }
+
+    for (const std::string_view& line : StringUtil::SplitString(data.value(), '\n'))
+    {
+      const std::string line_str(line);
+      FrameHashes hashes;
+      if (std::sscanf(line_str.c_str(), "%d %" SCNx64 " %" SCNx64 " %" SCNx64, &hashes.frame, &hashes.ram,
+                      &hashes.vram, &hashes.spu_ram) == 4)
+      {
+        s_reference_hashes.push_back(hashes);
+      }
+    }
+
+    Log_InfoPrintf("Loaded %zu reference hashes from '%s'.", s_reference_hashes.size(), s_hash_compare_path.c_str());
+  }
+
+  if (!s_hash_log_path.empty())
+  {
+    s_hash_log_file = FileSystem::OpenCFile(s_hash_log_path.c_str(), "wb");
+    if (!s_hash_log_file)
+    {
+      Log_ErrorPrintf("Failed to open hash log '%s'", s_hash_log_path.c_str());
+      return false;
+    }
+
+    std::fprintf(s_hash_log_file, "# frame ram vram spu_ram\n");
+  }
+
+  if (s_hash_interval == 0)
+    s_hash_interval = 1;
+
+  return true;
+}
+
+static void CloseHashLogs()
+{
+  if (s_hash_log_file)
+  {
+    std::fclose(s_hash_log_file);
+    s_hash_log_file = nullptr;
+  }
+}
+
+/// Returns false if the hashes don't match the reference run.
+static bool UpdateFrameHashes(int frame)
+{
+  FrameHashes hashes;
+  hashes.frame = frame;
+  System::GetMemoryHashes(&hashes.ram, &hashes.vram, &hashes.spu_ram);
+
+  if (s_hash_log_file)
+  {
+    std::fprintf(s_hash_log_file, "%d %016" PRIx64 " %016" PRIx64 " %016" PRIx64 "\n", frame, hashes.ram,
+                 hashes.vram, hashes.spu_ram);
+  }
+
+  // the reference may have been hashed at a different interval, so only compare frames present in both
+  while (s_next_reference_hash < s_reference_hashes.size() && s_reference_hashes[s_next_reference_hash].frame < frame)
+    s_next_reference_hash++;
+  if (s_next_reference_hash == s_reference_hashes.size() || s_reference_hashes[s_next_reference_hash].frame != frame)
+    return true;
+
+  const FrameHashes& ref = s_reference_hashes[s_next_reference_hash];
+  if (ref.ram == hashes.ram && ref.vram == hashes.vram && ref.spu_ram == hashes.spu_ram)
+    return true;
+
+  Log_ErrorPrintf("Frame %d differs from the reference:%s%s%s", frame, (ref.ram != hashes.ram) ? " RAM" : "",
+                  (ref.vram != hashes.vram) ? " VRAM" : "", (ref.spu_ram != hashes.spu_ram) ? " SPU RAM" : "");
+  return false;
+}
+
+/// Runs the booted system for the requested number of frames, and returns the exit code.
+int RegTestHost::RunFrames()
+{
+  if (s_frame_dump_interval > 0)
+  {
+    if (s_dump_base_directory.empty())
+    {
+      Log_ErrorPrint("Dump directory not specified.");
+      return -1;
+    }
+
+    Log_InfoPrintf("Dumping every %dth frame to '%s'.", s_frame_dump_interval, s_dump_base_directory.c_str());
+  }
+
+  if (!s_block_profile_path.empty())
+    CPU::CodeCache::StartBlockProfile();
+
+  const bool hash_frames = (!s_hash_log_path.empty() || !s_hash_compare_path.empty());
+  if (hash_frames && !OpenHashLogs())
+    return -1;
+
+  Log_InfoPrintf("Running for %d frames...", s_frames_to_run);
+
+  float total_gpu_time = 0.0f;
+  HostDisplay::GPUSectionTimes total_gpu_section_times = {};
+  bool has_gpu_section_times = false;
+
+  if (s_benchmark)
+  {
+    Log_InfoPrintf("Benchmarking, skipping %d warm-up frames.", s_benchmark_warmup_frames);
+    s_benchmark_frame_times.reserve(static_cast<size_t>(std::max(s_frames_to_run - s_benchmark_warmup_frames, 0)));
+  }
+
+  for (int frame = 1; frame <= s_frames_to_run; frame++)
+  {
+    if (s_benchmark && frame == (s_benchmark_warmup_frames + 1))
+    {
+      System::ResetPerformanceCounters();
+      s_benchmark_results.start_compiled_blocks = CPU::CodeCache::GetCompiledBlockCount();
+      s_benchmark_results.start_shader_compiles = GPU_HW::GetShaderCompileCount();
+      s_benchmark_sampling = true;
+      s_benchmark_timer.Reset();
+    }
+
+    const Common::Timer::Value frame_start_time = Common::Timer::GetCurrentValue();
+    System::RunFrame();
+
+    if (s_benchmark)
+    {
+      if (s_benchmark_sampling)
+      {
+        s_benchmark_frame_times.push_back(
+          Common::Timer::ConvertValueToMilliseconds(Common::Timer::GetCurrentValue() - frame_start_time));
+      }
+    }
+
+    if (hash_frames && (frame % s_hash_interval) == 0 && !UpdateFrameHashes(frame))
+    {
+      CloseHashLogs();
+      return 1;
+    }
+
+    if (s_benchmark)
+    {
+      // the display is surfaceless, so this only submits the frame's GPU work
+      g_host_display->Render(false);
+
+      const float gpu_time = g_host_display->GetAndResetAccumulatedGPUTime();
+      if (s_benchmark_sampling)
+        s_benchmark_results.gpu_time += gpu_time;
+
+      System::UpdatePerformanceCounters();
+      continue;
+    }
+
+    if (s_frame_dump_interval > 0 && (s_frame_dump_interval == 1 || (frame % s_frame_dump_interval) == 0))
+    {
+      std::string dump_filename(GetFrameDumpFilename(frame));
+      g_host_display->WriteDisplayTextureToFile(std::move(dump_filename));
+    }
+
+    g_host_display->Render(false);
+
+    if (s_report_gpu_times)
+    {
+      HostDisplay::GPUSectionTimes section_times;
+      total_gpu_time += g_host_display->GetAndResetAccumulatedGPUTime();
+      has_gpu_section_times = g_host_display->GetAndResetAccumulatedGPUSectionTimes(&section_times);
+      for (size_t i = 0; has_gpu_section_times && i < section_times.size(); i++)
+        total_gpu_section_times[i] += section_times[i];
+    }
+
+    System::UpdatePerformanceCounters();
+  }
+
+  if (s_report_gpu_times)
+  {
+    if (!g_host_display->IsGPUTimingEnabled())
+    {
+      Log_WarningPrintf("GPU timing is not supported by this renderer.");
+    }
+    else
+    {
+      Log_InfoPrintf("GPU time: %.2fms total, %.3fms/frame", total_gpu_time,
+                     total_gpu_time / static_cast<float>(s_frames_to_run));
+      for (size_t i = 0; has_gpu_section_times && i < total_gpu_section_times.size(); i++)
+      {
+        Log_InfoPrintf("  %s: %.2fms total, %.3fms/frame",
+                       HostDisplay::GetGPUTimingSectionName(static_cast<GPUTimingSection>(i)),
+                       total_gpu_section_times[i], total_gpu_section_times[i] / static_cast<float>(s_frames_to_run));
+      }
+    }
+  }
+
+  CloseHashLogs();
+
+  bool regressed = false;
+  if (s_benchmark)
+  {
+    const double wall_time = s_benchmark_timer.GetTimeMilliseconds();
+    s_benchmark_sampling = false;
+
+    BenchmarkBaseline current;
+    if (!WriteBenchmarkResults(wall_time, &current) ||
+        (!s_baseline_compare_path.empty() && !CompareBenchmarkBaseline(current, &regressed)) ||
+        (!s_baseline_save_path.empty() && !SaveBenchmarkBaseline(current)))
+    {
+      return -1;
+    }
+  }
+
+  if (!s_block_profile_path.empty())
+    CPU::CodeCache::StopBlockProfile(s_block_profile_path.c_str());
+
+  if (regressed)
+  {
+    Log_ErrorPrintf("Performance regressed by more than %.1f%% from the baseline.", s_regression_threshold);
+    return 2;
+  }
+
+  return 0;
+}
+
+int main(int argc, char* argv[])
+{
+  Log::SetConsoleOutputParams(true, nullptr, LOGLEVEL_VERBOSE);
+
+  if (!ParseCommandLineArgs(argc, argv) || !RegTestHost::SetFolders())
+    return -1;
+
+  if (s_boot_parameters->filename.empty())
+  {
+    Log_ErrorPrintf("No boot path specified.");
+    return -1;
+  }
+
+  Log_InfoPrintf("Initializing...");
+  RegTestHost::InitializeSettings();
+  CommonHost::Initialize();
+
+  int result = -1;
+  Log_InfoPrintf("Trying to boot '%s'...", s_boot_parameters->filename.c_str());
+  if (System::BootSystem(std::move(s_boot_parameters.value())))
+  {
+    result = RegTestHost::RunFrames();
+
+    Log_InfoPrintf("Shutting down system.");
+    System::ShutdownSystem(false);
+
+    if (result == 0)
+      Log_InfoPrintf("Exiting with success.");
+  }
+  else
+  {
+    Log_ErrorPrintf("Failed to boot system.");
+  }
+
+  RegTestHost::ReleaseHostDisplay();
+  CommonHost::Shutdown();
+  return result;
+}
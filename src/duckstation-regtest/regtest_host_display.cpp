@@ -1,19 +1,37 @@
 #include "regtest_host_display.h"
 #include "common/align.h"
 #include "common/assert.h"
-#include "common/file_system.h"
-#include "common/image.h"
 #include "common/log.h"
 #include "common/string_util.h"
-#include <array>
-#include <tuple>
 Log_SetChannel(RegTestHostDisplay);
 
+namespace {
+// Nothing is ever presented, so textures only need to live in memory for frame dumps to read back.
+class RegTestTexture final : public GPUTexture
+{
+public:
+  RegTestTexture(u32 width, u32 height, GPUTexture::Format format)
+    : GPUTexture(static_cast<u16>(width), static_cast<u16>(height), 1, 1, 1, format),
+      m_pitch(Common::AlignUpPow2(width * GetPixelSize(format), 4)), m_data(m_pitch * height)
+  {
+  }
+
+  bool IsValid() const override { return true; }
+
+  ALWAYS_INLINE u32 GetPitch() const { return m_pitch; }
+  ALWAYS_INLINE u8* GetData() { return m_data.data(); }
+
+private:
+  u32 m_pitch;
+  std::vector<u8> m_data;
+};
+} // namespace
+
 RegTestHostDisplay::RegTestHostDisplay() = default;
 
 RegTestHostDisplay::~RegTestHostDisplay() = default;
 
-HostDisplay::RenderAPI RegTestHostDisplay::GetRenderAPI() const
+RenderAPI RegTestHostDisplay::GetRenderAPI() const
 {
   return RenderAPI::None;
 }
@@ -61,41 +79,6 @@ bool RegTestHostDisplay::DoneRenderContextCurrent()
   return true;
 }
 
-void RegTestHostDisplay::DestroyRenderDevice()
-{
-  ClearSoftwareCursor();
-}
-
-void RegTestHostDisplay::DestroyRenderSurface() {}
-
-bool RegTestHostDisplay::CreateResources()
-{
-  return true;
-}
-
-void RegTestHostDisplay::DestroyResources() {}
-
-HostDisplay::AdapterAndModeList RegTestHostDisplay::GetAdapterAndModeList()
-{
-  return {};
-}
-
-bool RegTestHostDisplay::CreateImGuiContext()
-{
-  return true;
-}
-
-void RegTestHostDisplay::DestroyImGuiContext()
-{
-  // noop
-}
-
-bool RegTestHostDisplay::UpdateImGuiFontTexture()
-{
-  // noop
-  return true;
-}
-
 bool RegTestHostDisplay::ChangeRenderWindow(const WindowInfo& wi)
 {
   m_window_info = wi;
@@ -123,84 +106,91 @@ bool RegTestHostDisplay::SetFullscreen(bool fullscreen, u32 width, u32 height, f
   return false;
 }
 
+HostDisplay::AdapterAndModeList RegTestHostDisplay::GetAdapterAndModeList()
+{
+  return {};
+}
+
+void RegTestHostDisplay::DestroyRenderSurface() {}
+
 bool RegTestHostDisplay::SetPostProcessingChain(const std::string_view& config)
 {
   return false;
 }
 
-std::unique_ptr<GPUTexture> RegTestHostDisplay::CreateTexture(u32 width, u32 height, u32 layers, u32 levels,
-                                                                      u32 samples, GPUTexture::Format format,
-                                                                      const void* data, u32 data_stride,
-                                                                      bool dynamic /* = false */)
+bool RegTestHostDisplay::CreateResources()
 {
-  return nullptr;
+  return true;
 }
 
-void RegTestHostDisplay::UpdateTexture(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height,
-                                       const void* data, u32 data_stride)
+void RegTestHostDisplay::DestroyResources() {}
+
+bool RegTestHostDisplay::CreateImGuiContext()
 {
+  return true;
 }
 
-bool RegTestHostDisplay::DownloadTexture(const void* texture_handle, GPUTexture::Format texture_format, u32 x,
-                                         u32 y, u32 width, u32 height, void* out_data, u32 out_data_stride)
+void RegTestHostDisplay::DestroyImGuiContext()
 {
-  const u32 pixel_size = GPUTexture::GetPixelSize(texture_format);
-  const u32 input_stride = Common::AlignUpPow2(width * pixel_size, 4);
-  const u8* input_start = static_cast<const u8*>(texture_handle) + (x * pixel_size);
-  StringUtil::StrideMemCpy(out_data, out_data_stride, input_start, input_stride, width * pixel_size, height);
-  return true;
+  // noop
 }
 
-bool RegTestHostDisplay::SupportsTextureFormat(GPUTexture::Format format) const
+bool RegTestHostDisplay::UpdateImGuiFontTexture()
 {
-  return (format == GPUTexture::Format::RGBA8);
+  // noop
+  return true;
 }
 
-bool RegTestHostDisplay::BeginSetDisplayPixels(GPUTexture::Format format, u32 width, u32 height, void** out_buffer,
-                                               u32* out_pitch)
+std::unique_ptr<GPUTexture> RegTestHostDisplay::CreateTexture(u32 width, u32 height, u32 layers, u32 levels,
+                                                              u32 samples, GPUTexture::Format format,
+                                                              const void* data, u32 data_stride,
+                                                              bool dynamic /* = false */)
 {
-  const u32 pitch = Common::AlignUpPow2(width * GPUTexture::GetPixelSize(format), 4);
-  const u32 required_size = height * pitch;
-  if (m_frame_buffer.size() != (required_size / 4))
+  if (layers != 1 || levels != 1 || samples != 1 || width > GPUTexture::MAX_WIDTH || height > GPUTexture::MAX_HEIGHT)
+    return {};
+
+  std::unique_ptr<RegTestTexture> tex = std::make_unique<RegTestTexture>(width, height, format);
+  if (data)
   {
-    m_frame_buffer.clear();
-    m_frame_buffer.resize(required_size / 4);
+    StringUtil::StrideMemCpy(tex->GetData(), tex->GetPitch(), data, data_stride, width * tex->GetPixelSize(),
+                             height);
   }
 
-  // border is already filled here
-  m_frame_buffer_pitch = pitch;
-  SetDisplayTexture(m_frame_buffer.data(), format, width, height, 0, 0, width, height);
-  *out_buffer = reinterpret_cast<u8*>(m_frame_buffer.data());
-  *out_pitch = pitch;
-  return true;
+  return tex;
 }
 
-void RegTestHostDisplay::EndSetDisplayPixels()
+bool RegTestHostDisplay::BeginTextureUpdate(GPUTexture* texture, u32 width, u32 height, void** out_buffer,
+                                            u32* out_pitch)
 {
-  // noop
+  m_staging_pitch = Common::AlignUpPow2(width * texture->GetPixelSize(), 4);
+  m_staging_buffer.resize(m_staging_pitch * height);
+  *out_buffer = m_staging_buffer.data();
+  *out_pitch = m_staging_pitch;
+  return true;
 }
 
-void RegTestHostDisplay::DumpFrame(const std::string& filename)
+void RegTestHostDisplay::EndTextureUpdate(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height)
 {
-  if (!HasDisplayTexture())
-  {
-    if (FileSystem::FileExists(filename.c_str()))
-      FileSystem::DeleteFile(filename.c_str());
-
-    return;
-  }
-
-  Common::RGBA8Image image(m_display_texture_width, m_display_texture_height,
-                           static_cast<const u32*>(m_display_texture));
+  RegTestTexture* tex = static_cast<RegTestTexture*>(texture);
+  const u32 pixel_size = tex->GetPixelSize();
+  DebugAssert((x + width) <= tex->GetWidth() && (y + height) <= tex->GetHeight());
+  StringUtil::StrideMemCpy(tex->GetData() + (y * tex->GetPitch()) + (x * pixel_size), tex->GetPitch(),
+                           m_staging_buffer.data(), m_staging_pitch, width * pixel_size, height);
+}
 
-  // set alpha channel on all pixels
-  u32* pixels = image.GetPixels();
-  u32* pixels_end = pixels + (image.GetWidth() * image.GetHeight());
-  while (pixels != pixels_end)
-    *(pixels++) |= 0xFF000000u;
+bool RegTestHostDisplay::DownloadTexture(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height, void* out_data,
+                                         u32 out_data_stride)
+{
+  RegTestTexture* tex = static_cast<RegTestTexture*>(texture);
+  const u32 pixel_size = tex->GetPixelSize();
+  StringUtil::StrideMemCpy(out_data, out_data_stride, tex->GetData() + (y * tex->GetPitch()) + (x * pixel_size),
+                           tex->GetPitch(), width * pixel_size, height);
+  return true;
+}
 
-  if (!Common::WriteImageToFile(image, filename.c_str()))
-    Log_ErrorPrintf("Failed to dump frame '%s'", filename.c_str());
+bool RegTestHostDisplay::SupportsTextureFormat(GPUTexture::Format format) const
+{
+  return (format == GPUTexture::Format::RGBA8);
 }
 
 void RegTestHostDisplay::SetVSync(bool enabled)
@@ -208,8 +198,9 @@ void RegTestHostDisplay::SetVSync(bool enabled)
   Log_DevPrintf("Ignoring SetVSync(%u)", BoolToUInt32(enabled));
 }
 
-bool RegTestHostDisplay::Render()
+bool RegTestHostDisplay::Render(bool skip_present)
 {
+  m_display_changed = false;
   return true;
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 #include "core/host_display.h"
 #include <string>
+#include <vector>
 
 class RegTestHostDisplay final : public HostDisplay
 {
@@ -8,8 +9,6 @@ public:
   RegTestHostDisplay();
   ~RegTestHostDisplay();
 
-  void DumpFrame(const std::string& filename);
-
   RenderAPI GetRenderAPI() const override;
   void* GetRenderDevice() const override;
   void* GetRenderContext() const override;
@@ -21,7 +20,6 @@ public:
                           bool threaded_presentation) override;
   bool InitializeRenderDevice(std::string_view shader_cache_directory, bool debug_device,
                               bool threaded_presentation) override;
-  void DestroyRenderDevice() override;
 
   bool MakeRenderContextCurrent() override;
   bool DoneRenderContextCurrent() override;
@@ -31,6 +29,7 @@ public:
   bool SupportsFullscreen() const override;
   bool IsFullscreen() override;
   bool SetFullscreen(bool fullscreen, u32 width, u32 height, float refresh_rate) override;
+  AdapterAndModeList GetAdapterAndModeList() override;
   void DestroyRenderSurface() override;
 
   bool SetPostProcessingChain(const std::string_view& config) override;
@@ -38,33 +37,26 @@ public:
   bool CreateResources() override;
   void DestroyResources() override;
 
-  AdapterAndModeList GetAdapterAndModeList() override;
   bool CreateImGuiContext() override;
   void DestroyImGuiContext() override;
   bool UpdateImGuiFontTexture() override;
 
   std::unique_ptr<GPUTexture> CreateTexture(u32 width, u32 height, u32 layers, u32 levels, u32 samples,
-                                                    GPUTexture::Format format, const void* data, u32 data_stride,
-                                                    bool dynamic = false) override;
-  void UpdateTexture(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height, const void* data,
-                     u32 data_stride) override;
-  bool DownloadTexture(const void* texture_handle, GPUTexture::Format texture_format, u32 x, u32 y, u32 width,
-                       u32 height, void* out_data, u32 out_data_stride) override;
+                                            GPUTexture::Format format, const void* data, u32 data_stride,
+                                            bool dynamic = false) override;
+  bool BeginTextureUpdate(GPUTexture* texture, u32 width, u32 height, void** out_buffer, u32* out_pitch) override;
+  void EndTextureUpdate(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height) override;
+  bool DownloadTexture(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height, void* out_data,
+                       u32 out_data_stride) override;
+  bool SupportsTextureFormat(GPUTexture::Format format) const override;
 
   void SetVSync(bool enabled) override;
 
-  bool Render() override;
+  bool Render(bool skip_present) override;
   bool RenderScreenshot(u32 width, u32 height, std::vector<u32>* out_pixels, u32* out_stride,
                         GPUTexture::Format* out_format) override;
 
-  bool SupportsTextureFormat(GPUTexture::Format format) const override;
-
-  bool BeginSetDisplayPixels(GPUTexture::Format format, u32 width, u32 height, void** out_buffer,
-                             u32* out_pitch) override;
-  void EndSetDisplayPixels() override;
-
 private:
-  std::vector<u32> m_frame_buffer;
-  GPUTexture::Format m_frame_buffer_format = GPUTexture::Format::Unknown;
-  u32 m_frame_buffer_pitch = 0;
+  std::vector<u8> m_staging_buffer;
+  u32 m_staging_pitch = 0;
 };
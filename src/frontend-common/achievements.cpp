@@ -31,6 +31,7 @@
 #include <atomic>
 #include <cstdarg>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <functional>
 #include <string>
@@ -52,11 +53,32 @@ enum : s32
   // Number of seconds between rich presence pings. RAIntegration uses 2 minutes.
   RICH_PRESENCE_PING_FREQUENCY = 2 * 60,
   NO_RICH_PRESENCE_PING_FREQUENCY = RICH_PRESENCE_PING_FREQUENCY * 2,
+
+  // Unlocks which couldn't reach the server are retried after this many seconds, doubling each time.
+  UNLOCK_RETRY_INITIAL_DELAY = 5,
+  UNLOCK_RETRY_MAX_DELAY = 5 * 60,
+};
+
+// Unlocks which haven't been accepted by the server yet. These are kept on disk, so they're retried next time if the
+// network is down until we shut down.
+struct PendingUnlock
+{
+  std::string username;
+  std::string game_hash;
+  u32 achievement_id;
+  bool hardcore;
+  bool in_flight;
+  u32 attempts;
+  Common::Timer::Value next_attempt_time;
 };
 
+using GameRequestCallbackFunction = void (*)(s32 status_code, std::string content_type,
+                                             Common::HTTPDownloader::Request::Data data);
+
 static constexpr const char* INFO_SOUND_NAME = "sounds/achievements/message.wav";
 static constexpr const char* UNLOCK_SOUND_NAME = "sounds/achievements/unlock.wav";
 static constexpr const char* LBSUBMIT_SOUND_NAME = "sounds/achievements/lbsubmit.wav";
+static constexpr const char* PENDING_UNLOCKS_FILENAME = "achievements_pending.txt";
 
 static void FormattedError(const char* format, ...);
 static void LogFailedResponseJSON(const Common::HTTPDownloader::Request::Data& data);
@@ -98,7 +120,13 @@ static void GetGameIdCallback(s32 status_code, std::string content_type, Common:
 static void SendPlayingCallback(s32 status_code, std::string content_type, Common::HTTPDownloader::Request::Data data);
 static void UpdateRichPresence();
 static void SendPingCallback(s32 status_code, std::string content_type, Common::HTTPDownloader::Request::Data data);
-static void UnlockAchievementCallback(s32 status_code, std::string content_type,
+static Common::HTTPDownloader::Request::Callback GameRequestCallback(GameRequestCallbackFunction callback);
+static std::string GetPendingUnlocksPath();
+static void LoadPendingUnlocks();
+static void SavePendingUnlocks();
+static void SendPendingUnlock(PendingUnlock* unlock);
+static void SendPendingUnlocks();
+static void UnlockAchievementCallback(std::string game_hash, u32 achievement_id, s32 status_code,
                                       Common::HTTPDownloader::Request::Data data);
 static void SubmitLeaderboardCallback(s32 status_code, std::string content_type,
                                       Common::HTTPDownloader::Request::Data data);
@@ -133,6 +161,11 @@ static bool s_has_rich_presence = false;
 static std::string s_rich_presence_string;
 static Common::Timer s_last_ping_time;
 
+static std::vector<PendingUnlock> s_pending_unlocks;
+
+// Bumped when the game changes, so responses for the previous game are dropped rather than waited for.
+static u32 s_game_request_generation = 0;
+
 static u32 s_last_queried_lboard = 0;
 static u32 s_submitting_lboard_id = 0;
 static std::optional<std::vector<Achievements::LeaderboardEntry>> s_lboard_entries;
@@ -375,6 +408,21 @@ void Achievements::ClearGameHash()
 {
   s_game_path = {};
   std::string().swap(s_game_hash);
+  s_game_request_generation++;
+}
+
+Common::HTTPDownloader::Request::Callback Achievements::GameRequestCallback(GameRequestCallbackFunction callback)
+{
+  return [callback, generation = s_game_request_generation](s32 status_code, std::string content_type,
+                                                             Common::HTTPDownloader::Request::Data data) {
+    if (generation != s_game_request_generation)
+    {
+      Log_DevPrintf("Ignoring response for previous game, status code %d", status_code);
+      return;
+    }
+
+    callback(status_code, std::move(content_type), std::move(data));
+  };
 }
 
 std::string Achievements::GetUserAgent()
@@ -465,6 +513,7 @@ void Achievements::Initialize()
   s_username = Host::GetBaseStringSettingValue("Cheevos", "Username");
   s_api_token = Host::GetBaseStringSettingValue("Cheevos", "Token");
   s_logged_in = (!s_username.empty() && !s_api_token.empty());
+  LoadPendingUnlocks();
 
   if (System::IsValid())
     GameChanged(System::GetRunningPath(), nullptr);
@@ -634,6 +683,8 @@ bool Achievements::OnSystemShutdown()
   s_challenge_mode = false;
   rc_runtime_destroy(&s_rcheevos_runtime);
 
+  // anything the server hasn't accepted is still on disk for next time
+  s_pending_unlocks.clear();
   s_http_downloader.reset();
   return true;
 }
@@ -688,6 +739,7 @@ void Achievements::FrameUpdate()
 #endif
 
   s_http_downloader->PollRequests();
+  SendPendingUnlocks();
 
   if (HasActiveGame())
   {
@@ -713,6 +765,7 @@ void Achievements::ProcessPendingHTTPRequests()
 #endif
 
   s_http_downloader->PollRequests();
+  SendPendingUnlocks();
 }
 
 bool Achievements::DoState(StateWrapper& sw)
@@ -1089,7 +1142,7 @@ void Achievements::GetUserUnlocks()
   request.api_token = s_api_token.c_str();
   request.game_id = s_game_id;
   request.hardcore = static_cast<int>(ChallengeModeActive());
-  request.Send(GetUserUnlocksCallback);
+  request.Send(GameRequestCallback(GetUserUnlocksCallback));
 }
 
 void Achievements::GetPatchesCallback(s32 status_code, std::string content_type,
@@ -1284,7 +1337,7 @@ void Achievements::GetPatches(u32 game_id)
   request.username = s_username.c_str();
   request.api_token = s_api_token.c_str();
   request.game_id = game_id;
-  request.Send(GetPatchesCallback);
+  request.Send(GameRequestCallback(GetPatchesCallback));
 }
 
 std::string Achievements::GetGameHash(CDImage* image)
@@ -1363,8 +1416,8 @@ void Achievements::GameChanged(const std::string& path, CDImage* image)
     if (!temp_image)
     {
       Log_ErrorPrintf("Failed to open temporary CD image '%s'", path.c_str());
-      s_http_downloader->WaitForAllRequests();
       std::unique_lock lock(s_achievements_mutex);
+      s_game_request_generation++;
       DisableChallengeMode();
       ClearGameInfo();
       return;
@@ -1384,14 +1437,6 @@ void Achievements::GameChanged(const std::string& path, CDImage* image)
     }
   }
 
-  if (s_http_downloader->HasAnyRequests())
-  {
-    if (image && System::IsValid())
-      Host::DisplayLoadingScreen("Downloading achievements data...");
-
-    s_http_downloader->WaitForAllRequests();
-  }
-
   if (image && image->HasSubImages() && image->GetCurrentSubImage() != 0)
   {
     std::unique_ptr<CDImage> image_copy(
@@ -1408,10 +1453,8 @@ void Achievements::GameChanged(const std::string& path, CDImage* image)
     return;
   }
 
+  // requests for the previous game are left to finish, ClearGameHash() makes sure their responses are ignored
   std::unique_lock lock(s_achievements_mutex);
-  if (!IsUsingRAIntegration())
-    s_http_downloader->WaitForAllRequests();
-
   ClearGameInfo();
   ClearGameHash();
   s_game_path = path;
@@ -1448,7 +1491,7 @@ void Achievements::SendGetGameId()
   request.username = s_username.c_str();
   request.api_token = s_api_token.c_str();
   request.game_hash = s_game_hash.c_str();
-  request.Send(GetGameIdCallback);
+  request.Send(GameRequestCallback(GetGameIdCallback));
 }
 
 void Achievements::SendPlayingCallback(s32 status_code, std::string content_type,
@@ -1475,7 +1518,7 @@ void Achievements::SendPlaying()
   request.username = s_username.c_str();
   request.api_token = s_api_token.c_str();
   request.game_id = s_game_id;
-  request.Send(SendPlayingCallback);
+  request.Send(GameRequestCallback(SendPlayingCallback));
 }
 
 void Achievements::UpdateRichPresence()
@@ -1526,7 +1569,7 @@ void Achievements::SendPing()
   request.username = s_username.c_str();
   request.game_id = s_game_id;
   request.rich_presence = s_rich_presence_string.c_str();
-  request.Send(SendPingCallback);
+  request.Send(GameRequestCallback(SendPingCallback));
 }
 
 const std::string& Achievements::GetGameTitle()
@@ -1628,7 +1671,7 @@ std::optional<bool> Achievements::TryEnumerateLeaderboardEntries(u32 id,
     // Just over what a single page can store, should be a reasonable amount for now
     request.count = 15;
 
-    request.Send(GetLbInfoCallback);
+    request.Send(GameRequestCallback(GetLbInfoCallback));
   }
 
   return std::nullopt;
@@ -1711,12 +1754,130 @@ void Achievements::DeactivateAchievement(Achievement* achievement)
   Log_DevPrintf("Deactivated achievement %s (%u)", achievement->title.c_str(), achievement->id);
 }
 
-void Achievements::UnlockAchievementCallback(s32 status_code, std::string content_type,
+std::string Achievements::GetPendingUnlocksPath()
+{
+  return Path::Combine(EmuFolders::DataRoot, PENDING_UNLOCKS_FILENAME);
+}
+
+void Achievements::LoadPendingUnlocks()
+{
+  s_pending_unlocks.clear();
+
+  const std::string path(GetPendingUnlocksPath());
+  std::optional<std::string> data(FileSystem::ReadFileToString(path.c_str()));
+  if (!data.has_value())
+    return;
+
+  // one per line, as "username game_hash achievement_id hardcore"
+  for (const std::string_view& line : StringUtil::SplitString(data.value(), '\n'))
+  {
+    const std::vector<std::string_view> fields(StringUtil::SplitString(StringUtil::StripWhitespace(line), ' '));
+    const std::optional<u32> achievement_id =
+      (fields.size() == 4) ? StringUtil::FromChars<u32>(fields[2]) : std::optional<u32>();
+    const std::optional<bool> hardcore =
+      (fields.size() == 4) ? StringUtil::FromChars<bool>(fields[3]) : std::optional<bool>();
+    if (!achievement_id.has_value() || !hardcore.has_value())
+    {
+      Log_WarningPrintf("Ignoring malformed pending unlock '%.*s'", static_cast<int>(line.size()), line.data());
+      continue;
+    }
+
+    s_pending_unlocks.push_back(PendingUnlock{std::string(fields[0]), std::string(fields[1]), achievement_id.value(),
+                                              hardcore.value(), false, 0, 0});
+  }
+
+  if (!s_pending_unlocks.empty())
+    Log_InfoPrintf("Loaded %zu unlocks which haven't been sent to the server yet", s_pending_unlocks.size());
+}
+
+void Achievements::SavePendingUnlocks()
+{
+  const std::string path(GetPendingUnlocksPath());
+  if (s_pending_unlocks.empty())
+  {
+    if (FileSystem::FileExists(path.c_str()) && !FileSystem::DeleteFile(path.c_str()))
+      Log_ErrorPrintf("Failed to delete '%s'", path.c_str());
+
+    return;
+  }
+
+  std::string data;
+  for (const PendingUnlock& unlock : s_pending_unlocks)
+  {
+    fmt::format_to(std::back_inserter(data), "{} {} {} {}\n", unlock.username, unlock.game_hash,
+                   unlock.achievement_id, unlock.hardcore ? "true" : "false");
+  }
+
+  if (!FileSystem::WriteStringToFile(path.c_str(), data))
+    Log_ErrorPrintf("Failed to write pending unlocks to '%s'", path.c_str());
+}
+
+void Achievements::SendPendingUnlock(PendingUnlock* unlock)
+{
+  unlock->in_flight = true;
+
+  RAPIRequest<rc_api_award_achievement_request_t, rc_api_init_award_achievement_request> request;
+  request.username = unlock->username.c_str();
+  request.api_token = s_api_token.c_str();
+  request.game_hash = unlock->game_hash.c_str();
+  request.achievement_id = unlock->achievement_id;
+  request.hardcore = static_cast<int>(unlock->hardcore);
+  request.Send([game_hash = unlock->game_hash, achievement_id = unlock->achievement_id](
+                 s32 status_code, std::string content_type, Common::HTTPDownloader::Request::Data data) {
+    UnlockAchievementCallback(game_hash, achievement_id, status_code, std::move(data));
+  });
+}
+
+void Achievements::SendPendingUnlocks()
+{
+  if (s_pending_unlocks.empty() || !s_logged_in)
+    return;
+
+  std::unique_lock lock(s_achievements_mutex);
+  const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
+  for (PendingUnlock& unlock : s_pending_unlocks)
+  {
+    // the token is only valid for the user who earned it
+    if (!unlock.in_flight && current_time >= unlock.next_attempt_time && unlock.username == s_username)
+      SendPendingUnlock(&unlock);
+  }
+}
+
+void Achievements::UnlockAchievementCallback(std::string game_hash, u32 achievement_id, s32 status_code,
                                              Common::HTTPDownloader::Request::Data data)
 {
-  if (!System::IsValid())
+  std::unique_lock lock(s_achievements_mutex);
+  auto iter = std::find_if(s_pending_unlocks.begin(), s_pending_unlocks.end(), [&](const PendingUnlock& it) {
+    return (it.achievement_id == achievement_id && it.game_hash == game_hash);
+  });
+  if (iter == s_pending_unlocks.end())
     return;
 
+  if (status_code != HTTP_OK || data.empty())
+  {
+    // couldn't reach the server, try again later
+    const u32 delay = std::min<u32>(UNLOCK_RETRY_INITIAL_DELAY << std::min<u32>(iter->attempts, 16),
+                                    UNLOCK_RETRY_MAX_DELAY);
+    Log_WarningPrintf("Unlock of achievement %u failed with status code %d, retrying in %u seconds", achievement_id,
+                      status_code, delay);
+    if (iter->attempts == 0)
+    {
+      Host::AddKeyedOSDMessage("achievements_unlock_retry",
+                               Host::TranslateStdString("Achievements",
+                                                        "Failed to submit achievement unlock, it will be retried."),
+                               10.0f);
+    }
+
+    iter->in_flight = false;
+    iter->attempts++;
+    iter->next_attempt_time = Common::Timer::GetCurrentValue() + Common::Timer::ConvertSecondsToValue(delay);
+    return;
+  }
+
+  // the server answered, if it rejected the unlock then sending it again won't change that
+  s_pending_unlocks.erase(iter);
+  SavePendingUnlocks();
+
   RAPIResponse<rc_api_award_achievement_response_t, rc_api_process_award_achievement_response,
                rc_api_destroy_award_achievement_response>
     response(status_code, data);
@@ -1823,13 +1984,11 @@ void Achievements::UnlockAchievement(u32 achievement_id, bool add_notification /
     return;
   }
 
-  RAPIRequest<rc_api_award_achievement_request_t, rc_api_init_award_achievement_request> request;
-  request.username = s_username.c_str();
-  request.api_token = s_api_token.c_str();
-  request.game_hash = s_game_hash.c_str();
-  request.achievement_id = achievement_id;
-  request.hardcore = static_cast<int>(ChallengeModeActive());
-  request.Send(UnlockAchievementCallback);
+  // saved before it's sent, so it's not lost if we can't reach the server before shutting down
+  s_pending_unlocks.push_back(
+    PendingUnlock{s_username, s_game_hash, achievement_id, ChallengeModeActive(), false, 0, 0});
+  SavePendingUnlocks();
+  SendPendingUnlock(&s_pending_unlocks.back());
 }
 
 void Achievements::SubmitLeaderboard(u32 leaderboard_id, int value)
@@ -1864,7 +2023,7 @@ void Achievements::SubmitLeaderboard(u32 leaderboard_id, int value)
   request.game_hash = s_game_hash.c_str();
   request.leaderboard_id = leaderboard_id;
   request.score = value;
-  request.Send(SubmitLeaderboardCallback);
+  request.Send(GameRequestCallback(SubmitLeaderboardCallback));
 }
 
 void Achievements::AchievementPrimed(u32 achievement_id)
@@ -1979,32 +2138,19 @@ void Achievements::CheevosEventHandler(const rc_runtime_event_t* runtime_event)
 
 unsigned Achievements::PeekMemory(unsigned address, unsigned num_bytes, void* ud)
 {
-  switch (num_bytes)
-  {
-    case 1:
-    {
-      u8 value = 0;
-      CPU::SafeReadMemoryByte(address, &value);
-      return value;
-    }
+  if (num_bytes != 1 && num_bytes != 2 && num_bytes != 4)
+    return 0;
 
-    case 2:
-    {
-      u16 value;
-      CPU::SafeReadMemoryHalfWord(address, &value);
-      return value;
-    }
+  // This is called for every memory reference in the set each frame, and nearly all of them are in RAM, so read that
+  // directly rather than going through the bus. Anything else, or which wraps around the end of RAM, takes the slow
+  // path. Values are little-endian, same as the guest.
+  u32 value = 0;
+  if (address < Bus::RAM_MIRROR_END && ((address & Bus::g_ram_mask) + num_bytes) <= Bus::g_ram_size)
+    std::memcpy(&value, &Bus::g_ram[address & Bus::g_ram_mask], num_bytes);
+  else if (!CPU::SafeReadMemoryBytes(address, &value, num_bytes))
+    value = 0;
 
-    case 4:
-    {
-      u32 value;
-      CPU::SafeReadMemoryWord(address, &value);
-      return value;
-    }
-
-    default:
-      return 0;
-  }
+  return value;
 }
 
 #ifdef WITH_RAINTEGRATION
@@ -7,6 +7,7 @@
 #include "common/log.h"
 #include "common/path.h"
 #include "common/string_util.h"
+#include "common/timer.h"
 #include "core/cdrom.h"
 #include "core/cheats.h"
 #include "core/controller.h"
@@ -79,6 +80,11 @@ static void PollDiscordPresence();
 #endif
 } // namespace CommonHost
 
+// idle loops keep to the refresh rate for this many unchanged frames, then only wake for events or this timeout
+static constexpr u32 IDLE_BACKOFF_FRAMES = 10;
+static constexpr u32 IDLE_MAX_WAIT_MS = 100;
+static u32 s_idle_unchanged_frames = 0;
+
 #ifdef WITH_DISCORD_PRESENCE
 // discord rich presence
 bool m_discord_presence_enabled = false;
@@ -175,9 +181,30 @@ bool CommonHost::CreateHostDisplayResources()
 
 void CommonHost::ReleaseHostDisplayResources()
 {
+  System::ReleaseParkedGPU();
   SaveStateSelectorUI::DestroyTextures();
 }
 
+u32 CommonHost::GetIdleWaitTimeout(bool frame_unchanged)
+{
+  if (!frame_unchanged)
+  {
+    s_idle_unchanged_frames = 0;
+    return 0;
+  }
+
+  // presenting is what normally paces these loops with vsync, so stand in for it until we're sure nothing's moving.
+  // async texture loads don't wake the loop when they finish, so keep checking for them.
+  if (s_idle_unchanged_frames < IDLE_BACKOFF_FRAMES || ImGuiFullscreen::HasPendingTextureLoads())
+  {
+    s_idle_unchanged_frames++;
+    const float refresh_rate = g_host_display ? g_host_display->GetWindowInfo().surface_refresh_rate : 0.0f;
+    return static_cast<u32>(std::ceil(1000.0f / ((refresh_rate > 0.0f) ? refresh_rate : 60.0f)));
+  }
+
+  return IDLE_MAX_WAIT_MS;
+}
+
 #ifndef __ANDROID__
 
 std::unique_ptr<AudioStream> Host::CreateAudioStream(AudioBackend backend, u32 sample_rate, u32 channels, u32 buffer_ms,
@@ -193,6 +220,9 @@ std::unique_ptr<AudioStream> Host::CreateAudioStream(AudioBackend backend, u32 s
 #ifdef _WIN32
     case AudioBackend::XAudio2:
       return CommonHost::CreateXAudio2Stream(sample_rate, channels, buffer_ms, latency_ms, stretch);
+
+    case AudioBackend::WASAPI:
+      return CommonHost::CreateWASAPIAudioStream(sample_rate, channels, buffer_ms, latency_ms, stretch);
 #endif
 
     case AudioBackend::Null:
@@ -225,6 +255,8 @@ void CommonHost::UpdateLogSettings()
   {
     Log::SetFileOutputParams(false, nullptr);
   }
+
+  Log::SetAsyncOutput(true);
 }
 
 void CommonHost::OnSystemStarting()
@@ -373,6 +405,7 @@ void CommonHost::CheckForSettingsChanges(const Settings& old_settings)
 #endif
 
   FullscreenUI::CheckForConfigChanges(old_settings);
+  ImGuiManager::InvalidatePerformanceOverlay();
 
   if (g_settings.log_level != old_settings.log_level || g_settings.log_filter != old_settings.log_filter ||
       g_settings.log_to_console != old_settings.log_to_console ||
@@ -388,6 +421,11 @@ void Host::SetPadVibrationIntensity(u32 pad_index, float large_or_single_motor_i
   InputManager::SetPadVibrationIntensity(pad_index, large_or_single_motor_intensity, small_motor_intensity);
 }
 
+void Host::LatchPadInput()
+{
+  InputManager::LatchPadInput();
+}
+
 void Host::DisplayLoadingScreen(const char* message, int progress_min /*= -1*/, int progress_max /*= -1*/,
                                 int progress_value /*= -1*/)
 {
@@ -607,16 +645,17 @@ static void HotkeyLoadStateSlot(bool global, s32 slot)
     return;
   }
 
-  std::string path(global ? System::GetGlobalSaveStateFileName(slot) :
-                            System::GetGameSaveStateFileName(System::GetRunningSerial(), slot));
-  if (!FileSystem::FileExists(path.c_str()))
+  // goes through System so a save to this slot which is still being written is waited for
+  const std::optional<SaveStateInfo> ssi(
+    System::GetSaveStateInfo(global ? nullptr : System::GetRunningSerial().c_str(), slot));
+  if (!ssi.has_value())
   {
     Host::AddKeyedOSDMessage("LoadState",
                              fmt::format(TRANSLATABLE("OSDMessage", "No save state found in slot {}."), slot), 5.0f);
     return;
   }
 
-  System::LoadState(path.c_str());
+  System::LoadState(ssi->path.c_str());
 }
 
 static void HotkeySaveStateSlot(bool global, s32 slot)
@@ -696,6 +735,41 @@ DEFINE_HOTKEY("Screenshot", TRANSLATABLE("Hotkeys", "General"), TRANSLATABLE("Ho
                   System::SaveScreenshot();
               })
 
+DEFINE_HOTKEY("ToggleGPUDump", TRANSLATABLE("Hotkeys", "General"), TRANSLATABLE("Hotkeys", "Toggle GPU Dump Recording"),
+              [](s32 pressed) {
+                if (!pressed && System::IsValid())
+                {
+                  if (System::IsRecordingGPUDump())
+                    System::StopRecordingGPUDump();
+                  else
+                    System::StartRecordingGPUDump();
+                }
+              })
+
+#ifdef WITH_PROFILER
+DEFINE_HOTKEY("ToggleProfileCapture", TRANSLATABLE("Hotkeys", "General"),
+              TRANSLATABLE("Hotkeys", "Toggle Profile Capture"), [](s32 pressed) {
+                if (!pressed && System::IsValid())
+                {
+                  if (System::IsCapturingProfile())
+                    System::StopProfileCapture();
+                  else
+                    System::StartProfileCapture();
+                }
+              })
+#endif
+
+DEFINE_HOTKEY("ToggleMediaCapture", TRANSLATABLE("Hotkeys", "General"),
+              TRANSLATABLE("Hotkeys", "Toggle Video Capture"), [](s32 pressed) {
+                if (!pressed && System::IsValid())
+                {
+                  if (System::IsCapturingMedia())
+                    System::StopMediaCapture();
+                  else
+                    System::StartMediaCapture();
+                }
+              })
+
 #if !defined(__ANDROID__) && defined(WITH_CHEEVOS)
 DEFINE_HOTKEY("OpenAchievements", TRANSLATABLE("Hotkeys", "General"), TRANSLATABLE("Hotkeys", "Open Achievement List"),
               [](s32 pressed) {
@@ -32,6 +32,11 @@ void PumpMessagesOnCPUThread();
 bool CreateHostDisplayResources();
 void ReleaseHostDisplayResources();
 
+/// Returns how many milliseconds an idle loop should block waiting for input or other events after rendering a frame.
+/// Zero if the frame was presented, since vsync paces it. Unchanged frames wait for one refresh while textures are
+/// still loading or the UI has only just stopped changing, then for up to 100ms.
+u32 GetIdleWaitTimeout(bool frame_unchanged);
+
 #ifdef WITH_CUBEB
 std::unique_ptr<AudioStream> CreateCubebAudioStream(u32 sample_rate, u32 channels, u32 buffer_ms, u32 latency_ms,
                                                     AudioStretchMode stretch);
@@ -40,6 +45,8 @@ std::vector<std::string> GetCubebDriverNames();
 #ifdef _WIN32
 std::unique_ptr<AudioStream> CreateXAudio2Stream(u32 sample_rate, u32 channels, u32 buffer_ms, u32 latency_ms,
                                                  AudioStretchMode stretch);
+std::unique_ptr<AudioStream> CreateWASAPIAudioStream(u32 sample_rate, u32 channels, u32 buffer_ms, u32 latency_ms,
+                                                     AudioStretchMode stretch);
 #endif
 } // namespace CommonHost
 
@@ -144,6 +144,12 @@ bool CubebAudioStream::Initialize(u32 latency_ms)
     return false;
   }
 
+  uint32_t stream_latency_frames = 0;
+  rv = cubeb_stream_get_latency(stream, &stream_latency_frames);
+  m_output_latency_frames = (rv == CUBEB_OK) ? stream_latency_frames : latency_frames;
+  Log_DevPrintf("(Cubeb) Output latency: %u ms (%u audio frames)",
+                GetMSForBufferSize(m_sample_rate, m_output_latency_frames), m_output_latency_frames);
+
   return true;
 }
 
@@ -657,8 +657,10 @@ bool D3D11HostDisplay::CreateResources()
 
 void D3D11HostDisplay::DestroyResources()
 {
+  CancelPendingPostProcessingChain();
   m_post_processing_chain.ClearStages();
   m_post_processing_input_texture.Destroy();
+  m_post_processing_output_texture.Destroy();
   m_post_processing_stages.clear();
 
   m_display_uniform_buffer.Release();
@@ -670,6 +672,10 @@ void D3D11HostDisplay::DestroyResources()
   m_display_blend_state.Reset();
   m_display_depth_stencil_state.Reset();
   m_display_rasterizer_state.Reset();
+
+  m_screenshot_readback_staging_texture.Reset();
+  m_screenshot_readback_texture.Destroy();
+  m_screenshot_readback_pending = false;
 }
 
 bool D3D11HostDisplay::CreateImGuiContext()
@@ -698,6 +704,8 @@ bool D3D11HostDisplay::Render(bool skip_present)
     return false;
   }
 
+  UpdatePendingPostProcessingChain();
+
   // When using vsync, the time here seems to include the time for the buffer to become available.
   // This blows our our GPU usage number considerably, so read the timestamp before the final blit
   // in this configuration. It does reduce accuracy a little, but better than seeing 100% all of
@@ -739,9 +747,86 @@ bool D3D11HostDisplay::RenderScreenshot(u32 width, u32 height, std::vector<u32>*
   if (!render_texture.Create(m_device.Get(), width, height, 1, 1, 1, hdformat, D3D11_BIND_RENDER_TARGET))
     return false;
 
+  RenderScreenshotDisplay(&render_texture);
+
+  const u32 stride = GPUTexture::GetPixelSize(hdformat) * width;
+  out_pixels->resize(width * height);
+  if (!DownloadTexture(&render_texture, 0, 0, width, height, out_pixels->data(), stride))
+    return false;
+
+  *out_stride = stride;
+  *out_format = hdformat;
+  return true;
+}
+
+bool D3D11HostDisplay::BeginScreenshotReadback(u32 width, u32 height)
+{
+  static constexpr GPUTexture::Format hdformat = GPUTexture::Format::RGBA8;
+
+  if (m_screenshot_readback_texture.GetWidth() != width || m_screenshot_readback_texture.GetHeight() != height)
+  {
+    m_screenshot_readback_staging_texture.Reset();
+    m_screenshot_readback_texture.Destroy();
+    if (!m_screenshot_readback_texture.Create(m_device.Get(), width, height, 1, 1, 1, hdformat,
+                                              D3D11_BIND_RENDER_TARGET))
+    {
+      return false;
+    }
+
+    const CD3D11_TEXTURE2D_DESC desc(D3D11::Texture::GetDXGIFormat(hdformat), width, height, 1, 1, 0,
+                                     D3D11_USAGE_STAGING, D3D11_CPU_ACCESS_READ);
+    const HRESULT hr =
+      m_device->CreateTexture2D(&desc, nullptr, m_screenshot_readback_staging_texture.ReleaseAndGetAddressOf());
+    if (FAILED(hr))
+    {
+      Log_ErrorPrintf("CreateTexture2D() failed with HRESULT %08X", hr);
+      m_screenshot_readback_texture.Destroy();
+      return false;
+    }
+  }
+
+  RenderScreenshotDisplay(&m_screenshot_readback_texture);
+  m_context->CopyResource(m_screenshot_readback_staging_texture.Get(), m_screenshot_readback_texture.GetD3DTexture());
+  m_screenshot_readback_pending = true;
+  return true;
+}
+
+bool D3D11HostDisplay::FinishScreenshotReadback(std::vector<u32>* out_pixels, u32* out_stride,
+                                                GPUTexture::Format* out_format)
+{
+  if (!m_screenshot_readback_pending)
+    return HostDisplay::FinishScreenshotReadback(out_pixels, out_stride, out_format);
+
+  m_screenshot_readback_pending = false;
+
+  D3D11_MAPPED_SUBRESOURCE sr;
+  const HRESULT hr = m_context->Map(m_screenshot_readback_staging_texture.Get(), 0, D3D11_MAP_READ, 0, &sr);
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("Map() failed with HRESULT %08X", hr);
+    return false;
+  }
+
+  const u32 width = m_screenshot_readback_texture.GetWidth();
+  const u32 height = m_screenshot_readback_texture.GetHeight();
+  const u32 stride = width * sizeof(u32);
+  out_pixels->resize(width * height);
+  StringUtil::StrideMemCpy(out_pixels->data(), stride, sr.pData, sr.RowPitch, stride, height);
+  m_context->Unmap(m_screenshot_readback_staging_texture.Get(), 0);
+
+  *out_stride = stride;
+  *out_format = GPUTexture::Format::RGBA8;
+  return true;
+}
+
+void D3D11HostDisplay::RenderScreenshotDisplay(D3D11::Texture* render_texture)
+{
+  const u32 width = render_texture->GetWidth();
+  const u32 height = render_texture->GetHeight();
+
   static constexpr std::array<float, 4> clear_color = {};
-  m_context->ClearRenderTargetView(render_texture.GetD3DRTV(), clear_color.data());
-  m_context->OMSetRenderTargets(1, render_texture.GetD3DRTVArray(), nullptr);
+  m_context->ClearRenderTargetView(render_texture->GetD3DRTV(), clear_color.data());
+  m_context->OMSetRenderTargets(1, render_texture->GetD3DRTVArray(), nullptr);
 
   if (HasDisplayTexture())
   {
@@ -749,7 +834,7 @@ bool D3D11HostDisplay::RenderScreenshot(u32 width, u32 height, std::vector<u32>*
 
     if (!m_post_processing_chain.IsEmpty())
     {
-      ApplyPostProcessingChain(render_texture.GetD3DRTV(), left, top, draw_width, draw_height,
+      ApplyPostProcessingChain(render_texture->GetD3DRTV(), left, top, draw_width, draw_height,
                                static_cast<D3D11::Texture*>(m_display_texture), m_display_texture_view_x,
                                m_display_texture_view_y, m_display_texture_view_width, m_display_texture_view_height,
                                width, height);
@@ -763,15 +848,6 @@ bool D3D11HostDisplay::RenderScreenshot(u32 width, u32 height, std::vector<u32>*
   }
 
   m_context->OMSetRenderTargets(0, nullptr, nullptr);
-
-  const u32 stride = GPUTexture::GetPixelSize(hdformat) * width;
-  out_pixels->resize(width * height);
-  if (!DownloadTexture(&render_texture, 0, 0, width, height, out_pixels->data(), stride))
-    return false;
-
-  *out_stride = stride;
-  *out_format = hdformat;
-  return true;
 }
 
 void D3D11HostDisplay::RenderImGui()
@@ -956,36 +1032,106 @@ HostDisplay::AdapterAndModeList D3D11HostDisplay::GetAdapterAndModeList()
 
 bool D3D11HostDisplay::SetPostProcessingChain(const std::string_view& config)
 {
+  CancelPendingPostProcessingChain();
+
   if (config.empty())
   {
     m_post_processing_input_texture.Destroy();
+    m_post_processing_output_texture.Destroy();
     m_post_processing_stages.clear();
     m_post_processing_chain.ClearStages();
     return true;
   }
 
-  if (!m_post_processing_chain.CreateFromString(config))
+  std::unique_ptr<PendingPostProcessingChain> pending = std::make_unique<PendingPostProcessingChain>();
+  if (!pending->chain.CreateFromString(config))
     return false;
 
-  m_post_processing_stages.clear();
-
   D3D11::ShaderCache shader_cache;
   shader_cache.Open(EmuFolders::Cache, m_device->GetFeatureLevel(), SHADER_CACHE_VERSION,
                     g_settings.gpu_use_debug_device);
 
   FrontendCommon::PostProcessingShaderGen shadergen(RenderAPI::D3D11, true);
-  u32 max_ubo_size = 0;
+  const u32 stage_count = pending->chain.GetStageCount();
+  pending->vertex_shaders.resize(stage_count);
+  pending->pixel_shaders.resize(stage_count);
+  pending->vertex_blobs.resize(stage_count);
+  pending->pixel_blobs.resize(stage_count);
+
+  bool needs_compile = false;
+  for (u32 i = 0; i < stage_count; i++)
+  {
+    const FrontendCommon::PostProcessingShader& shader = pending->chain.GetShaderStage(i);
+    pending->vertex_shaders[i] = shadergen.GeneratePostProcessingVertexShader(shader);
+    pending->pixel_shaders[i] = shadergen.GeneratePostProcessingFragmentShader(shader);
+    pending->vertex_blobs[i] =
+      shader_cache.LookupShaderBlob(D3D11::ShaderCompiler::Type::Vertex, pending->vertex_shaders[i]);
+    pending->pixel_blobs[i] =
+      shader_cache.LookupShaderBlob(D3D11::ShaderCompiler::Type::Pixel, pending->pixel_shaders[i]);
+    needs_compile |= (!pending->vertex_blobs[i] || !pending->pixel_blobs[i]);
+  }
+
+  if (!needs_compile)
+    return CreatePostProcessingStages(*pending, false);
 
-  for (u32 i = 0; i < m_post_processing_chain.GetStageCount(); i++)
+  Log_InfoPrintf("Compiling %u post-processing stages in the background", stage_count);
+
+  PendingPostProcessingChain* pending_ptr = pending.get();
+  const D3D_FEATURE_LEVEL feature_level = m_device->GetFeatureLevel();
+  const bool debug = g_settings.gpu_use_debug_device;
+  pending->group.Run([pending_ptr, stage_count, feature_level, debug]() {
+    for (u32 i = 0; i < stage_count && !pending_ptr->group.IsCancelled(); i++)
+    {
+      if (!pending_ptr->vertex_blobs[i])
+      {
+        pending_ptr->vertex_blobs[i] = D3D11::ShaderCompiler::CompileShader(
+          D3D11::ShaderCompiler::Type::Vertex, feature_level, pending_ptr->vertex_shaders[i], debug);
+      }
+      if (!pending_ptr->pixel_blobs[i])
+      {
+        pending_ptr->pixel_blobs[i] = D3D11::ShaderCompiler::CompileShader(
+          D3D11::ShaderCompiler::Type::Pixel, feature_level, pending_ptr->pixel_shaders[i], debug);
+      }
+    }
+
+    pending_ptr->done.store(true, std::memory_order_release);
+  });
+
+  m_pending_post_processing_chain = std::move(pending);
+  return true;
+}
+
+bool D3D11HostDisplay::CreatePostProcessingStages(PendingPostProcessingChain& pending, bool add_to_cache)
+{
+  // blobs compiled on the worker are only written to the cache here, so that it's never opened by two threads
+  D3D11::ShaderCache shader_cache;
+  if (add_to_cache)
   {
-    const FrontendCommon::PostProcessingShader& shader = m_post_processing_chain.GetShaderStage(i);
-    const std::string vs = shadergen.GeneratePostProcessingVertexShader(shader);
-    const std::string ps = shadergen.GeneratePostProcessingFragmentShader(shader);
+    shader_cache.Open(EmuFolders::Cache, m_device->GetFeatureLevel(), SHADER_CACHE_VERSION,
+                      g_settings.gpu_use_debug_device);
+  }
+
+  std::vector<PostProcessingStage> stages;
+  u32 max_ubo_size = 0;
 
+  for (u32 i = 0; i < pending.chain.GetStageCount(); i++)
+  {
     PostProcessingStage stage;
-    stage.uniforms_size = shader.GetUniformsSize();
-    stage.vertex_shader = shader_cache.GetVertexShader(m_device.Get(), vs);
-    stage.pixel_shader = shader_cache.GetPixelShader(m_device.Get(), ps);
+    stage.uniforms_size = pending.chain.GetShaderStage(i).GetUniformsSize();
+    if (pending.vertex_blobs[i] && pending.pixel_blobs[i])
+    {
+      if (add_to_cache)
+      {
+        shader_cache.InsertShaderBlob(D3D11::ShaderCompiler::Type::Vertex, pending.vertex_shaders[i],
+                                      pending.vertex_blobs[i].Get());
+        shader_cache.InsertShaderBlob(D3D11::ShaderCompiler::Type::Pixel, pending.pixel_shaders[i],
+                                      pending.pixel_blobs[i].Get());
+      }
+
+      stage.vertex_shader = D3D11::ShaderCompiler::CreateVertexShader(m_device.Get(), pending.vertex_blobs[i].Get());
+      stage.pixel_shader = D3D11::ShaderCompiler::CreatePixelShader(m_device.Get(), pending.pixel_blobs[i].Get());
+    }
+
     if (!stage.vertex_shader || !stage.pixel_shader)
     {
       Log_ErrorPrintf("Failed to compile one or more post-processing shaders, disabling.");
@@ -995,7 +1141,7 @@ bool D3D11HostDisplay::SetPostProcessingChain(const std::string_view& config)
     }
 
     max_ubo_size = std::max(max_ubo_size, stage.uniforms_size);
-    m_post_processing_stages.push_back(std::move(stage));
+    stages.push_back(std::move(stage));
   }
 
   if (m_display_uniform_buffer.GetSize() < max_ubo_size &&
@@ -1007,9 +1153,30 @@ bool D3D11HostDisplay::SetPostProcessingChain(const std::string_view& config)
     return false;
   }
 
+  m_post_processing_chain = std::move(pending.chain);
+  m_post_processing_stages = std::move(stages);
   return true;
 }
 
+void D3D11HostDisplay::UpdatePendingPostProcessingChain()
+{
+  if (!m_pending_post_processing_chain || !m_pending_post_processing_chain->done.load(std::memory_order_acquire))
+    return;
+
+  std::unique_ptr<PendingPostProcessingChain> pending = std::move(m_pending_post_processing_chain);
+  CreatePostProcessingStages(*pending, true);
+}
+
+void D3D11HostDisplay::CancelPendingPostProcessingChain()
+{
+  if (!m_pending_post_processing_chain)
+    return;
+
+  // waits for the stage being compiled, if any
+  m_pending_post_processing_chain->group.Cancel();
+  m_pending_post_processing_chain.reset();
+}
+
 bool D3D11HostDisplay::CheckPostProcessingRenderTargets(u32 target_width, u32 target_height)
 {
   DebugAssert(!m_post_processing_stages.empty());
@@ -1027,14 +1194,14 @@ bool D3D11HostDisplay::CheckPostProcessingRenderTargets(u32 target_width, u32 ta
     }
   }
 
-  const u32 target_count = (static_cast<u32>(m_post_processing_stages.size()) - 1);
-  for (u32 i = 0; i < target_count; i++)
+  // only needed when there is more than one stage, the final stage writes to the target
+  if (m_post_processing_stages.size() > 1 && (m_post_processing_output_texture.GetWidth() != target_width ||
+                                              m_post_processing_output_texture.GetHeight() != target_height))
   {
-    PostProcessingStage& pps = m_post_processing_stages[i];
-    if (pps.output_texture.GetWidth() != target_width || pps.output_texture.GetHeight() != target_height)
+    if (!m_post_processing_output_texture.Create(m_device.Get(), target_width, target_height, 1, 1, 1, format,
+                                                 bind_flags))
     {
-      if (!pps.output_texture.Create(m_device.Get(), target_width, target_height, 1, 1, 1, format, bind_flags))
-        return false;
+      return false;
     }
   }
 
@@ -1071,14 +1238,22 @@ void D3D11HostDisplay::ApplyPostProcessingChain(ID3D11RenderTargetView* final_ta
   for (u32 i = 0; i < static_cast<u32>(m_post_processing_stages.size()); i++)
   {
     PostProcessingStage& pps = m_post_processing_stages[i];
+
+    // each stage only reads the previous stage's output, so two intermediate textures are enough
+    D3D11::Texture* output_texture = (texture == &m_post_processing_input_texture) ?
+                                       &m_post_processing_output_texture :
+                                       &m_post_processing_input_texture;
     if (i == final_stage)
     {
       m_context->OMSetRenderTargets(1, &final_target, nullptr);
     }
     else
     {
-      m_context->ClearRenderTargetView(pps.output_texture.GetD3DRTV(), clear_color.data());
-      m_context->OMSetRenderTargets(1, pps.output_texture.GetD3DRTVArray(), nullptr);
+      // the output may still be bound as the previous stage's input
+      ID3D11ShaderResourceView* null_srv = nullptr;
+      m_context->PSSetShaderResources(0, 1, &null_srv);
+      m_context->ClearRenderTargetView(output_texture->GetD3DRTV(), clear_color.data());
+      m_context->OMSetRenderTargets(1, output_texture->GetD3DRTVArray(), nullptr);
     }
 
     m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -1099,7 +1274,7 @@ void D3D11HostDisplay::ApplyPostProcessingChain(ID3D11RenderTargetView* final_ta
     m_context->Draw(3, 0);
 
     if (i != final_stage)
-      texture = &pps.output_texture;
+      texture = output_texture;
   }
 
   ID3D11ShaderResourceView* null_srv = nullptr;
@@ -1,10 +1,12 @@
 #pragma once
 #include "common/d3d11/stream_buffer.h"
 #include "common/d3d11/texture.h"
+#include "common/task_scheduler.h"
 #include "common/window_info.h"
 #include "common/windows_headers.h"
 #include "core/host_display.h"
 #include "frontend-common/postprocessing_chain.h"
+#include <atomic>
 #include <d3d11.h>
 #include <dxgi.h>
 #include <memory>
@@ -67,6 +69,8 @@ public:
   bool Render(bool skip_present) override;
   bool RenderScreenshot(u32 width, u32 height, std::vector<u32>* out_pixels, u32* out_stride,
                         GPUTexture::Format* out_format) override;
+  bool BeginScreenshotReadback(u32 width, u32 height) override;
+  bool FinishScreenshotReadback(std::vector<u32>* out_pixels, u32* out_stride, GPUTexture::Format* out_format) override;
 
   static AdapterAndModeList StaticGetAdapterAndModeList();
 
@@ -90,6 +94,7 @@ protected:
   bool CreateSwapChainRTV();
 
   void RenderDisplay();
+  void RenderScreenshotDisplay(D3D11::Texture* render_texture);
   void RenderSoftwareCursor();
   void RenderImGui();
 
@@ -101,10 +106,24 @@ protected:
   {
     ComPtr<ID3D11VertexShader> vertex_shader;
     ComPtr<ID3D11PixelShader> pixel_shader;
-    D3D11::Texture output_texture;
     u32 uniforms_size;
   };
 
+  // chains with shaders missing from the cache are compiled on a worker, the current chain is used until it's done
+  struct PendingPostProcessingChain
+  {
+    FrontendCommon::PostProcessingChain chain;
+    std::vector<std::string> vertex_shaders;
+    std::vector<std::string> pixel_shaders;
+    std::vector<ComPtr<ID3DBlob>> vertex_blobs;
+    std::vector<ComPtr<ID3DBlob>> pixel_blobs;
+    std::atomic_bool done{false};
+    Threading::TaskGroup group;
+  };
+
+  bool CreatePostProcessingStages(PendingPostProcessingChain& pending, bool add_to_cache);
+  void UpdatePendingPostProcessingChain();
+  void CancelPendingPostProcessingChain();
   bool CheckPostProcessingRenderTargets(u32 target_width, u32 target_height);
   void ApplyPostProcessingChain(ID3D11RenderTargetView* final_target, s32 final_left, s32 final_top, s32 final_width,
                                 s32 final_height, D3D11::Texture* texture, s32 texture_view_x, s32 texture_view_y,
@@ -138,6 +157,11 @@ protected:
   u32 m_readback_staging_texture_width = 0;
   u32 m_readback_staging_texture_height = 0;
 
+  // screenshots are copied to their own staging texture, which is only mapped when they're collected
+  D3D11::Texture m_screenshot_readback_texture;
+  ComPtr<ID3D11Texture2D> m_screenshot_readback_staging_texture;
+  bool m_screenshot_readback_pending = false;
+
   bool m_allow_tearing_supported = false;
   bool m_using_flip_model_swap_chain = true;
   bool m_using_allow_tearing = false;
@@ -145,7 +169,9 @@ protected:
 
   FrontendCommon::PostProcessingChain m_post_processing_chain;
   D3D11::Texture m_post_processing_input_texture;
+  D3D11::Texture m_post_processing_output_texture; // intermediate stages ping-pong between this and the input texture
   std::vector<PostProcessingStage> m_post_processing_stages;
+  std::unique_ptr<PendingPostProcessingChain> m_pending_post_processing_chain;
 
   std::array<std::array<ComPtr<ID3D11Query>, 3>, NUM_TIMESTAMP_QUERIES> m_timestamp_queries = {};
   u8 m_read_timestamp_query = 0;
@@ -413,9 +413,13 @@ static void DrawGameListSettingsPage(const ImVec2& heading_size);
 static void SwitchToGameList();
 static void PopulateGameListEntryList();
 static GPUTexture* GetTextureForGameListEntryType(GameList::EntryType type);
+static const std::string& GetGameListCoverPath(const GameList::Entry* entry);
 static GPUTexture* GetGameListCover(const GameList::Entry* entry);
 static GPUTexture* GetCoverForCurrentGame();
 
+// rows of the grid above and below the view which have their covers loaded ahead of time
+static constexpr float GAME_GRID_PREFETCH_ROWS = 2.0f;
+
 // Lazily populated cover images.
 static std::unordered_map<std::string, std::string> s_cover_image_map;
 static std::vector<const GameList::Entry*> s_game_list_sorted_entries;
@@ -2365,6 +2369,10 @@ void FullscreenUI::DrawInterfaceSettingsPage()
                     "ShowCPU", false);
   DrawToggleSetting(bsi, ICON_FA_SPINNER " Show GPU Usage",
                     "Shows the host's GPU usage in the top-right corner of the display.", "Display", "ShowGPU", false);
+  DrawToggleSetting(bsi, ICON_FA_MICROCHIP " Show Subsystem Times",
+                    "Shows how the emulation thread's time is split between the CPU, GPU, SPU, MDEC and timing "
+                    "events in the top-right corner of the display.",
+                    "Display", "ShowSubsystemTimes", false);
   DrawToggleSetting(bsi, ICON_FA_RULER_VERTICAL " Show Resolution",
                     "Shows the current rendering resolution of the system in the top-right corner of the display.",
                     "Display", "ShowResolution", false);
@@ -2439,6 +2447,9 @@ void FullscreenUI::DrawBIOSSettingsPage()
 
   DrawToggleSetting(bsi, "Enable Fast Boot", "Patches the BIOS to skip the boot animation. Safe to enable.", "BIOS",
                     "PatchFastBoot", Settings::DEFAULT_FAST_BOOT_VALUE);
+  DrawToggleSetting(bsi, "Enable Instant Boot",
+                    "Resumes games from a state taken when they first started, skipping the BIOS and loading.",
+                    "BIOS", "InstantBoot", false);
   DrawToggleSetting(bsi, "Enable TTY Output",
                     "Patches the BIOS to log calls to printf(). Only use when debugging, can break games.", "BIOS",
                     "PatchTTYEnable", false);
@@ -2525,6 +2536,10 @@ void FullscreenUI::DrawConsoleSettingsPage()
     bsi, "Apply Image Patches",
     "Automatically applies patches to disc images when they are present, currently only PPF is supported.", "CDROM",
     "LoadImagePatches", false);
+  DrawToggleSetting(bsi, "Cache Sectors Locally",
+                    "Keeps a copy of sectors read from disc images in the cache directory, so images on network "
+                    "drives only have to be read once.",
+                    "CDROM", "SectorCache", false);
 
   EndMenuButtons();
 }
@@ -2578,6 +2593,10 @@ void FullscreenUI::DrawEmulationSettingsPage()
   DrawIntRangeSetting(bsi, "Rewind Save Slots",
                       "How many saves will be kept for rewinding. Higher values have greater memory requirements.",
                       "Main", "RewindSaveSlots", 10, 1, 10000, "%d Frames");
+  DrawToggleSetting(bsi, "Store Rewind VRAM at Native Resolution",
+                    "Keeps rewind states in system memory instead of video memory. Upscaled detail is lost for a "
+                    "frame after rewinding.",
+                    "Main", "RewindNativeResolutionVRAM", false);
 
   const s32 runahead_frames = GetEffectiveIntSetting(bsi, "Main", "RunaheadFrameCount", 0);
   const bool runahead_enabled = (runahead_frames > 0);
@@ -2602,12 +2621,13 @@ void FullscreenUI::DrawEmulationSettingsPage()
   {
     const float rewind_frequency = GetEffectiveFloatSetting(bsi, "Main", "RewindFrequency", 10.0f);
     const s32 rewind_save_slots = GetEffectiveIntSetting(bsi, "Main", "RewindSaveSlots", 10);
+    const bool rewind_native_vram = GetEffectiveBoolSetting(bsi, "Main", "RewindNativeResolutionVRAM", false);
     const float duration =
       ((rewind_frequency <= std::numeric_limits<float>::epsilon()) ? (1.0f / 60.0f) : rewind_frequency) *
       static_cast<float>(rewind_save_slots);
 
     u64 ram_usage, vram_usage;
-    System::CalculateRewindMemoryUsage(rewind_save_slots, &ram_usage, &vram_usage);
+    System::CalculateRewindMemoryUsage(rewind_save_slots, rewind_native_vram, &ram_usage, &vram_usage);
     rewind_summary.Format("Rewind for %u frames, lasting %.2f seconds will require up to %" PRIu64
                           "MB of RAM and %" PRIu64 "MB of VRAM.",
                           rewind_save_slots, duration, ram_usage / 1048576, vram_usage / 1048576);
@@ -3344,6 +3364,11 @@ void FullscreenUI::DrawDisplaySettingsPage()
   DrawToggleSetting(bsi, "Enable VSync",
                     "Synchronizes presentation of the console's frames to the host. Enable for smoother animations.",
                     "Display", "VSync", Settings::DEFAULT_VSYNC_VALUE);
+  DrawToggleSetting(bsi, "Relaxed VSync",
+                    "Presents frames which miss the refresh interval immediately, tearing instead of stuttering. "
+                    "Vulkan only.",
+                    "Display", "RelaxedVSync", false,
+                    GetEffectiveBoolSetting(bsi, "Display", "VSync", Settings::DEFAULT_VSYNC_VALUE));
 
   DrawToggleSetting(bsi, "Sync To Host Refresh Rate",
                     "Adjusts the emulation speed so the console's refresh rate matches the host when VSync and Audio "
@@ -3354,6 +3379,17 @@ void FullscreenUI::DrawDisplaySettingsPage()
     bsi, "Optimal Frame Pacing",
     "Ensures every frame generated is displayed for optimal pacing. Disable if you are having speed or sound issues.",
     "Display", "DisplayAllFrames", false);
+  DrawToggleSetting(bsi, "Reduce Input Latency",
+                    "Delays the start of each frame until just before it is needed, so it uses the newest input.",
+                    "Display", "PreFrameSleep", false);
+  DrawToggleSetting(bsi, "Adaptive Frameskip",
+                    "Skips drawing frames when the system can't keep up, so audio and game speed stay smooth. May "
+                    "cause flickering in some games.",
+                    "Display", "AdaptiveFrameskip", false);
+  DrawFloatRangeSetting(bsi, "Input Latency Safety Margin",
+                        "Time left for presenting each frame when reducing input latency. Increase if frames drop.",
+                        "Display", "PreFrameSleepBuffer", Settings::DEFAULT_DISPLAY_PRE_FRAME_SLEEP_BUFFER, 0.0f,
+                        20.0f, "%.1f ms", 1.0f, GetEffectiveBoolSetting(bsi, "Display", "PreFrameSleep", false));
 
   MenuHeading("Rendering");
 
@@ -3362,6 +3398,13 @@ void FullscreenUI::DrawDisplaySettingsPage()
     "Scales internal VRAM resolution by the specified multiplier. Some games require 1x VRAM resolution.", "GPU",
     "ResolutionScale", 1, resolution_scales.data(), resolution_scales.size(), 0, is_hardware);
 
+  DrawToggleSetting(bsi, "Dynamic Resolution Scaling",
+                    "Lowers the internal resolution when the GPU can't keep up, and raises it again when it can.",
+                    "GPU", "DynamicResolution", false, is_hardware);
+  DrawIntRangeSetting(bsi, "Dynamic Resolution Minimum Scale",
+                      "The lowest scale dynamic resolution scaling will drop to.", "GPU", "DynamicResolutionMinScale",
+                      1, 1, 16, "%dx", is_hardware && GetEffectiveBoolSetting(bsi, "GPU", "DynamicResolution", false));
+
   DrawEnumSetting(bsi, "Texture Filtering",
                   "Smooths out the blockiness of magnified textures on 3D objects. Will have a greater effect "
                   "on higher resolution scales. The JINC2 and especially xBR filtering modes are very demanding,"
@@ -3472,6 +3515,9 @@ void FullscreenUI::DrawDisplaySettingsPage()
   DrawToggleSetting(bsi, "Preload Replacement Textures",
                     "Loads all replacement texture to RAM, reducing stuttering at runtime.", "TextureReplacements",
                     "PreloadTextures", false);
+  DrawToggleSetting(bsi, "Load Replacement Textures Asynchronously",
+                    "Loads replacement textures in the background, showing the original texture until ready.",
+                    "TextureReplacements", "AsyncLoading", true);
 
   EndMenuButtons();
 }
@@ -3495,6 +3541,10 @@ void FullscreenUI::DrawAudioSettingsPage()
                     "Forcibly mutes both CD-DA and XA audio from the CD-ROM. Can be used to "
                     "disable background music in some games.",
                     "CDROM", "MuteCDAudio", false);
+  DrawToggleSetting(bsi, "Audio-Only PSF Playback",
+                    "Plays PSF files without rendering or presenting, pacing emulation by the audio output instead of "
+                    "the display. Uses much less power.",
+                    "Audio", "AudioOnlyPSF", true);
 
   MenuHeading("Backend Settings");
 
@@ -3760,6 +3810,12 @@ void FullscreenUI::DrawAdvancedSettingsPage()
                     "Enable debugging when supported by the host's renderer API. Only for developer use.", "GPU",
                     "UseDebugDevice", false);
 
+  DrawIntRangeSetting(bsi, "Vulkan Frames In Flight",
+                      "Number of frames the CPU can queue ahead of the GPU. Lower values reduce latency, higher values "
+                      "avoid stalls.",
+                      "GPU", "MaxFramesInFlight", Settings::DEFAULT_GPU_MAX_FRAMES_IN_FLIGHT, 1,
+                      Settings::MAX_GPU_MAX_FRAMES_IN_FLIGHT);
+
 #ifdef _WIN32
   DrawToggleSetting(bsi, "Increase Timer Resolution", "Enables more precise frame pacing at the cost of battery life.",
                     "Main", "IncreaseTimerResolution", true);
@@ -3772,6 +3828,19 @@ void FullscreenUI::DrawAdvancedSettingsPage()
   DrawToggleSetting(bsi, "Create Save State Backups", "Renames existing save states when saving to a backup file.",
                     "Main", "CreateSaveStateBackups", false);
 
+  const bool detect_stutters = GetEffectiveBoolSetting(bsi, "Display", "DetectStutters", false);
+  DrawToggleSetting(bsi, "Log Stutters",
+                    "Writes the time spent in each part of the emulator over the previous frames to the log when a "
+                    "frame takes much longer than usual.",
+                    "Display", "DetectStutters", false);
+  DrawFloatRangeSetting(bsi, "Stutter Threshold", "Frames which take at least this long are logged as stutters.",
+                        "Display", "StutterThreshold", Settings::DEFAULT_DISPLAY_STUTTER_THRESHOLD, 0.0f, 1000.0f,
+                        "%.0f ms", 1.0f, detect_stutters);
+  DrawFloatRangeSetting(bsi, "Stutter Median Threshold",
+                        "Frames which take at least this many times the median frame time are logged as stutters.",
+                        "Display", "StutterMedianMultiplier", Settings::DEFAULT_DISPLAY_STUTTER_MEDIAN_MULTIPLIER,
+                        0.0f, 10.0f, "%.1fx", 1.0f, detect_stutters);
+
   MenuHeading("Display Settings");
   DrawToggleSetting(bsi, "Show Status Indicators", "Shows persistent icons when turbo is active or when paused.",
                     "Display", "ShowStatusIndicators", true);
@@ -3810,12 +3879,26 @@ void FullscreenUI::DrawAdvancedSettingsPage()
   DrawToggleSetting(bsi, "Enable Recompiler ICache",
                     "Simulates the CPU's instruction cache in the recompiler. Can help with games running too fast.",
                     "CPU", "RecompilerICache", false);
+  DrawToggleSetting(bsi, "Use Huge Pages For Emulated Memory",
+                    "Backs RAM, VRAM and the recompiler's code with huge pages where the host allows it. Takes effect "
+                    "on the next boot.",
+                    "Console", "UseHugePages", false);
+  DrawToggleSetting(bsi, "Share BIOS And Resources Between Instances",
+                    "Maps the BIOS and font files instead of reading them, so running instances share one copy. Takes "
+                    "effect on the next boot.",
+                    "Main", "MapResourceFiles", false);
+  DrawToggleSetting(bsi, "Enable Idle Loop Skipping",
+                    "Skips ahead to the next event when the game waits in a loop. Timing is unaffected.", "CPU",
+                    "IdleLoopSkipping", true);
   DrawToggleSetting(bsi, "Enable Recompiler Memory Exceptions",
                     "Enables alignment and bus exceptions. Not needed for any known games.", "CPU",
                     "RecompilerMemoryExceptions", false);
   DrawToggleSetting(bsi, "Enable Recompiler Block Linking",
                     "Performance enhancement - jumps directly between blocks instead of returning to the dispatcher.",
                     "CPU", "RecompilerBlockLinking", true);
+  DrawToggleSetting(bsi, "Enable Recompiler Block Cache",
+                    "Saves the list of compiled blocks per-game, and precompiles them at boot to reduce stutter.",
+                    "CPU", "RecompilerBlockCache", false);
   DrawEnumSetting(bsi, "Recompiler Fast Memory Access",
                   "Avoids calls to C++ code, significantly speeding up the recompiler.", "CPU", "FastmemMode",
                   Settings::DEFAULT_CPU_FASTMEM_MODE, &Settings::ParseCPUFastmemMode, &Settings::GetCPUFastmemModeName,
@@ -4248,6 +4331,9 @@ void FullscreenUI::DrawSaveStateSelector(bool is_loading, bool fullscreen)
     if (!visible)
       continue;
 
+    if (hovered && is_loading)
+      System::PrefetchSaveState(entry.path.c_str());
+
     ImVec2 pos(bb.Min);
 
     // use aspect ratio of screenshot to determine height
@@ -4758,6 +4844,10 @@ void FullscreenUI::DrawGameGrid(const ImVec2& heading_size)
 
   SmallString draw_title;
 
+  const ImGuiWindow* const current_window = ImGui::GetCurrentWindow();
+  const float prefetch_min_y = current_window->ClipRect.Min.y - (item_height + item_spacing) * GAME_GRID_PREFETCH_ROWS;
+  const float prefetch_max_y = current_window->ClipRect.Max.y + (item_height + item_spacing) * GAME_GRID_PREFETCH_ROWS;
+
   u32 grid_x = 0;
   u32 grid_y = 0;
   ImGui::SetCursorPos(ImVec2(start_x, 0.0f));
@@ -4818,6 +4908,13 @@ void FullscreenUI::DrawGameGrid(const ImVec2& heading_size)
         HandleGameListOptions(entry);
       }
     }
+    else if (bb.Max.y >= prefetch_min_y && bb.Min.y <= prefetch_max_y)
+    {
+      // just outside the view, start loading the cover so it's ready when it's scrolled to
+      const std::string& cover_path = GetGameListCoverPath(entry);
+      if (!cover_path.empty())
+        ImGuiFullscreen::PrefetchCachedTextureAsync(cover_path);
+    }
 
     grid_x++;
     if (grid_x == grid_count_x)
@@ -5101,7 +5198,7 @@ void FullscreenUI::SwitchToGameList()
   QueueResetFocus();
 }
 
-GPUTexture* FullscreenUI::GetGameListCover(const GameList::Entry* entry)
+const std::string& FullscreenUI::GetGameListCoverPath(const GameList::Entry* entry)
 {
   // lookup and grab cover image
   auto cover_it = s_cover_image_map.find(entry->path);
@@ -5111,7 +5208,13 @@ GPUTexture* FullscreenUI::GetGameListCover(const GameList::Entry* entry)
     cover_it = s_cover_image_map.emplace(entry->path, std::move(cover_path)).first;
   }
 
-  GPUTexture* tex = (!cover_it->second.empty()) ? GetCachedTextureAsync(cover_it->second.c_str()) : nullptr;
+  return cover_it->second;
+}
+
+GPUTexture* FullscreenUI::GetGameListCover(const GameList::Entry* entry)
+{
+  const std::string& cover_path = GetGameListCoverPath(entry);
+  GPUTexture* tex = (!cover_path.empty()) ? GetCachedTextureAsync(cover_path.c_str()) : nullptr;
   return tex ? tex : GetTextureForGameListEntryType(entry->type);
 }
 
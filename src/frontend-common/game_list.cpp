@@ -8,6 +8,7 @@
 #include "common/path.h"
 #include "common/progress_callback.h"
 #include "common/string_util.h"
+#include "common/thirdparty/thread_pool.h"
 #include "core/bios.h"
 #include "core/host.h"
 #include "core/host_settings.h"
@@ -17,9 +18,15 @@
 #include "util/cd_image.h"
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
+#include <cstdio>
+#include <cstring>
 #include <ctime>
+#include <future>
+#include <optional>
 #include <string_view>
+#include <thread>
 #include <tinyxml2.h>
 #include <unordered_map>
 #include <utility>
@@ -28,35 +35,129 @@ Log_SetChannel(GameList);
 enum : u32
 {
   GAME_LIST_CACHE_SIGNATURE = 0x45434C47,
-  GAME_LIST_CACHE_VERSION = 32
+  GAME_LIST_CACHE_VERSION = 33,
+
+  DIRECTORY_CACHE_SIGNATURE = 0x43444C47,
+  DIRECTORY_CACHE_VERSION = 1,
+
+  // scanning is mostly waiting on reads, so this is more about not flooding network shares than the core count
+  MAX_SCAN_THREADS = 8,
+
+  // with HTTP/2 these share a connection, so it's the number of covers in flight rather than sockets
+  MAX_PARALLEL_COVER_DOWNLOADS = 8,
 };
 
 namespace GameList {
-using CacheMap = std::unordered_map<std::string, Entry>;
+// The cache is a header, followed by an array of fixed-size records, and then a table of the strings they reference.
+// It's mapped rather than read, so only the records which are actually used are converted to entries.
+struct CacheHeader
+{
+  u32 signature;
+  u32 version;
+  u32 record_count;
+  u32 string_table_size;
+};
+
+struct CacheString
+{
+  u32 offset;
+  u32 length;
+};
+
+struct CacheRecord
+{
+  CacheString path;
+  CacheString serial;
+  CacheString title;
+  CacheString genre;
+  CacheString publisher;
+  CacheString developer;
+  u64 total_size;
+  u64 last_modified_time;
+  u64 release_date;
+  u32 supported_controllers;
+  u8 type;
+  u8 region;
+  u8 min_players;
+  u8 max_players;
+  u8 min_blocks;
+  u8 max_blocks;
+  u8 compatibility;
+  u8 reserved[5];
+};
+static_assert(sizeof(CacheHeader) == 16 && sizeof(CacheRecord) == 88, "Cache structures are packed");
+
+// paths in the mapped string table to their record index, entries are removed as they're used
+using CacheMap = std::unordered_map<std::string_view, u32>;
+
+// The contents of a directory the last time it was listed. A directory's modification time changes when files are
+// added, removed or renamed in it, so unless it has, the cached contents are used instead of listing it again.
+struct DirectoryCacheEntry
+{
+  std::time_t modified_time = 0;
+  std::vector<std::pair<std::string, std::time_t>> files;
+  std::vector<std::string> subdirectories;
+};
+using DirectoryCacheMap = std::unordered_map<std::string, DirectoryCacheEntry>;
+
+// whether each directory visited during a refresh has also had its subdirectories visited
+using DirectoryVisitMap = std::unordered_map<std::string, bool>;
 
 static bool GetExeListEntry(const std::string& path, Entry* entry);
 static bool GetPsfListEntry(const std::string& path, Entry* entry);
 static bool GetDiscListEntry(const std::string& path, Entry* entry);
 
+static std::string_view GetCacheString(const CacheString& str);
+static bool ReadCacheRecord(u32 index, CacheRecord* record);
+static void PopulateEntryFromCacheRecord(const CacheRecord& record, Entry* entry);
 static bool GetGameListEntryFromCache(const std::string& path, Entry* entry);
 static void ScanDirectory(const char* path, bool recursive, bool only_cache,
-                          const std::vector<std::string>& excluded_paths, ProgressCallback* progress);
+                          const std::vector<std::string>& excluded_paths, DirectoryVisitMap* visited,
+                          ProgressCallback* progress);
+static void FindFilesInDirectory(const std::string& path, bool recursive, DirectoryVisitMap* visited,
+                                 FileSystem::FindResultsArray* files);
+static const DirectoryCacheEntry* GetDirectoryContents(const std::string& path);
 static bool AddFileFromCache(const std::string& path, std::time_t timestamp);
-static bool ScanFile(std::string path, std::time_t timestamp);
+static std::optional<Entry> ScanFile(std::string path, std::time_t timestamp);
+static void AddScannedEntry(Entry entry);
+
+static std::string GetIndexKey(const std::string_view& str);
+static void AddEntry(Entry entry);
 
 static std::string GetCacheFilename();
 static void LoadCache();
-static bool LoadEntriesFromCache(ByteStream* stream);
-static bool OpenCacheForWriting();
-static bool WriteEntryToCache(const Entry* entry);
-static void CloseCacheFileStream();
+static bool LoadEntriesFromCache();
+static void SaveCache();
+static void CloseCache();
 static void DeleteCacheFile();
+
+static std::string GetDirectoryCacheFilename();
+static void LoadDirectoryCache();
+static void SaveDirectoryCache();
+static void DeleteDirectoryCacheFile();
 } // namespace GameList
 
 static std::vector<GameList::Entry> m_entries;
 static std::recursive_mutex s_mutex;
+
+// case-insensitive lookups into m_entries, the serial index holds the first entry with each serial
+static std::unordered_map<std::string, u32> m_entry_path_index;
+static std::unordered_map<std::string, u32> m_entry_serial_index;
+
+// the previous refresh's cache, mapped while refreshing
+static std::FILE* m_cache_file = nullptr;
+static const u8* m_cache_mapping = nullptr;
+static size_t m_cache_mapping_size = 0;
+static const u8* m_cache_records = nullptr;
+static const char* m_cache_strings = nullptr;
+static u32 m_cache_strings_size = 0;
 static GameList::CacheMap m_cache_map;
-static std::unique_ptr<ByteStream> m_cache_write_stream;
+static bool m_cache_dirty = false;
+
+// directories as of the last refresh, and as they're found during a refresh
+static GameList::DirectoryCacheMap m_directory_cache;
+static GameList::DirectoryCacheMap m_new_directory_cache;
+static std::vector<std::string> m_scanned_directories;
 
 static bool m_game_list_loaded = false;
 
@@ -247,165 +348,239 @@ bool GameList::PopulateEntryFromPath(const std::string& path, Entry* entry)
   return GetDiscListEntry(path, entry);
 }
 
+std::string_view GameList::GetCacheString(const CacheString& str)
+{
+  // references are checked against the size of the string table by ReadCacheRecord()
+  return std::string_view(m_cache_strings + str.offset, str.length);
+}
+
+bool GameList::ReadCacheRecord(u32 index, CacheRecord* record)
+{
+  std::memcpy(record, m_cache_records + index * sizeof(CacheRecord), sizeof(CacheRecord));
+
+  for (const CacheString* str : {&record->path, &record->serial, &record->title, &record->genre, &record->publisher,
+                                 &record->developer})
+  {
+    if (str->offset > m_cache_strings_size || str->length > (m_cache_strings_size - str->offset))
+      return false;
+  }
+
+  return (record->type < static_cast<u8>(EntryType::Count) && record->region < static_cast<u8>(DiscRegion::Count) &&
+          record->compatibility < static_cast<u8>(GameDatabase::CompatibilityRating::Count));
+}
+
 bool GameList::GetGameListEntryFromCache(const std::string& path, Entry* entry)
 {
   auto iter = m_cache_map.find(path);
   if (iter == m_cache_map.end())
     return false;
 
-  *entry = std::move(iter->second);
+  // the records are only decoded when they're used, most of a large cache is never copied out of the mapping
+  CacheRecord record;
+  const bool result = ReadCacheRecord(iter->second, &record);
   m_cache_map.erase(iter);
+  if (!result)
+    return false;
+
+  PopulateEntryFromCacheRecord(record, entry);
   return true;
 }
 
-bool GameList::LoadEntriesFromCache(ByteStream* stream)
+void GameList::PopulateEntryFromCacheRecord(const CacheRecord& record, Entry* entry)
+{
+  entry->type = static_cast<EntryType>(record.type);
+  entry->region = static_cast<DiscRegion>(record.region);
+  entry->path = GetCacheString(record.path);
+  entry->serial = GetCacheString(record.serial);
+  entry->title = GetCacheString(record.title);
+  entry->genre = GetCacheString(record.genre);
+  entry->publisher = GetCacheString(record.publisher);
+  entry->developer = GetCacheString(record.developer);
+  entry->total_size = record.total_size;
+  entry->last_modified_time = static_cast<std::time_t>(record.last_modified_time);
+  entry->release_date = record.release_date;
+  entry->supported_controllers = record.supported_controllers;
+  entry->min_players = record.min_players;
+  entry->max_players = record.max_players;
+  entry->min_blocks = record.min_blocks;
+  entry->max_blocks = record.max_blocks;
+  entry->compatibility = static_cast<GameDatabase::CompatibilityRating>(record.compatibility);
+}
+
+bool GameList::LoadEntriesFromCache()
 {
-  u32 file_signature, file_version;
-  if (!stream->ReadU32(&file_signature) || !stream->ReadU32(&file_version) ||
-      file_signature != GAME_LIST_CACHE_SIGNATURE || file_version != GAME_LIST_CACHE_VERSION)
+  CacheHeader header;
+  if (m_cache_mapping_size < sizeof(header))
+    return false;
+
+  std::memcpy(&header, m_cache_mapping, sizeof(header));
+  if (header.signature != GAME_LIST_CACHE_SIGNATURE || header.version != GAME_LIST_CACHE_VERSION ||
+      (sizeof(CacheHeader) + static_cast<u64>(header.record_count) * sizeof(CacheRecord) +
+       header.string_table_size) != m_cache_mapping_size)
   {
-    Log_WarningPrintf("Game list cache is corrupted");
     return false;
   }
 
-  while (stream->GetPosition() != stream->GetSize())
+  m_cache_records = m_cache_mapping + sizeof(CacheHeader);
+  m_cache_strings = reinterpret_cast<const char*>(m_cache_records + header.record_count * sizeof(CacheRecord));
+  m_cache_strings_size = header.string_table_size;
+
+  // only the paths are looked at here, the map's keys point into the string table
+  m_cache_map.reserve(header.record_count);
+  for (u32 i = 0; i < header.record_count; i++)
   {
-    std::string path;
-    Entry ge;
-
-    u8 type;
-    u8 region;
-    u8 compatibility_rating;
-
-    if (!stream->ReadU8(&type) || !stream->ReadU8(&region) || !stream->ReadSizePrefixedString(&path) ||
-        !stream->ReadSizePrefixedString(&ge.serial) || !stream->ReadSizePrefixedString(&ge.title) ||
-        !stream->ReadSizePrefixedString(&ge.genre) || !stream->ReadSizePrefixedString(&ge.publisher) ||
-        !stream->ReadSizePrefixedString(&ge.developer) || !stream->ReadU64(&ge.total_size) ||
-        !stream->ReadU64(reinterpret_cast<u64*>(&ge.last_modified_time)) || !stream->ReadU64(&ge.release_date) ||
-        !stream->ReadU32(&ge.supported_controllers) || !stream->ReadU8(&ge.min_players) ||
-        !stream->ReadU8(&ge.max_players) || !stream->ReadU8(&ge.min_blocks) || !stream->ReadU8(&ge.max_blocks) ||
-        !stream->ReadU8(&compatibility_rating) || region >= static_cast<u8>(DiscRegion::Count) ||
-        type >= static_cast<u8>(EntryType::Count) ||
-        compatibility_rating >= static_cast<u8>(GameDatabase::CompatibilityRating::Count))
-    {
-      Log_WarningPrintf("Game list cache entry is corrupted");
+    CacheRecord record;
+    if (!ReadCacheRecord(i, &record))
       return false;
-    }
-
-    ge.path = path;
-    ge.region = static_cast<DiscRegion>(region);
-    ge.type = static_cast<EntryType>(type);
-    ge.compatibility = static_cast<GameDatabase::CompatibilityRating>(compatibility_rating);
 
-    auto iter = m_cache_map.find(ge.path);
-    if (iter != m_cache_map.end())
-      iter->second = std::move(ge);
-    else
-      m_cache_map.emplace(std::move(path), std::move(ge));
+    m_cache_map.emplace(GetCacheString(record.path), i);
   }
 
   return true;
 }
 
-bool GameList::WriteEntryToCache(const Entry* entry)
-{
-  bool result = true;
-  result &= m_cache_write_stream->WriteU8(static_cast<u8>(entry->type));
-  result &= m_cache_write_stream->WriteU8(static_cast<u8>(entry->region));
-  result &= m_cache_write_stream->WriteSizePrefixedString(entry->path);
-  result &= m_cache_write_stream->WriteSizePrefixedString(entry->serial);
-  result &= m_cache_write_stream->WriteSizePrefixedString(entry->title);
-  result &= m_cache_write_stream->WriteSizePrefixedString(entry->genre);
-  result &= m_cache_write_stream->WriteSizePrefixedString(entry->publisher);
-  result &= m_cache_write_stream->WriteSizePrefixedString(entry->developer);
-  result &= m_cache_write_stream->WriteU64(entry->total_size);
-  result &= m_cache_write_stream->WriteU64(entry->last_modified_time);
-  result &= m_cache_write_stream->WriteU64(entry->release_date);
-  result &= m_cache_write_stream->WriteU32(entry->supported_controllers);
-  result &= m_cache_write_stream->WriteU8(entry->min_players);
-  result &= m_cache_write_stream->WriteU8(entry->max_players);
-  result &= m_cache_write_stream->WriteU8(entry->min_blocks);
-  result &= m_cache_write_stream->WriteU8(entry->max_blocks);
-  result &= m_cache_write_stream->WriteU8(static_cast<u8>(entry->compatibility));
-  return result;
-}
-
-static std::string GameList::GetCacheFilename()
+std::string GameList::GetCacheFilename()
 {
   return Path::Combine(EmuFolders::Cache, "gamelist.cache");
 }
 
 void GameList::LoadCache()
 {
-  std::string filename(GetCacheFilename());
-  std::unique_ptr<ByteStream> stream =
-    ByteStream::OpenFile(filename.c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
-  if (!stream)
+  const std::string filename(GetCacheFilename());
+  m_cache_file = FileSystem::OpenCFile(filename.c_str(), "rb");
+  if (!m_cache_file)
     return;
 
-  if (!LoadEntriesFromCache(stream.get()))
+  const s64 size = FileSystem::FSize64(m_cache_file);
+  if (size > 0)
+  {
+    m_cache_mapping = static_cast<const u8*>(FileSystem::MapCFile(m_cache_file, static_cast<size_t>(size)));
+    m_cache_mapping_size = m_cache_mapping ? static_cast<size_t>(size) : 0;
+  }
+
+  if (!m_cache_mapping || !LoadEntriesFromCache())
   {
     Log_WarningPrintf("Deleting corrupted cache file '%s'", filename.c_str());
-    stream.reset();
-    m_cache_map.clear();
+    CloseCache();
     DeleteCacheFile();
-    return;
   }
 }
 
-bool GameList::OpenCacheForWriting()
+void GameList::SaveCache()
 {
-  const std::string cache_filename(GetCacheFilename());
-  Assert(!m_cache_write_stream);
+  std::vector<CacheRecord> records;
+  std::string strings;
+
+  // genres, publishers and developers repeat a lot, so each distinct string is only stored once
+  std::unordered_map<std::string_view, CacheString> string_offsets;
+  const auto add_string = [&strings, &string_offsets](const std::string_view& str) {
+    auto iter = string_offsets.find(str);
+    if (iter != string_offsets.end())
+      return iter->second;
+
+    const CacheString ref = {static_cast<u32>(strings.size()), static_cast<u32>(str.length())};
+    strings.append(str);
+    string_offsets.emplace(str, ref);
+    return ref;
+  };
+  const auto add_record = [&records, &add_string](const Entry& entry) {
+    CacheRecord& record = records.emplace_back();
+    record.path = add_string(entry.path);
+    record.serial = add_string(entry.serial);
+    record.title = add_string(entry.title);
+    record.genre = add_string(entry.genre);
+    record.publisher = add_string(entry.publisher);
+    record.developer = add_string(entry.developer);
+    record.total_size = entry.total_size;
+    record.last_modified_time = static_cast<u64>(entry.last_modified_time);
+    record.release_date = entry.release_date;
+    record.supported_controllers = entry.supported_controllers;
+    record.type = static_cast<u8>(entry.type);
+    record.region = static_cast<u8>(entry.region);
+    record.min_players = entry.min_players;
+    record.max_players = entry.max_players;
+    record.min_blocks = entry.min_blocks;
+    record.max_blocks = entry.max_blocks;
+    record.compatibility = static_cast<u8>(entry.compatibility);
+  };
 
-  m_cache_write_stream = ByteStream::OpenFile(cache_filename.c_str(),
-                                              BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_SEEKABLE);
-  if (m_cache_write_stream)
   {
-    // check the header
-    u32 signature, version;
-    if (m_cache_write_stream->ReadU32(&signature) && signature == GAME_LIST_CACHE_SIGNATURE &&
-        m_cache_write_stream->ReadU32(&version) && version == GAME_LIST_CACHE_VERSION &&
-        m_cache_write_stream->SeekToEnd())
+    std::unique_lock lock(s_mutex);
+    records.reserve(m_entries.size() + m_cache_map.size());
+    for (const Entry& entry : m_entries)
+      add_record(entry);
+
+    // keep entries which weren't used this time, e.g. from a directory which has been removed or is offline
+    for (const auto& [path, index] : m_cache_map)
     {
-      return true;
-    }
+      CacheRecord old_record;
+      if (m_entry_path_index.find(GetIndexKey(path)) != m_entry_path_index.end() ||
+          !ReadCacheRecord(index, &old_record))
+      {
+        continue;
+      }
 
-    m_cache_write_stream.reset();
+      CacheRecord& record = records.emplace_back(old_record);
+      for (CacheString* str : {&record.path, &record.serial, &record.title, &record.genre, &record.publisher,
+                               &record.developer})
+      {
+        *str = add_string(GetCacheString(*str));
+      }
+    }
   }
 
-  Log_InfoPrintf("Creating new game list cache file: '%s'", cache_filename.c_str());
+  const CacheHeader header = {GAME_LIST_CACHE_SIGNATURE, GAME_LIST_CACHE_VERSION, static_cast<u32>(records.size()),
+                              static_cast<u32>(strings.size())};
 
-  m_cache_write_stream = ByteStream::OpenFile(
-    cache_filename.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_TRUNCATE | BYTESTREAM_OPEN_WRITE);
-  if (!m_cache_write_stream)
-    return false;
+  // the strings have all been copied, and the file can't be replaced while it's mapped on Windows
+  CloseCache();
 
-  // new cache file, write header
-  if (!m_cache_write_stream->WriteU32(GAME_LIST_CACHE_SIGNATURE) ||
-      !m_cache_write_stream->WriteU32(GAME_LIST_CACHE_VERSION))
+  const std::string filename(GetCacheFilename());
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(filename.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
+                                             BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
   {
-    Log_ErrorPrintf("Failed to write game list cache header");
-    m_cache_write_stream.reset();
-    FileSystem::DeleteFile(cache_filename.c_str());
-    return false;
+    Log_ErrorPrintf("Failed to open game list cache '%s' for writing", filename.c_str());
+    return;
   }
 
-  return true;
+  if (!stream->Write2(&header, sizeof(header)) ||
+      (!records.empty() && !stream->Write2(records.data(), static_cast<u32>(records.size() * sizeof(CacheRecord)))) ||
+      (!strings.empty() && !stream->Write2(strings.data(), static_cast<u32>(strings.size()))))
+  {
+    Log_ErrorPrintf("Failed to write game list cache '%s'", filename.c_str());
+    stream->Discard();
+    return;
+  }
+
+  stream->Commit();
 }
 
-void GameList::CloseCacheFileStream()
+void GameList::CloseCache()
 {
-  if (!m_cache_write_stream)
-    return;
+  m_cache_map.clear();
+  m_cache_records = nullptr;
+  m_cache_strings = nullptr;
+  m_cache_strings_size = 0;
 
-  m_cache_write_stream->Commit();
-  m_cache_write_stream.reset();
+  if (m_cache_mapping)
+  {
+    FileSystem::UnmapCFile(m_cache_mapping, m_cache_mapping_size);
+    m_cache_mapping = nullptr;
+    m_cache_mapping_size = 0;
+  }
+
+  if (m_cache_file)
+  {
+    std::fclose(m_cache_file);
+    m_cache_file = nullptr;
+  }
 }
 
 void GameList::DeleteCacheFile()
 {
-  Assert(!m_cache_write_stream);
+  Assert(!m_cache_file);
 
   const std::string filename(GetCacheFilename());
   if (!FileSystem::FileExists(filename.c_str()))
@@ -417,23 +592,136 @@ void GameList::DeleteCacheFile()
     Log_WarningPrintf("Failed to delete game list cache '%s'", filename.c_str());
 }
 
+std::string GameList::GetDirectoryCacheFilename()
+{
+  return Path::Combine(EmuFolders::Cache, "gamelist_directories.cache");
+}
+
+void GameList::LoadDirectoryCache()
+{
+  const std::string filename(GetDirectoryCacheFilename());
+  std::unique_ptr<ByteStream> stream = ByteStream::OpenMappedFile(filename.c_str());
+  if (!stream)
+    return;
+
+  u32 signature, version;
+  if (!stream->ReadU32(&signature) || !stream->ReadU32(&version) || signature != DIRECTORY_CACHE_SIGNATURE ||
+      version != DIRECTORY_CACHE_VERSION)
+  {
+    Log_WarningPrintf("Directory cache is corrupted or out of date, ignoring.");
+    return;
+  }
+
+  while (stream->GetPosition() != stream->GetSize())
+  {
+    std::string path;
+    DirectoryCacheEntry contents;
+    u64 modified_time;
+    u32 file_count, subdirectory_count;
+    if (!stream->ReadSizePrefixedString(&path) || !stream->ReadU64(&modified_time) || !stream->ReadU32(&file_count))
+    {
+      Log_WarningPrintf("Directory cache is corrupted, ignoring.");
+      m_directory_cache.clear();
+      return;
+    }
+
+    contents.modified_time = static_cast<std::time_t>(modified_time);
+    contents.files.resize(file_count);
+    for (auto& [file_path, file_modified_time] : contents.files)
+    {
+      if (!stream->ReadSizePrefixedString(&file_path) || !stream->ReadU64(&modified_time))
+      {
+        Log_WarningPrintf("Directory cache is corrupted, ignoring.");
+        m_directory_cache.clear();
+        return;
+      }
+
+      file_modified_time = static_cast<std::time_t>(modified_time);
+    }
+
+    if (!stream->ReadU32(&subdirectory_count))
+    {
+      Log_WarningPrintf("Directory cache is corrupted, ignoring.");
+      m_directory_cache.clear();
+      return;
+    }
+
+    contents.subdirectories.resize(subdirectory_count);
+    for (std::string& subdirectory : contents.subdirectories)
+    {
+      if (!stream->ReadSizePrefixedString(&subdirectory))
+      {
+        Log_WarningPrintf("Directory cache is corrupted, ignoring.");
+        m_directory_cache.clear();
+        return;
+      }
+    }
+
+    m_directory_cache.insert_or_assign(std::move(path), std::move(contents));
+  }
+}
+
+void GameList::SaveDirectoryCache()
+{
+  const std::string filename(GetDirectoryCacheFilename());
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(filename.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
+                                             BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
+  {
+    Log_ErrorPrintf("Failed to open directory cache '%s' for writing", filename.c_str());
+    return;
+  }
+
+  bool result = stream->WriteU32(DIRECTORY_CACHE_SIGNATURE);
+  result &= stream->WriteU32(DIRECTORY_CACHE_VERSION);
+  for (const auto& [path, contents] : m_new_directory_cache)
+  {
+    result &= stream->WriteSizePrefixedString(path);
+    result &= stream->WriteU64(static_cast<u64>(contents.modified_time));
+    result &= stream->WriteU32(static_cast<u32>(contents.files.size()));
+    for (const auto& [file_path, file_modified_time] : contents.files)
+    {
+      result &= stream->WriteSizePrefixedString(file_path);
+      result &= stream->WriteU64(static_cast<u64>(file_modified_time));
+    }
+    result &= stream->WriteU32(static_cast<u32>(contents.subdirectories.size()));
+    for (const std::string& subdirectory : contents.subdirectories)
+      result &= stream->WriteSizePrefixedString(subdirectory);
+  }
+
+  if (!result)
+  {
+    Log_ErrorPrintf("Failed to write directory cache '%s'", filename.c_str());
+    stream->Discard();
+    return;
+  }
+
+  stream->Commit();
+}
+
+void GameList::DeleteDirectoryCacheFile()
+{
+  const std::string filename(GetDirectoryCacheFilename());
+  if (FileSystem::FileExists(filename.c_str()) && !FileSystem::DeleteFile(filename.c_str()))
+    Log_WarningPrintf("Failed to delete directory cache '%s'", filename.c_str());
+}
+
 static bool IsPathExcluded(const std::vector<std::string>& excluded_paths, const std::string& path)
 {
   return (std::find(excluded_paths.begin(), excluded_paths.end(), path) != excluded_paths.end());
 }
 
 void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
-                             const std::vector<std::string>& excluded_paths, ProgressCallback* progress)
+                             const std::vector<std::string>& excluded_paths, DirectoryVisitMap* visited,
+                             ProgressCallback* progress)
 {
   Log_InfoPrintf("Scanning %s%s", path, recursive ? " (recursively)" : "");
 
   progress->SetFormattedStatusText("Scanning directory '%s'%s...", path, recursive ? " (recursively)" : "");
 
   FileSystem::FindResultsArray files;
-  FileSystem::FindFiles(path, "*",
-                        recursive ? (FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_HIDDEN_FILES | FILESYSTEM_FIND_RECURSIVE) :
-                                    (FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_HIDDEN_FILES),
-                        &files);
+  FindFilesInDirectory(path, recursive, visited, &files);
   if (files.empty())
     return;
 
@@ -441,14 +729,15 @@ void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
   progress->SetProgressRange(static_cast<u32>(files.size()));
   progress->SetProgressValue(0);
 
+  // files which are up to date in the cache are added straight away, the rest are opened on the pool
+  std::vector<FILESYSTEM_FIND_DATA*> files_to_scan;
   u32 files_scanned = 0;
   for (FILESYSTEM_FIND_DATA& ffd : files)
   {
-    files_scanned++;
-
     if (progress->IsCancelled() || !GameList::IsScannableFilename(ffd.FileName) ||
         IsPathExcluded(excluded_paths, ffd.FileName))
     {
+      files_scanned++;
       continue;
     }
 
@@ -456,23 +745,136 @@ void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
       std::unique_lock lock(s_mutex);
       if (GetEntryForPath(ffd.FileName.c_str()) || AddFileFromCache(ffd.FileName, ffd.ModificationTime) || only_cache)
       {
+        files_scanned++;
         continue;
       }
     }
 
-    // ownership of fp is transferred
-    progress->SetFormattedStatusText("Scanning '%s'...", FileSystem::GetDisplayNameFromPath(ffd.FileName).c_str());
-    ScanFile(std::move(ffd.FileName), ffd.ModificationTime);
-    progress->SetProgressValue(files_scanned);
+    files_to_scan.push_back(&ffd);
   }
 
   progress->SetProgressValue(files_scanned);
+  if (!files_to_scan.empty() && !progress->IsCancelled())
+  {
+    // the database is shared by all of the workers, so don't have the first ones race to load it
+    GameDatabase::EnsureLoaded();
+
+    std::atomic_bool cancelled{false};
+    std::vector<std::future<std::optional<Entry>>> results;
+    results.reserve(files_to_scan.size());
+    {
+      const u32 num_threads = std::clamp(std::thread::hardware_concurrency(), 1u, static_cast<u32>(MAX_SCAN_THREADS));
+      cb::ThreadPool pool(static_cast<int>(std::min(num_threads, static_cast<u32>(files_to_scan.size()))));
+      for (FILESYSTEM_FIND_DATA* ffd : files_to_scan)
+      {
+        results.push_back(pool.ScheduleAndGetFuture([&cancelled, ffd]() -> std::optional<Entry> {
+          if (cancelled.load(std::memory_order_relaxed))
+            return std::nullopt;
+
+          return ScanFile(ffd->FileName, ffd->ModificationTime);
+        }));
+      }
+
+      // merged in directory order on this thread, which is also the only one to touch the progress callback and
+      // cache file. destroying the pool waits for any scans still running after a cancel.
+      for (size_t i = 0; i < results.size(); i++)
+      {
+        if (progress->IsCancelled())
+        {
+          cancelled.store(true, std::memory_order_relaxed);
+          break;
+        }
+
+        progress->SetFormattedStatusText("Scanning '%s'...",
+                                         FileSystem::GetDisplayNameFromPath(files_to_scan[i]->FileName).c_str());
+
+        std::optional<Entry> entry(results[i].get());
+        if (entry.has_value())
+          AddScannedEntry(std::move(entry.value()));
+
+        progress->SetProgressValue(++files_scanned);
+      }
+    }
+  }
+
+  progress->SetProgressValue(static_cast<u32>(files.size()));
   progress->PopState();
 }
 
+void GameList::FindFilesInDirectory(const std::string& path, bool recursive, DirectoryVisitMap* visited,
+                                    FileSystem::FindResultsArray* files)
+{
+  // directories can be reached more than once through overlapping search paths, and links
+  const auto [visit, first_visit] = visited->emplace(path, recursive);
+  if (!first_visit)
+  {
+    if (visit->second || !recursive)
+      return;
+
+    visit->second = true;
+  }
+
+  const DirectoryCacheEntry* contents = GetDirectoryContents(path);
+  if (!contents)
+    return;
+
+  if (first_visit)
+  {
+    for (const auto& [filename, modified_time] : contents->files)
+    {
+      FILESYSTEM_FIND_DATA& ffd = files->emplace_back();
+      ffd.FileName = filename;
+      ffd.ModificationTime = modified_time;
+    }
+  }
+
+  if (recursive)
+  {
+    for (const std::string& subdirectory : contents->subdirectories)
+      FindFilesInDirectory(subdirectory, true, visited, files);
+  }
+}
+
+const GameList::DirectoryCacheEntry* GameList::GetDirectoryContents(const std::string& path)
+{
+  const auto new_iter = m_new_directory_cache.find(path);
+  if (new_iter != m_new_directory_cache.end())
+    return &new_iter->second;
+
+  FILESYSTEM_STAT_DATA sd;
+  if (!FileSystem::StatFile(path.c_str(), &sd) || !(sd.Attributes & FILESYSTEM_FILE_ATTRIBUTE_DIRECTORY))
+    return nullptr;
+
+  DirectoryCacheEntry contents;
+  const auto iter = m_directory_cache.find(path);
+  if (iter != m_directory_cache.end() && iter->second.modified_time == sd.ModificationTime)
+  {
+    contents = std::move(iter->second);
+  }
+  else
+  {
+    Log_DevPrintf("Listing directory '%s'", path.c_str());
+
+    FileSystem::FindResultsArray results;
+    FileSystem::FindFiles(path.c_str(), "*",
+                          FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_FOLDERS | FILESYSTEM_FIND_HIDDEN_FILES, &results);
+
+    contents.modified_time = sd.ModificationTime;
+    for (FILESYSTEM_FIND_DATA& ffd : results)
+    {
+      if (ffd.Attributes & FILESYSTEM_FILE_ATTRIBUTE_DIRECTORY)
+        contents.subdirectories.push_back(std::move(ffd.FileName));
+      else if (IsScannableFilename(ffd.FileName))
+        contents.files.emplace_back(std::move(ffd.FileName), ffd.ModificationTime);
+    }
+  }
+
+  return &m_new_directory_cache.emplace(path, std::move(contents)).first->second;
+}
+
 bool GameList::AddFileFromCache(const std::string& path, std::time_t timestamp)
 {
-  if (std::any_of(m_entries.begin(), m_entries.end(), [&path](const Entry& other) { return other.path == path; }))
+  if (GetEntryForPath(path.c_str()))
   {
     // already exists
     return true;
@@ -482,30 +884,47 @@ bool GameList::AddFileFromCache(const std::string& path, std::time_t timestamp)
   if (!GetGameListEntryFromCache(path, &entry) || entry.last_modified_time != timestamp)
     return false;
 
-  m_entries.push_back(std::move(entry));
+  AddEntry(std::move(entry));
   return true;
 }
 
-bool GameList::ScanFile(std::string path, std::time_t timestamp)
+std::optional<GameList::Entry> GameList::ScanFile(std::string path, std::time_t timestamp)
 {
   Log_DevPrintf("Scanning '%s'...", path.c_str());
 
   Entry entry;
   if (!PopulateEntryFromPath(path, &entry))
-    return false;
+    return std::nullopt;
 
   entry.path = std::move(path);
   entry.last_modified_time = timestamp;
+  return entry;
+}
 
-  if (m_cache_write_stream || OpenCacheForWriting())
-  {
-    if (!WriteEntryToCache(&entry))
-      Log_WarningPrintf("Failed to write entry '%s' to cache", entry.path.c_str());
-  }
+void GameList::AddScannedEntry(Entry entry)
+{
+  m_cache_dirty = true;
 
   std::unique_lock lock(s_mutex);
+  if (!GetEntryForPath(entry.path.c_str()))
+    AddEntry(std::move(entry));
+}
+
+std::string GameList::GetIndexKey(const std::string_view& str)
+{
+  std::string key(str);
+  std::transform(key.begin(), key.end(), key.begin(),
+                 [](char ch) { return static_cast<char>(std::tolower(static_cast<unsigned char>(ch))); });
+  return key;
+}
+
+void GameList::AddEntry(Entry entry)
+{
+  const u32 index = static_cast<u32>(m_entries.size());
+  m_entry_path_index.emplace(GetIndexKey(entry.path), index);
+  m_entry_serial_index.emplace(GetIndexKey(entry.serial), index);
+
   m_entries.push_back(std::move(entry));
-  return true;
 }
 
 std::unique_lock<std::recursive_mutex> GameList::GetLock()
@@ -520,28 +939,20 @@ const GameList::Entry* GameList::GetEntryByIndex(u32 index)
 
 const GameList::Entry* GameList::GetEntryForPath(const char* path)
 {
-  const size_t path_length = std::strlen(path);
-  for (const Entry& entry : m_entries)
-  {
-    if (entry.path.size() == path_length && StringUtil::Strcasecmp(entry.path.c_str(), path) == 0)
-      return &entry;
-  }
+  const auto iter = m_entry_path_index.find(GetIndexKey(path));
+  return (iter != m_entry_path_index.end()) ? &m_entries[iter->second] : nullptr;
+}
 
-  return nullptr;
+std::optional<u32> GameList::GetEntryIndexForPath(const char* path)
+{
+  const auto iter = m_entry_path_index.find(GetIndexKey(path));
+  return (iter != m_entry_path_index.end()) ? std::optional<u32>(iter->second) : std::nullopt;
 }
 
 const GameList::Entry* GameList::GetEntryBySerial(const std::string_view& serial)
 {
-  for (const Entry& entry : m_entries)
-  {
-    if (entry.serial.length() == serial.length() &&
-        StringUtil::Strncasecmp(entry.serial.c_str(), serial.data(), serial.length()) == 0)
-    {
-      return &entry;
-    }
-  }
-
-  return nullptr;
+  const auto iter = m_entry_serial_index.find(GetIndexKey(serial));
+  return (iter != m_entry_serial_index.end()) ? &m_entries[iter->second] : nullptr;
 }
 
 u32 GameList::GetEntryCount()
@@ -557,15 +968,24 @@ void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback*
     progress = ProgressCallback::NullProgressCallback;
 
   if (invalidate_cache)
+  {
     DeleteCacheFile();
+    DeleteDirectoryCacheFile();
+  }
   else
+  {
     LoadCache();
+    LoadDirectoryCache();
+  }
+  m_cache_dirty = (m_cache_mapping == nullptr);
 
   // don't delete the old entries, since the frontend might still access them
   std::vector<Entry> old_entries;
   {
     std::unique_lock lock(s_mutex);
     old_entries.swap(m_entries);
+    m_entry_path_index.clear();
+    m_entry_serial_index.clear();
   }
 
   const std::vector<std::string> excluded_paths(Host::GetStringListSetting("GameList", "ExcludedPaths"));
@@ -578,13 +998,14 @@ void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback*
     progress->SetProgressValue(0);
 
     // we manually count it here, because otherwise pop state updates it itself
+    DirectoryVisitMap visited;
     int directory_counter = 0;
     for (const std::string& dir : dirs)
     {
       if (progress->IsCancelled())
         break;
 
-      ScanDirectory(dir.c_str(), false, only_cache, excluded_paths, progress);
+      ScanDirectory(dir.c_str(), false, only_cache, excluded_paths, &visited, progress);
       progress->SetProgressValue(++directory_counter);
     }
     for (const std::string& dir : recursive_dirs)
@@ -592,14 +1013,35 @@ void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback*
       if (progress->IsCancelled())
         break;
 
-      ScanDirectory(dir.c_str(), true, only_cache, excluded_paths, progress);
+      ScanDirectory(dir.c_str(), true, only_cache, excluded_paths, &visited, progress);
       progress->SetProgressValue(++directory_counter);
     }
   }
 
-  // don't need unused cache entries
-  CloseCacheFileStream();
-  m_cache_map.clear();
+  // a cancelled refresh won't have seen every directory, so keep the old contents for next time
+  if (!progress->IsCancelled())
+  {
+    SaveDirectoryCache();
+
+    std::unique_lock lock(s_mutex);
+    m_scanned_directories.clear();
+    m_scanned_directories.reserve(m_new_directory_cache.size());
+    for (const auto& it : m_new_directory_cache)
+      m_scanned_directories.push_back(it.first);
+  }
+
+  // the cache is only rewritten when something was scanned, unused entries are carried over when it is
+  if (m_cache_dirty)
+    SaveCache();
+  CloseCache();
+  m_directory_cache.clear();
+  m_new_directory_cache.clear();
+}
+
+std::vector<std::string> GameList::GetScannedDirectories()
+{
+  std::unique_lock lock(s_mutex);
+  return m_scanned_directories;
 }
 
 std::string GameList::GetCoverImagePathForEntry(const Entry* entry)
@@ -714,7 +1156,8 @@ bool GameList::DownloadCovers(const std::vector<std::string>& url_templates, boo
     return false;
   }
 
-  std::vector<std::pair<std::string, std::string>> download_urls;
+  // each entry's URLs are tried in order, until one of them succeeds
+  std::vector<std::pair<std::string, std::vector<std::string>>> downloads;
   {
     std::unique_lock lock(s_mutex);
     for (const GameList::Entry& entry : m_entries)
@@ -723,6 +1166,7 @@ bool GameList::DownloadCovers(const std::vector<std::string>& url_templates, boo
       if (!existing_path.empty())
         continue;
 
+      std::vector<std::string> urls;
       for (const std::string& url_template : url_templates)
       {
         std::string url(url_template);
@@ -737,11 +1181,13 @@ bool GameList::DownloadCovers(const std::vector<std::string>& url_templates, boo
         if (has_serial)
           StringUtil::ReplaceAll(&url, "${serial}", Common::HTTPDownloader::URLEncode(entry.serial));
 
-        download_urls.emplace_back(entry.path, std::move(url));
+        urls.push_back(std::move(url));
       }
+
+      downloads.emplace_back(entry.path, std::move(urls));
     }
   }
-  if (download_urls.empty())
+  if (downloads.empty())
   {
     progress->DisplayError("No URLs to download enumerated.");
     return false;
@@ -755,64 +1201,109 @@ bool GameList::DownloadCovers(const std::vector<std::string>& url_templates, boo
   }
 
   progress->SetCancellable(true);
-  progress->SetProgressRange(static_cast<u32>(download_urls.size()));
-
-  for (auto& [entry_path, url] : download_urls)
-  {
-    if (progress->IsCancelled())
-      break;
-
-    // make sure it didn't get done already
+  progress->SetProgressRange(static_cast<u32>(downloads.size()));
+
+  // Covers are downloaded in parallel, over as few connections as the downloader can manage. Entries are only started
+  // as others finish rather than all being queued up front, so cancelling doesn't have to wait for the rest. The
+  // callbacks all run on this thread, from WaitForAllRequests().
+  size_t next_download = 0;
+  std::function<void(size_t, size_t)> start_download;
+  const auto start_next_download = [&]() {
+    while (next_download < downloads.size() && !progress->IsCancelled())
     {
-      std::unique_lock lock(s_mutex);
-      const GameList::Entry* entry = GetEntryForPath(entry_path.c_str());
-      if (!entry || !GetCoverImagePathForEntry(entry).empty())
+      const size_t index = next_download++;
+
+      // make sure it didn't get done already
       {
-        progress->IncrementProgressValue();
-        continue;
+        std::unique_lock lock(s_mutex);
+        const GameList::Entry* entry = GetEntryForPath(downloads[index].first.c_str());
+        if (!entry || !GetCoverImagePathForEntry(entry).empty())
+        {
+          progress->IncrementProgressValue();
+          continue;
+        }
+
+        progress->SetFormattedStatusText("Downloading cover for %s...", entry->title.c_str());
       }
 
-      progress->SetFormattedStatusText("Downloading cover for %s...", entry->title.c_str());
+      start_download(index, 0);
+      return;
     }
+  };
 
-    // we could actually do a few in parallel here...
+  start_download = [&](size_t index, size_t url_index) {
+    const std::string& url = downloads[index].second[url_index];
     std::string filename(Common::HTTPDownloader::URLDecode(url));
-    downloader->CreateRequest(
-      std::move(url), [use_serial, &save_callback, entry_path = std::move(entry_path),
-                       filename = std::move(filename)](s32 status_code, std::string content_type, Common::HTTPDownloader::Request::Data data) {
-        if (status_code != Common::HTTPDownloader::HTTP_OK || data.empty())
-          return;
 
-        std::unique_lock lock(s_mutex);
-        const GameList::Entry* entry = GetEntryForPath(entry_path.c_str());
-        if (!entry || !GetCoverImagePathForEntry(entry).empty())
-          return;
+    // covers go straight to disk, and the extension isn't known until the response arrives, so they're renamed
+    // afterwards. the name comes from the url so an interrupted download is only resumed from the same source.
+    std::string download_path(
+      Path::Combine(EmuFolders::Covers, fmt::format("download_{:016x}.tmp", std::hash<std::string>()(url))));
+    downloader->CreateFileRequest(
+      url, download_path,
+      [&, index, url_index, filename = std::move(filename), download_path](s32 status_code, std::string content_type,
+                                                                           Common::HTTPDownloader::Request::Data data) {
+      const bool downloaded = (status_code == Common::HTTPDownloader::HTTP_OK &&
+                               FileSystem::GetPathFileSize(download_path.c_str()) > 0);
+      if (!downloaded)
+      {
+        if (status_code == Common::HTTPDownloader::HTTP_OK)
+          FileSystem::DeleteFile(download_path.c_str());
 
-        // prefer the content type from the response for the extension
-        // otherwise, if it's missing, and the request didn't have an extension.. fall back to jpegs.
-        std::string template_filename;
-        std::string content_type_extension(Common::HTTPDownloader::GetExtensionForContentType(content_type));
-
-        // don't treat the domain name as an extension..
-        const std::string::size_type last_slash = filename.find('/');
-        const std::string::size_type last_dot = filename.find('.');
-        if (!content_type_extension.empty())
-          template_filename = fmt::format("cover.{}", content_type_extension);
-        else if (last_slash != std::string::npos && last_dot != std::string::npos && last_dot > last_slash)
-          template_filename = Path::GetFileName(filename);
+        if ((url_index + 1) < downloads[index].second.size() && !progress->IsCancelled())
+        {
+          start_download(index, url_index + 1);
+          return;
+        }
+      }
+      else
+      {
+        std::unique_lock lock(s_mutex);
+        const GameList::Entry* entry = GetEntryForPath(downloads[index].first.c_str());
+        if (entry && GetCoverImagePathForEntry(entry).empty())
+        {
+          // prefer the content type from the response for the extension
+          // otherwise, if it's missing, and the request didn't have an extension.. fall back to jpegs.
+          std::string template_filename;
+          std::string content_type_extension(Common::HTTPDownloader::GetExtensionForContentType(content_type));
+
+          // don't treat the domain name as an extension..
+          const std::string::size_type last_slash = filename.find('/');
+          const std::string::size_type last_dot = filename.find('.');
+          if (!content_type_extension.empty())
+            template_filename = fmt::format("cover.{}", content_type_extension);
+          else if (last_slash != std::string::npos && last_dot != std::string::npos && last_dot > last_slash)
+            template_filename = Path::GetFileName(filename);
+          else
+            template_filename = "cover.jpg";
+
+          std::string write_path(GetNewCoverImagePathForEntry(entry, template_filename.c_str(), use_serial));
+          if (!write_path.empty() && FileSystem::RenamePath(download_path.c_str(), write_path.c_str()))
+          {
+            if (save_callback)
+              save_callback(entry, std::move(write_path));
+          }
+          else
+          {
+            FileSystem::DeleteFile(download_path.c_str());
+          }
+        }
         else
-          template_filename = "cover.jpg";
+        {
+          FileSystem::DeleteFile(download_path.c_str());
+        }
+      }
 
-        std::string write_path(GetNewCoverImagePathForEntry(entry, template_filename.c_str(), use_serial));
-        if (write_path.empty())
-          return;
+      progress->IncrementProgressValue();
+      start_next_download();
+    });
+  };
 
-        if (FileSystem::WriteBinaryFile(write_path.c_str(), data.data(), data.size()) && save_callback)
-          save_callback(entry, std::move(write_path));
-      });
-    downloader->WaitForAllRequests();
-    progress->IncrementProgressValue();
-  }
+  downloader->SetMaxActiveRequests(MAX_PARALLEL_COVER_DOWNLOADS);
+  for (u32 i = 0; i < MAX_PARALLEL_COVER_DOWNLOADS; i++)
+    start_next_download();
+
+  downloader->WaitForAllRequests();
 
   return true;
 }
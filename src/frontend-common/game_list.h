@@ -5,6 +5,7 @@
 #include <ctime>
 #include <functional>
 #include <mutex>
+#include <optional>
 #include <string>
 
 class ByteStream;
@@ -63,6 +64,7 @@ bool PopulateEntryFromPath(const std::string& path, Entry* entry);
 std::unique_lock<std::recursive_mutex> GetLock();
 const Entry* GetEntryByIndex(u32 index);
 const Entry* GetEntryForPath(const char* path);
+std::optional<u32> GetEntryIndexForPath(const char* path);
 const Entry* GetEntryBySerial(const std::string_view& serial);
 u32 GetEntryCount();
 
@@ -71,8 +73,13 @@ bool IsGameListLoaded();
 /// Populates the game list with files in the configured directories.
 /// If invalidate_cache is set, all files will be re-scanned.
 /// If only_cache is set, no new files will be scanned, only those present in the cache.
+/// Directories are only listed again when their modification time changes. Files which are modified in place don't
+/// change the time of their directory, so invalidate_cache is needed to pick those up.
 void Refresh(bool invalidate_cache, bool only_cache = false, ProgressCallback* progress = nullptr);
 
+/// Returns every directory visited by the last complete refresh, including subdirectories of recursive paths.
+std::vector<std::string> GetScannedDirectories();
+
 std::string GetCoverImagePathForEntry(const Entry* entry);
 std::string GetCoverImagePath(const std::string& path, const std::string& serial, const std::string& title);
 std::string GetNewCoverImagePathForEntry(const Entry* entry, const char* new_filename, bool use_serial);
@@ -2,25 +2,31 @@
 
 #include "imgui_fullscreen.h"
 #include "IconsFontAwesome5.h"
+#include "common/align.h"
 #include "common/assert.h"
 #include "common/easing.h"
 #include "common/file_system.h"
+#include "common/heterogeneous_containers.h"
 #include "common/image.h"
 #include "common/log.h"
 #include "common/lru_cache.h"
+#include "common/md5_digest.h"
 #include "common/path.h"
 #include "common/string_util.h"
 #include "common/threading.h"
 #include "common/timer.h"
 #include "core/host.h"
 #include "core/host_display.h"
+#include "core/settings.h"
 #include "fmt/core.h"
 #include "imgui_internal.h"
 #include "imgui_stdlib.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <condition_variable>
+#include <cstring>
 #include <deque>
 #include <mutex>
 #include <thread>
@@ -32,7 +38,11 @@ namespace ImGuiFullscreen {
 using MessageDialogCallbackVariant = std::variant<InfoMessageDialogCallback, ConfirmMessageDialogCallback>;
 
 static std::optional<Common::RGBA8Image> LoadTextureImage(const char* path);
+static std::string GetThumbnailPath(const char* path, const FILESYSTEM_STAT_DATA& sd, u32 max_size);
+static std::optional<Common::RGBA8Image> LoadThumbnailImage(const char* path, u32 max_size);
 static std::shared_ptr<GPUTexture> UploadTexture(const char* path, const Common::RGBA8Image& image);
+static void QueueTextureLoad(const std::string_view& name, bool prefetch);
+static void PrioritizeTextureLoad(const std::string_view& name);
 static void TextureLoaderThread();
 
 static void DrawFileSelector();
@@ -78,15 +88,36 @@ static u32 s_menu_button_index = 0;
 static u32 s_close_button_state = 0;
 static bool s_focus_reset_queued = false;
 
+// Async textures are downscaled to at most this many layout units on their longest side, and the downscaled copies
+// of images on disk are kept in the cache directory, so the full size image only has to be decoded once.
+static constexpr float THUMBNAIL_LAYOUT_SIZE = 384.0f;
+static constexpr u32 THUMBNAIL_SIZE_ALIGNMENT = 64;
+
+// Requests are loaded newest first, with prefetches at the lowest priority. Once there are more than this many, the
+// lowest priority ones are dropped, since they've normally been scrolled past by then.
+static constexpr size_t MAX_TEXTURE_LOAD_QUEUE_SIZE = 64;
+static constexpr u32 MAX_TEXTURE_UPLOADS_PER_FRAME = 8;
+
+namespace {
+struct TextureLoadRequest
+{
+  std::string path;
+  u32 max_size;
+};
+} // namespace
+
 static LRUCache<std::string, std::shared_ptr<GPUTexture>> s_texture_cache(128, true);
 static std::shared_ptr<GPUTexture> s_placeholder_texture;
 static std::atomic_bool s_texture_load_thread_quit{false};
 static std::mutex s_texture_load_mutex;
 static std::condition_variable s_texture_load_cv;
-static std::deque<std::string> s_texture_load_queue;
-static std::deque<std::pair<std::string, Common::RGBA8Image>> s_texture_upload_queue;
+static std::deque<TextureLoadRequest> s_texture_load_queue;
+static std::deque<std::pair<std::string, std::optional<Common::RGBA8Image>>> s_texture_upload_queue;
 static std::thread s_texture_load_thread;
 
+// textures which are queued, loading or waiting to be uploaded, only accessed on the UI thread
+static UnorderedStringSet s_texture_load_pending;
+
 static bool s_choice_dialog_open = false;
 static bool s_choice_dialog_checkable = false;
 static std::string s_choice_dialog_title;
@@ -203,6 +234,7 @@ void ImGuiFullscreen::Shutdown()
   }
 
   s_texture_upload_queue.clear();
+  s_texture_load_pending.clear();
   s_placeholder_texture.reset();
   g_standard_font = nullptr;
   g_medium_font = nullptr;
@@ -262,6 +294,56 @@ std::optional<Common::RGBA8Image> ImGuiFullscreen::LoadTextureImage(const char*
   return image;
 }
 
+std::string ImGuiFullscreen::GetThumbnailPath(const char* path, const FILESYSTEM_STAT_DATA& sd, u32 max_size)
+{
+  // a replaced image will have a different timestamp or size, so it can't pick up a stale thumbnail
+  MD5Digest digest;
+  digest.Update(path, static_cast<u32>(std::strlen(path)));
+  digest.Update(&sd.ModificationTime, sizeof(sd.ModificationTime));
+  digest.Update(&sd.Size, sizeof(sd.Size));
+  digest.Update(&max_size, sizeof(max_size));
+
+  u8 hash[16];
+  digest.Final(hash);
+  return Path::Combine(EmuFolders::Cache,
+                       fmt::format("thumbnails" FS_OSPATH_SEPARATOR_STR "{}.png", StringUtil::EncodeHex(hash, 16)));
+}
+
+std::optional<Common::RGBA8Image> ImGuiFullscreen::LoadThumbnailImage(const char* path, u32 max_size)
+{
+  // resources are small, so only files on disk are worth keeping thumbnails of
+  std::string thumbnail_path;
+  FILESYSTEM_STAT_DATA sd;
+  if (Path::IsAbsolute(path) && FileSystem::StatFile(path, &sd))
+  {
+    thumbnail_path = GetThumbnailPath(path, sd, max_size);
+
+    Common::RGBA8Image image;
+    if (FileSystem::FileExists(thumbnail_path.c_str()) && image.LoadFromFile(thumbnail_path.c_str()))
+      return image;
+  }
+
+  std::optional<Common::RGBA8Image> image(LoadTextureImage(path));
+  if (!image.has_value() || (image->GetWidth() <= max_size && image->GetHeight() <= max_size))
+    return image;
+
+  const float scale =
+    static_cast<float>(max_size) / static_cast<float>(std::max(image->GetWidth(), image->GetHeight()));
+  image->Resize(std::max(static_cast<u32>(std::round(static_cast<float>(image->GetWidth()) * scale)), 1u),
+                std::max(static_cast<u32>(std::round(static_cast<float>(image->GetHeight()) * scale)), 1u));
+
+  if (!thumbnail_path.empty())
+  {
+    if (!FileSystem::EnsureDirectoryExists(std::string(Path::GetDirectory(thumbnail_path)).c_str(), false) ||
+        !image->SaveToFile(thumbnail_path.c_str()))
+    {
+      Log_WarningPrintf("Failed to save thumbnail for '%s'", path);
+    }
+  }
+
+  return image;
+}
+
 std::shared_ptr<GPUTexture> ImGuiFullscreen::UploadTexture(const char* path, const Common::RGBA8Image& image)
 {
   std::unique_ptr<GPUTexture> texture = g_host_display->CreateTexture(
@@ -309,16 +391,84 @@ GPUTexture* ImGuiFullscreen::GetCachedTextureAsync(const std::string_view& name)
   {
     // insert the placeholder
     tex_ptr = s_texture_cache.Insert(std::string(name), s_placeholder_texture);
-
-    // queue the actual load
-    std::unique_lock lock(s_texture_load_mutex);
-    s_texture_load_queue.emplace_back(name);
-    s_texture_load_cv.notify_one();
+    QueueTextureLoad(name, false);
+  }
+  else if (*tex_ptr == s_placeholder_texture &&
+           s_texture_load_pending.find(std::string(name)) != s_texture_load_pending.end())
+  {
+    // still loading, or prefetched and now visible, so make it the next to load. failed loads aren't pending, and
+    // keep the placeholder until they're evicted.
+    PrioritizeTextureLoad(name);
   }
 
   return tex_ptr->get();
 }
 
+void ImGuiFullscreen::PrefetchCachedTextureAsync(const std::string_view& name)
+{
+  if (s_texture_cache.Lookup(name))
+    return;
+
+  s_texture_cache.Insert(std::string(name), s_placeholder_texture);
+  QueueTextureLoad(name, true);
+}
+
+bool ImGuiFullscreen::HasPendingTextureLoads()
+{
+  return !s_texture_load_pending.empty();
+}
+
+void ImGuiFullscreen::QueueTextureLoad(const std::string_view& name, bool prefetch)
+{
+  // the placeholder can be evicted while it's still loading
+  if (!s_texture_load_pending.emplace(name).second)
+  {
+    if (!prefetch)
+      PrioritizeTextureLoad(name);
+
+    return;
+  }
+
+  std::unique_lock lock(s_texture_load_mutex);
+
+  // rounded up, so small changes to the layout scale don't make new thumbnails
+  const u32 max_size =
+    Common::AlignUpPow2(static_cast<u32>(LayoutScale(THUMBNAIL_LAYOUT_SIZE)), THUMBNAIL_SIZE_ALIGNMENT);
+  if (prefetch)
+    s_texture_load_queue.push_front(TextureLoadRequest{std::string(name), max_size});
+  else
+    s_texture_load_queue.push_back(TextureLoadRequest{std::string(name), max_size});
+
+  while (s_texture_load_queue.size() > MAX_TEXTURE_LOAD_QUEUE_SIZE)
+  {
+    // drop the placeholder too, so it's requested again when it's next drawn
+    const std::string& dropped = s_texture_load_queue.front().path;
+    std::shared_ptr<GPUTexture>* tex_ptr = s_texture_cache.Lookup(dropped);
+    if (tex_ptr && *tex_ptr == s_placeholder_texture)
+      s_texture_cache.Remove(dropped);
+
+    s_texture_load_pending.erase(dropped);
+    s_texture_load_queue.pop_front();
+  }
+
+  s_texture_load_cv.notify_one();
+}
+
+void ImGuiFullscreen::PrioritizeTextureLoad(const std::string_view& name)
+{
+  std::unique_lock lock(s_texture_load_mutex);
+
+  // it's not in the queue if it's loading now, or waiting to be uploaded
+  auto iter = std::find_if(s_texture_load_queue.begin(), s_texture_load_queue.end(),
+                           [&name](const TextureLoadRequest& req) { return (req.path == name); });
+  if (iter == s_texture_load_queue.end() || iter == (s_texture_load_queue.end() - 1))
+    return;
+
+  TextureLoadRequest req(std::move(*iter));
+  s_texture_load_queue.erase(iter);
+  s_texture_load_queue.push_back(std::move(req));
+}
+
 bool ImGuiFullscreen::InvalidateCachedTexture(const std::string& path)
 {
   return s_texture_cache.Remove(path);
@@ -326,16 +476,21 @@ bool ImGuiFullscreen::InvalidateCachedTexture(const std::string& path)
 
 void ImGuiFullscreen::UploadAsyncTextures()
 {
+  // spread the uploads over a few frames when a lot finish at once, e.g. after a fast scroll
   std::unique_lock lock(s_texture_load_mutex);
-  while (!s_texture_upload_queue.empty())
+  for (u32 i = 0; i < MAX_TEXTURE_UPLOADS_PER_FRAME && !s_texture_upload_queue.empty(); i++)
   {
-    std::pair<std::string, Common::RGBA8Image> it(std::move(s_texture_upload_queue.front()));
+    std::pair<std::string, std::optional<Common::RGBA8Image>> it(std::move(s_texture_upload_queue.front()));
     s_texture_upload_queue.pop_front();
     lock.unlock();
 
-    std::shared_ptr<GPUTexture> tex = UploadTexture(it.first.c_str(), it.second);
-    if (tex)
-      s_texture_cache.Insert(std::move(it.first), std::move(tex));
+    s_texture_load_pending.erase(it.first);
+    if (it.second.has_value())
+    {
+      std::shared_ptr<GPUTexture> tex = UploadTexture(it.first.c_str(), it.second.value());
+      if (tex)
+        s_texture_cache.Insert(std::move(it.first), std::move(tex));
+    }
 
     lock.lock();
   }
@@ -358,16 +513,15 @@ void ImGuiFullscreen::TextureLoaderThread()
 
     while (!s_texture_load_queue.empty())
     {
-      std::string path(std::move(s_texture_load_queue.front()));
-      s_texture_load_queue.pop_front();
+      TextureLoadRequest req(std::move(s_texture_load_queue.back()));
+      s_texture_load_queue.pop_back();
 
       lock.unlock();
-      std::optional<Common::RGBA8Image> image(LoadTextureImage(path.c_str()));
+      std::optional<Common::RGBA8Image> image(LoadThumbnailImage(req.path.c_str(), req.max_size));
       lock.lock();
 
-      // don't bother queuing back if it doesn't exist
-      if (image)
-        s_texture_upload_queue.emplace_back(std::move(path), std::move(image.value()));
+      // failures are queued back too, so they're no longer pending
+      s_texture_upload_queue.emplace_back(std::move(req.path), std::move(image));
     }
   }
 
@@ -125,8 +125,10 @@ const std::shared_ptr<GPUTexture>& GetPlaceholderTexture();
 std::shared_ptr<GPUTexture> LoadTexture(const std::string_view& path);
 GPUTexture* GetCachedTexture(const std::string_view& name);
 GPUTexture* GetCachedTextureAsync(const std::string_view& name);
+void PrefetchCachedTextureAsync(const std::string_view& name);
 bool InvalidateCachedTexture(const std::string& path);
 void UploadAsyncTextures();
+bool HasPendingTextureLoads();
 
 void BeginLayout();
 void EndLayout();
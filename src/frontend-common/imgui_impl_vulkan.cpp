@@ -360,16 +360,11 @@ void ImGui_ImplVulkan_RenderDrawData(ImDrawData* draw_data)
                 if (tex && last_texture != tex)
                 {
                     // if we can't get a descriptor set, we'll we're in trouble, since we can't restart the render pass from here.
-                    VkDescriptorSet ds = g_vulkan_context->AllocateDescriptorSet(bd->DescriptorSetLayout);
-                    if (ds == VK_NULL_HANDLE)
+                    if (!g_vulkan_context->BindImageSamplerDescriptor(command_buffer, bd->PipelineLayout, bd->DescriptorSetLayout, 0, tex->GetView(), bd->FontSampler))
                     {
                         continue;
                     }
 
-                    Vulkan::DescriptorSetUpdateBuilder dsb;
-                    dsb.AddCombinedImageSamplerDescriptorWrite(ds, 0, tex->GetView(), bd->FontSampler);
-                    dsb.Update(g_vulkan_context->GetDevice());
-                    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, bd->PipelineLayout, 0, 1, &ds, 0, nullptr);
                     last_texture = tex;
                 }
 
@@ -486,6 +481,8 @@ static bool ImGui_ImplVulkan_CreateDescriptorSetLayout(VkDevice device)
     info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     info.bindingCount = 1;
     info.pBindings = binding;
+    if (g_vulkan_context->SupportsPushDescriptors())
+        info.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
     VkResult err = vkCreateDescriptorSetLayout(device, &info, nullptr, &bd->DescriptorSetLayout);
     return (err == VK_SUCCESS);
 }
@@ -3,6 +3,7 @@
 #include "common/assert.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/path.h"
 #include "common/string_util.h"
 #include "common/timer.h"
 #include "common_host.h"
@@ -16,6 +17,7 @@
 #include "imgui_fullscreen.h"
 #include "imgui_internal.h"
 #include "input_manager.h"
+#include "xxhash.h"
 #include <atomic>
 #include <chrono>
 #include <cmath>
@@ -47,11 +49,30 @@ static ImFont* s_fixed_font;
 static ImFont* s_medium_font;
 static ImFont* s_large_font;
 
-static std::vector<u8> s_standard_font_data;
-static std::vector<u8> s_fixed_font_data;
-static std::vector<u8> s_icon_font_data;
+namespace {
+/// Font file contents, either read into memory or mapped from the file so that running instances share the pages.
+struct FontData
+{
+  std::vector<u8> bytes;
+  const void* mapping = nullptr;
+  size_t mapping_size = 0;
+
+  bool IsLoaded() const { return (mapping || !bytes.empty()); }
+  void* GetData() const { return mapping ? const_cast<void*>(mapping) : const_cast<u8*>(bytes.data()); }
+  int GetSize() const { return static_cast<int>(mapping ? mapping_size : bytes.size()); }
+
+  bool Load(const char* path, bool map_file);
+  bool LoadResource(const char* name, bool map_file);
+  void Release();
+};
+} // namespace
+
+static FontData s_standard_font_data;
+static FontData s_fixed_font_data;
+static FontData s_icon_font_data;
 
 static Common::Timer s_last_render_time;
+static u64 s_last_frame_hash = 0;
 
 // cached copies of WantCaptureKeyboard/Mouse, used to know when to dispatch events
 static std::atomic_bool s_imgui_wants_keyboard{false};
@@ -63,13 +84,13 @@ static std::unordered_map<u32, ImGuiKey> s_imgui_key_map;
 void ImGuiManager::SetFontPath(std::string path)
 {
   s_font_path = std::move(path);
-  s_standard_font_data = {};
+  s_standard_font_data.Release();
 }
 
 void ImGuiManager::SetFontRange(const u16* range)
 {
   s_font_range = range;
-  s_standard_font_data = {};
+  s_standard_font_data.Release();
 }
 
 bool ImGuiManager::Initialize()
@@ -201,6 +222,35 @@ void ImGuiManager::NewFrame()
   s_imgui_wants_mouse.store(io.WantCaptureMouse, std::memory_order_release);
 }
 
+bool ImGuiManager::HasFrameChanged()
+{
+  ImGui::Render();
+
+  // the software cursor is drawn outside of imgui, and resizing discards the swap chain's contents
+  const ImGuiIO& io = ImGui::GetIO();
+  u64 hash = XXH3_64bits(&io.DisplaySize, sizeof(io.DisplaySize));
+  hash = XXH3_64bits_withSeed(&io.MousePos, sizeof(io.MousePos), hash);
+
+  // animations, hovering and textures which finished loading all show up as different vertices or commands
+  const ImDrawData* draw_data = ImGui::GetDrawData();
+  for (int i = 0; i < draw_data->CmdListsCount; i++)
+  {
+    const ImDrawList* cmd_list = draw_data->CmdLists[i];
+    hash = XXH3_64bits_withSeed(cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.size_in_bytes(), hash);
+    hash = XXH3_64bits_withSeed(cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.size_in_bytes(), hash);
+    for (const ImDrawCmd& cmd : cmd_list->CmdBuffer)
+    {
+      const u64 cmd_data[] = {reinterpret_cast<u64>(cmd.TextureId), cmd.VtxOffset, cmd.IdxOffset, cmd.ElemCount};
+      hash = XXH3_64bits_withSeed(&cmd.ClipRect, sizeof(cmd.ClipRect), hash);
+      hash = XXH3_64bits_withSeed(cmd_data, sizeof(cmd_data), hash);
+    }
+  }
+
+  const bool changed = (hash != s_last_frame_hash);
+  s_last_frame_hash = hash;
+  return changed;
+}
+
 void ImGuiManager::SetStyle()
 {
   ImGuiStyle& style = ImGui::GetStyle();
@@ -385,37 +435,67 @@ void ImGuiManager::SetKeyMap()
   }
 }
 
-bool ImGuiManager::LoadFontData()
+bool FontData::Load(const char* path, bool map_file)
 {
-  if (s_standard_font_data.empty())
+  if (map_file)
   {
-    std::optional<std::vector<u8>> font_data = s_font_path.empty() ?
-                                                 Host::ReadResourceFile("fonts/Roboto-Regular.ttf") :
-                                                 FileSystem::ReadBinaryFile(s_font_path.c_str());
-    if (!font_data.has_value())
-      return false;
+    auto fp = FileSystem::OpenManagedCFile(path, "rb");
+    const s64 size = fp ? FileSystem::FSize64(fp.get()) : -1;
+    if (size > 0 && (mapping = FileSystem::MapCFile(fp.get(), static_cast<size_t>(size))) != nullptr)
+    {
+      mapping_size = static_cast<size_t>(size);
+      return true;
+    }
 
-    s_standard_font_data = std::move(font_data.value());
+    Log_WarningPrintf("Failed to map font '%s', reading it instead", path);
   }
 
-  if (s_fixed_font_data.empty())
-  {
-    std::optional<std::vector<u8>> font_data = Host::ReadResourceFile("fonts/RobotoMono-Medium.ttf");
-    if (!font_data.has_value())
-      return false;
+  std::optional<std::vector<u8>> font_data = FileSystem::ReadBinaryFile(path);
+  if (!font_data.has_value())
+    return false;
 
-    s_fixed_font_data = std::move(font_data.value());
-  }
+  bytes = std::move(font_data.value());
+  return true;
+}
+
+bool FontData::LoadResource(const char* name, bool map_file)
+{
+  if (map_file)
+    return Load(Path::Combine(EmuFolders::Resources, name).c_str(), true);
+
+  std::optional<std::vector<u8>> font_data = Host::ReadResourceFile(name);
+  if (!font_data.has_value())
+    return false;
+
+  bytes = std::move(font_data.value());
+  return true;
+}
 
-  if (s_icon_font_data.empty())
+void FontData::Release()
+{
+  FileSystem::UnmapCFile(mapping, mapping_size);
+  mapping = nullptr;
+  mapping_size = 0;
+  bytes = {};
+}
+
+bool ImGuiManager::LoadFontData()
+{
+  const bool map_files = g_settings.map_resource_files;
+  if (!s_standard_font_data.IsLoaded())
   {
-    std::optional<std::vector<u8>> font_data = Host::ReadResourceFile("fonts/fa-solid-900.ttf");
-    if (!font_data.has_value())
+    const bool loaded = s_font_path.empty() ? s_standard_font_data.LoadResource("fonts/Roboto-Regular.ttf", map_files) :
+                                              s_standard_font_data.Load(s_font_path.c_str(), map_files);
+    if (!loaded)
       return false;
-
-    s_icon_font_data = std::move(font_data.value());
   }
 
+  if (!s_fixed_font_data.IsLoaded() && !s_fixed_font_data.LoadResource("fonts/RobotoMono-Medium.ttf", map_files))
+    return false;
+
+  if (!s_icon_font_data.IsLoaded() && !s_icon_font_data.LoadResource("fonts/fa-solid-900.ttf", map_files))
+    return false;
+
   return true;
 }
 
@@ -443,17 +523,16 @@ ImFont* ImGuiManager::AddTextFont(float size)
 
   ImFontConfig cfg;
   cfg.FontDataOwnedByAtlas = false;
-  return ImGui::GetIO().Fonts->AddFontFromMemoryTTF(s_standard_font_data.data(),
-                                                    static_cast<int>(s_standard_font_data.size()), size, &cfg,
-                                                    s_font_range ? s_font_range : default_ranges);
+  return ImGui::GetIO().Fonts->AddFontFromMemoryTTF(s_standard_font_data.GetData(), s_standard_font_data.GetSize(),
+                                                    size, &cfg, s_font_range ? s_font_range : default_ranges);
 }
 
 ImFont* ImGuiManager::AddFixedFont(float size)
 {
   ImFontConfig cfg;
   cfg.FontDataOwnedByAtlas = false;
-  return ImGui::GetIO().Fonts->AddFontFromMemoryTTF(s_fixed_font_data.data(),
-                                                    static_cast<int>(s_fixed_font_data.size()), size, &cfg, nullptr);
+  return ImGui::GetIO().Fonts->AddFontFromMemoryTTF(s_fixed_font_data.GetData(), s_fixed_font_data.GetSize(), size,
+                                                    &cfg, nullptr);
 }
 
 bool ImGuiManager::AddIconFonts(float size)
@@ -467,7 +546,7 @@ bool ImGuiManager::AddIconFonts(float size)
   cfg.GlyphMaxAdvanceX = size;
   cfg.FontDataOwnedByAtlas = false;
 
-  return (ImGui::GetIO().Fonts->AddFontFromMemoryTTF(s_icon_font_data.data(), static_cast<int>(s_icon_font_data.size()),
+  return (ImGui::GetIO().Fonts->AddFontFromMemoryTTF(s_icon_font_data.GetData(), s_icon_font_data.GetSize(),
                                                      size * 0.75f, &cfg, range_fa) != nullptr);
 }
 
@@ -30,6 +30,10 @@ void UpdateScale();
 /// Call at the beginning of the frame to set up ImGui state.
 void NewFrame();
 
+/// Finishes the frame, and returns false if it draws exactly the same as the last frame this was called for. Idle
+/// loops can skip presenting when nothing else on screen changed.
+bool HasFrameChanged();
+
 /// Renders any on-screen display elements.
 void RenderOSD();
 
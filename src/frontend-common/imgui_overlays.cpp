@@ -7,11 +7,13 @@
 #include "common/string_util.h"
 #include "common/timer.h"
 #include "common_host.h"
+#include "core/cdrom.h"
 #include "core/controller.h"
 #include "core/gpu.h"
 #include "core/host.h"
 #include "core/host_display.h"
 #include "core/host_settings.h"
+#include "core/host_time_accounting.h"
 #include "core/settings.h"
 #include "core/spu.h"
 #include "core/system.h"
@@ -29,13 +31,50 @@
 #include <chrono>
 #include <cmath>
 #include <deque>
+#include <limits>
 #include <mutex>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
 
 Log_SetChannel(ImGuiManager);
 
 namespace ImGuiManager {
+namespace {
+struct PerformanceOverlayLine
+{
+  SmallString text;
+  ImFont* font;
+  ImU32 color;
+  ImVec2 size;
+};
+
+struct PerformanceOverlayKey
+{
+  u32 update_count;
+  System::State state;
+  ImFont* fixed_font;
+  ImFont* standard_font;
+  u32 display_width;
+  u32 display_height;
+  bool interlaced;
+  bool rewinding;
+  bool fast_forward;
+  bool turbo;
+
+  bool operator!=(const PerformanceOverlayKey& rhs) const
+  {
+    return std::tie(update_count, state, fixed_font, standard_font, display_width, display_height, interlaced,
+                    rewinding, fast_forward, turbo) !=
+           std::tie(rhs.update_count, rhs.state, rhs.fixed_font, rhs.standard_font, rhs.display_width,
+                    rhs.display_height, rhs.interlaced, rhs.rewinding, rhs.fast_forward, rhs.turbo);
+  }
+};
+} // namespace
+
 static void FormatProcessorStat(String& text, double usage, double time);
+static void AddPerformanceOverlayLine(ImFont* font, const SmallString& text, ImU32 color);
+static void UpdatePerformanceOverlayLines(System::State state);
 static void DrawPerformanceOverlay();
 static void DrawEnhancementsOverlay();
 static void DrawInputsOverlay();
@@ -47,6 +86,10 @@ static void Draw();
 
 static bool s_save_state_selector_ui_open = false;
 
+static std::vector<ImGuiManager::PerformanceOverlayLine> s_performance_overlay_lines;
+static ImGuiManager::PerformanceOverlayKey s_performance_overlay_key = {};
+static bool s_performance_overlay_dirty = true;
+
 void ImGuiManager::RenderOverlays()
 {
   const System::State state = System::GetState();
@@ -76,44 +119,25 @@ void ImGuiManager::FormatProcessorStat(String& text, double usage, double time)
     text.AppendFmtString("{:.1f}% ({:.2f}ms)", usage, time);
 }
 
-void ImGuiManager::DrawPerformanceOverlay()
+void ImGuiManager::AddPerformanceOverlayLine(ImFont* font, const SmallString& text, ImU32 color)
 {
-  if (!(g_settings.display_show_fps || g_settings.display_show_speed || g_settings.display_show_resolution ||
-        g_settings.display_show_cpu ||
-        (g_settings.display_show_status_indicators &&
-         (System::IsPaused() || System::IsFastForwardEnabled() || System::IsTurboEnabled()))))
-  {
-    return;
-  }
+  PerformanceOverlayLine& line = s_performance_overlay_lines.emplace_back();
+  line.text.Assign(text);
+  line.font = font;
+  line.color = color;
+  line.size = font->CalcTextSizeA(font->FontSize, std::numeric_limits<float>::max(), -1.0f, text.GetCharArray(),
+                                  text.GetCharArray() + text.GetLength(), nullptr);
+}
 
-  const float scale = ImGuiManager::GetGlobalScale();
-  const float shadow_offset = std::ceil(1.0f * scale);
-  const float margin = std::ceil(10.0f * scale);
-  const float spacing = std::ceil(5.0f * scale);
+void ImGuiManager::UpdatePerformanceOverlayLines(System::State state)
+{
   ImFont* fixed_font = ImGuiManager::GetFixedFont();
   ImFont* standard_font = ImGuiManager::GetStandardFont();
-  float position_y = margin;
-
-  ImDrawList* dl = ImGui::GetBackgroundDrawList();
   SmallString text;
-  ImVec2 text_size;
   bool first = true;
 
-#define DRAW_LINE(font, text, color)                                                                                   \
-  do                                                                                                                   \
-  {                                                                                                                    \
-    text_size =                                                                                                        \
-      font->CalcTextSizeA(font->FontSize, std::numeric_limits<float>::max(), -1.0f, (text), nullptr, nullptr);         \
-    dl->AddText(                                                                                                       \
-      font, font->FontSize,                                                                                            \
-      ImVec2(ImGui::GetIO().DisplaySize.x - margin - text_size.x + shadow_offset, position_y + shadow_offset),         \
-      IM_COL32(0, 0, 0, 100), text, text.GetCharArray() + text.GetLength());                                           \
-    dl->AddText(font, font->FontSize, ImVec2(ImGui::GetIO().DisplaySize.x - margin - text_size.x, position_y), color,  \
-                (text));                                                                                               \
-    position_y += text_size.y + spacing;                                                                               \
-  } while (0)
+  s_performance_overlay_lines.clear();
 
-  const System::State state = System::GetState();
   if (state == System::State::Running)
   {
     const float speed = System::GetEmulationSpeed();
@@ -144,7 +168,7 @@ void ImGuiManager::DrawPerformanceOverlay()
       else
         color = IM_COL32(255, 255, 255, 255);
 
-      DRAW_LINE(fixed_font, text, color);
+      AddPerformanceOverlayLine(fixed_font, text, color);
     }
 
     if (g_settings.display_show_resolution)
@@ -152,14 +176,19 @@ void ImGuiManager::DrawPerformanceOverlay()
       const auto [effective_width, effective_height] = g_gpu->GetEffectiveDisplayResolution();
       const bool interlaced = g_gpu->IsInterlacedDisplayEnabled();
       text.Fmt("{}x{} ({})", effective_width, effective_height, interlaced ? "interlaced" : "progressive");
-      DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
+      AddPerformanceOverlayLine(fixed_font, text, IM_COL32(255, 255, 255, 255));
     }
 
     if (g_settings.display_show_cpu)
     {
       text.Clear();
       text.AppendFmtString("{:.2f}ms ({:.2f}ms worst)", System::GetAverageFrameTime(), System::GetWorstFrameTime());
-      DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
+      AddPerformanceOverlayLine(fixed_font, text, IM_COL32(255, 255, 255, 255));
+
+      text.Clear();
+      text.AppendFmtString("Latency: {:.2f}ms ({:.2f}ms worst)", System::GetAverageInputLatency(),
+                           System::GetWorstInputLatency());
+      AddPerformanceOverlayLine(fixed_font, text, IM_COL32(255, 255, 255, 255));
 
       text.Clear();
       if (g_settings.cpu_overclock_active || (!g_settings.IsUsingRecompiler() || g_settings.cpu_recompiler_icache ||
@@ -203,13 +232,22 @@ void ImGuiManager::DrawPerformanceOverlay()
         text.Assign("CPU: ");
       }
       FormatProcessorStat(text, System::GetCPUThreadUsage(), System::GetCPUThreadAverageTime());
-      DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
+      AddPerformanceOverlayLine(fixed_font, text, IM_COL32(255, 255, 255, 255));
 
       if (g_gpu->GetSWThread())
       {
         text.Assign("SW: ");
         FormatProcessorStat(text, System::GetSWThreadUsage(), System::GetSWThreadAverageTime());
-        DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
+        AddPerformanceOverlayLine(fixed_font, text, IM_COL32(255, 255, 255, 255));
+      }
+
+      if (const CDROMAsyncReader::ReadaheadStats cd_stats = g_cdrom.GetReadaheadStats(); cd_stats.depth > 0)
+      {
+        const u32 total = cd_stats.hits + cd_stats.misses;
+        text.Fmt("CD: {} sectors, {:.1f}% hits ({}/{})", cd_stats.depth,
+                 (total > 0) ? (static_cast<float>(cd_stats.hits) * 100.0f / static_cast<float>(total)) : 0.0f,
+                 cd_stats.hits, total);
+        AddPerformanceOverlayLine(fixed_font, text, IM_COL32(255, 255, 255, 255));
       }
 
 #if 0
@@ -218,16 +256,46 @@ void ImGuiManager::DrawPerformanceOverlay()
         const u32 frames = stream->GetBufferedFramesRelaxed();
         text.Clear();
         text.Fmt("Audio: {:<4u}f/{:<3u}ms", frames, AudioStream::GetMSForBufferSize(stream->GetSampleRate(), frames));
-        DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
+        AddPerformanceOverlayLine(fixed_font, text, IM_COL32(255, 255, 255, 255));
       }
 #endif
     }
 
+    if (g_settings.display_show_subsystem_times)
+    {
+      for (const HostTimeAccounting::SectionTime& section : HostTimeAccounting::GetAverages())
+      {
+        text.Fmt("{}: ", section.name);
+        FormatProcessorStat(text, section.usage, section.time);
+        AddPerformanceOverlayLine(fixed_font, text, IM_COL32(255, 255, 255, 255));
+      }
+    }
+
     if (g_settings.display_show_gpu && g_host_display->IsGPUTimingEnabled())
     {
       text.Assign("GPU: ");
       FormatProcessorStat(text, System::GetGPUUsage(), System::GetGPUAverageTime());
-      DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
+      AddPerformanceOverlayLine(fixed_font, text, IM_COL32(255, 255, 255, 255));
+
+      if (System::HasGPUSectionTimes())
+      {
+        for (u32 i = 0; i < static_cast<u32>(GPUTimingSection::Count); i++)
+        {
+          const GPUTimingSection section = static_cast<GPUTimingSection>(i);
+          const float time = System::GetGPUSectionAverageTime(section);
+          if (time < 0.005f)
+            continue;
+
+          text.Fmt(" {}: {:.2f}ms", HostDisplay::GetGPUTimingSectionName(section), time);
+          AddPerformanceOverlayLine(fixed_font, text, IM_COL32(255, 255, 255, 255));
+        }
+      }
+    }
+
+    if (g_settings.display_show_gpu && System::GetAverageFenceWaitTime() >= 0.005f)
+    {
+      text.Fmt("Fence Wait: {:.2f}ms", System::GetAverageFenceWaitTime());
+      AddPerformanceOverlayLine(fixed_font, text, IM_COL32(255, 255, 255, 255));
     }
 
     if (g_settings.display_show_status_indicators)
@@ -236,17 +304,72 @@ void ImGuiManager::DrawPerformanceOverlay()
       if (rewinding || System::IsFastForwardEnabled() || System::IsTurboEnabled())
       {
         text.Assign(rewinding ? ICON_FA_FAST_BACKWARD : ICON_FA_FAST_FORWARD);
-        DRAW_LINE(standard_font, text, IM_COL32(255, 255, 255, 255));
+        AddPerformanceOverlayLine(standard_font, text, IM_COL32(255, 255, 255, 255));
       }
     }
   }
   else if (g_settings.display_show_status_indicators && state == System::State::Paused)
   {
     text.Assign(ICON_FA_PAUSE);
-    DRAW_LINE(standard_font, text, IM_COL32(255, 255, 255, 255));
+    AddPerformanceOverlayLine(standard_font, text, IM_COL32(255, 255, 255, 255));
   }
 
-#undef DRAW_LINE
+}
+
+void ImGuiManager::InvalidatePerformanceOverlay()
+{
+  s_performance_overlay_dirty = true;
+}
+
+void ImGuiManager::DrawPerformanceOverlay()
+{
+  if (!(g_settings.display_show_fps || g_settings.display_show_speed || g_settings.display_show_resolution ||
+        g_settings.display_show_cpu || g_settings.display_show_subsystem_times ||
+        (g_settings.display_show_status_indicators &&
+         (System::IsPaused() || System::IsFastForwardEnabled() || System::IsTurboEnabled()))))
+  {
+    return;
+  }
+
+  // the counters are only recalculated once a second, so only format them again when they or the state change
+  PerformanceOverlayKey key = {};
+  key.state = System::GetState();
+  key.update_count = System::GetPerformanceCountersUpdateCount();
+  key.fixed_font = ImGuiManager::GetFixedFont();
+  key.standard_font = ImGuiManager::GetStandardFont();
+  key.rewinding = System::IsRewinding();
+  key.fast_forward = System::IsFastForwardEnabled();
+  key.turbo = System::IsTurboEnabled();
+  if (g_settings.display_show_resolution && key.state == System::State::Running)
+  {
+    std::tie(key.display_width, key.display_height) = g_gpu->GetEffectiveDisplayResolution();
+    key.interlaced = g_gpu->IsInterlacedDisplayEnabled();
+  }
+  if (s_performance_overlay_dirty || key != s_performance_overlay_key)
+  {
+    s_performance_overlay_key = key;
+    s_performance_overlay_dirty = false;
+    UpdatePerformanceOverlayLines(key.state);
+  }
+
+  const float scale = ImGuiManager::GetGlobalScale();
+  const float shadow_offset = std::ceil(1.0f * scale);
+  const float margin = std::ceil(10.0f * scale);
+  const float spacing = std::ceil(5.0f * scale);
+  const float right = ImGui::GetIO().DisplaySize.x - margin;
+  float position_y = margin;
+
+  ImDrawList* dl = ImGui::GetBackgroundDrawList();
+  for (const PerformanceOverlayLine& line : s_performance_overlay_lines)
+  {
+    const char* text_start = line.text.GetCharArray();
+    const char* text_end = text_start + line.text.GetLength();
+    const float font_size = line.font->FontSize;
+    dl->AddText(line.font, font_size, ImVec2(right - line.size.x + shadow_offset, position_y + shadow_offset),
+                IM_COL32(0, 0, 0, 100), text_start, text_end);
+    dl->AddText(line.font, font_size, ImVec2(right - line.size.x, position_y), line.color, text_start, text_end);
+    position_y += line.size.y + spacing;
+  }
 }
 
 void ImGuiManager::DrawEnhancementsOverlay()
@@ -4,6 +4,9 @@
 
 namespace ImGuiManager {
 void RenderOverlays();
+
+/// Forces the performance overlay's text to be formatted again, e.g. after the settings it shows change.
+void InvalidatePerformanceOverlay();
 }
 
 namespace SaveStateSelectorUI {
@@ -4,6 +4,7 @@
 #include "common/log.h"
 #include "common/path.h"
 #include "common/string_util.h"
+#include "common/threading.h"
 #include "common/timer.h"
 #include "core/controller.h"
 #include "core/host.h"
@@ -13,11 +14,13 @@
 
 #include "fmt/core.h"
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -34,6 +37,9 @@ enum : u32
   MAX_MOTORS_PER_PAD = 2,
   FIRST_EXTERNAL_INPUT_SOURCE = static_cast<u32>(InputSourceType::Pointer) + 1u,
   LAST_EXTERNAL_INPUT_SOURCE = static_cast<u32>(InputSourceType::Count),
+  INPUT_THREAD_POLL_INTERVAL_US = 1000,
+  INPUT_EVENT_QUEUE_SIZE = 1024,
+  INPUT_EVENT_QUEUE_MASK = INPUT_EVENT_QUEUE_SIZE - 1,
 };
 
 // ------------------------------------------------------------------------
@@ -51,6 +57,7 @@ struct InputBinding
   u8 num_keys = 0;
   u8 full_mask = 0;
   u8 current_mask = 0;
+  bool pad_binding = false;
 };
 
 struct PadVibrationBinding
@@ -98,7 +105,8 @@ static std::optional<InputBindingKey> ParseSensorKey(const std::string_view& sou
 
 static std::vector<std::string_view> SplitChord(const std::string_view& binding);
 static bool SplitBinding(const std::string_view& binding, std::string_view* source, std::string_view* sub_binding);
-static void AddBindings(const std::vector<std::string>& bindings, const InputEventHandler& handler);
+static void AddBindings(const std::vector<std::string>& bindings, const InputEventHandler& handler,
+                        bool pad_binding = false);
 
 static bool IsAxisHandler(const InputEventHandler& handler);
 
@@ -108,6 +116,30 @@ static void AddPadBindings(SettingsInterface& si, const std::string& section, u3
 static void UpdateContinuedVibration();
 static void GenerateRelativeMouseEvents();
 
+namespace {
+enum class EventPass : u8
+{
+  All,
+  PadBindings,
+  OtherBindings,
+};
+
+// Bindings for a key, stored contiguously in the lookup table.
+struct BindingRange
+{
+  InputBinding* const* first;
+  InputBinding* const* last;
+
+  ALWAYS_INLINE InputBinding* const* begin() const { return first; }
+  ALWAYS_INLINE InputBinding* const* end() const { return last; }
+  ALWAYS_INLINE bool empty() const { return (first == last); }
+};
+} // namespace
+
+static void AddBindingInternal(const std::string_view& binding, const InputEventHandler& handler, bool pad_binding);
+static void RebuildBindingTable();
+static BindingRange FindBindingsForKey(InputBindingKey masked_key);
+static bool InvokeEventsForPass(InputBindingKey key, float value, GenericInputBinding generic_key, EventPass pass);
 static bool DoEventHook(InputBindingKey key, float value);
 static bool PreprocessEvent(InputBindingKey key, float value, GenericInputBinding generic_key);
 
@@ -115,16 +147,33 @@ static void LoadMacroButtonConfig(SettingsInterface& si, const std::string& sect
                                   const Controller::ControllerInfo* cinfo);
 static void ApplyMacroButton(u32 pad, const MacroButton& mb);
 static void UpdateMacroButtons();
+
+static void PollSourceEvents();
+static void StartInputThread();
+static void StopInputThread();
+static void InputThreadEntryPoint();
+static bool QueueEvent(InputBindingKey key, float value, GenericInputBinding generic_key);
+static void ProcessQueuedEvents();
 } // namespace InputManager
 
 // ------------------------------------------------------------------------
 // Local Variables
 // ------------------------------------------------------------------------
 
-// This is a multimap containing any binds related to the specified key.
-using BindingMap = std::unordered_multimap<InputBindingKey, std::shared_ptr<InputBinding>, InputBindingKeyHash>;
+// Every binding, and an open-addressed table from a (direction masked) key to the bindings which include it. The table
+// is rebuilt whenever bindings are added, so looking up an event is a couple of probes without any allocation.
+struct BindingTableEntry
+{
+  u64 key_bits;
+  u32 first_binding;
+  u32 num_bindings; // zero for empty slots
+};
+using BindingList = std::vector<std::shared_ptr<InputBinding>>;
 using VibrationBindingArray = std::vector<PadVibrationBinding>;
-static BindingMap s_binding_map;
+static BindingList s_bindings;
+static std::vector<BindingTableEntry> s_binding_table;
+static std::vector<InputBinding*> s_binding_table_bindings;
+static u32 s_binding_table_mask = 0;
 static VibrationBindingArray s_pad_vibration_array;
 static std::mutex s_binding_map_write_lock;
 
@@ -135,6 +184,30 @@ static InputInterceptHook::Callback m_event_intercept_callback;
 // Input sources. Keyboard/mouse don't exist here.
 static std::array<std::unique_ptr<InputSource>, static_cast<u32>(InputSourceType::Count)> s_input_sources;
 
+// Optional thread which polls the sources between frames. Events it generates are queued for the CPU thread, since
+// the handlers touch the controllers. The lock is held while polling, and when the CPU thread uses the sources.
+struct QueuedInputEvent
+{
+  InputBindingKey key;
+  float value;
+  GenericInputBinding generic_key;
+};
+static std::thread s_input_thread;
+static std::atomic_bool s_input_thread_running{false};
+static std::mutex s_input_source_lock;
+static std::array<QueuedInputEvent, INPUT_EVENT_QUEUE_SIZE> s_input_event_queue;
+static std::atomic<u32> s_input_event_queue_read_pos{0};
+static std::atomic<u32> s_input_event_queue_write_pos{0};
+static thread_local bool s_is_input_thread = false;
+
+// bumped for every event dispatched on the CPU thread
+static u32 s_dispatched_event_count = 0;
+
+// With late latching, queued events are applied to the pad bindings when the game reads the pads. They're kept for
+// the remaining bindings until the frame ends, since hotkeys can't run in the middle of a frame.
+static bool s_late_latching_enabled = false;
+static std::vector<QueuedInputEvent> s_latched_input_events;
+
 // Macro buttons.
 static std::array<std::array<MacroButton, InputManager::NUM_MACRO_BUTTONS_PER_CONTROLLER>,
                   NUM_CONTROLLER_AND_CARD_PORTS>
@@ -329,13 +402,23 @@ std::string InputManager::ConvertInputBindingKeysToString(const InputBindingKey*
   return ss.str();
 }
 
-void InputManager::AddBindings(const std::vector<std::string>& bindings, const InputEventHandler& handler)
+void InputManager::AddBindings(const std::vector<std::string>& bindings, const InputEventHandler& handler,
+                               bool pad_binding /* = false */)
 {
   for (const std::string& binding : bindings)
-    AddBinding(binding, handler);
+    AddBindingInternal(binding, handler, pad_binding);
+}
+
+void InputManager::AddBinding(const std::string_view& binding, const InputEventHandler& handler,
+                              bool pad_binding /* = false */)
+{
+  std::unique_lock lock(s_binding_map_write_lock);
+  AddBindingInternal(binding, handler, pad_binding);
+  RebuildBindingTable();
 }
 
-void InputManager::AddBinding(const std::string_view& binding, const InputEventHandler& handler)
+void InputManager::AddBindingInternal(const std::string_view& binding, const InputEventHandler& handler,
+                                      bool pad_binding)
 {
   std::shared_ptr<InputBinding> ibinding;
   const std::vector<std::string_view> chord_bindings(SplitChord(binding));
@@ -354,6 +437,7 @@ void InputManager::AddBinding(const std::string_view& binding, const InputEventH
     {
       ibinding = std::make_shared<InputBinding>();
       ibinding->handler = handler;
+      ibinding->pad_binding = pad_binding;
     }
 
     if (ibinding->num_keys == MAX_KEYS_PER_BINDING)
@@ -369,12 +453,72 @@ void InputManager::AddBinding(const std::string_view& binding, const InputEventH
     ibinding->num_keys++;
   }
 
-  if (!ibinding)
-    return;
+  if (ibinding)
+    s_bindings.push_back(std::move(ibinding));
+}
+
+void InputManager::RebuildBindingTable()
+{
+  // group the bindings by key, keeping them in the order they were added
+  std::vector<std::pair<u64, InputBinding*>> keys;
+  for (const std::shared_ptr<InputBinding>& binding : s_bindings)
+  {
+    for (u32 i = 0; i < binding->num_keys; i++)
+      keys.emplace_back(binding->keys[i].MaskDirection().bits, binding.get());
+  }
+  std::stable_sort(keys.begin(), keys.end(),
+                   [](const auto& lhs, const auto& rhs) { return (lhs.first < rhs.first); });
+
+  u32 num_keys = 0;
+  for (size_t i = 0; i < keys.size(); i++)
+    num_keys += (i == 0 || keys[i].first != keys[i - 1].first) ? 1 : 0;
 
-  // plop it in the input map for all the keys
-  for (u32 i = 0; i < ibinding->num_keys; i++)
-    s_binding_map.emplace(ibinding->keys[i].MaskDirection(), ibinding);
+  // keep the table at most half full, so probe sequences stay short
+  u32 table_size = 16;
+  while (table_size < (num_keys * 2))
+    table_size *= 2;
+
+  s_binding_table.assign(table_size, BindingTableEntry{0, 0, 0});
+  s_binding_table_mask = table_size - 1;
+  s_binding_table_bindings.clear();
+  s_binding_table_bindings.reserve(keys.size());
+
+  for (size_t i = 0; i < keys.size();)
+  {
+    const u64 key_bits = keys[i].first;
+    const u32 first_binding = static_cast<u32>(s_binding_table_bindings.size());
+    for (; i < keys.size() && keys[i].first == key_bits; i++)
+      s_binding_table_bindings.push_back(keys[i].second);
+
+    u32 slot = static_cast<u32>((key_bits * UINT64_C(0x9E3779B97F4A7C15)) >> 32) & s_binding_table_mask;
+    while (s_binding_table[slot].num_bindings != 0)
+      slot = (slot + 1) & s_binding_table_mask;
+
+    s_binding_table[slot] = BindingTableEntry{
+      key_bits, first_binding, static_cast<u32>(s_binding_table_bindings.size()) - first_binding};
+  }
+}
+
+InputManager::BindingRange InputManager::FindBindingsForKey(InputBindingKey masked_key)
+{
+  if (s_binding_table.empty())
+    return BindingRange{nullptr, nullptr};
+
+  u32 slot = static_cast<u32>((masked_key.bits * UINT64_C(0x9E3779B97F4A7C15)) >> 32) & s_binding_table_mask;
+  for (;;)
+  {
+    const BindingTableEntry& entry = s_binding_table[slot];
+    if (entry.num_bindings == 0)
+      return BindingRange{nullptr, nullptr};
+
+    if (entry.key_bits == masked_key.bits)
+    {
+      InputBinding* const* first = s_binding_table_bindings.data() + entry.first_binding;
+      return BindingRange{first, first + entry.num_bindings};
+    }
+
+    slot = (slot + 1) & s_binding_table_mask;
+  }
 }
 
 void InputManager::AddVibrationBinding(u32 pad_index, const InputBindingKey* motor_0_binding,
@@ -631,7 +775,8 @@ void InputManager::AddPadBindings(SettingsInterface& si, const std::string& sect
                     Controller* c = System::GetController(pad_index);
                     if (c)
                       c->SetBindState(bind_index, value);
-                  }});
+                  }},
+                  true);
     }
   }
 
@@ -690,15 +835,19 @@ void InputManager::AddPadBindings(SettingsInterface& si, const std::string& sect
 bool InputManager::HasAnyBindingsForKey(InputBindingKey key)
 {
   std::unique_lock lock(s_binding_map_write_lock);
-  return (s_binding_map.find(key.MaskDirection()) != s_binding_map.end());
+  return !FindBindingsForKey(key.MaskDirection()).empty();
 }
 
 bool InputManager::HasAnyBindingsForSource(InputBindingKey key)
 {
   std::unique_lock lock(s_binding_map_write_lock);
-  for (const auto& it : s_binding_map)
+  for (const BindingTableEntry& entry : s_binding_table)
   {
-    const InputBindingKey& okey = it.first;
+    if (entry.num_bindings == 0)
+      continue;
+
+    InputBindingKey okey;
+    okey.bits = entry.key_bits;
     if (okey.source_type == key.source_type && okey.source_index == key.source_index &&
         okey.source_subtype == key.source_subtype)
     {
@@ -716,23 +865,40 @@ bool InputManager::IsAxisHandler(const InputEventHandler& handler)
 
 bool InputManager::InvokeEvents(InputBindingKey key, float value, GenericInputBinding generic_key)
 {
-  if (DoEventHook(key, value))
-    return true;
+  if (s_is_input_thread)
+    return QueueEvent(key, value, generic_key);
 
-  // If imgui ate the event, don't fire our handlers.
-  const bool skip_button_handlers = PreprocessEvent(key, value, generic_key);
+  return InvokeEventsForPass(key, value, generic_key, EventPass::All);
+}
+
+bool InputManager::InvokeEventsForPass(InputBindingKey key, float value, GenericInputBinding generic_key,
+                                       EventPass pass)
+{
+  s_dispatched_event_count++;
+
+  // The hook and imgui go with the other bindings, the pads are updated as if they didn't want the event.
+  bool skip_button_handlers = false;
+  if (pass != EventPass::PadBindings)
+  {
+    if (DoEventHook(key, value))
+      return true;
+
+    // If imgui ate the event, don't fire our handlers.
+    skip_button_handlers = PreprocessEvent(key, value, generic_key);
+  }
 
   // find all the bindings associated with this key
   const InputBindingKey masked_key = key.MaskDirection();
-  const auto range = s_binding_map.equal_range(masked_key);
-  if (range.first == s_binding_map.end())
+  const BindingRange range = FindBindingsForKey(masked_key);
+  if (range.empty())
     return false;
 
   // Now we can actually fire/activate bindings.
   u32 min_num_keys = 0;
-  for (auto it = range.first; it != range.second; ++it)
+  for (InputBinding* binding : range)
   {
-    InputBinding* binding = it->second.get();
+    if (pass != EventPass::All && binding->pad_binding != (pass == EventPass::PadBindings))
+      continue;
 
     // find the key which matches us
     for (u32 i = 0; i < binding->num_keys; i++)
@@ -765,7 +931,7 @@ bool InputManager::InvokeEvents(InputBindingKey key, float value, GenericInputBi
         binding->current_mask = new_mask;
 
         // Workaround for multi-key bindings that share the same keys.
-        if (binding->num_keys > 1 && new_full_state && prev_full_state != new_full_state && range.first != range.second)
+        if (binding->num_keys > 1 && new_full_state && prev_full_state != new_full_state && !range.empty())
         {
           // Because the binding map isn't ordered, we could iterate in the order of Shift+F1 and then
           // F1, which would mean that F1 wouldn't get cancelled and still activate. So, to handle this
@@ -779,10 +945,8 @@ bool InputManager::InvokeEvents(InputBindingKey key, float value, GenericInputBi
           // they could still activate and take precedence over us, so we leave them alone.
           for (u32 j = 0; j < binding->num_keys; j++)
           {
-            const auto range2 = s_binding_map.equal_range(binding->keys[j].MaskDirection());
-            for (auto it2 = range2.first; it2 != range2.second; ++it2)
+            for (InputBinding* other_binding : FindBindingsForKey(binding->keys[j].MaskDirection()))
             {
-              InputBinding* other_binding = it2->second.get();
               if (other_binding == binding || IsAxisHandler(other_binding->handler) ||
                   other_binding->num_keys >= binding->num_keys)
               {
@@ -897,9 +1061,13 @@ bool InputManager::IsUsingRawInput()
 bool InputManager::HasPointerAxisBinds()
 {
   std::unique_lock lock(s_binding_map_write_lock);
-  for (const auto& it : s_binding_map)
+  for (const BindingTableEntry& entry : s_binding_table)
   {
-    const InputBindingKey& key = it.first;
+    if (entry.num_bindings == 0)
+      continue;
+
+    InputBindingKey key;
+    key.bits = entry.key_bits;
     if (key.source_type == InputSourceType::Pointer && key.source_subtype == InputSubclass::PointerAxis &&
         key.data >= static_cast<u32>(InputPointerAxis::X) && key.data <= static_cast<u32>(InputPointerAxis::Y))
     {
@@ -918,6 +1086,8 @@ void InputManager::SetDefaultConfig(SettingsInterface& si)
   si.SetBoolValue("InputSources", "Evdev", false);
   si.SetBoolValue("InputSources", "XInput", false);
   si.SetBoolValue("InputSources", "RawInput", false);
+  si.SetBoolValue("InputSources", "PollingThread", false);
+  si.SetBoolValue("InputSources", "LateLatching", false);
 }
 
 void InputManager::ClearPortBindings(SettingsInterface& si, u32 port)
@@ -1093,6 +1263,7 @@ std::vector<std::string> InputManager::GetInputProfileNames()
 void InputManager::SetPadVibrationIntensity(u32 pad_index, float large_or_single_motor_intensity,
                                             float small_motor_intensity)
 {
+  std::lock_guard<std::mutex> lock(s_input_source_lock);
   for (PadVibrationBinding& pad : s_pad_vibration_array)
   {
     if (pad.pad_index != pad_index)
@@ -1143,6 +1314,7 @@ void InputManager::SetPadVibrationIntensity(u32 pad_index, float large_or_single
 
 void InputManager::PauseVibration()
 {
+  std::lock_guard<std::mutex> lock(s_input_source_lock);
   for (PadVibrationBinding& binding : s_pad_vibration_array)
   {
     for (u32 motor_index = 0; motor_index < MAX_MOTORS_PER_PAD; motor_index++)
@@ -1160,6 +1332,8 @@ void InputManager::PauseVibration()
 
 void InputManager::UpdateContinuedVibration()
 {
+  std::lock_guard<std::mutex> lock(s_input_source_lock);
+
   // update vibration intensities, so if the game does a long effect, it continues
   const u64 current_time = Common::Timer::GetCurrentValue();
   for (PadVibrationBinding& pad : s_pad_vibration_array)
@@ -1355,7 +1529,7 @@ void InputManager::ReloadBindings(SettingsInterface& si, SettingsInterface& bind
 
   std::unique_lock lock(s_binding_map_write_lock);
 
-  s_binding_map.clear();
+  s_bindings.clear();
   s_pad_vibration_array.clear();
 
   // Hotkeys use the base configuration, except if the custom hotkeys option is enabled.
@@ -1375,6 +1549,8 @@ void InputManager::ReloadBindings(SettingsInterface& si, SettingsInterface& bind
     LoadMacroButtonConfig(binding_si, section, pad, cinfo);
   }
 
+  RebuildBindingTable();
+
   for (u32 axis = 0; axis < static_cast<u32>(InputPointerAxis::Count); axis++)
   {
     // From lilypad: 1 mouse pixel = 1/8th way down.
@@ -1392,6 +1568,8 @@ void InputManager::ReloadBindings(SettingsInterface& si, SettingsInterface& bind
 
 void InputManager::CloseSources()
 {
+  StopInputThread();
+
   for (u32 i = FIRST_EXTERNAL_INPUT_SOURCE; i < LAST_EXTERNAL_INPUT_SOURCE; i++)
   {
     if (s_input_sources[i])
@@ -1402,13 +1580,22 @@ void InputManager::CloseSources()
   }
 }
 
-void InputManager::PollSources()
+void InputManager::PollSourceEvents()
 {
   for (u32 i = FIRST_EXTERNAL_INPUT_SOURCE; i < LAST_EXTERNAL_INPUT_SOURCE; i++)
   {
     if (s_input_sources[i])
       s_input_sources[i]->PollEvents();
   }
+}
+
+bool InputManager::PollSources()
+{
+  const u32 prev_event_count = s_dispatched_event_count;
+  if (s_input_thread_running.load(std::memory_order_relaxed))
+    ProcessQueuedEvents();
+  else
+    PollSourceEvents();
 
   GenerateRelativeMouseEvents();
 
@@ -1418,10 +1605,109 @@ void InputManager::PollSources()
     if (!s_pad_vibration_array.empty())
       UpdateContinuedVibration();
   }
+
+  return (s_dispatched_event_count != prev_event_count);
+}
+
+void InputManager::StartInputThread()
+{
+  if (s_input_thread.joinable())
+    return;
+
+  Log_InfoPrintf("Starting input polling thread.");
+  s_input_thread_running.store(true);
+  s_input_thread = std::thread(&InputManager::InputThreadEntryPoint);
+}
+
+void InputManager::StopInputThread()
+{
+  if (!s_input_thread.joinable())
+    return;
+
+  s_input_thread_running.store(false);
+  s_input_thread.join();
+
+  // don't lose anything which was polled after the last frame
+  ProcessQueuedEvents();
+}
+
+void InputManager::InputThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Input Polling");
+  s_is_input_thread = true;
+
+  const Common::Timer::Value interval =
+    Common::Timer::ConvertNanosecondsToValue(static_cast<double>(INPUT_THREAD_POLL_INTERVAL_US) * 1000.0);
+  Common::Timer::Value next_poll_time = Common::Timer::GetCurrentValue();
+  while (s_input_thread_running.load(std::memory_order_relaxed))
+  {
+    {
+      std::lock_guard<std::mutex> lock(s_input_source_lock);
+      PollSourceEvents();
+    }
+
+    // don't try to catch up if we were descheduled, just poll again as soon as possible
+    const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
+    next_poll_time = std::max(next_poll_time + interval, current_time);
+    Common::Timer::SleepUntil(next_poll_time, false);
+  }
+
+  s_is_input_thread = false;
+}
+
+bool InputManager::QueueEvent(InputBindingKey key, float value, GenericInputBinding generic_key)
+{
+  // single producer and consumer, so the positions are enough to synchronize
+  const u32 write_pos = s_input_event_queue_write_pos.load(std::memory_order_relaxed);
+  if ((write_pos - s_input_event_queue_read_pos.load(std::memory_order_acquire)) == INPUT_EVENT_QUEUE_SIZE)
+  {
+    // the CPU thread isn't pumping messages, waiting would hold up the source lock
+    Log_WarningPrintf("Input event queue is full, dropping event.");
+    return false;
+  }
+
+  s_input_event_queue[write_pos & INPUT_EVENT_QUEUE_MASK] = QueuedInputEvent{key, value, generic_key};
+  s_input_event_queue_write_pos.store(write_pos + 1, std::memory_order_release);
+  return true;
+}
+
+void InputManager::ProcessQueuedEvents()
+{
+  for (const QueuedInputEvent& event : s_latched_input_events)
+    InvokeEventsForPass(event.key, event.value, event.generic_key, EventPass::OtherBindings);
+  s_latched_input_events.clear();
+
+  const u32 write_pos = s_input_event_queue_write_pos.load(std::memory_order_acquire);
+  u32 read_pos = s_input_event_queue_read_pos.load(std::memory_order_relaxed);
+  for (; read_pos != write_pos; read_pos++)
+  {
+    const QueuedInputEvent& event = s_input_event_queue[read_pos & INPUT_EVENT_QUEUE_MASK];
+    InvokeEvents(event.key, event.value, event.generic_key);
+  }
+
+  s_input_event_queue_read_pos.store(read_pos, std::memory_order_release);
+}
+
+void InputManager::LatchPadInput()
+{
+  if (!s_late_latching_enabled)
+    return;
+
+  const u32 write_pos = s_input_event_queue_write_pos.load(std::memory_order_acquire);
+  u32 read_pos = s_input_event_queue_read_pos.load(std::memory_order_relaxed);
+  for (; read_pos != write_pos; read_pos++)
+  {
+    const QueuedInputEvent& event = s_input_event_queue[read_pos & INPUT_EVENT_QUEUE_MASK];
+    InvokeEventsForPass(event.key, event.value, event.generic_key, EventPass::PadBindings);
+    s_latched_input_events.push_back(event);
+  }
+
+  s_input_event_queue_read_pos.store(read_pos, std::memory_order_release);
 }
 
 std::vector<std::pair<std::string, std::string>> InputManager::EnumerateDevices()
 {
+  std::lock_guard<std::mutex> lock(s_input_source_lock);
   std::vector<std::pair<std::string, std::string>> ret;
 
   ret.emplace_back("Keyboard", "Keyboard");
@@ -1444,6 +1730,7 @@ std::vector<std::pair<std::string, std::string>> InputManager::EnumerateDevices(
 
 std::vector<InputBindingKey> InputManager::EnumerateMotors()
 {
+  std::lock_guard<std::mutex> lock(s_input_source_lock);
   std::vector<InputBindingKey> ret;
 
   for (u32 i = FIRST_EXTERNAL_INPUT_SOURCE; i < LAST_EXTERNAL_INPUT_SOURCE; i++)
@@ -1506,6 +1793,7 @@ GenericInputBindingMapping InputManager::GetGenericBindingMapping(const std::str
 
   if (!GetInternalGenericBindingMapping(device, &mapping))
   {
+    std::lock_guard<std::mutex> lock(s_input_source_lock);
     for (u32 i = FIRST_EXTERNAL_INPUT_SOURCE; i < LAST_EXTERNAL_INPUT_SOURCE; i++)
     {
       if (s_input_sources[i] && s_input_sources[i]->GetGenericBindingMapping(device, &mapping))
@@ -1551,6 +1839,9 @@ static void UpdateInputSourceState(SettingsInterface& si, std::unique_lock<std::
 
 void InputManager::ReloadSources(SettingsInterface& si, std::unique_lock<std::mutex>& settings_lock)
 {
+  // sources are created and destroyed here, so they can't be polled at the same time
+  StopInputThread();
+
 #ifdef _WIN32
   UpdateInputSourceState(si, settings_lock, InputSourceType::DInput, &InputSource::CreateDInputSource, false);
   UpdateInputSourceState(si, settings_lock, InputSourceType::XInput, &InputSource::CreateXInputSource, false);
@@ -1565,4 +1856,9 @@ void InputManager::ReloadSources(SettingsInterface& si, std::unique_lock<std::mu
 #ifdef __ANDROID__
   UpdateInputSourceState(si, settings_lock, InputSourceType::Android, &InputSource::CreateAndroidSource, true);
 #endif
+
+  // latching needs the events to be queued, otherwise the sources would fire hotkeys in the middle of a frame
+  s_late_latching_enabled = si.GetBoolValue("InputSources", "LateLatching", false);
+  if (s_late_latching_enabled || si.GetBoolValue("InputSources", "PollingThread", false))
+    StartInputThread();
 }
@@ -224,7 +224,13 @@ void ReloadSources(SettingsInterface& si, std::unique_lock<std::mutex>& settings
 void CloseSources();
 
 /// Polls input sources for events (e.g. external controllers).
-void PollSources();
+/// When the polling thread is enabled, processes the events it has queued since the last call instead.
+/// Returns true if any events were dispatched, so idle loops know there's something to redraw.
+bool PollSources();
+
+/// Applies queued events to the pad bindings when late latching is enabled, called when the game reads the pads.
+/// Every other binding is left until the next PollSources().
+void LatchPadInput();
 
 /// Returns true if any bindings exist for the specified key.
 /// Can be safely called on another thread.
@@ -238,7 +244,8 @@ bool HasAnyBindingsForSource(InputBindingKey key);
 bool ParseBindingAndGetSource(const std::string_view& binding, InputBindingKey* key, InputSource** source);
 
 /// Externally adds a fixed binding. Be sure to call *after* ReloadBindings() otherwise it will be lost.
-void AddBinding(const std::string_view& binding, const InputEventHandler& handler);
+/// Pad bindings only update controller state, so they can be fired while a frame is being emulated.
+void AddBinding(const std::string_view& binding, const InputEventHandler& handler, bool pad_binding = false);
 
 /// Adds an external vibration binding.
 void AddVibrationBinding(u32 pad_index, const InputBindingKey* motor_0_binding, InputSource* motor_0_source,
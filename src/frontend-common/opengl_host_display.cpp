@@ -1,13 +1,17 @@
 #include "opengl_host_display.h"
 #include "common/align.h"
 #include "common/assert.h"
+#include "common/gl/shader_cache.h"
 #include "common/log.h"
 #include "common/string_util.h"
 #include "common_host.h"
+#include "core/settings.h"
+#include "core/shader_cache_version.h"
 #include "imgui.h"
 #include "imgui_impl_opengl3.h"
 #include "postprocessing_shadergen.h"
 #include <array>
+#include <cstring>
 #include <tuple>
 Log_SetChannel(OpenGLHostDisplay);
 
@@ -170,6 +174,49 @@ bool OpenGLHostDisplay::UpdateTexture(GPUTexture* texture, u32 x, u32 y, u32 wid
   return true;
 }
 
+bool OpenGLHostDisplay::BeginTextureFieldUpdate(GPUTexture* texture, u32 width, u32 height, u32 field,
+                                                void** out_buffer, u32* out_pitch)
+{
+  // GL textures keep their contents, so only the rows of this field need to be uploaded.
+  return BeginTextureUpdate(texture, width, height / 2, out_buffer, out_pitch);
+}
+
+void OpenGLHostDisplay::EndTextureFieldUpdate(GPUTexture* texture, u32 width, u32 height, u32 field)
+{
+  const u32 pixel_size = texture->GetPixelSize();
+  const u32 stride = Common::AlignUpPow2(width * pixel_size, 4);
+  const u32 rows = height / 2;
+  const u32 size_required = stride * rows;
+  GL::Texture* gl_texture = static_cast<GL::Texture*>(texture);
+  GL::StreamBuffer* buffer = UsePBOForUploads() ? GetTextureStreamBuffer() : nullptr;
+
+  const auto [gl_internal_format, gl_format, gl_type] = GL::Texture::GetPixelFormatMapping(gl_texture->GetFormat());
+
+  gl_texture->Bind();
+  if (buffer && size_required < buffer->GetSize())
+  {
+    buffer->Unmap(size_required);
+    buffer->Bind();
+
+    for (u32 row = 0; row < rows; row++)
+    {
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, (row * 2) + field, width, 1, gl_format, gl_type,
+                      reinterpret_cast<void*>(static_cast<uintptr_t>(m_texture_stream_buffer_offset + row * stride)));
+    }
+
+    buffer->Unbind();
+  }
+  else
+  {
+    const u8* data = GetTextureRepackBuffer().data();
+    for (u32 row = 0; row < rows; row++)
+    {
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, (row * 2) + field, width, 1, gl_format, gl_type, data);
+      data += stride;
+    }
+  }
+}
+
 bool OpenGLHostDisplay::DownloadTexture(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height, void* out_data,
                                         u32 out_data_stride)
 {
@@ -586,6 +633,7 @@ void OpenGLHostDisplay::DestroyResources()
 {
   m_post_processing_chain.ClearStages();
   m_post_processing_input_texture.Destroy();
+  m_post_processing_output_texture.Destroy();
   m_post_processing_ubo.reset();
   m_post_processing_stages.clear();
 
@@ -605,6 +653,8 @@ void OpenGLHostDisplay::DestroyResources()
     m_display_nearest_sampler = 0;
   }
 
+  DestroyScreenshotReadback();
+
   m_cursor_program.Destroy();
   m_display_program.Destroy();
 }
@@ -616,6 +666,13 @@ bool OpenGLHostDisplay::Render(bool skip_present)
     if (ImGui::GetCurrentContext())
       ImGui::Render();
 
+    // Headless never gets to the swap below, so the frame's GPU time has to be collected here instead.
+    if (!skip_present && m_gpu_timing_enabled)
+    {
+      PopTimestampQuery();
+      KickTimestampQuery();
+    }
+
     return false;
   }
 
@@ -684,6 +741,122 @@ bool OpenGLHostDisplay::RenderScreenshot(u32 width, u32 height, std::vector<u32>
   return true;
 }
 
+bool OpenGLHostDisplay::BeginScreenshotReadback(u32 width, u32 height)
+{
+  // without pack buffers and fences, there's nothing to wait on later
+  if (m_use_gles2_draw_path || !(GLAD_GL_VERSION_3_2 || GLAD_GL_ES_VERSION_3_0 || GLAD_GL_ARB_sync))
+    return HostDisplay::BeginScreenshotReadback(width, height);
+
+  if (m_screenshot_readback_fence)
+  {
+    glDeleteSync(m_screenshot_readback_fence);
+    m_screenshot_readback_fence = nullptr;
+  }
+
+  if (m_screenshot_readback_texture.GetWidth() != width || m_screenshot_readback_texture.GetHeight() != height)
+  {
+    m_screenshot_readback_texture.Destroy();
+    if (!m_screenshot_readback_texture.Create(width, height, 1, 1, 1, GPUTexture::Format::RGBA8, nullptr, 0) ||
+        !m_screenshot_readback_texture.CreateFramebuffer())
+    {
+      m_screenshot_readback_texture.Destroy();
+      return false;
+    }
+  }
+
+  glDisable(GL_SCISSOR_TEST);
+  m_screenshot_readback_texture.BindFramebuffer(GL_FRAMEBUFFER);
+  glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  m_screenshot_readback_flip = false;
+  if (HasDisplayTexture())
+  {
+    const auto [left, top, draw_width, draw_height] = CalculateDrawRect(width, height, 0);
+
+    if (!m_post_processing_chain.IsEmpty())
+    {
+      ApplyPostProcessingChain(m_screenshot_readback_texture.GetGLFramebufferID(), left, height - top - draw_height,
+                               draw_width, draw_height, static_cast<GL::Texture*>(m_display_texture),
+                               m_display_texture_view_x, m_display_texture_view_y, m_display_texture_view_width,
+                               m_display_texture_view_height, width, height);
+      m_screenshot_readback_flip = true;
+    }
+    else
+    {
+      // drawn upside down, so the rows come back top first
+      RenderDisplay(left, top, draw_width, draw_height, static_cast<GL::Texture*>(m_display_texture),
+                    m_display_texture_view_x, m_display_texture_view_y + m_display_texture_view_height,
+                    m_display_texture_view_width, -m_display_texture_view_height, IsUsingLinearFiltering());
+    }
+  }
+
+  if (m_screenshot_readback_buffer == 0)
+    glGenBuffers(1, &m_screenshot_readback_buffer);
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, m_screenshot_readback_buffer);
+  glBufferData(GL_PIXEL_PACK_BUFFER, width * height * sizeof(u32), nullptr, GL_STREAM_READ);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  m_screenshot_readback_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  return (m_screenshot_readback_fence != nullptr);
+}
+
+bool OpenGLHostDisplay::FinishScreenshotReadback(std::vector<u32>* out_pixels, u32* out_stride,
+                                                 GPUTexture::Format* out_format)
+{
+  if (!m_screenshot_readback_fence)
+    return HostDisplay::FinishScreenshotReadback(out_pixels, out_stride, out_format);
+
+  glClientWaitSync(m_screenshot_readback_fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+  glDeleteSync(m_screenshot_readback_fence);
+  m_screenshot_readback_fence = nullptr;
+
+  const u32 width = m_screenshot_readback_texture.GetWidth();
+  const u32 height = m_screenshot_readback_texture.GetHeight();
+  const u32 stride = width * sizeof(u32);
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, m_screenshot_readback_buffer);
+  const void* map = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, stride * height, GL_MAP_READ_BIT);
+  if (map)
+  {
+    out_pixels->resize(width * height);
+    std::memcpy(out_pixels->data(), map, stride * height);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  if (!map)
+  {
+    Log_ErrorPrint("Failed to map screenshot readback buffer");
+    return false;
+  }
+
+  // the post-processing chain can't draw flipped, so these are done here
+  if (m_screenshot_readback_flip)
+    GPUTexture::FlipTextureDataRGBA8(width, height, *out_pixels, stride);
+
+  *out_stride = stride;
+  *out_format = GPUTexture::Format::RGBA8;
+  return true;
+}
+
+void OpenGLHostDisplay::DestroyScreenshotReadback()
+{
+  if (m_screenshot_readback_fence)
+  {
+    glDeleteSync(m_screenshot_readback_fence);
+    m_screenshot_readback_fence = nullptr;
+  }
+  if (m_screenshot_readback_buffer != 0)
+  {
+    glDeleteBuffers(1, &m_screenshot_readback_buffer);
+    m_screenshot_readback_buffer = 0;
+  }
+  m_screenshot_readback_texture.Destroy();
+}
+
 void OpenGLHostDisplay::RenderImGui()
 {
   ImGui::Render();
@@ -817,6 +990,7 @@ bool OpenGLHostDisplay::SetPostProcessingChain(const std::string_view& config)
   if (config.empty())
   {
     m_post_processing_input_texture.Destroy();
+    m_post_processing_output_texture.Destroy();
     m_post_processing_stages.clear();
     m_post_processing_chain.ClearStages();
     return true;
@@ -827,6 +1001,11 @@ bool OpenGLHostDisplay::SetPostProcessingChain(const std::string_view& config)
 
   m_post_processing_stages.clear();
 
+  // GL objects can't be created off the context's thread, but linking from a cached binary avoids most of the cost
+  GL::ShaderCache shader_cache;
+  shader_cache.Open(m_gl_context->IsGLES(), EmuFolders::Cache, SHADER_CACHE_VERSION,
+                    static_cast<u64>(g_settings.gpu_shader_cache_size_limit) * 1024 * 1024);
+
   FrontendCommon::PostProcessingShaderGen shadergen(GetRenderAPI(), false);
 
   for (u32 i = 0; i < m_post_processing_chain.GetStageCount(); i++)
@@ -835,9 +1014,8 @@ bool OpenGLHostDisplay::SetPostProcessingChain(const std::string_view& config)
     const std::string vs = shadergen.GeneratePostProcessingVertexShader(shader);
     const std::string ps = shadergen.GeneratePostProcessingFragmentShader(shader);
 
-    PostProcessingStage stage;
-    stage.uniforms_size = shader.GetUniformsSize();
-    if (!stage.program.Compile(vs, {}, ps))
+    std::optional<GL::Program> prog = shader_cache.GetProgram(vs, {}, ps);
+    if (!prog)
     {
       Log_InfoPrintf("Failed to compile post-processing program, disabling.");
       m_post_processing_stages.clear();
@@ -847,19 +1025,14 @@ bool OpenGLHostDisplay::SetPostProcessingChain(const std::string_view& config)
 
     if (!shadergen.UseGLSLBindingLayout())
     {
-      stage.program.BindUniformBlock("UBOBlock", 1);
-      stage.program.Bind();
-      stage.program.Uniform1i("samp0", 0);
-    }
-
-    if (!stage.program.Link())
-    {
-      Log_InfoPrintf("Failed to link post-processing program, disabling.");
-      m_post_processing_stages.clear();
-      m_post_processing_chain.ClearStages();
-      return false;
+      prog->BindUniformBlock("UBOBlock", 1);
+      prog->Bind();
+      prog->Uniform1i("samp0", 0);
     }
 
+    PostProcessingStage stage;
+    stage.program = std::move(*prog);
+    stage.uniforms_size = shader.GetUniformsSize();
     m_post_processing_stages.push_back(std::move(stage));
   }
 
@@ -894,17 +1067,14 @@ bool OpenGLHostDisplay::CheckPostProcessingRenderTargets(u32 target_width, u32 t
     }
   }
 
-  const u32 target_count = (static_cast<u32>(m_post_processing_stages.size()) - 1);
-  for (u32 i = 0; i < target_count; i++)
+  // only needed when there is more than one stage, the final stage writes to the target
+  if (m_post_processing_stages.size() > 1 && (m_post_processing_output_texture.GetWidth() != target_width ||
+                                              m_post_processing_output_texture.GetHeight() != target_height))
   {
-    PostProcessingStage& pps = m_post_processing_stages[i];
-    if (pps.output_texture.GetWidth() != target_width || pps.output_texture.GetHeight() != target_height)
+    if (!m_post_processing_output_texture.Create(target_width, target_height, 1, 1, 1, GPUTexture::Format::RGBA8) ||
+        !m_post_processing_output_texture.CreateFramebuffer())
     {
-      if (!pps.output_texture.Create(target_width, target_height, 1, 1, 1, GPUTexture::Format::RGBA8) ||
-          !pps.output_texture.CreateFramebuffer())
-      {
-        return false;
-      }
+      return false;
     }
   }
 
@@ -941,13 +1111,17 @@ void OpenGLHostDisplay::ApplyPostProcessingChain(GLuint final_target, s32 final_
   for (u32 i = 0; i < static_cast<u32>(m_post_processing_stages.size()); i++)
   {
     PostProcessingStage& pps = m_post_processing_stages[i];
+
+    // each stage only reads the previous stage's output, so two intermediate textures are enough
+    GL::Texture* output_texture = (texture == &m_post_processing_input_texture) ? &m_post_processing_output_texture :
+                                                                                  &m_post_processing_input_texture;
     if (i == final_stage)
     {
       glBindFramebuffer(GL_DRAW_FRAMEBUFFER, final_target);
     }
     else
     {
-      pps.output_texture.BindFramebuffer(GL_DRAW_FRAMEBUFFER);
+      output_texture->BindFramebuffer(GL_DRAW_FRAMEBUFFER);
       glClear(GL_COLOR_BUFFER_BIT);
     }
 
@@ -967,7 +1141,7 @@ void OpenGLHostDisplay::ApplyPostProcessingChain(GLuint final_target, s32 final_
     glDrawArrays(GL_TRIANGLES, 0, 3);
 
     if (i != final_stage)
-      texture = &pps.output_texture;
+      texture = output_texture;
   }
 
   glBindSampler(0, 0);
@@ -980,7 +1154,6 @@ void OpenGLHostDisplay::CreateTimestampQueries()
   const auto GenQueries = gles ? glGenQueriesEXT : glGenQueries;
 
   GenQueries(static_cast<u32>(m_timestamp_queries.size()), m_timestamp_queries.data());
-  KickTimestampQuery();
 }
 
 void OpenGLHostDisplay::DestroyTimestampQueries()
@@ -46,6 +46,9 @@ public:
   bool BeginTextureUpdate(GPUTexture* texture, u32 width, u32 height, void** out_buffer, u32* out_pitch) override;
   void EndTextureUpdate(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height) override;
   bool UpdateTexture(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height, const void* data, u32 pitch) override;
+  bool BeginTextureFieldUpdate(GPUTexture* texture, u32 width, u32 height, u32 field, void** out_buffer,
+                               u32* out_pitch) override;
+  void EndTextureFieldUpdate(GPUTexture* texture, u32 width, u32 height, u32 field) override;
   bool DownloadTexture(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height, void* out_data,
                        u32 out_data_stride) override;
   bool SupportsTextureFormat(GPUTexture::Format format) const override;
@@ -55,6 +58,8 @@ public:
   bool Render(bool skip_present) override;
   bool RenderScreenshot(u32 width, u32 height, std::vector<u32>* out_pixels, u32* out_stride,
                         GPUTexture::Format* out_format) override;
+  bool BeginScreenshotReadback(u32 width, u32 height) override;
+  bool FinishScreenshotReadback(std::vector<u32>* out_pixels, u32* out_stride, GPUTexture::Format* out_format) override;
 
   bool SetGPUTimingEnabled(bool enabled) override;
   float GetAndResetAccumulatedGPUTime() override;
@@ -90,7 +95,6 @@ protected:
   struct PostProcessingStage
   {
     GL::Program program;
-    GL::Texture output_texture;
     u32 uniforms_size;
   };
 
@@ -99,6 +103,8 @@ protected:
                                 GL::Texture* texture, s32 texture_view_x, s32 texture_view_y, s32 texture_view_width,
                                 s32 texture_view_height, u32 target_width, u32 target_height);
 
+  void DestroyScreenshotReadback();
+
   void CreateTimestampQueries();
   void DestroyTimestampQueries();
   void PopTimestampQuery();
@@ -119,9 +125,16 @@ protected:
 
   FrontendCommon::PostProcessingChain m_post_processing_chain;
   GL::Texture m_post_processing_input_texture;
+  GL::Texture m_post_processing_output_texture; // intermediate stages ping-pong between this and the input texture
   std::unique_ptr<GL::StreamBuffer> m_post_processing_ubo;
   std::vector<PostProcessingStage> m_post_processing_stages;
 
+  // screenshots read back through a pack buffer, which is only mapped once the fence has signalled
+  GL::Texture m_screenshot_readback_texture;
+  GLuint m_screenshot_readback_buffer = 0;
+  GLsync m_screenshot_readback_fence = nullptr;
+  bool m_screenshot_readback_flip = false;
+
   std::array<GLuint, NUM_TIMESTAMP_QUERIES> m_timestamp_queries = {};
   float m_accumulated_gpu_time = 0.0f;
   u8 m_read_timestamp_query = 0;
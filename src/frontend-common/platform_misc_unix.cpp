@@ -2,13 +2,13 @@
 #include "common/string.h"
 #include "platform_misc.h"
 #include <cinttypes>
+#include <spawn.h>
+#include <unistd.h>
 Log_SetChannel(FrontendCommon);
 
 #ifdef USE_X11
 #include <cstdio>
-#include <spawn.h>
 #include <sys/wait.h>
-#include <unistd.h>
 
 static bool SetScreensaverInhibitX11(bool inhibit, const WindowInfo& wi)
 {
@@ -11,10 +11,12 @@
 #include "common/vulkan/swap_chain.h"
 #include "common/vulkan/util.h"
 #include "common_host.h"
+#include "core/settings.h"
 #include "core/shader_cache_version.h"
 #include "imgui.h"
 #include "imgui_impl_vulkan.h"
 #include "postprocessing_shadergen.h"
+#include <algorithm>
 #include <array>
 Log_SetChannel(VulkanHostDisplay);
 
@@ -100,6 +102,9 @@ bool VulkanHostDisplay::ChangeRenderWindow(const WindowInfo& new_wi)
 
 void VulkanHostDisplay::ResizeRenderWindow(s32 new_window_width, s32 new_window_height)
 {
+  if (!m_swap_chain)
+    return;
+
   g_vulkan_context->WaitForGPUIdle();
 
   if (!m_swap_chain->ResizeSwapChain(new_window_width, new_window_height))
@@ -211,14 +216,15 @@ void VulkanHostDisplay::SetVSync(bool enabled)
 
   // This swap chain should not be used by the current buffer, thus safe to destroy.
   g_vulkan_context->WaitForGPUIdle();
-  m_swap_chain->SetVSync(enabled);
+  m_swap_chain->SetVSync(enabled, g_settings.video_sync_relaxed);
 }
 
 bool VulkanHostDisplay::CreateRenderDevice(const WindowInfo& wi, std::string_view adapter_name, bool debug_device,
                                            bool threaded_presentation)
 {
   WindowInfo local_wi(wi);
-  if (!Vulkan::Context::Create(adapter_name, &local_wi, &m_swap_chain, threaded_presentation, debug_device, false))
+  if (!Vulkan::Context::Create(adapter_name, &local_wi, &m_swap_chain, threaded_presentation, debug_device, false,
+                               g_settings.gpu_max_frames_in_flight))
   {
     Log_ErrorPrintf("Failed to create Vulkan context");
     m_window_info = {};
@@ -253,6 +259,11 @@ bool VulkanHostDisplay::HasRenderSurface() const
   return static_cast<bool>(m_swap_chain);
 }
 
+VkFormat VulkanHostDisplay::GetDisplayTextureFormat() const
+{
+  return m_swap_chain ? m_swap_chain->GetTextureFormat() : VK_FORMAT_R8G8B8A8_UNORM;
+}
+
 VkRenderPass VulkanHostDisplay::GetRenderPassForDisplay() const
 {
   if (m_swap_chain)
@@ -435,6 +446,8 @@ void main()
 
   Vulkan::DescriptorSetLayoutBuilder dslbuilder;
   dslbuilder.AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+  if (g_vulkan_context->SupportsPushDescriptors())
+    dslbuilder.SetPushFlag();
   m_descriptor_set_layout = dslbuilder.Create(device);
   if (m_descriptor_set_layout == VK_NULL_HANDLE)
     return false;
@@ -447,6 +460,8 @@ void main()
     return false;
 
   dslbuilder.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+  if (g_vulkan_context->SupportsPushDescriptors())
+    dslbuilder.SetPushFlag();
   m_post_process_descriptor_set_layout = dslbuilder.Create(device);
   if (m_post_process_descriptor_set_layout == VK_NULL_HANDLE)
     return false;
@@ -528,6 +543,8 @@ void VulkanHostDisplay::DestroyResources()
   Vulkan::Util::SafeDestroyDescriptorSetLayout(m_post_process_ubo_descriptor_set_layout);
   m_post_processing_input_texture.Destroy(false);
   Vulkan::Util::SafeDestroyFramebuffer(m_post_processing_input_framebuffer);
+  m_post_processing_output_texture.Destroy(false);
+  Vulkan::Util::SafeDestroyFramebuffer(m_post_processing_output_framebuffer);
   m_post_processing_stages.clear();
   m_post_processing_ubo.Destroy(true);
   m_post_processing_chain.ClearStages();
@@ -542,7 +559,7 @@ void VulkanHostDisplay::DestroyResources()
 
 bool VulkanHostDisplay::CreateImGuiContext()
 {
-  return ImGui_ImplVulkan_Init(m_swap_chain->GetClearRenderPass());
+  return ImGui_ImplVulkan_Init(GetRenderPassForDisplay());
 }
 
 void VulkanHostDisplay::DestroyImGuiContext()
@@ -575,6 +592,14 @@ bool VulkanHostDisplay::Render(bool skip_present)
     if (ImGui::GetCurrentContext())
       ImGui::Render();
 
+    // Headless, nothing is ever presented, but the frame's rendering still has to be submitted, otherwise it would
+    // pile up in one command buffer until something forced a flush.
+    if (!skip_present)
+    {
+      g_vulkan_context->SetGPUTimingSection(Vulkan::Context::NO_GPU_TIMING_SECTION);
+      g_vulkan_context->ExecuteCommandBuffer(false);
+    }
+
     return false;
   }
 
@@ -623,7 +648,9 @@ bool VulkanHostDisplay::Render(bool skip_present)
     swap_chain_texture.OverrideImageLayout(VK_IMAGE_LAYOUT_UNDEFINED);
     swap_chain_texture.TransitionToLayout(cmdbuffer, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 
+    g_vulkan_context->SetGPUTimingSection(static_cast<u32>(GPUTimingSection::Display));
     RenderDisplay();
+    g_vulkan_context->SetGPUTimingSection(static_cast<u32>(GPUTimingSection::Display));
 
     if (ImGui::GetCurrentContext())
       RenderImGui();
@@ -636,6 +663,7 @@ bool VulkanHostDisplay::Render(bool skip_present)
     swap_chain_texture.TransitionToLayout(cmdbuffer, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
   }
 
+  g_vulkan_context->SetGPUTimingSection(Vulkan::Context::NO_GPU_TIMING_SECTION);
   g_vulkan_context->SubmitCommandBuffer(m_swap_chain->GetImageAvailableSemaphore(),
                                         m_swap_chain->GetRenderingFinishedSemaphore(), m_swap_chain->GetSwapChain(),
                                         m_swap_chain->GetCurrentImageIndex(), !m_swap_chain->IsVSyncEnabled());
@@ -647,11 +675,7 @@ bool VulkanHostDisplay::Render(bool skip_present)
 bool VulkanHostDisplay::RenderScreenshot(u32 width, u32 height, std::vector<u32>* out_pixels, u32* out_stride,
                                          GPUTexture::Format* out_format)
 {
-  // in theory we could do this without a swap chain, but postprocessing assumes it for now...
-  if (!m_swap_chain)
-    return false;
-
-  const VkFormat format = m_swap_chain ? m_swap_chain->GetTextureFormat() : VK_FORMAT_R8G8B8A8_UNORM;
+  const VkFormat format = GetDisplayTextureFormat();
   switch (format)
   {
     case VK_FORMAT_R8G8B8A8_UNORM:
@@ -699,10 +723,7 @@ bool VulkanHostDisplay::RenderScreenshot(u32 width, u32 height, std::vector<u32>
     return false;
   }
 
-  const VkRenderPass rp =
-    m_swap_chain ?
-      m_swap_chain->GetClearRenderPass() :
-      g_vulkan_context->GetRenderPass(format, VK_FORMAT_UNDEFINED, VK_SAMPLE_COUNT_1_BIT, VK_ATTACHMENT_LOAD_OP_CLEAR);
+  const VkRenderPass rp = GetRenderPassForDisplay();
   if (!rp)
     return false;
 
@@ -746,7 +767,7 @@ void VulkanHostDisplay::BeginSwapChainRenderPass(VkFramebuffer framebuffer, u32
   const VkClearValue clear_value = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
   const VkRenderPassBeginInfo rp = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
                                     nullptr,
-                                    m_swap_chain->GetClearRenderPass(),
+                                    GetRenderPassForDisplay(),
                                     framebuffer,
                                     {{0, 0}, {width, height}},
                                     1u,
@@ -793,20 +814,14 @@ void VulkanHostDisplay::RenderDisplay(s32 left, s32 top, s32 width, s32 height,
     cmdbuffer, "VulkanHostDisplay::RenderDisplay: {%u,%u} %ux%u | %ux%u | {%u,%u} %ux%u", left, top, width, height,
     texture->GetWidth(), texture->GetHeight(), texture_view_x, texture_view_y, texture_view_width, texture_view_height);
 
-  VkDescriptorSet ds = g_vulkan_context->AllocateDescriptorSet(m_descriptor_set_layout);
-  if (ds == VK_NULL_HANDLE)
+  const VkSampler sampler = linear_filter ? m_linear_sampler : m_point_sampler;
+  if (!g_vulkan_context->BindImageSamplerDescriptor(cmdbuffer, m_pipeline_layout, m_descriptor_set_layout, 0,
+                                                    texture->GetView(), sampler, texture->GetLayout()))
   {
     Log_ErrorPrintf("Skipping rendering display because of no descriptor set");
     return;
   }
 
-  {
-    Vulkan::DescriptorSetUpdateBuilder dsupdate;
-    dsupdate.AddCombinedImageSamplerDescriptorWrite(
-      ds, 0, texture->GetView(), linear_filter ? m_linear_sampler : m_point_sampler, texture->GetLayout());
-    dsupdate.Update(g_vulkan_context->GetDevice());
-  }
-
   const float position_adjust = IsUsingLinearFiltering() ? 0.5f : 0.0f;
   const float size_adjust = IsUsingLinearFiltering() ? 1.0f : 0.0f;
   const PushConstants pc{
@@ -817,7 +832,6 @@ void VulkanHostDisplay::RenderDisplay(s32 left, s32 top, s32 width, s32 height,
 
   vkCmdBindPipeline(cmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_display_pipeline);
   vkCmdPushConstants(cmdbuffer, m_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pc), &pc);
-  vkCmdBindDescriptorSets(cmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline_layout, 0, 1, &ds, 0, nullptr);
   Vulkan::Util::SetViewportAndScissor(cmdbuffer, left, top, width, height);
   vkCmdDraw(cmdbuffer, 3, 1, 0, 0);
 }
@@ -844,24 +858,17 @@ void VulkanHostDisplay::RenderSoftwareCursor(s32 left, s32 top, s32 width, s32 h
   const Vulkan::Util::DebugScope debugScope(cmdbuffer, "VulkanHostDisplay::RenderSoftwareCursor: {%u,%u} %ux%u", left,
                                             top, width, height);
 
-  VkDescriptorSet ds = g_vulkan_context->AllocateDescriptorSet(m_descriptor_set_layout);
-  if (ds == VK_NULL_HANDLE)
+  if (!g_vulkan_context->BindImageSamplerDescriptor(cmdbuffer, m_pipeline_layout, m_descriptor_set_layout, 0,
+                                                    static_cast<Vulkan::Texture*>(texture)->GetView(),
+                                                    m_linear_sampler))
   {
     Log_ErrorPrintf("Skipping rendering software cursor because of no descriptor set");
     return;
   }
 
-  {
-    Vulkan::DescriptorSetUpdateBuilder dsupdate;
-    dsupdate.AddCombinedImageSamplerDescriptorWrite(ds, 0, static_cast<Vulkan::Texture*>(texture)->GetView(),
-                                                    m_linear_sampler);
-    dsupdate.Update(g_vulkan_context->GetDevice());
-  }
-
   const PushConstants pc{0.0f, 0.0f, 1.0f, 1.0f};
   vkCmdBindPipeline(cmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_cursor_pipeline);
   vkCmdPushConstants(cmdbuffer, m_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(pc), &pc);
-  vkCmdBindDescriptorSets(cmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline_layout, 0, 1, &ds, 0, nullptr);
   Vulkan::Util::SetViewportAndScissor(cmdbuffer, left, top, width, height);
   vkCmdDraw(cmdbuffer, 3, 1, 0, 0);
 }
@@ -882,6 +889,20 @@ float VulkanHostDisplay::GetAndResetAccumulatedGPUTime()
   return g_vulkan_context->GetAndResetAccumulatedGPUTime();
 }
 
+float VulkanHostDisplay::GetAndResetAccumulatedFenceWaitTime()
+{
+  return g_vulkan_context->GetAndResetAccumulatedFenceWaitTime();
+}
+
+bool VulkanHostDisplay::GetAndResetAccumulatedGPUSectionTimes(GPUSectionTimes* times)
+{
+  static_assert(static_cast<size_t>(GPUTimingSection::Count) <= Vulkan::Context::MAX_GPU_TIMING_SECTIONS);
+
+  const Vulkan::Context::GPUSectionTimes section_times = g_vulkan_context->GetAndResetAccumulatedGPUSectionTimes();
+  std::copy_n(section_times.begin(), times->size(), times->begin());
+  return true;
+}
+
 HostDisplay::AdapterAndModeList VulkanHostDisplay::StaticGetAdapterAndModeList(const WindowInfo* wi)
 {
   AdapterAndModeList ret;
@@ -923,20 +944,14 @@ HostDisplay::AdapterAndModeList VulkanHostDisplay::StaticGetAdapterAndModeList(c
 }
 
 VulkanHostDisplay::PostProcessingStage::PostProcessingStage(PostProcessingStage&& move)
-  : pipeline(move.pipeline), output_framebuffer(move.output_framebuffer),
-    output_texture(std::move(move.output_texture)), uniforms_size(move.uniforms_size)
+  : pipeline(move.pipeline), uniforms_size(move.uniforms_size)
 {
-  move.output_framebuffer = VK_NULL_HANDLE;
   move.pipeline = VK_NULL_HANDLE;
   move.uniforms_size = 0;
 }
 
 VulkanHostDisplay::PostProcessingStage::~PostProcessingStage()
 {
-  if (output_framebuffer != VK_NULL_HANDLE)
-    g_vulkan_context->DeferFramebufferDestruction(output_framebuffer);
-
-  output_texture.Destroy(true);
   if (pipeline != VK_NULL_HANDLE)
     g_vulkan_context->DeferPipelineDestruction(pipeline);
 }
@@ -1041,7 +1056,7 @@ bool VulkanHostDisplay::CheckPostProcessingRenderTargets(u32 target_width, u32 t
       m_post_processing_input_framebuffer = VK_NULL_HANDLE;
     }
 
-    if (!m_post_processing_input_texture.Create(target_width, target_height, 1, 1, m_swap_chain->GetTextureFormat(),
+    if (!m_post_processing_input_texture.Create(target_width, target_height, 1, 1, GetDisplayTextureFormat(),
                                                 VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
                                                 VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT) ||
         (m_post_processing_input_framebuffer =
@@ -1057,32 +1072,30 @@ bool VulkanHostDisplay::CheckPostProcessingRenderTargets(u32 target_width, u32 t
                                 "Post Processing Input Texture Memory");
   }
 
-  const u32 target_count = (static_cast<u32>(m_post_processing_stages.size()) - 1);
-  for (u32 i = 0; i < target_count; i++)
+  // only needed when there is more than one stage, the final stage writes to the target
+  if (m_post_processing_stages.size() > 1 && (m_post_processing_output_texture.GetWidth() != target_width ||
+                                              m_post_processing_output_texture.GetHeight() != target_height))
   {
-    PostProcessingStage& pps = m_post_processing_stages[i];
-    if (pps.output_texture.GetWidth() != target_width || pps.output_texture.GetHeight() != target_height)
+    if (m_post_processing_output_framebuffer != VK_NULL_HANDLE)
     {
-      if (pps.output_framebuffer != VK_NULL_HANDLE)
-      {
-        g_vulkan_context->DeferFramebufferDestruction(pps.output_framebuffer);
-        pps.output_framebuffer = VK_NULL_HANDLE;
-      }
+      g_vulkan_context->DeferFramebufferDestruction(m_post_processing_output_framebuffer);
+      m_post_processing_output_framebuffer = VK_NULL_HANDLE;
+    }
 
-      if (!pps.output_texture.Create(target_width, target_height, 1, 1, m_swap_chain->GetTextureFormat(),
-                                     VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
-                                     VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT) ||
-          (pps.output_framebuffer = pps.output_texture.CreateFramebuffer(GetRenderPassForDisplay())) == VK_NULL_HANDLE)
-      {
-        return false;
-      }
-      Vulkan::Util::SetObjectName(g_vulkan_context->GetDevice(), pps.output_texture.GetImage(),
-                                  "Post Processing Output Texture %u", i);
-      Vulkan::Util::SetObjectName(g_vulkan_context->GetDevice(), pps.output_texture.GetAllocation(),
-                                  "Post Processing Output Texture Memory %u", i);
-      Vulkan::Util::SetObjectName(g_vulkan_context->GetDevice(), pps.output_texture.GetView(),
-                                  "Post Processing Output Texture View %u", i);
+    if (!m_post_processing_output_texture.Create(target_width, target_height, 1, 1, GetDisplayTextureFormat(),
+                                                 VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
+                                                 VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT) ||
+        (m_post_processing_output_framebuffer =
+           m_post_processing_output_texture.CreateFramebuffer(GetRenderPassForDisplay())) == VK_NULL_HANDLE)
+    {
+      return false;
     }
+    Vulkan::Util::SetObjectName(g_vulkan_context->GetDevice(), m_post_processing_output_texture.GetImage(),
+                                "Post Processing Output Texture");
+    Vulkan::Util::SetObjectName(g_vulkan_context->GetDevice(), m_post_processing_output_texture.GetView(),
+                                "Post Processing Output Texture View");
+    Vulkan::Util::SetObjectName(g_vulkan_context->GetDevice(), m_post_processing_output_texture.GetAllocation(),
+                                "Post Processing Output Texture Memory");
   }
 
   return true;
@@ -1119,6 +1132,8 @@ void VulkanHostDisplay::ApplyPostProcessingChain(VkFramebuffer target_fb, s32 fi
   texture_view_width = final_width;
   texture_view_height = final_height;
 
+  g_vulkan_context->SetGPUTimingSection(static_cast<u32>(GPUTimingSection::PostProcessing));
+
   const u32 final_stage = static_cast<u32>(m_post_processing_stages.size()) - 1u;
   for (u32 i = 0; i < static_cast<u32>(m_post_processing_stages.size()); i++)
   {
@@ -1126,10 +1141,16 @@ void VulkanHostDisplay::ApplyPostProcessingChain(VkFramebuffer target_fb, s32 fi
     const Vulkan::Util::DebugScope stage_scope(g_vulkan_context->GetCurrentCommandBuffer(), "Post Processing Stage: %s",
                                                m_post_processing_chain.GetShaderStage(i).GetName().c_str());
 
+    // each stage only reads the previous stage's output, so two intermediate textures are enough
+    const bool output_to_input = (texture != &m_post_processing_input_texture);
+    Vulkan::Texture* output_texture = output_to_input ? &m_post_processing_input_texture :
+                                                        &m_post_processing_output_texture;
     if (i != final_stage)
     {
-      pps.output_texture.TransitionToLayout(cmdbuffer, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-      BeginSwapChainRenderPass(pps.output_framebuffer, target_width, target_height);
+      output_texture->TransitionToLayout(cmdbuffer, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+      BeginSwapChainRenderPass(output_to_input ? m_post_processing_input_framebuffer :
+                                                 m_post_processing_output_framebuffer,
+                               target_width, target_height);
     }
     else
     {
@@ -1137,19 +1158,16 @@ void VulkanHostDisplay::ApplyPostProcessingChain(VkFramebuffer target_fb, s32 fi
     }
 
     const bool use_push_constants = m_post_processing_chain.GetShaderStage(i).UsePushConstants();
-    VkDescriptorSet ds = g_vulkan_context->AllocateDescriptorSet(
-      use_push_constants ? m_post_process_descriptor_set_layout : m_post_process_ubo_descriptor_set_layout);
-    if (ds == VK_NULL_HANDLE)
-    {
-      Log_ErrorPrintf("Skipping rendering display because of no descriptor set");
-      return;
-    }
-
-    Vulkan::DescriptorSetUpdateBuilder dsupdate;
-    dsupdate.AddCombinedImageSamplerDescriptorWrite(ds, 1, texture->GetView(), m_point_sampler, texture->GetLayout());
-
     if (use_push_constants)
     {
+      if (!g_vulkan_context->BindImageSamplerDescriptor(cmdbuffer, m_post_process_pipeline_layout,
+                                                        m_post_process_descriptor_set_layout, 1, texture->GetView(),
+                                                        m_point_sampler, texture->GetLayout()))
+      {
+        Log_ErrorPrintf("Skipping rendering display because of no descriptor set");
+        return;
+      }
+
       u8 buffer[FrontendCommon::PostProcessingShader::PUSH_CONSTANT_SIZE_THRESHOLD];
       Assert(pps.uniforms_size <= sizeof(buffer));
       m_post_processing_chain.GetShaderStage(i).FillUniformBuffer(
@@ -1158,13 +1176,17 @@ void VulkanHostDisplay::ApplyPostProcessingChain(VkFramebuffer target_fb, s32 fi
 
       vkCmdPushConstants(cmdbuffer, m_post_process_pipeline_layout,
                          VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, pps.uniforms_size, buffer);
-
-      dsupdate.Update(g_vulkan_context->GetDevice());
-      vkCmdBindDescriptorSets(cmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_post_process_pipeline_layout, 0, 1, &ds, 0,
-                              nullptr);
     }
     else
     {
+      // dynamic uniform buffers can't be pushed, so these still get a set each
+      VkDescriptorSet ds = g_vulkan_context->AllocateDescriptorSet(m_post_process_ubo_descriptor_set_layout);
+      if (ds == VK_NULL_HANDLE)
+      {
+        Log_ErrorPrintf("Skipping rendering display because of no descriptor set");
+        return;
+      }
+
       if (!m_post_processing_ubo.ReserveMemory(pps.uniforms_size,
                                                static_cast<u32>(g_vulkan_context->GetUniformBufferAlignment())))
       {
@@ -1177,6 +1199,9 @@ void VulkanHostDisplay::ApplyPostProcessingChain(VkFramebuffer target_fb, s32 fi
         texture_view_y, texture_view_width, texture_view_height, GetWindowWidth(), GetWindowHeight(), 0.0f);
       m_post_processing_ubo.CommitMemory(pps.uniforms_size);
 
+      Vulkan::DescriptorSetUpdateBuilder dsupdate;
+      dsupdate.AddCombinedImageSamplerDescriptorWrite(ds, 1, texture->GetView(), m_point_sampler,
+                                                      texture->GetLayout());
       dsupdate.AddBufferDescriptorWrite(ds, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
                                         m_post_processing_ubo.GetBuffer(), 0, pps.uniforms_size);
       dsupdate.Update(g_vulkan_context->GetDevice());
@@ -1192,8 +1217,8 @@ void VulkanHostDisplay::ApplyPostProcessingChain(VkFramebuffer target_fb, s32 fi
     {
       vkCmdEndRenderPass(cmdbuffer);
       Vulkan::Util::EndDebugScope(g_vulkan_context->GetCurrentCommandBuffer());
-      pps.output_texture.TransitionToLayout(cmdbuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-      texture = &pps.output_texture;
+      output_texture->TransitionToLayout(cmdbuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+      texture = output_texture;
     }
   }
 }
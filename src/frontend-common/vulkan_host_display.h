@@ -62,6 +62,8 @@ public:
 
   bool SetGPUTimingEnabled(bool enabled) override;
   float GetAndResetAccumulatedGPUTime() override;
+  float GetAndResetAccumulatedFenceWaitTime() override;
+  bool GetAndResetAccumulatedGPUSectionTimes(GPUSectionTimes* times) override;
 
   static AdapterAndModeList StaticGetAdapterAndModeList(const WindowInfo* wi);
 
@@ -81,8 +83,6 @@ protected:
     ~PostProcessingStage();
 
     VkPipeline pipeline = VK_NULL_HANDLE;
-    VkFramebuffer output_framebuffer = VK_NULL_HANDLE;
-    Vulkan::Texture output_texture;
     u32 uniforms_size = 0;
   };
 
@@ -91,6 +91,8 @@ protected:
                                 s32 final_height, Vulkan::Texture* texture, s32 texture_view_x, s32 texture_view_y,
                                 s32 texture_view_width, s32 texture_view_height, u32 target_width, u32 target_height);
 
+  // without a swap chain (headless), the display is rendered to RGBA8 textures
+  VkFormat GetDisplayTextureFormat() const;
   VkRenderPass GetRenderPassForDisplay() const;
 
   bool CheckStagingBufferSize(u32 required_size);
@@ -135,6 +137,10 @@ protected:
   FrontendCommon::PostProcessingChain m_post_processing_chain;
   Vulkan::Texture m_post_processing_input_texture;
   VkFramebuffer m_post_processing_input_framebuffer = VK_NULL_HANDLE;
+
+  // intermediate stages ping-pong between this and the input texture
+  Vulkan::Texture m_post_processing_output_texture;
+  VkFramebuffer m_post_processing_output_framebuffer = VK_NULL_HANDLE;
   Vulkan::StreamBuffer m_post_processing_ubo;
   std::vector<PostProcessingStage> m_post_processing_stages;
 };
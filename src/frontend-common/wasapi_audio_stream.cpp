@@ -0,0 +1,355 @@
+#include "wasapi_audio_stream.h"
+#include "common/assert.h"
+#include "common/log.h"
+#include "common_host.h"
+#include <Audioclient.h>
+#include <algorithm>
+#include <avrt.h>
+#include <mmdeviceapi.h>
+Log_SetChannel(WASAPIAudioStream);
+
+#pragma comment(lib, "Ole32.lib")
+#pragma comment(lib, "avrt.lib")
+
+// REFERENCE_TIME is in 100ns units.
+static constexpr REFERENCE_TIME REFTIMES_PER_MS = 10000;
+
+// How long the render thread waits for the device before checking for shutdown, e.g. while paused.
+static constexpr DWORD RENDER_THREAD_WAIT_MS = 100;
+
+WASAPIAudioStream::WASAPIAudioStream(u32 sample_rate, u32 channels, u32 buffer_ms, AudioStretchMode stretch)
+  : AudioStream(sample_rate, channels, buffer_ms, stretch)
+{
+}
+
+WASAPIAudioStream::~WASAPIAudioStream()
+{
+  if (IsOpen())
+    CloseDevice();
+
+  if (m_com_initialized_by_us)
+    CoUninitialize();
+}
+
+std::unique_ptr<AudioStream> CommonHost::CreateWASAPIAudioStream(u32 sample_rate, u32 channels, u32 buffer_ms,
+                                                                 u32 latency_ms, AudioStretchMode stretch)
+{
+  std::unique_ptr<WASAPIAudioStream> stream(
+    std::make_unique<WASAPIAudioStream>(sample_rate, channels, buffer_ms, stretch));
+  if (!stream->OpenDevice(latency_ms))
+    stream.reset();
+  return stream;
+}
+
+bool WASAPIAudioStream::OpenDevice(u32 latency_ms)
+{
+  DebugAssert(!IsOpen());
+
+  HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  m_com_initialized_by_us = SUCCEEDED(hr);
+  if (FAILED(hr) && hr != RPC_E_CHANGED_MODE && hr != S_FALSE)
+  {
+    Log_ErrorPrintf("Failed to initialize COM");
+    return false;
+  }
+
+  Microsoft::WRL::ComPtr<IMMDeviceEnumerator> enumerator;
+  hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL, IID_PPV_ARGS(enumerator.GetAddressOf()));
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("CoCreateInstance(MMDeviceEnumerator) failed: %08X", hr);
+    return false;
+  }
+
+  hr = enumerator->GetDefaultAudioEndpoint(eRender, eConsole, m_device.ReleaseAndGetAddressOf());
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("GetDefaultAudioEndpoint() failed: %08X", hr);
+    return false;
+  }
+
+  WAVEFORMATEX wf = {};
+  wf.wFormatTag = WAVE_FORMAT_PCM;
+  wf.nChannels = static_cast<WORD>(m_channels);
+  wf.nSamplesPerSec = m_sample_rate;
+  wf.wBitsPerSample = sizeof(s16) * 8;
+  wf.nBlockAlign = static_cast<WORD>(sizeof(s16) * m_channels);
+  wf.nAvgBytesPerSec = m_sample_rate * wf.nBlockAlign;
+
+  if (!InitializeClient(true, latency_ms, &wf))
+  {
+    Log_WarningPrintf("Exclusive mode is not available, falling back to shared mode.");
+    if (!InitializeClient(false, latency_ms, &wf))
+    {
+      CloseDevice();
+      return false;
+    }
+  }
+
+  hr = m_audio_client->GetService(IID_PPV_ARGS(m_render_client.ReleaseAndGetAddressOf()));
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("GetService(IAudioRenderClient) failed: %08X", hr);
+    CloseDevice();
+    return false;
+  }
+
+  // Device latency is the buffer we fill each period, plus whatever the driver/mixer adds.
+  REFERENCE_TIME stream_latency = 0;
+  if (FAILED(m_audio_client->GetStreamLatency(&stream_latency)))
+    stream_latency = 0;
+  m_output_latency_frames =
+    m_device_buffer_frames + static_cast<u32>((stream_latency * m_sample_rate) / (REFTIMES_PER_MS * 1000));
+  Log_InfoPrintf("WASAPI %s mode, buffer of %u frames, output latency %u ms", m_exclusive ? "exclusive" : "shared",
+                 m_device_buffer_frames, GetMSForBufferSize(m_sample_rate, m_output_latency_frames));
+
+  // Start with a silent buffer, otherwise the first period plays garbage.
+  BYTE* data;
+  hr = m_render_client->GetBuffer(m_device_buffer_frames, &data);
+  if (SUCCEEDED(hr))
+    m_render_client->ReleaseBuffer(m_device_buffer_frames, AUDCLNT_BUFFERFLAGS_SILENT);
+
+  BaseInitialize();
+  m_volume = 100;
+  m_paused = false;
+
+  m_render_thread_shutdown.store(false, std::memory_order_release);
+  m_render_thread = std::thread(&WASAPIAudioStream::RenderThreadEntryPoint, this);
+
+  hr = m_audio_client->Start();
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("Start() failed: %08X", hr);
+    CloseDevice();
+    return false;
+  }
+
+  return true;
+}
+
+bool WASAPIAudioStream::InitializeClient(bool exclusive, u32 latency_ms, const WAVEFORMATEX* wf)
+{
+  const AUDCLNT_SHAREMODE share_mode = exclusive ? AUDCLNT_SHAREMODE_EXCLUSIVE : AUDCLNT_SHAREMODE_SHARED;
+
+  HRESULT hr = m_device->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr,
+                                  reinterpret_cast<void**>(m_audio_client.ReleaseAndGetAddressOf()));
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("Activate(IAudioClient) failed: %08X", hr);
+    return false;
+  }
+
+  REFERENCE_TIME default_period = 0, minimum_period = 0;
+  hr = m_audio_client->GetDevicePeriod(&default_period, &minimum_period);
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("GetDevicePeriod() failed: %08X", hr);
+    m_audio_client.Reset();
+    return false;
+  }
+
+  REFERENCE_TIME duration = std::max<REFERENCE_TIME>(minimum_period, latency_ms * REFTIMES_PER_MS);
+  if (exclusive)
+  {
+    hr = m_audio_client->IsFormatSupported(share_mode, wf, nullptr);
+    if (hr != S_OK)
+    {
+      Log_DevPrintf("Device does not support %u hz/%u channels in exclusive mode: %08X", wf->nSamplesPerSec,
+                    wf->nChannels, hr);
+      m_audio_client.Reset();
+      return false;
+    }
+
+    // In exclusive event mode, the buffer duration and period must match.
+    hr = m_audio_client->Initialize(share_mode, AUDCLNT_STREAMFLAGS_EVENTCALLBACK, duration, duration, wf, nullptr);
+    if (hr == AUDCLNT_E_BUFFER_SIZE_NOT_ALIGNED)
+    {
+      // The driver wants a different size, recreate the client with the aligned one.
+      UINT32 aligned_frames = 0;
+      hr = m_audio_client->GetBufferSize(&aligned_frames);
+      m_audio_client.Reset();
+      if (FAILED(hr))
+        return false;
+
+      duration = static_cast<REFERENCE_TIME>(
+        (static_cast<double>(REFTIMES_PER_MS) * 1000.0 * aligned_frames) / wf->nSamplesPerSec + 0.5);
+      hr = m_device->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr,
+                              reinterpret_cast<void**>(m_audio_client.ReleaseAndGetAddressOf()));
+      if (SUCCEEDED(hr))
+        hr = m_audio_client->Initialize(share_mode, AUDCLNT_STREAMFLAGS_EVENTCALLBACK, duration, duration, wf, nullptr);
+    }
+  }
+  else
+  {
+    hr = m_audio_client->Initialize(share_mode,
+                                    AUDCLNT_STREAMFLAGS_EVENTCALLBACK | AUDCLNT_STREAMFLAGS_AUTOCONVERTPCM |
+                                      AUDCLNT_STREAMFLAGS_SRC_DEFAULT_QUALITY,
+                                    duration, 0, wf, nullptr);
+  }
+
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("IAudioClient::Initialize(%s) failed: %08X", exclusive ? "exclusive" : "shared", hr);
+    m_audio_client.Reset();
+    return false;
+  }
+
+  UINT32 buffer_frames = 0;
+  hr = m_audio_client->GetBufferSize(&buffer_frames);
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("GetBufferSize() failed: %08X", hr);
+    m_audio_client.Reset();
+    return false;
+  }
+
+  if (!m_buffer_event)
+  {
+    m_buffer_event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!m_buffer_event)
+    {
+      Log_ErrorPrintf("CreateEvent() failed: %u", GetLastError());
+      m_audio_client.Reset();
+      return false;
+    }
+  }
+
+  hr = m_audio_client->SetEventHandle(m_buffer_event);
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("SetEventHandle() failed: %08X", hr);
+    m_audio_client.Reset();
+    return false;
+  }
+
+  m_device_buffer_frames = buffer_frames;
+  m_exclusive = exclusive;
+  return true;
+}
+
+void WASAPIAudioStream::CloseDevice()
+{
+  if (m_render_thread.joinable())
+  {
+    m_render_thread_shutdown.store(true, std::memory_order_release);
+    SetEvent(m_buffer_event);
+    m_render_thread.join();
+  }
+
+  if (m_audio_client && !m_paused)
+    m_audio_client->Stop();
+
+  m_render_client.Reset();
+  m_audio_client.Reset();
+  m_device.Reset();
+
+  if (m_buffer_event)
+  {
+    CloseHandle(m_buffer_event);
+    m_buffer_event = nullptr;
+  }
+
+  m_device_buffer_frames = 0;
+  m_output_latency_frames = 0;
+  m_paused = true;
+}
+
+void WASAPIAudioStream::SetPaused(bool paused)
+{
+  if (m_paused == paused || !IsOpen())
+    return;
+
+  const HRESULT hr = paused ? m_audio_client->Stop() : m_audio_client->Start();
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("%s() failed: %08X", paused ? "Stop" : "Start", hr);
+    return;
+  }
+
+  m_paused = paused;
+}
+
+void WASAPIAudioStream::SetOutputVolume(u32 volume)
+{
+  // There's no mixer to apply volume in exclusive mode, so it's done when filling the device buffer.
+  m_output_volume.store(volume, std::memory_order_release);
+  m_volume = volume;
+}
+
+void WASAPIAudioStream::RenderThreadEntryPoint()
+{
+  const HRESULT com_hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+  // Ask MMCSS to prioritize this thread, missing a period in exclusive mode is an audible glitch.
+  DWORD task_index = 0;
+  const HANDLE avrt_handle = AvSetMmThreadCharacteristicsW(L"Pro Audio", &task_index);
+  if (!avrt_handle)
+    Log_WarningPrintf("AvSetMmThreadCharacteristics() failed: %u", GetLastError());
+
+  while (!m_render_thread_shutdown.load(std::memory_order_acquire))
+  {
+    if (WaitForSingleObject(m_buffer_event, RENDER_THREAD_WAIT_MS) != WAIT_OBJECT_0)
+      continue;
+
+    if (m_render_thread_shutdown.load(std::memory_order_acquire))
+      break;
+
+    if (!FillBuffer())
+      break;
+  }
+
+  if (avrt_handle)
+    AvRevertMmThreadCharacteristics(avrt_handle);
+
+  if (SUCCEEDED(com_hr))
+    CoUninitialize();
+}
+
+bool WASAPIAudioStream::FillBuffer()
+{
+  // Exclusive mode always hands over the whole buffer, shared mode only the part the mixer has consumed.
+  UINT32 frames = m_device_buffer_frames;
+  if (!m_exclusive)
+  {
+    UINT32 padding = 0;
+    const HRESULT hr = m_audio_client->GetCurrentPadding(&padding);
+    if (FAILED(hr))
+    {
+      Log_ErrorPrintf("GetCurrentPadding() failed: %08X", hr);
+      return false;
+    }
+
+    frames -= padding;
+  }
+
+  if (frames == 0)
+    return true;
+
+  BYTE* data;
+  HRESULT hr = m_render_client->GetBuffer(frames, &data);
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("GetBuffer() failed: %08X", hr);
+    return false;
+  }
+
+  s16* samples = reinterpret_cast<s16*>(data);
+  ReadFrames(samples, frames);
+
+  const u32 volume = m_output_volume.load(std::memory_order_acquire);
+  if (volume != 100)
+  {
+    const u32 num_samples = frames * m_channels;
+    for (u32 i = 0; i < num_samples; i++)
+      samples[i] = static_cast<s16>((static_cast<s32>(samples[i]) * static_cast<s32>(volume)) / 100);
+  }
+
+  hr = m_render_client->ReleaseBuffer(frames, 0);
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("ReleaseBuffer() failed: %08X", hr);
+    return false;
+  }
+
+  return true;
+}
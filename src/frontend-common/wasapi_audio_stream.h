@@ -0,0 +1,47 @@
+#pragma once
+#include "common/windows_headers.h"
+#include "util/audio_stream.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <wrl/client.h>
+
+struct IMMDevice;
+struct IAudioClient;
+struct IAudioRenderClient;
+struct tWAVEFORMATEX;
+
+/// WASAPI output, bypassing the shared mode mixer when the device allows it. Falls back to event-driven shared mode
+/// (with the system resampler) when exclusive mode is unavailable, e.g. another application holds the device.
+class WASAPIAudioStream final : public AudioStream
+{
+public:
+  WASAPIAudioStream(u32 sample_rate, u32 channels, u32 buffer_ms, AudioStretchMode stretch);
+  ~WASAPIAudioStream();
+
+  void SetPaused(bool paused) override;
+  void SetOutputVolume(u32 volume) override;
+
+  bool OpenDevice(u32 latency_ms);
+  void CloseDevice();
+
+private:
+  ALWAYS_INLINE bool IsOpen() const { return static_cast<bool>(m_audio_client); }
+
+  bool InitializeClient(bool exclusive, u32 latency_ms, const tWAVEFORMATEX* wf);
+  void RenderThreadEntryPoint();
+  bool FillBuffer();
+
+  Microsoft::WRL::ComPtr<IMMDevice> m_device;
+  Microsoft::WRL::ComPtr<IAudioClient> m_audio_client;
+  Microsoft::WRL::ComPtr<IAudioRenderClient> m_render_client;
+  HANDLE m_buffer_event = nullptr;
+
+  std::thread m_render_thread;
+  std::atomic_bool m_render_thread_shutdown{false};
+  std::atomic<u32> m_output_volume{100};
+
+  u32 m_device_buffer_frames = 0;
+  bool m_exclusive = false;
+  bool m_com_initialized_by_us = false;
+};
@@ -113,6 +113,9 @@ bool XAudio2AudioStream::OpenDevice(u32 latency_ms)
   for (u32 i = 0; i < NUM_BUFFERS; i++)
     m_enqueue_buffers[i] = std::make_unique<SampleType[]>(m_enqueue_buffer_size * m_channels);
 
+  // the source voice holds one buffer while the other is being filled
+  m_output_latency_frames = m_enqueue_buffer_size;
+
   BaseInitialize();
   m_volume = 100;
   m_paused = false;
@@ -4,18 +4,27 @@
 #include "common/minizip_helpers.h"
 #include "common/string_util.h"
 #include "common/win32_progress_callback.h"
+#include "zstd.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifdef _WIN32
 #include <shellapi.h>
 #endif
 
+static constexpr u32 MAX_STAGING_WORKERS = 8;
+static constexpr u32 STAGING_CHUNK_SIZE = 64 * 1024;
+
 Updater::Updater(ProgressCallback* progress) : m_progress(progress)
 {
   progress->SetTitle("DuckStation Update Installer");
@@ -49,6 +58,7 @@ bool Updater::OpenUpdateZip(const char* path)
   if (!m_zf)
     return false;
 
+  m_zip_path = path;
   m_progress->SetStatusText("Parsing update zip...");
   return ParseZip();
 }
@@ -112,7 +122,12 @@ bool Updater::ParseZip()
       if (StringUtil::Strcasecmp(zip_filename_buffer, "updater.exe") != 0)
       {
         entry.destination_filename = zip_filename_buffer;
-        m_progress->DisplayFormattedInformation("Found file in zip: '%s'", entry.destination_filename.c_str());
+        entry.is_patch = StringUtil::EndsWithNoCase(entry.destination_filename, PATCH_EXTENSION);
+        if (entry.is_patch)
+          entry.destination_filename.erase(len - std::strlen(PATCH_EXTENSION));
+
+        m_progress->DisplayFormattedInformation("Found %s in zip: '%s'", entry.is_patch ? "patch" : "file",
+                                                entry.destination_filename.c_str());
         m_update_paths.push_back(std::move(entry));
       }
     }
@@ -194,71 +209,244 @@ bool Updater::PrepareStagingDirectory()
 
 bool Updater::StageUpdate()
 {
-  m_progress->SetProgressRange(static_cast<u32>(m_update_paths.size()));
+  const u32 num_files = static_cast<u32>(m_update_paths.size());
+  m_progress->SetProgressRange(num_files);
   m_progress->SetProgressValue(0);
+  m_progress->SetStatusText("Extracting update...");
+
+  // zip handles can't be shared between threads, so each worker opens the zip itself. the zip's CRCs and the
+  // patches' checksums are verified as they're read, so that happens in parallel too.
+  const u32 num_workers = std::clamp(std::thread::hardware_concurrency(), 1u, std::min(MAX_STAGING_WORKERS, num_files));
+  std::atomic<u32> next_file{0};
+  std::atomic<u32> files_done{0};
+  std::atomic<u32> workers_running{num_workers};
+  std::atomic_bool failed{false};
+  std::mutex error_mutex;
+  std::string error_message;
+
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers);
+  for (u32 i = 0; i < num_workers; i++)
+  {
+    workers.emplace_back([&]() {
+      std::string error;
+      unzFile zf = MinizipHelpers::OpenUnzFile(m_zip_path.c_str());
+      if (!zf)
+      {
+        error = StringUtil::StdStringFromFormat("Failed to open update zip '%s'", m_zip_path.c_str());
+      }
+      else
+      {
+        while (!failed.load(std::memory_order_relaxed))
+        {
+          const u32 index = next_file.fetch_add(1, std::memory_order_relaxed);
+          if (index >= num_files)
+            break;
+
+          if (!StageFile(zf, m_update_paths[index], m_staging_directory, m_destination_directory, &error))
+            break;
+
+          files_done.fetch_add(1, std::memory_order_release);
+        }
+
+        unzClose(zf);
+      }
+
+      if (!error.empty())
+      {
+        std::unique_lock lock(error_mutex);
+        if (error_message.empty())
+          error_message = std::move(error);
+        failed.store(true);
+      }
+
+      workers_running.fetch_sub(1, std::memory_order_release);
+    });
+  }
+
+  // the progress window belongs to this thread, so it's updated (and its messages pumped) from here
+  while (workers_running.load(std::memory_order_acquire) > 0)
+  {
+    m_progress->SetProgressValue(files_done.load(std::memory_order_acquire));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  for (std::thread& worker : workers)
+    worker.join();
+
+  if (failed.load())
+  {
+    m_progress->DisplayFormattedModalError("%s", error_message.c_str());
+    return false;
+  }
 
   for (const FileToUpdate& ftu : m_update_paths)
   {
-    m_progress->SetFormattedStatusText("Extracting '%s'...", ftu.original_zip_filename.c_str());
+    m_progress->DisplayFormattedInformation("%s '%s'", ftu.is_patch ? "Patched" : "Extracted",
+                                            ftu.destination_filename.c_str());
+  }
+
+  m_progress->SetProgressValue(num_files);
+  return true;
+}
+
+bool Updater::StageFile(unzFile zf, const FileToUpdate& ftu, const std::string& staging_directory,
+                        const std::string& destination_directory, std::string* error)
+{
+  if (unzLocateFile(zf, ftu.original_zip_filename.c_str(), 0) != UNZ_OK)
+  {
+    *error = StringUtil::StdStringFromFormat("Unable to locate file '%s' in zip", ftu.original_zip_filename.c_str());
+    return false;
+  }
+  else if (unzOpenCurrentFile(zf) != UNZ_OK)
+  {
+    *error = StringUtil::StdStringFromFormat("Failed to open file '%s' in zip", ftu.original_zip_filename.c_str());
+    return false;
+  }
+
+  const std::string destination_file = StringUtil::StdStringFromFormat(
+    "%s" FS_OSPATH_SEPARATOR_STR "%s", staging_directory.c_str(), ftu.destination_filename.c_str());
+  std::FILE* fp = FileSystem::OpenCFile(destination_file.c_str(), "wb");
+  if (!fp)
+  {
+    *error = StringUtil::StdStringFromFormat("Failed to open staging output file '%s'", destination_file.c_str());
+    unzCloseCurrentFile(zf);
+    return false;
+  }
 
-    if (unzLocateFile(m_zf, ftu.original_zip_filename.c_str(), 0) != UNZ_OK)
+  bool result = ftu.is_patch ? PatchFile(zf, ftu, destination_directory, fp, error) : ExtractFile(zf, ftu, fp, error);
+
+  // minizip only checks the CRC once the whole file has been read, when it's closed
+  const int close_result = unzCloseCurrentFile(zf);
+  if (result && close_result != UNZ_OK)
+  {
+    *error = StringUtil::StdStringFromFormat("File '%s' in zip is corrupted", ftu.original_zip_filename.c_str());
+    result = false;
+  }
+
+  if (std::fclose(fp) != 0 && result)
+  {
+    *error = StringUtil::StdStringFromFormat("Failed to write to file '%s'", destination_file.c_str());
+    result = false;
+  }
+
+  if (!result)
+    FileSystem::DeleteFile(destination_file.c_str());
+
+  return result;
+}
+
+bool Updater::ExtractFile(unzFile zf, const FileToUpdate& ftu, std::FILE* fp, std::string* error)
+{
+  std::unique_ptr<u8[]> buffer = std::make_unique<u8[]>(STAGING_CHUNK_SIZE);
+  for (;;)
+  {
+    const int byte_count = unzReadCurrentFile(zf, buffer.get(), STAGING_CHUNK_SIZE);
+    if (byte_count < 0)
     {
-      m_progress->DisplayFormattedModalError("Unable to locate file '%s' in zip", ftu.original_zip_filename.c_str());
+      *error = StringUtil::StdStringFromFormat("Failed to read file '%s' from zip", ftu.original_zip_filename.c_str());
       return false;
     }
-    else if (unzOpenCurrentFile(m_zf) != UNZ_OK)
+    else if (byte_count == 0)
+    {
+      // end of file
+      return true;
+    }
+
+    if (std::fwrite(buffer.get(), static_cast<size_t>(byte_count), 1, fp) != 1)
     {
-      m_progress->DisplayFormattedModalError("Failed to open file '%s' in zip", ftu.original_zip_filename.c_str());
+      *error = StringUtil::StdStringFromFormat("Failed to write staged file '%s'", ftu.destination_filename.c_str());
       return false;
     }
+  }
+}
 
-    m_progress->DisplayFormattedInformation("Extracting '%s'...", ftu.destination_filename.c_str());
+bool Updater::PatchFile(unzFile zf, const FileToUpdate& ftu, const std::string& destination_directory,
+                        std::FILE* fp, std::string* error)
+{
+  const std::string source_file = StringUtil::StdStringFromFormat(
+    "%s" FS_OSPATH_SEPARATOR_STR "%s", destination_directory.c_str(), ftu.destination_filename.c_str());
+  std::optional<std::vector<u8>> source = FileSystem::ReadBinaryFile(source_file.c_str());
+  if (!source.has_value())
+  {
+    *error = StringUtil::StdStringFromFormat("Failed to read '%s' to patch", source_file.c_str());
+    return false;
+  }
 
-    const std::string destination_file = StringUtil::StdStringFromFormat(
-      "%s" FS_OSPATH_SEPARATOR_STR "%s", m_staging_directory.c_str(), ftu.destination_filename.c_str());
-    std::FILE* fp = FileSystem::OpenCFile(destination_file.c_str(), "wb");
-    if (!fp)
+  ZSTD_DStream* dstream = ZSTD_createDStream();
+  if (!dstream)
+  {
+    *error = "ZSTD_createDStream() failed";
+    return false;
+  }
+
+  // patches reference the whole of the old file, so they need a window at least as big as it
+  ZSTD_DCtx_setParameter(dstream, ZSTD_d_windowLogMax, ZSTD_dParam_getBounds(ZSTD_d_windowLogMax).upperBound);
+  ZSTD_DCtx_refPrefix(dstream, source->data(), source->size());
+
+  std::unique_ptr<u8[]> in_buffer = std::make_unique<u8[]>(STAGING_CHUNK_SIZE);
+  std::unique_ptr<u8[]> out_buffer = std::make_unique<u8[]>(ZSTD_DStreamOutSize());
+  size_t last_result = 1;
+  bool result = true;
+  for (;;)
+  {
+    const int byte_count = unzReadCurrentFile(zf, in_buffer.get(), STAGING_CHUNK_SIZE);
+    if (byte_count < 0)
     {
-      m_progress->DisplayFormattedModalError("Failed to open staging output file '%s'", destination_file.c_str());
-      unzCloseCurrentFile(m_zf);
-      return false;
+      *error = StringUtil::StdStringFromFormat("Failed to read file '%s' from zip", ftu.original_zip_filename.c_str());
+      result = false;
+      break;
+    }
+    else if (byte_count == 0)
+    {
+      break;
     }
 
-    static constexpr u32 CHUNK_SIZE = 4096;
-    u8 buffer[CHUNK_SIZE];
-    for (;;)
+    ZSTD_inBuffer in = {in_buffer.get(), static_cast<size_t>(byte_count), 0};
+    while (result && in.pos < in.size)
     {
-      int byte_count = unzReadCurrentFile(m_zf, buffer, CHUNK_SIZE);
-      if (byte_count < 0)
+      ZSTD_outBuffer out = {out_buffer.get(), ZSTD_DStreamOutSize(), 0};
+      last_result = ZSTD_decompressStream(dstream, &out, &in);
+      if (ZSTD_isError(last_result))
       {
-        m_progress->DisplayFormattedModalError("Failed to read file '%s' from zip", ftu.original_zip_filename.c_str());
-        std::fclose(fp);
-        FileSystem::DeleteFile(destination_file.c_str());
-        unzCloseCurrentFile(m_zf);
-        return false;
+        // includes checksum mismatches, which is what an installed file other than the one the patch was made from
+        // usually results in
+        *error = StringUtil::StdStringFromFormat(
+          "Failed to patch '%s': %s. The installed version may not match this update, please download it in full.",
+          ftu.destination_filename.c_str(), ZSTD_getErrorName(last_result));
+        result = false;
       }
-      else if (byte_count == 0)
-      {
-        // end of file
-        break;
-      }
-
-      if (std::fwrite(buffer, static_cast<size_t>(byte_count), 1, fp) != 1)
+      else if (out.pos > 0 && std::fwrite(out_buffer.get(), out.pos, 1, fp) != 1)
       {
-        m_progress->DisplayFormattedModalError("Failed to write to file '%s'", destination_file.c_str());
-        std::fclose(fp);
-        FileSystem::DeleteFile(destination_file.c_str());
-        unzCloseCurrentFile(m_zf);
-        return false;
+        *error = StringUtil::StdStringFromFormat("Failed to write staged file '%s'", ftu.destination_filename.c_str());
+        result = false;
       }
     }
 
-    std::fclose(fp);
-    unzCloseCurrentFile(m_zf);
-    m_progress->IncrementProgressValue();
+    if (!result)
+      break;
   }
 
-  return true;
+  // flush anything still buffered in the decompressor, a complete frame leaves nothing behind
+  while (result && last_result != 0)
+  {
+    ZSTD_inBuffer in = {nullptr, 0, 0};
+    ZSTD_outBuffer out = {out_buffer.get(), ZSTD_DStreamOutSize(), 0};
+    last_result = ZSTD_decompressStream(dstream, &out, &in);
+    if (ZSTD_isError(last_result) || out.pos == 0)
+    {
+      *error = StringUtil::StdStringFromFormat("Patch '%s' in zip is truncated", ftu.original_zip_filename.c_str());
+      result = false;
+    }
+    else if (std::fwrite(out_buffer.get(), out.pos, 1, fp) != 1)
+    {
+      *error = StringUtil::StdStringFromFormat("Failed to write staged file '%s'", ftu.destination_filename.c_str());
+      result = false;
+    }
+  }
+
+  ZSTD_freeDStream(dstream);
+  return result;
 }
 
 bool Updater::CommitUpdate()
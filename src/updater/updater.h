@@ -1,6 +1,7 @@
 #pragma once
 #include "common/progress_callback.h"
 #include "unzip.h"
+#include <cstdio>
 #include <string>
 #include <vector>
 
@@ -12,6 +13,10 @@ public:
 
   bool Initialize(std::string destination_directory);
 
+  /// Files named with PATCH_EXTENSION in the zip are zstd frames made with --patch-from the installed file, and
+  /// replace that file.
+  static constexpr const char* PATCH_EXTENSION = ".zstpatch";
+
   bool OpenUpdateZip(const char* path);
   bool PrepareStagingDirectory();
   bool StageUpdate();
@@ -25,10 +30,20 @@ private:
   {
     std::string original_zip_filename;
     std::string destination_filename;
+    bool is_patch = false;
   };
 
   bool ParseZip();
 
+  /// Extracts or patches one file into the staging directory. Called from the worker threads, each with their own
+  /// handle to the zip, so it doesn't touch the progress callback.
+  static bool StageFile(unzFile zf, const FileToUpdate& ftu, const std::string& staging_directory,
+                        const std::string& destination_directory, std::string* error);
+  static bool ExtractFile(unzFile zf, const FileToUpdate& ftu, std::FILE* fp, std::string* error);
+  static bool PatchFile(unzFile zf, const FileToUpdate& ftu, const std::string& destination_directory,
+                        std::FILE* fp, std::string* error);
+
+  std::string m_zip_path;
   std::string m_destination_directory;
   std::string m_staging_directory;
 
@@ -61,8 +61,10 @@ u32 AudioStream::GetMSForBufferSize(u32 sample_rate, u32 buffer_size)
   return (buffer_size * 1000u) / sample_rate;
 }
 
-static constexpr const auto s_stretch_mode_names = make_array("None", "Resample", "TimeStretch");
-static constexpr const auto s_stretch_mode_display_names = make_array("None", "Resampling", "Time Stretching");
+static constexpr const auto s_stretch_mode_names =
+  make_array("None", "Resample", "TimeStretch", "FastTimeStretch", "DynamicRateControl");
+static constexpr const auto s_stretch_mode_display_names =
+  make_array("None", "Resampling", "Time Stretching", "Fast Time Stretching", "Dynamic Rate Control");
 
 const char* AudioStream::GetStretchModeName(AudioStretchMode mode)
 {
@@ -96,13 +98,24 @@ u32 AudioStream::GetBufferedFramesRelaxed() const
 
 void AudioStream::ReadFrames(s16* bData, u32 nFrames)
 {
-  const u32 available_frames = GetBufferedFramesRelaxed();
+  // acquire on the write position, so the frames it covers are visible to this thread
+  u32 available_frames =
+    (m_wpos.load(std::memory_order_acquire) + m_buffer_size - m_rpos.load(std::memory_order_relaxed)) % m_buffer_size;
+
+  // the writer can't move the read position itself, so overrun discards are done here
+  if (const u32 discard_frames = m_discard_frames.exchange(0, std::memory_order_relaxed); discard_frames > 0)
+  {
+    const u32 discard = std::min(discard_frames, available_frames);
+    m_rpos.store((m_rpos.load(std::memory_order_relaxed) + discard) % m_buffer_size, std::memory_order_release);
+    available_frames -= discard;
+  }
+
   u32 frames_to_read = nFrames;
   u32 silence_frames = 0;
 
   if (m_filling)
   {
-    u32 toFill = m_buffer_size / ((m_stretch_mode != AudioStretchMode::TimeStretch) ? 32 : 400);
+    u32 toFill = m_buffer_size / (!IsTimeStretching() ? 32 : 400);
     toFill = GetAlignedBufferSize(toFill);
 
     if (available_frames < toFill)
@@ -122,8 +135,9 @@ void AudioStream::ReadFrames(s16* bData, u32 nFrames)
     silence_frames = frames_to_read - available_frames;
     frames_to_read = available_frames;
     m_filling = true;
+    m_underrun_count.fetch_add(1, std::memory_order_relaxed);
 
-    if (m_stretch_mode == AudioStretchMode::TimeStretch)
+    if (IsTimeStretching())
       StretchUnderrun();
   }
 
@@ -194,15 +208,12 @@ void AudioStream::InternalWriteFrames(s32* bData, u32 nSamples)
   const u32 free = m_buffer_size - GetBufferedFramesRelaxed();
   if (free <= nSamples)
   {
-    if (m_stretch_mode == AudioStretchMode::TimeStretch)
-    {
+    m_overrun_count.fetch_add(1, std::memory_order_relaxed);
+    if (IsTimeStretching())
       StretchOverrun();
-    }
-    else
-    {
-      Log_DebugPrintf("Buffer overrun, chunk dropped");
-      return;
-    }
+
+    Log_DebugPrintf("Buffer overrun, chunk dropped");
+    return;
   }
 
   u32 wpos = m_wpos.load(std::memory_order_acquire);
@@ -241,7 +252,7 @@ void AudioStream::AllocateBuffer()
 {
   // use a larger buffer when time stretching, since we need more input
   const u32 multplier =
-    (m_stretch_mode == AudioStretchMode::TimeStretch) ? 16 : ((m_stretch_mode == AudioStretchMode::Off) ? 1 : 2);
+    IsTimeStretching() ? 16 : ((m_stretch_mode == AudioStretchMode::Off) ? 1 : 2);
   m_buffer_size = GetAlignedBufferSize(((m_buffer_ms * multplier) * m_sample_rate) / 1000);
   m_target_buffer_size = GetAlignedBufferSize((m_sample_rate * m_buffer_ms) / 1000u);
   m_buffer = std::unique_ptr<s32[]>(new s32[m_buffer_size]);
@@ -259,12 +270,23 @@ void AudioStream::DestroyBuffer()
 
 void AudioStream::EmptyBuffer()
 {
-  if (m_stretch_mode != AudioStretchMode::Off)
+  if (m_soundtouch)
   {
     m_soundtouch->clear();
     if (m_stretch_mode == AudioStretchMode::TimeStretch)
       m_soundtouch->setTempo(m_nominal_rate);
   }
+  else if (m_stretch_mode == AudioStretchMode::FastTimeStretch)
+  {
+    m_fast_stretch_tempo = m_nominal_rate;
+    m_fast_stretch_position = 0.0f;
+    m_fast_stretch_has_pending = false;
+    m_fast_stretch_in_sync = true;
+  }
+  else if (m_stretch_mode == AudioStretchMode::DynamicRateControl)
+  {
+    ResetDynamicRateControl();
+  }
 
   m_wpos.store(m_rpos.load(std::memory_order_acquire), std::memory_order_release);
 }
@@ -278,7 +300,7 @@ void AudioStream::SetNominalRate(float tempo)
 
 void AudioStream::UpdateTargetTempo(float tempo)
 {
-  if (m_stretch_mode != AudioStretchMode::TimeStretch)
+  if (!IsTimeStretching())
     return;
 
   // undo sqrt()
@@ -288,11 +310,11 @@ void AudioStream::UpdateTargetTempo(float tempo)
   m_average_position = AVERAGING_WINDOW;
   m_average_available = AVERAGING_WINDOW;
   std::fill_n(m_average_fullness.data(), AVERAGING_WINDOW, tempo);
-  m_soundtouch->setTempo(tempo);
+  SetStretchTempo(tempo);
   m_stretch_reset = 0;
   m_stretch_inactive = false;
   m_stretch_ok_count = 0;
-  m_dynamic_target_usage = static_cast<float>(m_target_buffer_size) * m_nominal_rate;
+  m_dynamic_target_usage = static_cast<float>(GetStretchTargetBufferSize()) * m_nominal_rate;
 }
 
 void AudioStream::SetStretchMode(AudioStretchMode mode)
@@ -329,7 +351,27 @@ void AudioStream::SetOutputVolume(u32 volume)
 
 void AudioStream::BeginWrite(SampleType** buffer_ptr, u32* num_frames)
 {
-  // TODO: Write directly to buffer when not using stretching.
+  if (m_stretch_mode == AudioStretchMode::Off && m_volume != 0)
+  {
+    // Write directly into the ring, up to the end of the buffer. One frame is kept free to tell full from empty.
+    const u32 wpos = m_wpos.load(std::memory_order_relaxed);
+    const u32 rpos = m_rpos.load(std::memory_order_acquire);
+    const u32 free = (rpos + m_buffer_size - wpos - 1) % m_buffer_size;
+    const u32 contiguous = std::min(free, m_buffer_size - wpos);
+    m_direct_write = (contiguous > 0);
+    if (m_direct_write)
+    {
+      *buffer_ptr = reinterpret_cast<s16*>(&m_buffer[wpos]);
+      *num_frames = contiguous;
+      return;
+    }
+
+    // Buffer is full, let the caller write to the staging buffer and drop it.
+    *buffer_ptr = reinterpret_cast<s16*>(m_staging_buffer.data());
+    *num_frames = CHUNK_SIZE;
+    return;
+  }
+
   *buffer_ptr = reinterpret_cast<s16*>(&m_staging_buffer[m_staging_buffer_pos]);
   *num_frames = CHUNK_SIZE - m_staging_buffer_pos;
 }
@@ -345,6 +387,21 @@ void AudioStream::EndWrite(u32 num_frames)
   if (m_volume == 0)
     return;
 
+  if (m_stretch_mode == AudioStretchMode::Off)
+  {
+    if (!m_direct_write)
+    {
+      Log_DebugPrintf("Buffer overrun, %u frames dropped", num_frames);
+      m_overrun_count.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    // release so the reader sees the frames before the new position
+    m_direct_write = false;
+    m_wpos.store((m_wpos.load(std::memory_order_relaxed) + num_frames) % m_buffer_size, std::memory_order_release);
+    return;
+  }
+
   m_staging_buffer_pos += num_frames;
   DebugAssert(m_staging_buffer_pos <= CHUNK_SIZE);
   if (m_staging_buffer_pos < CHUNK_SIZE)
@@ -490,6 +547,67 @@ static void FloatChunkToS16(s32* dst, const float* src, uint size)
 }
 #endif
 
+// Linear crossfade weights for a stereo chunk in 2.14 fixed point, as (from, to) pairs per sample. Neither weight
+// reaches 0x4000 on its own, so both fit in a signed 16-bit multiply.
+static constexpr std::array<s16, AudioStream::CHUNK_SIZE * 2 * 2> ComputeCrossfadeWeights()
+{
+  std::array<s16, AudioStream::CHUNK_SIZE * 2 * 2> weights = {};
+  for (u32 frame = 0; frame < AudioStream::CHUNK_SIZE; frame++)
+  {
+    const s16 to = static_cast<s16>(((frame * 2 + 1) * 0x4000) / (AudioStream::CHUNK_SIZE * 2));
+    const s16 from = static_cast<s16>(0x4000 - to);
+    for (u32 channel = 0; channel < 2; channel++)
+    {
+      weights[(frame * 2 + channel) * 2 + 0] = from;
+      weights[(frame * 2 + channel) * 2 + 1] = to;
+    }
+  }
+  return weights;
+}
+alignas(16) static constexpr std::array<s16, AudioStream::CHUNK_SIZE * 2 * 2> s_crossfade_weights =
+  ComputeCrossfadeWeights();
+
+/// Fades from one stereo chunk to another over the length of the chunk. dst may alias either input.
+static void CrossfadeChunk(s32* dst, const s32* from, const s32* to)
+{
+  static_assert((AudioStream::CHUNK_SIZE % 4) == 0);
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+  const s16* weights = s_crossfade_weights.data();
+  for (u32 i = 0; i < AudioStream::CHUNK_SIZE; i += 4)
+  {
+    const int16x8_t fv = vreinterpretq_s16_s32(vld1q_s32(from + i));
+    const int16x8_t tv = vreinterpretq_s16_s32(vld1q_s32(to + i));
+    const int16x8x2_t wv = vld2q_s16(weights + i * 4); // [from weights], [to weights]
+    int32x4_t lo = vmull_s16(vget_low_s16(fv), vget_low_s16(wv.val[0]));
+    int32x4_t hi = vmull_high_s16(fv, wv.val[0]);
+    lo = vmlal_s16(lo, vget_low_s16(tv), vget_low_s16(wv.val[1]));
+    hi = vmlal_high_s16(hi, tv, wv.val[1]);
+    vst1q_s32(dst + i, vreinterpretq_s32_s16(vcombine_s16(vshrn_n_s32(lo, 14), vshrn_n_s32(hi, 14))));
+  }
+#elif defined(_M_IX86) || defined(_M_AMD64)
+  const __m128i* weights = reinterpret_cast<const __m128i*>(s_crossfade_weights.data());
+  for (u32 i = 0; i < AudioStream::CHUNK_SIZE; i += 4)
+  {
+    const __m128i fv = _mm_load_si128(reinterpret_cast<const __m128i*>(from + i));
+    const __m128i tv = _mm_load_si128(reinterpret_cast<const __m128i*>(to + i));
+    const __m128i lo = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(fv, tv), weights[i / 2 + 0]), 14);
+    const __m128i hi = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(fv, tv), weights[i / 2 + 1]), 14);
+    _mm_store_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lo, hi));
+  }
+#else
+  const s16* from_samples = reinterpret_cast<const s16*>(from);
+  const s16* to_samples = reinterpret_cast<const s16*>(to);
+  s16* dst_samples = reinterpret_cast<s16*>(dst);
+  for (u32 i = 0; i < AudioStream::CHUNK_SIZE * 2; i++)
+  {
+    dst_samples[i] = static_cast<s16>((from_samples[i] * s_crossfade_weights[i * 2 + 0] +
+                                       to_samples[i] * s_crossfade_weights[i * 2 + 1]) >>
+                                      14);
+  }
+#endif
+}
+
 // Time stretching algorithm based on PCSX2 implementation.
 
 template<class T>
@@ -503,6 +621,29 @@ void AudioStream::StretchAllocate()
   if (m_stretch_mode == AudioStretchMode::Off)
     return;
 
+  m_stretch_reset = STRETCH_RESET_THRESHOLD;
+  m_stretch_inactive = false;
+  m_stretch_ok_count = 0;
+  m_dynamic_target_usage = 0.0f;
+  m_average_position = 0;
+  m_average_available = 0;
+
+  m_staging_buffer_pos = 0;
+
+  if (m_stretch_mode == AudioStretchMode::FastTimeStretch)
+  {
+    m_fast_stretch_tempo = m_nominal_rate;
+    m_fast_stretch_position = 0.0f;
+    m_fast_stretch_has_pending = false;
+    m_fast_stretch_in_sync = true;
+    return;
+  }
+  else if (m_stretch_mode == AudioStretchMode::DynamicRateControl)
+  {
+    ResetDynamicRateControl();
+    return;
+  }
+
   m_soundtouch = std::make_unique<soundtouch::SoundTouch>();
   m_soundtouch->setSampleRate(m_sample_rate);
   m_soundtouch->setChannels(m_channels);
@@ -518,15 +659,6 @@ void AudioStream::StretchAllocate()
     m_soundtouch->setRate(m_nominal_rate);
   else
     m_soundtouch->setTempo(m_nominal_rate);
-
-  m_stretch_reset = STRETCH_RESET_THRESHOLD;
-  m_stretch_inactive = false;
-  m_stretch_ok_count = 0;
-  m_dynamic_target_usage = 0.0f;
-  m_average_position = 0;
-  m_average_available = 0;
-
-  m_staging_buffer_pos = 0;
 }
 
 void AudioStream::StretchDestroy()
@@ -536,6 +668,17 @@ void AudioStream::StretchDestroy()
 
 void AudioStream::StretchWrite()
 {
+  if (m_stretch_mode == AudioStretchMode::FastTimeStretch)
+  {
+    FastStretchWrite();
+    return;
+  }
+  else if (m_stretch_mode == AudioStretchMode::DynamicRateControl)
+  {
+    DynamicRateControlWrite();
+    return;
+  }
+
   S16ChunkToFloat(m_staging_buffer.data(), m_float_buffer.data());
 
   m_soundtouch->putSamples(m_float_buffer.data(), CHUNK_SIZE);
@@ -583,7 +726,7 @@ void AudioStream::UpdateStretchTempo()
   static constexpr u32 INACTIVE_MIN_OK_COUNT = 50;
   static constexpr u32 COMPENSATION_DIVIDER = 100;
 
-  float base_target_usage = static_cast<float>(m_target_buffer_size) * m_nominal_rate;
+  float base_target_usage = static_cast<float>(GetStretchTargetBufferSize()) * m_nominal_rate;
 
   // state vars
   if (m_stretch_reset >= STRETCH_RESET_THRESHOLD)
@@ -659,12 +802,210 @@ void AudioStream::UpdateStretchTempo()
     iterations++;
   }
 
-  m_soundtouch->setTempo(tempo);
+  SetStretchTempo(tempo);
 
   if (m_stretch_reset >= STRETCH_RESET_THRESHOLD)
     m_stretch_reset = 0;
 }
 
+void AudioStream::SetStretchTempo(float tempo)
+{
+  if (m_stretch_mode == AudioStretchMode::FastTimeStretch)
+    m_fast_stretch_tempo = tempo;
+  else
+    m_soundtouch->setTempo(tempo);
+}
+
+void AudioStream::FastStretchWrite()
+{
+  // Whole chunks are dropped when running fast and repeated when running slow. The seam is hidden by crossfading
+  // from the chunk which would have naturally followed the output into the chunk being written. That chunk is only
+  // known for repeats once the next one arrives, so the output runs one chunk behind.
+  if (m_fast_stretch_has_pending)
+  {
+    m_fast_stretch_position += 1.0f / m_fast_stretch_tempo;
+    const u32 count = static_cast<u32>(m_fast_stretch_position);
+    m_fast_stretch_position -= static_cast<float>(count);
+
+    if (count == 0)
+    {
+      // dropped, the pending chunk is where the output would have continued
+      if (m_fast_stretch_in_sync)
+      {
+        m_fast_stretch_continuation = m_fast_stretch_pending;
+        m_fast_stretch_in_sync = false;
+      }
+    }
+    else
+    {
+      for (u32 i = 0; i < count; i++)
+      {
+        if (m_fast_stretch_in_sync)
+        {
+          InternalWriteFrames(m_fast_stretch_pending.data(), CHUNK_SIZE);
+        }
+        else
+        {
+          CrossfadeChunk(m_fast_stretch_continuation.data(), m_fast_stretch_continuation.data(),
+                         m_fast_stretch_pending.data());
+          InternalWriteFrames(m_fast_stretch_continuation.data(), CHUNK_SIZE);
+        }
+
+        // each repeat continues from the start of the incoming chunk
+        m_fast_stretch_continuation = m_staging_buffer;
+        m_fast_stretch_in_sync = false;
+      }
+
+      m_fast_stretch_in_sync = true;
+    }
+  }
+
+  m_fast_stretch_pending = m_staging_buffer;
+  m_fast_stretch_has_pending = true;
+
+  UpdateStretchTempo();
+}
+
+// Polyphase windowed sinc (Lanczos, a = 4) in 2.14 fixed point. Each phase sums to exactly 0x4000, so there's no
+// gain ripple as the rate changes. The step only ever moves a fraction of a percent away from the nominal rate, so
+// this doesn't need the stopband of a general purpose resampler.
+static constexpr u32 DRC_PHASES = 256;
+static constexpr u32 DRC_PHASE_SHIFT = 32 - 8;
+static_assert((1u << (32 - DRC_PHASE_SHIFT)) == DRC_PHASES);
+
+using DRCCoefficientTable = std::array<std::array<s16, 8>, DRC_PHASES>;
+static DRCCoefficientTable ComputeDRCCoefficients()
+{
+  static constexpr double PI = 3.14159265358979323846;
+  static constexpr double LOBES = 4.0;
+  const auto sinc = [](double x) { return (x == 0.0) ? 1.0 : (std::sin(PI * x) / (PI * x)); };
+
+  DRCCoefficientTable table = {};
+  for (u32 phase = 0; phase < DRC_PHASES; phase++)
+  {
+    const double frac = static_cast<double>(phase) / static_cast<double>(DRC_PHASES);
+    std::array<double, 8> weights;
+    double sum = 0.0;
+    for (u32 tap = 0; tap < 8; tap++)
+    {
+      // taps are at -3..4 relative to the integer position
+      const double x = (static_cast<double>(tap) - 3.0) - frac;
+      weights[tap] = sinc(x) * sinc(x / LOBES);
+      sum += weights[tap];
+    }
+
+    s32 total = 0;
+    for (u32 tap = 0; tap < 8; tap++)
+    {
+      table[phase][tap] = static_cast<s16>(std::lround(weights[tap] * (16384.0 / sum)));
+      total += table[phase][tap];
+    }
+
+    // put the rounding error on the nearest tap
+    table[phase][(frac < 0.5) ? 3 : 4] += static_cast<s16>(16384 - total);
+  }
+
+  return table;
+}
+alignas(16) static const DRCCoefficientTable s_drc_coefficients = ComputeDRCCoefficients();
+
+/// Filters eight stereo frames (centered between the fourth and fifth) down to a single frame.
+ALWAYS_INLINE static s32 DRCResampleFrame(const s32* frames, const s16* coefficients)
+{
+#if defined(_M_ARM64) || defined(__aarch64__)
+  const int16x8x2_t fv = vld2q_s16(reinterpret_cast<const s16*>(frames)); // [left], [right]
+  const int16x8_t cv = vld1q_s16(coefficients);
+  int32x4_t lv = vmull_s16(vget_low_s16(fv.val[0]), vget_low_s16(cv));
+  int32x4_t rv = vmull_s16(vget_low_s16(fv.val[1]), vget_low_s16(cv));
+  lv = vmlal_high_s16(lv, fv.val[0], cv);
+  rv = vmlal_high_s16(rv, fv.val[1], cv);
+  int32x4_t sv = vpaddq_s32(lv, rv); // [l01, l23, r01, r23]
+  sv = vpaddq_s32(sv, sv);           // [l, r, l, r]
+  return vget_lane_s32(vreinterpret_s32_s16(vqrshrn_n_s32(sv, 14)), 0);
+#elif defined(_M_IX86) || defined(_M_AMD64)
+  const __m128i f0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frames));
+  const __m128i f1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frames + 4));
+  const __m128i cv = _mm_load_si128(reinterpret_cast<const __m128i*>(coefficients));
+  const __m128i lv =
+    _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(f0, 16), 16), _mm_srai_epi32(_mm_slli_epi32(f1, 16), 16));
+  const __m128i rv = _mm_packs_epi32(_mm_srai_epi32(f0, 16), _mm_srai_epi32(f1, 16));
+  const __m128i lsum = _mm_madd_epi16(lv, cv); // [l01, l23, l45, l67]
+  const __m128i rsum = _mm_madd_epi16(rv, cv); // [r01, r23, r45, r67]
+  __m128i sv = _mm_add_epi32(_mm_unpacklo_epi32(lsum, rsum), _mm_unpackhi_epi32(lsum, rsum));
+  sv = _mm_add_epi32(sv, _mm_srli_si128(sv, 8)); // [l, r, ...]
+  sv = _mm_srai_epi32(_mm_add_epi32(sv, _mm_set1_epi32(0x2000)), 14);
+  return _mm_cvtsi128_si32(_mm_packs_epi32(sv, sv));
+#else
+  const s16* samples = reinterpret_cast<const s16*>(frames);
+  s32 left = 0, right = 0;
+  for (u32 tap = 0; tap < 8; tap++)
+  {
+    left += samples[tap * 2 + 0] * coefficients[tap];
+    right += samples[tap * 2 + 1] * coefficients[tap];
+  }
+  left = std::clamp<s32>((left + 0x2000) >> 14, -32768, 32767);
+  right = std::clamp<s32>((right + 0x2000) >> 14, -32768, 32767);
+  return static_cast<s32>((static_cast<u32>(left) & 0xFFFFu) | (static_cast<u32>(right) << 16));
+#endif
+}
+
+void AudioStream::ResetDynamicRateControl()
+{
+  m_drc_input.fill(0);
+  m_drc_position = static_cast<u64>(DRC_TAPS / 2 - 1) << 32;
+  m_drc_average_fill = static_cast<float>(GetStretchTargetBufferSize());
+}
+
+void AudioStream::DynamicRateControlWrite()
+{
+  // Maximum step deviation from the nominal rate, 0.5% is around 9 cents of pitch, which isn't noticeable.
+  static constexpr float MAX_DEVIATION = 0.005f;
+  static constexpr float FILL_SMOOTHING = 0.05f;
+  static constexpr float MIN_STEP = 1.0f / 32.0f;
+  static constexpr float MAX_STEP = 32.0f;
+  static constexpr u32 LAST_POSITION = DRC_HISTORY_FRAMES + CHUNK_SIZE - DRC_TAPS;
+
+  // The fill level jumps around as whole frames of audio are generated at once, so steer on an average.
+  const float target = static_cast<float>(GetStretchTargetBufferSize());
+  m_drc_average_fill += (static_cast<float>(GetBufferedFramesRelaxed()) - m_drc_average_fill) * FILL_SMOOTHING;
+  const float deviation = std::clamp((m_drc_average_fill - target) / target, -1.0f, 1.0f);
+  const float step = std::clamp(m_nominal_rate * (1.0f + MAX_DEVIATION * deviation), MIN_STEP, MAX_STEP);
+  const u64 step_fixed = static_cast<u64>(static_cast<double>(step) * 4294967296.0);
+
+  std::memcpy(&m_drc_input[DRC_HISTORY_FRAMES], m_staging_buffer.data(), sizeof(s32) * CHUNK_SIZE);
+
+  // positions are offset so the first tap is at the integer part
+  u32 num_output_frames = 0;
+  u64 position = m_drc_position;
+  while ((position >> 32) <= (LAST_POSITION + (DRC_TAPS / 2 - 1)))
+  {
+    const u32 first_frame = static_cast<u32>(position >> 32) - (DRC_TAPS / 2 - 1);
+    const u32 phase = static_cast<u32>(position) >> DRC_PHASE_SHIFT;
+    m_drc_output[num_output_frames++] =
+      DRCResampleFrame(&m_drc_input[first_frame], s_drc_coefficients[phase].data());
+    position += step_fixed;
+
+    if (num_output_frames == CHUNK_SIZE)
+    {
+      InternalWriteFrames(m_drc_output.data(), num_output_frames);
+      num_output_frames = 0;
+    }
+  }
+
+  if (num_output_frames > 0)
+    InternalWriteFrames(m_drc_output.data(), num_output_frames);
+
+  m_drc_position = position - (static_cast<u64>(CHUNK_SIZE) << 32);
+  std::memmove(&m_drc_input[0], &m_drc_input[CHUNK_SIZE], sizeof(s32) * DRC_HISTORY_FRAMES);
+}
+
+u32 AudioStream::GetStretchTargetBufferSize() const
+{
+  // The device latency is part of the total latency too, so buffer less ourselves. Keep at least half of the
+  // target, otherwise a device with a large buffer would leave nothing to absorb timing jitter.
+  return m_target_buffer_size - std::min(m_output_latency_frames, m_target_buffer_size / 2);
+}
+
 void AudioStream::StretchUnderrun()
 {
   // Didn't produce enough frames in time.
@@ -676,7 +1017,7 @@ void AudioStream::StretchOverrun()
   // Produced more frames than can fit in the buffer.
   m_stretch_reset++;
 
-  // Drop two packets to give the time stretcher a bit more time to slow things down.
-  const u32 discard = CHUNK_SIZE * 2;
-  m_rpos.store((m_rpos.load(std::memory_order_acquire) + discard) % m_buffer_size, std::memory_order_release);
+  // Drop two packets to give the time stretcher a bit more time to slow things down. The read position belongs to the
+  // backend thread, so the discard is done on its next read.
+  m_discard_frames.fetch_add(CHUNK_SIZE * 2, std::memory_order_relaxed);
 }
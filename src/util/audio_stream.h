@@ -19,6 +19,8 @@ enum class AudioStretchMode : u8
   Off,
   Resample,
   TimeStretch,
+  FastTimeStretch,
+  DynamicRateControl,
   Count
 };
 
@@ -54,11 +56,20 @@ public:
 
   u32 GetBufferedFramesRelaxed() const;
 
+  /// Frames of latency added by the backend/device after ReadFrames(), i.e. on top of the buffered frames.
+  ALWAYS_INLINE u32 GetOutputLatencyFrames() const { return m_output_latency_frames; }
+
+  /// Number of times the backend requested more frames than were buffered, or the buffer was full when writing.
+  ALWAYS_INLINE u32 GetUnderrunCount() const { return m_underrun_count.load(std::memory_order_relaxed); }
+  ALWAYS_INLINE u32 GetOverrunCount() const { return m_overrun_count.load(std::memory_order_relaxed); }
+
   /// Temporarily pauses the stream, preventing it from requesting data.
   virtual void SetPaused(bool paused);
 
   virtual void SetOutputVolume(u32 volume);
 
+  /// Returns a contiguous span for the emulation thread to write frames into. When not stretching, this points
+  /// directly into the ring buffer. If the buffer is full, the returned span is a scratch buffer which is discarded.
   void BeginWrite(SampleType** buffer_ptr, u32* num_frames);
   void WriteFrames(const SampleType* frames, u32 num_frames);
   void EndWrite(u32 num_frames);
@@ -84,6 +95,7 @@ protected:
   u32 m_channels = 0;
   u32 m_buffer_ms = 0;
   u32 m_volume = 0;
+  u32 m_output_latency_frames = 0;
 
   AudioStretchMode m_stretch_mode = AudioStretchMode::Off;
   bool m_stretch_inactive = false;
@@ -97,6 +109,9 @@ private:
     AVERAGING_WINDOW = 50,
     STRETCH_RESET_THRESHOLD = 5,
     TARGET_IPS = 691,
+    CACHE_LINE_SIZE = 64,
+    DRC_TAPS = 8,
+    DRC_HISTORY_FRAMES = DRC_TAPS - 1,
   };
 
   void AllocateBuffer();
@@ -104,20 +119,36 @@ private:
 
   void InternalWriteFrames(s32* bData, u32 nFrames);
 
+  ALWAYS_INLINE bool IsTimeStretching() const
+  {
+    return (m_stretch_mode == AudioStretchMode::TimeStretch || m_stretch_mode == AudioStretchMode::FastTimeStretch);
+  }
+
   void StretchAllocate();
   void StretchDestroy();
   void StretchWrite();
+  void FastStretchWrite();
+  void DynamicRateControlWrite();
+  void ResetDynamicRateControl();
+  void SetStretchTempo(float tempo);
   void StretchUnderrun();
   void StretchOverrun();
 
+  u32 GetStretchTargetBufferSize() const;
   float AddAndGetAverageTempo(float val);
   void UpdateStretchTempo();
 
   u32 m_buffer_size = 0;
   std::unique_ptr<s32[]> m_buffer;
 
-  std::atomic<u32> m_rpos{0};
-  std::atomic<u32> m_wpos{0};
+  // Single-producer single-consumer ring: the emulation thread only writes m_wpos, and the backend callback only
+  // writes m_rpos. Each index lives on its own cache line so the two threads don't contend.
+  alignas(CACHE_LINE_SIZE) std::atomic<u32> m_rpos{0};
+  std::atomic<u32> m_discard_frames{0};
+  std::atomic<u32> m_underrun_count{0};
+  alignas(CACHE_LINE_SIZE) std::atomic<u32> m_wpos{0};
+  std::atomic<u32> m_overrun_count{0};
+  bool m_direct_write = false;
 
   std::unique_ptr<soundtouch::SoundTouch> m_soundtouch;
 
@@ -139,6 +170,20 @@ private:
 
   // float buffer, soundtouch only accepts float samples as input
   alignas(16) std::array<float, CHUNK_SIZE * MAX_CHANNELS> m_float_buffer;
+
+  // fast time stretching, drops/repeats whole chunks with a crossfade over the seam
+  alignas(16) std::array<s32, CHUNK_SIZE> m_fast_stretch_pending;
+  alignas(16) std::array<s32, CHUNK_SIZE> m_fast_stretch_continuation;
+  float m_fast_stretch_tempo = 1.0f;
+  float m_fast_stretch_position = 0.0f;
+  bool m_fast_stretch_has_pending = false;
+  bool m_fast_stretch_in_sync = true;
+
+  // dynamic rate control, resamples with the step nudged slightly to hold the buffer at its target fill
+  alignas(16) std::array<s32, DRC_HISTORY_FRAMES + CHUNK_SIZE> m_drc_input;
+  alignas(16) std::array<s32, CHUNK_SIZE> m_drc_output;
+  u64 m_drc_position = 0; // 32.32 fixed point, in frames from the start of m_drc_input
+  float m_drc_average_fill = 0.0f;
 };
 
 #ifdef _MSC_VER
@@ -0,0 +1,413 @@
+#include "avi_writer.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "stb_image_write.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+Log_SetChannel(AVIWriter);
+
+#pragma pack(push, 1)
+struct AVI_STREAM_HEADER
+{
+  u32 chunk_id; // "strh"
+  u32 chunk_size;
+  u32 type;
+  u32 handler;
+  u32 flags;
+  u16 priority;
+  u16 language;
+  u32 initial_frames;
+  u32 scale;
+  u32 rate;
+  u32 start;
+  u32 length;
+  u32 suggested_buffer_size;
+  u32 quality;
+  u32 sample_size;
+  s16 frame_left;
+  s16 frame_top;
+  s16 frame_right;
+  s16 frame_bottom;
+};
+
+struct AVI_HEADER
+{
+  u32 riff_id; // RIFF
+  u32 riff_size;
+  u32 avi_id; // "AVI "
+
+  u32 hdrl_list_id; // LIST
+  u32 hdrl_list_size;
+  u32 hdrl_id; // "hdrl"
+
+  struct MainHeader
+  {
+    u32 chunk_id; // "avih"
+    u32 chunk_size;
+    u32 microseconds_per_frame;
+    u32 max_bytes_per_second;
+    u32 padding_granularity;
+    u32 flags;
+    u32 total_frames;
+    u32 initial_frames;
+    u32 streams;
+    u32 suggested_buffer_size;
+    u32 width;
+    u32 height;
+    u32 reserved[4];
+  } avih;
+
+  struct VideoStreamList
+  {
+    u32 list_id; // LIST
+    u32 list_size;
+    u32 strl_id; // "strl"
+    AVI_STREAM_HEADER strh;
+
+    struct Format
+    {
+      u32 chunk_id; // "strf"
+      u32 chunk_size;
+      u32 size;
+      s32 width;
+      s32 height;
+      u16 planes;
+      u16 bit_count;
+      u32 compression;
+      u32 size_image;
+      s32 x_pels_per_meter;
+      s32 y_pels_per_meter;
+      u32 colors_used;
+      u32 colors_important;
+    } strf;
+  } video;
+
+  struct AudioStreamList
+  {
+    u32 list_id; // LIST
+    u32 list_size;
+    u32 strl_id; // "strl"
+    AVI_STREAM_HEADER strh;
+
+    struct Format
+    {
+      u32 chunk_id; // "strf"
+      u32 chunk_size;
+      u16 format_tag;
+      u16 num_channels;
+      u32 sample_rate;
+      u32 byte_rate;
+      u16 block_align;
+      u16 bits_per_sample;
+    } strf;
+  } audio;
+
+  u32 movi_list_id; // LIST
+  u32 movi_list_size;
+  u32 movi_id; // "movi"
+};
+#pragma pack(pop)
+
+static constexpr u32 MakeFourCC(char a, char b, char c, char d)
+{
+  return static_cast<u32>(static_cast<u8>(a)) | (static_cast<u32>(static_cast<u8>(b)) << 8) |
+         (static_cast<u32>(static_cast<u8>(c)) << 16) | (static_cast<u32>(static_cast<u8>(d)) << 24);
+}
+
+static constexpr u32 VIDEO_CHUNK_ID = MakeFourCC('0', '0', 'd', 'c');
+static constexpr u32 AUDIO_CHUNK_ID = MakeFourCC('0', '1', 'w', 'b');
+static constexpr u32 AVIF_HASINDEX = 0x10;
+static constexpr u32 AVIF_ISINTERLEAVED = 0x100;
+static constexpr u32 AVIIF_KEYFRAME = 0x10;
+
+namespace Common {
+
+AVIWriter::AVIWriter() = default;
+
+AVIWriter::~AVIWriter()
+{
+  if (IsOpen())
+    Close();
+}
+
+bool AVIWriter::Open(const char* filename, u32 width, u32 height, float frame_rate, u32 sample_rate, u32 num_channels,
+                     u32 jpeg_quality)
+{
+  if (IsOpen())
+    Close();
+
+  m_file = FileSystem::OpenCFile(filename, "wb");
+  if (!m_file)
+    return false;
+
+  m_width = width;
+  m_height = height;
+  m_frame_rate_numerator = static_cast<u32>(std::round(frame_rate * 1000.0f));
+  m_frame_rate_denominator = 1000;
+  m_sample_rate = sample_rate;
+  m_num_channels = num_channels;
+  m_jpeg_quality = jpeg_quality;
+
+  if (!WriteHeader())
+  {
+    Log_ErrorPrintf("Failed to write header to file");
+    std::fclose(m_file);
+    m_file = nullptr;
+    m_width = 0;
+    m_height = 0;
+    m_sample_rate = 0;
+    m_num_channels = 0;
+    return false;
+  }
+
+  m_writer_shutdown = false;
+  m_writer_thread = std::thread(&AVIWriter::WriterThreadEntryPoint, this);
+  return true;
+}
+
+void AVIWriter::Close()
+{
+  if (!IsOpen())
+    return;
+
+  if (!m_pending_audio.empty())
+    QueuePacket(Packet{{}, std::move(m_pending_audio), false});
+
+  {
+    std::unique_lock lock(m_mutex);
+    m_writer_shutdown = true;
+    m_work_cv.notify_one();
+  }
+  m_writer_thread.join();
+
+  if (!WriteIndex())
+    Log_ErrorPrintf("Failed to write index, file may not be seekable");
+
+  if (std::fseek(m_file, 0, SEEK_SET) != 0 || !WriteHeader())
+    Log_ErrorPrintf("Failed to re-write header on file, file may be unplayable");
+
+  std::fclose(m_file);
+  m_file = nullptr;
+  m_width = 0;
+  m_height = 0;
+  m_sample_rate = 0;
+  m_num_channels = 0;
+  m_num_video_frames = 0;
+  m_pending_audio = {};
+  m_index = {};
+  m_encode_buffer = {};
+  m_movi_size = 0;
+  m_num_audio_frames_written = 0;
+  m_max_video_chunk_size = 0;
+  m_file_full = false;
+}
+
+void AVIWriter::WriteVideoFrame(std::vector<u32> pixels)
+{
+  if (!pixels.empty() && pixels.size() != (m_width * m_height))
+  {
+    Log_WarningPrintf("Frame is the wrong size (%zu pixels, expected %ux%u), dropping", pixels.size(), m_width,
+                      m_height);
+    pixels = {};
+  }
+
+  m_num_video_frames++;
+  QueuePacket(Packet{std::move(pixels), std::move(m_pending_audio), true});
+  m_pending_audio = {};
+}
+
+void AVIWriter::WriteAudioFrames(const s16* samples, u32 num_frames)
+{
+  m_pending_audio.insert(m_pending_audio.end(), samples, samples + num_frames * m_num_channels);
+}
+
+void AVIWriter::QueuePacket(Packet packet)
+{
+  std::unique_lock lock(m_mutex);
+  if (!packet.pixels.empty())
+  {
+    // drop rather than stall emulation, the empty chunk keeps the streams in sync
+    if (m_queued_video_frames >= MAX_QUEUED_VIDEO_FRAMES)
+    {
+      Log_WarningPrintf("Too many queued frames, dropping frame %u", m_num_video_frames);
+      packet.pixels = {};
+    }
+    else
+    {
+      m_queued_video_frames++;
+    }
+  }
+
+  m_queued_packets.push_back(std::move(packet));
+  m_work_cv.notify_one();
+}
+
+void AVIWriter::WriterThreadEntryPoint()
+{
+  const auto write_func = [](void* context, void* data, int size) {
+    std::vector<u8>* buffer = static_cast<std::vector<u8>*>(context);
+    buffer->insert(buffer->end(), static_cast<const u8*>(data), static_cast<const u8*>(data) + size);
+  };
+
+  std::unique_lock lock(m_mutex);
+  for (;;)
+  {
+    m_work_cv.wait(lock, [this]() { return m_writer_shutdown || !m_queued_packets.empty(); });
+    if (m_queued_packets.empty())
+      break;
+
+    Packet packet = std::move(m_queued_packets.front());
+    m_queued_packets.pop_front();
+    lock.unlock();
+
+    if (!packet.audio.empty())
+    {
+      const u32 num_frames = static_cast<u32>(packet.audio.size()) / m_num_channels;
+      WriteChunk(AUDIO_CHUNK_ID, packet.audio.data(), static_cast<u32>(packet.audio.size() * sizeof(SampleType)));
+      if (!m_file_full)
+        m_num_audio_frames_written += num_frames;
+    }
+
+    if (packet.has_video)
+    {
+      m_encode_buffer.clear();
+      if (!packet.pixels.empty() &&
+          stbi_write_jpg_to_func(write_func, &m_encode_buffer, m_width, m_height, 4, packet.pixels.data(),
+                                 m_jpeg_quality) == 0)
+      {
+        Log_ErrorPrintf("Failed to compress frame, dropping");
+        m_encode_buffer.clear();
+      }
+
+      WriteChunk(VIDEO_CHUNK_ID, m_encode_buffer.data(), static_cast<u32>(m_encode_buffer.size()));
+      m_max_video_chunk_size = std::max(m_max_video_chunk_size, static_cast<u32>(m_encode_buffer.size()));
+    }
+
+    lock.lock();
+    if (!packet.pixels.empty())
+      m_queued_video_frames--;
+  }
+}
+
+void AVIWriter::WriteChunk(u32 chunk_id, const void* data, u32 size)
+{
+  const u32 padded_size = (size + 1) & ~1u;
+  if (m_file_full || (sizeof(AVI_HEADER) + m_movi_size + 8 + padded_size + (m_index.size() + 1) * sizeof(IndexEntry)) >
+                       MAX_FILE_SIZE)
+  {
+    if (!m_file_full)
+    {
+      Log_ErrorPrintf("Output file has reached the maximum size, further frames will not be written");
+      m_file_full = true;
+    }
+
+    return;
+  }
+
+  // offsets are relative to the "movi" identifier
+  m_index.push_back(IndexEntry{chunk_id, AVIIF_KEYFRAME, static_cast<u32>(m_movi_size + 4), size});
+
+  static constexpr u8 padding = 0;
+  const u32 chunk_header[2] = {chunk_id, size};
+  if (std::fwrite(chunk_header, sizeof(chunk_header), 1, m_file) != 1 ||
+      (size > 0 && std::fwrite(data, size, 1, m_file) != 1) ||
+      (padded_size != size && std::fwrite(&padding, 1, 1, m_file) != 1))
+  {
+    Log_ErrorPrintf("Failed to write %u byte chunk to output file", size);
+  }
+
+  m_movi_size += sizeof(chunk_header) + padded_size;
+}
+
+bool AVIWriter::WriteIndex()
+{
+  const u32 index_header[2] = {MakeFourCC('i', 'd', 'x', '1'), static_cast<u32>(m_index.size() * sizeof(IndexEntry))};
+  return (std::fwrite(index_header, sizeof(index_header), 1, m_file) == 1 &&
+          (m_index.empty() || std::fwrite(m_index.data(), sizeof(IndexEntry), m_index.size(), m_file) == m_index.size()));
+}
+
+bool AVIWriter::WriteHeader()
+{
+  const u32 block_align = m_num_channels * sizeof(SampleType);
+  const u32 byte_rate = m_sample_rate * block_align;
+  const u32 movi_list_size = 4 + static_cast<u32>(m_movi_size);
+  const u32 index_size = m_index.empty() ? 0 : static_cast<u32>(8 + m_index.size() * sizeof(IndexEntry));
+  const u32 num_video_frames =
+    static_cast<u32>(std::count_if(m_index.begin(), m_index.end(), [](const IndexEntry& e) {
+      return (e.chunk_id == VIDEO_CHUNK_ID);
+    }));
+
+  AVI_HEADER header = {};
+  header.riff_id = MakeFourCC('R', 'I', 'F', 'F');
+  header.riff_size = static_cast<u32>(sizeof(AVI_HEADER) - 8 - 4) + movi_list_size + index_size;
+  header.avi_id = MakeFourCC('A', 'V', 'I', ' ');
+
+  header.hdrl_list_id = MakeFourCC('L', 'I', 'S', 'T');
+  header.hdrl_list_size = static_cast<u32>(offsetof(AVI_HEADER, movi_list_id) - offsetof(AVI_HEADER, hdrl_id));
+  header.hdrl_id = MakeFourCC('h', 'd', 'r', 'l');
+
+  header.avih.chunk_id = MakeFourCC('a', 'v', 'i', 'h');
+  header.avih.chunk_size = sizeof(header.avih) - 8;
+  header.avih.microseconds_per_frame =
+    static_cast<u32>((1000000ull * m_frame_rate_denominator) / std::max(m_frame_rate_numerator, 1u));
+  header.avih.flags = AVIF_HASINDEX | AVIF_ISINTERLEAVED;
+  header.avih.total_frames = num_video_frames;
+  header.avih.streams = 2;
+  header.avih.suggested_buffer_size = m_max_video_chunk_size;
+  header.avih.width = m_width;
+  header.avih.height = m_height;
+
+  header.video.list_id = MakeFourCC('L', 'I', 'S', 'T');
+  header.video.list_size = sizeof(header.video) - 8;
+  header.video.strl_id = MakeFourCC('s', 't', 'r', 'l');
+  header.video.strh.chunk_id = MakeFourCC('s', 't', 'r', 'h');
+  header.video.strh.chunk_size = sizeof(header.video.strh) - 8;
+  header.video.strh.type = MakeFourCC('v', 'i', 'd', 's');
+  header.video.strh.handler = MakeFourCC('M', 'J', 'P', 'G');
+  header.video.strh.scale = m_frame_rate_denominator;
+  header.video.strh.rate = m_frame_rate_numerator;
+  header.video.strh.length = num_video_frames;
+  header.video.strh.suggested_buffer_size = m_max_video_chunk_size;
+  header.video.strh.quality = 0xFFFFFFFFu;
+  header.video.strh.frame_right = static_cast<s16>(m_width);
+  header.video.strh.frame_bottom = static_cast<s16>(m_height);
+  header.video.strf.chunk_id = MakeFourCC('s', 't', 'r', 'f');
+  header.video.strf.chunk_size = sizeof(header.video.strf) - 8;
+  header.video.strf.size = sizeof(header.video.strf) - 8;
+  header.video.strf.width = static_cast<s32>(m_width);
+  header.video.strf.height = static_cast<s32>(m_height);
+  header.video.strf.planes = 1;
+  header.video.strf.bit_count = 24;
+  header.video.strf.compression = MakeFourCC('M', 'J', 'P', 'G');
+  header.video.strf.size_image = m_width * m_height * 3;
+
+  header.audio.list_id = MakeFourCC('L', 'I', 'S', 'T');
+  header.audio.list_size = sizeof(header.audio) - 8;
+  header.audio.strl_id = MakeFourCC('s', 't', 'r', 'l');
+  header.audio.strh.chunk_id = MakeFourCC('s', 't', 'r', 'h');
+  header.audio.strh.chunk_size = sizeof(header.audio.strh) - 8;
+  header.audio.strh.type = MakeFourCC('a', 'u', 'd', 's');
+  header.audio.strh.scale = block_align;
+  header.audio.strh.rate = byte_rate;
+  header.audio.strh.length = m_num_audio_frames_written;
+  header.audio.strh.suggested_buffer_size = byte_rate;
+  header.audio.strh.quality = 0xFFFFFFFFu;
+  header.audio.strh.sample_size = block_align;
+  header.audio.strf.chunk_id = MakeFourCC('s', 't', 'r', 'f');
+  header.audio.strf.chunk_size = sizeof(header.audio.strf) - 8;
+  header.audio.strf.format_tag = 1;
+  header.audio.strf.num_channels = static_cast<u16>(m_num_channels);
+  header.audio.strf.sample_rate = m_sample_rate;
+  header.audio.strf.byte_rate = byte_rate;
+  header.audio.strf.block_align = static_cast<u16>(block_align);
+  header.audio.strf.bits_per_sample = 16;
+
+  header.movi_list_id = MakeFourCC('L', 'I', 'S', 'T');
+  header.movi_list_size = movi_list_size;
+  header.movi_id = MakeFourCC('m', 'o', 'v', 'i');
+
+  return (std::fwrite(&header, sizeof(header), 1, m_file) == 1);
+}
+
+} // namespace Common
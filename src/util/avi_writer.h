@@ -0,0 +1,97 @@
+#pragma once
+#include "common/types.h"
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Common {
+
+/// Writes an AVI file with a motion JPEG video stream and an interleaved 16-bit PCM audio stream. Frames are
+/// compressed and written on a worker thread, so the caller only pays for copying the data in.
+class AVIWriter
+{
+public:
+  AVIWriter();
+  ~AVIWriter();
+
+  ALWAYS_INLINE u32 GetWidth() const { return m_width; }
+  ALWAYS_INLINE u32 GetHeight() const { return m_height; }
+  ALWAYS_INLINE u32 GetSampleRate() const { return m_sample_rate; }
+  ALWAYS_INLINE u32 GetNumChannels() const { return m_num_channels; }
+  ALWAYS_INLINE u32 GetNumVideoFrames() const { return m_num_video_frames; }
+  ALWAYS_INLINE bool IsOpen() const { return (m_file != nullptr); }
+
+  bool Open(const char* filename, u32 width, u32 height, float frame_rate, u32 sample_rate, u32 num_channels,
+            u32 jpeg_quality);
+  void Close();
+
+  /// Pixels are RGBA8, exactly width * height with no row padding. If the buffer is empty or the worker has fallen
+  /// too far behind, a dropped frame is written instead, which players display as a repeat of the previous frame.
+  void WriteVideoFrame(std::vector<u32> pixels);
+
+  /// Samples are buffered and written before the next video frame.
+  void WriteAudioFrames(const s16* samples, u32 num_frames);
+
+private:
+  using SampleType = s16;
+
+  // raw frames waiting to be compressed take ~1MB each at 2x resolution, so the queue is kept short
+  static constexpr u32 MAX_QUEUED_VIDEO_FRAMES = 32;
+
+  // AVI 1.0 files use 32-bit sizes, and many readers treat them as signed
+  static constexpr u64 MAX_FILE_SIZE = 0x7C000000;
+
+  struct Packet
+  {
+    std::vector<u32> pixels;
+    std::vector<SampleType> audio;
+    bool has_video;
+  };
+
+  struct IndexEntry
+  {
+    u32 chunk_id;
+    u32 flags;
+    u32 offset;
+    u32 size;
+  };
+
+  bool WriteHeader();
+  bool WriteIndex();
+  void WriteChunk(u32 chunk_id, const void* data, u32 size);
+
+  void QueuePacket(Packet packet);
+  void WriterThreadEntryPoint();
+
+  std::FILE* m_file = nullptr;
+  u32 m_width = 0;
+  u32 m_height = 0;
+  u32 m_frame_rate_numerator = 0;
+  u32 m_frame_rate_denominator = 0;
+  u32 m_sample_rate = 0;
+  u32 m_num_channels = 0;
+  u32 m_jpeg_quality = 0;
+  u32 m_num_video_frames = 0;
+
+  std::vector<SampleType> m_pending_audio;
+
+  std::deque<Packet> m_queued_packets;
+  u32 m_queued_video_frames = 0;
+  std::mutex m_mutex;
+  std::condition_variable m_work_cv;
+  std::thread m_writer_thread;
+  bool m_writer_shutdown = false;
+
+  // only touched by the worker while it's running
+  std::vector<IndexEntry> m_index;
+  std::vector<u8> m_encode_buffer;
+  u64 m_movi_size = 0;
+  u32 m_num_audio_frames_written = 0;
+  u32 m_max_video_chunk_size = 0;
+  bool m_file_full = false;
+};
+
+} // namespace Common
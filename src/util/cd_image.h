@@ -231,6 +231,10 @@ public:
   static std::unique_ptr<CDImage> OverlayPPFPatch(const char* filename, std::unique_ptr<CDImage> parent_image,
                                                   ProgressCallback* progress = ProgressCallback::NullProgressCallback);
 
+  /// Caches sectors read from the parent in cache_directory. Returns the parent unchanged if the cache can't be used.
+  static std::unique_ptr<CDImage> OverlaySectorCache(std::unique_ptr<CDImage> parent_image,
+                                                     const char* cache_directory, u64 max_cache_size);
+
   // Accessors.
   const std::string& GetFileName() const
   {
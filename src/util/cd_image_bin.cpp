@@ -4,6 +4,7 @@
 #include "common/file_system.h"
 #include "common/log.h"
 #include <cerrno>
+#include <cstring>
 Log_SetChannel(CDImageBin);
 
 class CDImageBin : public CDImage
@@ -24,6 +25,10 @@ private:
   std::FILE* m_fp = nullptr;
   u64 m_file_position = 0;
 
+  // sectors are copied straight out of the page cache when the file can be mapped
+  const u8* m_mapping = nullptr;
+  size_t m_mapping_size = 0;
+
   CDSubChannelReplacement m_sbi;
 };
 
@@ -31,6 +36,7 @@ CDImageBin::CDImageBin() = default;
 
 CDImageBin::~CDImageBin()
 {
+  FileSystem::UnmapCFile(m_mapping, m_mapping_size);
   if (m_fp)
     std::fclose(m_fp);
 }
@@ -54,6 +60,14 @@ bool CDImageBin::Open(const char* filename, Common::Error* error)
   const u32 file_size = static_cast<u32>(std::ftell(m_fp));
   std::fseek(m_fp, 0, SEEK_SET);
 
+  // a whole disc doesn't reliably fit in a 32-bit address space
+  if constexpr (sizeof(void*) >= 8)
+  {
+    m_mapping = static_cast<const u8*>(FileSystem::MapCFile(m_fp, file_size));
+    if (m_mapping)
+      m_mapping_size = file_size;
+  }
+
   m_lba_count = file_size / track_sector_size;
 
   SubChannelQ::Control control = {};
@@ -115,6 +129,15 @@ bool CDImageBin::HasNonStandardSubchannel() const
 bool CDImageBin::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index)
 {
   const u64 file_position = index.file_offset + (static_cast<u64>(lba_in_index) * index.file_sector_size);
+  if (m_mapping)
+  {
+    if ((file_position + index.file_sector_size) > m_mapping_size)
+      return false;
+
+    std::memcpy(buffer, m_mapping + file_position, index.file_sector_size);
+    return true;
+  }
+
   if (m_file_position != file_position)
   {
     if (std::fseek(m_fp, static_cast<long>(file_position), SEEK_SET) != 0)
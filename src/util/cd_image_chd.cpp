@@ -9,16 +9,21 @@
 #include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/lru_cache.h"
 #include "common/platform.h"
 #include "fmt/format.h"
 #include "libchdr/chd.h"
 #include <algorithm>
 #include <cerrno>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
+#include <deque>
 #include <limits>
 #include <map>
+#include <mutex>
 #include <optional>
+#include <thread>
 Log_SetChannel(CDImageCHD);
 
 static std::optional<CDImage::TrackMode> ParseTrackModeString(const char* str)
@@ -63,20 +68,60 @@ private:
   enum : u32
   {
     CHD_CD_SECTOR_DATA_SIZE = 2352 + 96,
-    CHD_CD_TRACK_ALIGNMENT = 4
+    CHD_CD_TRACK_ALIGNMENT = 4,
+
+    // hunks are usually 8 sectors, so this is a little over 600KB of decompressed data
+    HUNK_CACHE_SIZE = 32,
+    PREFETCH_HUNK_COUNT = 4,
+    MAX_PREFETCH_WORKERS = 2,
+
+    // metadata-only opens read a few scattered sectors, so workers only start once the disc is being read through
+    PREFETCH_START_SEQUENTIAL_MISSES = 4,
+  };
+
+  // libchdr handles aren't thread safe, so each worker decompresses from its own
+  struct PrefetchWorker
+  {
+    std::FILE* fp;
+    chd_file* chd;
+    std::thread thread;
   };
 
-  bool ReadHunk(u32 hunk_index);
+  const u8* GetHunk(u32 hunk_index);
+  bool ReadHunk(chd_file* chd, u32 hunk_index, std::vector<u8>* buffer);
+
+  void StartPrefetchWorkers();
+  void StopPrefetchWorkers();
+  void PrefetchWorkerThread(chd_file* chd);
+  void QueuePrefetch(u32 hunk_index, bool after_seek);
+  void CollectPrefetchedHunks(std::unique_lock<std::mutex>& lock);
 
   std::FILE* m_fp = nullptr;
   chd_file* m_chd = nullptr;
   u32 m_hunk_size = 0;
+  u32 m_hunk_count = 0;
   u32 m_sectors_per_hunk = 0;
 
-  std::vector<u8> m_hunk_buffer;
+  // only accessed from the thread reading sectors
+  LRUCache<u32, std::vector<u8>> m_hunk_cache{HUNK_CACHE_SIZE};
   u32 m_current_hunk_index = static_cast<u32>(-1);
+  const u8* m_current_hunk = nullptr;
   bool m_precached = false;
 
+  // misses are only counted until the workers have been started once
+  u32 m_last_missed_hunk_index = static_cast<u32>(-1);
+  u32 m_sequential_hunk_misses = 0;
+  bool m_prefetch_started = false;
+
+  std::vector<PrefetchWorker> m_prefetch_workers;
+  std::mutex m_prefetch_mutex;
+  std::condition_variable m_prefetch_work_cv;
+  std::condition_variable m_prefetch_done_cv;
+  std::deque<u32> m_prefetch_queue;
+  std::vector<u32> m_prefetch_in_flight;
+  std::vector<std::pair<u32, std::vector<u8>>> m_prefetched_hunks;
+  bool m_prefetch_shutdown = false;
+
   CDSubChannelReplacement m_sbi;
 };
 
@@ -84,6 +129,8 @@ CDImageCHD::CDImageCHD() = default;
 
 CDImageCHD::~CDImageCHD()
 {
+  StopPrefetchWorkers();
+
   if (m_chd)
     chd_close(m_chd);
   if (m_fp)
@@ -125,7 +172,7 @@ bool CDImageCHD::Open(const char* filename, Common::Error* error)
   }
 
   m_sectors_per_hunk = m_hunk_size / CHD_CD_SECTOR_DATA_SIZE;
-  m_hunk_buffer.resize(m_hunk_size);
+  m_hunk_count = header->totalhunks;
   m_filename = filename;
 
   u32 disc_lba = 0;
@@ -289,6 +336,114 @@ bool CDImageCHD::Open(const char* filename, Common::Error* error)
   return Seek(1, Position{0, 0, 0});
 }
 
+void CDImageCHD::StartPrefetchWorkers()
+{
+  m_prefetch_started = true;
+
+  // leave a core for the emulator and one for the read thread itself
+  const u32 num_cpus = std::thread::hardware_concurrency();
+  const u32 num_workers = std::min<u32>(MAX_PREFETCH_WORKERS, (num_cpus > 2) ? ((num_cpus - 1) / 2) : 0);
+
+  m_prefetch_shutdown = false;
+  for (u32 i = 0; i < num_workers; i++)
+  {
+    std::FILE* fp = FileSystem::OpenCFile(m_filename.c_str(), "rb");
+    if (!fp)
+      break;
+
+    chd_file* chd;
+    if (chd_open_file(fp, CHD_OPEN_READ, nullptr, &chd) != CHDERR_NONE)
+    {
+      std::fclose(fp);
+      break;
+    }
+
+    PrefetchWorker& worker = m_prefetch_workers.emplace_back();
+    worker.fp = fp;
+    worker.chd = chd;
+    worker.thread = std::thread(&CDImageCHD::PrefetchWorkerThread, this, chd);
+  }
+
+  Log_DevPrintf("Using %zu hunk prefetch workers", m_prefetch_workers.size());
+}
+
+void CDImageCHD::StopPrefetchWorkers()
+{
+  {
+    std::unique_lock lock(m_prefetch_mutex);
+    m_prefetch_shutdown = true;
+    m_prefetch_queue.clear();
+    m_prefetch_work_cv.notify_all();
+  }
+
+  for (PrefetchWorker& worker : m_prefetch_workers)
+  {
+    worker.thread.join();
+    chd_close(worker.chd);
+    std::fclose(worker.fp);
+  }
+
+  m_prefetch_workers.clear();
+  m_prefetched_hunks.clear();
+}
+
+void CDImageCHD::PrefetchWorkerThread(chd_file* chd)
+{
+  std::unique_lock lock(m_prefetch_mutex);
+  for (;;)
+  {
+    m_prefetch_work_cv.wait(lock, [this]() { return m_prefetch_shutdown || !m_prefetch_queue.empty(); });
+    if (m_prefetch_shutdown)
+      break;
+
+    const u32 hunk_index = m_prefetch_queue.front();
+    m_prefetch_queue.pop_front();
+    m_prefetch_in_flight.push_back(hunk_index);
+    lock.unlock();
+
+    std::vector<u8> buffer;
+    const bool result = ReadHunk(chd, hunk_index, &buffer);
+
+    lock.lock();
+    m_prefetch_in_flight.erase(std::find(m_prefetch_in_flight.begin(), m_prefetch_in_flight.end(), hunk_index));
+    if (result)
+      m_prefetched_hunks.emplace_back(hunk_index, std::move(buffer));
+    m_prefetch_done_cv.notify_all();
+  }
+}
+
+void CDImageCHD::CollectPrefetchedHunks(std::unique_lock<std::mutex>& lock)
+{
+  for (auto& [hunk_index, buffer] : m_prefetched_hunks)
+    m_hunk_cache.Insert(hunk_index, std::move(buffer));
+  m_prefetched_hunks.clear();
+}
+
+void CDImageCHD::QueuePrefetch(u32 hunk_index, bool after_seek)
+{
+  std::unique_lock lock(m_prefetch_mutex);
+  CollectPrefetchedHunks(lock);
+
+  // anything still waiting from before the seek is no longer useful
+  if (after_seek)
+    m_prefetch_queue.clear();
+
+  const u32 last_hunk_index = std::min(hunk_index + PREFETCH_HUNK_COUNT, m_hunk_count - 1);
+  for (u32 prefetch_index = hunk_index + 1; prefetch_index <= last_hunk_index; prefetch_index++)
+  {
+    if (m_hunk_cache.Lookup(prefetch_index) ||
+        std::find(m_prefetch_queue.begin(), m_prefetch_queue.end(), prefetch_index) != m_prefetch_queue.end() ||
+        std::find(m_prefetch_in_flight.begin(), m_prefetch_in_flight.end(), prefetch_index) !=
+          m_prefetch_in_flight.end())
+    {
+      continue;
+    }
+
+    m_prefetch_queue.push_back(prefetch_index);
+    m_prefetch_work_cv.notify_one();
+  }
+}
+
 bool CDImageCHD::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
 {
   if (m_sbi.GetReplacementSubChannelQ(index.start_lba_on_disc + lba_in_index, subq))
@@ -320,7 +475,9 @@ CDImage::PrecacheResult CDImageCHD::Precache(ProgressCallback* progress)
   if (chd_precache_progress(m_chd, callback, progress) != CHDERR_NONE)
     return CDImage::PrecacheResult::ReadError;
 
+  // the workers' handles aren't precached, so they would only be decompressing from disk for nothing
   m_precached = true;
+  StopPrefetchWorkers();
   return CDImage::PrecacheResult::Success;
 }
 
@@ -376,31 +533,87 @@ bool CDImageCHD::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
   const u32 hunk_offset = static_cast<u32>((disc_frame % m_sectors_per_hunk) * CHD_CD_SECTOR_DATA_SIZE);
   DebugAssert((m_hunk_size - hunk_offset) >= CHD_CD_SECTOR_DATA_SIZE);
 
-  if (m_current_hunk_index != hunk_index && !ReadHunk(hunk_index))
-    return false;
+  if (m_current_hunk_index != hunk_index)
+  {
+    m_current_hunk = GetHunk(hunk_index);
+    m_current_hunk_index = m_current_hunk ? hunk_index : static_cast<u32>(-1);
+    if (!m_current_hunk)
+      return false;
+  }
 
   // Audio data is in big-endian, so we have to swap it for little endian hosts...
   if (index.mode == TrackMode::Audio)
-    CopyAndSwap(buffer, &m_hunk_buffer[hunk_offset], RAW_SECTOR_SIZE);
+    CopyAndSwap(buffer, &m_current_hunk[hunk_offset], RAW_SECTOR_SIZE);
   else
-    std::memcpy(buffer, &m_hunk_buffer[hunk_offset], RAW_SECTOR_SIZE);
+    std::memcpy(buffer, &m_current_hunk[hunk_offset], RAW_SECTOR_SIZE);
 
   return true;
 }
 
-bool CDImageCHD::ReadHunk(u32 hunk_index)
+const u8* CDImageCHD::GetHunk(u32 hunk_index)
 {
-  const chd_error err = chd_read(m_chd, hunk_index, m_hunk_buffer.data());
+  const std::vector<u8>* hunk = m_hunk_cache.Lookup(hunk_index);
+  if (!hunk && !m_prefetch_workers.empty())
+  {
+    // a worker may already be decompressing it, in which case it's quicker to wait than start over
+    std::unique_lock lock(m_prefetch_mutex);
+    m_prefetch_done_cv.wait(lock, [this, hunk_index]() {
+      return std::find(m_prefetch_in_flight.begin(), m_prefetch_in_flight.end(), hunk_index) ==
+             m_prefetch_in_flight.end();
+    });
+    CollectPrefetchedHunks(lock);
+    hunk = m_hunk_cache.Lookup(hunk_index);
+
+    // not started yet, we'll decompress it ourselves
+    if (!hunk)
+    {
+      if (auto iter = std::find(m_prefetch_queue.begin(), m_prefetch_queue.end(), hunk_index);
+          iter != m_prefetch_queue.end())
+      {
+        m_prefetch_queue.erase(iter);
+      }
+    }
+  }
+
+  // nothing had it, so this is most likely a seek to a new area of the disc
+  const bool seeked = !hunk;
+  if (!hunk)
+  {
+    std::vector<u8> buffer;
+    if (!ReadHunk(m_chd, hunk_index, &buffer))
+      return nullptr;
+
+    hunk = m_hunk_cache.Insert(hunk_index, std::move(buffer));
+
+    if (!m_prefetch_started && !m_precached)
+    {
+      m_sequential_hunk_misses = (hunk_index == (m_last_missed_hunk_index + 1)) ? (m_sequential_hunk_misses + 1) : 1;
+      m_last_missed_hunk_index = hunk_index;
+      if (m_sequential_hunk_misses >= PREFETCH_START_SEQUENTIAL_MISSES)
+        StartPrefetchWorkers();
+    }
+  }
+
+  // the pointer stays valid until the hunk is evicted, which prefetching can do, so look it up again afterwards
+  if (!m_prefetch_workers.empty())
+  {
+    QueuePrefetch(hunk_index, seeked);
+    hunk = m_hunk_cache.Lookup(hunk_index);
+  }
+
+  return hunk ? hunk->data() : nullptr;
+}
+
+bool CDImageCHD::ReadHunk(chd_file* chd, u32 hunk_index, std::vector<u8>* buffer)
+{
+  buffer->resize(m_hunk_size);
+  const chd_error err = chd_read(chd, hunk_index, buffer->data());
   if (err != CHDERR_NONE)
   {
     Log_ErrorPrintf("chd_read(%u) failed: %s", hunk_index, chd_error_string(err));
-
-    // data might have been partially written
-    m_current_hunk_index = static_cast<u32>(-1);
     return false;
   }
 
-  m_current_hunk_index = hunk_index;
   return true;
 }
 
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <cerrno>
 #include <cinttypes>
+#include <cstring>
 #include <map>
 Log_SetChannel(CDImageCueSheet);
 
@@ -32,6 +33,10 @@ private:
     std::string filename;
     std::FILE* file;
     u64 file_position;
+
+    // sectors are copied straight out of the page cache when the file can be mapped
+    const u8* mapping;
+    size_t mapping_size;
   };
 
   std::vector<TrackFile> m_files;
@@ -42,7 +47,10 @@ CDImageCueSheet::CDImageCueSheet() = default;
 
 CDImageCueSheet::~CDImageCueSheet()
 {
-  std::for_each(m_files.begin(), m_files.end(), [](TrackFile& t) { std::fclose(t.file); });
+  std::for_each(m_files.begin(), m_files.end(), [](TrackFile& t) {
+    FileSystem::UnmapCFile(t.mapping, t.mapping_size);
+    std::fclose(t.file);
+  });
 }
 
 bool CDImageCueSheet::OpenAndParse(const char* filename, Common::Error* error)
@@ -118,7 +126,19 @@ bool CDImageCueSheet::OpenAndParse(const char* filename, Common::Error* error)
         return false;
       }
 
-      m_files.push_back(TrackFile{std::move(track_filename), track_fp, 0});
+      TrackFile& tf = m_files.emplace_back(TrackFile{std::move(track_filename), track_fp, 0, nullptr, 0});
+
+      // a whole disc doesn't reliably fit in a 32-bit address space
+      if constexpr (sizeof(void*) >= 8)
+      {
+        const s64 file_size = FileSystem::FSize64(track_fp);
+        if (file_size > 0)
+        {
+          tf.mapping = static_cast<const u8*>(FileSystem::MapCFile(track_fp, static_cast<size_t>(file_size)));
+          if (tf.mapping)
+            tf.mapping_size = static_cast<size_t>(file_size);
+        }
+      }
     }
 
     // data type determines the sector size
@@ -312,6 +332,15 @@ bool CDImageCueSheet::ReadSectorFromIndex(void* buffer, const Index& index, LBA
 
   TrackFile& tf = m_files[index.file_index];
   const u64 file_position = index.file_offset + (static_cast<u64>(lba_in_index) * index.file_sector_size);
+  if (tf.mapping)
+  {
+    if ((file_position + index.file_sector_size) > tf.mapping_size)
+      return false;
+
+    std::memcpy(buffer, tf.mapping + file_position, index.file_sector_size);
+    return true;
+  }
+
   if (tf.file_position != file_position)
   {
     if (std::fseek(tf.file, static_cast<long>(file_position), SEEK_SET) != 0)
@@ -4,9 +4,15 @@
 #include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/progress_callback.h"
+#include "fmt/format.h"
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cerrno>
+#include <cstring>
 #include <map>
+#include <thread>
 Log_SetChannel(CDImageEcm);
 
 // unecm.c by Neill Corlett (c) 2002, GPL licensed
@@ -48,9 +54,22 @@ static constexpr std::array<u32, 256> ComputeEDCLUT()
   return edc_lut;
 }
 
+// Tables for slicing-by-8, table N advances the CRC past N further zero bytes.
+static constexpr std::array<std::array<u32, 256>, 8> ComputeEDCSlicedLUT()
+{
+  std::array<std::array<u32, 256>, 8> edc_lut{};
+  edc_lut[0] = ComputeEDCLUT();
+  for (u32 n = 1; n < 8; n++)
+  {
+    for (u32 i = 0; i < 256; i++)
+      edc_lut[n][i] = (edc_lut[n - 1][i] >> 8) ^ edc_lut[0][edc_lut[n - 1][i] & 0xFF];
+  }
+  return edc_lut;
+}
+
 static constexpr std::array<u8, 256> ecc_f_lut = ComputeECCFLUT();
 static constexpr std::array<u8, 256> ecc_b_lut = ComputeECCBLUT();
-static constexpr std::array<u32, 256> edc_lut = ComputeEDCLUT();
+static constexpr std::array<std::array<u32, 256>, 8> edc_lut = ComputeEDCSlicedLUT();
 
 /***************************************************************************/
 /*
@@ -58,8 +77,22 @@ static constexpr std::array<u32, 256> edc_lut = ComputeEDCLUT();
 */
 static u32 edc_partial_computeblock(u32 edc, const u8* src, u16 size)
 {
+  // eight bytes per iteration, the loads are little endian like the CRC
+  while (size >= 8)
+  {
+    u32 lo, hi;
+    std::memcpy(&lo, src, sizeof(lo));
+    std::memcpy(&hi, src + 4, sizeof(hi));
+    lo ^= edc;
+    edc = edc_lut[7][lo & 0xFF] ^ edc_lut[6][(lo >> 8) & 0xFF] ^ edc_lut[5][(lo >> 16) & 0xFF] ^
+          edc_lut[4][lo >> 24] ^ edc_lut[3][hi & 0xFF] ^ edc_lut[2][(hi >> 8) & 0xFF] ^
+          edc_lut[1][(hi >> 16) & 0xFF] ^ edc_lut[0][hi >> 24];
+    src += 8;
+    size -= 8;
+  }
+
   while (size--)
-    edc = (edc >> 8) ^ edc_lut[(edc ^ (*src++)) & 0xFF];
+    edc = (edc >> 8) ^ edc_lut[0][(edc ^ (*src++)) & 0xFF];
   return edc;
 }
 
@@ -75,29 +108,68 @@ static void edc_computeblock(const u8* src, u16 size, u8* dest)
 /***************************************************************************/
 /*
 ** Compute ECC for a block (can do either P or Q)
+**
+** Rather than walking each major (column) in turn, all majors are advanced together one minor (row) at a time, with
+** the GF(2^8) multiply by two applied to eight bytes at once. Only the final combine needs the lookup tables.
 */
-static void ecc_computeblock(u8* src, u32 major_count, u32 minor_count, u32 major_mult, u32 minor_inc, u8* dest)
+template<u32 major_count, u32 minor_count, u32 major_mult, u32 minor_inc>
+static constexpr std::array<u16, major_count * minor_count> ComputeECCIndices()
 {
-  u32 size = major_count * minor_count;
-  u32 major, minor;
-  for (major = 0; major < major_count; major++)
+  constexpr u32 size = major_count * minor_count;
+  std::array<u16, size> indices{};
+  for (u32 major = 0; major < major_count; major++)
   {
     u32 index = (major >> 1) * major_mult + (major & 1);
-    u8 ecc_a = 0;
-    u8 ecc_b = 0;
-    for (minor = 0; minor < minor_count; minor++)
+    for (u32 minor = 0; minor < minor_count; minor++)
     {
-      u8 temp = src[index];
+      indices[minor * major_count + major] = static_cast<u16>(index);
       index += minor_inc;
       if (index >= size)
         index -= size;
-      ecc_a ^= temp;
-      ecc_b ^= temp;
-      ecc_a = ecc_f_lut[ecc_a];
     }
-    ecc_a = ecc_b_lut[ecc_f_lut[ecc_a] ^ ecc_b];
-    dest[major] = ecc_a;
-    dest[major + major_count] = ecc_a ^ ecc_b;
+  }
+  return indices;
+}
+
+ALWAYS_INLINE static u64 ecc_mul2(u64 v)
+{
+  return ((v & 0x7F7F7F7F7F7F7F7FULL) << 1) ^ (((v >> 7) & 0x0101010101010101ULL) * 0x1D);
+}
+
+template<u32 major_count, u32 minor_count, u32 major_mult, u32 minor_inc>
+static void ecc_computeblock(const u8* src, u8* dest)
+{
+  static constexpr std::array<u16, major_count * minor_count> indices =
+    ComputeECCIndices<major_count, minor_count, major_mult, minor_inc>();
+  constexpr u32 num_words = (major_count + 7) / 8;
+
+  u64 ecc_a[num_words] = {};
+  u64 ecc_b[num_words] = {};
+  for (u32 minor = 0; minor < minor_count; minor++)
+  {
+    u8 row[num_words * 8] = {};
+    const u16* row_indices = &indices[minor * major_count];
+    for (u32 major = 0; major < major_count; major++)
+      row[major] = src[row_indices[major]];
+
+    for (u32 i = 0; i < num_words; i++)
+    {
+      u64 temp;
+      std::memcpy(&temp, &row[i * 8], sizeof(temp));
+      ecc_a[i] = ecc_mul2(ecc_a[i] ^ temp);
+      ecc_b[i] ^= temp;
+    }
+  }
+
+  u8 ecc_a_bytes[num_words * 8];
+  u8 ecc_b_bytes[num_words * 8];
+  std::memcpy(ecc_a_bytes, ecc_a, sizeof(ecc_a_bytes));
+  std::memcpy(ecc_b_bytes, ecc_b, sizeof(ecc_b_bytes));
+  for (u32 major = 0; major < major_count; major++)
+  {
+    const u8 a = ecc_b_lut[ecc_f_lut[ecc_a_bytes[major]] ^ ecc_b_bytes[major]];
+    dest[major] = a;
+    dest[major + major_count] = a ^ ecc_b_bytes[major];
   }
 }
 
@@ -115,9 +187,9 @@ static void ecc_generate(u8* sector, int zeroaddress)
       sector[12 + i] = 0;
     }
   /* Compute ECC P code */
-  ecc_computeblock(sector + 0xC, 86, 24, 2, 86, sector + 0x81C);
+  ecc_computeblock<86, 24, 2, 86>(sector + 0xC, sector + 0x81C);
   /* Compute ECC Q code */
-  ecc_computeblock(sector + 0xC, 52, 43, 86, 88, sector + 0x8C8);
+  ecc_computeblock<52, 43, 86, 88>(sector + 0xC, sector + 0x8C8);
   /* Restore the address */
   if (zeroaddress)
     for (i = 0; i < 4; i++)
@@ -166,12 +238,13 @@ public:
   bool ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index) override;
   bool HasNonStandardSubchannel() const override;
 
+  PrecacheResult Precache(ProgressCallback* progress) override;
+  bool IsPrecached() const override;
+
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
 
 private:
-  bool ReadChunks(u32 disc_offset, u32 size);
-
   std::FILE* m_fp = nullptr;
 
   enum class SectorType : u32
@@ -206,9 +279,16 @@ private:
 
   using DataMap = std::map<u32, SectorEntry>;
 
+  static bool DecodeChunk(std::FILE* fp, const SectorEntry& entry, u8* dest);
+  bool ReadChunks(u32 disc_offset, u32 size);
+
   DataMap m_data_map;
   std::vector<u8> m_chunk_buffer;
   u32 m_chunk_start = 0;
+  u32 m_disc_size = 0;
+
+  // the whole decoded disc, when precached
+  std::vector<u8> m_precached_data;
 
   CDSubChannelReplacement m_sbi;
 };
@@ -364,6 +444,7 @@ bool CDImageEcm::Open(const char* filename, Common::Error* error)
     return false;
   }
 
+  m_disc_size = disc_offset;
   m_lba_count = disc_offset / RAW_SECTOR_SIZE;
   if ((disc_offset % RAW_SECTOR_SIZE) != 0)
     Log_WarningPrintf("ECM image is misaligned with offset %u", disc_offset);
@@ -414,6 +495,75 @@ bool CDImageEcm::Open(const char* filename, Common::Error* error)
   return Seek(1, Position{0, 0, 0});
 }
 
+bool CDImageEcm::DecodeChunk(std::FILE* fp, const SectorEntry& entry, u8* dest)
+{
+  if (std::fseek(fp, entry.file_offset, SEEK_SET) != 0)
+    return false;
+
+  if (entry.type == SectorType::Raw)
+    return (std::fread(dest, entry.chunk_size, 1, fp) == 1);
+
+  u8 sector[RAW_SECTOR_SIZE];
+
+  // TODO: needed?
+  std::memset(sector, 0, RAW_SECTOR_SIZE);
+  std::memset(sector + 1, 0xFF, 10);
+
+  u32 skip;
+  switch (entry.type)
+  {
+    case SectorType::Mode1:
+    {
+      sector[0x0F] = 0x01;
+      if (std::fread(sector + 0x00C, 0x003, 1, fp) != 1 || std::fread(sector + 0x010, 0x800, 1, fp) != 1)
+        return false;
+
+      eccedc_generate(sector, 1);
+      skip = 0;
+    }
+    break;
+
+    case SectorType::Mode2Form1:
+    {
+      sector[0x0F] = 0x02;
+      if (std::fread(sector + 0x014, 0x804, 1, fp) != 1)
+        return false;
+
+      sector[0x10] = sector[0x14];
+      sector[0x11] = sector[0x15];
+      sector[0x12] = sector[0x16];
+      sector[0x13] = sector[0x17];
+
+      eccedc_generate(sector, 2);
+      skip = 0x10;
+    }
+    break;
+
+    case SectorType::Mode2Form2:
+    {
+      sector[0x0F] = 0x02;
+      if (std::fread(sector + 0x014, 0x918, 1, fp) != 1)
+        return false;
+
+      sector[0x10] = sector[0x14];
+      sector[0x11] = sector[0x15];
+      sector[0x12] = sector[0x16];
+      sector[0x13] = sector[0x17];
+
+      eccedc_generate(sector, 3);
+      skip = 0x10;
+    }
+    break;
+
+    default:
+      UnreachableCode();
+      return false;
+  }
+
+  std::memcpy(dest, sector + skip, entry.chunk_size);
+  return true;
+}
+
 bool CDImageEcm::ReadChunks(u32 disc_offset, u32 size)
 {
   DataMap::iterator next =
@@ -431,88 +581,102 @@ bool CDImageEcm::ReadChunks(u32 disc_offset, u32 size)
   u32 total_bytes_read = 0;
   while (total_bytes_read < size)
   {
-    if (current == m_data_map.end() || std::fseek(m_fp, current->second.file_offset, SEEK_SET) != 0)
+    if (current == m_data_map.end())
       return false;
 
     const u32 chunk_size = current->second.chunk_size;
     const u32 chunk_start = static_cast<u32>(m_chunk_buffer.size());
     m_chunk_buffer.resize(chunk_start + chunk_size);
+    if (!DecodeChunk(m_fp, current->second, &m_chunk_buffer[chunk_start]))
+      return false;
 
-    if (current->second.type == SectorType::Raw)
-    {
-      if (std::fread(&m_chunk_buffer[chunk_start], chunk_size, 1, m_fp) != 1)
-        return false;
+    total_bytes_read += chunk_size;
+    ++current;
+  }
 
-      total_bytes_read += chunk_size;
-    }
-    else
-    {
-      // u8* sector = &m_chunk_buffer[chunk_start];
-      u8 sector[RAW_SECTOR_SIZE];
+  return true;
+}
 
-      // TODO: needed?
-      std::memset(sector, 0, RAW_SECTOR_SIZE);
-      std::memset(sector + 1, 0xFF, 10);
+CDImage::PrecacheResult CDImageEcm::Precache(ProgressCallback* progress)
+{
+  if (!m_precached_data.empty())
+    return CDImage::PrecacheResult::Success;
+
+  progress->SetStatusText(fmt::format("Precaching {}...", FileSystem::GetDisplayNameFromPath(m_filename)).c_str());
+  progress->SetProgressRange(100);
+
+  // Chunks don't depend on each other, so split the disc into one contiguous range per thread. Each worker gets its
+  // own file handle, and this thread takes the first range so it can report progress.
+  const u32 num_threads = std::clamp<u32>(std::thread::hardware_concurrency(), 1, 8);
+  const size_t num_chunks = m_data_map.size();
+  std::vector<DataMap::const_iterator> range_starts;
+  range_starts.reserve(num_threads + 1);
+  {
+    DataMap::const_iterator iter = m_data_map.begin();
+    for (u32 i = 0; i < num_threads; i++)
+    {
+      range_starts.push_back(iter);
+      std::advance(iter, (num_chunks * (i + 1)) / num_threads - (num_chunks * i) / num_threads);
+    }
+    range_starts.push_back(m_data_map.end());
+  }
 
-      u32 skip;
-      switch (current->second.type)
+  std::vector<u8> data(m_disc_size);
+  std::atomic_bool failed{false};
+  auto decode_range = [this, &data, &failed](std::FILE* fp, DataMap::const_iterator begin,
+                                             DataMap::const_iterator end, ProgressCallback* progress) {
+    const size_t count = static_cast<size_t>(std::distance(begin, end));
+    size_t done = 0;
+    for (DataMap::const_iterator iter = begin; iter != end && !failed.load(std::memory_order_relaxed); ++iter, done++)
+    {
+      if (!DecodeChunk(fp, iter->second, &data[iter->first]))
       {
-        case SectorType::Mode1:
-        {
-          sector[0x0F] = 0x01;
-          if (std::fread(sector + 0x00C, 0x003, 1, m_fp) != 1 || std::fread(sector + 0x010, 0x800, 1, m_fp) != 1)
-            return false;
-
-          eccedc_generate(sector, 1);
-          skip = 0;
-        }
+        Log_ErrorPrintf("Failed to decode chunk at offset %u", iter->first);
+        failed.store(true);
         break;
+      }
 
-        case SectorType::Mode2Form1:
-        {
-          sector[0x0F] = 0x02;
-          if (std::fread(sector + 0x014, 0x804, 1, m_fp) != 1)
-            return false;
-
-          sector[0x10] = sector[0x14];
-          sector[0x11] = sector[0x15];
-          sector[0x12] = sector[0x16];
-          sector[0x13] = sector[0x17];
+      if (progress && (done % 1024) == 0)
+        progress->SetProgressValue(static_cast<u32>((done * 100) / count));
+    }
+  };
 
-          eccedc_generate(sector, 2);
-          skip = 0x10;
-        }
-        break;
+  std::vector<std::thread> threads;
+  std::vector<std::FILE*> files;
+  for (u32 i = 1; i < num_threads; i++)
+  {
+    std::FILE* fp = FileSystem::OpenCFile(m_filename.c_str(), "rb");
+    if (!fp)
+    {
+      failed.store(true);
+      break;
+    }
 
-        case SectorType::Mode2Form2:
-        {
-          sector[0x0F] = 0x02;
-          if (std::fread(sector + 0x014, 0x918, 1, m_fp) != 1)
-            return false;
+    files.push_back(fp);
+    threads.emplace_back(decode_range, fp, range_starts[i], range_starts[i + 1], nullptr);
+  }
 
-          sector[0x10] = sector[0x14];
-          sector[0x11] = sector[0x15];
-          sector[0x12] = sector[0x16];
-          sector[0x13] = sector[0x17];
+  // decoding in this thread moves m_fp, but ReadChunks always seeks first
+  decode_range(m_fp, range_starts[0], range_starts[1], progress);
 
-          eccedc_generate(sector, 3);
-          skip = 0x10;
-        }
-        break;
+  for (std::thread& thread : threads)
+    thread.join();
+  for (std::FILE* fp : files)
+    std::fclose(fp);
 
-        default:
-          UnreachableCode();
-          return false;
-      }
+  // if a handle couldn't be opened, not every range was decoded
+  if (failed.load() || threads.size() != (num_threads - 1))
+    return CDImage::PrecacheResult::ReadError;
 
-      std::memcpy(&m_chunk_buffer[chunk_start], sector + skip, chunk_size);
-      total_bytes_read += chunk_size;
-    }
-
-    ++current;
-  }
+  progress->SetProgressValue(100);
+  m_precached_data = std::move(data);
+  m_chunk_buffer = {};
+  return CDImage::PrecacheResult::Success;
+}
 
-  return true;
+bool CDImageEcm::IsPrecached() const
+{
+  return !m_precached_data.empty();
 }
 
 bool CDImageEcm::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
@@ -533,6 +697,15 @@ bool CDImageEcm::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
   const u32 file_start = static_cast<u32>(index.file_offset) + (lba_in_index * index.file_sector_size);
   const u32 file_end = file_start + RAW_SECTOR_SIZE;
 
+  if (!m_precached_data.empty())
+  {
+    if (file_end > m_precached_data.size())
+      return false;
+
+    std::memcpy(buffer, &m_precached_data[file_start], RAW_SECTOR_SIZE);
+    return true;
+  }
+
   if (file_start < m_chunk_start || file_end > (m_chunk_start + m_chunk_buffer.size()))
   {
     if (!ReadChunks(file_start, RAW_SECTOR_SIZE))
@@ -1,11 +1,30 @@
 #include "cd_image_hasher.h"
 #include "cd_image.h"
+#include "common/byte_stream.h"
+#include "common/file_system.h"
+#include "common/log.h"
 #include "common/md5_digest.h"
 #include "common/string_util.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+Log_SetChannel(CDImageHasher);
 
 namespace CDImageHasher {
 
-static bool ReadIndex(CDImage* image, u8 track, u8 index, MD5Digest* digest, ProgressCallback* progress_callback)
+static constexpr u32 HASH_CACHE_SIGNATURE = 0x48534854; // THSH
+static constexpr u32 HASH_CACHE_VERSION = 1;
+static constexpr u32 MAX_HASH_THREADS = 4;
+static constexpr u32 MAX_TRACKS = 99;
+
+static bool LookupCachedHashes(const char* cache_filename, const std::string& path, u64 size, u64 mtime,
+                               std::vector<Hash>* out_hashes);
+static void StoreCachedHashes(const char* cache_filename, const std::string& path, u64 size, u64 mtime,
+                              const std::vector<Hash>& hashes);
+
+static bool ReadIndex(CDImage* image, u8 track, u8 index, MD5Digest* digest, ProgressCallback* progress_callback,
+                      std::atomic<u32>* sectors_done = nullptr)
 {
   const CDImage::LBA index_start = image->GetTrackIndexPosition(track, index);
   const u32 index_length = image->GetTrackIndexLength(track, index);
@@ -34,13 +53,16 @@ static bool ReadIndex(CDImage* image, u8 track, u8 index, MD5Digest* digest, Pro
     }
 
     digest->Update(sector.data(), static_cast<u32>(sector.size()));
+    if (sectors_done)
+      sectors_done->fetch_add(1, std::memory_order_relaxed);
   }
 
   progress_callback->SetProgressValue(index_length);
   return true;
 }
 
-static bool ReadTrack(CDImage* image, u8 track, MD5Digest* digest, ProgressCallback* progress_callback)
+static bool ReadTrack(CDImage* image, u8 track, MD5Digest* digest, ProgressCallback* progress_callback,
+                      std::atomic<u32>* sectors_done = nullptr)
 {
   static constexpr u8 INDICES_TO_READ = 2;
 
@@ -60,7 +82,7 @@ static bool ReadTrack(CDImage* image, u8 track, MD5Digest* digest, ProgressCallb
 
     progress++;
     progress_callback->PushState();
-    if (!ReadIndex(image, track, index, digest, progress_callback))
+    if (!ReadIndex(image, track, index, digest, progress_callback, sectors_done))
     {
       progress_callback->PopState();
       progress_callback->PopState();
@@ -128,4 +150,184 @@ bool GetTrackHash(CDImage* image, u8 track, Hash* out_hash,
   return true;
 }
 
-} // namespace CDImageHasher
\ No newline at end of file
+bool GetTrackHashes(const char* path, std::vector<Hash>* out_hashes, const char* cache_filename /* = nullptr */,
+                    ProgressCallback* progress_callback /* = ProgressCallback::NullProgressCallback */)
+{
+  FILESYSTEM_STAT_DATA sd;
+  const bool has_stat = FileSystem::StatFile(path, &sd);
+  if (cache_filename && has_stat &&
+      LookupCachedHashes(cache_filename, path, static_cast<u64>(sd.Size), static_cast<u64>(sd.ModificationTime),
+                         out_hashes))
+  {
+    Log_InfoPrintf("Using cached track hashes for '%s'", path);
+    return true;
+  }
+
+  std::unique_ptr<CDImage> image = CDImage::Open(path, false, nullptr);
+  if (!image)
+  {
+    progress_callback->DisplayFormattedModalError("Failed to open '%s'", path);
+    return false;
+  }
+
+  const u32 track_count = image->GetTrackCount();
+  u32 total_sectors = 0;
+  for (u32 track = 1; track <= track_count; track++)
+  {
+    // index 0 of the data track isn't hashed, see ReadTrack()
+    if (track != 1)
+      total_sectors += image->GetTrackIndexLength(static_cast<u8>(track), 0);
+    total_sectors += image->GetTrackIndexLength(static_cast<u8>(track), 1);
+  }
+
+  // images aren't thread safe, so every worker opens its own, the first one reusing the image we already have
+  const u32 num_threads =
+    std::clamp<u32>(std::thread::hardware_concurrency(), 1, std::max(std::min(track_count, MAX_HASH_THREADS), 1u));
+  std::vector<std::unique_ptr<CDImage>> images;
+  images.push_back(std::move(image));
+  for (u32 i = 1; i < num_threads; i++)
+  {
+    std::unique_ptr<CDImage> worker_image = CDImage::Open(path, false, nullptr);
+    if (!worker_image)
+      break;
+    images.push_back(std::move(worker_image));
+  }
+
+  std::vector<Hash> hashes(track_count);
+  std::atomic<u32> next_track{1};
+  std::atomic<u32> sectors_done{0};
+  std::atomic_bool failed{false};
+  auto worker = [&hashes, &next_track, &sectors_done, &failed, track_count](CDImage* worker_image) {
+    for (;;)
+    {
+      const u32 track = next_track.fetch_add(1);
+      if (track > track_count || failed.load())
+        break;
+
+      MD5Digest digest;
+      if (!ReadTrack(worker_image, static_cast<u8>(track), &digest, ProgressCallback::NullProgressCallback,
+                     &sectors_done))
+      {
+        failed.store(true);
+        break;
+      }
+
+      digest.Final(hashes[track - 1].data());
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::unique_ptr<CDImage>& worker_image : images)
+    threads.emplace_back(worker, worker_image.get());
+
+  // the callback may pump the UI, so it's only ever touched from this thread
+  progress_callback->SetStatusText(
+    TinyString::FromFormat("Computing hashes for %u tracks on %zu threads...", track_count, threads.size()));
+  progress_callback->SetProgressRange(std::max(total_sectors, 1u));
+  for (;;)
+  {
+    const u32 done = sectors_done.load(std::memory_order_relaxed);
+    progress_callback->SetProgressValue(done);
+    if (done >= total_sectors || failed.load() || progress_callback->IsCancelled() ||
+        next_track.load() > (track_count + static_cast<u32>(threads.size())))
+    {
+      break;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+
+  if (progress_callback->IsCancelled())
+    failed.store(true);
+
+  for (std::thread& thread : threads)
+    thread.join();
+
+  if (failed.load())
+  {
+    if (!progress_callback->IsCancelled())
+      progress_callback->DisplayFormattedModalError("Failed to read tracks from '%s'", path);
+    return false;
+  }
+
+  if (cache_filename && has_stat)
+    StoreCachedHashes(cache_filename, path, static_cast<u64>(sd.Size), static_cast<u64>(sd.ModificationTime), hashes);
+
+  *out_hashes = std::move(hashes);
+  return true;
+}
+
+bool LookupCachedHashes(const char* cache_filename, const std::string& path, u64 size, u64 mtime,
+                        std::vector<Hash>* out_hashes)
+{
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(cache_filename, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
+    return false;
+
+  u32 signature, version;
+  if (!stream->ReadU32(&signature) || !stream->ReadU32(&version) || signature != HASH_CACHE_SIGNATURE ||
+      version != HASH_CACHE_VERSION)
+  {
+    return false;
+  }
+
+  // entries are appended, so the last match is the most recent
+  bool found = false;
+  std::string entry_path;
+  std::vector<Hash> entry_hashes;
+  while (stream->GetPosition() != stream->GetSize())
+  {
+    u64 entry_size, entry_mtime;
+    u32 num_hashes;
+    if (!stream->ReadSizePrefixedString(&entry_path) || !stream->ReadU64(&entry_size) ||
+        !stream->ReadU64(&entry_mtime) || !stream->ReadU32(&num_hashes) || num_hashes > MAX_TRACKS)
+    {
+      Log_WarningPrintf("Track hash cache is corrupted");
+      return found;
+    }
+
+    entry_hashes.resize(num_hashes);
+    if (num_hashes > 0 && !stream->Read2(entry_hashes.data(), static_cast<u32>(num_hashes * sizeof(Hash))))
+    {
+      Log_WarningPrintf("Track hash cache is corrupted");
+      return found;
+    }
+
+    if (entry_path == path && entry_size == size && entry_mtime == mtime)
+    {
+      *out_hashes = entry_hashes;
+      found = true;
+    }
+  }
+
+  return found;
+}
+
+void StoreCachedHashes(const char* cache_filename, const std::string& path, u64 size, u64 mtime,
+                       const std::vector<Hash>& hashes)
+{
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(cache_filename, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_SEEKABLE);
+  u32 signature, version;
+  if (!stream || !stream->ReadU32(&signature) || !stream->ReadU32(&version) || signature != HASH_CACHE_SIGNATURE ||
+      version != HASH_CACHE_VERSION || !stream->SeekToEnd())
+  {
+    stream = ByteStream::OpenFile(cache_filename,
+                                  BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_TRUNCATE | BYTESTREAM_OPEN_WRITE);
+    if (!stream || !stream->WriteU32(HASH_CACHE_SIGNATURE) || !stream->WriteU32(HASH_CACHE_VERSION))
+    {
+      Log_ErrorPrintf("Failed to create track hash cache '%s'", cache_filename);
+      return;
+    }
+  }
+
+  if (!stream->WriteSizePrefixedString(path) || !stream->WriteU64(size) || !stream->WriteU64(mtime) ||
+      !stream->WriteU32(static_cast<u32>(hashes.size())) ||
+      !stream->Write2(hashes.data(), static_cast<u32>(hashes.size() * sizeof(Hash))))
+  {
+    Log_ErrorPrintf("Failed to write track hash cache '%s'", cache_filename);
+  }
+}
+
+} // namespace CDImageHasher
@@ -4,6 +4,7 @@
 #include <array>
 #include <optional>
 #include <string>
+#include <vector>
 
 class CDImage;
 
@@ -18,4 +19,10 @@ bool GetImageHash(CDImage* image, Hash* out_hash,
 bool GetTrackHash(CDImage* image, u8 track, Hash* out_hash,
                   ProgressCallback* progress_callback = ProgressCallback::NullProgressCallback);
 
+/// Hashes every track of the image at path, with tracks spread across worker threads which each open their own
+/// instance of the image. When cache_filename is set, results are looked up there first, keyed by the path, size
+/// and modification time of the file, and stored there afterwards.
+bool GetTrackHashes(const char* path, std::vector<Hash>* out_hashes, const char* cache_filename = nullptr,
+                    ProgressCallback* progress_callback = ProgressCallback::NullProgressCallback);
+
 } // namespace CDImageHasher
\ No newline at end of file
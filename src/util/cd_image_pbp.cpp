@@ -4,13 +4,21 @@
 #include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/lru_cache.h"
 #include "common/path.h"
+#include "common/progress_callback.h"
 #include "common/string_util.h"
+#include "fmt/format.h"
 #include "pbp_types.h"
 #include "string.h"
 #include "zlib.h"
+#include <algorithm>
 #include <array>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <vector>
 Log_SetChannel(CDImagePBP);
 
@@ -36,6 +44,9 @@ public:
   std::string GetMetadata(const std::string_view& type) const override;
   std::string GetSubImageMetadata(u32 index, const std::string_view& type) const override;
 
+  PrecacheResult Precache(ProgressCallback* progress) override;
+  bool IsPrecached() const override;
+
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
 
@@ -46,6 +57,19 @@ private:
     u16 size;
   };
 
+  enum : u32
+  {
+    BLOCK_CACHE_SIZE = 16,
+    PREFETCH_BLOCK_COUNT = 2,
+  };
+
+  struct PrefetchRequest
+  {
+    u32 block_index;
+    BlockInfo block_info;
+    const u8* precached_data;
+  };
+
 #if _DEBUG
   static void PrintPBPHeaderInfo(const PBPHeader& pbp_header);
   static void PrintSFOHeaderInfo(const SFOHeader& sfo_header);
@@ -60,8 +84,17 @@ private:
 
   bool IsValidEboot(Common::Error* error);
 
-  bool InitDecompressionStream();
-  bool DecompressBlock(const BlockInfo& block_info);
+  static bool InitDecompressionStream(z_stream* stream);
+  static bool ReadBlock(std::FILE* fp, z_stream* stream, const BlockInfo& block_info, const u8* precached_data,
+                        std::vector<u8>* compressed_buffer, u8* decompressed_block);
+  const u8* GetBlock(u32 block_index);
+
+  void StartPrefetchWorker();
+  void StopPrefetchWorker();
+  void FlushPrefetch();
+  void PrefetchWorkerThread();
+  void QueuePrefetch(u32 block_index, bool after_seek);
+  void CollectPrefetchedBlocks(std::unique_lock<std::mutex>& lock);
 
   bool OpenDisc(u32 index, Common::Error* error);
 
@@ -83,11 +116,30 @@ private:
 
   std::array<TOCEntry, TOC_NUM_ENTRIES> m_toc;
 
+  // only accessed from the thread reading sectors
+  LRUCache<u32, std::vector<u8>> m_block_cache{BLOCK_CACHE_SIZE};
   u32 m_current_block = static_cast<u32>(-1);
-  std::array<u8, DECOMPRESSED_BLOCK_SIZE> m_decompressed_block;
+  const u8* m_current_block_data = nullptr;
   std::vector<u8> m_compressed_block;
 
-  z_stream m_inflate_stream;
+  // Compressed blocks of the current disc, packed back to back. Inflating from here is cheap enough that there's no
+  // need to hold the whole decompressed disc in memory.
+  std::vector<u8> m_precached_blocks;
+  std::vector<u32> m_precached_block_offsets;
+
+  z_stream m_inflate_stream = {};
+
+  // inflates the blocks after the one being read from its own file handle, so sequential reads rarely wait on zlib
+  std::thread m_prefetch_thread;
+  std::FILE* m_prefetch_fp = nullptr;
+  z_stream m_prefetch_stream = {};
+  std::mutex m_prefetch_mutex;
+  std::condition_variable m_prefetch_work_cv;
+  std::condition_variable m_prefetch_done_cv;
+  std::deque<PrefetchRequest> m_prefetch_queue;
+  u32 m_prefetch_in_flight = static_cast<u32>(-1);
+  std::vector<std::pair<u32, std::vector<u8>>> m_prefetched_blocks;
+  bool m_prefetch_shutdown = false;
 
   CDSubChannelReplacement m_sbi;
 };
@@ -121,6 +173,8 @@ static void SwapByteOrder(T& val)
 
 CDImagePBP::~CDImagePBP()
 {
+  StopPrefetchWorker();
+
   if (m_file)
     fclose(m_file);
 
@@ -340,6 +394,14 @@ bool CDImagePBP::Open(const char* filename, Common::Error* error)
 
   m_filename = filename;
 
+  if (!InitDecompressionStream(&m_inflate_stream))
+  {
+    Log_ErrorPrint("Failed to initialize zlib decompression stream");
+    if (error)
+      error->SetMessage("Failed to initialize zlib decompression stream");
+    return false;
+  }
+
   // Read in PBP header
   if (!LoadPBPHeader())
   {
@@ -436,7 +498,11 @@ bool CDImagePBP::Open(const char* filename, Common::Error* error)
   }
 
   // Default to first disc for now
-  return OpenDisc(0, error);
+  if (!OpenDisc(0, error))
+    return false;
+
+  StartPrefetchWorker();
+  return true;
 }
 
 bool CDImagePBP::OpenDisc(u32 index, Common::Error* error)
@@ -449,11 +515,16 @@ bool CDImagePBP::OpenDisc(u32 index, Common::Error* error)
     return false;
   }
 
+  // the worker may still be inflating from the old disc's block table
+  FlushPrefetch();
+  m_block_cache.Clear();
   m_current_block = static_cast<u32>(-1);
+  m_current_block_data = nullptr;
   m_blockinfo_table.fill({});
   m_toc.fill({});
-  m_decompressed_block.fill(0x00);
   m_compressed_block.clear();
+  m_precached_blocks = {};
+  m_precached_block_offsets = {};
 
   // Go to ISO header
   const u32 iso_header_start = m_disc_offsets[index];
@@ -512,11 +583,14 @@ bool CDImagePBP::OpenDisc(u32 index, Common::Error* error)
   if (FSeek64(m_file, iso_header_start + 0x4000, SEEK_SET) != 0)
     return false;
 
+  // read the whole table in one go, it's about 1MB and switching discs re-reads it
+  std::vector<BlockTableEntry> block_table(BLOCK_TABLE_NUM_ENTRIES);
+  if (fread(block_table.data(), sizeof(BlockTableEntry), block_table.size(), m_file) != block_table.size())
+    return false;
+
   for (u32 i = 0; i < BLOCK_TABLE_NUM_ENTRIES; i++)
   {
-    BlockTableEntry bte;
-    if (fread(&bte, sizeof(bte), 1, m_file) != 1)
-      return false;
+    const BlockTableEntry& bte = block_table[i];
 
     // Only store absolute file offset into a BlockInfo if this is a valid block
     m_blockinfo_table[i] = {(bte.size != 0) ? (iso_header_start + iso_offset + bte.offset) : 0, bte.size};
@@ -666,13 +740,6 @@ bool CDImagePBP::OpenDisc(u32 index, Common::Error* error)
 
   AddLeadOutIndex();
 
-  // Initialize zlib stream
-  if (!InitDecompressionStream())
-  {
-    Log_ErrorPrint("Failed to initialize zlib decompression stream");
-    return false;
-  }
-
   if (m_disc_offsets.size() > 1)
   {
     std::string sbi_path(Path::StripExtension(m_filename));
@@ -699,45 +766,58 @@ const std::string* CDImagePBP::LookupStringSFOTableEntry(const char* key, const
   return &std::get<std::string>(data_value);
 }
 
-bool CDImagePBP::InitDecompressionStream()
+bool CDImagePBP::InitDecompressionStream(z_stream* stream)
 {
-  m_inflate_stream = {};
-  m_inflate_stream.next_in = Z_NULL;
-  m_inflate_stream.avail_in = 0;
-  m_inflate_stream.zalloc = Z_NULL;
-  m_inflate_stream.zfree = Z_NULL;
-  m_inflate_stream.opaque = Z_NULL;
-
-  int ret = inflateInit2(&m_inflate_stream, -MAX_WBITS);
+  *stream = {};
+  stream->next_in = Z_NULL;
+  stream->avail_in = 0;
+  stream->zalloc = Z_NULL;
+  stream->zfree = Z_NULL;
+  stream->opaque = Z_NULL;
+
+  int ret = inflateInit2(stream, -MAX_WBITS);
   return ret == Z_OK;
 }
 
-bool CDImagePBP::DecompressBlock(const BlockInfo& block_info)
+bool CDImagePBP::ReadBlock(std::FILE* fp, z_stream* stream, const BlockInfo& block_info, const u8* precached_data,
+                           std::vector<u8>* compressed_buffer, u8* decompressed_block)
 {
-  if (FSeek64(m_file, block_info.offset, SEEK_SET) != 0)
-    return false;
-
   // Compression level 0 has compressed size == decompressed size.
-  if (block_info.size == m_decompressed_block.size())
+  const bool uncompressed = (block_info.size == DECOMPRESSED_BLOCK_SIZE);
+
+  if (precached_data)
   {
-    return (fread(m_decompressed_block.data(), sizeof(u8), m_decompressed_block.size(), m_file) ==
-            m_decompressed_block.size());
+    if (uncompressed)
+    {
+      std::memcpy(decompressed_block, precached_data, DECOMPRESSED_BLOCK_SIZE);
+      return true;
+    }
   }
+  else
+  {
+    if (FSeek64(fp, block_info.offset, SEEK_SET) != 0)
+      return false;
 
-  m_compressed_block.resize(block_info.size);
+    if (uncompressed)
+      return (fread(decompressed_block, DECOMPRESSED_BLOCK_SIZE, 1, fp) == 1);
 
-  if (fread(m_compressed_block.data(), sizeof(u8), m_compressed_block.size(), m_file) != m_compressed_block.size())
-    return false;
+    compressed_buffer->resize(block_info.size);
+    if (fread(compressed_buffer->data(), sizeof(u8), compressed_buffer->size(), fp) != compressed_buffer->size())
+      return false;
 
-  m_inflate_stream.next_in = m_compressed_block.data();
-  m_inflate_stream.avail_in = static_cast<uInt>(m_compressed_block.size());
-  m_inflate_stream.next_out = m_decompressed_block.data();
-  m_inflate_stream.avail_out = static_cast<uInt>(m_decompressed_block.size());
+    precached_data = compressed_buffer->data();
+  }
 
-  if (inflateReset(&m_inflate_stream) != Z_OK)
+  // zlib doesn't modify the input, it's just not declared const
+  stream->next_in = const_cast<u8*>(precached_data);
+  stream->avail_in = static_cast<uInt>(block_info.size);
+  stream->next_out = decompressed_block;
+  stream->avail_out = static_cast<uInt>(DECOMPRESSED_BLOCK_SIZE);
+
+  if (inflateReset(stream) != Z_OK)
     return false;
 
-  int err = inflate(&m_inflate_stream, Z_FINISH);
+  int err = inflate(stream, Z_FINISH);
   if (err != Z_STREAM_END)
   {
     Log_ErrorPrintf("Inflate error %d", err);
@@ -747,6 +827,172 @@ bool CDImagePBP::DecompressBlock(const BlockInfo& block_info)
   return true;
 }
 
+const u8* CDImagePBP::GetBlock(u32 block_index)
+{
+  const std::vector<u8>* block = m_block_cache.Lookup(block_index);
+  if (!block && m_prefetch_thread.joinable())
+  {
+    // the worker may already be inflating it, in which case it's quicker to wait than start over
+    std::unique_lock lock(m_prefetch_mutex);
+    m_prefetch_done_cv.wait(lock, [this, block_index]() { return m_prefetch_in_flight != block_index; });
+    CollectPrefetchedBlocks(lock);
+    block = m_block_cache.Lookup(block_index);
+
+    // not started yet, we'll inflate it ourselves
+    if (!block)
+    {
+      if (auto iter = std::find_if(m_prefetch_queue.begin(), m_prefetch_queue.end(),
+                                   [block_index](const PrefetchRequest& req) { return req.block_index == block_index; });
+          iter != m_prefetch_queue.end())
+      {
+        m_prefetch_queue.erase(iter);
+      }
+    }
+  }
+
+  // nothing had it, so this is most likely a seek to a new area of the disc
+  const bool seeked = !block;
+  if (!block)
+  {
+    const u8* precached_data =
+      m_precached_blocks.empty() ? nullptr : &m_precached_blocks[m_precached_block_offsets[block_index]];
+    std::vector<u8> buffer(DECOMPRESSED_BLOCK_SIZE);
+    if (!ReadBlock(m_file, &m_inflate_stream, m_blockinfo_table[block_index], precached_data, &m_compressed_block,
+                   buffer.data()))
+    {
+      return nullptr;
+    }
+
+    block = m_block_cache.Insert(block_index, std::move(buffer));
+  }
+
+  // the pointer stays valid until the block is evicted, which prefetching can do, so look it up again afterwards
+  if (m_prefetch_thread.joinable())
+  {
+    QueuePrefetch(block_index, seeked);
+    block = m_block_cache.Lookup(block_index);
+  }
+
+  return block ? block->data() : nullptr;
+}
+
+void CDImagePBP::StartPrefetchWorker()
+{
+  // leave a core for the emulator and one for the read thread itself
+  if (std::thread::hardware_concurrency() <= 2)
+    return;
+
+  m_prefetch_fp = FileSystem::OpenCFile(m_filename.c_str(), "rb");
+  if (!m_prefetch_fp)
+    return;
+
+  if (!InitDecompressionStream(&m_prefetch_stream))
+  {
+    std::fclose(m_prefetch_fp);
+    m_prefetch_fp = nullptr;
+    return;
+  }
+
+  m_prefetch_shutdown = false;
+  m_prefetch_thread = std::thread(&CDImagePBP::PrefetchWorkerThread, this);
+}
+
+void CDImagePBP::StopPrefetchWorker()
+{
+  if (!m_prefetch_thread.joinable())
+    return;
+
+  {
+    std::unique_lock lock(m_prefetch_mutex);
+    m_prefetch_shutdown = true;
+    m_prefetch_queue.clear();
+    m_prefetch_work_cv.notify_one();
+  }
+
+  m_prefetch_thread.join();
+  m_prefetched_blocks.clear();
+  inflateEnd(&m_prefetch_stream);
+  std::fclose(m_prefetch_fp);
+  m_prefetch_fp = nullptr;
+}
+
+void CDImagePBP::FlushPrefetch()
+{
+  if (!m_prefetch_thread.joinable())
+    return;
+
+  std::unique_lock lock(m_prefetch_mutex);
+  m_prefetch_queue.clear();
+  m_prefetch_done_cv.wait(lock, [this]() { return m_prefetch_in_flight == static_cast<u32>(-1); });
+  m_prefetched_blocks.clear();
+}
+
+void CDImagePBP::PrefetchWorkerThread()
+{
+  std::vector<u8> compressed_buffer;
+
+  std::unique_lock lock(m_prefetch_mutex);
+  for (;;)
+  {
+    m_prefetch_work_cv.wait(lock, [this]() { return m_prefetch_shutdown || !m_prefetch_queue.empty(); });
+    if (m_prefetch_shutdown)
+      break;
+
+    const PrefetchRequest req = m_prefetch_queue.front();
+    m_prefetch_queue.pop_front();
+    m_prefetch_in_flight = req.block_index;
+    lock.unlock();
+
+    std::vector<u8> buffer(DECOMPRESSED_BLOCK_SIZE);
+    const bool result = ReadBlock(m_prefetch_fp, &m_prefetch_stream, req.block_info, req.precached_data,
+                                  &compressed_buffer, buffer.data());
+
+    lock.lock();
+    m_prefetch_in_flight = static_cast<u32>(-1);
+    if (result)
+      m_prefetched_blocks.emplace_back(req.block_index, std::move(buffer));
+    m_prefetch_done_cv.notify_all();
+  }
+}
+
+void CDImagePBP::CollectPrefetchedBlocks(std::unique_lock<std::mutex>& lock)
+{
+  for (auto& [block_index, buffer] : m_prefetched_blocks)
+    m_block_cache.Insert(block_index, std::move(buffer));
+  m_prefetched_blocks.clear();
+}
+
+void CDImagePBP::QueuePrefetch(u32 block_index, bool after_seek)
+{
+  std::unique_lock lock(m_prefetch_mutex);
+  CollectPrefetchedBlocks(lock);
+
+  // anything still waiting from before the seek is no longer useful
+  if (after_seek)
+    m_prefetch_queue.clear();
+
+  const u32 last_block_index = std::min<u32>(block_index + PREFETCH_BLOCK_COUNT, BLOCK_TABLE_NUM_ENTRIES - 1);
+  for (u32 prefetch_index = block_index + 1; prefetch_index <= last_block_index; prefetch_index++)
+  {
+    const BlockInfo& bi = m_blockinfo_table[prefetch_index];
+    if (bi.size == 0)
+      break;
+
+    if (m_block_cache.Lookup(prefetch_index) || m_prefetch_in_flight == prefetch_index ||
+        std::find_if(m_prefetch_queue.begin(), m_prefetch_queue.end(), [prefetch_index](const PrefetchRequest& req) {
+          return req.block_index == prefetch_index;
+        }) != m_prefetch_queue.end())
+    {
+      continue;
+    }
+
+    const u8* precached_data =
+      m_precached_blocks.empty() ? nullptr : &m_precached_blocks[m_precached_block_offsets[prefetch_index]];
+    m_prefetch_queue.push_back(PrefetchRequest{prefetch_index, bi, precached_data});
+    m_prefetch_work_cv.notify_one();
+  }
+}
+
 bool CDImagePBP::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
 {
   if (m_sbi.GetReplacementSubChannelQ(index.start_lba_on_disc + lba_in_index, subq))
@@ -774,13 +1020,20 @@ bool CDImagePBP::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
     return false;
   }
 
-  if (m_current_block != requested_block && !DecompressBlock(bi))
+  if (m_current_block != requested_block)
   {
-    Log_ErrorPrintf("Failed to decompress block %u", requested_block);
-    return false;
+    m_current_block_data = GetBlock(requested_block);
+    if (!m_current_block_data)
+    {
+      Log_ErrorPrintf("Failed to decompress block %u", requested_block);
+      m_current_block = static_cast<u32>(-1);
+      return false;
+    }
+
+    m_current_block = requested_block;
   }
 
-  std::memcpy(buffer, &m_decompressed_block[offset_in_block], RAW_SECTOR_SIZE);
+  std::memcpy(buffer, &m_current_block_data[offset_in_block], RAW_SECTOR_SIZE);
   return true;
 }
 
@@ -880,6 +1133,53 @@ bool CDImagePBP::SwitchSubImage(u32 index, Common::Error* error)
   return true;
 }
 
+CDImage::PrecacheResult CDImagePBP::Precache(ProgressCallback* progress)
+{
+  if (!m_precached_blocks.empty())
+    return CDImage::PrecacheResult::Success;
+
+  u32 num_blocks = 0;
+  size_t total_size = 0;
+  for (const BlockInfo& bi : m_blockinfo_table)
+  {
+    if (bi.size == 0)
+      break;
+
+    total_size += bi.size;
+    num_blocks++;
+  }
+
+  progress->SetStatusText(fmt::format("Precaching {}...", FileSystem::GetDisplayNameFromPath(m_filename)).c_str());
+  progress->SetProgressRange(num_blocks);
+
+  std::vector<u8> blocks(total_size);
+  std::vector<u32> block_offsets(num_blocks);
+  u32 offset = 0;
+  for (u32 i = 0; i < num_blocks; i++)
+  {
+    const BlockInfo& bi = m_blockinfo_table[i];
+    if (FSeek64(m_file, bi.offset, SEEK_SET) != 0 || std::fread(&blocks[offset], bi.size, 1, m_file) != 1)
+    {
+      Log_ErrorPrintf("Failed to read block %u for precaching", i);
+      return CDImage::PrecacheResult::ReadError;
+    }
+
+    block_offsets[i] = offset;
+    offset += bi.size;
+    progress->SetProgressValue(i + 1);
+  }
+
+  Log_InfoPrintf("Precached %u blocks (%zu bytes compressed)", num_blocks, total_size);
+  m_precached_blocks = std::move(blocks);
+  m_precached_block_offsets = std::move(block_offsets);
+  return CDImage::PrecacheResult::Success;
+}
+
+bool CDImagePBP::IsPrecached() const
+{
+  return !m_precached_blocks.empty();
+}
+
 std::string CDImagePBP::GetSubImageMetadata(u32 index, const std::string_view& type) const
 {
   if (type == "title")
@@ -0,0 +1,362 @@
+#include "cd_image.h"
+#include "common/align.h"
+#include "common/assert.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/md5_digest.h"
+#include "common/path.h"
+#include "common/string_util.h"
+#include "fmt/format.h"
+#include <algorithm>
+#include <cerrno>
+Log_SetChannel(CDImageSectorCache);
+
+namespace {
+
+enum : u32
+{
+  CACHE_FILE_SIGNATURE = 0x43535344, // DSSC
+  CACHE_FILE_VERSION = 1,
+  CACHE_DATA_ALIGNMENT = 4096,
+
+  // keeps the header reasonably current without rewriting it for every sector
+  HEADER_UPDATE_INTERVAL = 256,
+};
+
+#pragma pack(push, 1)
+struct CacheFileHeader
+{
+  u32 signature;
+  u32 version;
+  u32 lba_count;
+  u32 cached_sectors;
+  u64 source_size;
+  s64 source_modification_time;
+};
+#pragma pack(pop)
+
+} // namespace
+
+static constexpr const char* CACHE_FILE_EXTENSION = ".sectorcache";
+
+/// Keeps a copy of every sector read from the parent in a sparse file on local storage, so images on slow or remote
+/// drives only have to be read once. Sectors are stored at their LBA, with a bitmap recording which are present.
+class CDImageSectorCache : public CDImage
+{
+public:
+  CDImageSectorCache();
+  ~CDImageSectorCache() override;
+
+  bool Open(std::unique_ptr<CDImage>& parent_image, const char* cache_directory, u64 max_cache_size);
+
+  bool ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index) override;
+  bool HasNonStandardSubchannel() const override;
+
+  std::string GetMetadata(const std::string_view& type) const override;
+  std::string GetSubImageMetadata(u32 index, const std::string_view& type) const override;
+
+  PrecacheResult Precache(ProgressCallback* progress = ProgressCallback::NullProgressCallback) override;
+  bool IsPrecached() const override;
+
+protected:
+  bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
+
+private:
+  ALWAYS_INLINE bool IsSectorCached(LBA lba) const { return (m_bitmap[lba / 8] & (1u << (lba % 8))) != 0; }
+
+  bool OpenCacheFile(const std::string& path, const FILESYSTEM_STAT_DATA& sd);
+  bool WriteHeader();
+  void StoreSector(LBA lba, const void* data, u32 size);
+  void CloseCacheFile();
+
+  /// Deletes the least recently used cache files other than keep_path until the rest fit within max_size.
+  static void EvictCacheFiles(const char* cache_directory, const std::string& keep_path, u64 max_size);
+
+  std::unique_ptr<CDImage> m_parent_image;
+  std::FILE* m_fp = nullptr;
+  CacheFileHeader m_header = {};
+  std::vector<u8> m_bitmap;
+  u64 m_data_offset = 0;
+  u32 m_max_cached_sectors = 0;
+  u32 m_sectors_since_header_update = 0;
+  bool m_header_dirty = false;
+};
+
+CDImageSectorCache::CDImageSectorCache() = default;
+
+CDImageSectorCache::~CDImageSectorCache()
+{
+  CloseCacheFile();
+}
+
+bool CDImageSectorCache::Open(std::unique_ptr<CDImage>& parent_image, const char* cache_directory, u64 max_cache_size)
+{
+  const std::string& filename = parent_image->GetFileName();
+  FILESYSTEM_STAT_DATA sd;
+  if (!FileSystem::StatFile(filename.c_str(), &sd))
+  {
+    Log_ErrorPrintf("Failed to stat '%s'", filename.c_str());
+    return false;
+  }
+
+  // Keyed on the path, size and modification time rather than the contents, hashing the image would mean reading
+  // the whole thing over the network, which is what we're trying to avoid.
+  MD5Digest digest;
+  digest.Update(filename.data(), static_cast<u32>(filename.size()));
+  digest.Update(&sd.Size, sizeof(sd.Size));
+  digest.Update(&sd.ModificationTime, sizeof(sd.ModificationTime));
+  u8 hash[16];
+  digest.Final(hash);
+
+  if (!FileSystem::DirectoryExists(cache_directory) && !FileSystem::CreateDirectory(cache_directory, false))
+  {
+    Log_ErrorPrintf("Failed to create sector cache directory '%s'", cache_directory);
+    return false;
+  }
+
+  std::string cache_filename;
+  cache_filename.reserve(std::size(hash) * 2 + std::strlen(CACHE_FILE_EXTENSION));
+  for (const u8 byte : hash)
+    fmt::format_to(std::back_inserter(cache_filename), "{:02X}", byte);
+  cache_filename.append(CACHE_FILE_EXTENSION);
+  const std::string cache_path = Path::Combine(cache_directory, cache_filename);
+
+  // copy all the stuff from the parent image
+  m_filename = parent_image->GetFileName();
+  m_tracks = parent_image->GetTracks();
+  m_indices = parent_image->GetIndices();
+  m_lba_count = parent_image->GetLBACount();
+  m_max_cached_sectors = static_cast<u32>(std::min<u64>(max_cache_size / RAW_SECTOR_SIZE, m_lba_count));
+
+  // leave room for this image to fill up to its share of the limit
+  EvictCacheFiles(cache_directory, cache_path,
+                  max_cache_size - static_cast<u64>(m_max_cached_sectors) * RAW_SECTOR_SIZE);
+
+  if (!OpenCacheFile(cache_path, sd))
+    return false;
+
+  m_parent_image = std::move(parent_image);
+
+  Log_InfoPrintf("Sector cache '%s' holds %u of %u sectors", Path::GetFileName(cache_path).data(),
+                 m_header.cached_sectors, m_lba_count);
+  return Seek(1, Position{0, 0, 0});
+}
+
+bool CDImageSectorCache::OpenCacheFile(const std::string& path, const FILESYSTEM_STAT_DATA& sd)
+{
+  m_bitmap.clear();
+  m_bitmap.resize((m_lba_count + 7) / 8);
+  m_data_offset = Common::AlignUpPow2(sizeof(CacheFileHeader) + m_bitmap.size(), CACHE_DATA_ALIGNMENT);
+
+  m_fp = FileSystem::OpenCFile(path.c_str(), "r+b");
+  if (m_fp)
+  {
+    if (std::fread(&m_header, sizeof(m_header), 1, m_fp) == 1 && m_header.signature == CACHE_FILE_SIGNATURE &&
+        m_header.version == CACHE_FILE_VERSION && m_header.lba_count == m_lba_count &&
+        m_header.source_size == static_cast<u64>(sd.Size) &&
+        m_header.source_modification_time == static_cast<s64>(sd.ModificationTime) &&
+        std::fread(m_bitmap.data(), m_bitmap.size(), 1, m_fp) == 1)
+    {
+      // rewritten on close even if nothing new was read, eviction goes by modification time
+      m_header_dirty = true;
+      return true;
+    }
+
+    Log_WarningPrintf("Sector cache '%s' is invalid or out of date, recreating", path.c_str());
+    std::fclose(m_fp);
+    std::fill(m_bitmap.begin(), m_bitmap.end(), static_cast<u8>(0));
+  }
+
+  m_fp = FileSystem::OpenCFile(path.c_str(), "w+b");
+  if (!m_fp)
+  {
+    Log_ErrorPrintf("Failed to create sector cache '%s': %d", path.c_str(), errno);
+    return false;
+  }
+
+  m_header.signature = CACHE_FILE_SIGNATURE;
+  m_header.version = CACHE_FILE_VERSION;
+  m_header.lba_count = m_lba_count;
+  m_header.cached_sectors = 0;
+  m_header.source_size = static_cast<u64>(sd.Size);
+  m_header.source_modification_time = static_cast<s64>(sd.ModificationTime);
+  if (!WriteHeader() || std::fwrite(m_bitmap.data(), m_bitmap.size(), 1, m_fp) != 1 || std::fflush(m_fp) != 0)
+  {
+    Log_ErrorPrintf("Failed to write sector cache header to '%s'", path.c_str());
+    std::fclose(m_fp);
+    m_fp = nullptr;
+    FileSystem::DeleteFile(path.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+bool CDImageSectorCache::WriteHeader()
+{
+  m_header_dirty = false;
+  m_sectors_since_header_update = 0;
+  return (FileSystem::FSeek64(m_fp, 0, SEEK_SET) == 0 && std::fwrite(&m_header, sizeof(m_header), 1, m_fp) == 1);
+}
+
+void CDImageSectorCache::CloseCacheFile()
+{
+  if (!m_fp)
+    return;
+
+  if (m_header_dirty && !WriteHeader())
+    Log_ErrorPrintf("Failed to update sector cache header");
+
+  std::fclose(m_fp);
+  m_fp = nullptr;
+}
+
+void CDImageSectorCache::StoreSector(LBA lba, const void* data, u32 size)
+{
+  if (m_header.cached_sectors >= m_max_cached_sectors)
+    return;
+
+  // bitmap byte goes last, so an interrupted write leaves the sector marked as missing
+  const u32 bitmap_index = lba / 8;
+  const u8 new_bitmap_value = m_bitmap[bitmap_index] | static_cast<u8>(1u << (lba % 8));
+  if (FileSystem::FSeek64(m_fp, static_cast<s64>(m_data_offset + static_cast<u64>(lba) * RAW_SECTOR_SIZE),
+                          SEEK_SET) != 0 ||
+      std::fwrite(data, size, 1, m_fp) != 1 ||
+      FileSystem::FSeek64(m_fp, static_cast<s64>(sizeof(CacheFileHeader) + bitmap_index), SEEK_SET) != 0 ||
+      std::fwrite(&new_bitmap_value, sizeof(new_bitmap_value), 1, m_fp) != 1)
+  {
+    Log_ErrorPrintf("Failed to write sector %u to cache, disabling: %d", lba, errno);
+    CloseCacheFile();
+    return;
+  }
+
+  m_bitmap[bitmap_index] = new_bitmap_value;
+  m_header.cached_sectors++;
+  m_header_dirty = true;
+  if ((++m_sectors_since_header_update) == HEADER_UPDATE_INTERVAL)
+    WriteHeader();
+}
+
+bool CDImageSectorCache::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index)
+{
+  const LBA lba = index.start_lba_on_disc + lba_in_index;
+  if (!m_fp)
+    return m_parent_image->ReadSectorFromIndex(buffer, index, lba_in_index);
+
+  if (IsSectorCached(lba))
+  {
+    if (FileSystem::FSeek64(m_fp, static_cast<s64>(m_data_offset + static_cast<u64>(lba) * RAW_SECTOR_SIZE),
+                            SEEK_SET) == 0 &&
+        std::fread(buffer, index.file_sector_size, 1, m_fp) == 1)
+    {
+      return true;
+    }
+
+    Log_ErrorPrintf("Failed to read sector %u from cache, disabling: %d", lba, errno);
+    CloseCacheFile();
+    return m_parent_image->ReadSectorFromIndex(buffer, index, lba_in_index);
+  }
+
+  if (!m_parent_image->ReadSectorFromIndex(buffer, index, lba_in_index))
+    return false;
+
+  StoreSector(lba, buffer, index.file_sector_size);
+  return true;
+}
+
+bool CDImageSectorCache::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
+{
+  return m_parent_image->ReadSubChannelQ(subq, index, lba_in_index);
+}
+
+bool CDImageSectorCache::HasNonStandardSubchannel() const
+{
+  return m_parent_image->HasNonStandardSubchannel();
+}
+
+std::string CDImageSectorCache::GetMetadata(const std::string_view& type) const
+{
+  return m_parent_image->GetMetadata(type);
+}
+
+std::string CDImageSectorCache::GetSubImageMetadata(u32 index, const std::string_view& type) const
+{
+  // Multi-disc images aren't wrapped.
+  std::string ret;
+  if (index == 0)
+    ret = m_parent_image->GetSubImageMetadata(index, type);
+
+  return ret;
+}
+
+CDImage::PrecacheResult CDImageSectorCache::Precache(ProgressCallback* progress)
+{
+  return m_parent_image->Precache(progress);
+}
+
+bool CDImageSectorCache::IsPrecached() const
+{
+  return m_parent_image->IsPrecached();
+}
+
+void CDImageSectorCache::EvictCacheFiles(const char* cache_directory, const std::string& keep_path,
+                                         u64 max_size)
+{
+  FileSystem::FindResultsArray files;
+  FileSystem::FindFiles(cache_directory, fmt::format("*{}", CACHE_FILE_EXTENSION).c_str(), FILESYSTEM_FIND_FILES,
+                        &files);
+
+  // The files are sparse, so go by the number of sectors each one holds rather than the apparent size.
+  struct Entry
+  {
+    std::time_t modification_time;
+    const std::string* path;
+    u64 size;
+  };
+  std::vector<Entry> entries;
+  entries.reserve(files.size());
+  u64 total_size = 0;
+  for (const FILESYSTEM_FIND_DATA& fd : files)
+  {
+    if (fd.FileName == keep_path)
+      continue;
+
+    auto fp = FileSystem::OpenManagedCFile(fd.FileName.c_str(), "rb");
+    CacheFileHeader header;
+    const u64 size =
+      (fp && std::fread(&header, sizeof(header), 1, fp.get()) == 1 && header.signature == CACHE_FILE_SIGNATURE) ?
+        (static_cast<u64>(header.cached_sectors) * RAW_SECTOR_SIZE) :
+        static_cast<u64>(fd.Size);
+    entries.push_back(Entry{fd.ModificationTime, &fd.FileName, size});
+    total_size += size;
+  }
+
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& lhs, const Entry& rhs) { return lhs.modification_time < rhs.modification_time; });
+  for (const Entry& entry : entries)
+  {
+    if (total_size <= max_size)
+      break;
+
+    Log_InfoPrintf("Evicting sector cache '%s'", entry.path->c_str());
+    if (FileSystem::DeleteFile(entry.path->c_str()))
+      total_size -= entry.size;
+  }
+}
+
+std::unique_ptr<CDImage> CDImage::OverlaySectorCache(std::unique_ptr<CDImage> parent_image,
+                                                     const char* cache_directory, u64 max_cache_size)
+{
+  if (parent_image->HasSubImages())
+    return parent_image;
+
+  // a missing cache shouldn't stop the game from booting, so hand the parent back on failure
+  std::unique_ptr<CDImageSectorCache> cached_image = std::make_unique<CDImageSectorCache>();
+  if (!cached_image->Open(parent_image, cache_directory, max_cache_size))
+  {
+    Log_WarningPrintf("Sector cache unavailable for '%s'", parent_image->GetFileName().c_str());
+    return parent_image;
+  }
+
+  return cached_image;
+}
@@ -4,6 +4,7 @@
 #include "common/path.h"
 #include <algorithm>
 #include <memory>
+#include <vector>
 Log_SetChannel(CDSubChannelReplacement);
 
 #pragma pack(push, 1)
@@ -89,6 +90,41 @@ bool CDSubChannelReplacement::LoadSBIFromImagePath(const char* image_path)
   return LoadSBI(Path::ReplaceExtension(image_path, "sbi").c_str());
 }
 
+bool CDSubChannelReplacement::SaveSBI(const char* path) const
+{
+  auto fp = FileSystem::OpenManagedCFile(path, "wb");
+  if (!fp)
+  {
+    Log_ErrorPrintf("Failed to open '%s' for writing", path);
+    return false;
+  }
+
+  static constexpr char header[] = {'S', 'B', 'I', '\0'};
+  if (std::fwrite(header, sizeof(header), 1, fp.get()) != 1)
+    return false;
+
+  // sorted, so the same image always produces the same file
+  std::vector<u32> lbas;
+  lbas.reserve(m_replacement_subq.size());
+  for (const auto& it : m_replacement_subq)
+    lbas.push_back(it.first);
+  std::sort(lbas.begin(), lbas.end());
+
+  for (const u32 lba : lbas)
+  {
+    const CDImage::Position pos = CDImage::Position::FromLBA(lba);
+
+    SBIFileEntry entry;
+    std::tie(entry.minute_bcd, entry.second_bcd, entry.frame_bcd) = pos.ToBCD();
+    entry.type = 1;
+    std::copy_n(m_replacement_subq.at(lba).data.data(), countof(entry.data), entry.data);
+    if (std::fwrite(&entry, sizeof(entry), 1, fp.get()) != 1)
+      return false;
+  }
+
+  return true;
+}
+
 void CDSubChannelReplacement::AddReplacementSubChannelQ(u32 lba, const CDImage::SubChannelQ& subq)
 {
   auto iter = m_replacement_subq.find(lba);
@@ -16,6 +16,9 @@ public:
   bool LoadSBI(const char* path);
   bool LoadSBIFromImagePath(const char* image_path);
 
+  /// Writes the replacement sectors out in the same format LoadSBI() reads.
+  bool SaveSBI(const char* path) const;
+
   /// Adds a sector to the replacement map.
   void AddReplacementSubChannelQ(u32 lba, const CDImage::SubChannelQ& subq);
 
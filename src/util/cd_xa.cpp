@@ -2,55 +2,115 @@
 #include "cd_image.h"
 #include <algorithm>
 #include <array>
+#include <cstring>
 
 namespace CDXA {
 static constexpr std::array<s32, 4> s_xa_adpcm_filter_table_pos = {{0, 60, 115, 98}};
 static constexpr std::array<s32, 4> s_xa_adpcm_filter_table_neg = {{0, 0, -52, -55}};
 
-template<bool IS_STEREO, bool IS_8BIT>
-static void DecodeXA_ADPCMChunk(const u8* chunk_ptr, s16* samples, s32* last_samples)
+template<bool IS_8BIT>
+ALWAYS_INLINE static s16 GetXA_ADPCMSample(const u8* words_ptr, u32 word, u32 block, u8 shift)
 {
   // The data layout is annoying here. Each word of data is interleaved with the other blocks, requiring multiple
   // passes to decode the whole chunk.
+  // NOTE: assumes LE
+  u32 word_data;
+  std::memcpy(&word_data, &words_ptr[word * sizeof(u32)], sizeof(word_data));
+
+  // extract nibble from block
+  const u32 nibble = IS_8BIT ? ((word_data >> (block * 8)) & 0xFF) : ((word_data >> (block * 4)) & 0x0F);
+  return static_cast<s16>(Truncate16(nibble << 12)) >> shift;
+}
+
+template<bool IS_8BIT>
+ALWAYS_INLINE static void UnpackXA_ADPCMBlock(const u8* words_ptr, u32 block, u8 shift, s16* out_samples)
+{
+  // doesn't depend on the filter, so the compiler is free to vectorize it
+  for (u32 word = 0; word < 28; word++)
+    out_samples[word] = GetXA_ADPCMSample<IS_8BIT>(words_ptr, word, block, shift);
+}
+
+ALWAYS_INLINE static s16 FilterXA_ADPCMSample(s16 sample, s32 filter_pos, s32 filter_neg, s32& prev0, s32& prev1)
+{
+  // mix in previous values
+  const s32 interp_sample = s32(sample) + ((prev0 * filter_pos) + (prev1 * filter_neg) + 32) / 64;
+
+  // update previous values
+  prev1 = prev0;
+  prev0 = interp_sample;
+
+  return static_cast<s16>(std::clamp<s32>(interp_sample, -0x8000, 0x7FFF));
+}
+
+template<bool IS_STEREO, bool IS_8BIT>
+static void DecodeXA_ADPCMChunk(const u8* chunk_ptr, s16* samples, s32* last_samples)
+{
   constexpr u32 NUM_BLOCKS = IS_8BIT ? 4 : 8;
   constexpr u32 WORDS_PER_BLOCK = 28;
 
   const u8* headers_ptr = chunk_ptr + 4;
   const u8* words_ptr = chunk_ptr + 16;
 
-  for (u32 block = 0; block < NUM_BLOCKS; block++)
+  // The filter depends on the previous output, so it's inherently serial. For stereo, the left and right channels are
+  // independent though, so unpack both blocks up front and run the two filters together.
+  if constexpr (IS_STEREO)
   {
-    const XA_ADPCMBlockHeader block_header{headers_ptr[block]};
-    const u8 shift = block_header.GetShift();
-    const u8 filter = block_header.GetFilter();
-    const s32 filter_pos = s_xa_adpcm_filter_table_pos[filter];
-    const s32 filter_neg = s_xa_adpcm_filter_table_neg[filter];
-
-    s16* out_samples_ptr =
-      IS_STEREO ? &samples[(block / 2) * (WORDS_PER_BLOCK * 2) + (block % 2)] : &samples[block * WORDS_PER_BLOCK];
-    constexpr u32 out_samples_increment = IS_STEREO ? 2 : 1;
-
-    for (u32 word = 0; word < 28; word++)
+    std::array<std::array<s16, WORDS_PER_BLOCK>, NUM_BLOCKS> block_samples;
+    for (u32 block = 0; block < NUM_BLOCKS; block++)
     {
-      // NOTE: assumes LE
-      u32 word_data;
-      std::memcpy(&word_data, &words_ptr[word * sizeof(u32)], sizeof(word_data));
-
-      // extract nibble from block
-      const u32 nibble = IS_8BIT ? ((word_data >> (block * 8)) & 0xFF) : ((word_data >> (block * 4)) & 0x0F);
-      const s16 sample = static_cast<s16>(Truncate16(nibble << 12)) >> shift;
-
-      // mix in previous values
-      s32* prev = IS_STEREO ? &last_samples[(block & 1) * 2] : last_samples;
-      const s32 interp_sample = s32(sample) + ((prev[0] * filter_pos) + (prev[1] * filter_neg) + 32) / 64;
+      const XA_ADPCMBlockHeader block_header{headers_ptr[block]};
+      UnpackXA_ADPCMBlock<IS_8BIT>(words_ptr, block, block_header.GetShift(), block_samples[block].data());
+    }
 
-      // update previous values
-      prev[1] = prev[0];
-      prev[0] = interp_sample;
+    s32 left_prev0 = last_samples[0], left_prev1 = last_samples[1];
+    s32 right_prev0 = last_samples[2], right_prev1 = last_samples[3];
+    for (u32 block = 0; block < NUM_BLOCKS; block += 2)
+    {
+      const XA_ADPCMBlockHeader left_header{headers_ptr[block]};
+      const XA_ADPCMBlockHeader right_header{headers_ptr[block + 1]};
+      const s32 left_filter_pos = s_xa_adpcm_filter_table_pos[left_header.GetFilter()];
+      const s32 left_filter_neg = s_xa_adpcm_filter_table_neg[left_header.GetFilter()];
+      const s32 right_filter_pos = s_xa_adpcm_filter_table_pos[right_header.GetFilter()];
+      const s32 right_filter_neg = s_xa_adpcm_filter_table_neg[right_header.GetFilter()];
+      const s16* left_samples = block_samples[block].data();
+      const s16* right_samples = block_samples[block + 1].data();
+
+      s16* out_samples_ptr = &samples[(block / 2) * (WORDS_PER_BLOCK * 2)];
+      for (u32 word = 0; word < WORDS_PER_BLOCK; word++)
+      {
+        out_samples_ptr[0] =
+          FilterXA_ADPCMSample(left_samples[word], left_filter_pos, left_filter_neg, left_prev0, left_prev1);
+        out_samples_ptr[1] =
+          FilterXA_ADPCMSample(right_samples[word], right_filter_pos, right_filter_neg, right_prev0, right_prev1);
+        out_samples_ptr += 2;
+      }
+    }
 
-      *out_samples_ptr = static_cast<s16>(std::clamp<s32>(interp_sample, -0x8000, 0x7FFF));
-      out_samples_ptr += out_samples_increment;
+    last_samples[0] = left_prev0;
+    last_samples[1] = left_prev1;
+    last_samples[2] = right_prev0;
+    last_samples[3] = right_prev1;
+  }
+  else
+  {
+    s32 prev0 = last_samples[0], prev1 = last_samples[1];
+    s16* out_samples_ptr = samples;
+    for (u32 block = 0; block < NUM_BLOCKS; block++)
+    {
+      const XA_ADPCMBlockHeader block_header{headers_ptr[block]};
+      const s32 filter_pos = s_xa_adpcm_filter_table_pos[block_header.GetFilter()];
+      const s32 filter_neg = s_xa_adpcm_filter_table_neg[block_header.GetFilter()];
+      const u8 shift = block_header.GetShift();
+      for (u32 word = 0; word < WORDS_PER_BLOCK; word++)
+      {
+        *(out_samples_ptr++) =
+          FilterXA_ADPCMSample(GetXA_ADPCMSample<IS_8BIT>(words_ptr, word, block, shift), filter_pos, filter_neg,
+                               prev0, prev1);
+      }
     }
+
+    last_samples[0] = prev0;
+    last_samples[1] = prev1;
   }
 }
 
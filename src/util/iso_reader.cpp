@@ -24,6 +24,7 @@ bool ISOReader::Open(CDImage* image, u32 track_number)
 {
   m_image = image;
   m_track_number = track_number;
+  m_directory_cache.clear();
   if (!ReadPVD())
     return false;
 
@@ -58,59 +59,43 @@ bool ISOReader::ReadPVD()
   return false;
 }
 
-std::optional<ISOReader::ISODirectoryEntry> ISOReader::LocateFile(const char* path)
+const ISOReader::ISODirectoryEntry& ISOReader::GetRootDirectoryEntry() const
 {
-  u8 sector_buffer[SECTOR_SIZE];
-
-  const ISODirectoryEntry* root_de = reinterpret_cast<const ISODirectoryEntry*>(m_pvd.root_directory_entry);
-  if (*path == '\0' || std::strcmp(path, "/") == 0)
-  {
-    // locating the root directory
-    return *root_de;
-  }
-
-  // start at the root directory
-  return LocateFile(path, sector_buffer, root_de->location_le, root_de->length_le);
+  return *reinterpret_cast<const ISODirectoryEntry*>(m_pvd.root_directory_entry);
 }
 
-std::optional<ISOReader::ISODirectoryEntry> ISOReader::LocateFile(const char* path, u8* sector_buffer,
-                                                                  u32 directory_record_lba, u32 directory_record_size)
+const ISOReader::CachedDirectory* ISOReader::ReadDirectory(u32 directory_record_lba, u32 directory_record_size)
 {
-  if (directory_record_size == 0)
-  {
-    Log_ErrorPrintf("Directory entry record size 0 while looking for '%s'", path);
-    return std::nullopt;
-  }
-
-  // strip any leading slashes
-  const char* path_component_start = path;
-  while (*path_component_start == '/' || *path_component_start == '\\')
-    path_component_start++;
+  auto iter = m_directory_cache.find(directory_record_lba);
+  if (iter != m_directory_cache.end())
+    return &iter->second;
 
-  u32 path_component_length = 0;
-  const char* path_component_end = path_component_start;
-  while (*path_component_end != '\0' && *path_component_end != '/' && *path_component_end != '\\')
+  if (directory_record_size == 0)
   {
-    path_component_length++;
-    path_component_end++;
+    Log_ErrorPrintf("Directory entry record size 0 at LBA %u", directory_record_lba);
+    return nullptr;
   }
 
-  // start reading directory entries
+  // read the whole extent at once
   const u32 num_sectors = (directory_record_size + (SECTOR_SIZE - 1)) / SECTOR_SIZE;
   if (!m_image->Seek(m_track_number, directory_record_lba))
   {
     Log_ErrorPrintf("Seek to LBA %u failed", directory_record_lba);
-    return std::nullopt;
+    return nullptr;
   }
 
-  for (u32 i = 0; i < num_sectors; i++)
+  std::vector<u8> buffer(num_sectors * SECTOR_SIZE);
+  if (m_image->Read(CDImage::ReadMode::DataOnly, num_sectors, buffer.data()) != num_sectors)
   {
-    if (m_image->Read(CDImage::ReadMode::DataOnly, 1, sector_buffer) != 1)
-    {
-      Log_ErrorPrintf("Failed to read LBA %u", directory_record_lba + i);
-      return std::nullopt;
-    }
+    Log_ErrorPrintf("Failed to read %u sectors at LBA %u", num_sectors, directory_record_lba);
+    return nullptr;
+  }
 
+  CachedDirectory directory;
+  for (u32 i = 0; i < num_sectors; i++)
+  {
+    // entries never cross sector boundaries
+    const u8* sector_buffer = &buffer[i * SECTOR_SIZE];
     u32 sector_offset = 0;
     while ((sector_offset + sizeof(ISODirectoryEntry)) < SECTOR_SIZE)
     {
@@ -129,46 +114,77 @@ std::optional<ISOReader::ISODirectoryEntry> ISOReader::LocateFile(const char* pa
       if (de->filename_length == 1 && (*de_filename == '\x0' || *de_filename == '\x1'))
         continue;
 
-      // check filename length
-      if (de->filename_length < path_component_length)
-        continue;
+      directory.push_back(CachedDirectoryEntry{*de, std::string(de_filename, de->filename_length)});
+    }
+  }
+
+  return &m_directory_cache.emplace(directory_record_lba, std::move(directory)).first->second;
+}
 
-      if (de->flags & ISODirectoryEntryFlag_Directory)
+std::optional<ISOReader::ISODirectoryEntry> ISOReader::LocateFile(const char* path)
+{
+  // start at the root directory
+  const ISODirectoryEntry* current_de = &GetRootDirectoryEntry();
+  const char* path_component_start = path;
+  for (;;)
+  {
+    // strip any leading slashes
+    while (*path_component_start == '/' || *path_component_start == '\\')
+      path_component_start++;
+    if (*path_component_start == '\0')
+      return *current_de;
+
+    u32 path_component_length = 0;
+    const char* path_component_end = path_component_start;
+    while (*path_component_end != '\0' && *path_component_end != '/' && *path_component_end != '\\')
+    {
+      path_component_length++;
+      path_component_end++;
+    }
+
+    if (!(current_de->flags & ISODirectoryEntryFlag_Directory))
+    {
+      // we're looking for a directory but got a file
+      Log_ErrorPrintf("Looking for directory but got file");
+      return std::nullopt;
+    }
+
+    const CachedDirectory* directory = ReadDirectory(current_de->location_le, current_de->length_le);
+    if (!directory)
+      return std::nullopt;
+
+    const ISODirectoryEntry* found_de = nullptr;
+    for (const CachedDirectoryEntry& entry : *directory)
+    {
+      // check filename length
+      const std::string& de_filename = entry.filename;
+      if (de_filename.length() < path_component_length ||
+          !FilenamesEqual(de_filename.c_str(), path_component_start, path_component_length))
       {
-        // directories don't have the version? so check the length instead
-        if (de->filename_length != path_component_length ||
-            !FilenamesEqual(de_filename, path_component_start, path_component_length))
-        {
-          continue;
-        }
+        continue;
       }
-      else
+
+      // directories don't have the version? so check the length instead
+      if ((entry.de.flags & ISODirectoryEntryFlag_Directory) ? (de_filename.length() != path_component_length) :
+                                                               (de_filename[path_component_length] != ';'))
       {
-        // compare filename
-        if (!FilenamesEqual(de_filename, path_component_start, path_component_length) ||
-            de_filename[path_component_length] != ';')
-        {
-          continue;
-        }
+        continue;
       }
 
-      // found it. is this the file we're looking for?
-      if (*path_component_end == '\0')
-        return *de;
-
-      // if it is a directory, recurse into it
-      if (de->flags & ISODirectoryEntryFlag_Directory)
-        return LocateFile(path_component_end, sector_buffer, de->location_le, de->length_le);
+      found_de = &entry.de;
+      break;
+    }
 
-      // we're looking for a directory but got a file
-      Log_ErrorPrintf("Looking for directory but got file");
+    if (!found_de)
+    {
+      std::string temp(path_component_start, path_component_length);
+      Log_ErrorPrintf("Path component '%s' not found", temp.c_str());
       return std::nullopt;
     }
-  }
 
-  std::string temp(path_component_start, path_component_length);
-  Log_ErrorPrintf("Path component '%s' not found", temp.c_str());
-  return std::nullopt;
+    current_de = found_de;
+    path_component_start = path_component_end;
+  }
 }
 
 std::vector<std::string> ISOReader::GetFilesInDirectory(const char* path)
@@ -179,9 +195,9 @@ std::vector<std::string> ISOReader::GetFilesInDirectory(const char* path)
   if (base_path.empty())
   {
     // root directory
-    const ISODirectoryEntry* root_de = reinterpret_cast<const ISODirectoryEntry*>(m_pvd.root_directory_entry);
-    directory_record_lba = root_de->location_le;
-    directory_record_length = root_de->length_le;
+    const ISODirectoryEntry& root_de = GetRootDirectoryEntry();
+    directory_record_lba = root_de.location_le;
+    directory_record_length = root_de.length_le;
   }
   else
   {
@@ -205,55 +221,26 @@ std::vector<std::string> ISOReader::GetFilesInDirectory(const char* path)
       base_path += '/';
   }
 
-  // start reading directory entries
-  const u32 num_sectors = (directory_record_length + (SECTOR_SIZE - 1)) / SECTOR_SIZE;
-  if (!m_image->Seek(m_track_number, directory_record_lba))
-  {
-    Log_ErrorPrintf("Seek to LBA %u failed", directory_record_lba);
+  const CachedDirectory* directory = ReadDirectory(directory_record_lba, directory_record_length);
+  if (!directory)
     return {};
-  }
 
   std::vector<std::string> files;
-  u8 sector_buffer[SECTOR_SIZE];
-  for (u32 i = 0; i < num_sectors; i++)
+  files.reserve(directory->size());
+  for (const CachedDirectoryEntry& entry : *directory)
   {
-    if (m_image->Read(CDImage::ReadMode::DataOnly, 1, sector_buffer) != 1)
+    // strip off terminator/file version
+    std::string filename(entry.filename);
+    std::string::size_type pos = filename.rfind(';');
+    if (pos == std::string::npos)
     {
-      Log_ErrorPrintf("Failed to read LBA %u", directory_record_lba + i);
-      break;
+      Log_ErrorPrintf("Invalid filename '%s'", filename.c_str());
+      continue;
     }
+    filename.erase(pos);
 
-    u32 sector_offset = 0;
-    while ((sector_offset + sizeof(ISODirectoryEntry)) < SECTOR_SIZE)
-    {
-      const ISODirectoryEntry* de = reinterpret_cast<const ISODirectoryEntry*>(&sector_buffer[sector_offset]);
-      const char* de_filename =
-        reinterpret_cast<const char*>(&sector_buffer[sector_offset + sizeof(ISODirectoryEntry)]);
-      if ((sector_offset + de->entry_length) > SECTOR_SIZE || de->filename_length > de->entry_length ||
-          de->entry_length < sizeof(ISODirectoryEntry))
-      {
-        break;
-      }
-
-      sector_offset += de->entry_length;
-
-      // skip current/parent directory
-      if (de->filename_length == 1 && (*de_filename == '\x0' || *de_filename == '\x1'))
-        continue;
-
-      // strip off terminator/file version
-      std::string filename(de_filename, de->filename_length);
-      std::string::size_type pos = filename.rfind(';');
-      if (pos == std::string::npos)
-      {
-        Log_ErrorPrintf("Invalid filename '%s'", filename.c_str());
-        continue;
-      }
-      filename.erase(pos);
-
-      if (!filename.empty())
-        files.push_back(base_path + filename);
-    }
+    if (!filename.empty())
+      files.push_back(base_path + filename);
   }
 
   return files;
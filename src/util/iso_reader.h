@@ -3,6 +3,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class CDImage;
@@ -142,14 +143,25 @@ public:
   bool ReadFile(const char* path, std::vector<u8>* data);
 
 private:
+  struct CachedDirectoryEntry
+  {
+    ISODirectoryEntry de;
+    std::string filename;
+  };
+  using CachedDirectory = std::vector<CachedDirectoryEntry>;
+
   bool ReadPVD();
 
+  const ISODirectoryEntry& GetRootDirectoryEntry() const;
+  const CachedDirectory* ReadDirectory(u32 directory_record_lba, u32 directory_record_size);
+
   std::optional<ISODirectoryEntry> LocateFile(const char* path);
-  std::optional<ISODirectoryEntry> LocateFile(const char* path, u8* sector_buffer, u32 directory_record_lba,
-                                              u32 directory_record_size);
 
   CDImage* m_image;
   u32 m_track_number;
 
   ISOPrimaryVolumeDescriptor m_pvd = {};
+
+  // parsed directory extents, keyed by LBA, so SYSTEM.CNF and the executable don't walk from the root each time
+  std::unordered_map<u32, CachedDirectory> m_directory_cache;
 };
\ No newline at end of file
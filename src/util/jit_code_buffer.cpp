@@ -3,6 +3,7 @@
 #include "common/assert.h"
 #include "common/log.h"
 #include "common/platform.h"
+#include "memory_arena.h"
 #include <algorithm>
 Log_SetChannel(JitCodeBuffer);
 
@@ -37,35 +38,49 @@ JitCodeBuffer::~JitCodeBuffer()
   Destroy();
 }
 
-bool JitCodeBuffer::Allocate(u32 size /* = 64 * 1024 * 1024 */, u32 far_code_size /* = 0 */)
+bool JitCodeBuffer::Allocate(u32 size /* = 64 * 1024 * 1024 */, u32 far_code_size /* = 0 */,
+                             bool huge_pages /* = false */)
 {
   Destroy();
 
   m_total_size = size + far_code_size;
 
-#if defined(_WIN32)
-  m_code_ptr = static_cast<u8*>(VirtualAlloc(nullptr, m_total_size, MEM_COMMIT, PAGE_EXECUTE_READWRITE));
-  if (!m_code_ptr)
+  m_huge_pages = false;
+#if !defined(__APPLE__) || !defined(__aarch64__)
+  // MAP_JIT can't be combined with huge pages
+  if (huge_pages)
   {
-    Log_ErrorPrintf("VirtualAlloc(RWX, %u) for internal buffer failed: %u", m_total_size, GetLastError());
-    return false;
+    m_code_ptr = static_cast<u8*>(Common::MemoryArena::AllocateMemory(m_total_size, true, true));
+    m_huge_pages = (m_code_ptr != nullptr);
   }
-#elif defined(__linux__) || defined(__ANDROID__) || defined(__APPLE__) || defined(__HAIKU__) || defined(__FreeBSD__)
-  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
-#if defined(__APPLE__) && defined(__aarch64__)
-  // MAP_JIT and toggleable write protection is required on Apple Silicon.
-  flags |= MAP_JIT;
 #endif
 
-  m_code_ptr = static_cast<u8*>(mmap(nullptr, m_total_size, PROT_READ | PROT_WRITE | PROT_EXEC, flags, -1, 0));
   if (!m_code_ptr)
   {
-    Log_ErrorPrintf("mmap(RWX, %u) for internal buffer failed: %d", m_total_size, errno);
-    return false;
-  }
+#if defined(_WIN32)
+    m_code_ptr = static_cast<u8*>(VirtualAlloc(nullptr, m_total_size, MEM_COMMIT, PAGE_EXECUTE_READWRITE));
+    if (!m_code_ptr)
+    {
+      Log_ErrorPrintf("VirtualAlloc(RWX, %u) for internal buffer failed: %u", m_total_size, GetLastError());
+      return false;
+    }
+#elif defined(__linux__) || defined(__ANDROID__) || defined(__APPLE__) || defined(__HAIKU__) || defined(__FreeBSD__)
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(__APPLE__) && defined(__aarch64__)
+    // MAP_JIT and toggleable write protection is required on Apple Silicon.
+    flags |= MAP_JIT;
+#endif
+
+    m_code_ptr = static_cast<u8*>(mmap(nullptr, m_total_size, PROT_READ | PROT_WRITE | PROT_EXEC, flags, -1, 0));
+    if (!m_code_ptr)
+    {
+      Log_ErrorPrintf("mmap(RWX, %u) for internal buffer failed: %d", m_total_size, errno);
+      return false;
+    }
 #else
-  return false;
+    return false;
 #endif
+  }
 
   m_free_code_ptr = m_code_ptr;
   m_code_size = size;
@@ -78,6 +93,7 @@ bool JitCodeBuffer::Allocate(u32 size /* = 64 * 1024 * 1024 */, u32 far_code_siz
 
   m_old_protection = 0;
   m_owns_buffer = true;
+  ResetSegments();
   return true;
 }
 
@@ -149,12 +165,18 @@ bool JitCodeBuffer::Initialize(void* buffer, u32 size, u32 far_code_size /* = 0
 
   m_guard_size = guard_size;
   m_owns_buffer = false;
+  ResetSegments();
   return true;
 }
 
 void JitCodeBuffer::Destroy()
 {
-  if (m_owns_buffer)
+  if (m_huge_pages)
+  {
+    Common::MemoryArena::FreeMemory(m_code_ptr, m_total_size, true);
+    m_huge_pages = false;
+  }
+  else if (m_owns_buffer)
   {
 #if defined(_WIN32)
     if (!VirtualFree(m_code_ptr, 0, MEM_RELEASE))
@@ -189,6 +211,7 @@ void JitCodeBuffer::Destroy()
   m_guard_size = 0;
   m_old_protection = 0;
   m_owns_buffer = false;
+  ResetSegments();
 }
 
 void JitCodeBuffer::ReserveCode(u32 size)
@@ -199,6 +222,7 @@ void JitCodeBuffer::ReserveCode(u32 size)
   m_code_reserve_size += size;
   m_free_code_ptr += size;
   m_code_size -= size;
+  ResetSegments();
 }
 
 void JitCodeBuffer::CommitCode(u32 length)
@@ -211,7 +235,7 @@ void JitCodeBuffer::CommitCode(u32 length)
   FlushInstructionCache(m_free_code_ptr, length);
 #endif
 
-  Assert(length <= (m_code_size - m_code_used));
+  Assert(length <= GetFreeCodeSpace());
   m_free_code_ptr += length;
   m_code_used += length;
 }
@@ -226,7 +250,7 @@ void JitCodeBuffer::CommitFarCode(u32 length)
   FlushInstructionCache(m_free_far_code_ptr, length);
 #endif
 
-  Assert(length <= (m_far_code_size - m_far_code_used));
+  Assert(length <= GetFreeFarCodeSpace());
   m_free_far_code_ptr += length;
   m_far_code_used += length;
 }
@@ -249,6 +273,49 @@ void JitCodeBuffer::Reset()
   }
 
   WriteProtect(true);
+  ResetSegments();
+}
+
+void JitCodeBuffer::ResetSegments()
+{
+  m_code_segments_base = m_code_ptr ? (m_code_ptr + m_guard_size + m_code_reserve_size) : nullptr;
+  m_code_segment_end = m_code_segments_base + m_code_size;
+  m_code_segment_size = m_code_size;
+  m_far_code_segments_base = m_far_code_ptr;
+  m_far_code_segment_end = m_far_code_segments_base + m_far_code_size;
+  m_far_code_segment_size = m_far_code_size;
+  m_segment_count = 1;
+  m_current_segment = 0;
+}
+
+void JitCodeBuffer::InitializeSegments(u32 count)
+{
+  Assert(count > 0);
+
+  // anything before the free pointer (e.g. dispatchers) stays where it is
+  m_code_segments_base = m_free_code_ptr;
+  m_code_segment_size = GetFreeCodeSpace() / count;
+  m_code_segment_end = m_code_segments_base + m_code_segment_size;
+  m_far_code_segments_base = m_free_far_code_ptr;
+  m_far_code_segment_size = GetFreeFarCodeSpace() / count;
+  m_far_code_segment_end = m_far_code_segments_base + m_far_code_segment_size;
+  m_segment_count = count;
+  m_current_segment = 0;
+}
+
+u32 JitCodeBuffer::AdvanceSegment()
+{
+  m_current_segment = (m_current_segment + 1) % m_segment_count;
+
+  m_free_code_ptr = m_code_segments_base + (m_current_segment * m_code_segment_size);
+  m_code_segment_end = m_free_code_ptr + m_code_segment_size;
+  m_code_used = static_cast<u32>(m_free_code_ptr - (m_code_ptr + m_guard_size + m_code_reserve_size));
+
+  m_free_far_code_ptr = m_far_code_segments_base + (m_current_segment * m_far_code_segment_size);
+  m_far_code_segment_end = m_free_far_code_ptr + m_far_code_segment_size;
+  m_far_code_used = static_cast<u32>(m_free_far_code_ptr - m_far_code_ptr);
+
+  return m_current_segment;
 }
 
 void JitCodeBuffer::Align(u32 alignment, u8 padding_value)
@@ -292,6 +359,20 @@ void JitCodeBuffer::WriteProtect(bool enabled)
   if (!needs_write_protect)
     return;
 
+  // the protection is per-thread, so is the nesting
+  static thread_local u32 unprotect_depth = 0;
+  if (!enabled)
+  {
+    if (unprotect_depth++ > 0)
+      return;
+  }
+  else
+  {
+    DebugAssert(unprotect_depth > 0);
+    if (--unprotect_depth > 0)
+      return;
+  }
+
   pthread_jit_write_protect_np(enabled ? 1 : 0);
 }
 
@@ -11,7 +11,8 @@ public:
 
   bool IsValid() const { return (m_code_ptr != nullptr); }
 
-  bool Allocate(u32 size = 64 * 1024 * 1024, u32 far_code_size = 0);
+  /// With huge_pages, the buffer is backed by huge pages where the host allows it. Not available with MAP_JIT.
+  bool Allocate(u32 size = 64 * 1024 * 1024, u32 far_code_size = 0, bool huge_pages = false);
   bool Initialize(void* buffer, u32 size, u32 far_code_size = 0, u32 guard_size = 0);
   void Destroy();
   void Reset();
@@ -20,14 +21,28 @@ public:
   ALWAYS_INLINE u32 GetTotalSize() const { return m_total_size; }
 
   ALWAYS_INLINE u8* GetFreeCodePointer() const { return m_free_code_ptr; }
-  ALWAYS_INLINE u32 GetFreeCodeSpace() const { return static_cast<u32>(m_code_size - m_code_used); }
+  ALWAYS_INLINE u32 GetFreeCodeSpace() const { return static_cast<u32>(m_code_segment_end - m_free_code_ptr); }
   void ReserveCode(u32 size);
   void CommitCode(u32 length);
 
   ALWAYS_INLINE u8* GetFreeFarCodePointer() const { return m_free_far_code_ptr; }
-  ALWAYS_INLINE u32 GetFreeFarCodeSpace() const { return static_cast<u32>(m_far_code_size - m_far_code_used); }
+  ALWAYS_INLINE u32 GetFreeFarCodeSpace() const
+  {
+    return static_cast<u32>(m_far_code_segment_end - m_free_far_code_ptr);
+  }
   void CommitFarCode(u32 length);
 
+  /// Splits the remaining near and far code space into equally-sized segments, which are filled one at a time.
+  /// The free space reported is then only the space left in the current segment. Reset() removes the segments.
+  void InitializeSegments(u32 count);
+
+  /// Moves the free pointers to the start of the next segment, wrapping around to the first segment after the last.
+  /// Any code previously placed in the segment must no longer be referenced. Returns the new segment index.
+  u32 AdvanceSegment();
+
+  ALWAYS_INLINE u32 GetSegmentCount() const { return m_segment_count; }
+  ALWAYS_INLINE u32 GetCurrentSegment() const { return m_current_segment; }
+
   /// Adjusts the free code pointer to the specified alignment, padding with bytes.
   /// Assumes alignment is a power-of-two.
   void Align(u32 alignment, u8 padding_value);
@@ -35,14 +50,29 @@ public:
   /// Flushes the instruction cache on the host for the specified range.
   static void FlushInstructionCache(void* address, u32 size);
 
-  /// For Apple Silicon - Toggles write protection on the JIT space.
+  /// For Apple Silicon - Toggles write protection on the JIT space. Calls nest, and only the outermost pair on each
+  /// thread toggles, so a batch of writes can share one toggle. The thread can't execute the JIT space while it's
+  /// unprotected.
 #if defined(__APPLE__) && defined(__aarch64__)
   static void WriteProtect(bool enabled);
 #else
   ALWAYS_INLINE static void WriteProtect(bool enabled) {}
 #endif
 
+  /// Leaves the JIT space unprotected until the end of the scope.
+  class ScopedWriteUnprotect
+  {
+  public:
+    ALWAYS_INLINE ScopedWriteUnprotect() { WriteProtect(false); }
+    ALWAYS_INLINE ~ScopedWriteUnprotect() { WriteProtect(true); }
+
+    ScopedWriteUnprotect(const ScopedWriteUnprotect&) = delete;
+    ScopedWriteUnprotect& operator=(const ScopedWriteUnprotect&) = delete;
+  };
+
 private:
+  void ResetSegments();
+
   u8* m_code_ptr = nullptr;
   u8* m_free_code_ptr = nullptr;
   u32 m_code_size = 0;
@@ -54,8 +84,18 @@ private:
   u32 m_far_code_size = 0;
   u32 m_far_code_used = 0;
 
+  u8* m_code_segments_base = nullptr;
+  u8* m_code_segment_end = nullptr;
+  u8* m_far_code_segments_base = nullptr;
+  u8* m_far_code_segment_end = nullptr;
+  u32 m_code_segment_size = 0;
+  u32 m_far_code_segment_size = 0;
+  u32 m_segment_count = 1;
+  u32 m_current_segment = 0;
+
   u32 m_total_size = 0;
   u32 m_guard_size = 0;
   u32 m_old_protection = 0;
   bool m_owns_buffer = false;
+  bool m_huge_pages = false;
 };
@@ -1,4 +1,5 @@
 #include "memory_arena.h"
+#include "common/align.h"
 #include "common/assert.h"
 #include "common/log.h"
 #include "common/string_util.h"
@@ -94,6 +95,116 @@ void* MemoryArena::FindBaseAddressForMapping(size_t size)
   return base_address;
 }
 
+#ifdef _WIN32
+
+static bool EnableLockMemoryPrivilege()
+{
+  // large pages need SeLockMemoryPrivilege, which the user has to be granted, and then has to be enabled
+  static const bool enabled = []() {
+    HANDLE token;
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+      return false;
+
+    TOKEN_PRIVILEGES tp = {};
+    tp.PrivilegeCount = 1;
+    tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+    const bool result = (LookupPrivilegeValueW(nullptr, SE_LOCK_MEMORY_NAME, &tp.Privileges[0].Luid) &&
+                         AdjustTokenPrivileges(token, FALSE, &tp, 0, nullptr, nullptr) &&
+                         GetLastError() == ERROR_SUCCESS);
+    CloseHandle(token);
+    if (!result)
+      Log_WarningPrint("SeLockMemoryPrivilege is not available, large pages will not be used.");
+
+    return result;
+  }();
+
+  return enabled;
+}
+
+#endif
+
+void* MemoryArena::AllocateMemory(size_t size, bool huge_pages, bool executable)
+{
+#if defined(_WIN32)
+  const DWORD protect = executable ? PAGE_EXECUTE_READWRITE : PAGE_READWRITE;
+  const SIZE_T large_page_size = GetLargePageMinimum();
+  if (huge_pages && large_page_size > 0 && EnableLockMemoryPrivilege())
+  {
+    // large pages are committed and locked up front
+    const SIZE_T large_size = (size + large_page_size - 1) / large_page_size * large_page_size;
+    void* ptr = VirtualAlloc(nullptr, large_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, protect);
+    if (ptr)
+      return ptr;
+
+    Log_WarningPrintf("VirtualAlloc(MEM_LARGE_PAGES, %zu) failed: %u", static_cast<size_t>(large_size),
+                      GetLastError());
+  }
+
+  return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, protect);
+#elif defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__)
+  const int prot = PROT_READ | PROT_WRITE | (executable ? PROT_EXEC : 0);
+  if (!huge_pages)
+  {
+    void* ptr = mmap(nullptr, size, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return (ptr != MAP_FAILED) ? ptr : nullptr;
+  }
+
+  const size_t huge_size = Common::AlignUpPow2(size, HUGE_PAGE_SIZE);
+#ifdef MAP_HUGETLB
+  // explicit huge pages only exist if a pool has been reserved, so this usually fails
+  void* ptr = mmap(nullptr, huge_size, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (ptr != MAP_FAILED)
+    return ptr;
+#endif
+
+  // transparent huge pages need an aligned range, so over-allocate and trim the ends off
+  u8* base =
+    static_cast<u8*>(mmap(nullptr, huge_size + HUGE_PAGE_SIZE, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (base == MAP_FAILED)
+    return nullptr;
+
+  u8* aligned = reinterpret_cast<u8*>(Common::AlignUpPow2(reinterpret_cast<uintptr_t>(base), HUGE_PAGE_SIZE));
+  const size_t head = static_cast<size_t>(aligned - base);
+  if (head > 0)
+    munmap(base, head);
+  if (head < HUGE_PAGE_SIZE)
+    munmap(aligned + huge_size, HUGE_PAGE_SIZE - head);
+
+  AdviseHugePages(aligned, huge_size);
+  return aligned;
+#else
+  return nullptr;
+#endif
+}
+
+void MemoryArena::FreeMemory(void* ptr, size_t size, bool huge_pages)
+{
+  if (!ptr)
+    return;
+
+#if defined(_WIN32)
+  VirtualFree(ptr, 0, MEM_RELEASE);
+#elif defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__)
+  munmap(ptr, huge_pages ? Common::AlignUpPow2(size, HUGE_PAGE_SIZE) : size);
+#endif
+}
+
+bool MemoryArena::AdviseHugePages(void* address, size_t size)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (madvise(address, size, MADV_HUGEPAGE) != 0)
+  {
+    // EINVAL if the kernel was built without transparent huge pages
+    Log_WarningPrintf("madvise(MADV_HUGEPAGE, %p, %zu) failed: %d", address, size, errno);
+    return false;
+  }
+
+  return true;
+#else
+  return false;
+#endif
+}
+
 bool MemoryArena::IsValid() const
 {
 #if defined(_WIN32)
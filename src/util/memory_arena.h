@@ -32,11 +32,23 @@ public:
     bool m_writable;
   };
 
+  /// Size of the huge pages which are asked for. 2MB on both x86-64 and ARM64 with 4K base pages.
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
   MemoryArena();
   ~MemoryArena();
 
   static void* FindBaseAddressForMapping(size_t size);
 
+  /// Allocates zeroed memory. With huge_pages set, it's backed by huge pages where the host allows it, and quietly
+  /// falls back to normal pages otherwise. Has to be freed with FreeMemory() and the same size and huge_pages.
+  static void* AllocateMemory(size_t size, bool huge_pages, bool executable = false);
+  static void FreeMemory(void* ptr, size_t size, bool huge_pages);
+
+  /// Asks for an existing mapping to be backed by transparent huge pages. Only whole, aligned huge pages within the
+  /// range can be. Returns false if the host doesn't support it.
+  static bool AdviseHugePages(void* address, size_t size);
+
   ALWAYS_INLINE size_t GetSize() const { return m_size; }
   ALWAYS_INLINE bool IsWritable() const { return m_writable; }
   ALWAYS_INLINE bool IsExecutable() const { return m_executable; }
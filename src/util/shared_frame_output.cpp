@@ -0,0 +1,174 @@
+#include "shared_frame_output.h"
+#include "common/align.h"
+#include "common/assert.h"
+#include "common/log.h"
+#include "common/string_util.h"
+Log_SetChannel(SharedFrameOutput);
+
+#if defined(_WIN32)
+#include "common/windows_headers.h"
+#elif !defined(__ANDROID__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Common {
+
+// slots are cache line aligned so consumers reading one don't contend with the next being written
+static constexpr u32 SLOT_ALIGNMENT = 64;
+
+SharedFrameOutput::SharedFrameOutput() = default;
+
+SharedFrameOutput::~SharedFrameOutput()
+{
+  Destroy();
+}
+
+bool SharedFrameOutput::Create(const char* name, u32 max_width, u32 max_height, u32 num_slots)
+{
+  if (IsOpen())
+    Destroy();
+
+  const u32 header_size = Common::AlignUpPow2(static_cast<u32>(sizeof(Header)), SLOT_ALIGNMENT);
+  const u32 slot_size =
+    Common::AlignUpPow2(static_cast<u32>(sizeof(SlotHeader)) + (max_width * max_height * sizeof(u32)), SLOT_ALIGNMENT);
+  const size_t size = header_size + (static_cast<size_t>(slot_size) * num_slots);
+
+  void* ptr;
+#if defined(_WIN32)
+  const std::wstring wname(StringUtil::UTF8StringToWideString(name));
+  m_mapping_handle = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, Truncate32(size >> 32),
+                                        Truncate32(size), wname.c_str());
+  if (!m_mapping_handle)
+  {
+    Log_ErrorPrintf("CreateFileMapping(%s) failed: %u", name, GetLastError());
+    return false;
+  }
+
+  ptr = MapViewOfFile(m_mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+  if (!ptr)
+  {
+    Log_ErrorPrintf("MapViewOfFile(%s) failed: %u", name, GetLastError());
+    CloseHandle(m_mapping_handle);
+    m_mapping_handle = nullptr;
+    return false;
+  }
+#elif !defined(__ANDROID__)
+  // unlike the memory arena, the mapping is left linked so other processes can open it by name
+  const int fd = shm_open(name, O_CREAT | O_RDWR, 0600);
+  if (fd < 0)
+  {
+    Log_ErrorPrintf("shm_open(%s) failed: %d", name, errno);
+    return false;
+  }
+
+  if (ftruncate(fd, static_cast<off_t>(size)) < 0)
+  {
+    Log_ErrorPrintf("ftruncate(%zu) failed: %d", size, errno);
+    close(fd);
+    shm_unlink(name);
+    return false;
+  }
+
+  ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED)
+  {
+    Log_ErrorPrintf("mmap(%zu) failed: %d", size, errno);
+    shm_unlink(name);
+    return false;
+  }
+#else
+  Log_ErrorPrintf("Shared frame output is not supported on this platform.");
+  return false;
+#endif
+
+  m_name = name;
+  m_header = static_cast<Header*>(ptr);
+  m_size = size;
+  m_next_frame = 1;
+
+  // a previous instance may have left its frames around, so hide them before filling in the header
+  m_header->magic = 0;
+  m_header->latest_frame.store(0, std::memory_order_relaxed);
+  for (u32 i = 0; i < num_slots; i++)
+  {
+    SlotHeader* slot = reinterpret_cast<SlotHeader*>(reinterpret_cast<u8*>(m_header) + header_size + (i * slot_size));
+    slot->sequence.store(0, std::memory_order_relaxed);
+  }
+
+  m_header->version = VERSION;
+  m_header->header_size = header_size;
+  m_header->num_slots = num_slots;
+  m_header->slot_size = slot_size;
+  m_header->max_width = max_width;
+  m_header->max_height = max_height;
+  std::atomic_thread_fence(std::memory_order_release);
+  m_header->magic = MAGIC;
+
+  Log_InfoPrintf("Created shared frame output '%s' with %u %ux%u slots.", name, num_slots, max_width, max_height);
+  return true;
+}
+
+void SharedFrameOutput::Destroy()
+{
+  if (!m_header)
+    return;
+
+  // tell consumers that nothing more is coming, in case they still have it mapped
+  m_header->magic = 0;
+
+#if defined(_WIN32)
+  UnmapViewOfFile(m_header);
+  CloseHandle(m_mapping_handle);
+  m_mapping_handle = nullptr;
+#elif !defined(__ANDROID__)
+  munmap(m_header, m_size);
+  shm_unlink(m_name.c_str());
+#endif
+
+  m_header = nullptr;
+  m_size = 0;
+  m_name = {};
+}
+
+SharedFrameOutput::SlotHeader* SharedFrameOutput::GetSlot(u32 frame_number) const
+{
+  const u32 index = frame_number % m_header->num_slots;
+  return reinterpret_cast<SlotHeader*>(reinterpret_cast<u8*>(m_header) + m_header->header_size +
+                                       (static_cast<size_t>(index) * m_header->slot_size));
+}
+
+bool SharedFrameOutput::BeginFrame(u32 width, u32 height, void** out_buffer, u32* out_stride)
+{
+  if (!m_header || width > m_header->max_width || height > m_header->max_height)
+    return false;
+
+  SlotHeader* slot = GetSlot(m_next_frame);
+  slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot->frame_number = m_next_frame;
+  slot->width = width;
+  slot->height = height;
+  slot->stride = width * sizeof(u32);
+
+  *out_buffer = reinterpret_cast<u8*>(slot) + sizeof(SlotHeader);
+  *out_stride = slot->stride;
+  return true;
+}
+
+void SharedFrameOutput::EndFrame()
+{
+  SlotHeader* slot = GetSlot(m_next_frame);
+  DebugAssert(slot->sequence.load(std::memory_order_relaxed) & 1u);
+  slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  m_header->latest_frame.store(m_next_frame, std::memory_order_release);
+
+  // zero is reserved for no frames
+  m_next_frame = (m_next_frame == UINT32_MAX) ? 1 : (m_next_frame + 1);
+}
+
+} // namespace Common
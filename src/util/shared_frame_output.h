@@ -0,0 +1,65 @@
+#pragma once
+#include "common/types.h"
+#include <atomic>
+#include <string>
+
+namespace Common {
+
+/// Publishes frames to a named shared memory ring, so external encoders can consume them without capturing the
+/// window. Frames are RGBA8. Consumers open the mapping, wait for the header's latest_frame to change, and read the
+/// slot for that frame, retrying if the slot's sequence was odd or changed while it was being copied.
+class SharedFrameOutput
+{
+public:
+  static constexpr u32 MAGIC = 0x4F465344; // DSFO
+  static constexpr u32 VERSION = 1;
+
+  struct Header
+  {
+    u32 magic;
+    u32 version;
+    u32 header_size;
+    u32 num_slots;
+    u32 slot_size; ///< including the slot header
+    u32 max_width;
+    u32 max_height;
+    std::atomic<u32> latest_frame; ///< zero until the first frame, the slot is (latest_frame % num_slots)
+  };
+
+  struct SlotHeader
+  {
+    std::atomic<u32> sequence; ///< odd while the slot is being written
+    u32 frame_number;
+    u32 width;
+    u32 height;
+    u32 stride;
+    u32 reserved[3];
+  };
+
+  SharedFrameOutput();
+  ~SharedFrameOutput();
+
+  ALWAYS_INLINE bool IsOpen() const { return (m_header != nullptr); }
+  ALWAYS_INLINE const std::string& GetName() const { return m_name; }
+
+  bool Create(const char* name, u32 max_width, u32 max_height, u32 num_slots);
+  void Destroy();
+
+  /// Returns the next slot to write a frame of the specified size to, published with EndFrame().
+  bool BeginFrame(u32 width, u32 height, void** out_buffer, u32* out_stride);
+  void EndFrame();
+
+private:
+  SlotHeader* GetSlot(u32 frame_number) const;
+
+  std::string m_name;
+  Header* m_header = nullptr;
+  size_t m_size = 0;
+  u32 m_next_frame = 1;
+
+#ifdef _WIN32
+  void* m_mapping_handle = nullptr;
+#endif
+};
+
+} // namespace Common
@@ -10,20 +10,58 @@ StateWrapper::StateWrapper(ByteStream* stream, Mode mode, u32 version)
 {
 }
 
-StateWrapper::~StateWrapper() = default;
+StateWrapper::StateWrapper(GrowableMemoryByteStream* stream, Mode mode, u32 version)
+  : m_stream(stream), m_memory_stream(stream), m_mode(mode), m_version(version)
+{
+  m_memory = stream->GetMemoryPointer();
+  m_memory_position = static_cast<u32>(stream->GetPosition());
+  m_memory_size = (mode == Mode::Read) ? static_cast<u32>(stream->GetSize()) : stream->GetMemorySize();
+}
 
-void StateWrapper::DoBytes(void* data, size_t length)
+StateWrapper::~StateWrapper()
 {
-  if (m_mode == Mode::Read)
-  {
-    if (m_error || (m_error |= !m_stream->Read2(data, static_cast<u32>(length))) == true)
-      std::memset(data, 0, length);
-  }
-  else
-  {
-    if (!m_error)
-      m_error |= !m_stream->Write2(data, static_cast<u32>(length));
-  }
+  SyncStream();
+}
+
+bool StateWrapper::ReadDataSlow(void* data, u32 size)
+{
+  // memory streams can't be read past the end
+  if (m_memory_stream)
+    return false;
+
+  return m_stream->Read2(data, size);
+}
+
+bool StateWrapper::WriteDataSlow(const void* data, u32 size)
+{
+  if (!m_memory_stream)
+    return m_stream->Write2(data, size);
+
+  // let the stream grow its buffer, then carry on writing to it directly
+  SyncStream();
+  if (m_memory_stream->Write(data, size) != size)
+    return false;
+
+  m_memory = m_memory_stream->GetMemoryPointer();
+  m_memory_position = static_cast<u32>(m_memory_stream->GetPosition());
+  m_memory_size = m_memory_stream->GetMemorySize();
+  return true;
+}
+
+void StateWrapper::SyncStream()
+{
+  if (!m_memory_stream)
+    return;
+
+  if (m_mode == Mode::Write && m_memory_position > m_memory_stream->GetSize())
+    m_memory_stream->Resize(m_memory_position);
+
+  m_memory_stream->SeekAbsolute(m_memory_position);
+}
+
+u64 StateWrapper::GetPosition() const
+{
+  return m_memory_stream ? m_memory_position : m_stream->GetPosition();
 }
 
 void StateWrapper::Do(bool* value_ptr)
@@ -32,14 +70,14 @@ void StateWrapper::Do(bool* value_ptr)
   {
     u8 value = 0;
     if (!m_error)
-      m_error |= !m_stream->ReadByte(&value);
+      m_error |= !ReadData(&value, sizeof(value));
     *value_ptr = (value != 0);
   }
   else
   {
     u8 value = static_cast<u8>(*value_ptr);
     if (!m_error)
-      m_error |= !m_stream->WriteByte(value);
+      m_error |= !WriteData(&value, sizeof(value));
   }
 }
 
@@ -73,7 +111,7 @@ bool StateWrapper::DoMarker(const char* marker)
   if (m_mode == Mode::Write || file_value.Compare(marker))
     return true;
 
-  Log_ErrorPrintf("Marker mismatch at offset %" PRIu64 ": found '%s' expected '%s'", m_stream->GetPosition(),
+  Log_ErrorPrintf("Marker mismatch at offset %" PRIu64 ": found '%s' expected '%s'", GetPosition(),
                   file_value.GetCharArray(), marker);
 
   return false;
@@ -21,16 +21,26 @@ public:
   };
 
   StateWrapper(ByteStream* stream, Mode mode, u32 version);
+
+  /// Memory streams are accessed directly rather than through the ByteStream interface. The stream's position and
+  /// size are only brought up to date when the wrapper is destroyed or GetStream() is called.
+  StateWrapper(GrowableMemoryByteStream* stream, Mode mode, u32 version);
+
   StateWrapper(const StateWrapper&) = delete;
   ~StateWrapper();
 
-  ByteStream* GetStream() const { return m_stream; }
+  ByteStream* GetStream()
+  {
+    SyncStream();
+    return m_stream;
+  }
   bool HasError() const { return m_error; }
   bool IsReading() const { return (m_mode == Mode::Read); }
   bool IsWriting() const { return (m_mode == Mode::Write); }
   Mode GetMode() const { return m_mode; }
   void SetMode(Mode mode) { m_mode = mode; }
   u32 GetVersion() const { return m_version; }
+  u64 GetPosition() const;
 
   /// Overload for integral or floating-point types. Writes bytes as-is.
   template<typename T, std::enable_if_t<std::is_integral_v<T> || std::is_floating_point_v<T>, int> = 0>
@@ -38,13 +48,13 @@ public:
   {
     if (m_mode == Mode::Read)
     {
-      if (m_error || (m_error |= !m_stream->Read2(value_ptr, sizeof(T))) == true)
+      if (m_error || (m_error |= !ReadData(value_ptr, sizeof(T))) == true)
         *value_ptr = static_cast<T>(0);
     }
     else
     {
       if (!m_error)
-        m_error |= !m_stream->Write2(value_ptr, sizeof(T));
+        m_error |= !WriteData(value_ptr, sizeof(T));
     }
   }
 
@@ -56,7 +66,7 @@ public:
     if (m_mode == Mode::Read)
     {
       TType temp;
-      if (m_error || (m_error |= !m_stream->Read2(&temp, sizeof(TType))) == true)
+      if (m_error || (m_error |= !ReadData(&temp, sizeof(TType))) == true)
         temp = static_cast<TType>(0);
 
       *value_ptr = static_cast<T>(temp);
@@ -66,7 +76,7 @@ public:
       TType temp;
       std::memcpy(&temp, value_ptr, sizeof(TType));
       if (!m_error)
-        m_error |= !m_stream->Write2(&temp, sizeof(TType));
+        m_error |= !WriteData(&temp, sizeof(TType));
     }
   }
 
@@ -76,31 +86,50 @@ public:
   {
     if (m_mode == Mode::Read)
     {
-      if (m_error || (m_error |= !m_stream->Read2(value_ptr, sizeof(T))) == true)
+      if (m_error || (m_error |= !ReadData(value_ptr, sizeof(T))) == true)
         std::memset(value_ptr, 0, sizeof(*value_ptr));
     }
     else
     {
       if (!m_error)
-        m_error |= !m_stream->Write2(value_ptr, sizeof(T));
+        m_error |= !WriteData(value_ptr, sizeof(T));
     }
   }
 
   template<typename T>
   void DoArray(T* values, size_t count)
   {
-    for (size_t i = 0; i < count; i++)
-      Do(&values[i]);
+    // numbers are stored as-is, so the whole array can be copied at once. bools are excluded, they're normalized.
+    if constexpr ((std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_floating_point_v<T>)
+    {
+      DoBytes(values, sizeof(T) * count);
+    }
+    else
+    {
+      for (size_t i = 0; i < count; i++)
+        Do(&values[i]);
+    }
   }
 
   template<typename T>
   void DoPODArray(T* values, size_t count)
   {
-    for (size_t i = 0; i < count; i++)
-      DoPOD(&values[i]);
+    DoBytes(values, sizeof(T) * count);
   }
 
-  void DoBytes(void* data, size_t length);
+  void DoBytes(void* data, size_t length)
+  {
+    if (m_mode == Mode::Read)
+    {
+      if (m_error || (m_error |= !ReadData(data, static_cast<u32>(length))) == true)
+        std::memset(data, 0, length);
+    }
+    else
+    {
+      if (!m_error)
+        m_error |= !WriteData(data, static_cast<u32>(length));
+    }
+  }
 
   void Do(bool* value_ptr);
   void Do(std::string* value_ptr);
@@ -196,12 +225,54 @@ public:
       return;
     }
 
-    if (!m_error)
+    if (m_error)
+      return;
+
+    if (m_memory_stream)
+    {
+      if ((m_memory_position + count) <= m_memory_size)
+        m_memory_position += static_cast<u32>(count);
+      else
+        m_error = true;
+    }
+    else
+    {
       m_error = !m_stream->SeekRelative(static_cast<s64>(count));
+    }
   }
 
 private:
+  // when reading, m_memory_size is the amount of data in the stream, when writing, it's the allocated size. it stays
+  // at zero for other streams, so every access falls through to the slow path.
+  ALWAYS_INLINE bool ReadData(void* data, u32 size)
+  {
+    if ((m_memory_position + size) > m_memory_size)
+      return ReadDataSlow(data, size);
+
+    std::memcpy(data, m_memory + m_memory_position, size);
+    m_memory_position += size;
+    return true;
+  }
+
+  ALWAYS_INLINE bool WriteData(const void* data, u32 size)
+  {
+    if ((m_memory_position + size) > m_memory_size)
+      return WriteDataSlow(data, size);
+
+    std::memcpy(m_memory + m_memory_position, data, size);
+    m_memory_position += size;
+    return true;
+  }
+
+  bool ReadDataSlow(void* data, u32 size);
+  bool WriteDataSlow(const void* data, u32 size);
+  void SyncStream();
+
   ByteStream* m_stream;
+  GrowableMemoryByteStream* m_memory_stream = nullptr;
+  u8* m_memory = nullptr;
+  u32 m_memory_position = 0;
+  u32 m_memory_size = 0;
   Mode m_mode;
   u32 m_version;
   bool m_error = false;
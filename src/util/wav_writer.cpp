@@ -1,6 +1,7 @@
 #include "wav_writer.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include <algorithm>
 Log_SetChannel(WAVWriter);
 
 #pragma pack(push, 1)
@@ -62,6 +63,9 @@ bool WAVWriter::Open(const char* filename, u32 sample_rate, u32 num_channels)
     return false;
   }
 
+  m_block.reserve(BLOCK_FRAMES * m_num_channels);
+  m_writer_shutdown = false;
+  m_writer_thread = std::thread(&WAVWriter::WriterThreadEntryPoint, this);
   return true;
 }
 
@@ -70,6 +74,18 @@ void WAVWriter::Close()
   if (!IsOpen())
     return;
 
+  if (!m_block.empty())
+    QueueBlock();
+
+  {
+    std::unique_lock lock(m_mutex);
+    m_writer_shutdown = true;
+    m_work_cv.notify_one();
+  }
+  m_writer_thread.join();
+  m_free_blocks.clear();
+  m_block = {};
+
   if (std::fseek(m_file, 0, SEEK_SET) != 0 || !WriteHeader())
     Log_ErrorPrintf("Failed to re-write header on file, file may be unplayable");
 
@@ -78,21 +94,74 @@ void WAVWriter::Close()
   m_sample_rate = 0;
   m_num_channels = 0;
   m_num_frames = 0;
+  m_num_frames_written = 0;
 }
 
 void WAVWriter::WriteFrames(const s16* samples, u32 num_frames)
 {
-  const u32 num_frames_written =
-    static_cast<u32>(std::fwrite(samples, sizeof(s16) * m_num_channels, num_frames, m_file));
-  if (num_frames_written != num_frames)
-    Log_ErrorPrintf("Only wrote %u of %u frames to output file", num_frames_written, num_frames);
+  while (num_frames > 0)
+  {
+    const u32 block_frames = static_cast<u32>(m_block.size()) / m_num_channels;
+    const u32 frames_this_block = std::min(num_frames, BLOCK_FRAMES - block_frames);
+    m_block.insert(m_block.end(), samples, samples + frames_this_block * m_num_channels);
+    samples += frames_this_block * m_num_channels;
+    num_frames -= frames_this_block;
+    m_num_frames += frames_this_block;
+
+    if ((block_frames + frames_this_block) == BLOCK_FRAMES)
+      QueueBlock();
+  }
+}
+
+void WAVWriter::QueueBlock()
+{
+  std::unique_lock lock(m_mutex);
+  m_done_cv.wait(lock, [this]() { return m_queued_blocks.size() < MAX_QUEUED_BLOCKS; });
+  m_queued_blocks.push_back(std::move(m_block));
+  m_work_cv.notify_one();
 
-  m_num_frames += num_frames_written;
+  if (!m_free_blocks.empty())
+  {
+    m_block = std::move(m_free_blocks.back());
+    m_free_blocks.pop_back();
+  }
+  else
+  {
+    m_block = {};
+    m_block.reserve(BLOCK_FRAMES * m_num_channels);
+  }
+}
+
+void WAVWriter::WriterThreadEntryPoint()
+{
+  std::unique_lock lock(m_mutex);
+  for (;;)
+  {
+    m_work_cv.wait(lock, [this]() { return m_writer_shutdown || !m_queued_blocks.empty(); });
+    if (m_queued_blocks.empty())
+      break;
+
+    std::vector<SampleType> block = std::move(m_queued_blocks.front());
+    m_queued_blocks.pop_front();
+    lock.unlock();
+
+    const u32 num_frames = static_cast<u32>(block.size()) / m_num_channels;
+    const u32 num_frames_written =
+      static_cast<u32>(std::fwrite(block.data(), sizeof(SampleType) * m_num_channels, num_frames, m_file));
+    if (num_frames_written != num_frames)
+      Log_ErrorPrintf("Only wrote %u of %u frames to output file", num_frames_written, num_frames);
+    m_num_frames_written += num_frames_written;
+
+    block.clear();
+    lock.lock();
+    m_free_blocks.push_back(std::move(block));
+    m_done_cv.notify_one();
+  }
 }
 
 bool WAVWriter::WriteHeader()
 {
-  const u32 data_size = sizeof(SampleType) * m_num_channels * m_num_frames;
+  const u32 data_size = sizeof(SampleType) * m_num_channels * m_num_frames_written;
 
   WAV_HEADER header = {};
   header.chunk_id = 0x46464952; // 0x52494646
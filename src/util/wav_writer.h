@@ -1,6 +1,11 @@
 #pragma once
 #include "common/types.h"
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace Common {
 
@@ -18,17 +23,37 @@ public:
   bool Open(const char* filename, u32 sample_rate, u32 num_channels);
   void Close();
 
+  /// Frames are buffered and written to the file on a worker thread, so this does not wait on disk I/O.
   void WriteFrames(const s16* samples, u32 num_frames);
 
 private:
   using SampleType = s16;
 
+  // frames are handed to the worker in blocks of this size, queued blocks are capped so a stalled disk can't grow
+  // memory unbounded, past that the caller waits
+  static constexpr u32 BLOCK_FRAMES = 4096;
+  static constexpr u32 MAX_QUEUED_BLOCKS = 64;
+
   bool WriteHeader();
 
+  void QueueBlock();
+  void WriterThreadEntryPoint();
+
   std::FILE* m_file = nullptr;
+
+  std::vector<SampleType> m_block;
+  std::vector<std::vector<SampleType>> m_free_blocks;
+  std::deque<std::vector<SampleType>> m_queued_blocks;
+  std::mutex m_mutex;
+  std::condition_variable m_work_cv;
+  std::condition_variable m_done_cv;
+  std::thread m_writer_thread;
+  bool m_writer_shutdown = false;
+
   u32 m_sample_rate = 0;
   u32 m_num_channels = 0;
   u32 m_num_frames = 0;
+  u32 m_num_frames_written = 0;
 };
 
 } // namespace Common
\ No newline at end of file